@@ -132,6 +132,11 @@ REPOSITORY_LOCATIONS = dict(
         commit = "6a4fec616ec4b20f54d5fb530808b855cb664390",
         remote = "https://github.com/google/protobuf",
     ),
+    com_googlesource_code_re2 = dict(
+        sha256 = "38bc0426ee15b5ed67957017fd18201965df0721327be13f60496f2b356e3e01",
+        strip_prefix = "re2-2019-08-01",
+        urls = ["https://github.com/google/re2/archive/2019-08-01.tar.gz"],
+    ),
     grpc_httpjson_transcoding = dict(
         commit = "05a15e4ecd0244a981fdf0348a76658def62fa9c",  # 2018-05-30
         remote = "https://github.com/grpc-ecosystem/grpc-httpjson-transcoding",
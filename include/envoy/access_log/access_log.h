@@ -80,6 +80,17 @@ public:
                              const Http::HeaderMap& response_headers,
                              const Http::HeaderMap& response_trailers,
                              const RequestInfo::RequestInfo& request_info) const PURE;
+
+  /**
+   * Append the formatted output to a string rather than returning a new one, so that a caller
+   * that reuses the string for every log line doesn't allocate once its capacity has grown.
+   * @param output supplies the string to append to.
+   */
+  virtual void formatInto(const Http::HeaderMap& request_headers,
+                          const Http::HeaderMap& response_headers,
+                          const Http::HeaderMap& response_trailers,
+                          const RequestInfo::RequestInfo& request_info,
+                          std::string& output) const PURE;
 };
 
 typedef std::unique_ptr<Formatter> FormatterPtr;
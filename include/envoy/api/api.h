@@ -8,6 +8,7 @@
 #include "envoy/event/timer.h"
 #include "envoy/filesystem/filesystem.h"
 #include "envoy/stats/store.h"
+#include "envoy/thread/blocking_pool.h"
 #include "envoy/thread/thread.h"
 
 namespace Envoy {
@@ -47,6 +48,12 @@ public:
    * @return file content.
    */
   virtual std::string fileReadToEnd(const std::string& path) PURE;
+
+  /**
+   * @return Thread::BlockingPool& the threads shared by the subsystems that do blocking file and
+   *         crypto work off the main and worker threads.
+   */
+  virtual Thread::BlockingPool& blockingPool() PURE;
 };
 
 typedef std::unique_ptr<Api> ApiPtr;
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Regex {
+
+/**
+ * A compiled regular expression, independent of the engine that compiled it.
+ */
+class CompiledMatcher {
+public:
+  virtual ~CompiledMatcher() {}
+
+  /**
+   * @param value supplies the value to match.
+   * @return bool whether the regex matches the entire value.
+   */
+  virtual bool match(absl::string_view value) const PURE;
+
+  /**
+   * Find the leftmost match of the regex anywhere in a value.
+   * @param value supplies the value to search.
+   * @param submatches supplies an array to receive the whole match followed by the capture groups.
+   *        Capture groups that did not participate in the match are set to a default constructed
+   *        absl::string_view. May be nullptr if num_submatches is 0.
+   * @param num_submatches supplies the number of entries in submatches to fill. Must not be more
+   *        than numCaptureGroups() + 1.
+   * @return bool whether the regex matched.
+   */
+  virtual bool search(absl::string_view value, absl::string_view* submatches,
+                      size_t num_submatches) const PURE;
+
+  /**
+   * @return size_t the number of capture groups in the regex.
+   */
+  virtual size_t numCaptureGroups() const PURE;
+};
+
+typedef std::unique_ptr<const CompiledMatcher> CompiledMatcherPtr;
+
+} // namespace Regex
+} // namespace Envoy
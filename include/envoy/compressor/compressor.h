@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+#include <string>
+
 #include "envoy/buffer/buffer.h"
 
 namespace Envoy {
@@ -26,5 +29,26 @@ public:
   virtual void compress(Buffer::Instance& buffer, State state) PURE;
 };
 
+typedef std::unique_ptr<Compressor> CompressorPtr;
+
+/**
+ * Creates the compressors of a content coding, with the same settings.
+ */
+class CompressorFactory {
+public:
+  virtual ~CompressorFactory() {}
+
+  /**
+   * @return CompressorPtr a new compressor, ready to compress a stream.
+   */
+  virtual CompressorPtr createCompressor() const PURE;
+
+  /**
+   * @return const std::string& the content coding of the compressed streams, as found in the
+   *         Content-Encoding and Accept-Encoding headers.
+   */
+  virtual const std::string& contentEncoding() const PURE;
+};
+
 } // namespace Compressor
 } // namespace Envoy
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+namespace Config {
+
+/**
+ * Runs the independent per resource work of an xDS update, such as unpacking and validating the
+ * resources of a large response, on several threads. The caller blocks until all the work is done,
+ * so that the update is still applied and acknowledged in order on the main thread.
+ */
+class DecodePool {
+public:
+  virtual ~DecodePool() {}
+
+  /**
+   * Run a function for each index in [0, count), possibly concurrently. The function must not
+   * touch state that is not safe to access from other threads.
+   * @param count supplies the number of indices.
+   * @param fn supplies the function to run for each index.
+   * @throw the exception thrown for the lowest index, once all the indices have been run.
+   */
+  virtual void parallelFor(size_t count, const std::function<void(size_t)>& fn) PURE;
+};
+
+} // namespace Config
+} // namespace Envoy
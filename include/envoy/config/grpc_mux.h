@@ -23,6 +23,20 @@ public:
   virtual void onConfigUpdate(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
                               const std::string& version_info) PURE;
 
+  /**
+   * Called when an incremental configuration update is received. Only the resources that were
+   * added, updated or removed since the previous update are supplied.
+   * @param added_resources vector of the added and updated resources.
+   * @param removed_resources names of the removed resources.
+   * @param system_version_info version of the xDS server as a whole, for debugging.
+   * @throw EnvoyException with reason if the configuration is rejected. Otherwise the configuration
+   *        is accepted. Accepted resources have their versions reflected in subsequent requests.
+   */
+  virtual void onIncrementalConfigUpdate(
+      const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added_resources,
+      const Protobuf::RepeatedPtrField<ProtobufTypes::String>& removed_resources,
+      const std::string& system_version_info) PURE;
+
   /**
    * Called when either the subscription is unable to fetch a config update or when onConfigUpdate
    * invokes an exception.
@@ -29,6 +29,21 @@ public:
   virtual void onConfigUpdate(const ResourceVector& resources,
                               const std::string& version_info) PURE;
 
+  /**
+   * Called when an incremental configuration update is received. Only the resources that were
+   * added, updated or removed since the previous update are supplied, so that the cost of applying
+   * the update is proportional to the change rather than to the total number of resources.
+   * @param added_resources vector of the added and updated resources.
+   * @param removed_resources names of the removed resources.
+   * @param system_version_info supplies the version information of the xDS server as a whole.
+   * @throw EnvoyException with reason if the configuration is rejected. Otherwise the configuration
+   *        is accepted.
+   */
+  virtual void onIncrementalConfigUpdate(
+      const ResourceVector& added_resources,
+      const Protobuf::RepeatedPtrField<ProtobufTypes::String>& removed_resources,
+      const std::string& system_version_info) PURE;
+
   /**
    * Called when either the Subscription is unable to fetch a config update or when onConfigUpdate
    * invokes an exception.
@@ -19,6 +19,10 @@
 #include "envoy/network/transport_socket.h"
 
 namespace Envoy {
+namespace Stats {
+class Scope;
+} // namespace Stats
+
 namespace Event {
 
 /**
@@ -38,6 +42,22 @@ public:
    */
   virtual TimeSystem& timeSystem() PURE;
 
+  /**
+   * Returns a time source for hot paths, whose times are read from timeSystem() at most once per
+   * event loop callback. The times it returns may lag behind by the time spent in the current
+   * callback so far. It may only be used from the thread running the event loop.
+   */
+  virtual TimeSource& approximateTimeSource() PURE;
+
+  /**
+   * Start recording the stats of the dispatcher: the time spent in each kind of callback, how late
+   * the event loop runs and the depth of the post and deferred deletion queues. Must be called
+   * before run() or from the thread running the event loop.
+   * @param scope supplies the scope of the stats, which must outlive the event loop.
+   * @param prefix supplies the prefix of the stats of the dispatcher, e.g. "worker_0.dispatcher.".
+   */
+  virtual void initializeStats(Stats::Scope& scope, const std::string& prefix) PURE;
+
   /**
    * Clear any items in the deferred deletion queue.
    */
@@ -69,6 +89,23 @@ public:
                          Network::TransportSocketPtr&& transport_socket,
                          const Network::ConnectionSocket::OptionsSharedPtr& options) PURE;
 
+  /**
+   * Create a client connection racing connection attempts to several addresses, as described by
+   * RFC 8305 (Happy Eyeballs).
+   * @param addresses supplies the addresses to connect to, in order of preference. Must not be
+   *        empty.
+   * @param source_address supplies an address to bind to or nullptr if no bind is necessary.
+   * @param transport_socket supplies a transport socket to be used by the connection.
+   * @param options the socket options to be set on the underlying sockets before anything is sent
+   *        on them.
+   * @return Network::ClientConnectionPtr a client connection that is owned by the caller.
+   */
+  virtual Network::ClientConnectionPtr createHappyEyeballsConnection(
+      const std::vector<Network::Address::InstanceConstSharedPtr>& addresses,
+      Network::Address::InstanceConstSharedPtr source_address,
+      Network::TransportSocketPtr&& transport_socket,
+      const Network::ConnectionSocket::OptionsSharedPtr& options) PURE;
+
   /**
    * Create an async DNS resolver. The resolver should only be used on the thread that runs this
    * dispatcher.
@@ -109,12 +146,29 @@ public:
                                               Network::ListenerCallbacks& cb, bool bind_to_port,
                                               bool hand_off_restored_destination_connections) PURE;
 
+  /**
+   * Create a listener receiving datagrams on a bound datagram socket.
+   * @param socket supplies the socket to receive on.
+   * @param cb supplies the callbacks to invoke for received datagrams.
+   * @return Network::UdpListenerPtr a new listener that is owned by the caller.
+   */
+  virtual Network::UdpListenerPtr createUdpListener(Network::Socket& socket,
+                                                    Network::UdpListenerCallbacks& cb) PURE;
+
   /**
    * Allocate a timer. @see Timer for docs on how to use the timer.
    * @param cb supplies the callback to invoke when the timer fires.
    */
   virtual Event::TimerPtr createTimer(TimerCb cb) PURE;
 
+  /**
+   * Allocate a timer with millisecond granularity that is cheap to enable and disable, intended for
+   * timeouts that are re-armed or cancelled far more often than they fire (e.g. idle timeouts).
+   * The timer may fire up to a millisecond later than a timer from createTimer().
+   * @param cb supplies the callback to invoke when the timer fires.
+   */
+  virtual Event::TimerPtr createCoarseTimer(TimerCb cb) PURE;
+
   /**
    * Submit an item for deferred delete. @see DeferredDeletable.
    */
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 
 #include "envoy/event/dispatcher.h"
@@ -21,7 +22,23 @@ public:
    */
   enum class FailureReason {
     // The stream has been reset.
-    Reset
+    Reset,
+    // The response body exceeded RequestOptions::max_response_body_bytes and the stream was reset.
+    ResponseBodyTooLarge
+  };
+
+  /**
+   * Options for a request sent with send().
+   */
+  struct RequestOptions {
+    // The request timeout.
+    absl::optional<std::chrono::milliseconds> timeout;
+    // The maximum number of response body bytes to buffer for onSuccess(). If the body is longer,
+    // the stream is reset and the request fails with FailureReason::ResponseBodyTooLarge.
+    absl::optional<uint64_t> max_response_body_bytes;
+    // Drop the response body as it arrives rather than buffering it, for callers that only need
+    // the response headers. The response passed to onSuccess() then has no body.
+    bool discard_response_body{};
   };
 
   /**
@@ -143,6 +160,18 @@ public:
   virtual Request* send(MessagePtr&& request, Callbacks& callbacks,
                         const absl::optional<std::chrono::milliseconds>& timeout) PURE;
 
+  /**
+   * Send an HTTP request asynchronously, with options controlling how the response is buffered.
+   * The request body is moved to the upstream stream without being copied, so a body sharing the
+   * slices of another buffer (see Buffer::OwnedImpl::share()) is sent without duplicating them.
+   * @param request the request to send.
+   * @param callbacks the callbacks to be notified of request status.
+   * @param options supplies the request options.
+   * @return a request handle or nullptr if no request could be created, as for send() above.
+   */
+  virtual Request* send(MessagePtr&& request, Callbacks& callbacks,
+                        const RequestOptions& options) PURE;
+
   /**
    * Start an HTTP stream asynchronously.
    * @param callbacks the callbacks to be notified of stream status.
@@ -172,6 +172,15 @@ public:
    * @return uint32_t the stream's configured buffer limits.
    */
   virtual uint32_t bufferLimit() PURE;
+
+  /**
+   * Set the weight of the stream relative to the other streams of its connection, for protocols
+   * that multiplex streams. The connection's bandwidth is shared between its streams with data to
+   * send in proportion to their weights. This has no effect on protocols without multiplexing, or
+   * unless enabled by Http2Settings::prioritize_streams_.
+   * @param weight supplies the weight, between 1 and 256 as for HTTP/2 stream priorities.
+   */
+  virtual void setPriorityWeight(uint32_t weight) PURE;
 };
 
 /**
@@ -198,6 +207,11 @@ struct Http1Settings {
   bool accept_http_10_{false};
   // Set a default host if no Host: header is present for HTTP/1.0 requests.`
   std::string default_host_for_http_10_;
+  // Parse requests with the vectorized parser instead of http_parser.
+  bool use_vectorized_parser_{false};
+  // Reference large request header values in the connection's read buffer instead of copying
+  // them. The buffer slices holding them are then kept alive by the request headers.
+  bool reference_header_values_{false};
 };
 
 /**
@@ -210,6 +224,14 @@ struct Http2Settings {
   uint32_t initial_stream_window_size_{DEFAULT_INITIAL_STREAM_WINDOW_SIZE};
   uint32_t initial_connection_window_size_{DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE};
   bool allow_connect_{DEFAULT_ALLOW_CONNECT};
+  uint32_t max_connections_per_host_{DEFAULT_MAX_CONNECTIONS_PER_HOST};
+  // Reference received DATA frame payloads in the read buffer rather than copying them.
+  bool reference_received_data_{false};
+  // Schedule the DATA frames of streams by their weight while the connection is write blocked.
+  bool prioritize_streams_{false};
+  // Grow the receive windows from their initial sizes up to this size, following the
+  // bandwidth-delay product of the connection measured with PINGs. 0 disables auto tuning.
+  uint32_t auto_tuned_window_size_limit_{0};
 
   // disable HPACK compression
   static const uint32_t MIN_HPACK_TABLE_SIZE = 0;
@@ -245,6 +267,8 @@ struct Http2Settings {
   static const uint32_t MAX_INITIAL_CONNECTION_WINDOW_SIZE = (1U << 31) - 1;
   // By default both nghttp2 and Envoy do not allow CONNECT over H2.
   static const bool DEFAULT_ALLOW_CONNECT = false;
+  // By default all the streams to an upstream host share one connection.
+  static const uint32_t DEFAULT_MAX_CONNECTIONS_PER_HOST = 1;
 };
 
 /**
@@ -53,14 +53,17 @@ typedef std::unordered_set<LowerCaseString, LowerCaseStringHash> LowerCaseStrUno
 
 /**
  * This is a string implementation for use in header processing. It is heavily optimized for
- * performance. It supports 3 different types of storage and can switch between them:
+ * performance. It supports 4 different types of storage and can switch between them:
  * 1) A reference.
  * 2) Interned string.
  * 3) Heap allocated storage.
+ * 4) A reference to data pinned by the owner of the string, such as received data held by a
+ *    codec's header map. Unlike 1) the data only lives as long as its owner, so it must not be
+ *    referenced beyond that.
  */
 class HeaderString {
 public:
-  enum class Type { Inline, Reference, Dynamic };
+  enum class Type { Inline, Reference, Dynamic, Pinned };
 
   /**
    * Default constructor. Sets up for inline storage.
@@ -85,8 +88,8 @@ public:
   ~HeaderString();
 
   /**
-   * Append data to an existing string. If the string is a reference string the reference data is
-   * not copied.
+   * Append data to an existing string. If the string is a reference or pinned string the
+   * referenced data is copied first, and is not modified.
    */
   void append(const char* data, uint32_t size);
 
@@ -108,8 +111,8 @@ public:
   }
 
   /**
-   * Return the string to a default state. Reference strings are not touched. Both inline/dynamic
-   * strings are reset to zero size.
+   * Return the string to a default state. Reference and pinned strings are not touched. Both
+   * inline/dynamic strings are reset to zero size.
    */
   void clear();
 
@@ -140,6 +143,15 @@ public:
    */
   void setReference(const std::string& ref_value);
 
+  /**
+   * Set the value of the string to reference pinned data without copying it. Any later mutation
+   * copies the data first.
+   * @param data MUST be null terminated (i.e. data[size] == 0) and MUST remain valid for as long
+   *        as the string references it, which is typically ensured by the owner of the string.
+   * @param size supplies the length of the string, not including the null terminator.
+   */
+  void setPinned(const char* data, uint32_t size);
+
   /**
    * @return the size of the string, not including the null terminator.
    */
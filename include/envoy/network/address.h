@@ -2,6 +2,7 @@
 
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include <array>
 #include <cstdint>
@@ -143,6 +144,28 @@ public:
    */
   virtual Api::SysCallIntResult connect(int fd) const PURE;
 
+  /**
+   * Send a datagram to this address. The socket should have been created with a call to
+   * socket(SocketType::Datagram) on an Instance of the same address family.
+   * @param fd supplies the platform socket handle.
+   * @param iov supplies the slices of the datagram.
+   * @param iovcnt supplies the number of slices.
+   * @return a Api::SysCallSizeResult with rc_ = the number of bytes sent for success and rc_ = -1
+   *   for failure. If the call is successful, errno_ shouldn't be used.
+   */
+  virtual Api::SysCallSizeResult sendTo(int fd, const iovec* iov, int iovcnt) const PURE;
+
+  /**
+   * Send several datagrams to this address, with a single sendmmsg() call on Linux.
+   * @param fd supplies the platform socket handle.
+   * @param datagrams supplies the datagrams, one per iovec.
+   * @param num_datagrams supplies the number of datagrams.
+   * @return a Api::SysCallIntResult with rc_ = the number of datagrams sent from the start of
+   *   datagrams for success and rc_ = -1 if none could be sent.
+   */
+  virtual Api::SysCallIntResult sendBatchTo(int fd, const iovec* datagrams,
+                                            int num_datagrams) const PURE;
+
   /**
    * @return the IP address information IFF type() == Type::Ip, otherwise nullptr.
    */
@@ -86,6 +86,18 @@ public:
     Stats::Gauge& write_current_;
     // Counter* as this is an optional counter. Bind errors will not be tracked if this is nullptr.
     Stats::Counter* bind_errors_;
+    // Counter* as this is an optional counter. Counts read events that yielded after exhausting
+    // the read budget. Not tracked if this is nullptr.
+    Stats::Counter* read_budget_exhausted_;
+    // Counter* as this is an optional counter. Accumulates the milliseconds the write buffer spent
+    // above its high watermark. Not tracked if this is nullptr.
+    Stats::Counter* write_buffer_above_high_watermark_ms_;
+    // Counter* as this is an optional counter. Counts connections established to another address
+    // than the first one of racing connection attempts. Not tracked if this is nullptr.
+    Stats::Counter* connect_fallback_wins_;
+    // Counter* as this is an optional counter. Counts connections whose data sent in the SYN with
+    // TCP Fast Open was acknowledged. Not tracked if this is nullptr.
+    Stats::Counter* tfo_syn_data_acked_;
   };
 
   virtual ~Connection() {}
@@ -122,6 +134,13 @@ public:
    */
   virtual uint64_t id() const PURE;
 
+  /**
+   * @return int the file descriptor of the connection's socket, or -1 once it is closed. This is
+   *         for fast paths that move data between sockets in the kernel, bypassing the
+   *         connection's buffers and filters. Callers must not close it.
+   */
+  virtual int fd() const PURE;
+
   /**
    * @return std::string the next protocol to use as selected by network level negotiation. (E.g.,
    *         ALPN). If network level negotation is not supported by the connection or no protocol
@@ -134,6 +153,12 @@ public:
    */
   virtual void noDelay(bool enable) PURE;
 
+  /**
+   * Enable/Disable TCP QUICKACK on the connection. The kernel clears it again after acknowledging,
+   * so while enabled it is set again after each read.
+   */
+  virtual void quickAck(bool enable) PURE;
+
   /**
    * Disable socket reads on the connection, applying external back pressure. When reads are
    * enabled again if there is data still in the input buffer it will be redispatched through
@@ -218,6 +243,16 @@ public:
    */
   virtual uint32_t bufferLimit() const PURE;
 
+  /**
+   * Let the write buffer high watermark set with setBufferLimits() grow up to max_limit while the
+   * peer drains the buffer quickly enough, so that fast peers on high latency links do not pause
+   * the writer on every round trip. The watermark returns to the configured limit once the buffer
+   * has not been above it for a while. @see Buffer::WatermarkBuffer::setAutoTuning().
+   * @param max_limit supplies the largest write buffer limit. Values not above the limit set with
+   *        setBufferLimits() disable auto tuning.
+   */
+  virtual void setBufferLimitAutoTuning(uint32_t max_limit) PURE;
+
   /**
    * @return boolean telling if the connection's local address has been restored to an original
    *         destination address, rather than the address the connection was accepted at.
@@ -229,6 +264,11 @@ public:
    */
   virtual bool aboveHighWatermark() const PURE;
 
+  /**
+   * @return the number of bytes written to the connection that have not been sent yet.
+   */
+  virtual uint64_t bufferedWriteBytes() const PURE;
+
   /**
    * Get the socket options set on this connection.
    */
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+#include "envoy/network/listen_socket.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * A per-worker handler of a listener's accepted connections, which a connection balancer can hand
+ * accepted sockets to.
+ */
+class BalancedConnectionHandler {
+public:
+  virtual ~BalancedConnectionHandler() {}
+
+  /**
+   * @return uint64_t the number of connections the handler owns or has been assigned, including
+   *         sockets posted to it that it has not picked up yet.
+   */
+  virtual uint64_t numConnections() const PURE;
+
+  /**
+   * Count a connection the handler has been assigned. Called by the balancer when it picks the
+   * handler, so that concurrent picks see the assignment.
+   */
+  virtual void incNumConnections() PURE;
+
+  /**
+   * Hand an accepted socket to the handler. May be called from any thread; the socket is picked up
+   * on the handler's own worker.
+   * @param socket supplies the accepted socket.
+   */
+  virtual void post(ConnectionSocketPtr&& socket) PURE;
+};
+
+/**
+ * Assigns a listener's accepted connections to the workers' handlers of that listener. Shared by
+ * all workers of a listener, so implementations must be thread safe.
+ */
+class ConnectionBalancer {
+public:
+  virtual ~ConnectionBalancer() {}
+
+  /**
+   * Register a handler that connections can be assigned to.
+   */
+  virtual void registerHandler(BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Unregister a handler. It will not be picked anymore.
+   */
+  virtual void unregisterHandler(BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Pick the handler for a connection just accepted by another handler. The picked handler's
+   * connection count has been incremented when this returns.
+   * @param current_handler supplies the handler that accepted the connection.
+   * @return BalancedConnectionHandler& the handler that should own the connection. If it is not
+   *         current_handler, the socket should be posted to it.
+   */
+  virtual BalancedConnectionHandler&
+  pickTargetHandler(BalancedConnectionHandler& current_handler) PURE;
+};
+
+typedef std::unique_ptr<ConnectionBalancer> ConnectionBalancerPtr;
+
+} // namespace Network
+} // namespace Envoy
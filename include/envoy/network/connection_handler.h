@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <unordered_set>
 
 #include "envoy/network/connection.h"
 #include "envoy/network/filter.h"
@@ -45,6 +47,19 @@ public:
    */
   virtual void removeListeners(uint64_t listener_tag) PURE;
 
+  /**
+   * Close the connections of stopped listeners that were created from any of the given filter
+   * chains, and remove the listeners once they have no connections left. Connections created from
+   * other filter chains are left to close on their own.
+   * @param listener_tag supplies the tag passed to addListener().
+   * @param filter_chains supplies the filter chains whose connections to close.
+   * @param completion supplies the completion to call once the listeners have been removed. It is
+   *        called from the handler's dispatcher.
+   */
+  virtual void removeFilterChains(uint64_t listener_tag,
+                                  const std::unordered_set<const FilterChain*>& filter_chains,
+                                  std::function<void()> completion) PURE;
+
   /**
    * Stop listeners using the listener tag as a key. This will not close any connections and is used
    * for draining.
@@ -56,6 +71,17 @@ public:
    * Stop all listeners. This will not close any connections and is used for draining.
    */
   virtual void stopListeners() PURE;
+
+  /**
+   * Temporarily stop all listeners from accepting connections, e.g. while the server is
+   * overloaded. Unlike stopListeners(), the listeners keep their sockets and can be re-enabled.
+   */
+  virtual void disableListeners() PURE;
+
+  /**
+   * Re-enable listeners after disableListeners().
+   */
+  virtual void enableListeners() PURE;
 };
 
 typedef std::unique_ptr<ConnectionHandler> ConnectionHandlerPtr;
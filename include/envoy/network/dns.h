@@ -24,7 +24,7 @@ public:
   virtual void cancel() PURE;
 };
 
-enum class DnsLookupFamily { V4Only, V6Only, Auto };
+enum class DnsLookupFamily { V4Only, V6Only, Auto, All };
 
 /**
  * An asynchronous DNS resolver.
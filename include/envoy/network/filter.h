@@ -17,6 +17,8 @@ namespace Network {
 
 class Connection;
 class ConnectionSocket;
+class UdpListener;
+struct UdpRecvData;
 
 /**
  * Status codes returned by filters that can cause future filters to not get iterated to.
@@ -190,7 +192,8 @@ public:
    * If a filter stopped filter iteration by returning FilterStatus::StopIteration,
    * the filter should call continueFilterChain(true) when complete to continue the filter chain,
    * or continueFilterChain(false) if the filter execution failed and the connection must be
-   * closed.
+   * closed. A filter that fails from onAccept() may call continueFilterChain(false) before
+   * returning FilterStatus::StopIteration.
    * @param success boolean telling whether the filter execution was successful or not.
    */
   virtual void continueFilterChain(bool success) PURE;
@@ -239,6 +242,71 @@ public:
  */
 typedef std::function<void(ListenerFilterManager& filter_manager)> ListenerFilterFactoryCb;
 
+/**
+ * Callbacks used by individual UDP listener read filter instances to communicate with the listener.
+ */
+class UdpReadFilterCallbacks {
+public:
+  virtual ~UdpReadFilterCallbacks() {}
+
+  /**
+   * @return UdpListener& the listener the filter receives datagrams from, which the filter can
+   *         send datagrams back to peers with.
+   */
+  virtual UdpListener& udpListener() PURE;
+};
+
+/**
+ * UDP listener read filter. Unlike network filters, which each belong to a connection, there is a
+ * single instance per UDP listener, which receives the datagrams of all peers.
+ */
+class UdpListenerReadFilter {
+public:
+  virtual ~UdpListenerReadFilter() {}
+
+  /**
+   * Called when a datagram is received by the listener.
+   * @param data supplies the datagram. The filter can move the buffer out.
+   */
+  virtual void onData(UdpRecvData& data) PURE;
+
+protected:
+  /**
+   * @param callbacks supplies the read filter callbacks used to interact with the listener.
+   */
+  UdpListenerReadFilter(UdpReadFilterCallbacks& callbacks) : read_callbacks_(&callbacks) {}
+
+  UdpReadFilterCallbacks* read_callbacks_{};
+};
+
+typedef std::unique_ptr<UdpListenerReadFilter> UdpListenerReadFilterPtr;
+
+/**
+ * Interface for adding UDP listener read filters to a UDP listener.
+ */
+class UdpListenerFilterManager {
+public:
+  virtual ~UdpListenerFilterManager() {}
+
+  /**
+   * Add a read filter to the UDP listener. Filters are invoked in FIFO order (the filter added
+   * first is called first).
+   * @param filter supplies the filter being added.
+   */
+  virtual void addReadFilter(UdpListenerReadFilterPtr&& filter) PURE;
+};
+
+/**
+ * This function is used to wrap the creation of the read filters of a UDP listener. Filter
+ * factories create the lambda at configuration initialization time, and then it is called once
+ * per worker that runs the listener.
+ * @param udp_listener supplies the listener to install filters to.
+ * @param callbacks supplies the callbacks the filters use to interact with the listener.
+ */
+typedef std::function<void(UdpListenerFilterManager& udp_listener,
+                           UdpReadFilterCallbacks& callbacks)>
+    UdpListenerFilterFactoryCb;
+
 /**
  * Interface representing a single filter chain.
  */
@@ -299,6 +367,15 @@ public:
    * @return true if filter chain was created successfully. Otherwise false.
    */
   virtual bool createListenerFilterChain(ListenerFilterManager& listener) PURE;
+
+  /**
+   * Called to create the read filters of a UDP listener.
+   * @param udp_listener supplies the listener to create the chain on.
+   * @param callbacks supplies the callbacks the filters use to interact with the listener.
+   * @return true if filter chain was created successfully. Otherwise false.
+   */
+  virtual bool createUdpListenerFilterChain(UdpListenerFilterManager& udp_listener,
+                                            UdpReadFilterCallbacks& callbacks) PURE;
 };
 
 } // namespace Network
@@ -4,8 +4,11 @@
 #include <memory>
 #include <string>
 
+#include "envoy/api/os_sys_calls.h"
+#include "envoy/buffer/buffer.h"
 #include "envoy/common/exception.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/listen_socket.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/ssl/context.h"
@@ -14,6 +17,19 @@
 namespace Envoy {
 namespace Network {
 
+/**
+ * Per-worker limits on how fast a listener accepts connections. Connections that are not accepted
+ * yet wait in the kernel's accept queue. A value of 0 means no limit.
+ */
+struct AcceptLimits {
+  // The maximum number of connections accepted in one event loop iteration.
+  uint32_t max_accepts_per_event_loop_{};
+  // The sustained number of connections accepted per second.
+  uint32_t accepts_per_second_{};
+  // The number of connections that can be accepted at once above accepts_per_second_.
+  uint32_t accept_burst_{};
+};
+
 /**
  * A configuration for an individual listener.
  */
@@ -60,6 +76,13 @@ public:
    */
   virtual uint32_t perConnectionBufferLimitBytes() PURE;
 
+  /**
+   * @return uint32_t providing the largest limit the write buffers of the listener's new
+   *         connections may grow to, or 0 if their limit is not auto tuned.
+   *         @see Connection::setBufferLimitAutoTuning().
+   */
+  virtual uint32_t perConnectionBufferLimitMaxBytes() PURE;
+
   /**
    * @return Stats::Scope& the stats scope to use for all listener specific stats.
    */
@@ -74,6 +97,30 @@ public:
    * @return const std::string& the listener's name.
    */
   virtual const std::string& name() const PURE;
+
+  /**
+   * @return ConnectionBalancer& the balancer that assigns the listener's accepted connections to
+   *         workers. The same balancer is shared by all workers of the listener.
+   */
+  virtual ConnectionBalancer& connectionBalancer() PURE;
+
+  /**
+   * @return const AcceptLimits& the per-worker limits on accepting connections.
+   */
+  virtual const AcceptLimits& acceptLimits() const PURE;
+
+  /**
+   * @return bool whether TCP QUICKACK is enabled on the listener's connections.
+   *         @see Connection::quickAck().
+   */
+  virtual bool tcpQuickAck() const PURE;
+
+  /**
+   * @return Address::SocketType the type of the listen socket. Datagram listeners receive with a
+   *         UdpListener and run the filters of FilterChainFactory::createUdpListenerFilterChain()
+   *         rather than accepting connections.
+   */
+  virtual Address::SocketType socketType() const PURE;
 };
 
 /**
@@ -106,10 +153,86 @@ public:
 class Listener {
 public:
   virtual ~Listener() {}
+
+  /**
+   * Temporarily stop accepting connections. Connections wait in the kernel's accept queue until
+   * the listener is enabled again. If called from within ListenerCallbacks::onAccept(), no more
+   * connections are accepted in the current event loop iteration.
+   */
+  virtual void disable() PURE;
+
+  /**
+   * Resume accepting connections after disable().
+   */
+  virtual void enable() PURE;
 };
 
 typedef std::unique_ptr<Listener> ListenerPtr;
 
+/**
+ * A datagram received by a UDP listener.
+ */
+struct UdpRecvData {
+  // The address the datagram was received at.
+  Address::InstanceConstSharedPtr local_address_;
+  // The address the datagram was sent from, and that replies are sent to.
+  Address::InstanceConstSharedPtr peer_address_;
+  Buffer::InstancePtr buffer_;
+};
+
+/**
+ * Callbacks invoked by a UDP listener.
+ */
+class UdpListenerCallbacks {
+public:
+  virtual ~UdpListenerCallbacks() {}
+
+  /**
+   * Called for each datagram received. The datagrams read from the socket at once are delivered
+   * in the order they were received.
+   * @param data supplies the datagram that is moved into the callee.
+   */
+  virtual void onData(UdpRecvData&& data) PURE;
+};
+
+/**
+ * A listener on a datagram socket, which receives datagrams from any peer and can send datagrams
+ * back to them. Free the listener to stop receiving on the socket.
+ */
+class UdpListener : public Listener {
+public:
+  /**
+   * @return Event::Dispatcher& the dispatcher the listener's datagrams are read on.
+   */
+  virtual Event::Dispatcher& dispatcher() PURE;
+
+  /**
+   * Send a datagram to a peer from the listener's socket.
+   * @param peer_address supplies the address to send the datagram to.
+   * @param data supplies the datagram. It is drained if the datagram was sent.
+   * @return Api::SysCallSizeResult the result of the send. rc_ is -1 on failure, which includes
+   *         a full socket send buffer (errno_ is EAGAIN), as datagrams are not queued.
+   */
+  virtual Api::SysCallSizeResult send(const Address::Instance& peer_address,
+                                      Buffer::Instance& data) PURE;
+
+  /**
+   * Send several datagrams to a peer from the listener's socket, with a single system call where
+   * the platform supports it.
+   * @param peer_address supplies the address to send the datagrams to.
+   * @param datagrams supplies the datagrams, one per slice.
+   * @param num_datagrams supplies the number of datagrams.
+   * @return Api::SysCallIntResult the result of the send. rc_ is the number of datagrams sent from
+   *         the start of datagrams, which may be fewer than num_datagrams if the socket send
+   *         buffer filled up, or -1 on failure to send any.
+   */
+  virtual Api::SysCallIntResult sendBatch(const Address::Instance& peer_address,
+                                          const Buffer::RawSlice* datagrams,
+                                          uint64_t num_datagrams) PURE;
+};
+
+typedef std::unique_ptr<UdpListener> UdpListenerPtr;
+
 /**
  * Thrown when there is a runtime error creating/binding a listener.
  */
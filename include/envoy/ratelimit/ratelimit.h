@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -75,11 +76,14 @@ public:
    * @param callbacks supplies the completion callbacks.
    * @param domain specifies the rate limit domain.
    * @param descriptors specifies a list of descriptors to query.
+   * @param hits_addend specifies the number of hits the request adds to the matched limits, such
+   *        as to lease quota for several requests at once. Usually 1.
    * @param parent_span source for generating an egress child span as part of the trace.
    *
    */
   virtual void limit(RequestCallbacks& callbacks, const std::string& domain,
-                     const std::vector<Descriptor>& descriptors, Tracing::Span& parent_span) PURE;
+                     const std::vector<Descriptor>& descriptors, uint32_t hits_addend,
+                     Tracing::Span& parent_span) PURE;
 };
 
 typedef std::unique_ptr<Client> ClientPtr;
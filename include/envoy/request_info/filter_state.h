@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <string>
 
 #include "envoy/common/exception.h"
 #include "envoy/common/pure.h"
@@ -19,6 +21,24 @@ public:
     virtual ~Object(){};
   };
 
+  /**
+   * A data name interned into a process wide slot, so that the data stored under it is found by
+   * indexing rather than by comparing names. Keys are registered once, typically at startup or
+   * when the configuration naming them is loaded, and live for the lifetime of the process. Data
+   * set under a key can also be accessed by its name, and the other way around.
+   */
+  class Key {
+  public:
+    Key(absl::string_view name, uint32_t slot) : name_(name), slot_(slot) {}
+
+    const std::string& name() const { return name_; }
+    uint32_t slot() const { return slot_; }
+
+  private:
+    const std::string name_;
+    const uint32_t slot_;
+  };
+
   virtual ~FilterState(){};
 
   /**
@@ -29,6 +49,11 @@ public:
    */
   virtual void setData(absl::string_view data_name, std::unique_ptr<Object>&& data) PURE;
 
+  /**
+   * Same as setData(absl::string_view, ...) for a registered key.
+   */
+  virtual void setData(const Key& key, std::unique_ptr<Object>&& data) PURE;
+
   /**
    * @param data_name the name of the data being set.
    * @return a reference to the stored data.
@@ -45,6 +70,18 @@ public:
     return *result;
   }
 
+  /**
+   * Same as getData(absl::string_view) for a registered key.
+   */
+  template <typename T> const T& getData(const Key& key) const {
+    const T* result = dynamic_cast<const T*>(getDataGeneric(key));
+    if (!result) {
+      throw EnvoyException(
+          fmt::format("Data stored under {} cannot be coerced to specified type", key.name()));
+    }
+    return *result;
+  }
+
   /**
    * @param data_name the name of the data being probed.
    * @return Whether data of the type and name specified exists in the
@@ -55,6 +92,13 @@ public:
             (dynamic_cast<const T*>(getDataGeneric(data_name)) != nullptr));
   }
 
+  /**
+   * Same as hasData(absl::string_view) for a registered key.
+   */
+  template <typename T> bool hasData(const Key& key) const {
+    return hasDataWithKey(key) && (dynamic_cast<const T*>(getDataGeneric(key)) != nullptr);
+  }
+
   /**
    * @param data_name the name of the data being probed.
    * @return Whether data of any type and the name specified exists in the
@@ -62,8 +106,14 @@ public:
    */
   virtual bool hasDataWithName(absl::string_view data_name) const PURE;
 
+  /**
+   * Same as hasDataWithName() for a registered key.
+   */
+  virtual bool hasDataWithKey(const Key& key) const PURE;
+
 protected:
   virtual const Object* getDataGeneric(absl::string_view data_name) const PURE;
+  virtual const Object* getDataGeneric(const Key& key) const PURE;
 };
 
 } // namespace RequestInfo
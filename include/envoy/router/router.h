@@ -10,6 +10,7 @@
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/v2/core/base.pb.h"
+#include "envoy/common/regex.h"
 #include "envoy/http/codec.h"
 #include "envoy/http/codes.h"
 #include "envoy/http/header_map.h"
@@ -101,9 +102,9 @@ public:
   virtual const std::list<std::string>& allowOrigins() const PURE;
 
   /*
-   * @return std::list<std::regex>& regexes that match allowed origins.
+   * @return std::list<Regex::CompiledMatcherPtr>& regexes that match allowed origins.
    */
-  virtual const std::list<std::regex>& allowOriginRegexes() const PURE;
+  virtual const std::list<Regex::CompiledMatcherPtr>& allowOriginRegexes() const PURE;
 
   /**
    * @return std::string access-control-allow-methods value.
@@ -387,6 +388,12 @@ public:
   virtual const std::vector<MetadataMatchCriterionConstSharedPtr>&
   metadataMatchCriteria() const PURE;
 
+  /**
+   * @return uint64_t a hash of all criteria, computed once when the criteria are created by
+   * folding each criterion's name and value in order with HashedValue::combine().
+   */
+  virtual uint64_t hash() const PURE;
+
   /**
    * Creates a new MetadataMatchCriteria, merging existing
    * metadata criteria with the provided criteria. The result criteria is the
@@ -500,6 +507,18 @@ public:
    */
   virtual absl::optional<std::chrono::milliseconds> idleTimeout() const PURE;
 
+  /**
+   * @return absl::optional<std::chrono::milliseconds> the delay after which a hedged request is
+   *         sent to another upstream host if no response has started. Nullopt disables hedging.
+   */
+  virtual absl::optional<std::chrono::milliseconds> hedgeDelay() const PURE;
+
+  /**
+   * @return absl::optional<uint32_t> the maximum number of request body bytes to buffer for
+   *         retries, shadowing and hedging. Nullopt defers to the connection's buffer limit.
+   */
+  virtual absl::optional<uint32_t> retryShadowBufferLimit() const PURE;
+
   /**
    * @return absl::optional<std::chrono::milliseconds> the maximum allowed timeout value derived
    * from 'grpc-timeout' header of a gRPC request. Non-present value disables use of 'grpc-timeout'
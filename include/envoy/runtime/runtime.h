@@ -34,6 +34,30 @@ public:
 
 typedef std::unique_ptr<RandomGenerator> RandomGeneratorPtr;
 
+/**
+ * A runtime key interned in the process wide key registry. Snapshots resolve the values of the
+ * keys interned before they were built, so that looking one of them up is an array access rather
+ * than hashing the key. Keys interned later are looked up by name until the next snapshot.
+ */
+class Key {
+public:
+  Key(const std::string& name, uint32_t index) : name_(name), index_(index) {}
+
+  /**
+   * @return const std::string& the name of the key.
+   */
+  const std::string& name() const { return name_; }
+
+  /**
+   * @return uint32_t the index of the key in the registry.
+   */
+  uint32_t index() const { return index_; }
+
+private:
+  const std::string name_;
+  const uint32_t index_;
+};
+
 /**
  * A snapshot of runtime data.
  */
@@ -73,7 +97,7 @@ public:
     virtual const std::string& name() const PURE;
   };
 
-  typedef std::unique_ptr<const OverrideLayer> OverrideLayerConstPtr;
+  typedef std::shared_ptr<const OverrideLayer> OverrideLayerConstSharedPtr;
 
   /**
    * Test if a feature is enabled using the built in random generator. This is done by generating
@@ -140,9 +164,20 @@ public:
    * to top; for instance, the second layer's entries override the first layer's entries, and so on.
    * Any layer can add a key in addition to overriding keys in layers below. The layer vector is
    * safe only for the lifetime of the Snapshot.
-   * @return const std::vector<OverrideLayerConstPtr>& the raw map of loaded values.
+   * @return const std::vector<OverrideLayerConstSharedPtr>& the raw map of loaded values.
+   */
+  virtual const std::vector<OverrideLayerConstSharedPtr>& getLayers() const PURE;
+
+  /**
+   * Variants of featureEnabled() and getInteger() taking an interned key, which are cheaper for
+   * keys looked up on every request.
    */
-  virtual const std::vector<OverrideLayerConstPtr>& getLayers() const PURE;
+  virtual bool featureEnabled(const Key& key, uint64_t default_value) const PURE;
+  virtual bool featureEnabled(const Key& key, uint64_t default_value,
+                              uint64_t random_value) const PURE;
+  virtual bool featureEnabled(const Key& key, uint64_t default_value, uint64_t random_value,
+                              uint64_t num_buckets) const PURE;
+  virtual uint64_t getInteger(const Key& key, uint64_t default_value) const PURE;
 };
 
 /**
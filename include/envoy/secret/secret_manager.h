@@ -44,6 +44,14 @@ public:
   virtual CertificateValidationContextConfigProviderSharedPtr
   findStaticCertificateValidationContextProvider(const std::string& name) const PURE;
 
+  /**
+   * @param name a name of the static TlsSessionTicketKeysConfigProvider.
+   * @return the TlsSessionTicketKeysConfigProviderSharedPtr. Returns nullptr if the static session
+   * ticket keys are not found.
+   */
+  virtual TlsSessionTicketKeysConfigProviderSharedPtr
+  findStaticTlsSessionTicketKeysProvider(const std::string& name) const PURE;
+
   /**
    * @param tls_certificate the protobuf config of the TLS certificate.
    * @return a TlsCertificateConfigProviderSharedPtr created from tls_certificate.
@@ -62,6 +70,13 @@ public:
       const envoy::api::v2::auth::CertificateValidationContext& certificate_validation_context)
       PURE;
 
+  /**
+   * @param session_ticket_keys the protobuf config of the session ticket keys.
+   * @return a TlsSessionTicketKeysConfigProviderSharedPtr created from session_ticket_keys.
+   */
+  virtual TlsSessionTicketKeysConfigProviderSharedPtr createInlineTlsSessionTicketKeysProvider(
+      const envoy::api::v2::auth::TlsSessionTicketKeys& session_ticket_keys) PURE;
+
   /**
    * Finds and returns a dynamic secret provider associated to SDS config. Create
    * a new one if such provider does not exist.
@@ -75,6 +90,20 @@ public:
   virtual TlsCertificateConfigProviderSharedPtr findOrCreateTlsCertificateProvider(
       const envoy::api::v2::core::ConfigSource& config_source, const std::string& config_name,
       Server::Configuration::TransportSocketFactoryContext& secret_provider_context) PURE;
+
+  /**
+   * Finds and returns a dynamic session ticket keys provider associated to SDS config. Create a
+   * new one if such provider does not exist.
+   *
+   * @param config_source a protobuf message object containing a SDS config source.
+   * @param config_name a name that uniquely refers to the SDS config source.
+   * @param secret_provider_context context that provides components for creating and initializing
+   * secret provider.
+   * @return TlsSessionTicketKeysConfigProviderSharedPtr the dynamic session ticket keys provider.
+   */
+  virtual TlsSessionTicketKeysConfigProviderSharedPtr findOrCreateTlsSessionTicketKeysProvider(
+      const envoy::api::v2::core::ConfigSource& config_source, const std::string& config_name,
+      Server::Configuration::TransportSocketFactoryContext& secret_provider_context) PURE;
 };
 
 } // namespace Secret
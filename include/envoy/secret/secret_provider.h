@@ -6,6 +6,7 @@
 #include "envoy/common/pure.h"
 #include "envoy/ssl/certificate_validation_context_config.h"
 #include "envoy/ssl/tls_certificate_config.h"
+#include "envoy/ssl/tls_session_ticket_keys_config.h"
 
 namespace Envoy {
 namespace Secret {
@@ -40,5 +41,9 @@ typedef SecretProvider<Ssl::CertificateValidationContextConfig>
 typedef std::shared_ptr<CertificateValidationContextConfigProvider>
     CertificateValidationContextConfigProviderSharedPtr;
 
+typedef SecretProvider<Ssl::TlsSessionTicketKeysConfig> TlsSessionTicketKeysConfigProvider;
+typedef std::shared_ptr<TlsSessionTicketKeysConfigProvider>
+    TlsSessionTicketKeysConfigProviderSharedPtr;
+
 } // namespace Secret
 } // namespace Envoy
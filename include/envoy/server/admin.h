@@ -44,6 +44,15 @@ public:
    * request.
    */
   virtual const Http::HeaderMap& getRequestHeaders() const PURE;
+
+  /**
+   * Continue the response after the handler returned, with chunks produced on later dispatcher
+   * iterations so that large responses do not block the main thread. The continuation appends
+   * the next chunk of the body to the buffer, and returns false once the body is complete.
+   * @param continuation supplies the continuation.
+   */
+  virtual void
+  setResponseContinuation(std::function<bool(Buffer::Instance& response)> continuation) PURE;
 };
 
 /**
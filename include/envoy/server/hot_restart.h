@@ -41,9 +41,13 @@ public:
    * Retrieve a listening socket on the specified address from the parent process. The socket will
    * be duplicated across process boundaries.
    * @param address supplies the address of the socket to duplicate, e.g. tcp://127.0.0.1:5000.
+   * @param worker_index supplies the index of the worker the socket is for. Only listeners with a
+   *        separate SO_REUSEPORT socket per worker have more than one socket per address; for all
+   *        others the shared socket is returned regardless of the index.
    * @return int the fd or -1 if there is no bound listen port in the parent.
    */
-  virtual int duplicateParentListenSocket(const std::string& address) PURE;
+  virtual int duplicateParentListenSocket(const std::string& address,
+                                          uint32_t worker_index) PURE;
 
   /**
    * Retrieve stats from our parent process.
@@ -51,6 +55,14 @@ public:
    */
   virtual void getParentStats(GetParentStatsInfo& info) PURE;
 
+  /**
+   * Retrieve the TLS sessions cached by our parent, so that the clients it served can resume their
+   * sessions with us. See Ssl::ContextManager::exportServerSessions().
+   * @return std::string the serialized sessions, or an empty string if there is no parent or it
+   *         does not support the transfer.
+   */
+  virtual std::string getParentTlsSessions() PURE;
+
   /**
    * Initialize the restarter after primary server initialization begins. The hot restart
    * implementation needs to be created early to deal with shared memory, logging, etc. so
@@ -52,6 +52,31 @@ public:
   createListenSocket(Network::Address::InstanceConstSharedPtr address,
                      const Network::Socket::OptionsSharedPtr& options, bool bind_to_port) PURE;
 
+  /**
+   * Creates an additional bound socket for a listener that has a separate SO_REUSEPORT socket per
+   * worker. createListenSocket() creates the socket of the first worker.
+   * @param address supplies the socket's address.
+   * @param options to be set on the created socket just before calling 'bind()'.
+   * @param worker_index supplies the index of the worker the socket is for.
+   * @return Network::SocketSharedPtr an initialized and bound socket.
+   */
+  virtual Network::SocketSharedPtr
+  createWorkerListenSocket(Network::Address::InstanceConstSharedPtr address,
+                           const Network::Socket::OptionsSharedPtr& options,
+                           uint32_t worker_index) PURE;
+
+  /**
+   * Creates a bound datagram socket. UDP listeners have a separate SO_REUSEPORT socket per worker.
+   * @param address supplies the socket's address.
+   * @param options to be set on the created socket just before calling 'bind()'.
+   * @param worker_index supplies the index of the worker the socket is for.
+   * @return Network::SocketSharedPtr an initialized and bound socket.
+   */
+  virtual Network::SocketSharedPtr
+  createUdpListenSocket(Network::Address::InstanceConstSharedPtr address,
+                        const Network::Socket::OptionsSharedPtr& options,
+                        uint32_t worker_index) PURE;
+
   /**
    * Creates a list of filter factories.
    * @param filters supplies the proto configuration.
@@ -72,6 +97,16 @@ public:
       const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
       Configuration::ListenerFactoryContext& context) PURE;
 
+  /**
+   * Creates a list of UDP listener filter factories.
+   * @param filters supplies the proto configuration.
+   * @param context supplies the factory creation context.
+   * @return std::vector<Network::UdpListenerFilterFactoryCb> the list of filter factories.
+   */
+  virtual std::vector<Network::UdpListenerFilterFactoryCb> createUdpListenerFilterFactoryList(
+      const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
+      Configuration::ListenerFactoryContext& context) PURE;
+
   /**
    * @return DrainManagerPtr a new drain manager.
    * @param drain_type supplies the type of draining to do for the owning listener.
@@ -125,6 +160,16 @@ public:
    */
   virtual std::vector<std::reference_wrapper<Network::ListenerConfig>> listeners() PURE;
 
+  /**
+   * @return std::vector<std::reference_wrapper<Network::ListenerConfig>> the currently loaded
+   * listeners as seen by a single worker, i.e. whose socket() is the socket that worker accepts on.
+   * Listeners with a separate SO_REUSEPORT socket per worker are left out if there is no such
+   * worker. The same lifetime caveats apply as for listeners().
+   * @param worker_index supplies the index of the worker.
+   */
+  virtual std::vector<std::reference_wrapper<Network::ListenerConfig>>
+  workerListeners(uint32_t worker_index) PURE;
+
   /**
    * @return uint64_t the total number of connections owned by all listeners across all workers.
    */
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "envoy/common/pure.h"
 #include "envoy/network/address.h"
@@ -40,6 +41,43 @@ enum class Mode {
   // to be validated in a non-prod environment.
 };
 
+/**
+ * How the probability that a draining listener closes a connection grows over the drain time.
+ */
+enum class DrainCurve {
+  /**
+   * Default curve: the probability grows linearly from 0 to 1.
+   */
+  Linear,
+
+  /**
+   * The probability grows with the square of the elapsed drain time, so that few connections are
+   * closed early in the drain and most toward its end.
+   */
+  Quadratic,
+
+  /**
+   * Connections are closed as soon as the drain sequence starts.
+   */
+  Immediate,
+};
+
+/**
+ * The libevent backend of the event loops of the server.
+ */
+enum class EventLoopBackend {
+  /**
+   * Default backend: libevent picks the best backend of the platform.
+   */
+  Default,
+
+  /**
+   * epoll with the libevent changelist, which coalesces the changes to an fd's events within an
+   * event loop iteration into a single epoll_ctl() call.
+   */
+  EpollChangelist,
+};
+
 /**
  * General options for the server.
  */
@@ -60,11 +98,65 @@ public:
    */
   virtual uint32_t concurrency() const PURE;
 
+  /**
+   * @return const std::vector<uint32_t>& the CPUs to pin worker threads to. Worker i is pinned to
+   *         entry i modulo the number of entries. Empty if workers are not pinned.
+   */
+  virtual const std::vector<uint32_t>& workerCpuAffinity() const PURE;
+
+  /**
+   * @return uint32_t the number of threads that do blocking file and crypto work, such as
+   *         reloading the runtime from disk, off the main and worker threads. 0 if the work runs
+   *         inline.
+   */
+  virtual uint32_t blockingPoolThreads() const PURE;
+
+  /**
+   * @return uint32_t the number of threads that run the private key operations of TLS server
+   *         handshakes. 0 if they run inline on the workers.
+   */
+  virtual uint32_t tlsPrivateKeyThreads() const PURE;
+
+  /**
+   * @return uint32_t the number of TLS sessions to cache for all TLS contexts and workers. 0 if
+   *         client contexts do not resume sessions and server contexts cache sessions on their own.
+   */
+  virtual uint32_t tlsSessionCacheSize() const PURE;
+
+  /**
+   * @return uint32_t the maximum number of listener TLS contexts, built on their first connection,
+   *         to keep built. 0 if listener TLS contexts are built when the listener is created.
+   */
+  virtual uint32_t tlsLazyServerContexts() const PURE;
+
+  /**
+   * @return uint32_t the number of DNS resolutions the server's DNS resolver caches for the TTL of
+   *         their records. 0 if resolutions are not cached.
+   */
+  virtual uint32_t dnsCacheSize() const PURE;
+
+  /**
+   * @return std::chrono::seconds how long cached DNS resolutions are still used for, while they
+   *         are resolved again, once their TTL has expired.
+   */
+  virtual std::chrono::seconds dnsCacheMaxStale() const PURE;
+
   /**
    * @return the number of seconds that envoy will perform draining during a hot restart.
    */
   virtual std::chrono::seconds drainTime() const PURE;
 
+  /**
+   * @return DrainCurve how the probability of closing connections grows over the drain time.
+   */
+  virtual DrainCurve drainCurve() const PURE;
+
+  /**
+   * @return uint32_t the maximum number of connections each worker closes per second because of
+   *         a drain. 0 if drain closes are not paced.
+   */
+  virtual uint32_t drainCloseRate() const PURE;
+
   /**
    * @return const std::string& the path to the configuration file.
    */
@@ -107,6 +199,12 @@ public:
    */
   virtual const std::string& logPath() const PURE;
 
+  /**
+   * @return uint32_t the number of log messages each thread can have waiting to be written by the
+   *         logging thread. 0 if messages are written synchronously by the threads logging them.
+   */
+  virtual uint32_t logRingSize() const PURE;
+
   /**
    * @return the number of seconds that envoy will wait before shutting down the parent envoy during
    *         a host restart. Generally this will be longer than the drainTime() option.
@@ -159,6 +257,39 @@ public:
    * @return bool indicating whether the hot restart functionality has been disabled via cli flags.
    */
   virtual bool hotRestartDisabled() const PURE;
+
+  /**
+   * @return uint32_t the size in megabytes of the huge page backed pool that buffer slices are
+   *         carved from when the slab cache of their thread is empty. 0 if slices are allocated
+   *         from the heap.
+   */
+  virtual uint32_t bufferSlabPoolMb() const PURE;
+
+  /**
+   * @return bool whether buffers use the original libevent buffer implementation.
+   */
+  virtual bool useLibeventBuffers() const PURE;
+
+  /**
+   * @return EventLoopBackend the libevent backend of the event loops.
+   */
+  virtual EventLoopBackend eventLoopBackend() const PURE;
+
+  /**
+   * @return uint64_t the maximum number of bytes a connection reads per read event before
+   *         yielding to other connections. 0 if there is no limit.
+   */
+  virtual uint64_t readBudgetBytes() const PURE;
+
+  /**
+   * @return bool whether configured regexes are compiled with std::regex instead of RE2.
+   */
+  virtual bool useStdRegex() const PURE;
+
+  /**
+   * @return uint32_t the maximum RE2 program size of configured regexes.
+   */
+  virtual uint32_t maxRegexProgramSize() const PURE;
 };
 
 } // namespace Server
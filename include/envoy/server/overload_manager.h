@@ -40,6 +40,19 @@ public:
     return it->second;
   }
 
+  /**
+   * @return const double& the scaled value of the action in [0, 1], for actions that are applied
+   *         proportionally to the pressure of their resources. It is 1 when the action is active.
+   *         The reference stays valid for the lifetime of this object.
+   */
+  const double& getScaledValue(const std::string& action) {
+    auto it = scaled_values_.find(action);
+    if (it == scaled_values_.end()) {
+      it = scaled_values_.insert(std::make_pair(action, 0.0)).first;
+    }
+    return it->second;
+  }
+
   void setState(const std::string& action, OverloadActionState state) {
     auto it = actions_.find(action);
     if (it == actions_.end()) {
@@ -49,8 +62,11 @@ public:
     }
   }
 
+  void setScaledValue(const std::string& action, double value) { scaled_values_[action] = value; }
+
 private:
   std::unordered_map<std::string, OverloadActionState> actions_;
+  std::unordered_map<std::string, double> scaled_values_;
 };
 
 /**
@@ -60,6 +76,20 @@ class OverloadActionNameValues {
 public:
   // Overload action to stop accepting new requests.
   const std::string StopAcceptingRequests = "envoy.overload_actions.stop_accepting_requests";
+
+  // Overload action to stop accepting new connections.
+  const std::string StopAcceptingConnections = "envoy.overload_actions.stop_accepting_connections";
+
+  // Overload action to shrink the idle timeout of HTTP connections in proportion to its scaled
+  // value.
+  const std::string ReduceTimeouts = "envoy.overload_actions.reduce_timeouts";
+
+  // Overload action to reset the streams and connections buffering the most memory.
+  const std::string ResetHighMemoryStreams = "envoy.overload_actions.reset_high_memory_streams";
+
+  // Overload action to advance drain sequences at half speed, so that clients reconnect more
+  // slowly.
+  const std::string SlowDrain = "envoy.overload_actions.slow_drain";
 };
 
 typedef ConstSingleton<OverloadActionNameValues> OverloadActionNames;
@@ -106,6 +136,12 @@ public:
   static const OverloadActionState& getInactiveState() {
     CONSTRUCT_ON_FIRST_USE(OverloadActionState, OverloadActionState::Inactive);
   }
+
+  /**
+   * Convenience method to get a statically allocated reference to the scaled value of an
+   * inactive overload action. @see getInactiveState().
+   */
+  static const double& getInactiveScaledValue() { CONSTRUCT_ON_FIRST_USE(double, 0.0); }
 };
 
 } // namespace Server
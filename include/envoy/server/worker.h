@@ -1,8 +1,11 @@
 #pragma once
 
 #include <functional>
+#include <unordered_set>
 
+#include "envoy/network/filter.h"
 #include "envoy/server/guarddog.h"
+#include "envoy/server/overload_manager.h"
 
 namespace Envoy {
 namespace Server {
@@ -56,6 +59,20 @@ public:
   virtual void removeListener(Network::ListenerConfig& listener,
                               std::function<void()> completion) PURE;
 
+  /**
+   * Close the connections of a stopped listener that were created from any of the given filter
+   * chains, and remove the listener once its remaining connections have closed on their own. This
+   * is used when a listener update leaves some of its filter chains unchanged.
+   * @param listener supplies the listener.
+   * @param filter_chains supplies the filter chains whose connections to close.
+   * @param completion supplies the completion to be called when the listener has been removed.
+   *        This completion is called on the worker thread. No locking is performed by the worker.
+   */
+  virtual void
+  removeFilterChains(Network::ListenerConfig& listener,
+                     const std::unordered_set<const Network::FilterChain*>& filter_chains,
+                     std::function<void()> completion) PURE;
+
   /**
    * Stop a listener from accepting new connections. This is used for server draining.
    * @param listener supplies the listener to stop.
@@ -82,9 +99,11 @@ public:
   virtual ~WorkerFactory() {}
 
   /**
+   * @param overload_manager supplies the server's overload manager, which the worker registers
+   *        with for the overload actions it implements.
    * @return WorkerPtr a new worker.
    */
-  virtual WorkerPtr createWorker() PURE;
+  virtual WorkerPtr createWorker(OverloadManager& overload_manager) PURE;
 };
 
 } // namespace Server
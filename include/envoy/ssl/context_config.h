@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -8,9 +9,23 @@
 #include "envoy/ssl/certificate_validation_context_config.h"
 #include "envoy/ssl/tls_certificate_config.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Ssl {
 
+/**
+ * Sizing of the records sent while a connection ramps up.
+ */
+struct DynamicRecordSizing {
+  // The plaintext size of records sent while ramping up, or 0 to fit them in a TCP segment.
+  uint32_t small_record_size_;
+  // The number of bytes sent in small records before sending full size records.
+  uint64_t ramp_up_bytes_;
+  // The time without sending after which the connection ramps up again.
+  std::chrono::milliseconds idle_timeout_;
+};
+
 /**
  * Supplies the configuration for an SSL context.
  */
@@ -60,12 +75,29 @@ public:
    */
   virtual unsigned maxProtocolVersion() const PURE;
 
+  /**
+   * @return true if the kernel should encrypt the records sent once the handshake completed.
+   */
+  virtual bool kernelTlsOffload() const PURE;
+
+  /**
+   * @return the sizing of the records sent while connections ramp up, or nullopt if connections
+   *         always send full size records.
+   */
+  virtual const absl::optional<DynamicRecordSizing>& dynamicRecordSizing() const PURE;
+
   /**
    * @return true if the ContextConfig is able to provide secrets to create SSL context,
    * and false if dynamic secrets are expected but are not downloaded from SDS server yet.
    */
   virtual bool isReady() const PURE;
 
+  /**
+   * @return true if secrets are fetched from an SDS server, and so may change after contexts have
+   *         been created from the ContextConfig.
+   */
+  virtual bool hasDynamicSecrets() const PURE;
+
   /**
    * Add secret callback into context config. When dynamic secrets are in use and new secrets
    * are downloaded from SDS server, this callback is invoked to update SSL context.
@@ -109,6 +141,14 @@ public:
    * are candidates for decrypting received tickets.
    */
   virtual const std::vector<SessionTicketKey>& sessionTicketKeys() const PURE;
+
+  /**
+   * Add a callback that is run on the main thread when the session ticket keys were updated, which
+   * only happens for keys delivered via SDS. Contexts should then swap in the new keys, rather than
+   * being recreated.
+   * @param callback supplies the callback. It replaces any callback added before.
+   */
+  virtual void setSessionTicketKeysUpdateCallback(std::function<void()> callback) PURE;
 };
 
 typedef std::unique_ptr<ServerContextConfig> ServerContextConfigPtr;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <string>
 
 #include "envoy/ssl/context.h"
 #include "envoy/ssl/context_config.h"
@@ -9,6 +11,23 @@
 namespace Envoy {
 namespace Ssl {
 
+/**
+ * A ServerContext that is only built when first needed, and that its ContextManager may release
+ * again while it is unused.
+ */
+class LazyServerContext {
+public:
+  virtual ~LazyServerContext() {}
+
+  /**
+   * Get the context, building it first if it is not built yet. May be called from any thread.
+   * @return ServerContextSharedPtr the context, or nullptr if it could not be built.
+   */
+  virtual ServerContextSharedPtr get() PURE;
+};
+
+typedef std::unique_ptr<LazyServerContext> LazyServerContextPtr;
+
 /**
  * Manages all of the SSL contexts in the process
  */
@@ -29,6 +48,15 @@ public:
   createSslServerContext(Stats::Scope& scope, const ServerContextConfig& config,
                          const std::vector<std::string>& server_names) PURE;
 
+  /**
+   * Creates a LazyServerContext for a ServerContextConfig whose secrets do not change.
+   * @return LazyServerContextPtr the lazy context, or nullptr if server contexts are built
+   *         eagerly, with createSslServerContext().
+   */
+  virtual LazyServerContextPtr
+  createLazySslServerContext(Stats::Scope& scope, const ServerContextConfig& config,
+                             const std::vector<std::string>& server_names) PURE;
+
   /**
    * @return the number of days until the next certificate being managed will expire.
    */
@@ -38,6 +66,21 @@ public:
    * Iterate through all currently allocated contexts.
    */
   virtual void iterateContexts(std::function<void(const Context&)> callback) PURE;
+
+  /**
+   * Serialize the cached sessions of the server contexts, so that another process can resume
+   * them, e.g. across a hot restart.
+   * @return std::string the serialized sessions, which are only meaningful to
+   *         importServerSessions() on the same host.
+   */
+  virtual std::string exportServerSessions() PURE;
+
+  /**
+   * Cache the sessions serialized by exportServerSessions() for the server contexts to resume.
+   * Sessions that cannot be parsed are ignored.
+   * @param sessions supplies the serialized sessions.
+   */
+  virtual void importServerSessions(const std::string& sessions) PURE;
 };
 
 } // namespace Ssl
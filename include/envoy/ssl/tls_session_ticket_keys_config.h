@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "envoy/common/pure.h"
+#include "envoy/ssl/context_config.h"
+
+namespace Envoy {
+namespace Ssl {
+
+class TlsSessionTicketKeysConfig {
+public:
+  virtual ~TlsSessionTicketKeysConfig() {}
+
+  /**
+   * @return The keys to use for encrypting and decrypting session tickets. The first element is
+   * used for encrypting new tickets, and all elements are candidates for decrypting received
+   * tickets.
+   */
+  virtual const std::vector<ServerContextConfig::SessionTicketKey>& keys() const PURE;
+};
+
+typedef std::unique_ptr<TlsSessionTicketKeysConfig> TlsSessionTicketKeysConfigPtr;
+
+} // namespace Ssl
+} // namespace Envoy
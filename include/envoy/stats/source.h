@@ -14,6 +14,22 @@
 namespace Envoy {
 namespace Stats {
 
+/**
+ * A used counter and the amount it was incremented by since the previous flush.
+ */
+struct CounterSnapshot {
+  std::reference_wrapper<const Counter> counter_;
+  uint64_t delta_;
+};
+
+/**
+ * A used gauge and its value at the time of the flush.
+ */
+struct GaugeSnapshot {
+  std::reference_wrapper<const Gauge> gauge_;
+  uint64_t value_;
+};
+
 /**
  * Provides cached access to a particular store's stats.
  */
@@ -45,6 +61,30 @@ public:
    */
   virtual const std::vector<ParentHistogramSharedPtr>& cachedHistograms() PURE;
 
+  /**
+   * Returns the used counters, each with the amount it was incremented by since the previous
+   * flush. The counters are latched once, when this is first called after clearCache(), so that
+   * every sink observes the same deltas. Sinks should use this rather than latching counters
+   * themselves.
+   * @return std::vector<CounterSnapshot>& the counter snapshots. Note: reference may not be valid
+   * after clearCache() is called.
+   */
+  virtual const std::vector<CounterSnapshot>& cachedCounterSnapshots() PURE;
+
+  /**
+   * Returns the used gauges, each with its value when this is first called after clearCache().
+   * @return std::vector<GaugeSnapshot>& the gauge snapshots. Note: reference may not be valid
+   * after clearCache() is called.
+   */
+  virtual const std::vector<GaugeSnapshot>& cachedGaugeSnapshots() PURE;
+
+  /**
+   * Sets whether snapshots only include the counters that were incremented and the gauges whose
+   * value changed since the previous snapshot.
+   * @param changed_only supplies whether unchanged metrics are left out of snapshots.
+   */
+  virtual void setChangedMetricsOnly(bool changed_only) PURE;
+
   /**
    * Resets the cache so that any future calls to get cached metrics will refresh the set.
    */
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+namespace Stats {
+
+class StatsMatcher {
+public:
+  virtual ~StatsMatcher() {}
+
+  /**
+   * Take a metric name and report whether or not it should be rejected, i.e. not created.
+   * @param name std::string the full name of a Stats::Metric (Counter, Gauge, Histogram).
+   * @return bool whether the metric should be rejected.
+   */
+  virtual bool rejects(const std::string& name) const PURE;
+};
+
+typedef std::unique_ptr<const StatsMatcher> StatsMatcherPtr;
+
+} // namespace Stats
+} // namespace Envoy
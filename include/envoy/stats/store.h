@@ -6,6 +6,7 @@
 
 #include "envoy/common/pure.h"
 #include "envoy/stats/scope.h"
+#include "envoy/stats/stats_matcher.h"
 #include "envoy/stats/tag_producer.h"
 
 namespace Envoy {
@@ -66,6 +67,21 @@ public:
    */
   virtual void setTagProducer(TagProducerPtr&& tag_producer) PURE;
 
+  /**
+   * Limit the number of counters and gauges whose names start with a prefix. Once the limit is
+   * reached, further counters and gauges under the prefix are neither stored nor flushed, and
+   * updates to them are discarded. Stats freed along with their scope make room again.
+   * @param prefix supplies the name prefix.
+   * @param max_stats supplies the most counters and gauges to store under the prefix.
+   */
+  virtual void setCardinalityLimit(const std::string& prefix, uint64_t max_stats) PURE;
+
+  /**
+   * Set the given stats matcher to control which stats are created. Stats it rejects are handed
+   * out as stand-ins that are neither stored nor flushed, and discard their updates.
+   */
+  virtual void setStatsMatcher(StatsMatcherPtr&& stats_matcher) PURE;
+
   /**
    * Initialize the store for threading. This will be called once after all worker threads have
    * been initialized. At this point the store can initialize itself for multi-threaded operation.
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "envoy/common/pure.h"
+#include "envoy/event/dispatcher.h"
+
+namespace Envoy {
+namespace Thread {
+
+/**
+ * Handle to work posted to a BlockingPool. Destroying the handle cancels the work if it has not
+ * started yet, and waits for it if it is running, so that neither the work nor its completion
+ * callback run afterwards. The owner of the state the work touches should hold the handle.
+ */
+class BlockingWork {
+public:
+  virtual ~BlockingWork() {}
+};
+
+typedef std::unique_ptr<BlockingWork> BlockingWorkPtr;
+
+/**
+ * A bounded set of background threads shared by the subsystems that do blocking work, such as
+ * reading files from disk or parsing certificates and keys, so that disk and crypto stalls do not
+ * block xDS processing on the main thread or the event loops of the workers.
+ */
+class BlockingPool {
+public:
+  virtual ~BlockingPool() {}
+
+  /**
+   * Run work on one of the threads, then run a completion callback on a dispatcher.
+   * @param work supplies the blocking work. It must not throw, and must not touch state that is
+   *        not safe to access from other threads. The results should be left in state shared
+   *        with the completion callback.
+   * @param dispatcher supplies the dispatcher on which the completion callback is run.
+   * @param on_complete supplies the completion callback.
+   * @return BlockingWorkPtr the handle to the work, which cancels it once destroyed.
+   */
+  virtual BlockingWorkPtr post(std::function<void()> work, Event::Dispatcher& dispatcher,
+                               std::function<void()> on_complete) PURE;
+};
+
+} // namespace Thread
+} // namespace Envoy
@@ -64,6 +64,15 @@ public:
    */
   typedef std::function<ThreadLocalObjectSharedPtr(Event::Dispatcher& dispatcher)> InitializeCb;
   virtual void set(InitializeCb cb) PURE;
+
+  /**
+   * Publish a single object to all threads previously registered via registerThread(). Unlike
+   * set(), nothing is posted to the threads: each thread picks the object up on its next get(),
+   * and releases the object it held before at that point. The object is shared by all threads
+   * and must be safe to use concurrently, typically by being immutable.
+   * @param object supplies the object to publish.
+   */
+  virtual void publish(ThreadLocalObjectSharedPtr object) PURE;
 };
 
 typedef std::unique_ptr<Slot> SlotPtr;
@@ -107,6 +107,12 @@ public:
    * @param sampled whether the span and any subsequent child spans should be sampled
    */
   virtual void setSampled(bool sampled) PURE;
+
+  /**
+   * @return whether the span may be reported to the tracing system. Tags of spans that are not
+   *         sampled are dropped, so callers may skip building them.
+   */
+  virtual bool sampled() const PURE;
 };
 
 /**
@@ -9,6 +9,7 @@
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/v2/cds.pb.h"
 #include "envoy/config/bootstrap/v2/bootstrap.pb.h"
+#include "envoy/config/decode_pool.h"
 #include "envoy/config/grpc_mux.h"
 #include "envoy/grpc/async_client_manager.h"
 #include "envoy/http/async_client.h"
@@ -183,6 +184,12 @@ public:
    */
   virtual Config::GrpcMux& adsMux() PURE;
 
+  /**
+   * @return Config::DecodePool& the pool that the xDS APIs unpack and validate the resources of
+   *         their updates on.
+   */
+  virtual Config::DecodePool& xdsDecodePool() PURE;
+
   /**
    * @return Grpc::AsyncClientManager& the cluster manager's gRPC client manager.
    */
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
 
@@ -9,6 +10,8 @@
 #include "envoy/upstream/health_check_host_monitor.h"
 #include "envoy/upstream/outlier_detection.h"
 
+#include "common/protobuf/utility.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -40,6 +43,13 @@ struct HostStats {
 
 class ClusterInfo;
 
+/**
+ * The values of a host's envoy.lb metadata by key. The values are hashed when the metadata is set,
+ * so that load balancers compare them without walking the metadata.
+ */
+typedef std::map<std::string, HashedValue> LbMetadata;
+typedef std::shared_ptr<const LbMetadata> LbMetadataConstSharedPtr;
+
 /**
  * A description of an upstream host.
  */
@@ -67,6 +77,12 @@ public:
    */
   virtual void metadata(const envoy::api::v2::core::Metadata& new_metadata) PURE;
 
+  /**
+   * @return the envoy.lb metadata of the host, extracted from the current metadata when it was
+   *         set. Never nullptr.
+   */
+  virtual LbMetadataConstSharedPtr lbMetadata() const PURE;
+
   /**
    * @return the cluster the host is a member of.
    */
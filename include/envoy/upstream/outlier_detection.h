@@ -82,6 +82,13 @@ public:
    *         or the cluster did not have enough hosts to run through success rate outlier ejection.
    */
   virtual double successRate() const PURE;
+
+  /**
+   * @return the exponentially weighted moving average of the response time of the host over the
+   *         calculated intervals, in milliseconds. -1 means that the host has not yet had enough
+   *         request volume in an interval to calculate it.
+   */
+  virtual double latency() const PURE;
 };
 
 typedef std::unique_ptr<DetectorHostMonitor> DetectorHostMonitorPtr;
@@ -120,11 +127,26 @@ public:
    *         proceed with success rate based outlier ejection.
    */
   virtual double successRateEjectionThreshold() const PURE;
+
+  /**
+   * Returns the average latency of the hosts in the Detector for the last aggregation interval.
+   * @return the average latency in milliseconds, or -1 if there were not enough hosts with enough
+   *         request volume to proceed with latency based outlier ejection.
+   */
+  virtual double latencyAverage() const PURE;
+
+  /**
+   * Returns the latency threshold used in the last interval. The threshold is used to eject hosts
+   * based on their latency.
+   * @return the threshold in milliseconds, or -1 if there were not enough hosts with enough
+   *         request volume to proceed with latency based outlier ejection.
+   */
+  virtual double latencyEjectionThreshold() const PURE;
 };
 
 typedef std::shared_ptr<Detector> DetectorSharedPtr;
 
-enum class EjectionType { Consecutive5xx, SuccessRate, ConsecutiveGatewayFailure };
+enum class EjectionType { Consecutive5xx, SuccessRate, ConsecutiveGatewayFailure, Latency };
 
 /**
  * Sink for outlier detection event logs.
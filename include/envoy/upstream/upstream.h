@@ -243,6 +243,30 @@ public:
    */
   virtual const HostsPerLocality& healthyHostsPerLocality() const PURE;
 
+  /**
+   * The shared accessors below return the immutable lists backing hosts(), healthyHosts(),
+   * hostsPerLocality() and healthyHostsPerLocality(). They let the lists be handed to other
+   * threads without copying them; an update replaces the lists rather than mutating them.
+   * @return HostVectorConstSharedPtr all hosts that make up the set at the current time.
+   */
+  virtual HostVectorConstSharedPtr hostsPtr() const PURE;
+
+  /**
+   * @return HostVectorConstSharedPtr all healthy hosts contained in the set at the current time.
+   */
+  virtual HostVectorConstSharedPtr healthyHostsPtr() const PURE;
+
+  /**
+   * @return HostsPerLocalityConstSharedPtr hosts per locality.
+   */
+  virtual HostsPerLocalityConstSharedPtr hostsPerLocalityPtr() const PURE;
+
+  /**
+   * @return HostsPerLocalityConstSharedPtr same as hostsPerLocalityPtr but only contains healthy
+   *         hosts.
+   */
+  virtual HostsPerLocalityConstSharedPtr healthyHostsPerLocalityPtr() const PURE;
+
   /**
    * @return weights for each locality in the host set.
    */
@@ -326,6 +350,7 @@ public:
 // clang-format off
 #define ALL_CLUSTER_STATS(COUNTER, GAUGE, HISTOGRAM)                                               \
   COUNTER  (lb_healthy_panic)                                                                      \
+  COUNTER  (lb_hash_bounded_load_fallback)                                                         \
   COUNTER  (lb_local_cluster_not_ok)                                                               \
   COUNTER  (lb_recalculate_zone_structures)                                                        \
   COUNTER  (lb_zone_cluster_too_small)                                                             \
@@ -349,8 +374,10 @@ public:
   COUNTER  (upstream_cx_idle_timeout)                                                              \
   COUNTER  (upstream_cx_connect_attempts_exceeded)                                                 \
   COUNTER  (upstream_cx_overflow)                                                                  \
+  COUNTER  (upstream_cx_prefetch)                                                                  \
   HISTOGRAM(upstream_cx_connect_ms)                                                                \
   HISTOGRAM(upstream_cx_length_ms)                                                                 \
+  HISTOGRAM(upstream_cx_http2_streams)                                                             \
   COUNTER  (upstream_cx_destroy)                                                                   \
   COUNTER  (upstream_cx_destroy_local)                                                             \
   COUNTER  (upstream_cx_destroy_remote)                                                            \
@@ -362,6 +389,10 @@ public:
   GAUGE    (upstream_cx_rx_bytes_buffered)                                                         \
   COUNTER  (upstream_cx_tx_bytes_total)                                                            \
   GAUGE    (upstream_cx_tx_bytes_buffered)                                                         \
+  COUNTER  (upstream_cx_read_budget_exhausted)                                                     \
+  COUNTER  (upstream_cx_tx_buffer_above_high_watermark_ms)                                         \
+  COUNTER  (upstream_cx_connect_fallback)                                                          \
+  COUNTER  (upstream_cx_tfo_syn_data_acked)                                                        \
   COUNTER  (upstream_cx_protocol_error)                                                            \
   COUNTER  (upstream_cx_max_requests)                                                              \
   COUNTER  (upstream_cx_none_healthy)                                                              \
@@ -371,6 +402,7 @@ public:
   COUNTER  (upstream_rq_pending_total)                                                             \
   COUNTER  (upstream_rq_pending_overflow)                                                          \
   COUNTER  (upstream_rq_pending_failure_eject)                                                     \
+  COUNTER  (upstream_rq_pending_dropped)                                                           \
   GAUGE    (upstream_rq_pending_active)                                                            \
   COUNTER  (upstream_rq_cancelled)                                                                 \
   COUNTER  (upstream_rq_maintenance_mode)                                                          \
@@ -381,6 +413,8 @@ public:
   COUNTER  (upstream_rq_retry)                                                                     \
   COUNTER  (upstream_rq_retry_success)                                                             \
   COUNTER  (upstream_rq_retry_overflow)                                                            \
+  COUNTER  (upstream_rq_hedged)                                                                    \
+  COUNTER  (upstream_rq_hedge_won)                                                                 \
   COUNTER  (upstream_flow_control_paused_reading_total)                                            \
   COUNTER  (upstream_flow_control_resumed_reading_total)                                           \
   COUNTER  (upstream_flow_control_backed_up_total)                                                 \
@@ -396,6 +430,7 @@ public:
   COUNTER  (update_failure)                                                                        \
   COUNTER  (update_empty)                                                                          \
   COUNTER  (update_no_rebuild)                                                                     \
+  COUNTER  (update_coalesced)                                                                      \
   GAUGE    (version)
 // clang-format on
 
@@ -434,6 +469,17 @@ public:
 };
 typedef std::shared_ptr<const ProtocolOptionsConfig> ProtocolOptionsConfigConstSharedPtr;
 
+/**
+ * Bounds on the time requests wait in a connection pool for a connection. @see
+ * envoy::api::v2::Cluster::PendingRequestQueue.
+ */
+struct PendingRequestQueueConfig {
+  // The time a request may wait while the pool is overloaded.
+  std::chrono::milliseconds target_delay_;
+  // How long the queue may stay non-empty before the pool is considered overloaded.
+  std::chrono::milliseconds interval_;
+};
+
 /**
  * Information about a given upstream cluster.
  */
@@ -447,6 +493,8 @@ public:
     static const uint64_t USE_DOWNSTREAM_PROTOCOL = 0x2;
     // Whether connections should be immediately closed upon health failure.
     static const uint64_t CLOSE_CONNECTIONS_ON_HOST_HEALTH_FAILURE = 0x4;
+    // Whether TCP QUICKACK is enabled on connections to the upstream.
+    static const uint64_t TCP_QUICK_ACK = 0x8;
   };
 
   virtual ~ClusterInfo() {}
@@ -472,6 +520,12 @@ public:
    */
   virtual uint32_t perConnectionBufferLimitBytes() const PURE;
 
+  /**
+   * @return the largest limit the write buffers of the cluster's connections may grow to, or 0 if
+   *         their limit is not auto tuned. @see Network::Connection::setBufferLimitAutoTuning().
+   */
+  virtual uint32_t perConnectionBufferLimitMaxBytes() const PURE;
+
   /**
    * @return uint64_t features supported by the cluster. @see Features.
    */
@@ -517,6 +571,13 @@ public:
   virtual const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>&
   lbRingHashConfig() const PURE;
 
+  /**
+   * @return configuration for least request load balancing, only used if type is set to
+   *         least_request_lb.
+   */
+  virtual const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig>&
+  lbLeastRequestConfig() const PURE;
+
   /**
    * @return const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>& the configuration
    *         for the Original Destination load balancing policy, only used if type is set to
@@ -540,6 +601,17 @@ public:
    */
   virtual uint64_t maxRequestsPerConnection() const PURE;
 
+  /**
+   * @return float the ratio of connections that a connection pool keeps open or connecting to the
+   *         requests it is serving or has queued. 1 indicates that no connections are prefetched.
+   */
+  virtual float prefetchRatio() const PURE;
+
+  /**
+   * @return the bounds on the time requests wait in a connection pool for a connection, if any.
+   */
+  virtual const absl::optional<PendingRequestQueueConfig>& pendingRequestQueue() const PURE;
+
   /**
    * @return the human readable name of the cluster.
    */
@@ -603,6 +675,13 @@ public:
    */
   virtual bool drainConnectionsOnHostRemoval() const PURE;
 
+  /**
+   * @return absl::optional<uint64_t> a key that is the same for all clusters whose connection
+   *         pools may be shared for hosts with the same address, or no key if the cluster's pools
+   *         are not shared.
+   */
+  virtual absl::optional<uint64_t> sharedConnPoolKey() const PURE;
+
 protected:
   /**
    * Invoked by extensionProtocolOptionsTyped.
@@ -634,6 +713,7 @@ public:
    *         returns nullptr.
    */
   virtual HealthChecker* healthChecker() PURE;
+  virtual const HealthChecker* healthChecker() const PURE;
 
   /**
    * @return the information about this upstream cluster.
@@ -63,13 +63,19 @@ std::string FormatterImpl::format(const Http::HeaderMap& request_headers,
                                   const RequestInfo::RequestInfo& request_info) const {
   std::string log_line;
   log_line.reserve(256);
+  formatInto(request_headers, response_headers, response_trailers, request_info, log_line);
+  return log_line;
+}
 
+void FormatterImpl::formatInto(const Http::HeaderMap& request_headers,
+                               const Http::HeaderMap& response_headers,
+                               const Http::HeaderMap& response_trailers,
+                               const RequestInfo::RequestInfo& request_info,
+                               std::string& output) const {
   for (const FormatterPtr& formatter : formatters_) {
-    log_line +=
-        formatter->format(request_headers, response_headers, response_trailers, request_info);
+    formatter->formatInto(request_headers, response_headers, response_trailers, request_info,
+                          output);
   }
-
-  return log_line;
 }
 
 void AccessLogFormatParser::parseCommandHeader(const std::string& token, const size_t start,
@@ -320,6 +326,13 @@ std::string RequestInfoFormatter::format(const Http::HeaderMap&, const Http::Hea
   return field_extractor_(request_info);
 }
 
+void RequestInfoFormatter::formatInto(const Http::HeaderMap&, const Http::HeaderMap&,
+                                      const Http::HeaderMap&,
+                                      const RequestInfo::RequestInfo& request_info,
+                                      std::string& output) const {
+  output += field_extractor_(request_info);
+}
+
 PlainStringFormatter::PlainStringFormatter(const std::string& str) : str_(str) {}
 
 std::string PlainStringFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
@@ -328,30 +341,40 @@ std::string PlainStringFormatter::format(const Http::HeaderMap&, const Http::Hea
   return str_;
 }
 
+void PlainStringFormatter::formatInto(const Http::HeaderMap&, const Http::HeaderMap&,
+                                      const Http::HeaderMap&, const RequestInfo::RequestInfo&,
+                                      std::string& output) const {
+  output += str_;
+}
+
 HeaderFormatter::HeaderFormatter(const std::string& main_header,
                                  const std::string& alternative_header,
                                  absl::optional<size_t> max_length)
     : main_header_(main_header), alternative_header_(alternative_header), max_length_(max_length) {}
 
 std::string HeaderFormatter::format(const Http::HeaderMap& headers) const {
+  std::string header_value_string;
+  formatInto(headers, header_value_string);
+  return header_value_string;
+}
+
+void HeaderFormatter::formatInto(const Http::HeaderMap& headers, std::string& output) const {
   const Http::HeaderEntry* header = headers.get(main_header_);
 
   if (!header && !alternative_header_.get().empty()) {
     header = headers.get(alternative_header_);
   }
 
-  std::string header_value_string;
-  if (!header) {
-    header_value_string = UnspecifiedValueString;
-  } else {
-    header_value_string = header->value().c_str();
+  absl::string_view header_value = UnspecifiedValueString;
+  if (header) {
+    header_value = header->value().getStringView();
   }
 
-  if (max_length_ && header_value_string.length() > max_length_.value()) {
-    return header_value_string.substr(0, max_length_.value());
+  if (max_length_ && header_value.length() > max_length_.value()) {
+    header_value = header_value.substr(0, max_length_.value());
   }
 
-  return header_value_string;
+  output.append(header_value.data(), header_value.length());
 }
 
 ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
@@ -366,6 +389,13 @@ std::string ResponseHeaderFormatter::format(const Http::HeaderMap&,
   return HeaderFormatter::format(response_headers);
 }
 
+void ResponseHeaderFormatter::formatInto(const Http::HeaderMap&,
+                                         const Http::HeaderMap& response_headers,
+                                         const Http::HeaderMap&, const RequestInfo::RequestInfo&,
+                                         std::string& output) const {
+  HeaderFormatter::formatInto(response_headers, output);
+}
+
 RequestHeaderFormatter::RequestHeaderFormatter(const std::string& main_header,
                                                const std::string& alternative_header,
                                                absl::optional<size_t> max_length)
@@ -377,6 +407,13 @@ std::string RequestHeaderFormatter::format(const Http::HeaderMap& request_header
   return HeaderFormatter::format(request_headers);
 }
 
+void RequestHeaderFormatter::formatInto(const Http::HeaderMap& request_headers,
+                                        const Http::HeaderMap&, const Http::HeaderMap&,
+                                        const RequestInfo::RequestInfo&,
+                                        std::string& output) const {
+  HeaderFormatter::formatInto(request_headers, output);
+}
+
 ResponseTrailerFormatter::ResponseTrailerFormatter(const std::string& main_header,
                                                    const std::string& alternative_header,
                                                    absl::optional<size_t> max_length)
@@ -388,6 +425,13 @@ std::string ResponseTrailerFormatter::format(const Http::HeaderMap&, const Http:
   return HeaderFormatter::format(response_trailers);
 }
 
+void ResponseTrailerFormatter::formatInto(const Http::HeaderMap&, const Http::HeaderMap&,
+                                          const Http::HeaderMap& response_trailers,
+                                          const RequestInfo::RequestInfo&,
+                                          std::string& output) const {
+  HeaderFormatter::formatInto(response_trailers, output);
+}
+
 MetadataFormatter::MetadataFormatter(const std::string& filter_namespace,
                                      const std::vector<std::string>& path,
                                      absl::optional<size_t> max_length)
@@ -430,6 +474,13 @@ std::string DynamicMetadataFormatter::format(const Http::HeaderMap&, const Http:
   return MetadataFormatter::format(request_info.dynamicMetadata());
 }
 
+void DynamicMetadataFormatter::formatInto(const Http::HeaderMap&, const Http::HeaderMap&,
+                                          const Http::HeaderMap&,
+                                          const RequestInfo::RequestInfo& request_info,
+                                          std::string& output) const {
+  output += MetadataFormatter::format(request_info.dynamicMetadata());
+}
+
 StartTimeFormatter::StartTimeFormatter(const std::string& format) : date_formatter_(format) {}
 
 std::string StartTimeFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
@@ -442,5 +493,13 @@ std::string StartTimeFormatter::format(const Http::HeaderMap&, const Http::Heade
   }
 }
 
+void StartTimeFormatter::formatInto(const Http::HeaderMap& request_headers,
+                                    const Http::HeaderMap& response_headers,
+                                    const Http::HeaderMap& response_trailers,
+                                    const RequestInfo::RequestInfo& request_info,
+                                    std::string& output) const {
+  output += format(request_headers, response_headers, response_trailers, request_info);
+}
+
 } // namespace AccessLog
 } // namespace Envoy
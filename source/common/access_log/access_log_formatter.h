@@ -93,6 +93,9 @@ public:
                      const Http::HeaderMap& response_headers,
                      const Http::HeaderMap& response_trailers,
                      const RequestInfo::RequestInfo& request_info) const override;
+  void formatInto(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
+                  const Http::HeaderMap& response_trailers,
+                  const RequestInfo::RequestInfo& request_info, std::string& output) const override;
 
 private:
   std::vector<FormatterPtr> formatters_;
@@ -109,6 +112,8 @@ public:
   // Formatter::format
   std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
                      const RequestInfo::RequestInfo&) const override;
+  void formatInto(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const RequestInfo::RequestInfo&, std::string& output) const override;
 
 private:
   std::string str_;
@@ -120,6 +125,7 @@ public:
                   absl::optional<size_t> max_length);
 
   std::string format(const Http::HeaderMap& headers) const;
+  void formatInto(const Http::HeaderMap& headers, std::string& output) const;
 
 private:
   Http::LowerCaseString main_header_;
@@ -138,6 +144,9 @@ public:
   // Formatter::format
   std::string format(const Http::HeaderMap& request_headers, const Http::HeaderMap&,
                      const Http::HeaderMap&, const RequestInfo::RequestInfo&) const override;
+  void formatInto(const Http::HeaderMap& request_headers, const Http::HeaderMap&,
+                  const Http::HeaderMap&, const RequestInfo::RequestInfo&,
+                  std::string& output) const override;
 };
 
 /**
@@ -151,6 +160,9 @@ public:
   // Formatter::format
   std::string format(const Http::HeaderMap&, const Http::HeaderMap& response_headers,
                      const Http::HeaderMap&, const RequestInfo::RequestInfo&) const override;
+  void formatInto(const Http::HeaderMap&, const Http::HeaderMap& response_headers,
+                  const Http::HeaderMap&, const RequestInfo::RequestInfo&,
+                  std::string& output) const override;
 };
 
 /**
@@ -165,6 +177,9 @@ public:
   std::string format(const Http::HeaderMap&, const Http::HeaderMap&,
                      const Http::HeaderMap& response_trailers,
                      const RequestInfo::RequestInfo&) const override;
+  void formatInto(const Http::HeaderMap&, const Http::HeaderMap&,
+                  const Http::HeaderMap& response_trailers, const RequestInfo::RequestInfo&,
+                  std::string& output) const override;
 };
 
 /**
@@ -177,6 +192,8 @@ public:
   // Formatter::format
   std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
                      const RequestInfo::RequestInfo& request_info) const override;
+  void formatInto(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const RequestInfo::RequestInfo& request_info, std::string& output) const override;
 
 private:
   std::function<std::string(const RequestInfo::RequestInfo&)> field_extractor_;
@@ -209,6 +226,8 @@ public:
   // Formatter::format
   std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
                      const RequestInfo::RequestInfo& request_info) const override;
+  void formatInto(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const RequestInfo::RequestInfo& request_info, std::string& output) const override;
 };
 
 /**
@@ -219,6 +238,8 @@ public:
   StartTimeFormatter(const std::string& format);
   std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
                      const RequestInfo::RequestInfo&) const override;
+  void formatInto(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const RequestInfo::RequestInfo& request_info, std::string& output) const override;
 
 private:
   const Envoy::DateFormatter date_formatter_;
@@ -1,5 +1,6 @@
 #include "common/access_log/access_log_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 
@@ -12,6 +13,7 @@
 
 #include "common/access_log/access_log_formatter.h"
 #include "common/common/assert.h"
+#include "common/common/lock_guard.h"
 #include "common/common/utility.h"
 #include "common/config/utility.h"
 #include "common/http/header_map_impl.h"
@@ -74,6 +76,9 @@ FilterFactory::fromProto(const envoy::config::filter::accesslog::v2::AccessLogFi
   case envoy::config::filter::accesslog::v2::AccessLogFilter::kResponseFlagFilter:
     MessageUtil::validate(config);
     return FilterPtr{new ResponseFlagFilter(config.response_flag_filter())};
+  case envoy::config::filter::accesslog::v2::AccessLogFilter::kSampleBudgetFilter:
+    MessageUtil::validate(config);
+    return FilterPtr{new SampleBudgetFilter(config.sample_budget_filter(), random)};
   default:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
@@ -113,7 +118,7 @@ bool RuntimeFilter::evaluate(const RequestInfo::RequestInfo&,
   const Http::HeaderEntry* uuid = request_header.RequestId();
   uint64_t random_value;
   if (use_independent_randomness_ || uuid == nullptr ||
-      !UuidUtils::uuidModBy(uuid->value().c_str(), random_value,
+      !UuidUtils::uuidModBy(uuid->value().getStringView(), random_value,
                             ProtobufPercentHelper::fractionalPercentDenominatorToInt(percent_))) {
     random_value = random_.random();
   }
@@ -123,6 +128,53 @@ bool RuntimeFilter::evaluate(const RequestInfo::RequestInfo&,
       ProtobufPercentHelper::fractionalPercentDenominatorToInt(percent_));
 }
 
+SampleBudgetFilter::SampleBudgetFilter(
+    const envoy::config::filter::accesslog::v2::SampleBudgetFilter& config,
+    Runtime::RandomGenerator& random)
+    : random_(random), max_entries_(config.max_entries()),
+      interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, interval, 1000)) {}
+
+bool SampleBudgetFilter::evaluate(const RequestInfo::RequestInfo& info, const Http::HeaderMap&) {
+  // The start time is recorded for every request already, and is close enough to tell intervals
+  // apart. Requests that started before the current interval count towards it.
+  const MonotonicTime now = info.startTimeMonotonic();
+
+  Thread::LockGuard lock(lock_);
+  if (now - interval_start_ >= 2 * interval_) {
+    // The previous interval had no requests at all.
+    budgets_.clear();
+    interval_start_ = now;
+  } else if (now - interval_start_ >= interval_) {
+    for (auto it = budgets_.begin(); it != budgets_.end();) {
+      if (it->second.requests_ == 0) {
+        it = budgets_.erase(it);
+        continue;
+      }
+      it->second.last_interval_requests_ = it->second.requests_;
+      it->second.requests_ = 0;
+      it->second.logged_ = 0;
+      ++it;
+    }
+    interval_start_ += interval_;
+  }
+
+  RouteBudget& budget = budgets_[info.routeEntry()];
+  budget.requests_++;
+  if (budget.logged_ >= max_entries_) {
+    return false;
+  }
+
+  // Expect as many requests as in the previous interval, or as have been seen so far if that is
+  // more already.
+  const uint64_t expected_requests = std::max(budget.last_interval_requests_, budget.requests_);
+  if (expected_requests > max_entries_ && random_.random() % expected_requests >= max_entries_) {
+    return false;
+  }
+
+  budget.logged_++;
+  return true;
+}
+
 OperatorFilter::OperatorFilter(const Protobuf::RepeatedPtrField<
                                    envoy::config::filter::accesslog::v2::AccessLogFilter>& configs,
                                Runtime::Loader& runtime, Runtime::RandomGenerator& random) {
@@ -1,14 +1,20 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "envoy/access_log/access_log.h"
+#include "envoy/common/time.h"
 #include "envoy/config/filter/accesslog/v2/accesslog.pb.h"
+#include "envoy/router/router.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/server/access_log_config.h"
 
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
 #include "common/http/header_utility.h"
 #include "common/protobuf/protobuf.h"
 
@@ -180,6 +186,36 @@ private:
   uint64_t configured_flags_{};
 };
 
+/**
+ * Filter that samples requests, so that about a fixed number of requests of each route are logged
+ * per interval whatever their rate.
+ */
+class SampleBudgetFilter : public Filter {
+public:
+  SampleBudgetFilter(const envoy::config::filter::accesslog::v2::SampleBudgetFilter& config,
+                     Runtime::RandomGenerator& random);
+
+  // AccessLog::Filter
+  bool evaluate(const RequestInfo::RequestInfo& info,
+                const Http::HeaderMap& request_headers) override;
+
+private:
+  struct RouteBudget {
+    uint64_t requests_{};
+    uint64_t last_interval_requests_{};
+    uint64_t logged_{};
+  };
+
+  Runtime::RandomGenerator& random_;
+  const uint64_t max_entries_;
+  const std::chrono::milliseconds interval_;
+  Thread::MutexBasicLockable lock_;
+  MonotonicTime interval_start_ GUARDED_BY(lock_);
+  // Routes without requests in the current interval are removed when the next one starts, so
+  // entries of routes that are gone do not accumulate.
+  std::unordered_map<const Router::RouteEntry*, RouteBudget> budgets_ GUARDED_BY(lock_);
+};
+
 /**
  * Access log factory that reads the configuration from proto.
  */
@@ -13,13 +13,15 @@ Event::DispatcherPtr Impl::allocateDispatcher(Event::TimeSystem& time_system) {
   return Event::DispatcherPtr{new Event::DispatcherImpl(time_system)};
 }
 
-Impl::Impl(std::chrono::milliseconds file_flush_interval_msec)
-    : file_flush_interval_msec_(file_flush_interval_msec) {}
+Impl::Impl(std::chrono::milliseconds file_flush_interval_msec, uint32_t blocking_pool_threads)
+    : file_flush_interval_msec_(file_flush_interval_msec),
+      file_flusher_(std::make_shared<Filesystem::FileFlusher>()),
+      blocking_pool_(blocking_pool_threads) {}
 
 Filesystem::FileSharedPtr Impl::createFile(const std::string& path, Event::Dispatcher& dispatcher,
                                            Thread::BasicLockable& lock, Stats::Store& stats_store) {
   return std::make_shared<Filesystem::FileImpl>(path, dispatcher, lock, stats_store,
-                                                file_flush_interval_msec_);
+                                                file_flush_interval_msec_, file_flusher_);
 }
 
 bool Impl::fileExists(const std::string& path) { return Filesystem::fileExists(path); }
@@ -7,6 +7,9 @@
 #include "envoy/event/timer.h"
 #include "envoy/filesystem/filesystem.h"
 
+#include "common/common/blocking_pool_impl.h"
+#include "common/filesystem/filesystem_impl.h"
+
 namespace Envoy {
 namespace Api {
 
@@ -15,7 +18,12 @@ namespace Api {
  */
 class Impl : public Api::Api {
 public:
-  Impl(std::chrono::milliseconds file_flush_interval_msec);
+  /**
+   * @param file_flush_interval_msec supplies the interval at which created files are flushed.
+   * @param blocking_pool_threads supplies the number of threads of the blocking pool. Without
+   *        threads, the blocking work is run inline.
+   */
+  Impl(std::chrono::milliseconds file_flush_interval_msec, uint32_t blocking_pool_threads = 0);
 
   // Api::Api
   Event::DispatcherPtr allocateDispatcher(Event::TimeSystem& time_system) override;
@@ -24,9 +32,13 @@ public:
                                        Stats::Store& stats_store) override;
   bool fileExists(const std::string& path) override;
   std::string fileReadToEnd(const std::string& path) override;
+  Thread::BlockingPool& blockingPool() override { return blocking_pool_; }
 
 private:
   std::chrono::milliseconds file_flush_interval_msec_;
+  // Flushes all the files created by this Api. Files share ownership, as they may outlive it.
+  Filesystem::FileFlusherSharedPtr file_flusher_;
+  Thread::BlockingPoolImpl blocking_pool_;
 };
 
 } // namespace Api
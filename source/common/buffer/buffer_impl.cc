@@ -1,10 +1,13 @@
 #include "common/buffer/buffer_impl.h"
 
+#include <climits>
 #include <cstdint>
 #include <string>
 
 #include "common/api/os_sys_calls_impl.h"
+#include "common/buffer/slab_pool.h"
 #include "common/common/assert.h"
+#include "common/common/macros.h"
 
 #include "event2/buffer.h"
 
@@ -20,19 +23,185 @@ static_assert(offsetof(RawSlice, mem_) == offsetof(evbuffer_iovec, iov_base),
 static_assert(offsetof(RawSlice, len_) == offsetof(evbuffer_iovec, iov_len),
               "RawSlice != evbuffer_iovec");
 
-void OwnedImpl::add(const void* data, uint64_t size) { evbuffer_add(buffer_.get(), data, size); }
+namespace {
+
+// Every block handed out for an OwnedSlice is preceded by this header, which records the capacity
+// of the slice so that the block can be returned to the right slab free list.
+struct BlockHeader {
+  uint64_t capacity_;
+  // Links free blocks of the same size class together while they are cached. This also keeps the
+  // slice that follows the header 16 byte aligned.
+  BlockHeader* next_free_;
+};
+static_assert(sizeof(BlockHeader) == 16, "BlockHeader must preserve 16 byte alignment");
+
+// This must match OwnedSlice::slabCapacity() / OwnedSlice::PageSize.
+constexpr uint64_t NumSlabClasses = 4;
+constexpr uint64_t MaxCachedSlabsPerClass = 64;
+
+// The per-thread slab free lists. These are trivially destructible so that they remain usable
+// while thread_local and static objects holding buffers are destroyed at thread/process exit.
+thread_local BlockHeader* free_slabs[NumSlabClasses];
+thread_local uint64_t num_free_slabs[NumSlabClasses];
+thread_local bool slab_cache_shut_down = false;
+
+// Slab classes are indexed by their capacity in pages, starting at one page.
+uint64_t slabClass(uint64_t capacity, uint64_t page_size) { return capacity / page_size - 1; }
+
+uint64_t blockSize(uint64_t capacity) {
+  return sizeof(BlockHeader) + sizeof(OwnedSlice) + capacity;
+}
+
+// Returns a block to the slab pool it was allocated from, or to the heap.
+void freeBlock(BlockHeader* block) {
+  SlabPool* pool = SlabPool::get();
+  if (pool != nullptr && pool->owns(block)) {
+    const uint64_t page_size = OwnedSlice::slabCapacity() / NumSlabClasses;
+    pool->release(slabClass(block->capacity_, page_size), blockSize(block->capacity_), block);
+    return;
+  }
+  ::operator delete(block);
+}
+
+// Releases the cached slabs when a thread exits. After that, slices freed on the thread go back to
+// the slab pool or the heap directly.
+class SlabCacheReaper {
+public:
+  ~SlabCacheReaper() {
+    for (uint64_t i = 0; i < NumSlabClasses; i++) {
+      while (free_slabs[i] != nullptr) {
+        BlockHeader* block = free_slabs[i];
+        free_slabs[i] = block->next_free_;
+        freeBlock(block);
+      }
+      num_free_slabs[i] = 0;
+    }
+    slab_cache_shut_down = true;
+  }
+};
+
+} // namespace
+
+constexpr uint64_t OwnedSlice::PageSize;
+constexpr uint64_t OwnedSlice::NumSlabClasses;
+constexpr uint64_t OwnedImpl::MinSharedMoveSize;
+static_assert(OwnedSlice::slabCapacity() == 4096 * NumSlabClasses, "slab class mismatch");
+static_assert(NumSlabClasses <= SlabPool::MaxSizeClasses, "too many slab classes");
+
+SlicePtr OwnedSlice::create(uint64_t capacity) {
+  // Round up to the next multiple of the page size; a zero size request still gets one page.
+  const uint64_t slice_capacity =
+      capacity == 0 ? PageSize : (capacity + PageSize - 1) & ~(PageSize - 1);
+  return SlicePtr(new (slice_capacity) OwnedSlice(slice_capacity));
+}
+
+void* OwnedSlice::operator new(size_t object_size, uint64_t capacity) {
+  BlockHeader* block = nullptr;
+  if (capacity <= slabCapacity()) {
+    const uint64_t slab_class = slabClass(capacity, PageSize);
+    block = free_slabs[slab_class];
+    if (block != nullptr) {
+      free_slabs[slab_class] = block->next_free_;
+      num_free_slabs[slab_class]--;
+    } else if (SlabPool::get() != nullptr) {
+      ASSERT(object_size == sizeof(OwnedSlice));
+      block = static_cast<BlockHeader*>(SlabPool::get()->allocate(slab_class, blockSize(capacity)));
+    }
+  }
+  if (block == nullptr) {
+    block = static_cast<BlockHeader*>(::operator new(sizeof(BlockHeader) + object_size + capacity));
+  }
+  block->capacity_ = capacity;
+  block->next_free_ = nullptr;
+  return block + 1;
+}
+
+void OwnedSlice::operator delete(void* address) {
+  BlockHeader* block = static_cast<BlockHeader*>(address) - 1;
+  if (block->capacity_ <= slabCapacity() && !slab_cache_shut_down) {
+    const uint64_t slab_class = slabClass(block->capacity_, PageSize);
+    if (num_free_slabs[slab_class] < MaxCachedSlabsPerClass) {
+      // Make sure the free lists are released when this thread exits.
+      static thread_local SlabCacheReaper reaper;
+      UNREFERENCED_PARAMETER(reaper);
+      block->next_free_ = free_slabs[slab_class];
+      free_slabs[slab_class] = block;
+      num_free_slabs[slab_class]++;
+      return;
+    }
+  }
+  freeBlock(block);
+}
+
+uint64_t OwnedSlice::cachedSlabsForTest(uint64_t capacity) {
+  return num_free_slabs[slabClass(capacity, PageSize)];
+}
+
+bool OwnedImpl::use_old_impl_ = false;
+
+void OwnedImpl::add(const void* data, uint64_t size) {
+  if (old_impl_) {
+    evbuffer_add(buffer_.get(), data, size);
+  } else {
+    addImpl(data, size);
+  }
+}
+
+void OwnedImpl::addImpl(const void* data, uint64_t size) {
+  const uint8_t* src = static_cast<const uint8_t*>(data);
+  bool new_slice_needed = slices_.empty();
+  while (size != 0) {
+    if (new_slice_needed) {
+      slices_.emplace_back(OwnedSlice::create(size));
+    }
+    const uint64_t copy_size = slices_.back()->append(src, size);
+    src += copy_size;
+    size -= copy_size;
+    length_ += copy_size;
+    new_slice_needed = true;
+  }
+}
 
 void OwnedImpl::addBufferFragment(BufferFragment& fragment) {
-  evbuffer_add_reference(
-      buffer_.get(), fragment.data(), fragment.size(),
-      [](const void*, size_t, void* arg) { static_cast<BufferFragment*>(arg)->done(); }, &fragment);
+  if (old_impl_) {
+    evbuffer_add_reference(
+        buffer_.get(), fragment.data(), fragment.size(),
+        [](const void*, size_t, void* arg) { static_cast<BufferFragment*>(arg)->done(); },
+        &fragment);
+  } else {
+    length_ += fragment.size();
+    slices_.emplace_back(std::make_unique<UnownedSlice>(fragment));
+  }
 }
 
 void OwnedImpl::add(const std::string& data) {
-  evbuffer_add(buffer_.get(), data.c_str(), data.size());
+  if (old_impl_) {
+    evbuffer_add(buffer_.get(), data.c_str(), data.size());
+  } else {
+    addImpl(data.data(), data.size());
+  }
 }
 
 void OwnedImpl::add(const Instance& data) {
+  if (!old_impl_) {
+    // See move() below for why we do the static cast.
+    const OwnedImpl& other = static_cast<const OwnedImpl&>(data);
+    ASSERT(!other.old_impl_);
+    for (size_t i = 0; i < other.slices_.size(); i++) {
+      const Slice& slice = *other.slices_[i];
+      const uint64_t slice_size = slice.dataSize();
+      const SharedSlice* shared_slice = dynamic_cast<const SharedSlice*>(&slice);
+      if (shared_slice != nullptr && slice_size >= MinSharedMoveSize) {
+        // The content of a shared slice never changes, so a reference is as good as a copy.
+        slices_.emplace_back(std::make_unique<SharedSlice>(
+            shared_slice->storage(), const_cast<uint8_t*>(slice.data()), slice_size));
+        length_ += slice_size;
+      } else {
+        addImpl(slice.data(), slice_size);
+      }
+    }
+    return;
+  }
   uint64_t num_slices = data.getRawSlices(nullptr, 0);
   RawSlice slices[num_slices];
   data.getRawSlices(slices, num_slices);
@@ -42,68 +211,348 @@ void OwnedImpl::add(const Instance& data) {
 }
 
 void OwnedImpl::prepend(absl::string_view data) {
-  evbuffer_prepend(buffer_.get(), data.data(), data.size());
+  if (old_impl_) {
+    evbuffer_prepend(buffer_.get(), data.data(), data.size());
+    return;
+  }
+  uint64_t size = data.size();
+  bool new_slice_needed = slices_.empty();
+  while (size != 0) {
+    if (new_slice_needed) {
+      slices_.emplace_front(OwnedSlice::create(size));
+    }
+    const uint64_t copy_size = slices_.front()->prepend(data.data(), size);
+    size -= copy_size;
+    length_ += copy_size;
+    new_slice_needed = true;
+  }
 }
 
 void OwnedImpl::prepend(Instance& data) {
-  int rc =
-      evbuffer_prepend_buffer(buffer_.get(), static_cast<LibEventInstance&>(data).buffer().get());
-  ASSERT(rc == 0);
-  ASSERT(data.length() == 0);
-  static_cast<LibEventInstance&>(data).postProcess();
+  if (old_impl_) {
+    int rc =
+        evbuffer_prepend_buffer(buffer_.get(), static_cast<LibEventInstance&>(data).buffer().get());
+    ASSERT(rc == 0);
+    ASSERT(data.length() == 0);
+    static_cast<LibEventInstance&>(data).postProcess();
+    return;
+  }
+  // See move() below for why we do the static cast.
+  OwnedImpl& other = static_cast<OwnedImpl&>(data);
+  ASSERT(!other.old_impl_);
+  while (!other.slices_.empty()) {
+    const uint64_t slice_size = other.slices_.back()->dataSize();
+    if (slice_size != 0) {
+      length_ += slice_size;
+      slices_.emplace_front(std::move(other.slices_.back()));
+    }
+    other.slices_.pop_back();
+    other.length_ -= slice_size;
+  }
+  ASSERT(other.length() == 0);
+  other.postProcess();
 }
 
 void OwnedImpl::commit(RawSlice* iovecs, uint64_t num_iovecs) {
-  int rc =
-      evbuffer_commit_space(buffer_.get(), reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(rc == 0);
+  if (old_impl_) {
+    int rc =
+        evbuffer_commit_space(buffer_.get(), reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
+    ASSERT(rc == 0);
+    return;
+  }
+  if (num_iovecs == 0 || slices_.empty()) {
+    return;
+  }
+  // Find the slices in the buffer that correspond to the iovecs:
+  // First, scan backward from the end of the buffer to find the last slice containing any
+  // content. Reservations are made from the end of the buffer, and out-of-order commits aren't
+  // supported, so any slices before this point cannot match the iovecs being committed.
+  ssize_t slice_index = static_cast<ssize_t>(slices_.size()) - 1;
+  while (slice_index >= 0 && slices_[slice_index]->dataSize() == 0) {
+    slice_index--;
+  }
+  if (slice_index < 0) {
+    // There was no slice containing any data, so rewind the iterator to the first slice.
+    slice_index = 0;
+  }
+
+  // Next, scan forward and attempt to match the slices against iovecs.
+  uint64_t num_slices_committed = 0;
+  while (num_slices_committed < num_iovecs &&
+         slice_index < static_cast<ssize_t>(slices_.size())) {
+    if (slices_[slice_index]->commit(iovecs[num_slices_committed])) {
+      length_ += iovecs[num_slices_committed].len_;
+      num_slices_committed++;
+    }
+    slice_index++;
+  }
+
+  ASSERT(num_slices_committed > 0);
 }
 
 void OwnedImpl::copyOut(size_t start, uint64_t size, void* data) const {
   ASSERT(start + size <= length());
 
-  evbuffer_ptr start_ptr;
-  int rc = evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET);
-  ASSERT(rc != -1);
+  if (old_impl_) {
+    evbuffer_ptr start_ptr;
+    int rc = evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET);
+    ASSERT(rc != -1);
+
+    ev_ssize_t copied = evbuffer_copyout_from(buffer_.get(), &start_ptr, data, size);
+    ASSERT(static_cast<uint64_t>(copied) == size);
+    return;
+  }
 
-  ev_ssize_t copied = evbuffer_copyout_from(buffer_.get(), &start_ptr, data, size);
-  ASSERT(static_cast<uint64_t>(copied) == size);
+  uint64_t bytes_to_skip = start;
+  uint8_t* dest = static_cast<uint8_t*>(data);
+  for (size_t i = 0; i < slices_.size() && size != 0; i++) {
+    const Slice& slice = *slices_[i];
+    const uint64_t data_size = slice.dataSize();
+    if (data_size <= bytes_to_skip) {
+      // The offset where the caller wants to start copying is after the end of this slice,
+      // so just skip over this slice completely.
+      bytes_to_skip -= data_size;
+      continue;
+    }
+    const uint64_t copy_size = std::min(size, data_size - bytes_to_skip);
+    memcpy(dest, slice.data() + bytes_to_skip, copy_size);
+    size -= copy_size;
+    dest += copy_size;
+    // Now that we've started copying, there are no bytes left to skip over. If there
+    // is any more data to be copied, the next iteration can start copying from the very
+    // beginning of the next slice.
+    bytes_to_skip = 0;
+  }
+  ASSERT(size == 0);
 }
 
 void OwnedImpl::drain(uint64_t size) {
   ASSERT(size <= length());
-  int rc = evbuffer_drain(buffer_.get(), size);
-  ASSERT(rc == 0);
+  if (old_impl_) {
+    int rc = evbuffer_drain(buffer_.get(), size);
+    ASSERT(rc == 0);
+    return;
+  }
+  uint64_t bytes_remaining = size;
+  while (bytes_remaining != 0) {
+    ASSERT(!slices_.empty());
+    const uint64_t slice_size = slices_.front()->dataSize();
+    if (slice_size <= bytes_remaining) {
+      slices_.pop_front();
+      bytes_remaining -= slice_size;
+    } else {
+      slices_.front()->drain(bytes_remaining);
+      bytes_remaining = 0;
+    }
+  }
+  // Release any empty, non-reservable slices (e.g. zero length fragments) now at the front, so
+  // that fragment owners are notified as promptly as they would be when the data is drained.
+  while (!slices_.empty() && slices_.front()->dataSize() == 0 &&
+         slices_.front()->reservableSize() == 0) {
+    slices_.pop_front();
+  }
+  length_ -= size;
+  if (length_ == 0) {
+    releaseEmptySlices();
+  }
+}
+
+void OwnedImpl::releaseEmptySlices() {
+  ASSERT(length_ == 0);
+  // An empty buffer keeps no storage, so that idle connections don't each hold on to a slab. Freed
+  // slabs go back to the thread's free list, from which the next read of any connection reserves.
+  // Reservations are made at the end of the buffer, and commit() must still find their slices.
+  while (!slices_.empty() && !slices_.front()->reservationOutstanding()) {
+    slices_.pop_front();
+  }
 }
 
 uint64_t OwnedImpl::getRawSlices(RawSlice* out, uint64_t out_size) const {
-  return evbuffer_peek(buffer_.get(), -1, nullptr, reinterpret_cast<evbuffer_iovec*>(out),
-                       out_size);
+  if (old_impl_) {
+    return evbuffer_peek(buffer_.get(), -1, nullptr, reinterpret_cast<evbuffer_iovec*>(out),
+                         out_size);
+  }
+  // Unlike evbuffer, empty slices are never returned, even when they are reservable.
+  uint64_t num_slices = 0;
+  for (size_t i = 0; i < slices_.size(); i++) {
+    const Slice& slice = *slices_[i];
+    if (slice.dataSize() == 0) {
+      continue;
+    }
+    if (num_slices < out_size) {
+      out[num_slices].mem_ = const_cast<uint8_t*>(slice.data());
+      out[num_slices].len_ = slice.dataSize();
+    }
+    // Per the definition of getRawSlices in include/envoy/buffer/buffer.h, we need to return
+    // the total number of slices needed to access all the data in the buffer, which can be
+    // larger than out_size. So we keep iterating and counting non-empty slices here, even
+    // if all the caller-supplied slices have been filled.
+    num_slices++;
+  }
+  return num_slices;
 }
 
-uint64_t OwnedImpl::length() const { return evbuffer_get_length(buffer_.get()); }
+uint64_t OwnedImpl::length() const {
+  if (old_impl_) {
+    return evbuffer_get_length(buffer_.get());
+  }
+  return length_;
+}
 
 void* OwnedImpl::linearize(uint32_t size) {
   ASSERT(size <= length());
-  return evbuffer_pullup(buffer_.get(), size);
+  if (old_impl_) {
+    return evbuffer_pullup(buffer_.get(), size);
+  }
+  if (slices_.empty()) {
+    return nullptr;
+  }
+  uint64_t linearized_size = 0;
+  uint64_t num_slices_to_linearize = 0;
+  for (size_t i = 0; i < slices_.size(); i++) {
+    num_slices_to_linearize++;
+    linearized_size += slices_[i]->dataSize();
+    if (linearized_size >= size) {
+      break;
+    }
+  }
+  if (num_slices_to_linearize > 1) {
+    SlicePtr new_slice = OwnedSlice::create(linearized_size);
+    for (uint64_t i = 0; i < num_slices_to_linearize; i++) {
+      const uint64_t copied =
+          new_slice->append(slices_.front()->data(), slices_.front()->dataSize());
+      ASSERT(copied == slices_.front()->dataSize());
+      UNREFERENCED_PARAMETER(copied);
+      slices_.pop_front();
+    }
+    ASSERT(new_slice->dataSize() == linearized_size);
+    slices_.emplace_front(std::move(new_slice));
+  }
+  return slices_.front()->data();
 }
 
 void OwnedImpl::move(Instance& rhs) {
-  // We do the static cast here because in practice we only have one buffer implementation right
-  // now and this is safe. Using the evbuffer move routines require having access to both evbuffers.
-  // This is a reasonable compromise in a high performance path where we want to maintain an
-  // abstraction in case we get rid of evbuffer later.
-  int rc = evbuffer_add_buffer(buffer_.get(), static_cast<LibEventInstance&>(rhs).buffer().get());
-  ASSERT(rc == 0);
-  static_cast<LibEventInstance&>(rhs).postProcess();
+  if (old_impl_) {
+    // We do the static cast here because in practice we only have one buffer implementation
+    // right now and this is safe. Using the evbuffer move routines require having access to both
+    // evbuffers. This is a reasonable compromise in a high performance path where we want to
+    // maintain an abstraction in case we get rid of evbuffer later.
+    int rc =
+        evbuffer_add_buffer(buffer_.get(), static_cast<LibEventInstance&>(rhs).buffer().get());
+    ASSERT(rc == 0);
+    static_cast<LibEventInstance&>(rhs).postProcess();
+    return;
+  }
+  // Similar to the above, OwnedImpl is the only Instance implementation so the cast is safe. The
+  // slices are moved rather than copied, so this is O(number of slices) regardless of length.
+  OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+  ASSERT(!other.old_impl_);
+  while (!other.slices_.empty()) {
+    const uint64_t slice_size = other.slices_.front()->dataSize();
+    if (slice_size != 0) {
+      slices_.emplace_back(std::move(other.slices_.front()));
+      length_ += slice_size;
+    }
+    other.slices_.pop_front();
+    other.length_ -= slice_size;
+  }
+  ASSERT(other.length() == 0);
+  other.postProcess();
 }
 
 void OwnedImpl::move(Instance& rhs, uint64_t length) {
+  if (old_impl_) {
+    // See move() above for why we do the static cast.
+    int rc = evbuffer_remove_buffer(static_cast<LibEventInstance&>(rhs).buffer().get(),
+                                    buffer_.get(), length);
+    ASSERT(static_cast<uint64_t>(rc) == length);
+    static_cast<LibEventInstance&>(rhs).postProcess();
+    return;
+  }
   // See move() above for why we do the static cast.
-  int rc = evbuffer_remove_buffer(static_cast<LibEventInstance&>(rhs).buffer().get(), buffer_.get(),
-                                  length);
-  ASSERT(static_cast<uint64_t>(rc) == length);
-  static_cast<LibEventInstance&>(rhs).postProcess();
+  OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+  ASSERT(!other.old_impl_);
+  ASSERT(length <= other.length());
+  while (length != 0 && !other.slices_.empty()) {
+    const uint64_t slice_size = other.slices_.front()->dataSize();
+    const uint64_t copy_size = std::min(slice_size, length);
+    if (copy_size == 0) {
+      other.slices_.pop_front();
+    } else if (copy_size < slice_size && copy_size < MinSharedMoveSize) {
+      addImpl(other.slices_.front()->data(), copy_size);
+      other.slices_.front()->drain(copy_size);
+      other.length_ -= copy_size;
+    } else if (copy_size < slice_size) {
+      // Split the slice between both buffers. Each part is read-only, so neither buffer can
+      // overwrite the content of the other.
+      std::shared_ptr<Slice> storage(std::move(other.slices_.front()));
+      uint8_t* data = storage->data();
+      slices_.emplace_back(std::make_unique<SharedSlice>(storage, data, copy_size));
+      length_ += copy_size;
+      other.slices_.front() =
+          std::make_unique<SharedSlice>(storage, data + copy_size, slice_size - copy_size);
+      other.length_ -= copy_size;
+    } else {
+      slices_.emplace_back(std::move(other.slices_.front()));
+      other.slices_.pop_front();
+      length_ += slice_size;
+      other.length_ -= slice_size;
+    }
+    length -= copy_size;
+  }
+  other.postProcess();
+}
+
+void OwnedImpl::pin(OwnedImpl& rhs, uint64_t length) {
+  ASSERT(!old_impl_ && !rhs.old_impl_);
+  ASSERT(length <= rhs.length());
+  while (length != 0 && !rhs.slices_.empty()) {
+    SlicePtr slice = std::move(rhs.slices_.front());
+    rhs.slices_.pop_front();
+    const uint64_t slice_size = slice->dataSize();
+    if (length < slice_size) {
+      // Copy out whatever follows rather than the pinned content, which must not move.
+      rhs.slices_.emplace_front(OwnedSlice::create(slice->data() + length, slice_size - length));
+      rhs.length_ -= length;
+      length = 0;
+    } else {
+      rhs.length_ -= slice_size;
+      length -= slice_size;
+    }
+    length_ += slice_size;
+    slices_.emplace_back(std::move(slice));
+  }
+  rhs.postProcess();
+}
+
+bool OwnedImpl::writable(const void* data) const {
+  ASSERT(!old_impl_);
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < slices_.size(); i++) {
+    const Slice& slice = *slices_[i];
+    if (p >= slice.data() && p < slice.data() + slice.dataSize()) {
+      return !slice.readOnly();
+    }
+  }
+  return false;
+}
+
+void OwnedImpl::share(Instance& data) {
+  if (!old_impl_) {
+    // See move() above for why we do the static cast.
+    OwnedImpl& other = static_cast<OwnedImpl&>(data);
+    ASSERT(!other.old_impl_);
+    for (size_t i = 0; i < other.slices_.size(); i++) {
+      SlicePtr& slice = other.slices_[i];
+      const uint64_t slice_size = slice->dataSize();
+      if (slice_size >= MinSharedMoveSize && dynamic_cast<SharedSlice*>(slice.get()) == nullptr) {
+        // Freeze the slice, so that appending to either buffer can't overwrite shared content.
+        std::shared_ptr<Slice> storage(std::move(slice));
+        slice = std::make_unique<SharedSlice>(storage, storage->data(), slice_size);
+      }
+    }
+  }
+  add(static_cast<const Instance&>(data));
 }
 
 Api::SysCallIntResult OwnedImpl::read(int fd, uint64_t max_length) {
@@ -128,47 +577,167 @@ Api::SysCallIntResult OwnedImpl::read(int fd, uint64_t max_length) {
   auto& os_syscalls = Api::OsSysCallsSingleton::get();
   const Api::SysCallSizeResult result =
       os_syscalls.readv(fd, iov, static_cast<int>(num_slices_to_read));
-  if (result.rc_ < 0) {
-    return {static_cast<int>(result.rc_), result.errno_};
-  }
-  uint64_t num_slices_to_commit = 0;
-  uint64_t bytes_to_commit = result.rc_;
+  // Commit what was read, and release the rest of the reservation with empty commits.
+  uint64_t bytes_to_commit = result.rc_ < 0 ? 0 : result.rc_;
   ASSERT(bytes_to_commit <= max_length);
-  while (bytes_to_commit != 0) {
-    slices[num_slices_to_commit].len_ =
-        std::min(slices[num_slices_to_commit].len_, static_cast<size_t>(bytes_to_commit));
-    ASSERT(bytes_to_commit >= slices[num_slices_to_commit].len_);
-    bytes_to_commit -= slices[num_slices_to_commit].len_;
-    num_slices_to_commit++;
-  }
-  ASSERT(num_slices_to_commit <= num_slices);
-  commit(slices, num_slices_to_commit);
+  for (uint64_t i = 0; i < num_slices; i++) {
+    slices[i].len_ = std::min(slices[i].len_, static_cast<size_t>(bytes_to_commit));
+    bytes_to_commit -= slices[i].len_;
+  }
+  ASSERT(bytes_to_commit == 0);
+  commit(slices, num_slices);
+  // Don't keep the slab reserved for a read that found no data (e.g. EAGAIN) in an empty buffer.
+  if (length_ == 0) {
+    releaseEmptySlices();
+  }
   return {static_cast<int>(result.rc_), result.errno_};
 }
 
 uint64_t OwnedImpl::reserve(uint64_t length, RawSlice* iovecs, uint64_t num_iovecs) {
-  uint64_t ret = evbuffer_reserve_space(buffer_.get(), length,
-                                        reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(ret >= 1);
-  return ret;
+  if (old_impl_) {
+    uint64_t ret = evbuffer_reserve_space(buffer_.get(), length,
+                                          reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
+    ASSERT(ret >= 1);
+    return ret;
+  }
+  if (num_iovecs == 0 || length == 0) {
+    return 0;
+  }
+  // Check whether there are any empty slices with reservable space at the end of the buffer.
+  size_t first_reservable_slice = slices_.size();
+  while (first_reservable_slice > 0) {
+    if (slices_[first_reservable_slice - 1]->reservableSize() == 0) {
+      break;
+    }
+    first_reservable_slice--;
+    if (slices_[first_reservable_slice]->dataSize() != 0) {
+      // There is some content in this slice, so anything in front of it is nonreservable.
+      break;
+    }
+  }
+
+  // Having found the sequence of reservable slices at the back of the buffer, reserve
+  // as much space as possible from each one.
+  uint64_t num_slices_used = 0;
+  uint64_t bytes_remaining = length;
+  size_t slice_index = first_reservable_slice;
+  while (slice_index < slices_.size() && bytes_remaining != 0 && num_slices_used < num_iovecs) {
+    auto& slice = slices_[slice_index];
+    const uint64_t reservation_size = std::min(slice->reservableSize(), bytes_remaining);
+    if (num_slices_used + 1 == num_iovecs && reservation_size < bytes_remaining) {
+      // There is only one iovec left, and this next slice does not have enough space to
+      // complete the reservation. Stop iterating, with last one iovec still unpopulated,
+      // so the code following this loop can allocate a new slice to hold the rest of the
+      // reservation.
+      break;
+    }
+    iovecs[num_slices_used] = slice->reserve(reservation_size);
+    bytes_remaining -= iovecs[num_slices_used].len_;
+    num_slices_used++;
+    slice_index++;
+  }
+
+  // If needed, allocate one more slice at the end to provide the remainder of the reservation.
+  if (bytes_remaining != 0) {
+    slices_.emplace_back(OwnedSlice::create(bytes_remaining));
+    iovecs[num_slices_used] = slices_.back()->reserve(bytes_remaining);
+    bytes_remaining -= iovecs[num_slices_used].len_;
+    num_slices_used++;
+  }
+
+  ASSERT(num_slices_used <= num_iovecs);
+  ASSERT(bytes_remaining == 0);
+  return num_slices_used;
 }
 
 ssize_t OwnedImpl::search(const void* data, uint64_t size, size_t start) const {
-  evbuffer_ptr start_ptr;
-  if (-1 == evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET)) {
-    return -1;
+  if (old_impl_) {
+    evbuffer_ptr start_ptr;
+    if (-1 == evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET)) {
+      return -1;
+    }
+
+    evbuffer_ptr result_ptr =
+        evbuffer_search(buffer_.get(), static_cast<const char*>(data), size, &start_ptr);
+    return result_ptr.pos;
   }
 
-  evbuffer_ptr result_ptr =
-      evbuffer_search(buffer_.get(), static_cast<const char*>(data), size, &start_ptr);
-  return result_ptr.pos;
+  // This implementation uses the same search algorithm as evbuffer_search(), a naive
+  // scan that requires O(M*N) comparisons in the worst case.
+  if (start > length_) {
+    return -1;
+  }
+  if (size == 0) {
+    return start;
+  }
+  const uint8_t* needle = static_cast<const uint8_t*>(data);
+  uint64_t offset = 0;
+  for (size_t slice_index = 0; slice_index < slices_.size(); slice_index++) {
+    const Slice& slice = *slices_[slice_index];
+    const uint64_t slice_size = slice.dataSize();
+    if (slice_size <= start) {
+      start -= slice_size;
+      offset += slice_size;
+      continue;
+    }
+    const uint8_t* slice_start = slice.data();
+    const uint8_t* haystack = slice_start + start;
+    const uint8_t* haystack_end = slice_start + slice_size;
+    while (haystack < haystack_end) {
+      // Search within this slice for the first byte of the needle.
+      const uint8_t* first_byte_match =
+          static_cast<const uint8_t*>(memchr(haystack, needle[0], haystack_end - haystack));
+      if (first_byte_match == nullptr) {
+        break;
+      }
+      // After finding a match for the first byte of the needle, check whether the following
+      // bytes in the buffer match the remainder of the needle. Note that the match can span
+      // two or more slices.
+      size_t i = 1;
+      size_t match_index = slice_index;
+      const uint8_t* match_next = first_byte_match + 1;
+      const uint8_t* match_end = haystack_end;
+      while (i < size) {
+        if (match_next >= match_end) {
+          // We've hit the end of this slice, so continue checking against the next slice.
+          match_index++;
+          if (match_index == slices_.size()) {
+            // We've hit the end of the entire buffer.
+            break;
+          }
+          const Slice& match_slice = *slices_[match_index];
+          match_next = match_slice.data();
+          match_end = match_next + match_slice.dataSize();
+          continue;
+        }
+        if (*match_next++ != needle[i]) {
+          break;
+        }
+        i++;
+      }
+      if (i == size) {
+        // Successful match of the entire needle.
+        return offset + (first_byte_match - slice_start);
+      }
+      // If this wasn't a successful match, start scanning again at the next byte.
+      haystack = first_byte_match + 1;
+    }
+    start = 0;
+    offset += slice_size;
+  }
+  return -1;
 }
 
 Api::SysCallIntResult OwnedImpl::write(int fd) {
-  constexpr uint64_t MaxSlices = 16;
+  // Gather enough slices into one writev() to usually fill the socket's send buffer, so that large
+  // responses take as few syscalls as possible.
+  constexpr uint64_t MaxSlices = 64;
+#ifdef IOV_MAX
+  static_assert(MaxSlices <= IOV_MAX, "writev() rejects more than IOV_MAX slices");
+#endif
   RawSlice slices[MaxSlices];
   const uint64_t num_slices = std::min(getRawSlices(slices, MaxSlices), MaxSlices);
-  struct iovec iov[num_slices];
+  struct iovec iov[MaxSlices];
   uint64_t num_slices_to_write = 0;
   for (uint64_t i = 0; i < num_slices; i++) {
     if (slices[i].mem_ != nullptr && slices[i].len_ != 0) {
@@ -188,7 +757,11 @@ Api::SysCallIntResult OwnedImpl::write(int fd) {
   return {static_cast<int>(result.rc_), result.errno_};
 }
 
-OwnedImpl::OwnedImpl() : buffer_(evbuffer_new()) {}
+OwnedImpl::OwnedImpl() : old_impl_(use_old_impl_) {
+  if (old_impl_) {
+    buffer_ = evbuffer_new();
+  }
+}
 
 OwnedImpl::OwnedImpl(const std::string& data) : OwnedImpl() { add(data); }
 
@@ -196,6 +769,16 @@ OwnedImpl::OwnedImpl(const Instance& data) : OwnedImpl() { add(data); }
 
 OwnedImpl::OwnedImpl(const void* data, uint64_t size) : OwnedImpl() { add(data, size); }
 
+OwnedImpl::OwnedImpl(OwnedImpl&& rhs) : OwnedImpl() { move(rhs); }
+
+OwnedImpl& OwnedImpl::operator=(OwnedImpl&& rhs) {
+  if (this != &rhs) {
+    drain(length());
+    move(rhs);
+  }
+  return *this;
+}
+
 std::string OwnedImpl::toString() const {
   uint64_t num_slices = getRawSlices(nullptr, 0);
   RawSlice slices[num_slices];
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <string>
 
 #include "envoy/buffer/buffer.h"
 
+#include "common/common/assert.h"
 #include "common/common/non_copyable.h"
 #include "common/event/libevent.h"
 
@@ -46,6 +50,386 @@ private:
   const std::function<void(const void*, size_t, const BufferFragmentImpl*)> releasor_;
 };
 
+/**
+ * A Slice manages a contiguous block of bytes.
+ * The block is arranged like this:
+ *                   |<- dataSize() ->|<- reservableSize() ->|
+ * +-----------------+----------------+----------------------+
+ * | Drained         | Data           | Reservable           |
+ * | Unused space    | Usable content | New content can be   |
+ * | that formerly   |                | added here with      |
+ * | was in the Data |                | reserve()/commit()   |
+ * | section         |                |                      |
+ * +-----------------+----------------+----------------------+
+ *                   ^                ^                      ^
+ *                   |                |                      |
+ *                   base_ + data_    base_ + reservable_    base_ + capacity_
+ */
+class Slice {
+public:
+  virtual ~Slice() {}
+
+  /**
+   * @return a pointer to the start of the usable content.
+   */
+  const uint8_t* data() const { return base_ + data_; }
+
+  /**
+   * @return a pointer to the start of the usable content.
+   */
+  uint8_t* data() { return base_ + data_; }
+
+  /**
+   * @return the size in bytes of the usable content.
+   */
+  uint64_t dataSize() const { return reservable_ - data_; }
+
+  /**
+   * Remove the first size bytes of usable content. Runs in O(1) time.
+   * @param size number of bytes to remove. If greater than dataSize(), the result is undefined.
+   */
+  void drain(uint64_t size) {
+    ASSERT(data_ + size <= reservable_);
+    data_ += size;
+    if (data_ == reservable_ && !reservation_outstanding_) {
+      // There is no more content in the slice, and there is no outstanding reservation, so the
+      // Data section can be reset to the start of the slice to facilitate reuse.
+      data_ = reservable_ = 0;
+    }
+  }
+
+  /**
+   * @return the number of bytes available to be reserve()d.
+   * @note If reserve() has been called without a corresponding commit(), this method
+   *       should not be used.
+   * @note Read-only slices return zero from this method.
+   */
+  uint64_t reservableSize() const { return read_only_ ? 0 : capacity_ - reservable_; }
+
+  /**
+   * @return whether reserve() has been called without a matching commit().
+   */
+  bool reservationOutstanding() const { return reservation_outstanding_; }
+
+  /**
+   * @return whether the storage is referenced rather than owned, so that nothing may be written to
+   *         it.
+   */
+  bool readOnly() const { return read_only_; }
+
+  /**
+   * Reserve `size` bytes that the caller can populate with content. The caller SHOULD then
+   * call commit() to add the newly populated content from the Reserved section to the Data
+   * section.
+   * @note If there is already an outstanding reservation (i.e., a reservation obtained
+   *       from reserve() that has not been released by calling commit()), this method will
+   *       return a new reservation that replaces it.
+   * @param size the number of bytes to reserve. The Slice implementation MAY reserve
+   *        fewer bytes than requested (for example, if it doesn't have enough room in the
+   *        Reservable section to fulfill the whole request).
+   * @return a tuple containing the address of the start of resulting reservation and the
+   *         reservation size in bytes. If the address is null, the reservation failed.
+   */
+  RawSlice reserve(uint64_t size) {
+    if (size == 0 || reservableSize() == 0) {
+      return {nullptr, 0};
+    }
+    reservation_outstanding_ = true;
+    return {base_ + reservable_, static_cast<size_t>(std::min(size, reservableSize()))};
+  }
+
+  /**
+   * Commit a Reservation that was previously obtained from a call to reserve().
+   * The Reservation's size is added to the Data section.
+   * @param reservation a reservation obtained from a previous call to reserve().
+   *        If the reservation is not from this Slice, commit() will return false.
+   *        If the caller is committing fewer bytes than provided by reserve(), it
+   *        should change the len_ field of the reservation before calling commit().
+   *        For example, if a caller reserve()s 4KB to do a nonblocking socket read,
+   *        and the read only returns two bytes, the caller should set
+   *        reservation.len_ = 2 and then call commit(reservation).
+   * @return whether the Reservation was successfully committed to the Slice.
+   */
+  bool commit(const RawSlice& reservation) {
+    if (static_cast<const uint8_t*>(reservation.mem_) != base_ + reservable_ ||
+        reservable_ + reservation.len_ > capacity_ || reservable_ >= capacity_) {
+      // The reservation is not from this Slice.
+      return false;
+    }
+    reservable_ += reservation.len_;
+    reservation_outstanding_ = false;
+    return true;
+  }
+
+  /**
+   * Copy as much of the supplied data as possible to the end of the slice.
+   * @param data start of the data to copy.
+   * @param size number of bytes to copy.
+   * @return number of bytes copied (may be a smaller than size, may even be zero).
+   */
+  uint64_t append(const void* data, uint64_t size) {
+    const uint64_t copy_size = std::min(size, reservableSize());
+    if (copy_size != 0) {
+      memcpy(base_ + reservable_, data, copy_size);
+      reservable_ += copy_size;
+    }
+    return copy_size;
+  }
+
+  /**
+   * Copy as much of the supplied data as possible to the front of the slice.
+   * If only part of the data will fit in the slice, the bytes from the _end_ are
+   * copied.
+   * @param data start of the data to copy.
+   * @param size number of bytes to copy.
+   * @return number of bytes copied (may be a smaller than size, may even be zero). Read-only
+   *         slices copy nothing, even if part of their content was drained.
+   */
+  uint64_t prepend(const void* data, uint64_t size) {
+    if (read_only_) {
+      return 0;
+    }
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    uint64_t copy_size;
+    if (dataSize() == 0) {
+      // There is nothing in the slice, so put the data at the very end in case the caller
+      // later tries to prepend anything else in front of it.
+      if (reservation_outstanding_) {
+        return 0;
+      }
+      copy_size = std::min(size, reservableSize());
+      reservable_ = capacity_;
+      data_ = capacity_ - copy_size;
+    } else {
+      if (data_ == 0) {
+        // There is content in the slice, and no space in front of it to write anything.
+        return 0;
+      }
+      // Write into the space in front of the slice's current content.
+      copy_size = std::min(size, data_);
+      data_ -= copy_size;
+    }
+    memcpy(base_ + data_, src + size - copy_size, copy_size);
+    return copy_size;
+  }
+
+protected:
+  Slice(uint64_t data, uint64_t reservable, uint64_t capacity, bool read_only = false)
+      : data_(data), reservable_(reservable), capacity_(capacity), read_only_(read_only) {}
+
+  /** Start of the slice - subclasses must set this */
+  uint8_t* base_{nullptr};
+
+  /** Offset in bytes from the start of the slice to the start of the Data section */
+  uint64_t data_;
+
+  /** Offset in bytes from the start of the slice to the start of the Reservable section */
+  uint64_t reservable_;
+
+  /** Total number of bytes in the slice */
+  uint64_t capacity_;
+
+  /** Whether reserve() has been called without a matching commit() */
+  bool reservation_outstanding_{false};
+
+  /** Whether the storage is referenced rather than owned, so that nothing may be written to it */
+  const bool read_only_;
+};
+
+typedef std::unique_ptr<Slice> SlicePtr;
+
+/**
+ * A Slice that owns its storage. The slice header and its storage are allocated as one block.
+ * Blocks of up to slabCapacity() bytes come in a small number of fixed size classes and are
+ * recycled through a per-thread free list, so steady-state proxying doesn't hit malloc for every
+ * read or write.
+ */
+class OwnedSlice : public Slice, NonCopyable {
+public:
+  /**
+   * Create an empty OwnedSlice.
+   * @param capacity number of bytes of space the slice should have. The slice may have more
+   *        space than requested; capacity is rounded up to a multiple of the page size.
+   * @return an OwnedSlice with at least the specified capacity.
+   */
+  static SlicePtr create(uint64_t capacity);
+
+  /**
+   * Create an OwnedSlice and initialize it with a copy of the supplied data.
+   * @param data the content to copy into the slice.
+   * @param size length of the content.
+   * @return an OwnedSlice containing a copy of the content, which may (dependent on
+   *         the internal implementation) have a nonzero amount of reservable space at the end.
+   */
+  static SlicePtr create(const void* data, uint64_t size) {
+    SlicePtr slice = create(size);
+    slice->append(data, size);
+    return slice;
+  }
+
+  /**
+   * @return the largest slice capacity that is recycled through the per-thread slab free lists.
+   */
+  static constexpr uint64_t slabCapacity() { return PageSize * NumSlabClasses; }
+
+  /**
+   * @return the number of free slabs of the given capacity cached by the calling thread. Only
+   *         intended for tests.
+   */
+  static uint64_t cachedSlabsForTest(uint64_t capacity);
+
+  // Deallocation goes back through the slab allocator. This also keeps C++14 from selecting the
+  // global sized operator delete(void*, size_t) as the cleanup for the placement new below.
+  static void operator delete(void* address);
+
+private:
+  OwnedSlice(uint64_t capacity) : Slice(0, 0, capacity) { base_ = storage_; }
+
+  static void* operator new(size_t object_size, uint64_t capacity);
+
+  static constexpr uint64_t PageSize = 4096;
+  static constexpr uint64_t NumSlabClasses = 4;
+
+  uint8_t storage_[];
+};
+
+/**
+ * Queue of SlicePtr that supports efficient read and write access to both
+ * the front and the back of the queue.
+ * @note This class has similar properties to std::deque<T>. The reason for using
+ *       a custom deque implementation is that benchmark testing during development
+ *       revealed that std::deque was too slow to reach performance parity with the
+ *       prior evbuffer-based buffer implementation.
+ */
+class SliceDeque : NonCopyable {
+public:
+  SliceDeque() : ring_(inline_ring_), capacity_(InlineRingCapacity) {}
+
+  ~SliceDeque() { clear(); }
+
+  void emplace_back(SlicePtr&& slice) {
+    growRing();
+    ring_[internalIndex(size_)] = std::move(slice);
+    size_++;
+  }
+
+  void emplace_front(SlicePtr&& slice) {
+    growRing();
+    start_ = (start_ == 0) ? capacity_ - 1 : start_ - 1;
+    ring_[start_] = std::move(slice);
+    size_++;
+  }
+
+  bool empty() const { return size() == 0; }
+  size_t size() const { return size_; }
+
+  SlicePtr& front() { return ring_[start_]; }
+  const SlicePtr& front() const { return ring_[start_]; }
+  SlicePtr& back() { return ring_[internalIndex(size_ - 1)]; }
+  const SlicePtr& back() const { return ring_[internalIndex(size_ - 1)]; }
+
+  SlicePtr& operator[](size_t i) { return ring_[internalIndex(i)]; }
+  const SlicePtr& operator[](size_t i) const { return ring_[internalIndex(i)]; }
+
+  void pop_front() {
+    if (size() == 0) {
+      return;
+    }
+    front() = SlicePtr();
+    size_--;
+    start_++;
+    if (start_ == capacity_) {
+      start_ = 0;
+    }
+  }
+
+  void pop_back() {
+    if (size() == 0) {
+      return;
+    }
+    back() = SlicePtr();
+    size_--;
+  }
+
+  void clear() {
+    while (!empty()) {
+      pop_front();
+    }
+  }
+
+private:
+  constexpr static size_t InlineRingCapacity = 8;
+
+  size_t internalIndex(size_t index) const {
+    size_t internal_index = start_ + index;
+    if (internal_index >= capacity_) {
+      internal_index -= capacity_;
+      ASSERT(internal_index < capacity_);
+    }
+    return internal_index;
+  }
+
+  void growRing() {
+    if (size_ < capacity_) {
+      return;
+    }
+    const size_t new_capacity = capacity_ * 2;
+    std::unique_ptr<SlicePtr[]> new_ring(new SlicePtr[new_capacity]);
+    for (size_t i = 0; i < size_; i++) {
+      new_ring[i] = std::move(ring_[internalIndex(i)]);
+    }
+    external_ring_.swap(new_ring);
+    ring_ = external_ring_.get();
+    start_ = 0;
+    capacity_ = new_capacity;
+  }
+
+  SlicePtr inline_ring_[InlineRingCapacity];
+  std::unique_ptr<SlicePtr[]> external_ring_;
+  SlicePtr* ring_; // points to start of either inline or external ring.
+  size_t start_{0};
+  size_t size_{0};
+  size_t capacity_;
+};
+
+/**
+ * A read-only Slice that references externally owned data supplied via a BufferFragment. The
+ * fragment's done() is called when the slice is destroyed.
+ */
+class UnownedSlice : public Slice {
+public:
+  UnownedSlice(BufferFragment& fragment)
+      : Slice(0, fragment.size(), fragment.size(), true), fragment_(fragment) {
+    base_ = static_cast<uint8_t*>(const_cast<void*>(fragment.data()));
+  }
+
+  ~UnownedSlice() override { fragment_.done(); }
+
+private:
+  BufferFragment& fragment_;
+};
+
+/**
+ * A read-only Slice that references part of the storage of another slice. The storage is released
+ * once no SharedSlice references it anymore. This splits a slice between buffers without copying
+ * its content.
+ */
+class SharedSlice : public Slice {
+public:
+  SharedSlice(std::shared_ptr<Slice> storage, uint8_t* data, uint64_t size)
+      : Slice(0, size, size, true), storage_(std::move(storage)) {
+    base_ = data;
+  }
+
+  /**
+   * @return the slice whose storage this slice references.
+   */
+  const std::shared_ptr<Slice>& storage() const { return storage_; }
+
+private:
+  const std::shared_ptr<Slice> storage_;
+};
+
 class LibEventInstance : public Instance {
 public:
   // Allows access into the underlying buffer for move() optimizations.
@@ -55,10 +439,17 @@ public:
 };
 
 /**
- * Wraps an allocated and owned evbuffer.
+ * Wraps an allocated and owned buffer.
+ *
+ * By default the content is stored in a SliceDeque of OwnedSlice/UnownedSlice, so move() and
+ * drain() of whole slices are pointer operations. The original evbuffer-backed implementation is
+ * still available via useOldImpl() (see the --use-libevent-buffers command line option).
+ *
+ * Copying a buffer with add(const Instance&) references rather than copies the large read-only
+ * slices of the source, such as those split by move() or frozen by share().
  *
- * Note that due to the internals of move() accessing buffer(), OwnedImpl is not
- * compatible with non-LibEventInstance buffers.
+ * Note that due to the internals of move(), OwnedImpl is not compatible with non-OwnedImpl
+ * buffers, and all buffers in the process must use the same underlying implementation.
  */
 class OwnedImpl : public LibEventInstance {
 public:
@@ -66,6 +457,9 @@ public:
   OwnedImpl(const std::string& data);
   OwnedImpl(const Instance& data);
   OwnedImpl(const void* data, uint64_t size);
+  // Moving transfers the content, leaving rhs empty but usable.
+  OwnedImpl(OwnedImpl&& rhs);
+  OwnedImpl& operator=(OwnedImpl&& rhs);
 
   // LibEventInstance
   void add(const void* data, uint64_t size) override;
@@ -89,9 +483,69 @@ public:
   void postProcess() override {}
   std::string toString() const override;
 
-  Event::Libevent::BufferPtr& buffer() override { return buffer_; }
+  Event::Libevent::BufferPtr& buffer() override {
+    ASSERT(old_impl_);
+    return buffer_;
+  }
+
+  /**
+   * Move the first length bytes of rhs to the end of this buffer without copying them, so that
+   * pointers previously obtained from rhs.getRawSlices() stay valid for as long as this buffer
+   * holds the data. If length ends part way through a slice, the whole slice is moved and the
+   * content that follows length is copied back into a new slice at the front of rhs. This buffer
+   * is then longer than length; it is intended to keep the data alive rather than to be read.
+   * Only supported by the slice based implementation.
+   * @param rhs the buffer to move data from.
+   * @param length the number of bytes to move.
+   */
+  void pin(OwnedImpl& rhs, uint64_t length);
+
+  /**
+   * Only supported by the slice based implementation.
+   * @param data supplies a pointer into the content of this buffer.
+   * @return whether the slice holding data owns its storage, so that it may be written to.
+   */
+  bool writable(const void* data) const;
+
+  /**
+   * Append the content of data to this buffer, sharing its large slices instead of copying them.
+   * Those slices become read-only in both buffers, and their storage is released once neither
+   * buffer, nor any later copy of either, references it. Small slices are copied. The evbuffer
+   * based implementation copies everything.
+   * @param data the buffer to share the content of. Its content is unchanged.
+   */
+  void share(Instance& data);
+
+  /**
+   * Select the evbuffer (true) or slice (false) based implementation for buffers constructed
+   * after this call. This is intended to be called once at startup, before any buffers exist.
+   */
+  static void useOldImpl(bool use_old_impl) { use_old_impl_ = use_old_impl; }
+
+  /**
+   * @return whether newly constructed buffers use the evbuffer based implementation.
+   */
+  static bool usingOldImpl() { return use_old_impl_; }
 
 private:
+  // Copy data to the end of the buffer, coalescing it into the last slice if there is room.
+  void addImpl(const void* data, uint64_t size);
+
+  // Release the slices of an empty buffer, except for those of an outstanding reservation.
+  void releaseEmptySlices();
+
+  // Moving less than this many bytes of a slice copies them rather than sharing the slice.
+  static constexpr uint64_t MinSharedMoveSize = 4096;
+
+  // Whether this buffer uses the evbuffer based implementation.
+  const bool old_impl_;
+  static bool use_old_impl_;
+
+  // Used by the slice based implementation.
+  SliceDeque slices_;
+  uint64_t length_{0};
+
+  // Used by the evbuffer based implementation.
   Event::Libevent::BufferPtr buffer_;
 };
 
@@ -0,0 +1,104 @@
+#include "common/buffer/memory_account.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Buffer {
+
+MemoryAccount::~MemoryAccount() { close(); }
+
+void MemoryAccount::charge(uint64_t bytes) {
+  balance_.fetch_add(bytes, std::memory_order_relaxed);
+  if (id_ == 0 && !closed_) {
+    MemoryAccountRegistrySingleton::get().add(*this);
+  }
+}
+
+void MemoryAccount::credit(uint64_t bytes) {
+  ASSERT(balance() >= bytes);
+  balance_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void MemoryAccount::close() {
+  closed_ = true;
+  if (id_ != 0) {
+    MemoryAccountRegistrySingleton::get().remove(*this);
+  }
+}
+
+void MemoryAccountRegistry::add(MemoryAccount& account) {
+  Thread::LockGuard lock(lock_);
+  account.id_ = next_id_++;
+  accounts_.emplace(account.id_, &account);
+}
+
+void MemoryAccountRegistry::remove(MemoryAccount& account) {
+  Thread::LockGuard lock(lock_);
+  accounts_.erase(account.id_);
+  account.id_ = 0;
+}
+
+std::vector<MemoryAccount*> MemoryAccountRegistry::largestAccounts(size_t count) {
+  std::vector<MemoryAccount*> accounts;
+  accounts.reserve(accounts_.size());
+  for (const auto& entry : accounts_) {
+    accounts.push_back(entry.second);
+  }
+
+  count = std::min(count, accounts.size());
+  std::partial_sort(accounts.begin(), accounts.begin() + count, accounts.end(),
+                    [](const MemoryAccount* lhs, const MemoryAccount* rhs) {
+                      return lhs->balance() > rhs->balance();
+                    });
+  accounts.resize(count);
+  return accounts;
+}
+
+std::vector<MemoryConsumer> MemoryAccountRegistry::largest(size_t count) {
+  Thread::LockGuard lock(lock_);
+  std::vector<MemoryConsumer> consumers;
+  for (const MemoryAccount* account : largestAccounts(count)) {
+    consumers.push_back({account->describe(), account->balance()});
+  }
+  return consumers;
+}
+
+size_t MemoryAccountRegistry::resetLargest(size_t count) {
+  std::vector<std::pair<Event::Dispatcher*, uint64_t>> resets;
+  {
+    Thread::LockGuard lock(lock_);
+    for (const MemoryAccount* account : largestAccounts(count)) {
+      if (account->balance() == 0) {
+        break;
+      }
+      ENVOY_LOG(info, "resetting {} holding {} bytes", account->describe(), account->balance());
+      resets.emplace_back(&account->dispatcher_, account->id_);
+    }
+  }
+
+  for (const auto& reset : resets) {
+    const uint64_t id = reset.second;
+    reset.first->post([this, id]() -> void {
+      // Accounts are only removed on their own dispatcher, so the account found here stays alive
+      // until it is reset.
+      MemoryAccount* account = nullptr;
+      {
+        Thread::LockGuard lock(lock_);
+        auto it = accounts_.find(id);
+        if (it != accounts_.end()) {
+          account = it->second;
+        }
+      }
+      if (account != nullptr) {
+        account->resetOwner();
+      }
+    });
+  }
+  return resets.size();
+}
+
+} // namespace Buffer
+} // namespace Envoy
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/common/pure.h"
+#include "envoy/event/dispatcher.h"
+
+#include "common/common/logger.h"
+#include "common/common/non_copyable.h"
+#include "common/common/thread.h"
+#include "common/singleton/threadsafe_singleton.h"
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * The memory held in the buffers of a stream or connection. It is charged and credited by the
+ * WatermarkBuffers bound to it on the thread of its owner, and registers with the
+ * MemoryAccountRegistry the first time it holds memory so that the largest consumers of the
+ * process can be listed and reset.
+ */
+class MemoryAccount : NonCopyable {
+public:
+  MemoryAccount(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+  virtual ~MemoryAccount();
+
+  void charge(uint64_t bytes);
+  void credit(uint64_t bytes);
+  uint64_t balance() const { return balance_.load(std::memory_order_relaxed); }
+
+  /**
+   * Removes the account from the registry once its owner is going away, so that it is neither
+   * listed nor reset again.
+   */
+  void close();
+
+  /**
+   * @return a description of the owner of the account. It is called from any thread while the
+   *         account is registered, so it may only use state that never changes.
+   */
+  virtual std::string describe() const PURE;
+
+  /**
+   * Resets the owner of the account to release its memory. Called on the dispatcher of the
+   * account.
+   */
+  virtual void resetOwner() PURE;
+
+private:
+  friend class MemoryAccountRegistry;
+
+  Event::Dispatcher& dispatcher_;
+  std::atomic<uint64_t> balance_{0};
+  // Key of the account in the registry, non zero while it is registered.
+  uint64_t id_{0};
+  bool closed_{false};
+};
+
+/**
+ * A registered account and the memory it held.
+ */
+struct MemoryConsumer {
+  std::string description_;
+  uint64_t bytes_;
+};
+
+/**
+ * The accounts of the process that hold memory. Accounts are only registered while their owner
+ * is alive, so no state outlives them.
+ */
+class MemoryAccountRegistry : Logger::Loggable<Logger::Id::main> {
+public:
+  /**
+   * @return the count largest consumers, largest first.
+   */
+  std::vector<MemoryConsumer> largest(size_t count);
+
+  /**
+   * Resets the owners of the count largest accounts, each on its own dispatcher.
+   * @return the number of owners being reset.
+   */
+  size_t resetLargest(size_t count);
+
+private:
+  friend class MemoryAccount;
+
+  void add(MemoryAccount& account);
+  void remove(MemoryAccount& account);
+  std::vector<MemoryAccount*> largestAccounts(size_t count) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  Thread::MutexBasicLockable lock_;
+  uint64_t next_id_ GUARDED_BY(lock_){1};
+  std::unordered_map<uint64_t, MemoryAccount*> accounts_ GUARDED_BY(lock_);
+};
+
+typedef ThreadSafeSingleton<MemoryAccountRegistry> MemoryAccountRegistrySingleton;
+
+} // namespace Buffer
+} // namespace Envoy
@@ -0,0 +1,103 @@
+#include "common/buffer/slab_pool.h"
+
+#include <sys/mman.h>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Buffer {
+
+namespace {
+
+constexpr uint64_t BlockAlignment = 64;
+
+uint64_t roundUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+constexpr uint64_t SlabPool::HugePageSize;
+constexpr uint32_t SlabPool::MaxSizeClasses;
+std::atomic<SlabPool*> SlabPool::pool_{nullptr};
+
+SlabPool::SlabPool(uint64_t size) : size_(roundUp(size, HugePageSize)) {
+  void* mapping = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  mapping = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (mapping != MAP_FAILED) {
+    mapping_ = base_ = mapping;
+    mapping_size_ = size_;
+    huge_pages_ = true;
+    return;
+  }
+#endif
+
+  // Without enough reserved huge pages, map regular pages aligned to a huge page so that
+  // transparent huge pages can back the whole region.
+  mapping_size_ = size_ + HugePageSize;
+  mapping =
+      ::mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED) {
+    size_ = 0;
+    mapping_size_ = 0;
+    return;
+  }
+  mapping_ = mapping;
+  base_ = reinterpret_cast<void*>(roundUp(reinterpret_cast<uintptr_t>(mapping), HugePageSize));
+#ifdef MADV_HUGEPAGE
+  ::madvise(base_, size_, MADV_HUGEPAGE);
+#endif
+}
+
+SlabPool::~SlabPool() {
+  if (mapping_ != nullptr) {
+    ::munmap(mapping_, mapping_size_);
+  }
+}
+
+void* SlabPool::allocate(uint32_t size_class, uint64_t size) {
+  ASSERT(size_class < MaxSizeClasses);
+  size = roundUp(size, BlockAlignment);
+  void* block = nullptr;
+  {
+    Thread::LockGuard lock(lock_);
+    if (free_blocks_[size_class] != nullptr) {
+      block = free_blocks_[size_class];
+      free_blocks_[size_class] = free_blocks_[size_class]->next_;
+    } else if (carved_ + size <= size_) {
+      block = static_cast<uint8_t*>(base_) + carved_;
+      carved_ += size;
+    }
+  }
+
+  if (block == nullptr) {
+    fallbacks_++;
+    return nullptr;
+  }
+  allocated_bytes_ += size;
+  return block;
+}
+
+void SlabPool::release(uint32_t size_class, uint64_t size, void* block) {
+  ASSERT(size_class < MaxSizeClasses);
+  ASSERT(owns(block));
+  allocated_bytes_ -= roundUp(size, BlockAlignment);
+  FreeBlock* free_block = static_cast<FreeBlock*>(block);
+  Thread::LockGuard lock(lock_);
+  free_block->next_ = free_blocks_[size_class];
+  free_blocks_[size_class] = free_block;
+}
+
+void SlabPool::initialize(uint64_t size) {
+  static Thread::MutexBasicLockable initialize_lock;
+  Thread::LockGuard lock(initialize_lock);
+  if (pool_.load() == nullptr) {
+    pool_.store(new SlabPool(size), std::memory_order_release);
+  }
+}
+
+} // namespace Buffer
+} // namespace Envoy
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "common/common/non_copyable.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * A region of memory reserved up front for the slabs of buffers. The region is backed by
+ * explicitly reserved 2MB huge pages when the kernel has enough of them, and otherwise by regular
+ * pages that the kernel is advised to back with transparent huge pages. Packing slabs into huge
+ * pages cuts the TLB misses of buffer heavy workloads, and keeps the slabs from fragmenting the
+ * heap.
+ *
+ * Blocks are carved from the region on demand and recycled through a free list per size class.
+ * The per-thread slab caches of OwnedSlice sit in front of the pool, so its lock is only taken
+ * when the cache of a thread is empty or full. Allocations the pool cannot serve fall back to the
+ * heap.
+ */
+class SlabPool : NonCopyable {
+public:
+  static constexpr uint64_t HugePageSize = 2 * 1024 * 1024;
+  static constexpr uint32_t MaxSizeClasses = 8;
+
+  /**
+   * @param size the number of bytes to reserve, rounded up to a multiple of the huge page size.
+   */
+  explicit SlabPool(uint64_t size);
+  ~SlabPool();
+
+  /**
+   * @param size_class the size class of the block, below MaxSizeClasses.
+   * @param size the size of the blocks of the size class.
+   * @return a block of size bytes aligned to 64 bytes, or nullptr if the pool is exhausted.
+   */
+  void* allocate(uint32_t size_class, uint64_t size);
+
+  /**
+   * Returns a block allocated from the pool to the free list of its size class.
+   */
+  void release(uint32_t size_class, uint64_t size, void* block);
+
+  /**
+   * @return whether the block was allocated from the pool.
+   */
+  bool owns(const void* block) const {
+    return block >= base_ && block < static_cast<const uint8_t*>(base_) + size_;
+  }
+
+  /**
+   * @return uint64_t the number of bytes reserved, 0 if the region could not be mapped.
+   */
+  uint64_t size() const { return size_; }
+
+  /**
+   * @return bool whether the region is backed by explicitly reserved huge pages.
+   */
+  bool hugePages() const { return huge_pages_; }
+
+  /**
+   * @return uint64_t the number of bytes of the blocks handed out.
+   */
+  uint64_t allocatedBytes() const { return allocated_bytes_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return uint64_t the number of allocations that fell back to the heap because the pool was
+   *         exhausted.
+   */
+  uint64_t fallbacks() const { return fallbacks_.load(std::memory_order_relaxed); }
+
+  /**
+   * Reserves the pool from which OwnedSlice allocates its slabs. Buffers may be freed while static
+   * objects are destroyed, so the pool is never released. Later calls have no effect.
+   * @param size the number of bytes to reserve.
+   */
+  static void initialize(uint64_t size);
+
+  /**
+   * @return SlabPool* the pool from which OwnedSlice allocates its slabs, or nullptr if there is
+   *         none.
+   */
+  static SlabPool* get() { return pool_.load(std::memory_order_acquire); }
+
+private:
+  struct FreeBlock {
+    FreeBlock* next_;
+  };
+
+  uint64_t size_;
+  void* base_{};
+  // The mapping, which starts before base_ when it had to be aligned by hand.
+  void* mapping_{};
+  uint64_t mapping_size_{};
+  bool huge_pages_{};
+
+  Thread::MutexBasicLockable lock_;
+  // The number of bytes carved from the region so far.
+  uint64_t carved_ GUARDED_BY(lock_){};
+  FreeBlock* free_blocks_[MaxSizeClasses] GUARDED_BY(lock_){};
+
+  std::atomic<uint64_t> allocated_bytes_{};
+  std::atomic<uint64_t> fallbacks_{};
+
+  static std::atomic<SlabPool*> pool_;
+};
+
+} // namespace Buffer
+} // namespace Envoy
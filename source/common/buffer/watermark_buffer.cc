@@ -1,15 +1,24 @@
 #include "common/buffer/watermark_buffer.h"
 
+#include <algorithm>
+
 #include "common/common/assert.h"
 
 namespace Envoy {
 namespace Buffer {
 
+WatermarkBuffer::~WatermarkBuffer() { setAccount(nullptr); }
+
 void WatermarkBuffer::add(const void* data, uint64_t size) {
   OwnedImpl::add(data, size);
   checkHighWatermark();
 }
 
+void WatermarkBuffer::addBufferFragment(BufferFragment& fragment) {
+  OwnedImpl::addBufferFragment(fragment);
+  checkHighWatermark();
+}
+
 void WatermarkBuffer::add(const std::string& data) {
   OwnedImpl::add(data);
   checkHighWatermark();
@@ -68,27 +77,107 @@ Api::SysCallIntResult WatermarkBuffer::write(int fd) {
   return result;
 }
 
+constexpr std::chrono::milliseconds WatermarkBuffer::AutoTuneDrainTime;
+constexpr std::chrono::milliseconds WatermarkBuffer::AutoTuneIdleTimeout;
+
 void WatermarkBuffer::setWatermarks(uint32_t low_watermark, uint32_t high_watermark) {
   ASSERT(low_watermark < high_watermark || (high_watermark == 0 && low_watermark == 0));
   low_watermark_ = low_watermark;
   high_watermark_ = high_watermark;
+  base_high_watermark_ = high_watermark;
   checkHighWatermark();
   checkLowWatermark();
 }
 
+void WatermarkBuffer::setAutoTuning(uint32_t max_high_watermark, TimeSource& time_source) {
+  if (max_high_watermark <= base_high_watermark_) {
+    max_high_watermark_ = 0;
+    time_source_ = nullptr;
+    setWatermarks(base_high_watermark_ / 2, base_high_watermark_);
+    return;
+  }
+
+  max_high_watermark_ = max_high_watermark;
+  time_source_ = &time_source;
+  low_watermark_time_ = time_source.monotonicTime();
+}
+
+void WatermarkBuffer::setAccount(MemoryAccount* account) {
+  updateLength();
+  if (account_ != nullptr) {
+    account_->credit(last_length_);
+  }
+  account_ = account;
+  if (account_ != nullptr) {
+    account_->charge(last_length_);
+  }
+}
+
+void WatermarkBuffer::updateLength() {
+  const uint64_t length = OwnedImpl::length();
+  if (length > last_length_) {
+    if (account_ != nullptr) {
+      account_->charge(length - last_length_);
+    }
+  } else if (length < last_length_) {
+    if (account_ != nullptr) {
+      account_->credit(last_length_ - length);
+    }
+    drained_ += last_length_ - length;
+  }
+  last_length_ = length;
+}
+
+void WatermarkBuffer::autoTune() {
+  const MonotonicTime now = time_source_->monotonicTime();
+  const uint64_t elapsed_ms = std::max<uint64_t>(
+      1, std::chrono::duration_cast<std::chrono::milliseconds>(now - high_watermark_time_).count());
+  // The bytes the buffer drains in AutoTuneDrainTime at the rate observed while it was above the
+  // low watermark, which approximates the bandwidth delay product of the reader.
+  const uint64_t target =
+      (drained_ - drained_at_high_watermark_) * AutoTuneDrainTime.count() / elapsed_ms;
+  const uint64_t high_watermark =
+      std::min<uint64_t>(std::max<uint64_t>(target, high_watermark_ / 2),
+                         std::min<uint64_t>(uint64_t(high_watermark_) * 2, max_high_watermark_));
+  high_watermark_ = std::max<uint64_t>(high_watermark, base_high_watermark_);
+  low_watermark_ = high_watermark_ / 2;
+  low_watermark_time_ = now;
+}
+
 void WatermarkBuffer::checkLowWatermark() {
+  updateLength();
   if (!above_high_watermark_called_ ||
       (high_watermark_ != 0 && OwnedImpl::length() >= low_watermark_)) {
     return;
   }
 
+  if (time_source_ != nullptr && high_watermark_ != 0) {
+    autoTune();
+  }
   above_high_watermark_called_ = false;
   below_low_watermark_();
 }
 
 void WatermarkBuffer::checkHighWatermark() {
+  updateLength();
   if (above_high_watermark_called_ || high_watermark_ == 0 ||
-      OwnedImpl::length() <= high_watermark_) {
+      OwnedImpl::length() <= base_high_watermark_) {
+    return;
+  }
+
+  if (time_source_ != nullptr) {
+    const MonotonicTime now = time_source_->monotonicTime();
+    if (high_watermark_ > base_high_watermark_ && now - low_watermark_time_ > AutoTuneIdleTimeout) {
+      // The reader has not been throttled for a while, so stop holding on to a larger buffer.
+      high_watermark_ = base_high_watermark_;
+      low_watermark_ = base_high_watermark_ / 2;
+    }
+    if (OwnedImpl::length() <= high_watermark_) {
+      return;
+    }
+    drained_at_high_watermark_ = drained_;
+    high_watermark_time_ = now;
+  } else if (OwnedImpl::length() <= high_watermark_) {
     return;
   }
 
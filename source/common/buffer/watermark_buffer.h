@@ -1,9 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <string>
 
+#include "envoy/common/time.h"
+
 #include "common/buffer/buffer_impl.h"
+#include "common/buffer/memory_account.h"
 
 namespace Envoy {
 namespace Buffer {
@@ -18,10 +22,12 @@ public:
   WatermarkBuffer(std::function<void()> below_low_watermark,
                   std::function<void()> above_high_watermark)
       : below_low_watermark_(below_low_watermark), above_high_watermark_(above_high_watermark) {}
+  ~WatermarkBuffer();
 
   // Override all functions from Instance which can result in changing the size
   // of the underlying buffer.
   void add(const void* data, uint64_t size) override;
+  void addBufferFragment(BufferFragment& fragment) override;
   void add(const std::string& data) override;
   void add(const Instance& data) override;
   void prepend(absl::string_view data) override;
@@ -39,9 +45,34 @@ public:
   void setWatermarks(uint32_t low_watermark, uint32_t high_watermark);
   uint32_t highWatermark() const { return high_watermark_; }
 
+  /**
+   * Let the high watermark adapt to the rate at which the buffer is drained, between the high
+   * watermark set by setWatermarks() and max_high_watermark. Each time the buffer drops below the
+   * low watermark after going above the high one, the high watermark is set to the bytes the
+   * buffer drains in AutoTuneDrainTime at the rate observed meanwhile, at most doubling or halving
+   * it at a time. A buffer drained quickly, such as the write buffer of a connection to a fast
+   * peer on a high latency link, grows so that its writer is paused less often, while one drained
+   * slowly by a slow reader stays small. After AutoTuneIdleTimeout without going above the high
+   * watermark, the buffer goes back to the configured watermark.
+   * @param max_high_watermark supplies the largest high watermark. 0 disables auto tuning.
+   * @param time_source supplies the time source to measure the drain rate with.
+   */
+  void setAutoTuning(uint32_t max_high_watermark, TimeSource& time_source);
+
+  static constexpr std::chrono::milliseconds AutoTuneDrainTime{100};
+  static constexpr std::chrono::milliseconds AutoTuneIdleTimeout{1000};
+
+  /**
+   * Charges the bytes held by the buffer to an account, which must outlive the buffer or be
+   * replaced first. Pass nullptr to stop charging.
+   */
+  void setAccount(MemoryAccount* account);
+
 private:
   void checkHighWatermark();
   void checkLowWatermark();
+  void updateLength();
+  void autoTune();
 
   std::function<void()> below_low_watermark_;
   std::function<void()> above_high_watermark_;
@@ -54,6 +85,22 @@ private:
   // True between the time above_high_watermark_ has been called until above_high_watermark_ has
   // been called.
   bool above_high_watermark_called_{false};
+  MemoryAccount* account_{};
+  // The length of the buffer when it was last checked, which is also the number of bytes charged
+  // to account_.
+  uint64_t last_length_{0};
+
+  // Auto tuning state, see setAutoTuning().
+  TimeSource* time_source_{};
+  uint32_t base_high_watermark_{0};
+  uint32_t max_high_watermark_{0};
+  // The bytes drained from the buffer since auto tuning was enabled.
+  uint64_t drained_{0};
+  // The drained_ count and time when the buffer last went above the high watermark.
+  uint64_t drained_at_high_watermark_{0};
+  MonotonicTime high_watermark_time_;
+  // When the buffer last dropped below the low watermark.
+  MonotonicTime low_watermark_time_;
 };
 
 typedef std::unique_ptr<WatermarkBuffer> WatermarkBufferPtr;
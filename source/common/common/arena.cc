@@ -0,0 +1,78 @@
+#include "common/common/arena.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+
+Arena::~Arena() {
+  while (blocks_ != nullptr) {
+    Block* next = blocks_->next_;
+    ::operator delete(blocks_);
+    blocks_ = next;
+  }
+}
+
+void* Arena::allocate(uint64_t size, uint64_t alignment) {
+  ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0);
+  uintptr_t aligned = (reinterpret_cast<uintptr_t>(current_) + alignment - 1) & ~(alignment - 1);
+  if (current_ == nullptr || aligned + size > reinterpret_cast<uintptr_t>(end_)) {
+    // The block header is a multiple of the maximum fundamental alignment, so block data starts
+    // suitably aligned for anything but over-aligned types.
+    static_assert(sizeof(Block) % alignof(std::max_align_t) == 0, "");
+    const uint64_t block_size = std::max(next_block_size_, size + alignment);
+    Block* block = static_cast<Block*>(::operator new(sizeof(Block) + block_size));
+    block->next_ = blocks_;
+    block->size_ = block_size;
+    blocks_ = block;
+    num_blocks_++;
+    current_ = reinterpret_cast<uint8_t*>(block + 1);
+    end_ = current_ + block_size;
+    next_block_size_ *= 2;
+    aligned = (reinterpret_cast<uintptr_t>(current_) + alignment - 1) & ~(alignment - 1);
+  }
+
+  uint8_t* result = reinterpret_cast<uint8_t*>(aligned);
+  bytes_allocated_ += (result + size) - current_;
+  current_ = result + size;
+  return result;
+}
+
+constexpr uint64_t ArenaSizeHistogram::MinBlockSize;
+constexpr uint64_t ArenaSizeHistogram::MaxBlockSize;
+constexpr uint64_t ArenaSizeHistogram::DefaultBlockSize;
+constexpr uint64_t ArenaSizeHistogram::CoveredPercent;
+constexpr uint64_t ArenaSizeHistogram::DecayInterval;
+constexpr size_t ArenaSizeHistogram::NumBuckets;
+
+void ArenaSizeHistogram::record(uint64_t bytes) {
+  size_t bucket = 0;
+  while (bucket < NumBuckets - 1 && (MinBlockSize << bucket) < bytes) {
+    bucket++;
+  }
+  counts_[bucket]++;
+  if (++total_ == DecayInterval) {
+    total_ = 0;
+    for (uint64_t& count : counts_) {
+      count /= 2;
+      total_ += count;
+    }
+  }
+}
+
+uint64_t ArenaSizeHistogram::recommendedBlockSize() const {
+  if (total_ == 0) {
+    return DefaultBlockSize;
+  }
+  uint64_t covered = 0;
+  for (size_t bucket = 0; bucket < NumBuckets; bucket++) {
+    covered += counts_[bucket];
+    if (covered * 100 >= total_ * CoveredPercent) {
+      return MinBlockSize << bucket;
+    }
+  }
+  return MaxBlockSize;
+}
+
+} // namespace Envoy
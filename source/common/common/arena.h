@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+
+/**
+ * A simple bump pointer arena. Memory is carved out of a chain of blocks and is only returned to
+ * the system when the arena is destroyed, so many small objects sharing a lifetime cost a handful
+ * of allocations instead of one each. No block is allocated until the first allocation, so an
+ * unused arena is free. Objects placed in the arena are not destroyed by the arena; see
+ * ArenaDeleter.
+ */
+class Arena : NonCopyable {
+public:
+  /**
+   * @param initial_block_size supplies the size of the first block. Subsequent blocks double in
+   *        size, and any allocation larger than the next block gets a block of its own.
+   */
+  explicit Arena(uint64_t initial_block_size) : next_block_size_(initial_block_size) {}
+  ~Arena();
+
+  /**
+   * Allocate memory from the arena.
+   * @param size supplies the number of bytes to allocate.
+   * @param alignment supplies the required alignment, which must be a power of two.
+   * @return void* the allocated memory, which is valid until the arena is destroyed.
+   */
+  void* allocate(uint64_t size, uint64_t alignment = alignof(std::max_align_t));
+
+  /**
+   * @return uint64_t the number of bytes handed out by allocate(), including alignment padding.
+   */
+  uint64_t bytesAllocated() const { return bytes_allocated_; }
+
+  /**
+   * @return uint64_t the number of blocks allocated from the system.
+   */
+  uint64_t numBlocks() const { return num_blocks_; }
+
+private:
+  struct Block {
+    Block* next_;
+    uint64_t size_;
+  };
+
+  Block* blocks_{};
+  uint8_t* current_{};
+  uint8_t* end_{};
+  uint64_t next_block_size_;
+  uint64_t bytes_allocated_{};
+  uint64_t num_blocks_{};
+};
+
+/**
+ * unique_ptr deleter for an object that may live in an Arena. Arena memory is reclaimed with the
+ * arena, so only the destructor is run; heap objects are deleted as usual.
+ */
+class ArenaDeleter {
+public:
+  ArenaDeleter() {}
+  explicit ArenaDeleter(bool in_arena) : in_arena_(in_arena) {}
+
+  template <class T> void operator()(T* object) const {
+    if (in_arena_) {
+      object->~T();
+    } else {
+      delete object;
+    }
+  }
+
+private:
+  bool in_arena_{false};
+};
+
+template <class T> using ArenaPtr = std::unique_ptr<T, ArenaDeleter>;
+
+/**
+ * Construct an object in an arena.
+ * @param arena supplies the arena to construct the object in. If nullptr, the object is allocated
+ *        on the heap.
+ * @param args supplies the constructor arguments.
+ * @return ArenaPtr<T> the new object.
+ */
+template <class T, class... Args> ArenaPtr<T> makeArenaPtr(Arena* arena, Args&&... args) {
+  if (arena == nullptr) {
+    return ArenaPtr<T>(new T(std::forward<Args>(args)...), ArenaDeleter(false));
+  }
+  return ArenaPtr<T>(new (arena->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...),
+                     ArenaDeleter(true));
+}
+
+/**
+ * STL allocator backed by an Arena. Deallocation is a no-op for arena memory, which suits
+ * containers that only grow for the lifetime of the arena. With a nullptr arena, the allocator
+ * falls back to the heap.
+ */
+template <class T> class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+  template <class U> ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    if (arena_ == nullptr) {
+      return std::allocator<T>().allocate(n);
+    }
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, size_t n) {
+    if (arena_ == nullptr) {
+      std::allocator<T>().deallocate(p, n);
+    }
+  }
+
+  Arena* arena() const { return arena_; }
+
+  template <class U> bool operator==(const ArenaAllocator<U>& rhs) const {
+    return arena_ == rhs.arena();
+  }
+  template <class U> bool operator!=(const ArenaAllocator<U>& rhs) const {
+    return arena_ != rhs.arena();
+  }
+
+private:
+  Arena* arena_;
+};
+
+/**
+ * Running histogram of the arena sizes used by a class of objects (e.g. HTTP streams), used to
+ * pick an initial block size for the next arena that is large enough for most of them. Sizes are
+ * bucketed by power of two and old samples decay, so the estimate follows changes in traffic.
+ */
+class ArenaSizeHistogram {
+public:
+  /**
+   * Record the number of bytes used by an arena.
+   */
+  void record(uint64_t bytes);
+
+  /**
+   * @return uint64_t the smallest bucket size that covers CoveredPercent of the recent samples,
+   *         or DefaultBlockSize if there are none.
+   */
+  uint64_t recommendedBlockSize() const;
+
+  static constexpr uint64_t MinBlockSize = 256;
+  static constexpr uint64_t MaxBlockSize = 64 * 1024;
+  static constexpr uint64_t DefaultBlockSize = 1024;
+  static constexpr uint64_t CoveredPercent = 90;
+  // Counts are halved once this many samples have been recorded.
+  static constexpr uint64_t DecayInterval = 1024;
+
+private:
+  // One bucket per power of two from MinBlockSize to MaxBlockSize inclusive.
+  static constexpr size_t NumBuckets = 9;
+
+  std::array<uint64_t, NumBuckets> counts_{};
+  uint64_t total_{};
+};
+
+} // namespace Envoy
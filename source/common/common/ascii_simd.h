@@ -0,0 +1,98 @@
+#pragma once
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Envoy {
+
+/**
+ * ASCII case folding of 16 byte blocks with SSE2 or NEON. Without either, no block is processed and
+ * callers fall back to their scalar loop for the whole input.
+ */
+class AsciiSimd {
+public:
+  static constexpr size_t BlockSize = 16;
+
+  /**
+   * Lowercase the ASCII letters of the whole blocks at the start of the buffer.
+   * @param buffer supplies the start of the buffer.
+   * @param size supplies the size of the buffer.
+   * @return size_t the number of bytes that were processed, a multiple of BlockSize.
+   */
+  static size_t toLowerBlocks(char* buffer, size_t size) {
+    size_t i = 0;
+#if defined(__SSE2__) || defined(__aarch64__)
+    for (; size - i >= BlockSize; i += BlockSize) {
+      store(buffer + i, toLower(load(buffer + i)));
+    }
+#else
+    (void)buffer;
+    (void)size;
+#endif
+    return i;
+  }
+
+  /**
+   * Compare the whole blocks at the start of two buffers ignoring the case of ASCII letters,
+   * stopping at the first block that differs.
+   * @param lhs supplies the start of the first buffer.
+   * @param rhs supplies the start of the second buffer.
+   * @param size supplies the size of both buffers.
+   * @return size_t the number of bytes that are equal ignoring case, a multiple of BlockSize. The
+   *         bytes past it still need to be compared.
+   */
+  static size_t caseEqualBlocks(const char* lhs, const char* rhs, size_t size) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; size - i >= BlockSize; i += BlockSize) {
+      const __m128i equal = _mm_cmpeq_epi8(toLower(load(lhs + i)), toLower(load(rhs + i)));
+      if (_mm_movemask_epi8(equal) != 0xffff) {
+        break;
+      }
+    }
+#elif defined(__aarch64__)
+    for (; size - i >= BlockSize; i += BlockSize) {
+      if (vminvq_u8(vceqq_u8(toLower(load(lhs + i)), toLower(load(rhs + i)))) != 0xff) {
+        break;
+      }
+    }
+#else
+    (void)lhs;
+    (void)rhs;
+    (void)size;
+#endif
+    return i;
+  }
+
+private:
+#if defined(__SSE2__)
+  static __m128i load(const char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+  static void store(char* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+  static __m128i toLower(__m128i v) {
+    // Bytes with the high bit set are negative, so they never fall in the signed range of the upper
+    // case letters.
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                        _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+  }
+#elif defined(__aarch64__)
+  static uint8x16_t load(const char* p) { return vld1q_u8(reinterpret_cast<const uint8_t*>(p)); }
+  static void store(char* p, uint8x16_t v) { vst1q_u8(reinterpret_cast<uint8_t*>(p), v); }
+
+  static uint8x16_t toLower(uint8x16_t v) {
+    const uint8x16_t upper = vandq_u8(vcgeq_u8(v, vdupq_n_u8('A')), vcleq_u8(v, vdupq_n_u8('Z')));
+    return vorrq_u8(v, vandq_u8(upper, vdupq_n_u8(0x20)));
+  }
+#endif
+};
+
+} // namespace Envoy
@@ -1,6 +1,8 @@
 #include "common/common/base64.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 #include "common/common/empty_string.h"
@@ -46,214 +48,306 @@ constexpr unsigned char URL_REVERSE_LOOKUP_TABLE[256] = {
     64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64};
 // clang-format on
 
-inline bool decodeBase(const uint8_t cur_char, uint64_t pos, std::string& ret,
-                       const unsigned char* const reverse_lookup_table) {
-  const unsigned char c = reverse_lookup_table[static_cast<uint32_t>(cur_char)];
-  if (c == 64) {
-    // Invalid character
-    return false;
-  }
-
-  switch (pos % 4) {
-  case 0:
-    ret.push_back(c << 2);
-    break;
-  case 1:
-    ret.back() |= c >> 4;
-    ret.push_back(c << 4);
-    break;
-  case 2:
-    ret.back() |= c >> 2;
-    ret.push_back(c << 6);
-    break;
-  case 3:
-    ret.back() |= c;
-    break;
+// Encodes whole groups of three bytes into four characters each. Each group is handled as one
+// 24-bit word, so there is no per byte state to carry.
+inline void encodeGroups(const uint8_t* input, uint64_t num_groups, char* output,
+                         const char* const char_table) {
+  for (; num_groups > 0; --num_groups, input += 3, output += 4) {
+    const uint32_t word = (input[0] << 16) | (input[1] << 8) | input[2];
+    output[0] = char_table[word >> 18];
+    output[1] = char_table[(word >> 12) & 0x3f];
+    output[2] = char_table[(word >> 6) & 0x3f];
+    output[3] = char_table[word & 0x3f];
   }
-  return true;
 }
 
-inline bool decodeLast(const uint8_t cur_char, uint64_t pos, std::string& ret,
-                       const unsigned char* const reverse_lookup_table) {
-  const unsigned char c = reverse_lookup_table[static_cast<uint32_t>(cur_char)];
-  if (c == 64) {
-    // Invalid character
-    return false;
+// Encodes the one or two bytes left after the last whole group, returning the number of characters
+// written.
+inline uint64_t encodeTail(const uint8_t* input, uint64_t length, char* output,
+                           const char* const char_table, bool add_padding) {
+  if (length == 0) {
+    return 0;
   }
 
-  switch (pos % 4) {
-  case 0:
-    return false;
-  case 1:
-    ret.back() |= c >> 4;
-    return (c & 0b1111) == 0;
-  case 2:
-    ret.back() |= c >> 2;
-    return (c & 0b11) == 0;
-  case 3:
-    ret.back() |= c;
-    break;
+  const uint32_t word = (input[0] << 16) | (length == 2 ? input[1] << 8 : 0);
+  output[0] = char_table[word >> 18];
+  output[1] = char_table[(word >> 12) & 0x3f];
+  if (length == 2) {
+    output[2] = char_table[(word >> 6) & 0x3f];
+  }
+  if (!add_padding) {
+    return length + 1;
   }
-  return true;
+  if (length == 1) {
+    output[2] = '=';
+  }
+  output[3] = '=';
+  return 4;
 }
 
-inline void encodeBase(const uint8_t cur_char, uint64_t pos, uint8_t& next_c, std::string& ret,
-                       const char* const char_table) {
-  switch (pos % 3) {
-  case 0:
-    ret.push_back(char_table[cur_char >> 2]);
-    next_c = (cur_char & 0x03) << 4;
-    break;
-  case 1:
-    ret.push_back(char_table[next_c | (cur_char >> 4)]);
-    next_c = (cur_char & 0x0f) << 2;
-    break;
-  case 2:
-    ret.push_back(char_table[next_c | (cur_char >> 6)]);
-    ret.push_back(char_table[cur_char & 0x3f]);
-    next_c = 0;
-    break;
+inline uint64_t encodedLength(uint64_t length, bool add_padding) {
+  return add_padding ? (length + 2) / 3 * 4 : length / 3 * 4 + (length % 3 ? length % 3 + 1 : 0);
+}
+
+// Decodes whole groups of four characters into three bytes each. Invalid characters map to 64, so
+// a single check of the or-ed lookups after the loop replaces a branch per character.
+inline bool decodeGroups(const uint8_t* input, uint64_t num_groups, uint8_t* output,
+                         const unsigned char* const reverse_lookup_table) {
+  uint32_t invalid = 0;
+  for (; num_groups > 0; --num_groups, input += 4, output += 3) {
+    const uint32_t a = reverse_lookup_table[input[0]];
+    const uint32_t b = reverse_lookup_table[input[1]];
+    const uint32_t c = reverse_lookup_table[input[2]];
+    const uint32_t d = reverse_lookup_table[input[3]];
+    invalid |= a | b | c | d;
+    const uint32_t word = (a << 18) | (b << 12) | (c << 6) | d;
+    output[0] = word >> 16;
+    output[1] = word >> 8;
+    output[2] = word;
   }
+  return (invalid & 64) == 0;
 }
 
-inline void encodeLast(uint64_t pos, uint8_t last_char, std::string& ret,
-                       const char* const char_table, bool add_padding) {
-  switch (pos % 3) {
-  case 1:
-    ret.push_back(char_table[last_char]);
-    if (add_padding) {
-      ret.push_back('=');
-      ret.push_back('=');
-    }
-    break;
-  case 2:
-    ret.push_back(char_table[last_char]);
-    if (add_padding) {
-      ret.push_back('=');
-    }
-    break;
+// Decodes the unpadded characters of a last partial group. The unused bits of the last character
+// must be zero, so that every decoded value has a single encoding.
+inline bool decodeTail(const uint8_t* input, uint64_t length, uint8_t* output,
+                       const unsigned char* const reverse_lookup_table) {
+  switch (length) {
+  case 0:
+    return true;
+  case 2: {
+    const uint32_t a = reverse_lookup_table[input[0]];
+    const uint32_t b = reverse_lookup_table[input[1]];
+    output[0] = (a << 2) | (b >> 4);
+    return ((a | b) & 64) == 0 && (b & 0b1111) == 0;
+  }
+  case 3: {
+    const uint32_t a = reverse_lookup_table[input[0]];
+    const uint32_t b = reverse_lookup_table[input[1]];
+    const uint32_t c = reverse_lookup_table[input[2]];
+    output[0] = (a << 2) | (b >> 4);
+    output[1] = (b << 4) | (c >> 2);
+    return ((a | b | c) & 64) == 0 && (c & 0b11) == 0;
+  }
   default:
-    break;
+    return false;
   }
 }
 
-} // namespace
-
-std::string Base64::decode(const std::string& input) {
-  if (input.length() % 4 || input.empty()) {
-    return EMPTY_STRING;
+// Returns the number of padding characters at the end of a padded encoding.
+inline uint64_t paddingLength(const char* input, uint64_t length) {
+  if (input[length - 1] != '=') {
+    return 0;
   }
+  return input[length - 2] == '=' ? 2 : 1;
+}
 
-  // Last position before "valid" padding character.
-  uint64_t last = input.length() - 1;
-  size_t max_length = input.length() / 4 * 3;
-  // At most last two chars can be '='.
-  if (input[input.length() - 1] == '=') {
-    max_length--;
-    last = input.length() - 2;
-    if (input[input.length() - 2] == '=') {
-      max_length--;
-      last = input.length() - 3;
-    }
-  }
+// Encodes the first length bytes of a buffer, which may split groups across slices, into output.
+// Returns the number of characters written.
+uint64_t encodeSlices(const Buffer::Instance& buffer, uint64_t length, char* output,
+                      const char* const char_table, bool add_padding) {
+  const uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  buffer.getRawSlices(slices, num_slices);
 
-  std::string ret;
-  ret.reserve(max_length);
-  for (uint64_t i = 0; i < last; ++i) {
-    if (!decodeBase(input[i], i, ret, REVERSE_LOOKUP_TABLE)) {
-      return EMPTY_STRING;
+  char* const output_start = output;
+  // The bytes of a group split between slices.
+  uint8_t carry[3];
+  uint64_t carried = 0;
+  for (const Buffer::RawSlice& slice : slices) {
+    if (length == 0) {
+      break;
+    }
+    const uint8_t* input = static_cast<const uint8_t*>(slice.mem_);
+    uint64_t size = std::min<uint64_t>(slice.len_, length);
+    length -= size;
+
+    if (carried > 0) {
+      const uint64_t taken = std::min<uint64_t>(3 - carried, size);
+      memcpy(carry + carried, input, taken);
+      carried += taken;
+      input += taken;
+      size -= taken;
+      if (carried < 3) {
+        continue;
+      }
+      encodeGroups(carry, 1, output, char_table);
+      output += 4;
+      carried = 0;
     }
-  }
 
-  if (!decodeLast(input[last], last, ret, REVERSE_LOOKUP_TABLE)) {
-    return EMPTY_STRING;
+    const uint64_t num_groups = size / 3;
+    encodeGroups(input, num_groups, output, char_table);
+    output += num_groups * 4;
+    carried = size % 3;
+    memcpy(carry, input + num_groups * 3, carried);
   }
 
-  return ret;
+  output += encodeTail(carry, carried, output, char_table, add_padding);
+  return output - output_start;
 }
 
-std::string Base64::encode(const Buffer::Instance& buffer, uint64_t length) {
-  uint64_t output_length = (std::min(length, buffer.length()) + 2) / 3 * 4;
-  std::string ret;
-  ret.reserve(output_length);
-
-  uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
+// Decodes the first length characters of a buffer, which may split groups across slices, into
+// output. The characters must not include padding.
+bool decodeSlices(const Buffer::Instance& buffer, uint64_t length, uint8_t* output,
+                  const unsigned char* const reverse_lookup_table) {
+  const uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
   Buffer::RawSlice slices[num_slices];
   buffer.getRawSlices(slices, num_slices);
 
-  uint64_t j = 0;
-  uint8_t next_c = 0;
-  for (Buffer::RawSlice& slice : slices) {
-    const uint8_t* slice_mem = static_cast<const uint8_t*>(slice.mem_);
-
-    for (uint64_t i = 0; i < slice.len_ && j < length; ++i, ++j) {
-      encodeBase(slice_mem[i], j, next_c, ret, CHAR_TABLE);
-    }
-
-    if (j == length) {
+  bool valid = true;
+  // The characters of a group split between slices.
+  uint8_t carry[4];
+  uint64_t carried = 0;
+  for (const Buffer::RawSlice& slice : slices) {
+    if (length == 0) {
       break;
     }
+    const uint8_t* input = static_cast<const uint8_t*>(slice.mem_);
+    uint64_t size = std::min<uint64_t>(slice.len_, length);
+    length -= size;
+
+    if (carried > 0) {
+      const uint64_t taken = std::min<uint64_t>(4 - carried, size);
+      memcpy(carry + carried, input, taken);
+      carried += taken;
+      input += taken;
+      size -= taken;
+      if (carried < 4) {
+        continue;
+      }
+      valid &= decodeGroups(carry, 1, output, reverse_lookup_table);
+      output += 3;
+      carried = 0;
+    }
+
+    const uint64_t num_groups = size / 4;
+    valid &= decodeGroups(input, num_groups, output, reverse_lookup_table);
+    output += num_groups * 3;
+    carried = size % 4;
+    memcpy(carry, input + num_groups * 4, carried);
   }
 
-  encodeLast(j, next_c, ret, CHAR_TABLE, true);
+  return valid && decodeTail(carry, carried, output, reverse_lookup_table);
+}
 
+// Decodes a string of unpadded characters.
+std::string decodeString(const char* input, uint64_t length,
+                         const unsigned char* const reverse_lookup_table) {
+  const uint64_t num_groups = length / 4;
+  const uint64_t tail_length = length % 4;
+  std::string ret(num_groups * 3 + (tail_length > 0 ? tail_length - 1 : 0), '\0');
+  uint8_t* output = reinterpret_cast<uint8_t*>(&ret[0]);
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(input);
+  if (!decodeGroups(data, num_groups, output, reverse_lookup_table) ||
+      !decodeTail(data + num_groups * 4, tail_length, output + num_groups * 3,
+                  reverse_lookup_table)) {
+    return EMPTY_STRING;
+  }
   return ret;
 }
 
-std::string Base64::encode(const char* input, uint64_t length) {
-  uint64_t output_length = (length + 2) / 3 * 4;
-  std::string ret;
-  ret.reserve(output_length);
+// Encodes a string, with or without padding.
+std::string encodeString(const char* input, uint64_t length, const char* const char_table,
+                         bool add_padding) {
+  std::string ret(encodedLength(length, add_padding), '\0');
+  const uint64_t num_groups = length / 3;
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(input);
+  encodeGroups(data, num_groups, &ret[0], char_table);
+  encodeTail(data + num_groups * 3, length % 3, &ret[num_groups * 4], char_table, add_padding);
+  return ret;
+}
 
-  uint64_t pos = 0;
-  uint8_t next_c = 0;
+} // namespace
 
-  for (uint64_t i = 0; i < length; ++i) {
-    encodeBase(input[i], pos++, next_c, ret, CHAR_TABLE);
+std::string Base64::decode(const std::string& input) {
+  if (input.length() % 4 || input.empty()) {
+    return EMPTY_STRING;
   }
 
-  encodeLast(pos, next_c, ret, CHAR_TABLE, true);
-
-  return ret;
+  return decodeString(input.data(), input.length() - paddingLength(input.data(), input.length()),
+                      REVERSE_LOOKUP_TABLE);
 }
 
-std::string Base64Url::decode(const std::string& input) {
-  if (input.empty()) {
-    return EMPTY_STRING;
+uint64_t Base64::decode(const char* input, uint64_t length, char* output) {
+  if (length % 4 || length == 0) {
+    return 0;
   }
 
-  std::string ret;
-  ret.reserve(input.length() / 4 * 3 + 3);
-
-  uint64_t last = input.length() - 1;
-  for (uint64_t i = 0; i < last; ++i) {
-    if (!decodeBase(input[i], i, ret, URL_REVERSE_LOOKUP_TABLE)) {
-      return EMPTY_STRING;
-    }
+  const uint64_t data_length = length - paddingLength(input, length);
+  const uint64_t num_groups = data_length / 4;
+  const uint64_t tail_length = data_length % 4;
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(input);
+  uint8_t* decoded = reinterpret_cast<uint8_t*>(output);
+  if (!decodeGroups(data, num_groups, decoded, REVERSE_LOOKUP_TABLE) ||
+      !decodeTail(data + num_groups * 4, tail_length, decoded + num_groups * 3,
+                  REVERSE_LOOKUP_TABLE)) {
+    return 0;
   }
+  return num_groups * 3 + (tail_length > 0 ? tail_length - 1 : 0);
+}
 
-  if (!decodeLast(input[last], last, ret, URL_REVERSE_LOOKUP_TABLE)) {
-    return EMPTY_STRING;
+bool Base64::decode(const Buffer::Instance& input, uint64_t length, Buffer::Instance& output) {
+  if (length % 4 || length == 0 || length > input.length()) {
+    return false;
   }
 
+  char last[2];
+  input.copyOut(length - 2, 2, last);
+  const uint64_t data_length = length - paddingLength(last, 2);
+  const uint64_t output_length = data_length / 4 * 3 + (data_length % 4 ? data_length % 4 - 1 : 0);
+
+  Buffer::RawSlice slice;
+  output.reserve(output_length, &slice, 1);
+  const bool valid =
+      decodeSlices(input, data_length, static_cast<uint8_t*>(slice.mem_), REVERSE_LOOKUP_TABLE);
+  // An invalid input commits nothing, which releases the reservation.
+  slice.len_ = valid ? output_length : 0;
+  output.commit(&slice, 1);
+  return valid;
+}
+
+std::string Base64::encode(const Buffer::Instance& buffer, uint64_t length) {
+  length = std::min(length, buffer.length());
+  std::string ret(encodedLength(length, true), '\0');
+  encodeSlices(buffer, length, &ret[0], CHAR_TABLE, true);
   return ret;
 }
 
-std::string Base64Url::encode(const char* input, uint64_t length) {
-  uint64_t output_length = (length + 2) / 3 * 4;
-  std::string ret;
-  ret.reserve(output_length);
+void Base64::encode(const Buffer::Instance& input, uint64_t length, Buffer::Instance& output) {
+  length = std::min(length, input.length());
+  if (length == 0) {
+    return;
+  }
+
+  Buffer::RawSlice slice;
+  output.reserve(encodedLength(length, true), &slice, 1);
+  slice.len_ = encodeSlices(input, length, static_cast<char*>(slice.mem_), CHAR_TABLE, true);
+  output.commit(&slice, 1);
+}
 
-  uint64_t pos = 0;
-  uint8_t next_c = 0;
+std::string Base64::encode(const char* input, uint64_t length) {
+  return encodeString(input, length, CHAR_TABLE, true);
+}
 
-  for (uint64_t i = 0; i < length; ++i) {
-    encodeBase(input[i], pos++, next_c, ret, URL_CHAR_TABLE);
+uint64_t Base64::encode(const char* input, uint64_t length, char* output) {
+  const uint64_t num_groups = length / 3;
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(input);
+  encodeGroups(data, num_groups, output, CHAR_TABLE);
+  return num_groups * 4 +
+         encodeTail(data + num_groups * 3, length % 3, output + num_groups * 4, CHAR_TABLE, true);
+}
+
+std::string Base64Url::decode(const std::string& input) {
+  if (input.empty()) {
+    return EMPTY_STRING;
   }
 
-  encodeLast(pos, next_c, ret, URL_CHAR_TABLE, false);
+  return decodeString(input.data(), input.length(), URL_REVERSE_LOOKUP_TABLE);
+}
 
-  return ret;
+std::string Base64Url::encode(const char* input, uint64_t length) {
+  return encodeString(input, length, URL_CHAR_TABLE, false);
 }
 
 } // namespace Envoy
@@ -20,6 +20,15 @@ public:
    */
   static std::string encode(const Buffer::Instance& buffer, uint64_t length);
 
+  /**
+   * Base64 encode an input buffer, appending the encoding to an output buffer. The encoding is
+   * written directly into space reserved in the output buffer, without an intermediate string.
+   * @param input supplies the buffer to encode.
+   * @param length supplies the length to encode which may be <= the input buffer length.
+   * @param output supplies the buffer to append the encoding to.
+   */
+  static void encode(const Buffer::Instance& input, uint64_t length, Buffer::Instance& output);
+
   /**
    * Base64 encode an input char buffer with a given length.
    * @param input char array to encode.
@@ -27,6 +36,16 @@ public:
    */
   static std::string encode(const char* input, uint64_t length);
 
+  /**
+   * Base64 encode an input char buffer into an output char buffer, without allocating.
+   * @param input char array to encode.
+   * @param length of the input array.
+   * @param output supplies the char array to encode into, which must have room for
+   *        (length + 2) / 3 * 4 characters. The encoding is not null terminated.
+   * @return the number of characters written.
+   */
+  static uint64_t encode(const char* input, uint64_t length, char* output);
+
   /**
    * Base64 decode an input string. Padding is required.
    * @param input supplies the input to decode.
@@ -35,6 +54,28 @@ public:
    * bytes.
    */
   static std::string decode(const std::string& input);
+
+  /**
+   * Base64 decode an input char buffer into an output char buffer, without allocating. Padding is
+   * required.
+   * @param input supplies the characters to decode.
+   * @param length supplies the number of characters to decode.
+   * @param output supplies the buffer to decode into, which must have room for length / 4 * 3
+   *        bytes.
+   * @return the number of decoded bytes, or 0 if the input was empty or not valid base64.
+   */
+  static uint64_t decode(const char* input, uint64_t length, char* output);
+
+  /**
+   * Base64 decode the start of an input buffer, appending the decoded bytes to an output buffer.
+   * The bytes are written directly into space reserved in the output buffer. Padding is required.
+   * @param input supplies the buffer to decode.
+   * @param length supplies the number of characters to decode, which must be a multiple of 4 and
+   *        <= the input buffer length.
+   * @param output supplies the buffer to append the decoded bytes to.
+   * @return whether the input was valid base64. Nothing is appended to the output if it was not.
+   */
+  static bool decode(const Buffer::Instance& input, uint64_t length, Buffer::Instance& output);
 };
 
 /**
@@ -36,7 +36,10 @@ struct BlockMemoryHashSetOptions {
 /**
  * Implements hash_set<Value> without using pointers, suitable for use
  * in shared memory. Users must commit to capacity and num_slots at
- * construction time. Value must provide these methods:
+ * construction time. Each cell keeps part of the hash of its key, so that walking a slot's
+ * chain only compares the keys whose hash matches. Callers that hold a lock around the set can
+ * hash the key before taking it, with the overloads taking the hash. Value must provide these
+ * methods:
  *    absl::string_view Value::key()
  *    void Value::initialize(absl::string_view key)
  *    static uint64_t Value::size()
@@ -116,7 +119,9 @@ public:
         RELEASE_ASSERT(cell_index < control_->hash_set_options.capacity, "");
         Cell& cell = getCell(cell_index);
         absl::string_view key = cell.value.key();
-        RELEASE_ASSERT(computeSlot(key) == slot, "");
+        const uint64_t hash = Value::hash(key);
+        RELEASE_ASSERT(computeSlot(hash) == slot, "");
+        RELEASE_ASSERT(cell.key_hash == keyHash(hash), "");
         next = cell.next_cell_index;
         ++num_values;
       }
@@ -149,19 +154,26 @@ public:
    * @return a pair with the value-pointer (or nullptr), and a bool indicating
    *         whether the value is newly allocated.
    */
-  ValueCreatedPair insert(absl::string_view key) {
-    Value* value = get(key);
+  ValueCreatedPair insert(absl::string_view key) { return insert(key, Value::hash(key)); }
+
+  /**
+   * Inserts a value into the set, as insert(key).
+   * @param hash supplies Value::hash(key).
+   */
+  ValueCreatedPair insert(absl::string_view key, uint64_t hash) {
+    Value* value = get(key, hash);
     if (value != nullptr) {
       return ValueCreatedPair(value, false);
     }
     if (control_->size >= control_->hash_set_options.capacity) {
       return ValueCreatedPair(nullptr, false);
     }
-    const uint32_t slot = computeSlot(key);
+    const uint32_t slot = computeSlot(hash);
     const uint32_t cell_index = control_->free_cell_index;
     Cell& cell = getCell(cell_index);
     control_->free_cell_index = cell.next_cell_index;
     cell.next_cell_index = slots_[slot];
+    cell.key_hash = keyHash(hash);
     slots_[slot] = cell_index;
     value = &cell.value;
     value->initialize(key, stats_options_);
@@ -174,13 +186,20 @@ public:
    * was found.
    * @param key the key to remove
    */
-  bool remove(absl::string_view key) {
-    const uint32_t slot = computeSlot(key);
+  bool remove(absl::string_view key) { return remove(key, Value::hash(key)); }
+
+  /**
+   * Removes the specified key from the map, as remove(key).
+   * @param hash supplies Value::hash(key).
+   */
+  bool remove(absl::string_view key, uint64_t hash) {
+    const uint32_t slot = computeSlot(hash);
+    const uint32_t key_hash = keyHash(hash);
     uint32_t* next = nullptr;
     for (uint32_t* cptr = &slots_[slot]; *cptr != Sentinal; cptr = next) {
       const uint32_t cell_index = *cptr;
       Cell& cell = getCell(cell_index);
-      if (cell.value.key() == key) {
+      if (cell.key_hash == key_hash && cell.value.key() == key) {
         // Splice current cell out of slot-chain.
         *cptr = cell.next_cell_index;
 
@@ -203,11 +222,18 @@ public:
    * Gets the value associated with a key, returning nullptr if the value was not found.
    * @param key
    */
-  Value* get(absl::string_view key) {
-    const uint32_t slot = computeSlot(key);
+  Value* get(absl::string_view key) { return get(key, Value::hash(key)); }
+
+  /**
+   * Gets the value associated with a key, as get(key).
+   * @param hash supplies Value::hash(key).
+   */
+  Value* get(absl::string_view key, uint64_t hash) {
+    const uint32_t slot = computeSlot(hash);
+    const uint32_t key_hash = keyHash(hash);
     for (uint32_t c = slots_[slot]; c != Sentinal; c = getCell(c).next_cell_index) {
       Cell& cell = getCell(c);
-      if (cell.value.key() == key) {
+      if (cell.key_hash == key_hash && cell.value.key() == key) {
         return &cell.value;
       }
     }
@@ -270,9 +296,11 @@ private:
     return true;
   }
 
-  uint32_t computeSlot(absl::string_view key) {
-    return Value::hash(key) % control_->hash_set_options.num_slots;
-  }
+  uint32_t computeSlot(uint64_t hash) { return hash % control_->hash_set_options.num_slots; }
+
+  // The bits of the hash kept in a cell. The slot is derived from the low bits, so the high bits
+  // tell apart more of the keys sharing a slot.
+  static uint32_t keyHash(uint64_t hash) { return hash >> 32; }
 
   /**
    * Computes a signature string, composed of all the non-zero 8-bit characters.
@@ -304,6 +332,7 @@ private:
    */
   struct Cell {
     uint32_t next_cell_index; // Index of next cell in map->cells_, terminated with Sentinal.
+    uint32_t key_hash;        // keyHash() of the key, checked before comparing keys.
     Value value;              // Templated value field.
   };
 
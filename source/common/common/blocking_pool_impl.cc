@@ -0,0 +1,89 @@
+#include "common/common/blocking_pool_impl.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Thread {
+
+BlockingPoolImpl::BlockingPoolImpl(uint32_t threads) {
+  for (uint32_t i = 0; i < threads; i++) {
+    threads_.emplace_back(new Thread([this]() -> void { threadRoutine(); }));
+  }
+}
+
+BlockingPoolImpl::~BlockingPoolImpl() {
+  {
+    absl::MutexLock lock(&mutex_);
+    exit_ = true;
+  }
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+BlockingWorkPtr BlockingPoolImpl::post(std::function<void()> work, Event::Dispatcher& dispatcher,
+                                       std::function<void()> on_complete) {
+  auto shared_work = std::make_shared<Work>(std::move(work), dispatcher, std::move(on_complete));
+  BlockingWorkPtr handle = std::make_unique<Handle>(shared_work);
+  if (threads_.empty()) {
+    run(shared_work);
+  } else {
+    absl::MutexLock lock(&mutex_);
+    ASSERT(!exit_);
+    queue_.push_back(std::move(shared_work));
+  }
+  return handle;
+}
+
+BlockingPoolImpl::Handle::~Handle() {
+  absl::MutexLock lock(&work_->mutex_);
+  // Once the work has finished, it no longer touches the state of the handle's owner.
+  work_->mutex_.Await(absl::Condition(work_.get(), &Work::notRunning));
+  work_->phase_ = Phase::Cancelled;
+}
+
+void BlockingPoolImpl::run(const WorkSharedPtr& work) {
+  {
+    absl::MutexLock lock(&work->mutex_);
+    if (work->phase_ == Phase::Cancelled) {
+      return;
+    }
+    work->phase_ = Phase::Running;
+  }
+  work->work_();
+  {
+    absl::MutexLock lock(&work->mutex_);
+    work->phase_ = Phase::Done;
+  }
+  work->dispatcher_.post([work]() -> void {
+    {
+      absl::MutexLock lock(&work->mutex_);
+      if (work->phase_ == Phase::Cancelled) {
+        return;
+      }
+    }
+    // The handle is destroyed on the dispatcher's thread too, so it cannot be cancelled anymore.
+    work->on_complete_();
+  });
+}
+
+bool BlockingPoolImpl::readyOrExiting() const { return exit_ || !queue_.empty(); }
+
+void BlockingPoolImpl::threadRoutine() {
+  while (true) {
+    WorkSharedPtr work;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(this, &BlockingPoolImpl::readyOrExiting));
+      if (exit_) {
+        return;
+      }
+      work = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    run(work);
+  }
+}
+
+} // namespace Thread
+} // namespace Envoy
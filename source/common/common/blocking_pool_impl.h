@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/thread/blocking_pool.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Thread {
+
+/**
+ * BlockingPool backed by a fixed set of threads. A pool without threads runs the work inline, and
+ * still runs the completion callback from the dispatcher's event loop.
+ */
+class BlockingPoolImpl : public BlockingPool {
+public:
+  explicit BlockingPoolImpl(uint32_t threads);
+
+  /**
+   * Joins the threads once the work they are running finished. The work that has not started yet
+   * is dropped, so its completion callback never runs.
+   */
+  ~BlockingPoolImpl();
+
+  // Thread::BlockingPool
+  BlockingWorkPtr post(std::function<void()> work, Event::Dispatcher& dispatcher,
+                       std::function<void()> on_complete) override;
+
+private:
+  enum class Phase { Queued, Running, Done, Cancelled };
+
+  // Shared by the handle, the queue and the completion callback posted to the dispatcher.
+  struct Work {
+    Work(std::function<void()> work, Event::Dispatcher& dispatcher,
+         std::function<void()> on_complete)
+        : work_(std::move(work)), dispatcher_(dispatcher), on_complete_(std::move(on_complete)) {}
+
+    bool notRunning() const EXCLUSIVE_LOCKS_REQUIRED(mutex_) { return phase_ != Phase::Running; }
+
+    absl::Mutex mutex_;
+    Phase phase_ GUARDED_BY(mutex_){Phase::Queued};
+    std::function<void()> work_;
+    Event::Dispatcher& dispatcher_;
+    std::function<void()> on_complete_;
+  };
+  typedef std::shared_ptr<Work> WorkSharedPtr;
+
+  class Handle : public BlockingWork {
+  public:
+    explicit Handle(const WorkSharedPtr& work) : work_(work) {}
+    ~Handle();
+
+  private:
+    const WorkSharedPtr work_;
+  };
+
+  static void run(const WorkSharedPtr& work);
+  bool readyOrExiting() const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void threadRoutine();
+
+  absl::Mutex mutex_;
+  std::deque<WorkSharedPtr> queue_ GUARDED_BY(mutex_);
+  bool exit_ GUARDED_BY(mutex_){};
+  std::vector<ThreadPtr> threads_;
+};
+
+} // namespace Thread
+} // namespace Envoy
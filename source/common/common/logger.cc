@@ -48,9 +48,7 @@ void StderrSinkDelegate::flush() {
   std::cerr << std::flush;
 }
 
-void DelegatingLogSink::log(const spdlog::details::log_msg& msg) {
-  sink_->log(msg.formatted.str());
-}
+void DelegatingLogSink::log(const spdlog::details::log_msg& msg) { sink_->logMessage(msg); }
 
 DelegatingLogSinkPtr DelegatingLogSink::init() {
   DelegatingLogSinkPtr delegating_sink(new DelegatingLogSink);
@@ -74,6 +72,11 @@ std::vector<Logger>& Registry::allLoggers() {
   return *all_loggers;
 }
 
+std::string& Registry::mutableLogFormat() {
+  static std::string* log_format = new std::string(Logger::DEFAULT_LOG_FORMAT);
+  return *log_format;
+}
+
 spdlog::logger& Registry::getLog(Id id) { return *allLoggers()[static_cast<int>(id)].logger_; }
 
 void Registry::setLogLevel(spdlog::level::level_enum log_level) {
@@ -83,6 +86,7 @@ void Registry::setLogLevel(spdlog::level::level_enum log_level) {
 }
 
 void Registry::setLogFormat(const std::string& log_format) {
+  mutableLogFormat() = log_format;
   for (Logger& logger : allLoggers()) {
     logger.logger_->set_pattern(log_format);
   }
@@ -106,6 +106,14 @@ public:
   virtual void log(absl::string_view msg) PURE;
   virtual void flush() PURE;
 
+  /**
+   * Log a message along with its metadata. Delegates that format messages themselves override
+   * this, others are handed the message formatted by the logger.
+   */
+  virtual void logMessage(const spdlog::details::log_msg& msg) {
+    log(absl::string_view(msg.formatted.data(), msg.formatted.size()));
+  }
+
 protected:
   SinkDelegate* previous_delegate() { return previous_delegate_; }
 
@@ -209,6 +217,11 @@ public:
    */
   static void setLogFormat(const std::string& log_format);
 
+  /**
+   * @return const std::string& the log format last set.
+   */
+  static const std::string& logFormat() { return mutableLogFormat(); }
+
   /**
    * @return std::vector<Logger>& the installed loggers.
    */
@@ -224,6 +237,7 @@ private:
    * @return std::vector<Logger>& return the installed loggers.
    */
   static std::vector<Logger>& allLoggers();
+  static std::string& mutableLogFormat();
 };
 
 /**
@@ -1,10 +1,13 @@
 #include "common/common/logger_delegates.h"
 
+#include <algorithm>
 #include <cassert> // use direct system-assert to avoid cyclic dependency.
 #include <cstdint>
 #include <iostream>
 #include <string>
 
+#include "common/common/lock_guard.h"
+
 #include "spdlog/spdlog.h"
 
 namespace Envoy {
@@ -27,5 +30,164 @@ void FileSinkDelegate::flush() {
   log_file_->flush();
 }
 
+AsyncSinkDelegate::AsyncSinkDelegate(DelegatingLogSinkPtr log_sink, uint32_t ring_size,
+                                     std::chrono::milliseconds interval)
+    : SinkDelegate(log_sink), ring_size_(ring_size), interval_(interval),
+      generation_([] {
+        static std::atomic<uint64_t> next_generation{1};
+        return next_generation++;
+      }()),
+      log_format_(Registry::logFormat()),
+      formatter_(std::make_unique<spdlog::pattern_formatter>(log_format_)) {
+  assert(ring_size_ > 0);
+  // The loggers only copy the message, which is formatted by the logging thread.
+  Registry::setLogFormat("%v");
+  thread_.reset(new Thread::Thread([this]() -> void { threadRoutine(); }));
+}
+
+AsyncSinkDelegate::~AsyncSinkDelegate() {
+  {
+    Thread::LockGuard lock(mutex_);
+    exit_ = true;
+    wakeup_.notifyOne();
+  }
+  thread_->join();
+  Registry::setLogFormat(log_format_);
+}
+
+void AsyncSinkDelegate::log(absl::string_view msg) {
+  Ring& ring = threadRing();
+  Message* message = beginMessage(ring);
+  if (message == nullptr) {
+    return;
+  }
+  message->payload_.assign(msg.data(), msg.size());
+  message->formatted_ = true;
+  commitMessage(ring);
+}
+
+void AsyncSinkDelegate::logMessage(const spdlog::details::log_msg& msg) {
+  Ring& ring = threadRing();
+  Message* message = beginMessage(ring);
+  if (message == nullptr) {
+    return;
+  }
+  message->level_ = msg.level;
+  message->time_ = msg.time;
+  message->thread_id_ = msg.thread_id;
+  message->logger_name_ = msg.logger_name;
+  message->payload_.assign(msg.raw.data(), msg.raw.size());
+  message->formatted_ = false;
+  commitMessage(ring);
+}
+
+void AsyncSinkDelegate::flush() {
+  drain();
+  previous_delegate()->flush();
+}
+
+uint64_t AsyncSinkDelegate::droppedMessages() const {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+AsyncSinkDelegate::Message* AsyncSinkDelegate::beginMessage(Ring& ring) {
+  const uint64_t head = ring.head_.load(std::memory_order_relaxed);
+  if (head - ring.tail_.load(std::memory_order_acquire) == ring_size_) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  return &ring.messages_[head % ring_size_];
+}
+
+void AsyncSinkDelegate::commitMessage(Ring& ring) {
+  const uint64_t head = ring.head_.load(std::memory_order_relaxed) + 1;
+  ring.head_.store(head, std::memory_order_release);
+  // Wake the logging thread early rather than dropping messages of threads logging in bursts.
+  if (head - ring.tail_.load(std::memory_order_relaxed) == ring_size_ / 2 + 1) {
+    wakeup_.notifyOne();
+  }
+}
+
+AsyncSinkDelegate::Ring& AsyncSinkDelegate::threadRing() {
+  struct ThreadRing {
+    uint64_t generation_{};
+    RingSharedPtr ring_;
+  };
+  static thread_local ThreadRing thread_ring;
+  if (thread_ring.generation_ != generation_) {
+    thread_ring.generation_ = generation_;
+    thread_ring.ring_ = std::make_shared<Ring>(ring_size_);
+    Thread::LockGuard lock(rings_lock_);
+    rings_.push_back(thread_ring.ring_);
+  }
+  return *thread_ring.ring_;
+}
+
+void AsyncSinkDelegate::threadRoutine() {
+  while (true) {
+    {
+      Thread::LockGuard lock(mutex_);
+      if (!exit_) {
+        // CondVar::waitFor() does not throw, so it's safe to pass the mutex rather than the guard.
+        wakeup_.waitFor(mutex_, interval_);
+      }
+      if (exit_) {
+        break;
+      }
+    }
+    drain();
+  }
+
+  // Write the waiting messages before exiting.
+  drain();
+}
+
+void AsyncSinkDelegate::drain() {
+  std::vector<RingSharedPtr> rings;
+  {
+    Thread::LockGuard lock(rings_lock_);
+    // Release the drained rings of the threads that exited.
+    rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                [](const RingSharedPtr& ring) {
+                                  return ring.use_count() == 1 &&
+                                         ring->head_.load(std::memory_order_acquire) ==
+                                             ring->tail_.load(std::memory_order_relaxed);
+                                }),
+                 rings_.end());
+    rings = rings_;
+  }
+
+  Thread::LockGuard lock(drain_lock_);
+  for (const RingSharedPtr& ring : rings) {
+    const uint64_t head = ring->head_.load(std::memory_order_acquire);
+    for (uint64_t tail = ring->tail_.load(std::memory_order_relaxed); tail != head; ++tail) {
+      writeMessage(ring->messages_[tail % ring_size_]);
+      ring->tail_.store(tail + 1, std::memory_order_release);
+    }
+  }
+
+  const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+  if (dropped != reported_dropped_) {
+    previous_delegate()->log(fmt::format(
+        "dropped {} log messages logged while the ring of their thread was full\n",
+        dropped - reported_dropped_));
+    reported_dropped_ = dropped;
+  }
+}
+
+void AsyncSinkDelegate::writeMessage(Message& message) {
+  if (message.formatted_) {
+    previous_delegate()->log(message.payload_);
+    return;
+  }
+
+  spdlog::details::log_msg msg(message.logger_name_, message.level_);
+  msg.time = message.time_;
+  msg.thread_id = message.thread_id_;
+  msg.raw << fmt::StringRef(message.payload_.data(), message.payload_.size());
+  formatter_->format(msg);
+  previous_delegate()->logMessage(msg);
+}
+
 } // namespace Logger
 } // namespace Envoy
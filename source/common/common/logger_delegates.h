@@ -1,14 +1,18 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/filesystem/filesystem.h"
 
 #include "common/common/logger.h"
 #include "common/common/macros.h"
+#include "common/common/thread.h"
 
 #include "absl/strings/string_view.h"
 
@@ -34,6 +38,91 @@ private:
   Filesystem::FileSharedPtr log_file_;
 };
 
+/**
+ * SinkDelegate handing log messages to a logging thread, which formats them and writes them to the
+ * delegate that was installed before it. Each thread logs into its own ring of messages without
+ * taking a lock, and messages logged while the ring of their thread is full are dropped and
+ * counted. While installed, the loggers only capture the message and its metadata, the log format
+ * being applied by the logging thread. Flushes, which follow critical messages, drain the rings
+ * synchronously.
+ */
+class AsyncSinkDelegate : public SinkDelegate {
+public:
+  /**
+   * @param log_sink supplies the sink to install the delegate on.
+   * @param ring_size supplies the number of messages each thread can have waiting to be written.
+   * @param interval supplies how often the logging thread writes the waiting messages.
+   */
+  AsyncSinkDelegate(DelegatingLogSinkPtr log_sink, uint32_t ring_size,
+                    std::chrono::milliseconds interval);
+  ~AsyncSinkDelegate();
+
+  // SinkDelegate
+  void log(absl::string_view msg) override;
+  void logMessage(const spdlog::details::log_msg& msg) override;
+  void flush() override;
+
+  /**
+   * @return uint64_t the number of messages dropped because the ring of their thread was full.
+   */
+  uint64_t droppedMessages() const;
+
+private:
+  struct Message {
+    spdlog::level::level_enum level_;
+    spdlog::log_clock::time_point time_;
+    size_t thread_id_;
+    const std::string* logger_name_;
+    // Keeps its capacity across messages, so that steady state logging does not allocate.
+    std::string payload_;
+    // Whether the payload is already formatted, for messages logged without metadata.
+    bool formatted_;
+  };
+
+  /**
+   * Single producer single consumer ring of the messages of a thread.
+   */
+  struct Ring {
+    Ring(uint32_t size) : messages_(size) {}
+
+    std::vector<Message> messages_;
+    // Written by the thread of the ring, read by the logging thread.
+    std::atomic<uint64_t> head_{};
+    // Written by the logging thread, read by the thread of the ring.
+    std::atomic<uint64_t> tail_{};
+  };
+  typedef std::shared_ptr<Ring> RingSharedPtr;
+
+  /**
+   * @return Message* the slot of the next message of the thread's ring, or nullptr if the ring
+   *         is full. The message is handed to the logging thread by commitMessage().
+   */
+  Message* beginMessage(Ring& ring);
+  void commitMessage(Ring& ring);
+  Ring& threadRing();
+  void threadRoutine();
+  void drain();
+  void writeMessage(Message& message);
+
+  const uint32_t ring_size_;
+  const std::chrono::milliseconds interval_;
+  // Distinguishes the rings of this delegate in the thread local storage from those of delegates
+  // installed earlier.
+  const uint64_t generation_;
+  const std::string log_format_;
+  std::unique_ptr<spdlog::formatter> formatter_;
+  Thread::MutexBasicLockable rings_lock_;
+  std::vector<RingSharedPtr> rings_ GUARDED_BY(rings_lock_);
+  std::atomic<uint64_t> dropped_{};
+  // Serializes draining between the logging thread and flushes.
+  Thread::MutexBasicLockable drain_lock_;
+  uint64_t reported_dropped_ GUARDED_BY(drain_lock_){};
+  Thread::MutexBasicLockable mutex_;
+  Thread::CondVar wakeup_;
+  bool exit_ GUARDED_BY(mutex_){};
+  Thread::ThreadPtr thread_;
+};
+
 } // namespace Logger
 
 } // namespace Envoy
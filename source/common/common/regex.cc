@@ -0,0 +1,136 @@
+#include "common/common/regex.h"
+
+#include <regex>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+
+#include "re2/re2.h"
+
+namespace Envoy {
+namespace Regex {
+namespace {
+
+class CompiledGoogleReMatcher : public CompiledMatcher {
+public:
+  CompiledGoogleReMatcher(const std::string& regex, uint32_t max_program_size)
+      : regex_(regex, options()) {
+    if (!regex_.ok()) {
+      throw EnvoyException(fmt::format("Invalid regex '{}': {}", regex, regex_.error()));
+    }
+    const int program_size = regex_.ProgramSize();
+    if (static_cast<uint32_t>(program_size) > max_program_size) {
+      throw EnvoyException(fmt::format("regex '{}' RE2 program size of {} > max program size of {}",
+                                       regex, program_size, max_program_size));
+    }
+  }
+
+  // CompiledMatcher
+  bool match(absl::string_view value) const override {
+    return regex_.Match(re2::StringPiece(value.data(), value.size()), 0, value.size(),
+                        re2::RE2::ANCHOR_BOTH, nullptr, 0);
+  }
+  bool search(absl::string_view value, absl::string_view* submatches,
+              size_t num_submatches) const override {
+    ASSERT(num_submatches <= numCaptureGroups() + 1);
+    // Stat tag extraction needs at most three submatches, so avoid allocating in the common case.
+    re2::StringPiece stack_pieces[MaxStackSubmatches];
+    std::vector<re2::StringPiece> heap_pieces;
+    re2::StringPiece* pieces = stack_pieces;
+    if (num_submatches > MaxStackSubmatches) {
+      heap_pieces.resize(num_submatches);
+      pieces = heap_pieces.data();
+    }
+    if (!regex_.Match(re2::StringPiece(value.data(), value.size()), 0, value.size(),
+                      re2::RE2::UNANCHORED, pieces, num_submatches)) {
+      return false;
+    }
+    for (size_t i = 0; i < num_submatches; i++) {
+      submatches[i] = pieces[i].data() == nullptr ? absl::string_view()
+                                                  : absl::string_view(pieces[i].data(),
+                                                                      pieces[i].size());
+    }
+    return true;
+  }
+  size_t numCaptureGroups() const override { return regex_.NumberOfCapturingGroups(); }
+
+private:
+  static constexpr size_t MaxStackSubmatches = 4;
+
+  static re2::RE2::Options options() {
+    re2::RE2::Options options;
+    options.set_log_errors(false);
+    return options;
+  }
+
+  const re2::RE2 regex_;
+};
+
+class CompiledStdMatcher : public CompiledMatcher {
+public:
+  CompiledStdMatcher(const std::string& regex) : regex_(parse(regex)) {}
+
+  // CompiledMatcher
+  bool match(absl::string_view value) const override {
+    return std::regex_match(value.begin(), value.end(), regex_);
+  }
+  bool search(absl::string_view value, absl::string_view* submatches,
+              size_t num_submatches) const override {
+    ASSERT(num_submatches <= numCaptureGroups() + 1);
+    std::cmatch match;
+    if (!std::regex_search(value.begin(), value.end(), match, regex_)) {
+      return false;
+    }
+    for (size_t i = 0; i < num_submatches; i++) {
+      submatches[i] = match[i].matched ? absl::string_view(match[i].first, match[i].length())
+                                       : absl::string_view();
+    }
+    return true;
+  }
+  size_t numCaptureGroups() const override { return regex_.mark_count(); }
+
+private:
+  static std::regex parse(const std::string& regex) {
+    try {
+      return std::regex(regex, std::regex::optimize);
+    } catch (const std::regex_error& e) {
+      throw EnvoyException(fmt::format("Invalid regex '{}': {}", regex, e.what()));
+    }
+  }
+
+  const std::regex regex_;
+};
+
+} // namespace
+
+constexpr uint32_t Utility::DefaultMaxProgramSize;
+
+CompiledMatcherPtr Utility::parseRegex(const std::string& regex) {
+  return parseRegex(regex, defaultEngine());
+}
+
+CompiledMatcherPtr Utility::parseRegex(const std::string& regex, Engine engine) {
+  switch (engine) {
+  case Engine::GoogleRe2:
+    return std::make_unique<CompiledGoogleReMatcher>(regex, maxProgramSize());
+  case Engine::StdRegex:
+    return std::make_unique<CompiledStdMatcher>(regex);
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+Engine& Utility::mutableDefaultEngine() {
+  static Engine engine = Engine::GoogleRe2;
+  return engine;
+}
+
+uint32_t& Utility::mutableMaxProgramSize() {
+  static uint32_t max_program_size = DefaultMaxProgramSize;
+  return max_program_size;
+}
+
+} // namespace Regex
+} // namespace Envoy
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "envoy/common/regex.h"
+
+namespace Envoy {
+namespace Regex {
+
+/**
+ * Regex engines that CompiledMatchers can be built with.
+ */
+enum class Engine {
+  // RE2, which matches in time linear in the size of the input and never recurses. Regexes are
+  // limited to the RE2 syntax (no backreferences or lookaround assertions).
+  GoogleRe2,
+  // std::regex with the ECMAScript grammar. Backtracking, so matching can be exponential in the
+  // size of the input and may overflow the stack on long inputs.
+  StdRegex,
+};
+
+/**
+ * Utilities for constructing CompiledMatchers.
+ */
+class Utility {
+public:
+  /**
+   * Compile a regex with the default engine.
+   * @param regex supplies the regular expression.
+   * @return CompiledMatcherPtr the compiled regex.
+   * @throw EnvoyException if the regex is invalid or exceeds the maximum program size.
+   */
+  static CompiledMatcherPtr parseRegex(const std::string& regex);
+
+  /**
+   * Compile a regex with a specific engine.
+   * @param regex supplies the regular expression.
+   * @param engine supplies the engine to compile the regex with.
+   * @return CompiledMatcherPtr the compiled regex.
+   * @throw EnvoyException if the regex is invalid or exceeds the maximum program size.
+   */
+  static CompiledMatcherPtr parseRegex(const std::string& regex, Engine engine);
+
+  /**
+   * Set the engine used by parseRegex(const std::string&). This is process wide, and must be set
+   * before any configuration is loaded.
+   */
+  static void setDefaultEngine(Engine engine) { mutableDefaultEngine() = engine; }
+  static Engine defaultEngine() { return mutableDefaultEngine(); }
+
+  /**
+   * Set the maximum program size of RE2 regexes. The program size is a rough measure of the cost
+   * of compiling and evaluating a regex, and bounds the memory used by each compiled regex. Regexes
+   * with a larger program fail to compile. This is process wide, and must be set before any
+   * configuration is loaded.
+   */
+  static void setMaxProgramSize(uint32_t max_program_size) {
+    mutableMaxProgramSize() = max_program_size;
+  }
+  static uint32_t maxProgramSize() { return mutableMaxProgramSize(); }
+
+  static constexpr uint32_t DefaultMaxProgramSize = 1000;
+
+private:
+  static Engine& mutableDefaultEngine();
+  static uint32_t& mutableMaxProgramSize();
+};
+
+} // namespace Regex
+} // namespace Envoy
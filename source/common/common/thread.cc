@@ -1,11 +1,14 @@
 #include "common/common/thread.h"
 
 #ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
 #include <sys/syscall.h>
 #elif defined(__APPLE__)
 #include <pthread.h>
 #endif
 
+#include <algorithm>
 #include <functional>
 
 #include "common/common/assert.h"
@@ -37,10 +40,76 @@ int32_t Thread::currentThreadId() {
 #endif
 }
 
+bool Thread::setCurrentThreadCpuAffinity(uint32_t cpu) {
+#ifdef __linux__
+  if (cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+  UNREFERENCED_PARAMETER(cpu);
+  return false;
+#endif
+}
+
 void Thread::join() {
   int rc = pthread_join(thread_id_, nullptr);
   RELEASE_ASSERT(rc == 0, "");
 }
 
+std::atomic<bool> MutexContention::enabled_{false};
+std::atomic<uint64_t> MutexContention::contentions_{0};
+std::atomic<uint64_t> MutexContention::wait_time_ns_{0};
+std::array<std::atomic<uint64_t>, MutexContention::NumBuckets> MutexContention::buckets_{};
+
+void MutexContention::enable(bool enabled) {
+  if (enabled && !enabled_.load()) {
+    contentions_ = 0;
+    wait_time_ns_ = 0;
+    for (auto& bucket : buckets_) {
+      bucket = 0;
+    }
+  }
+  enabled_ = enabled;
+}
+
+void MutexContention::record(std::chrono::nanoseconds wait) {
+  contentions_.fetch_add(1, std::memory_order_relaxed);
+  wait_time_ns_.fetch_add(wait.count(), std::memory_order_relaxed);
+  buckets_[bucket(wait)].fetch_add(1, std::memory_order_relaxed);
+}
+
+MutexContention::Profile MutexContention::profile() {
+  Profile result;
+  result.contentions_ = contentions_.load(std::memory_order_relaxed);
+  result.wait_time_ = std::chrono::nanoseconds(wait_time_ns_.load(std::memory_order_relaxed));
+  for (size_t i = 0; i < NumBuckets; i++) {
+    result.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+size_t MutexContention::bucket(std::chrono::nanoseconds wait) {
+  const uint64_t wait_us = std::chrono::duration_cast<std::chrono::microseconds>(wait).count();
+  if (wait_us == 0) {
+    return 0;
+  }
+  // A wait of [2^(n-1), 2^n) microseconds falls in bucket n.
+  const size_t bucket = 64 - __builtin_clzll(wait_us);
+  return std::min(bucket, NumBuckets - 1);
+}
+
+void MutexBasicLockable::profiledLock() {
+  if (mutex_.TryLock()) {
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  mutex_.Lock();
+  MutexContention::record(std::chrono::steady_clock::now() - start);
+}
+
 } // namespace Thread
 } // namespace Envoy
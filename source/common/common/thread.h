@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 
@@ -25,6 +28,14 @@ public:
    */
   static ThreadId currentThreadId();
 
+  /**
+   * Pin the current thread to a CPU. Memory the thread touches first is then allocated on that
+   * CPU's NUMA node under the default memory policy.
+   * @return bool whether the thread was pinned. This fails for CPUs that do not exist or are not
+   *         available to the process, and on platforms without thread affinity support.
+   */
+  static bool setCurrentThreadCpuAffinity(uint32_t cpu);
+
   /**
    * Join on thread exit.
    */
@@ -37,18 +48,77 @@ private:
 
 typedef std::unique_ptr<Thread> ThreadPtr;
 
+/**
+ * Process wide profile of the contended acquisitions of MutexBasicLockable, with the time spent
+ * waiting on them. While the profile is disabled, lock() only pays for a relaxed atomic load.
+ */
+class MutexContention {
+public:
+  // Wait time buckets. The first bucket holds the waits under 1us, and each following bucket the
+  // waits up to twice as long as the previous one. The last bucket holds all the longer waits.
+  static constexpr size_t NumBuckets = 24;
+
+  struct Profile {
+    uint64_t contentions_{};
+    std::chrono::nanoseconds wait_time_{};
+    std::array<uint64_t, NumBuckets> buckets_{};
+  };
+
+  /**
+   * Enable or disable the profile. Enabling a disabled profile clears it.
+   */
+  static void enable(bool enabled);
+
+  /**
+   * @return bool whether contended acquisitions are being profiled.
+   */
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  /**
+   * Record a contended acquisition.
+   * @param wait supplies the time spent waiting for the mutex.
+   */
+  static void record(std::chrono::nanoseconds wait);
+
+  /**
+   * @return Profile the contended acquisitions recorded since the profile was last enabled.
+   */
+  static Profile profile();
+
+  /**
+   * @return size_t the wait time bucket of a wait.
+   */
+  static size_t bucket(std::chrono::nanoseconds wait);
+
+private:
+  static std::atomic<bool> enabled_;
+  static std::atomic<uint64_t> contentions_;
+  static std::atomic<uint64_t> wait_time_ns_;
+  static std::array<std::atomic<uint64_t>, NumBuckets> buckets_;
+};
+
 /**
  * Implementation of BasicLockable
  */
 class MutexBasicLockable : public BasicLockable {
 public:
   // BasicLockable
-  void lock() EXCLUSIVE_LOCK_FUNCTION() override { mutex_.Lock(); }
+  void lock() EXCLUSIVE_LOCK_FUNCTION() override {
+    if (MutexContention::enabled()) {
+      profiledLock();
+    } else {
+      mutex_.Lock();
+    }
+  }
   bool tryLock() EXCLUSIVE_TRYLOCK_FUNCTION(true) override { return mutex_.TryLock(); }
   void unlock() UNLOCK_FUNCTION() override { mutex_.Unlock(); }
 
 private:
   friend class CondVar;
+
+  // Times the acquisition when the mutex is contended.
+  void profiledLock() EXCLUSIVE_LOCK_FUNCTION(mutex_);
+
   absl::Mutex mutex_;
 };
 
@@ -1,5 +1,7 @@
 #include "common/common/to_lower_table.h"
 
+#include "common/common/ascii_simd.h"
+
 namespace Envoy {
 ToLowerTable::ToLowerTable() {
   for (size_t c = 0; c < 256; c++) {
@@ -11,7 +13,7 @@ ToLowerTable::ToLowerTable() {
 }
 
 void ToLowerTable::toLowerCase(char* buffer, uint32_t size) const {
-  for (size_t i = 0; i < size; i++) {
+  for (size_t i = AsciiSimd::toLowerBlocks(buffer, size); i < size; i++) {
     buffer[i] = table_[static_cast<uint8_t>(buffer[i])];
   }
 }
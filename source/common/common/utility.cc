@@ -9,6 +9,7 @@
 
 #include "envoy/common/exception.h"
 
+#include "common/common/ascii_simd.h"
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
 #include "common/common/hash.h"
@@ -218,6 +219,11 @@ ConstMemoryStreamBuffer::ConstMemoryStreamBuffer(const char* data, size_t size)
 InputConstMemoryStream::InputConstMemoryStream(const char* data, size_t size)
     : ConstMemoryStreamBuffer{data, size}, std::istream{static_cast<std::streambuf*>(this)} {}
 
+MemoryStreamBuffer::MemoryStreamBuffer(char* data, size_t size) { this->setp(data, data + size); }
+
+OutputMemoryStream::OutputMemoryStream(char* data, size_t size)
+    : MemoryStreamBuffer{data, size}, std::ostream{static_cast<std::streambuf*>(this)} {}
+
 bool DateUtil::timePointValid(SystemTime time_point) {
   return std::chrono::duration_cast<std::chrono::milliseconds>(time_point.time_since_epoch())
              .count() != 0;
@@ -291,40 +297,53 @@ absl::string_view StringUtil::rtrim(absl::string_view source) {
 
 absl::string_view StringUtil::trim(absl::string_view source) { return ltrim(rtrim(source)); }
 
-bool StringUtil::findToken(absl::string_view source, absl::string_view delimiters,
-                           absl::string_view key_token, bool trim_whitespace) {
-  const auto tokens = splitToken(source, delimiters, trim_whitespace);
-  if (trim_whitespace) {
-    for (const auto token : tokens) {
-      if (key_token == trim(token)) {
+namespace {
+
+// Whether any of the tokens of source satisfies the predicate. The tokens are scanned in place
+// rather than split into a vector. Empty tokens are only kept when trimming whitespace, as
+// findToken() always did.
+template <class Predicate>
+bool anyToken(absl::string_view source, absl::string_view delimiters, bool trim_whitespace,
+              Predicate predicate) {
+  while (true) {
+    // A single delimiter, which is the common case, is found with memchr().
+    const size_t end = delimiters.size() == 1 ? source.find(delimiters[0])
+                                              : source.find_first_of(delimiters);
+    const absl::string_view token = source.substr(0, end);
+    if (trim_whitespace) {
+      if (predicate(StringUtil::trim(token))) {
         return true;
       }
+    } else if (!token.empty() && predicate(token)) {
+      return true;
     }
-    return false;
+    if (end == absl::string_view::npos) {
+      return false;
+    }
+    source.remove_prefix(end + 1);
   }
+}
+
+} // namespace
 
-  return std::find(tokens.begin(), tokens.end(), key_token) != tokens.end();
+bool StringUtil::findToken(absl::string_view source, absl::string_view delimiters,
+                           absl::string_view key_token, bool trim_whitespace) {
+  return anyToken(source, delimiters, trim_whitespace,
+                  [key_token](absl::string_view token) { return token == key_token; });
 }
 
 bool StringUtil::caseFindToken(absl::string_view source, absl::string_view delimiters,
                                absl::string_view key_token, bool trim_whitespace) {
-  const auto tokens = splitToken(source, delimiters, trim_whitespace);
-  std::function<bool(absl::string_view)> predicate;
-
-  if (trim_whitespace) {
-    predicate = [&](absl::string_view token) { return caseCompare(key_token, trim(token)); };
-  } else {
-    predicate = [&](absl::string_view token) { return caseCompare(key_token, token); };
-  }
-
-  return std::find_if(tokens.begin(), tokens.end(), predicate) != tokens.end();
+  return anyToken(source, delimiters, trim_whitespace,
+                  [key_token](absl::string_view token) { return caseCompare(key_token, token); });
 }
 
 bool StringUtil::caseCompare(absl::string_view lhs, absl::string_view rhs) {
   if (rhs.size() != lhs.size()) {
     return false;
   }
-  return absl::StartsWithIgnoreCase(rhs, lhs);
+  const size_t equal = AsciiSimd::caseEqualBlocks(lhs.data(), rhs.data(), lhs.size());
+  return absl::EqualsIgnoreCase(lhs.substr(equal), rhs.substr(equal));
 }
 
 absl::string_view StringUtil::cropRight(absl::string_view source, absl::string_view delimiter) {
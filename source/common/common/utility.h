@@ -125,6 +125,29 @@ public:
   InputConstMemoryStream(const char* data, size_t size);
 };
 
+/**
+ * Class used for creating non-allocating std::ostream's. See OutputMemoryStream below.
+ */
+class MemoryStreamBuffer : public std::streambuf {
+public:
+  MemoryStreamBuffer(char* data, size_t size);
+};
+
+/**
+ * std::ostream class similar to std::ostringstream, except that it writes into a region of memory
+ * supplied by the caller rather than allocating. Writes beyond the end of the region fail, and set
+ * the badbit of the stream.
+ */
+class OutputMemoryStream : public virtual MemoryStreamBuffer, public std::ostream {
+public:
+  OutputMemoryStream(char* data, size_t size);
+
+  /**
+   * @return the number of bytes written to the region.
+   */
+  size_t size() const { return pptr() - pbase(); }
+};
+
 /**
  * Utility class for date/time helpers.
  */
@@ -10,16 +10,13 @@ namespace Compressor {
 ZlibCompressorImpl::ZlibCompressorImpl() : ZlibCompressorImpl(4096) {}
 
 ZlibCompressorImpl::ZlibCompressorImpl(uint64_t chunk_size)
-    : chunk_size_{chunk_size}, initialized_{false}, chunk_char_ptr_(new unsigned char[chunk_size]),
-      zstream_ptr_(new z_stream(), [](z_stream* z) {
+    : chunk_size_{chunk_size}, initialized_{false}, zstream_ptr_(new z_stream(), [](z_stream* z) {
         deflateEnd(z);
         delete z;
       }) {
   zstream_ptr_->zalloc = Z_NULL;
   zstream_ptr_->zfree = Z_NULL;
   zstream_ptr_->opaque = Z_NULL;
-  zstream_ptr_->avail_out = chunk_size_;
-  zstream_ptr_->next_out = chunk_char_ptr_.get();
 }
 
 void ZlibCompressorImpl::init(CompressionLevel comp_level, CompressionStrategy comp_strategy,
@@ -42,14 +39,14 @@ void ZlibCompressorImpl::compress(Buffer::Instance& buffer, State state) {
     zstream_ptr_->avail_in = input_slice.len_;
     zstream_ptr_->next_in = static_cast<Bytef*>(input_slice.mem_);
     // Z_NO_FLUSH tells the compressor to take the data in and compresses it as much as possible
-    // without flushing it out. However, if the data output is greater or equal to the allocated
-    // chunk size, process() outputs it to the end of the buffer. This is fine, since at the next
-    // step, the buffer is drained from the beginning of the buffer by the size of input.
-    process(buffer, Z_NO_FLUSH);
-    buffer.drain(input_slice.len_);
+    // without flushing it out. Whatever is output meanwhile is collected apart from the input,
+    // since the input slices must stay valid until they have all been consumed.
+    process(output_, Z_NO_FLUSH);
   }
 
-  process(buffer, state == State::Finish ? Z_FINISH : Z_SYNC_FLUSH);
+  process(output_, state == State::Finish ? Z_FINISH : Z_SYNC_FLUSH);
+  buffer.drain(buffer.length());
+  buffer.move(output_);
 }
 
 bool ZlibCompressorImpl::deflateNext(int64_t flush_state) {
@@ -72,25 +69,48 @@ bool ZlibCompressorImpl::deflateNext(int64_t flush_state) {
 }
 
 void ZlibCompressorImpl::process(Buffer::Instance& output_buffer, int64_t flush_state) {
+  // zlib writes straight into space reserved at the end of the output, so the compressed bytes are
+  // never copied.
+  Buffer::RawSlice output_slice;
+  reserveOutput(output_buffer, output_slice);
   while (deflateNext(flush_state)) {
     if (zstream_ptr_->avail_out == 0) {
-      updateOutput(output_buffer);
+      commitOutput(output_buffer, output_slice);
+      reserveOutput(output_buffer, output_slice);
     }
   }
 
-  if (flush_state == Z_SYNC_FLUSH || flush_state == Z_FINISH) {
-    updateOutput(output_buffer);
-  }
+  commitOutput(output_buffer, output_slice);
+}
+
+void ZlibCompressorImpl::reserveOutput(Buffer::Instance& output_buffer,
+                                       Buffer::RawSlice& output_slice) {
+  output_buffer.reserve(chunk_size_, &output_slice, 1);
+  zstream_ptr_->avail_out = output_slice.len_;
+  zstream_ptr_->next_out = static_cast<Bytef*>(output_slice.mem_);
 }
 
-void ZlibCompressorImpl::updateOutput(Buffer::Instance& output_buffer) {
-  const uint64_t n_output = chunk_size_ - zstream_ptr_->avail_out;
-  if (n_output > 0) {
-    output_buffer.add(static_cast<void*>(chunk_char_ptr_.get()), n_output);
+void ZlibCompressorImpl::commitOutput(Buffer::Instance& output_buffer,
+                                      Buffer::RawSlice& output_slice) {
+  output_slice.len_ -= zstream_ptr_->avail_out;
+  // An uncommitted reservation is simply replaced by the next one.
+  if (output_slice.len_ > 0) {
+    output_buffer.commit(&output_slice, 1);
   }
-  chunk_char_ptr_.reset(new unsigned char[chunk_size_]);
-  zstream_ptr_->avail_out = chunk_size_;
-  zstream_ptr_->next_out = chunk_char_ptr_.get();
+  zstream_ptr_->avail_out = 0;
+  zstream_ptr_->next_out = nullptr;
+}
+
+ZlibCompressorFactory::ZlibCompressorFactory(ZlibCompressorImpl::CompressionLevel level,
+                                             ZlibCompressorImpl::CompressionStrategy strategy,
+                                             int64_t window_bits, uint64_t memory_level)
+    : level_(level), strategy_(strategy), window_bits_(window_bits), memory_level_(memory_level),
+      content_encoding_(window_bits > 15 ? "gzip" : "deflate") {}
+
+CompressorPtr ZlibCompressorFactory::createCompressor() const {
+  std::unique_ptr<ZlibCompressorImpl> compressor = std::make_unique<ZlibCompressorImpl>();
+  compressor->init(level_, strategy_, window_bits_, memory_level_);
+  return std::move(compressor);
 }
 
 } // namespace Compressor
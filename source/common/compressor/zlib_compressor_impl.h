@@ -2,6 +2,8 @@
 
 #include "envoy/compressor/compressor.h"
 
+#include "common/buffer/buffer_impl.h"
+
 #include "zlib.h"
 
 namespace Envoy {
@@ -15,8 +17,8 @@ public:
   ZlibCompressorImpl();
 
   /**
-   * Constructor that allows setting the size of compressor's output buffer. It
-   * should be called whenever a buffer size different than the 4096 bytes, normally set by the
+   * Constructor that allows setting the size of the output space reserved for the compressor at a
+   * time. It should be called whenever a size different than the 4096 bytes, normally set by the
    * default constructor, is desired. If memory is available and it makes sense to output large
    * chunks of compressed data, zlib documentation suggests buffers sizes on the order of 128K or
    * 256K bytes. @see http://zlib.net/zlib_how.html
@@ -78,14 +80,38 @@ public:
 private:
   bool deflateNext(int64_t flush_state);
   void process(Buffer::Instance& output_buffer, int64_t flush_state);
-  void updateOutput(Buffer::Instance& output_buffer);
+  void reserveOutput(Buffer::Instance& output_buffer, Buffer::RawSlice& output_slice);
+  void commitOutput(Buffer::Instance& output_buffer, Buffer::RawSlice& output_slice);
 
   const uint64_t chunk_size_;
   bool initialized_;
 
-  std::unique_ptr<unsigned char[]> chunk_char_ptr_;
+  // The output of a compress() call, which replaces its input once all of it is consumed.
+  Buffer::OwnedImpl output_;
   std::unique_ptr<z_stream, std::function<void(z_stream*)>> zstream_ptr_;
 };
 
+/**
+ * Creates zlib compressors, which produce a gzip stream when the window bits are greater than 15
+ * and a zlib (deflate) stream otherwise.
+ */
+class ZlibCompressorFactory : public CompressorFactory {
+public:
+  ZlibCompressorFactory(ZlibCompressorImpl::CompressionLevel level,
+                        ZlibCompressorImpl::CompressionStrategy strategy, int64_t window_bits,
+                        uint64_t memory_level);
+
+  // Compressor::CompressorFactory
+  CompressorPtr createCompressor() const override;
+  const std::string& contentEncoding() const override { return content_encoding_; }
+
+private:
+  const ZlibCompressorImpl::CompressionLevel level_;
+  const ZlibCompressorImpl::CompressionStrategy strategy_;
+  const int64_t window_bits_;
+  const uint64_t memory_level_;
+  const std::string content_encoding_;
+};
+
 } // namespace Compressor
 } // namespace Envoy
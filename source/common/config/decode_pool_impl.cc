@@ -0,0 +1,83 @@
+#include "common/config/decode_pool_impl.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Config {
+
+DecodePoolImpl::DecodePoolImpl(uint32_t threads) {
+  for (uint32_t i = 0; i < threads; i++) {
+    threads_.emplace_back(new Thread::Thread([this]() -> void { threadRoutine(); }));
+  }
+}
+
+DecodePoolImpl::~DecodePoolImpl() {
+  {
+    absl::MutexLock lock(&mutex_);
+    ASSERT(batch_ == nullptr);
+    exit_ = true;
+  }
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+void DecodePoolImpl::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+  if (threads_.empty() || count < 2) {
+    for (size_t i = 0; i < count; i++) {
+      fn(i);
+    }
+    return;
+  }
+
+  Batch batch(count, fn);
+  {
+    absl::MutexLock lock(&mutex_);
+    ASSERT(batch_ == nullptr);
+    batch_ = &batch;
+    runBatch(batch);
+    // The threads may still be running the last indices.
+    mutex_.Await(absl::Condition(&batch, &Batch::finished));
+    batch_ = nullptr;
+  }
+
+  for (const std::exception_ptr& error : batch.errors_) {
+    if (error != nullptr) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+bool DecodePoolImpl::readyOrExiting() const {
+  return exit_ || (batch_ != nullptr && batch_->next_ < batch_->count_);
+}
+
+void DecodePoolImpl::runBatch(Batch& batch) {
+  while (batch.next_ < batch.count_) {
+    const size_t index = batch.next_++;
+    mutex_.Unlock();
+    try {
+      batch.fn_(index);
+    } catch (...) {
+      batch.errors_[index] = std::current_exception();
+    }
+    mutex_.Lock();
+    batch.done_++;
+  }
+  // Once all the indices have been run the caller may return as soon as the mutex is released, so
+  // the batch must not be touched anymore.
+}
+
+void DecodePoolImpl::threadRoutine() {
+  absl::MutexLock lock(&mutex_);
+  while (true) {
+    mutex_.Await(absl::Condition(this, &DecodePoolImpl::readyOrExiting));
+    if (exit_) {
+      return;
+    }
+    runBatch(*batch_);
+  }
+}
+
+} // namespace Config
+} // namespace Envoy
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <exception>
+#include <functional>
+#include <vector>
+
+#include "envoy/config/decode_pool.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Config {
+
+/**
+ * DecodePool backed by a fixed set of threads. The calling thread works on the indices too, so a
+ * pool without threads runs everything inline.
+ */
+class DecodePoolImpl : public DecodePool {
+public:
+  explicit DecodePoolImpl(uint32_t threads);
+
+  /**
+   * Joins the threads. No parallelFor() may be running.
+   */
+  ~DecodePoolImpl();
+
+  // Config::DecodePool
+  void parallelFor(size_t count, const std::function<void(size_t)>& fn) override;
+
+private:
+  // A parallelFor() in progress.
+  struct Batch {
+    Batch(size_t count, const std::function<void(size_t)>& fn)
+        : fn_(fn), count_(count), errors_(count) {}
+
+    bool finished() const { return done_ == count_; }
+
+    const std::function<void(size_t)>& fn_;
+    const size_t count_;
+    // The next index to run and the number of indices that have been run, guarded by the pool's
+    // mutex.
+    size_t next_{};
+    size_t done_{};
+    // Each index has its own slot, which is only written by the thread that runs it.
+    std::vector<std::exception_ptr> errors_;
+  };
+
+  bool readyOrExiting() const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void runBatch(Batch& batch) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void threadRoutine();
+
+  absl::Mutex mutex_;
+  Batch* batch_ GUARDED_BY(mutex_){};
+  bool exit_ GUARDED_BY(mutex_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+} // namespace Config
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include "common/config/grpc_mux_impl.h"
 
+#include <algorithm>
 #include <unordered_set>
 
 #include "common/common/token_bucket_impl.h"
@@ -12,11 +13,15 @@ namespace Config {
 GrpcMuxImpl::GrpcMuxImpl(const LocalInfo::LocalInfo& local_info, Grpc::AsyncClientPtr async_client,
                          Event::Dispatcher& dispatcher,
                          const Protobuf::MethodDescriptor& service_method,
-                         Runtime::RandomGenerator& random)
+                         Runtime::RandomGenerator& random, SnapshotStorePtr snapshot_store)
     : local_info_(local_info), async_client_(std::move(async_client)),
-      service_method_(service_method), random_(random), time_source_(dispatcher.timeSystem()) {
+      service_method_(service_method), random_(random), time_source_(dispatcher.timeSystem()),
+      snapshot_store_(std::move(snapshot_store)) {
   Config::Utility::checkLocalInfo("ads", local_info);
   retry_timer_ = dispatcher.createTimer([this]() -> void { establishNewStream(); });
+  if (snapshot_store_ != nullptr) {
+    snapshot_timer_ = dispatcher.createTimer([this]() -> void { applySnapshots(); });
+  }
   backoff_strategy_ = std::make_unique<JitteredBackOffStrategy>(RETRY_INITIAL_DELAY_MS,
                                                                 RETRY_MAX_DELAY_MS, random_);
 }
@@ -101,8 +106,8 @@ void GrpcMuxImpl::handleFailure() {
 GrpcMuxWatchPtr GrpcMuxImpl::subscribe(const std::string& type_url,
                                        const std::vector<std::string>& resources,
                                        GrpcMuxCallbacks& callbacks) {
-  auto watch =
-      std::unique_ptr<GrpcMuxWatch>(new GrpcMuxWatchImpl(resources, callbacks, type_url, *this));
+  GrpcMuxWatchImpl* watch_impl = new GrpcMuxWatchImpl(resources, callbacks, type_url, *this);
+  auto watch = std::unique_ptr<GrpcMuxWatch>(watch_impl);
   ENVOY_LOG(debug, "gRPC mux subscribe for " + type_url);
 
   // Lazily kick off the requests based on first subscription. This has the
@@ -118,6 +123,14 @@ GrpcMuxWatchPtr GrpcMuxImpl::subscribe(const std::string& type_url,
     api_state_[type_url].request_.mutable_node()->MergeFrom(local_info_.node());
     api_state_[type_url].subscribed_ = true;
     subscriptions_.emplace_back(type_url);
+    if (snapshot_store_ != nullptr) {
+      api_state_[type_url].snapshot_ = snapshot_store_->load(type_url);
+    }
+  }
+
+  if (api_state_[type_url].snapshot_ != nullptr) {
+    watch_impl->snapshot_pending_ = true;
+    snapshot_timer_->enableTimer(std::chrono::milliseconds(0));
   }
 
   // This will send an updated request on each subscription.
@@ -170,6 +183,8 @@ void GrpcMuxImpl::onReceiveMessage(std::unique_ptr<envoy::api::v2::DiscoveryResp
     // violation
     return;
   }
+  // The management server now has authority over the API.
+  api_state_[type_url].snapshot_.reset();
   if (api_state_[type_url].watches_.empty()) {
     // update the nonce as we are processing this response.
     api_state_[type_url].request_.set_response_nonce(message->nonce());
@@ -189,44 +204,13 @@ void GrpcMuxImpl::onReceiveMessage(std::unique_ptr<envoy::api::v2::DiscoveryResp
     return;
   }
   try {
-    // To avoid O(n^2) explosion (e.g. when we have 1000s of EDS watches), we
-    // build a map here from resource name to resource and then walk watches_.
-    // We have to walk all watches (and need an efficient map as a result) to
-    // ensure we deliver empty config updates when a resource is dropped.
-    std::unordered_map<std::string, ProtobufWkt::Any> resources;
-    GrpcMuxCallbacks& callbacks = api_state_[type_url].watches_.front()->callbacks_;
-    for (const auto& resource : message->resources()) {
-      if (type_url != resource.type_url()) {
-        throw EnvoyException(fmt::format("{} does not match {} type URL is DiscoveryResponse {}",
-                                         resource.type_url(), type_url, message->DebugString()));
-      }
-      const std::string resource_name = callbacks.resourceName(resource);
-      resources.emplace(resource_name, resource);
-    }
-    for (auto watch : api_state_[type_url].watches_) {
-      // onConfigUpdate should be called in all cases for single watch xDS (Cluster and Listener)
-      // even if the message does not have resources so that update_empty stat is properly
-      // incremented and state-of-the-world semantics are maintained.
-      if (watch->resources_.empty()) {
-        watch->callbacks_.onConfigUpdate(message->resources(), message->version_info());
-        continue;
-      }
-      Protobuf::RepeatedPtrField<ProtobufWkt::Any> found_resources;
-      for (auto watched_resource_name : watch->resources_) {
-        auto it = resources.find(watched_resource_name);
-        if (it != resources.end()) {
-          found_resources.Add()->MergeFrom(it->second);
-        }
-      }
-      // onConfigUpdate should be called only on watches(clusters/routes) that have updates in the
-      // message.
-      if (found_resources.size() > 0) {
-        watch->callbacks_.onConfigUpdate(found_resources, message->version_info());
-      }
-    }
+    applyResponse(*message, false);
     // TODO(mattklein123): In the future if we start tracking per-resource versions, we would do
     // that tracking here.
     api_state_[type_url].request_.set_version_info(message->version_info());
+    if (snapshot_store_ != nullptr) {
+      snapshot_store_->store(*message);
+    }
   } catch (const EnvoyException& e) {
     ENVOY_LOG(warn, "gRPC config for {} update rejected: {}", message->type_url(), e.what());
     for (auto watch : api_state_[type_url].watches_) {
@@ -240,6 +224,82 @@ void GrpcMuxImpl::onReceiveMessage(std::unique_ptr<envoy::api::v2::DiscoveryResp
   sendDiscoveryRequest(type_url);
 }
 
+void GrpcMuxImpl::applyResponse(const envoy::api::v2::DiscoveryResponse& message, bool snapshot) {
+  const std::string& type_url = message.type_url();
+  std::list<GrpcMuxWatchImpl*>& watches = api_state_[type_url].watches_;
+  // To avoid O(n^2) explosion (e.g. when we have 1000s of EDS watches), we
+  // build a map here from resource name to resource and then walk watches_.
+  // We have to walk all watches (and need an efficient map as a result) to
+  // ensure we deliver empty config updates when a resource is dropped.
+  // Naming a resource unpacks it, so the map is skipped when only wildcard watches (e.g. CDS and
+  // LDS) exist, which receive the resources as they are. The map points into the message rather
+  // than copying every resource.
+  std::unordered_map<std::string, const ProtobufWkt::Any*> resources;
+  GrpcMuxCallbacks& callbacks = watches.front()->callbacks_;
+  const bool named_watches = std::any_of(
+      watches.begin(), watches.end(),
+      [](const GrpcMuxWatchImpl* watch) { return !watch->resources_.empty(); });
+  for (const auto& resource : message.resources()) {
+    if (type_url != resource.type_url()) {
+      throw EnvoyException(fmt::format("{} does not match {} type URL is DiscoveryResponse {}",
+                                       resource.type_url(), type_url, message.DebugString()));
+    }
+    if (named_watches) {
+      const std::string resource_name = callbacks.resourceName(resource);
+      resources.emplace(resource_name, &resource);
+    }
+  }
+  // The resources found for each named watch only live until its callbacks return.
+  Protobuf::Arena arena;
+  for (auto watch : watches) {
+    if (snapshot) {
+      if (!watch->snapshot_pending_) {
+        continue;
+      }
+      watch->snapshot_pending_ = false;
+    }
+    // onConfigUpdate should be called in all cases for single watch xDS (Cluster and Listener)
+    // even if the message does not have resources so that update_empty stat is properly
+    // incremented and state-of-the-world semantics are maintained.
+    if (watch->resources_.empty()) {
+      watch->callbacks_.onConfigUpdate(message.resources(), message.version_info());
+      continue;
+    }
+    Protobuf::RepeatedPtrField<ProtobufWkt::Any>& found_resources =
+        *Protobuf::Arena::CreateMessage<Protobuf::RepeatedPtrField<ProtobufWkt::Any>>(&arena);
+    for (const auto& watched_resource_name : watch->resources_) {
+      auto it = resources.find(watched_resource_name);
+      if (it != resources.end()) {
+        found_resources.Add()->MergeFrom(*it->second);
+      }
+    }
+    // onConfigUpdate should be called only on watches(clusters/routes) that have updates in the
+    // message.
+    if (found_resources.size() > 0) {
+      watch->callbacks_.onConfigUpdate(found_resources, message.version_info());
+    }
+  }
+}
+
+void GrpcMuxImpl::applySnapshots() {
+  // Snapshots are applied in Envoy's dependency ordering, e.g. clusters before their endpoints.
+  for (const std::string& type_url : subscriptions_) {
+    ApiState& api_state = api_state_[type_url];
+    if (api_state.snapshot_ == nullptr || api_state.watches_.empty()) {
+      continue;
+    }
+    ENVOY_LOG(debug, "Applying xDS snapshot for {} at version {}", type_url,
+              api_state.snapshot_->version_info());
+    try {
+      // The version is not acknowledged, so that the management server still sends its state.
+      applyResponse(*api_state.snapshot_, true);
+    } catch (const EnvoyException& e) {
+      ENVOY_LOG(warn, "xDS snapshot for {} rejected: {}", type_url, e.what());
+      api_state.snapshot_.reset();
+    }
+  }
+}
+
 void GrpcMuxImpl::onReceiveTrailingMetadata(Http::HeaderMapPtr&& metadata) {
   UNREFERENCED_PARAMETER(metadata);
 }
@@ -13,6 +13,7 @@
 
 #include "common/common/backoff_strategy.h"
 #include "common/common/logger.h"
+#include "common/config/snapshot_store.h"
 
 namespace Envoy {
 namespace Config {
@@ -24,9 +25,14 @@ class GrpcMuxImpl : public GrpcMux,
                     Grpc::TypedAsyncStreamCallbacks<envoy::api::v2::DiscoveryResponse>,
                     Logger::Loggable<Logger::Id::upstream> {
 public:
+  /**
+   * @param snapshot_store supplies the optional store that accepted responses are persisted to.
+   *        Until the management server has responded for an API, its persisted response is applied
+   *        to the API's watches.
+   */
   GrpcMuxImpl(const LocalInfo::LocalInfo& local_info, Grpc::AsyncClientPtr async_client,
               Event::Dispatcher& dispatcher, const Protobuf::MethodDescriptor& service_method,
-              Runtime::RandomGenerator& random);
+              Runtime::RandomGenerator& random, SnapshotStorePtr snapshot_store = nullptr);
   ~GrpcMuxImpl();
 
   void start() override;
@@ -51,6 +57,8 @@ private:
   void establishNewStream();
   void sendDiscoveryRequest(const std::string& type_url);
   void handleFailure();
+  void applySnapshots();
+  void applyResponse(const envoy::api::v2::DiscoveryResponse& message, bool snapshot);
 
   struct GrpcMuxWatchImpl : public GrpcMuxWatch {
     GrpcMuxWatchImpl(const std::vector<std::string>& resources, GrpcMuxCallbacks& callbacks,
@@ -74,6 +82,8 @@ private:
     GrpcMuxImpl& parent_;
     std::list<GrpcMuxWatchImpl*>::iterator entry_;
     bool inserted_;
+    // Is the watch waiting for the snapshot of its API to be applied?
+    bool snapshot_pending_{};
   };
 
   // Per muxed API state.
@@ -88,6 +98,9 @@ private:
     bool pending_{};
     // Has this API been tracked in subscriptions_?
     bool subscribed_{};
+    // The persisted response of the API, loaded on the first subscription and dropped once the
+    // management server has responded.
+    std::unique_ptr<envoy::api::v2::DiscoveryResponse> snapshot_;
     // Detects when Envoy is making too many requests.
     TokenBucketPtr limit_request_;
     // Limits warning messages when too many requests is detected.
@@ -105,6 +118,10 @@ private:
   Runtime::RandomGenerator& random_;
   TimeSource& time_source_;
   BackOffStrategyPtr backoff_strategy_;
+  SnapshotStorePtr snapshot_store_;
+  // Applies the snapshots to new watches outside of subscribe(), as other subscriptions do not
+  // deliver updates from within start() either.
+  Event::TimerPtr snapshot_timer_;
 };
 
 class NullGrpcMuxImpl : public GrpcMux {
@@ -16,9 +16,10 @@ class GrpcSubscriptionImpl : public Config::Subscription<ResourceType> {
 public:
   GrpcSubscriptionImpl(const LocalInfo::LocalInfo& local_info, Grpc::AsyncClientPtr async_client,
                        Event::Dispatcher& dispatcher, Runtime::RandomGenerator& random,
-                       const Protobuf::MethodDescriptor& service_method, SubscriptionStats stats)
+                       const Protobuf::MethodDescriptor& service_method,
+                       DecodePool& decode_pool, SubscriptionStats stats)
       : grpc_mux_(local_info, std::move(async_client), dispatcher, service_method, random),
-        grpc_mux_subscription_(grpc_mux_, stats) {}
+        grpc_mux_subscription_(grpc_mux_, decode_pool, stats) {}
 
   // Config::Subscription
   void start(const std::vector<std::string>& resources,
@@ -0,0 +1,348 @@
+#include "common/config/incremental_grpc_mux_impl.h"
+
+#include "common/common/token_bucket_impl.h"
+#include "common/config/utility.h"
+#include "common/protobuf/protobuf.h"
+
+namespace Envoy {
+namespace Config {
+
+IncrementalGrpcMuxImpl::IncrementalGrpcMuxImpl(const LocalInfo::LocalInfo& local_info,
+                                               Grpc::AsyncClientPtr async_client,
+                                               Event::Dispatcher& dispatcher,
+                                               const Protobuf::MethodDescriptor& service_method,
+                                               Runtime::RandomGenerator& random)
+    : local_info_(local_info), async_client_(std::move(async_client)),
+      service_method_(service_method), random_(random), time_source_(dispatcher.timeSystem()) {
+  Config::Utility::checkLocalInfo("ads", local_info);
+  retry_timer_ = dispatcher.createTimer([this]() -> void { establishNewStream(); });
+  backoff_strategy_ = std::make_unique<JitteredBackOffStrategy>(RETRY_INITIAL_DELAY_MS,
+                                                                RETRY_MAX_DELAY_MS, random_);
+}
+
+IncrementalGrpcMuxImpl::~IncrementalGrpcMuxImpl() {
+  for (const auto& api_state : api_state_) {
+    for (auto watch : api_state.second.watches_) {
+      watch->inserted_ = false;
+    }
+  }
+}
+
+void IncrementalGrpcMuxImpl::start() { establishNewStream(); }
+
+void IncrementalGrpcMuxImpl::setRetryTimer() {
+  retry_timer_->enableTimer(std::chrono::milliseconds(backoff_strategy_->nextBackOffMs()));
+}
+
+void IncrementalGrpcMuxImpl::establishNewStream() {
+  ENVOY_LOG(debug, "Establishing new gRPC bidi stream for {}", service_method_.DebugString());
+  stream_ = async_client_->start(service_method_, *this);
+  if (stream_ == nullptr) {
+    ENVOY_LOG(warn, "Unable to establish new stream");
+    handleFailure();
+    return;
+  }
+
+  for (const auto& type_url : subscriptions_) {
+    api_state_[type_url].initial_ = true;
+    sendIncrementalDiscoveryRequest(type_url);
+  }
+}
+
+void IncrementalGrpcMuxImpl::sendIncrementalDiscoveryRequest(const std::string& type_url) {
+  if (stream_ == nullptr) {
+    ENVOY_LOG(debug, "No stream available to sendIncrementalDiscoveryRequest for {}", type_url);
+    return;
+  }
+
+  ApiState& api_state = api_state_[type_url];
+  if (api_state.paused_) {
+    ENVOY_LOG(trace, "API {} paused during sendIncrementalDiscoveryRequest(), setting pending.",
+              type_url);
+    api_state.pending_ = true;
+    return;
+  }
+
+  if (!api_state.limit_request_->consume() && api_state.limit_log_->consume()) {
+    ENVOY_LOG(warn, "{}",
+              fmt::format("Too many sendIncrementalDiscoveryRequest calls for {}", type_url));
+  }
+
+  auto& request = api_state.request_;
+  if (api_state.initial_) {
+    // The management server knows nothing of a new stream, so the changes accumulated for the
+    // previous one are superseded by the whole subscription and the versions already held.
+    request.clear_resource_names_subscribe();
+    request.clear_resource_names_unsubscribe();
+    for (const auto& named_watches : api_state.named_watches_) {
+      request.add_resource_names_subscribe(named_watches.first);
+    }
+    for (const auto& version : api_state.resource_versions_) {
+      (*request.mutable_initial_resource_versions())[version.first] = version.second;
+    }
+    api_state.initial_ = false;
+  }
+
+  ENVOY_LOG(trace, "Sending IncrementalDiscoveryRequest for {}: {}", type_url,
+            request.DebugString());
+  stream_->sendMessage(request, false);
+
+  // Everything but the node and type URL only applies to a single request.
+  request.clear_resource_names_subscribe();
+  request.clear_resource_names_unsubscribe();
+  request.clear_initial_resource_versions();
+  request.clear_response_nonce();
+  request.clear_error_detail();
+}
+
+void IncrementalGrpcMuxImpl::handleFailure() {
+  for (const auto& api_state : api_state_) {
+    for (auto watch : api_state.second.watches_) {
+      watch->callbacks_.onConfigUpdateFailed(nullptr);
+    }
+  }
+  setRetryTimer();
+}
+
+GrpcMuxWatchPtr IncrementalGrpcMuxImpl::subscribe(const std::string& type_url,
+                                                  const std::vector<std::string>& resources,
+                                                  GrpcMuxCallbacks& callbacks) {
+  auto* watch = new IncrementalGrpcMuxWatchImpl(resources, callbacks, type_url, *this);
+  GrpcMuxWatchPtr watch_ptr(watch);
+  ENVOY_LOG(debug, "Incremental gRPC mux subscribe for " + type_url);
+
+  ApiState& api_state = api_state_[type_url];
+  if (!api_state.subscribed_) {
+    // Bucket contains 100 tokens maximum and refills at 5 tokens/sec.
+    api_state.limit_request_ = std::make_unique<TokenBucketImpl>(100, time_source_, 5);
+    // Bucket contains 1 token maximum and refills 1 token on every ~5 seconds.
+    api_state.limit_log_ = std::make_unique<TokenBucketImpl>(1, time_source_, 0.2);
+    api_state.request_.set_type_url(type_url);
+    api_state.request_.mutable_node()->MergeFrom(local_info_.node());
+    api_state.subscribed_ = true;
+    api_state.initial_ = true;
+    subscriptions_.emplace_back(type_url);
+  }
+
+  watch->entry_ = api_state.watches_.emplace(api_state.watches_.begin(), watch);
+  if (watch->resources_.empty()) {
+    api_state.wildcard_watches_.push_back(watch);
+  }
+  // Only the names that nothing watched yet need to be subscribed to on the stream. The others
+  // will not be sent again until they change, so the new watch is handed them as last accepted.
+  bool changed = api_state.initial_;
+  WatchUpdate update;
+  for (const std::string& resource : watch->resources_) {
+    auto& watches = api_state.named_watches_[resource];
+    if (watches.empty()) {
+      api_state.request_.add_resource_names_subscribe(resource);
+      changed = true;
+    } else {
+      auto it = api_state.named_resources_.find(resource);
+      if (it != api_state.named_resources_.end()) {
+        update.added_resources_.Add()->MergeFrom(it->second);
+      }
+    }
+    watches.push_back(watch);
+  }
+
+  if (changed) {
+    sendIncrementalDiscoveryRequest(type_url);
+  }
+
+  if (!update.added_resources_.empty()) {
+    try {
+      callbacks.onIncrementalConfigUpdate(update.added_resources_, update.removed_resources_,
+                                          api_state.system_version_info_);
+    } catch (const EnvoyException& e) {
+      ENVOY_LOG(warn, "Incremental gRPC config for {} rejected by a new watch: {}", type_url,
+                e.what());
+      callbacks.onConfigUpdateFailed(&e);
+    }
+  }
+
+  return watch_ptr;
+}
+
+void IncrementalGrpcMuxImpl::removeWatch(IncrementalGrpcMuxWatchImpl& watch) {
+  ApiState& api_state = api_state_[watch.type_url_];
+  api_state.watches_.erase(watch.entry_);
+  if (watch.resources_.empty()) {
+    api_state.wildcard_watches_.remove(&watch);
+    return;
+  }
+
+  // The names that are left without a watch are unsubscribed from, and their versions forgotten
+  // as the management server stops tracking them.
+  bool changed = false;
+  for (const std::string& resource : watch.resources_) {
+    auto it = api_state.named_watches_.find(resource);
+    ASSERT(it != api_state.named_watches_.end());
+    it->second.remove(&watch);
+    if (it->second.empty()) {
+      api_state.named_watches_.erase(it);
+      api_state.resource_versions_.erase(resource);
+      api_state.named_resources_.erase(resource);
+      api_state.request_.add_resource_names_unsubscribe(resource);
+      changed = true;
+    }
+  }
+
+  if (changed) {
+    sendIncrementalDiscoveryRequest(watch.type_url_);
+  }
+}
+
+void IncrementalGrpcMuxImpl::pause(const std::string& type_url) {
+  ENVOY_LOG(debug, "Pausing discovery requests for {}", type_url);
+  ApiState& api_state = api_state_[type_url];
+  ASSERT(!api_state.paused_);
+  ASSERT(!api_state.pending_);
+  api_state.paused_ = true;
+}
+
+void IncrementalGrpcMuxImpl::resume(const std::string& type_url) {
+  ENVOY_LOG(debug, "Resuming discovery requests for {}", type_url);
+  ApiState& api_state = api_state_[type_url];
+  ASSERT(api_state.paused_);
+  api_state.paused_ = false;
+
+  if (api_state.pending_) {
+    ASSERT(api_state.subscribed_);
+    sendIncrementalDiscoveryRequest(type_url);
+    api_state.pending_ = false;
+  }
+}
+
+void IncrementalGrpcMuxImpl::onCreateInitialMetadata(Http::HeaderMap& metadata) {
+  UNREFERENCED_PARAMETER(metadata);
+}
+
+void IncrementalGrpcMuxImpl::onReceiveInitialMetadata(Http::HeaderMapPtr&& metadata) {
+  UNREFERENCED_PARAMETER(metadata);
+}
+
+void IncrementalGrpcMuxImpl::onReceiveMessage(
+    std::unique_ptr<envoy::api::v2::IncrementalDiscoveryResponse>&& message) {
+  // Reset here so that it starts with fresh backoff interval on next disconnect.
+  backoff_strategy_->reset();
+
+  // The type URL may be left implicit on a stream that serves a single xDS API.
+  std::string type_url = message->type_url();
+  if (type_url.empty() && subscriptions_.size() == 1) {
+    type_url = subscriptions_.front();
+  }
+  ENVOY_LOG(debug, "Received incremental gRPC message for {} at version {}", type_url,
+            message->system_version_info());
+  if (api_state_.count(type_url) == 0 || !api_state_[type_url].subscribed_) {
+    ENVOY_LOG(warn, "Ignoring unknown type URL {}", type_url);
+    return;
+  }
+
+  ApiState& api_state = api_state_[type_url];
+  try {
+    applyUpdate(type_url, *message);
+  } catch (const EnvoyException& e) {
+    ENVOY_LOG(warn, "Incremental gRPC config for {} update rejected: {}", type_url, e.what());
+    for (auto watch : api_state.watches_) {
+      watch->callbacks_.onConfigUpdateFailed(&e);
+    }
+    ::google::rpc::Status* error_detail = api_state.request_.mutable_error_detail();
+    error_detail->set_code(Grpc::Status::GrpcStatus::Internal);
+    error_detail->set_message(e.what());
+  }
+  api_state.request_.set_response_nonce(message->nonce());
+  sendIncrementalDiscoveryRequest(type_url);
+}
+
+void IncrementalGrpcMuxImpl::applyUpdate(
+    const std::string& type_url, const envoy::api::v2::IncrementalDiscoveryResponse& message) {
+  ApiState& api_state = api_state_[type_url];
+  if (api_state.watches_.empty()) {
+    // Whatever remains of a resource that is no longer watched, e.g. the ClusterLoadAssignment of
+    // a deleted cluster, has nothing to be applied to.
+    return;
+  }
+
+  // Only the watches of the resources in the message are visited, so that the cost of an update
+  // does not grow with the number of watches, e.g. with 1000s of EDS clusters.
+  GrpcMuxCallbacks& callbacks = api_state.watches_.front()->callbacks_;
+  std::vector<std::string> added_names;
+  std::unordered_map<IncrementalGrpcMuxWatchImpl*, WatchUpdate> updates;
+  std::vector<IncrementalGrpcMuxWatchImpl*> updated_watches;
+  auto update_for = [&updates, &updated_watches](IncrementalGrpcMuxWatchImpl* watch) {
+    auto result = updates.emplace(watch, WatchUpdate());
+    if (result.second) {
+      updated_watches.push_back(watch);
+    }
+    return &result.first->second;
+  };
+
+  // The copies of the resources handed to the wildcard watches only live until their callbacks
+  // return.
+  Protobuf::Arena arena;
+  Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added_resources =
+      *Protobuf::Arena::CreateMessage<Protobuf::RepeatedPtrField<ProtobufWkt::Any>>(&arena);
+  for (const auto& resource : message.resources()) {
+    if (type_url != resource.resource().type_url()) {
+      throw EnvoyException(fmt::format(
+          "{} does not match {} type URL is IncrementalDiscoveryResponse {}",
+          resource.resource().type_url(), type_url, message.DebugString()));
+    }
+    added_names.push_back(callbacks.resourceName(resource.resource()));
+    added_resources.Add()->MergeFrom(resource.resource());
+    auto it = api_state.named_watches_.find(added_names.back());
+    if (it != api_state.named_watches_.end()) {
+      for (auto watch : it->second) {
+        update_for(watch)->added_resources_.Add()->MergeFrom(resource.resource());
+      }
+    }
+  }
+  for (const auto& resource_name : message.removed_resources()) {
+    auto it = api_state.named_watches_.find(resource_name);
+    if (it != api_state.named_watches_.end()) {
+      for (auto watch : it->second) {
+        *update_for(watch)->removed_resources_.Add() = resource_name;
+      }
+    }
+  }
+
+  // The watches on all resources are updated even if the message holds no change, so that their
+  // update stats and initialization are maintained as with the state of the world protocol.
+  for (auto watch : api_state.wildcard_watches_) {
+    watch->callbacks_.onIncrementalConfigUpdate(added_resources, message.removed_resources(),
+                                                message.system_version_info());
+  }
+  for (auto watch : updated_watches) {
+    const WatchUpdate& update = updates[watch];
+    watch->callbacks_.onIncrementalConfigUpdate(update.added_resources_, update.removed_resources_,
+                                                message.system_version_info());
+  }
+
+  // The resources and their versions are only tracked once the update is accepted.
+  for (int i = 0; i < message.resources().size(); i++) {
+    api_state.resource_versions_[added_names[i]] = message.resources(i).version();
+    if (api_state.named_watches_.count(added_names[i]) > 0) {
+      api_state.named_resources_[added_names[i]] = message.resources(i).resource();
+    }
+  }
+  for (const auto& resource_name : message.removed_resources()) {
+    api_state.resource_versions_.erase(resource_name);
+    api_state.named_resources_.erase(resource_name);
+  }
+  api_state.system_version_info_ = message.system_version_info();
+}
+
+void IncrementalGrpcMuxImpl::onReceiveTrailingMetadata(Http::HeaderMapPtr&& metadata) {
+  UNREFERENCED_PARAMETER(metadata);
+}
+
+void IncrementalGrpcMuxImpl::onRemoteClose(Grpc::Status::GrpcStatus status,
+                                           const std::string& message) {
+  ENVOY_LOG(warn, "Incremental gRPC config stream closed: {}, {}", status, message);
+  stream_ = nullptr;
+  setRetryTimer();
+}
+
+} // namespace Config
+} // namespace Envoy
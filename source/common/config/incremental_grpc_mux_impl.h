@@ -0,0 +1,140 @@
+#pragma once
+
+#include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
+
+#include "envoy/api/v2/discovery.pb.h"
+#include "envoy/common/time.h"
+#include "envoy/common/token_bucket.h"
+#include "envoy/config/grpc_mux.h"
+#include "envoy/config/subscription.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/grpc/async_client.h"
+#include "envoy/grpc/status.h"
+#include "envoy/upstream/cluster_manager.h"
+
+#include "common/common/backoff_strategy.h"
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Config {
+
+/**
+ * ADS and xDS API implementation that fetches via the incremental gRPC protocol. Rather than the
+ * state of the world, only the resources that were added, updated or removed are exchanged in
+ * either direction, so that the cost of an update is proportional to the change.
+ */
+class IncrementalGrpcMuxImpl
+    : public GrpcMux,
+      Grpc::TypedAsyncStreamCallbacks<envoy::api::v2::IncrementalDiscoveryResponse>,
+      Logger::Loggable<Logger::Id::upstream> {
+public:
+  IncrementalGrpcMuxImpl(const LocalInfo::LocalInfo& local_info, Grpc::AsyncClientPtr async_client,
+                         Event::Dispatcher& dispatcher,
+                         const Protobuf::MethodDescriptor& service_method,
+                         Runtime::RandomGenerator& random);
+  ~IncrementalGrpcMuxImpl();
+
+  void start() override;
+  GrpcMuxWatchPtr subscribe(const std::string& type_url, const std::vector<std::string>& resources,
+                            GrpcMuxCallbacks& callbacks) override;
+  void pause(const std::string& type_url) override;
+  void resume(const std::string& type_url) override;
+
+  // Grpc::AsyncStreamCallbacks
+  void onCreateInitialMetadata(Http::HeaderMap& metadata) override;
+  void onReceiveInitialMetadata(Http::HeaderMapPtr&& metadata) override;
+  void onReceiveMessage(
+      std::unique_ptr<envoy::api::v2::IncrementalDiscoveryResponse>&& message) override;
+  void onReceiveTrailingMetadata(Http::HeaderMapPtr&& metadata) override;
+  void onRemoteClose(Grpc::Status::GrpcStatus status, const std::string& message) override;
+
+  const uint32_t RETRY_INITIAL_DELAY_MS = 500;
+  const uint32_t RETRY_MAX_DELAY_MS = 30000; // Do not cross more than 30s
+
+private:
+  struct IncrementalGrpcMuxWatchImpl : public GrpcMuxWatch {
+    IncrementalGrpcMuxWatchImpl(const std::vector<std::string>& resources,
+                                GrpcMuxCallbacks& callbacks, const std::string& type_url,
+                                IncrementalGrpcMuxImpl& parent)
+        : resources_(resources.begin(), resources.end()), callbacks_(callbacks),
+          type_url_(type_url), parent_(parent), inserted_(true) {}
+    ~IncrementalGrpcMuxWatchImpl() override {
+      if (inserted_) {
+        parent_.removeWatch(*this);
+      }
+    }
+
+    const std::set<std::string> resources_;
+    GrpcMuxCallbacks& callbacks_;
+    const std::string type_url_;
+    IncrementalGrpcMuxImpl& parent_;
+    std::list<IncrementalGrpcMuxWatchImpl*>::iterator entry_;
+    bool inserted_;
+  };
+
+  // The part of an incremental update that concerns a single watch.
+  struct WatchUpdate {
+    Protobuf::RepeatedPtrField<ProtobufWkt::Any> added_resources_;
+    Protobuf::RepeatedPtrField<ProtobufTypes::String> removed_resources_;
+  };
+
+  // Per muxed API state.
+  struct ApiState {
+    // All the watches of the API.
+    std::list<IncrementalGrpcMuxWatchImpl*> watches_;
+    // The watches on all the resources of the API.
+    std::list<IncrementalGrpcMuxWatchImpl*> wildcard_watches_;
+    // The watches on each subscribed resource name. A name is subscribed to on the stream for as
+    // long as it has a watch.
+    std::map<std::string, std::list<IncrementalGrpcMuxWatchImpl*>> named_watches_;
+    // Versions of the accepted resources, sent on a new stream so that the management server only
+    // has to send what changed in the meantime.
+    std::unordered_map<std::string, std::string> resource_versions_;
+    // The accepted resources that are watched by name, for the watches added later on. The
+    // management server only sends a resource again when it changes.
+    std::unordered_map<std::string, ProtobufWkt::Any> named_resources_;
+    // Version of the last accepted update.
+    std::string system_version_info_;
+    // Next IncrementalDiscoveryRequest for API, accumulating the subscription changes, nonce and
+    // error detail until it is sent.
+    envoy::api::v2::IncrementalDiscoveryRequest request_;
+    // Whether the next request is the first of a stream, which resubscribes to every name.
+    bool initial_{};
+    // Paused via pause()?
+    bool paused_{};
+    // Was a request elided during a pause?
+    bool pending_{};
+    // Has this API been tracked in subscriptions_?
+    bool subscribed_{};
+    // Detects when Envoy is making too many requests.
+    TokenBucketPtr limit_request_;
+    // Limits warning messages when too many requests is detected.
+    TokenBucketPtr limit_log_;
+  };
+
+  void setRetryTimer();
+  void establishNewStream();
+  void sendIncrementalDiscoveryRequest(const std::string& type_url);
+  void handleFailure();
+  void removeWatch(IncrementalGrpcMuxWatchImpl& watch);
+  void applyUpdate(const std::string& type_url,
+                   const envoy::api::v2::IncrementalDiscoveryResponse& message);
+
+  const LocalInfo::LocalInfo& local_info_;
+  Grpc::AsyncClientPtr async_client_;
+  Grpc::AsyncStream* stream_{};
+  const Protobuf::MethodDescriptor& service_method_;
+  std::unordered_map<std::string, ApiState> api_state_;
+  // Envoy's dependendency ordering.
+  std::list<std::string> subscriptions_;
+  Event::TimerPtr retry_timer_;
+  Runtime::RandomGenerator& random_;
+  TimeSource& time_source_;
+  BackOffStrategyPtr backoff_strategy_;
+};
+
+} // namespace Config
+} // namespace Envoy
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "envoy/api/v2/core/base.pb.h"
+#include "envoy/config/subscription.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/grpc/async_client.h"
+
+#include "common/config/grpc_mux_subscription_impl.h"
+#include "common/config/incremental_grpc_mux_impl.h"
+
+namespace Envoy {
+namespace Config {
+
+template <class ResourceType>
+class IncrementalGrpcSubscriptionImpl : public Config::Subscription<ResourceType> {
+public:
+  IncrementalGrpcSubscriptionImpl(const LocalInfo::LocalInfo& local_info,
+                                  Grpc::AsyncClientPtr async_client, Event::Dispatcher& dispatcher,
+                                  Runtime::RandomGenerator& random,
+                                  const Protobuf::MethodDescriptor& service_method,
+                                  DecodePool& decode_pool, SubscriptionStats stats)
+      : grpc_mux_(local_info, std::move(async_client), dispatcher, service_method, random),
+        grpc_mux_subscription_(grpc_mux_, decode_pool, stats) {}
+
+  // Config::Subscription
+  void start(const std::vector<std::string>& resources,
+             Config::SubscriptionCallbacks<ResourceType>& callbacks) override {
+    // Subscribe first, so we get failure callbacks if grpc_mux_.start() fails.
+    grpc_mux_subscription_.start(resources, callbacks);
+    grpc_mux_.start();
+  }
+
+  void updateResources(const std::vector<std::string>& resources) override {
+    grpc_mux_subscription_.updateResources(resources);
+  }
+
+  IncrementalGrpcMuxImpl& grpcMux() { return grpc_mux_; }
+
+private:
+  IncrementalGrpcMuxImpl grpc_mux_;
+  GrpcMuxSubscriptionImpl<ResourceType> grpc_mux_subscription_;
+};
+
+} // namespace Config
+} // namespace Envoy
@@ -0,0 +1,75 @@
+#include "common/config/snapshot_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/fmt.h"
+#include "common/filesystem/filesystem_impl.h"
+
+namespace Envoy {
+namespace Config {
+
+SnapshotStore::SnapshotStore(const std::string& directory) : directory_(directory) {
+  if (!Filesystem::directoryExists(directory_)) {
+    throw EnvoyException(fmt::format("xDS snapshot directory {} does not exist", directory_));
+  }
+}
+
+std::string SnapshotStore::path(const std::string& type_url) const {
+  // Type URLs are of the form type.googleapis.com/envoy.api.v2.Cluster.
+  return fmt::format("{}/{}.pb", directory_, type_url.substr(type_url.rfind('/') + 1));
+}
+
+std::unique_ptr<envoy::api::v2::DiscoveryResponse>
+SnapshotStore::load(const std::string& type_url) const {
+  const std::string snapshot_path = path(type_url);
+  const int fd = ::open(snapshot_path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return nullptr;
+  }
+
+  // The snapshot is parsed straight from the mapped file, as a snapshot with all the clusters or
+  // endpoints of a large deployment may take several megabytes.
+  auto response = std::make_unique<envoy::api::v2::DiscoveryResponse>();
+  struct stat info;
+  bool parsed = false;
+  if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+    void* data = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      parsed = response->ParseFromArray(data, info.st_size);
+      ::munmap(data, info.st_size);
+    }
+  }
+  ::close(fd);
+
+  if (!parsed || response->type_url() != type_url) {
+    ENVOY_LOG(warn, "Ignoring unreadable xDS snapshot {}", snapshot_path);
+    return nullptr;
+  }
+  return response;
+}
+
+void SnapshotStore::store(const envoy::api::v2::DiscoveryResponse& response) const {
+  const std::string snapshot_path = path(response.type_url());
+  const std::string temporary_path = snapshot_path + ".tmp";
+  std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+  const bool written = file && response.SerializeToOstream(&file);
+  file.close();
+  if (!written || !file) {
+    ENVOY_LOG(warn, "Unable to write xDS snapshot {}", temporary_path);
+    return;
+  }
+  if (std::rename(temporary_path.c_str(), snapshot_path.c_str()) != 0) {
+    ENVOY_LOG(warn, "Unable to rename xDS snapshot {} to {}", temporary_path, snapshot_path);
+  }
+}
+
+} // namespace Config
+} // namespace Envoy
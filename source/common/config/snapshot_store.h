@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/api/v2/discovery.pb.h"
+
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Config {
+
+/**
+ * Persists the last accepted DiscoveryResponse of each xDS API as a binary protobuf file in a
+ * directory, so that a restarted Envoy can apply them before the management server has responded.
+ */
+class SnapshotStore : Logger::Loggable<Logger::Id::config> {
+public:
+  /**
+   * @param directory supplies the directory that holds the snapshots.
+   * @throw EnvoyException if the directory does not exist.
+   */
+  explicit SnapshotStore(const std::string& directory);
+
+  /**
+   * @param type_url supplies the type URL of the xDS API.
+   * @return the persisted response of the xDS API, or nullptr if there is none or it cannot be
+   *         read.
+   */
+  std::unique_ptr<envoy::api::v2::DiscoveryResponse> load(const std::string& type_url) const;
+
+  /**
+   * Replace the persisted response of the response's xDS API. The snapshot is written to a
+   * temporary file that is then renamed, so that a crash never leaves a truncated snapshot.
+   * Failures are logged.
+   * @param response supplies the accepted response.
+   */
+  void store(const envoy::api::v2::DiscoveryResponse& response) const;
+
+  /**
+   * @param type_url supplies the type URL of an xDS API.
+   * @return std::string the path of the API's snapshot.
+   */
+  std::string path(const std::string& type_url) const;
+
+private:
+  const std::string directory_;
+};
+
+typedef std::unique_ptr<SnapshotStore> SnapshotStorePtr;
+
+} // namespace Config
+} // namespace Envoy
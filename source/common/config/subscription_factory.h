@@ -11,6 +11,7 @@
 #include "common/config/grpc_mux_subscription_impl.h"
 #include "common/config/grpc_subscription_impl.h"
 #include "common/config/http_subscription_impl.h"
+#include "common/config/incremental_grpc_subscription_impl.h"
 #include "common/config/utility.h"
 #include "common/filesystem/filesystem_impl.h"
 #include "common/protobuf/protobuf.h"
@@ -33,7 +34,7 @@ public:
    * @param rest_method fully qualified name of v2 REST API method (as per protobuf service
    *        description).
    * @param grpc_method fully qualified name of v2 gRPC API bidi streaming method (as per protobuf
-   *        service description).
+   *        service description). Its incremental variant is used for INCREMENTAL_GRPC.
    */
   template <class ResourceType>
   static std::unique_ptr<Subscription<ResourceType>> subscriptionFromConfigSource(
@@ -71,7 +72,19 @@ public:
                                                            config.api_config_source(), scope)
                 ->create(),
             dispatcher, random,
-            *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(grpc_method), stats));
+            *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(grpc_method),
+            cm.xdsDecodePool(), stats));
+        break;
+      }
+      case envoy::api::v2::core::ApiConfigSource::INCREMENTAL_GRPC: {
+        const Protobuf::MethodDescriptor& incremental_method =
+            Utility::incrementalGrpcMethod(grpc_method);
+        result.reset(new IncrementalGrpcSubscriptionImpl<ResourceType>(
+            local_info,
+            Config::Utility::factoryForGrpcApiConfigSource(cm.grpcAsyncClientManager(),
+                                                           config.api_config_source(), scope)
+                ->create(),
+            dispatcher, random, incremental_method, cm.xdsDecodePool(), stats));
         break;
       }
       default:
@@ -80,7 +93,8 @@ public:
       break;
     }
     case envoy::api::v2::core::ConfigSource::kAds: {
-      result.reset(new GrpcMuxSubscriptionImpl<ResourceType>(cm.adsMux(), stats));
+      result.reset(
+          new GrpcMuxSubscriptionImpl<ResourceType>(cm.adsMux(), cm.xdsDecodePool(), stats));
       break;
     }
     default:
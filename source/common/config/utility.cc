@@ -16,6 +16,7 @@
 #include "common/json/config_schemas.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
+#include "common/stats/stats_matcher_impl.h"
 #include "common/stats/tag_producer_impl.h"
 
 namespace Envoy {
@@ -85,10 +86,31 @@ void Utility::checkFilesystemSubscriptionBackingPath(const std::string& path) {
   }
 }
 
+bool Utility::isGrpcApiConfigSource(
+    const envoy::api::v2::core::ApiConfigSource& api_config_source) {
+  return api_config_source.api_type() == envoy::api::v2::core::ApiConfigSource::GRPC ||
+         api_config_source.api_type() == envoy::api::v2::core::ApiConfigSource::INCREMENTAL_GRPC;
+}
+
+const Protobuf::MethodDescriptor& Utility::incrementalGrpcMethod(const std::string& grpc_method) {
+  // The incremental variant of a StreamX method is IncrementalX, in the same service.
+  const size_t pos = grpc_method.rfind(".Stream");
+  const Protobuf::MethodDescriptor* method =
+      pos == std::string::npos
+          ? nullptr
+          : Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
+                grpc_method.substr(0, pos) + ".Incremental" + grpc_method.substr(pos + 7));
+  if (method == nullptr) {
+    throw EnvoyException(fmt::format(
+        "envoy::api::v2::core::ConfigSource type INCREMENTAL_GRPC is not supported by {}",
+        grpc_method));
+  }
+  return *method;
+}
+
 void Utility::checkApiConfigSourceNames(
     const envoy::api::v2::core::ApiConfigSource& api_config_source) {
-  const bool is_grpc =
-      (api_config_source.api_type() == envoy::api::v2::core::ApiConfigSource::GRPC);
+  const bool is_grpc = isGrpcApiConfigSource(api_config_source);
 
   if (api_config_source.cluster_names().empty() && api_config_source.grpc_services().empty()) {
     throw EnvoyException(
@@ -139,8 +161,7 @@ void Utility::checkApiConfigSourceSubscriptionBackingCluster(
     const envoy::api::v2::core::ApiConfigSource& api_config_source) {
   Utility::checkApiConfigSourceNames(api_config_source);
 
-  const bool is_grpc =
-      (api_config_source.api_type() == envoy::api::v2::core::ApiConfigSource::GRPC);
+  const bool is_grpc = isGrpcApiConfigSource(api_config_source);
 
   if (!api_config_source.cluster_names().empty()) {
     // All API configs of type REST and REST_LEGACY should have cluster names.
@@ -221,6 +242,14 @@ Utility::createTagProducer(const envoy::config::bootstrap::v2::Bootstrap& bootst
   return std::make_unique<Stats::TagProducerImpl>(bootstrap.stats_config());
 }
 
+Stats::StatsMatcherPtr
+Utility::createStatsMatcher(const envoy::config::bootstrap::v2::Bootstrap& bootstrap) {
+  if (!bootstrap.stats_config().has_stats_matcher()) {
+    return nullptr;
+  }
+  return std::make_unique<Stats::StatsMatcherImpl>(bootstrap.stats_config());
+}
+
 void Utility::checkObjNameLength(const std::string& error_prefix, const std::string& name,
                                  const Stats::StatsOptions& stats_options) {
   if (name.length() > stats_options.maxNameLength()) {
@@ -235,9 +264,10 @@ Grpc::AsyncClientFactoryPtr Utility::factoryForGrpcApiConfigSource(
     const envoy::api::v2::core::ApiConfigSource& api_config_source, Stats::Scope& scope) {
   Utility::checkApiConfigSourceNames(api_config_source);
 
-  if (api_config_source.api_type() != envoy::api::v2::core::ApiConfigSource::GRPC) {
-    throw EnvoyException(fmt::format("envoy::api::v2::core::ConfigSource type must be GRPC: {}",
-                                     api_config_source.DebugString()));
+  if (!isGrpcApiConfigSource(api_config_source)) {
+    throw EnvoyException(fmt::format(
+        "envoy::api::v2::core::ConfigSource type must be GRPC or INCREMENTAL_GRPC: {}",
+        api_config_source.DebugString()));
   }
 
   envoy::api::v2::core::GrpcService grpc_service;
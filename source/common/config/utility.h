@@ -10,6 +10,7 @@
 #include "envoy/registry/registry.h"
 #include "envoy/server/filter_config.h"
 #include "envoy/stats/scope.h"
+#include "envoy/stats/stats_matcher.h"
 #include "envoy/stats/stats_options.h"
 #include "envoy/stats/tag_producer.h"
 #include "envoy/upstream/cluster_manager.h"
@@ -135,6 +136,23 @@ public:
    */
   static void checkFilesystemSubscriptionBackingPath(const std::string& path);
 
+  /**
+   * @param api_config_source the config source to check.
+   * @return bool whether the API is fetched via gRPC, with the state of the world or the
+   *         incremental protocol.
+   */
+  static bool isGrpcApiConfigSource(const envoy::api::v2::core::ApiConfigSource& api_config_source);
+
+  /**
+   * Find the incremental variant of a gRPC API method.
+   * @param grpc_method fully qualified name of the bidi streaming method, e.g.
+   *        envoy.api.v2.ClusterDiscoveryService.StreamClusters.
+   * @return const Protobuf::MethodDescriptor& the incremental method, e.g.
+   *         envoy.api.v2.ClusterDiscoveryService.IncrementalClusters.
+   * @throws EnvoyException when the API has no incremental variant.
+   */
+  static const Protobuf::MethodDescriptor& incrementalGrpcMethod(const std::string& grpc_method);
+
   /**
    * Check the grpc_services and cluster_names for API config sanity. Throws on error.
    * @param api_config_source the config source to validate.
@@ -302,6 +320,15 @@ public:
   static Stats::TagProducerPtr
   createTagProducer(const envoy::config::bootstrap::v2::Bootstrap& bootstrap);
 
+  /**
+   * Create StatsMatcher instance.
+   * @param bootstrap bootstrap proto.
+   * @return Stats::StatsMatcherPtr the matcher, or nullptr if no stats matcher is configured.
+   * @throws EnvoyException when a regex of the matcher is invalid.
+   */
+  static Stats::StatsMatcherPtr
+  createStatsMatcher(const envoy::config::bootstrap::v2::Bootstrap& bootstrap);
+
   /**
    * Check user supplied name in RDS/CDS/LDS for sanity.
    * It should be within the configured length limit. Throws on error.
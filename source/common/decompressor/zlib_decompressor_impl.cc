@@ -10,16 +10,13 @@ namespace Decompressor {
 ZlibDecompressorImpl::ZlibDecompressorImpl() : ZlibDecompressorImpl(4096) {}
 
 ZlibDecompressorImpl::ZlibDecompressorImpl(uint64_t chunk_size)
-    : chunk_size_{chunk_size}, initialized_{false}, chunk_char_ptr_(new unsigned char[chunk_size]),
-      zstream_ptr_(new z_stream(), [](z_stream* z) {
+    : chunk_size_{chunk_size}, initialized_{false}, zstream_ptr_(new z_stream(), [](z_stream* z) {
         inflateEnd(z);
         delete z;
       }) {
   zstream_ptr_->zalloc = Z_NULL;
   zstream_ptr_->zfree = Z_NULL;
   zstream_ptr_->opaque = Z_NULL;
-  zstream_ptr_->avail_out = chunk_size_;
-  zstream_ptr_->next_out = chunk_char_ptr_.get();
 }
 
 void ZlibDecompressorImpl::init(int64_t window_bits) {
@@ -37,24 +34,40 @@ void ZlibDecompressorImpl::decompress(const Buffer::Instance& input_buffer,
   Buffer::RawSlice slices[num_slices];
   input_buffer.getRawSlices(slices, num_slices);
 
+  // zlib writes straight into space reserved at the end of the output, so the decompressed bytes
+  // are never copied.
+  Buffer::RawSlice output_slice;
+  reserveOutput(output_buffer, output_slice);
   for (const Buffer::RawSlice& input_slice : slices) {
     zstream_ptr_->avail_in = input_slice.len_;
     zstream_ptr_->next_in = static_cast<Bytef*>(input_slice.mem_);
     while (inflateNext()) {
       if (zstream_ptr_->avail_out == 0) {
-        output_buffer.add(static_cast<void*>(chunk_char_ptr_.get()),
-                          chunk_size_ - zstream_ptr_->avail_out);
-        chunk_char_ptr_.reset(new unsigned char[chunk_size_]);
-        zstream_ptr_->avail_out = chunk_size_;
-        zstream_ptr_->next_out = chunk_char_ptr_.get();
+        commitOutput(output_buffer, output_slice);
+        reserveOutput(output_buffer, output_slice);
       }
     }
   }
 
-  const uint64_t n_output{chunk_size_ - zstream_ptr_->avail_out};
-  if (n_output > 0) {
-    output_buffer.add(static_cast<void*>(chunk_char_ptr_.get()), n_output);
+  commitOutput(output_buffer, output_slice);
+}
+
+void ZlibDecompressorImpl::reserveOutput(Buffer::Instance& output_buffer,
+                                         Buffer::RawSlice& output_slice) {
+  output_buffer.reserve(chunk_size_, &output_slice, 1);
+  zstream_ptr_->avail_out = output_slice.len_;
+  zstream_ptr_->next_out = static_cast<Bytef*>(output_slice.mem_);
+}
+
+void ZlibDecompressorImpl::commitOutput(Buffer::Instance& output_buffer,
+                                        Buffer::RawSlice& output_slice) {
+  output_slice.len_ -= zstream_ptr_->avail_out;
+  // An uncommitted reservation is simply replaced by the next one.
+  if (output_slice.len_ > 0) {
+    output_buffer.commit(&output_slice, 1);
   }
+  zstream_ptr_->avail_out = 0;
+  zstream_ptr_->next_out = nullptr;
 }
 
 bool ZlibDecompressorImpl::inflateNext() {
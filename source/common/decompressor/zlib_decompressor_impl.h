@@ -15,8 +15,8 @@ public:
   ZlibDecompressorImpl();
 
   /**
-   * Constructor that allows setting the size of decompressor's output buffer. It
-   * should be called whenever a buffer size different than the 4096 bytes, normally set by the
+   * Constructor that allows setting the size of the output space reserved for the decompressor at
+   * a time. It should be called whenever a size different than the 4096 bytes, normally set by the
    * default constructor, is desired. If memory is available and it makes sense to output large
    * chunks of compressed data, zlib documentation suggests buffers sizes on the order of 128K or
    * 256K bytes. @see http://zlib.net/zlib_how.html
@@ -45,11 +45,12 @@ public:
 
 private:
   bool inflateNext();
+  void reserveOutput(Buffer::Instance& output_buffer, Buffer::RawSlice& output_slice);
+  void commitOutput(Buffer::Instance& output_buffer, Buffer::RawSlice& output_slice);
 
   const uint64_t chunk_size_;
   bool initialized_;
 
-  std::unique_ptr<unsigned char[]> chunk_char_ptr_;
   std::unique_ptr<z_stream, std::function<void(z_stream*)>> zstream_ptr_;
 };
 
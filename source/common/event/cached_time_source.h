@@ -0,0 +1,49 @@
+#pragma once
+
+#include "envoy/common/time.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * TimeSource caching the times of another source until it is invalidated. Each time is read from
+ * the other source at most once between invalidations, on first use. Not thread safe.
+ */
+class CachedTimeSource : public TimeSource {
+public:
+  explicit CachedTimeSource(TimeSource& time_source) : time_source_(time_source) {}
+
+  /**
+   * Make the next reads of each time go to the other source.
+   */
+  void invalidate() {
+    system_time_valid_ = false;
+    monotonic_time_valid_ = false;
+  }
+
+  // TimeSource
+  SystemTime systemTime() override {
+    if (!system_time_valid_) {
+      system_time_ = time_source_.systemTime();
+      system_time_valid_ = true;
+    }
+    return system_time_;
+  }
+  MonotonicTime monotonicTime() override {
+    if (!monotonic_time_valid_) {
+      monotonic_time_ = time_source_.monotonicTime();
+      monotonic_time_valid_ = true;
+    }
+    return monotonic_time_;
+  }
+
+private:
+  TimeSource& time_source_;
+  SystemTime system_time_;
+  MonotonicTime monotonic_time_;
+  bool system_time_valid_{};
+  bool monotonic_time_valid_{};
+};
+
+} // namespace Event
+} // namespace Envoy
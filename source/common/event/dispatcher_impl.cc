@@ -13,10 +13,12 @@
 #include "common/common/lock_guard.h"
 #include "common/event/file_event_impl.h"
 #include "common/event/signal_impl.h"
+#include "common/event/timer_wheel.h"
 #include "common/filesystem/watcher_impl.h"
 #include "common/network/connection_impl.h"
 #include "common/network/dns_impl.h"
 #include "common/network/listener_impl.h"
+#include "common/network/udp_listener_impl.h"
 
 #include "event2/event.h"
 
@@ -30,18 +32,57 @@ DispatcherImpl::DispatcherImpl(TimeSystem& time_system)
 }
 
 DispatcherImpl::DispatcherImpl(TimeSystem& time_system, Buffer::WatermarkFactoryPtr&& factory)
-    : time_system_(time_system), buffer_factory_(std::move(factory)), base_(event_base_new()),
+    : time_system_(time_system), approximate_time_source_(time_system),
+      buffer_factory_(std::move(factory)), base_(Libevent::Global::createBase()),
       scheduler_(time_system_.createScheduler(base_)),
-      deferred_delete_timer_(createTimer([this]() -> void { clearDeferredDeleteList(); })),
-      post_timer_(createTimer([this]() -> void { runPostCallbacks(); })),
+      coarse_scheduler_(new TimerWheel(*scheduler_, time_system_)),
+      // The internal timers are created from the scheduler so that they are not timed as timers,
+      // their callbacks record their own stats.
+      deferred_delete_timer_(
+          scheduler_->createTimer([this]() -> void { clearDeferredDeleteList(); })),
+      post_timer_(scheduler_->createTimer([this]() -> void { runPostCallbacks(); })),
       current_to_delete_(&to_delete_1_) {
   RELEASE_ASSERT(Libevent::Global::initialized(), "");
 }
 
 DispatcherImpl::~DispatcherImpl() {}
 
+namespace {
+// How often the lateness of the event loop is measured.
+constexpr std::chrono::milliseconds LoopLagInterval(1000);
+} // namespace
+
+void DispatcherImpl::initializeStats(Stats::Scope& scope, const std::string& prefix) {
+  ASSERT(isThreadSafe());
+  stats_ = std::make_unique<DispatcherStats>(
+      DispatcherStats{ALL_DISPATCHER_STATS(POOL_GAUGE_PREFIX(scope, prefix),
+                                           POOL_HISTOGRAM_PREFIX(scope, prefix))});
+  loop_lag_timer_ = scheduler_->createTimer([this]() -> void { onLoopLagTimer(); });
+  loop_lag_deadline_ = time_system_.monotonicTime() + LoopLagInterval;
+  loop_lag_timer_->enableTimer(LoopLagInterval);
+}
+
+void DispatcherImpl::onLoopLagTimer() {
+  const MonotonicTime now = time_system_.monotonicTime();
+  if (now > loop_lag_deadline_) {
+    stats_->loop_lag_us_.recordValue(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - loop_lag_deadline_).count());
+  } else {
+    stats_->loop_lag_us_.recordValue(0);
+  }
+  loop_lag_deadline_ = now + LoopLagInterval;
+  loop_lag_timer_->enableTimer(LoopLagInterval);
+}
+
+void DispatcherImpl::recordDuration(Stats::Histogram& histogram, MonotonicTime start) {
+  histogram.recordValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                            time_system_.monotonicTime() - start)
+                            .count());
+}
+
 void DispatcherImpl::clearDeferredDeleteList() {
   ASSERT(isThreadSafe());
+  approximate_time_source_.invalidate();
   std::vector<DeferredDeletablePtr>* to_delete = current_to_delete_;
 
   size_t num_to_delete = to_delete->size();
@@ -50,6 +91,11 @@ void DispatcherImpl::clearDeferredDeleteList() {
   }
 
   ENVOY_LOG(trace, "clearing deferred deletion list (size={})", num_to_delete);
+  MonotonicTime start;
+  if (stats_ != nullptr) {
+    stats_->deferred_delete_queue_depth_.set(num_to_delete);
+    start = time_system_.monotonicTime();
+  }
 
   // Swap the current deletion vector so that if we do deferred delete while we are deleting, we
   // use the other vector. We will get another callback to delete that vector.
@@ -70,6 +116,9 @@ void DispatcherImpl::clearDeferredDeleteList() {
 
   to_delete->clear();
   deferred_deleting_ = false;
+  if (stats_ != nullptr) {
+    recordDuration(stats_->deferred_delete_us_, start);
+  }
 }
 
 Network::ConnectionPtr
@@ -90,6 +139,16 @@ DispatcherImpl::createClientConnection(Network::Address::InstanceConstSharedPtr
                                                          std::move(transport_socket), options);
 }
 
+Network::ClientConnectionPtr DispatcherImpl::createHappyEyeballsConnection(
+    const std::vector<Network::Address::InstanceConstSharedPtr>& addresses,
+    Network::Address::InstanceConstSharedPtr source_address,
+    Network::TransportSocketPtr&& transport_socket,
+    const Network::ConnectionSocket::OptionsSharedPtr& options) {
+  ASSERT(isThreadSafe());
+  return std::make_unique<Network::HappyEyeballsConnectionImpl>(
+      *this, addresses, source_address, std::move(transport_socket), options);
+}
+
 Network::DnsResolverSharedPtr DispatcherImpl::createDnsResolver(
     const std::vector<Network::Address::InstanceConstSharedPtr>& resolvers) {
   ASSERT(isThreadSafe());
@@ -99,7 +158,22 @@ Network::DnsResolverSharedPtr DispatcherImpl::createDnsResolver(
 FileEventPtr DispatcherImpl::createFileEvent(int fd, FileReadyCb cb, FileTriggerType trigger,
                                              uint32_t events) {
   ASSERT(isThreadSafe());
-  return FileEventPtr{new FileEventImpl(*this, fd, cb, trigger, events)};
+  FileReadyCb timed_cb = [this, cb](uint32_t events) -> void {
+    // The callback may destroy the file event, and this closure along with it.
+    DispatcherImpl& dispatcher = *this;
+    dispatcher.approximate_time_source_.invalidate();
+    if (dispatcher.stats_ == nullptr) {
+      cb(events);
+      return;
+    }
+    const MonotonicTime start = dispatcher.time_system_.monotonicTime();
+    cb(events);
+    // Events that are only writable are write events.
+    dispatcher.recordDuration(events == FileReadyType::Write ? dispatcher.stats_->write_event_us_
+                                                             : dispatcher.stats_->read_event_us_,
+                              start);
+  };
+  return FileEventPtr{new FileEventImpl(*this, fd, timed_cb, trigger, events)};
 }
 
 Filesystem::WatcherPtr DispatcherImpl::createFilesystemWatcher() {
@@ -115,9 +189,35 @@ DispatcherImpl::createListener(Network::Socket& socket, Network::ListenerCallbac
                                                         hand_off_restored_destination_connections)};
 }
 
+Network::UdpListenerPtr DispatcherImpl::createUdpListener(Network::Socket& socket,
+                                                          Network::UdpListenerCallbacks& cb) {
+  ASSERT(isThreadSafe());
+  return Network::UdpListenerPtr{new Network::UdpListenerImpl(*this, socket, cb)};
+}
+
 TimerPtr DispatcherImpl::createTimer(TimerCb cb) {
   ASSERT(isThreadSafe());
-  return scheduler_->createTimer(cb);
+  return scheduler_->createTimer(timedTimerCallback(cb));
+}
+
+TimerPtr DispatcherImpl::createCoarseTimer(TimerCb cb) {
+  ASSERT(isThreadSafe());
+  return coarse_scheduler_->createTimer(timedTimerCallback(cb));
+}
+
+TimerCb DispatcherImpl::timedTimerCallback(TimerCb cb) {
+  return [this, cb]() -> void {
+    // The callback may destroy the timer, and this closure along with it.
+    DispatcherImpl& dispatcher = *this;
+    dispatcher.approximate_time_source_.invalidate();
+    if (dispatcher.stats_ == nullptr) {
+      cb();
+      return;
+    }
+    const MonotonicTime start = dispatcher.time_system_.monotonicTime();
+    cb();
+    dispatcher.recordDuration(dispatcher.stats_->timer_us_, start);
+  };
 }
 
 void DispatcherImpl::deferredDelete(DeferredDeletablePtr&& to_delete) {
@@ -133,7 +233,11 @@ void DispatcherImpl::exit() { event_base_loopexit(base_.get(), nullptr); }
 
 SignalEventPtr DispatcherImpl::listenForSignal(int signal_num, SignalCb cb) {
   ASSERT(isThreadSafe());
-  return SignalEventPtr{new SignalEventImpl(*this, signal_num, cb)};
+  SignalCb signal_cb = [this, cb]() -> void {
+    approximate_time_source_.invalidate();
+    cb();
+  };
+  return SignalEventPtr{new SignalEventImpl(*this, signal_num, signal_cb)};
 }
 
 void DispatcherImpl::post(std::function<void()> callback) {
@@ -159,9 +263,18 @@ void DispatcherImpl::run(RunType type) {
   runPostCallbacks();
 
   event_base_loop(base_.get(), type == RunType::NonBlock ? EVLOOP_NONBLOCK : 0);
+  // Code running between loops, e.g. in tests, doesn't see the times of the last callback.
+  approximate_time_source_.invalidate();
 }
 
 void DispatcherImpl::runPostCallbacks() {
+  MonotonicTime start;
+  if (stats_ != nullptr) {
+    Thread::LockGuard lock(post_lock_);
+    stats_->post_queue_depth_.set(post_callbacks_.size());
+    start = time_system_.monotonicTime();
+  }
+
   while (true) {
     // It is important that this declaration is inside the body of the loop so that the callback is
     // destructed while post_lock_ is not held. If callback is declared outside the loop and reused
@@ -173,13 +286,18 @@ void DispatcherImpl::runPostCallbacks() {
     {
       Thread::LockGuard lock(post_lock_);
       if (post_callbacks_.empty()) {
-        return;
+        break;
       }
       callback = post_callbacks_.front();
       post_callbacks_.pop_front();
     }
+    approximate_time_source_.invalidate();
     callback();
   }
+
+  if (stats_ != nullptr) {
+    recordDuration(stats_->post_us_, start);
+  }
 }
 
 } // namespace Event
@@ -9,14 +9,39 @@
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/network/connection_handler.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 
 #include "common/common/logger.h"
 #include "common/common/thread.h"
+#include "common/event/cached_time_source.h"
 #include "common/event/libevent.h"
 
 namespace Envoy {
 namespace Event {
 
+/**
+ * All dispatcher stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_DISPATCHER_STATS(GAUGE, HISTOGRAM)                                                     \
+  GAUGE    (post_queue_depth)                                                                      \
+  GAUGE    (deferred_delete_queue_depth)                                                           \
+  HISTOGRAM(loop_lag_us)                                                                           \
+  HISTOGRAM(read_event_us)                                                                         \
+  HISTOGRAM(write_event_us)                                                                        \
+  HISTOGRAM(timer_us)                                                                              \
+  HISTOGRAM(post_us)                                                                               \
+  HISTOGRAM(deferred_delete_us)
+// clang-format on
+
+/**
+ * Struct definition for all dispatcher stats. @see stats_macros.h
+ */
+struct DispatcherStats {
+  ALL_DISPATCHER_STATS(GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
+};
+
 /**
  * libevent implementation of Event::Dispatcher.
  */
@@ -33,6 +58,8 @@ public:
 
   // Event::Dispatcher
   TimeSystem& timeSystem() override { return time_system_; }
+  TimeSource& approximateTimeSource() override { return approximate_time_source_; }
+  void initializeStats(Stats::Scope& scope, const std::string& prefix) override;
   void clearDeferredDeleteList() override;
   Network::ConnectionPtr
   createServerConnection(Network::ConnectionSocketPtr&& socket,
@@ -42,6 +69,11 @@ public:
                          Network::Address::InstanceConstSharedPtr source_address,
                          Network::TransportSocketPtr&& transport_socket,
                          const Network::ConnectionSocket::OptionsSharedPtr& options) override;
+  Network::ClientConnectionPtr createHappyEyeballsConnection(
+      const std::vector<Network::Address::InstanceConstSharedPtr>& addresses,
+      Network::Address::InstanceConstSharedPtr source_address,
+      Network::TransportSocketPtr&& transport_socket,
+      const Network::ConnectionSocket::OptionsSharedPtr& options) override;
   Network::DnsResolverSharedPtr createDnsResolver(
       const std::vector<Network::Address::InstanceConstSharedPtr>& resolvers) override;
   FileEventPtr createFileEvent(int fd, FileReadyCb cb, FileTriggerType trigger,
@@ -50,7 +82,10 @@ public:
   Network::ListenerPtr createListener(Network::Socket& socket, Network::ListenerCallbacks& cb,
                                       bool bind_to_port,
                                       bool hand_off_restored_destination_connections) override;
+  Network::UdpListenerPtr createUdpListener(Network::Socket& socket,
+                                            Network::UdpListenerCallbacks& cb) override;
   TimerPtr createTimer(TimerCb cb) override;
+  TimerPtr createCoarseTimer(TimerCb cb) override;
   void deferredDelete(DeferredDeletablePtr&& to_delete) override;
   void exit() override;
   SignalEventPtr listenForSignal(int signal_num, SignalCb cb) override;
@@ -60,6 +95,10 @@ public:
 
 private:
   void runPostCallbacks();
+  void onLoopLagTimer();
+  TimerCb timedTimerCallback(TimerCb cb);
+  // Records the time elapsed since start, in microseconds.
+  void recordDuration(Stats::Histogram& histogram, MonotonicTime start);
 
   // Validate that an operation is thread safe, i.e. it's invoked on the same thread that the
   // dispatcher run loop is executing on. We allow run_tid_ == 0 for tests where we don't invoke
@@ -69,10 +108,13 @@ private:
   }
 
   TimeSystem& time_system_;
+  // Invalidated before each event loop callback.
+  CachedTimeSource approximate_time_source_;
   Thread::ThreadId run_tid_{};
   Buffer::WatermarkFactoryPtr buffer_factory_;
   Libevent::BasePtr base_;
   SchedulerPtr scheduler_;
+  SchedulerPtr coarse_scheduler_;
   TimerPtr deferred_delete_timer_;
   TimerPtr post_timer_;
   std::vector<DeferredDeletablePtr> to_delete_1_;
@@ -81,6 +123,11 @@ private:
   Thread::MutexBasicLockable post_lock_;
   std::list<std::function<void()>> post_callbacks_ GUARDED_BY(post_lock_);
   bool deferred_deleting_{};
+  // Set by initializeStats(), the callbacks are only timed from then on.
+  std::unique_ptr<DispatcherStats> stats_;
+  // Fires periodically to measure how late the event loop runs its timers.
+  TimerPtr loop_lag_timer_;
+  MonotonicTime loop_lag_deadline_;
 };
 
 } // namespace Event
@@ -2,8 +2,11 @@
 
 #include <signal.h>
 
+#include <string>
+
 #include "common/common/assert.h"
 
+#include "event2/event.h"
 #include "event2/thread.h"
 
 namespace Envoy {
@@ -11,6 +14,7 @@ namespace Event {
 namespace Libevent {
 
 bool Global::initialized_ = false;
+Backend Global::backend_ = Backend::Default;
 
 void Global::initialize() {
   evthread_use_pthreads();
@@ -20,6 +24,23 @@ void Global::initialize() {
   initialized_ = true;
 }
 
+BasePtr Global::createBase() {
+  if (backend_ == Backend::Default) {
+    return BasePtr(event_base_new());
+  }
+
+  ASSERT(backend_ == Backend::EpollChangelist);
+  event_config* config = event_config_new();
+  RELEASE_ASSERT(config != nullptr, "");
+  event_config_set_flag(config, EVENT_BASE_FLAG_EPOLL_USE_CHANGELIST);
+  BasePtr base(event_base_new_with_config(config));
+  event_config_free(config);
+  // libevent ignores the flag on other backends; don't silently run with one of them.
+  RELEASE_ASSERT(base != nullptr && std::string(event_base_get_method(base.get())) == "epoll",
+                 "epoll changelist backend is unavailable");
+  return base;
+}
+
 } // namespace Libevent
 } // namespace Event
 } // namespace Envoy
@@ -26,6 +26,20 @@ namespace Envoy {
 namespace Event {
 namespace Libevent {
 
+typedef CSmartPtr<event_base, event_base_free> BasePtr;
+
+/**
+ * How event bases poll for readiness.
+ */
+enum class Backend {
+  // Whatever libevent picks for the platform (epoll on Linux).
+  Default,
+  // epoll with fd interest changes queued and applied together when the loop next polls, instead
+  // of an epoll_ctl() per change. Must not be used with fds cloned by dup(), which can trigger a
+  // Linux kernel bug.
+  EpollChangelist,
+};
+
 /**
  * Global functionality specific to libevent.
  */
@@ -38,12 +52,23 @@ public:
    */
   static void initialize();
 
+  /**
+   * Select the backend used by event bases created afterwards.
+   */
+  static void setBackend(Backend backend) { backend_ = backend; }
+  static Backend backend() { return backend_; }
+
+  /**
+   * @return BasePtr a new event base using the selected backend.
+   */
+  static BasePtr createBase();
+
 private:
   // True if initialized() has been called.
   static bool initialized_;
+  static Backend backend_;
 };
 
-typedef CSmartPtr<event_base, event_base_free> BasePtr;
 typedef CSmartPtr<evbuffer, evbuffer_free> BufferPtr;
 typedef CSmartPtr<bufferevent, bufferevent_free> BufferEventPtr;
 typedef CSmartPtr<evconnlistener, evconnlistener_free> ListenerPtr;
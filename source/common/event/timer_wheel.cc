@@ -0,0 +1,129 @@
+#include "common/event/timer_wheel.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Event {
+
+static_assert((TimerWheel::NumSlots & (TimerWheel::NumSlots - 1)) == 0,
+              "NumSlots must be a power of two");
+
+void TimerWheel::Node::unlink() {
+  prev_->next_ = next_;
+  next_->prev_ = prev_;
+  prev_ = next_ = this;
+}
+
+void TimerWheel::Node::linkBefore(Node& position) {
+  ASSERT(!linked());
+  prev_ = position.prev_;
+  next_ = &position;
+  prev_->next_ = this;
+  position.prev_ = this;
+}
+
+TimerWheel::TimerWheel(Scheduler& base_scheduler, TimeSource& time_source)
+    : time_source_(time_source), epoch_(time_source.monotonicTime()),
+      tick_timer_(base_scheduler.createTimer([this]() -> void { onTick(); })),
+      slots_(new Node[NumSlots]), next_tick_(0) {}
+
+TimerPtr TimerWheel::createTimer(const TimerCb& cb) {
+  ASSERT(cb);
+  return std::make_unique<WheelTimer>(*this, cb);
+}
+
+uint64_t TimerWheel::nowTick() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time_source_.monotonicTime() -
+                                                               epoch_)
+      .count();
+}
+
+void TimerWheel::schedule(WheelTimer& timer, const std::chrono::milliseconds& d) {
+  timer.unlink();
+
+  // The current tick is already partially over, so round up to never fire early. Slots before
+  // next_tick_ have already been processed.
+  const uint64_t now = nowTick();
+  const uint64_t tick = std::max(now + d.count() + 1, next_tick_);
+  const uint32_t slot = tick & SlotMask;
+  timer.expiry_tick_ = tick;
+  timer.linkBefore(slots_[slot]);
+  occupied_[slot / 64] |= 1ULL << (slot % 64);
+
+  if (tick < armed_tick_) {
+    arm(tick, now);
+  }
+}
+
+void TimerWheel::arm(uint64_t tick, uint64_t now) {
+  armed_tick_ = tick;
+  tick_timer_->enableTimer(std::chrono::milliseconds(tick > now ? tick - now : 0));
+}
+
+void TimerWheel::armNextOccupied(uint64_t now) {
+  // Find the first occupied slot at or after next_tick_, at most one revolution out.
+  const uint32_t start = next_tick_ & SlotMask;
+  uint32_t distance = 0;
+  while (distance < NumSlots) {
+    const uint32_t slot = (start + distance) & SlotMask;
+    const uint64_t bits = occupied_[slot / 64] >> (slot % 64);
+    if (bits == 0) {
+      distance += 64 - (slot % 64);
+      continue;
+    }
+
+    distance += __builtin_ctzll(bits);
+    if (distance >= NumSlots) {
+      break;
+    }
+
+    const uint32_t occupied_slot = (start + distance) & SlotMask;
+    if (slots_[occupied_slot].linked()) {
+      const uint64_t tick = next_tick_ + distance;
+      if (tick < armed_tick_) {
+        arm(tick, now);
+      }
+      return;
+    }
+
+    // All timers in this slot were disabled or re-enabled elsewhere.
+    occupied_[occupied_slot / 64] &= ~(1ULL << (occupied_slot % 64));
+  }
+}
+
+void TimerWheel::onTick() {
+  armed_tick_ = NotArmed;
+  const uint64_t now = nowTick();
+
+  // Collect the expired timers of every slot up to now, visiting each slot at most once. Timers
+  // in these slots that belong to a later revolution stay where they are.
+  Node expired;
+  const uint64_t end = std::min(now + 1, next_tick_ + NumSlots);
+  for (uint64_t tick = next_tick_; tick < end; ++tick) {
+    Node& slot = slots_[tick & SlotMask];
+    for (Node* node = slot.next_; node != &slot;) {
+      Node* next = node->next_;
+      if (static_cast<WheelTimer*>(node)->expiry_tick_ <= now) {
+        node->unlink();
+        node->linkBefore(expired);
+      }
+      node = next;
+    }
+  }
+  next_tick_ = now + 1;
+
+  // Callbacks may enable, disable or destroy any timer, including ones still on the expired list,
+  // so always take the current head.
+  while (expired.linked()) {
+    WheelTimer& timer = static_cast<WheelTimer&>(*expired.next_);
+    timer.unlink();
+    timer.cb_();
+  }
+
+  armNextOccupied(now);
+}
+
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/time.h"
+#include "envoy/event/timer.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Hashed timer wheel with millisecond resolution. Timers are bucketed by expiry into a fixed ring
+ * of slots, so enabling, re-enabling and disabling a timer are O(1) list operations rather than
+ * libevent min-heap updates. This suits timeouts that are re-armed or cancelled far more often than
+ * they fire, such as idle timeouts. A single timer from the underlying scheduler is armed for the
+ * next occupied slot. Timers expiring more than one revolution out stay in their slot until their
+ * revolution comes around.
+ *
+ * A timer fires no earlier than requested and up to one millisecond later (plus event loop
+ * latency); a zero timeout fires on the next tick rather than in the current loop iteration.
+ */
+class TimerWheel : public Scheduler {
+public:
+  TimerWheel(Scheduler& base_scheduler, TimeSource& time_source);
+
+  // Scheduler
+  TimerPtr createTimer(const TimerCb& cb) override;
+
+  static constexpr uint32_t NumSlots = 4096;
+
+private:
+  // Node of an intrusive circular list. An unlinked node points to itself, so a node can be
+  // unlinked without knowing which list it is on.
+  struct Node {
+    Node() = default;
+    Node(const Node&) = delete;
+    Node& operator=(const Node&) = delete;
+
+    bool linked() const { return next_ != this; }
+    void unlink();
+    void linkBefore(Node& position);
+
+    Node* prev_{this};
+    Node* next_{this};
+  };
+
+  class WheelTimer : public Timer, public Node {
+  public:
+    WheelTimer(TimerWheel& wheel, const TimerCb& cb) : wheel_(wheel), cb_(cb) {}
+    ~WheelTimer() { unlink(); }
+
+    // Timer
+    void disableTimer() override { unlink(); }
+    void enableTimer(const std::chrono::milliseconds& d) override { wheel_.schedule(*this, d); }
+
+    TimerWheel& wheel_;
+    const TimerCb cb_;
+    uint64_t expiry_tick_{};
+  };
+
+  static constexpr uint64_t NotArmed = UINT64_MAX;
+  static constexpr uint32_t SlotMask = NumSlots - 1;
+
+  uint64_t nowTick();
+  void schedule(WheelTimer& timer, const std::chrono::milliseconds& d);
+  void arm(uint64_t tick, uint64_t now);
+  void armNextOccupied(uint64_t now);
+  void onTick();
+
+  TimeSource& time_source_;
+  const MonotonicTime epoch_;
+  TimerPtr tick_timer_;
+  std::unique_ptr<Node[]> slots_;
+  // One bit per slot, set when a timer is linked into the slot. Bits are cleared lazily when a
+  // scan finds the slot empty.
+  uint64_t occupied_[NumSlots / 64]{};
+  // The first tick whose slot has not been processed yet.
+  uint64_t next_tick_;
+  // The tick tick_timer_ is armed for.
+  uint64_t armed_tick_{NotArmed};
+};
+
+} // namespace Event
+} // namespace Envoy
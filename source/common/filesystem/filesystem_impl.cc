@@ -2,8 +2,11 @@
 
 #include <dirent.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
+#include <algorithm>
 #include <chrono>
+#include <climits>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
@@ -92,12 +95,73 @@ bool illegalPath(const std::string& path) {
   }
 }
 
+FileFlusher::~FileFlusher() {
+  {
+    Thread::LockGuard lock(mutex_);
+    exit_ = true;
+    ready_event_.notifyOne();
+  }
+
+  if (thread_ != nullptr) {
+    thread_->join();
+  }
+}
+
+void FileFlusher::requestFlush(FileImpl& file) {
+  Thread::LockGuard lock(mutex_);
+  if (thread_ == nullptr) {
+    thread_.reset(new Thread::Thread([this]() -> void { threadRoutine(); }));
+  }
+  if (std::find(pending_.begin(), pending_.end(), &file) == pending_.end()) {
+    pending_.push_back(&file);
+    ready_event_.notifyOne();
+  }
+}
+
+void FileFlusher::cancel(FileImpl& file) {
+  Thread::LockGuard lock(mutex_);
+  pending_.erase(std::remove(pending_.begin(), pending_.end(), &file), pending_.end());
+  while (flushing_ == &file) {
+    // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+    idle_event_.wait(mutex_);
+  }
+}
+
+void FileFlusher::threadRoutine() {
+  while (true) {
+    FileImpl* file;
+    {
+      Thread::LockGuard lock(mutex_);
+      while (pending_.empty() && !exit_) {
+        ready_event_.wait(mutex_);
+      }
+
+      if (exit_) {
+        return;
+      }
+
+      file = pending_.front();
+      pending_.pop_front();
+      flushing_ = file;
+    }
+
+    file->flushBuffered();
+
+    {
+      Thread::LockGuard lock(mutex_);
+      flushing_ = nullptr;
+      idle_event_.notifyAll();
+    }
+  }
+}
+
 FileImpl::FileImpl(const std::string& path, Event::Dispatcher& dispatcher,
                    Thread::BasicLockable& lock, Stats::Store& stats_store,
-                   std::chrono::milliseconds flush_interval_msec)
-    : path_(path), file_lock_(lock), flush_timer_(dispatcher.createTimer([this]() -> void {
+                   std::chrono::milliseconds flush_interval_msec, FileFlusherSharedPtr flusher)
+    : path_(path), file_lock_(lock), flusher_(flusher),
+      flush_timer_(dispatcher.createTimer([this]() -> void {
         stats_.flushed_by_timer_.inc();
-        flush_event_.notifyOne();
+        flusher_->requestFlush(*this);
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
       os_sys_calls_(Api::OsSysCallsSingleton::get()), flush_interval_msec_(flush_interval_msec),
@@ -119,15 +183,7 @@ void FileImpl::open() {
 void FileImpl::reopen() { reopen_file_ = true; }
 
 FileImpl::~FileImpl() {
-  {
-    Thread::LockGuard lock(write_lock_);
-    flush_thread_exit_ = true;
-    flush_event_.notifyOne();
-  }
-
-  if (flush_thread_ != nullptr) {
-    flush_thread_->join();
-  }
+  flusher_->cancel(*this);
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
   if (fd_ != -1) {
@@ -154,10 +210,26 @@ void FileImpl::doWrite(Buffer::Instance& buffer) {
   //            process lock or had multiple locks.
   {
     Thread::LockGuard lock(file_lock_);
-    for (Buffer::RawSlice& slice : slices) {
-      const Api::SysCallSizeResult result = os_sys_calls_.write(fd_, slice.mem_, slice.len_);
-      ASSERT(result.rc_ == static_cast<ssize_t>(slice.len_));
+    if (num_slices == 1) {
+      const Api::SysCallSizeResult result =
+          os_sys_calls_.write(fd_, slices[0].mem_, slices[0].len_);
+      ASSERT(result.rc_ == static_cast<ssize_t>(slices[0].len_));
       stats_.write_completed_.inc();
+    } else {
+      // Write everything that has been buffered with as few system calls as possible.
+      for (uint64_t i = 0; i < num_slices; i += IOV_MAX) {
+        const uint64_t num_iovecs = std::min<uint64_t>(IOV_MAX, num_slices - i);
+        iovec iov[num_iovecs];
+        ssize_t length = 0;
+        for (uint64_t j = 0; j < num_iovecs; j++) {
+          iov[j].iov_base = slices[i + j].mem_;
+          iov[j].iov_len = slices[i + j].len_;
+          length += slices[i + j].len_;
+        }
+        const Api::SysCallSizeResult result = os_sys_calls_.writev(fd_, iov, num_iovecs);
+        ASSERT(result.rc_ == length);
+        stats_.write_completed_.inc();
+      }
     }
   }
 
@@ -165,44 +237,35 @@ void FileImpl::doWrite(Buffer::Instance& buffer) {
   buffer.drain(buffer.length());
 }
 
-void FileImpl::flushThreadFunc() {
-
-  while (true) {
-    std::unique_lock<Thread::BasicLockable> flush_lock;
-
-    {
-      Thread::LockGuard write_lock(write_lock_);
-
-      // flush_event_ can be woken up either by large enough flush_buffer or by timer.
-      // In case it was timer, flush_buffer_ can be empty.
-      while (flush_buffer_.length() == 0 && !flush_thread_exit_) {
-        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
-        flush_event_.wait(write_lock_);
-      }
+void FileImpl::flushBuffered() {
+  std::unique_lock<Thread::BasicLockable> flush_lock;
 
-      if (flush_thread_exit_) {
-        return;
-      }
+  {
+    Thread::LockGuard write_lock(write_lock_);
 
-      flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-      ASSERT(flush_buffer_.length() > 0);
-      about_to_write_buffer_.move(flush_buffer_);
-      ASSERT(flush_buffer_.length() == 0);
+    // The flush may have been requested by the timer, or flush() may have written out the buffer
+    // since it was requested, so flush_buffer_ can be empty.
+    if (flush_buffer_.length() == 0) {
+      return;
     }
 
-    // if we failed to open file before (-1 == fd_), then simply ignore
-    if (fd_ != -1) {
-      try {
-        if (reopen_file_) {
-          reopen_file_ = false;
-          os_sys_calls_.close(fd_);
-          open();
-        }
+    flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
+    about_to_write_buffer_.move(flush_buffer_);
+    ASSERT(flush_buffer_.length() == 0);
+  }
 
-        doWrite(about_to_write_buffer_);
-      } catch (const EnvoyException&) {
-        stats_.reopen_failed_.inc();
+  // if we failed to open file before (-1 == fd_), then simply ignore
+  if (fd_ != -1) {
+    try {
+      if (reopen_file_) {
+        reopen_file_ = false;
+        os_sys_calls_.close(fd_);
+        open();
       }
+
+      doWrite(about_to_write_buffer_);
+    } catch (const EnvoyException&) {
+      stats_.reopen_failed_.inc();
     }
   }
 }
@@ -214,7 +277,7 @@ void FileImpl::flush() {
     Thread::LockGuard write_lock(write_lock_);
 
     // flush_lock_ must be held while checking this or else it is
-    // possible that flushThreadFunc() has already moved data from
+    // possible that flushBuffered() has already moved data from
     // flush_buffer_ to about_to_write_buffer_, has unlocked write_lock_,
     // but has not yet completed doWrite(). This would allow flush() to
     // return before the pending data has actually been written to disk.
@@ -234,7 +297,7 @@ void FileImpl::flush() {
 void FileImpl::write(absl::string_view data) {
   Thread::LockGuard lock(write_lock_);
 
-  if (flush_thread_ == nullptr) {
+  if (!flush_structures_created_) {
     createFlushStructures();
   }
 
@@ -242,12 +305,14 @@ void FileImpl::write(absl::string_view data) {
   stats_.write_total_buffered_.add(data.length());
   flush_buffer_.add(data.data(), data.size());
   if (flush_buffer_.length() > MIN_FLUSH_SIZE) {
-    flush_event_.notifyOne();
+    flusher_->requestFlush(*this);
   }
 }
 
 void FileImpl::createFlushStructures() {
-  flush_thread_.reset(new Thread::Thread([this]() -> void { flushThreadFunc(); }));
+  flush_structures_created_ = true;
+  // Flush the first write right away, so that a new log shows up without waiting for the timer.
+  flusher_->requestFlush(*this);
   flush_timer_->enableTimer(flush_interval_msec_);
 }
 
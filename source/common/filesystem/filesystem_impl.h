@@ -4,6 +4,8 @@
 #include <chrono>
 #include <cstdint>
 #include <cstdlib>
+#include <deque>
+#include <memory>
 #include <string>
 
 #include "envoy/api/os_sys_calls.h"
@@ -72,17 +74,54 @@ std::string canonicalPath(const std::string& path);
  */
 bool illegalPath(const std::string& path);
 
+class FileImpl;
+
+/**
+ * Thread that flushes the buffered writes of all the FileImpls that share it, so that the number
+ * of access log files doesn't determine the number of threads. Files ask for a flush once their
+ * buffer is large enough or their flush timer fires, and the thread flushes the files in the order
+ * that they asked. The thread is started by the first request.
+ */
+class FileFlusher {
+public:
+  ~FileFlusher();
+
+  /**
+   * Queue a file to be flushed, unless it already is.
+   */
+  void requestFlush(FileImpl& file);
+
+  /**
+   * Remove a file from the queue, and wait for the thread to finish flushing it if it is. The
+   * file won't be flushed by the thread afterwards.
+   */
+  void cancel(FileImpl& file);
+
+private:
+  void threadRoutine();
+
+  Thread::MutexBasicLockable mutex_;
+  Thread::CondVar ready_event_; // Signalled when a file is queued or the thread should exit.
+  Thread::CondVar idle_event_;  // Signalled when the thread has finished flushing a file.
+  std::deque<FileImpl*> pending_ GUARDED_BY(mutex_);
+  FileImpl* flushing_ GUARDED_BY(mutex_){};
+  bool exit_ GUARDED_BY(mutex_){};
+  Thread::ThreadPtr thread_;
+};
+
+typedef std::shared_ptr<FileFlusher> FileFlusherSharedPtr;
+
 /**
  * This is a file implementation geared for writing out access logs. It turn out that in certain
  * cases even if a standard file is opened with O_NONBLOCK, the kernel can still block when writing.
- * This implementation uses a flush thread per file, with the idea there there aren't that many
- * files. If this turns out to be a good implementation we can potentially have a single flush
- * thread that flushes all files, but we will start with this.
+ * Writes are therefore buffered, and written out by a FileFlusher thread that is shared by all the
+ * files created by an Api::Api.
  */
 class FileImpl : public File {
 public:
   FileImpl(const std::string& path, Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
-           Stats::Store& stats_store, std::chrono::milliseconds flush_interval_msec);
+           Stats::Store& stats_store, std::chrono::milliseconds flush_interval_msec,
+           FileFlusherSharedPtr flusher);
   ~FileImpl();
 
   // Filesystem::File
@@ -100,8 +139,11 @@ public:
   void flush() override;
 
 private:
+  friend class FileFlusher;
+
   void doWrite(Buffer::Instance& buffer);
-  void flushThreadFunc();
+  // Called by the FileFlusher thread to write out the buffered data.
+  void flushBuffered();
   void open();
   void createFlushStructures();
 
@@ -115,6 +157,7 @@ private:
   //    1) write_lock_
   //    2) flush_lock_
   //    3) file_lock_
+  // The FileFlusher's lock is only ever held on its own, or after write_lock_.
   Thread::BasicLockable& file_lock_;      // This lock is used only by the flush thread when writing
                                           // to disk. This is used to make sure that file blocks do
                                           // not get interleaved by multiple processes writing to
@@ -128,9 +171,8 @@ private:
       write_lock_; // The lock is used when filling the flush buffer. It allows
                    // multiple threads to write to the same file at relatively
                    // high performance. It is always local to the process.
-  Thread::ThreadPtr flush_thread_;
-  Thread::CondVar flush_event_;
-  std::atomic<bool> flush_thread_exit_{};
+  const FileFlusherSharedPtr flusher_;
+  bool flush_structures_created_ GUARDED_BY(write_lock_){};
   std::atomic<bool> reopen_file_{};
   Buffer::OwnedImpl
       flush_buffer_ GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It gets
@@ -31,12 +31,24 @@ AsyncClientFactoryImpl::AsyncClientFactoryImpl(Upstream::ClusterManager& cm,
 }
 
 AsyncClientManagerImpl::AsyncClientManagerImpl(Upstream::ClusterManager& cm,
-                                               ThreadLocal::Instance& tls, TimeSource& time_source)
+                                               ThreadLocal::Instance& tls, TimeSource& time_source,
+                                               uint32_t google_grpc_completion_threads)
     : cm_(cm), tls_(tls), time_source_(time_source) {
 #ifdef ENVOY_GOOGLE_GRPC
+  // The pool lives as long as the last thread local client using it.
+  GoogleCompletionQueuePoolSharedPtr cq_pool;
+  if (google_grpc_completion_threads > 0) {
+    cq_pool = std::make_shared<GoogleCompletionQueuePool>(google_grpc_completion_threads);
+  }
   google_tls_slot_ = tls.allocateSlot();
-  google_tls_slot_->set(
-      [](Event::Dispatcher&) { return std::make_shared<GoogleAsyncClientThreadLocal>(); });
+  google_tls_slot_->set([cq_pool](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    if (cq_pool != nullptr) {
+      return std::make_shared<GoogleAsyncClientThreadLocal>(cq_pool);
+    }
+    return std::make_shared<GoogleAsyncClientThreadLocal>();
+  });
+#else
+  UNREFERENCED_PARAMETER(google_grpc_completion_threads);
 #endif
 }
 
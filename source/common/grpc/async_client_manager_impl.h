@@ -40,8 +40,12 @@ private:
 
 class AsyncClientManagerImpl : public AsyncClientManager {
 public:
+  /**
+   * @param google_grpc_completion_threads the number of completion queue threads shared by the
+   *        Google gRPC clients of all the threads, or 0 for each thread to run its own.
+   */
   AsyncClientManagerImpl(Upstream::ClusterManager& cm, ThreadLocal::Instance& tls,
-                         TimeSource& time_source);
+                         TimeSource& time_source, uint32_t google_grpc_completion_threads);
 
   // Grpc::AsyncClientManager
   AsyncClientFactoryPtr factoryForGrpcService(const envoy::api::v2::core::GrpcService& config,
@@ -1,10 +1,13 @@
 #include "common/grpc/codec.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <vector>
 
 #include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/macros.h"
 
 namespace Envoy {
 namespace Grpc {
@@ -22,79 +25,144 @@ void Encoder::newFrame(uint8_t flags, uint64_t length, std::array<uint8_t, 5>& o
 Decoder::Decoder() : state_(State::FH_FLAG) {}
 
 bool Decoder::decode(Buffer::Instance& input, std::vector<Frame>& output) {
+  // Validate all the frame headers first, so that an error leaves the input unchanged.
+  if (!checkFlags(input)) {
+    return false;
+  }
+
+  while (input.length() > 0) {
+    switch (state_) {
+    case State::DATA: {
+      // Move the payload slices out of the input rather than copying them.
+      const uint64_t remain_in_frame = frame_.length_ - frame_.data_->length();
+      frame_.data_->move(input, std::min(input.length(), remain_in_frame));
+      if (frame_.length_ == frame_.data_->length()) {
+        output.push_back(std::move(frame_));
+        frame_.flags_ = 0;
+        frame_.length_ = 0;
+        state_ = State::FH_FLAG;
+      }
+      break;
+    }
+    case State::FH_FLAG:
+      if (input.length() >= GRPC_FRAME_HEADER_SIZE) {
+        // Fast path for a header contained in the input.
+        std::array<uint8_t, GRPC_FRAME_HEADER_SIZE> header;
+        input.copyOut(0, GRPC_FRAME_HEADER_SIZE, header.data());
+        input.drain(GRPC_FRAME_HEADER_SIZE);
+        frame_.flags_ = header[0];
+        frame_.length_ = static_cast<uint32_t>(header[1]) << 24 |
+                         static_cast<uint32_t>(header[2]) << 16 |
+                         static_cast<uint32_t>(header[3]) << 8 | static_cast<uint32_t>(header[4]);
+        onHeaderComplete(output);
+        break;
+      }
+      FALLTHRU;
+    default: {
+      uint8_t c;
+      input.copyOut(0, 1, &c);
+      input.drain(1);
+      decodeHeaderByte(c, output);
+      break;
+    }
+    }
+  }
+  return true;
+}
+
+bool Decoder::checkFlags(const Buffer::Instance& input) const {
+  State state = state_;
+  uint32_t length = frame_.length_;
+  uint64_t remain_in_frame =
+      state_ == State::DATA ? frame_.length_ - frame_.data_->length() : 0;
+
   uint64_t count = input.getRawSlices(nullptr, 0);
   Buffer::RawSlice slices[count];
   input.getRawSlices(slices, count);
-  for (Buffer::RawSlice& slice : slices) {
-    uint8_t* mem = reinterpret_cast<uint8_t*>(slice.mem_);
+  for (const Buffer::RawSlice& slice : slices) {
+    const uint8_t* mem = static_cast<const uint8_t*>(slice.mem_);
     for (uint64_t j = 0; j < slice.len_;) {
-      uint8_t c = *mem;
-      switch (state_) {
+      if (state == State::DATA) {
+        const uint64_t skip = std::min(slice.len_ - j, remain_in_frame);
+        j += skip;
+        remain_in_frame -= skip;
+        if (remain_in_frame == 0) {
+          state = State::FH_FLAG;
+        }
+        continue;
+      }
+
+      const uint8_t c = mem[j++];
+      switch (state) {
       case State::FH_FLAG:
         if (c & ~GRPC_FH_COMPRESSED) {
           // Unsupported flags.
           return false;
         }
-        frame_.flags_ = c;
-        state_ = State::FH_LEN_0;
-        mem++;
-        j++;
+        state = State::FH_LEN_0;
         break;
       case State::FH_LEN_0:
-        frame_.length_ = static_cast<uint32_t>(c) << 24;
-        state_ = State::FH_LEN_1;
-        mem++;
-        j++;
+        length = static_cast<uint32_t>(c) << 24;
+        state = State::FH_LEN_1;
         break;
       case State::FH_LEN_1:
-        frame_.length_ |= static_cast<uint32_t>(c) << 16;
-        state_ = State::FH_LEN_2;
-        mem++;
-        j++;
+        length |= static_cast<uint32_t>(c) << 16;
+        state = State::FH_LEN_2;
         break;
       case State::FH_LEN_2:
-        frame_.length_ |= static_cast<uint32_t>(c) << 8;
-        state_ = State::FH_LEN_3;
-        mem++;
-        j++;
+        length |= static_cast<uint32_t>(c) << 8;
+        state = State::FH_LEN_3;
         break;
       case State::FH_LEN_3:
-        frame_.length_ |= static_cast<uint32_t>(c);
-        if (frame_.length_ == 0) {
-          output.push_back(std::move(frame_));
-          state_ = State::FH_FLAG;
-        } else {
-          frame_.data_.reset(new Buffer::OwnedImpl());
-          state_ = State::DATA;
-        }
-        mem++;
-        j++;
+        length |= static_cast<uint32_t>(c);
+        remain_in_frame = length;
+        state = length == 0 ? State::FH_FLAG : State::DATA;
         break;
       case State::DATA:
-        uint64_t remain_in_buffer = slice.len_ - j;
-        uint64_t remain_in_frame = frame_.length_ - frame_.data_->length();
-        if (remain_in_buffer <= remain_in_frame) {
-          frame_.data_->add(mem, remain_in_buffer);
-          mem += remain_in_buffer;
-          j += remain_in_buffer;
-        } else {
-          frame_.data_->add(mem, remain_in_frame);
-          mem += remain_in_frame;
-          j += remain_in_frame;
-        }
-        if (frame_.length_ == frame_.data_->length()) {
-          output.push_back(std::move(frame_));
-          frame_.flags_ = 0;
-          frame_.length_ = 0;
-          state_ = State::FH_FLAG;
-        }
-        break;
+        NOT_REACHED_GCOVR_EXCL_LINE;
       }
     }
   }
-  input.drain(input.length());
   return true;
 }
 
+void Decoder::decodeHeaderByte(uint8_t c, std::vector<Frame>& output) {
+  switch (state_) {
+  case State::FH_FLAG:
+    frame_.flags_ = c;
+    state_ = State::FH_LEN_0;
+    break;
+  case State::FH_LEN_0:
+    frame_.length_ = static_cast<uint32_t>(c) << 24;
+    state_ = State::FH_LEN_1;
+    break;
+  case State::FH_LEN_1:
+    frame_.length_ |= static_cast<uint32_t>(c) << 16;
+    state_ = State::FH_LEN_2;
+    break;
+  case State::FH_LEN_2:
+    frame_.length_ |= static_cast<uint32_t>(c) << 8;
+    state_ = State::FH_LEN_3;
+    break;
+  case State::FH_LEN_3:
+    frame_.length_ |= static_cast<uint32_t>(c);
+    onHeaderComplete(output);
+    break;
+  case State::DATA:
+    NOT_REACHED_GCOVR_EXCL_LINE;
+  }
+}
+
+void Decoder::onHeaderComplete(std::vector<Frame>& output) {
+  if (frame_.length_ == 0) {
+    output.push_back(std::move(frame_));
+    frame_.flags_ = 0;
+    state_ = State::FH_FLAG;
+  } else {
+    frame_.data_ = std::make_unique<Buffer::OwnedImpl>();
+    state_ = State::DATA;
+  }
+}
+
 } // namespace Grpc
 } // namespace Envoy
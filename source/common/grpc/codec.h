@@ -12,6 +12,8 @@ namespace Grpc {
 const uint8_t GRPC_FH_DEFAULT = 0b0u;
 // Last bit for a compressed message.
 const uint8_t GRPC_FH_COMPRESSED = 0b1u;
+// Size of the flags and length prefix of a GRPC data frame.
+const uint64_t GRPC_FRAME_HEADER_SIZE = 5;
 
 enum class CompressionAlgorithm { None, Gzip };
 
@@ -39,7 +41,8 @@ public:
   // Decodes the given buffer with GRPC data frame. Drains the input buffer when
   // decoding succeeded (returns true). If the input is not sufficient to make a
   // complete GRPC data frame, it will be buffered in the decoder. If a decoding
-  // error happened, the input buffer remains unchanged.
+  // error happened, the input buffer remains unchanged. The frame data is moved
+  // out of the input buffer slices, not copied.
   // @param input supplies the binary octets wrapped in a GRPC data frame.
   // @param output supplies the buffer to store the decoded data.
   // @return bool whether the decoding succeeded or not.
@@ -86,6 +89,13 @@ private:
     DATA,
   };
 
+  // @return whether all the frame headers starting in the input have supported flags.
+  bool checkFlags(const Buffer::Instance& input) const;
+  // Advances the header state machine by one byte.
+  void decodeHeaderByte(uint8_t c, std::vector<Frame>& output);
+  // Emits an empty frame, or starts buffering the data of the frame.
+  void onHeaderComplete(std::vector<Frame>& output);
+
   State state_;
   Frame frame_;
 };
@@ -13,8 +13,38 @@
 namespace Envoy {
 namespace Grpc {
 
+GoogleCompletionQueuePool::GoogleCompletionQueuePool(uint32_t num_threads) {
+  ASSERT(num_threads > 0);
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    auto cq_thread = std::make_unique<CompletionQueueThread>();
+    grpc::CompletionQueue& cq = cq_thread->cq_;
+    cq_thread->thread_ = std::make_unique<Thread::Thread>(
+        [&cq] { GoogleAsyncClientThreadLocal::completionThread(cq); });
+    cq_threads_.push_back(std::move(cq_thread));
+  }
+}
+
+GoogleCompletionQueuePool::~GoogleCompletionQueuePool() {
+  // The silos using the queues are gone, and have drained their streams' tags.
+  for (auto& cq_thread : cq_threads_) {
+    cq_thread->cq_.Shutdown();
+  }
+  for (auto& cq_thread : cq_threads_) {
+    cq_thread->thread_->join();
+  }
+}
+
+grpc::CompletionQueue& GoogleCompletionQueuePool::assign() {
+  return cq_threads_[next_++ % cq_threads_.size()]->cq_;
+}
+
 GoogleAsyncClientThreadLocal::GoogleAsyncClientThreadLocal()
-    : completion_thread_(new Thread::Thread([this] { completionThread(); })) {}
+    : own_cq_(std::make_unique<grpc::CompletionQueue>()), cq_(*own_cq_),
+      completion_thread_(new Thread::Thread([this] { completionThread(cq_); })) {}
+
+GoogleAsyncClientThreadLocal::GoogleAsyncClientThreadLocal(
+    GoogleCompletionQueuePoolSharedPtr cq_pool)
+    : cq_pool_(cq_pool), cq_(cq_pool_->assign()) {}
 
 GoogleAsyncClientThreadLocal::~GoogleAsyncClientThreadLocal() {
   // Force streams to shutdown and invoke TryCancel() to start the drain of
@@ -27,43 +57,66 @@ GoogleAsyncClientThreadLocal::~GoogleAsyncClientThreadLocal() {
     // we point to the next one first.
     (*it++)->resetStream();
   }
-  cq_.Shutdown();
-  ENVOY_LOG(debug, "Joining completionThread");
-  completion_thread_->join();
-  ENVOY_LOG(debug, "Joined completionThread");
-  // Ensure that we have cleaned up all orphan streams, now that CQ is gone.
+  if (own_cq_ != nullptr) {
+    own_cq_->Shutdown();
+    ENVOY_LOG(debug, "Joining completionThread");
+    completion_thread_->join();
+    ENVOY_LOG(debug, "Joined completionThread");
+  }
+  // Ensure that we have cleaned up all orphan streams. With our own CQ, it is gone and all their
+  // ops have been queued. With a shared CQ, the cancelled ops are still being delivered.
   while (!streams_.empty()) {
-    (*streams_.begin())->onCompletedOps();
+    {
+      Thread::LockGuard lock(completed_ops_lock_);
+      while (completed_ops_.empty()) {
+        completed_ops_cond_.wait(completed_ops_lock_);
+      }
+    }
+    onCompletedOps();
   }
 }
 
-void GoogleAsyncClientThreadLocal::completionThread() {
+void GoogleAsyncClientThreadLocal::completionThread(grpc::CompletionQueue& cq) {
   ENVOY_LOG(debug, "completionThread running");
   void* tag;
   bool ok;
-  while (cq_.Next(&tag, &ok)) {
+  while (cq.Next(&tag, &ok)) {
     const auto& google_async_tag = *reinterpret_cast<GoogleAsyncTag*>(tag);
     const GoogleAsyncTag::Operation op = google_async_tag.op_;
     GoogleAsyncStreamImpl& stream = google_async_tag.stream_;
     ENVOY_LOG(trace, "completionThread CQ event {} {}", op, ok);
-    Thread::LockGuard lock(stream.completed_ops_lock_);
-
-    // It's an invariant that there must only be one pending post for arbitrary
-    // length completed_ops_, otherwise we can race in stream destruction, where
-    // we process multiple events in onCompletedOps() but have only partially
-    // consumed the posts on the dispatcher.
-    // TODO(htuch): This may result in unbounded processing on the silo thread
-    // in onCompletedOps() in extreme cases, when we emplace_back() in
-    // completionThread() at a high rate, consider bounding the length of such
-    // sequences if this behavior becomes an issue.
-    if (stream.completed_ops_.empty()) {
-      stream.dispatcher_.post([&stream] { stream.onCompletedOps(); });
-    }
-    stream.completed_ops_.emplace_back(op, ok);
+    stream.tls_.queueCompletedOp(stream, op, ok);
   }
   ENVOY_LOG(debug, "completionThread exiting");
 }
 
+void GoogleAsyncClientThreadLocal::queueCompletedOp(GoogleAsyncStreamImpl& stream,
+                                                    GoogleAsyncTag::Operation op, bool ok) {
+  Thread::LockGuard lock(completed_ops_lock_);
+  // Ops completed while a post is pending are handled by that post, so that a burst of completions
+  // costs the silo a single dispatcher wakeup. The post refers to the silo rather than to a stream,
+  // so a stream freed in the meantime is never reached through it: streams are only freed once all
+  // their ops have been handled.
+  if (completed_ops_.empty()) {
+    stream.dispatcher_.post([this] { onCompletedOps(); });
+  }
+  completed_ops_.push_back({&stream, op, ok});
+  completed_ops_cond_.notifyOne();
+}
+
+void GoogleAsyncClientThreadLocal::onCompletedOps() {
+  // Take the batch so that the completion thread is not blocked while it is handled, and so that
+  // the ops completed meanwhile are left to the next post rather than extending this one.
+  std::deque<CompletedOp> completed_ops;
+  {
+    Thread::LockGuard lock(completed_ops_lock_);
+    completed_ops.swap(completed_ops_);
+  }
+  for (const CompletedOp& completed_op : completed_ops) {
+    completed_op.stream_->handleOpCompletion(completed_op.op_, completed_op.ok_);
+  }
+}
+
 GoogleAsyncClientImpl::GoogleAsyncClientImpl(Event::Dispatcher& dispatcher,
                                              GoogleAsyncClientThreadLocal& tls,
                                              GoogleStubFactory& stub_factory,
@@ -227,17 +280,6 @@ void GoogleAsyncStreamImpl::writeQueued() {
   ENVOY_LOG(trace, "Write op dispatched");
 }
 
-void GoogleAsyncStreamImpl::onCompletedOps() {
-  Thread::LockGuard lock(completed_ops_lock_);
-  while (!completed_ops_.empty()) {
-    GoogleAsyncTag::Operation op;
-    bool ok;
-    std::tie(op, ok) = completed_ops_.front();
-    completed_ops_.pop_front();
-    handleOpCompletion(op, ok);
-  }
-}
-
 void GoogleAsyncStreamImpl::handleOpCompletion(GoogleAsyncTag::Operation op, bool ok) {
   ENVOY_LOG(trace, "handleOpCompletion op={} ok={} inflight={}", op, ok, inflight_tags_);
   ASSERT(inflight_tags_ > 0);
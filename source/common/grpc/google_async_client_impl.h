@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <deque>
 #include <queue>
 
 #include "envoy/grpc/async_client.h"
@@ -59,10 +61,35 @@ struct GoogleAsyncTag {
   }
 };
 
+// Completion queues, each drained by a thread of its own, which are shared by the
+// GoogleAsyncClientThreadLocal of every silo instead of each silo running a completion thread.
+class GoogleCompletionQueuePool : Logger::Loggable<Logger::Id::grpc> {
+public:
+  explicit GoogleCompletionQueuePool(uint32_t num_threads);
+  ~GoogleCompletionQueuePool();
+
+  // @return the completion queue for a new silo. Queues are handed out round robin.
+  grpc::CompletionQueue& assign();
+
+private:
+  struct CompletionQueueThread {
+    grpc::CompletionQueue cq_;
+    Thread::ThreadPtr thread_;
+  };
+
+  std::vector<std::unique_ptr<CompletionQueueThread>> cq_threads_;
+  std::atomic<uint32_t> next_{};
+};
+
+typedef std::shared_ptr<GoogleCompletionQueuePool> GoogleCompletionQueuePoolSharedPtr;
+
 class GoogleAsyncClientThreadLocal : public ThreadLocal::ThreadLocalObject,
                                      Logger::Loggable<Logger::Id::grpc> {
 public:
+  // Runs a completion thread for this silo.
   GoogleAsyncClientThreadLocal();
+  // Uses a completion queue of a pool shared with other silos.
+  explicit GoogleAsyncClientThreadLocal(GoogleCompletionQueuePoolSharedPtr cq_pool);
   ~GoogleAsyncClientThreadLocal();
 
   grpc::CompletionQueue& completionQueue() { return cq_; }
@@ -78,12 +105,30 @@ public:
     streams_.erase(it);
   }
 
+  // Hands the events of a completion queue to the silos of their streams, until the queue is shut
+  // down and drained.
+  static void completionThread(grpc::CompletionQueue& cq);
+
 private:
-  void completionThread();
+  struct CompletedOp {
+    GoogleAsyncStreamImpl* stream_;
+    GoogleAsyncTag::Operation op_;
+    bool ok_;
+  };
+
+  // Queue a completed operation of one of our streams for the silo thread. Called from a
+  // completion thread.
+  void queueCompletedOp(GoogleAsyncStreamImpl& stream, GoogleAsyncTag::Operation op, bool ok);
+  // Handle the queued completed operations on the silo thread.
+  void onCompletedOps();
 
-  // The CompletionQueue for in-flight operations. This must precede completion_thread_ to ensure it
-  // is constructed before the thread runs.
-  grpc::CompletionQueue cq_;
+  // Set when this silo runs its own completion thread. This must precede cq_ and
+  // completion_thread_ to ensure it is constructed before the thread runs.
+  std::unique_ptr<grpc::CompletionQueue> own_cq_;
+  // Keeps the shared completion queues and their threads alive until all the silos are gone.
+  GoogleCompletionQueuePoolSharedPtr cq_pool_;
+  // The CompletionQueue for in-flight operations.
+  grpc::CompletionQueue& cq_;
   // The threading model for the Google gRPC C++ library is not directly compatible with Envoy's
   // siloed model. We resolve this by issuing non-blocking asynchronous
   // operations on the GoogleAsyncClientImpl silo thread, and then synchronously
@@ -91,12 +136,20 @@ private:
   // are delivered, we cross-post to the silo dispatcher to continue the
   // operation.
   //
-  // We have an independent completion thread for each TLS silo (i.e. one per worker and
-  // also one for the main thread).
+  // By default we have an independent completion thread for each TLS silo (i.e. one per worker
+  // and also one for the main thread). With a GoogleCompletionQueuePool, the pool's threads serve
+  // all the silos instead and this is not set.
   Thread::ThreadPtr completion_thread_;
   // Track all streams that are currently using this CQ, so we can notify them
   // on shutdown.
   std::unordered_set<GoogleAsyncStreamImpl*> streams_;
+  // Completed operations of all our streams, passed from the completion thread to the silo thread
+  // in batches: only the first operation queued after a batch is taken posts to the dispatcher.
+  std::deque<CompletedOp> completed_ops_ GUARDED_BY(completed_ops_lock_);
+  Thread::MutexBasicLockable completed_ops_lock_;
+  // Signalled when an operation is queued, for the destructor to wait for the operations of the
+  // streams being reset.
+  Thread::CondVar completed_ops_cond_;
 };
 
 // Google gRPC client stats. TODO(htuch): consider how a wider set of stats collected by the
@@ -210,9 +263,6 @@ protected:
   bool call_failed() const { return call_failed_; }
 
 private:
-  // Process queued events in completed_ops_ with handleOpCompletion() on
-  // GoogleAsyncClient silo thread.
-  void onCompletedOps();
   // Handle Operation completion on GoogleAsyncClient silo thread. This is posted by
   // GoogleAsyncClientThreadLocal::completionThread() when a message is received on cq_.
   void handleOpCompletion(GoogleAsyncTag::Operation op, bool ok);
@@ -263,7 +313,8 @@ private:
   // Latch our own version of this reference, so that completionThread() doesn't
   // try and access via parent_, which might not exist in teardown. We assume
   // that the dispatcher lives longer than completionThread() life, which should
-  // hold for the expected server object lifetimes.
+  // hold for the expected server object lifetimes. All the streams of a silo share its
+  // dispatcher.
   Event::Dispatcher& dispatcher_;
   // We hold a ref count on the stub_ to allow the stream to wait for its tags
   // to drain from the CQ on cleanup.
@@ -290,11 +341,6 @@ private:
   // Count of the tags in-flight. This must hit zero before the stream can be
   // freed.
   uint32_t inflight_tags_{};
-  // Queue of completed (op, ok) passed from completionThread() to
-  // handleOpCompletion().
-  std::deque<std::pair<GoogleAsyncTag::Operation, bool>>
-      completed_ops_ GUARDED_BY(completed_ops_lock_);
-  Thread::MutexBasicLockable completed_ops_lock_;
 
   friend class GoogleAsyncClientImpl;
   friend class GoogleAsyncClientThreadLocal;
@@ -13,7 +13,7 @@ namespace Envoy {
 namespace Http {
 
 const std::list<std::string> AsyncStreamImpl::NullCorsPolicy::allow_origin_;
-const std::list<std::regex> AsyncStreamImpl::NullCorsPolicy::allow_origin_regex_;
+const std::list<Regex::CompiledMatcherPtr> AsyncStreamImpl::NullCorsPolicy::allow_origin_regex_;
 const absl::optional<bool> AsyncStreamImpl::NullCorsPolicy::allow_credentials_;
 const std::vector<std::reference_wrapper<const Router::RateLimitPolicyEntry>>
     AsyncStreamImpl::NullRateLimitPolicy::rate_limit_policy_entry_;
@@ -49,8 +49,16 @@ AsyncClientImpl::~AsyncClientImpl() {
 AsyncClient::Request*
 AsyncClientImpl::send(MessagePtr&& request, AsyncClient::Callbacks& callbacks,
                       const absl::optional<std::chrono::milliseconds>& timeout) {
+  RequestOptions options;
+  options.timeout = timeout;
+  return send(std::move(request), callbacks, options);
+}
+
+AsyncClient::Request* AsyncClientImpl::send(MessagePtr&& request,
+                                            AsyncClient::Callbacks& callbacks,
+                                            const RequestOptions& options) {
   AsyncRequestImpl* async_request =
-      new AsyncRequestImpl(std::move(request), *this, callbacks, timeout);
+      new AsyncRequestImpl(std::move(request), *this, callbacks, options);
   async_request->initialize();
   std::unique_ptr<AsyncStreamImpl> new_request{async_request};
 
@@ -179,11 +187,12 @@ void AsyncStreamImpl::resetStream() {
 
 AsyncRequestImpl::AsyncRequestImpl(MessagePtr&& request, AsyncClientImpl& parent,
                                    AsyncClient::Callbacks& callbacks,
-                                   const absl::optional<std::chrono::milliseconds>& timeout)
+                                   const AsyncClient::RequestOptions& options)
     // We tell the underlying stream to not buffer because we already have the full request and
     // and can handle any buffered body requests.
-    : AsyncStreamImpl(parent, *this, timeout, false), request_(std::move(request)),
-      callbacks_(callbacks) {}
+    : AsyncStreamImpl(parent, *this, options.timeout, false), request_(std::move(request)),
+      callbacks_(callbacks), max_response_body_bytes_(options.max_response_body_bytes),
+      discard_response_body_(options.discard_response_body) {}
 
 void AsyncRequestImpl::initialize() {
   sendHeaders(request_->headers(), !request_->body());
@@ -204,10 +213,23 @@ void AsyncRequestImpl::onHeaders(HeaderMapPtr&& headers, bool end_stream) {
 }
 
 void AsyncRequestImpl::onData(Buffer::Instance& data, bool end_stream) {
-  if (!response_->body()) {
-    response_->body().reset(new Buffer::OwnedImpl());
+  if (discard_response_body_) {
+    data.drain(data.length());
+  } else {
+    if (!response_->body()) {
+      response_->body().reset(new Buffer::OwnedImpl());
+    }
+    if (max_response_body_bytes_ &&
+        response_->body()->length() + data.length() > max_response_body_bytes_.value()) {
+      ENVOY_LOG(debug, "async http request response body exceeds {} bytes",
+                max_response_body_bytes_.value());
+      // Reset the stream without the Reset failure, and report the actual reason instead.
+      cancel();
+      callbacks_.onFailure(AsyncClient::FailureReason::ResponseBodyTooLarge);
+      return;
+    }
+    response_->body()->move(data);
   }
-  response_->body()->move(data);
 
   if (end_stream) {
     onComplete();
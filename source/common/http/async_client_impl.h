@@ -44,6 +44,7 @@ public:
   // Http::AsyncClient
   Request* send(MessagePtr&& request, Callbacks& callbacks,
                 const absl::optional<std::chrono::milliseconds>& timeout) override;
+  Request* send(MessagePtr&& request, Callbacks& callbacks, const RequestOptions& options) override;
 
   Stream* start(StreamCallbacks& callbacks,
                 const absl::optional<std::chrono::milliseconds>& timeout,
@@ -90,7 +91,7 @@ private:
   struct NullCorsPolicy : public Router::CorsPolicy {
     // Router::CorsPolicy
     const std::list<std::string>& allowOrigins() const override { return allow_origin_; };
-    const std::list<std::regex>& allowOriginRegexes() const override {
+    const std::list<Regex::CompiledMatcherPtr>& allowOriginRegexes() const override {
       return allow_origin_regex_;
     };
     const std::string& allowMethods() const override { return EMPTY_STRING; };
@@ -101,7 +102,7 @@ private:
     bool enabled() const override { return false; };
 
     static const std::list<std::string> allow_origin_;
-    static const std::list<std::regex> allow_origin_regex_;
+    static const std::list<Regex::CompiledMatcherPtr> allow_origin_regex_;
     static const absl::optional<bool> allow_credentials_;
   };
 
@@ -199,6 +200,8 @@ private:
       }
     }
     absl::optional<std::chrono::milliseconds> idleTimeout() const override { return absl::nullopt; }
+    absl::optional<std::chrono::milliseconds> hedgeDelay() const override { return absl::nullopt; }
+    absl::optional<uint32_t> retryShadowBufferLimit() const override { return absl::nullopt; }
     absl::optional<std::chrono::milliseconds> maxGrpcTimeout() const override {
       return absl::nullopt;
     }
@@ -320,7 +323,7 @@ class AsyncRequestImpl final : public AsyncClient::Request,
                                AsyncClient::StreamCallbacks {
 public:
   AsyncRequestImpl(MessagePtr&& request, AsyncClientImpl& parent, AsyncClient::Callbacks& callbacks,
-                   const absl::optional<std::chrono::milliseconds>& timeout);
+                   const AsyncClient::RequestOptions& options);
 
   // AsyncClient::Request
   virtual void cancel() override;
@@ -341,6 +344,8 @@ private:
   MessagePtr request_;
   AsyncClient::Callbacks& callbacks_;
   std::unique_ptr<MessageImpl> response_;
+  const absl::optional<uint64_t> max_response_body_bytes_;
+  const bool discard_response_body_;
   bool cancelled_{};
 
   friend class AsyncClientImpl;
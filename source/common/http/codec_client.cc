@@ -7,6 +7,7 @@
 #include "common/http/http1/codec_impl.h"
 #include "common/http/http2/codec_impl.h"
 #include "common/http/utility.h"
+#include "common/stats/stage_timer.h"
 
 namespace Envoy {
 namespace Http {
@@ -112,6 +113,7 @@ void CodecClient::onReset(ActiveRequest& request, StreamResetReason reason) {
 void CodecClient::onData(Buffer::Instance& data) {
   bool protocol_error = false;
   try {
+    Stats::StageTimer timer(Stats::Stage::HttpCodecDispatch);
     codec_->dispatch(data);
   } catch (CodecProtocolException& e) {
     ENVOY_CONN_LOG(info, "protocol error: {}", *connection_, e.what());
@@ -35,6 +35,8 @@ namespace Http {
   GAUGE    (downstream_cx_rx_bytes_buffered)                                                       \
   COUNTER  (downstream_cx_tx_bytes_total)                                                          \
   GAUGE    (downstream_cx_tx_bytes_buffered)                                                       \
+  COUNTER  (downstream_cx_read_budget_exhausted)                                                   \
+  COUNTER  (downstream_cx_tx_buffer_above_high_watermark_ms)                                       \
   COUNTER  (downstream_cx_drain_close)                                                             \
   COUNTER  (downstream_cx_idle_timeout)                                                            \
   COUNTER  (downstream_flow_control_paused_reading_total)                                          \
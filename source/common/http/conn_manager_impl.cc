@@ -30,10 +30,26 @@
 #include "common/http/http2/codec_impl.h"
 #include "common/http/utility.h"
 #include "common/network/utility.h"
+#include "common/runtime/key_registry.h"
+#include "common/stats/stage_timer.h"
 
 namespace Envoy {
 namespace Http {
 
+namespace {
+
+const Runtime::Key RuntimeStreamArenaEnabled =
+    Runtime::KeyRegistry::intern("http_connection_manager.stream_arena_enabled");
+
+// Sizes of the arenas used by recent streams on this thread, which determine the initial block
+// size of the next stream's arena.
+ArenaSizeHistogram& streamArenaSizes() {
+  static thread_local ArenaSizeHistogram histogram;
+  return histogram;
+}
+
+} // namespace
+
 ConnectionManagerStats ConnectionManagerImpl::generateStats(const std::string& prefix,
                                                             Stats::Scope& scope) {
   return {
@@ -68,7 +84,11 @@ ConnectionManagerImpl::ConnectionManagerImpl(ConnectionManagerConfig& config,
       overload_stop_accepting_requests_(
           overload_manager ? overload_manager->getThreadLocalOverloadState().getState(
                                  Server::OverloadActionNames::get().StopAcceptingRequests)
-                           : Server::OverloadManager::getInactiveState()) {}
+                           : Server::OverloadManager::getInactiveState()),
+      overload_reduce_timeouts_(
+          overload_manager ? overload_manager->getThreadLocalOverloadState().getScaledValue(
+                                 Server::OverloadActionNames::get().ReduceTimeouts)
+                           : Server::OverloadManager::getInactiveScaledValue()) {}
 
 const HeaderMapImpl& ConnectionManagerImpl::continueHeader() {
   CONSTRUCT_ON_FIRST_USE(HeaderMapImpl,
@@ -89,13 +109,14 @@ void ConnectionManagerImpl::initializeReadFilterCallbacks(Network::ReadFilterCal
   if (config_.idleTimeout()) {
     idle_timer_ = read_callbacks_->connection().dispatcher().createTimer(
         [this]() -> void { onIdleTimeout(); });
-    idle_timer_->enableTimer(config_.idleTimeout().value());
+    idle_timer_->enableTimer(idleTimeout());
   }
 
   read_callbacks_->connection().setConnectionStats(
       {stats_.named_.downstream_cx_rx_bytes_total_, stats_.named_.downstream_cx_rx_bytes_buffered_,
        stats_.named_.downstream_cx_tx_bytes_total_, stats_.named_.downstream_cx_tx_bytes_buffered_,
-       nullptr});
+       nullptr, &stats_.named_.downstream_cx_read_budget_exhausted_,
+       &stats_.named_.downstream_cx_tx_buffer_above_high_watermark_ms_, nullptr, nullptr});
 }
 
 ConnectionManagerImpl::~ConnectionManagerImpl() {
@@ -163,16 +184,31 @@ void ConnectionManagerImpl::doEndStream(ActiveStream& stream) {
   }
 
   if (idle_timer_ && streams_.empty()) {
-    idle_timer_->enableTimer(config_.idleTimeout().value());
+    idle_timer_->enableTimer(idleTimeout());
   }
 }
 
+std::chrono::milliseconds ConnectionManagerImpl::idleTimeout() const {
+  const std::chrono::milliseconds timeout = config_.idleTimeout().value();
+  if (overload_reduce_timeouts_ == 0) {
+    return timeout;
+  }
+
+  // Close idle connections sooner in proportion to the memory they would otherwise hold on to,
+  // without closing them before a client has a chance to send its first request.
+  const std::chrono::milliseconds minimum(1000);
+  const std::chrono::milliseconds reduced(static_cast<std::chrono::milliseconds::rep>(
+      timeout.count() * (1 - overload_reduce_timeouts_)));
+  return std::min(timeout, std::max(reduced, minimum));
+}
+
 void ConnectionManagerImpl::doDeferredStreamDestroy(ActiveStream& stream) {
   if (stream.idle_timer_ != nullptr) {
     stream.idle_timer_->disableTimer();
     stream.idle_timer_ = nullptr;
   }
   stream.state_.destroyed_ = true;
+  stream.memory_account_.close();
   for (auto& filter : stream.decoder_filters_) {
     filter->handle_->onDestroy();
   }
@@ -231,6 +267,7 @@ Network::FilterStatus ConnectionManagerImpl::onData(Buffer::Instance& data, bool
     redispatch = false;
 
     try {
+      Stats::StageTimer timer(Stats::Stage::HttpCodecDispatch);
       codec_->dispatch(data);
     } catch (const CodecProtocolException& e) {
       // HTTP/1.1 codec has already sent a 400 response if possible. HTTP/2 codec has already sent
@@ -359,9 +396,18 @@ void ConnectionManagerImpl::chargeTracingStats(const Tracing::Reason& tracing_re
 ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connection_manager)
     : connection_manager_(connection_manager),
       snapped_route_config_(connection_manager.config_.routeConfigProvider().config()),
-      stream_id_(connection_manager.random_generator_.random()),
+      stream_id_(connection_manager.random_generator_.random()), memory_account_(*this),
+      arena_(streamArenaSizes().recommendedBlockSize()),
+      arena_enabled_(
+          connection_manager.runtime_.snapshot().featureEnabled(RuntimeStreamArenaEnabled, 0)),
+      decoder_filters_(ArenaAllocator<ActiveStreamDecoderFilterPtr>(streamArena())),
+      encoder_filters_(ArenaAllocator<ActiveStreamEncoderFilterPtr>(streamArena())),
+      access_log_handlers_(ArenaAllocator<AccessLog::InstanceSharedPtr>(streamArena())),
       request_timer_(new Stats::Timespan(connection_manager_.stats_.named_.downstream_rq_time_)),
-      request_info_(connection_manager_.codec_->protocol()) {
+      request_info_(connection_manager_.codec_->protocol(),
+                    connection_manager_.read_callbacks_->connection()
+                        .dispatcher()
+                        .approximateTimeSource()) {
   connection_manager_.stats_.named_.downstream_rq_total_.inc();
   connection_manager_.stats_.named_.downstream_rq_active_.inc();
   if (connection_manager_.codec_->protocol() == Protocol::Http2) {
@@ -380,7 +426,7 @@ ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connect
 
   if (connection_manager_.config_.streamIdleTimeout().count()) {
     idle_timeout_ms_ = connection_manager_.config_.streamIdleTimeout();
-    idle_timer_ = connection_manager_.read_callbacks_->connection().dispatcher().createTimer(
+    idle_timer_ = connection_manager_.read_callbacks_->connection().dispatcher().createCoarseTimer(
         [this]() -> void { onIdleTimeout(); });
     resetIdleTimer();
   }
@@ -388,6 +434,20 @@ ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connect
       connection_manager_.read_callbacks_->connection().requestedServerName());
 }
 
+ConnectionManagerImpl::ActiveStream::MemoryAccountImpl::MemoryAccountImpl(ActiveStream& stream)
+    : MemoryAccount(stream.connection_manager_.read_callbacks_->connection().dispatcher()),
+      stream_(stream), stream_id_(stream.stream_id_),
+      connection_id_(stream.connection_manager_.read_callbacks_->connection().id()) {}
+
+std::string ConnectionManagerImpl::ActiveStream::MemoryAccountImpl::describe() const {
+  return fmt::format("stream {} on connection {}", stream_id_, connection_id_);
+}
+
+void ConnectionManagerImpl::ActiveStream::MemoryAccountImpl::resetOwner() {
+  ENVOY_STREAM_LOG(debug, "resetting stream holding {} bytes", stream_, balance());
+  stream_.connection_manager_.doEndStream(stream_);
+}
+
 ConnectionManagerImpl::ActiveStream::~ActiveStream() {
   request_info_.onRequestComplete();
 
@@ -411,6 +471,10 @@ ConnectionManagerImpl::ActiveStream::~ActiveStream() {
   }
 
   ASSERT(state_.filter_call_state_ == 0);
+
+  if (arena_enabled_) {
+    streamArenaSizes().record(arena_.bytesAllocated());
+  }
 }
 
 void ConnectionManagerImpl::ActiveStream::resetIdleTimer() {
@@ -438,16 +502,18 @@ void ConnectionManagerImpl::ActiveStream::onIdleTimeout() {
 
 void ConnectionManagerImpl::ActiveStream::addStreamDecoderFilterWorker(
     StreamDecoderFilterSharedPtr filter, bool dual_filter) {
-  ActiveStreamDecoderFilterPtr wrapper(new ActiveStreamDecoderFilter(*this, filter, dual_filter));
+  ActiveStreamDecoderFilterPtr wrapper(
+      makeArenaPtr<ActiveStreamDecoderFilter>(streamArena(), *this, filter, dual_filter));
   filter->setDecoderFilterCallbacks(*wrapper);
-  wrapper->moveIntoListBack(std::move(wrapper), decoder_filters_);
+  decoder_filters_.emplace_back(std::move(wrapper));
 }
 
 void ConnectionManagerImpl::ActiveStream::addStreamEncoderFilterWorker(
     StreamEncoderFilterSharedPtr filter, bool dual_filter) {
-  ActiveStreamEncoderFilterPtr wrapper(new ActiveStreamEncoderFilter(*this, filter, dual_filter));
+  ActiveStreamEncoderFilterPtr wrapper(
+      makeArenaPtr<ActiveStreamEncoderFilter>(streamArena(), *this, filter, dual_filter));
   filter->setEncoderFilterCallbacks(*wrapper);
-  wrapper->moveIntoListBack(std::move(wrapper), encoder_filters_);
+  encoder_filters_.emplace_back(std::move(wrapper));
 }
 
 void ConnectionManagerImpl::ActiveStream::addAccessLogHandler(
@@ -595,10 +661,15 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(HeaderMapPtr&& headers,
   }
 
   // Modify the downstream remote address depending on configuration and headers.
+  Network::Connection& connection = connection_manager_.read_callbacks_->connection();
+  if (connection_manager_.request_mutation_policy_ == nullptr) {
+    connection_manager_.request_mutation_policy_ = std::make_unique<const RequestMutationPolicy>(
+        connection_manager_.config_, connection, connection_manager_.local_info_);
+  }
   request_info_.setDownstreamRemoteAddress(ConnectionManagerUtility::mutateRequestHeaders(
-      *request_headers_, connection_manager_.read_callbacks_->connection(),
-      connection_manager_.config_, *snapped_route_config_, connection_manager_.random_generator_,
-      connection_manager_.runtime_, connection_manager_.local_info_));
+      *request_headers_, connection, connection_manager_.config_,
+      *connection_manager_.request_mutation_policy_, *snapped_route_config_,
+      connection_manager_.random_generator_, connection_manager_.runtime_));
   ASSERT(request_info_.downstreamRemoteAddress() != nullptr);
 
   ASSERT(!cached_route_);
@@ -620,6 +691,12 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(HeaderMapPtr&& headers,
           *request_headers_, request_info_, *this, connection_manager_.cluster_manager_,
           connection_manager_.read_callbacks_);
       ASSERT(connection_manager_.ws_connection_ != nullptr);
+      // The data of the upgraded connection bypasses the stream, so its idle timer would fire
+      // regardless of traffic. The WebSocket idle_timeout governs the connection instead.
+      if (idle_timer_ != nullptr) {
+        idle_timer_->disableTimer();
+        idle_timer_ = nullptr;
+      }
       connection_manager_.stats_.named_.downstream_cx_websocket_active_.inc();
       connection_manager_.stats_.named_.downstream_cx_http1_active_.dec();
       connection_manager_.stats_.named_.downstream_cx_websocket_total_.inc();
@@ -636,13 +713,18 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(HeaderMapPtr&& headers,
 
   if (cached_route_.value()) {
     const Router::RouteEntry* route_entry = cached_route_.value()->routeEntry();
+    if (route_entry != nullptr) {
+      response_encoder_->getStream().setPriorityWeight(
+          Utility::priorityWeight(route_entry->priority()));
+    }
     if (route_entry != nullptr && route_entry->idleTimeout()) {
       idle_timeout_ms_ = route_entry->idleTimeout().value();
       if (idle_timeout_ms_.count()) {
         // If we have a route-level idle timeout but no global stream idle timeout, create a timer.
         if (idle_timer_ == nullptr) {
-          idle_timer_ = connection_manager_.read_callbacks_->connection().dispatcher().createTimer(
-              [this]() -> void { onIdleTimeout(); });
+          idle_timer_ =
+              connection_manager_.read_callbacks_->connection().dispatcher().createCoarseTimer(
+                  [this]() -> void { onIdleTimeout(); });
         }
       } else if (idle_timer_ != nullptr) {
         // If we had a global stream idle timeout but the route-level idle timeout is set to zero
@@ -721,8 +803,9 @@ void ConnectionManagerImpl::ActiveStream::traceRequest() {
 
 void ConnectionManagerImpl::ActiveStream::decodeHeaders(ActiveStreamDecoderFilter* filter,
                                                         HeaderMap& headers, bool end_stream) {
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry;
-  std::list<ActiveStreamDecoderFilterPtr>::iterator continue_data_entry = decoder_filters_.end();
+  Stats::StageTimer timer(Stats::Stage::HttpDecoderFilters);
+  ActiveStreamDecoderFilterList::iterator entry;
+  ActiveStreamDecoderFilterList::iterator continue_data_entry = decoder_filters_.end();
   if (!filter) {
     entry = decoder_filters_.begin();
   } else {
@@ -779,6 +862,7 @@ void ConnectionManagerImpl::ActiveStream::decodeData(Buffer::Instance& data, boo
 
 void ConnectionManagerImpl::ActiveStream::decodeData(ActiveStreamDecoderFilter* filter,
                                                      Buffer::Instance& data, bool end_stream) {
+  Stats::StageTimer timer(Stats::Stage::HttpDecoderFilters);
   resetIdleTimer();
 
   // If a response is complete or a reset has been sent, filters do not care about further body
@@ -787,7 +871,7 @@ void ConnectionManagerImpl::ActiveStream::decodeData(ActiveStreamDecoderFilter*
     return;
   }
 
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry;
+  ActiveStreamDecoderFilterList::iterator entry;
   auto trailers_added_entry = decoder_filters_.end();
   const bool trailers_exists_at_start = request_trailers_ != nullptr;
   if (!filter) {
@@ -876,12 +960,13 @@ void ConnectionManagerImpl::ActiveStream::decodeTrailers(HeaderMapPtr&& trailers
 
 void ConnectionManagerImpl::ActiveStream::decodeTrailers(ActiveStreamDecoderFilter* filter,
                                                          HeaderMap& trailers) {
+  Stats::StageTimer timer(Stats::Stage::HttpDecoderFilters);
   // See decodeData() above for why we check local_complete_ here.
   if (state_.local_complete_) {
     return;
   }
 
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry;
+  ActiveStreamDecoderFilterList::iterator entry;
   if (!filter) {
     entry = decoder_filters_.begin();
   } else {
@@ -910,7 +995,7 @@ void ConnectionManagerImpl::ActiveStream::maybeEndDecode(bool end_stream) {
   }
 }
 
-std::list<ConnectionManagerImpl::ActiveStreamEncoderFilterPtr>::iterator
+ConnectionManagerImpl::ActiveStreamEncoderFilterList::iterator
 ConnectionManagerImpl::ActiveStream::commonEncodePrefix(ActiveStreamEncoderFilter* filter,
                                                         bool end_stream) {
   // Only do base state setting on the initial call. Subsequent calls for filtering do not touch
@@ -974,7 +1059,7 @@ void ConnectionManagerImpl::ActiveStream::encode100ContinueHeaders(
   // filter. This is simpler than that case because 100 continue implies no
   // end-stream, and because there are normal headers coming there's no need for
   // complex continuation logic.
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry = commonEncodePrefix(filter, false);
+  ActiveStreamEncoderFilterList::iterator entry = commonEncodePrefix(filter, false);
   for (; entry != encoder_filters_.end(); entry++) {
     ASSERT(!(state_.filter_call_state_ & FilterCallState::Encode100ContinueHeaders));
     state_.filter_call_state_ |= FilterCallState::Encode100ContinueHeaders;
@@ -1002,10 +1087,11 @@ void ConnectionManagerImpl::ActiveStream::encode100ContinueHeaders(
 
 void ConnectionManagerImpl::ActiveStream::encodeHeaders(ActiveStreamEncoderFilter* filter,
                                                         HeaderMap& headers, bool end_stream) {
+  Stats::StageTimer timer(Stats::Stage::HttpEncoderFilters);
   resetIdleTimer();
 
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry = commonEncodePrefix(filter, end_stream);
-  std::list<ActiveStreamEncoderFilterPtr>::iterator continue_data_entry = encoder_filters_.end();
+  ActiveStreamEncoderFilterList::iterator entry = commonEncodePrefix(filter, end_stream);
+  ActiveStreamEncoderFilterList::iterator continue_data_entry = encoder_filters_.end();
 
   for (; entry != encoder_filters_.end(); entry++) {
     ASSERT(!(state_.filter_call_state_ & FilterCallState::EncodeHeaders));
@@ -1026,8 +1112,10 @@ void ConnectionManagerImpl::ActiveStream::encodeHeaders(ActiveStreamEncoderFilte
     }
   }
 
-  // Base headers.
-  connection_manager_.config_.dateProvider().setDateHeader(headers);
+  // Base headers. The Date references the worker's response header block, which the stream holds
+  // for as long as its response headers, rather than being copied into them.
+  response_header_block_ = connection_manager_.config_.dateProvider().responseHeaderBlock();
+  DateProvider::referenceDateHeader(headers, *response_header_block_);
   // Following setReference() is safe because serverName() is constant for the life of the listener.
   headers.insertServer().value().setReference(connection_manager_.config_.serverName());
   ConnectionManagerUtility::mutateResponseHeaders(headers, request_headers_.get(),
@@ -1152,8 +1240,9 @@ void ConnectionManagerImpl::ActiveStream::addEncodedData(ActiveStreamEncoderFilt
 
 void ConnectionManagerImpl::ActiveStream::encodeData(ActiveStreamEncoderFilter* filter,
                                                      Buffer::Instance& data, bool end_stream) {
+  Stats::StageTimer timer(Stats::Stage::HttpEncoderFilters);
   resetIdleTimer();
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry = commonEncodePrefix(filter, end_stream);
+  ActiveStreamEncoderFilterList::iterator entry = commonEncodePrefix(filter, end_stream);
   auto trailers_added_entry = encoder_filters_.end();
 
   const bool trailers_exists_at_start = response_trailers_ != nullptr;
@@ -1204,8 +1293,9 @@ void ConnectionManagerImpl::ActiveStream::encodeData(ActiveStreamEncoderFilter*
 
 void ConnectionManagerImpl::ActiveStream::encodeTrailers(ActiveStreamEncoderFilter* filter,
                                                          HeaderMap& trailers) {
+  Stats::StageTimer timer(Stats::Stage::HttpEncoderFilters);
   resetIdleTimer();
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry = commonEncodePrefix(filter, true);
+  ActiveStreamEncoderFilterList::iterator entry = commonEncodePrefix(filter, true);
   for (; entry != encoder_filters_.end(); entry++) {
     ASSERT(!(state_.filter_call_state_ & FilterCallState::EncodeTrailers));
     state_.filter_call_state_ |= FilterCallState::EncodeTrailers;
@@ -1287,11 +1377,15 @@ void ConnectionManagerImpl::ActiveStream::setBufferLimit(uint32_t new_limit) {
 }
 
 bool ConnectionManagerImpl::ActiveStream::createFilterChain() {
+  decoder_filters_.reserve(connection_manager_.decoder_filter_chain_size_);
+  encoder_filters_.reserve(connection_manager_.encoder_filter_chain_size_);
   bool upgrade_rejected = false;
   auto upgrade = request_headers_->Upgrade();
   if (upgrade != nullptr) {
     if (connection_manager_.config_.filterFactory().createUpgradeFilterChain(
             upgrade->value().c_str(), *this)) {
+      // Upgrade chains are not the connection's usual chain, so they don't size the next stream's
+      // filter lists.
       return true;
     } else {
       upgrade_rejected = true;
@@ -1301,6 +1395,8 @@ bool ConnectionManagerImpl::ActiveStream::createFilterChain() {
   }
 
   connection_manager_.config_.filterFactory().createFilterChain(*this);
+  connection_manager_.decoder_filter_chain_size_ = decoder_filters_.size();
+  connection_manager_.encoder_filter_chain_size_ = encoder_filters_.size();
   return !upgrade_rejected;
 }
 
@@ -1476,6 +1572,7 @@ Buffer::WatermarkBufferPtr ConnectionManagerImpl::ActiveStreamDecoderFilter::cre
       new Buffer::WatermarkBuffer([this]() -> void { this->requestDataDrained(); },
                                   [this]() -> void { this->requestDataTooLarge(); })};
   buffer->setWatermarks(parent_.buffer_limit_);
+  buffer->setAccount(&parent_.memory_account_);
   return buffer;
 }
 
@@ -1568,6 +1665,7 @@ Buffer::WatermarkBufferPtr ConnectionManagerImpl::ActiveStreamEncoderFilter::cre
   auto buffer = new Buffer::WatermarkBuffer([this]() -> void { this->responseDataDrained(); },
                                             [this]() -> void { this->responseDataTooLarge(); });
   buffer->setWatermarks(parent_.buffer_limit_);
+  buffer->setAccount(&parent_.memory_account_);
   return Buffer::WatermarkBufferPtr{buffer};
 }
 
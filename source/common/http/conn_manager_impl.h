@@ -25,7 +25,9 @@
 #include "envoy/tracing/http_tracer.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/buffer/memory_account.h"
 #include "common/buffer/watermark_buffer.h"
+#include "common/common/arena.h"
 #include "common/common/linked_object.h"
 #include "common/grpc/common.h"
 #include "common/http/conn_manager_config.h"
@@ -37,6 +39,8 @@
 namespace Envoy {
 namespace Http {
 
+struct RequestMutationPolicy;
+
 /**
  * Implementation of both ConnectionManager and ServerConnectionCallbacks. This is a
  * Network::Filter that can be installed on a connection that will perform HTTP protocol agnostic
@@ -86,6 +90,21 @@ public:
 
 private:
   struct ActiveStream;
+  struct ActiveStreamDecoderFilter;
+  struct ActiveStreamEncoderFilter;
+
+  // Filter wrappers and the lists that hold them are allocated from the stream's arena when it is
+  // enabled (see ActiveStream::arena_). The lists are vectors, reserved up front from the size of
+  // the connection's previous filter chain, so that walking the chain scans contiguous memory.
+  // Filters are only added while the chain is created, so iterators stay valid afterwards.
+  typedef ArenaPtr<ActiveStreamDecoderFilter> ActiveStreamDecoderFilterPtr;
+  typedef std::vector<ActiveStreamDecoderFilterPtr, ArenaAllocator<ActiveStreamDecoderFilterPtr>>
+      ActiveStreamDecoderFilterList;
+  typedef ArenaPtr<ActiveStreamEncoderFilter> ActiveStreamEncoderFilterPtr;
+  typedef std::vector<ActiveStreamEncoderFilterPtr, ArenaAllocator<ActiveStreamEncoderFilterPtr>>
+      ActiveStreamEncoderFilterList;
+  typedef std::list<AccessLog::InstanceSharedPtr, ArenaAllocator<AccessLog::InstanceSharedPtr>>
+      AccessLogHandlerList;
 
   /**
    * Base class wrapper for both stream encoder and decoder filters.
@@ -135,11 +154,16 @@ private:
    * Wrapper for a stream decoder filter.
    */
   struct ActiveStreamDecoderFilter : public ActiveStreamFilterBase,
-                                     public StreamDecoderFilterCallbacks,
-                                     LinkedObject<ActiveStreamDecoderFilter> {
+                                     public StreamDecoderFilterCallbacks {
     ActiveStreamDecoderFilter(ActiveStream& parent, StreamDecoderFilterSharedPtr filter,
                               bool dual_filter)
-        : ActiveStreamFilterBase(parent, dual_filter), handle_(filter) {}
+        : ActiveStreamFilterBase(parent, dual_filter), handle_(filter),
+          index_(parent.decoder_filters_.size()) {}
+
+    // @return the position of this filter in the stream's decoder filter list.
+    ActiveStreamDecoderFilterList::iterator entry() {
+      return parent_.decoder_filters_.begin() + index_;
+    }
 
     // ActiveStreamFilterBase
     bool canContinue() override {
@@ -200,20 +224,24 @@ private:
     void requestDataDrained();
 
     StreamDecoderFilterSharedPtr handle_;
+    const size_t index_;
     bool is_grpc_request_{};
   };
 
-  typedef std::unique_ptr<ActiveStreamDecoderFilter> ActiveStreamDecoderFilterPtr;
-
   /**
    * Wrapper for a stream encoder filter.
    */
   struct ActiveStreamEncoderFilter : public ActiveStreamFilterBase,
-                                     public StreamEncoderFilterCallbacks,
-                                     LinkedObject<ActiveStreamEncoderFilter> {
+                                     public StreamEncoderFilterCallbacks {
     ActiveStreamEncoderFilter(ActiveStream& parent, StreamEncoderFilterSharedPtr filter,
                               bool dual_filter)
-        : ActiveStreamFilterBase(parent, dual_filter), handle_(filter) {}
+        : ActiveStreamFilterBase(parent, dual_filter), handle_(filter),
+          index_(parent.encoder_filters_.size()) {}
+
+    // @return the position of this filter in the stream's encoder filter list.
+    ActiveStreamEncoderFilterList::iterator entry() {
+      return parent_.encoder_filters_.begin() + index_;
+    }
 
     // ActiveStreamFilterBase
     bool canContinue() override { return true; }
@@ -248,10 +276,9 @@ private:
     void responseDataDrained();
 
     StreamEncoderFilterSharedPtr handle_;
+    const size_t index_;
   };
 
-  typedef std::unique_ptr<ActiveStreamEncoderFilter> ActiveStreamEncoderFilterPtr;
-
   /**
    * Wraps a single active stream on the connection. These are either full request/response pairs
    * or pushes.
@@ -269,8 +296,8 @@ private:
     void addStreamDecoderFilterWorker(StreamDecoderFilterSharedPtr filter, bool dual_filter);
     void addStreamEncoderFilterWorker(StreamEncoderFilterSharedPtr filter, bool dual_filter);
     void chargeStats(const HeaderMap& headers);
-    std::list<ActiveStreamEncoderFilterPtr>::iterator
-    commonEncodePrefix(ActiveStreamEncoderFilter* filter, bool end_stream);
+    ActiveStreamEncoderFilterList::iterator commonEncodePrefix(ActiveStreamEncoderFilter* filter,
+                                                               bool end_stream);
     const Network::Connection* connection();
     void addDecodedData(ActiveStreamDecoderFilter& filter, Buffer::Instance& data, bool streaming);
     HeaderMap& addDecodedTrailers();
@@ -379,21 +406,48 @@ private:
     // Reset per-stream idle timer.
     void resetIdleTimer();
 
+    // Accounts the memory held in the buffered request and response data of the stream.
+    class MemoryAccountImpl : public Buffer::MemoryAccount {
+    public:
+      MemoryAccountImpl(ActiveStream& stream);
+
+      // Buffer::MemoryAccount
+      std::string describe() const override;
+      void resetOwner() override;
+
+    private:
+      ActiveStream& stream_;
+      const uint64_t stream_id_;
+      const uint64_t connection_id_;
+    };
+
+    // The arena for per-stream allocations, or nullptr if they should use the heap.
+    Arena* streamArena() { return arena_enabled_ ? &arena_ : nullptr; }
+
     ConnectionManagerImpl& connection_manager_;
     Router::ConfigConstSharedPtr snapped_route_config_;
     Tracing::SpanPtr active_span_;
     const uint64_t stream_id_;
+    // Declared before the buffers it accounts so that it outlives them.
+    MemoryAccountImpl memory_account_;
     StreamEncoder* response_encoder_{};
     HeaderMapPtr continue_headers_;
+    // The worker's response header block, which the Date of response_headers_ references.
+    ResponseHeaderBlockConstSharedPtr response_header_block_;
     HeaderMapPtr response_headers_;
     Buffer::WatermarkBufferPtr buffered_response_data_;
     HeaderMapPtr response_trailers_{};
     HeaderMapPtr request_headers_;
     Buffer::WatermarkBufferPtr buffered_request_data_;
     HeaderMapPtr request_trailers_;
-    std::list<ActiveStreamDecoderFilterPtr> decoder_filters_;
-    std::list<ActiveStreamEncoderFilterPtr> encoder_filters_;
-    std::list<AccessLog::InstanceSharedPtr> access_log_handlers_;
+    // Arena for the per-stream filter chain bookkeeping, enabled for the percentage of streams set
+    // by the http_connection_manager.stream_arena_enabled runtime key. The first block is sized
+    // from the arenas of recent streams on this thread. It must outlive the members below.
+    Arena arena_;
+    const bool arena_enabled_;
+    ActiveStreamDecoderFilterList decoder_filters_;
+    ActiveStreamEncoderFilterList encoder_filters_;
+    AccessLogHandlerList access_log_handlers_;
     Stats::TimespanPtr request_timer_;
     // Per-stream idle timeout.
     Event::TimerPtr idle_timer_;
@@ -430,6 +484,11 @@ private:
    */
   void doEndStream(ActiveStream& stream);
 
+  /**
+   * @return the connection idle timeout, shrunk by the reduce timeouts overload action.
+   */
+  std::chrono::milliseconds idleTimeout() const;
+
   void resetAllStreams();
   void onIdleTimeout();
   void onDrainTimeout();
@@ -444,6 +503,10 @@ private:
                                   // config in the hot path.
   ServerConnectionPtr codec_;
   std::list<ActiveStreamPtr> streams_;
+  // Sizes of the last filter chain created on this connection, which the next stream's filter
+  // lists are reserved to. Streams of a connection almost always get the same chain.
+  size_t decoder_filter_chain_size_{};
+  size_t encoder_filter_chain_size_{};
   Stats::TimespanPtr conn_length_;
   const Network::DrainDecision& drain_close_;
   DrainState drain_state_{DrainState::NotDraining};
@@ -457,8 +520,11 @@ private:
   Upstream::ClusterManager& cluster_manager_;
   WebSocketProxyPtr ws_connection_;
   Network::ReadFilterCallbacks* read_callbacks_{};
+  // Resolved on the first request of the connection.
+  std::unique_ptr<const RequestMutationPolicy> request_mutation_policy_;
   ConnectionManagerListenerStats& listener_stats_;
   const Server::OverloadActionState& overload_stop_accepting_requests_;
+  const double& overload_reduce_timeouts_;
 };
 
 } // namespace Http
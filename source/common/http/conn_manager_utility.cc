@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 #include "common/access_log/access_log_formatter.h"
@@ -10,19 +11,62 @@
 #include "common/http/headers.h"
 #include "common/http/utility.h"
 #include "common/network/utility.h"
+#include "common/runtime/key_registry.h"
+#include "common/runtime/runtime_impl.h"
 #include "common/runtime/uuid_util.h"
 #include "common/tracing/http_tracer_impl.h"
 
 #include "absl/strings/str_join.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Http {
 
+static const Runtime::Key RuntimeTracingClientEnabled =
+    Runtime::KeyRegistry::intern("tracing.client_enabled");
+static const Runtime::Key RuntimeTracingRandomSampling =
+    Runtime::KeyRegistry::intern("tracing.random_sampling");
+static const Runtime::Key RuntimeTracingGlobalEnabled =
+    Runtime::KeyRegistry::intern("tracing.global_enabled");
+
+RequestMutationPolicy::RequestMutationPolicy(ConnectionManagerConfig& config,
+                                             const Network::Connection& connection,
+                                             const LocalInfo::LocalInfo& local_info)
+    : use_remote_address_(config.useRemoteAddress()),
+      xff_num_trusted_hops_(config.xffNumTrustedHops()),
+      forwarded_proto_(connection.ssl() ? Headers::get().SchemeValues.Https
+                                        : Headers::get().SchemeValues.Http),
+      user_agent_(config.userAgent()), via_(config.via()),
+      generate_request_id_(config.generateRequestId()) {
+  if (use_remote_address_) {
+    const Network::Address::Instance& remote_address = *connection.remoteAddress();
+    if (!config.skipXffAppend()) {
+      xff_address_ = Network::Utility::isLoopbackAddress(remote_address) ? &config.localAddress()
+                                                                         : &remote_address;
+    }
+    remote_address_internal_ = Network::Utility::isInternalAddress(remote_address);
+  }
+
+  if (user_agent_) {
+    downstream_service_node_ = local_info.nodeName();
+  }
+}
+
 Network::Address::InstanceConstSharedPtr ConnectionManagerUtility::mutateRequestHeaders(
     Http::HeaderMap& request_headers, Network::Connection& connection,
     ConnectionManagerConfig& config, const Router::Config& route_config,
     Runtime::RandomGenerator& random, Runtime::Loader& runtime,
     const LocalInfo::LocalInfo& local_info) {
+  return mutateRequestHeaders(request_headers, connection, config,
+                              RequestMutationPolicy(config, connection, local_info), route_config,
+                              random, runtime);
+}
+
+Network::Address::InstanceConstSharedPtr ConnectionManagerUtility::mutateRequestHeaders(
+    Http::HeaderMap& request_headers, Network::Connection& connection,
+    ConnectionManagerConfig& config, const RequestMutationPolicy& policy,
+    const Router::Config& route_config, Runtime::RandomGenerator& random,
+    Runtime::Loader& runtime) {
   // If this is a Upgrade request, do not remove the Connection and Upgrade headers,
   // as we forward them verbatim to the upstream hosts.
   if (Utility::isUpgrade(request_headers)) {
@@ -52,8 +96,10 @@ Network::Address::InstanceConstSharedPtr ConnectionManagerUtility::mutateRequest
   // our peer to have already properly set XFF, etc.
   Network::Address::InstanceConstSharedPtr final_remote_address;
   bool single_xff_address;
-  const uint32_t xff_num_trusted_hops = config.xffNumTrustedHops();
-  if (config.useRemoteAddress()) {
+  // Whether final_remote_address is internal, if single_xff_address.
+  bool final_remote_address_internal = false;
+  const uint32_t xff_num_trusted_hops = policy.xff_num_trusted_hops_;
+  if (policy.use_remote_address_) {
     single_xff_address = request_headers.ForwardedFor() == nullptr;
     // If there are any trusted proxies in front of this Envoy instance (as indicated by
     // the xff_num_trusted_hops configuration option), get the trusted client address
@@ -67,16 +113,14 @@ Network::Address::InstanceConstSharedPtr ConnectionManagerUtility::mutateRequest
     // source address of the immediate downstream's connection to us.
     if (final_remote_address == nullptr) {
       final_remote_address = connection.remoteAddress();
+      final_remote_address_internal = policy.remote_address_internal_;
+    } else if (single_xff_address) {
+      final_remote_address_internal = Network::Utility::isInternalAddress(*final_remote_address);
     }
-    if (!config.skipXffAppend()) {
-      if (Network::Utility::isLoopbackAddress(*connection.remoteAddress())) {
-        Utility::appendXff(request_headers, config.localAddress());
-      } else {
-        Utility::appendXff(request_headers, *connection.remoteAddress());
-      }
+    if (policy.xff_address_ != nullptr) {
+      Utility::appendXff(request_headers, *policy.xff_address_);
     }
-    request_headers.insertForwardedProto().value().setReference(
-        connection.ssl() ? Headers::get().SchemeValues.Https : Headers::get().SchemeValues.Http);
+    request_headers.insertForwardedProto().value().setReference(policy.forwarded_proto_);
   } else {
     // If we are not using remote address, attempt to pull a valid IPv4 or IPv6 address out of XFF.
     // If we find one, it will be used as the downstream address for logging. It may or may not be
@@ -84,13 +128,14 @@ Network::Address::InstanceConstSharedPtr ConnectionManagerUtility::mutateRequest
     auto ret = Utility::getLastAddressFromXFF(request_headers, xff_num_trusted_hops);
     final_remote_address = ret.address_;
     single_xff_address = ret.single_address_;
-  }
+    final_remote_address_internal = single_xff_address && final_remote_address != nullptr &&
+                                    Network::Utility::isInternalAddress(*final_remote_address);
 
-  // If we didn't already replace x-forwarded-proto because we are using the remote address, and
-  // remote hasn't set it (trusted proxy), we set it, since we then use this for setting scheme.
-  if (!request_headers.ForwardedProto()) {
-    request_headers.insertForwardedProto().value().setReference(
-        connection.ssl() ? Headers::get().SchemeValues.Https : Headers::get().SchemeValues.Http);
+    // If remote hasn't set x-forwarded-proto (trusted proxy), we set it, since we then use this
+    // for setting scheme.
+    if (!request_headers.ForwardedProto()) {
+      request_headers.insertForwardedProto().value().setReference(policy.forwarded_proto_);
+    }
   }
 
   // At this point we can determine whether this is an internal or external request. The
@@ -102,8 +147,7 @@ Network::Address::InstanceConstSharedPtr ConnectionManagerUtility::mutateRequest
   // HUGE WARNING: The way we do this is not optimal but is how it worked "from the beginning" so
   //               we can't change it at this point. In the future we will likely need to add
   //               additional inference modes and make this mode legacy.
-  const bool internal_request = single_xff_address && final_remote_address != nullptr &&
-                                Network::Utility::isInternalAddress(*final_remote_address);
+  const bool internal_request = single_xff_address && final_remote_address_internal;
 
   // After determining internal request status, if there is no final remote address, due to no XFF,
   // busted XFF, etc., use the direct connection remote address for logging.
@@ -113,7 +157,7 @@ Network::Address::InstanceConstSharedPtr ConnectionManagerUtility::mutateRequest
 
   // Edge request is the request from external clients to front Envoy.
   // Request from front Envoy to the internal service will be treated as not edge request.
-  const bool edge_request = !internal_request && config.useRemoteAddress();
+  const bool edge_request = !internal_request && policy.use_remote_address_;
 
   // If internal request, set header and do other internal only modifications.
   if (internal_request) {
@@ -142,23 +186,23 @@ Network::Address::InstanceConstSharedPtr ConnectionManagerUtility::mutateRequest
     }
   }
 
-  if (config.userAgent()) {
-    request_headers.insertEnvoyDownstreamServiceCluster().value(config.userAgent().value());
+  if (policy.user_agent_) {
+    request_headers.insertEnvoyDownstreamServiceCluster().value(policy.user_agent_.value());
     HeaderEntry& user_agent_header = request_headers.insertUserAgent();
     if (user_agent_header.value().empty()) {
       // Following setReference() is safe because user agent is constant for the life of the
       // listener.
-      user_agent_header.value().setReference(config.userAgent().value());
+      user_agent_header.value().setReference(policy.user_agent_.value());
     }
 
     // TODO(htuch): should this be under the config.userAgent() condition or in the outer scope?
-    if (!local_info.nodeName().empty()) {
-      request_headers.insertEnvoyDownstreamServiceNode().value(local_info.nodeName());
+    if (!policy.downstream_service_node_.empty()) {
+      request_headers.insertEnvoyDownstreamServiceNode().value(policy.downstream_service_node_);
     }
   }
 
-  if (!config.via().empty()) {
-    Utility::appendVia(request_headers, config.via());
+  if (!policy.via_.empty()) {
+    Utility::appendVia(request_headers, policy.via_);
   }
 
   // If we are an external request, AND we are "using remote address" (see above), we set
@@ -169,7 +213,7 @@ Network::Address::InstanceConstSharedPtr ConnectionManagerUtility::mutateRequest
   }
 
   // Generate x-request-id for all edge requests, or if there is none.
-  if (config.generateRequestId() && (edge_request || !request_headers.RequestId())) {
+  if (policy.generate_request_id_ && (edge_request || !request_headers.RequestId())) {
     // TODO(PiotrSikora) PERF: Write UUID directly to the header map.
     const std::string uuid = random.uuid();
     ASSERT(!uuid.empty());
@@ -189,34 +233,43 @@ void ConnectionManagerUtility::mutateTracingRequestHeader(Http::HeaderMap& reque
     return;
   }
 
-  std::string x_request_id = request_headers.RequestId()->value().c_str();
+  HeaderString& request_id = request_headers.RequestId()->value();
+  const absl::string_view x_request_id = request_id.getStringView();
   uint64_t result;
   // Skip if x-request-id is corrupted.
   if (!UuidUtils::uuidModBy(x_request_id, result, 10000)) {
     return;
   }
 
+  absl::optional<UuidTraceStatus> trace_status;
   // Do not apply tracing transformations if we are currently tracing.
   if (UuidTraceStatus::NoTrace == UuidUtils::isTraceableUuid(x_request_id)) {
     if (request_headers.ClientTraceId() &&
-        runtime.snapshot().featureEnabled("tracing.client_enabled",
+        runtime.snapshot().featureEnabled(RuntimeTracingClientEnabled,
                                           config.tracingConfig()->client_sampling_)) {
-      UuidUtils::setTraceableUuid(x_request_id, UuidTraceStatus::Client);
+      trace_status = UuidTraceStatus::Client;
     } else if (request_headers.EnvoyForceTrace()) {
-      UuidUtils::setTraceableUuid(x_request_id, UuidTraceStatus::Forced);
-    } else if (runtime.snapshot().featureEnabled("tracing.random_sampling",
+      trace_status = UuidTraceStatus::Forced;
+    } else if (runtime.snapshot().featureEnabled(RuntimeTracingRandomSampling,
                                                  config.tracingConfig()->random_sampling_, result,
                                                  10000)) {
-      UuidUtils::setTraceableUuid(x_request_id, UuidTraceStatus::Sampled);
+      trace_status = UuidTraceStatus::Sampled;
     }
   }
 
-  if (!runtime.snapshot().featureEnabled("tracing.global_enabled",
+  if (!runtime.snapshot().featureEnabled(RuntimeTracingGlobalEnabled,
                                          config.tracingConfig()->overall_sampling_, result)) {
-    UuidUtils::setTraceableUuid(x_request_id, UuidTraceStatus::NoTrace);
+    trace_status = UuidTraceStatus::NoTrace;
   }
 
-  request_headers.RequestId()->value(x_request_id);
+  // The header value may reference memory that it doesn't own, so the status is set on a copy on
+  // the stack, which then replaces the value without allocating.
+  char uuid[Runtime::RandomGeneratorImpl::UUID_LENGTH];
+  if (trace_status.has_value() && x_request_id.size() == sizeof(uuid)) {
+    memcpy(uuid, x_request_id.data(), sizeof(uuid));
+    UuidUtils::setTraceableUuid(uuid, sizeof(uuid), trace_status.value());
+    request_id.setCopy(uuid, sizeof(uuid));
+  }
 }
 
 void ConnectionManagerUtility::mutateXfccRequestHeader(Http::HeaderMap& request_headers,
@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <cstdint>
+#include <string>
 
 #include "envoy/http/header_map.h"
 #include "envoy/network/connection.h"
@@ -11,6 +12,30 @@
 namespace Envoy {
 namespace Http {
 
+/**
+ * The request header mutations that apply to the requests of a downstream connection, resolved
+ * once from the connection manager configuration and the connection. Mutating the headers of each
+ * request then only depends on the request headers.
+ */
+struct RequestMutationPolicy {
+  RequestMutationPolicy(ConnectionManagerConfig& config, const Network::Connection& connection,
+                        const LocalInfo::LocalInfo& local_info);
+
+  const bool use_remote_address_;
+  const uint32_t xff_num_trusted_hops_;
+  // The address appended to XFF, or nullptr if XFF is not appended.
+  const Network::Address::Instance* xff_address_{};
+  // Whether the remote address of the connection is internal. Only resolved when using the remote
+  // address.
+  bool remote_address_internal_{};
+  const std::string& forwarded_proto_;
+  const absl::optional<std::string>& user_agent_;
+  // The value of x-envoy-downstream-service-node, or empty if it is not set.
+  std::string downstream_service_node_;
+  const std::string& via_;
+  const bool generate_request_id_;
+};
+
 /**
  * Connection manager utilities split out for ease of testing.
  */
@@ -33,6 +58,16 @@ public:
                        Runtime::RandomGenerator& random, Runtime::Loader& runtime,
                        const LocalInfo::LocalInfo& local_info);
 
+  /**
+   * As above, with the policy of the connection resolved ahead of time.
+   * @param policy supplies the policy resolved from the config and the connection.
+   */
+  static Network::Address::InstanceConstSharedPtr
+  mutateRequestHeaders(Http::HeaderMap& request_headers, Network::Connection& connection,
+                       ConnectionManagerConfig& config, const RequestMutationPolicy& policy,
+                       const Router::Config& route_config, Runtime::RandomGenerator& random,
+                       Runtime::Loader& runtime);
+
   static void mutateResponseHeaders(Http::HeaderMap& response_headers,
                                     const Http::HeaderMap* request_headers, const std::string& via);
 
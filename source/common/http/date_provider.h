@@ -1,11 +1,27 @@
 #pragma once
 
+#include <memory>
+#include <string>
+
 #include "envoy/common/pure.h"
 #include "envoy/http/header_map.h"
 
 namespace Envoy {
 namespace Http {
 
+/**
+ * The values of the headers added to every response, formatted once and shared by the responses
+ * of all the workers until the next refresh. A block is immutable, so header maps may reference its
+ * values rather than copying them, for as long as the block is held.
+ */
+struct ResponseHeaderBlock {
+  explicit ResponseHeaderBlock(const std::string& date) : date_(date) {}
+
+  const std::string date_;
+};
+
+typedef std::shared_ptr<const ResponseHeaderBlock> ResponseHeaderBlockConstSharedPtr;
+
 /**
  * Fills headers with a date header.
  */
@@ -14,10 +30,25 @@ public:
   virtual ~DateProvider() {}
 
   /**
-   * Set the Date header potentially using a cached value.
+   * Set the Date header potentially using a cached value. The value is copied into the headers.
    * @param headers supplies the headers to fill.
    */
   virtual void setDateHeader(HeaderMap& headers) PURE;
+
+  /**
+   * @return ResponseHeaderBlockConstSharedPtr the current response header block, potentially
+   *         cached. Use referenceDateHeader() to reference its Date rather than copying it.
+   */
+  virtual ResponseHeaderBlockConstSharedPtr responseHeaderBlock() PURE;
+
+  /**
+   * Set the Date header to reference the value of a response header block.
+   * @param headers supplies the headers to fill.
+   * @param block supplies the block, which MUST be held for as long as headers reference it.
+   */
+  static void referenceDateHeader(HeaderMap& headers, const ResponseHeaderBlock& block) {
+    headers.insertDate().value().setPinned(block.date_.c_str(), block.date_.size());
+  }
 };
 
 } // namespace Http
@@ -1,6 +1,7 @@
 #include "common/http/date_provider_impl.h"
 
 #include <chrono>
+#include <memory>
 #include <string>
 
 namespace Envoy {
@@ -17,21 +18,29 @@ TlsCachingDateProviderImpl::TlsCachingDateProviderImpl(Event::Dispatcher& dispat
 }
 
 void TlsCachingDateProviderImpl::onRefreshDate() {
-  std::string new_date_string = date_formatter_.now();
-  tls_->set([new_date_string](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-    return std::make_shared<ThreadLocalCachedDate>(new_date_string);
-  });
+  tls_->publish(std::make_shared<ThreadLocalCachedBlock>(date_formatter_.now()));
 
   refresh_timer_->enableTimer(std::chrono::milliseconds(500));
 }
 
 void TlsCachingDateProviderImpl::setDateHeader(HeaderMap& headers) {
-  headers.insertDate().value(tls_->getTyped<ThreadLocalCachedDate>().date_string_);
+  headers.insertDate().value(tls_->getTyped<ThreadLocalCachedBlock>().block_.date_);
+}
+
+ResponseHeaderBlockConstSharedPtr TlsCachingDateProviderImpl::responseHeaderBlock() {
+  // The block shares the ownership of the cached object, so nothing is allocated per response.
+  std::shared_ptr<ThreadLocalCachedBlock> cached =
+      std::dynamic_pointer_cast<ThreadLocalCachedBlock>(tls_->get());
+  return ResponseHeaderBlockConstSharedPtr(cached, &cached->block_);
 }
 
 void SlowDateProviderImpl::setDateHeader(HeaderMap& headers) {
   headers.insertDate().value(date_formatter_.now());
 }
 
+ResponseHeaderBlockConstSharedPtr SlowDateProviderImpl::responseHeaderBlock() {
+  return std::make_shared<ResponseHeaderBlock>(date_formatter_.now());
+}
+
 } // namespace Http
 } // namespace Envoy
@@ -23,8 +23,8 @@ protected:
 };
 
 /**
- * A caching thread local provider. This implementation updates the date string every 500ms and
- * caches on each thread.
+ * A caching thread local provider. This implementation updates the response header block every
+ * 500ms and caches it on each thread.
  */
 class TlsCachingDateProviderImpl : public DateProviderImplBase, public Singleton::Instance {
 public:
@@ -32,12 +32,13 @@ public:
 
   // Http::DateProvider
   void setDateHeader(HeaderMap& headers) override;
+  ResponseHeaderBlockConstSharedPtr responseHeaderBlock() override;
 
 private:
-  struct ThreadLocalCachedDate : public ThreadLocal::ThreadLocalObject {
-    ThreadLocalCachedDate(const std::string& date_string) : date_string_(date_string) {}
+  struct ThreadLocalCachedBlock : public ThreadLocal::ThreadLocalObject {
+    ThreadLocalCachedBlock(const std::string& date) : block_(date) {}
 
-    const std::string date_string_;
+    const ResponseHeaderBlock block_;
   };
 
   void onRefreshDate();
@@ -53,6 +54,7 @@ class SlowDateProviderImpl : public DateProviderImplBase {
 public:
   // Http::DateProvider
   void setDateHeader(HeaderMap& headers) override;
+  ResponseHeaderBlockConstSharedPtr responseHeaderBlock() override;
 };
 
 } // namespace Http
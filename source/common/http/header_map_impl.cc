@@ -1,7 +1,7 @@
 #include "common/http/header_map_impl.h"
 
+#include <algorithm>
 #include <cstdint>
-#include <list>
 #include <string>
 
 #include "common/common/assert.h"
@@ -54,6 +54,7 @@ HeaderString::HeaderString(HeaderString&& move_value) {
   type_ = move_value.type_;
   string_length_ = move_value.string_length_;
   switch (move_value.type_) {
+  case Type::Pinned:
   case Type::Reference: {
     buffer_.ref_ = move_value.buffer_.ref_;
     break;
@@ -87,6 +88,7 @@ void HeaderString::freeDynamic() {
 
 void HeaderString::append(const char* data, uint32_t size) {
   switch (type_) {
+  case Type::Pinned:
   case Type::Reference: {
     // Rather than be too clever and optimize this uncommon case, we dynamically
     // allocate and copy.
@@ -146,6 +148,7 @@ void HeaderString::append(const char* data, uint32_t size) {
 
 void HeaderString::clear() {
   switch (type_) {
+  case Type::Pinned:
   case Type::Reference: {
     break;
   }
@@ -161,6 +164,7 @@ void HeaderString::clear() {
 
 void HeaderString::setCopy(const char* data, uint32_t size) {
   switch (type_) {
+  case Type::Pinned:
   case Type::Reference: {
     // Switch back to inline and fall through.
     type_ = Type::Inline;
@@ -206,6 +210,7 @@ void HeaderString::setCopy(const char* data, uint32_t size) {
 
 void HeaderString::setInteger(uint64_t value) {
   switch (type_) {
+  case Type::Pinned:
   case Type::Reference: {
     // Switch back to inline and fall through.
     type_ = Type::Inline;
@@ -236,6 +241,14 @@ void HeaderString::setReference(const std::string& ref_value) {
   string_length_ = ref_value.size();
 }
 
+void HeaderString::setPinned(const char* data, uint32_t size) {
+  ASSERT(data[size] == 0);
+  freeDynamic();
+  type_ = Type::Pinned;
+  buffer_.ref_ = data;
+  string_length_ = size;
+}
+
 // Specialization needed for HeaderMapImpl::HeaderList::insert() when key is LowerCaseString.
 // A fully specialized template must be defined once in the program, hence this may not be in
 // a header file.
@@ -243,6 +256,48 @@ template <> bool HeaderMapImpl::HeaderList::isPseudoHeader(const LowerCaseString
   return key.get().c_str()[0] == ':';
 }
 
+constexpr size_t HeaderMapImpl::HeaderList::InitialCapacity;
+constexpr size_t HeaderMapImpl::HeaderList::MaxBlockCapacity;
+
+HeaderMapImpl::HeaderList::~HeaderList() {
+  for (HeaderEntryImpl* entry : headers_) {
+    entry->~HeaderEntryImpl();
+  }
+}
+
+void HeaderMapImpl::HeaderList::erase(HeaderEntryImpl& entry) {
+  // Removal is rare compared to iteration, so a linear scan of the (short) order vector is
+  // cheaper overall than maintaining a back reference in every entry.
+  auto i = std::find(headers_.begin(), headers_.end(), &entry);
+  ASSERT(i != headers_.end());
+  if (static_cast<size_t>(i - headers_.begin()) < pseudo_headers_end_) {
+    pseudo_headers_end_--;
+  }
+  headers_.erase(i);
+  release(&entry);
+}
+
+void* HeaderMapImpl::HeaderList::allocate() {
+  if (!free_entries_.empty()) {
+    EntryStorage* storage = free_entries_.back();
+    free_entries_.pop_back();
+    return storage;
+  }
+  if (last_block_used_ == last_block_capacity_) {
+    last_block_capacity_ = last_block_capacity_ == 0
+                               ? InitialCapacity
+                               : std::min(last_block_capacity_ * 2, MaxBlockCapacity);
+    last_block_used_ = 0;
+    blocks_.emplace_back(new EntryStorage[last_block_capacity_]);
+  }
+  return &blocks_.back()[last_block_used_++];
+}
+
+void HeaderMapImpl::HeaderList::release(HeaderEntryImpl* entry) {
+  entry->~HeaderEntryImpl();
+  free_entries_.push_back(reinterpret_cast<EntryStorage*>(entry));
+}
+
 HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key) : key_(key) {}
 
 HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key, HeaderString&& value)
@@ -266,7 +321,7 @@ void HeaderMapImpl::HeaderEntryImpl::value(const HeaderEntry& header) {
 }
 
 #define INLINE_HEADER_STATIC_MAP_ENTRY(name)                                                       \
-  add(Headers::get().name.get().c_str(), [](HeaderMapImpl& h) -> StaticLookupResponse {            \
+  add(Headers::get().name, [](HeaderMapImpl& h) -> StaticLookupResponse {                          \
     return {&h.inline_headers_.name##_, &Headers::get().name};                                     \
   });
 
@@ -274,38 +329,65 @@ HeaderMapImpl::StaticLookupTable::StaticLookupTable() {
   ALL_INLINE_HEADERS(INLINE_HEADER_STATIC_MAP_ENTRY)
 
   // Special case where we map a legacy host header to :authority.
-  add(Headers::get().HostLegacy.get().c_str(), [](HeaderMapImpl& h) -> StaticLookupResponse {
+  add(Headers::get().HostLegacy, [](HeaderMapImpl& h) -> StaticLookupResponse {
     return {&h.inline_headers_.Host_, &Headers::get().Host};
   });
+
+  RELEASE_ASSERT(entries_.size() < 256, "too many inline headers for the static lookup table");
+  seed_ = 1;
+  while (!build(seed_)) {
+    // Only names with the same length and sampled characters can never be told apart.
+    RELEASE_ASSERT(seed_ < (1 << 20), "inline header names are not distinguishable by hash");
+    seed_++;
+  }
 }
 
-void HeaderMapImpl::StaticLookupTable::add(const char* key, StaticLookupEntry::EntryCb cb) {
-  StaticLookupEntry* current = &root_;
-  while (uint8_t c = *key) {
-    if (!current->entries_[c]) {
-      current->entries_[c].reset(new StaticLookupEntry());
-    }
+void HeaderMapImpl::StaticLookupTable::add(const LowerCaseString& key,
+                                           StaticLookupEntry::EntryCb cb) {
+  ASSERT(!key.get().empty());
+  entries_.push_back({key.get(), cb});
+}
 
-    current = current->entries_[c].get();
-    key++;
+uint32_t HeaderMapImpl::StaticLookupTable::hash(absl::string_view key, uint32_t seed) {
+  ASSERT(!key.empty());
+  const size_t size = key.size();
+  const uint32_t samples[] = {static_cast<uint32_t>(size), static_cast<uint8_t>(key[0]),
+                              static_cast<uint8_t>(key[size / 2]),
+                              static_cast<uint8_t>(key[size > 1 ? size - 2 : 0]),
+                              static_cast<uint8_t>(key[size - 1])};
+  uint32_t h = seed;
+  for (const uint32_t sample : samples) {
+    h = (h ^ sample) * 0x9e3779b1;
+    h ^= h >> 15;
   }
+  return h;
+}
 
-  current->cb_ = cb;
+bool HeaderMapImpl::StaticLookupTable::build(uint32_t seed) {
+  slots_.fill(0);
+  for (size_t i = 0; i < entries_.size(); i++) {
+    uint8_t& slot = slots_[hash(entries_[i].key_, seed) & (NumSlots - 1)];
+    if (slot != 0) {
+      return false;
+    }
+    slot = static_cast<uint8_t>(i + 1);
+  }
+  return true;
 }
 
 HeaderMapImpl::StaticLookupEntry::EntryCb
-HeaderMapImpl::StaticLookupTable::find(const char* key) const {
-  const StaticLookupEntry* current = &root_;
-  while (uint8_t c = *key) {
-    current = current->entries_[c].get();
-    if (current) {
-      key++;
-    } else {
-      return nullptr;
-    }
+HeaderMapImpl::StaticLookupTable::find(absl::string_view key) const {
+  if (key.empty()) {
+    return nullptr;
   }
 
-  return current->cb_;
+  const uint8_t slot = slots_[hash(key, seed_) & (NumSlots - 1)];
+  if (slot == 0) {
+    return nullptr;
+  }
+
+  const StaticLookupEntry& entry = entries_[slot - 1];
+  return entry.key_ == key ? entry.cb_ : nullptr;
 }
 
 void HeaderMapImpl::appendToHeader(HeaderString& header, absl::string_view data) {
@@ -354,7 +436,7 @@ bool HeaderMapImpl::operator==(const HeaderMapImpl& rhs) const {
   }
 
   for (auto i = headers_.begin(), j = rhs.headers_.begin(); i != headers_.end(); ++i, ++j) {
-    if (i->key() != j->key().c_str() || i->value() != j->value().c_str()) {
+    if ((*i)->key() != (*j)->key().c_str() || (*i)->value() != (*j)->value().c_str()) {
       return false;
     }
   }
@@ -363,7 +445,8 @@ bool HeaderMapImpl::operator==(const HeaderMapImpl& rhs) const {
 }
 
 void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.c_str());
+  StaticLookupEntry::EntryCb cb =
+      ConstSingleton<StaticLookupTable>::get().find(key.getStringView());
   if (cb) {
     key.clear();
     StaticLookupResponse ref_lookup_response = cb(*this);
@@ -374,15 +457,14 @@ void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
       value.clear();
     }
   } else {
-    std::list<HeaderEntryImpl>::iterator i = headers_.insert(std::move(key), std::move(value));
-    i->entry_ = i;
+    headers_.insert(std::move(key), std::move(value));
   }
 }
 
 void HeaderMapImpl::addViaMove(HeaderString&& key, HeaderString&& value) {
   // If this is an inline header, we can't addViaMove, because we'll overwrite
   // the existing value.
-  auto* entry = getExistingInline(key.c_str());
+  auto* entry = getExistingInline(key.getStringView());
   if (entry != nullptr) {
     appendToHeader(entry->value(), value.c_str());
     key.clear();
@@ -415,7 +497,7 @@ void HeaderMapImpl::addReferenceKey(const LowerCaseString& key, const std::strin
 }
 
 void HeaderMapImpl::addCopy(const LowerCaseString& key, uint64_t value) {
-  auto* entry = getExistingInline(key.get().c_str());
+  auto* entry = getExistingInline(key.get());
   if (entry != nullptr) {
     char buf[32];
     StringUtil::itoa(buf, sizeof(buf), value);
@@ -432,7 +514,7 @@ void HeaderMapImpl::addCopy(const LowerCaseString& key, uint64_t value) {
 }
 
 void HeaderMapImpl::addCopy(const LowerCaseString& key, const std::string& value) {
-  auto* entry = getExistingInline(key.get().c_str());
+  auto* entry = getExistingInline(key.get());
   if (entry != nullptr) {
     appendToHeader(entry->value(), value);
     return;
@@ -464,18 +546,18 @@ void HeaderMapImpl::setReferenceKey(const LowerCaseString& key, const std::strin
 
 uint64_t HeaderMapImpl::byteSize() const {
   uint64_t byte_size = 0;
-  for (const HeaderEntryImpl& header : headers_) {
-    byte_size += header.key().size();
-    byte_size += header.value().size();
+  for (const HeaderEntryImpl* header : headers_) {
+    byte_size += header->key().size();
+    byte_size += header->value().size();
   }
 
   return byte_size;
 }
 
 const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    if (header.key() == key.get().c_str()) {
-      return &header;
+  for (const HeaderEntryImpl* header : headers_) {
+    if (header->key() == key.get().c_str()) {
+      return header;
     }
   }
 
@@ -483,9 +565,9 @@ const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const {
 }
 
 HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) {
-  for (HeaderEntryImpl& header : headers_) {
-    if (header.key() == key.get().c_str()) {
-      return &header;
+  for (HeaderEntryImpl* header : headers_) {
+    if (header->key() == key.get().c_str()) {
+      return header;
     }
   }
 
@@ -493,8 +575,8 @@ HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) {
 }
 
 void HeaderMapImpl::iterate(ConstIterateCb cb, void* context) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    if (cb(header, context) == HeaderMap::Iterate::Break) {
+  for (const HeaderEntryImpl* header : headers_) {
+    if (cb(*header, context) == HeaderMap::Iterate::Break) {
       break;
     }
   }
@@ -502,7 +584,7 @@ void HeaderMapImpl::iterate(ConstIterateCb cb, void* context) const {
 
 void HeaderMapImpl::iterateReverse(ConstIterateCb cb, void* context) const {
   for (auto it = headers_.rbegin(); it != headers_.rend(); it++) {
-    if (cb(*it, context) == HeaderMap::Iterate::Break) {
+    if (cb(**it, context) == HeaderMap::Iterate::Break) {
       break;
     }
   }
@@ -510,7 +592,7 @@ void HeaderMapImpl::iterateReverse(ConstIterateCb cb, void* context) const {
 
 HeaderMap::Lookup HeaderMapImpl::lookup(const LowerCaseString& key,
                                         const HeaderEntry** entry) const {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get().c_str());
+  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get());
   if (cb) {
     // The accessor callbacks for predefined inline headers take a HeaderMapImpl& as an argument;
     // even though we don't make any modifications, we need to cast_cast in order to use the
@@ -532,18 +614,13 @@ HeaderMap::Lookup HeaderMapImpl::lookup(const LowerCaseString& key,
 }
 
 void HeaderMapImpl::remove(const LowerCaseString& key) {
-  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get().c_str());
+  StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key.get());
   if (cb) {
     StaticLookupResponse ref_lookup_response = cb(*this);
     removeInline(ref_lookup_response.entry_);
   } else {
-    for (auto i = headers_.begin(); i != headers_.end();) {
-      if (i->key() == key.get().c_str()) {
-        i = headers_.erase(i);
-      } else {
-        ++i;
-      }
-    }
+    headers_.remove_if(
+        [&key](const HeaderEntryImpl& entry) { return entry.key() == key.get().c_str(); });
   }
 }
 
@@ -554,7 +631,7 @@ void HeaderMapImpl::removePrefix(const LowerCaseString& prefix) {
       // If this header should be removed, make sure any references in the
       // static lookup table are cleared as well.
       StaticLookupEntry::EntryCb cb =
-          ConstSingleton<StaticLookupTable>::get().find(entry.key().c_str());
+          ConstSingleton<StaticLookupTable>::get().find(entry.key().getStringView());
       if (cb) {
         StaticLookupResponse ref_lookup_response = cb(*this);
         if (ref_lookup_response.entry_) {
@@ -572,9 +649,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.insert(key);
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = &headers_.insert(key);
   return **entry;
 }
 
@@ -586,13 +661,11 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.insert(key, std::move(value));
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = &headers_.insert(key, std::move(value));
   return **entry;
 }
 
-HeaderMapImpl::HeaderEntryImpl* HeaderMapImpl::getExistingInline(const char* key) {
+HeaderMapImpl::HeaderEntryImpl* HeaderMapImpl::getExistingInline(absl::string_view key) {
   StaticLookupEntry::EntryCb cb = ConstSingleton<StaticLookupTable>::get().find(key);
   if (cb) {
     StaticLookupResponse ref_lookup_response = cb(*this);
@@ -608,7 +681,7 @@ void HeaderMapImpl::removeInline(HeaderEntryImpl** ptr_to_entry) {
 
   HeaderEntryImpl* entry = *ptr_to_entry;
   *ptr_to_entry = nullptr;
-  headers_.erase(entry->entry_);
+  headers_.erase(*entry);
 }
 
 } // namespace Http
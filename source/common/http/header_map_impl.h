@@ -2,9 +2,10 @@
 
 #include <array>
 #include <cstdint>
-#include <list>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "envoy/http/header_map.h"
 
@@ -101,7 +102,6 @@ protected:
 
     HeaderString key_;
     HeaderString value_;
-    std::list<HeaderEntryImpl>::iterator entry_;
   };
 
   struct StaticLookupResponse {
@@ -112,20 +112,31 @@ protected:
   struct StaticLookupEntry {
     typedef StaticLookupResponse (*EntryCb)(HeaderMapImpl&);
 
+    absl::string_view key_;
     EntryCb cb_{};
-    std::array<std::unique_ptr<StaticLookupEntry>, 256> entries_;
   };
 
   /**
    * This is the static lookup table that is used to determine whether a header is one of the O(1)
-   * headers. This uses a trie for lookup time at most equal to the size of the incoming string.
+   * headers. It is a perfect hash over the length and a few characters of the header names: the
+   * seed is chosen when the table is built so that no two names share a slot, so a lookup is a
+   * single hash and a comparison with the only name that can match.
    */
   struct StaticLookupTable {
     StaticLookupTable();
-    void add(const char* key, StaticLookupEntry::EntryCb cb);
-    StaticLookupEntry::EntryCb find(const char* key) const;
+    void add(const LowerCaseString& key, StaticLookupEntry::EntryCb cb);
+    StaticLookupEntry::EntryCb find(absl::string_view key) const;
 
-    StaticLookupEntry root_;
+    static uint32_t hash(absl::string_view key, uint32_t seed);
+    bool build(uint32_t seed);
+
+    // Enough for the ~75 names to be spread without collisions after trying a few hundred seeds.
+    static constexpr uint32_t NumSlots = 512;
+
+    std::vector<StaticLookupEntry> entries_;
+    // One plus the index in entries_ of the name hashing to each slot, or zero if none does.
+    std::array<uint8_t, NumSlots> slots_{};
+    uint32_t seed_{};
   };
 
   struct AllInlineHeaders {
@@ -136,68 +147,92 @@ protected:
    * List of HeaderEntryImpl that keeps the pseudo headers (key starting with ':') in the front
    * of the list (as required by nghttp2) and otherwise maintains insertion order.
    *
-   * Note: the internal iterators held in fields make this unsafe to copy and move, since the
-   * reference to end() is not preserved across a move (see Notes in
-   * https://en.cppreference.com/w/cpp/container/list/list). The NonCopyable will supress both copy
-   * and move constructors/assignment.
+   * Entries are constructed in place in blocks of contiguous storage owned by the list, so a map
+   * with a typical number of headers costs a handful of allocations rather than one per header,
+   * and the order of the headers is kept in a flat vector of entry pointers, which is what
+   * iteration walks. Entries never move once constructed, so the pointers held by the inline
+   * header index (and handed out by get()) stay valid until the entry is removed. The storage of
+   * removed entries is recycled by later insertions.
+   *
+   * Note: NonCopyable will supress both copy and move constructors/assignment.
    * TODO(htuch): Maybe we want this to movable one day; for now, our header map moves happen on
    * HeaderMapPtr, so the performance impact should not be evident.
    */
   class HeaderList : NonCopyable {
   public:
-    HeaderList() : pseudo_headers_end_(headers_.end()) {}
+    typedef std::vector<HeaderEntryImpl*>::const_iterator const_iterator;
+    typedef std::vector<HeaderEntryImpl*>::const_reverse_iterator const_reverse_iterator;
+
+    ~HeaderList();
 
     template <class Key> bool isPseudoHeader(const Key& key) { return key.c_str()[0] == ':'; }
 
-    template <class Key, class... Value>
-    std::list<HeaderEntryImpl>::iterator insert(Key&& key, Value&&... value) {
+    template <class Key, class... Value> HeaderEntryImpl& insert(Key&& key, Value&&... value) {
       const bool is_pseudo_header = isPseudoHeader(key);
-      std::list<HeaderEntryImpl>::iterator i =
-          headers_.emplace(is_pseudo_header ? pseudo_headers_end_ : headers_.end(),
-                           std::forward<Key>(key), std::forward<Value>(value)...);
-      if (!is_pseudo_header && pseudo_headers_end_ == headers_.end()) {
-        pseudo_headers_end_ = i;
+      HeaderEntryImpl* entry =
+          new (allocate()) HeaderEntryImpl(std::forward<Key>(key), std::forward<Value>(value)...);
+      if (headers_.empty()) {
+        headers_.reserve(InitialCapacity);
       }
-      return i;
-    }
-
-    std::list<HeaderEntryImpl>::iterator erase(std::list<HeaderEntryImpl>::iterator i) {
-      if (pseudo_headers_end_ == i) {
-        pseudo_headers_end_++;
+      if (is_pseudo_header) {
+        headers_.insert(headers_.begin() + pseudo_headers_end_++, entry);
+      } else {
+        headers_.push_back(entry);
       }
-      return headers_.erase(i);
+      return *entry;
     }
 
+    void erase(HeaderEntryImpl& entry);
+
     template <class UnaryPredicate> void remove_if(UnaryPredicate p) {
-      headers_.remove_if([&](const HeaderEntryImpl& entry) {
-        const bool to_remove = p(entry);
-        if (to_remove) {
-          if (pseudo_headers_end_ == entry.entry_) {
-            pseudo_headers_end_++;
+      // Compact the surviving entries to the front of the vector, preserving their order.
+      size_t kept = 0;
+      const size_t pseudo_headers_end = pseudo_headers_end_;
+      for (size_t i = 0; i < headers_.size(); i++) {
+        HeaderEntryImpl* entry = headers_[i];
+        if (p(*entry)) {
+          if (i < pseudo_headers_end) {
+            pseudo_headers_end_--;
           }
+          release(entry);
+        } else {
+          headers_[kept++] = entry;
         }
-        return to_remove;
-      });
+      }
+      headers_.resize(kept);
     }
 
-    std::list<HeaderEntryImpl>::iterator begin() { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::iterator end() { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_iterator begin() const { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::const_iterator end() const { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rend() const { return headers_.rend(); }
+    const_iterator begin() const { return headers_.begin(); }
+    const_iterator end() const { return headers_.end(); }
+    const_reverse_iterator rbegin() const { return headers_.rbegin(); }
+    const_reverse_iterator rend() const { return headers_.rend(); }
     size_t size() const { return headers_.size(); }
 
   private:
-    std::list<HeaderEntryImpl> headers_;
-    std::list<HeaderEntryImpl>::iterator pseudo_headers_end_;
+    typedef std::aligned_storage<sizeof(HeaderEntryImpl), alignof(HeaderEntryImpl)>::type
+        EntryStorage;
+
+    // Capacity of the first storage block and of the order vector. Subsequent blocks double in
+    // size up to MaxBlockCapacity.
+    static constexpr size_t InitialCapacity = 16;
+    static constexpr size_t MaxBlockCapacity = 64;
+
+    void* allocate();
+    void release(HeaderEntryImpl* entry);
+
+    std::vector<HeaderEntryImpl*> headers_;
+    size_t pseudo_headers_end_{0};
+    std::vector<std::unique_ptr<EntryStorage[]>> blocks_;
+    size_t last_block_capacity_{0};
+    size_t last_block_used_{0};
+    std::vector<EntryStorage*> free_entries_;
   };
 
   void insertByKey(HeaderString&& key, HeaderString&& value);
   HeaderEntryImpl& maybeCreateInline(HeaderEntryImpl** entry, const LowerCaseString& key);
   HeaderEntryImpl& maybeCreateInline(HeaderEntryImpl** entry, const LowerCaseString& key,
                                      HeaderString&& value);
-  HeaderEntryImpl* getExistingInline(const char* key);
+  HeaderEntryImpl* getExistingInline(absl::string_view key);
 
   void removeInline(HeaderEntryImpl** entry);
 
@@ -1,8 +1,10 @@
 #include "common/http/header_utility.h"
 
+#include "common/common/macros.h"
 #include "common/common/utility.h"
 #include "common/config/rds_json.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
 #include "common/protobuf/utility.h"
 
 #include "absl/strings/match.h"
@@ -10,6 +12,25 @@
 namespace Envoy {
 namespace Http {
 
+namespace {
+
+typedef std::unordered_map<std::string, HeaderUtility::InlineHeaderGetter> InlineHeaderGetterMap;
+
+#define INLINE_HEADER_GETTER_ENTRY(name)                                                           \
+  {Headers::get().name.get(), static_cast<HeaderUtility::InlineHeaderGetter>(&HeaderMap::name)},
+
+const InlineHeaderGetterMap& inlineHeaderGetters() {
+  CONSTRUCT_ON_FIRST_USE(InlineHeaderGetterMap, ALL_INLINE_HEADERS(INLINE_HEADER_GETTER_ENTRY));
+}
+
+HeaderUtility::InlineHeaderGetter inlineHeaderGetter(const LowerCaseString& name) {
+  const auto& getters = inlineHeaderGetters();
+  const auto it = getters.find(name.get());
+  return it != getters.end() ? it->second : nullptr;
+}
+
+} // namespace
+
 // HeaderMatcher will consist of:
 //   header_match_specifier which can be any one of exact_match, regex_match, range_match,
 //   present_match, prefix_match or suffix_match.
@@ -23,7 +44,8 @@ namespace Http {
 //   f.prefix_match: Match will succeed if header value matches the prefix value specified here.
 //   g.suffix_match: Match will succeed if header value matches the suffix value specified here.
 HeaderUtility::HeaderData::HeaderData(const envoy::api::v2::route::HeaderMatcher& config)
-    : name_(config.name()), invert_match_(config.invert_match()) {
+    : name_(config.name()), invert_match_(config.invert_match()),
+      inline_getter_(inlineHeaderGetter(name_)) {
   switch (config.header_match_specifier_case()) {
   case envoy::api::v2::route::HeaderMatcher::kExactMatch:
     header_match_type_ = HeaderMatchType::Value;
@@ -64,6 +86,101 @@ HeaderUtility::HeaderData::HeaderData(const Json::Object& config)
         return header_matcher;
       }()) {}
 
+HeaderUtility::HeaderMatcherSet::HeaderMatcherSet(
+    const Protobuf::RepeatedPtrField<envoy::api::v2::route::HeaderMatcher>& config) {
+  header_data_.reserve(config.size());
+  for (const auto& header_matcher : config) {
+    header_data_.emplace_back(header_matcher);
+  }
+
+  // header_data_ is not resized past this point, so the pointers into it stay valid.
+  for (const HeaderData& header_data : header_data_) {
+    if (header_data.inline_getter_ != nullptr) {
+      inline_header_data_.push_back(&header_data);
+      continue;
+    }
+    auto it = group_index_.find(header_data.name_.get());
+    if (it == group_index_.end()) {
+      it = group_index_.emplace(header_data.name_.get(), groups_.size()).first;
+      groups_.push_back({&header_data.name_, {}});
+    }
+    groups_[it->second].header_data_.push_back(&header_data);
+  }
+}
+
+bool HeaderUtility::HeaderMatcherSet::matches(const Http::HeaderMap& request_headers) const {
+  for (const HeaderData* header_data : inline_header_data_) {
+    if (!matchHeader((request_headers.*header_data->inline_getter_)(), *header_data)) {
+      return false;
+    }
+  }
+
+  if (groups_.empty()) {
+    return true;
+  }
+
+  // A single lookup is cheaper than hashing every key of the map.
+  if (groups_.size() == 1 || groups_.size() > MaxGroupsPerPass) {
+    for (const HeaderGroup& group : groups_) {
+      if (!matchGroup(group, request_headers.get(*group.name_))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  MatchContext context{*this, 0, true};
+  request_headers.iterate(matchGroupsCb, &context);
+  if (!context.matched_) {
+    return false;
+  }
+
+  // Match the groups of the headers that are absent from the request.
+  for (size_t i = 0; i < groups_.size(); i++) {
+    if ((context.seen_groups_ & (1ULL << i)) == 0 && !matchGroup(groups_[i], nullptr)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+HeaderMap::Iterate HeaderUtility::HeaderMatcherSet::matchGroupsCb(const HeaderEntry& header,
+                                                                  void* context) {
+  MatchContext& match_context = *static_cast<MatchContext*>(context);
+  const HeaderMatcherSet& set = match_context.set_;
+  const auto it = set.group_index_.find(header.key().getStringView());
+  if (it == set.group_index_.end()) {
+    return HeaderMap::Iterate::Continue;
+  }
+
+  // Only the first header with the key is matched, as with HeaderMap::get().
+  const uint64_t group_bit = 1ULL << it->second;
+  if ((match_context.seen_groups_ & group_bit) != 0) {
+    return HeaderMap::Iterate::Continue;
+  }
+  match_context.seen_groups_ |= group_bit;
+
+  if (!set.matchGroup(set.groups_[it->second], &header)) {
+    match_context.matched_ = false;
+    return HeaderMap::Iterate::Break;
+  }
+
+  const uint64_t all_groups =
+      set.groups_.size() == MaxGroupsPerPass ? ~0ULL : (1ULL << set.groups_.size()) - 1;
+  return match_context.seen_groups_ == all_groups ? HeaderMap::Iterate::Break
+                                                  : HeaderMap::Iterate::Continue;
+}
+
+bool HeaderUtility::HeaderMatcherSet::matchGroup(const HeaderGroup& group,
+                                                 const HeaderEntry* header) const {
+  for (const HeaderData* header_data : group.header_data_) {
+    if (!matchHeader(header, *header_data)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool HeaderUtility::matchHeaders(const Http::HeaderMap& request_headers,
                                  const std::vector<HeaderData>& config_headers) {
   // TODO (rodaine): Should this really allow empty headers to always match?
@@ -80,8 +197,13 @@ bool HeaderUtility::matchHeaders(const Http::HeaderMap& request_headers,
 
 bool HeaderUtility::matchHeaders(const Http::HeaderMap& request_headers,
                                  const HeaderData& header_data) {
-  const Http::HeaderEntry* header = request_headers.get(header_data.name_);
+  if (header_data.inline_getter_ != nullptr) {
+    return matchHeader((request_headers.*header_data.inline_getter_)(), header_data);
+  }
+  return matchHeader(request_headers.get(header_data.name_), header_data);
+}
 
+bool HeaderUtility::matchHeader(const Http::HeaderEntry* header, const HeaderData& header_data) {
   if (header == nullptr) {
     return header_data.invert_match_ && header_data.header_match_type_ == HeaderMatchType::Present;
   }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <regex>
+#include <unordered_map>
 #include <vector>
 
 #include "envoy/api/v2/route/route.pb.h"
@@ -8,6 +9,12 @@
 #include "envoy/json/json_object.h"
 #include "envoy/type/range.pb.h"
 
+#include "common/common/non_copyable.h"
+#include "common/common/utility.h"
+#include "common/protobuf/protobuf.h"
+
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Http {
 
@@ -18,6 +25,9 @@ class HeaderUtility {
 public:
   enum class HeaderMatchType { Value, Regex, Range, Present, Prefix, Suffix };
 
+  // Accessor of one of the O(1) inline headers of a HeaderMap (see ALL_INLINE_HEADERS).
+  typedef const HeaderEntry* (HeaderMap::*InlineHeaderGetter)() const;
+
   // A HeaderData specifies one of exact value or regex or range element
   // to match in a request's header, specified in the header_match_type_ member.
   // It is the runtime equivalent of the HeaderMatchSpecifier proto in RDS API.
@@ -31,6 +41,54 @@ public:
     std::regex regex_pattern_;
     envoy::type::Int64Range range_;
     const bool invert_match_;
+    // The accessor of the header if it is one of the inline headers, so that matching reads its
+    // slot directly rather than scanning the header map. nullptr otherwise.
+    const InlineHeaderGetter inline_getter_;
+  };
+
+  /**
+   * A set of header conditions that must all match, compiled so that matching a header map costs
+   * a single pass over it. Conditions on inline headers read their slots directly, and the other
+   * headers the set references are resolved together by hashing the keys of the header map once,
+   * rather than scanning the map once per condition.
+   */
+  class HeaderMatcherSet : NonCopyable {
+  public:
+    HeaderMatcherSet(
+        const Protobuf::RepeatedPtrField<envoy::api::v2::route::HeaderMatcher>& config);
+
+    /**
+     * @param request_headers supplies the headers from the request.
+     * @return bool true if all the conditions of the set match the request_headers. An empty set
+     *         always matches.
+     */
+    bool matches(const Http::HeaderMap& request_headers) const;
+
+  private:
+    // The conditions on the headers with a given key, which is not one of the inline headers.
+    struct HeaderGroup {
+      const Http::LowerCaseString* name_;
+      std::vector<const HeaderData*> header_data_;
+    };
+
+    struct MatchContext {
+      const HeaderMatcherSet& set_;
+      uint64_t seen_groups_; // Bit i is set once the first header of groups_[i] is matched.
+      bool matched_;
+    };
+
+    // The groups are tracked in a bitmask during the pass over the header map, so larger sets
+    // fall back to a lookup per group.
+    static constexpr size_t MaxGroupsPerPass = 64;
+
+    static HeaderMap::Iterate matchGroupsCb(const HeaderEntry& header, void* context);
+    bool matchGroup(const HeaderGroup& group, const HeaderEntry* header) const;
+
+    std::vector<HeaderData> header_data_;
+    std::vector<const HeaderData*> inline_header_data_;
+    std::vector<HeaderGroup> groups_;
+    // Index of the groups_ by key.
+    std::unordered_map<absl::string_view, size_t, StringViewHash> group_index_;
   };
 
   /**
@@ -45,6 +103,14 @@ public:
 
   static bool matchHeaders(const Http::HeaderMap& request_headers, const HeaderData& config_header);
 
+  /**
+   * @param header supplies the first header of the request with the key of the config_header, or
+   *        nullptr if the request has none.
+   * @param config_header supplies the header condition.
+   * @return bool true if the header satisfies the config_header.
+   */
+  static bool matchHeader(const Http::HeaderEntry* header, const HeaderData& config_header);
+
   /**
    * Add headers from one HeaderMap to another
    * @param headers target where headers will be added
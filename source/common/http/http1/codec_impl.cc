@@ -12,19 +12,34 @@
 #include "common/common/utility.h"
 #include "common/http/exception.h"
 #include "common/http/headers.h"
+#include "common/http/http1/legacy_parser_impl.h"
+#include "common/http/http1/vectorized_parser_impl.h"
 #include "common/http/utility.h"
 
 namespace Envoy {
 namespace Http {
 namespace Http1 {
 
+namespace {
+// Shorter values are copied, as they fit in a HeaderString's inline storage anyway.
+constexpr size_t MinReferencedHeaderValueSize = 128;
+} // namespace
+
 const std::string StreamEncoderImpl::CRLF = "\r\n";
 const std::string StreamEncoderImpl::LAST_CHUNK = "0\r\n\r\n";
 
+uint64_t StreamEncoderImpl::serializedHeadersSize(const HeaderMap& headers) {
+  // Each header adds ": " and CRLF. The longest header added by the codec is
+  // "transfer-encoding: chunked\r\n", and the headers end with an empty line.
+  static const uint64_t codec_headers_size = Headers::get().TransferEncoding.get().size() +
+                                             Headers::get().TransferEncodingValues.Chunked.size() +
+                                             4 + 2;
+  return headers.byteSize() + 4 * headers.size() + codec_headers_size;
+}
+
 void StreamEncoderImpl::encodeHeader(const char* key, uint32_t key_size, const char* value,
                                      uint32_t value_size) {
-
-  connection_.reserveBuffer(key_size + value_size + 4);
+  // The space was reserved by the caller of encodeHeaders() with serializedHeadersSize().
   ASSERT(key_size > 0);
 
   connection_.copyToBuffer(key, key_size);
@@ -112,7 +127,6 @@ void StreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_stream)
     }
   }
 
-  connection_.reserveBuffer(2);
   connection_.addCharToBuffer('\r');
   connection_.addCharToBuffer('\n');
 
@@ -217,7 +231,13 @@ void ResponseStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end
   started_response_ = true;
   uint64_t numeric_status = Utility::getResponseStatus(headers);
 
-  connection_.reserveBuffer(4096);
+  const char* status_string = CodeUtility::toString(static_cast<Code>(numeric_status));
+  uint32_t status_string_len = strlen(status_string);
+
+  // The status line is the prefix, up to 20 digits of status code, a space, the reason phrase and
+  // CRLF.
+  connection_.reserveBuffer(sizeof(RESPONSE_PREFIX) - 1 + 20 + 1 + status_string_len + 2 +
+                            serializedHeadersSize(headers));
   if (connection_.protocol() == Protocol::Http10 && connection_.supports_http_10()) {
     connection_.copyToBuffer(HTTP_10_RESPONSE_PREFIX, sizeof(HTTP_10_RESPONSE_PREFIX) - 1);
   } else {
@@ -225,9 +245,6 @@ void ResponseStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end
   }
   connection_.addIntToBuffer(numeric_status);
   connection_.addCharToBuffer(' ');
-
-  const char* status_string = CodeUtility::toString(static_cast<Code>(numeric_status));
-  uint32_t status_string_len = strlen(status_string);
   connection_.copyToBuffer(status_string, status_string_len);
 
   connection_.addCharToBuffer('\r');
@@ -248,7 +265,8 @@ void RequestStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_
     head_request_ = true;
   }
   connection_.onEncodeHeaders(headers);
-  connection_.reserveBuffer(std::max(4096U, path->value().size() + 4096));
+  connection_.reserveBuffer(method->value().size() + 1 + path->value().size() +
+                            sizeof(REQUEST_POSTFIX) - 1 + serializedHeadersSize(headers));
   connection_.copyToBuffer(method->value().c_str(), method->value().size());
   connection_.addCharToBuffer(' ');
   connection_.copyToBuffer(path->value().c_str(), path->value().size());
@@ -257,50 +275,23 @@ void RequestStreamEncoderImpl::encodeHeaders(const HeaderMap& headers, bool end_
   StreamEncoderImpl::encodeHeaders(headers, end_stream);
 }
 
-http_parser_settings ConnectionImpl::settings_{
-    [](http_parser* parser) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onMessageBeginBase();
-      return 0;
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onUrl(at, length);
-      return 0;
-    },
-    nullptr, // on_status
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onHeaderField(at, length);
-      return 0;
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onHeaderValue(at, length);
-      return 0;
-    },
-    [](http_parser* parser) -> int {
-      return static_cast<ConnectionImpl*>(parser->data)->onHeadersCompleteBase();
-    },
-    [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onBody(at, length);
-      return 0;
-    },
-    [](http_parser* parser) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onMessageCompleteBase();
-      return 0;
-    },
-    nullptr, // on_chunk_header
-    nullptr  // on_chunk_complete
-};
-
 const ToLowerTable& ConnectionImpl::toLowerTable() {
   static ToLowerTable* table = new ToLowerTable();
   return *table;
 }
 
-ConnectionImpl::ConnectionImpl(Network::Connection& connection, http_parser_type type)
-    : connection_(connection), output_buffer_([&]() -> void { this->onBelowLowWatermark(); },
-                                              [&]() -> void { this->onAboveHighWatermark(); }) {
+ConnectionImpl::ConnectionImpl(Network::Connection& connection, MessageType type,
+                               bool use_vectorized_parser, bool reference_header_values)
+    : connection_(connection),
+      reference_header_values_(reference_header_values && !Buffer::OwnedImpl::usingOldImpl()),
+      output_buffer_([&]() -> void { this->onBelowLowWatermark(); },
+                     [&]() -> void { this->onAboveHighWatermark(); }) {
   output_buffer_.setWatermarks(connection.bufferLimit());
-  http_parser_init(&parser_, type);
-  parser_.data = this;
+  if (use_vectorized_parser) {
+    parser_.reset(new VectorizedParserImpl(type, parser_callbacks_));
+  } else {
+    parser_.reset(new LegacyHttpParserImpl(type, parser_callbacks_));
+  }
 }
 
 void ConnectionImpl::completeLastHeader() {
@@ -308,10 +299,21 @@ void ConnectionImpl::completeLastHeader() {
                  current_header_field_.c_str(), current_header_value_.c_str());
   if (!current_header_field_.empty()) {
     toLowerTable().toLowerCase(current_header_field_.buffer(), current_header_field_.size());
-    current_header_map_->addViaMove(std::move(current_header_field_),
-                                    std::move(current_header_value_));
+    if (current_header_value_ref_.data() != nullptr) {
+      // The parser is past the character following the value (CR, LF or whitespace), so it can be
+      // overwritten with the terminator. referenceHeaderValue() checked that the slice is writable.
+      const_cast<char*>(current_header_value_ref_.data())[current_header_value_ref_.size()] = 0;
+      HeaderString value;
+      value.setPinned(current_header_value_ref_.data(), current_header_value_ref_.size());
+      current_header_map_->addViaMove(std::move(current_header_field_), std::move(value));
+    } else {
+      current_header_map_->addViaMove(std::move(current_header_field_),
+                                      std::move(current_header_value_));
+    }
   }
 
+  current_header_value_ref_ = absl::string_view();
+
   header_parsing_state_ = HeaderParsingState::Field;
   ASSERT(current_header_field_.empty());
   ASSERT(current_header_value_.empty());
@@ -338,28 +340,38 @@ bool ConnectionImpl::maybeDirectDispatch(Buffer::Instance& data) {
 
 void ConnectionImpl::dispatch(Buffer::Instance& data) {
   ENVOY_CONN_LOG(trace, "parsing {} bytes", connection_, data.length());
+  // See Buffer::OwnedImpl::move() for why the static cast is safe.
+  current_buffer_ = &static_cast<const Buffer::OwnedImpl&>(data);
 
   if (maybeDirectDispatch(data)) {
     return;
   }
 
   // Always unpause before dispatch.
-  http_parser_pause(&parser_, 0);
+  parser_->resume();
 
   ssize_t total_parsed = 0;
   if (data.length() > 0) {
     uint64_t num_slices = data.getRawSlices(nullptr, 0);
     Buffer::RawSlice slices[num_slices];
     data.getRawSlices(slices, num_slices);
-    for (Buffer::RawSlice& slice : slices) {
-      total_parsed += dispatchSlice(static_cast<const char*>(slice.mem_), slice.len_);
+    try {
+      for (Buffer::RawSlice& slice : slices) {
+        total_parsed += dispatchSlice(static_cast<const char*>(slice.mem_), slice.len_);
+      }
+    } catch (const EnvoyException&) {
+      // Headers that were already decoded may still reference the data.
+      if (pinned_data_ != nullptr) {
+        drainParsed(data, data.length());
+      }
+      throw;
     }
   } else {
     dispatchSlice(nullptr, 0);
   }
 
   ENVOY_CONN_LOG(trace, "parsed {} bytes", connection_, total_parsed);
-  data.drain(total_parsed);
+  drainParsed(data, total_parsed);
 
   // If an upgrade has been handled and there is body data or early upgrade
   // payload to send on, send it on.
@@ -367,16 +379,45 @@ void ConnectionImpl::dispatch(Buffer::Instance& data) {
 }
 
 size_t ConnectionImpl::dispatchSlice(const char* slice, size_t len) {
-  ssize_t rc = http_parser_execute(&parser_, &settings_, slice, len);
-  if (HTTP_PARSER_ERRNO(&parser_) != HPE_OK && HTTP_PARSER_ERRNO(&parser_) != HPE_PAUSED) {
+  current_slice_ = slice;
+  current_slice_end_ = slice + len;
+  size_t rc = parser_->execute(slice, len);
+  if (parser_->hasError()) {
     sendProtocolError();
-    throw CodecProtocolException("http/1.1 protocol error: " +
-                                 std::string(http_errno_name(HTTP_PARSER_ERRNO(&parser_))));
+    throw CodecProtocolException("http/1.1 protocol error: " + std::string(parser_->errorName()));
   }
 
   return rc;
 }
 
+void ConnectionImpl::drainParsed(Buffer::Instance& data, uint64_t length) {
+  if (pinned_data_ == nullptr) {
+    data.drain(length);
+    return;
+  }
+
+  // See Buffer::OwnedImpl::move() for why the static cast is safe.
+  pinned_data_->pin(static_cast<Buffer::OwnedImpl&>(data), length);
+  pinned_data_.reset();
+}
+
+bool ConnectionImpl::referenceHeaderValue(const char* data, size_t length) {
+  // The character following the value must be in the same slice, to be replaced by the
+  // terminator, and the slice must own its storage (e.g. not be a buffer fragment).
+  if (!reference_header_values_ || length < MinReferencedHeaderValueSize ||
+      data < current_slice_ || data + length >= current_slice_end_ ||
+      !current_buffer_->writable(data)) {
+    return false;
+  }
+
+  if (pinned_data_ == nullptr) {
+    pinned_data_ = std::make_shared<Buffer::OwnedImpl>();
+  }
+  current_header_map_->pin(pinned_data_);
+  current_header_value_ref_ = absl::string_view(data, length);
+  return true;
+}
+
 void ConnectionImpl::onHeaderField(const char* data, size_t length) {
   if (header_parsing_state_ == HeaderParsingState::Done) {
     // Ignore trailers.
@@ -397,13 +438,22 @@ void ConnectionImpl::onHeaderValue(const char* data, size_t length) {
   }
 
   header_parsing_state_ = HeaderParsingState::Value;
+  if (current_header_value_ref_.data() != nullptr) {
+    // The value is split across callbacks, so copy it after all.
+    current_header_value_.append(current_header_value_ref_.data(),
+                                 current_header_value_ref_.size());
+    current_header_value_ref_ = absl::string_view();
+  } else if (current_header_value_.empty() && referenceHeaderValue(data, length)) {
+    return;
+  }
+
   current_header_value_.append(data, length);
 }
 
 int ConnectionImpl::onHeadersCompleteBase() {
   ENVOY_CONN_LOG(trace, "headers complete", connection_);
   completeLastHeader();
-  if (!(parser_.http_major == 1 && parser_.http_minor == 1)) {
+  if (!parser_->isHttp11()) {
     // This is not necessarily true, but it's good enough since higher layers only care if this is
     // HTTP/1.1 or not.
     protocol_ = Protocol::Http10;
@@ -417,7 +467,7 @@ int ConnectionImpl::onHeadersCompleteBase() {
   current_header_map_.reset();
   header_parsing_state_ = HeaderParsingState::Done;
 
-  // Returning 2 informs http_parser to not expect a body or further data on this connection.
+  // Returning 2 informs the parser to not expect a body or further data on this connection.
   return handling_upgrade_ ? 2 : rc;
 }
 
@@ -428,7 +478,7 @@ void ConnectionImpl::onMessageCompleteBase() {
     // upgrade payload will be treated as stream body.
     ASSERT(!deferred_end_stream_headers_);
     ENVOY_CONN_LOG(trace, "Pausing parser due to upgrade.", connection_);
-    http_parser_pause(&parser_, 1);
+    parser_->pause();
     return;
   }
   onMessageComplete();
@@ -437,7 +487,7 @@ void ConnectionImpl::onMessageCompleteBase() {
 void ConnectionImpl::onMessageBeginBase() {
   ENVOY_CONN_LOG(trace, "message begin", connection_);
   ASSERT(!current_header_map_);
-  current_header_map_.reset(new HeaderMapImpl());
+  current_header_map_.reset(new ReceivedHeaderMapImpl());
   header_parsing_state_ = HeaderParsingState::Field;
   onMessageBegin();
 }
@@ -451,7 +501,9 @@ void ConnectionImpl::onResetStreamBase(StreamResetReason reason) {
 ServerConnectionImpl::ServerConnectionImpl(Network::Connection& connection,
                                            ServerConnectionCallbacks& callbacks,
                                            Http1Settings settings)
-    : ConnectionImpl(connection, HTTP_REQUEST), callbacks_(callbacks), codec_settings_(settings) {}
+    : ConnectionImpl(connection, MessageType::Request, settings.use_vectorized_parser_,
+                     settings.reference_header_values_),
+      callbacks_(callbacks), codec_settings_(settings) {}
 
 void ServerConnectionImpl::onEncodeComplete() {
   ASSERT(active_request_);
@@ -545,15 +597,15 @@ int ServerConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
   // to disconnect the connection but we shouldn't fire any more events since it doesn't make
   // sense.
   if (active_request_) {
-    const char* method_string = http_method_str(static_cast<http_method>(parser_.method));
+    const char* method_string = http_method_str(parser_->method());
 
     // Inform the response encoder about any HEAD method, so it can set content
     // length and transfer encoding headers correctly.
-    active_request_->response_encoder_.isResponseToHeadRequest(parser_.method == HTTP_HEAD);
+    active_request_->response_encoder_.isResponseToHeadRequest(parser_->method() == HTTP_HEAD);
 
     // Currently, CONNECT is not supported, however; http_parser_parse_url needs to know about
     // CONNECT
-    handlePath(*headers, parser_.method);
+    handlePath(*headers, parser_->method());
     ASSERT(active_request_->request_url_.empty());
 
     headers->insertMethod().value(method_string, strlen(method_string));
@@ -564,14 +616,15 @@ int ServerConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
     // with message complete. This allows upper layers to behave like HTTP/2 and prevents a proxy
     // scenario where the higher layers stream through and implicitly switch to chunked transfer
     // encoding because end stream with zero body length has not yet been indicated.
-    if (parser_.flags & F_CHUNKED ||
-        (parser_.content_length > 0 && parser_.content_length != ULLONG_MAX) || handling_upgrade_) {
+    if (parser_->isChunked() ||
+        (parser_->contentLength() > 0 && parser_->contentLength() != ULLONG_MAX) ||
+        handling_upgrade_) {
       active_request_->request_decoder_->decodeHeaders(std::move(headers), false);
 
       // If the connection has been closed (or is closing) after decoding headers, pause the parser
       // so we return control to the caller.
       if (connection_.state() != Network::Connection::State::Open) {
-        http_parser_pause(&parser_, 1);
+        parser_->pause();
       }
 
     } else {
@@ -622,7 +675,7 @@ void ServerConnectionImpl::onMessageComplete() {
   // Always pause the parser so that the calling code can process 1 request at a time and apply
   // back pressure. However this means that the calling code needs to detect if there is more data
   // in the buffer and dispatch it again.
-  http_parser_pause(&parser_, 1);
+  parser_->pause();
 }
 
 void ServerConnectionImpl::onResetStream(StreamResetReason reason) {
@@ -657,11 +710,11 @@ void ServerConnectionImpl::onBelowLowWatermark() {
 }
 
 ClientConnectionImpl::ClientConnectionImpl(Network::Connection& connection, ConnectionCallbacks&)
-    : ConnectionImpl(connection, HTTP_RESPONSE) {}
+    : ConnectionImpl(connection, MessageType::Response, false, false) {}
 
 bool ClientConnectionImpl::cannotHaveBody() {
   if ((!pending_responses_.empty() && pending_responses_.front().head_request_) ||
-      parser_.status_code == 204 || parser_.status_code == 304) {
+      parser_->statusCode() == 204 || parser_->statusCode() == 304) {
     return true;
   } else {
     return false;
@@ -691,7 +744,7 @@ void ClientConnectionImpl::onEncodeHeaders(const HeaderMap& headers) {
 }
 
 int ClientConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
-  headers->insertStatus().value(parser_.status_code);
+  headers->insertStatus().value(parser_->statusCode());
 
   // Handle the case where the client is closing a kept alive connection (by sending a 408
   // with a 'Connection: close' header). In this case we just let response flush out followed
@@ -699,7 +752,7 @@ int ClientConnectionImpl::onHeadersComplete(HeaderMapImplPtr&& headers) {
   if (pending_responses_.empty() && !resetStreamCalled()) {
     throw PrematureResponseException(std::move(headers));
   } else if (!pending_responses_.empty()) {
-    if (parser_.status_code == 100) {
+    if (parser_->statusCode() == 100) {
       // http-parser treats 100 continue headers as their own complete response.
       // Swallow the spurious onMessageComplete and continue processing.
       ignore_message_complete_for_100_continue_ = true;
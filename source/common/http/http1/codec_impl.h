@@ -1,22 +1,25 @@
 #pragma once
 
-#include <http_parser.h>
-
 #include <array>
 #include <cstdint>
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/http/codec.h"
 #include "envoy/network/connection.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/buffer/watermark_buffer.h"
 #include "common/common/assert.h"
 #include "common/common/to_lower_table.h"
 #include "common/http/codec_helper.h"
 #include "common/http/codes.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/http1/parser.h"
+
+#include "absl/strings/string_view.h"
 
 namespace Envoy {
 namespace Http {
@@ -24,6 +27,28 @@ namespace Http1 {
 
 class ConnectionImpl;
 
+/**
+ * Header map for a received message. Values may be pinned references into the data read from the
+ * connection (see Http1Settings::reference_header_values_), in which case the map keeps the
+ * buffer slices holding them alive.
+ */
+class ReceivedHeaderMapImpl : public HeaderMapImpl {
+public:
+  /**
+   * Keep data alive for the lifetime of the map.
+   */
+  void pin(const std::shared_ptr<Buffer::OwnedImpl>& data) {
+    if (pinned_data_.empty() || pinned_data_.back() != data) {
+      pinned_data_.push_back(data);
+    }
+  }
+
+private:
+  std::vector<std::shared_ptr<Buffer::OwnedImpl>> pinned_data_;
+};
+
+typedef std::unique_ptr<ReceivedHeaderMapImpl> ReceivedHeaderMapImplPtr;
+
 /**
  * Base class for HTTP/1.1 request and response encoders.
  */
@@ -45,12 +70,20 @@ public:
   void resetStream(StreamResetReason reason) override;
   void readDisable(bool disable) override;
   uint32_t bufferLimit() override;
+  void setPriorityWeight(uint32_t) override {}
 
   void isResponseToHeadRequest(bool value) { is_response_to_head_request_ = value; }
 
 protected:
   StreamEncoderImpl(ConnectionImpl& connection) : connection_(connection) {}
 
+  /**
+   * @return an upper bound of the size of the headers serialized by encodeHeaders(), including the
+   *         headers added by the codec and the empty line ending them. Callers reserve it along
+   *         with the start line, so that the whole header block is copied into a single slice.
+   */
+  static uint64_t serializedHeadersSize(const HeaderMap& headers);
+
   static const std::string CRLF;
   static const std::string LAST_CHUNK;
 
@@ -162,12 +195,13 @@ public:
   bool maybeDirectDispatch(Buffer::Instance& data);
 
 protected:
-  ConnectionImpl(Network::Connection& connection, http_parser_type type);
+  ConnectionImpl(Network::Connection& connection, MessageType type, bool use_vectorized_parser,
+                 bool reference_header_values);
 
   bool resetStreamCalled() { return reset_stream_called_; }
 
   Network::Connection& connection_;
-  http_parser parser_;
+  ParserPtr parser_;
   HeaderMapPtr deferred_end_stream_headers_;
   Http::Code error_code_{Http::Code::BadRequest};
   bool handling_upgrade_{};
@@ -175,6 +209,30 @@ protected:
 private:
   enum class HeaderParsingState { Field, Value, Done };
 
+  /**
+   * Forwards parser callbacks to the connection.
+   */
+  class ParserCallbacksImpl : public ParserCallbacks {
+  public:
+    ParserCallbacksImpl(ConnectionImpl& parent) : parent_(parent) {}
+
+    // Http1::ParserCallbacks
+    void onMessageBegin() override { parent_.onMessageBeginBase(); }
+    void onUrl(const char* data, size_t length) override { parent_.onUrl(data, length); }
+    void onHeaderField(const char* data, size_t length) override {
+      parent_.onHeaderField(data, length);
+    }
+    void onHeaderValue(const char* data, size_t length) override {
+      parent_.onHeaderValue(data, length);
+    }
+    int onHeadersComplete() override { return parent_.onHeadersCompleteBase(); }
+    void onBody(const char* data, size_t length) override { parent_.onBody(data, length); }
+    void onMessageComplete() override { parent_.onMessageCompleteBase(); }
+
+  private:
+    ConnectionImpl& parent_;
+  };
+
   /**
    * Called in order to complete an in progress header decode.
    */
@@ -187,6 +245,22 @@ private:
    */
   size_t dispatchSlice(const char* slice, size_t len);
 
+  /**
+   * Drain data that has been parsed, handing it over to pinned_data_ instead if any header values
+   * reference it.
+   * @param data supplies the dispatched data.
+   * @param length supplies the number of bytes parsed.
+   */
+  void drainParsed(Buffer::Instance& data, uint64_t length);
+
+  /**
+   * Reference a header value in the slice being dispatched instead of copying it, if possible.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   * @return whether the value is referenced.
+   */
+  bool referenceHeaderValue(const char* data, size_t length);
+
   /**
    * Called when a request/response is beginning. A base routine happens first then a virtual
    * dispatch is invoked.
@@ -258,13 +332,23 @@ private:
    */
   virtual void onBelowLowWatermark() PURE;
 
-  static http_parser_settings settings_;
   static const ToLowerTable& toLowerTable();
 
-  HeaderMapImplPtr current_header_map_;
+  ParserCallbacksImpl parser_callbacks_{*this};
+  ReceivedHeaderMapImplPtr current_header_map_;
   HeaderParsingState header_parsing_state_{HeaderParsingState::Field};
   HeaderString current_header_field_;
   HeaderString current_header_value_;
+  // Set instead of current_header_value_ while the value is referenced in the dispatched data.
+  absl::string_view current_header_value_ref_;
+  const bool reference_header_values_;
+  // The slice being dispatched.
+  const char* current_slice_{};
+  const char* current_slice_end_{};
+  // The buffer being dispatched. Values in its read-only slices are copied rather than referenced.
+  const Buffer::OwnedImpl* current_buffer_{};
+  // Receives the dispatched data once parsed, if header values reference it.
+  std::shared_ptr<Buffer::OwnedImpl> pinned_data_;
   bool reset_stream_called_{};
   Buffer::WatermarkBuffer output_buffer_;
   Buffer::RawSlice reserved_iovec_;
@@ -1,5 +1,6 @@
 #include "common/http/http1/conn_pool.h"
 
+#include <cmath>
 #include <cstdint>
 #include <list>
 
@@ -88,6 +89,7 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_dec
     ready_clients_.front()->moveBetweenLists(ready_clients_, busy_clients_);
     ENVOY_CONN_LOG(debug, "using existing connection", *busy_clients_.front()->codec_client_);
     attachRequestToClient(*busy_clients_.front(), response_decoder, callbacks);
+    tryPrefetch();
     return nullptr;
   }
 
@@ -104,8 +106,12 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_dec
     }
 
     ENVOY_LOG(debug, "queueing request due to no available connections");
+    if (pending_requests_.empty()) {
+      pending_requests_nonempty_since_ = dispatcher_.timeSystem().monotonicTime();
+    }
     PendingRequestPtr pending_request(new PendingRequest(*this, response_decoder, callbacks));
     pending_request->moveIntoList(std::move(pending_request), pending_requests_);
+    tryPrefetch();
     return pending_requests_.front().get();
   } else {
     ENVOY_LOG(debug, "max pending requests overflow");
@@ -115,6 +121,17 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_dec
   }
 }
 
+void ConnPoolImpl::failExpiredRequests(std::list<PendingRequestPtr>& expired) {
+  // Requests are only failed once the pool is consistent again, as the callbacks may create new
+  // streams.
+  while (!expired.empty()) {
+    PendingRequestPtr request = expired.front()->removeFromList(expired);
+    ENVOY_LOG(debug, "dropping request pending for too long");
+    host_->cluster().stats().upstream_rq_pending_dropped_.inc();
+    request->callbacks_.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
+  }
+}
+
 void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
@@ -226,32 +243,66 @@ void ConnPoolImpl::onResponseComplete(ActiveClient& client) {
 
 void ConnPoolImpl::onUpstreamReady() {
   upstream_ready_enabled_ = false;
-  while (!pending_requests_.empty() && !ready_clients_.empty()) {
+  std::list<PendingRequestPtr> expired;
+  while (!ready_clients_.empty()) {
+    PendingRequestPtr request = popPendingRequest(expired);
+    if (!request) {
+      break;
+    }
+
+    // There is work to do so bind a request to the client and move it to the busy list.
     ActiveClient& client = *ready_clients_.front();
     ENVOY_CONN_LOG(debug, "attaching to next request", *client.codec_client_);
-    // There is work to do so bind a request to the client and move it to the busy list. Pending
-    // requests are pushed onto the front, so pull from the back.
-    attachRequestToClient(client, pending_requests_.back()->decoder_,
-                          pending_requests_.back()->callbacks_);
-    pending_requests_.pop_back();
+    attachRequestToClient(client, request->decoder_, request->callbacks_);
     client.moveBetweenLists(ready_clients_, busy_clients_);
   }
+
+  failExpiredRequests(expired);
+}
+
+ConnPoolImpl::PendingRequestPtr
+ConnPoolImpl::popPendingRequest(std::list<PendingRequestPtr>& expired) {
+  // Pending requests are pushed onto the front, so the oldest request is at the back.
+  const absl::optional<Upstream::PendingRequestQueueConfig>& queue_config =
+      host_->cluster().pendingRequestQueue();
+  if (!queue_config.has_value()) {
+    return pending_requests_.empty() ? nullptr
+                                     : pending_requests_.back()->removeFromList(pending_requests_);
+  }
+
+  // As in CoDel, a queue that drains within an interval only absorbs a burst, and is served in
+  // order. A queue that has not drained for an interval is a standing queue, whose oldest requests
+  // are unlikely to complete in time. Only requests that waited less than the target delay are then
+  // served, newest first.
+  const MonotonicTime now = dispatcher_.timeSystem().monotonicTime();
+  if (pending_requests_.empty() ||
+      now - pending_requests_nonempty_since_ <= queue_config->interval_) {
+    return pending_requests_.empty() ? nullptr
+                                     : pending_requests_.back()->removeFromList(pending_requests_);
+  }
+
+  while (!pending_requests_.empty() &&
+         now - pending_requests_.back()->enqueue_time_ > queue_config->target_delay_) {
+    PendingRequestPtr request = pending_requests_.back()->removeFromList(pending_requests_);
+    request->moveIntoListBack(std::move(request), expired);
+  }
+  return pending_requests_.empty() ? nullptr
+                                   : pending_requests_.front()->removeFromList(pending_requests_);
 }
 
 void ConnPoolImpl::processIdleClient(ActiveClient& client, bool delay) {
   client.stream_wrapper_.reset();
-  if (pending_requests_.empty() || delay) {
+  std::list<PendingRequestPtr> expired;
+  PendingRequestPtr request = delay ? nullptr : popPendingRequest(expired);
+  if (!request) {
     // There is nothing to service or delayed processing is requested, so just move the connection
     // into the ready list.
     ENVOY_CONN_LOG(debug, "moving to ready", *client.codec_client_);
     client.moveBetweenLists(busy_clients_, ready_clients_);
   } else {
     // There is work to do immediately so bind a request to the client and move it to the busy list.
-    // Pending requests are pushed onto the front, so pull from the back.
     ENVOY_CONN_LOG(debug, "attaching to next request", *client.codec_client_);
-    attachRequestToClient(client, pending_requests_.back()->decoder_,
-                          pending_requests_.back()->callbacks_);
-    pending_requests_.pop_back();
+    attachRequestToClient(client, request->decoder_, request->callbacks_);
   }
 
   if (delay && !pending_requests_.empty() && !upstream_ready_enabled_) {
@@ -259,9 +310,27 @@ void ConnPoolImpl::processIdleClient(ActiveClient& client, bool delay) {
     upstream_ready_timer_->enableTimer(std::chrono::milliseconds(0));
   }
 
+  failExpiredRequests(expired);
   checkForDrained();
 }
 
+void ConnPoolImpl::tryPrefetch() {
+  const float prefetch_ratio = host_->cluster().prefetchRatio();
+  // Connections opened while draining would only be closed again once they connect.
+  if (prefetch_ratio <= 1 || !drained_callbacks_.empty()) {
+    return;
+  }
+
+  const uint64_t target =
+      std::ceil(prefetch_ratio * (num_active_requests_ + pending_requests_.size()));
+  while (ready_clients_.size() + busy_clients_.size() < target &&
+         host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    ENVOY_LOG(debug, "prefetching a connection");
+    host_->cluster().stats().upstream_cx_prefetch_.inc();
+    createNewConnection();
+  }
+}
+
 ConnPoolImpl::StreamWrapper::StreamWrapper(StreamDecoder& response_decoder, ActiveClient& parent)
     : StreamEncoderWrapper(parent.codec_client_->newStream(*this)),
       StreamDecoderWrapper(response_decoder), parent_(parent) {
@@ -269,9 +338,11 @@ ConnPoolImpl::StreamWrapper::StreamWrapper(StreamDecoder& response_decoder, Acti
   StreamEncoderWrapper::inner_.getStream().addCallbacks(*this);
   parent_.parent_.host_->cluster().stats().upstream_rq_active_.inc();
   parent_.parent_.host_->stats().rq_active_.inc();
+  parent_.parent_.num_active_requests_++;
 }
 
 ConnPoolImpl::StreamWrapper::~StreamWrapper() {
+  parent_.parent_.num_active_requests_--;
   parent_.parent_.host_->cluster().stats().upstream_rq_active_.dec();
   parent_.parent_.host_->stats().rq_active_.dec();
 }
@@ -296,7 +367,8 @@ void ConnPoolImpl::StreamWrapper::onDecodeComplete() {
 
 ConnPoolImpl::PendingRequest::PendingRequest(ConnPoolImpl& parent, StreamDecoder& decoder,
                                              ConnectionPool::Callbacks& callbacks)
-    : parent_(parent), decoder_(decoder), callbacks_(callbacks) {
+    : parent_(parent), decoder_(decoder), callbacks_(callbacks),
+      enqueue_time_(parent.dispatcher_.timeSystem().monotonicTime()) {
   parent_.host_->cluster().stats().upstream_rq_pending_total_.inc();
   parent_.host_->cluster().stats().upstream_rq_pending_active_.inc();
   parent_.host_->cluster().resourceManager(parent_.priority_).pendingRequests().inc();
@@ -334,7 +406,11 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
        parent_.host_->cluster().stats().upstream_cx_rx_bytes_buffered_,
        parent_.host_->cluster().stats().upstream_cx_tx_bytes_total_,
        parent_.host_->cluster().stats().upstream_cx_tx_bytes_buffered_,
-       &parent_.host_->cluster().stats().bind_errors_});
+       &parent_.host_->cluster().stats().bind_errors_,
+       &parent_.host_->cluster().stats().upstream_cx_read_budget_exhausted_,
+       &parent_.host_->cluster().stats().upstream_cx_tx_buffer_above_high_watermark_ms_,
+       &parent_.host_->cluster().stats().upstream_cx_connect_fallback_,
+       &parent_.host_->cluster().stats().upstream_cx_tfo_syn_data_acked_});
 }
 
 ConnPoolImpl::ActiveClient::~ActiveClient() {
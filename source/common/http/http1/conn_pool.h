@@ -4,6 +4,7 @@
 #include <list>
 #include <memory>
 
+#include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/event/timer.h"
 #include "envoy/http/conn_pool.h"
@@ -109,6 +110,7 @@ protected:
     ConnPoolImpl& parent_;
     StreamDecoder& decoder_;
     ConnectionPool::Callbacks& callbacks_;
+    const MonotonicTime enqueue_time_;
   };
 
   typedef std::unique_ptr<PendingRequest> PendingRequestPtr;
@@ -118,12 +120,25 @@ protected:
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   void checkForDrained();
   void createNewConnection();
+  void failExpiredRequests(std::list<PendingRequestPtr>& expired);
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onDownstreamReset(ActiveClient& client);
   void onPendingRequestCancel(PendingRequest& request);
   void onResponseComplete(ActiveClient& client);
   void onUpstreamReady();
+  /**
+   * Remove the next pending request to serve. If the cluster bounds the time requests wait, the
+   * requests that waited too long are moved to expired instead, and the most recent request is
+   * served first while the pool is overloaded.
+   * @return the request to serve, or nullptr if there is none.
+   */
+  PendingRequestPtr popPendingRequest(std::list<PendingRequestPtr>& expired);
   void processIdleClient(ActiveClient& client, bool delay);
+  /**
+   * Create connections until there are as many as the cluster's prefetch ratio of the requests
+   * being served or queued.
+   */
+  void tryPrefetch();
 
   Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
@@ -131,11 +146,16 @@ protected:
   std::list<ActiveClientPtr> ready_clients_;
   std::list<ActiveClientPtr> busy_clients_;
   std::list<PendingRequestPtr> pending_requests_;
+  // When a request was last queued while pending_requests_ was empty, that is since when the queue
+  // has not drained.
+  MonotonicTime pending_requests_nonempty_since_;
   std::list<DrainedCb> drained_callbacks_;
   Upstream::ResourcePriority priority_;
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
   Event::TimerPtr upstream_ready_timer_;
   bool upstream_ready_enabled_{false};
+  // Requests attached to clients, used with the pending requests to size prefetching.
+  uint64_t num_active_requests_{};
 };
 
 /**
@@ -0,0 +1,60 @@
+#include "common/http/http1/legacy_parser_impl.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+http_parser_settings LegacyHttpParserImpl::settings_{
+    [](http_parser* parser) -> int {
+      static_cast<LegacyHttpParserImpl*>(parser->data)->callbacks_.onMessageBegin();
+      return 0;
+    },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      static_cast<LegacyHttpParserImpl*>(parser->data)->callbacks_.onUrl(at, length);
+      return 0;
+    },
+    nullptr, // on_status
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      static_cast<LegacyHttpParserImpl*>(parser->data)->callbacks_.onHeaderField(at, length);
+      return 0;
+    },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      static_cast<LegacyHttpParserImpl*>(parser->data)->callbacks_.onHeaderValue(at, length);
+      return 0;
+    },
+    [](http_parser* parser) -> int {
+      return static_cast<LegacyHttpParserImpl*>(parser->data)->callbacks_.onHeadersComplete();
+    },
+    [](http_parser* parser, const char* at, size_t length) -> int {
+      static_cast<LegacyHttpParserImpl*>(parser->data)->callbacks_.onBody(at, length);
+      return 0;
+    },
+    [](http_parser* parser) -> int {
+      static_cast<LegacyHttpParserImpl*>(parser->data)->callbacks_.onMessageComplete();
+      return 0;
+    },
+    nullptr, // on_chunk_header
+    nullptr  // on_chunk_complete
+};
+
+LegacyHttpParserImpl::LegacyHttpParserImpl(MessageType type, ParserCallbacks& callbacks)
+    : callbacks_(callbacks) {
+  http_parser_init(&parser_, type == MessageType::Request ? HTTP_REQUEST : HTTP_RESPONSE);
+  parser_.data = this;
+}
+
+size_t LegacyHttpParserImpl::execute(const char* data, size_t length) {
+  return http_parser_execute(&parser_, &settings_, data, length);
+}
+
+bool LegacyHttpParserImpl::hasError() const {
+  return HTTP_PARSER_ERRNO(&parser_) != HPE_OK && HTTP_PARSER_ERRNO(&parser_) != HPE_PAUSED;
+}
+
+const char* LegacyHttpParserImpl::errorName() const {
+  return http_errno_name(HTTP_PARSER_ERRNO(&parser_));
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
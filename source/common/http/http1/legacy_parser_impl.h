@@ -0,0 +1,39 @@
+#pragma once
+
+#include <http_parser.h>
+
+#include "common/http/http1/parser.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Parser implementation backed by the http_parser library.
+ */
+class LegacyHttpParserImpl : public Parser {
+public:
+  LegacyHttpParserImpl(MessageType type, ParserCallbacks& callbacks);
+
+  // Http1::Parser
+  size_t execute(const char* data, size_t length) override;
+  void pause() override { http_parser_pause(&parser_, 1); }
+  void resume() override { http_parser_pause(&parser_, 0); }
+  bool hasError() const override;
+  const char* errorName() const override;
+  http_method method() const override { return static_cast<http_method>(parser_.method); }
+  uint16_t statusCode() const override { return parser_.status_code; }
+  bool isHttp11() const override { return parser_.http_major == 1 && parser_.http_minor == 1; }
+  bool isChunked() const override { return parser_.flags & F_CHUNKED; }
+  uint64_t contentLength() const override { return parser_.content_length; }
+
+private:
+  static http_parser_settings settings_;
+
+  http_parser parser_;
+  ParserCallbacks& callbacks_;
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <http_parser.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Callbacks invoked by a Parser as it makes progress through an HTTP/1 message. Data pointers are
+ * only valid for the duration of the callback. A parser may deliver a URL, header field or header
+ * value in multiple fragments; the end of a field is signaled by the start of its value.
+ */
+class ParserCallbacks {
+public:
+  virtual ~ParserCallbacks() {}
+
+  /**
+   * Called when the first byte of a request/response is received.
+   */
+  virtual void onMessageBegin() PURE;
+
+  /**
+   * Called when URL data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onUrl(const char* data, size_t length) PURE;
+
+  /**
+   * Called when header field data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onHeaderField(const char* data, size_t length) PURE;
+
+  /**
+   * Called when header value data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onHeaderValue(const char* data, size_t length) PURE;
+
+  /**
+   * Called when headers are complete.
+   * @return 0 if no error, 1 if there should be no body, 2 if there should be no body or further
+   *         messages on this connection (upgrade).
+   */
+  virtual int onHeadersComplete() PURE;
+
+  /**
+   * Called when body data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void onBody(const char* data, size_t length) PURE;
+
+  /**
+   * Called when the request/response is complete.
+   */
+  virtual void onMessageComplete() PURE;
+};
+
+enum class MessageType { Request, Response };
+
+/**
+ * An incremental HTTP/1 message parser. The message state accessors (method(), statusCode(), etc.)
+ * are valid from onHeadersComplete() until the start of the next message.
+ */
+class Parser {
+public:
+  virtual ~Parser() {}
+
+  /**
+   * Parse a span of data.
+   * @param data supplies the start address.
+   * @param length supplies the length. A zero length signals the end of the input.
+   * @return size_t the number of bytes consumed. This is less than length if the parser was
+   *         paused from within a callback or an error occurred.
+   */
+  virtual size_t execute(const char* data, size_t length) PURE;
+
+  /**
+   * Pause the parser. When called from within a callback the current execute() returns after
+   * that callback, and subsequent calls consume nothing until resume() is called.
+   */
+  virtual void pause() PURE;
+
+  /**
+   * Resume a paused parser.
+   */
+  virtual void resume() PURE;
+
+  /**
+   * @return bool whether a protocol error has occurred. Pausing is not an error.
+   */
+  virtual bool hasError() const PURE;
+
+  /**
+   * @return const char* the http_parser compatible name of the current error (e.g. HPE_OK).
+   */
+  virtual const char* errorName() const PURE;
+
+  /**
+   * @return http_method the request method.
+   */
+  virtual http_method method() const PURE;
+
+  /**
+   * @return uint16_t the response status code.
+   */
+  virtual uint16_t statusCode() const PURE;
+
+  /**
+   * @return bool whether the message is HTTP/1.1.
+   */
+  virtual bool isHttp11() const PURE;
+
+  /**
+   * @return bool whether the message body uses chunked transfer encoding.
+   */
+  virtual bool isChunked() const PURE;
+
+  /**
+   * @return uint64_t the value of the content-length header, or ULLONG_MAX if there is none.
+   */
+  virtual uint64_t contentLength() const PURE;
+};
+
+typedef std::unique_ptr<Parser> ParserPtr;
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,822 @@
+#include "common/http/http1/vectorized_parser_impl.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+constexpr size_t VectorizedParserImpl::MaxHeaderSize;
+
+namespace {
+
+struct MethodEntry {
+  absl::string_view name_;
+  http_method method_;
+};
+
+const MethodEntry Methods[] = {
+#define METHOD_ENTRY(num, name, string) {#string, HTTP_##name},
+    HTTP_METHOD_MAP(METHOD_ENTRY)
+#undef METHOD_ENTRY
+};
+
+// All methods are shorter than this, so a longer method token is rejected without a table scan.
+constexpr size_t MaxMethodLength = 16;
+
+bool lookupMethod(absl::string_view token, http_method& method) {
+  for (const MethodEntry& entry : Methods) {
+    if (entry.name_ == token) {
+      method = entry.method_;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isMethodPrefix(absl::string_view token) {
+  for (const MethodEntry& entry : Methods) {
+    if (absl::StartsWith(entry.name_, token)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * RFC 7230 tchar lookup table.
+ */
+class TokenTable {
+public:
+  TokenTable() {
+    for (int c = 0; c < 256; c++) {
+      table_[c] = absl::ascii_isalnum(c) || std::strchr("!#$%&'*+-.^_`|~", c) != nullptr;
+    }
+    // strchr() matches the terminating NUL.
+    table_[0] = false;
+  }
+
+  bool isToken(char c) const { return table_[static_cast<uint8_t>(c)]; }
+
+private:
+  std::array<bool, 256> table_;
+};
+
+const TokenTable& tokenTable() {
+  static TokenTable* table = new TokenTable();
+  return *table;
+}
+
+/**
+ * Find the first byte in [p, end) that is a control character, DEL or, if StopAtSpace, SP.
+ * Horizontal tab is only a match if AllowTab is false. Bytes with the high bit set never match.
+ */
+template <bool StopAtSpace, bool AllowTab> const char* findControl(const char* p, const char* end) {
+  constexpr char max_control = StopAtSpace ? ' ' : '\x1f';
+#if defined(__AVX2__)
+  {
+    const __m256i max_control_v = _mm256_set1_epi8(max_control);
+    const __m256i tab_v = _mm256_set1_epi8('\t');
+    const __m256i del_v = _mm256_set1_epi8('\x7f');
+    for (; end - p >= 32; p += 32) {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+      // Unsigned v <= max_control.
+      __m256i match = _mm256_cmpeq_epi8(_mm256_min_epu8(v, max_control_v), v);
+      if (AllowTab) {
+        match = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab_v), match);
+      }
+      match = _mm256_or_si256(match, _mm256_cmpeq_epi8(v, del_v));
+      const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(match));
+      if (mask != 0) {
+        return p + __builtin_ctz(mask);
+      }
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    const __m128i max_control_v = _mm_set1_epi8(max_control);
+    const __m128i tab_v = _mm_set1_epi8('\t');
+    const __m128i del_v = _mm_set1_epi8('\x7f');
+    for (; end - p >= 16; p += 16) {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      __m128i match = _mm_cmpeq_epi8(_mm_min_epu8(v, max_control_v), v);
+      if (AllowTab) {
+        match = _mm_andnot_si128(_mm_cmpeq_epi8(v, tab_v), match);
+      }
+      match = _mm_or_si128(match, _mm_cmpeq_epi8(v, del_v));
+      const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(match));
+      if (mask != 0) {
+        return p + __builtin_ctz(mask);
+      }
+    }
+  }
+#endif
+  for (; p != end; p++) {
+    const uint8_t c = static_cast<uint8_t>(*p);
+    if ((c <= static_cast<uint8_t>(max_control) && !(AllowTab && c == '\t')) || c == 0x7f) {
+      return p;
+    }
+  }
+  return end;
+}
+
+/**
+ * Find the first byte in [p, end) that is not a tchar.
+ */
+const char* findNonToken(const char* p, const char* end) {
+  const TokenTable& table = tokenTable();
+#if defined(__SSE4_2__)
+  // Byte ranges that are not tchars. '|' (0x7c) and '~' (0x7e) fall into the last range to keep
+  // the set within eight ranges, so matches are confirmed with the table.
+  static const char ranges[16] = {'\x00', ' ', '"', '"', '(', ')', ',', ',',
+                                  '/',    '/', ':', '@', '[', ']', '{', '\xff'};
+  const __m128i ranges_v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ranges));
+  while (end - p >= 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const int index = _mm_cmpestri(ranges_v, 16, v, 16,
+                                   _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+    if (index == 16) {
+      p += 16;
+      continue;
+    }
+    p += index;
+    if (!table.isToken(*p)) {
+      return p;
+    }
+    p++;
+  }
+#endif
+  while (p != end && table.isToken(*p)) {
+    p++;
+  }
+  return p;
+}
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+int hexValue(char c) {
+  if (isDigit(c)) {
+    return c - '0';
+  }
+  c = absl::ascii_tolower(c);
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+/**
+ * @return the end of the header block (just past the LF of the empty line) if one starts in
+ *         [search_start, end), nullptr otherwise. A header block never starts with an empty line.
+ */
+const char* findHeaderBlockEnd(const char* search_start, const char* end) {
+  const char* p = search_start;
+  while (p != end) {
+    const char* lf = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    if (lf == nullptr || lf + 1 == end) {
+      return nullptr;
+    }
+    if (lf[1] == '\n') {
+      return lf + 2;
+    }
+    if (lf[1] == '\r') {
+      if (lf + 2 == end) {
+        return nullptr;
+      }
+      if (lf[2] == '\n') {
+        return lf + 3;
+      }
+    }
+    p = lf + 1;
+  }
+  return nullptr;
+}
+
+} // namespace
+
+VectorizedParserImpl::VectorizedParserImpl(MessageType type, ParserCallbacks& callbacks)
+    : type_(type), callbacks_(callbacks) {}
+
+const char* VectorizedParserImpl::errorName() const {
+  if (error_ != nullptr) {
+    return error_;
+  }
+  return paused_ ? "HPE_PAUSED" : "HPE_OK";
+}
+
+void VectorizedParserImpl::setError(const char* error) {
+  if (error_ == nullptr) {
+    error_ = error;
+  }
+}
+
+size_t VectorizedParserImpl::execute(const char* data, size_t length) {
+  if (error_ != nullptr || paused_) {
+    return 0;
+  }
+  if (length == 0) {
+    return onEof();
+  }
+
+  const char* p = data;
+  const char* const end = data + length;
+  while (error_ == nullptr && !paused_) {
+    switch (state_) {
+    case State::MessageStart:
+      while (p != end && (*p == '\r' || *p == '\n')) {
+        p++;
+      }
+      if (p == end) {
+        return length;
+      }
+      startMessage(*p);
+      break;
+    case State::Headers:
+      if (p == end) {
+        return length;
+      }
+      p = consumeHeaders(p, end);
+      break;
+    case State::HeadersDone:
+      onHeadersDone();
+      break;
+    case State::MessageDone:
+      completeMessage();
+      break;
+    case State::Body: {
+      if (p == end) {
+        return length;
+      }
+      const uint64_t body_length = std::min<uint64_t>(body_remaining_, end - p);
+      body_remaining_ -= body_length;
+      if (body_remaining_ == 0) {
+        state_ = State::MessageDone;
+      }
+      callbacks_.onBody(p, body_length);
+      p += body_length;
+      break;
+    }
+    case State::BodyUntilEof:
+      if (p == end) {
+        return length;
+      }
+      callbacks_.onBody(p, end - p);
+      p = end;
+      break;
+    case State::Dead:
+      while (p != end && (*p == '\r' || *p == '\n')) {
+        p++;
+      }
+      if (p == end) {
+        return length;
+      }
+      setError("HPE_CLOSED_CONNECTION");
+      break;
+    default:
+      if (p == end) {
+        return length;
+      }
+      p = consumeChunked(p, end);
+      break;
+    }
+
+    // As with http_parser, the rest of the data after an upgrade is in a different protocol and is
+    // left to the caller. upgrade_ is reset when the next message begins.
+    if (upgrade_ && (state_ == State::MessageStart || state_ == State::Dead)) {
+      break;
+    }
+  }
+
+  return p - data;
+}
+
+size_t VectorizedParserImpl::onEof() {
+  switch (state_) {
+  case State::BodyUntilEof:
+  case State::MessageDone:
+    completeMessage();
+    return 0;
+  case State::MessageStart:
+  case State::Dead:
+    return 0;
+  default:
+    setError("HPE_INVALID_EOF_STATE");
+    return 1;
+  }
+}
+
+void VectorizedParserImpl::startMessage(char first_char) {
+  if (type_ == MessageType::Request) {
+    if (!isMethodPrefix(absl::string_view(&first_char, 1))) {
+      setError("HPE_INVALID_METHOD");
+      return;
+    }
+  } else if (first_char != 'H') {
+    setError("HPE_INVALID_CONSTANT");
+    return;
+  }
+
+  method_ = HTTP_GET;
+  status_code_ = 0;
+  http_major_ = 1;
+  http_minor_ = 1;
+  content_length_ = ULLONG_MAX;
+  body_remaining_ = 0;
+  trailers_size_ = 0;
+  chunked_ = false;
+  chunk_size_digit_ = false;
+  connection_close_ = false;
+  connection_keep_alive_ = false;
+  connection_upgrade_ = false;
+  upgrade_header_ = false;
+  upgrade_ = false;
+  skip_body_ = false;
+  state_ = State::Headers;
+  callbacks_.onMessageBegin();
+}
+
+const char* VectorizedParserImpl::consumeHeaders(const char* p, const char* end) {
+  const char* block_end;
+  if (pending_headers_.empty()) {
+    // Common case: the whole header block is in this span and is parsed in place.
+    block_end = findHeaderBlockEnd(
+        p, static_cast<size_t>(end - p) > MaxHeaderSize ? p + MaxHeaderSize : end);
+    if (block_end != nullptr) {
+      return parseHeaderBlock(p, block_end) ? block_end : p;
+    }
+    if (static_cast<size_t>(end - p) > MaxHeaderSize) {
+      setError("HPE_HEADER_OVERFLOW");
+      return p;
+    }
+    pending_headers_.assign(p, end - p);
+    validatePartialHeaders(pending_headers_);
+    return end;
+  }
+
+  // Continue a buffered partial block. Only copy what can be part of a block within the size
+  // limit, and resume the search for the terminating empty line where the last one stopped.
+  const size_t old_size = pending_headers_.size();
+  const size_t copy_length = std::min<size_t>(end - p, MaxHeaderSize + 1 - old_size);
+  pending_headers_.append(p, copy_length);
+  const char* block_begin = pending_headers_.data();
+  block_end = findHeaderBlockEnd(block_begin + (old_size >= 2 ? old_size - 2 : 0),
+                                 block_begin + pending_headers_.size());
+  if (block_end == nullptr || static_cast<size_t>(block_end - block_begin) > MaxHeaderSize) {
+    if (pending_headers_.size() > MaxHeaderSize) {
+      setError("HPE_HEADER_OVERFLOW");
+      return p;
+    }
+    validatePartialHeaders(pending_headers_);
+    return p + copy_length;
+  }
+
+  const size_t consumed = (block_end - block_begin) - old_size;
+  const bool parsed = parseHeaderBlock(block_begin, block_end);
+  pending_headers_.clear();
+  return parsed ? p + consumed : p;
+}
+
+void VectorizedParserImpl::validatePartialHeaders(absl::string_view data) {
+  if (type_ == MessageType::Request) {
+    const absl::string_view head = data.substr(0, MaxMethodLength);
+    const size_t space = head.find(' ');
+    http_method method;
+    if (space != absl::string_view::npos ? !lookupMethod(head.substr(0, space), method)
+                                         : !isMethodPrefix(head)) {
+      setError("HPE_INVALID_METHOD");
+    }
+  } else {
+    const absl::string_view protocol("HTTP/");
+    const absl::string_view head = data.substr(0, protocol.size());
+    if (head != protocol.substr(0, head.size())) {
+      setError("HPE_INVALID_CONSTANT");
+    }
+  }
+}
+
+bool VectorizedParserImpl::parseHeaderBlock(const char* p, const char* end) {
+  // The block ends with a LF, so scans for CR/LF never run off the end.
+  ASSERT(end[-1] == '\n');
+  p = type_ == MessageType::Request ? parseRequestLine(p, end) : parseStatusLine(p, end);
+  if (p == nullptr) {
+    return false;
+  }
+
+  while (*p != '\r' && *p != '\n') {
+    const char* name = p;
+    const char* name_end = findNonToken(name, end);
+    if (name_end == name || *name_end != ':') {
+      setError("HPE_INVALID_HEADER_TOKEN");
+      return false;
+    }
+
+    const char* value = name_end + 1;
+    while (*value == ' ' || *value == '\t') {
+      value++;
+    }
+    const char* value_end = findControl<false, true>(value, end);
+    if (*value_end != '\r' && *value_end != '\n') {
+      setError("HPE_INVALID_HEADER_TOKEN");
+      return false;
+    }
+    p = skipLineEnd(value_end, "HPE_LF_EXPECTED");
+    if (p == nullptr) {
+      return false;
+    }
+    while (value_end != value && (value_end[-1] == ' ' || value_end[-1] == '\t')) {
+      value_end--;
+    }
+
+    if (!onHeader(absl::string_view(name, name_end - name),
+                  absl::string_view(value, value_end - value))) {
+      return false;
+    }
+  }
+  // findHeaderBlockEnd() does not look at a CR after a line end unless a LF follows it, so a bare
+  // CR stops the loop above before the end of the block.
+  p = skipLineEnd(p, "HPE_LF_EXPECTED");
+  if (p == nullptr) {
+    return false;
+  }
+  if (p != end) {
+    setError("HPE_LF_EXPECTED");
+    return false;
+  }
+
+  if (chunked_ && content_length_ != ULLONG_MAX) {
+    setError("HPE_UNEXPECTED_CONTENT_LENGTH");
+    return false;
+  }
+
+  if (upgrade_header_ && connection_upgrade_) {
+    // For responses, upgrade headers are only meaningful on a 101 Switching Protocols.
+    upgrade_ = type_ == MessageType::Request || status_code_ == 101;
+  } else {
+    upgrade_ = type_ == MessageType::Request && method_ == HTTP_CONNECT;
+  }
+
+  switch (callbacks_.onHeadersComplete()) {
+  case 0:
+    break;
+  case 2:
+    upgrade_ = true;
+    FALLTHRU;
+  case 1:
+    skip_body_ = true;
+    break;
+  default:
+    setError("HPE_CB_headers_complete");
+    return false;
+  }
+  state_ = State::HeadersDone;
+  return true;
+}
+
+const char* VectorizedParserImpl::parseRequestLine(const char* p, const char* end) {
+  const char* method_end = findNonToken(p, end);
+  if (*method_end != ' ' || !lookupMethod(absl::string_view(p, method_end - p), method_)) {
+    setError("HPE_INVALID_METHOD");
+    return nullptr;
+  }
+
+  p = method_end;
+  while (*p == ' ') {
+    p++;
+  }
+  const char* url_end = findControl<true, false>(p, end);
+  if (url_end == p || (*url_end != ' ' && *url_end != '\r' && *url_end != '\n')) {
+    setError("HPE_INVALID_URL");
+    return nullptr;
+  }
+  callbacks_.onUrl(p, url_end - p);
+
+  p = url_end;
+  if (*p == ' ') {
+    while (*p == ' ') {
+      p++;
+    }
+    p = parseVersion(p, end);
+    if (p == nullptr) {
+      return nullptr;
+    }
+  } else {
+    // HTTP/0.9 request line without a version.
+    http_major_ = 0;
+    http_minor_ = 9;
+  }
+  return skipLineEnd(p, "HPE_INVALID_VERSION");
+}
+
+const char* VectorizedParserImpl::parseStatusLine(const char* p, const char* end) {
+  p = parseVersion(p, end);
+  if (p == nullptr) {
+    return nullptr;
+  }
+  if (end - p < 4 || p[0] != ' ' || !isDigit(p[1]) || !isDigit(p[2]) || !isDigit(p[3])) {
+    setError("HPE_INVALID_STATUS");
+    return nullptr;
+  }
+  status_code_ = (p[1] - '0') * 100 + (p[2] - '0') * 10 + (p[3] - '0');
+  p += 4;
+
+  if (*p == ' ') {
+    // Reason phrase, which is ignored.
+    p = findControl<false, true>(p + 1, end);
+  }
+  return skipLineEnd(p, "HPE_INVALID_STATUS");
+}
+
+const char* VectorizedParserImpl::parseVersion(const char* p, const char* end) {
+  static const char protocol[] = "HTTP/";
+  constexpr size_t protocol_length = sizeof(protocol) - 1;
+  if (static_cast<size_t>(end - p) < protocol_length + 3 ||
+      std::memcmp(p, protocol, protocol_length) != 0) {
+    setError("HPE_INVALID_CONSTANT");
+    return nullptr;
+  }
+  p += protocol_length;
+  if (!isDigit(p[0]) || p[1] != '.' || !isDigit(p[2])) {
+    setError("HPE_INVALID_VERSION");
+    return nullptr;
+  }
+  http_major_ = p[0] - '0';
+  http_minor_ = p[2] - '0';
+  return p + 3;
+}
+
+const char* VectorizedParserImpl::skipLineEnd(const char* p, const char* error) {
+  if (p[0] == '\n') {
+    return p + 1;
+  }
+  if (p[0] == '\r' && p[1] == '\n') {
+    return p + 2;
+  }
+  setError(error);
+  return nullptr;
+}
+
+bool VectorizedParserImpl::onHeader(absl::string_view name, absl::string_view value) {
+  callbacks_.onHeaderField(name.data(), name.size());
+  callbacks_.onHeaderValue(value.data(), value.size());
+
+  // Only a handful of headers affect framing; the name length rules out all others cheaply.
+  switch (name.size()) {
+  case 7:
+    if (absl::EqualsIgnoreCase(name, "upgrade")) {
+      upgrade_header_ = true;
+    }
+    break;
+  case 10:
+    if (absl::EqualsIgnoreCase(name, "connection")) {
+      onConnectionHeader(value);
+    }
+    break;
+  case 14:
+    if (absl::EqualsIgnoreCase(name, "content-length")) {
+      if (content_length_ != ULLONG_MAX) {
+        setError("HPE_UNEXPECTED_CONTENT_LENGTH");
+        return false;
+      }
+      if (value.empty()) {
+        setError("HPE_INVALID_CONTENT_LENGTH");
+        return false;
+      }
+      uint64_t content_length = 0;
+      for (char c : value) {
+        if (!isDigit(c) || content_length > (ULLONG_MAX - 10) / 10) {
+          setError("HPE_INVALID_CONTENT_LENGTH");
+          return false;
+        }
+        content_length = content_length * 10 + (c - '0');
+      }
+      content_length_ = content_length;
+    }
+    break;
+  case 16:
+    if (absl::EqualsIgnoreCase(name, "proxy-connection")) {
+      onConnectionHeader(value);
+    }
+    break;
+  case 17:
+    if (absl::EqualsIgnoreCase(name, "transfer-encoding")) {
+      chunked_ = absl::EqualsIgnoreCase(value, "chunked");
+    }
+    break;
+  }
+  return true;
+}
+
+void VectorizedParserImpl::onConnectionHeader(absl::string_view value) {
+  while (!value.empty()) {
+    const size_t comma = value.find(',');
+    const absl::string_view token = absl::StripAsciiWhitespace(value.substr(0, comma));
+    if (absl::EqualsIgnoreCase(token, "close")) {
+      connection_close_ = true;
+    } else if (absl::EqualsIgnoreCase(token, "keep-alive")) {
+      connection_keep_alive_ = true;
+    } else if (absl::EqualsIgnoreCase(token, "upgrade")) {
+      connection_upgrade_ = true;
+    }
+    value.remove_prefix(comma == absl::string_view::npos ? value.size() : comma + 1);
+  }
+}
+
+void VectorizedParserImpl::onHeadersDone() {
+  const bool has_body = chunked_ || (content_length_ > 0 && content_length_ != ULLONG_MAX);
+  if (upgrade_ && ((type_ == MessageType::Request && method_ == HTTP_CONNECT) || skip_body_ ||
+                   !has_body)) {
+    completeMessage();
+  } else if (skip_body_) {
+    completeMessage();
+  } else if (chunked_) {
+    state_ = State::ChunkSize;
+  } else if (content_length_ == 0) {
+    completeMessage();
+  } else if (content_length_ != ULLONG_MAX) {
+    body_remaining_ = content_length_;
+    state_ = State::Body;
+  } else if (!needsEof()) {
+    completeMessage();
+  } else {
+    state_ = State::BodyUntilEof;
+  }
+}
+
+void VectorizedParserImpl::onChunkSizeDone() {
+  if (body_remaining_ == 0) {
+    state_ = State::TrailerLineStart;
+  } else {
+    state_ = State::ChunkData;
+  }
+}
+
+const char* VectorizedParserImpl::consumeChunked(const char* p, const char* end) {
+  while (p != end && error_ == nullptr && !paused_) {
+    switch (state_) {
+    case State::ChunkSize: {
+      const int digit = hexValue(*p);
+      if (digit >= 0) {
+        if (body_remaining_ > (ULLONG_MAX - 16) / 16) {
+          setError("HPE_INVALID_CONTENT_LENGTH");
+          return p;
+        }
+        body_remaining_ = body_remaining_ * 16 + digit;
+        chunk_size_digit_ = true;
+        p++;
+        break;
+      }
+      if (!chunk_size_digit_) {
+        setError("HPE_INVALID_CHUNK_SIZE");
+        return p;
+      }
+      if (*p == ';' || *p == ' ' || *p == '\t') {
+        state_ = State::ChunkExtension;
+      } else if (*p == '\r') {
+        state_ = State::ChunkSizeAlmostDone;
+      } else if (*p == '\n') {
+        onChunkSizeDone();
+      } else {
+        setError("HPE_INVALID_CHUNK_SIZE");
+        return p;
+      }
+      p++;
+      break;
+    }
+    case State::ChunkExtension:
+      // Chunk extensions are ignored.
+      p = findControl<false, true>(p, end);
+      if (p == end) {
+        return p;
+      }
+      if (*p == '\r') {
+        state_ = State::ChunkSizeAlmostDone;
+      } else if (*p == '\n') {
+        onChunkSizeDone();
+      } else {
+        setError("HPE_INVALID_CHUNK_SIZE");
+        return p;
+      }
+      p++;
+      break;
+    case State::ChunkSizeAlmostDone:
+      if (*p != '\n') {
+        setError("HPE_LF_EXPECTED");
+        return p;
+      }
+      onChunkSizeDone();
+      p++;
+      break;
+    case State::ChunkData: {
+      const uint64_t chunk_length = std::min<uint64_t>(body_remaining_, end - p);
+      body_remaining_ -= chunk_length;
+      if (body_remaining_ == 0) {
+        state_ = State::ChunkDataEnd;
+      }
+      callbacks_.onBody(p, chunk_length);
+      p += chunk_length;
+      break;
+    }
+    case State::ChunkDataEnd:
+      if (*p == '\r') {
+        state_ = State::ChunkDataAlmostDone;
+      } else if (*p == '\n') {
+        state_ = State::ChunkSize;
+        chunk_size_digit_ = false;
+      } else {
+        setError("HPE_INVALID_CHUNK_SIZE");
+        return p;
+      }
+      p++;
+      break;
+    case State::ChunkDataAlmostDone:
+      if (*p != '\n') {
+        setError("HPE_LF_EXPECTED");
+        return p;
+      }
+      state_ = State::ChunkSize;
+      chunk_size_digit_ = false;
+      p++;
+      break;
+    case State::TrailerLineStart:
+      // Trailers are skipped, callers have no use for them.
+      if (*p == '\r') {
+        state_ = State::TrailersAlmostDone;
+        p++;
+      } else if (*p == '\n') {
+        state_ = State::MessageDone;
+        return p + 1;
+      } else {
+        state_ = State::TrailerLine;
+      }
+      break;
+    case State::TrailerLine: {
+      const char* lf = static_cast<const char*>(std::memchr(p, '\n', end - p));
+      const char* line_end = lf == nullptr ? end : lf + 1;
+      trailers_size_ += line_end - p;
+      if (trailers_size_ > MaxHeaderSize) {
+        setError("HPE_HEADER_OVERFLOW");
+        return p;
+      }
+      if (lf != nullptr) {
+        state_ = State::TrailerLineStart;
+      }
+      p = line_end;
+      break;
+    }
+    case State::TrailersAlmostDone:
+      if (*p != '\n') {
+        setError("HPE_LF_EXPECTED");
+        return p;
+      }
+      state_ = State::MessageDone;
+      return p + 1;
+    default:
+      NOT_REACHED_GCOVR_EXCL_LINE;
+    }
+  }
+  return p;
+}
+
+bool VectorizedParserImpl::needsEof() const {
+  if (type_ == MessageType::Request) {
+    return false;
+  }
+  // See RFC 7230 section 3.3.3.
+  if (status_code_ / 100 == 1 || status_code_ == 204 || status_code_ == 304 || skip_body_) {
+    return false;
+  }
+  return !chunked_ && content_length_ == ULLONG_MAX;
+}
+
+bool VectorizedParserImpl::shouldKeepAlive() const {
+  if (http_major_ > 0 && http_minor_ > 0) {
+    if (connection_close_) {
+      return false;
+    }
+  } else if (!connection_keep_alive_) {
+    return false;
+  }
+  return !needsEof();
+}
+
+void VectorizedParserImpl::completeMessage() {
+  state_ = shouldKeepAlive() ? State::MessageStart : State::Dead;
+  callbacks_.onMessageComplete();
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
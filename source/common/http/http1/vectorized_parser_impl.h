@@ -0,0 +1,122 @@
+#pragma once
+
+#include <http_parser.h>
+
+#include <climits>
+#include <cstdint>
+#include <string>
+
+#include "common/common/non_copyable.h"
+#include "common/http/http1/parser.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Parser implementation that scans the request/status line and header block in bulk rather than
+ * one byte at a time. The end of the header block is located first, and the block is then parsed
+ * with SIMD scans for delimiters and invalid characters (AVX2 or SSE2 for lines and values, SSE4.2
+ * for header names, with a scalar fallback when the instruction set is not enabled at compile
+ * time). The URL and every header field and value are each delivered as a single span, straight
+ * from the dispatched data when the block is contained in one slice, or from an internal buffer
+ * when it spans several.
+ *
+ * Message framing follows http_parser: the same error names are reported, callbacks are invoked in
+ * the same order and onHeadersComplete() return codes have the same meaning. The grammar is
+ * stricter in places where RFC 7230 permits a recipient to reject a message: header names must be
+ * tokens, obsolete line folding is rejected and optional whitespace is trimmed from both ends of
+ * header values. As the request line and headers are only validated once the header block is
+ * complete, the exception is the request method (or response protocol), which is checked as it
+ * arrives so that garbage is rejected early.
+ */
+class VectorizedParserImpl : public Parser, NonCopyable {
+public:
+  VectorizedParserImpl(MessageType type, ParserCallbacks& callbacks);
+
+  // Http1::Parser
+  size_t execute(const char* data, size_t length) override;
+  void pause() override { paused_ = true; }
+  void resume() override { paused_ = false; }
+  bool hasError() const override { return error_ != nullptr; }
+  const char* errorName() const override;
+  http_method method() const override { return method_; }
+  uint16_t statusCode() const override { return status_code_; }
+  bool isHttp11() const override { return http_major_ == 1 && http_minor_ == 1; }
+  bool isChunked() const override { return chunked_; }
+  uint64_t contentLength() const override { return content_length_; }
+
+  // Maximum size of the request/status line and headers, matching http_parser.
+  static constexpr size_t MaxHeaderSize = HTTP_MAX_HEADER_SIZE;
+
+private:
+  enum class State {
+    MessageStart,
+    Headers,
+    HeadersDone,
+    MessageDone,
+    Body,
+    BodyUntilEof,
+    ChunkSize,
+    ChunkExtension,
+    ChunkSizeAlmostDone,
+    ChunkData,
+    ChunkDataEnd,
+    ChunkDataAlmostDone,
+    TrailerLineStart,
+    TrailerLine,
+    TrailersAlmostDone,
+    Dead
+  };
+
+  void startMessage(char first_char);
+  const char* consumeHeaders(const char* p, const char* end);
+  void validatePartialHeaders(absl::string_view data);
+  bool parseHeaderBlock(const char* p, const char* end);
+  const char* parseRequestLine(const char* p, const char* end);
+  const char* parseStatusLine(const char* p, const char* end);
+  const char* parseVersion(const char* p, const char* end);
+  const char* skipLineEnd(const char* p, const char* error);
+  bool onHeader(absl::string_view name, absl::string_view value);
+  void onConnectionHeader(absl::string_view value);
+  void onChunkSizeDone();
+  void onHeadersDone();
+  const char* consumeChunked(const char* p, const char* end);
+  bool needsEof() const;
+  bool shouldKeepAlive() const;
+  void completeMessage();
+  size_t onEof();
+  void setError(const char* error);
+
+  const MessageType type_;
+  ParserCallbacks& callbacks_;
+  State state_{State::MessageStart};
+  const char* error_{};
+  bool paused_{};
+
+  // Partial header block, only used when the block spans more than one execute() call.
+  std::string pending_headers_;
+
+  // Per message state.
+  http_method method_{HTTP_GET};
+  uint16_t status_code_{};
+  uint16_t http_major_{1};
+  uint16_t http_minor_{1};
+  uint64_t content_length_{ULLONG_MAX};
+  uint64_t body_remaining_{};
+  size_t trailers_size_{};
+  bool chunked_{};
+  bool chunk_size_digit_{};
+  bool connection_close_{};
+  bool connection_keep_alive_{};
+  bool connection_upgrade_{};
+  bool upgrade_header_{};
+  bool upgrade_{};
+  bool skip_body_{};
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -1,6 +1,9 @@
 #include "common/http/http2/codec_impl.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -11,6 +14,7 @@
 #include "envoy/stats/scope.h"
 
 #include "common/common/assert.h"
+#include "common/common/cleanup.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/fmt.h"
 #include "common/common/utility.h"
@@ -22,6 +26,12 @@ namespace Envoy {
 namespace Http {
 namespace Http2 {
 
+namespace {
+// Payload of the PINGs measuring the bandwidth-delay product, told apart from the PINGs of the peer
+// by their ACKs.
+constexpr uint8_t BdpPingData[8] = {'e', 'n', 'v', 'o', 'y', 'b', 'd', 'p'};
+} // namespace
+
 bool Utility::reconstituteCrumbledCookies(const HeaderString& key, const HeaderString& value,
                                           HeaderString& cookies) {
   if (key != Headers::get().Cookie.get().c_str()) {
@@ -38,6 +48,33 @@ bool Utility::reconstituteCrumbledCookies(const HeaderString& key, const HeaderS
 
 ConnectionImpl::Http2Callbacks ConnectionImpl::http2_callbacks_;
 
+namespace {
+
+// Smaller payloads are copied, which is cheaper than referencing them.
+constexpr size_t MinReferencedDataSize = 1024;
+
+/**
+ * The payload of a received DATA frame, referenced in the buffer it was read into.
+ */
+class ReferencedData : public Buffer::BufferFragment {
+public:
+  ReferencedData(const uint8_t* data, size_t size, std::shared_ptr<Buffer::OwnedImpl> pinned_data)
+      : data_(data), size_(size), pinned_data_(std::move(pinned_data)) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return data_; }
+  size_t size() const override { return size_; }
+  void done() override { delete this; }
+
+private:
+  const uint8_t* const data_;
+  const size_t size_;
+  // Keeps the slices of the read buffer alive.
+  const std::shared_ptr<Buffer::OwnedImpl> pinned_data_;
+};
+
+} // namespace
+
 /**
  * Helper to remove const during a cast. nghttp2 takes non-const pointers for headers even though
  * it copies them.
@@ -72,6 +109,7 @@ static void insertHeader(std::vector<nghttp2_nv>& headers, const HeaderEntry& he
 
 void ConnectionImpl::StreamImpl::buildHeaders(std::vector<nghttp2_nv>& final_headers,
                                               const HeaderMap& headers) {
+  final_headers.clear();
   final_headers.reserve(headers.size());
   headers.iterate(
       [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
@@ -88,7 +126,7 @@ void ConnectionImpl::StreamImpl::encode100ContinueHeaders(const HeaderMap& heade
 }
 
 void ConnectionImpl::StreamImpl::encodeHeaders(const HeaderMap& headers, bool end_stream) {
-  std::vector<nghttp2_nv> final_headers;
+  std::vector<nghttp2_nv>& final_headers = parent_.final_headers_;
 
   Http::HeaderMapPtr modified_headers;
   if (Http::Utility::isUpgrade(headers)) {
@@ -184,7 +222,7 @@ void ConnectionImpl::StreamImpl::saveHeader(HeaderString&& name, HeaderString&&
 }
 
 void ConnectionImpl::StreamImpl::submitTrailers(const HeaderMap& trailers) {
-  std::vector<nghttp2_nv> final_headers;
+  std::vector<nghttp2_nv>& final_headers = parent_.final_headers_;
   buildHeaders(final_headers, trailers);
   int rc =
       nghttp2_submit_trailer(parent_.session_, stream_id_, &final_headers[0], final_headers.size());
@@ -192,7 +230,10 @@ void ConnectionImpl::StreamImpl::submitTrailers(const HeaderMap& trailers) {
 }
 
 ssize_t ConnectionImpl::StreamImpl::onDataSourceRead(uint64_t length, uint32_t* data_flags) {
-  if (pending_send_data_.length() == 0 && !local_end_stream_) {
+  if ((pending_send_data_.length() == 0 && !local_end_stream_) ||
+      (pending_send_data_.length() > 0 && parent_.holdData())) {
+    // Either there is nothing to send yet, or the connection is write blocked and the data is held
+    // until it drains, to be sent by stream weight rather than queued behind earlier streams.
     ASSERT(!data_deferred_);
     data_deferred_ = true;
     return NGHTTP2_ERR_DEFERRED;
@@ -227,8 +268,13 @@ int ConnectionImpl::StreamImpl::onDataSourceSend(const uint8_t* framehd, size_t
 void ConnectionImpl::ClientStreamImpl::submitHeaders(const std::vector<nghttp2_nv>& final_headers,
                                                      nghttp2_data_provider* provider) {
   ASSERT(stream_id_ == -1);
-  stream_id_ = nghttp2_submit_request(parent_.session_, nullptr, &final_headers.data()[0],
-                                      final_headers.size(), provider, base());
+  nghttp2_priority_spec priority_spec;
+  if (weight_ != NGHTTP2_DEFAULT_WEIGHT) {
+    nghttp2_priority_spec_init(&priority_spec, 0, weight_, 0);
+  }
+  stream_id_ = nghttp2_submit_request(
+      parent_.session_, weight_ != NGHTTP2_DEFAULT_WEIGHT ? &priority_spec : nullptr,
+      &final_headers.data()[0], final_headers.size(), provider, base());
   ASSERT(stream_id_ > 0);
 }
 
@@ -244,7 +290,7 @@ void ConnectionImpl::StreamImpl::encodeData(Buffer::Instance& data, bool end_str
   ASSERT(!local_end_stream_);
   local_end_stream_ = end_stream;
   pending_send_data_.move(data);
-  if (data_deferred_) {
+  if (data_deferred_ && !parent_.holdData()) {
     int rc = nghttp2_session_resume_data(parent_.session_, stream_id_);
     ASSERT(rc == 0);
 
@@ -254,6 +300,23 @@ void ConnectionImpl::StreamImpl::encodeData(Buffer::Instance& data, bool end_str
   parent_.sendPendingFrames();
 }
 
+void ConnectionImpl::StreamImpl::setPriorityWeight(uint32_t weight) {
+  ASSERT(weight >= NGHTTP2_MIN_WEIGHT && weight <= NGHTTP2_MAX_WEIGHT);
+  if (!parent_.prioritize_streams_ || weight == weight_) {
+    return;
+  }
+
+  weight_ = weight;
+  if (stream_id_ != -1) {
+    // This only changes the local scheduling of the stream's frames. The stream is made a direct
+    // dependent of the connection, as the dependencies a peer may have set are not tracked once
+    // streams are closed.
+    nghttp2_priority_spec priority_spec;
+    nghttp2_priority_spec_init(&priority_spec, 0, weight_, 0);
+    nghttp2_session_change_stream_priority(parent_.session_, stream_id_, &priority_spec);
+  }
+}
+
 void ConnectionImpl::StreamImpl::resetStream(StreamResetReason reason) {
   // Higher layers expect calling resetStream() to immediately raise reset callbacks.
   runResetCallbacks(reason);
@@ -287,21 +350,26 @@ ConnectionImpl::~ConnectionImpl() { nghttp2_session_del(session_); }
 
 void ConnectionImpl::dispatch(Buffer::Instance& data) {
   ENVOY_CONN_LOG(trace, "dispatching {} bytes", connection_, data.length());
-  uint64_t num_slices = data.getRawSlices(nullptr, 0);
-  Buffer::RawSlice slices[num_slices];
-  data.getRawSlices(slices, num_slices);
-  for (Buffer::RawSlice& slice : slices) {
-    dispatching_ = true;
-    ssize_t rc =
-        nghttp2_session_mem_recv(session_, static_cast<const uint8_t*>(slice.mem_), slice.len_);
-    if (rc != static_cast<ssize_t>(slice.len_)) {
-      throw CodecProtocolException(fmt::format("{}", nghttp2_strerror(rc)));
+  {
+    // Data referenced by streams must stay alive, also if dispatching fails part way through.
+    Cleanup pin_referenced_data([this, &data]() { pinReferencedData(data); });
+    uint64_t num_slices = data.getRawSlices(nullptr, 0);
+    Buffer::RawSlice slices[num_slices];
+    data.getRawSlices(slices, num_slices);
+    for (Buffer::RawSlice& slice : slices) {
+      dispatching_ = true;
+      current_slice_ = static_cast<const uint8_t*>(slice.mem_);
+      current_slice_end_ = current_slice_ + slice.len_;
+      ssize_t rc = nghttp2_session_mem_recv(session_, current_slice_, slice.len_);
+      if (rc != static_cast<ssize_t>(slice.len_)) {
+        throw CodecProtocolException(fmt::format("{}", nghttp2_strerror(rc)));
+      }
+
+      dispatching_ = false;
     }
 
-    dispatching_ = false;
+    ENVOY_CONN_LOG(trace, "dispatched {} bytes", connection_, data.length());
   }
-
-  ENVOY_CONN_LOG(trace, "dispatched {} bytes", connection_, data.length());
   data.drain(data.length());
 
   // Decoding incoming frames can generate outbound frames so flush pending.
@@ -316,7 +384,12 @@ int ConnectionImpl::onData(int32_t stream_id, const uint8_t* data, size_t len) {
   StreamImpl* stream = getStream(stream_id);
   // If this results in buffering too much data, the watermark buffer will call
   // pendingRecvBufferHighWatermark, resulting in ++read_disable_count_
-  stream->pending_recv_data_.add(data, len);
+  if (!referenceData(*stream, data, len)) {
+    stream->pending_recv_data_.add(data, len);
+  }
+  if (auto_tuned_window_size_limit_ > 0) {
+    sampleBdp(len);
+  }
   // Update the window to the peer unless some consumer of this stream's data has hit a flow control
   // limit and disabled reads on this stream
   if (!stream->buffers_overrun()) {
@@ -327,6 +400,78 @@ int ConnectionImpl::onData(int32_t stream_id, const uint8_t* data, size_t len) {
   return 0;
 }
 
+bool ConnectionImpl::referenceData(StreamImpl& stream, const uint8_t* data, size_t len) {
+  if (!reference_received_data_ || len < MinReferencedDataSize || data < current_slice_ ||
+      data + len > current_slice_end_) {
+    return false;
+  }
+
+  if (pinned_data_ == nullptr) {
+    pinned_data_ = std::make_shared<Buffer::OwnedImpl>();
+  }
+  stream.pending_recv_data_.addBufferFragment(*new ReferencedData(data, len, pinned_data_));
+  return true;
+}
+
+void ConnectionImpl::pinReferencedData(Buffer::Instance& data) {
+  if (pinned_data_ == nullptr) {
+    return;
+  }
+
+  // See Buffer::OwnedImpl::move() for why the static cast is safe.
+  pinned_data_->pin(static_cast<Buffer::OwnedImpl&>(data), data.length());
+  pinned_data_.reset();
+}
+
+void ConnectionImpl::sampleBdp(size_t len) {
+  if (bdp_ping_outstanding_) {
+    bdp_sample_ += len;
+    return;
+  }
+  if (stream_window_size_ >= auto_tuned_window_size_limit_) {
+    return;
+  }
+
+  int rc = nghttp2_submit_ping(session_, NGHTTP2_FLAG_NONE, BdpPingData);
+  ASSERT(rc == 0);
+  bdp_ping_outstanding_ = true;
+  bdp_ping_sent_time_ = connection_.dispatcher().timeSystem().monotonicTime();
+  bdp_sample_ = len;
+}
+
+void ConnectionImpl::onBdpPingAck() {
+  bdp_ping_outstanding_ = false;
+  const std::chrono::duration<double> rtt = std::max<std::chrono::duration<double>>(
+      connection_.dispatcher().timeSystem().monotonicTime() - bdp_ping_sent_time_,
+      std::chrono::microseconds(1));
+  const double bandwidth = bdp_sample_ / rtt.count();
+  // A sample that did not come close to filling the window says nothing about the link.
+  if (3 * bdp_sample_ < 2 * static_cast<uint64_t>(stream_window_size_) ||
+      bandwidth <= max_bandwidth_) {
+    return;
+  }
+  max_bandwidth_ = bandwidth;
+
+  const uint32_t window_size =
+      std::min<uint64_t>(auto_tuned_window_size_limit_, 2 * std::max<uint64_t>(bdp_sample_, 1));
+  if (window_size > stream_window_size_) {
+    ENVOY_CONN_LOG(debug, "growing stream-level window size to {}, rtt {}us", connection_,
+                   window_size,
+                   std::chrono::duration_cast<std::chrono::microseconds>(rtt).count());
+    stream_window_size_ = window_size;
+    // Peers apply the new initial window size to all open streams.
+    const nghttp2_settings_entry iv{NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, window_size};
+    int rc = nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, &iv, 1);
+    ASSERT(rc == 0);
+  }
+  if (window_size > connection_window_size_) {
+    ENVOY_CONN_LOG(debug, "growing connection-level window size to {}", connection_, window_size);
+    connection_window_size_ = window_size;
+    int rc = nghttp2_session_set_local_window_size(session_, NGHTTP2_FLAG_NONE, 0, window_size);
+    ASSERT(rc == 0);
+  }
+}
+
 void ConnectionImpl::goAway() {
   int rc = nghttp2_submit_goaway(session_, NGHTTP2_FLAG_NONE,
                                  nghttp2_session_get_last_proc_stream_id(session_),
@@ -355,6 +500,13 @@ int ConnectionImpl::onFrameReceived(const nghttp2_frame* frame) {
     return 0;
   }
 
+  if (frame->hd.type == NGHTTP2_PING && (frame->hd.flags & NGHTTP2_FLAG_ACK) &&
+      bdp_ping_outstanding_ &&
+      memcmp(frame->ping.opaque_data, BdpPingData, sizeof(BdpPingData)) == 0) {
+    onBdpPingAck();
+    return 0;
+  }
+
   StreamImpl* stream = getStream(frame->hd.stream_id);
   if (!stream) {
     return 0;
@@ -565,6 +717,34 @@ int ConnectionImpl::saveHeader(const nghttp2_frame* frame, HeaderString&& name,
   }
 }
 
+void ConnectionImpl::onUnderlyingConnectionBelowWriteBufferLowWatermark() {
+  connection_above_high_watermark_ = false;
+  for (auto& stream : active_streams_) {
+    stream->runLowWatermarkCallbacks();
+  }
+
+  if (!prioritize_streams_) {
+    return;
+  }
+
+  // Release the DATA frames held while the connection was write blocked. nghttp2 interleaves the
+  // frames of the streams by weight, so that the streams share the connection in proportion to
+  // their weights until it is write blocked again.
+  bool resumed = false;
+  for (auto& stream : active_streams_) {
+    if (stream->data_deferred_ &&
+        (stream->pending_send_data_.length() > 0 || stream->local_end_stream_)) {
+      int rc = nghttp2_session_resume_data(session_, stream->stream_id_);
+      ASSERT(rc == 0);
+      stream->data_deferred_ = false;
+      resumed = true;
+    }
+  }
+  if (resumed) {
+    sendPendingFrames();
+  }
+}
+
 void ConnectionImpl::sendPendingFrames() {
   if (dispatching_ || connection_.state() == Network::Connection::State::Closed) {
     return;
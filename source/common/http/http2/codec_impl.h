@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 
+#include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/http/codec.h"
 #include "envoy/network/connection.h"
@@ -77,8 +78,15 @@ public:
                  const Http2Settings& http2_settings)
       : stats_{ALL_HTTP2_CODEC_STATS(POOL_COUNTER_PREFIX(stats, "http2."))},
         connection_(connection),
-        per_stream_buffer_limit_(http2_settings.initial_stream_window_size_), dispatching_(false),
-        raised_goaway_(false), pending_deferred_reset_(false) {}
+        per_stream_buffer_limit_(http2_settings.initial_stream_window_size_),
+        prioritize_streams_(http2_settings.prioritize_streams_),
+        reference_received_data_(http2_settings.reference_received_data_ &&
+                                 !Buffer::OwnedImpl::usingOldImpl()),
+        auto_tuned_window_size_limit_(http2_settings.auto_tuned_window_size_limit_),
+        stream_window_size_(http2_settings.initial_stream_window_size_),
+        connection_window_size_(http2_settings.initial_connection_window_size_),
+        dispatching_(false), raised_goaway_(false), pending_deferred_reset_(false),
+        connection_above_high_watermark_(false), bdp_ping_outstanding_(false) {}
 
   ~ConnectionImpl();
 
@@ -90,15 +98,12 @@ public:
   bool wantsToWrite() override { return nghttp2_session_want_write(session_); }
   // Propogate network connection watermark events to each stream on the connection.
   void onUnderlyingConnectionAboveWriteBufferHighWatermark() override {
+    connection_above_high_watermark_ = true;
     for (auto& stream : active_streams_) {
       stream->runHighWatermarkCallbacks();
     }
   }
-  void onUnderlyingConnectionBelowWriteBufferLowWatermark() override {
-    for (auto& stream : active_streams_) {
-      stream->runLowWatermarkCallbacks();
-    }
-  }
+  void onUnderlyingConnectionBelowWriteBufferLowWatermark() override;
 
 protected:
   /**
@@ -149,6 +154,10 @@ protected:
     ssize_t onDataSourceRead(uint64_t length, uint32_t* data_flags);
     int onDataSourceSend(const uint8_t* framehd, size_t length);
     void resetStreamWorker(StreamResetReason reason);
+    /**
+     * Replace the content of final_headers with the given headers. The vector is usually the
+     * connection's final_headers_, so that its capacity is reused across streams.
+     */
     static void buildHeaders(std::vector<nghttp2_nv>& final_headers, const HeaderMap& headers);
     void saveHeader(HeaderString&& name, HeaderString&& value);
     virtual void submitHeaders(const std::vector<nghttp2_nv>& final_headers,
@@ -168,6 +177,7 @@ protected:
     void resetStream(StreamResetReason reason) override;
     virtual void readDisable(bool disable) override;
     virtual uint32_t bufferLimit() override { return pending_recv_data_.highWatermark(); }
+    void setPriorityWeight(uint32_t weight) override;
 
     void setWriteBufferWatermarks(uint32_t low_watermark, uint32_t high_watermark) {
       pending_recv_data_.setWatermarks(low_watermark, high_watermark);
@@ -201,6 +211,7 @@ protected:
     HeaderMapImplPtr headers_;
     StreamDecoder* decoder_{};
     int32_t stream_id_{-1};
+    uint32_t weight_{NGHTTP2_DEFAULT_WEIGHT};
     uint32_t unconsumed_bytes_{0};
     uint32_t read_disable_count_{0};
     Buffer::WatermarkBuffer pending_recv_data_{
@@ -270,6 +281,9 @@ protected:
 
   ConnectionImpl* base() { return this; }
   StreamImpl* getStream(int32_t stream_id);
+  // Whether the DATA frames of streams are held until the connection drains. @see
+  // Http2Settings::prioritize_streams_.
+  bool holdData() const { return prioritize_streams_ && connection_above_high_watermark_; }
   int saveHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value);
   void sendPendingFrames();
   void sendSettings(const Http2Settings& http2_settings, bool disable_push);
@@ -281,11 +295,30 @@ protected:
   CodecStats stats_;
   Network::Connection& connection_;
   uint32_t per_stream_buffer_limit_;
+  const bool prioritize_streams_;
 
 private:
   virtual ConnectionCallbacks& callbacks() PURE;
   virtual int onBeginHeaders(const nghttp2_frame* frame) PURE;
   int onData(int32_t stream_id, const uint8_t* data, size_t len);
+  /**
+   * Add received data to the stream by referencing it in the buffer being dispatched, if enabled
+   * and worthwhile. The buffer is then pinned once dispatching ends.
+   * @return whether the data was referenced.
+   */
+  bool referenceData(StreamImpl& stream, const uint8_t* data, size_t len);
+  void pinReferencedData(Buffer::Instance& data);
+  /**
+   * Account received DATA to the bandwidth-delay product estimate, starting a measurement with a
+   * PING if none is in flight and the windows can still grow.
+   */
+  void sampleBdp(size_t len);
+  /**
+   * Complete the bandwidth-delay product measurement, growing the receive windows to twice the
+   * DATA received during the round trip if the window was mostly used and the bandwidth is the
+   * highest measured.
+   */
+  void onBdpPingAck();
   int onFrameReceived(const nghttp2_frame* frame);
   int onFrameSend(const nghttp2_frame* frame);
   virtual int onHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value) PURE;
@@ -293,9 +326,29 @@ private:
   ssize_t onSend(const uint8_t* data, size_t length);
   int onStreamClose(int32_t stream_id, uint32_t error_code);
 
+  const bool reference_received_data_;
+  // Holds the slices of dispatched data referenced by the received data of streams.
+  std::shared_ptr<Buffer::OwnedImpl> pinned_data_;
+  // The slice being dispatched.
+  const uint8_t* current_slice_{};
+  const uint8_t* current_slice_end_{};
+  // Reused by streams to pass headers to nghttp2, which copies the array when they are submitted.
+  std::vector<nghttp2_nv> final_headers_;
+  // @see Http2Settings::auto_tuned_window_size_limit_.
+  const uint32_t auto_tuned_window_size_limit_;
+  // The receive windows, which only change when auto tuned.
+  uint32_t stream_window_size_;
+  uint32_t connection_window_size_;
+  // The DATA received since the BDP PING was sent, and when it was sent.
+  uint64_t bdp_sample_{};
+  MonotonicTime bdp_ping_sent_time_;
+  // The highest bandwidth measured, in bytes per second.
+  double max_bandwidth_{};
   bool dispatching_ : 1;
   bool raised_goaway_ : 1;
   bool pending_deferred_reset_ : 1;
+  bool connection_above_high_watermark_ : 1;
+  bool bdp_ping_outstanding_ : 1;
 };
 
 /**
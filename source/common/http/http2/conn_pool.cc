@@ -17,15 +17,21 @@ namespace Http2 {
 ConnPoolImpl::ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
                            Upstream::ResourcePriority priority,
                            const Network::ConnectionSocket::OptionsSharedPtr& options)
-    : dispatcher_(dispatcher), host_(host), priority_(priority), socket_options_(options) {}
+    : dispatcher_(dispatcher), host_(host),
+      primary_clients_(host_->cluster().http2Settings().max_connections_per_host_),
+      draining_clients_(primary_clients_.size()), priority_(priority), socket_options_(options) {
+  ASSERT(!primary_clients_.empty());
+}
 
 ConnPoolImpl::~ConnPoolImpl() {
-  if (primary_client_) {
-    primary_client_->client_->close();
-  }
+  for (size_t slot = 0; slot < primary_clients_.size(); slot++) {
+    if (primary_clients_[slot]) {
+      primary_clients_[slot]->client_->close();
+    }
 
-  if (draining_client_) {
-    draining_client_->client_->close();
+    if (draining_clients_[slot]) {
+      draining_clients_[slot]->client_->close();
+    }
   }
 
   // Make sure all clients are destroyed before we are destroyed.
@@ -33,8 +39,10 @@ ConnPoolImpl::~ConnPoolImpl() {
 }
 
 void ConnPoolImpl::ConnPoolImpl::drainConnections() {
-  if (primary_client_ != nullptr) {
-    movePrimaryClientToDraining();
+  for (size_t slot = 0; slot < primary_clients_.size(); slot++) {
+    if (primary_clients_[slot] != nullptr) {
+      movePrimaryClientToDraining(slot);
+    }
   }
 }
 
@@ -49,18 +57,22 @@ void ConnPoolImpl::checkForDrained() {
   }
 
   bool drained = true;
-  if (primary_client_) {
-    if (primary_client_->client_->numActiveRequests() == 0) {
-      primary_client_->client_->close();
-      ASSERT(!primary_client_);
-    } else {
-      drained = false;
+  for (size_t slot = 0; slot < primary_clients_.size(); slot++) {
+    ActiveClientPtr& primary_client = primary_clients_[slot];
+    if (primary_client) {
+      if (primary_client->client_->numActiveRequests() == 0) {
+        primary_client->client_->close();
+        ASSERT(!primary_client);
+      } else {
+        drained = false;
+      }
     }
-  }
 
-  ASSERT(!draining_client_ || (draining_client_->client_->numActiveRequests() > 0));
-  if (draining_client_ && draining_client_->client_->numActiveRequests() > 0) {
-    drained = false;
+    const ActiveClientPtr& draining_client = draining_clients_[slot];
+    ASSERT(!draining_client || (draining_client->client_->numActiveRequests() > 0));
+    if (draining_client && draining_client->client_->numActiveRequests() > 0) {
+      drained = false;
+    }
   }
 
   if (drained) {
@@ -75,39 +87,63 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
                                                      ConnectionPool::Callbacks& callbacks) {
   ASSERT(drained_callbacks_.empty());
 
-  // First see if we need to handle max streams rollover.
-  uint64_t max_streams = host_->cluster().maxRequestsPerConnection();
-  if (max_streams == 0) {
-    max_streams = maxTotalStreams();
-  }
-
-  if (primary_client_ && primary_client_->total_streams_ >= max_streams) {
-    movePrimaryClientToDraining();
-  }
-
-  if (!primary_client_) {
-    primary_client_.reset(new ActiveClient(*this));
-  }
+  ActiveClient& primary_client = selectPrimaryClient();
 
   if (!host_->cluster().resourceManager(priority_).requests().canCreate()) {
     ENVOY_LOG(debug, "max requests overflow");
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
     host_->cluster().stats().upstream_rq_pending_overflow_.inc();
   } else {
-    ENVOY_CONN_LOG(debug, "creating stream", *primary_client_->client_);
-    primary_client_->total_streams_++;
+    ENVOY_CONN_LOG(debug, "creating stream", *primary_client.client_);
+    primary_client.total_streams_++;
     host_->stats().rq_total_.inc();
     host_->stats().rq_active_.inc();
     host_->cluster().stats().upstream_rq_total_.inc();
     host_->cluster().stats().upstream_rq_active_.inc();
     host_->cluster().resourceManager(priority_).requests().inc();
-    callbacks.onPoolReady(primary_client_->client_->newStream(response_decoder),
-                          primary_client_->real_host_description_);
+    callbacks.onPoolReady(primary_client.client_->newStream(response_decoder),
+                          primary_client.real_host_description_);
   }
 
   return nullptr;
 }
 
+ConnPoolImpl::ActiveClient& ConnPoolImpl::selectPrimaryClient() {
+  // First see if we need to handle max streams rollover.
+  uint64_t max_streams = host_->cluster().maxRequestsPerConnection();
+  if (max_streams == 0) {
+    max_streams = maxTotalStreams();
+  }
+
+  ActiveClient* least_active_client = nullptr;
+  size_t empty_slot = primary_clients_.size();
+  for (size_t slot = 0; slot < primary_clients_.size(); slot++) {
+    if (primary_clients_[slot] && primary_clients_[slot]->total_streams_ >= max_streams) {
+      movePrimaryClientToDraining(slot);
+    }
+
+    ActiveClient* client = primary_clients_[slot].get();
+    if (client == nullptr) {
+      if (empty_slot == primary_clients_.size()) {
+        empty_slot = slot;
+      }
+    } else if (least_active_client == nullptr ||
+               client->client_->numActiveRequests() <
+                   least_active_client->client_->numActiveRequests()) {
+      least_active_client = client;
+    }
+  }
+
+  // Only open another connection once all the others have streams to carry.
+  if (empty_slot < primary_clients_.size() &&
+      (least_active_client == nullptr || least_active_client->client_->numActiveRequests() > 0)) {
+    primary_clients_[empty_slot].reset(new ActiveClient(*this, empty_slot));
+    least_active_client = primary_clients_[empty_slot].get();
+  }
+
+  return *least_active_client;
+}
+
 void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
@@ -121,12 +157,12 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       }
     }
 
-    if (&client == primary_client_.get()) {
+    if (&client == primary_clients_[client.slot_].get()) {
       ENVOY_CONN_LOG(debug, "destroying primary client", *client.client_);
-      dispatcher_.deferredDelete(std::move(primary_client_));
+      dispatcher_.deferredDelete(std::move(primary_clients_[client.slot_]));
     } else {
       ENVOY_CONN_LOG(debug, "destroying draining client", *client.client_);
-      dispatcher_.deferredDelete(std::move(draining_client_));
+      dispatcher_.deferredDelete(std::move(draining_clients_[client.slot_]));
     }
 
     if (client.connect_timer_) {
@@ -149,25 +185,27 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   }
 }
 
-void ConnPoolImpl::movePrimaryClientToDraining() {
-  ENVOY_CONN_LOG(debug, "moving primary to draining", *primary_client_->client_);
-  if (draining_client_) {
+void ConnPoolImpl::movePrimaryClientToDraining(size_t slot) {
+  ActiveClientPtr& primary_client = primary_clients_[slot];
+  ActiveClientPtr& draining_client = draining_clients_[slot];
+  ENVOY_CONN_LOG(debug, "moving primary to draining", *primary_client->client_);
+  if (draining_client) {
     // This should pretty much never happen, but is possible if we start draining and then get
     // a goaway for example. In this case just kill the current draining connection. It's not
     // worth keeping a list.
-    draining_client_->client_->close();
+    draining_client->client_->close();
   }
 
-  ASSERT(!draining_client_);
-  if (primary_client_->client_->numActiveRequests() == 0) {
+  ASSERT(!draining_client);
+  if (primary_client->client_->numActiveRequests() == 0) {
     // If we are making a new connection and the primary does not have any active requests just
     // close it now.
-    primary_client_->client_->close();
+    primary_client->client_->close();
   } else {
-    draining_client_ = std::move(primary_client_);
+    draining_client = std::move(primary_client);
   }
 
-  ASSERT(!primary_client_);
+  ASSERT(!primary_client);
 }
 
 void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
@@ -179,8 +217,8 @@ void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
 void ConnPoolImpl::onGoAway(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "remote goaway", *client.client_);
   host_->cluster().stats().upstream_cx_close_notify_.inc();
-  if (&client == primary_client_.get()) {
-    movePrimaryClientToDraining();
+  if (&client == primary_clients_[client.slot_].get()) {
+    movePrimaryClientToDraining(client.slot_);
   }
 }
 
@@ -190,7 +228,8 @@ void ConnPoolImpl::onStreamDestroy(ActiveClient& client) {
   host_->stats().rq_active_.dec();
   host_->cluster().stats().upstream_rq_active_.dec();
   host_->cluster().resourceManager(priority_).requests().dec();
-  if (&client == draining_client_.get() && client.client_->numActiveRequests() == 0) {
+  if (&client == draining_clients_[client.slot_].get() &&
+      client.client_->numActiveRequests() == 0) {
     // Close out the draining client if we no long have active requests.
     client.client_->close();
   }
@@ -215,8 +254,8 @@ void ConnPoolImpl::onStreamReset(ActiveClient& client, Http::StreamResetReason r
   }
 }
 
-ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
-    : parent_(parent),
+ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent, size_t slot)
+    : parent_(parent), slot_(slot),
       connect_timer_(parent_.dispatcher_.createTimer([this]() -> void { onConnectTimeout(); })) {
 
   parent_.conn_connect_ms_.reset(
@@ -237,16 +276,22 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
   parent_.host_->cluster().stats().upstream_cx_http2_total_.inc();
   conn_length_.reset(new Stats::Timespan(parent_.host_->cluster().stats().upstream_cx_length_ms_));
 
-  client_->setConnectionStats({parent_.host_->cluster().stats().upstream_cx_rx_bytes_total_,
-                               parent_.host_->cluster().stats().upstream_cx_rx_bytes_buffered_,
-                               parent_.host_->cluster().stats().upstream_cx_tx_bytes_total_,
-                               parent_.host_->cluster().stats().upstream_cx_tx_bytes_buffered_,
-                               &parent_.host_->cluster().stats().bind_errors_});
+  client_->setConnectionStats(
+      {parent_.host_->cluster().stats().upstream_cx_rx_bytes_total_,
+       parent_.host_->cluster().stats().upstream_cx_rx_bytes_buffered_,
+       parent_.host_->cluster().stats().upstream_cx_tx_bytes_total_,
+       parent_.host_->cluster().stats().upstream_cx_tx_bytes_buffered_,
+       &parent_.host_->cluster().stats().bind_errors_,
+       &parent_.host_->cluster().stats().upstream_cx_read_budget_exhausted_,
+       &parent_.host_->cluster().stats().upstream_cx_tx_buffer_above_high_watermark_ms_,
+       &parent_.host_->cluster().stats().upstream_cx_connect_fallback_,
+       &parent_.host_->cluster().stats().upstream_cx_tfo_syn_data_acked_});
 }
 
 ConnPoolImpl::ActiveClient::~ActiveClient() {
   parent_.host_->stats().cx_active_.dec();
   parent_.host_->cluster().stats().upstream_cx_active_.dec();
+  parent_.host_->cluster().stats().upstream_cx_http2_streams_.recordValue(total_streams_);
   conn_length_->complete();
 }
 
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <vector>
 
 #include "envoy/event/timer.h"
 #include "envoy/http/conn_pool.h"
@@ -20,6 +21,11 @@ namespace Http2 {
  * Implementation of a "connection pool" for HTTP/2. This mainly handles stats as well as
  * shifting to a new connection if we reach max streams on the primary. This is a base class
  * used for both the prod implementation as well as the testing one.
+ *
+ * The pool has a slot per connection it may keep open to the host, as set by
+ * Http2Settings::max_connections_per_host_. Each slot has a primary client, which new streams are
+ * sent on, and a draining client. New streams go to the primary with the fewest active streams,
+ * and the primary of an empty slot is only connected once all the other primaries are busy.
  */
 class ConnPoolImpl : Logger::Loggable<Logger::Id::pool>, public ConnectionPool::Instance {
 public:
@@ -40,7 +46,7 @@ protected:
                         public CodecClientCallbacks,
                         public Event::DeferredDeletable,
                         public Http::ConnectionCallbacks {
-    ActiveClient(ConnPoolImpl& parent);
+    ActiveClient(ConnPoolImpl& parent, size_t slot);
     ~ActiveClient();
 
     void onConnectTimeout() { parent_.onConnectTimeout(*this); }
@@ -62,6 +68,7 @@ protected:
     void onGoAway() override { parent_.onGoAway(*this); }
 
     ConnPoolImpl& parent_;
+    const size_t slot_;
     CodecClientPtr client_;
     Upstream::HostDescriptionConstSharedPtr real_host_description_;
     uint64_t total_streams_{};
@@ -75,18 +82,20 @@ protected:
   void checkForDrained();
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   virtual uint32_t maxTotalStreams() PURE;
-  void movePrimaryClientToDraining();
+  void movePrimaryClientToDraining(size_t slot);
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onConnectTimeout(ActiveClient& client);
   void onGoAway(ActiveClient& client);
   void onStreamDestroy(ActiveClient& client);
   void onStreamReset(ActiveClient& client, Http::StreamResetReason reason);
+  ActiveClient& selectPrimaryClient();
 
   Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
   Upstream::HostConstSharedPtr host_;
-  ActiveClientPtr primary_client_;
-  ActiveClientPtr draining_client_;
+  // Indexed by slot.
+  std::vector<ActiveClientPtr> primary_clients_;
+  std::vector<ActiveClientPtr> draining_clients_;
   std::list<DrainedCb> drained_callbacks_;
   Upstream::ResourcePriority priority_;
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
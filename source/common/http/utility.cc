@@ -55,11 +55,13 @@ std::string Utility::createSslRedirectPath(const HeaderMap& headers) {
                      headers.Path()->value().c_str());
 }
 
-Utility::QueryParams Utility::parseQueryString(absl::string_view url) {
-  QueryParams params;
+namespace {
+
+// Calls cb with the name and value of each parameter of the query string of the url, in order.
+template <class Callback> void forEachQueryParam(absl::string_view url, Callback cb) {
   size_t start = url.find('?');
   if (start == std::string::npos) {
-    return params;
+    return;
   }
 
   start++;
@@ -72,18 +74,41 @@ Utility::QueryParams Utility::parseQueryString(absl::string_view url) {
 
     const size_t equal = param.find('=');
     if (equal != std::string::npos) {
-      params.emplace(StringUtil::subspan(url, start, start + equal),
-                     StringUtil::subspan(url, start + equal + 1, end));
+      cb(param.substr(0, equal), param.substr(equal + 1));
     } else {
-      params.emplace(StringUtil::subspan(url, start, end), "");
+      cb(param, absl::string_view());
     }
 
     start = end + 1;
   }
+}
+
+} // namespace
 
+Utility::QueryParams Utility::parseQueryString(absl::string_view url) {
+  QueryParams params;
+  forEachQueryParam(url, [&params](absl::string_view name, absl::string_view value) {
+    params.emplace(std::string(name), std::string(value));
+  });
   return params;
 }
 
+absl::optional<absl::string_view> Utility::QueryParamsView::get(absl::string_view name) const {
+  if (!parsed_) {
+    forEachQueryParam(url_, [this](absl::string_view param_name, absl::string_view param_value) {
+      params_.emplace_back(param_name, param_value);
+    });
+    parsed_ = true;
+  }
+
+  for (const auto& param : params_) {
+    if (param.first == name) {
+      return param.second;
+    }
+  }
+  return absl::nullopt;
+}
+
 const char* Utility::findQueryStringStart(const HeaderString& path) {
   return std::find(path.c_str(), path.c_str() + path.size(), '?');
 }
@@ -234,15 +259,28 @@ Utility::parseHttp2Settings(const envoy::api::v2::core::Http2ProtocolOptions& co
       PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, initial_connection_window_size,
                                       Http::Http2Settings::DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE);
   ret.allow_connect_ = config.allow_connect();
+  ret.max_connections_per_host_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      config, max_connections_per_host, Http::Http2Settings::DEFAULT_MAX_CONNECTIONS_PER_HOST);
+  ret.reference_received_data_ = config.reference_received_data();
+  ret.prioritize_streams_ = config.prioritize_streams();
+  ret.auto_tuned_window_size_limit_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, auto_tuned_window_size_limit, 0);
   return ret;
 }
 
+uint32_t Utility::priorityWeight(Upstream::ResourcePriority priority) {
+  // The largest HTTP/2 stream weight, and the default one.
+  return priority == Upstream::ResourcePriority::High ? 256 : 16;
+}
+
 Http1Settings
 Utility::parseHttp1Settings(const envoy::api::v2::core::Http1ProtocolOptions& config) {
   Http1Settings ret;
   ret.allow_absolute_url_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, allow_absolute_url, false);
   ret.accept_http_10_ = config.accept_http_10();
   ret.default_host_for_http_10_ = config.default_host_for_http_10();
+  ret.use_vectorized_parser_ = config.use_vectorized_parser();
+  ret.reference_header_values_ = config.reference_header_values();
   return ret;
 }
 
@@ -3,6 +3,8 @@
 #include <chrono>
 #include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "envoy/api/v2/core/http_uri.pb.h"
 #include "envoy/api/v2/core/protocol.pb.h"
@@ -11,10 +13,12 @@
 #include "envoy/http/filter.h"
 #include "envoy/http/message.h"
 #include "envoy/http/query_params.h"
+#include "envoy/upstream/resource_manager.h"
 
 #include "common/json/json_loader.h"
 
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Http {
@@ -48,6 +52,27 @@ std::string createSslRedirectPath(const HeaderMap& headers);
  */
 QueryParams parseQueryString(absl::string_view url);
 
+/**
+ * The query parameters of a URL, parsed on first use into views of the URL. Several lookups parse
+ * the query string at most once, and nothing is copied. The URL must outlive the view. As with
+ * parseQueryString(), the first value of a repeated parameter wins and values are not decoded.
+ */
+class QueryParamsView {
+public:
+  explicit QueryParamsView(absl::string_view url) : url_(url) {}
+
+  /**
+   * @param name supplies the name of the parameter.
+   * @return the value of the parameter, or absl::nullopt if the URL does not have it.
+   */
+  absl::optional<absl::string_view> get(absl::string_view name) const;
+
+private:
+  const absl::string_view url_;
+  mutable bool parsed_{};
+  mutable std::vector<std::pair<absl::string_view, absl::string_view>> params_;
+};
+
 /**
  * Finds the start of the query string in a path
  * @param path supplies a HeaderString& to search for the query string
@@ -120,6 +145,12 @@ bool isWebSocketUpgradeRequest(const HeaderMap& headers);
  */
 Http2Settings parseHttp2Settings(const envoy::api::v2::core::Http2ProtocolOptions& config);
 
+/**
+ * @return uint32_t the weight of the streams of a route priority class.
+ *         @see Http::Stream::setPriorityWeight().
+ */
+uint32_t priorityWeight(Upstream::ResourcePriority priority);
+
 /**
  * @return Http1Settings An Http1Settings populated from the
  * envoy::api::v2::core::Http1ProtocolOptions config.
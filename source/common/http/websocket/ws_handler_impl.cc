@@ -38,6 +38,8 @@ TcpProxy::ConfigSharedPtr Config(const envoy::api::v2::route::RouteAction& route
     if (ws_config.has_max_connect_attempts()) {
       *tcp_config.mutable_max_connect_attempts() = ws_config.max_connect_attempts();
     }
+
+    tcp_config.set_splice(ws_config.splice());
   }
   return std::make_shared<TcpProxy::Config>(tcp_config, factory_context);
 }
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <fstream>
 #include <limits>
+#include <memory>
 #include <sstream>
 #include <stack>
 #include <string>
@@ -12,6 +13,8 @@
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
 #include "common/common/hash.h"
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
 #include "common/common/utility.h"
 #include "common/filesystem/filesystem_impl.h"
 
@@ -52,7 +55,7 @@ public:
 
   // Value factory.
   template <typename T> static FieldSharedPtr createValue(T value) {
-    return FieldSharedPtr{new Field(value)};
+    return FieldSharedPtr{new Field(std::move(value))};
   }
 
   void append(FieldSharedPtr field_ptr) {
@@ -131,7 +134,9 @@ private:
   };
 
   explicit Field(Type type) : type_(type) {}
-  explicit Field(const std::string& value) : type_(Type::String) { value_.string_value_ = value; }
+  explicit Field(std::string&& value) : type_(Type::String) {
+    value_.string_value_ = std::move(value);
+  }
   explicit Field(int64_t value) : type_(Type::Integer) { value_.integer_value_ = value; }
   explicit Field(double value) : type_(Type::Double) { value_.double_value_ = value; }
   explicit Field(bool value) : type_(Type::Boolean) { value_.boolean_value_ = value; }
@@ -150,7 +155,7 @@ private:
     checkType(Type::String);
     return value_.string_value_;
   }
-  std::vector<FieldSharedPtr> arrayValue() const {
+  const std::vector<FieldSharedPtr>& arrayValue() const {
     checkType(Type::Array);
     return value_.array_value_;
   }
@@ -167,9 +172,9 @@ private:
     return value_.integer_value_;
   }
 
-  rapidjson::Document asRapidJsonDocument() const;
-  static void buildRapidJsonDocument(const Field& field, rapidjson::Value& value,
-                                     rapidjson::Document::AllocatorType& allocator);
+  // Replays the field as SAX events, so that it can be written or validated without first being
+  // copied into a rapidjson::Document.
+  template <class Handler> bool accept(Handler& handler) const;
 
   uint64_t line_number_start_ = 0;
   uint64_t line_number_end_ = 0;
@@ -197,6 +202,27 @@ private:
   uint64_t line_number_;
 };
 
+/**
+ * Schemas compiled by validateSchema(). The schemas are the constant strings of config_schemas.cc
+ * and of the extensions, so that the cache is bounded and compiling each of them once avoids
+ * recompiling the same schema for every object of a large v1 config.
+ */
+class SchemaCache {
+public:
+  static SchemaCache& instance();
+
+  /**
+   * @param schema supplies the JSON schema.
+   * @return const rapidjson::SchemaDocument& the compiled schema, valid for the process lifetime.
+   * Throws std::invalid_argument if the schema is not valid JSON.
+   */
+  const rapidjson::SchemaDocument& get(const std::string& schema);
+
+private:
+  Thread::MutexBasicLockable lock_;
+  std::unordered_map<std::string, std::unique_ptr<rapidjson::SchemaDocument>> schemas_;
+};
+
 /**
  * Consume events from SAX callbacks to build JSON Field.
  */
@@ -240,93 +266,48 @@ private:
   FieldSharedPtr root_;
 };
 
-void Field::buildRapidJsonDocument(const Field& field, rapidjson::Value& value,
-                                   rapidjson::Document::AllocatorType& allocator) {
-
-  switch (field.type_) {
-  case Type::Array: {
-    value.SetArray();
-    value.Reserve(field.value_.array_value_.size(), allocator);
-    for (const auto& element : field.value_.array_value_) {
-      switch (element->type_) {
-      case Type::Array:
-      case Type::Object: {
-        rapidjson::Value nested_value;
-        buildRapidJsonDocument(*element, nested_value, allocator);
-        value.PushBack(nested_value, allocator);
-        break;
-      }
-      case Type::Boolean:
-        value.PushBack(element->value_.boolean_value_, allocator);
-        break;
-      case Type::Double:
-        value.PushBack(element->value_.double_value_, allocator);
-        break;
-      case Type::Integer:
-        value.PushBack(element->value_.integer_value_, allocator);
-        break;
-      case Type::Null:
-        value.PushBack(rapidjson::Value(), allocator);
-        break;
-      case Type::String:
-        value.PushBack(rapidjson::StringRef(element->value_.string_value_.c_str()), allocator);
-      }
+template <class Handler> bool Field::accept(Handler& handler) const {
+  switch (type_) {
+  case Type::Array:
+    if (!handler.StartArray()) {
+      return false;
     }
-    break;
-  }
-  case Type::Object: {
-    value.SetObject();
-    for (const auto& item : field.value_.object_value_) {
-      auto name = rapidjson::StringRef(item.first.c_str());
-
-      switch (item.second->type_) {
-      case Type::Array:
-      case Type::Object: {
-        rapidjson::Value nested_value;
-        buildRapidJsonDocument(*item.second, nested_value, allocator);
-        value.AddMember(name, nested_value, allocator);
-        break;
+    for (const auto& element : value_.array_value_) {
+      if (!element->accept(handler)) {
+        return false;
       }
-      case Type::Boolean:
-        value.AddMember(name, item.second->value_.boolean_value_, allocator);
-        break;
-      case Type::Double:
-        value.AddMember(name, item.second->value_.double_value_, allocator);
-        break;
-      case Type::Integer:
-        value.AddMember(name, item.second->value_.integer_value_, allocator);
-        break;
-      case Type::Null:
-        value.AddMember(name, rapidjson::Value(), allocator);
-        break;
-      case Type::String:
-        value.AddMember(name, rapidjson::StringRef(item.second->value_.string_value_.c_str()),
-                        allocator);
-        break;
+    }
+    return handler.EndArray(value_.array_value_.size());
+  case Type::Boolean:
+    return handler.Bool(value_.boolean_value_);
+  case Type::Double:
+    return handler.Double(value_.double_value_);
+  case Type::Integer:
+    return handler.Int64(value_.integer_value_);
+  case Type::Null:
+    return handler.Null();
+  case Type::Object:
+    if (!handler.StartObject()) {
+      return false;
+    }
+    for (const auto& item : value_.object_value_) {
+      if (!handler.Key(item.first.c_str(), item.first.size(), false) ||
+          !item.second->accept(handler)) {
+        return false;
       }
     }
-    break;
-  }
-  case Type::Null: {
-    value.SetNull();
-    break;
+    return handler.EndObject(value_.object_value_.size());
+  case Type::String:
+    return handler.String(value_.string_value_.c_str(), value_.string_value_.size(), false);
   }
-  default:
-    NOT_REACHED_GCOVR_EXCL_LINE;
-  }
-}
 
-rapidjson::Document Field::asRapidJsonDocument() const {
-  rapidjson::Document document;
-  rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
-  buildRapidJsonDocument(*this, document, allocator);
-  return document;
+  NOT_REACHED_GCOVR_EXCL_LINE;
 }
 
 uint64_t Field::hash() const {
   rapidjson::StringBuffer buffer;
   rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-  asRapidJsonDocument().Accept(writer);
+  accept(writer);
   return HashUtil::xxHash64(buffer.GetString());
 }
 
@@ -420,7 +401,7 @@ std::vector<ObjectSharedPtr> Field::getObjectArray(const std::string& name,
                                 line_number_start_, line_number_end_));
   }
 
-  std::vector<FieldSharedPtr> array_value = value_itr->second->arrayValue();
+  const std::vector<FieldSharedPtr>& array_value = value_itr->second->arrayValue();
   return {array_value.begin(), array_value.end()};
 }
 
@@ -456,7 +437,7 @@ std::vector<std::string> Field::getStringArray(const std::string& name, bool all
                                 line_number_start_, line_number_end_));
   }
 
-  std::vector<FieldSharedPtr> array = value_itr->second->arrayValue();
+  const std::vector<FieldSharedPtr>& array = value_itr->second->arrayValue();
   string_array.reserve(array.size());
   for (const auto& element : array) {
     if (!element->isType(Type::String)) {
@@ -477,8 +458,7 @@ std::vector<ObjectSharedPtr> Field::asObjectArray() const {
 std::string Field::asJsonString() const {
   rapidjson::StringBuffer buffer;
   rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-  rapidjson::Document document = asRapidJsonDocument();
-  document.Accept(writer);
+  accept(writer);
   return buffer.GetString();
 }
 
@@ -509,7 +489,13 @@ void Field::iterate(const ObjectCallback& callback) const {
   }
 }
 
-void Field::validateSchema(const std::string& schema) const {
+const rapidjson::SchemaDocument& SchemaCache::get(const std::string& schema) {
+  Thread::LockGuard lock(lock_);
+  auto it = schemas_.find(schema);
+  if (it != schemas_.end()) {
+    return *it->second;
+  }
+
   rapidjson::Document schema_document;
   if (schema_document.Parse<0>(schema.c_str()).HasParseError()) {
     throw std::invalid_argument(fmt::format(
@@ -517,10 +503,22 @@ void Field::validateSchema(const std::string& schema) const {
         schema_document.GetErrorOffset(), GetParseError_En(schema_document.GetParseError())));
   }
 
-  rapidjson::SchemaDocument schema_document_for_validator(schema_document);
-  rapidjson::SchemaValidator schema_validator(schema_document_for_validator);
+  auto compiled = std::make_unique<rapidjson::SchemaDocument>(schema_document);
+  const rapidjson::SchemaDocument& ret = *compiled;
+  schemas_.emplace(schema, std::move(compiled));
+  return ret;
+}
+
+SchemaCache& SchemaCache::instance() {
+  // Leaked on purpose, as the JSON config of static objects may be validated during shutdown.
+  static SchemaCache* cache = new SchemaCache();
+  return *cache;
+}
+
+void Field::validateSchema(const std::string& schema) const {
+  rapidjson::SchemaValidator schema_validator(SchemaCache::instance().get(schema));
 
-  if (!asRapidJsonDocument().Accept(schema_validator)) {
+  if (!accept(schema_validator)) {
     rapidjson::StringBuffer schema_string_buffer;
     rapidjson::StringBuffer document_string_buffer;
 
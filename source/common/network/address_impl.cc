@@ -42,6 +42,44 @@ void validateIpv6Supported(const std::string& address) {
   }
 }
 
+// Send a datagram to the socket address.
+Api::SysCallSizeResult sendMsg(int fd, const sockaddr* address, socklen_t address_length,
+                               const iovec* iov, int iovcnt) {
+  msghdr message{};
+  message.msg_name = const_cast<sockaddr*>(address);
+  message.msg_namelen = address_length;
+  message.msg_iov = const_cast<iovec*>(iov);
+  message.msg_iovlen = iovcnt;
+  const ssize_t rc = ::sendmsg(fd, &message, 0);
+  return {rc, errno};
+}
+
+// Send datagrams to the socket address, stopping at the first that can not be sent.
+Api::SysCallIntResult sendMMsg(int fd, const sockaddr* address, socklen_t address_length,
+                               const iovec* datagrams, int num_datagrams) {
+#if defined(__linux__)
+  mmsghdr messages[num_datagrams];
+  memset(messages, 0, sizeof(messages));
+  for (int i = 0; i < num_datagrams; ++i) {
+    messages[i].msg_hdr.msg_name = const_cast<sockaddr*>(address);
+    messages[i].msg_hdr.msg_namelen = address_length;
+    messages[i].msg_hdr.msg_iov = const_cast<iovec*>(&datagrams[i]);
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+  const int rc = ::sendmmsg(fd, messages, num_datagrams, 0);
+  return {rc, errno};
+#else
+  int sent = 0;
+  for (; sent < num_datagrams; ++sent) {
+    const Api::SysCallSizeResult result = sendMsg(fd, address, address_length, &datagrams[sent], 1);
+    if (result.rc_ == -1) {
+      return {sent > 0 ? sent : -1, result.errno_};
+    }
+  }
+  return {sent, 0};
+#endif
+}
+
 } // namespace
 
 // Check if an IP family is supported on this machine.
@@ -226,6 +264,17 @@ Api::SysCallIntResult Ipv4Instance::connect(int fd) const {
   return {rc, errno};
 }
 
+Api::SysCallSizeResult Ipv4Instance::sendTo(int fd, const iovec* iov, int iovcnt) const {
+  return sendMsg(fd, reinterpret_cast<const sockaddr*>(&ip_.ipv4_.address_),
+                 sizeof(ip_.ipv4_.address_), iov, iovcnt);
+}
+
+Api::SysCallIntResult Ipv4Instance::sendBatchTo(int fd, const iovec* datagrams,
+                                                int num_datagrams) const {
+  return sendMMsg(fd, reinterpret_cast<const sockaddr*>(&ip_.ipv4_.address_),
+                  sizeof(ip_.ipv4_.address_), datagrams, num_datagrams);
+}
+
 int Ipv4Instance::socket(SocketType type) const { return socketFromSocketType(type); }
 
 absl::uint128 Ipv6Instance::Ipv6Helper::address() const {
@@ -291,6 +340,17 @@ Api::SysCallIntResult Ipv6Instance::connect(int fd) const {
   return {rc, errno};
 }
 
+Api::SysCallSizeResult Ipv6Instance::sendTo(int fd, const iovec* iov, int iovcnt) const {
+  return sendMsg(fd, reinterpret_cast<const sockaddr*>(&ip_.ipv6_.address_),
+                 sizeof(ip_.ipv6_.address_), iov, iovcnt);
+}
+
+Api::SysCallIntResult Ipv6Instance::sendBatchTo(int fd, const iovec* datagrams,
+                                                int num_datagrams) const {
+  return sendMMsg(fd, reinterpret_cast<const sockaddr*>(&ip_.ipv6_.address_),
+                  sizeof(ip_.ipv6_.address_), datagrams, num_datagrams);
+}
+
 int Ipv6Instance::socket(SocketType type) const {
   const int fd = socketFromSocketType(type);
   // Setting IPV6_V6ONLY resticts the IPv6 socket to IPv6 connections only.
@@ -362,6 +422,25 @@ Api::SysCallIntResult PipeInstance::connect(int fd) const {
   return {rc, errno};
 }
 
+Api::SysCallSizeResult PipeInstance::sendTo(int fd, const iovec* iov, int iovcnt) const {
+  if (abstract_namespace_) {
+    return sendMsg(fd, reinterpret_cast<const sockaddr*>(&address_),
+                   offsetof(struct sockaddr_un, sun_path) + address_length_, iov, iovcnt);
+  }
+  return sendMsg(fd, reinterpret_cast<const sockaddr*>(&address_), sizeof(address_), iov, iovcnt);
+}
+
+Api::SysCallIntResult PipeInstance::sendBatchTo(int fd, const iovec* datagrams,
+                                                int num_datagrams) const {
+  if (abstract_namespace_) {
+    return sendMMsg(fd, reinterpret_cast<const sockaddr*>(&address_),
+                    offsetof(struct sockaddr_un, sun_path) + address_length_, datagrams,
+                    num_datagrams);
+  }
+  return sendMMsg(fd, reinterpret_cast<const sockaddr*>(&address_), sizeof(address_), datagrams,
+                  num_datagrams);
+}
+
 int PipeInstance::socket(SocketType type) const { return socketFromSocketType(type); }
 
 } // namespace Address
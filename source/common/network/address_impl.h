@@ -99,6 +99,9 @@ public:
   bool operator==(const Instance& rhs) const override;
   Api::SysCallIntResult bind(int fd) const override;
   Api::SysCallIntResult connect(int fd) const override;
+  Api::SysCallSizeResult sendTo(int fd, const iovec* iov, int iovcnt) const override;
+  Api::SysCallIntResult sendBatchTo(int fd, const iovec* datagrams,
+                                    int num_datagrams) const override;
   const Ip* ip() const override { return &ip_; }
   int socket(SocketType type) const override;
 
@@ -159,6 +162,9 @@ public:
   bool operator==(const Instance& rhs) const override;
   Api::SysCallIntResult bind(int fd) const override;
   Api::SysCallIntResult connect(int fd) const override;
+  Api::SysCallSizeResult sendTo(int fd, const iovec* iov, int iovcnt) const override;
+  Api::SysCallIntResult sendBatchTo(int fd, const iovec* datagrams,
+                                    int num_datagrams) const override;
   const Ip* ip() const override { return &ip_; }
   int socket(SocketType type) const override;
 
@@ -216,6 +222,9 @@ public:
   bool operator==(const Instance& rhs) const override;
   Api::SysCallIntResult bind(int fd) const override;
   Api::SysCallIntResult connect(int fd) const override;
+  Api::SysCallSizeResult sendTo(int fd, const iovec* iov, int iovcnt) const override;
+  Api::SysCallIntResult sendBatchTo(int fd, const iovec* datagrams,
+                                    int num_datagrams) const override;
   const Ip* ip() const override { return nullptr; }
   int socket(SocketType type) const override;
 
@@ -0,0 +1,46 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Network {
+
+void ExactConnectionBalancerImpl::registerHandler(BalancedConnectionHandler& handler) {
+  Thread::LockGuard lock(lock_);
+  handlers_.push_back(&handler);
+}
+
+void ExactConnectionBalancerImpl::unregisterHandler(BalancedConnectionHandler& handler) {
+  Thread::LockGuard lock(lock_);
+  // This could be made O(1) but it only happens when listeners are added or removed.
+  auto it = std::find(handlers_.begin(), handlers_.end(), &handler);
+  ASSERT(it != handlers_.end());
+  handlers_.erase(it);
+}
+
+BalancedConnectionHandler&
+ExactConnectionBalancerImpl::pickTargetHandler(BalancedConnectionHandler& current_handler) {
+  BalancedConnectionHandler* min_connection_handler = &current_handler;
+  {
+    Thread::LockGuard lock(lock_);
+    // Prefer the current handler on ties to avoid a needless cross-thread post.
+    uint64_t min_connections = current_handler.numConnections();
+    for (BalancedConnectionHandler* handler : handlers_) {
+      const uint64_t connections = handler->numConnections();
+      if (connections < min_connections) {
+        min_connection_handler = handler;
+        min_connections = connections;
+      }
+    }
+
+    min_connection_handler->incNumConnections();
+  }
+
+  return *min_connection_handler;
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "envoy/network/connection_balancer.h"
+
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Balancer that assigns every connection to the handler with the fewest connections at the time
+ * of accept. All picks are serialized under a lock, so this is meant for listeners with relatively
+ * few, long-lived connections where balance matters more than accept throughput.
+ */
+class ExactConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  // Network::ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler& handler) override;
+  void unregisterHandler(BalancedConnectionHandler& handler) override;
+  BalancedConnectionHandler& pickTargetHandler(BalancedConnectionHandler& current_handler) override;
+
+private:
+  Thread::MutexBasicLockable lock_;
+  std::vector<BalancedConnectionHandler*> handlers_ GUARDED_BY(lock_);
+};
+
+/**
+ * Balancer that keeps every connection on the handler that accepted it.
+ */
+class NopConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  // Network::ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler&) override {}
+  void unregisterHandler(BalancedConnectionHandler&) override {}
+  BalancedConnectionHandler&
+  pickTargetHandler(BalancedConnectionHandler& current_handler) override {
+    current_handler.incNumConnections();
+    return current_handler;
+  }
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -5,7 +5,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 
 #include "envoy/common/exception.h"
@@ -15,6 +17,7 @@
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/enum_to_int.h"
+#include "common/common/fmt.h"
 #include "common/network/address_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/raw_buffer_socket.h"
@@ -42,6 +45,7 @@ void ConnectionImplUtility::updateBufferStats(uint64_t delta, uint64_t new_total
 }
 
 std::atomic<uint64_t> ConnectionImpl::next_global_id_;
+uint64_t ConnectionImpl::read_budget_ = 0;
 
 ConnectionImpl::ConnectionImpl(Event::Dispatcher& dispatcher, ConnectionSocketPtr&& socket,
                                TransportSocketPtr&& transport_socket, bool connected)
@@ -49,11 +53,13 @@ ConnectionImpl::ConnectionImpl(Event::Dispatcher& dispatcher, ConnectionSocketPt
       socket_(std::move(socket)), write_buffer_(dispatcher.getWatermarkFactory().create(
                                       [this]() -> void { this->onLowWatermark(); },
                                       [this]() -> void { this->onHighWatermark(); })),
-      dispatcher_(dispatcher), id_(next_global_id_++) {
+      dispatcher_(dispatcher), id_(next_global_id_++), memory_account_(*this) {
   // Treat the lack of a valid fd (which in practice only happens if we run out of FDs) as an OOM
   // condition and just crash.
   RELEASE_ASSERT(fd() != -1, "");
 
+  static_cast<Buffer::WatermarkBuffer*>(write_buffer_.get())->setAccount(&memory_account_);
+
   if (!connected) {
     connecting_ = true;
   }
@@ -75,6 +81,21 @@ ConnectionImpl::~ConnectionImpl() {
   // deletion). Hence the assert above. However, call close() here just to be completely sure that
   // the fd is closed and make it more likely that we crash from a bad close callback.
   close(ConnectionCloseType::NoFlush);
+
+  // The account is destroyed before the write buffer.
+  static_cast<Buffer::WatermarkBuffer*>(write_buffer_.get())->setAccount(nullptr);
+}
+
+ConnectionImpl::MemoryAccountImpl::MemoryAccountImpl(ConnectionImpl& connection)
+    : MemoryAccount(connection.dispatcher_), connection_(connection), id_(connection.id_),
+      remote_address_(connection.remoteAddress()) {}
+
+std::string ConnectionImpl::MemoryAccountImpl::describe() const {
+  return fmt::format("connection {} with {}", id_, remote_address_->asString());
+}
+
+void ConnectionImpl::MemoryAccountImpl::resetOwner() {
+  connection_.close(ConnectionCloseType::NoFlush);
 }
 
 void ConnectionImpl::addWriteFilter(WriteFilterSharedPtr filter) {
@@ -136,7 +157,19 @@ void ConnectionImpl::closeSocket(ConnectionEvent close_type) {
   // Drain input and output buffers.
   updateReadBufferStats(0, 0);
   updateWriteBufferStats(0, 0);
+#ifdef TCPI_OPT_SYN_DATA
+  if (connection_stats_ && connection_stats_->tfo_syn_data_acked_ &&
+      socket_->remoteAddress()->type() == Address::Type::Ip) {
+    tcp_info info;
+    socklen_t info_size = sizeof(info);
+    if (getsockopt(fd(), IPPROTO_TCP, TCP_INFO, &info, &info_size) == 0 &&
+        (info.tcpi_options & TCPI_OPT_SYN_DATA)) {
+      connection_stats_->tfo_syn_data_acked_->inc();
+    }
+  }
+#endif
   connection_stats_.reset();
+  memory_account_.close();
 
   file_event_.reset();
   socket_->close();
@@ -157,6 +190,7 @@ void ConnectionImpl::noDelay(bool enable) {
   if (fd() == -1) {
     return;
   }
+  no_delay_ = enable;
 
   // Don't set NODELAY for unix domain sockets
   sockaddr addr;
@@ -182,6 +216,26 @@ void ConnectionImpl::noDelay(bool enable) {
   RELEASE_ASSERT(0 == rc, "");
 }
 
+void ConnectionImpl::quickAck(bool enable) {
+  // As for noDelay(), the socket may already be invalid, in which case the error is raised shortly.
+  if (fd() == -1) {
+    return;
+  }
+  quick_ack_ = enable;
+  setQuickAck(enable);
+}
+
+void ConnectionImpl::setQuickAck(bool enable) {
+  // TCP_QUICKACK is not supported by all platforms and socket types, and only affects how soon
+  // data is acknowledged, so failures are ignored.
+#ifdef TCP_QUICKACK
+  int new_value = enable;
+  setsockopt(fd(), IPPROTO_TCP, TCP_QUICKACK, &new_value, sizeof(new_value));
+#else
+  UNREFERENCED_PARAMETER(enable);
+#endif
+}
+
 uint64_t ConnectionImpl::id() const { return id_; }
 
 void ConnectionImpl::onRead(uint64_t read_buffer_size) {
@@ -367,10 +421,22 @@ void ConnectionImpl::setBufferLimits(uint32_t limit) {
   }
 }
 
+void ConnectionImpl::setBufferLimitAutoTuning(uint32_t max_limit) {
+  // The high watermark is one byte above the limit, see setBufferLimits().
+  static_cast<Buffer::WatermarkBuffer*>(write_buffer_.get())
+      ->setAutoTuning(max_limit > 0 ? max_limit + 1 : 0, dispatcher_.timeSystem());
+}
+
 void ConnectionImpl::onLowWatermark() {
   ENVOY_CONN_LOG(debug, "onBelowWriteBufferLowWatermark", *this);
   ASSERT(above_high_watermark_);
   above_high_watermark_ = false;
+  if (connection_stats_ && connection_stats_->write_buffer_above_high_watermark_ms_ != nullptr) {
+    connection_stats_->write_buffer_above_high_watermark_ms_->add(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            dispatcher_.timeSystem().monotonicTime() - above_high_watermark_time_)
+            .count());
+  }
   for (ConnectionCallbacks* callback : callbacks_) {
     callback->onBelowWriteBufferLowWatermark();
   }
@@ -380,6 +446,7 @@ void ConnectionImpl::onHighWatermark() {
   ENVOY_CONN_LOG(debug, "onAboveWriteBufferHighWatermark", *this);
   ASSERT(!above_high_watermark_);
   above_high_watermark_ = true;
+  above_high_watermark_time_ = dispatcher_.timeSystem().monotonicTime();
   for (ConnectionCallbacks* callback : callbacks_) {
     callback->onAboveWriteBufferHighWatermark();
   }
@@ -398,6 +465,9 @@ void ConnectionImpl::onFileEvent(uint32_t events) {
       }
     } else {
       ENVOY_CONN_LOG(debug, "raising immediate error", *this);
+      if (immediate_error_event_ == ConnectionEvent::RemoteClose && retryConnect()) {
+        return;
+      }
     }
     closeSocket(immediate_error_event_);
     return;
@@ -423,14 +493,40 @@ void ConnectionImpl::onFileEvent(uint32_t events) {
   }
 }
 
+bool ConnectionImpl::shouldDrainReadBuffer() {
+  if (read_buffer_limit_ > 0 && read_buffer_.length() >= read_buffer_limit_) {
+    return true;
+  }
+
+  // The transport socket yields and re-activates the read event, letting other connections on
+  // this dispatcher run before reading more.
+  if (read_budget_ > 0 && read_buffer_.length() - read_event_start_size_ >= read_budget_) {
+    read_budget_exhausted_ = true;
+    return true;
+  }
+
+  return false;
+}
+
 void ConnectionImpl::onReadReady() {
   ENVOY_CONN_LOG(trace, "read ready", *this);
 
   ASSERT(!connecting_);
 
+  read_event_start_size_ = read_buffer_.length();
+  read_budget_exhausted_ = false;
   IoResult result = transport_socket_->doRead(read_buffer_);
   uint64_t new_buffer_size = read_buffer_.length();
+  if (quick_ack_ && result.bytes_processed_ != 0) {
+    // The kernel falls back to delayed ACKs once it leaves quick ACK mode, so it is re-armed after
+    // each read.
+    setQuickAck(true);
+  }
   updateReadBufferStats(result.bytes_processed_, new_buffer_size);
+  if (read_budget_exhausted_ && connection_stats_ &&
+      connection_stats_->read_budget_exhausted_ != nullptr) {
+    connection_stats_->read_budget_exhausted_->inc();
+  }
 
   // If this connection doesn't have half-close semantics, translate end_stream into
   // a connection close.
@@ -465,6 +561,7 @@ void ConnectionImpl::onWriteReady() {
     if (error == 0) {
       ENVOY_CONN_LOG(debug, "connected", *this);
       connecting_ = false;
+      onSocketConnected();
       transport_socket_->onConnected();
       // It's possible that we closed during the connect callback.
       if (state() != State::Open) {
@@ -473,6 +570,9 @@ void ConnectionImpl::onWriteReady() {
       }
     } else {
       ENVOY_CONN_LOG(debug, "delayed connection error: {}", *this, error);
+      if (retryConnect()) {
+        return;
+      }
       closeSocket(ConnectionEvent::RemoteClose);
       return;
     }
@@ -503,6 +603,37 @@ void ConnectionImpl::onWriteReady() {
   }
 }
 
+void ConnectionImpl::replaceSocket(ConnectionSocketPtr&& socket, bool connected) {
+  ASSERT(connecting_);
+  file_event_.reset();
+  socket_->close();
+  socket_ = std::move(socket);
+  immediate_error_event_ = ConnectionEvent::Connected;
+  if (no_delay_) {
+    noDelay(true);
+  }
+  if (quick_ack_) {
+    setQuickAck(true);
+  }
+
+  file_event_ = dispatcher_.createFileEvent(
+      fd(), [this](uint32_t events) -> void { onFileEvent(events); }, Event::FileTriggerType::Edge,
+      Event::FileReadyType::Read | Event::FileReadyType::Write);
+  if (!read_enabled_) {
+    if (detect_early_close_ && !enable_half_close_) {
+      file_event_->setEnabled(Event::FileReadyType::Write | Event::FileReadyType::Closed);
+    } else {
+      file_event_->setEnabled(Event::FileReadyType::Write);
+    }
+  }
+  if (socket_->remoteAddress()->type() == Address::Type::Ip) {
+    socket_->setLocalAddress(Address::addressFromFd(fd()), false);
+  }
+  if (connected) {
+    file_event_->activate(Event::FileReadyType::Write);
+  }
+}
+
 void ConnectionImpl::setConnectionStats(const ConnectionStats& stats) {
   ASSERT(!connection_stats_,
          "Two network filters are attempting to set connection stats. This indicates an issue "
@@ -600,5 +731,131 @@ void ClientConnectionImpl::connect() {
   }
 }
 
+constexpr std::chrono::milliseconds HappyEyeballsConnectionImpl::ATTEMPT_DELAY;
+
+HappyEyeballsConnectionImpl::HappyEyeballsConnectionImpl(
+    Event::Dispatcher& dispatcher, const std::vector<Address::InstanceConstSharedPtr>& addresses,
+    const Address::InstanceConstSharedPtr& source_address,
+    Network::TransportSocketPtr&& transport_socket,
+    const Network::ConnectionSocket::OptionsSharedPtr& options)
+    : ClientConnectionImpl(dispatcher, addresses.front(), source_address,
+                           std::move(transport_socket), options),
+      source_address_(source_address), options_(options),
+      fallback_addresses_(addresses.begin() + 1, addresses.end()),
+      attempt_timer_(dispatcher.createTimer([this]() -> void { onAttemptTimer(); })) {}
+
+void HappyEyeballsConnectionImpl::connect() {
+  ClientConnectionImpl::connect();
+  // An immediate error starts the next attempt once raised, see retryConnect().
+  if (connecting_ && !fallback_addresses_.empty()) {
+    attempt_timer_->enableTimer(ATTEMPT_DELAY);
+  }
+}
+
+void HappyEyeballsConnectionImpl::startNextAttempt() {
+  ASSERT(next_fallback_ < fallback_addresses_.size());
+  const Address::InstanceConstSharedPtr& address = fallback_addresses_[next_fallback_++];
+  ENVOY_CONN_LOG(debug, "connecting to fallback address {}", *this, address->asString());
+  ConnectionSocketPtr socket = std::make_unique<ClientSocketImpl>(address);
+  if (socket->fd() == -1 ||
+      !Network::Socket::applyOptions(options_, *socket,
+                                     envoy::api::v2::core::SocketOption::STATE_PREBIND)) {
+    ENVOY_CONN_LOG(debug, "failed to set up the socket to {}", *this, address->asString());
+    return;
+  }
+  if (source_address_ != nullptr && source_address_->bind(socket->fd()).rc_ < 0) {
+    ENVOY_CONN_LOG(debug, "failed to bind the socket to {} to {}", *this, address->asString(),
+                   source_address_->asString());
+    return;
+  }
+  const Api::SysCallIntResult result = address->connect(socket->fd());
+  if (result.rc_ == -1 && result.errno_ != EINPROGRESS) {
+    ENVOY_CONN_LOG(debug, "immediate connection error to {}: {}", *this, address->asString(),
+                   result.errno_);
+    return;
+  }
+
+  attempts_.emplace_back(new ConnectAttempt());
+  ConnectAttempt& attempt = *attempts_.back();
+  attempt.socket_ = std::move(socket);
+  attempt.file_event_ = dispatcher().createFileEvent(
+      attempt.socket_->fd(), [this, &attempt](uint32_t) -> void { onAttemptWriteReady(attempt); },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Write);
+}
+
+void HappyEyeballsConnectionImpl::onAttemptWriteReady(ConnectAttempt& attempt) {
+  auto it = std::find_if(attempts_.begin(), attempts_.end(),
+                         [&attempt](const ConnectAttemptPtr& a) { return a.get() == &attempt; });
+  ASSERT(it != attempts_.end());
+  ConnectionSocketPtr socket = std::move(attempt.socket_);
+  attempts_.erase(it);
+  if (state() != State::Open || !connecting_) {
+    return;
+  }
+
+  int error;
+  socklen_t error_size = sizeof(error);
+  int rc = getsockopt(socket->fd(), SOL_SOCKET, SO_ERROR, &error, &error_size);
+  ASSERT(0 == rc);
+  if (error != 0) {
+    ENVOY_CONN_LOG(debug, "delayed connection error to {}: {}", *this,
+                   socket->remoteAddress()->asString(), error);
+    // Move on to the next address without waiting for the attempt delay.
+    if (next_fallback_ < fallback_addresses_.size()) {
+      startNextAttempt();
+    }
+    return;
+  }
+
+  ENVOY_CONN_LOG(debug, "connected to fallback address {}", *this,
+                 socket->remoteAddress()->asString());
+  connecting_to_fallback_ = true;
+  replaceSocket(std::move(socket), true);
+}
+
+void HappyEyeballsConnectionImpl::onAttemptTimer() {
+  if (state() != State::Open || !connecting_) {
+    return;
+  }
+  if (next_fallback_ < fallback_addresses_.size()) {
+    startNextAttempt();
+  }
+  if (next_fallback_ < fallback_addresses_.size()) {
+    attempt_timer_->enableTimer(ATTEMPT_DELAY);
+  }
+}
+
+bool HappyEyeballsConnectionImpl::retryConnect() {
+  while (attempts_.empty() && next_fallback_ < fallback_addresses_.size()) {
+    startNextAttempt();
+  }
+  if (attempts_.empty()) {
+    return false;
+  }
+
+  // Continue with the oldest attempt in flight, which becomes the connection's socket.
+  ConnectAttemptPtr attempt = std::move(attempts_.front());
+  attempts_.pop_front();
+  attempt->file_event_.reset();
+  connecting_ = true;
+  connecting_to_fallback_ = true;
+  replaceSocket(std::move(attempt->socket_), false);
+  return true;
+}
+
+void HappyEyeballsConnectionImpl::onSocketConnected() {
+  cancelAttempts();
+  if (connecting_to_fallback_ && connectionStats() != nullptr &&
+      connectionStats()->connect_fallback_wins_ != nullptr) {
+    connectionStats()->connect_fallback_wins_->inc();
+  }
+}
+
+void HappyEyeballsConnectionImpl::cancelAttempts() {
+  attempts_.clear();
+  attempt_timer_->disableTimer();
+  next_fallback_ = fallback_addresses_.size();
+}
+
 } // namespace Network
 } // namespace Envoy
@@ -1,15 +1,18 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/event/dispatcher.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/transport_socket.h"
 
+#include "common/buffer/memory_account.h"
 #include "common/buffer/watermark_buffer.h"
 #include "common/common/logger.h"
 #include "common/event/libevent.h"
@@ -68,6 +71,7 @@ public:
   uint64_t id() const override;
   std::string nextProtocol() const override { return transport_socket_->protocol(); }
   void noDelay(bool enable) override;
+  void quickAck(bool enable) override;
   void readDisable(bool disable) override;
   void detectEarlyCloseWhenReadDisabled(bool value) override { detect_early_close_ = value; }
   bool readEnabled() const override;
@@ -83,8 +87,10 @@ public:
   void write(Buffer::Instance& data, bool end_stream) override;
   void setBufferLimits(uint32_t limit) override;
   uint32_t bufferLimit() const override { return read_buffer_limit_; }
+  void setBufferLimitAutoTuning(uint32_t max_limit) override;
   bool localAddressRestored() const override { return socket_->localAddressRestored(); }
   bool aboveHighWatermark() const override { return above_high_watermark_; }
+  uint64_t bufferedWriteBytes() const override { return write_buffer_->length(); }
   const ConnectionSocket::OptionsSharedPtr& socketOptions() const override {
     return socket_->options();
   }
@@ -101,9 +107,7 @@ public:
   Connection& connection() override { return *this; }
   void raiseEvent(ConnectionEvent event) override;
   // Should the read buffer be drained?
-  bool shouldDrainReadBuffer() override {
-    return read_buffer_limit_ > 0 && read_buffer_.length() >= read_buffer_limit_;
-  }
+  bool shouldDrainReadBuffer() override;
   // Mark read buffer ready to read in the event loop. This is used when yielding following
   // shouldDrainReadBuffer().
   // TODO(htuch): While this is the basis for also yielding to other connections to provide some
@@ -114,8 +118,34 @@ public:
   // Obtain global next connection ID. This should only be used in tests.
   static uint64_t nextGlobalIdForTest() { return next_global_id_; }
 
+  /**
+   * Set the maximum number of bytes a connection reads per read event before yielding back to the
+   * event loop, so that a single busy connection can't starve the others on its worker. 0 (the
+   * default) means no budget. Applies process wide; see the --read-budget-bytes command line
+   * option.
+   */
+  static void setReadBudget(uint64_t bytes) { read_budget_ = bytes; }
+  static uint64_t readBudget() { return read_budget_; }
+
 protected:
   void closeSocket(ConnectionEvent close_type);
+  /**
+   * Replace the socket of a connection that is still connecting, with the socket of a connection
+   * attempt to another address.
+   * @param socket supplies the socket replacing the current one, which is closed.
+   * @param connected supplies whether the new socket already connected.
+   */
+  void replaceSocket(ConnectionSocketPtr&& socket, bool connected);
+  /**
+   * Called when the socket failed to connect.
+   * @return whether the connection keeps connecting, with a socket replacing the failed one.
+   */
+  virtual bool retryConnect() { return false; }
+  /**
+   * Called when the socket connected, before the transport socket is told.
+   */
+  virtual void onSocketConnected() {}
+  const ConnectionStats* connectionStats() const { return connection_stats_.get(); }
 
   void onLowWatermark();
   void onHighWatermark();
@@ -140,6 +170,7 @@ private:
   void onRead(uint64_t read_buffer_size);
   void onReadReady();
   void onWriteReady();
+  void setQuickAck(bool enable);
   void updateReadBufferStats(uint64_t num_read, uint64_t new_size);
   void updateWriteBufferStats(uint64_t num_written, uint64_t new_size);
 
@@ -147,14 +178,35 @@ private:
   bool bothSidesHalfClosed();
 
   static std::atomic<uint64_t> next_global_id_;
+  static uint64_t read_budget_;
+
+  // Accounts the memory held in write_buffer_, which is where the data of a slow reader piles up.
+  class MemoryAccountImpl : public Buffer::MemoryAccount {
+  public:
+    MemoryAccountImpl(ConnectionImpl& connection);
+
+    // Buffer::MemoryAccount
+    std::string describe() const override;
+    void resetOwner() override;
+
+  private:
+    ConnectionImpl& connection_;
+    const uint64_t id_;
+    const Address::InstanceConstSharedPtr remote_address_;
+  };
 
   Event::Dispatcher& dispatcher_;
   const uint64_t id_;
+  MemoryAccountImpl memory_account_;
   std::list<ConnectionCallbacks*> callbacks_;
   std::list<BytesSentCb> bytes_sent_callbacks_;
   bool read_enabled_{true};
+  bool no_delay_{false};
+  bool quick_ack_{false};
   bool close_with_flush_{false};
   bool above_high_watermark_{false};
+  // When the write buffer last went above its high watermark.
+  MonotonicTime above_high_watermark_time_;
   bool detect_early_close_{true};
   bool enable_half_close_{false};
   bool read_end_stream_raised_{false};
@@ -163,6 +215,10 @@ private:
   bool current_write_end_stream_{false};
   Buffer::Instance* current_write_buffer_{};
   uint64_t last_read_buffer_size_{};
+  // read_buffer_ length at the start of the current read event, and whether the event ran out of
+  // read budget.
+  uint64_t read_event_start_size_{};
+  bool read_budget_exhausted_{false};
   uint64_t last_write_buffer_size_{};
   std::unique_ptr<ConnectionStats> connection_stats_;
   // Tracks the number of times reads have been disabled. If N different components call
@@ -186,5 +242,56 @@ public:
   void connect() override;
 };
 
+/**
+ * Client connection racing connection attempts to several addresses, as described by RFC 8305
+ * (Happy Eyeballs). The first address is connected to first, and an attempt to the next address is
+ * started each time ATTEMPT_DELAY passes without a connection, or as soon as all the attempts in
+ * flight failed. The connection continues with the socket of the first attempt that connects.
+ */
+class HappyEyeballsConnectionImpl : public ClientConnectionImpl {
+public:
+  HappyEyeballsConnectionImpl(Event::Dispatcher& dispatcher,
+                              const std::vector<Address::InstanceConstSharedPtr>& addresses,
+                              const Address::InstanceConstSharedPtr& source_address,
+                              Network::TransportSocketPtr&& transport_socket,
+                              const Network::ConnectionSocket::OptionsSharedPtr& options);
+
+  // The connection attempt delay recommended by RFC 8305.
+  static constexpr std::chrono::milliseconds ATTEMPT_DELAY{250};
+
+  // Network::ClientConnection
+  void connect() override;
+
+private:
+  struct ConnectAttempt {
+    ConnectionSocketPtr socket_;
+    Event::FileEventPtr file_event_;
+  };
+  typedef std::unique_ptr<ConnectAttempt> ConnectAttemptPtr;
+
+  // ConnectionImpl
+  bool retryConnect() override;
+  void onSocketConnected() override;
+
+  /**
+   * Start connecting to the next address, unless it can't be connected to.
+   */
+  void startNextAttempt();
+  void onAttemptWriteReady(ConnectAttempt& attempt);
+  void onAttemptTimer();
+  void cancelAttempts();
+
+  const Address::InstanceConstSharedPtr source_address_;
+  const Network::ConnectionSocket::OptionsSharedPtr options_;
+  // The addresses after the first one, and the next one to connect to.
+  const std::vector<Address::InstanceConstSharedPtr> fallback_addresses_;
+  size_t next_fallback_{};
+  // The attempts in flight other than the one of the connection's socket.
+  std::list<ConnectAttemptPtr> attempts_;
+  Event::TimerPtr attempt_timer_;
+  // Whether the connection's socket is the one of a fallback attempt.
+  bool connecting_to_fallback_{false};
+};
+
 } // namespace Network
 } // namespace Envoy
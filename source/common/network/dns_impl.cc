@@ -1,9 +1,13 @@
 #include "common/network/dns_impl.h"
 
+#include <arpa/inet.h>
+#include <arpa/nameser.h>
 #include <netdb.h>
 #include <netinet/ip.h>
 #include <sys/socket.h>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstdint>
 #include <list>
@@ -20,11 +24,41 @@
 namespace Envoy {
 namespace Network {
 
+namespace {
+// Alternate between the addresses of both lists, starting with the first one, which is how RFC 8305
+// orders the addresses of both families for connection attempts.
+std::list<Address::InstanceConstSharedPtr>
+interleave(std::list<Address::InstanceConstSharedPtr>&& first,
+           std::list<Address::InstanceConstSharedPtr>&& second) {
+  std::list<Address::InstanceConstSharedPtr> address_list;
+  auto first_it = first.begin();
+  auto second_it = second.begin();
+  while (first_it != first.end() || second_it != second.end()) {
+    if (first_it != first.end()) {
+      address_list.push_back(std::move(*first_it++));
+    }
+    if (second_it != second.end()) {
+      address_list.push_back(std::move(*second_it++));
+    }
+  }
+  return address_list;
+}
+} // namespace
+
 DnsResolverImpl::DnsResolverImpl(
     Event::Dispatcher& dispatcher,
     const std::vector<Network::Address::InstanceConstSharedPtr>& resolvers)
+    : DnsResolverImpl(dispatcher, resolvers, 0, std::chrono::seconds(0), nullptr) {}
+
+DnsResolverImpl::DnsResolverImpl(
+    Event::Dispatcher& dispatcher,
+    const std::vector<Network::Address::InstanceConstSharedPtr>& resolvers, uint32_t cache_size,
+    std::chrono::seconds cache_max_stale, Stats::ScopePtr&& scope)
     : dispatcher_(dispatcher),
       timer_(dispatcher.createTimer([this] { onEventCallback(ARES_SOCKET_BAD, 0); })) {
+  if (cache_size > 0) {
+    cache_ = std::make_unique<Cache>(cache_size, cache_max_stale, std::move(scope));
+  }
   // This is also done in main(), to satisfy the requirement that c-ares is
   // initialized prior to threading. The additional call to ares_library_init()
   // here is a nop in normal execution, but exists for testing where we don't
@@ -66,6 +100,11 @@ DnsResolverImpl::~DnsResolverImpl() {
   ares_library_cleanup();
 }
 
+DnsResolverImpl::Cache::Cache(uint32_t size, std::chrono::seconds max_stale,
+                              Stats::ScopePtr&& scope)
+    : size_(size), max_stale_(max_stale), scope_(std::move(scope)),
+      stats_{ALL_DNS_CACHE_STATS(POOL_COUNTER(*scope_), POOL_GAUGE(*scope_))} {}
+
 void DnsResolverImpl::initializeChannel(ares_options* options, int optmask) {
   options->sock_state_cb = [](void* arg, int fd, int read, int write) {
     static_cast<DnsResolverImpl*>(arg)->onAresSocketStateChange(fd, read, write);
@@ -82,7 +121,7 @@ void DnsResolverImpl::PendingResolution::onAresHostCallback(int status, int time
     delete this;
     return;
   }
-  if (!fallback_if_failed_) {
+  if (!fallback_if_failed_ && !resolve_v4_next_) {
     completed_ = true;
   }
 
@@ -109,7 +148,7 @@ void DnsResolverImpl::PendingResolution::onAresHostCallback(int status, int time
         address_list.emplace_back(new Address::Ipv6Instance(address));
       }
     }
-    if (!address_list.empty()) {
+    if (!address_list.empty() && !resolve_v4_next_) {
       completed_ = true;
     }
   }
@@ -118,8 +157,32 @@ void DnsResolverImpl::PendingResolution::onAresHostCallback(int status, int time
     ENVOY_LOG(debug, "DNS request timed out {} times", timeouts);
   }
 
+  if (resolve_v4_next_) {
+    resolve_v4_next_ = false;
+    v6_address_list_ = std::move(address_list);
+    v6_ttl_ = ttl_;
+    getHostByName(AF_INET);
+    // Note: Nothing can follow this call to getHostByName due to deletion of this
+    // object upon synchronous resolution.
+    return;
+  }
+  if (dns_lookup_family_ == DnsLookupFamily::All) {
+    // The addresses of both families are cached for the shortest TTL of their records, and not at
+    // all if either came from a literal address or the hosts file.
+    if (address_list.empty()) {
+      ttl_ = v6_ttl_;
+    } else if (!v6_address_list_.empty()) {
+      ttl_ = ttl_.has_value() && v6_ttl_.has_value()
+                 ? absl::make_optional(std::min(ttl_.value(), v6_ttl_.value()))
+                 : absl::nullopt;
+    }
+    address_list = interleave(std::move(v6_address_list_), std::move(address_list));
+  }
+
   if (completed_) {
-    if (!cancelled_) {
+    parent_.onResolution(*this, address_list);
+    // Background refreshes of the cache have no callback.
+    if (!cancelled_ && callback_) {
       try {
         callback_(std::move(address_list));
       } catch (const EnvoyException& e) {
@@ -190,15 +253,139 @@ void DnsResolverImpl::onAresSocketStateChange(int fd, int read, int write) {
                           (write ? Event::FileReadyType::Write : 0));
 }
 
+void DnsResolverImpl::PendingResolution::onAresSearchCallback(int status, int timeouts,
+                                                              unsigned char* abuf, int alen) {
+  hostent* hostent = nullptr;
+  if (status == ARES_SUCCESS) {
+    // Only the shortest TTL matters, so a bounded number of them is parsed.
+    int naddrttls = 16;
+    if (family_ == AF_INET) {
+      std::array<ares_addrttl, 16> addrttls;
+      status = ares_parse_a_reply(abuf, alen, &hostent, addrttls.data(), &naddrttls);
+      if (status == ARES_SUCCESS && naddrttls > 0) {
+        ttl_ = std::chrono::seconds(
+            std::min_element(addrttls.begin(), addrttls.begin() + naddrttls,
+                             [](const ares_addrttl& a, const ares_addrttl& b) {
+                               return a.ttl < b.ttl;
+                             })
+                ->ttl);
+      }
+    } else {
+      std::array<ares_addr6ttl, 16> addrttls;
+      status = ares_parse_aaaa_reply(abuf, alen, &hostent, addrttls.data(), &naddrttls);
+      if (status == ARES_SUCCESS && naddrttls > 0) {
+        ttl_ = std::chrono::seconds(
+            std::min_element(addrttls.begin(), addrttls.begin() + naddrttls,
+                             [](const ares_addr6ttl& a, const ares_addr6ttl& b) {
+                               return a.ttl < b.ttl;
+                             })
+                ->ttl);
+      }
+    }
+  }
+
+  // This may delete the resolution.
+  onAresHostCallback(status, timeouts, hostent);
+  if (hostent != nullptr) {
+    ares_free_hostent(hostent);
+  }
+}
+
+std::string DnsResolverImpl::cacheKey(const std::string& dns_name,
+                                      DnsLookupFamily dns_lookup_family) {
+  return fmt::format("{}:{}", static_cast<int>(dns_lookup_family), dns_name);
+}
+
 ActiveDnsQuery* DnsResolverImpl::resolve(const std::string& dns_name,
                                          DnsLookupFamily dns_lookup_family, ResolveCb callback) {
-  // TODO(hennna): Add DNS caching which will allow testing the edge case of a
-  // failed intial call to getHostbyName followed by a synchronous IPv4
-  // resolution.
+  if (cache_ == nullptr) {
+    return startResolution(dns_name, dns_lookup_family, callback);
+  }
+
+  auto it = cache_->entries_.find(cacheKey(dns_name, dns_lookup_family));
+  const MonotonicTime now = dispatcher_.timeSystem().monotonicTime();
+  if (it == cache_->entries_.end() || now >= it->second.expiry_ + cache_->max_stale_) {
+    cache_->stats_.miss_.inc();
+    return startResolution(dns_name, dns_lookup_family, callback);
+  }
+
+  CacheEntry& entry = it->second;
+  if (now < entry.expiry_) {
+    cache_->stats_.hit_.inc();
+  } else {
+    cache_->stats_.stale_hit_.inc();
+  }
+  cache_->lru_.splice(cache_->lru_.begin(), cache_->lru_, entry.lru_entry_);
+
+  // The refresh may complete synchronously and update the entry.
+  std::list<Address::InstanceConstSharedPtr> address_list = entry.addresses_;
+  if (now >= entry.prefetch_time_ && !entry.refreshing_) {
+    entry.refreshing_ = true;
+    cache_->stats_.prefetch_.inc();
+    startResolution(dns_name, dns_lookup_family, nullptr);
+  }
+
+  callback(std::move(address_list));
+  return nullptr;
+}
+
+void DnsResolverImpl::onResolution(const PendingResolution& resolution,
+                                   const std::list<Address::InstanceConstSharedPtr>& address_list) {
+  if (cache_ == nullptr) {
+    return;
+  }
+
+  const std::string key = cacheKey(resolution.dns_name_, resolution.dns_lookup_family_);
+  auto it = cache_->entries_.find(key);
+  if (address_list.empty()) {
+    // Keep returning the cached addresses until they are too stale, should a refresh fail.
+    if (it != cache_->entries_.end()) {
+      it->second.refreshing_ = false;
+    }
+    return;
+  }
+
+  if (!resolution.ttl_.has_value() || resolution.ttl_.value().count() == 0) {
+    // Literal addresses, names from the hosts file and records that must not be cached.
+    if (it != cache_->entries_.end()) {
+      cache_->lru_.erase(it->second.lru_entry_);
+      cache_->entries_.erase(it);
+      cache_->stats_.size_.set(cache_->entries_.size());
+    }
+    return;
+  }
+
+  if (it == cache_->entries_.end()) {
+    if (cache_->entries_.size() == cache_->size_) {
+      cache_->entries_.erase(cache_->lru_.back());
+      cache_->lru_.pop_back();
+      cache_->stats_.eviction_.inc();
+    }
+    cache_->lru_.push_front(key);
+    it = cache_->entries_.emplace(key, CacheEntry{}).first;
+    it->second.lru_entry_ = cache_->lru_.begin();
+    cache_->stats_.size_.set(cache_->entries_.size());
+  }
+
+  CacheEntry& entry = it->second;
+  const MonotonicTime now = dispatcher_.timeSystem().monotonicTime();
+  const std::chrono::milliseconds ttl = resolution.ttl_.value();
+  entry.addresses_ = address_list;
+  entry.expiry_ = now + ttl;
+  // Resolve the name again when it is looked up during the last eighth of the TTL.
+  entry.prefetch_time_ = now + ttl - ttl / 8;
+  entry.refreshing_ = false;
+}
+
+ActiveDnsQuery* DnsResolverImpl::startResolution(const std::string& dns_name,
+                                                 DnsLookupFamily dns_lookup_family,
+                                                 ResolveCb callback) {
   std::unique_ptr<PendingResolution> pending_resolution(
-      new PendingResolution(callback, dispatcher_, channel_, dns_name));
+      new PendingResolution(callback, *this, dns_name, dns_lookup_family));
   if (dns_lookup_family == DnsLookupFamily::Auto) {
     pending_resolution->fallback_if_failed_ = true;
+  } else if (dns_lookup_family == DnsLookupFamily::All) {
+    pending_resolution->resolve_v4_next_ = true;
   }
 
   if (dns_lookup_family == DnsLookupFamily::V4Only) {
@@ -223,12 +410,38 @@ ActiveDnsQuery* DnsResolverImpl::resolve(const std::string& dns_name,
 }
 
 void DnsResolverImpl::PendingResolution::getHostByName(int family) {
-  ares_gethostbyname(channel_, dns_name_.c_str(), family,
-                     [](void* arg, int status, int timeouts, hostent* hostent) {
-                       static_cast<PendingResolution*>(arg)->onAresHostCallback(status, timeouts,
-                                                                                hostent);
-                     },
-                     this);
+  family_ = family;
+  ttl_.reset();
+
+  // Literal addresses resolve synchronously.
+  in6_addr literal;
+  if (inet_pton(AF_INET, dns_name_.c_str(), &literal) == 1 ||
+      inet_pton(AF_INET6, dns_name_.c_str(), &literal) == 1) {
+    ares_gethostbyname(channel_, dns_name_.c_str(), family,
+                       [](void* arg, int status, int timeouts, hostent* hostent) {
+                         static_cast<PendingResolution*>(arg)->onAresHostCallback(
+                             status, timeouts, hostent);
+                       },
+                       this);
+    return;
+  }
+
+  // ares_gethostbyname() consults the hosts file before querying, but does not surface the TTLs of
+  // the records it queries, so the two steps are taken separately.
+  hostent* hostent = nullptr;
+  if (ares_gethostbyname_file(channel_, dns_name_.c_str(), family, &hostent) == ARES_SUCCESS) {
+    // This may delete the resolution.
+    onAresHostCallback(ARES_SUCCESS, 0, hostent);
+    ares_free_hostent(hostent);
+    return;
+  }
+
+  ares_search(channel_, dns_name_.c_str(), ns_c_in, family == AF_INET ? ns_t_a : ns_t_aaaa,
+              [](void* arg, int status, int timeouts, unsigned char* abuf, int alen) {
+                static_cast<PendingResolution*>(arg)->onAresSearchCallback(status, timeouts, abuf,
+                                                                           alen);
+              },
+              this);
 }
 
 } // namespace Network
@@ -2,18 +2,25 @@
 
 #include <netdb.h>
 
+#include <chrono>
 #include <cstdint>
+#include <list>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
+#include "envoy/common/time.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/file_event.h"
 #include "envoy/network/dns.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 
 #include "common/common/linked_object.h"
 #include "common/common/logger.h"
 #include "common/common/utility.h"
 
+#include "absl/types/optional.h"
 #include "ares.h"
 
 namespace Envoy {
@@ -21,6 +28,26 @@ namespace Network {
 
 class DnsResolverImplPeer;
 
+/**
+ * All DNS cache stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_DNS_CACHE_STATS(COUNTER, GAUGE)                                                        \
+  COUNTER(hit)                                                                                     \
+  COUNTER(stale_hit)                                                                               \
+  COUNTER(miss)                                                                                    \
+  COUNTER(prefetch)                                                                                \
+  COUNTER(eviction)                                                                                \
+  GAUGE  (size)
+// clang-format on
+
+/**
+ * Struct definition for all DNS cache stats. @see stats_macros.h
+ */
+struct DnsCacheStats {
+  ALL_DNS_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
 /**
  * Implementation of DnsResolver that uses c-ares. All calls and callbacks are assumed to
  * happen on the thread that owns the creating dispatcher.
@@ -29,6 +56,19 @@ class DnsResolverImpl : public DnsResolver, protected Logger::Loggable<Logger::I
 public:
   DnsResolverImpl(Event::Dispatcher& dispatcher,
                   const std::vector<Network::Address::InstanceConstSharedPtr>& resolvers);
+
+  /**
+   * Resolver that caches the addresses resolved from DNS for as long as the TTL of their records.
+   * A name is resolved again in the background when it is looked up shortly before its addresses
+   * expire, and expired addresses are still returned while they are resolved again.
+   * @param cache_size supplies the maximum number of names and lookup families to cache.
+   * @param cache_max_stale supplies how long addresses are returned for after they expire.
+   * @param scope supplies the scope of the cache stats.
+   */
+  DnsResolverImpl(Event::Dispatcher& dispatcher,
+                  const std::vector<Network::Address::InstanceConstSharedPtr>& resolvers,
+                  uint32_t cache_size, std::chrono::seconds cache_max_stale,
+                  Stats::ScopePtr&& scope);
   ~DnsResolverImpl() override;
 
   // Network::DnsResolver
@@ -39,9 +79,10 @@ private:
   friend class DnsResolverImplPeer;
   struct PendingResolution : public ActiveDnsQuery {
     // Network::ActiveDnsQuery
-    PendingResolution(ResolveCb callback, Event::Dispatcher& dispatcher, ares_channel channel,
-                      const std::string& dns_name)
-        : callback_(callback), dispatcher_(dispatcher), channel_(channel), dns_name_(dns_name) {}
+    PendingResolution(ResolveCb callback, DnsResolverImpl& parent, const std::string& dns_name,
+                      DnsLookupFamily dns_lookup_family)
+        : callback_(callback), parent_(parent), dispatcher_(parent.dispatcher_),
+          channel_(parent.channel_), dns_name_(dns_name), dns_lookup_family_(dns_lookup_family) {}
 
     void cancel() override {
       // c-ares only supports channel-wide cancellation, so we just allow the
@@ -57,13 +98,22 @@ private:
      */
     void onAresHostCallback(int status, int timeouts, hostent* hostent);
     /**
-     * wrapper function of call to ares_gethostbyname.
+     * c-ares ares_search() query callback, which parses the answer and its TTLs.
+     * @param status return status of call to ares_search.
+     * @param timeouts the number of times the request timed out.
+     * @param abuf the answer.
+     * @param alen the length of the answer.
+     */
+    void onAresSearchCallback(int status, int timeouts, unsigned char* abuf, int alen);
+    /**
+     * Resolve the name from a literal address or the hosts file, or else query it.
      * @param family currently AF_INET and AF_INET6 are supported.
      */
     void getHostByName(int family);
 
     // Caller supplied callback to invoke on query completion or error.
     const ResolveCb callback_;
+    DnsResolverImpl& parent_;
     // Dispatcher to post any callback_ exceptions to.
     Event::Dispatcher& dispatcher_;
     // Does the object own itself? Resource reclamation occurs via self-deleting
@@ -76,10 +126,53 @@ private:
     // If dns_lookup_family is "fallback", fallback to v4 address if v6
     // resolution failed.
     bool fallback_if_failed_ = false;
+    // If dns_lookup_family is "all", resolve v4 addresses once the v6 ones are
+    // resolved, and return both.
+    bool resolve_v4_next_ = false;
+    // The v6 addresses and their TTL while the v4 ones are resolved.
+    std::list<Address::InstanceConstSharedPtr> v6_address_list_;
+    absl::optional<std::chrono::seconds> v6_ttl_;
     const ares_channel channel_;
     const std::string dns_name_;
+    const DnsLookupFamily dns_lookup_family_;
+    // Family of the current query.
+    int family_{};
+    // Shortest TTL of the records the addresses were resolved from. Not set for literal addresses
+    // and for names from the hosts file.
+    absl::optional<std::chrono::seconds> ttl_;
+  };
+
+  struct CacheEntry {
+    std::list<Address::InstanceConstSharedPtr> addresses_;
+    MonotonicTime expiry_;
+    // Lookups from then on resolve the name again in the background.
+    MonotonicTime prefetch_time_;
+    // Is the name being resolved again?
+    bool refreshing_{};
+    std::list<std::string>::iterator lru_entry_;
+  };
+
+  struct Cache {
+    Cache(uint32_t size, std::chrono::seconds max_stale, Stats::ScopePtr&& scope);
+
+    const uint32_t size_;
+    const std::chrono::seconds max_stale_;
+    Stats::ScopePtr scope_;
+    DnsCacheStats stats_;
+    // Keyed by cacheKey().
+    std::unordered_map<std::string, CacheEntry> entries_;
+    // Most recently used first.
+    std::list<std::string> lru_;
   };
 
+  static std::string cacheKey(const std::string& dns_name, DnsLookupFamily dns_lookup_family);
+  // Start resolving a name with c-ares.
+  ActiveDnsQuery* startResolution(const std::string& dns_name, DnsLookupFamily dns_lookup_family,
+                                  ResolveCb callback);
+  // Update the cache with the outcome of a resolution.
+  void onResolution(const PendingResolution& resolution,
+                    const std::list<Address::InstanceConstSharedPtr>& address_list);
+
   // Callback for events on sockets tracked in events_.
   void onEventCallback(int fd, uint32_t events);
   // c-ares callback when a socket state changes, indicating that libevent
@@ -94,6 +187,8 @@ private:
   Event::TimerPtr timer_;
   ares_channel channel_;
   std::unordered_map<int, Event::FileEventPtr> events_;
+  // Set if resolutions are cached.
+  std::unique_ptr<Cache> cache_;
 };
 
 } // namespace Network
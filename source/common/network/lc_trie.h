@@ -21,6 +21,12 @@ namespace Envoy {
 namespace Network {
 namespace LcTrie {
 
+/**
+ * Branching factor used at the root of large LC tries when none is specified. The paper suggests
+ * '16' for large LC tries.
+ */
+constexpr uint32_t LargeRootBranchingFactor = 16;
+
 /**
  * Maximum number of nodes an LC trie can hold.
  * @note If the size of LcTrieInternal::LcNode::address_ ever changes, this constant
@@ -46,13 +52,11 @@ public:
                       (i.e. data isn't inherited from wider ranges).
    * @param fill_factor supplies the fraction of completeness to use when calculating the branch
    *                    value for a sub-trie.
-   * @param root_branching_factor supplies the branching factor at the root.
-   *
-   * TODO(ccaraman): Investigate if a non-zero root branching factor should be the default. The
-   * paper suggests for large LC-Tries to use the value '16'. It reduces the depth of the trie.
-   * However, there is no suggested values for smaller LC-Tries. With perf tests, it is possible to
-   * get this data for smaller LC-Tries. Another option is to expose this in the configuration and
-   * let consumers decide.
+   * @param root_branching_factor supplies the branching factor at the root. If 0, tries with at
+   *                              least 2^LargeRootBranchingFactor disjoint prefixes use
+   *                              LargeRootBranchingFactor, which reduces their depth, as long as
+   *                              the root fits within MaxLcTrieNodes. Smaller tries compute the
+   *                              branching factor of their root like that of any other node.
    */
   LcTrie(const std::vector<std::pair<T, std::vector<Address::CidrRange>>>& data,
          bool exclusive = false, double fill_factor = 0.5, uint32_t root_branching_factor = 0) {
@@ -181,12 +185,23 @@ public:
    * version of the ip_address.
    */
   std::vector<T> getData(const Network::Address::InstanceConstSharedPtr& ip_address) const {
+    return lookup(ip_address);
+  }
+
+  /**
+   * Like getData(), without copying the data.
+   * @param  ip_address supplies the IP address.
+   * @return a reference to the data from the CIDR ranges that contain 'ip_address', which is valid
+   * for the lifetime of the trie. The reference is to an empty vector if no prefix contains
+   * 'ip_address'.
+   */
+  const std::vector<T>& lookup(const Network::Address::InstanceConstSharedPtr& ip_address) const {
     if (ip_address->ip()->version() == Address::IpVersion::v4) {
       Ipv4 ip = ntohl(ip_address->ip()->ipv4()->address());
-      return ipv4_trie_->getData(ip);
+      return ipv4_trie_->lookup(ip, no_data_);
     } else {
       Ipv6 ip = Utility::Ip6ntohl(ip_address->ip()->ipv6()->address());
-      return ipv6_trie_->getData(ip);
+      return ipv6_trie_->lookup(ip, no_data_);
     }
   }
 
@@ -230,6 +245,29 @@ private:
   typedef uint32_t Ipv4;
   typedef absl::uint128 Ipv6;
 
+  /**
+   * Extract n bits from input starting at position p, like extractBits(), while looking up an
+   * address. n is at most 31.
+   */
+  static uint32_t extractLookupBits(uint32_t p, uint32_t n, Ipv4 input) {
+    return extractBits<Ipv4>(p, n, input);
+  }
+
+  // Most of the nodes of an IPv6 trie branch on bits within one half of the address, which only
+  // takes 64-bit shifts rather than absl::uint128 ones.
+  static uint32_t extractLookupBits(uint32_t p, uint32_t n, const Ipv6& input) {
+    if (n == 0) {
+      return 0;
+    }
+    if (p + n <= 64) {
+      return absl::Uint128High64(input) << p >> (64 - n);
+    }
+    if (p >= 64) {
+      return absl::Uint128Low64(input) << (p - 64) >> (64 - n);
+    }
+    return static_cast<uint32_t>(extractBits<Ipv6>(p, n, input));
+  }
+
   typedef std::unordered_set<T> DataSet;
   typedef std::shared_ptr<DataSet> DataSetSharedPtr;
 
@@ -295,6 +333,8 @@ private:
     uint32_t length_{0};
     // Data for this entry.
     DataSet data_;
+    // The same data, which lookups return, once the entry is in an LC trie.
+    std::vector<T> values_;
   };
 
   /**
@@ -426,11 +466,12 @@ private:
 
     /**
      * Retrieve the data associated with the CIDR range that contains `ip_address`.
-     * @param  ip_address supplies the IP address in host byte order.
-     * @return a vector of data from the CIDR ranges and IP addresses that encompasses the input.
-     * An empty vector is returned if the LC Trie is empty.
+     * @param ip_address supplies the IP address in host byte order.
+     * @param no_data supplies the vector to return if no CIDR range contains the input.
+     * @return a reference to the data from the CIDR ranges and IP addresses that encompasses the
+     * input.
      */
-    std::vector<T> getData(const IpType& ip_address) const;
+    const std::vector<T>& lookup(const IpType& ip_address, const std::vector<T>& no_data) const;
 
   private:
     /**
@@ -444,6 +485,19 @@ private:
 
       ip_prefixes_ = data;
       std::sort(ip_prefixes_.begin(), ip_prefixes_.end());
+      for (auto& prefix : ip_prefixes_) {
+        prefix.values_.assign(prefix.data_.begin(), prefix.data_.end());
+        prefix.data_.clear();
+      }
+
+      // A wide root saves large tries levels of lookups, at the cost of 2^branch nodes which
+      // must fit along with the rest of the trie.
+      if (root_branching_factor_ == 0 &&
+          ip_prefixes_.size() >= (1u << LargeRootBranchingFactor) &&
+          ip_prefixes_.size() / fill_factor_ + (1u << LargeRootBranchingFactor) <=
+              MaxLcTrieNodes) {
+        root_branching_factor_ = LargeRootBranchingFactor;
+      }
 
       // Build the trie_.
       trie_.reserve(static_cast<size_t>(ip_prefixes_.size() / fill_factor_));
@@ -498,7 +552,7 @@ private:
       // According to the original LC-Trie paper, a large branching factor(suggested value: 16)
       // at the root increases performance.
       if (root_branching_factor_ > 0 && prefix == 0 && first == 0) {
-        compute.branch_ = root_branching_factor_;
+        compute.branch_ = std::min(root_branching_factor_, address_size - compute.prefix_);
         return compute;
       }
 
@@ -689,9 +743,10 @@ private:
     std::vector<LcNode> trie_;
 
     const double fill_factor_;
-    const uint32_t root_branching_factor_;
+    uint32_t root_branching_factor_;
   };
 
+  const std::vector<T> no_data_;
   std::unique_ptr<LcTrieInternal<Ipv4>> ipv4_trie_;
   std::unique_ptr<LcTrieInternal<Ipv6>> ipv6_trie_;
 };
@@ -707,11 +762,11 @@ LcTrie<T>::LcTrieInternal<IpType, address_size>::LcTrieInternal(std::vector<IpPr
 
 template <class T>
 template <class IpType, uint32_t address_size>
-std::vector<T>
-LcTrie<T>::LcTrieInternal<IpType, address_size>::getData(const IpType& ip_address) const {
-  std::vector<T> return_vector;
+const std::vector<T>&
+LcTrie<T>::LcTrieInternal<IpType, address_size>::lookup(const IpType& ip_address,
+                                                        const std::vector<T>& no_data) const {
   if (trie_.empty()) {
-    return return_vector;
+    return no_data;
   }
 
   LcNode node = trie_[0];
@@ -721,10 +776,8 @@ LcTrie<T>::LcTrieInternal<IpType, address_size>::getData(const IpType& ip_addres
 
   // branch == 0 is a leaf node.
   while (branch != 0) {
-    // branch is at most 2^5-1= 31 bits to extract, so we can safely cast the
-    // output of extractBits to uint32_t without any data loss.
-    node = trie_[address + static_cast<uint32_t>(
-                               extractBits<IpType, address_size>(position, branch, ip_address))];
+    // branch is at most 2^5-1= 31 bits to extract, so the bits fit in a uint32_t.
+    node = trie_[address + extractLookupBits(position, branch, ip_address)];
     position += branch + node.skip_;
     branch = node.branch_;
     address = node.address_;
@@ -735,9 +788,9 @@ LcTrie<T>::LcTrieInternal<IpType, address_size>::getData(const IpType& ip_addres
   // ip_address.
   const auto& prefix = ip_prefixes_[address];
   if (prefix.contains(ip_address)) {
-    return std::vector<T>(prefix.data_.begin(), prefix.data_.end());
+    return prefix.values_;
   }
-  return std::vector<T>();
+  return no_data;
 }
 
 } // namespace LcTrie
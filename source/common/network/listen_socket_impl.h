@@ -73,6 +73,19 @@ public:
 
 typedef std::unique_ptr<TcpListenSocket> TcpListenSocketPtr;
 
+/**
+ * Wraps a datagram socket bound to an IP address.
+ */
+class UdpListenSocket : public ListenSocketImpl {
+public:
+  UdpListenSocket(const Address::InstanceConstSharedPtr& address,
+                  const Network::Socket::OptionsSharedPtr& options, bool bind_to_port);
+  UdpListenSocket(int fd, const Address::InstanceConstSharedPtr& address,
+                  const Network::Socket::OptionsSharedPtr& options);
+};
+
+typedef std::unique_ptr<UdpListenSocket> UdpListenSocketPtr;
+
 class UdsListenSocket : public ListenSocketImpl {
 public:
   UdsListenSocket(const Address::InstanceConstSharedPtr& address);
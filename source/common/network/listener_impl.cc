@@ -76,6 +76,20 @@ ListenerImpl::ListenerImpl(Event::DispatcherImpl& dispatcher, Socket& socket, Li
   }
 }
 
+void ListenerImpl::disable() {
+  if (listener_) {
+    // libevent checks whether the listener is still enabled after each accept callback, so this
+    // also ends the current accept loop.
+    evconnlistener_disable(listener_.get());
+  }
+}
+
+void ListenerImpl::enable() {
+  if (listener_) {
+    evconnlistener_enable(listener_.get());
+  }
+}
+
 void ListenerImpl::errorCallback(evconnlistener*, void*) {
   // We should never get an error callback. This can happen if we run out of FDs or memory. In those
   // cases just crash.
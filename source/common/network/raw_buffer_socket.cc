@@ -1,5 +1,7 @@
 #include "common/network/raw_buffer_socket.h"
 
+#include <algorithm>
+
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/http/headers.h"
@@ -7,6 +9,9 @@
 namespace Envoy {
 namespace Network {
 
+constexpr uint64_t RawBufferSocket::MinReadSize;
+constexpr uint64_t RawBufferSocket::MaxReadSize;
+
 void RawBufferSocket::setTransportSocketCallbacks(TransportSocketCallbacks& callbacks) {
   callbacks_ = &callbacks;
 }
@@ -16,8 +21,7 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
   uint64_t bytes_read = 0;
   bool end_stream = false;
   do {
-    // 16K read is arbitrary. TODO(mattklein123) PERF: Tune the read size.
-    Api::SysCallIntResult result = buffer.read(callbacks_->fd(), 16384);
+    Api::SysCallIntResult result = buffer.read(callbacks_->fd(), read_size_);
     ENVOY_CONN_LOG(trace, "read returns: {}", callbacks_->connection(), result.rc_);
 
     if (result.rc_ == 0) {
@@ -33,6 +37,9 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
       break;
     } else {
       bytes_read += result.rc_;
+      if (static_cast<uint64_t>(result.rc_) == read_size_) {
+        read_size_ = std::min(read_size_ * 2, MaxReadSize);
+      }
       if (callbacks_->shouldDrainReadBuffer()) {
         callbacks_->setReadBufferReady();
         break;
@@ -40,6 +47,10 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
     }
   } while (true);
 
+  if (bytes_read > 0 && bytes_read * 4 <= read_size_) {
+    read_size_ = std::max(read_size_ / 2, MinReadSize);
+  }
+
   return {action, bytes_read, end_stream};
 }
 
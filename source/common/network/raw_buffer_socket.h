@@ -21,7 +21,15 @@ public:
   IoResult doWrite(Buffer::Instance& buffer, bool end_stream) override;
   const Ssl::Connection* ssl() const override { return nullptr; }
 
+  // Bounds of the adaptive per-read size.
+  static constexpr uint64_t MinReadSize = 4096;
+  static constexpr uint64_t MaxReadSize = 65536;
+
 private:
+  // Reads start at this size. It doubles after each read that fills it, and halves after a read
+  // event that delivered no more than a quarter of it, so that busy connections take fewer read
+  // syscalls and mostly idle ones reserve less memory.
+  uint64_t read_size_{16384};
   TransportSocketCallbacks* callbacks_{};
   bool shutdown_{};
 };
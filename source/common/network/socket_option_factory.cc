@@ -85,5 +85,47 @@ SocketOptionFactory::buildTcpFastOpenOptions(uint32_t queue_length) {
   return options;
 }
 
+std::unique_ptr<Socket::Options> SocketOptionFactory::buildTcpFastOpenConnectOptions() {
+  std::unique_ptr<Socket::Options> options = absl::make_unique<Socket::Options>();
+  options->push_back(std::make_shared<Network::SocketOptionImpl>(
+      envoy::api::v2::core::SocketOption::STATE_PREBIND, ENVOY_SOCKET_TCP_FASTOPEN_CONNECT, 1));
+  return options;
+}
+
+std::unique_ptr<Socket::Options> SocketOptionFactory::buildReusePortOptions() {
+  std::unique_ptr<Socket::Options> options = absl::make_unique<Socket::Options>();
+  options->push_back(std::make_shared<Network::SocketOptionImpl>(
+      envoy::api::v2::core::SocketOption::STATE_PREBIND, ENVOY_SOCKET_SO_REUSEPORT, 1));
+  return options;
+}
+
+std::unique_ptr<Socket::Options> SocketOptionFactory::buildIncomingCpuOptions(uint32_t cpu) {
+  std::unique_ptr<Socket::Options> options = absl::make_unique<Socket::Options>();
+  options->push_back(std::make_shared<Network::SocketOptionImpl>(
+      envoy::api::v2::core::SocketOption::STATE_PREBIND, ENVOY_SOCKET_SO_INCOMING_CPU, cpu));
+  return options;
+}
+
+std::unique_ptr<Socket::Options> SocketOptionFactory::buildTcpLatencyOptions(
+    const envoy::api::v2::core::TcpLatencyOptions& latency_options) {
+  std::unique_ptr<Socket::Options> options = absl::make_unique<Socket::Options>();
+  if (latency_options.has_busy_poll_us()) {
+    options->push_back(std::make_shared<Network::SocketOptionImpl>(
+        envoy::api::v2::core::SocketOption::STATE_PREBIND, ENVOY_SOCKET_SO_BUSY_POLL,
+        latency_options.busy_poll_us().value()));
+  }
+  if (latency_options.has_incoming_cpu()) {
+    options->push_back(std::make_shared<Network::SocketOptionImpl>(
+        envoy::api::v2::core::SocketOption::STATE_PREBIND, ENVOY_SOCKET_SO_INCOMING_CPU,
+        latency_options.incoming_cpu().value()));
+  }
+  if (latency_options.has_notsent_lowat()) {
+    options->push_back(std::make_shared<Network::SocketOptionImpl>(
+        envoy::api::v2::core::SocketOption::STATE_PREBIND, ENVOY_SOCKET_TCP_NOTSENT_LOWAT,
+        latency_options.notsent_lowat().value()));
+  }
+  return options;
+}
+
 } // namespace Network
 } // namespace Envoy
@@ -30,6 +30,11 @@ public:
   static std::unique_ptr<Socket::Options> buildIpFreebindOptions();
   static std::unique_ptr<Socket::Options> buildIpTransparentOptions();
   static std::unique_ptr<Socket::Options> buildTcpFastOpenOptions(uint32_t queue_length);
+  static std::unique_ptr<Socket::Options> buildTcpFastOpenConnectOptions();
+  static std::unique_ptr<Socket::Options> buildReusePortOptions();
+  static std::unique_ptr<Socket::Options> buildIncomingCpuOptions(uint32_t cpu);
+  static std::unique_ptr<Socket::Options>
+  buildTcpLatencyOptions(const envoy::api::v2::core::TcpLatencyOptions& latency_options);
   static std::unique_ptr<Socket::Options> buildLiteralOptions(
       const Protobuf::RepeatedPtrField<envoy::api::v2::core::SocketOption>& socket_options);
 };
@@ -76,6 +76,34 @@ typedef absl::optional<std::pair<int, int>> SocketOptionName;
 #define ENVOY_SOCKET_TCP_KEEPINTVL Network::SocketOptionName()
 #endif
 
+#ifdef SO_REUSEPORT
+#define ENVOY_SOCKET_SO_REUSEPORT                                                                  \
+  Network::SocketOptionName(std::make_pair(SOL_SOCKET, SO_REUSEPORT))
+#else
+#define ENVOY_SOCKET_SO_REUSEPORT Network::SocketOptionName()
+#endif
+
+#ifdef SO_INCOMING_CPU
+#define ENVOY_SOCKET_SO_INCOMING_CPU                                                               \
+  Network::SocketOptionName(std::make_pair(SOL_SOCKET, SO_INCOMING_CPU))
+#else
+#define ENVOY_SOCKET_SO_INCOMING_CPU Network::SocketOptionName()
+#endif
+
+#ifdef SO_BUSY_POLL
+#define ENVOY_SOCKET_SO_BUSY_POLL                                                                  \
+  Network::SocketOptionName(std::make_pair(SOL_SOCKET, SO_BUSY_POLL))
+#else
+#define ENVOY_SOCKET_SO_BUSY_POLL Network::SocketOptionName()
+#endif
+
+#ifdef TCP_NOTSENT_LOWAT
+#define ENVOY_SOCKET_TCP_NOTSENT_LOWAT                                                             \
+  Network::SocketOptionName(std::make_pair(IPPROTO_TCP, TCP_NOTSENT_LOWAT))
+#else
+#define ENVOY_SOCKET_TCP_NOTSENT_LOWAT Network::SocketOptionName()
+#endif
+
 #ifdef TCP_FASTOPEN
 #define ENVOY_SOCKET_TCP_FASTOPEN                                                                  \
   Network::SocketOptionName(std::make_pair(IPPROTO_TCP, TCP_FASTOPEN))
@@ -83,6 +111,13 @@ typedef absl::optional<std::pair<int, int>> SocketOptionName;
 #define ENVOY_SOCKET_TCP_FASTOPEN Network::SocketOptionName()
 #endif
 
+#ifdef TCP_FASTOPEN_CONNECT
+#define ENVOY_SOCKET_TCP_FASTOPEN_CONNECT                                                          \
+  Network::SocketOptionName(std::make_pair(IPPROTO_TCP, TCP_FASTOPEN_CONNECT))
+#else
+#define ENVOY_SOCKET_TCP_FASTOPEN_CONNECT Network::SocketOptionName()
+#endif
+
 class SocketOptionImpl : public Socket::Option, Logger::Loggable<Logger::Id::connection> {
 public:
   SocketOptionImpl(envoy::api::v2::core::SocketOption::SocketState in_state,
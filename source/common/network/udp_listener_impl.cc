@@ -0,0 +1,152 @@
+#include "common/network/udp_listener_impl.h"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cstring>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/network/address_impl.h"
+
+namespace Envoy {
+namespace Network {
+
+UdpBatchReader::UdpBatchReader() : batch_buffer_(MAX_BATCH_SIZE * MAX_DATAGRAM_SIZE) {}
+
+void UdpBatchReader::read(int fd, const DatagramCb& cb, const BatchDoneCb& batch_done_cb) {
+  for (uint32_t i = 0; i < MAX_BATCHES_PER_EVENT; ++i) {
+    if (readBatch(fd, cb, batch_done_cb) < MAX_BATCH_SIZE) {
+      return;
+    }
+  }
+}
+
+uint32_t UdpBatchReader::readBatch(int fd, const DatagramCb& cb,
+                                   const BatchDoneCb& batch_done_cb) {
+  sockaddr_storage peer_addresses[MAX_BATCH_SIZE];
+  iovec iovs[MAX_BATCH_SIZE];
+#if defined(__linux__)
+  mmsghdr messages[MAX_BATCH_SIZE];
+  memset(messages, 0, sizeof(messages));
+  for (uint32_t i = 0; i < MAX_BATCH_SIZE; ++i) {
+    iovs[i].iov_base = &batch_buffer_[i * MAX_DATAGRAM_SIZE];
+    iovs[i].iov_len = MAX_DATAGRAM_SIZE;
+    messages[i].msg_hdr.msg_iov = &iovs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+    messages[i].msg_hdr.msg_name = &peer_addresses[i];
+    messages[i].msg_hdr.msg_namelen = sizeof(peer_addresses[i]);
+  }
+
+  const int rc = ::recvmmsg(fd, messages, MAX_BATCH_SIZE, 0, nullptr);
+  if (rc <= 0) {
+    if (rc == -1 && errno != EAGAIN) {
+      ENVOY_LOG(debug, "udp receive error: {}", strerror(errno));
+    }
+    return 0;
+  }
+
+  for (int i = 0; i < rc; ++i) {
+    if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) {
+      ENVOY_LOG(debug, "dropped a datagram larger than {} bytes", MAX_DATAGRAM_SIZE);
+      continue;
+    }
+    cb(static_cast<const char*>(iovs[i].iov_base), messages[i].msg_len, peer_addresses[i],
+       messages[i].msg_hdr.msg_namelen);
+  }
+  if (batch_done_cb) {
+    batch_done_cb();
+  }
+  return rc;
+#else
+  msghdr message{};
+  iovs[0].iov_base = batch_buffer_.data();
+  iovs[0].iov_len = MAX_DATAGRAM_SIZE;
+  message.msg_iov = &iovs[0];
+  message.msg_iovlen = 1;
+  message.msg_name = &peer_addresses[0];
+  message.msg_namelen = sizeof(peer_addresses[0]);
+
+  const ssize_t rc = ::recvmsg(fd, &message, 0);
+  if (rc < 0) {
+    if (errno != EAGAIN) {
+      ENVOY_LOG(debug, "udp receive error: {}", strerror(errno));
+    }
+    return 0;
+  }
+
+  if (message.msg_flags & MSG_TRUNC) {
+    ENVOY_LOG(debug, "dropped a datagram larger than {} bytes", MAX_DATAGRAM_SIZE);
+  } else {
+    cb(batch_buffer_.data(), rc, peer_addresses[0], message.msg_namelen);
+  }
+  if (batch_done_cb) {
+    batch_done_cb();
+  }
+  // Report a full batch, so that the next datagram is read in the same event loop iteration.
+  return MAX_BATCH_SIZE;
+#endif
+}
+
+UdpListenerImpl::UdpListenerImpl(Event::Dispatcher& dispatcher, Socket& socket,
+                                 UdpListenerCallbacks& cb)
+    : dispatcher_(dispatcher), socket_(socket), cb_(cb),
+      datagram_cb_([this](const char* data, uint64_t size, const sockaddr_storage& peer_address,
+                          socklen_t peer_address_length) {
+        onDatagram(data, size, peer_address, peer_address_length);
+      }) {
+  file_event_ = dispatcher.createFileEvent(
+      socket.fd(), [this](uint32_t) { reader_.read(socket_.fd(), datagram_cb_); },
+      Event::FileTriggerType::Level, Event::FileReadyType::Read);
+}
+
+void UdpListenerImpl::disable() { file_event_->setEnabled(0); }
+
+void UdpListenerImpl::enable() { file_event_->setEnabled(Event::FileReadyType::Read); }
+
+void UdpListenerImpl::onDatagram(const char* data, uint64_t size,
+                                 const sockaddr_storage& peer_address,
+                                 socklen_t peer_address_length) {
+  const Address::InstanceConstSharedPtr& local_address = socket_.localAddress();
+  UdpRecvData recv_data;
+  recv_data.local_address_ = local_address;
+  // As for accepted connections, an IPv4 peer of a dual stack IPv6 socket is reported as an IPv4
+  // address.
+  recv_data.peer_address_ = Address::addressFromSockAddr(
+      peer_address, peer_address_length,
+      local_address->ip() != nullptr && local_address->ip()->version() == Address::IpVersion::v6);
+  recv_data.buffer_ = std::make_unique<Buffer::OwnedImpl>(data, size);
+  cb_.onData(std::move(recv_data));
+}
+
+Api::SysCallSizeResult UdpListenerImpl::send(const Address::Instance& peer_address,
+                                             Buffer::Instance& data) {
+  const uint64_t num_slices = data.getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  data.getRawSlices(slices, num_slices);
+  iovec iovs[num_slices];
+  for (uint64_t i = 0; i < num_slices; ++i) {
+    iovs[i].iov_base = slices[i].mem_;
+    iovs[i].iov_len = slices[i].len_;
+  }
+
+  const Api::SysCallSizeResult result = peer_address.sendTo(socket_.fd(), iovs, num_slices);
+  if (result.rc_ >= 0) {
+    data.drain(data.length());
+  }
+  return result;
+}
+
+Api::SysCallIntResult UdpListenerImpl::sendBatch(const Address::Instance& peer_address,
+                                                 const Buffer::RawSlice* datagrams,
+                                                 uint64_t num_datagrams) {
+  iovec iovs[num_datagrams];
+  for (uint64_t i = 0; i < num_datagrams; ++i) {
+    iovs[i].iov_base = datagrams[i].mem_;
+    iovs[i].iov_len = datagrams[i].len_;
+  }
+  return peer_address.sendBatchTo(socket_.fd(), iovs, num_datagrams);
+}
+
+} // namespace Network
+} // namespace Envoy
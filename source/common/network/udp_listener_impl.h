@@ -0,0 +1,105 @@
+#pragma once
+
+#include <sys/socket.h>
+
+#include <functional>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/file_event.h"
+#include "envoy/network/listener.h"
+
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * Reads batches of datagrams from a non-blocking datagram socket. On Linux a batch is read with a
+ * single recvmmsg() call, elsewhere one datagram is read per call.
+ */
+class UdpBatchReader : Logger::Loggable<Logger::Id::connection> {
+public:
+  UdpBatchReader();
+
+  /**
+   * Called for each datagram of a batch, in the order they were received.
+   * @param data supplies the datagram, which is valid until the end of its batch.
+   * @param size supplies the size of the datagram.
+   * @param peer_address supplies the address the datagram was sent from.
+   * @param peer_address_length supplies the length of peer_address.
+   */
+  typedef std::function<void(const char* data, uint64_t size,
+                             const sockaddr_storage& peer_address, socklen_t peer_address_length)>
+      DatagramCb;
+
+  /**
+   * Called after the datagrams of a batch were delivered, before their storage is reused. Allows
+   * handling the datagrams of a batch together, e.g. forwarding them with a single sendmmsg().
+   */
+  typedef std::function<void()> BatchDoneCb;
+
+  /**
+   * Read up to MAX_BATCHES_PER_EVENT batches, so that a busy socket does not starve the other
+   * events of the dispatcher. The socket should be level triggered, so that the datagrams left are
+   * read in the next event loop iteration.
+   * @param fd supplies the socket to read from.
+   * @param cb supplies the callback for each datagram read.
+   * @param batch_done_cb supplies the callback after each batch with at least one datagram.
+   */
+  void read(int fd, const DatagramCb& cb, const BatchDoneCb& batch_done_cb);
+  void read(int fd, const DatagramCb& cb) { read(fd, cb, nullptr); }
+
+  // The maximum number of datagrams read from the socket at once.
+  static constexpr uint32_t MAX_BATCH_SIZE = 16;
+  // The maximum number of batches read per event loop iteration.
+  static constexpr uint32_t MAX_BATCHES_PER_EVENT = 4;
+  // The largest datagram received. Larger datagrams are truncated by the kernel and dropped. This
+  // fits the packets of datagram protocols such as QUIC, which avoid IP fragmentation.
+  static constexpr uint64_t MAX_DATAGRAM_SIZE = 1500;
+
+private:
+  /**
+   * Read a batch of datagrams.
+   * @return uint32_t the number of datagrams read, less than MAX_BATCH_SIZE if no more are
+   *         pending on the socket.
+   */
+  uint32_t readBatch(int fd, const DatagramCb& cb, const BatchDoneCb& batch_done_cb);
+
+  // Storage for the datagrams of a batch, MAX_DATAGRAM_SIZE bytes each.
+  std::vector<char> batch_buffer_;
+};
+
+/**
+ * Network::UdpListener reading batches of datagrams with a UdpBatchReader.
+ */
+class UdpListenerImpl : public UdpListener {
+public:
+  UdpListenerImpl(Event::Dispatcher& dispatcher, Socket& socket, UdpListenerCallbacks& cb);
+
+  // Network::Listener
+  void disable() override;
+  void enable() override;
+
+  // Network::UdpListener
+  Event::Dispatcher& dispatcher() override { return dispatcher_; }
+  Api::SysCallSizeResult send(const Address::Instance& peer_address,
+                              Buffer::Instance& data) override;
+  Api::SysCallIntResult sendBatch(const Address::Instance& peer_address,
+                                  const Buffer::RawSlice* datagrams,
+                                  uint64_t num_datagrams) override;
+
+private:
+  void onDatagram(const char* data, uint64_t size, const sockaddr_storage& peer_address,
+                  socklen_t peer_address_length);
+
+  Event::Dispatcher& dispatcher_;
+  Socket& socket_;
+  UdpListenerCallbacks& cb_;
+  UdpBatchReader reader_;
+  const UdpBatchReader::DatagramCb datagram_cb_;
+  Event::FileEventPtr file_event_;
+};
+
+} // namespace Network
+} // namespace Envoy
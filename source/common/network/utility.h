@@ -34,6 +34,7 @@ typedef std::list<PortRange> PortRangeList;
 class Utility {
 public:
   static const std::string TCP_SCHEME;
+  static const std::string UDP_SCHEME;
   static const std::string UNIX_SCHEME;
 
   /**
@@ -50,6 +51,13 @@ public:
    */
   static bool urlIsTcpScheme(const std::string& url);
 
+  /**
+   * Match a URL to the UDP scheme
+   * @param url supplies the URL to match.
+   * @return bool true if the URL matches the UDP scheme, false otherwise.
+   */
+  static bool urlIsUdpScheme(const std::string& url);
+
   /**
    * Match a URL to the Unix scheme
    * @param url supplies the Unix to match.
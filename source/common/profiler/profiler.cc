@@ -5,6 +5,7 @@
 #ifdef TCMALLOC
 
 #include "gperftools/heap-profiler.h"
+#include "gperftools/malloc_extension.h"
 #include "gperftools/profiler.h"
 
 namespace Envoy {
@@ -18,6 +19,11 @@ bool Cpu::startProfiler(const std::string& output_path) {
 
 void Cpu::stopProfiler() { ProfilerStop(); }
 
+bool Heap::sample(std::string& output) {
+  MallocExtension::instance()->GetHeapSample(&output);
+  return true;
+}
+
 void Heap::forceLink() {
   // Currently this is here to force the inclusion of the heap profiler during static linking.
   // Without this call the heap profiler will not be included and cannot be started via env
@@ -37,6 +43,8 @@ bool Cpu::profilerEnabled() { return false; }
 bool Cpu::startProfiler(const std::string&) { return false; }
 void Cpu::stopProfiler() {}
 
+bool Heap::sample(std::string&) { return false; }
+
 } // namespace Profiler
 } // namespace Envoy
 
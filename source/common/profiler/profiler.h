@@ -31,6 +31,15 @@ public:
  * Process wide heap profiling
  */
 class Heap {
+public:
+  /**
+   * Sample the live heap allocations. tcmalloc only samples allocations when the
+   * TCMALLOC_SAMPLE_PARAMETER environment variable sets the average sampling interval in bytes.
+   * @param output supplies the string the sample is written to in pprof format.
+   * @return bool whether heap sampling is supported.
+   */
+  static bool sample(std::string& output);
+
 private:
   static void forceLink();
 };
@@ -235,12 +235,22 @@ public:
   template <class MessageType>
   static inline MessageType anyConvert(const ProtobufWkt::Any& message) {
     MessageType typed_message;
+    unpackTo(message, typed_message);
+    return typed_message;
+  };
+
+  /**
+   * Unpack a google.protobuf.Any into a typed message in place, e.g. one allocated on an arena.
+   * @param message source google.protobuf.Any message.
+   * @param typed_message destination message, which must be of the type inside the Any.
+   * @throw EnvoyException if the Any does not hold a valid message of the destination type.
+   */
+  static void unpackTo(const ProtobufWkt::Any& message, Protobuf::Message& typed_message) {
     if (!message.UnpackTo(&typed_message)) {
       throw EnvoyException("Unable to unpack " + message.DebugString());
     }
     checkUnknownFields(typed_message);
-    return typed_message;
-  };
+  }
 
   /**
    * Convert between two protobufs via a JSON round-trip. This is used to translate arbitrary
@@ -313,6 +323,18 @@ public:
 
   bool operator!=(const HashedValue& rhs) const { return !(*this == rhs); }
 
+  /**
+   * Fold a metadata key and its value into a running hash. Folding each pair of a lexically sorted
+   * list of metadata in order yields a hash of the whole list, starting from a hash of 0.
+   * @param hash supplies the hash of the preceding pairs.
+   * @param key supplies the metadata key.
+   * @param value supplies the metadata value.
+   * @return uint64_t the hash including key and value.
+   */
+  static uint64_t combine(uint64_t hash, absl::string_view key, const HashedValue& value) {
+    return HashUtil::xxHash64(key, hash + value.hash());
+  }
+
 private:
   const ProtobufWkt::Value value_;
   const std::size_t hash_;
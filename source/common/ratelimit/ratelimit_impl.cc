@@ -31,8 +31,12 @@ void GrpcClientImpl::cancel() {
 
 void GrpcClientImpl::createRequest(envoy::service::ratelimit::v2::RateLimitRequest& request,
                                    const std::string& domain,
-                                   const std::vector<Descriptor>& descriptors) {
+                                   const std::vector<Descriptor>& descriptors,
+                                   uint32_t hits_addend) {
   request.set_domain(domain);
+  if (hits_addend > 1) {
+    request.set_hits_addend(hits_addend);
+  }
   for (const Descriptor& descriptor : descriptors) {
     envoy::api::v2::ratelimit::RateLimitDescriptor* new_descriptor = request.add_descriptors();
     for (const DescriptorEntry& entry : descriptor.entries_) {
@@ -45,12 +49,13 @@ void GrpcClientImpl::createRequest(envoy::service::ratelimit::v2::RateLimitReque
 }
 
 void GrpcClientImpl::limit(RequestCallbacks& callbacks, const std::string& domain,
-                           const std::vector<Descriptor>& descriptors, Tracing::Span& parent_span) {
+                           const std::vector<Descriptor>& descriptors, uint32_t hits_addend,
+                           Tracing::Span& parent_span) {
   ASSERT(callbacks_ == nullptr);
   callbacks_ = &callbacks;
 
   envoy::service::ratelimit::v2::RateLimitRequest request;
-  createRequest(request, domain, descriptors);
+  createRequest(request, domain, descriptors, hits_addend);
 
   request_ = async_client_->send(service_method_, request, *this, parent_span, timeout_);
 }
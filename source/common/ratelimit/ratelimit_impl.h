@@ -46,12 +46,14 @@ public:
   ~GrpcClientImpl();
 
   static void createRequest(envoy::service::ratelimit::v2::RateLimitRequest& request,
-                            const std::string& domain, const std::vector<Descriptor>& descriptors);
+                            const std::string& domain, const std::vector<Descriptor>& descriptors,
+                            uint32_t hits_addend = 1);
 
   // RateLimit::Client
   void cancel() override;
   void limit(RequestCallbacks& callbacks, const std::string& domain,
-             const std::vector<Descriptor>& descriptors, Tracing::Span& parent_span) override;
+             const std::vector<Descriptor>& descriptors, uint32_t hits_addend,
+             Tracing::Span& parent_span) override;
 
   // Grpc::AsyncRequestCallbacks
   void onCreateInitialMetadata(Http::HeaderMap&) override {}
@@ -86,7 +88,7 @@ public:
   // RateLimit::Client
   void cancel() override {}
   void limit(RequestCallbacks& callbacks, const std::string&, const std::vector<Descriptor>&,
-             Tracing::Span&) override {
+             uint32_t, Tracing::Span&) override {
     callbacks.complete(LimitStatus::OK, nullptr);
   }
 };
@@ -5,7 +5,39 @@
 namespace Envoy {
 namespace RequestInfo {
 
+FilterStateKeys::Registry& FilterStateKeys::registry() {
+  // Never destroyed, since keys are held in statics of other translation units.
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+const FilterState::Key& FilterStateKeys::registerKey(absl::string_view name) {
+  Registry& registry = FilterStateKeys::registry();
+  absl::MutexLock lock(&registry.mutex_);
+  const auto it = registry.keys_by_name_.find(name);
+  if (it != registry.keys_by_name_.end()) {
+    return *it->second;
+  }
+  registry.keys_.emplace_back(name, registry.keys_.size());
+  const FilterState::Key& key = registry.keys_.back();
+  registry.keys_by_name_.emplace(key.name(), &key);
+  return key;
+}
+
+const FilterState::Key* FilterStateKeys::find(absl::string_view name) {
+  Registry& registry = FilterStateKeys::registry();
+  absl::ReaderMutexLock lock(&registry.mutex_);
+  const auto it = registry.keys_by_name_.find(name);
+  return it != registry.keys_by_name_.end() ? it->second : nullptr;
+}
+
 void FilterStateImpl::setData(absl::string_view data_name, std::unique_ptr<Object>&& data) {
+  const Key* key = FilterStateKeys::find(data_name);
+  if (key != nullptr) {
+    setData(*key, std::move(data));
+    return;
+  }
+
   // TODO(Google): Remove string conversion when fixed internally.
   const std::string name(data_name);
   if (data_storage_.find(name) != data_storage_.end()) {
@@ -16,12 +48,34 @@ void FilterStateImpl::setData(absl::string_view data_name, std::unique_ptr<Objec
   data_storage_[name] = std::move(data);
 }
 
+void FilterStateImpl::setData(const Key& key, std::unique_ptr<Object>&& data) {
+  if (key.slot() >= slots_.size()) {
+    slots_.resize(key.slot() + 1);
+  } else if (slots_[key.slot()] != nullptr) {
+    throw EnvoyException("FilterState::setData<T> called twice with same name.");
+  }
+  slots_[key.slot()] = std::move(data);
+}
+
 bool FilterStateImpl::hasDataWithName(absl::string_view data_name) const {
+  const Key* key = FilterStateKeys::find(data_name);
+  if (key != nullptr) {
+    return hasDataWithKey(*key);
+  }
   // TODO(Google): Remove string conversion when fixed internally.
   return data_storage_.count(std::string(data_name)) > 0;
 }
 
+bool FilterStateImpl::hasDataWithKey(const Key& key) const {
+  return key.slot() < slots_.size() && slots_[key.slot()] != nullptr;
+}
+
 const FilterState::Object* FilterStateImpl::getDataGeneric(absl::string_view data_name) const {
+  const Key* key = FilterStateKeys::find(data_name);
+  if (key != nullptr) {
+    return getDataGeneric(*key);
+  }
+
   // TODO(Google): Remove string conversion when fixed internally.
   const auto& it = data_storage_.find(std::string(data_name));
 
@@ -31,5 +85,12 @@ const FilterState::Object* FilterStateImpl::getDataGeneric(absl::string_view dat
   return it->second.get();
 }
 
+const FilterState::Object* FilterStateImpl::getDataGeneric(const Key& key) const {
+  if (!hasDataWithKey(key)) {
+    throw EnvoyException("FilterState::getData<T> called for unknown data name.");
+  }
+  return slots_[key.slot()].get();
+}
+
 } // namespace RequestInfo
 } // namespace Envoy
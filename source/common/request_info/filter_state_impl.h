@@ -1,22 +1,66 @@
 #pragma once
 
+#include <deque>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "envoy/request_info/filter_state.h"
 
+#include "common/common/utility.h"
+
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace RequestInfo {
 
+/**
+ * Process wide registry of the filter state keys. Filters register the names of the data they share
+ * once, typically as function local statics, and use the returned keys on the request path. Data
+ * accessed by name is looked up in the registry under a reader lock first.
+ */
+class FilterStateKeys {
+public:
+  /**
+   * Register a data name, or return the key it was already registered with.
+   * @param name supplies the data name.
+   * @return const FilterState::Key& the key of the name, valid for the lifetime of the process.
+   */
+  static const FilterState::Key& registerKey(absl::string_view name);
+
+  /**
+   * @param name supplies a data name.
+   * @return const FilterState::Key* the key the name was registered with, or nullptr.
+   */
+  static const FilterState::Key* find(absl::string_view name);
+
+private:
+  struct Registry {
+    absl::Mutex mutex_;
+    // Keys are never removed, and a deque does not move them when it grows.
+    std::deque<FilterState::Key> keys_ GUARDED_BY(mutex_);
+    std::unordered_map<absl::string_view, const FilterState::Key*, StringViewHash>
+        keys_by_name_ GUARDED_BY(mutex_);
+  };
+
+  static Registry& registry();
+};
+
 class FilterStateImpl : public FilterState {
 public:
   // FilterState
   void setData(absl::string_view data_name, std::unique_ptr<Object>&& data) override;
+  void setData(const Key& key, std::unique_ptr<Object>&& data) override;
   bool hasDataWithName(absl::string_view) const override;
+  bool hasDataWithKey(const Key& key) const override;
   const Object* getDataGeneric(absl::string_view data_name) const override;
+  const Object* getDataGeneric(const Key& key) const override;
 
 private:
+  // The data of registered keys, indexed by their slot. Only grown up to the highest slot set.
+  std::vector<std::unique_ptr<Object>> slots_;
+  // The data of names that were never registered.
   // The explicit non-type-specific comparator is necessary to allow use of find() method
   // with absl::string_view. See
   // https://stackoverflow.com/questions/20317413/what-are-transparent-comparators.
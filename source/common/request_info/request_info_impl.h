@@ -2,112 +2,119 @@
 
 #include <chrono>
 #include <cstdint>
+#include <memory>
+#include <string>
 
+#include "envoy/common/time.h"
 #include "envoy/request_info/request_info.h"
 
 #include "common/common/assert.h"
+#include "common/common/empty_string.h"
+#include "common/common/utility.h"
 #include "common/request_info/filter_state_impl.h"
 
 namespace Envoy {
 namespace RequestInfo {
 
 struct RequestInfoImpl : public RequestInfo {
-  RequestInfoImpl()
-      : start_time_(std::chrono::system_clock::now()),
-        start_time_monotonic_(std::chrono::steady_clock::now()) {}
+  RequestInfoImpl() : RequestInfoImpl(realTimeSource()) {}
 
   RequestInfoImpl(Http::Protocol protocol) : RequestInfoImpl() { protocol_ = protocol; }
 
+  /**
+   * @param time_source supplies the source of the timestamps of the request, e.g. the approximate
+   *        time source of the dispatcher handling the request.
+   */
+  RequestInfoImpl(TimeSource& time_source)
+      : time_source_(time_source), start_time_(time_source.systemTime()),
+        start_time_monotonic_(time_source.monotonicTime()) {}
+
+  RequestInfoImpl(Http::Protocol protocol, TimeSource& time_source)
+      : RequestInfoImpl(time_source) {
+    protocol_ = protocol;
+  }
+
   SystemTime startTime() const override { return start_time_; }
 
   MonotonicTime startTimeMonotonic() const override { return start_time_monotonic_; }
 
-  absl::optional<std::chrono::nanoseconds> duration(absl::optional<MonotonicTime> time) const {
-    if (!time) {
-      return {};
-    }
-
-    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.value() -
-                                                                start_time_monotonic_);
-  }
-
   absl::optional<std::chrono::nanoseconds> lastDownstreamRxByteReceived() const override {
-    return duration(last_downstream_rx_byte_received);
+    return timing(last_downstream_rx_byte_received_);
   }
 
   void onLastDownstreamRxByteReceived() override {
-    ASSERT(!last_downstream_rx_byte_received);
-    last_downstream_rx_byte_received = std::chrono::steady_clock::now();
+    ASSERT(!timing(last_downstream_rx_byte_received_));
+    last_downstream_rx_byte_received_ = sinceStart();
   }
 
   absl::optional<std::chrono::nanoseconds> firstUpstreamTxByteSent() const override {
-    return duration(first_upstream_tx_byte_sent_);
+    return timing(first_upstream_tx_byte_sent_);
   }
 
   void onFirstUpstreamTxByteSent() override {
-    ASSERT(!first_upstream_tx_byte_sent_);
-    first_upstream_tx_byte_sent_ = std::chrono::steady_clock::now();
+    ASSERT(!timing(first_upstream_tx_byte_sent_));
+    first_upstream_tx_byte_sent_ = sinceStart();
   }
 
   absl::optional<std::chrono::nanoseconds> lastUpstreamTxByteSent() const override {
-    return duration(last_upstream_tx_byte_sent_);
+    return timing(last_upstream_tx_byte_sent_);
   }
 
   void onLastUpstreamTxByteSent() override {
-    ASSERT(!last_upstream_tx_byte_sent_);
-    last_upstream_tx_byte_sent_ = std::chrono::steady_clock::now();
+    ASSERT(!timing(last_upstream_tx_byte_sent_));
+    last_upstream_tx_byte_sent_ = sinceStart();
   }
 
   absl::optional<std::chrono::nanoseconds> firstUpstreamRxByteReceived() const override {
-    return duration(first_upstream_rx_byte_received_);
+    return timing(first_upstream_rx_byte_received_);
   }
 
   void onFirstUpstreamRxByteReceived() override {
-    ASSERT(!first_upstream_rx_byte_received_);
-    first_upstream_rx_byte_received_ = std::chrono::steady_clock::now();
+    ASSERT(!timing(first_upstream_rx_byte_received_));
+    first_upstream_rx_byte_received_ = sinceStart();
   }
 
   absl::optional<std::chrono::nanoseconds> lastUpstreamRxByteReceived() const override {
-    return duration(last_upstream_rx_byte_received_);
+    return timing(last_upstream_rx_byte_received_);
   }
 
   void onLastUpstreamRxByteReceived() override {
-    ASSERT(!last_upstream_rx_byte_received_);
-    last_upstream_rx_byte_received_ = std::chrono::steady_clock::now();
+    ASSERT(!timing(last_upstream_rx_byte_received_));
+    last_upstream_rx_byte_received_ = sinceStart();
   }
 
   absl::optional<std::chrono::nanoseconds> firstDownstreamTxByteSent() const override {
-    return duration(first_downstream_tx_byte_sent_);
+    return timing(first_downstream_tx_byte_sent_);
   }
 
   void onFirstDownstreamTxByteSent() override {
-    ASSERT(!first_downstream_tx_byte_sent_);
-    first_downstream_tx_byte_sent_ = std::chrono::steady_clock::now();
+    ASSERT(!timing(first_downstream_tx_byte_sent_));
+    first_downstream_tx_byte_sent_ = sinceStart();
   }
 
   absl::optional<std::chrono::nanoseconds> lastDownstreamTxByteSent() const override {
-    return duration(last_downstream_tx_byte_sent_);
+    return timing(last_downstream_tx_byte_sent_);
   }
 
   void onLastDownstreamTxByteSent() override {
-    ASSERT(!last_downstream_tx_byte_sent_);
-    last_downstream_tx_byte_sent_ = std::chrono::steady_clock::now();
+    ASSERT(!timing(last_downstream_tx_byte_sent_));
+    last_downstream_tx_byte_sent_ = sinceStart();
   }
 
   absl::optional<std::chrono::nanoseconds> requestComplete() const override {
-    return duration(final_time_);
+    return timing(final_time_);
   }
 
   void onRequestComplete() override {
-    ASSERT(!final_time_);
-    final_time_ = std::chrono::steady_clock::now();
+    ASSERT(!timing(final_time_));
+    final_time_ = sinceStart();
   }
 
   void resetUpstreamTimings() override {
-    first_upstream_tx_byte_sent_ = absl::optional<MonotonicTime>{};
-    last_upstream_tx_byte_sent_ = absl::optional<MonotonicTime>{};
-    first_upstream_rx_byte_received_ = absl::optional<MonotonicTime>{};
-    last_upstream_rx_byte_received_ = absl::optional<MonotonicTime>{};
+    first_upstream_tx_byte_sent_ = unsetTiming();
+    last_upstream_tx_byte_sent_ = unsetTiming();
+    first_upstream_rx_byte_received_ = unsetTiming();
+    last_upstream_rx_byte_received_ = unsetTiming();
   }
 
   void addBytesReceived(uint64_t bytes_received) override { bytes_received_ += bytes_received; }
@@ -142,11 +149,11 @@ struct RequestInfoImpl : public RequestInfo {
 
   void setUpstreamLocalAddress(
       const Network::Address::InstanceConstSharedPtr& upstream_local_address) override {
-    upstream_local_address_ = upstream_local_address;
+    rareFields().upstream_local_address_ = upstream_local_address;
   }
 
   const Network::Address::InstanceConstSharedPtr& upstreamLocalAddress() const override {
-    return upstream_local_address_;
+    return rare_fields_ ? rare_fields_->upstream_local_address_ : noAddress();
   }
 
   bool healthCheck() const override { return hc_request_; }
@@ -173,49 +180,110 @@ struct RequestInfoImpl : public RequestInfo {
 
   const Router::RouteEntry* routeEntry() const override { return route_entry_; }
 
-  const envoy::api::v2::core::Metadata& dynamicMetadata() const override { return metadata_; };
+  const envoy::api::v2::core::Metadata& dynamicMetadata() const override {
+    return rare_fields_ ? rare_fields_->metadata_
+                        : envoy::api::v2::core::Metadata::default_instance();
+  };
 
   void setDynamicMetadata(const std::string& name, const ProtobufWkt::Struct& value) override {
-    (*metadata_.mutable_filter_metadata())[name].MergeFrom(value);
+    (*rareFields().metadata_.mutable_filter_metadata())[name].MergeFrom(value);
   };
 
-  FilterState& perRequestState() override { return per_request_state_; }
-  const FilterState& perRequestState() const override { return per_request_state_; }
+  FilterState& perRequestState() override { return rareFields().per_request_state_; }
+  const FilterState& perRequestState() const override {
+    return rare_fields_ ? rare_fields_->per_request_state_ : emptyFilterState();
+  }
 
   void setRequestedServerName(absl::string_view requested_server_name) override {
-    requested_server_name_ = std::string(requested_server_name);
+    // Connections without SNI set an empty name, which needs no allocation.
+    if (rare_fields_ || !requested_server_name.empty()) {
+      rareFields().requested_server_name_ = std::string(requested_server_name);
+    }
   }
 
-  const std::string& requestedServerName() const override { return requested_server_name_; }
+  const std::string& requestedServerName() const override {
+    return rare_fields_ ? rare_fields_->requested_server_name_ : EMPTY_STRING;
+  }
 
+  TimeSource& time_source_;
   const SystemTime start_time_;
   const MonotonicTime start_time_monotonic_;
 
-  absl::optional<MonotonicTime> last_downstream_rx_byte_received;
-  absl::optional<MonotonicTime> first_upstream_tx_byte_sent_;
-  absl::optional<MonotonicTime> last_upstream_tx_byte_sent_;
-  absl::optional<MonotonicTime> first_upstream_rx_byte_received_;
-  absl::optional<MonotonicTime> last_upstream_rx_byte_received_;
-  absl::optional<MonotonicTime> first_downstream_tx_byte_sent_;
-  absl::optional<MonotonicTime> last_downstream_tx_byte_sent_;
-  absl::optional<MonotonicTime> final_time_;
-
-  absl::optional<Http::Protocol> protocol_;
   absl::optional<uint32_t> response_code_;
-  uint64_t response_flags_{};
-  Upstream::HostDescriptionConstSharedPtr upstream_host_{};
-  bool hc_request_{};
   const Router::RouteEntry* route_entry_{};
-  envoy::api::v2::core::Metadata metadata_{};
-  FilterStateImpl per_request_state_{};
+  bool hc_request_{};
 
 private:
+  // Timings are stored as offsets from start_time_monotonic_, rather than as optional time points
+  // that are twice as large.
+  static constexpr std::chrono::nanoseconds unsetTiming() {
+    return std::chrono::nanoseconds::min();
+  }
+
+  static absl::optional<std::chrono::nanoseconds> timing(std::chrono::nanoseconds offset) {
+    if (offset == unsetTiming()) {
+      return absl::nullopt;
+    }
+    return offset;
+  }
+
+  /**
+   * The fields that most requests leave unset, allocated by the first request setting one of them
+   * so that requests that do not use filter state and metadata stay small.
+   */
+  struct RareFields {
+    Network::Address::InstanceConstSharedPtr upstream_local_address_;
+    envoy::api::v2::core::Metadata metadata_;
+    FilterStateImpl per_request_state_;
+    std::string requested_server_name_;
+  };
+
+  std::chrono::nanoseconds sinceStart() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time_source_.monotonicTime() -
+                                                                start_time_monotonic_);
+  }
+
+  RareFields& rareFields() {
+    if (!rare_fields_) {
+      rare_fields_ = std::make_unique<RareFields>();
+    }
+    return *rare_fields_;
+  }
+
+  static TimeSource& realTimeSource() {
+    static RealTimeSource* time_source = new RealTimeSource();
+    return *time_source;
+  }
+
+  static const Network::Address::InstanceConstSharedPtr& noAddress() {
+    static const Network::Address::InstanceConstSharedPtr* address =
+        new Network::Address::InstanceConstSharedPtr();
+    return *address;
+  }
+
+  static const FilterState& emptyFilterState() {
+    static const FilterStateImpl* filter_state = new FilterStateImpl();
+    return *filter_state;
+  }
+
+  // Response flags are stored in 32 bits so that they pack with hc_request_ and the protocol.
+  static_assert(ResponseFlag::LastFlag <= UINT32_MAX, "response flags must fit in 32 bits");
+  uint32_t response_flags_{};
+  absl::optional<Http::Protocol> protocol_;
+  std::chrono::nanoseconds last_downstream_rx_byte_received_{unsetTiming()};
+  std::chrono::nanoseconds first_upstream_tx_byte_sent_{unsetTiming()};
+  std::chrono::nanoseconds last_upstream_tx_byte_sent_{unsetTiming()};
+  std::chrono::nanoseconds first_upstream_rx_byte_received_{unsetTiming()};
+  std::chrono::nanoseconds last_upstream_rx_byte_received_{unsetTiming()};
+  std::chrono::nanoseconds first_downstream_tx_byte_sent_{unsetTiming()};
+  std::chrono::nanoseconds last_downstream_tx_byte_sent_{unsetTiming()};
+  std::chrono::nanoseconds final_time_{unsetTiming()};
   uint64_t bytes_received_{};
   uint64_t bytes_sent_{};
-  Network::Address::InstanceConstSharedPtr upstream_local_address_;
+  Upstream::HostDescriptionConstSharedPtr upstream_host_;
   Network::Address::InstanceConstSharedPtr downstream_local_address_;
   Network::Address::InstanceConstSharedPtr downstream_remote_address_;
-  std::string requested_server_name_;
+  std::unique_ptr<RareFields> rare_fields_;
 };
 
 } // namespace RequestInfo
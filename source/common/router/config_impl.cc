@@ -5,7 +5,6 @@
 #include <cstdint>
 #include <map>
 #include <memory>
-#include <regex>
 #include <string>
 #include <vector>
 
@@ -18,6 +17,7 @@
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
 #include "common/common/hash.h"
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/config/metadata.h"
 #include "common/config/rds_json.h"
@@ -61,7 +61,7 @@ CorsPolicyImpl::CorsPolicyImpl(const envoy::api::v2::route::CorsPolicy& config)
     allow_origin_.push_back(origin);
   }
   for (const auto& regex : config.allow_origin_regex()) {
-    allow_origin_regex_.push_back(RegexUtil::parseRegex(regex));
+    allow_origin_regex_.push_back(Regex::Utility::parseRegex(regex));
   }
   allow_methods_ = config.allow_methods();
   allow_headers_ = config.allow_headers();
@@ -246,6 +246,11 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
           route.route().cluster_not_found_response_code())),
       timeout_(PROTOBUF_GET_MS_OR_DEFAULT(route.route(), timeout, DEFAULT_ROUTE_TIMEOUT_MS)),
       idle_timeout_(PROTOBUF_GET_OPTIONAL_MS(route.route(), idle_timeout)),
+      hedge_delay_(PROTOBUF_GET_OPTIONAL_MS(route.route(), hedge_delay)),
+      retry_shadow_buffer_limit_(
+          route.route().has_retry_shadow_buffer_limit_bytes()
+              ? absl::optional<uint32_t>(route.route().retry_shadow_buffer_limit_bytes().value())
+              : absl::nullopt),
       max_grpc_timeout_(PROTOBUF_GET_OPTIONAL_MS(route.route(), max_grpc_timeout)),
       runtime_(loadRuntimeData(route.match())), loader_(factory_context.runtime()),
       host_redirect_(route.redirect().host_redirect()),
@@ -255,15 +260,9 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
       strip_query_(route.redirect().strip_query()), retry_policy_(route.route()),
       rate_limit_policy_(route.route().rate_limits()), shadow_policy_(route.route()),
       priority_(ConfigUtility::parsePriority(route.route().priority())),
+      config_headers_(route.match().headers()),
       total_cluster_weight_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(route.route().weighted_clusters(), total_weight, 100UL)),
-      route_action_request_headers_parser_(
-          HeaderParser::configure(route.route().request_headers_to_add())),
-      route_action_response_headers_parser_(HeaderParser::configure(
-          route.route().response_headers_to_add(), route.route().response_headers_to_remove())),
-      request_headers_parser_(HeaderParser::configure(route.request_headers_to_add())),
-      response_headers_parser_(HeaderParser::configure(route.response_headers_to_add(),
-                                                       route.response_headers_to_remove())),
       opaque_config_(parseOpaqueConfig(route)), decorator_(parseDecorator(route)),
       direct_response_code_(ConfigUtility::parseDirectResponseCode(route)),
       direct_response_body_(ConfigUtility::parseDirectResponseBody(route)),
@@ -280,6 +279,21 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
     metadata_ = route.metadata();
   }
 
+  // Merge the user-specified headers of all levels in the order they are applied: route-action
+  // level headers, route level headers, virtual host level headers and finally global connection
+  // manager level headers. Finalizing the headers of a request then runs a single list.
+  request_headers_parser_ = HeaderParser::merge(
+      {HeaderParser::configure(route.route().request_headers_to_add()).get(),
+       HeaderParser::configure(route.request_headers_to_add()).get(),
+       &vhost_.requestHeaderParser(), &vhost_.globalRouteConfig().requestHeaderParser()});
+  response_headers_parser_ = HeaderParser::merge(
+      {HeaderParser::configure(route.route().response_headers_to_add(),
+                               route.route().response_headers_to_remove())
+           .get(),
+       HeaderParser::configure(route.response_headers_to_add(), route.response_headers_to_remove())
+           .get(),
+       &vhost_.responseHeaderParser(), &vhost_.globalRouteConfig().responseHeaderParser()});
+
   // If this is a weighted_cluster, we create N internal route entries
   // (called WeightedClusterEntry), such that each object is a simple
   // single cluster, pointing back to the parent. Metadata criteria
@@ -305,10 +319,6 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
     }
   }
 
-  for (const auto& header_map : route.match().headers()) {
-    config_headers_.push_back(header_map);
-  }
-
   for (const auto& query_parameter : route.match().query_parameters()) {
     config_query_parameters_.push_back(query_parameter);
   }
@@ -328,7 +338,9 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
   }
 }
 
-bool RouteEntryImplBase::matchRoute(const Http::HeaderMap& headers, uint64_t random_value) const {
+bool RouteEntryImplBase::matchRoute(const Http::HeaderMap& headers,
+                                    const Http::Utility::QueryParamsView& query_params,
+                                    uint64_t random_value) const {
   bool matches = true;
 
   if (runtime_) {
@@ -336,11 +348,9 @@ bool RouteEntryImplBase::matchRoute(const Http::HeaderMap& headers, uint64_t ran
                                                  random_value);
   }
 
-  matches &= Http::HeaderUtility::matchHeaders(headers, config_headers_);
+  matches &= config_headers_.matches(headers);
   if (!config_query_parameters_.empty()) {
-    Http::Utility::QueryParams query_parameters =
-        Http::Utility::parseQueryString(headers.Path()->value().c_str());
-    matches &= ConfigUtility::matchQueryParams(query_parameters, config_query_parameters_);
+    matches &= ConfigUtility::matchQueryParams(query_params, config_query_parameters_);
   }
 
   return matches;
@@ -360,13 +370,8 @@ Http::WebSocketProxyPtr RouteEntryImplBase::createWebSocketProxy(
 void RouteEntryImplBase::finalizeRequestHeaders(Http::HeaderMap& headers,
                                                 const RequestInfo::RequestInfo& request_info,
                                                 bool insert_envoy_original_path) const {
-  // Append user-specified request headers in the following order: route-action-level headers,
-  // route-level headers, virtual host level headers and finally global connection manager level
-  // headers.
-  route_action_request_headers_parser_->evaluateHeaders(headers, request_info);
+  // Append user-specified request headers of all levels, merged at configuration time.
   request_headers_parser_->evaluateHeaders(headers, request_info);
-  vhost_.requestHeaderParser().evaluateHeaders(headers, request_info);
-  vhost_.globalRouteConfig().requestHeaderParser().evaluateHeaders(headers, request_info);
   if (!host_rewrite_.empty()) {
     headers.Host()->value(host_rewrite_);
   }
@@ -379,13 +384,8 @@ void RouteEntryImplBase::finalizeRequestHeaders(Http::HeaderMap& headers,
 
 void RouteEntryImplBase::finalizeResponseHeaders(
     Http::HeaderMap& headers, const RequestInfo::RequestInfo& request_info) const {
-  // Append user-specified response headers in the following order: route-action-level headers,
-  // route-level headers, virtual host level headers and finally global connection manager level
-  // headers.
-  route_action_response_headers_parser_->evaluateHeaders(headers, request_info);
+  // Append user-specified response headers of all levels, merged at configuration time.
   response_headers_parser_->evaluateHeaders(headers, request_info);
-  vhost_.responseHeaderParser().evaluateHeaders(headers, request_info);
-  vhost_.globalRouteConfig().responseHeaderParser().evaluateHeaders(headers, request_info);
 }
 
 absl::optional<RouteEntryImplBase::RuntimeData>
@@ -612,9 +612,11 @@ void PrefixRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
   finalizePathHeader(headers, prefix_, insert_envoy_original_path);
 }
 
-RouteConstSharedPtr PrefixRouteEntryImpl::matches(const Http::HeaderMap& headers,
-                                                  uint64_t random_value) const {
-  if (RouteEntryImplBase::matchRoute(headers, random_value) &&
+RouteConstSharedPtr
+PrefixRouteEntryImpl::matches(const Http::HeaderMap& headers,
+                              const Http::Utility::QueryParamsView& query_params,
+                              uint64_t random_value) const {
+  if (RouteEntryImplBase::matchRoute(headers, query_params, random_value) &&
       StringUtil::startsWith(headers.Path()->value().c_str(), prefix_, case_sensitive_)) {
     return clusterEntry(headers, random_value);
   }
@@ -632,8 +634,9 @@ void PathRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
 }
 
 RouteConstSharedPtr PathRouteEntryImpl::matches(const Http::HeaderMap& headers,
+                                                const Http::Utility::QueryParamsView& query_params,
                                                 uint64_t random_value) const {
-  if (RouteEntryImplBase::matchRoute(headers, random_value)) {
+  if (RouteEntryImplBase::matchRoute(headers, query_params, random_value)) {
     const Http::HeaderString& path = headers.Path()->value();
     const char* query_string_start = Http::Utility::findQueryStringStart(path);
     size_t compare_length = path.size();
@@ -663,7 +666,7 @@ RegexRouteEntryImpl::RegexRouteEntryImpl(const VirtualHostImpl& vhost,
                                          const envoy::api::v2::route::Route& route,
                                          Server::Configuration::FactoryContext& factory_context)
     : RouteEntryImplBase(vhost, route, factory_context),
-      regex_(RegexUtil::parseRegex(route.match().regex().c_str())),
+      regex_(Regex::Utility::parseRegex(route.match().regex())),
       regex_str_(route.match().regex()) {}
 
 void RegexRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
@@ -672,18 +675,19 @@ void RegexRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
   const char* query_string_start = Http::Utility::findQueryStringStart(path);
   // TODO(yuval-k): This ASSERT can happen if the path was changed by a filter without clearing the
   // route cache. We should consider if ASSERT-ing is the desired behavior in this case.
-  ASSERT(std::regex_match(path.c_str(), query_string_start, regex_));
+  ASSERT(regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str())));
   std::string matched_path(path.c_str(), query_string_start);
 
   finalizePathHeader(headers, matched_path, insert_envoy_original_path);
 }
 
 RouteConstSharedPtr RegexRouteEntryImpl::matches(const Http::HeaderMap& headers,
+                                                 const Http::Utility::QueryParamsView& query_params,
                                                  uint64_t random_value) const {
-  if (RouteEntryImplBase::matchRoute(headers, random_value)) {
+  if (RouteEntryImplBase::matchRoute(headers, query_params, random_value)) {
     const Http::HeaderString& path = headers.Path()->value();
     const char* query_string_start = Http::Utility::findQueryStringStart(path);
-    if (std::regex_match(path.c_str(), query_string_start, regex_)) {
+    if (regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str()))) {
       return clusterEntry(headers, random_value);
     }
   }
@@ -714,6 +718,7 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtu
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
 
+  std::vector<PathMatchIndex::Entry> path_match_entries;
   for (const auto& route : virtual_host.routes()) {
     const bool has_prefix =
         route.match().path_specifier_case() == envoy::api::v2::route::RouteMatch::kPrefix;
@@ -729,6 +734,9 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtu
       ASSERT(has_regex);
       routes_.emplace_back(new RegexRouteEntryImpl(*this, route, factory_context));
     }
+    path_match_entries.push_back(
+        {routes_.back()->matchType(), routes_.back()->matcher(),
+         PROTOBUF_GET_WRAPPED_OR_DEFAULT(route.match(), case_sensitive, true)});
 
     if (validate_clusters) {
       routes_.back()->validateClusters(factory_context.clusterManager());
@@ -741,6 +749,8 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtu
     }
   }
 
+  path_match_index_ = std::make_unique<const PathMatchIndex>(path_match_entries);
+
   for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
     virtual_clusters_.push_back(VirtualClusterEntry(virtual_cluster));
   }
@@ -756,8 +766,7 @@ VirtualHostImpl::VirtualClusterEntry::VirtualClusterEntry(
     method_ = envoy::api::v2::core::RequestMethod_Name(virtual_cluster.method());
   }
 
-  const std::string pattern = virtual_cluster.pattern();
-  pattern_ = RegexUtil::parseRegex(pattern);
+  pattern_ = Regex::Utility::parseRegex(virtual_cluster.pattern());
   name_ = virtual_cluster.name();
 }
 
@@ -767,7 +776,8 @@ const RouteSpecificFilterConfig* VirtualHostImpl::perFilterConfig(const std::str
   return per_filter_configs_.get(name);
 }
 
-const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(const std::string& host) const {
+const RouteMatcher::VirtualHostEntry*
+RouteMatcher::findWildcardVirtualHost(const std::string& host) const {
   // We do a longest wildcard suffix match against the host that's passed in.
   // (e.g. foo-bar.baz.com should match *-bar.baz.com before matching *.baz.com)
   // This is done by scanning the length => wildcards map looking for every
@@ -781,7 +791,7 @@ const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(const std::string&
     }
     const auto& match = wildcard_map.find(host.substr(host.size() - wildcard_length));
     if (match != wildcard_map.end()) {
-      return match->second.get();
+      return match->second;
     }
   }
   return nullptr;
@@ -790,10 +800,22 @@ const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(const std::string&
 RouteMatcher::RouteMatcher(const envoy::api::v2::RouteConfiguration& route_config,
                            const ConfigImpl& global_route_config,
                            Server::Configuration::FactoryContext& factory_context,
-                           bool validate_clusters) {
+                           bool validate_clusters)
+    : global_route_config_(global_route_config), factory_context_(factory_context),
+      max_built_on_demand_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(route_config, max_virtual_hosts_built_on_demand, 0)) {
   for (const auto& virtual_host_config : route_config.virtual_hosts()) {
-    VirtualHostSharedPtr virtual_host(new VirtualHostImpl(virtual_host_config, global_route_config,
-                                                          factory_context, validate_clusters));
+    // The virtual host is always built here, so that its config is validated with the route table.
+    std::unique_ptr<VirtualHostEntry> entry(new VirtualHostEntry());
+    entry->virtual_host_.reset(new VirtualHostImpl(virtual_host_config, global_route_config,
+                                                   factory_context, validate_clusters));
+    if (max_built_on_demand_ > 0 && buildableOnDemand(virtual_host_config)) {
+      entry->virtual_host_.reset();
+      entry->config_.reset(new envoy::api::v2::route::VirtualHost(virtual_host_config));
+    }
+    const VirtualHostEntry* virtual_host = entry.get();
+    entries_.emplace_back(std::move(entry));
+
     for (const std::string& domain_name : virtual_host_config.domains()) {
       const std::string domain = Http::LowerCaseString(domain_name).get();
       if ("*" == domain) {
@@ -825,9 +847,24 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
     return SSL_REDIRECT_ROUTE;
   }
 
-  // Check for a route that matches the request.
+  // Check for a route that matches the request. Only the routes whose path criterion may match
+  // are evaluated, in route order.
+  // The query string is parsed at most once, by the first route that matches query parameters.
+  RouteConstSharedPtr route_entry;
+  if (headers.Path() != nullptr) {
+    const Http::Utility::QueryParamsView query_params(headers.Path()->value().getStringView());
+    path_match_index_->forEachCandidate(
+        headers.Path()->value().getStringView(), [&](uint32_t index) -> bool {
+          route_entry = routes_[index]->matches(headers, query_params, random_value);
+          return route_entry != nullptr;
+        });
+    return route_entry;
+  }
+
+  // Without a path there's nothing to index on, so evaluate every route.
+  const Http::Utility::QueryParamsView query_params(absl::string_view{});
   for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
-    RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+    route_entry = route->matches(headers, query_params, random_value);
     if (nullptr != route_entry) {
       return route_entry;
     }
@@ -836,10 +873,68 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
   return nullptr;
 }
 
-const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::HeaderMap& headers) const {
+bool RouteMatcher::buildableOnDemand(const envoy::api::v2::route::VirtualHost& virtual_host) {
+  // Virtual hosts are built on demand by the workers. Per filter configs and WebSocket routes may
+  // allocate thread local slots when built, so virtual hosts with them are built with the table.
+  if (!virtual_host.per_filter_config().empty()) {
+    return false;
+  }
+  for (const auto& route : virtual_host.routes()) {
+    if (!route.per_filter_config().empty() ||
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(route.route(), use_websocket, false)) {
+      return false;
+    }
+    for (const auto& cluster : route.route().weighted_clusters().clusters()) {
+      if (!cluster.per_filter_config().empty()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+VirtualHostSharedPtr RouteMatcher::onDemandVirtualHost(const VirtualHostEntry& entry) const {
+  {
+    absl::MutexLock lock(&on_demand_mutex_);
+    auto it = on_demand_.find(&entry);
+    if (it != on_demand_.end()) {
+      on_demand_lru_.splice(on_demand_lru_.begin(), on_demand_lru_, it->second.lru_entry_);
+      return it->second.virtual_host_;
+    }
+  }
+
+  // The virtual host is built outside of the lock, so that workers matching other virtual hosts
+  // are not held up. Its clusters were validated, if needed, when the route table was built.
+  VirtualHostSharedPtr virtual_host(
+      new VirtualHostImpl(*entry.config_, global_route_config_, factory_context_, false));
+
+  absl::MutexLock lock(&on_demand_mutex_);
+  auto it = on_demand_.find(&entry);
+  if (it != on_demand_.end()) {
+    // Another worker built it in the meantime.
+    on_demand_lru_.splice(on_demand_lru_.begin(), on_demand_lru_, it->second.lru_entry_);
+    return it->second.virtual_host_;
+  }
+  if (on_demand_.size() == max_built_on_demand_) {
+    // Requests using routes of the evicted virtual host keep it alive, see route().
+    on_demand_.erase(on_demand_lru_.back());
+    on_demand_lru_.pop_back();
+  }
+  on_demand_lru_.push_front(&entry);
+  on_demand_.emplace(&entry, OnDemandEntry{virtual_host, on_demand_lru_.begin()});
+  return virtual_host;
+}
+
+size_t RouteMatcher::numBuiltOnDemand() const {
+  absl::MutexLock lock(&on_demand_mutex_);
+  return on_demand_.size();
+}
+
+const RouteMatcher::VirtualHostEntry*
+RouteMatcher::findVirtualHost(const Http::HeaderMap& headers) const {
   // Fast path the case where we only have a default virtual host.
   if (virtual_hosts_.empty() && wildcard_virtual_host_suffixes_.empty() && default_virtual_host_) {
-    return default_virtual_host_.get();
+    return default_virtual_host_;
   }
 
   // TODO (@rshriram) Match Origin header in WebSocket
@@ -847,25 +942,37 @@ const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::HeaderMap& head
   const std::string host = Http::LowerCaseString(headers.Host()->value().c_str()).get();
   const auto& iter = virtual_hosts_.find(host);
   if (iter != virtual_hosts_.end()) {
-    return iter->second.get();
+    return iter->second;
   }
   if (!wildcard_virtual_host_suffixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(host);
+    const VirtualHostEntry* vhost = findWildcardVirtualHost(host);
     if (vhost != nullptr) {
       return vhost;
     }
   }
-  return default_virtual_host_.get();
+  return default_virtual_host_;
 }
 
 RouteConstSharedPtr RouteMatcher::route(const Http::HeaderMap& headers,
                                         uint64_t random_value) const {
-  const VirtualHostImpl* virtual_host = findVirtualHost(headers);
-  if (virtual_host) {
-    return virtual_host->getRouteFromEntries(headers, random_value);
-  } else {
+  const VirtualHostEntry* entry = findVirtualHost(headers);
+  if (entry == nullptr) {
     return nullptr;
   }
+  if (entry->virtual_host_ != nullptr) {
+    return entry->virtual_host_->getRouteFromEntries(headers, random_value);
+  }
+
+  const VirtualHostSharedPtr virtual_host = onDemandVirtualHost(*entry);
+  RouteConstSharedPtr route = virtual_host->getRouteFromEntries(headers, random_value);
+  if (route == nullptr) {
+    return nullptr;
+  }
+  // Routes refer to their virtual host, which may be evicted while the request is using the route,
+  // so the returned route also owns the virtual host.
+  auto owner = std::make_shared<std::pair<VirtualHostSharedPtr, RouteConstSharedPtr>>(
+      virtual_host, std::move(route));
+  return RouteConstSharedPtr(owner, owner->second.get());
 }
 
 const VirtualHostImpl::CatchAllVirtualCluster VirtualHostImpl::VIRTUAL_CLUSTER_CATCH_ALL;
@@ -879,7 +986,7 @@ VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const
     bool method_matches =
         !entry.method_ || headers.Method()->value().c_str() == entry.method_.value();
 
-    if (method_matches && std::regex_match(headers.Path()->value().c_str(), entry.pattern_)) {
+    if (method_matches && entry.pattern_->match(headers.Path()->value().getStringView())) {
       return &entry;
     }
   }
@@ -895,6 +1002,11 @@ ConfigImpl::ConfigImpl(const envoy::api::v2::RouteConfiguration& config,
                        Server::Configuration::FactoryContext& factory_context,
                        bool validate_clusters_default)
     : name_(config.name()) {
+  // The routes merge these into their own header parsers, so they are configured first.
+  request_headers_parser_ = HeaderParser::configure(config.request_headers_to_add());
+  response_headers_parser_ = HeaderParser::configure(config.response_headers_to_add(),
+                                                     config.response_headers_to_remove());
+
   route_matcher_.reset(new RouteMatcher(
       config, *this, factory_context,
       PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default)));
@@ -902,10 +1014,6 @@ ConfigImpl::ConfigImpl(const envoy::api::v2::RouteConfiguration& config,
   for (const std::string& header : config.internal_only_headers()) {
     internal_only_headers_.push_back(Http::LowerCaseString(header));
   }
-
-  request_headers_parser_ = HeaderParser::configure(config.request_headers_to_add());
-  response_headers_parser_ = HeaderParser::configure(config.response_headers_to_add(),
-                                                     config.response_headers_to_remove());
 }
 
 PerFilterConfigs::PerFilterConfigs(
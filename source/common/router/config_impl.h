@@ -5,13 +5,13 @@
 #include <list>
 #include <map>
 #include <memory>
-#include <regex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "envoy/api/v2/rds.pb.h"
 #include "envoy/api/v2/route/route.pb.h"
+#include "envoy/common/regex.h"
 #include "envoy/router/router.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/server/filter_config.h"
@@ -22,9 +22,12 @@
 #include "common/router/header_formatter.h"
 #include "common/router/header_parser.h"
 #include "common/router/metadatamatchcriteria_impl.h"
+#include "common/router/path_match_index.h"
 #include "common/router/router_ratelimit.h"
+#include "common/common/thread_annotations.h"
 #include "common/tcp_proxy/tcp_proxy.h"
 
+#include "absl/synchronization/mutex.h"
 #include "absl/types/optional.h"
 
 namespace Envoy {
@@ -40,11 +43,13 @@ public:
   /**
    * See if this object matches the incoming headers.
    * @param headers supplies the headers to match.
+   * @param query_params supplies the query parameters of the request's path.
    * @param random_value supplies the random seed to use if a runtime choice is required. This
    *        allows stable choices between calls if desired.
    * @return true if input headers match this object.
    */
   virtual RouteConstSharedPtr matches(const Http::HeaderMap& headers,
+                                      const Http::Utility::QueryParamsView& query_params,
                                       uint64_t random_value) const PURE;
 };
 
@@ -98,7 +103,9 @@ public:
 
   // Router::CorsPolicy
   const std::list<std::string>& allowOrigins() const override { return allow_origin_; };
-  const std::list<std::regex>& allowOriginRegexes() const override { return allow_origin_regex_; }
+  const std::list<Regex::CompiledMatcherPtr>& allowOriginRegexes() const override {
+    return allow_origin_regex_;
+  }
   const std::string& allowMethods() const override { return allow_methods_; };
   const std::string& allowHeaders() const override { return allow_headers_; };
   const std::string& exposeHeaders() const override { return expose_headers_; };
@@ -108,7 +115,7 @@ public:
 
 private:
   std::list<std::string> allow_origin_;
-  std::list<std::regex> allow_origin_regex_;
+  std::list<Regex::CompiledMatcherPtr> allow_origin_regex_;
   std::string allow_methods_;
   std::string allow_headers_;
   std::string expose_headers_;
@@ -150,7 +157,7 @@ private:
     // Router::VirtualCluster
     const std::string& name() const override { return name_; }
 
-    std::regex pattern_;
+    Regex::CompiledMatcherPtr pattern_;
     absl::optional<std::string> method_;
     std::string name_;
   };
@@ -167,6 +174,8 @@ private:
 
   const std::string name_;
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  // Index over the path criteria of routes_, used to skip routes whose path can't match.
+  std::unique_ptr<const PathMatchIndex> path_match_index_;
   std::vector<VirtualClusterEntry> virtual_clusters_;
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
@@ -296,7 +305,8 @@ public:
     return !host_redirect_.empty() || !path_redirect_.empty() || !prefix_rewrite_redirect_.empty();
   }
 
-  bool matchRoute(const Http::HeaderMap& headers, uint64_t random_value) const;
+  bool matchRoute(const Http::HeaderMap& headers,
+                  const Http::Utility::QueryParamsView& query_params, uint64_t random_value) const;
   void validateClusters(Upstream::ClusterManager& cm) const;
 
   // Router::RouteEntry
@@ -324,6 +334,10 @@ public:
   }
   std::chrono::milliseconds timeout() const override { return timeout_; }
   absl::optional<std::chrono::milliseconds> idleTimeout() const override { return idle_timeout_; }
+  absl::optional<std::chrono::milliseconds> hedgeDelay() const override { return hedge_delay_; }
+  absl::optional<uint32_t> retryShadowBufferLimit() const override {
+    return retry_shadow_buffer_limit_;
+  }
   absl::optional<std::chrono::milliseconds> maxGrpcTimeout() const override {
     return max_grpc_timeout_;
   }
@@ -409,6 +423,12 @@ private:
     absl::optional<std::chrono::milliseconds> idleTimeout() const override {
       return parent_->idleTimeout();
     }
+    absl::optional<std::chrono::milliseconds> hedgeDelay() const override {
+      return parent_->hedgeDelay();
+    }
+    absl::optional<uint32_t> retryShadowBufferLimit() const override {
+      return parent_->retryShadowBufferLimit();
+    }
     absl::optional<std::chrono::milliseconds> maxGrpcTimeout() const override {
       return parent_->maxGrpcTimeout();
     }
@@ -527,6 +547,8 @@ private:
   const Http::Code cluster_not_found_response_code_;
   const std::chrono::milliseconds timeout_;
   const absl::optional<std::chrono::milliseconds> idle_timeout_;
+  const absl::optional<std::chrono::milliseconds> hedge_delay_;
+  const absl::optional<uint32_t> retry_shadow_buffer_limit_;
   const absl::optional<std::chrono::milliseconds> max_grpc_timeout_;
   const absl::optional<RuntimeData> runtime_;
   Runtime::Loader& loader_;
@@ -539,14 +561,14 @@ private:
   const RateLimitPolicyImpl rate_limit_policy_;
   const ShadowPolicyImpl shadow_policy_;
   const Upstream::ResourcePriority priority_;
-  std::vector<Http::HeaderUtility::HeaderData> config_headers_;
+  const Http::HeaderUtility::HeaderMatcherSet config_headers_;
   std::vector<ConfigUtility::QueryParameterMatcher> config_query_parameters_;
   std::vector<WeightedClusterEntrySharedPtr> weighted_clusters_;
   const uint64_t total_cluster_weight_;
   std::unique_ptr<const HashPolicyImpl> hash_policy_;
   MetadataMatchCriteriaConstPtr metadata_match_criteria_;
-  HeaderParserPtr route_action_request_headers_parser_;
-  HeaderParserPtr route_action_response_headers_parser_;
+  // The header parsers of the route action, the route, the virtual host and the route
+  // configuration, merged.
   HeaderParserPtr request_headers_parser_;
   HeaderParserPtr response_headers_parser_;
   envoy::api::v2::core::Metadata metadata_;
@@ -573,7 +595,9 @@ public:
   PathMatchType matchType() const override { return PathMatchType::Prefix; }
 
   // Router::Matchable
-  RouteConstSharedPtr matches(const Http::HeaderMap& headers, uint64_t random_value) const override;
+  RouteConstSharedPtr matches(const Http::HeaderMap& headers,
+                              const Http::Utility::QueryParamsView& query_params,
+                              uint64_t random_value) const override;
 
   // Router::DirectResponseEntry
   void rewritePathHeader(Http::HeaderMap& headers, bool insert_envoy_original_path) const override;
@@ -595,7 +619,9 @@ public:
   PathMatchType matchType() const override { return PathMatchType::Exact; }
 
   // Router::Matchable
-  RouteConstSharedPtr matches(const Http::HeaderMap& headers, uint64_t random_value) const override;
+  RouteConstSharedPtr matches(const Http::HeaderMap& headers,
+                              const Http::Utility::QueryParamsView& query_params,
+                              uint64_t random_value) const override;
 
   // Router::DirectResponseEntry
   void rewritePathHeader(Http::HeaderMap& headers, bool insert_envoy_original_path) const override;
@@ -617,13 +643,15 @@ public:
   PathMatchType matchType() const override { return PathMatchType::Regex; }
 
   // Router::Matchable
-  RouteConstSharedPtr matches(const Http::HeaderMap& headers, uint64_t random_value) const override;
+  RouteConstSharedPtr matches(const Http::HeaderMap& headers,
+                              const Http::Utility::QueryParamsView& query_params,
+                              uint64_t random_value) const override;
 
   // Router::DirectResponseEntry
   void rewritePathHeader(Http::HeaderMap& headers, bool insert_envoy_original_path) const override;
 
 private:
-  const std::regex regex_;
+  const Regex::CompiledMatcherPtr regex_;
   const std::string regex_str_;
 };
 
@@ -639,11 +667,39 @@ public:
 
   RouteConstSharedPtr route(const Http::HeaderMap& headers, uint64_t random_value) const;
 
+  /**
+   * @return size_t the number of virtual hosts built on demand that are currently held.
+   */
+  size_t numBuiltOnDemand() const;
+
 private:
-  const VirtualHostImpl* findVirtualHost(const Http::HeaderMap& headers) const;
-  const VirtualHostImpl* findWildcardVirtualHost(const std::string& host) const;
+  /**
+   * A virtual host of the route table. It is either built with the route table, or from its config
+   * when a request first matches it, in which case it is held in the LRU of the matcher.
+   */
+  struct VirtualHostEntry {
+    VirtualHostSharedPtr virtual_host_;
+    // Set for the virtual hosts built on demand.
+    std::unique_ptr<const envoy::api::v2::route::VirtualHost> config_;
+  };
 
-  std::unordered_map<std::string, VirtualHostSharedPtr> virtual_hosts_;
+  struct OnDemandEntry {
+    VirtualHostSharedPtr virtual_host_;
+    std::list<const VirtualHostEntry*>::iterator lru_entry_;
+  };
+
+  static bool buildableOnDemand(const envoy::api::v2::route::VirtualHost& virtual_host);
+  const VirtualHostEntry* findVirtualHost(const Http::HeaderMap& headers) const;
+  const VirtualHostEntry* findWildcardVirtualHost(const std::string& host) const;
+  VirtualHostSharedPtr onDemandVirtualHost(const VirtualHostEntry& entry) const;
+
+  const ConfigImpl& global_route_config_;
+  // Used to build virtual hosts on demand. Route tables doing so are not shared across listeners,
+  // so that they are not used past the listener of this context, see
+  // RouteConfigProviderManagerImpl::routeConfig().
+  Server::Configuration::FactoryContext& factory_context_;
+  std::vector<std::unique_ptr<const VirtualHostEntry>> entries_;
+  std::unordered_map<std::string, const VirtualHostEntry*> virtual_hosts_;
   // std::greater as a minor optimization to iterate from more to less specific
   //
   // A note on using an unordered_map versus a vector of (string, VirtualHostSharedPtr) pairs:
@@ -653,9 +709,19 @@ private:
   // and climbs to about 110ns once there are any entries.
   //
   // The break-even is 4 entries.
-  std::map<int64_t, std::unordered_map<std::string, VirtualHostSharedPtr>, std::greater<int64_t>>
+  std::map<int64_t, std::unordered_map<std::string, const VirtualHostEntry*>,
+           std::greater<int64_t>>
       wildcard_virtual_host_suffixes_;
-  VirtualHostSharedPtr default_virtual_host_;
+  const VirtualHostEntry* default_virtual_host_{};
+
+  // The virtual hosts built on demand are shared by all workers, at most max_built_on_demand_ of
+  // them being held at once.
+  const uint32_t max_built_on_demand_;
+  mutable absl::Mutex on_demand_mutex_;
+  mutable std::unordered_map<const VirtualHostEntry*, OnDemandEntry>
+      on_demand_ GUARDED_BY(on_demand_mutex_);
+  // Virtual hosts from the most to the least recently used.
+  mutable std::list<const VirtualHostEntry*> on_demand_lru_ GUARDED_BY(on_demand_mutex_);
 };
 
 /**
@@ -681,6 +747,8 @@ public:
 
   const std::string& name() const override { return name_; }
 
+  size_t numVirtualHostsBuiltOnDemand() const { return route_matcher_->numBuiltOnDemand(); }
+
 private:
   std::unique_ptr<RouteMatcher> route_matcher_;
   std::list<Http::LowerCaseString> internal_only_headers_;
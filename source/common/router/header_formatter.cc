@@ -11,6 +11,7 @@
 #include "common/config/metadata.h"
 #include "common/http/header_map_impl.h"
 #include "common/json/json_loader.h"
+#include "common/request_info/filter_state_impl.h"
 #include "common/request_info/utility.h"
 
 #include "absl/strings/str_cat.h"
@@ -140,25 +141,27 @@ parsePerRequestStateField(absl::string_view param_str) {
     throw EnvoyException(formatPerRequestStateParseException(param_str));
   }
 
-  std::string param(modified_param_str);
-  return [param](const Envoy::RequestInfo::RequestInfo& request_info) -> std::string {
+  // Resolve the state name to its slot once, rather than looking it up for every request.
+  const Envoy::RequestInfo::FilterState::Key& key =
+      Envoy::RequestInfo::FilterStateKeys::registerKey(modified_param_str);
+  return [&key](const Envoy::RequestInfo::RequestInfo& request_info) -> std::string {
     const Envoy::RequestInfo::FilterState& per_request_state = request_info.perRequestState();
 
     // No such value means don't output anything.
-    if (!per_request_state.hasDataWithName(param)) {
+    if (!per_request_state.hasDataWithKey(key)) {
       return std::string();
     }
 
     // Value exists but isn't string accessible is a contract violation; throw an error.
-    if (!per_request_state.hasData<StringAccessor>(param)) {
+    if (!per_request_state.hasData<StringAccessor>(key)) {
       ENVOY_LOG_MISC(debug,
                      "Invalid header information: PER_REQUEST_STATE value \"{}\" "
                      "exists but is not string accessible",
-                     param);
+                     key.name());
       return std::string();
     }
 
-    return std::string(per_request_state.getData<StringAccessor>(param).asString());
+    return std::string(per_request_state.getData<StringAccessor>(key).asString());
   };
 }
 
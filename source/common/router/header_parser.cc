@@ -6,11 +6,13 @@
 #include <string>
 
 #include "common/common/assert.h"
+#include "common/common/empty_string.h"
 #include "common/http/headers.h"
 #include "common/protobuf/utility.h"
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Router {
@@ -34,9 +36,11 @@ std::string unescape(absl::string_view sv) { return absl::StrReplaceAll(sv, {{"%
 // is either literal text (with % escaped as %%) or part of a %VAR% or %VAR(["args"])% expression.
 // The statement machine does minimal validation of the arguments (if any) and does not know the
 // names of valid variables. Interpretation of the variable name and arguments is delegated to
-// RequestInfoHeaderFormatter.
+// RequestInfoHeaderFormatter. If the value does not reference any variable, constant_value is set
+// to it.
 HeaderFormatterPtr
-parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option) {
+parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option,
+              absl::optional<std::string>& constant_value) {
   const std::string& key = header_value_option.header().key();
   // PGV constraints provide this guarantee.
   ASSERT(!key.empty());
@@ -53,10 +57,14 @@ parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option
 
   absl::string_view format(header_value_option.header().value());
   if (format.empty()) {
+    constant_value = "";
     return std::make_unique<PlainHeaderFormatter>("", append);
   }
 
   std::vector<HeaderFormatterPtr> formatters;
+  // The concatenated literals, which are the value if there are no variables.
+  std::string literal_value;
+  bool has_variables = false;
 
   size_t pos = 0, start = 0;
   ParserState state = ParserState::Literal;
@@ -87,6 +95,7 @@ parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option
       state = ParserState::VariableName;
       if (pos > start) {
         absl::string_view literal = format.substr(start, pos - start);
+        literal_value += unescape(literal);
         formatters.emplace_back(new PlainHeaderFormatter(unescape(literal), append));
       }
       start = pos + 1;
@@ -98,6 +107,7 @@ parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option
         // Found complete variable name, add formatter.
         formatters.emplace_back(
             new RequestInfoHeaderFormatter(format.substr(start, pos - start), append));
+        has_variables = true;
         start = pos + 1;
         state = ParserState::Literal;
         break;
@@ -179,6 +189,7 @@ parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option
       if (ch == '%') {
         formatters.emplace_back(
             new RequestInfoHeaderFormatter(format.substr(start, pos - start), append));
+        has_variables = true;
         start = pos + 1;
         state = ParserState::Literal;
         break;
@@ -206,11 +217,16 @@ parseInternal(const envoy::api::v2::core::HeaderValueOption& header_value_option
   if (pos > start) {
     // Trailing constant data.
     absl::string_view literal = format.substr(start, pos - start);
+    literal_value += unescape(literal);
     formatters.emplace_back(new PlainHeaderFormatter(unescape(literal), append));
   }
 
   ASSERT(formatters.size() > 0);
 
+  if (!has_variables) {
+    constant_value = std::move(literal_value);
+  }
+
   if (formatters.size() == 1) {
     return std::move(formatters[0]);
   }
@@ -225,10 +241,20 @@ HeaderParserPtr HeaderParser::configure(
   HeaderParserPtr header_parser(new HeaderParser());
 
   for (const auto& header_value_option : headers_to_add) {
-    HeaderFormatterPtr header_formatter = parseInternal(header_value_option);
-
-    header_parser->headers_to_add_.emplace_back(
-        Http::LowerCaseString(header_value_option.header().key()), std::move(header_formatter));
+    absl::optional<std::string> constant_value;
+    HeaderFormatterPtr header_formatter = parseInternal(header_value_option, constant_value);
+    const HeaderOperation::Type type =
+        header_formatter->append() ? HeaderOperation::Type::Add : HeaderOperation::Type::Set;
+    Http::LowerCaseString key(header_value_option.header().key());
+
+    if (!constant_value.has_value()) {
+      header_parser->operations_.push_back(
+          {type, std::move(key), EMPTY_STRING, std::move(header_formatter)});
+    } else if (!constant_value.value().empty()) {
+      // Constant values are added by reference rather than formatted for each request.
+      header_parser->operations_.push_back(
+          {type, std::move(key), std::move(constant_value.value()), nullptr});
+    }
   }
 
   return header_parser;
@@ -240,7 +266,19 @@ HeaderParserPtr HeaderParser::configure(
   HeaderParserPtr header_parser = configure(headers_to_add);
 
   for (const auto& header : headers_to_remove) {
-    header_parser->headers_to_remove_.emplace_back(header);
+    header_parser->operations_.push_back(
+        {HeaderOperation::Type::Remove, Http::LowerCaseString(header), EMPTY_STRING, nullptr});
+  }
+
+  return header_parser;
+}
+
+HeaderParserPtr HeaderParser::merge(const std::vector<const HeaderParser*>& header_parsers) {
+  HeaderParserPtr header_parser(new HeaderParser());
+
+  for (const HeaderParser* parser : header_parsers) {
+    header_parser->operations_.insert(header_parser->operations_.end(),
+                                      parser->operations_.begin(), parser->operations_.end());
   }
 
   return header_parser;
@@ -248,19 +286,29 @@ HeaderParserPtr HeaderParser::configure(
 
 void HeaderParser::evaluateHeaders(Http::HeaderMap& headers,
                                    const RequestInfo::RequestInfo& request_info) const {
-  for (const auto& formatter : headers_to_add_) {
-    const std::string value = formatter.second->format(request_info);
-    if (!value.empty()) {
-      if (formatter.second->append()) {
-        headers.addReferenceKey(formatter.first, value);
+  for (const HeaderOperation& operation : operations_) {
+    if (operation.type_ == HeaderOperation::Type::Remove) {
+      headers.remove(operation.key_);
+      continue;
+    }
+
+    if (operation.formatter_ == nullptr) {
+      if (operation.type_ == HeaderOperation::Type::Add) {
+        headers.addReference(operation.key_, operation.value_);
       } else {
-        headers.setReferenceKey(formatter.first, value);
+        headers.setReference(operation.key_, operation.value_);
       }
+      continue;
     }
-  }
 
-  for (const auto& header : headers_to_remove_) {
-    headers.remove(header);
+    const std::string value = operation.formatter_->format(request_info);
+    if (!value.empty()) {
+      if (operation.type_ == HeaderOperation::Type::Add) {
+        headers.addReferenceKey(operation.key_, value);
+      } else {
+        headers.setReferenceKey(operation.key_, value);
+      }
+    }
   }
 }
 
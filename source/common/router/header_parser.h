@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -19,7 +20,8 @@ typedef std::unique_ptr<HeaderParser> HeaderParserPtr;
 /**
  * HeaderParser manipulates Http::HeaderMap instances. Headers to be added are pre-parsed to select
  * between a constant value implementation and a dynamic value implementation based on
- * RequestInfo::RequestInfo fields.
+ * RequestInfo::RequestInfo fields. The manipulations are kept as a list of operations, which
+ * parsers of several configuration levels can be merged into.
  */
 class HeaderParser {
 public:
@@ -39,6 +41,13 @@ public:
       const Protobuf::RepeatedPtrField<envoy::api::v2::core::HeaderValueOption>& headers_to_add,
       const Protobuf::RepeatedPtrField<ProtobufTypes::String>& headers_to_remove);
 
+  /*
+   * @param header_parsers supplies the parsers to merge.
+   * @return HeaderParserPtr a parser that manipulates headers as evaluating each of header_parsers
+   *         in turn would. It doesn't reference header_parsers.
+   */
+  static HeaderParserPtr merge(const std::vector<const HeaderParser*>& header_parsers);
+
   void evaluateHeaders(Http::HeaderMap& headers,
                        const RequestInfo::RequestInfo& request_info) const;
 
@@ -46,8 +55,18 @@ protected:
   HeaderParser() {}
 
 private:
-  std::vector<std::pair<Http::LowerCaseString, HeaderFormatterPtr>> headers_to_add_;
-  std::vector<Http::LowerCaseString> headers_to_remove_;
+  struct HeaderOperation {
+    enum class Type { Add, Set, Remove };
+
+    Type type_;
+    Http::LowerCaseString key_;
+    // The value of added headers whose value doesn't depend on the request.
+    std::string value_;
+    // The formatter of the value of the other added headers, or nullptr.
+    std::shared_ptr<const HeaderFormatter> formatter_;
+  };
+
+  std::vector<HeaderOperation> operations_;
 };
 
 } // namespace Router
@@ -38,5 +38,15 @@ MetadataMatchCriteriaImpl::extractMetadataMatchCriteria(const MetadataMatchCrite
 
   return v;
 }
+
+uint64_t MetadataMatchCriteriaImpl::computeHash(
+    const std::vector<MetadataMatchCriterionConstSharedPtr>& criteria) {
+  uint64_t hash = 0;
+  for (const auto& criterion : criteria) {
+    hash = HashedValue::combine(hash, criterion->name(), criterion->value());
+  }
+  return hash;
+}
+
 } // namespace Router
 } // namespace Envoy
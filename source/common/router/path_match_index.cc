@@ -0,0 +1,103 @@
+#include "common/router/path_match_index.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "common/common/assert.h"
+
+#include "absl/strings/ascii.h"
+
+namespace Envoy {
+namespace Router {
+
+constexpr size_t PathMatchIndex::MaxCandidateLists;
+
+PathMatchIndex::PathMatchIndex(const std::vector<Entry>& entries) {
+  for (uint32_t i = 0; i < entries.size(); i++) {
+    const Entry& entry = entries[i];
+    if (entry.match_type_ == PathMatchType::Regex) {
+      unindexed_routes_.push_back(i);
+      continue;
+    }
+
+    ASSERT(entry.match_type_ == PathMatchType::Prefix || entry.match_type_ == PathMatchType::Exact);
+    Node* node = entry.case_sensitive_ ? &case_sensitive_root_ : &case_insensitive_root_;
+    for (char c : entry.matcher_) {
+      node = &node->findOrCreateChild(entry.case_sensitive_ ? c : absl::ascii_tolower(c));
+    }
+    if (entry.match_type_ == PathMatchType::Prefix) {
+      node->prefix_routes_.push_back(i);
+    } else {
+      node->exact_routes_.push_back(i);
+    }
+  }
+
+  finalize(case_sensitive_root_, nullptr);
+  finalize(case_insensitive_root_, nullptr);
+}
+
+PathMatchIndex::Node* PathMatchIndex::Node::findChild(char c) const {
+  auto it = std::lower_bound(
+      children_.begin(), children_.end(), c,
+      [](const std::pair<char, std::unique_ptr<Node>>& child, char c) { return child.first < c; });
+  return it != children_.end() && it->first == c ? it->second.get() : nullptr;
+}
+
+PathMatchIndex::Node& PathMatchIndex::Node::findOrCreateChild(char c) {
+  auto it = std::lower_bound(
+      children_.begin(), children_.end(), c,
+      [](const std::pair<char, std::unique_ptr<Node>>& child, char c) { return child.first < c; });
+  if (it == children_.end() || it->first != c) {
+    it = children_.emplace(it, c, std::make_unique<Node>());
+  }
+  return *it->second;
+}
+
+void PathMatchIndex::finalize(Node& node, const std::vector<uint32_t>* parent_candidates) {
+  if (node.prefix_routes_.empty()) {
+    node.inherited_prefix_candidates_ = parent_candidates;
+  } else {
+    if (parent_candidates != nullptr) {
+      std::merge(parent_candidates->begin(), parent_candidates->end(), node.prefix_routes_.begin(),
+                 node.prefix_routes_.end(), std::back_inserter(node.prefix_candidates_));
+    } else {
+      node.prefix_candidates_ = node.prefix_routes_;
+    }
+    node.inherited_prefix_candidates_ = &node.prefix_candidates_;
+  }
+
+  for (auto& child : node.children_) {
+    finalize(*child.second, node.inherited_prefix_candidates_);
+  }
+}
+
+void PathMatchIndex::findCandidates(const Node& root, absl::string_view path, size_t path_length,
+                                    bool case_sensitive, const std::vector<uint32_t>** lists,
+                                    size_t& num_lists) {
+  const Node* node = &root;
+  size_t depth = 0;
+  while (true) {
+    // Exact routes compare the path up to the query string.
+    if (depth == path_length && !node->exact_routes_.empty()) {
+      lists[num_lists++] = &node->exact_routes_;
+    }
+    if (depth == path.size()) {
+      break;
+    }
+    const Node* child =
+        node->findChild(case_sensitive ? path[depth] : absl::ascii_tolower(path[depth]));
+    if (child == nullptr) {
+      break;
+    }
+    node = child;
+    depth++;
+  }
+
+  // Prefix routes compare against the whole path, including the query string.
+  if (node->inherited_prefix_candidates_ != nullptr) {
+    lists[num_lists++] = node->inherited_prefix_candidates_;
+  }
+}
+
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/router/router.h"
+
+#include "common/common/non_copyable.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Index over the path match criteria of an ordered list of routes, used to narrow the routes that
+ * need to be evaluated for a request path without changing which route matches first.
+ *
+ * Prefix and exact path routes are stored in a character trie (one for case sensitive and one for
+ * case insensitive matchers), so the routes whose path criterion can match are found with a single
+ * walk along the request path, independent of the number of routes. Regex routes can't be indexed
+ * and are always candidates. Candidates are produced in route order and the caller still performs
+ * the full match (headers, query parameters, runtime, etc.) on each of them, so first match
+ * semantics are preserved.
+ */
+class PathMatchIndex : NonCopyable {
+public:
+  struct Entry {
+    PathMatchType match_type_;
+    std::string matcher_;
+    bool case_sensitive_;
+  };
+
+  /**
+   * @param entries supplies the path match criteria of each route, in route order. The position of
+   *        an entry is the route index passed to forEachCandidate() callbacks.
+   */
+  explicit PathMatchIndex(const std::vector<Entry>& entries);
+
+  /**
+   * Invoke a callback with the index of every route whose path criterion may match the path, in
+   * increasing order, until the callback returns true.
+   * @param path supplies the request path, including any query string.
+   * @param cb supplies the callback, which takes the route index and returns whether to stop.
+   * @return bool whether a callback returned true.
+   */
+  template <class Callback> bool forEachCandidate(absl::string_view path, Callback cb) const {
+    // Each list is sorted and disjoint from the others, so merge them on the fly.
+    const std::vector<uint32_t>* lists[MaxCandidateLists];
+    size_t num_lists = 0;
+    const size_t path_length = std::min(path.find('?'), path.size());
+    findCandidates(case_sensitive_root_, path, path_length, true, lists, num_lists);
+    findCandidates(case_insensitive_root_, path, path_length, false, lists, num_lists);
+    if (!unindexed_routes_.empty()) {
+      lists[num_lists++] = &unindexed_routes_;
+    }
+
+    size_t positions[MaxCandidateLists] = {};
+    while (true) {
+      const std::vector<uint32_t>* next_list = nullptr;
+      size_t* next_position = nullptr;
+      for (size_t i = 0; i < num_lists; i++) {
+        if (positions[i] < lists[i]->size() &&
+            (next_list == nullptr || (*lists[i])[positions[i]] < (*next_list)[*next_position])) {
+          next_list = lists[i];
+          next_position = &positions[i];
+        }
+      }
+      if (next_list == nullptr) {
+        return false;
+      }
+      if (cb((*next_list)[(*next_position)++])) {
+        return true;
+      }
+    }
+  }
+
+private:
+  struct Node {
+    Node* findChild(char c) const;
+    Node& findOrCreateChild(char c);
+
+    // Children sorted by character.
+    std::vector<std::pair<char, std::unique_ptr<Node>>> children_;
+    // Prefix routes that terminate at this node.
+    std::vector<uint32_t> prefix_routes_;
+    // Exact path routes that terminate at this node.
+    std::vector<uint32_t> exact_routes_;
+    // All prefix routes terminating at this node or its ancestors, in route order. This is only
+    // populated for nodes that have their own prefix routes; other nodes point to the list of
+    // their closest such ancestor.
+    std::vector<uint32_t> prefix_candidates_;
+    const std::vector<uint32_t>* inherited_prefix_candidates_{};
+  };
+
+  // Prefix and exact routes for each of the two tries, plus the unindexed routes.
+  static constexpr size_t MaxCandidateLists = 5;
+
+  static void finalize(Node& node, const std::vector<uint32_t>* parent_candidates);
+  static void findCandidates(const Node& root, absl::string_view path, size_t path_length,
+                             bool case_sensitive, const std::vector<uint32_t>** lists,
+                             size_t& num_lists);
+
+  Node case_sensitive_root_;
+  Node case_insensitive_root_;
+  std::vector<uint32_t> unindexed_routes_;
+};
+
+} // namespace Router
+} // namespace Envoy
@@ -43,7 +43,9 @@ StaticRouteConfigProviderImpl::StaticRouteConfigProviderImpl(
     const envoy::api::v2::RouteConfiguration& config,
     Server::Configuration::FactoryContext& factory_context,
     RouteConfigProviderManagerImpl& route_config_provider_manager)
-    : config_(new ConfigImpl(config, factory_context, true)), route_config_proto_{config},
+    : config_(route_config_provider_manager.routeConfig(MessageUtil::hash(config), config,
+                                                        factory_context, true)),
+      route_config_proto_{config},
       last_updated_(factory_context.timeSource().systemTime()),
       route_config_provider_manager_(route_config_provider_manager) {
   route_config_provider_manager_.static_route_config_providers_.insert(this);
@@ -154,14 +156,13 @@ RdsRouteConfigProviderImpl::RdsRouteConfigProviderImpl(
       tls_(factory_context.threadLocal().allocateSlot()) {
   ConfigConstSharedPtr initial_config;
   if (subscription_->config_info_.has_value()) {
-    initial_config =
-        std::make_shared<ConfigImpl>(subscription_->route_config_proto_, factory_context_, false);
+    initial_config = subscription_->route_config_provider_manager_.routeConfig(
+        subscription_->config_info_.value().last_config_hash_, subscription_->route_config_proto_,
+        factory_context_, false);
   } else {
     initial_config = std::make_shared<NullConfigImpl>();
   }
-  tls_->set([initial_config](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-    return std::make_shared<ThreadLocalConfig>(initial_config);
-  });
+  tls_->publish(std::make_shared<ThreadLocalConfig>(initial_config));
   subscription_->route_config_providers_.insert(this);
 }
 
@@ -183,10 +184,11 @@ absl::optional<RouteConfigProvider::ConfigInfo> RdsRouteConfigProviderImpl::conf
 }
 
 void RdsRouteConfigProviderImpl::onConfigUpdate() {
-  ConfigConstSharedPtr new_config(
-      new ConfigImpl(subscription_->route_config_proto_, factory_context_, false));
-  tls_->runOnAllThreads(
-      [this, new_config]() -> void { tls_->getTyped<ThreadLocalConfig>().config_ = new_config; });
+  // Only the first provider of the subscription builds the route table, the others share it.
+  ConfigConstSharedPtr new_config = subscription_->route_config_provider_manager_.routeConfig(
+      subscription_->config_info_.value().last_config_hash_, subscription_->route_config_proto_,
+      factory_context_, false);
+  tls_->publish(std::make_shared<ThreadLocalConfig>(new_config));
 }
 
 RouteConfigProviderManagerImpl::RouteConfigProviderManagerImpl(Server::Admin& admin) {
@@ -241,6 +243,37 @@ RouteConfigProviderPtr RouteConfigProviderManagerImpl::createStaticRouteConfigPr
   return provider;
 }
 
+ConfigConstSharedPtr RouteConfigProviderManagerImpl::routeConfig(
+    uint64_t hash, const envoy::api::v2::RouteConfiguration& route_config,
+    Server::Configuration::FactoryContext& factory_context, bool validate_clusters_default) {
+  // Route tables build their virtual hosts on demand with the factory context they were built
+  // with, which goes away with its listener while other listeners may still share the table.
+  if (PROTOBUF_GET_WRAPPED_OR_DEFAULT(route_config, max_virtual_hosts_built_on_demand, 0) > 0) {
+    return std::make_shared<ConfigImpl>(route_config, factory_context, validate_clusters_default);
+  }
+
+  const auto key = std::make_pair(hash, validate_clusters_default);
+  auto it = route_configs_.find(key);
+  if (it != route_configs_.end()) {
+    ConfigConstSharedPtr config = it->second.lock();
+    if (config != nullptr) {
+      return config;
+    }
+  }
+
+  ConfigConstSharedPtr config =
+      std::make_shared<ConfigImpl>(route_config, factory_context, validate_clusters_default);
+  for (auto entry = route_configs_.begin(); entry != route_configs_.end();) {
+    if (entry->second.expired()) {
+      entry = route_configs_.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+  route_configs_[key] = config;
+  return config;
+}
+
 std::unique_ptr<envoy::admin::v2alpha::RoutesConfigDump>
 RouteConfigProviderManagerImpl::dumpRouteConfigs() const {
   auto config_dump = std::make_unique<envoy::admin::v2alpha::RoutesConfigDump>();
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -108,6 +109,14 @@ public:
 
   // Config::SubscriptionCallbacks
   void onConfigUpdate(const ResourceVector& resources, const std::string& version_info) override;
+  void onIncrementalConfigUpdate(const ResourceVector& added_resources,
+                                 const Protobuf::RepeatedPtrField<ProtobufTypes::String>&,
+                                 const std::string& system_version_info) override {
+    // Only this route configuration is subscribed to, so the update is the whole configuration,
+    // or its removal when there is none, which is handled as missing from a state of the world
+    // update.
+    onConfigUpdate(added_resources, system_version_info);
+  }
   void onConfigUpdateFailed(const EnvoyException* e) override;
   std::string resourceName(const ProtobufWkt::Any& resource) override {
     return MessageUtil::anyConvert<envoy::api::v2::RouteConfiguration>(resource).name();
@@ -168,7 +177,7 @@ private:
   struct ThreadLocalConfig : public ThreadLocal::ThreadLocalObject {
     ThreadLocalConfig(ConfigConstSharedPtr initial_config) : config_(initial_config) {}
 
-    ConfigConstSharedPtr config_;
+    const ConfigConstSharedPtr config_;
   };
 
   RdsRouteConfigProviderImpl(RdsRouteConfigSubscriptionSharedPtr&& subscription,
@@ -199,14 +208,30 @@ public:
                                   Server::Configuration::FactoryContext& factory_context) override;
 
 private:
+  /**
+   * @return ConfigConstSharedPtr the route table of a route configuration. Providers whose route
+   *         configurations have the same content share a single route table, so that listeners
+   *         with identical routes do not each hold a copy.
+   * @param hash supplies the hash of the route configuration.
+   */
+  ConfigConstSharedPtr routeConfig(uint64_t hash,
+                                   const envoy::api::v2::RouteConfiguration& route_config,
+                                   Server::Configuration::FactoryContext& factory_context,
+                                   bool validate_clusters_default);
+
   // TODO(jsedgwick) These two members are prime candidates for the owned-entry list/map
   // as in ConfigTracker. I.e. the ProviderImpls would have an EntryOwner for these lists
   // Then the lifetime management stuff is centralized and opaque.
   std::unordered_map<std::string, std::weak_ptr<RdsRouteConfigSubscription>>
       route_config_subscriptions_;
   std::unordered_set<RouteConfigProvider*> static_route_config_providers_;
+  // Route tables by the hash of their route configuration and whether their clusters are
+  // validated by default. The route tables are owned by the providers, the entries of those that
+  // were released are pruned when a route table is built.
+  std::map<std::pair<uint64_t, bool>, std::weak_ptr<const Config>> route_configs_;
   Server::ConfigTracker::EntryOwnerPtr config_tracker_entry_;
 
+  friend class RdsRouteConfigProviderImpl;
   friend class RdsRouteConfigSubscription;
   friend class StaticRouteConfigProviderImpl;
 };
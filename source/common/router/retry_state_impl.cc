@@ -11,10 +11,15 @@
 #include "common/http/codes.h"
 #include "common/http/headers.h"
 #include "common/http/utility.h"
+#include "common/runtime/key_registry.h"
 
 namespace Envoy {
 namespace Router {
 
+static const Runtime::Key RuntimeBaseRetryBackoff =
+    Runtime::KeyRegistry::intern("upstream.base_retry_backoff_ms");
+static const Runtime::Key RuntimeUseRetry = Runtime::KeyRegistry::intern("upstream.use_retry");
+
 // These are defined in envoy/router/router.h, however during certain cases the compiler is
 // refusing to use the header version so allocate space here.
 const uint32_t RetryPolicy::RETRY_ON_5XX;
@@ -71,7 +76,7 @@ RetryStateImpl::RetryStateImpl(const RetryPolicy& route_policy, Http::HeaderMap&
   // Merge in the route policy.
   retry_on_ |= route_policy.retryOn();
   retries_remaining_ = std::max(retries_remaining_, route_policy.numRetries());
-  const uint32_t base = runtime_.snapshot().getInteger("upstream.base_retry_backoff_ms", 25);
+  const uint32_t base = runtime_.snapshot().getInteger(RuntimeBaseRetryBackoff, 25);
   // Cap the max interval to 10 times the base interval to ensure reasonable backoff intervals.
   backoff_strategy_ = std::make_unique<JitteredBackOffStrategy>(base, base * 10, random_);
 }
@@ -156,7 +161,7 @@ RetryStatus RetryStateImpl::shouldRetry(const Http::HeaderMap* response_headers,
     return RetryStatus::NoOverflow;
   }
 
-  if (!runtime_.snapshot().featureEnabled("upstream.use_retry", 100)) {
+  if (!runtime_.snapshot().featureEnabled(RuntimeUseRetry, 100)) {
     return RetryStatus::No;
   }
 
@@ -117,6 +117,7 @@ FilterUtility::finalTimeout(const RouteEntry& route, Http::HeaderMap& request_he
 Filter::~Filter() {
   // Upstream resources should already have been cleaned.
   ASSERT(!upstream_request_);
+  ASSERT(!hedged_request_);
   ASSERT(!retry_state_);
 }
 
@@ -299,6 +300,14 @@ Http::FilterHeadersStatus Filter::decodeHeaders(Http::HeaderMap& headers, bool e
                        config_.random_, callbacks_->dispatcher(), route_entry_->priority());
   do_shadowing_ = FilterUtility::shouldShadow(route_entry_->shadowPolicy(), config_.runtime_,
                                               callbacks_->streamId());
+  do_hedging_ = route_entry_->hedgeDelay().has_value();
+  if (buffer_limit_ > 0) {
+    retry_shadow_buffer_limit_ = buffer_limit_;
+  }
+  const absl::optional<uint32_t> route_buffer_limit = route_entry_->retryShadowBufferLimit();
+  if (route_buffer_limit && route_buffer_limit.value() < retry_shadow_buffer_limit_) {
+    retry_shadow_buffer_limit_ = route_buffer_limit.value();
+  }
 
   ENVOY_STREAM_LOG(debug, "router decoding headers:\n{}", *callbacks_, headers);
 
@@ -334,20 +343,23 @@ void Filter::sendNoHealthyUpstreamResponse() {
 }
 
 Http::FilterDataStatus Filter::decodeData(Buffer::Instance& data, bool end_stream) {
-  bool buffering = (retry_state_ && retry_state_->enabled()) || do_shadowing_;
-  if (buffering && buffer_limit_ > 0 &&
-      getLength(callbacks_->decodingBuffer()) + data.length() > buffer_limit_) {
-    // The request is larger than we should buffer. Give up on the retry/shadow
+  bool buffering = (retry_state_ && retry_state_->enabled()) || do_shadowing_ || do_hedging_;
+  if (buffering &&
+      getLength(callbacks_->decodingBuffer()) + data.length() > retry_shadow_buffer_limit_) {
+    // The request is larger than we should buffer. Give up on the retry/shadow/hedge
     cluster_->stats().retry_or_shadow_abandoned_.inc();
     retry_state_.reset();
     buffering = false;
     do_shadowing_ = false;
+    do_hedging_ = false;
   }
 
-  // If we are going to buffer for retries or shadowing, we need to make a copy before encoding
-  // since it's all moves from here on.
+  // If we are going to buffer for retries, shadowing or hedging, we need to make a copy before
+  // encoding since it's all moves from here on. The copy shares the body's slices, and so do the
+  // later copies of the buffered body for retries, hedging and shadowing.
   if (buffering) {
-    Buffer::OwnedImpl copy(data);
+    Buffer::OwnedImpl copy;
+    copy.share(data);
     upstream_request_->encodeData(copy, end_stream);
   } else {
     upstream_request_->encodeData(data, end_stream);
@@ -381,11 +393,19 @@ void Filter::setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callb
 
 void Filter::cleanup() {
   upstream_request_.reset();
+  if (hedged_request_) {
+    hedged_request_->resetStream();
+    hedged_request_.reset();
+  }
   retry_state_.reset();
   if (response_timeout_) {
     response_timeout_->disableTimer();
     response_timeout_.reset();
   }
+  if (hedge_timer_) {
+    hedge_timer_->disableTimer();
+    hedge_timer_.reset();
+  }
 }
 
 void Filter::maybeDoShadowing() {
@@ -409,7 +429,8 @@ void Filter::maybeDoShadowing() {
 
 void Filter::onRequestComplete() {
   downstream_end_stream_ = true;
-  downstream_request_complete_time_ = std::chrono::steady_clock::now();
+  downstream_request_complete_time_ =
+      callbacks_->dispatcher().approximateTimeSource().monotonicTime();
 
   // Possible that we got an immediate reset.
   if (upstream_request_) {
@@ -423,6 +444,10 @@ void Filter::onRequestComplete() {
           callbacks_->dispatcher().createTimer([this]() -> void { onResponseTimeout(); });
       response_timeout_->enableTimer(timeout_.global_timeout_);
     }
+    if (do_hedging_) {
+      hedge_timer_ = callbacks_->dispatcher().createTimer([this]() -> void { onHedgeTimeout(); });
+      hedge_timer_->enableTimer(route_entry_->hedgeDelay().value());
+    }
   }
 }
 
@@ -450,6 +475,73 @@ void Filter::onResponseTimeout() {
   onUpstreamReset(UpstreamResetType::GlobalTimeout, absl::optional<Http::StreamResetReason>());
 }
 
+void Filter::onHedgeTimeout() {
+  // Only hedge a request that is still waiting for its first response, and only once.
+  if (downstream_response_started_ || !upstream_request_ || hedged_request_) {
+    return;
+  }
+
+  hedging_ = true;
+  Http::ConnectionPool::Instance* conn_pool = getConnPool();
+  hedging_ = false;
+  if (!conn_pool) {
+    return;
+  }
+
+  ENVOY_STREAM_LOG(debug, "sending hedged request", *callbacks_);
+  cluster_->stats().upstream_rq_hedged_.inc();
+  hedged_request_.reset(new UpstreamRequest(*this, *conn_pool));
+  hedged_request_->encodeHeaders(!callbacks_->decodingBuffer() && !downstream_trailers_);
+  // Each step may reset the hedged request inline.
+  if (hedged_request_ && callbacks_->decodingBuffer()) {
+    Buffer::OwnedImpl copy(*callbacks_->decodingBuffer());
+    hedged_request_->encodeData(copy, !downstream_trailers_);
+  }
+  if (hedged_request_ && downstream_trailers_) {
+    hedged_request_->encodeTrailers(*downstream_trailers_);
+  }
+  if (hedged_request_) {
+    hedged_request_->setupPerTryTimeout();
+  }
+}
+
+void Filter::onHedgedRequestFailure(UpstreamRequest& upstream_request, uint64_t response_code) {
+  ASSERT(hedged_request_);
+  ENVOY_STREAM_LOG(debug, "hedged upstream request failed, awaiting the other one", *callbacks_);
+
+  const Upstream::HostDescriptionConstSharedPtr upstream_host = upstream_request.upstream_host_;
+  if (upstream_host) {
+    upstream_host->outlierDetector().putHttpResponseCode(response_code);
+    upstream_host->stats().rq_error_.inc();
+  }
+  if (retry_state_) {
+    retry_state_->onHostAttempted(upstream_host);
+  }
+
+  if (&upstream_request == hedged_request_.get()) {
+    hedged_request_.reset();
+  } else {
+    upstream_request_ = std::move(hedged_request_);
+  }
+  if (upstream_request_->upstream_host_) {
+    callbacks_->requestInfo().onUpstreamHostSelected(upstream_request_->upstream_host_);
+  }
+}
+
+void Filter::onHedgedRequestWon(UpstreamRequest& upstream_request) {
+  ASSERT(hedged_request_);
+  if (&upstream_request == hedged_request_.get()) {
+    ENVOY_STREAM_LOG(debug, "hedged request responded first", *callbacks_);
+    cluster_->stats().upstream_rq_hedge_won_.inc();
+    upstream_request_->resetStream();
+    upstream_request_ = std::move(hedged_request_);
+  } else {
+    hedged_request_->resetStream();
+    hedged_request_.reset();
+  }
+  callbacks_->requestInfo().onUpstreamHostSelected(upstream_request_->upstream_host_);
+}
+
 void Filter::onUpstreamReset(UpstreamResetType type,
                              const absl::optional<Http::StreamResetReason>& reset_reason) {
   ASSERT(type == UpstreamResetType::GlobalTimeout || upstream_request_);
@@ -617,7 +709,8 @@ void Filter::onUpstreamHeaders(const uint64_t response_code, Http::HeaderMapPtr&
   // Only send upstream service time if we received the complete request and this is not a
   // premature response.
   if (DateUtil::timePointValid(downstream_request_complete_time_)) {
-    MonotonicTime response_received_time = std::chrono::steady_clock::now();
+    MonotonicTime response_received_time =
+        callbacks_->dispatcher().approximateTimeSource().monotonicTime();
     std::chrono::milliseconds ms = std::chrono::duration_cast<std::chrono::milliseconds>(
         response_received_time - downstream_request_complete_time_);
     if (!config_.suppress_envoy_headers_) {
@@ -685,7 +778,8 @@ void Filter::onUpstreamComplete() {
   if (config_.emit_dynamic_stats_ && !callbacks_->requestInfo().healthCheck() &&
       DateUtil::timePointValid(downstream_request_complete_time_)) {
     std::chrono::milliseconds response_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now() - downstream_request_complete_time_);
+        callbacks_->dispatcher().approximateTimeSource().monotonicTime() -
+        downstream_request_complete_time_);
 
     upstream_request_->upstream_host_->outlierDetector().putResponseTime(response_time);
 
@@ -780,7 +874,8 @@ void Filter::doRetry() {
 
 Filter::UpstreamRequest::UpstreamRequest(Filter& parent, Http::ConnectionPool::Instance& pool)
     : parent_(parent), conn_pool_(pool), grpc_rq_success_deferred_(false),
-      request_info_(pool.protocol()), calling_encode_headers_(false), upstream_canary_(false),
+      request_info_(pool.protocol(), parent.callbacks_->dispatcher().approximateTimeSource()),
+      calling_encode_headers_(false), upstream_canary_(false),
       encode_complete_(false), encode_trailers_(false) {
 
   if (parent_.config_.start_child_span_) {
@@ -813,18 +908,33 @@ Filter::UpstreamRequest::~UpstreamRequest() {
 
 void Filter::UpstreamRequest::decode100ContinueHeaders(Http::HeaderMapPtr&& headers) {
   ASSERT(100 == Http::Utility::getResponseStatus(*headers));
+  if (parent_.hedged_request_) {
+    parent_.onHedgedRequestWon(*this);
+  }
   parent_.onUpstream100ContinueHeaders(std::move(headers));
 }
 
 void Filter::UpstreamRequest::decodeHeaders(Http::HeaderMapPtr&& headers, bool end_stream) {
+  const uint64_t response_code = Http::Utility::getResponseStatus(*headers);
+  request_info_.response_code_ = static_cast<uint32_t>(response_code);
+  if (parent_.hedged_request_) {
+    // While racing another request, a 5xx only ends this one.
+    if (Http::CodeUtility::is5xx(response_code)) {
+      if (!end_stream) {
+        resetStream();
+      }
+      parent_.onHedgedRequestFailure(*this, response_code);
+      return;
+    }
+    parent_.onHedgedRequestWon(*this);
+  }
+
   // TODO(rodaine): This is actually measuring after the headers are parsed and not the first byte.
   request_info_.onFirstUpstreamRxByteReceived();
   parent_.callbacks_->requestInfo().onFirstUpstreamRxByteReceived();
   maybeEndDecode(end_stream);
 
   upstream_headers_ = headers.get();
-  const uint64_t response_code = Http::Utility::getResponseStatus(*headers);
-  request_info_.response_code_ = static_cast<uint32_t>(response_code);
   parent_.onUpstreamHeaders(response_code, std::move(headers), end_stream);
 }
 
@@ -847,6 +957,24 @@ void Filter::UpstreamRequest::maybeEndDecode(bool end_stream) {
   }
 }
 
+void Filter::UpstreamRequest::onFirstTxByteSent() {
+  request_info_.onFirstUpstreamTxByteSent();
+  // A hedged request races a request that may have been sent already. The downstream timings are
+  // those of whichever is sent first, and they are reset along with the upstream request on retry.
+  RequestInfo::RequestInfo& downstream_info = parent_.callbacks_->requestInfo();
+  if (!downstream_info.firstUpstreamTxByteSent()) {
+    downstream_info.onFirstUpstreamTxByteSent();
+  }
+}
+
+void Filter::UpstreamRequest::onLastTxByteSent() {
+  request_info_.onLastUpstreamTxByteSent();
+  RequestInfo::RequestInfo& downstream_info = parent_.callbacks_->requestInfo();
+  if (!downstream_info.lastUpstreamTxByteSent()) {
+    downstream_info.onLastUpstreamTxByteSent();
+  }
+}
+
 void Filter::UpstreamRequest::encodeHeaders(bool end_stream) {
   ASSERT(!encode_complete_);
   encode_complete_ = end_stream;
@@ -879,8 +1007,7 @@ void Filter::UpstreamRequest::encodeData(Buffer::Instance& data, bool end_stream
     request_info_.addBytesSent(data.length());
     request_encoder_->encodeData(data, end_stream);
     if (end_stream) {
-      request_info_.onLastUpstreamTxByteSent();
-      parent_.callbacks_->requestInfo().onLastUpstreamTxByteSent();
+      onLastTxByteSent();
     }
   }
 }
@@ -895,8 +1022,7 @@ void Filter::UpstreamRequest::encodeTrailers(const Http::HeaderMap& trailers) {
   } else {
     ENVOY_STREAM_LOG(trace, "proxying trailers", *parent_.callbacks_);
     request_encoder_->encodeTrailers(trailers);
-    request_info_.onLastUpstreamTxByteSent();
-    parent_.callbacks_->requestInfo().onLastUpstreamTxByteSent();
+    onLastTxByteSent();
   }
 }
 
@@ -904,6 +1030,10 @@ void Filter::UpstreamRequest::onResetStream(Http::StreamResetReason reason) {
   clearRequestEncoder();
   if (!calling_encode_headers_) {
     request_info_.setResponseFlag(parent_.streamResetReasonToResponseFlag(reason));
+    if (parent_.hedged_request_) {
+      parent_.onHedgedRequestFailure(*this, enumToInt(Http::Code::ServiceUnavailable));
+      return;
+    }
     parent_.onUpstreamReset(UpstreamResetType::Reset,
                             absl::optional<Http::StreamResetReason>(reason));
   } else {
@@ -946,6 +1076,10 @@ void Filter::UpstreamRequest::onPerTryTimeout() {
     }
     resetStream();
     request_info_.setResponseFlag(RequestInfo::ResponseFlag::UpstreamRequestTimeout);
+    if (parent_.hedged_request_) {
+      parent_.onHedgedRequestFailure(*this, enumToInt(parent_.timeout_response_code_));
+      return;
+    }
     parent_.onUpstreamReset(
         UpstreamResetType::PerTryTimeout,
         absl::optional<Http::StreamResetReason>(Http::StreamResetReason::LocalReset));
@@ -992,8 +1126,9 @@ void Filter::UpstreamRequest::onPoolReady(Http::StreamEncoder& request_encoder,
     span_->injectContext(*parent_.downstream_headers_);
   }
 
-  request_info_.onFirstUpstreamTxByteSent();
-  parent_.callbacks_->requestInfo().onFirstUpstreamTxByteSent();
+  request_encoder.getStream().setPriorityWeight(
+      Http::Utility::priorityWeight(parent_.route_entry_->priority()));
+  onFirstTxByteSent();
   request_encoder.encodeHeaders(*parent_.downstream_headers_,
                                 !buffered_request_body_ && encode_complete_ && !encode_trailers_);
   calling_encode_headers_ = false;
@@ -1016,8 +1151,7 @@ void Filter::UpstreamRequest::onPoolReady(Http::StreamEncoder& request_encoder,
     }
 
     if (encode_complete_) {
-      request_info_.onLastUpstreamTxByteSent();
-      parent_.callbacks_->requestInfo().onLastUpstreamTxByteSent();
+      onLastTxByteSent();
     }
   }
 }
@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 
@@ -147,7 +148,7 @@ class Filter : Logger::Loggable<Logger::Id::router>,
 public:
   Filter(FilterConfig& config)
       : config_(config), downstream_response_started_(false), downstream_end_stream_(false),
-        do_shadowing_(false), is_retry_(false) {}
+        do_shadowing_(false), is_retry_(false), do_hedging_(false), hedging_(false) {}
 
   ~Filter();
 
@@ -205,6 +206,11 @@ public:
   const Http::HeaderMap* downstreamHeaders() const override { return downstream_headers_; }
 
   bool shouldSelectAnotherHost(const Upstream::Host& host) override {
+    // A hedged request should go to a different host than the request it is racing.
+    if (hedging_) {
+      return upstream_request_ && upstream_request_->upstream_host_.get() == &host;
+    }
+
     // We only care about host selection when performing a retry, at which point we consult the
     // RetryState to see if we're configured to avoid certain hosts during retries.
     if (!is_retry_) {
@@ -257,6 +263,8 @@ private:
     void setupPerTryTimeout();
     void onPerTryTimeout();
     void maybeEndDecode(bool end_stream);
+    void onFirstTxByteSent();
+    void onLastTxByteSent();
 
     void onUpstreamHostSelected(Upstream::HostDescriptionConstSharedPtr host) {
       request_info_.onUpstreamHostSelected(host);
@@ -348,6 +356,11 @@ private:
   void maybeDoShadowing();
   void onRequestComplete();
   void onResponseTimeout();
+  void onHedgeTimeout();
+  // Called when one of two racing upstream requests has failed, leaving the other one to respond.
+  void onHedgedRequestFailure(UpstreamRequest& upstream_request, uint64_t response_code);
+  // Called when one of two racing upstream requests starts responding. The other one is reset.
+  void onHedgedRequestWon(UpstreamRequest& upstream_request);
   void onUpstream100ContinueHeaders(Http::HeaderMapPtr&& headers);
   void onUpstreamHeaders(uint64_t response_code, Http::HeaderMapPtr&& headers, bool end_stream);
   void onUpstreamData(Buffer::Instance& data, bool end_stream);
@@ -374,11 +387,16 @@ private:
   FilterUtility::TimeoutData timeout_;
   Http::Code timeout_response_code_ = Http::Code::GatewayTimeout;
   UpstreamRequestPtr upstream_request_;
+  // Races upstream_request_ once the route's hedge delay has passed without a response.
+  UpstreamRequestPtr hedged_request_;
+  Event::TimerPtr hedge_timer_;
   bool grpc_request_{};
   Http::HeaderMap* downstream_headers_{};
   Http::HeaderMap* downstream_trailers_{};
   MonotonicTime downstream_request_complete_time_;
   uint32_t buffer_limit_{0};
+  // Request body bytes past which retries, shadowing and hedging are abandoned.
+  uint64_t retry_shadow_buffer_limit_{std::numeric_limits<uint64_t>::max()};
   bool stream_destroyed_{};
   MetadataMatchCriteriaConstPtr metadata_match_;
 
@@ -389,6 +407,8 @@ private:
   bool downstream_end_stream_ : 1;
   bool do_shadowing_ : 1;
   bool is_retry_ : 1;
+  bool do_hedging_ : 1;
+  bool hedging_ : 1;
 };
 
 class ProdFilter : public Filter {
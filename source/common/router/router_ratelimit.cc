@@ -66,17 +66,14 @@ bool GenericKeyAction::populateDescriptor(const Router::RouteEntry&,
 HeaderValueMatchAction::HeaderValueMatchAction(
     const envoy::api::v2::route::RateLimit::Action::HeaderValueMatch& action)
     : descriptor_value_(action.descriptor_value()),
-      expect_match_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(action, expect_match, true)) {
-  for (const auto& header_matcher : action.headers()) {
-    action_headers_.push_back(header_matcher);
-  }
-}
+      expect_match_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(action, expect_match, true)),
+      action_headers_(action.headers()) {}
 
 bool HeaderValueMatchAction::populateDescriptor(const Router::RouteEntry&,
                                                 RateLimit::Descriptor& descriptor,
                                                 const std::string&, const Http::HeaderMap& headers,
                                                 const Network::Address::Instance&) const {
-  if (expect_match_ == Http::HeaderUtility::matchHeaders(headers, action_headers_)) {
+  if (expect_match_ == action_headers_.matches(headers)) {
     descriptor.entries_.push_back({"header_match", descriptor_value_});
     return true;
   } else {
@@ -97,7 +97,7 @@ public:
 private:
   const std::string descriptor_value_;
   const bool expect_match_;
-  std::vector<Http::HeaderUtility::HeaderData> action_headers_;
+  const Http::HeaderUtility::HeaderMatcherSet action_headers_;
 };
 
 /*
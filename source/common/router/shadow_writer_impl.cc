@@ -21,9 +21,12 @@ void ShadowWriterImpl::shadow(const std::string& cluster, Http::MessagePtr&& req
       parts.size() == 2 ? absl::StrJoin(parts, "-shadow:")
                         : absl::StrCat(request->headers().Host()->value().c_str(), "-shadow"));
   // Configuration should guarantee that cluster exists before calling here. This is basically
-  // fire and forget. We don't handle cancelling.
-  cm_.httpAsyncClientForCluster(cluster).send(std::move(request), *this,
-                                              absl::optional<std::chrono::milliseconds>(timeout));
+  // fire and forget. We don't handle cancelling, and the response body is never looked at, so it
+  // is dropped as it arrives rather than buffered.
+  Http::AsyncClient::RequestOptions options;
+  options.timeout = timeout;
+  options.discard_response_body = true;
+  cm_.httpAsyncClientForCluster(cluster).send(std::move(request), *this, options);
 }
 
 } // namespace Router
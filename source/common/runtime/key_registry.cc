@@ -0,0 +1,37 @@
+#include "common/runtime/key_registry.h"
+
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Runtime {
+
+KeyRegistry::State& KeyRegistry::state() {
+  // Leaked on purpose, as keys may be interned by static initializers and used by static
+  // destructors.
+  static State* state = new State();
+  return *state;
+}
+
+Key KeyRegistry::intern(const std::string& name) {
+  State& registry = state();
+  Thread::LockGuard lock(registry.lock_);
+  auto it = registry.indices_.find(name);
+  if (it != registry.indices_.end()) {
+    return Key(name, it->second);
+  }
+  const uint32_t index = registry.names_.size();
+  registry.names_.push_back(name);
+  registry.indices_.emplace(name, index);
+  return Key(name, index);
+}
+
+void KeyRegistry::iterate(const std::function<void(const std::string&)>& cb) {
+  State& registry = state();
+  Thread::LockGuard lock(registry.lock_);
+  for (const std::string& name : registry.names_) {
+    cb(name);
+  }
+}
+
+} // namespace Runtime
+} // namespace Envoy
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/runtime/runtime.h"
+
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Runtime {
+
+/**
+ * Process wide registry of the runtime keys looked up through Runtime::Key. Keys are usually
+ * interned by static initializers or while configuration is loaded, and are never released:
+ * interning a name twice returns the same index, so the registry is bounded by the number of
+ * distinct names.
+ */
+class KeyRegistry {
+public:
+  /**
+   * @param name supplies the name of the runtime key.
+   * @return Key the interned key.
+   */
+  static Key intern(const std::string& name);
+
+  /**
+   * Call a function with the name of every interned key, in index order.
+   * @param cb supplies the function.
+   */
+  static void iterate(const std::function<void(const std::string&)>& cb);
+
+private:
+  struct State {
+    Thread::MutexBasicLockable lock_;
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, uint32_t> indices_;
+  };
+
+  static State& state();
+};
+
+} // namespace Runtime
+} // namespace Envoy
@@ -15,6 +15,7 @@
 #include "common/common/fmt.h"
 #include "common/common/utility.h"
 #include "common/filesystem/filesystem_impl.h"
+#include "common/runtime/key_registry.h"
 
 #include "openssl/rand.h"
 
@@ -151,8 +152,12 @@ bool SnapshotImpl::featureEnabled(const std::string& key, uint64_t default_value
 }
 
 bool SnapshotImpl::featureEnabled(const std::string& key, uint64_t default_value) const {
+  return sampleFeature(getInteger(key, default_value));
+}
+
+bool SnapshotImpl::sampleFeature(uint64_t value) const {
   // Avoid PNRG if we know we don't need it.
-  uint64_t cutoff = std::min(getInteger(key, default_value), static_cast<uint64_t>(100));
+  uint64_t cutoff = std::min(value, static_cast<uint64_t>(100));
   if (cutoff == 0) {
     return false;
   } else if (cutoff == 100) {
@@ -172,32 +177,67 @@ const std::string& SnapshotImpl::get(const std::string& key) const {
   if (entry == values_.end()) {
     return EMPTY_STRING;
   } else {
-    return entry->second.string_value_;
+    return entry->second->string_value_;
   }
 }
 
 uint64_t SnapshotImpl::getInteger(const std::string& key, uint64_t default_value) const {
   auto entry = values_.find(key);
-  if (entry == values_.end() || !entry->second.uint_value_) {
+  if (entry == values_.end() || !entry->second->uint_value_) {
+    return default_value;
+  } else {
+    return entry->second->uint_value_.value();
+  }
+}
+
+const Snapshot::Entry* SnapshotImpl::find(const Key& key) const {
+  if (key.index() < interned_values_.size()) {
+    return interned_values_[key.index()];
+  }
+  // The key was interned after the snapshot was built.
+  auto entry = values_.find(key.name());
+  return entry == values_.end() ? nullptr : entry->second;
+}
+
+bool SnapshotImpl::featureEnabled(const Key& key, uint64_t default_value) const {
+  return sampleFeature(getInteger(key, default_value));
+}
+
+bool SnapshotImpl::featureEnabled(const Key& key, uint64_t default_value,
+                                  uint64_t random_value) const {
+  return featureEnabled(key, default_value, random_value, 100);
+}
+
+bool SnapshotImpl::featureEnabled(const Key& key, uint64_t default_value, uint64_t random_value,
+                                  uint64_t num_buckets) const {
+  return random_value % num_buckets < std::min(getInteger(key, default_value), num_buckets);
+}
+
+uint64_t SnapshotImpl::getInteger(const Key& key, uint64_t default_value) const {
+  const Entry* entry = find(key);
+  if (entry == nullptr || !entry->uint_value_) {
     return default_value;
   } else {
-    return entry->second.uint_value_.value();
+    return entry->uint_value_.value();
   }
 }
 
-const std::vector<Snapshot::OverrideLayerConstPtr>& SnapshotImpl::getLayers() const {
+const std::vector<Snapshot::OverrideLayerConstSharedPtr>& SnapshotImpl::getLayers() const {
   return layers_;
 }
 
 SnapshotImpl::SnapshotImpl(RandomGenerator& generator, RuntimeStats& stats,
-                           std::vector<OverrideLayerConstPtr>&& layers)
+                           std::vector<OverrideLayerConstSharedPtr>&& layers)
     : layers_{std::move(layers)}, generator_{generator} {
   for (const auto& layer : layers_) {
     for (const auto& kv : layer->values()) {
-      values_.erase(kv.first);
-      values_.emplace(kv.first, kv.second);
+      values_[kv.first] = &kv.second;
     }
   }
+  KeyRegistry::iterate([this](const std::string& name) {
+    auto entry = values_.find(name);
+    interned_values_.push_back(entry == values_.end() ? nullptr : entry->second);
+  });
   stats.num_keys_.set(values_.size());
 }
 
@@ -222,13 +262,24 @@ void AdminLayer::mergeValues(const std::unordered_map<std::string, std::string>&
   stats_.admin_overrides_active_.set(values_.empty() ? 0 : 1);
 }
 
+DiskLayer::FileVersion::FileVersion(const struct stat& stat_result)
+    : device_(stat_result.st_dev), inode_(stat_result.st_ino), size_(stat_result.st_size),
+      modified_(stat_result.st_mtime) {
+#ifdef __APPLE__
+  modified_nsec_ = stat_result.st_mtimespec.tv_nsec;
+#else
+  modified_nsec_ = stat_result.st_mtim.tv_nsec;
+#endif
+}
+
 DiskLayer::DiskLayer(const std::string& name, const std::string& path,
-                     Api::OsSysCalls& os_sys_calls)
+                     Api::OsSysCalls& os_sys_calls, const DiskLayer* previous)
     : OverrideLayerImpl{name}, os_sys_calls_(os_sys_calls) {
-  walkDirectory(path, "", 1);
+  walkDirectory(path, "", 1, previous);
 }
 
-void DiskLayer::walkDirectory(const std::string& path, const std::string& prefix, uint32_t depth) {
+void DiskLayer::walkDirectory(const std::string& path, const std::string& prefix, uint32_t depth,
+                              const DiskLayer* previous) {
   ENVOY_LOG(debug, "walking directory: {}", path);
   if (depth > MaxWalkDepth) {
     throw EnvoyException(fmt::format("Walk recursion depth exceded {}", MaxWalkDepth));
@@ -265,8 +316,22 @@ void DiskLayer::walkDirectory(const std::string& path, const std::string& prefix
 
     if (S_ISDIR(stat_result.st_mode) && std::string(entry->d_name) != "." &&
         std::string(entry->d_name) != "..") {
-      walkDirectory(full_path, full_prefix, depth + 1);
+      walkDirectory(full_path, full_prefix, depth + 1, previous);
     } else if (S_ISREG(stat_result.st_mode)) {
+      const FileVersion version(stat_result);
+      file_versions_.erase(full_prefix);
+      file_versions_.emplace(full_prefix, version);
+      if (previous != nullptr) {
+        // Unchanged files keep their value, so that only the changed keys are read and parsed.
+        const auto previous_version = previous->file_versions_.find(full_prefix);
+        if (previous_version != previous->file_versions_.end() &&
+            previous_version->second == version) {
+          values_.erase(full_prefix);
+          values_.insert({full_prefix, previous->values_.at(full_prefix)});
+          continue;
+        }
+      }
+
       // Suck the file into a string. This is not very efficient but it should be good enough
       // for small files. Also, as noted elsewhere, none of this is non-blocking which could
       // theoretically lead to issues.
@@ -308,17 +373,12 @@ LoaderImpl::LoaderImpl(DoNotLoadSnapshot /* unused */, RandomGenerator& generato
       tls_(tls.allocateSlot()) {}
 
 std::unique_ptr<SnapshotImpl> LoaderImpl::createNewSnapshot() {
-  std::vector<Snapshot::OverrideLayerConstPtr> layers;
-  layers.emplace_back(std::make_unique<const AdminLayer>(admin_layer_));
+  std::vector<Snapshot::OverrideLayerConstSharedPtr> layers;
+  layers.emplace_back(std::make_shared<const AdminLayer>(admin_layer_));
   return std::make_unique<SnapshotImpl>(generator_, stats_, std::move(layers));
 }
 
-void LoaderImpl::loadNewSnapshot() {
-  ThreadLocal::ThreadLocalObjectSharedPtr ptr = createNewSnapshot();
-  tls_->set([ptr = std::move(ptr)](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-    return ptr;
-  });
-}
+void LoaderImpl::loadNewSnapshot() { tls_->publish(createNewSnapshot()); }
 
 Snapshot& LoaderImpl::snapshot() { return tls_->getTyped<Snapshot>(); }
 
@@ -333,17 +393,48 @@ DiskBackedLoaderImpl::DiskBackedLoaderImpl(Event::Dispatcher& dispatcher,
                                            const std::string& subdir,
                                            const std::string& override_dir, Stats::Store& store,
                                            RandomGenerator& generator,
-                                           Api::OsSysCallsPtr os_sys_calls)
-    : LoaderImpl(DoNotLoadSnapshot{}, generator, store, tls),
+                                           Api::OsSysCallsPtr os_sys_calls,
+                                           Thread::BlockingPool* blocking_pool)
+    : LoaderImpl(DoNotLoadSnapshot{}, generator, store, tls), dispatcher_(dispatcher),
       watcher_(dispatcher.createFilesystemWatcher()), root_path_(root_symlink_path + "/" + subdir),
       override_path_(root_symlink_path + "/" + override_dir),
-      os_sys_calls_(std::move(os_sys_calls)) {
+      os_sys_calls_(std::move(os_sys_calls)), blocking_pool_(blocking_pool) {
   watcher_->addWatch(root_symlink_path, Filesystem::Watcher::Events::MovedTo,
-                     [this](uint32_t) -> void { loadNewSnapshot(); });
+                     [this](uint32_t) -> void { onSymlinkSwapped(); });
 
+  layers_ = loadDiskLayers(layers_);
   loadNewSnapshot();
 }
 
+void DiskBackedLoaderImpl::onSymlinkSwapped() {
+  if (blocking_pool_ == nullptr) {
+    layers_ = loadDiskLayers(layers_);
+    loadNewSnapshot();
+    return;
+  }
+  if (reloading_) {
+    // The reload in progress may have walked the previous directory.
+    reload_pending_ = true;
+    return;
+  }
+
+  reloading_ = true;
+  // The layers are immutable, so the reload can take the unchanged values from the current layers
+  // while the snapshots still use them.
+  reload_ = blocking_pool_->post(
+      [this, previous = layers_]() -> void { reloaded_layers_ = loadDiskLayers(previous); },
+      dispatcher_,
+      [this]() -> void {
+        reloading_ = false;
+        layers_ = std::move(reloaded_layers_);
+        loadNewSnapshot();
+        if (reload_pending_) {
+          reload_pending_ = false;
+          onSymlinkSwapped();
+        }
+      });
+}
+
 RuntimeStats LoaderImpl::generateStats(Stats::Store& store) {
   std::string prefix = "runtime.";
   RuntimeStats stats{
@@ -351,22 +442,36 @@ RuntimeStats LoaderImpl::generateStats(Stats::Store& store) {
   return stats;
 }
 
-std::unique_ptr<SnapshotImpl> DiskBackedLoaderImpl::createNewSnapshot() {
-  std::vector<Snapshot::OverrideLayerConstPtr> layers;
+DiskBackedLoaderImpl::DiskLayers
+DiskBackedLoaderImpl::loadDiskLayers(const DiskLayers& previous) const {
+  DiskLayers layers;
   try {
-    layers.push_back(std::make_unique<DiskLayer>("root", root_path_, *os_sys_calls_));
+    layers.root_ =
+        std::make_shared<DiskLayer>("root", root_path_, *os_sys_calls_, previous.root_.get());
     if (Filesystem::directoryExists(override_path_)) {
-      layers.push_back(std::make_unique<DiskLayer>("override", override_path_, *os_sys_calls_));
+      layers.override_ = std::make_shared<DiskLayer>("override", override_path_, *os_sys_calls_,
+                                                     previous.override_.get());
       stats_.override_dir_exists_.inc();
     } else {
       stats_.override_dir_not_exists_.inc();
     }
   } catch (EnvoyException& e) {
-    layers.clear();
+    layers = DiskLayers();
     stats_.load_error_.inc();
     ENVOY_LOG(debug, "error loading runtime values from disk: {}", e.what());
   }
-  layers.push_back(std::make_unique<AdminLayer>(admin_layer_));
+  return layers;
+}
+
+std::unique_ptr<SnapshotImpl> DiskBackedLoaderImpl::createNewSnapshot() {
+  std::vector<Snapshot::OverrideLayerConstSharedPtr> layers;
+  if (layers_.root_ != nullptr) {
+    layers.push_back(layers_.root_);
+  }
+  if (layers_.override_ != nullptr) {
+    layers.push_back(layers_.override_);
+  }
+  layers.push_back(std::make_shared<AdminLayer>(admin_layer_));
   return std::make_unique<SnapshotImpl>(generator_, stats_, std::move(layers));
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <dirent.h>
+#include <sys/stat.h>
 
 #include <cstdint>
 #include <memory>
@@ -12,11 +13,13 @@
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/stats_macros.h"
 #include "envoy/stats/store.h"
+#include "envoy/thread/blocking_pool.h"
 #include "envoy/thread_local/thread_local.h"
 
 #include "common/common/empty_string.h"
 #include "common/common/logger.h"
 #include "common/common/thread.h"
+#include "common/common/utility.h"
 
 #include "spdlog/spdlog.h"
 
@@ -57,12 +60,14 @@ struct RuntimeStats {
 };
 
 /**
- * Implementation of Snapshot whose source is the vector of layers passed to the constructor.
+ * Implementation of Snapshot whose source is the vector of layers passed to the constructor. The
+ * layers are shared with other snapshots and the merged view only references their entries, so
+ * that a snapshot can be built without copying the values of the layers that did not change.
  */
 class SnapshotImpl : public Snapshot, public ThreadLocal::ThreadLocalObject {
 public:
   SnapshotImpl(RandomGenerator& generator, RuntimeStats& stats,
-               std::vector<OverrideLayerConstPtr>&& layers);
+               std::vector<OverrideLayerConstSharedPtr>&& layers);
 
   // Runtime::Snapshot
   bool featureEnabled(const std::string& key, uint64_t default_value, uint64_t random_value,
@@ -72,13 +77,25 @@ public:
                       uint64_t random_value) const override;
   const std::string& get(const std::string& key) const override;
   uint64_t getInteger(const std::string& key, uint64_t default_value) const override;
-  const std::vector<OverrideLayerConstPtr>& getLayers() const override;
+  const std::vector<OverrideLayerConstSharedPtr>& getLayers() const override;
+  bool featureEnabled(const Key& key, uint64_t default_value) const override;
+  bool featureEnabled(const Key& key, uint64_t default_value, uint64_t random_value) const override;
+  bool featureEnabled(const Key& key, uint64_t default_value, uint64_t random_value,
+                      uint64_t num_buckets) const override;
+  uint64_t getInteger(const Key& key, uint64_t default_value) const override;
 
   static Entry createEntry(const std::string& value);
 
 private:
-  const std::vector<OverrideLayerConstPtr> layers_;
-  std::unordered_map<std::string, const Snapshot::Entry> values_;
+  const Snapshot::Entry* find(const Key& key) const;
+  bool sampleFeature(uint64_t value) const;
+
+  const std::vector<OverrideLayerConstSharedPtr> layers_;
+  // Entries of the topmost layer defining each key, keyed by views of the layers' keys.
+  std::unordered_map<absl::string_view, const Snapshot::Entry*, StringViewHash> values_;
+  // The entries of the keys interned when the snapshot was built, by key index. nullptr for the
+  // keys without a value.
+  std::vector<const Snapshot::Entry*> interned_values_;
   RandomGenerator& generator_;
 };
 
@@ -128,9 +145,31 @@ private:
  */
 class DiskLayer : public OverrideLayerImpl, Logger::Loggable<Logger::Id::runtime> {
 public:
-  DiskLayer(const std::string& name, const std::string& path, Api::OsSysCalls& os_sys_calls);
+  /**
+   * @param previous supplies the layer previously loaded from the same directory, if any. The
+   *        values of the files that are unchanged since then are taken from it rather than read
+   *        again.
+   */
+  DiskLayer(const std::string& name, const std::string& path, Api::OsSysCalls& os_sys_calls,
+            const DiskLayer* previous = nullptr);
 
 private:
+  // Identifies the version of the file a value was read from. Replacing or modifying the file
+  // changes at least one of the fields.
+  struct FileVersion {
+    explicit FileVersion(const struct stat& stat_result);
+    bool operator==(const FileVersion& rhs) const {
+      return device_ == rhs.device_ && inode_ == rhs.inode_ && size_ == rhs.size_ &&
+             modified_ == rhs.modified_ && modified_nsec_ == rhs.modified_nsec_;
+    }
+
+    dev_t device_;
+    ino_t inode_;
+    off_t size_;
+    time_t modified_;
+    long modified_nsec_;
+  };
+
   struct Directory {
     Directory(const std::string& path) {
       dir_ = opendir(path.c_str());
@@ -144,10 +183,12 @@ private:
     DIR* dir_;
   };
 
-  void walkDirectory(const std::string& path, const std::string& prefix, uint32_t depth);
+  void walkDirectory(const std::string& path, const std::string& prefix, uint32_t depth,
+                     const DiskLayer* previous);
 
   const std::string path_;
   Api::OsSysCalls& os_sys_calls_;
+  std::unordered_map<std::string, FileVersion> file_versions_;
   // Maximum recursion depth for walkDirectory().
   const uint32_t MaxWalkDepth = 16;
 };
@@ -195,18 +236,47 @@ private:
  */
 class DiskBackedLoaderImpl : public LoaderImpl, Logger::Loggable<Logger::Id::runtime> {
 public:
+  /**
+   * @param blocking_pool supplies the threads that reload the runtime from disk once the symlink
+   *        is swapped, after which the new snapshot is loaded on the dispatcher. If nullptr, the
+   *        runtime is reloaded inline on the dispatcher. The initial load is always inline.
+   */
   DiskBackedLoaderImpl(Event::Dispatcher& dispatcher, ThreadLocal::SlotAllocator& tls,
                        const std::string& root_symlink_path, const std::string& subdir,
                        const std::string& override_dir, Stats::Store& store,
-                       RandomGenerator& generator, Api::OsSysCallsPtr os_sys_calls);
+                       RandomGenerator& generator, Api::OsSysCallsPtr os_sys_calls,
+                       Thread::BlockingPool* blocking_pool = nullptr);
 
 private:
+  // The layers loaded from disk, which are nullptr if loading failed.
+  struct DiskLayers {
+    std::shared_ptr<const DiskLayer> root_;
+    std::shared_ptr<const DiskLayer> override_;
+  };
+
   std::unique_ptr<SnapshotImpl> createNewSnapshot() override;
+  // Load the disk layers, reading only the files that changed since the previous layers were
+  // loaded. It may run on the blocking pool.
+  DiskLayers loadDiskLayers(const DiskLayers& previous) const;
+  void onSymlinkSwapped();
 
+  Event::Dispatcher& dispatcher_;
   const Filesystem::WatcherPtr watcher_;
   const std::string root_path_;
   const std::string override_path_;
   const Api::OsSysCallsPtr os_sys_calls_;
+  Thread::BlockingPool* const blocking_pool_;
+  // Shared by the snapshots until the runtime directory is swapped, so that admin changes do not
+  // read the disk again.
+  DiskLayers layers_;
+  // The reload running on the blocking pool, if any, and whether the symlink was swapped again
+  // since it started.
+  bool reloading_{};
+  bool reload_pending_{};
+  // Written by the reload on the blocking pool, and read once it completed.
+  DiskLayers reloaded_layers_;
+  // Destroyed first, as the reload touches the members above.
+  Thread::BlockingWorkPtr reload_;
 };
 
 } // namespace Runtime
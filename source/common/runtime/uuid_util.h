@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 
 enum class UuidTraceStatus { NoTrace, Sampled, Client, Forced };
@@ -12,12 +15,12 @@ enum class UuidTraceStatus { NoTrace, Sampled, Client, Forced };
 class UuidUtils {
 public:
   /**
-   * @return bool to indicate if operation succeeded.
+   * @return bool to indicate if operation succeeded, i.e. if uuid starts with 8 hex digits.
    * @param uuid uuid4.
-   * @param out will contain the result of the operation.
+   * @param out will contain the first 32 bits of uuid modulo mod.
    * @param mod modulo used in the operation.
    */
-  static bool uuidModBy(const std::string& uuid, uint64_t& out, uint64_t mod);
+  static bool uuidModBy(absl::string_view uuid, uint64_t& out, uint64_t mod);
 
   /**
    * Modify uuid in a way it can be detected if uuid is traceable or not.
@@ -27,10 +30,19 @@ public:
    */
   static bool setTraceableUuid(std::string& uuid, UuidTraceStatus trace_status);
 
+  /**
+   * Like setTraceableUuid() above, for a uuid in a caller owned buffer.
+   * @param uuid supplies the buffer holding the uuid, which is modified in place.
+   * @param length supplies the length of the uuid.
+   * @param trace_status is to specify why we modify uuid.
+   * @return true on success, false on failure.
+   */
+  static bool setTraceableUuid(char* uuid, size_t length, UuidTraceStatus trace_status);
+
   /**
    * @return status of the uuid, to differentiate reason for tracing, etc.
    */
-  static UuidTraceStatus isTraceableUuid(const std::string& uuid);
+  static UuidTraceStatus isTraceableUuid(absl::string_view uuid);
 
 private:
   // Byte on this position has predefined value of 4 for UUID4.
@@ -8,6 +8,7 @@
 #include "common/config/subscription_factory.h"
 #include "common/protobuf/utility.h"
 #include "common/ssl/tls_certificate_config_impl.h"
+#include "common/ssl/tls_session_ticket_keys_config_impl.h"
 
 namespace Envoy {
 namespace Secret {
@@ -60,11 +61,9 @@ void SdsApi::onConfigUpdate(const ResourceVector& resources, const std::string&)
   }
 
   const uint64_t new_hash = MessageUtil::hash(secret);
-  if (new_hash != secret_hash_ &&
-      secret.type_case() == envoy::api::v2::auth::Secret::TypeCase::kTlsCertificate) {
+  if (new_hash != secret_hash_ && secret.type_case() == secretType()) {
+    setSecret(secret);
     secret_hash_ = new_hash;
-    tls_certificate_secrets_ =
-        std::make_unique<Ssl::TlsCertificateConfigImpl>(secret.tls_certificate());
 
     update_callback_manager_.runCallbacks();
   }
@@ -84,5 +83,15 @@ void SdsApi::runInitializeCallbackIfAny() {
   }
 }
 
+void TlsCertificateSdsApi::setSecret(const envoy::api::v2::auth::Secret& secret) {
+  tls_certificate_secrets_ =
+      std::make_unique<Ssl::TlsCertificateConfigImpl>(secret.tls_certificate());
+}
+
+void TlsSessionTicketKeysSdsApi::setSecret(const envoy::api::v2::auth::Secret& secret) {
+  session_ticket_keys_secrets_ =
+      std::make_unique<Ssl::TlsSessionTicketKeysConfigImpl>(secret.session_ticket_keys());
+}
+
 } // namespace Secret
 } // namespace Envoy
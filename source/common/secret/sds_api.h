@@ -21,10 +21,10 @@ namespace Envoy {
 namespace Secret {
 
 /**
- * SDS API implementation that fetches secrets from SDS server via Subscription.
+ * SDS API implementation that fetches secrets from SDS server via Subscription. Subclasses hold
+ * the secret of one type and provide it to their SecretProvider callers.
  */
 class SdsApi : public Init::Target,
-               public TlsCertificateConfigProvider,
                public Config::SubscriptionCallbacks<envoy::api::v2::auth::Secret> {
 public:
   SdsApi(const LocalInfo::LocalInfo& local_info, Event::Dispatcher& dispatcher,
@@ -38,19 +38,31 @@ public:
 
   // Config::SubscriptionCallbacks
   void onConfigUpdate(const ResourceVector& resources, const std::string& version_info) override;
+  void onIncrementalConfigUpdate(const ResourceVector& added_resources,
+                                 const Protobuf::RepeatedPtrField<ProtobufTypes::String>&,
+                                 const std::string& system_version_info) override {
+    // A removed secret stays in use until it is replaced.
+    if (!added_resources.empty()) {
+      onConfigUpdate(added_resources, system_version_info);
+    }
+  }
   void onConfigUpdateFailed(const EnvoyException* e) override;
   std::string resourceName(const ProtobufWkt::Any& resource) override {
     return MessageUtil::anyConvert<envoy::api::v2::auth::Secret>(resource).name();
   }
 
-  // SecretProvider
-  const Ssl::TlsCertificateConfig* secret() const override {
-    return tls_certificate_secrets_.get();
-  }
+protected:
+  /**
+   * @return the type of secret this SdsApi accepts. Secrets of other types are ignored.
+   */
+  virtual envoy::api::v2::auth::Secret::TypeCase secretType() const PURE;
 
-  Common::CallbackHandle* addUpdateCallback(std::function<void()> callback) override {
-    return update_callback_manager_.add(callback);
-  }
+  /**
+   * Replace the held secret with a secret of secretType().
+   */
+  virtual void setSecret(const envoy::api::v2::auth::Secret& secret) PURE;
+
+  Common::CallbackManager<> update_callback_manager_;
 
 private:
   void runInitializeCallbackIfAny();
@@ -68,11 +80,61 @@ private:
 
   uint64_t secret_hash_;
   Cleanup clean_up_;
+};
+
+/**
+ * SdsApi that fetches a TLS certificate.
+ */
+class TlsCertificateSdsApi : public SdsApi, public TlsCertificateConfigProvider {
+public:
+  using SdsApi::SdsApi;
+
+  // SecretProvider
+  const Ssl::TlsCertificateConfig* secret() const override {
+    return tls_certificate_secrets_.get();
+  }
+
+  Common::CallbackHandle* addUpdateCallback(std::function<void()> callback) override {
+    return update_callback_manager_.add(callback);
+  }
+
+protected:
+  // SdsApi
+  envoy::api::v2::auth::Secret::TypeCase secretType() const override {
+    return envoy::api::v2::auth::Secret::TypeCase::kTlsCertificate;
+  }
+  void setSecret(const envoy::api::v2::auth::Secret& secret) override;
+
+private:
   Ssl::TlsCertificateConfigPtr tls_certificate_secrets_;
-  Common::CallbackManager<> update_callback_manager_;
 };
 
-typedef std::unique_ptr<SdsApi> SdsApiPtr;
+/**
+ * SdsApi that fetches TLS session ticket keys.
+ */
+class TlsSessionTicketKeysSdsApi : public SdsApi, public TlsSessionTicketKeysConfigProvider {
+public:
+  using SdsApi::SdsApi;
+
+  // SecretProvider
+  const Ssl::TlsSessionTicketKeysConfig* secret() const override {
+    return session_ticket_keys_secrets_.get();
+  }
+
+  Common::CallbackHandle* addUpdateCallback(std::function<void()> callback) override {
+    return update_callback_manager_.add(callback);
+  }
+
+protected:
+  // SdsApi
+  envoy::api::v2::auth::Secret::TypeCase secretType() const override {
+    return envoy::api::v2::auth::Secret::TypeCase::kSessionTicketKeys;
+  }
+  void setSecret(const envoy::api::v2::auth::Secret& secret) override;
+
+private:
+  Ssl::TlsSessionTicketKeysConfigPtr session_ticket_keys_secrets_;
+};
 
 } // namespace Secret
 } // namespace Envoy
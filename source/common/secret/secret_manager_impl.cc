@@ -34,6 +34,17 @@ void SecretManagerImpl::addStaticSecret(const envoy::api::v2::auth::Secret& secr
     }
     break;
   }
+  case envoy::api::v2::auth::Secret::TypeCase::kSessionTicketKeys: {
+    auto secret_provider =
+        std::make_shared<TlsSessionTicketKeysConfigProviderImpl>(secret.session_ticket_keys());
+    if (!static_session_ticket_keys_providers_
+             .insert(std::make_pair(secret.name(), secret_provider))
+             .second) {
+      throw EnvoyException(
+          fmt::format("Duplicate static TlsSessionTicketKeys secret name {}", secret.name()));
+    }
+    break;
+  }
   default:
     throw EnvoyException("Secret type not implemented");
   }
@@ -52,6 +63,12 @@ SecretManagerImpl::findStaticCertificateValidationContextProvider(const std::str
                                                                             : nullptr;
 }
 
+TlsSessionTicketKeysConfigProviderSharedPtr
+SecretManagerImpl::findStaticTlsSessionTicketKeysProvider(const std::string& name) const {
+  auto secret = static_session_ticket_keys_providers_.find(name);
+  return (secret != static_session_ticket_keys_providers_.end()) ? secret->second : nullptr;
+}
+
 TlsCertificateConfigProviderSharedPtr SecretManagerImpl::createInlineTlsCertificateProvider(
     const envoy::api::v2::auth::TlsCertificate& tls_certificate) {
   return std::make_shared<TlsCertificateConfigProviderImpl>(tls_certificate);
@@ -64,6 +81,12 @@ SecretManagerImpl::createInlineCertificateValidationContextProvider(
       certificate_validation_context);
 }
 
+TlsSessionTicketKeysConfigProviderSharedPtr
+SecretManagerImpl::createInlineTlsSessionTicketKeysProvider(
+    const envoy::api::v2::auth::TlsSessionTicketKeys& session_ticket_keys) {
+  return std::make_shared<TlsSessionTicketKeysConfigProviderImpl>(session_ticket_keys);
+}
+
 void SecretManagerImpl::removeDynamicSecretProvider(const std::string& map_key) {
   ENVOY_LOG(debug, "Unregister secret provider. hash key: {}", map_key);
 
@@ -71,6 +94,13 @@ void SecretManagerImpl::removeDynamicSecretProvider(const std::string& map_key)
   ASSERT(num_deleted == 1, "");
 }
 
+void SecretManagerImpl::removeDynamicSessionTicketKeysProvider(const std::string& map_key) {
+  ENVOY_LOG(debug, "Unregister session ticket keys provider. hash key: {}", map_key);
+
+  auto num_deleted = dynamic_session_ticket_keys_providers_.erase(map_key);
+  ASSERT(num_deleted == 1, "");
+}
+
 TlsCertificateConfigProviderSharedPtr SecretManagerImpl::findOrCreateTlsCertificateProvider(
     const envoy::api::v2::core::ConfigSource& sds_config_source, const std::string& config_name,
     Server::Configuration::TransportSocketFactoryContext& secret_provider_context) {
@@ -86,7 +116,7 @@ TlsCertificateConfigProviderSharedPtr SecretManagerImpl::findOrCreateTlsCertific
       removeDynamicSecretProvider(map_key);
     };
 
-    secret_provider = std::make_shared<SdsApi>(
+    secret_provider = std::make_shared<TlsCertificateSdsApi>(
         secret_provider_context.localInfo(), secret_provider_context.dispatcher(),
         secret_provider_context.random(), secret_provider_context.stats(),
         secret_provider_context.clusterManager(), *secret_provider_context.initManager(),
@@ -97,5 +127,31 @@ TlsCertificateConfigProviderSharedPtr SecretManagerImpl::findOrCreateTlsCertific
   return secret_provider;
 }
 
+TlsSessionTicketKeysConfigProviderSharedPtr
+SecretManagerImpl::findOrCreateTlsSessionTicketKeysProvider(
+    const envoy::api::v2::core::ConfigSource& sds_config_source, const std::string& config_name,
+    Server::Configuration::TransportSocketFactoryContext& secret_provider_context) {
+  const std::string map_key = sds_config_source.SerializeAsString() + config_name;
+
+  TlsSessionTicketKeysConfigProviderSharedPtr secret_provider =
+      dynamic_session_ticket_keys_providers_[map_key].lock();
+  if (!secret_provider) {
+    ASSERT(secret_provider_context.initManager() != nullptr);
+
+    std::function<void()> unregister_secret_provider = [map_key, this]() {
+      removeDynamicSessionTicketKeysProvider(map_key);
+    };
+
+    secret_provider = std::make_shared<TlsSessionTicketKeysSdsApi>(
+        secret_provider_context.localInfo(), secret_provider_context.dispatcher(),
+        secret_provider_context.random(), secret_provider_context.stats(),
+        secret_provider_context.clusterManager(), *secret_provider_context.initManager(),
+        sds_config_source, config_name, unregister_secret_provider);
+    dynamic_session_ticket_keys_providers_[map_key] = secret_provider;
+  }
+
+  return secret_provider;
+}
+
 } // namespace Secret
 } // namespace Envoy
@@ -7,6 +7,7 @@
 #include "envoy/server/transport_socket_config.h"
 #include "envoy/ssl/certificate_validation_context_config.h"
 #include "envoy/ssl/tls_certificate_config.h"
+#include "envoy/ssl/tls_session_ticket_keys_config.h"
 
 #include "common/common/logger.h"
 
@@ -23,6 +24,9 @@ public:
   CertificateValidationContextConfigProviderSharedPtr
   findStaticCertificateValidationContextProvider(const std::string& name) const override;
 
+  TlsSessionTicketKeysConfigProviderSharedPtr
+  findStaticTlsSessionTicketKeysProvider(const std::string& name) const override;
+
   TlsCertificateConfigProviderSharedPtr createInlineTlsCertificateProvider(
       const envoy::api::v2::auth::TlsCertificate& tls_certificate) override;
 
@@ -31,13 +35,21 @@ public:
       const envoy::api::v2::auth::CertificateValidationContext& certificate_validation_context)
       override;
 
+  TlsSessionTicketKeysConfigProviderSharedPtr createInlineTlsSessionTicketKeysProvider(
+      const envoy::api::v2::auth::TlsSessionTicketKeys& session_ticket_keys) override;
+
   TlsCertificateConfigProviderSharedPtr findOrCreateTlsCertificateProvider(
       const envoy::api::v2::core::ConfigSource& config_source, const std::string& config_name,
       Server::Configuration::TransportSocketFactoryContext& secret_provider_context) override;
 
+  TlsSessionTicketKeysConfigProviderSharedPtr findOrCreateTlsSessionTicketKeysProvider(
+      const envoy::api::v2::core::ConfigSource& config_source, const std::string& config_name,
+      Server::Configuration::TransportSocketFactoryContext& secret_provider_context) override;
+
 private:
   // Remove dynamic secret provider which has been deleted.
   void removeDynamicSecretProvider(const std::string& map_key);
+  void removeDynamicSessionTicketKeysProvider(const std::string& map_key);
 
   // Manages pairs of secret name and TlsCertificateConfigProviderSharedPtr.
   std::unordered_map<std::string, TlsCertificateConfigProviderSharedPtr>
@@ -47,9 +59,17 @@ private:
   std::unordered_map<std::string, CertificateValidationContextConfigProviderSharedPtr>
       static_certificate_validation_context_providers_;
 
+  // Manages pairs of secret name and TlsSessionTicketKeysConfigProviderSharedPtr.
+  std::unordered_map<std::string, TlsSessionTicketKeysConfigProviderSharedPtr>
+      static_session_ticket_keys_providers_;
+
   // map hash code of SDS config source and SdsApi object.
   std::unordered_map<std::string, std::weak_ptr<TlsCertificateConfigProvider>>
       dynamic_secret_providers_;
+
+  // map hash code of SDS config source and session ticket keys SdsApi object.
+  std::unordered_map<std::string, std::weak_ptr<TlsSessionTicketKeysConfigProvider>>
+      dynamic_session_ticket_keys_providers_;
 };
 
 } // namespace Secret
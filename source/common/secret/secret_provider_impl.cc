@@ -3,6 +3,7 @@
 #include "common/common/assert.h"
 #include "common/ssl/certificate_validation_context_config_impl.h"
 #include "common/ssl/tls_certificate_config_impl.h"
+#include "common/ssl/tls_session_ticket_keys_config_impl.h"
 
 namespace Envoy {
 namespace Secret {
@@ -16,5 +17,10 @@ CertificateValidationContextConfigProviderImpl::CertificateValidationContextConf
     : certificate_validation_context_(std::make_unique<Ssl::CertificateValidationContextConfigImpl>(
           certificate_validation_context)) {}
 
+TlsSessionTicketKeysConfigProviderImpl::TlsSessionTicketKeysConfigProviderImpl(
+    const envoy::api::v2::auth::TlsSessionTicketKeys& session_ticket_keys)
+    : session_ticket_keys_(
+          std::make_unique<Ssl::TlsSessionTicketKeysConfigImpl>(session_ticket_keys)) {}
+
 } // namespace Secret
 } // namespace Envoy
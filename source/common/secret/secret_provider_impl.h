@@ -6,6 +6,7 @@
 #include "envoy/secret/secret_provider.h"
 #include "envoy/ssl/certificate_validation_context_config.h"
 #include "envoy/ssl/tls_certificate_config.h"
+#include "envoy/ssl/tls_session_ticket_keys_config.h"
 
 namespace Envoy {
 namespace Secret {
@@ -38,5 +39,20 @@ private:
   Ssl::CertificateValidationContextConfigPtr certificate_validation_context_;
 };
 
+class TlsSessionTicketKeysConfigProviderImpl : public TlsSessionTicketKeysConfigProvider {
+public:
+  TlsSessionTicketKeysConfigProviderImpl(
+      const envoy::api::v2::auth::TlsSessionTicketKeys& session_ticket_keys);
+
+  const Ssl::TlsSessionTicketKeysConfig* secret() const override {
+    return session_ticket_keys_.get();
+  }
+
+  Common::CallbackHandle* addUpdateCallback(std::function<void()>) override { return nullptr; }
+
+private:
+  Ssl::TlsSessionTicketKeysConfigPtr session_ticket_keys_;
+};
+
 } // namespace Secret
 } // namespace Envoy
@@ -0,0 +1,70 @@
+#include "common/ssl/certificate_matcher.h"
+
+#include "openssl/sha.h"
+#include "openssl/x509v3.h"
+
+namespace Envoy {
+namespace Ssl {
+
+namespace {
+absl::string_view asn1StringView(ASN1_STRING* str) {
+  return {reinterpret_cast<const char*>(ASN1_STRING_data(str)),
+          static_cast<size_t>(ASN1_STRING_length(str))};
+}
+} // namespace
+
+SubjectAltNameMatcher::SubjectAltNameMatcher(const std::vector<std::string>& subject_alt_names)
+    : names_(subject_alt_names.begin(), subject_alt_names.end()) {
+  for (const std::string& name : names_) {
+    for (size_t pos = name.find('.', 1); pos != std::string::npos; pos = name.find('.', pos + 1)) {
+      wildcard_suffixes_.insert(name.substr(pos));
+    }
+  }
+}
+
+bool SubjectAltNameMatcher::matches(X509* cert) const {
+  bssl::UniquePtr<GENERAL_NAMES> san_names(
+      static_cast<GENERAL_NAMES*>(X509_get_ext_d2i(cert, NID_subject_alt_name, nullptr, nullptr)));
+  if (san_names == nullptr) {
+    return false;
+  }
+  for (const GENERAL_NAME* san : san_names.get()) {
+    if (san->type == GEN_DNS) {
+      if (matchesDnsName(asn1StringView(san->d.dNSName))) {
+        return true;
+      }
+    } else if (san->type == GEN_URI) {
+      if (matchesUri(asn1StringView(san->d.uniformResourceIdentifier))) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool SubjectAltNameMatcher::matchesDnsName(absl::string_view pattern) const {
+  if (names_.count(std::string(pattern)) > 0) {
+    return true;
+  }
+  if (pattern.size() > 1 && pattern[0] == '*' && pattern[1] == '.') {
+    return wildcard_suffixes_.count(std::string(pattern.substr(1))) > 0;
+  }
+  return false;
+}
+
+bool SubjectAltNameMatcher::matchesUri(absl::string_view uri) const {
+  return names_.count(std::string(uri)) > 0;
+}
+
+CertificateHashSet::CertificateHashSet(const std::vector<std::vector<uint8_t>>& hashes) {
+  for (const auto& hash : hashes) {
+    hashes_.emplace(hash.begin(), hash.end());
+  }
+}
+
+bool CertificateHashSet::contains(const uint8_t* hash) const {
+  return hashes_.count(std::string(reinterpret_cast<const char*>(hash), SHA256_DIGEST_LENGTH)) > 0;
+}
+
+} // namespace Ssl
+} // namespace Envoy
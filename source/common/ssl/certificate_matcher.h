@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Matches the subjectAltNames of peer certificates against the configured names. The names are
+ * indexed once, when the context is created, so that a handshake costs a lookup per name in the
+ * certificate rather than a scan of the configured names.
+ */
+class SubjectAltNameMatcher {
+public:
+  /**
+   * @param subject_alt_names supplies the configured DNS names and URIs.
+   */
+  explicit SubjectAltNameMatcher(const std::vector<std::string>& subject_alt_names);
+
+  /**
+   * @return true if a DNS or URI subjectAltName of cert matches one of the configured names.
+   */
+  bool matches(X509* cert) const;
+
+  /**
+   * @return true if a configured name matches the DNS name pattern of a certificate, which may
+   *         begin with a wildcard (*.example.com). The wildcard matches one or more labels.
+   */
+  bool matchesDnsName(absl::string_view pattern) const;
+
+  /**
+   * @return true if the URI of a certificate is one of the configured names.
+   */
+  bool matchesUri(absl::string_view uri) const;
+
+private:
+  std::unordered_set<std::string> names_;
+  // For each configured name, every suffix that starts at a dot after its first character. A
+  // wildcard pattern *.example.com matches if .example.com is one of them.
+  std::unordered_set<std::string> wildcard_suffixes_;
+};
+
+/**
+ * Set of SHA-256 digests that peer certificates are pinned to.
+ */
+class CertificateHashSet {
+public:
+  explicit CertificateHashSet(const std::vector<std::vector<uint8_t>>& hashes);
+
+  bool empty() const { return hashes_.empty(); }
+
+  /**
+   * @return true if the SHA-256 digest is in the set.
+   */
+  bool contains(const uint8_t* hash) const;
+
+private:
+  std::unordered_set<std::string> hashes_;
+};
+
+} // namespace Ssl
+} // namespace Envoy
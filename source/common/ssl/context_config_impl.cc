@@ -70,6 +70,48 @@ getCertificateValidationContextConfigProvider(
   return nullptr;
 }
 
+absl::optional<DynamicRecordSizing>
+getDynamicRecordSizing(const envoy::api::v2::auth::CommonTlsContext& config) {
+  if (!config.has_dynamic_record_sizing()) {
+    return absl::nullopt;
+  }
+  const auto& sizing = config.dynamic_record_sizing();
+  return DynamicRecordSizing{
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(sizing, small_record_size, 0),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(sizing, ramp_up_bytes, 65536),
+      std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(sizing, idle_timeout, 1000))};
+}
+
+Secret::TlsSessionTicketKeysConfigProviderSharedPtr getTlsSessionTicketKeysConfigProvider(
+    const envoy::api::v2::auth::DownstreamTlsContext& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context) {
+  switch (config.session_ticket_keys_type_case()) {
+  case envoy::api::v2::auth::DownstreamTlsContext::kSessionTicketKeys:
+    return factory_context.secretManager().createInlineTlsSessionTicketKeysProvider(
+        config.session_ticket_keys());
+  case envoy::api::v2::auth::DownstreamTlsContext::kSessionTicketKeysSdsSecretConfig: {
+    const auto& sds_secret_config = config.session_ticket_keys_sds_secret_config();
+    if (!sds_secret_config.has_sds_config()) {
+      // static secret
+      auto secret_provider = factory_context.secretManager().findStaticTlsSessionTicketKeysProvider(
+          sds_secret_config.name());
+      if (!secret_provider) {
+        throw EnvoyException(
+            fmt::format("Unknown static session ticket keys: {}", sds_secret_config.name()));
+      }
+      return secret_provider;
+    }
+    return factory_context.secretManager().findOrCreateTlsSessionTicketKeysProvider(
+        sds_secret_config.sds_config(), sds_secret_config.name(), factory_context);
+  }
+  case envoy::api::v2::auth::DownstreamTlsContext::SESSION_TICKET_KEYS_TYPE_NOT_SET:
+    return nullptr;
+  default:
+    throw EnvoyException(fmt::format("Unexpected case for oneof session_ticket_keys: {}",
+                                     config.session_ticket_keys_type_case()));
+  }
+}
+
 } // namespace
 
 const std::string ContextConfigImpl::DEFAULT_CIPHER_SUITES =
@@ -104,7 +146,17 @@ ContextConfigImpl::ContextConfigImpl(
       min_protocol_version_(
           tlsVersionFromProto(config.tls_params().tls_minimum_protocol_version(), TLS1_VERSION)),
       max_protocol_version_(tlsVersionFromProto(config.tls_params().tls_maximum_protocol_version(),
-                                                TLS1_2_VERSION)) {}
+                                                TLS1_2_VERSION)),
+      kernel_tls_offload_(config.kernel_tls_offload()),
+      dynamic_record_sizing_(getDynamicRecordSizing(config)),
+      dynamic_tls_certificate_(!config.tls_certificate_sds_secret_configs().empty() &&
+                               config.tls_certificate_sds_secret_configs(0).has_sds_config()) {
+#ifndef __linux__
+  if (kernel_tls_offload_) {
+    throw EnvoyException("Kernel TLS offload is only supported on Linux");
+  }
+#endif
+}
 
 ContextConfigImpl::~ContextConfigImpl() {
   if (secret_update_callback_handle_) {
@@ -166,27 +218,12 @@ ServerContextConfigImpl::ServerContextConfigImpl(
     : ContextConfigImpl(config.common_tls_context(), factory_context),
       require_client_certificate_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, require_client_certificate, false)),
-      session_ticket_keys_([&config] {
-        std::vector<SessionTicketKey> ret;
-
-        switch (config.session_ticket_keys_type_case()) {
-        case envoy::api::v2::auth::DownstreamTlsContext::kSessionTicketKeys:
-          for (const auto& datasource : config.session_ticket_keys().keys()) {
-            validateAndAppendKey(ret, Config::DataSource::read(datasource, false));
-          }
-          break;
-        case envoy::api::v2::auth::DownstreamTlsContext::kSessionTicketKeysSdsSecretConfig:
-          throw EnvoyException("SDS not supported yet");
-          break;
-        case envoy::api::v2::auth::DownstreamTlsContext::SESSION_TICKET_KEYS_TYPE_NOT_SET:
-          break;
-        default:
-          throw EnvoyException(fmt::format("Unexpected case for oneof session_ticket_keys: {}",
-                                           config.session_ticket_keys_type_case()));
-        }
-
-        return ret;
-      }()) {
+      session_ticket_keys_provider_(
+          getTlsSessionTicketKeysConfigProvider(config, factory_context)),
+      session_ticket_keys_update_callback_handle_(nullptr),
+      dynamic_session_ticket_keys_(
+          config.has_session_ticket_keys_sds_secret_config() &&
+          config.session_ticket_keys_sds_secret_config().has_sds_config()) {
   // TODO(PiotrSikora): Support multiple TLS certificates.
   if ((config.common_tls_context().tls_certificates().size() +
        config.common_tls_context().tls_certificate_sds_secret_configs().size()) == 0) {
@@ -197,6 +234,32 @@ ServerContextConfigImpl::ServerContextConfigImpl(
   }
 }
 
+ServerContextConfigImpl::~ServerContextConfigImpl() {
+  if (session_ticket_keys_update_callback_handle_) {
+    session_ticket_keys_update_callback_handle_->remove();
+  }
+}
+
+const std::vector<ServerContextConfig::SessionTicketKey>&
+ServerContextConfigImpl::sessionTicketKeys() const {
+  static const std::vector<SessionTicketKey> no_keys;
+  if (session_ticket_keys_provider_ == nullptr ||
+      session_ticket_keys_provider_->secret() == nullptr) {
+    return no_keys;
+  }
+  return session_ticket_keys_provider_->secret()->keys();
+}
+
+void ServerContextConfigImpl::setSessionTicketKeysUpdateCallback(std::function<void()> callback) {
+  if (session_ticket_keys_provider_) {
+    if (session_ticket_keys_update_callback_handle_) {
+      session_ticket_keys_update_callback_handle_->remove();
+    }
+    session_ticket_keys_update_callback_handle_ =
+        session_ticket_keys_provider_->addUpdateCallback(callback);
+  }
+}
+
 ServerContextConfigImpl::ServerContextConfigImpl(
     const Json::Object& config,
     Server::Configuration::TransportSocketFactoryContext& factory_context)
@@ -208,32 +271,5 @@ ServerContextConfigImpl::ServerContextConfigImpl(
           }(),
           factory_context) {}
 
-// Append a SessionTicketKey to keys, initializing it with key_data.
-// Throws if key_data is invalid.
-void ServerContextConfigImpl::validateAndAppendKey(
-    std::vector<ServerContextConfig::SessionTicketKey>& keys, const std::string& key_data) {
-  // If this changes, need to figure out how to deal with key files
-  // that previously worked. For now, just assert so we'll notice that
-  // it changed if it does.
-  static_assert(sizeof(SessionTicketKey) == 80, "Input is expected to be this size");
-
-  if (key_data.size() != sizeof(SessionTicketKey)) {
-    throw EnvoyException(fmt::format("Incorrect TLS session ticket key length. "
-                                     "Length {}, expected length {}.",
-                                     key_data.size(), sizeof(SessionTicketKey)));
-  }
-
-  keys.emplace_back();
-  SessionTicketKey& dst_key = keys.back();
-
-  std::copy_n(key_data.begin(), dst_key.name_.size(), dst_key.name_.begin());
-  size_t pos = dst_key.name_.size();
-  std::copy_n(key_data.begin() + pos, dst_key.hmac_key_.size(), dst_key.hmac_key_.begin());
-  pos += dst_key.hmac_key_.size();
-  std::copy_n(key_data.begin() + pos, dst_key.aes_key_.size(), dst_key.aes_key_.begin());
-  pos += dst_key.aes_key_.size();
-  ASSERT(key_data.begin() + pos == key_data.end());
-}
-
 } // namespace Ssl
 } // namespace Envoy
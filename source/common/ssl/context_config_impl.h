@@ -36,12 +36,17 @@ public:
   }
   unsigned minProtocolVersion() const override { return min_protocol_version_; };
   unsigned maxProtocolVersion() const override { return max_protocol_version_; };
+  bool kernelTlsOffload() const override { return kernel_tls_offload_; }
+  const absl::optional<DynamicRecordSizing>& dynamicRecordSizing() const override {
+    return dynamic_record_sizing_;
+  }
 
   bool isReady() const override {
     // Either tls_certficate_provider_ is nullptr or
     // tls_certficate_provider_->secret() is NOT nullptr.
     return !tls_certficate_provider_ || tls_certficate_provider_->secret() != nullptr;
   }
+  bool hasDynamicSecrets() const override { return dynamic_tls_certificate_; }
 
   void setSecretUpdateCallback(std::function<void()> callback) override {
     if (tls_certficate_provider_) {
@@ -74,6 +79,9 @@ private:
       certficate_validation_context_provider_;
   const unsigned min_protocol_version_;
   const unsigned max_protocol_version_;
+  const bool kernel_tls_offload_;
+  const absl::optional<DynamicRecordSizing> dynamic_record_sizing_;
+  const bool dynamic_tls_certificate_;
 };
 
 class ClientContextConfigImpl : public ContextConfigImpl, public ClientContextConfig {
@@ -103,18 +111,29 @@ public:
       const Json::Object& config,
       Server::Configuration::TransportSocketFactoryContext& secret_provider_context);
 
+  ~ServerContextConfigImpl() override;
+
+  // Ssl::ContextConfig
+  bool isReady() const override {
+    // Session ticket keys from SDS must have arrived too, so that the context encrypts tickets
+    // with them from the start.
+    return ContextConfigImpl::isReady() && (!session_ticket_keys_provider_ ||
+                                            session_ticket_keys_provider_->secret() != nullptr);
+  }
+  bool hasDynamicSecrets() const override {
+    return ContextConfigImpl::hasDynamicSecrets() || dynamic_session_ticket_keys_;
+  }
+
   // Ssl::ServerContextConfig
   bool requireClientCertificate() const override { return require_client_certificate_; }
-  const std::vector<SessionTicketKey>& sessionTicketKeys() const override {
-    return session_ticket_keys_;
-  }
+  const std::vector<SessionTicketKey>& sessionTicketKeys() const override;
+  void setSessionTicketKeysUpdateCallback(std::function<void()> callback) override;
 
 private:
   const bool require_client_certificate_;
-  const std::vector<SessionTicketKey> session_ticket_keys_;
-
-  static void validateAndAppendKey(std::vector<ServerContextConfig::SessionTicketKey>& keys,
-                                   const std::string& key_data);
+  Secret::TlsSessionTicketKeysConfigProviderSharedPtr session_ticket_keys_provider_;
+  Common::CallbackHandle* session_ticket_keys_update_callback_handle_;
+  const bool dynamic_session_ticket_keys_;
 };
 
 } // namespace Ssl
@@ -1,6 +1,7 @@
 #include "common/ssl/context_impl.h"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -16,6 +17,8 @@
 #include "common/common/utility.h"
 #include "common/ssl/utility.h"
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "openssl/hmac.h"
 #include "openssl/rand.h"
 #include "openssl/x509v3.h"
@@ -32,7 +35,9 @@ int ContextImpl::sslContextIndex() {
 }
 
 ContextImpl::ContextImpl(Stats::Scope& scope, const ContextConfig& config)
-    : ctx_(SSL_CTX_new(TLS_method())), scope_(scope), stats_(generateStats(scope)) {
+    : ctx_(SSL_CTX_new(TLS_method())), scope_(scope), stats_(generateStats(scope)),
+      kernel_tls_offload_(config.kernelTlsOffload()),
+      dynamic_record_sizing_(config.dynamicRecordSizing()) {
   RELEASE_ASSERT(ctx_, "");
 
   int rc = SSL_CTX_set_ex_data(ctx_.get(), sslContextIndex(), this);
@@ -171,6 +176,17 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const ContextConfig& config)
     verify_mode = SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT;
   }
 
+  if (!verify_subject_alt_name_list_.empty()) {
+    subject_alt_name_matcher_ =
+        std::make_unique<SubjectAltNameMatcher>(verify_subject_alt_name_list_);
+  }
+  if (!verify_certificate_hash_list_.empty()) {
+    certificate_hash_set_ = std::make_unique<CertificateHashSet>(verify_certificate_hash_list_);
+  }
+  if (!verify_certificate_spki_list_.empty()) {
+    certificate_spki_set_ = std::make_unique<CertificateHashSet>(verify_certificate_spki_list_);
+  }
+
   if (verify_mode != SSL_VERIFY_NONE) {
     SSL_CTX_set_verify(ctx_.get(), verify_mode, nullptr);
     SSL_CTX_set_cert_verify_callback(ctx_.get(), ContextImpl::verifyCallback, this);
@@ -278,6 +294,17 @@ bssl::UniquePtr<SSL> ContextImpl::newSsl() const {
   return bssl::UniquePtr<SSL>(SSL_new(ctx_.get()));
 }
 
+PrivateKeyOperationsPtr
+ContextImpl::newPrivateKeyOperations(Network::Connection& connection,
+                                     std::function<void()> on_complete) const {
+  if (private_key_thread_pool_ == nullptr) {
+    return nullptr;
+  }
+  return std::make_unique<PrivateKeyOperations>(*private_key_thread_pool_,
+                                                SSL_CTX_get0_privatekey(ctx_.get()),
+                                                connection.dispatcher(), on_complete);
+}
+
 int ContextImpl::ignoreCertificateExpirationCallback(int ok, X509_STORE_CTX* ctx) {
   if (!ok) {
     int err = X509_STORE_CTX_get_error(ctx);
@@ -307,19 +334,17 @@ int ContextImpl::verifyCallback(X509_STORE_CTX* store_ctx, void* arg) {
 }
 
 int ContextImpl::verifyCertificate(X509* cert) {
-  if (!verify_subject_alt_name_list_.empty() &&
-      !verifySubjectAltName(cert, verify_subject_alt_name_list_)) {
+  if (subject_alt_name_matcher_ != nullptr && !subject_alt_name_matcher_->matches(cert)) {
     stats_.fail_verify_san_.inc();
     return 0;
   }
 
-  if (!verify_certificate_hash_list_.empty() || !verify_certificate_spki_list_.empty()) {
+  if (certificate_hash_set_ != nullptr || certificate_spki_set_ != nullptr) {
     const bool valid_certificate_hash =
-        !verify_certificate_hash_list_.empty() &&
-        verifyCertificateHashList(cert, verify_certificate_hash_list_);
-    const bool valid_certificate_spki =
-        !verify_certificate_spki_list_.empty() &&
-        verifyCertificateSpkiList(cert, verify_certificate_spki_list_);
+        certificate_hash_set_ != nullptr && verifyCertificateHash(cert, *certificate_hash_set_);
+    const bool valid_certificate_spki = certificate_spki_set_ != nullptr &&
+                                        !valid_certificate_hash &&
+                                        verifyCertificateSpki(cert, *certificate_spki_set_);
 
     if (!valid_certificate_hash && !valid_certificate_spki) {
       stats_.fail_verify_cert_hash_.inc();
@@ -348,31 +373,7 @@ void ContextImpl::logHandshake(SSL* ssl) const {
 
 bool ContextImpl::verifySubjectAltName(X509* cert,
                                        const std::vector<std::string>& subject_alt_names) {
-  bssl::UniquePtr<GENERAL_NAMES> san_names(
-      static_cast<GENERAL_NAMES*>(X509_get_ext_d2i(cert, NID_subject_alt_name, nullptr, nullptr)));
-  if (san_names == nullptr) {
-    return false;
-  }
-  for (const GENERAL_NAME* san : san_names.get()) {
-    if (san->type == GEN_DNS) {
-      ASN1_STRING* str = san->d.dNSName;
-      const char* dns_name = reinterpret_cast<const char*>(ASN1_STRING_data(str));
-      for (auto& config_san : subject_alt_names) {
-        if (dNSNameMatch(config_san, dns_name)) {
-          return true;
-        }
-      }
-    } else if (san->type == GEN_URI) {
-      ASN1_STRING* str = san->d.uniformResourceIdentifier;
-      const char* uri = reinterpret_cast<const char*>(ASN1_STRING_data(str));
-      for (auto& config_san : subject_alt_names) {
-        if (config_san.compare(uri) == 0) {
-          return true;
-        }
-      }
-    }
-  }
-  return false;
+  return SubjectAltNameMatcher(subject_alt_names).matches(cert);
 }
 
 bool ContextImpl::dNSNameMatch(const std::string& dNSName, const char* pattern) {
@@ -391,23 +392,15 @@ bool ContextImpl::dNSNameMatch(const std::string& dNSName, const char* pattern)
   return false;
 }
 
-bool ContextImpl::verifyCertificateHashList(
-    X509* cert, const std::vector<std::vector<uint8_t>>& expected_hashes) {
-  std::vector<uint8_t> computed_hash(SHA256_DIGEST_LENGTH);
+bool ContextImpl::verifyCertificateHash(X509* cert, const CertificateHashSet& expected_hashes) {
+  uint8_t computed_hash[SHA256_DIGEST_LENGTH];
   unsigned int n;
-  X509_digest(cert, EVP_sha256(), computed_hash.data(), &n);
-  RELEASE_ASSERT(n == computed_hash.size(), "");
-
-  for (const auto& expected_hash : expected_hashes) {
-    if (computed_hash == expected_hash) {
-      return true;
-    }
-  }
-  return false;
+  X509_digest(cert, EVP_sha256(), computed_hash, &n);
+  RELEASE_ASSERT(n == SHA256_DIGEST_LENGTH, "");
+  return expected_hashes.contains(computed_hash);
 }
 
-bool ContextImpl::verifyCertificateSpkiList(
-    X509* cert, const std::vector<std::vector<uint8_t>>& expected_hashes) {
+bool ContextImpl::verifyCertificateSpki(X509* cert, const CertificateHashSet& expected_hashes) {
   X509_PUBKEY* pubkey = X509_get_X509_PUBKEY(cert);
   if (pubkey == nullptr) {
     return false;
@@ -419,15 +412,9 @@ bool ContextImpl::verifyCertificateSpkiList(
   }
   bssl::UniquePtr<uint8_t> free_spki(spki);
 
-  std::vector<uint8_t> computed_hash(SHA256_DIGEST_LENGTH);
-  SHA256(spki, len, computed_hash.data());
-
-  for (const auto& expected_hash : expected_hashes) {
-    if (computed_hash == expected_hash) {
-      return true;
-    }
-  }
-  return false;
+  uint8_t computed_hash[SHA256_DIGEST_LENGTH];
+  SHA256(spki, len, computed_hash);
+  return expected_hashes.contains(computed_hash);
 }
 
 SslStats ContextImpl::generateStats(Stats::Scope& store) {
@@ -476,14 +463,75 @@ std::string ContextImpl::getCertChainInformation() const {
                      getDaysUntilExpiration(cert_chain_.get()));
 }
 
-ClientContextImpl::ClientContextImpl(Stats::Scope& scope, const ClientContextConfig& config)
-    : ContextImpl(scope, config), server_name_indication_(config.serverNameIndication()),
+namespace {
+
+std::string nextClientSessionCacheKeyPrefix() {
+  static std::atomic<uint64_t> next_context_id;
+  return fmt::format("client:{}:", next_context_id++);
+}
+
+const char ServerSessionCacheKeyPrefix[] = "server:";
+
+std::string serverSessionCacheKey(const uint8_t* id, size_t id_len) {
+  return absl::StrCat(ServerSessionCacheKeyPrefix,
+                      absl::string_view(reinterpret_cast<const char*>(id), id_len));
+}
+
+} // namespace
+
+ClientContextImpl::ClientContextImpl(Stats::Scope& scope, const ClientContextConfig& config,
+                                     SessionCache* session_cache)
+    : ContextImpl(scope, config), session_cache_key_prefix_(nextClientSessionCacheKeyPrefix()),
+      server_name_indication_(config.serverNameIndication()),
       allow_renegotiation_(config.allowRenegotiation()) {
   if (!parsed_alpn_protocols_.empty()) {
     int rc = SSL_CTX_set_alpn_protos(ctx_.get(), &parsed_alpn_protocols_[0],
                                      parsed_alpn_protocols_.size());
     RELEASE_ASSERT(rc == 0, "");
   }
+
+  if (session_cache != nullptr) {
+    session_cache_ = session_cache;
+    SSL_CTX_set_session_cache_mode(ctx_.get(), SSL_SESS_CACHE_CLIENT);
+    SSL_CTX_sess_set_new_cb(ctx_.get(), [](SSL* ssl, SSL_SESSION* session) -> int {
+      const std::string* key =
+          static_cast<const std::string*>(SSL_get_ex_data(ssl, sslSessionCacheKeyIndex()));
+      if (key != nullptr) {
+        ContextImpl* context_impl = static_cast<ContextImpl*>(
+            SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), sslContextIndex()));
+        static_cast<ClientContextImpl*>(context_impl)->session_cache_->insert(*key, session);
+      }
+      // The cache took its own reference.
+      return 0;
+    });
+  }
+}
+
+int ClientContextImpl::sslSessionCacheKeyIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() -> int {
+    int ssl_index = SSL_get_ex_new_index(
+        0, nullptr, nullptr, nullptr,
+        [](void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*) -> void {
+          delete static_cast<std::string*>(ptr);
+        });
+    RELEASE_ASSERT(ssl_index >= 0, "");
+    return ssl_index;
+  }());
+}
+
+void ClientContextImpl::resumeSession(SSL* ssl, const Network::Connection& connection) const {
+  if (session_cache_ == nullptr) {
+    return;
+  }
+
+  // Only resume sessions with the upstream host that issued them.
+  std::string* key =
+      new std::string(session_cache_key_prefix_ + connection.remoteAddress()->asString());
+  SSL_set_ex_data(ssl, sslSessionCacheKeyIndex(), key);
+  bssl::UniquePtr<SSL_SESSION> session = session_cache_->lookup(*key);
+  if (session != nullptr) {
+    SSL_set_session(ssl, session.get());
+  }
 }
 
 bssl::UniquePtr<SSL> ClientContextImpl::newSsl() const {
@@ -503,12 +551,19 @@ bssl::UniquePtr<SSL> ClientContextImpl::newSsl() const {
 
 ServerContextImpl::ServerContextImpl(Stats::Scope& scope, const ServerContextConfig& config,
                                      const std::vector<std::string>& server_names,
-                                     Runtime::Loader& runtime)
+                                     Runtime::Loader& runtime,
+                                     PrivateKeyThreadPool* private_key_thread_pool,
+                                     SessionCache* session_cache)
     : ContextImpl(scope, config), runtime_(runtime),
       session_ticket_keys_(config.sessionTicketKeys()) {
   if (config.tlsCertificate() == nullptr) {
     throw EnvoyException("Server TlsCertificates must have a certificate specified");
   }
+  if (private_key_thread_pool != nullptr) {
+    // Signing and decrypting with the loaded key then happen on the pool, see SslSocket.
+    private_key_thread_pool_ = private_key_thread_pool;
+    SSL_CTX_set_private_key_method(ctx_.get(), &PrivateKeyOperations::privateKeyMethod());
+  }
   if (config.certificateValidationContext() != nullptr &&
       !config.certificateValidationContext()->caCert().empty()) {
     bssl::UniquePtr<BIO> bio(
@@ -567,7 +622,7 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope, const ServerContextCon
                                this);
   }
 
-  if (!session_ticket_keys_.empty()) {
+  if (!config.sessionTicketKeys().empty()) {
     SSL_CTX_set_tlsext_ticket_key_cb(
         ctx_.get(),
         [](SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx,
@@ -581,6 +636,28 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope, const ServerContextCon
         });
   }
 
+  if (session_cache != nullptr) {
+    // Sessions are only resumed with a matching session ID context, which is set below.
+    session_cache_ = session_cache;
+    SSL_CTX_set_session_cache_mode(ctx_.get(), SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+    SSL_CTX_sess_set_new_cb(ctx_.get(), [](SSL* ssl, SSL_SESSION* session) -> int {
+      fromSslCtx(SSL_get_SSL_CTX(ssl)).session_cache_->insert(sessionCacheKey(session), session);
+      // The cache took its own reference.
+      return 0;
+    });
+    SSL_CTX_sess_set_get_cb(
+        ctx_.get(), [](SSL* ssl, const uint8_t* id, int id_len, int* out_copy) -> SSL_SESSION* {
+          // The returned reference is handed over to BoringSSL.
+          *out_copy = 0;
+          return fromSslCtx(SSL_get_SSL_CTX(ssl))
+              .session_cache_->lookup(serverSessionCacheKey(id, id_len))
+              .release();
+        });
+    SSL_CTX_sess_set_remove_cb(ctx_.get(), [](SSL_CTX* ctx, SSL_SESSION* session) -> void {
+      fromSslCtx(ctx).session_cache_->remove(sessionCacheKey(session));
+    });
+  }
+
   uint8_t session_context_buf[EVP_MAX_MD_SIZE] = {};
   unsigned session_context_len = 0;
   EVP_MD_CTX md;
@@ -670,10 +747,49 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope, const ServerContextCon
   RELEASE_ASSERT(rc == 1, "");
 }
 
+ServerContextImpl& ServerContextImpl::fromSslCtx(SSL_CTX* ctx) {
+  ServerContextImpl* server_context_impl = dynamic_cast<ServerContextImpl*>(
+      static_cast<ContextImpl*>(SSL_CTX_get_ex_data(ctx, sslContextIndex())));
+  RELEASE_ASSERT(server_context_impl != nullptr, "");
+  return *server_context_impl;
+}
+
+std::string ServerContextImpl::sessionCacheKey(const SSL_SESSION* session) {
+  unsigned id_len;
+  const uint8_t* id = SSL_SESSION_get_id(session, &id_len);
+  return serverSessionCacheKey(id, id_len);
+}
+
+bool ServerContextImpl::isSessionCacheKey(const std::string& key) {
+  return absl::StartsWith(key, ServerSessionCacheKeyPrefix);
+}
+
+void ServerContextImpl::updateSessionTicketKeys(
+    const std::vector<ServerContextConfig::SessionTicketKey>& keys) {
+  if (keys.empty()) {
+    return;
+  }
+
+  absl::WriterMutexLock lock(&session_ticket_keys_mutex_);
+  previous_session_ticket_keys_.clear();
+  for (const ServerContextConfig::SessionTicketKey& key : session_ticket_keys_) {
+    const bool kept = std::any_of(
+        keys.begin(), keys.end(),
+        [&key](const ServerContextConfig::SessionTicketKey& new_key) -> bool {
+          return new_key.name_ == key.name_;
+        });
+    if (!kept) {
+      previous_session_ticket_keys_.push_back(key);
+    }
+  }
+  session_ticket_keys_ = keys;
+}
+
 int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv,
                                             EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx, int encrypt) {
   const EVP_MD* hmac = EVP_sha256();
   const EVP_CIPHER* cipher = EVP_aes_256_cbc();
+  absl::ReaderMutexLock lock(&session_ticket_keys_mutex_);
 
   if (encrypt == 1) {
     // Encrypt
@@ -705,17 +821,21 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
     return 1; // success
   } else {
     // Decrypt
+    const auto init_decrypt = [&](const ServerContextConfig::SessionTicketKey& key) -> bool {
+      if (!HMAC_Init_ex(hmac_ctx, key.hmac_key_.data(), key.hmac_key_.size(), hmac, nullptr)) {
+        return false;
+      }
+
+      RELEASE_ASSERT(key.aes_key_.size() == EVP_CIPHER_key_length(cipher), "");
+      return EVP_DecryptInit_ex(ctx, cipher, nullptr, key.aes_key_.data(), iv);
+    };
+
     bool is_enc_key = true; // first element is the encryption key
     for (const ServerContextConfig::SessionTicketKey& key : session_ticket_keys_) {
       static_assert(std::tuple_size<decltype(key.name_)>::value == SSL_TICKET_KEY_NAME_LEN,
                     "Expected key.name length");
       if (std::equal(key.name_.begin(), key.name_.end(), key_name)) {
-        if (!HMAC_Init_ex(hmac_ctx, key.hmac_key_.data(), key.hmac_key_.size(), hmac, nullptr)) {
-          return -1;
-        }
-
-        RELEASE_ASSERT(key.aes_key_.size() == EVP_CIPHER_key_length(cipher), "");
-        if (!EVP_DecryptInit_ex(ctx, cipher, nullptr, key.aes_key_.data(), iv)) {
+        if (!init_decrypt(key)) {
           return -1;
         }
 
@@ -726,6 +846,13 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
       is_enc_key = false;
     }
 
+    // Tickets of keys rotated out by the last update are still accepted, but renewed.
+    for (const ServerContextConfig::SessionTicketKey& key : previous_session_ticket_keys_) {
+      if (std::equal(key.name_.begin(), key.name_.end(), key_name)) {
+        return init_decrypt(key) ? 2 : -1;
+      }
+    }
+
     return 0; // decryption failed
   }
 }
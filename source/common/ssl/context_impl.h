@@ -3,15 +3,21 @@
 #include <string>
 #include <vector>
 
+#include "envoy/network/connection.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/ssl/context.h"
 #include "envoy/ssl/context_config.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 
+#include "common/common/thread_annotations.h"
+#include "common/ssl/certificate_matcher.h"
 #include "common/ssl/context_impl.h"
 #include "common/ssl/context_manager_impl.h"
+#include "common/ssl/private_key_operations.h"
+#include "common/ssl/session_cache.h"
 
+#include "absl/synchronization/mutex.h"
 #include "openssl/ssl.h"
 
 namespace Envoy {
@@ -30,7 +36,8 @@ namespace Ssl {
   COUNTER(fail_verify_no_cert)                                                                     \
   COUNTER(fail_verify_error)                                                                       \
   COUNTER(fail_verify_san)                                                                         \
-  COUNTER(fail_verify_cert_hash)
+  COUNTER(fail_verify_cert_hash)                                                                   \
+  COUNTER(kernel_tls_offload)
 // clang-format on
 
 /**
@@ -67,6 +74,38 @@ public:
    */
   static bool dNSNameMatch(const std::string& dnsName, const char* pattern);
 
+  /**
+   * @return PrivateKeyOperationsPtr the operations that run the private key operations of a
+   *         connection on the context's private key thread pool, or nullptr if the context runs
+   *         them inline.
+   * @param connection supplies the connection, on whose dispatcher on_complete is run.
+   * @param on_complete supplies the callback run when an operation completed.
+   */
+  PrivateKeyOperationsPtr newPrivateKeyOperations(Network::Connection& connection,
+                                                  std::function<void()> on_complete) const;
+
+  /**
+   * Resume a session of an earlier connection to the same peer, and store the sessions of this
+   * connection for later ones, if the context has a session cache. Only client contexts resume
+   * sessions this way; servers look sessions up by the ID the client offers.
+   * @param ssl supplies the connection's SSL.
+   * @param connection supplies the connection.
+   */
+  virtual void resumeSession(SSL*, const Network::Connection&) const {}
+
+  /**
+   * @return bool whether connections should hand the encryption of the records they send to the
+   *         kernel once their handshake completed. @see KernelTls::enableTransmit().
+   */
+  bool kernelTlsOffload() const { return kernel_tls_offload_; }
+
+  /**
+   * @return the sizing of the records connections send while they ramp up, if any.
+   */
+  const absl::optional<DynamicRecordSizing>& dynamicRecordSizing() const {
+    return dynamic_record_sizing_;
+  }
+
   SslStats& stats() { return stats_; }
 
   // Ssl::Context
@@ -96,22 +135,20 @@ protected:
    * certificate.
    *
    * @param ssl the certificate to verify
-   * @param expected_hashes the configured list of certificate hashes to match
+   * @param expected_hashes the configured certificate hashes to match
    * @return true if the verification succeeds
    */
-  static bool verifyCertificateHashList(X509* cert,
-                                        const std::vector<std::vector<uint8_t>>& expected_hashes);
+  static bool verifyCertificateHash(X509* cert, const CertificateHashSet& expected_hashes);
 
   /**
    * Verifies certificate hash for pinning. The hash is a base64-encoded SHA-256 of the DER-encoded
    * Subject Public Key Information (SPKI) of the certificate.
    *
    * @param ssl the certificate to verify
-   * @param expected_hashes the configured list of certificate hashes to match
+   * @param expected_hashes the configured certificate hashes to match
    * @return true if the verification succeeds
    */
-  static bool verifyCertificateSpkiList(X509* cert,
-                                        const std::vector<std::vector<uint8_t>>& expected_hashes);
+  static bool verifyCertificateSpki(X509* cert, const CertificateHashSet& expected_hashes);
 
   std::vector<uint8_t> parseAlpnProtocols(const std::string& alpn_protocols);
   static SslStats generateStats(Stats::Scope& scope);
@@ -127,6 +164,10 @@ protected:
   std::vector<std::string> verify_subject_alt_name_list_;
   std::vector<std::vector<uint8_t>> verify_certificate_hash_list_;
   std::vector<std::vector<uint8_t>> verify_certificate_spki_list_;
+  // Indexes of the lists above, that handshakes verify peer certificates with.
+  std::unique_ptr<SubjectAltNameMatcher> subject_alt_name_matcher_;
+  std::unique_ptr<CertificateHashSet> certificate_hash_set_;
+  std::unique_ptr<CertificateHashSet> certificate_spki_set_;
   Stats::Scope& scope_;
   SslStats stats_;
   std::vector<uint8_t> parsed_alpn_protocols_;
@@ -134,27 +175,73 @@ protected:
   bssl::UniquePtr<X509> cert_chain_;
   std::string ca_file_path_;
   std::string cert_chain_file_path_;
+  PrivateKeyThreadPool* private_key_thread_pool_{};
+  SessionCache* session_cache_{};
+  const bool kernel_tls_offload_;
+  const absl::optional<DynamicRecordSizing> dynamic_record_sizing_;
 };
 
 typedef std::shared_ptr<ContextImpl> ContextImplSharedPtr;
 
 class ClientContextImpl : public ContextImpl, public ClientContext {
 public:
-  ClientContextImpl(Stats::Scope& scope, const ClientContextConfig& config);
+  /**
+   * @param session_cache supplies the cache to resume sessions from, or nullptr to not resume
+   *        sessions.
+   */
+  ClientContextImpl(Stats::Scope& scope, const ClientContextConfig& config,
+                    SessionCache* session_cache = nullptr);
 
   bssl::UniquePtr<SSL> newSsl() const override;
+  void resumeSession(SSL* ssl, const Network::Connection& connection) const override;
 
 private:
+  /**
+   * The global SSL-library index used for storing the session cache key of a connection in its
+   * SSL instance.
+   */
+  static int sslSessionCacheKeyIndex();
+
+  // Sessions are never resumed across contexts, which may verify servers differently.
+  const std::string session_cache_key_prefix_;
   const std::string server_name_indication_;
   const bool allow_renegotiation_;
 };
 
 class ServerContextImpl : public ContextImpl, public ServerContext {
 public:
+  /**
+   * @param private_key_thread_pool supplies the threads to run private key operations on, or
+   *        nullptr to run them inline during the handshake.
+   * @param session_cache supplies the cache to store sessions in, or nullptr to only cache
+   *        sessions within the context.
+   */
   ServerContextImpl(Stats::Scope& scope, const ServerContextConfig& config,
-                    const std::vector<std::string>& server_names, Runtime::Loader& runtime);
+                    const std::vector<std::string>& server_names, Runtime::Loader& runtime,
+                    PrivateKeyThreadPool* private_key_thread_pool = nullptr,
+                    SessionCache* session_cache = nullptr);
+
+  /**
+   * Replace the session ticket keys without rebuilding the context, so that established
+   * connections and sessions survive a rotation. The first key encrypts new tickets. Keys that are
+   * dropped by the update still decrypt tickets, which are then renewed, until the next update.
+   * @param keys supplies the new keys. An empty set is ignored, as tickets must stay encryptable.
+   */
+  void updateSessionTicketKeys(const std::vector<ServerContextConfig::SessionTicketKey>& keys);
+
+  /**
+   * @return std::string the key a server session is stored under in the SessionCache.
+   */
+  static std::string sessionCacheKey(const SSL_SESSION* session);
+
+  /**
+   * @return bool whether a SessionCache key is the key of a server session.
+   */
+  static bool isSessionCacheKey(const std::string& key);
 
 private:
+  static ServerContextImpl& fromSslCtx(SSL_CTX* ctx);
+
   int alpnSelectCallback(const unsigned char** out, unsigned char* outlen, const unsigned char* in,
                          unsigned int inlen);
   int sessionTicketProcess(SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx,
@@ -162,7 +249,13 @@ private:
 
   Runtime::Loader& runtime_;
   std::vector<uint8_t> parsed_alt_alpn_protocols_;
-  const std::vector<ServerContextConfig::SessionTicketKey> session_ticket_keys_;
+  // Ticket callbacks run on all workers, while updates come from the main thread.
+  absl::Mutex session_ticket_keys_mutex_;
+  std::vector<ServerContextConfig::SessionTicketKey>
+      session_ticket_keys_ GUARDED_BY(session_ticket_keys_mutex_);
+  // Keys dropped by the last update, which only decrypt tickets.
+  std::vector<ServerContextConfig::SessionTicketKey>
+      previous_session_ticket_keys_ GUARDED_BY(session_ticket_keys_mutex_);
 };
 
 } // namespace Ssl
@@ -1,7 +1,9 @@
 #include "common/ssl/context_manager_impl.h"
 
+#include <cstring>
 #include <functional>
 
+#include "envoy/common/exception.h"
 #include "envoy/stats/scope.h"
 
 #include "common/common/assert.h"
@@ -10,7 +12,54 @@
 namespace Envoy {
 namespace Ssl {
 
+LazyServerContextImpl::LazyServerContextImpl(ContextManagerImpl& manager, Stats::Scope& scope,
+                                             const ServerContextConfig& config,
+                                             const std::vector<std::string>& server_names)
+    : manager_(manager), scope_(scope), config_(config), server_names_(server_names) {}
+
+LazyServerContextImpl::~LazyServerContextImpl() { manager_.onLazyServerContextDestroyed(*this); }
+
+ServerContextSharedPtr LazyServerContextImpl::get() {
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    if (context_ != nullptr) {
+      referenced_ = true;
+      return context_;
+    }
+  }
+
+  ServerContextSharedPtr context;
+  {
+    absl::MutexLock lock(&mutex_);
+    // Another worker may have built it meanwhile.
+    if (context_ == nullptr) {
+      try {
+        context_ = manager_.createSslServerContext(scope_, config_, server_names_);
+      } catch (const EnvoyException& e) {
+        ENVOY_LOG(warn, "failed to build server TLS context: {}", e.what());
+      }
+    }
+    context = context_;
+  }
+  if (context != nullptr) {
+    referenced_ = true;
+    manager_.onLazyServerContextBuilt(*this);
+  }
+  return context;
+}
+
+ContextManagerImpl::ContextManagerImpl(Runtime::Loader& runtime, uint32_t private_key_threads,
+                                       uint32_t session_cache_size, uint32_t lazy_server_contexts)
+    : runtime_(runtime),
+      private_key_thread_pool_(private_key_threads > 0
+                                   ? std::make_unique<PrivateKeyThreadPool>(private_key_threads)
+                                   : nullptr),
+      session_cache_(session_cache_size > 0 ? std::make_unique<LruSessionCache>(session_cache_size)
+                                            : nullptr),
+      lazy_server_contexts_(lazy_server_contexts) {}
+
 ContextManagerImpl::~ContextManagerImpl() {
+  absl::MutexLock lock(&contexts_mutex_);
   removeEmptyContexts();
   ASSERT(contexts_.empty());
 }
@@ -25,7 +74,9 @@ ContextManagerImpl::createSslClientContext(Stats::Scope& scope, const ClientCont
     return nullptr;
   }
 
-  ClientContextSharedPtr context = std::make_shared<ClientContextImpl>(scope, config);
+  ClientContextSharedPtr context =
+      std::make_shared<ClientContextImpl>(scope, config, session_cache_.get());
+  absl::MutexLock lock(&contexts_mutex_);
   removeEmptyContexts();
   contexts_.emplace_back(context);
   return context;
@@ -38,14 +89,58 @@ ContextManagerImpl::createSslServerContext(Stats::Scope& scope, const ServerCont
     return nullptr;
   }
 
-  ServerContextSharedPtr context =
-      std::make_shared<ServerContextImpl>(scope, config, server_names, runtime_);
+  ServerContextSharedPtr context = std::make_shared<ServerContextImpl>(
+      scope, config, server_names, runtime_, private_key_thread_pool_.get(), session_cache_.get());
+  absl::MutexLock lock(&contexts_mutex_);
   removeEmptyContexts();
   contexts_.emplace_back(context);
   return context;
 }
 
+LazyServerContextPtr
+ContextManagerImpl::createLazySslServerContext(Stats::Scope& scope,
+                                               const ServerContextConfig& config,
+                                               const std::vector<std::string>& server_names) {
+  if (lazy_server_contexts_ == 0) {
+    return nullptr;
+  }
+  return std::make_unique<LazyServerContextImpl>(*this, scope, config, server_names);
+}
+
+void ContextManagerImpl::onLazyServerContextBuilt(LazyServerContextImpl& lazy_context) {
+  // Released contexts are destroyed outside of the lock, once connections no longer use them.
+  std::vector<ServerContextSharedPtr> released;
+  absl::MutexLock lock(&lazy_contexts_mutex_);
+  if (lazy_context.built_) {
+    return;
+  }
+  lazy_context.built_ = true;
+  lazy_context.position_ = lazy_contexts_.insert(lazy_contexts_.end(), &lazy_context);
+
+  // Clock sweep: contexts used since the last sweep get another round, so that the hot path only
+  // sets a flag instead of reordering a list under a lock shared by all workers.
+  while (lazy_contexts_.size() > lazy_server_contexts_) {
+    LazyServerContextImpl* candidate = lazy_contexts_.front();
+    lazy_contexts_.pop_front();
+    if (candidate->referenced_.exchange(false)) {
+      candidate->position_ = lazy_contexts_.insert(lazy_contexts_.end(), candidate);
+      continue;
+    }
+    candidate->built_ = false;
+    absl::MutexLock candidate_lock(&candidate->mutex_);
+    released.push_back(std::move(candidate->context_));
+  }
+}
+
+void ContextManagerImpl::onLazyServerContextDestroyed(LazyServerContextImpl& lazy_context) {
+  absl::MutexLock lock(&lazy_contexts_mutex_);
+  if (lazy_context.built_) {
+    lazy_contexts_.erase(lazy_context.position_);
+  }
+}
+
 size_t ContextManagerImpl::daysUntilFirstCertExpires() const {
+  absl::MutexLock lock(&contexts_mutex_);
   size_t ret = std::numeric_limits<int>::max();
   for (const auto& ctx_weak_ptr : contexts_) {
     ContextSharedPtr context = ctx_weak_ptr.lock();
@@ -57,6 +152,7 @@ size_t ContextManagerImpl::daysUntilFirstCertExpires() const {
 }
 
 void ContextManagerImpl::iterateContexts(std::function<void(const Context&)> callback) {
+  absl::MutexLock lock(&contexts_mutex_);
   for (const auto& ctx_weak_ptr : contexts_) {
     ContextSharedPtr context = ctx_weak_ptr.lock();
     if (context) {
@@ -65,5 +161,54 @@ void ContextManagerImpl::iterateContexts(std::function<void(const Context&)> cal
   }
 }
 
+std::string ContextManagerImpl::exportServerSessions() {
+  std::string sessions;
+  if (session_cache_ == nullptr) {
+    return sessions;
+  }
+
+  // Each session is written as its length in host byte order followed by its encoding. Its cache
+  // key is derived from the session again on import.
+  session_cache_->iterate([&sessions](const std::string& key, SSL_SESSION* session) {
+    uint8_t* data;
+    size_t length;
+    if (!ServerContextImpl::isSessionCacheKey(key) ||
+        !SSL_SESSION_to_bytes(session, &data, &length)) {
+      return;
+    }
+    const uint32_t length32 = length;
+    sessions.append(reinterpret_cast<const char*>(&length32), sizeof(length32));
+    sessions.append(reinterpret_cast<const char*>(data), length);
+    OPENSSL_free(data);
+  });
+  return sessions;
+}
+
+void ContextManagerImpl::importServerSessions(const std::string& sessions) {
+  if (session_cache_ == nullptr || sessions.empty()) {
+    return;
+  }
+
+  bssl::UniquePtr<SSL_CTX> ctx(SSL_CTX_new(TLS_method()));
+  uint64_t imported = 0;
+  size_t offset = 0;
+  while (sessions.size() - offset >= sizeof(uint32_t)) {
+    uint32_t length;
+    memcpy(&length, sessions.data() + offset, sizeof(length));
+    offset += sizeof(length);
+    if (sessions.size() - offset < length) {
+      break;
+    }
+    bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_from_bytes(
+        reinterpret_cast<const uint8_t*>(sessions.data() + offset), length, ctx.get()));
+    offset += length;
+    if (session != nullptr) {
+      session_cache_->insert(ServerContextImpl::sessionCacheKey(session.get()), session.get());
+      imported++;
+    }
+  }
+  ENVOY_LOG(info, "imported {} TLS sessions", imported);
+}
+
 } // namespace Ssl
 } // namespace Envoy
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <list>
 
@@ -7,9 +8,49 @@
 #include "envoy/ssl/context_manager.h"
 #include "envoy/stats/scope.h"
 
+#include "common/common/logger.h"
+#include "common/common/thread_annotations.h"
+#include "common/ssl/private_key_operations.h"
+#include "common/ssl/session_cache.h"
+
+#include "absl/synchronization/mutex.h"
+
 namespace Envoy {
 namespace Ssl {
 
+class ContextManagerImpl;
+
+/**
+ * LazyServerContext of a ContextManagerImpl, which bounds the number of them that hold a built
+ * context.
+ */
+class LazyServerContextImpl : public LazyServerContext,
+                              Logger::Loggable<Logger::Id::config> {
+public:
+  LazyServerContextImpl(ContextManagerImpl& manager, Stats::Scope& scope,
+                        const ServerContextConfig& config,
+                        const std::vector<std::string>& server_names);
+  ~LazyServerContextImpl();
+
+  // Ssl::LazyServerContext
+  ServerContextSharedPtr get() override;
+
+private:
+  friend class ContextManagerImpl;
+
+  ContextManagerImpl& manager_;
+  Stats::Scope& scope_;
+  const ServerContextConfig& config_;
+  const std::vector<std::string> server_names_;
+  absl::Mutex mutex_;
+  ServerContextSharedPtr context_ GUARDED_BY(mutex_);
+  // Set on use, and cleared by the manager as it looks for a context to release.
+  std::atomic<bool> referenced_{};
+  // Guarded by the manager's lazy_contexts_mutex_.
+  bool built_{};
+  std::list<LazyServerContextImpl*>::iterator position_;
+};
+
 /**
  * The SSL context manager has the following threading model:
  * Contexts can be allocated via any thread (through in practice they are only allocated on the main
@@ -17,9 +58,18 @@ namespace Ssl {
  * be released from any thread). Context allocation/free is a very uncommon thing so we just do a
  * global lock to protect it all.
  */
-class ContextManagerImpl final : public ContextManager {
+class ContextManagerImpl final : public ContextManager, Logger::Loggable<Logger::Id::config> {
 public:
-  ContextManagerImpl(Runtime::Loader& runtime) : runtime_(runtime) {}
+  /**
+   * @param private_key_threads supplies the number of threads that run the private key operations
+   *        of server handshakes, or 0 to run them inline on the connection's worker.
+   * @param session_cache_size supplies the number of sessions the contexts share, or 0 for client
+   *        contexts to not resume sessions and server contexts to cache sessions on their own.
+   * @param lazy_server_contexts supplies the maximum number of lazy server contexts that hold a
+   *        built context, or 0 to build server contexts eagerly.
+   */
+  ContextManagerImpl(Runtime::Loader& runtime, uint32_t private_key_threads = 0,
+                     uint32_t session_cache_size = 0, uint32_t lazy_server_contexts = 0);
   ~ContextManagerImpl();
 
   // Ssl::ContextManager
@@ -28,13 +78,32 @@ public:
   Ssl::ServerContextSharedPtr
   createSslServerContext(Stats::Scope& scope, const ServerContextConfig& config,
                          const std::vector<std::string>& server_names) override;
+  LazyServerContextPtr
+  createLazySslServerContext(Stats::Scope& scope, const ServerContextConfig& config,
+                             const std::vector<std::string>& server_names) override;
   size_t daysUntilFirstCertExpires() const override;
   void iterateContexts(std::function<void(const Context&)> callback) override;
+  std::string exportServerSessions() override;
+  void importServerSessions(const std::string& sessions) override;
 
 private:
-  void removeEmptyContexts();
+  friend class LazyServerContextImpl;
+
+  void removeEmptyContexts() EXCLUSIVE_LOCKS_REQUIRED(contexts_mutex_);
+  void onLazyServerContextBuilt(LazyServerContextImpl& lazy_context);
+  void onLazyServerContextDestroyed(LazyServerContextImpl& lazy_context);
+
   Runtime::Loader& runtime_;
-  std::list<std::weak_ptr<Context>> contexts_;
+  // Outlives the contexts, which must all have been released before destruction.
+  std::unique_ptr<PrivateKeyThreadPool> private_key_thread_pool_;
+  SessionCachePtr session_cache_;
+  const uint32_t lazy_server_contexts_;
+  // Lazy server contexts are built on workers.
+  mutable absl::Mutex contexts_mutex_;
+  std::list<std::weak_ptr<Context>> contexts_ GUARDED_BY(contexts_mutex_);
+  absl::Mutex lazy_contexts_mutex_;
+  // Lazy server contexts holding a built context, in the order a clock sweep visits them.
+  std::list<LazyServerContextImpl*> lazy_contexts_ GUARDED_BY(lazy_contexts_mutex_);
 };
 
 } // namespace Ssl
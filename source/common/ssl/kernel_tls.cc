@@ -0,0 +1,141 @@
+#include "common/ssl/kernel_tls.h"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+#include "openssl/nid.h"
+
+#ifdef __linux__
+#include <linux/tls.h>
+
+// Older C libraries lack the kernel TLS constants.
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#endif
+
+namespace Envoy {
+namespace Ssl {
+namespace KernelTls {
+
+#ifdef __linux__
+namespace {
+
+template <class CryptoInfo>
+bool setTransmitKeys(int fd, uint16_t cipher_type, const uint8_t* key, const uint8_t* salt,
+                     uint64_t sequence) {
+  CryptoInfo crypto_info;
+  memset(&crypto_info, 0, sizeof(crypto_info));
+  crypto_info.info.version = TLS_1_2_VERSION;
+  crypto_info.info.cipher_type = cipher_type;
+  std::copy_n(key, sizeof(crypto_info.key), crypto_info.key);
+  std::copy_n(salt, sizeof(crypto_info.salt), crypto_info.salt);
+  // BoringSSL uses the sequence number as the explicit nonce of TLS 1.2 AES-GCM records, and so
+  // does the kernel, which advances both from here.
+  static_assert(sizeof(crypto_info.rec_seq) == sizeof(uint64_t), "Expected sequence length");
+  static_assert(sizeof(crypto_info.iv) == sizeof(uint64_t), "Expected explicit nonce length");
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    crypto_info.rec_seq[i] = static_cast<uint8_t>(sequence >> (8 * (sizeof(uint64_t) - 1 - i)));
+  }
+  std::copy_n(crypto_info.rec_seq, sizeof(crypto_info.iv), crypto_info.iv);
+  return setsockopt(fd, SOL_TLS, TLS_TX, &crypto_info, sizeof(crypto_info)) == 0;
+}
+
+} // namespace
+
+bool enableTransmit(SSL* ssl, int fd) {
+  if (SSL_version(ssl) != TLS1_2_VERSION) {
+    return false;
+  }
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  if (cipher == nullptr) {
+    return false;
+  }
+  size_t key_len;
+  uint16_t cipher_type;
+  switch (SSL_CIPHER_get_cipher_nid(cipher)) {
+  case NID_aes_128_gcm:
+    key_len = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+    cipher_type = TLS_CIPHER_AES_GCM_128;
+    break;
+#ifdef TLS_CIPHER_AES_GCM_256
+  case NID_aes_256_gcm:
+    key_len = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+    cipher_type = TLS_CIPHER_AES_GCM_256;
+    break;
+#endif
+  default:
+    return false;
+  }
+
+  // With AEAD cipher suites the key block is the client and server write keys, followed by their
+  // implicit nonces, the salt, which is as long for both key sizes.
+  const size_t salt_len = TLS_CIPHER_AES_GCM_128_SALT_SIZE;
+  std::vector<uint8_t> key_block(SSL_get_key_block_len(ssl));
+  if (key_block.size() != 2 * (key_len + salt_len) ||
+      !SSL_generate_key_block(ssl, key_block.data(), key_block.size())) {
+    return false;
+  }
+  const size_t side = SSL_is_server(ssl) ? 1 : 0;
+  const uint8_t* key = key_block.data() + side * key_len;
+  const uint8_t* salt = key_block.data() + 2 * key_len + side * salt_len;
+
+  if (setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) != 0) {
+    return false;
+  }
+  const uint64_t sequence = SSL_get_write_sequence(ssl);
+  switch (cipher_type) {
+  case TLS_CIPHER_AES_GCM_128:
+    return setTransmitKeys<tls12_crypto_info_aes_gcm_128>(fd, cipher_type, key, salt, sequence);
+#ifdef TLS_CIPHER_AES_GCM_256
+  case TLS_CIPHER_AES_GCM_256:
+    return setTransmitKeys<tls12_crypto_info_aes_gcm_256>(fd, cipher_type, key, salt, sequence);
+#endif
+  default:
+    NOT_REACHED_GCOVR_EXCL_LINE;
+  }
+}
+
+bool sendCloseNotify(int fd) {
+#ifdef TLS_SET_RECORD_TYPE
+  // A warning level close_notify alert.
+  uint8_t alert[2] = {SSL3_AL_WARNING, SSL_AD_CLOSE_NOTIFY};
+  iovec iov{alert, sizeof(alert)};
+  alignas(cmsghdr) uint8_t control[CMSG_SPACE(sizeof(uint8_t))];
+  msghdr msg{};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+  *CMSG_DATA(cmsg) = SSL3_RT_ALERT;
+  return sendmsg(fd, &msg, MSG_NOSIGNAL) == sizeof(alert);
+#else
+  UNREFERENCED_PARAMETER(fd);
+  return false;
+#endif
+}
+#else
+bool enableTransmit(SSL*, int) { return false; }
+
+bool sendCloseNotify(int) { return false; }
+#endif
+
+} // namespace KernelTls
+} // namespace Ssl
+} // namespace Envoy
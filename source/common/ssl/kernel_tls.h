@@ -0,0 +1,29 @@
+#pragma once
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+namespace KernelTls {
+
+/**
+ * Hand the encryption of records written to a connection's socket to the kernel (TCP_ULP "tls").
+ * Only TLS 1.2 with AES-GCM cipher suites is supported. On success, plaintext written to the
+ * socket is sent as records that continue the SSL's write sequence, and the SSL must not write to
+ * the socket anymore. Records received are still decrypted by the SSL.
+ * @param ssl supplies the SSL whose handshake has completed and whose writes are all flushed.
+ * @param fd supplies the socket of the connection.
+ * @return bool whether the kernel encrypts the records written to fd from now on.
+ */
+bool enableTransmit(SSL* ssl, int fd);
+
+/**
+ * Send a close_notify alert on a socket whose transmit side was handed to the kernel.
+ * @param fd supplies the socket of the connection.
+ * @return bool whether the alert was sent.
+ */
+bool sendCloseNotify(int fd);
+
+} // namespace KernelTls
+} // namespace Ssl
+} // namespace Envoy
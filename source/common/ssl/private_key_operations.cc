@@ -0,0 +1,202 @@
+#include "common/ssl/private_key_operations.h"
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+
+#include "openssl/err.h"
+#include "openssl/evp.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Ssl {
+
+PrivateKeyThreadPool::PrivateKeyThreadPool(uint32_t threads) {
+  for (uint32_t i = 0; i < threads; i++) {
+    threads_.emplace_back(new Thread::Thread([this]() -> void { threadRoutine(); }));
+  }
+}
+
+PrivateKeyThreadPool::~PrivateKeyThreadPool() {
+  {
+    absl::MutexLock lock(&mutex_);
+    exit_ = true;
+  }
+  for (auto& thread : threads_) {
+    thread->join();
+  }
+}
+
+void PrivateKeyThreadPool::post(std::function<void()> operation) {
+  absl::MutexLock lock(&mutex_);
+  ASSERT(!exit_);
+  operations_.push_back(std::move(operation));
+}
+
+bool PrivateKeyThreadPool::readyOrExiting() const { return exit_ || !operations_.empty(); }
+
+void PrivateKeyThreadPool::threadRoutine() {
+  while (true) {
+    std::function<void()> operation;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(this, &PrivateKeyThreadPool::readyOrExiting));
+      if (operations_.empty()) {
+        return;
+      }
+      operation = std::move(operations_.front());
+      operations_.pop_front();
+    }
+    operation();
+  }
+}
+
+PrivateKeyOperations::PrivateKeyOperations(PrivateKeyThreadPool& pool, EVP_PKEY* key,
+                                           Event::Dispatcher& dispatcher,
+                                           std::function<void()> on_complete)
+    : pool_(pool), key_(key), dispatcher_(dispatcher), on_complete_(on_complete) {
+  EVP_PKEY_up_ref(key);
+}
+
+PrivateKeyOperations::~PrivateKeyOperations() { cancel(); }
+
+void PrivateKeyOperations::attach(SSL* ssl) { SSL_set_ex_data(ssl, sslIndex(), this); }
+
+const SSL_PRIVATE_KEY_METHOD& PrivateKeyOperations::privateKeyMethod() {
+  CONSTRUCT_ON_FIRST_USE(SSL_PRIVATE_KEY_METHOD,
+                         SSL_PRIVATE_KEY_METHOD{&PrivateKeyOperations::sign,
+                                                &PrivateKeyOperations::decrypt,
+                                                &PrivateKeyOperations::complete});
+}
+
+int PrivateKeyOperations::sslIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() -> int {
+    int ssl_index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    RELEASE_ASSERT(ssl_index >= 0, "");
+    return ssl_index;
+  }());
+}
+
+PrivateKeyOperations& PrivateKeyOperations::fromSsl(SSL* ssl) {
+  auto* operations = static_cast<PrivateKeyOperations*>(SSL_get_ex_data(ssl, sslIndex()));
+  RELEASE_ASSERT(operations != nullptr, "");
+  return *operations;
+}
+
+ssl_private_key_result_t PrivateKeyOperations::sign(SSL* ssl, uint8_t*, size_t*, size_t,
+                                                    uint16_t signature_algorithm, const uint8_t* in,
+                                                    size_t in_len) {
+  std::vector<uint8_t> input(in, in + in_len);
+  return fromSsl(ssl).start([signature_algorithm, input](EVP_PKEY* key,
+                                                         std::vector<uint8_t>& output) -> bool {
+    // The digest is null for Ed25519, which signs the input as is.
+    const EVP_MD* md = SSL_get_signature_algorithm_digest(signature_algorithm);
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pctx;
+    if (!EVP_DigestSignInit(ctx.get(), &pctx, md, nullptr, key)) {
+      return false;
+    }
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1 /* digest length */))) {
+      return false;
+    }
+    size_t length = EVP_PKEY_size(key);
+    output.resize(length);
+    if (!EVP_DigestSign(ctx.get(), output.data(), &length, input.data(), input.size())) {
+      return false;
+    }
+    output.resize(length);
+    return true;
+  });
+}
+
+ssl_private_key_result_t PrivateKeyOperations::decrypt(SSL* ssl, uint8_t*, size_t*, size_t,
+                                                       const uint8_t* in, size_t in_len) {
+  std::vector<uint8_t> input(in, in + in_len);
+  return fromSsl(ssl).start([input](EVP_PKEY* key, std::vector<uint8_t>& output) -> bool {
+    // Only RSA key exchange decrypts, and BoringSSL removes the padding itself.
+    RSA* rsa = EVP_PKEY_get0_RSA(key);
+    if (rsa == nullptr) {
+      return false;
+    }
+    size_t length;
+    output.resize(RSA_size(rsa));
+    if (!RSA_decrypt(rsa, &length, output.data(), output.size(), input.data(), input.size(),
+                     RSA_NO_PADDING)) {
+      return false;
+    }
+    output.resize(length);
+    return true;
+  });
+}
+
+ssl_private_key_result_t PrivateKeyOperations::complete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                                        size_t max_out) {
+  PrivateKeyOperations& operations = fromSsl(ssl);
+  std::shared_ptr<Operation> operation = operations.operation_;
+  if (operation == nullptr) {
+    return ssl_private_key_failure;
+  }
+  {
+    absl::MutexLock lock(&operation->mutex_);
+    // The handshake may be resumed by socket events before the operation has completed.
+    if (!operation->done_) {
+      return ssl_private_key_retry;
+    }
+    // The completion callback may still be pending, and the connection may be gone when it runs.
+    operation->cancelled_ = true;
+  }
+
+  operations.operation_.reset();
+  if (!operation->success_ || operation->output_.size() > max_out) {
+    return ssl_private_key_failure;
+  }
+  std::copy(operation->output_.begin(), operation->output_.end(), out);
+  *out_len = operation->output_.size();
+  return ssl_private_key_success;
+}
+
+ssl_private_key_result_t PrivateKeyOperations::start(Computation computation) {
+  // BoringSSL runs one private key operation at a time per connection.
+  ASSERT(operation_ == nullptr);
+  operation_ = std::make_shared<Operation>();
+
+  std::shared_ptr<Operation> operation = operation_;
+  // The operation holds its own reference to the key, as the context may go away before it ends.
+  EVP_PKEY_up_ref(key_.get());
+  std::shared_ptr<EVP_PKEY> key(key_.get(), EVP_PKEY_free);
+  Event::Dispatcher& dispatcher = dispatcher_;
+  const std::function<void()> on_complete = on_complete_;
+  pool_.post([operation, key, computation, &dispatcher, on_complete]() -> void {
+    operation->success_ = computation(key.get(), operation->output_);
+    if (!operation->success_) {
+      ERR_clear_error();
+    }
+
+    absl::MutexLock lock(&operation->mutex_);
+    operation->done_ = true;
+    // Once cancelled, the connection and possibly its dispatcher are gone.
+    if (!operation->cancelled_) {
+      dispatcher.post([operation, on_complete]() -> void {
+        {
+          absl::MutexLock lock(&operation->mutex_);
+          if (operation->cancelled_) {
+            return;
+          }
+        }
+        on_complete();
+      });
+    }
+  });
+  return ssl_private_key_retry;
+}
+
+void PrivateKeyOperations::cancel() {
+  if (operation_ != nullptr) {
+    absl::MutexLock lock(&operation_->mutex_);
+    operation_->cancelled_ = true;
+  }
+}
+
+} // namespace Ssl
+} // namespace Envoy
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
+
+#include "absl/synchronization/mutex.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Threads that run the private key operations of TLS handshakes, so that RSA and ECDSA signing
+ * does not stall the other connections of a worker.
+ */
+class PrivateKeyThreadPool {
+public:
+  explicit PrivateKeyThreadPool(uint32_t threads);
+
+  /**
+   * Waits for queued operations to finish.
+   */
+  ~PrivateKeyThreadPool();
+
+  /**
+   * Run an operation on one of the threads.
+   */
+  void post(std::function<void()> operation);
+
+private:
+  bool readyOrExiting() const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void threadRoutine();
+
+  absl::Mutex mutex_;
+  std::deque<std::function<void()>> operations_ GUARDED_BY(mutex_);
+  bool exit_ GUARDED_BY(mutex_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+/**
+ * Runs the private key operations of a connection's handshake on a PrivateKeyThreadPool. It is
+ * attached to the connection's SSL, whose context must use privateKeyMethod(). BoringSSL then
+ * suspends the handshake with SSL_ERROR_WANT_PRIVATE_KEY_OPERATION, and once the operation has
+ * completed the connection's dispatcher runs the completion callback, which should resume the
+ * handshake.
+ */
+class PrivateKeyOperations {
+public:
+  /**
+   * @param pool supplies the threads to run operations on.
+   * @param key supplies the private key.
+   * @param dispatcher supplies the dispatcher of the connection.
+   * @param on_complete supplies the callback run on the dispatcher when an operation completed.
+   */
+  PrivateKeyOperations(PrivateKeyThreadPool& pool, EVP_PKEY* key, Event::Dispatcher& dispatcher,
+                       std::function<void()> on_complete);
+
+  /**
+   * Operations still running complete without invoking the callback.
+   */
+  ~PrivateKeyOperations();
+
+  /**
+   * Attach to a connection, for use by privateKeyMethod().
+   */
+  void attach(SSL* ssl);
+
+  /**
+   * @return const SSL_PRIVATE_KEY_METHOD& the private key method that runs the operations of SSLs
+   *         with attached PrivateKeyOperations.
+   */
+  static const SSL_PRIVATE_KEY_METHOD& privateKeyMethod();
+
+private:
+  // Shared with the thread running the operation, which may outlive the connection.
+  struct Operation {
+    absl::Mutex mutex_;
+    bool cancelled_ GUARDED_BY(mutex_){};
+    bool done_ GUARDED_BY(mutex_){};
+    bool success_{};
+    std::vector<uint8_t> output_;
+  };
+  typedef std::function<bool(EVP_PKEY* key, std::vector<uint8_t>& output)> Computation;
+
+  static int sslIndex();
+  static PrivateKeyOperations& fromSsl(SSL* ssl);
+  static ssl_private_key_result_t sign(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                       uint16_t signature_algorithm, const uint8_t* in,
+                                       size_t in_len);
+  static ssl_private_key_result_t decrypt(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                          const uint8_t* in, size_t in_len);
+  static ssl_private_key_result_t complete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                           size_t max_out);
+
+  ssl_private_key_result_t start(Computation computation);
+  void cancel();
+
+  PrivateKeyThreadPool& pool_;
+  bssl::UniquePtr<EVP_PKEY> key_;
+  Event::Dispatcher& dispatcher_;
+  const std::function<void()> on_complete_;
+  std::shared_ptr<Operation> operation_;
+};
+
+typedef std::unique_ptr<PrivateKeyOperations> PrivateKeyOperationsPtr;
+
+} // namespace Ssl
+} // namespace Envoy
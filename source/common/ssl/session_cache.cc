@@ -0,0 +1,80 @@
+#include "common/ssl/session_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace Envoy {
+namespace Ssl {
+
+namespace {
+// Enough to keep lock contention low with a worker per core on large hosts.
+constexpr uint32_t NumShards = 16;
+} // namespace
+
+LruSessionCache::LruSessionCache(uint32_t capacity)
+    : shard_capacity_(std::max(1U, (capacity + NumShards - 1) / NumShards)) {
+  for (uint32_t i = 0; i < NumShards; i++) {
+    shards_.emplace_back(new Shard());
+  }
+}
+
+LruSessionCache::Shard& LruSessionCache::shard(const std::string& key) {
+  return *shards_[std::hash<std::string>()(key) % shards_.size()];
+}
+
+void LruSessionCache::insert(const std::string& key, SSL_SESSION* session) {
+  SSL_SESSION_up_ref(session);
+  bssl::UniquePtr<SSL_SESSION> reference(session);
+
+  Shard& shard = this->shard(key);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.sessions_.find(key);
+  if (it != shard.sessions_.end()) {
+    it->second->second = std::move(reference);
+    shard.lru_.splice(shard.lru_.begin(), shard.lru_, it->second);
+    return;
+  }
+
+  if (shard.lru_.size() >= shard_capacity_) {
+    shard.sessions_.erase(shard.lru_.back().first);
+    shard.lru_.pop_back();
+  }
+  shard.lru_.emplace_front(key, std::move(reference));
+  shard.sessions_.emplace(key, shard.lru_.begin());
+}
+
+bssl::UniquePtr<SSL_SESSION> LruSessionCache::lookup(const std::string& key) {
+  Shard& shard = this->shard(key);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.sessions_.find(key);
+  if (it == shard.sessions_.end()) {
+    return nullptr;
+  }
+
+  shard.lru_.splice(shard.lru_.begin(), shard.lru_, it->second);
+  SSL_SESSION* session = it->second->second.get();
+  SSL_SESSION_up_ref(session);
+  return bssl::UniquePtr<SSL_SESSION>(session);
+}
+
+void LruSessionCache::remove(const std::string& key) {
+  Shard& shard = this->shard(key);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.sessions_.find(key);
+  if (it != shard.sessions_.end()) {
+    shard.lru_.erase(it->second);
+    shard.sessions_.erase(it);
+  }
+}
+
+void LruSessionCache::iterate(const std::function<void(const std::string&, SSL_SESSION*)>& cb) {
+  for (const auto& shard : shards_) {
+    absl::MutexLock lock(&shard->mutex_);
+    for (const auto& entry : shard->lru_) {
+      cb(entry.first, entry.second.get());
+    }
+  }
+}
+
+} // namespace Ssl
+} // namespace Envoy
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/pure.h"
+
+#include "common/common/thread_annotations.h"
+
+#include "absl/synchronization/mutex.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Store of TLS sessions that contexts resume sessions from. It is shared by all contexts of a
+ * ContextManagerImpl, and so by the connections of all workers. Implementations must be thread
+ * safe.
+ */
+class SessionCache {
+public:
+  virtual ~SessionCache() {}
+
+  /**
+   * Store a session, replacing any session stored under the same key.
+   * @param key supplies the key to store the session under.
+   * @param session supplies the session, which the cache takes a reference to.
+   */
+  virtual void insert(const std::string& key, SSL_SESSION* session) PURE;
+
+  /**
+   * @return bssl::UniquePtr<SSL_SESSION> the session stored under key, or nullptr if there is none.
+   */
+  virtual bssl::UniquePtr<SSL_SESSION> lookup(const std::string& key) PURE;
+
+  /**
+   * Remove the session stored under key, if any.
+   */
+  virtual void remove(const std::string& key) PURE;
+
+  /**
+   * Call a function with every stored session. The cache must not be modified from the function.
+   * @param cb supplies the function, called with the key of the session and the session.
+   */
+  virtual void iterate(const std::function<void(const std::string&, SSL_SESSION*)>& cb) PURE;
+};
+
+typedef std::unique_ptr<SessionCache> SessionCachePtr;
+
+/**
+ * In-process SessionCache that evicts the least recently used sessions once full. Keys are spread
+ * over shards with their own locks, so that handshakes on different workers rarely contend.
+ */
+class LruSessionCache : public SessionCache {
+public:
+  /**
+   * @param capacity supplies the maximum number of sessions to store.
+   */
+  explicit LruSessionCache(uint32_t capacity);
+
+  // Ssl::SessionCache
+  void insert(const std::string& key, SSL_SESSION* session) override;
+  bssl::UniquePtr<SSL_SESSION> lookup(const std::string& key) override;
+  void remove(const std::string& key) override;
+  void iterate(const std::function<void(const std::string&, SSL_SESSION*)>& cb) override;
+
+private:
+  typedef std::list<std::pair<std::string, bssl::UniquePtr<SSL_SESSION>>> LruList;
+
+  struct Shard {
+    absl::Mutex mutex_;
+    // Most recently used first.
+    LruList lru_ GUARDED_BY(mutex_);
+    std::unordered_map<std::string, LruList::iterator> sessions_ GUARDED_BY(mutex_);
+  };
+
+  Shard& shard(const std::string& key);
+
+  const uint32_t shard_capacity_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace Ssl
+} // namespace Envoy
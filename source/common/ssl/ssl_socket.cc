@@ -1,12 +1,21 @@
 #include "common/ssl/ssl_socket.h"
 
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstring>
+
 #include "envoy/stats/scope.h"
 
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/hex.h"
 #include "common/http/headers.h"
+#include "common/ssl/kernel_tls.h"
 #include "common/ssl/utility.h"
+#include "common/stats/stage_timer.h"
 
 #include "absl/strings/str_replace.h"
 #include "openssl/err.h"
@@ -18,6 +27,13 @@ namespace Envoy {
 namespace Ssl {
 
 namespace {
+// The largest plaintext of a TLS record.
+constexpr uint64_t MaxRecordSize = 16384;
+// Room for the header, explicit nonce or IV, tag or MAC and padding of a record, of all ciphers.
+constexpr int RecordOverhead = 64;
+// The MSS of a TCP connection over Ethernet.
+constexpr int DefaultSegmentSize = 1460;
+
 // This SslSocket will be used when SSL secret is not fetched from SDS server.
 class NotReadySslSocket : public Network::TransportSocket {
 public:
@@ -51,6 +67,14 @@ void SslSocket::setTransportSocketCallbacks(Network::TransportSocketCallbacks& c
 
   BIO* bio = BIO_new_socket(callbacks_->fd(), 0);
   SSL_set_bio(ssl_.get(), bio, bio);
+
+  // A completed private key operation resumes the handshake through a read event.
+  private_key_operations_ = ctx_->newPrivateKeyOperations(
+      callbacks_->connection(), [this]() -> void { callbacks_->setReadBufferReady(); });
+  if (private_key_operations_ != nullptr) {
+    private_key_operations_->attach(ssl_.get());
+  }
+  ctx_->resumeSession(ssl_.get(), callbacks_->connection());
 }
 
 Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
@@ -63,6 +87,7 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
     }
   }
 
+  Stats::StageTimer timer(Stats::Stage::TlsRead);
   bool keep_reading = true;
   bool end_stream = false;
   PostIoAction action = PostIoAction::KeepOpen;
@@ -120,6 +145,9 @@ PostIoAction SslSocket::doHandshake() {
     ENVOY_CONN_LOG(debug, "handshake complete", callbacks_->connection());
     handshake_complete_ = true;
     ctx_->logHandshake(ssl_.get());
+    if (ctx_->kernelTlsOffload()) {
+      enableKernelTls();
+    }
     callbacks_->raiseEvent(Network::ConnectionEvent::Connected);
 
     // It's possible that we closed during the handshake callback.
@@ -132,6 +160,7 @@ PostIoAction SslSocket::doHandshake() {
     switch (err) {
     case SSL_ERROR_WANT_READ:
     case SSL_ERROR_WANT_WRITE:
+    case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION:
       return PostIoAction::KeepOpen;
     default:
       drainErrorQueue();
@@ -140,6 +169,54 @@ PostIoAction SslSocket::doHandshake() {
   }
 }
 
+void SslSocket::enableKernelTls() {
+  // The handshake has flushed all the records the SSL wrote, so the kernel continues its sequence.
+  if (!KernelTls::enableTransmit(ssl_.get(), callbacks_->fd())) {
+    ENVOY_CONN_LOG(debug, "kernel TLS not available", callbacks_->connection());
+    return;
+  }
+  ENVOY_CONN_LOG(debug, "kernel TLS enabled for sending", callbacks_->connection());
+  kernel_tls_tx_ = true;
+  ctx_->stats().kernel_tls_offload_.inc();
+  // Alerts the SSL may still write would corrupt the kernel's record stream, so they are dropped.
+  SSL_set0_wbio(ssl_.get(), BIO_new(BIO_s_mem()));
+}
+
+void SslSocket::restartRampUpIfIdle() {
+  const absl::optional<DynamicRecordSizing>& sizing = ctx_->dynamicRecordSizing();
+  if (!sizing) {
+    return;
+  }
+  const MonotonicTime now = callbacks_->connection().dispatcher().timeSystem().monotonicTime();
+  if (now - last_write_time_ >= sizing->idle_timeout_) {
+    ramp_up_bytes_sent_ = 0;
+  }
+  last_write_time_ = now;
+}
+
+uint64_t SslSocket::recordSize() {
+  const absl::optional<DynamicRecordSizing>& sizing = ctx_->dynamicRecordSizing();
+  if (!sizing || ramp_up_bytes_sent_ >= sizing->ramp_up_bytes_) {
+    return MaxRecordSize;
+  }
+  if (small_record_size_ == 0) {
+    small_record_size_ =
+        sizing->small_record_size_ > 0 ? sizing->small_record_size_ : segmentRecordSize();
+  }
+  return small_record_size_;
+}
+
+uint32_t SslSocket::segmentRecordSize() const {
+  int segment_size;
+  socklen_t segment_size_len = sizeof(segment_size);
+  if (::getsockopt(callbacks_->fd(), IPPROTO_TCP, TCP_MAXSEG, &segment_size, &segment_size_len) !=
+          0 ||
+      segment_size <= RecordOverhead) {
+    segment_size = DefaultSegmentSize;
+  }
+  return std::min<uint64_t>(segment_size - RecordOverhead, MaxRecordSize);
+}
+
 void SslSocket::drainErrorQueue() {
   bool saw_error = false;
   bool saw_counted_error = false;
@@ -172,12 +249,18 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     }
   }
 
+  Stats::StageTimer timer(Stats::Stage::TlsWrite);
+  if (kernel_tls_tx_) {
+    return doKernelTlsWrite(write_buffer, end_stream);
+  }
+
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
     bytes_to_write = bytes_to_retry_;
     bytes_to_retry_ = 0;
   } else {
-    bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+    restartRampUpIfIdle();
+    bytes_to_write = std::min(write_buffer.length(), recordSize());
   }
 
   uint64_t total_bytes_written = 0;
@@ -194,8 +277,9 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     if (rc > 0) {
       ASSERT(rc == static_cast<int>(bytes_to_write));
       total_bytes_written += rc;
+      ramp_up_bytes_sent_ += rc;
       write_buffer.drain(rc);
-      bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+      bytes_to_write = std::min(write_buffer.length(), recordSize());
     } else {
       int err = SSL_get_error(ssl_.get(), rc);
       switch (err) {
@@ -220,11 +304,42 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
+Network::IoResult SslSocket::doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  // The kernel frames and encrypts the plaintext, so it is written as is.
+  uint64_t total_bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    Api::SysCallIntResult result = write_buffer.write(callbacks_->fd());
+    ENVOY_CONN_LOG(trace, "kernel tls write returns: {}", callbacks_->connection(), result.rc_);
+    if (result.rc_ == -1) {
+      if (result.errno_ == EAGAIN) {
+        return {PostIoAction::KeepOpen, total_bytes_written, false};
+      }
+      ENVOY_CONN_LOG(debug, "kernel tls write error: {} ({})", callbacks_->connection(),
+                     result.errno_, strerror(result.errno_));
+      return {PostIoAction::Close, total_bytes_written, false};
+    }
+    total_bytes_written += result.rc_;
+  }
+
+  if (end_stream) {
+    shutdownSsl();
+  }
+
+  return {PostIoAction::KeepOpen, total_bytes_written, false};
+}
+
 void SslSocket::onConnected() { ASSERT(!handshake_complete_); }
 
 void SslSocket::shutdownSsl() {
   ASSERT(handshake_complete_);
   if (!shutdown_sent_ && callbacks_->connection().state() != Network::Connection::State::Closed) {
+    if (kernel_tls_tx_) {
+      const bool sent = KernelTls::sendCloseNotify(callbacks_->fd());
+      ENVOY_CONN_LOG(debug, "SSL shutdown: kernel close_notify sent={}", callbacks_->connection(),
+                     sent);
+      shutdown_sent_ = true;
+      return;
+    }
     int rc = SSL_shutdown(ssl_.get());
     ENVOY_CONN_LOG(debug, "SSL shutdown: rc={}", callbacks_->connection(), rc);
     drainErrorQueue();
@@ -447,17 +562,50 @@ void ClientSslSocketFactory::onAddOrUpdateSecret() {
   stats_.ssl_context_update_by_sds_.inc();
 }
 
+void ServerSslSocketFactory::onSessionTicketKeysUpdate() {
+  ENVOY_LOG(debug, "Session ticket keys are updated.");
+  std::shared_ptr<ServerContextImpl> ssl_ctx;
+  {
+    absl::ReaderMutexLock l(&ssl_ctx_mu_);
+    ssl_ctx = std::dynamic_pointer_cast<ServerContextImpl>(ssl_ctx_);
+  }
+  if (ssl_ctx == nullptr) {
+    // The first keys may be all the context was waiting for.
+    onAddOrUpdateSecret();
+    return;
+  }
+  // Rotating keys in place keeps the context, and so its session cache and connections.
+  ssl_ctx->updateSessionTicketKeys(config_->sessionTicketKeys());
+  stats_.session_ticket_keys_update_by_sds_.inc();
+}
+
 ServerSslSocketFactory::ServerSslSocketFactory(ServerContextConfigPtr config,
                                                Ssl::ContextManager& manager,
                                                Stats::Scope& stats_scope,
                                                const std::vector<std::string>& server_names)
     : manager_(manager), stats_scope_(stats_scope), stats_(generateStats("server", stats_scope)),
       config_(std::move(config)), server_names_(server_names),
-      ssl_ctx_(manager_.createSslServerContext(stats_scope_, *config_, server_names_)) {
+      // Contexts whose secrets may change on SDS updates are always kept built.
+      lazy_ssl_ctx_(config_->hasDynamicSecrets() ? nullptr
+                                                 : manager_.createLazySslServerContext(
+                                                       stats_scope_, *config_, server_names_)),
+      ssl_ctx_(lazy_ssl_ctx_ == nullptr
+                   ? manager_.createSslServerContext(stats_scope_, *config_, server_names_)
+                   : nullptr) {
   config_->setSecretUpdateCallback([this]() { onAddOrUpdateSecret(); });
+  config_->setSessionTicketKeysUpdateCallback([this]() { onSessionTicketKeysUpdate(); });
 }
 
 Network::TransportSocketPtr ServerSslSocketFactory::createTransportSocket() const {
+  if (lazy_ssl_ctx_ != nullptr) {
+    ServerContextSharedPtr ssl_ctx = lazy_ssl_ctx_->get();
+    if (ssl_ctx == nullptr) {
+      stats_.downstream_context_build_failed_.inc();
+      return std::make_unique<NotReadySslSocket>();
+    }
+    return std::make_unique<Ssl::SslSocket>(std::move(ssl_ctx), Ssl::InitialState::Server);
+  }
+
   // onAddOrUpdateSecret() could be invoked in the middle of checking the existence of ssl_ctx and
   // creating SslSocket using ssl_ctx. Capture ssl_ctx_ into a local variable so that we check and
   // use the same ssl_ctx to create SslSocket.
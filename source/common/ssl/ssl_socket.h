@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <string>
 
+#include "envoy/common/time.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/secret/secret_callbacks.h"
@@ -11,6 +12,7 @@
 
 #include "common/common/logger.h"
 #include "common/ssl/context_impl.h"
+#include "common/ssl/private_key_operations.h"
 
 #include "absl/synchronization/mutex.h"
 #include "openssl/ssl.h"
@@ -21,8 +23,10 @@ namespace Ssl {
 // clang-format off
 #define ALL_SSL_SOCKET_FACTORY_STATS(COUNTER)                                 \
   COUNTER(ssl_context_update_by_sds)                                          \
+  COUNTER(session_ticket_keys_update_by_sds)                                  \
   COUNTER(upstream_context_secrets_not_ready)                                 \
-  COUNTER(downstream_context_secrets_not_ready)
+  COUNTER(downstream_context_secrets_not_ready)                               \
+  COUNTER(downstream_context_build_failed)
 // clang-format on
 
 /**
@@ -66,6 +70,11 @@ public:
 
 private:
   Network::PostIoAction doHandshake();
+  void enableKernelTls();
+  Network::IoResult doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream);
+  void restartRampUpIfIdle();
+  uint64_t recordSize();
+  uint32_t segmentRecordSize() const;
   void drainErrorQueue();
   void shutdownSsl();
 
@@ -77,9 +86,18 @@ private:
   Network::TransportSocketCallbacks* callbacks_{};
   ContextImplSharedPtr ctx_;
   bssl::UniquePtr<SSL> ssl_;
+  // Declared after ssl_ so that it is destroyed first.
+  PrivateKeyOperationsPtr private_key_operations_;
   bool handshake_complete_{};
   bool shutdown_sent_{};
+  // Once set, records sent are encrypted by the kernel and the SSL must not write to the socket.
+  bool kernel_tls_tx_{};
   uint64_t bytes_to_retry_{};
+  // Dynamic record sizing state: bytes sent since the connection started ramping up, and the size
+  // of small records, once known.
+  uint64_t ramp_up_bytes_sent_{};
+  uint32_t small_record_size_{};
+  MonotonicTime last_write_time_;
   mutable std::string cached_sha_256_peer_certificate_digest_;
   mutable std::string cached_url_encoded_pem_encoded_peer_certificate_;
 };
@@ -120,11 +138,15 @@ public:
   void onAddOrUpdateSecret() override;
 
 private:
+  void onSessionTicketKeysUpdate();
+
   Ssl::ContextManager& manager_;
   Stats::Scope& stats_scope_;
   SslSocketFactoryStats stats_;
   ServerContextConfigPtr config_;
   const std::vector<std::string> server_names_;
+  // Set if the context is built on the first connection instead of ssl_ctx_.
+  const LazyServerContextPtr lazy_ssl_ctx_;
   mutable absl::Mutex ssl_ctx_mu_;
   ServerContextSharedPtr ssl_ctx_ GUARDED_BY(ssl_ctx_mu_);
 };
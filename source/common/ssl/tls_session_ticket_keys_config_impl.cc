@@ -0,0 +1,51 @@
+#include "common/ssl/tls_session_ticket_keys_config_impl.h"
+
+#include <algorithm>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/config/datasource.h"
+
+namespace Envoy {
+namespace Ssl {
+
+TlsSessionTicketKeysConfigImpl::TlsSessionTicketKeysConfigImpl(
+    const envoy::api::v2::auth::TlsSessionTicketKeys& config) {
+  for (const auto& datasource : config.keys()) {
+    validateAndAppendKey(keys_, Config::DataSource::read(datasource, false));
+  }
+}
+
+// Append a SessionTicketKey to keys, initializing it with key_data.
+// Throws if key_data is invalid.
+void TlsSessionTicketKeysConfigImpl::validateAndAppendKey(
+    std::vector<ServerContextConfig::SessionTicketKey>& keys, const std::string& key_data) {
+  // If this changes, need to figure out how to deal with key files
+  // that previously worked. For now, just assert so we'll notice that
+  // it changed if it does.
+  static_assert(sizeof(ServerContextConfig::SessionTicketKey) == 80,
+                "Input is expected to be this size");
+
+  if (key_data.size() != sizeof(ServerContextConfig::SessionTicketKey)) {
+    throw EnvoyException(fmt::format("Incorrect TLS session ticket key length. "
+                                     "Length {}, expected length {}.",
+                                     key_data.size(),
+                                     sizeof(ServerContextConfig::SessionTicketKey)));
+  }
+
+  keys.emplace_back();
+  ServerContextConfig::SessionTicketKey& dst_key = keys.back();
+
+  std::copy_n(key_data.begin(), dst_key.name_.size(), dst_key.name_.begin());
+  size_t pos = dst_key.name_.size();
+  std::copy_n(key_data.begin() + pos, dst_key.hmac_key_.size(), dst_key.hmac_key_.begin());
+  pos += dst_key.hmac_key_.size();
+  std::copy_n(key_data.begin() + pos, dst_key.aes_key_.size(), dst_key.aes_key_.begin());
+  pos += dst_key.aes_key_.size();
+  ASSERT(key_data.begin() + pos == key_data.end());
+}
+
+} // namespace Ssl
+} // namespace Envoy
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "envoy/api/v2/auth/cert.pb.h"
+#include "envoy/ssl/tls_session_ticket_keys_config.h"
+
+namespace Envoy {
+namespace Ssl {
+
+class TlsSessionTicketKeysConfigImpl : public TlsSessionTicketKeysConfig {
+public:
+  TlsSessionTicketKeysConfigImpl(const envoy::api::v2::auth::TlsSessionTicketKeys& config);
+
+  const std::vector<ServerContextConfig::SessionTicketKey>& keys() const override { return keys_; }
+
+private:
+  static void validateAndAppendKey(std::vector<ServerContextConfig::SessionTicketKey>& keys,
+                                   const std::string& key_data);
+
+  std::vector<ServerContextConfig::SessionTicketKey> keys_;
+};
+
+} // namespace Ssl
+} // namespace Envoy
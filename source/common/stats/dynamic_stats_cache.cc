@@ -0,0 +1,66 @@
+#include "common/stats/dynamic_stats_cache.h"
+
+namespace Envoy {
+namespace Stats {
+
+constexpr uint32_t DynamicStatsCache::DEFAULT_MAX_ENTRIES;
+
+DynamicStatsCache::DynamicStatsCache(Scope& scope, ThreadLocal::SlotAllocator& tls,
+                                     uint32_t max_entries)
+    : scope_(scope), max_entries_(max_entries), tls_(tls.allocateSlot()) {
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalCache>();
+  });
+}
+
+Counter& DynamicStatsCache::counter(std::initializer_list<absl::string_view> name) {
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  const absl::string_view joined = cache.join(name);
+  auto it = cache.counters_.find(joined);
+  if (it != cache.counters_.end()) {
+    return *it->second;
+  }
+
+  Counter& counter = scope_.counter(cache.name_);
+  cache.counters_.emplace(cache.store(max_entries_), &counter);
+  return counter;
+}
+
+Histogram& DynamicStatsCache::histogram(std::initializer_list<absl::string_view> name) {
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  const absl::string_view joined = cache.join(name);
+  auto it = cache.histograms_.find(joined);
+  if (it != cache.histograms_.end()) {
+    return *it->second;
+  }
+
+  Histogram& histogram = scope_.histogram(cache.name_);
+  cache.histograms_.emplace(cache.store(max_entries_), &histogram);
+  return histogram;
+}
+
+size_t DynamicStatsCache::size() { return tls_->getTyped<ThreadLocalCache>().names_.size(); }
+
+absl::string_view
+DynamicStatsCache::ThreadLocalCache::join(std::initializer_list<absl::string_view> name) {
+  name_.clear();
+  for (const absl::string_view piece : name) {
+    name_.append(piece.data(), piece.size());
+  }
+  return name_;
+}
+
+absl::string_view DynamicStatsCache::ThreadLocalCache::store(uint32_t max_entries) {
+  // The stats are owned by the scope, so dropping them from the cache does not invalidate the
+  // references handed out before.
+  if (names_.size() >= max_entries) {
+    counters_.clear();
+    histograms_.clear();
+    names_.clear();
+  }
+  names_.push_back(name_);
+  return names_.back();
+}
+
+} // namespace Stats
+} // namespace Envoy
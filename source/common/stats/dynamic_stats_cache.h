@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/utility.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Per-worker cache of the counters and histograms whose names are built from request data, such
+ * as the collection of a mongo query or the table of a DynamoDB request. A name is given as the
+ * pieces it is made of, which are joined into a buffer of the worker, so that a cache hit neither
+ * allocates nor looks the stat up in the scope. Each worker caches at most max_entries stats and
+ * starts over once it is full, which bounds its memory whatever the cardinality of the names.
+ */
+class DynamicStatsCache {
+public:
+  static constexpr uint32_t DEFAULT_MAX_ENTRIES = 4096;
+
+  DynamicStatsCache(Scope& scope, ThreadLocal::SlotAllocator& tls,
+                    uint32_t max_entries = DEFAULT_MAX_ENTRIES);
+
+  /**
+   * @param name supplies the pieces of the name of the counter, relative to the scope.
+   * @return Counter& the counter, owned by the scope.
+   */
+  Counter& counter(std::initializer_list<absl::string_view> name);
+
+  /**
+   * @param name supplies the pieces of the name of the histogram, relative to the scope.
+   * @return Histogram& the histogram, owned by the scope.
+   */
+  Histogram& histogram(std::initializer_list<absl::string_view> name);
+
+  /**
+   * @return size_t the number of stats cached by the calling thread.
+   */
+  size_t size();
+
+private:
+  struct ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
+    // Joins the pieces of a name into name_.
+    absl::string_view join(std::initializer_list<absl::string_view> name);
+    // Copies name_ into names_, after emptying the cache if it is full.
+    absl::string_view store(uint32_t max_entries);
+
+    std::string name_;
+    // The names of the cached stats, which are referenced by the keys of the maps.
+    std::deque<std::string> names_;
+    std::unordered_map<absl::string_view, Counter*, StringViewHash> counters_;
+    std::unordered_map<absl::string_view, Histogram*, StringViewHash> histograms_;
+  };
+
+  Scope& scope_;
+  const uint32_t max_entries_;
+  ThreadLocal::SlotPtr tls_;
+};
+
+typedef std::shared_ptr<DynamicStatsCache> DynamicStatsCacheSharedPtr;
+
+} // namespace Stats
+} // namespace Envoy
@@ -6,7 +6,10 @@
 namespace Envoy {
 namespace Stats {
 
-HeapStatData::HeapStatData(absl::string_view key) : name_(key.data(), key.size()) {}
+HeapStatData::HeapStatData(SymbolVec&& symbols, SymbolTableImpl& symbol_table)
+    : symbols_(std::move(symbols)), symbol_table_(symbol_table) {}
+
+HeapStatData::~HeapStatData() { symbol_table_.free(symbols_); }
 
 HeapStatDataAllocator::HeapStatDataAllocator() {}
 
@@ -15,7 +18,9 @@ HeapStatDataAllocator::~HeapStatDataAllocator() { ASSERT(stats_.empty()); }
 HeapStatData* HeapStatDataAllocator::alloc(absl::string_view name) {
   // Any expected truncation of name is done at the callsite. No truncation is
   // required to use this allocator.
-  auto data = std::make_unique<HeapStatData>(name);
+  // If a stat with the same name exists, the symbols encoded here are released again when data is
+  // destroyed.
+  auto data = std::make_unique<HeapStatData>(symbol_table_.encodeSymbols(name), symbol_table_);
   Thread::ReleasableLockGuard lock(mutex_);
   auto ret = stats_.insert(data.get());
   HeapStatData* existing_data = *ret.first;
@@ -8,32 +8,37 @@
 #include "common/common/thread.h"
 #include "common/common/thread_annotations.h"
 #include "common/stats/stat_data_allocator_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 namespace Envoy {
 namespace Stats {
 
 /**
  * This structure is an alternate backing store for both CounterImpl and GaugeImpl. It is designed
- * so that it can be allocated efficiently from the heap on demand.
+ * so that it can be allocated efficiently from the heap on demand. The name is stored as symbols
+ * in the allocator's symbol table, so that the segments shared by many stats (such as a cluster
+ * name, or the stat name within the cluster) are only stored once.
  */
 struct HeapStatData {
-  explicit HeapStatData(absl::string_view key);
+  HeapStatData(SymbolVec&& symbols, SymbolTableImpl& symbol_table);
+  ~HeapStatData();
 
   /**
-   * @returns absl::string_view the name as a string_view.
+   * @returns const SymbolVec& the encoded name.
    */
-  absl::string_view key() const { return name_; }
+  const SymbolVec& symbols() const { return symbols_; }
 
   /**
-   * @returns std::string the name as a std::string.
+   * @returns std::string the name decoded as a std::string.
    */
-  std::string name() const { return name_; }
+  std::string name() const { return symbol_table_.decode(symbols_); }
 
   std::atomic<uint64_t> value_{0};
   std::atomic<uint64_t> pending_increment_{0};
   std::atomic<uint16_t> flags_{0};
   std::atomic<uint16_t> ref_count_{1};
-  std::string name_;
+  const SymbolVec symbols_;
+  SymbolTableImpl& symbol_table_;
 };
 
 /**
@@ -54,25 +59,30 @@ public:
 
 private:
   struct HeapStatHash_ {
-    size_t operator()(const HeapStatData* a) const { return HashUtil::xxHash64(a->key()); }
+    size_t operator()(const HeapStatData* a) const {
+      const SymbolVec& symbols = a->symbols();
+      return HashUtil::xxHash64(absl::string_view(reinterpret_cast<const char*>(symbols.data()),
+                                                  symbols.size() * sizeof(Symbol)));
+    }
   };
   struct HeapStatCompare_ {
     bool operator()(const HeapStatData* a, const HeapStatData* b) const {
-      return (a->key() == b->key());
+      return (a->symbols() == b->symbols());
     }
   };
 
-  // TODO(jmarantz): See https://github.com/envoyproxy/envoy/pull/3927 and
-  //  https://github.com/envoyproxy/envoy/issues/3585, which can help reorganize
-  // the heap stats using a ref-counted symbol table to compress the stat strings.
   typedef std::unordered_set<HeapStatData*, HeapStatHash_, HeapStatCompare_> StatSet;
 
-  // An unordered set of HeapStatData pointers which keys off the key()
+  // Declared first so that it outlives the stats referencing it.
+  SymbolTableImpl symbol_table_;
+
+  // An unordered set of HeapStatData pointers which keys off the symbols()
   // field in each object. This necessitates a custom comparator and hasher.
   StatSet stats_ GUARDED_BY(mutex_);
   // A mutex is needed here to protect the stats_ object from both alloc() and free() operations.
-  // Although alloc() operations are called under existing locking, free() operations are made from
-  // the destructors of the individual stat objects, which are not protected by locks.
+  // alloc() operations are only locked per scope by the store, so they may run concurrently for
+  // different scopes, and free() operations are made from the destructors of the individual stat
+  // objects, which are not protected by locks.
   Thread::MutexBasicLockable mutex_;
 };
 
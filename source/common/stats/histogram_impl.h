@@ -63,5 +63,29 @@ private:
   const std::string name_;
 };
 
+/**
+ * Histogram that discards its values, handed out in place of histograms that are not created.
+ */
+class NullHistogramImpl : public ParentHistogram, public MetricImpl {
+public:
+  NullHistogramImpl() : MetricImpl(std::string(), std::vector<Tag>()) {}
+
+  // Stats::Metric
+  const std::string name() const override { return ""; }
+  bool used() const override { return false; }
+
+  // Stats::Histogram
+  void recordValue(uint64_t) override {}
+
+  // Stats::ParentHistogram
+  void merge() override {}
+  const HistogramStatistics& intervalStatistics() const override { return statistics_; }
+  const HistogramStatistics& cumulativeStatistics() const override { return statistics_; }
+  const std::string summary() const override { return ""; }
+
+private:
+  const HistogramStatisticsImpl statistics_;
+};
+
 } // namespace Stats
 } // namespace Envoy
@@ -24,10 +24,60 @@ std::vector<ParentHistogramSharedPtr>& SourceImpl::cachedHistograms() {
   return *histograms_;
 }
 
+const std::vector<CounterSnapshot>& SourceImpl::cachedCounterSnapshots() {
+  if (!counter_snapshots_) {
+    counter_snapshots_.emplace();
+    const std::vector<CounterSharedPtr>& counters = cachedCounters();
+    counter_snapshots_->reserve(counters.size());
+    for (const CounterSharedPtr& counter : counters) {
+      if (!counter->used()) {
+        continue;
+      }
+      const uint64_t delta = counter->latch();
+      if (delta != 0 || !changed_only_) {
+        counter_snapshots_->push_back({*counter, delta});
+      }
+    }
+  }
+  return *counter_snapshots_;
+}
+
+const std::vector<GaugeSnapshot>& SourceImpl::cachedGaugeSnapshots() {
+  if (!gauge_snapshots_) {
+    gauge_snapshots_.emplace();
+    const std::vector<GaugeSharedPtr>& gauges = cachedGauges();
+    gauge_snapshots_->reserve(gauges.size());
+    std::unordered_map<const Gauge*, uint64_t> gauge_values;
+    for (const GaugeSharedPtr& gauge : gauges) {
+      if (!gauge->used()) {
+        continue;
+      }
+      const uint64_t value = gauge->value();
+      if (changed_only_) {
+        auto previous = previous_gauge_values_.find(gauge.get());
+        gauge_values.emplace(gauge.get(), value);
+        if (previous != previous_gauge_values_.end() && previous->second == value) {
+          continue;
+        }
+      }
+      gauge_snapshots_->push_back({*gauge, value});
+    }
+    previous_gauge_values_.swap(gauge_values);
+    if (changed_only_) {
+      previous_gauges_ = gauges;
+    } else {
+      previous_gauges_.clear();
+    }
+  }
+  return *gauge_snapshots_;
+}
+
 void SourceImpl::clearCache() {
   counters_.reset();
   gauges_.reset();
   histograms_.reset();
+  counter_snapshots_.reset();
+  gauge_snapshots_.reset();
 }
 
 } // namespace Stats
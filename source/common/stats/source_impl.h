@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_map>
+
 #include "envoy/stats/source.h"
 #include "envoy/stats/stats.h"
 #include "envoy/stats/store.h"
@@ -17,13 +19,23 @@ public:
   std::vector<CounterSharedPtr>& cachedCounters() override;
   std::vector<GaugeSharedPtr>& cachedGauges() override;
   std::vector<ParentHistogramSharedPtr>& cachedHistograms() override;
+  const std::vector<CounterSnapshot>& cachedCounterSnapshots() override;
+  const std::vector<GaugeSnapshot>& cachedGaugeSnapshots() override;
+  void setChangedMetricsOnly(bool changed_only) override { changed_only_ = changed_only; }
   void clearCache() override;
 
 private:
   Store& store_;
+  bool changed_only_{};
   absl::optional<std::vector<CounterSharedPtr>> counters_;
   absl::optional<std::vector<GaugeSharedPtr>> gauges_;
   absl::optional<std::vector<ParentHistogramSharedPtr>> histograms_;
+  absl::optional<std::vector<CounterSnapshot>> counter_snapshots_;
+  absl::optional<std::vector<GaugeSnapshot>> gauge_snapshots_;
+  // The gauge values of the previous snapshot, used to leave out unchanged gauges. The gauges are
+  // kept alive until the next snapshot so that their addresses are not reused in the meantime.
+  std::vector<GaugeSharedPtr> previous_gauges_;
+  std::unordered_map<const Gauge*, uint64_t> previous_gauge_values_;
 };
 
 } // namespace Stats
@@ -0,0 +1,43 @@
+#include "common/stats/stage_timer.h"
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Stats {
+
+std::atomic<const StageTimers::State*> StageTimers::state_{nullptr};
+
+StageTimerStats StageTimers::generateStats(Scope& scope, const std::string& prefix) {
+  return {ALL_STAGE_TIMER_STATS(POOL_HISTOGRAM_PREFIX(scope, prefix))};
+}
+
+void StageTimers::enable(StageTimerStats& stats, uint32_t sample_interval) {
+  ASSERT(sample_interval > 0);
+  State* state = new State{{&stats.http_codec_dispatch_ns_, &stats.http_decoder_filters_ns_,
+                            &stats.http_encoder_filters_ns_, &stats.lb_choose_host_ns_,
+                            &stats.tls_read_ns_, &stats.tls_write_ns_},
+                           sample_interval};
+  delete state_.exchange(state);
+}
+
+void StageTimers::disable() { delete state_.exchange(nullptr); }
+
+Histogram* StageTimers::sample(Stage stage) {
+  const State* state = state_.load(std::memory_order_acquire);
+  if (state == nullptr) {
+    return nullptr;
+  }
+
+  // Counting the executions per stage rather than per thread keeps a stage from being skipped
+  // by the interval lining up with the number of stages a request goes through.
+  static thread_local std::array<uint32_t, NumStages> executions{};
+  const size_t index = static_cast<size_t>(stage);
+  if (++executions[index] < state->sample_interval_) {
+    return nullptr;
+  }
+  executions[index] = 0;
+  return state->histograms_[index];
+}
+
+} // namespace Stats
+} // namespace Envoy
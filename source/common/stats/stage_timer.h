@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * All hot path stage stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_STAGE_TIMER_STATS(HISTOGRAM)                                                           \
+  HISTOGRAM(http_codec_dispatch_ns)                                                                \
+  HISTOGRAM(http_decoder_filters_ns)                                                               \
+  HISTOGRAM(http_encoder_filters_ns)                                                               \
+  HISTOGRAM(lb_choose_host_ns)                                                                     \
+  HISTOGRAM(tls_read_ns)                                                                           \
+  HISTOGRAM(tls_write_ns)
+// clang-format on
+
+/**
+ * Struct definition for all hot path stage stats. @see stats_macros.h
+ */
+struct StageTimerStats {
+  ALL_STAGE_TIMER_STATS(GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * Hot path stages, in the order of ALL_STAGE_TIMER_STATS.
+ */
+enum class Stage {
+  HttpCodecDispatch,
+  HttpDecoderFilters,
+  HttpEncoderFilters,
+  LbChooseHost,
+  TlsRead,
+  TlsWrite,
+};
+
+/**
+ * Process wide switch of the hot path stage timing. Once enabled, each thread times one in every
+ * sample_interval executions of each stage, so that most executions skip the clock reads and the
+ * histogram update.
+ */
+class StageTimers {
+public:
+  static constexpr size_t NumStages = 6;
+
+  static StageTimerStats generateStats(Scope& scope, const std::string& prefix);
+
+  /**
+   * Start timing the stages.
+   * @param stats supplies the histograms the stages are recorded in, which must outlive the
+   *        timing until disable().
+   * @param sample_interval supplies the number of executions of a stage per timed execution.
+   */
+  static void enable(StageTimerStats& stats, uint32_t sample_interval);
+
+  /**
+   * Stop timing the stages. Threads which may be timing a stage must have stopped beforehand.
+   */
+  static void disable();
+
+  /**
+   * @return Histogram* the histogram an execution of the stage is recorded in, or nullptr if the
+   *         execution is not timed.
+   */
+  static Histogram* sample(Stage stage);
+
+private:
+  struct State {
+    std::array<Histogram*, NumStages> histograms_;
+    uint32_t sample_interval_;
+  };
+
+  static std::atomic<const State*> state_;
+};
+
+/**
+ * Times an execution of a hot path stage, from construction to destruction.
+ */
+class StageTimer {
+public:
+  explicit StageTimer(Stage stage) : histogram_(StageTimers::sample(stage)) {
+    if (histogram_ != nullptr) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~StageTimer() {
+    if (histogram_ != nullptr) {
+      histogram_->recordValue(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now() - start_)
+                                  .count());
+    }
+  }
+
+private:
+  Histogram* const histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace Stats
+} // namespace Envoy
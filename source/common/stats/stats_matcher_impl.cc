@@ -0,0 +1,79 @@
+#include "common/stats/stats_matcher_impl.h"
+
+#include "common/common/assert.h"
+#include "common/common/regex.h"
+
+#include "absl/strings/match.h"
+
+namespace Envoy {
+namespace Stats {
+
+StatsMatcherImpl::StatsMatcherImpl(const envoy::config::metrics::v2::StatsConfig& config) {
+  const envoy::config::metrics::v2::StatsMatcher& matcher = config.stats_matcher();
+  const envoy::type::matcher::ListStringMatcher* patterns = nullptr;
+  switch (matcher.stats_matcher_case()) {
+  case envoy::config::metrics::v2::StatsMatcher::kRejectAll:
+    // Rejecting all stats is an empty inclusion list, accepting all an empty exclusion list.
+    is_inclusive_ = matcher.reject_all();
+    return;
+  case envoy::config::metrics::v2::StatsMatcher::kExclusionList:
+    is_inclusive_ = false;
+    patterns = &matcher.exclusion_list();
+    break;
+  case envoy::config::metrics::v2::StatsMatcher::kInclusionList:
+    patterns = &matcher.inclusion_list();
+    break;
+  default:
+    // No matcher, so all stats are created.
+    is_inclusive_ = false;
+    return;
+  }
+
+  for (const auto& pattern : patterns->patterns()) {
+    switch (pattern.match_pattern_case()) {
+    case envoy::type::matcher::StringMatcher::kExact:
+      exact_names_.insert(pattern.exact());
+      break;
+    case envoy::type::matcher::StringMatcher::kPrefix:
+      prefixes_.push_back(pattern.prefix());
+      break;
+    case envoy::type::matcher::StringMatcher::kSuffix:
+      suffixes_.push_back(pattern.suffix());
+      break;
+    case envoy::type::matcher::StringMatcher::kRegex:
+      regexes_.push_back(Regex::Utility::parseRegex(pattern.regex()));
+      break;
+    default:
+      NOT_REACHED_GCOVR_EXCL_LINE;
+    }
+  }
+}
+
+bool StatsMatcherImpl::rejects(const std::string& name) const {
+  return is_inclusive_ != matchesAny(name);
+}
+
+bool StatsMatcherImpl::matchesAny(const std::string& name) const {
+  if (exact_names_.count(name) > 0) {
+    return true;
+  }
+  for (const std::string& prefix : prefixes_) {
+    if (absl::StartsWith(name, prefix)) {
+      return true;
+    }
+  }
+  for (const std::string& suffix : suffixes_) {
+    if (absl::EndsWith(name, suffix)) {
+      return true;
+    }
+  }
+  for (const Regex::CompiledMatcherPtr& regex : regexes_) {
+    if (regex->match(name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace Stats
+} // namespace Envoy
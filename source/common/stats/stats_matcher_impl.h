@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "envoy/common/regex.h"
+#include "envoy/config/metrics/v2/stats.pb.h"
+#include "envoy/stats/stats_matcher.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Matches stat names against the exclusion or inclusion list of a StatsConfig. Exact names are
+ * looked up in a hash set, and the regexes are compiled with the default regex engine.
+ */
+class StatsMatcherImpl : public StatsMatcher {
+public:
+  StatsMatcherImpl(const envoy::config::metrics::v2::StatsConfig& config);
+
+  // Stats::StatsMatcher
+  bool rejects(const std::string& name) const override;
+
+private:
+  bool matchesAny(const std::string& name) const;
+
+  // Whether the patterns list the stats to create rather than those to reject.
+  bool is_inclusive_{true};
+  std::unordered_set<std::string> exact_names_;
+  std::vector<std::string> prefixes_;
+  std::vector<std::string> suffixes_;
+  std::vector<Regex::CompiledMatcherPtr> regexes_;
+};
+
+} // namespace Stats
+} // namespace Envoy
@@ -13,42 +13,97 @@ namespace Stats {
 // if they appear in stat names. We don't want to waste time symbolizing an integer as an integer,
 // if we can help it.
 StatNamePtr SymbolTableImpl::encode(const absl::string_view name) {
+  return std::make_unique<StatNameImpl>(encodeSymbols(name), *this);
+}
+
+SymbolVec SymbolTableImpl::encodeSymbols(const absl::string_view name) {
   SymbolVec symbol_vec;
   std::vector<absl::string_view> name_vec = absl::StrSplit(name, '.');
   symbol_vec.reserve(name_vec.size());
-  std::transform(name_vec.begin(), name_vec.end(), std::back_inserter(symbol_vec),
-                 [this](absl::string_view x) { return toSymbol(x); });
-
-  return std::make_unique<StatNameImpl>(symbol_vec, *this);
+  {
+    absl::ReaderMutexLock lock(&lock_);
+    for (absl::string_view segment : name_vec) {
+      Symbol symbol;
+      if (!findSymbol(segment, symbol)) {
+        break;
+      }
+      symbol_vec.push_back(symbol);
+    }
+  }
+  if (symbol_vec.size() < name_vec.size()) {
+    // Segments that are new to the table are added under the exclusive lock.
+    absl::MutexLock lock(&lock_);
+    for (size_t i = symbol_vec.size(); i < name_vec.size(); ++i) {
+      symbol_vec.push_back(toSymbol(name_vec[i]));
+    }
+  }
+  return symbol_vec;
 }
 
 std::string SymbolTableImpl::decode(const SymbolVec& symbol_vec) const {
   std::vector<absl::string_view> name;
   name.reserve(symbol_vec.size());
-  std::transform(symbol_vec.begin(), symbol_vec.end(), std::back_inserter(name),
-                 [this](Symbol x) { return fromSymbol(x); });
+  // The decoded segments are only valid while locked, as a concurrent free() may erase them.
+  absl::ReaderMutexLock lock(&lock_);
+  for (Symbol symbol : symbol_vec) {
+    name.push_back(fromSymbol(symbol));
+  }
   return absl::StrJoin(name, ".");
 }
 
 void SymbolTableImpl::free(const SymbolVec& symbol_vec) {
-  for (const Symbol symbol : symbol_vec) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
+  // Release the references under the shared lock, and only take the exclusive lock if one of them
+  // was the last.
+  std::vector<Symbol> unused;
+  {
+    absl::ReaderMutexLock lock(&lock_);
+    for (const Symbol symbol : symbol_vec) {
+      auto decode_search = decode_map_.find(symbol);
+      ASSERT(decode_search != decode_map_.end());
+
+      auto encode_search = encode_map_.find(decode_search->second);
+      ASSERT(encode_search != encode_map_.end());
+
+      if (--encode_search->second.ref_count_ == 0) {
+        unused.push_back(symbol);
+      }
+    }
+  }
+  if (unused.empty()) {
+    return;
+  }
 
+  absl::MutexLock lock(&lock_);
+  for (const Symbol symbol : unused) {
+    // Another thread may have taken a new reference to the symbol before the lock was taken, or
+    // erased it already after this thread's reference was followed by another one, which was also
+    // released. In the latter case the symbol may even have been reused for a different string.
+    auto decode_search = decode_map_.find(symbol);
+    if (decode_search == decode_map_.end()) {
+      continue;
+    }
     auto encode_search = encode_map_.find(decode_search->second);
     ASSERT(encode_search != encode_map_.end());
-
-    encode_search->second.ref_count_--;
     // If that was the last remaining client usage of the symbol, erase the the current
     // mappings and add the now-unused symbol to the reuse pool.
     if (encode_search->second.ref_count_ == 0) {
-      decode_map_.erase(decode_search);
       encode_map_.erase(encode_search);
+      decode_map_.erase(decode_search);
       pool_.push(symbol);
     }
   }
 }
 
+bool SymbolTableImpl::findSymbol(absl::string_view sv, Symbol& symbol) {
+  auto encode_find = encode_map_.find(sv);
+  if (encode_find == encode_map_.end()) {
+    return false;
+  }
+  ++(encode_find->second.ref_count_);
+  symbol = encode_find->second.symbol_;
+  return true;
+}
+
 Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
   Symbol result;
   auto encode_find = encode_map_.find(sv);
@@ -61,8 +116,7 @@ Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
     auto decode_insert = decode_map_.insert({next_symbol_, std::move(str)});
     ASSERT(decode_insert.second);
 
-    auto encode_insert = encode_map_.insert(
-        {decode_insert.first->second, {.symbol_ = next_symbol_, .ref_count_ = 1}});
+    auto encode_insert = encode_map_.emplace(decode_insert.first->second, next_symbol_);
     ASSERT(encode_insert.second);
 
     result = next_symbol_;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <stack>
 #include <string>
@@ -11,10 +12,12 @@
 #include "envoy/stats/symbol_table.h"
 
 #include "common/common/assert.h"
+#include "common/common/thread_annotations.h"
 #include "common/common/utility.h"
 
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace Stats {
@@ -29,6 +32,12 @@ using SymbolVec = std::vector<Symbol>;
  * effect of the non-monotonically-increasing symbol counter is that if a string is encoded, the
  * resulting stat is destroyed, and then that same string is re-encoded, it may or may not encode to
  * the same underlying symbol.
+ *
+ * The table is thread safe, as stats are created from any thread. Most stats are created with
+ * segments that are already in the table (such as the names of other stats of the same cluster),
+ * and decoded for flushes and admin output, so those lookups, and releasing references that
+ * leave a symbol in use, only take the table's lock shared. Only adding and erasing symbols take
+ * it exclusively.
  */
 class SymbolTableImpl : public SymbolTable {
 public:
@@ -36,18 +45,20 @@ public:
 
   // For testing purposes only.
   size_t size() const override {
+    absl::ReaderMutexLock lock(&lock_);
     ASSERT(encode_map_.size() == decode_map_.size());
     return encode_map_.size();
   }
 
-private:
-  friend class StatNameImpl;
-  friend class StatNameTest;
-
-  struct SharedSymbol {
-    Symbol symbol_;
-    uint32_t ref_count_;
-  };
+  /**
+   * Encodes a stat name into a vector of symbols, without wrapping it in a StatName. This is
+   * intended for stat storage that manages the symbol references itself, such as
+   * HeapStatDataAllocator. The symbols must be released with free().
+   *
+   * @param name the stat name to encode.
+   * @return SymbolVec the encoded name.
+   */
+  SymbolVec encodeSymbols(absl::string_view name);
 
   /**
    * Decodes a vector of symbols back into its period-delimited stat name.
@@ -68,13 +79,36 @@ private:
    */
   void free(const SymbolVec& symbol_vec);
 
+private:
+  friend class StatNameImpl;
+  friend class StatNameTest;
+
+  struct SharedSymbol {
+    SharedSymbol(Symbol symbol) : symbol_(symbol) {}
+
+    const Symbol symbol_;
+    // Changed under the shared lock. A symbol whose count dropped to zero is only erased under the
+    // exclusive lock if no encode() took a new reference to it in the meantime.
+    std::atomic<uint32_t> ref_count_{1};
+  };
+
+  /**
+   * Convenience function for encode(), taking a reference to the symbol of a string segment that
+   * is already in the table.
+   *
+   * @param sv the individual string to be encoded as a symbol.
+   * @param symbol receives the symbol of the string, if found.
+   * @return bool whether the string was found.
+   */
+  bool findSymbol(absl::string_view sv, Symbol& symbol) SHARED_LOCKS_REQUIRED(lock_);
+
   /**
    * Convenience function for encode(), symbolizing one string segment at a time.
    *
    * @param sv the individual string to be encoded as a symbol.
    * @return Symbol the encoded string.
    */
-  Symbol toSymbol(absl::string_view sv);
+  Symbol toSymbol(absl::string_view sv) EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   /**
    * Convenience function for decode(), decoding one symbol at a time.
@@ -82,10 +116,10 @@ private:
    * @param symbol the individual symbol to be decoded.
    * @return absl::string_view the decoded string.
    */
-  absl::string_view fromSymbol(Symbol symbol) const;
+  absl::string_view fromSymbol(Symbol symbol) const SHARED_LOCKS_REQUIRED(lock_);
 
   // Stages a new symbol for use. To be called after a successful insertion.
-  void newSymbol() {
+  void newSymbol() EXCLUSIVE_LOCKS_REQUIRED(lock_) {
     if (pool_.empty()) {
       next_symbol_ = ++monotonic_counter_;
     } else {
@@ -96,25 +130,31 @@ private:
     ASSERT(monotonic_counter_ != 0);
   }
 
-  Symbol monotonicCounter() { return monotonic_counter_; }
+  Symbol monotonicCounter() {
+    absl::ReaderMutexLock lock(&lock_);
+    return monotonic_counter_;
+  }
+
+  mutable absl::Mutex lock_;
 
   // Stores the symbol to be used at next insertion. This should exist ahead of insertion time so
   // that if insertion succeeds, the value written is the correct one.
-  Symbol next_symbol_ = 0;
+  Symbol next_symbol_ GUARDED_BY(lock_) = 0;
 
   // If the free pool is exhausted, we monotonically increase this counter.
-  Symbol monotonic_counter_ = 0;
+  Symbol monotonic_counter_ GUARDED_BY(lock_) = 0;
 
   // Bimap implementation.
   // The encode map stores both the symbol and the ref count of that symbol.
   // Using absl::string_view lets us only store the complete string once, in the decode map.
-  std::unordered_map<absl::string_view, SharedSymbol, StringViewHash> encode_map_;
-  std::unordered_map<Symbol, std::string> decode_map_;
+  std::unordered_map<absl::string_view, SharedSymbol, StringViewHash> encode_map_
+      GUARDED_BY(lock_);
+  std::unordered_map<Symbol, std::string> decode_map_ GUARDED_BY(lock_);
 
   // Free pool of symbols for re-use.
   // TODO(ambuc): There might be an optimization here relating to storing ranges of freed symbols
   // using an Envoy::IntervalSet.
-  std::stack<Symbol> pool_;
+  std::stack<Symbol> pool_ GUARDED_BY(lock_);
 };
 
 /**
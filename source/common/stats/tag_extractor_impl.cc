@@ -2,15 +2,19 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <string>
 
 #include "envoy/common/exception.h"
 
+#include "common/common/fmt.h"
 #include "common/common/perf_annotation.h"
-#include "common/common/utility.h"
+#include "common/common/regex.h"
 
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/strip.h"
 
 namespace Envoy {
 namespace Stats {
@@ -21,12 +25,15 @@ bool regexStartsWithDot(absl::string_view regex) {
   return absl::StartsWith(regex, "\\.") || absl::StartsWith(regex, "(?=\\.)");
 }
 
+// The characters matched by \w.
+bool isWordCharacter(char c) { return absl::ascii_isalnum(c) || c == '_'; }
+
 } // namespace
 
 TagExtractorImpl::TagExtractorImpl(const std::string& name, const std::string& regex,
                                    const std::string& substr)
     : name_(name), prefix_(std::string(extractRegexPrefix(regex))), substr_(substr),
-      regex_(RegexUtil::parseRegex(regex)) {}
+      regex_(Regex::Utility::parseRegex(regex)) {}
 
 std::string TagExtractorImpl::extractRegexPrefix(absl::string_view regex) {
   std::string prefix;
@@ -59,6 +66,15 @@ TagExtractorPtr TagExtractorImpl::createTagExtractor(const std::string& name,
     throw EnvoyException(fmt::format(
         "No regex specified for tag specifier and no default regex for name: '{}'", name));
   }
+  // Most default regexes can be matched without a regex engine, which is much cheaper for the many
+  // stat names created when a large number of clusters is added at once.
+  TagExtractorPtr extractor = TokenTagExtractorImpl::create(name, regex);
+  if (extractor == nullptr) {
+    extractor = SuffixTagExtractorImpl::create(name, regex);
+  }
+  if (extractor != nullptr) {
+    return extractor;
+  }
   return TagExtractorPtr{new TagExtractorImpl(name, regex, substr)};
 }
 
@@ -75,27 +91,30 @@ bool TagExtractorImpl::extractTag(const std::string& stat_name, std::vector<Tag>
     return false;
   }
 
-  std::smatch match;
   // The regex must match and contain one or more subexpressions (all after the first are ignored).
-  if (std::regex_search(stat_name, match, regex_) && match.size() > 1) {
+  const size_t num_submatches = std::min<size_t>(regex_->numCaptureGroups(), 2) + 1;
+  absl::string_view match[3];
+  if (num_submatches > 1 && regex_->search(stat_name, match, num_submatches)) {
     // remove_subexpr is the first submatch. It represents the portion of the string to be removed.
-    const auto& remove_subexpr = match[1];
+    const absl::string_view remove_subexpr = match[1];
 
     // value_subexpr is the optional second submatch. It is usually inside the first submatch
     // (remove_subexpr) to allow the expression to strip off extra characters that should be removed
     // from the string but also not necessary in the tag value ("." for example). If there is no
     // second submatch, then the value_subexpr is the same as the remove_subexpr.
-    const auto& value_subexpr = match.size() > 2 ? match[2] : remove_subexpr;
+    const absl::string_view value_subexpr = num_submatches > 2 ? match[2] : remove_subexpr;
 
     tags.emplace_back();
     Tag& tag = tags.back();
     tag.name_ = name_;
-    tag.value_ = value_subexpr.str();
+    tag.value_ = std::string(value_subexpr);
 
-    // Determines which characters to remove from stat_name to elide remove_subexpr.
-    std::string::size_type start = remove_subexpr.first - stat_name.begin();
-    std::string::size_type end = remove_subexpr.second - stat_name.begin();
-    remove_characters.insert(start, end);
+    // Determines which characters to remove from stat_name to elide remove_subexpr. A subexpression
+    // that did not participate in the match removes nothing.
+    if (remove_subexpr.data() != nullptr) {
+      const std::string::size_type start = remove_subexpr.data() - stat_name.data();
+      remove_characters.insert(start, start + remove_subexpr.size());
+    }
     PERF_RECORD(perf, "re-match", name_);
     return true;
   }
@@ -103,5 +122,148 @@ bool TagExtractorImpl::extractTag(const std::string& stat_name, std::vector<Tag>
   return false;
 }
 
+TokenTagExtractorImpl::TokenTagExtractorImpl(const std::string& name,
+                                             std::vector<std::string>&& tokens,
+                                             bool up_to_last_token)
+    : name_(name), tokens_(std::move(tokens)), up_to_last_token_(up_to_last_token) {}
+
+TagExtractorPtr TokenTagExtractorImpl::create(const std::string& name, absl::string_view regex) {
+  if (!absl::ConsumePrefix(&regex, "^")) {
+    return nullptr;
+  }
+
+  std::vector<std::string> tokens;
+  while (!absl::ConsumePrefix(&regex, "((.*?)\\.)")) {
+    absl::string_view::size_type size = 0;
+    while (size < regex.size() && isWordCharacter(regex[size])) {
+      ++size;
+    }
+    if (size == 0 || !absl::StartsWith(regex.substr(size), "\\.")) {
+      return nullptr;
+    }
+    tokens.emplace_back(regex.substr(0, size));
+    regex.remove_prefix(size + 2);
+  }
+
+  if (tokens.empty() || (!regex.empty() && regex != "\\w+?$")) {
+    return nullptr;
+  }
+  return TagExtractorPtr{new TokenTagExtractorImpl(name, std::move(tokens), !regex.empty())};
+}
+
+bool TokenTagExtractorImpl::extractTag(const std::string& stat_name, std::vector<Tag>& tags,
+                                       IntervalSet<size_t>& remove_characters) const {
+  size_t begin = 0;
+  for (const std::string& token : tokens_) {
+    if (stat_name.compare(begin, token.size(), token) != 0 ||
+        begin + token.size() >= stat_name.size() || stat_name[begin + token.size()] != '.') {
+      return false;
+    }
+    begin += token.size() + 1;
+  }
+
+  // The value is matched by .*?, which does not match newlines.
+  size_t end;
+  if (up_to_last_token_) {
+    end = stat_name.rfind('.');
+    if (end == std::string::npos || end < begin || end + 1 == stat_name.size() ||
+        !std::all_of(stat_name.begin() + end + 1, stat_name.end(), isWordCharacter) ||
+        std::find(stat_name.begin() + begin, stat_name.begin() + end, '\n') !=
+            stat_name.begin() + end) {
+      return false;
+    }
+  } else {
+    end = stat_name.find_first_of(".\n", begin);
+    if (end == std::string::npos || stat_name[end] != '.') {
+      return false;
+    }
+  }
+
+  tags.emplace_back();
+  Tag& tag = tags.back();
+  tag.name_ = name_;
+  tag.value_ = stat_name.substr(begin, end - begin);
+  remove_characters.insert(begin, end + 1);
+  return true;
+}
+
+SuffixTagExtractorImpl::SuffixTagExtractorImpl(const std::string& name, std::string&& pattern,
+                                               const Group& remove, const Group& value)
+    : name_(name), pattern_(std::move(pattern)), remove_(remove), value_(value) {}
+
+TagExtractorPtr SuffixTagExtractorImpl::create(const std::string& name, absl::string_view regex) {
+  if (!absl::ConsumeSuffix(&regex, "$")) {
+    return nullptr;
+  }
+
+  std::string pattern;
+  std::vector<Group> groups;
+  std::vector<size_t> open_groups;
+  // Whether a repetition would apply to a single character rather than to a group.
+  bool after_character = false;
+  for (size_t i = 0; i < regex.size(); ++i) {
+    const char c = regex[i];
+    if (isWordCharacter(c)) {
+      pattern.push_back(c);
+      after_character = true;
+    } else if (c == '\\' && i + 1 < regex.size() && regex[i + 1] == 'd') {
+      pattern.push_back(Digit);
+      after_character = true;
+      ++i;
+    } else if (c == '{' && after_character) {
+      const size_t close = regex.find('}', i);
+      uint32_t count;
+      if (close == absl::string_view::npos ||
+          !absl::SimpleAtoi(regex.substr(i + 1, close - i - 1), &count) || count == 0 ||
+          count > 16) {
+        return nullptr;
+      }
+      pattern.append(count - 1, pattern.back());
+      after_character = false;
+      i = close;
+    } else if (c == '(' && (i + 1 == regex.size() || regex[i + 1] != '?')) {
+      open_groups.push_back(groups.size());
+      groups.push_back({pattern.size(), 0});
+      after_character = false;
+    } else if (c == ')' && !open_groups.empty()) {
+      groups[open_groups.back()].end_ = pattern.size();
+      open_groups.pop_back();
+      after_character = false;
+    } else {
+      return nullptr;
+    }
+  }
+
+  // As for regexes, the first group is removed and the second, if any, is the tag value.
+  if (groups.empty() || !open_groups.empty()) {
+    return nullptr;
+  }
+  const Group value = groups.size() > 1 ? groups[1] : groups[0];
+  return TagExtractorPtr{new SuffixTagExtractorImpl(name, std::move(pattern), groups[0], value)};
+}
+
+bool SuffixTagExtractorImpl::extractTag(const std::string& stat_name, std::vector<Tag>& tags,
+                                        IntervalSet<size_t>& remove_characters) const {
+  if (stat_name.size() < pattern_.size()) {
+    return false;
+  }
+  const size_t begin = stat_name.size() - pattern_.size();
+  for (size_t i = 0; i < pattern_.size(); ++i) {
+    const char c = stat_name[begin + i];
+    if (pattern_[i] == Digit ? !absl::ascii_isdigit(c) : c != pattern_[i]) {
+      return false;
+    }
+  }
+
+  tags.emplace_back();
+  Tag& tag = tags.back();
+  tag.name_ = name_;
+  tag.value_ = stat_name.substr(begin + value_.begin_, value_.end_ - value_.begin_);
+  if (remove_.end_ > remove_.begin_) {
+    remove_characters.insert(begin + remove_.begin_, begin + remove_.end_);
+  }
+  return true;
+}
+
 } // namespace Stats
 } // namespace Envoy
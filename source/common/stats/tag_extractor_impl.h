@@ -1,9 +1,10 @@
 #pragma once
 
 #include <cstdint>
-#include <regex>
 #include <string>
+#include <vector>
 
+#include "envoy/common/regex.h"
 #include "envoy/stats/tag_extractor.h"
 
 #include "absl/strings/string_view.h"
@@ -50,7 +51,70 @@ private:
   const std::string name_;
   const std::string prefix_;
   const std::string substr_;
-  const std::regex regex_;
+  const Regex::CompiledMatcherPtr regex_;
+};
+
+/**
+ * Extracts the tag of a regex of the form ^a\.b\.((.*?)\.) or ^a\.b\.((.*?)\.)\w+?$, which most
+ * default extractors have, by comparing the leading tokens of the stat name instead of running the
+ * regex. The tag value is the token following the leading ones in the first form, and everything
+ * up to the last '.' of a name ending in a word in the second.
+ */
+class TokenTagExtractorImpl : public TagExtractor {
+public:
+  /**
+   * @return TagExtractorPtr the extractor for regex, or nullptr if regex is not of either form.
+   */
+  static TagExtractorPtr create(const std::string& name, absl::string_view regex);
+
+  std::string name() const override { return name_; }
+  bool extractTag(const std::string& stat_name, std::vector<Tag>& tags,
+                  IntervalSet<size_t>& remove_characters) const override;
+  absl::string_view prefixToken() const override { return tokens_.front(); }
+
+private:
+  TokenTagExtractorImpl(const std::string& name, std::vector<std::string>&& tokens,
+                        bool up_to_last_token);
+
+  const std::string name_;
+  const std::vector<std::string> tokens_;
+  const bool up_to_last_token_;
+};
+
+/**
+ * Extracts the tag of a regex matching a fixed length suffix of the stat name, made of word
+ * characters, \d and {n} repetitions, such as _rq(_(\d{3}))$, without running the regex.
+ */
+class SuffixTagExtractorImpl : public TagExtractor {
+public:
+  /**
+   * @return TagExtractorPtr the extractor for regex, or nullptr if regex is not of that form.
+   */
+  static TagExtractorPtr create(const std::string& name, absl::string_view regex);
+
+  std::string name() const override { return name_; }
+  bool extractTag(const std::string& stat_name, std::vector<Tag>& tags,
+                  IntervalSet<size_t>& remove_characters) const override;
+  absl::string_view prefixToken() const override { return absl::string_view(); }
+
+private:
+  // Stands for \d in the pattern, which no word character can be confused with.
+  static constexpr char Digit = '\0';
+
+  struct Group {
+    size_t begin_;
+    size_t end_;
+  };
+
+  SuffixTagExtractorImpl(const std::string& name, std::string&& pattern, const Group& remove,
+                         const Group& value);
+
+  const std::string name_;
+  // Each character matches itself, except for Digit which matches any decimal digit.
+  const std::string pattern_;
+  // The positions in the suffix of the characters to remove and of the tag value.
+  const Group remove_;
+  const Group value_;
 };
 
 } // namespace Stats
@@ -16,6 +16,7 @@
 #include "common/common/lock_guard.h"
 #include "common/stats/tag_producer_impl.h"
 
+#include "absl/strings/match.h"
 #include "absl/strings/str_join.h"
 
 namespace Envoy {
@@ -39,8 +40,10 @@ std::vector<CounterSharedPtr> ThreadLocalStoreImpl::counters() const {
   std::unordered_set<std::string> names;
   Thread::LockGuard lock(lock_);
   for (ScopeImpl* scope : scopes_) {
+    Thread::LockGuard scope_lock(scope->central_cache_.lock_);
     for (auto& counter : scope->central_cache_.counters_) {
-      if (names.insert(counter.first).second) {
+      if (counter.second != null_counter_ &&
+          names.insert(scope->prefix_ + counter.first).second) {
         ret.push_back(counter.second);
       }
     }
@@ -62,8 +65,9 @@ std::vector<GaugeSharedPtr> ThreadLocalStoreImpl::gauges() const {
   std::unordered_set<std::string> names;
   Thread::LockGuard lock(lock_);
   for (ScopeImpl* scope : scopes_) {
+    Thread::LockGuard scope_lock(scope->central_cache_.lock_);
     for (auto& gauge : scope->central_cache_.gauges_) {
-      if (names.insert(gauge.first).second) {
+      if (gauge.second != null_gauge_ && names.insert(scope->prefix_ + gauge.first).second) {
         ret.push_back(gauge.second);
       }
     }
@@ -81,6 +85,7 @@ std::vector<ParentHistogramSharedPtr> ThreadLocalStoreImpl::histograms() const {
   // in histograms with duplicate names, but until shared storage is implemented it's ultimately
   // less confusing for users who have such configs.
   for (ScopeImpl* scope : scopes_) {
+    Thread::LockGuard scope_lock(scope->central_cache_.lock_);
     for (const auto& name_histogram_pair : scope->central_cache_.histograms_) {
       const ParentHistogramSharedPtr& parent_hist = name_histogram_pair.second;
       ret.push_back(parent_hist);
@@ -99,6 +104,29 @@ void ThreadLocalStoreImpl::initializeThreading(Event::Dispatcher& main_thread_di
   });
 }
 
+void ThreadLocalStoreImpl::setCardinalityLimit(const std::string& prefix, uint64_t max_stats) {
+  ASSERT(tls_ == nullptr);
+  if (num_cardinality_limited_stats_ == nullptr) {
+    num_cardinality_limited_stats_ = &default_scope_->counter("stats.cardinality_limited");
+    makeNullStats();
+  }
+  cardinality_limits_.emplace_back(new CardinalityLimit(prefix, max_stats));
+}
+
+void ThreadLocalStoreImpl::setStatsMatcher(StatsMatcherPtr&& stats_matcher) {
+  ASSERT(tls_ == nullptr);
+  stats_matcher_ = std::move(stats_matcher);
+  makeNullStats();
+}
+
+void ThreadLocalStoreImpl::makeNullStats() {
+  if (null_counter_ == nullptr) {
+    null_counter_ = heap_allocator_.makeCounter("stats.null_counter", "", {});
+    null_gauge_ = heap_allocator_.makeGauge("stats.null_gauge", "", {});
+    null_histogram_ = std::make_shared<NullHistogramImpl>();
+  }
+}
+
 void ThreadLocalStoreImpl::shutdownThreading() {
   // This will block both future cache fills as well as cache flushes.
   shutting_down_ = true;
@@ -185,13 +213,41 @@ absl::string_view ThreadLocalStoreImpl::truncateStatNameIfNeeded(absl::string_vi
 
 std::atomic<uint64_t> ThreadLocalStoreImpl::ScopeImpl::next_scope_id_;
 
-ThreadLocalStoreImpl::ScopeImpl::~ScopeImpl() { parent_.releaseScopeCrossThread(this); }
+ThreadLocalStoreImpl::ScopeImpl::~ScopeImpl() {
+  for (const auto& limited : central_cache_.limited_stats_) {
+    limited.first->stats_ -= limited.second;
+  }
+  parent_.releaseScopeCrossThread(this);
+}
+
+bool ThreadLocalStoreImpl::ScopeImpl::admitStat(const std::string& final_name) {
+  std::vector<CardinalityLimit*> counted;
+  for (const auto& limit : parent_.cardinality_limits_) {
+    if (!absl::StartsWith(final_name, limit->prefix_)) {
+      continue;
+    }
+    // Other scopes may be counting against the same limit concurrently.
+    if (++limit->stats_ > limit->max_stats_) {
+      limit->stats_--;
+      for (CardinalityLimit* counted_limit : counted) {
+        counted_limit->stats_--;
+      }
+      return false;
+    }
+    counted.push_back(limit.get());
+  }
+  for (CardinalityLimit* counted_limit : counted) {
+    central_cache_.limited_stats_[counted_limit]++;
+  }
+  return true;
+}
 
 template <class StatType>
 StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
     const std::string& name,
     std::unordered_map<std::string, std::shared_ptr<StatType>>& central_cache_map,
-    MakeStatFn<StatType> make_stat, std::shared_ptr<StatType>* tls_ref) {
+    MakeStatFn<StatType> make_stat, std::shared_ptr<StatType>* tls_ref,
+    const std::shared_ptr<StatType>& null_stat) {
 
   // If we have a valid cache entry, return it.
   if (tls_ref && *tls_ref) {
@@ -199,16 +255,38 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
   }
 
   // We must now look in the central store so we must be locked. We grab a reference to the
-  // central store location. It might contain nothing. In this case, we allocate a new stat.
-  Thread::LockGuard lock(parent_.lock_);
+  // central store location. It might contain nothing. In this case, we allocate a new stat. Only
+  // this scope's cache is locked, so other scopes can allocate stats concurrently. The allocators
+  // do their own locking.
+  Thread::LockGuard lock(central_cache_.lock_);
   std::shared_ptr<StatType>& central_ref = central_cache_map[name];
   if (!central_ref) {
+    // Determine the final name based on the prefix and the passed name.
+    const std::string final_name = prefix_ + name;
+    // Rejected and refused stats are kept in the central cache, so that the name is only matched,
+    // and refused stats only counted, once.
+    if (parent_.rejects(final_name)) {
+      central_ref = null_stat;
+      if (tls_ref) {
+        *tls_ref = central_ref;
+      }
+      return *central_ref;
+    }
+    if (!parent_.cardinality_limits_.empty() && !admitStat(final_name)) {
+      parent_.num_cardinality_limited_stats_->inc();
+      central_ref = null_stat;
+      if (tls_ref) {
+        *tls_ref = central_ref;
+      }
+      return *central_ref;
+    }
+
     std::vector<Tag> tags;
 
     // Tag extraction occurs on the original, untruncated name so the extraction
     // can complete properly, even if the tag values are partially truncated.
-    std::string tag_extracted_name = parent_.getTagsForName(name, tags);
-    absl::string_view truncated_name = parent_.truncateStatNameIfNeeded(name);
+    std::string tag_extracted_name = parent_.getTagsForName(final_name, tags);
+    absl::string_view truncated_name = parent_.truncateStatNameIfNeeded(final_name);
     std::shared_ptr<StatType> stat =
         make_stat(parent_.alloc_, truncated_name, std::move(tag_extracted_name), std::move(tags));
     if (stat == nullptr) {
@@ -230,25 +308,24 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
 }
 
 Counter& ThreadLocalStoreImpl::ScopeImpl::counter(const std::string& name) {
-  // Determine the final name based on the prefix and the passed name.
-  std::string final_name = prefix_ + name;
+  // The caches belong to this scope, so they are keyed by the name within the scope. This avoids
+  // storing the prefix in every cache entry, and building the final name on every lookup.
 
   // We now try to acquire a *reference* to the TLS cache shared pointer. This might remain null
   // if we don't have TLS initialized currently. The de-referenced pointer might be null if there
   // is no cache entry.
   CounterSharedPtr* tls_ref = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref =
-        &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].counters_[final_name];
+    tls_ref = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].counters_[name];
   }
 
   return safeMakeStat<Counter>(
-      final_name, central_cache_.counters_,
+      name, central_cache_.counters_,
       [](StatDataAllocator& allocator, absl::string_view name, std::string&& tag_extracted_name,
          std::vector<Tag>&& tags) -> CounterSharedPtr {
         return allocator.makeCounter(name, std::move(tag_extracted_name), std::move(tags));
       },
-      tls_ref);
+      tls_ref, parent_.null_counter_);
 }
 
 void ThreadLocalStoreImpl::ScopeImpl::deliverHistogramToSinks(const Histogram& histogram,
@@ -270,50 +347,59 @@ void ThreadLocalStoreImpl::ScopeImpl::deliverHistogramToSinks(const Histogram& h
 Gauge& ThreadLocalStoreImpl::ScopeImpl::gauge(const std::string& name) {
   // See comments in counter(). There is no super clean way (via templates or otherwise) to
   // share this code so I'm leaving it largely duplicated for now.
-  std::string final_name = prefix_ + name;
   GaugeSharedPtr* tls_ref = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].gauges_[final_name];
+    tls_ref = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].gauges_[name];
   }
 
   return safeMakeStat<Gauge>(
-      final_name, central_cache_.gauges_,
+      name, central_cache_.gauges_,
       [](StatDataAllocator& allocator, absl::string_view name, std::string&& tag_extracted_name,
          std::vector<Tag>&& tags) -> GaugeSharedPtr {
         return allocator.makeGauge(name, std::move(tag_extracted_name), std::move(tags));
       },
-      tls_ref);
+      tls_ref, parent_.null_gauge_);
 }
 
 Histogram& ThreadLocalStoreImpl::ScopeImpl::histogram(const std::string& name) {
   // See comments in counter(). There is no super clean way (via templates or otherwise) to
   // share this code so I'm leaving it largely duplicated for now.
-  std::string final_name = prefix_ + name;
   ParentHistogramSharedPtr* tls_ref = nullptr;
 
   if (!parent_.shutting_down_ && parent_.tls_) {
-    tls_ref = &parent_.tls_->getTyped<TlsCache>()
-                   .scope_cache_[this->scope_id_]
-                   .parent_histograms_[final_name];
+    tls_ref =
+        &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].parent_histograms_[name];
   }
 
   if (tls_ref && *tls_ref) {
     return **tls_ref;
   }
 
-  Thread::LockGuard lock(parent_.lock_);
-  ParentHistogramImplSharedPtr& central_ref = central_cache_.histograms_[final_name];
-  if (!central_ref) {
+  Thread::LockGuard lock(central_cache_.lock_);
+  auto central = central_cache_.histograms_.find(name);
+  if (central == central_cache_.histograms_.end()) {
+    const std::string final_name = prefix_ + name;
+    if (parent_.rejects(final_name)) {
+      // The null histogram is not a ParentHistogramImpl, so unlike rejected counters and gauges it
+      // is only cached per thread.
+      if (tls_ref) {
+        *tls_ref = parent_.null_histogram_;
+      }
+      return *parent_.null_histogram_;
+    }
     std::vector<Tag> tags;
     std::string tag_extracted_name = parent_.getTagsForName(final_name, tags);
-    central_ref.reset(new ParentHistogramImpl(final_name, parent_, *this,
-                                              std::move(tag_extracted_name), std::move(tags)));
+    central = central_cache_.histograms_
+                  .emplace(name, std::make_shared<ParentHistogramImpl>(
+                                     final_name, parent_, *this, std::move(tag_extracted_name),
+                                     std::move(tags)))
+                  .first;
   }
 
   if (tls_ref) {
-    *tls_ref = central_ref;
+    *tls_ref = central->second;
   }
-  return *central_ref;
+  return *central->second;
 }
 
 Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(const std::string& name,
@@ -361,11 +447,18 @@ ThreadLocalHistogramImpl::~ThreadLocalHistogramImpl() {
 void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
   ASSERT(std::this_thread::get_id() == created_thread_id_);
   hist_insert_intscale(histograms_[current_active_], value, 0, 1);
-  flags_ |= Flags::Used;
+  // Once the flag is set, this spares every recording an atomic read-modify-write.
+  if (!(flags_.load(std::memory_order_relaxed) & Flags::Used)) {
+    flags_ |= Flags::Used;
+  }
 }
 
 void ThreadLocalHistogramImpl::merge(histogram_t* target) {
   histogram_t** other_histogram = &histograms_[otherHistogramIndex()];
+  if (hist_num_buckets(*other_histogram) == 0) {
+    // Nothing was recorded on this thread during the interval.
+    return;
+  }
   hist_accumulate(target, other_histogram, 1);
   hist_clear(*other_histogram);
 }
@@ -407,9 +500,19 @@ void ParentHistogramImpl::merge() {
     }
     // Since TLS merge is done, we can release the lock here.
     lock.release();
-    hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
-    cumulative_statistics_.refresh(cumulative_histogram_);
-    interval_statistics_.refresh(interval_histogram_);
+    // Computing quantiles is the bulk of a merge, so statistics that cannot have changed since
+    // the previous merge are kept as they are.
+    const bool interval_empty = hist_num_buckets(interval_histogram_) == 0;
+    if (!interval_empty) {
+      hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
+    }
+    if (!interval_empty || !merged_) {
+      cumulative_statistics_.refresh(cumulative_histogram_);
+    }
+    if (!interval_empty || !previous_interval_empty_ || !merged_) {
+      interval_statistics_.refresh(interval_histogram_);
+    }
+    previous_interval_empty_ = interval_empty;
     merged_ = true;
   }
 }
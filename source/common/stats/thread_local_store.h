@@ -105,6 +105,7 @@ private:
   mutable Thread::MutexBasicLockable merge_lock_;
   std::list<TlsHistogramSharedPtr> tls_histograms_ GUARDED_BY(merge_lock_);
   bool merged_;
+  bool previous_interval_empty_{};
   const std::string name_;
 };
 
@@ -133,6 +134,8 @@ public:
  *   the same backing stats).
  * - Scope deletion.
  * - Lockless in the fast path.
+ * - Each scope's central cache has its own lock, so that scopes can be populated concurrently from
+ *   several threads. The store wide lock only guards the set of scopes.
  *
  * This implementation is complicated so here is a rough overview of the threading model.
  * - The store can be used before threading is initialized. This is needed during server init.
@@ -200,6 +203,8 @@ public:
   void setTagProducer(TagProducerPtr&& tag_producer) override {
     tag_producer_ = std::move(tag_producer);
   }
+  void setCardinalityLimit(const std::string& prefix, uint64_t max_stats) override;
+  void setStatsMatcher(StatsMatcherPtr&& stats_matcher) override;
   void initializeThreading(Event::Dispatcher& main_thread_dispatcher,
                            ThreadLocal::Instance& tls) override;
   void shutdownThreading() override;
@@ -211,6 +216,8 @@ public:
   const Stats::StatsOptions& statsOptions() const override { return stats_options_; }
 
 private:
+  // Except for the thread local histograms, the cache entries are keyed by the name of the stat
+  // within the scope, without the scope prefix, since the caches are per scope.
   struct TlsCacheEntry {
     std::unordered_map<std::string, CounterSharedPtr> counters_;
     std::unordered_map<std::string, GaugeSharedPtr> gauges_;
@@ -218,10 +225,26 @@ private:
     std::unordered_map<std::string, ParentHistogramSharedPtr> parent_histograms_;
   };
 
+  struct CardinalityLimit {
+    CardinalityLimit(const std::string& prefix, uint64_t max_stats)
+        : prefix_(prefix), max_stats_(max_stats) {}
+
+    const std::string prefix_;
+    const uint64_t max_stats_;
+    // Counters and gauges stored under the prefix, summed over the scopes that created them.
+    std::atomic<uint64_t> stats_{};
+  };
+
   struct CentralCacheEntry {
+    // Guards the maps below, which are handed to safeMakeStat() by reference. When both are
+    // needed, the store's lock_ must be acquired before this lock.
+    mutable Thread::MutexBasicLockable lock_;
     std::unordered_map<std::string, CounterSharedPtr> counters_;
     std::unordered_map<std::string, GaugeSharedPtr> gauges_;
     std::unordered_map<std::string, ParentHistogramImplSharedPtr> histograms_;
+    // How many stats this scope counts against each cardinality limit, returned when the scope is
+    // destroyed.
+    std::unordered_map<CardinalityLimit*, uint64_t> limited_stats_;
   };
 
   struct ScopeImpl : public TlsScope {
@@ -250,19 +273,29 @@ private:
     /**
      * Makes a stat either by looking it up in the central cache,
      * generating it from the the parent allocator, or as a last
-     * result, creating it with the heap allocator.
+     * result, creating it with the heap allocator. Only the scope's
+     * central cache is locked while doing so.
      *
-     * @param name the full name of the stat (not tag extracted).
+     * @param name the name of the stat within the scope, without the scope prefix.
      * @param central_cache_map a map from name to the desired object in the central cache.
      * @param make_stat a function to generate the stat object, called if it's not in cache.
      * @param tls_ref possibly null reference to a cache entry for this stat, which will be
      *     used if non-empty, or filled in if empty (and non-null).
+     * @param null_stat supplies the stat handed out instead if the stats matcher rejects the stat
+     *     or a cardinality limit is reached.
      */
     template <class StatType>
     StatType&
     safeMakeStat(const std::string& name,
                  std::unordered_map<std::string, std::shared_ptr<StatType>>& central_cache_map,
-                 MakeStatFn<StatType> make_stat, std::shared_ptr<StatType>* tls_ref);
+                 MakeStatFn<StatType> make_stat, std::shared_ptr<StatType>* tls_ref,
+                 const std::shared_ptr<StatType>& null_stat);
+
+    /**
+     * Counts a new stat against the cardinality limits its name falls under.
+     * @return bool whether all of them have room for it.
+     */
+    bool admitStat(const std::string& final_name) EXCLUSIVE_LOCKS_REQUIRED(central_cache_.lock_);
 
     static std::atomic<uint64_t> next_scope_id_;
 
@@ -284,6 +317,10 @@ private:
   };
 
   std::string getTagsForName(const std::string& name, std::vector<Tag>& tags) const;
+  bool rejects(const std::string& name) const {
+    return stats_matcher_ != nullptr && stats_matcher_->rejects(name);
+  }
+  void makeNullStats();
   void clearScopeFromCaches(uint64_t scope_id);
   void releaseScopeCrossThread(ScopeImpl* scope);
   void mergeInternal(PostMergeCb mergeCb);
@@ -293,6 +330,7 @@ private:
   StatDataAllocator& alloc_;
   Event::Dispatcher* main_thread_dispatcher_{};
   ThreadLocal::SlotPtr tls_;
+  // Guards the set of scopes. Each scope's central cache is guarded by its own lock.
   mutable Thread::MutexBasicLockable lock_;
   std::unordered_set<ScopeImpl*> scopes_ GUARDED_BY(lock_);
   ScopePtr default_scope_;
@@ -303,6 +341,15 @@ private:
   Counter& num_last_resort_stats_;
   HeapStatDataAllocator heap_allocator_;
   SourceImpl source_;
+  // Set before threading is initialized, and read only afterwards.
+  std::vector<std::unique_ptr<CardinalityLimit>> cardinality_limits_;
+  Counter* num_cardinality_limited_stats_{};
+  StatsMatcherPtr stats_matcher_;
+  // Stand in for all the stats rejected by the stats matcher or refused by cardinality limits.
+  // They are not listed by counters(), gauges() and histograms().
+  CounterSharedPtr null_counter_;
+  GaugeSharedPtr null_gauge_;
+  std::shared_ptr<NullHistogramImpl> null_histogram_;
 };
 
 } // namespace Stats
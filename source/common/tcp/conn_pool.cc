@@ -337,7 +337,13 @@ ConnPoolImpl::ActiveConn::ActiveConn(ConnPoolImpl& parent)
                              parent_.host_->cluster().stats().upstream_cx_rx_bytes_buffered_,
                              parent_.host_->cluster().stats().upstream_cx_tx_bytes_total_,
                              parent_.host_->cluster().stats().upstream_cx_tx_bytes_buffered_,
-                             &parent_.host_->cluster().stats().bind_errors_});
+                             &parent_.host_->cluster().stats().bind_errors_,
+                             &parent_.host_->cluster().stats().upstream_cx_read_budget_exhausted_,
+                             &parent_.host_->cluster()
+                                  .stats()
+                                  .upstream_cx_tx_buffer_above_high_watermark_ms_,
+                             &parent_.host_->cluster().stats().upstream_cx_connect_fallback_,
+                             &parent_.host_->cluster().stats().upstream_cx_tfo_syn_data_acked_});
 
   // We just universally set no delay on connections. Theoretically we might at some point want
   // to make this configurable.
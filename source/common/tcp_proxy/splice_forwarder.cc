@@ -0,0 +1,173 @@
+#include "common/tcp_proxy/splice_forwarder.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace TcpProxy {
+
+namespace {
+// Larger pipes let a single splice move more data. The kernel caps this at
+// /proc/sys/fs/pipe-max-size for unprivileged processes, in which case the default size is kept.
+constexpr int PreferredPipeSize = 256 * 1024;
+} // namespace
+
+SpliceForwarder::Direction::~Direction() {
+  for (int fd : pipe_) {
+    if (fd != -1) {
+      ::close(fd);
+    }
+  }
+}
+
+#ifdef __linux__
+
+bool SpliceForwarder::supported() { return true; }
+
+SpliceForwarderPtr SpliceForwarder::create(Event::Dispatcher& dispatcher,
+                                           Network::Connection& downstream,
+                                           Network::Connection& upstream, Callbacks& callbacks) {
+  SpliceForwarderPtr forwarder(new SpliceForwarder(downstream, upstream, callbacks));
+  if (!forwarder->createPipe(forwarder->upstream_) ||
+      !forwarder->createPipe(forwarder->downstream_)) {
+    return nullptr;
+  }
+
+  // Connections use edge triggered events, and libevent requires all events on an fd to agree.
+  const uint32_t events = Event::FileReadyType::Read | Event::FileReadyType::Write;
+  SpliceForwarder* raw = forwarder.get();
+  forwarder->downstream_event_ = dispatcher.createFileEvent(
+      downstream.fd(), [raw](uint32_t) -> void { raw->onFileEvent(); },
+      Event::FileTriggerType::Edge, events);
+  forwarder->upstream_event_ = dispatcher.createFileEvent(
+      upstream.fd(), [raw](uint32_t) -> void { raw->onFileEvent(); },
+      Event::FileTriggerType::Edge, events);
+
+  // Data may have arrived before the events were registered. Start from the event loop rather
+  // than inline, so callbacks never run before create() returns.
+  forwarder->downstream_event_->activate(Event::FileReadyType::Read);
+  return forwarder;
+}
+
+bool SpliceForwarder::createPipe(Direction& direction) {
+  if (::pipe2(direction.pipe_, O_NONBLOCK | O_CLOEXEC) != 0) {
+    ENVOY_LOG(debug, "splice pipe creation failed: {}", strerror(errno));
+    return false;
+  }
+
+  int size = ::fcntl(direction.pipe_[1], F_SETPIPE_SZ, PreferredPipeSize);
+  if (size < 0) {
+    size = ::fcntl(direction.pipe_[1], F_GETPIPE_SZ);
+  }
+  RELEASE_ASSERT(size > 0, "");
+  direction.pipe_size_ = size;
+  return true;
+}
+
+bool SpliceForwarder::pump(Direction& direction) {
+  constexpr unsigned int flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+
+  while (enabled_) {
+    if (direction.in_pipe_ > 0) {
+      const ssize_t rc = ::splice(direction.pipe_[0], nullptr, direction.dst_.fd(), nullptr,
+                                  direction.in_pipe_, flags);
+      if (rc < 0) {
+        // On EAGAIN the destination's writable edge resumes the direction.
+        if (errno != EAGAIN) {
+          ENVOY_LOG(debug, "splice write failed: {}", strerror(errno));
+          return false;
+        }
+        return true;
+      }
+
+      direction.in_pipe_ -= rc;
+      if (&direction == &upstream_) {
+        callbacks_.onSplicedUpstream(rc);
+      } else {
+        callbacks_.onSplicedDownstream(rc);
+      }
+      continue;
+    }
+
+    if (direction.end_stream_read_) {
+      if (!direction.end_stream_written_) {
+        direction.end_stream_written_ = true;
+        Buffer::OwnedImpl empty;
+        direction.dst_.write(empty, true);
+      }
+      return true;
+    }
+
+    // Only fill an empty pipe, so that EAGAIN here always means the source has no more data.
+    const ssize_t rc = ::splice(direction.src_.fd(), nullptr, direction.pipe_[1], nullptr,
+                                direction.pipe_size_, flags);
+    if (rc == 0) {
+      direction.end_stream_read_ = true;
+    } else if (rc < 0) {
+      if (errno != EAGAIN) {
+        ENVOY_LOG(debug, "splice read failed: {}", strerror(errno));
+        return false;
+      }
+      return true;
+    } else {
+      direction.in_pipe_ = rc;
+    }
+  }
+
+  return true;
+}
+
+#else
+
+bool SpliceForwarder::supported() { return false; }
+
+SpliceForwarderPtr SpliceForwarder::create(Event::Dispatcher&, Network::Connection&,
+                                           Network::Connection&, Callbacks&) {
+  return nullptr;
+}
+
+bool SpliceForwarder::createPipe(Direction&) { NOT_REACHED_GCOVR_EXCL_LINE; }
+
+bool SpliceForwarder::pump(Direction&) { NOT_REACHED_GCOVR_EXCL_LINE; }
+
+#endif
+
+SpliceForwarder::SpliceForwarder(Network::Connection& downstream, Network::Connection& upstream,
+                                 Callbacks& callbacks)
+    : callbacks_(callbacks), upstream_(downstream, upstream), downstream_(upstream, downstream) {}
+
+SpliceForwarder::~SpliceForwarder() { disable(); }
+
+void SpliceForwarder::disable() {
+  enabled_ = false;
+  // The sockets may already be closed, so only stop watching them.
+  if (downstream_event_ != nullptr) {
+    downstream_event_->setEnabled(0);
+  }
+  if (upstream_event_ != nullptr) {
+    upstream_event_->setEnabled(0);
+  }
+}
+
+void SpliceForwarder::onFileEvent() {
+  // Either socket becoming readable or writable can unblock either direction.
+  const bool ok = pump(upstream_) && pump(downstream_);
+  if (!enabled_) {
+    return;
+  }
+
+  if (!ok) {
+    callbacks_.onSpliceComplete(true);
+  } else if (upstream_.end_stream_written_ && downstream_.end_stream_written_) {
+    callbacks_.onSpliceComplete(false);
+  }
+}
+
+} // namespace TcpProxy
+} // namespace Envoy
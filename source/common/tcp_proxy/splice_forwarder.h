@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/file_event.h"
+#include "envoy/network/connection.h"
+
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace TcpProxy {
+
+class SpliceForwarder;
+typedef std::unique_ptr<SpliceForwarder> SpliceForwarderPtr;
+
+/**
+ * Moves data between two plaintext connections with splice(2) through a pipe per direction, so
+ * that the payload never enters userspace. The forwarder reads and writes the connections' sockets
+ * directly: for its lifetime both connections must have reads disabled and empty write buffers,
+ * and no filter sees the data. When a direction reaches end of stream, the forwarder half-closes
+ * its destination with an empty end_stream write.
+ */
+class SpliceForwarder : public Event::DeferredDeletable,
+                        Logger::Loggable<Logger::Id::filter> {
+public:
+  class Callbacks {
+  public:
+    virtual ~Callbacks() {}
+
+    /**
+     * Called when bytes have been moved from the downstream to the upstream connection.
+     */
+    virtual void onSplicedUpstream(uint64_t bytes) PURE;
+
+    /**
+     * Called when bytes have been moved from the upstream to the downstream connection.
+     */
+    virtual void onSplicedDownstream(uint64_t bytes) PURE;
+
+    /**
+     * Called once both directions have reached end of stream, or when a splice failed. The owner
+     * should disable() the forwarder and close the connections.
+     * @param error supplies whether a splice failed.
+     */
+    virtual void onSpliceComplete(bool error) PURE;
+  };
+
+  ~SpliceForwarder();
+
+  /**
+   * @return bool whether splicing is available on this platform.
+   */
+  static bool supported();
+
+  /**
+   * Start forwarding between two connections.
+   * @return SpliceForwarderPtr the forwarder, or nullptr if its pipes could not be created.
+   */
+  static SpliceForwarderPtr create(Event::Dispatcher& dispatcher, Network::Connection& downstream,
+                                   Network::Connection& upstream, Callbacks& callbacks);
+
+  /**
+   * Stop forwarding and invoking callbacks. This may be called from within a callback, after
+   * which the forwarder should be deleted with Event::Dispatcher::deferredDelete().
+   */
+  void disable();
+
+private:
+  struct Direction {
+    Direction(Network::Connection& src, Network::Connection& dst) : src_(src), dst_(dst) {}
+    ~Direction();
+
+    Network::Connection& src_;
+    Network::Connection& dst_;
+    int pipe_[2]{-1, -1};
+    uint64_t pipe_size_{};
+    // Bytes read from src_ into the pipe and not yet written to dst_.
+    uint64_t in_pipe_{};
+    bool end_stream_read_{};
+    bool end_stream_written_{};
+  };
+
+  SpliceForwarder(Network::Connection& downstream, Network::Connection& upstream,
+                  Callbacks& callbacks);
+
+  bool createPipe(Direction& direction);
+  void onFileEvent();
+  // Move data until both sides of the direction would block. Returns false on error.
+  bool pump(Direction& direction);
+
+  Callbacks& callbacks_;
+  // Data flowing towards the upstream and the downstream connection respectively.
+  Direction upstream_;
+  Direction downstream_;
+  Event::FileEventPtr downstream_event_;
+  Event::FileEventPtr upstream_event_;
+  bool enabled_{true};
+};
+
+} // namespace TcpProxy
+} // namespace Envoy
@@ -52,7 +52,10 @@ Config::Config(const envoy::config::filter::network::tcp_proxy::v2::TcpProxy& co
                Server::Configuration::FactoryContext& context)
     : max_connect_attempts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_connect_attempts, 1)),
       upstream_drain_manager_slot_(context.threadLocal().allocateSlot()),
-      shared_config_(std::make_shared<SharedConfig>(config, context)) {
+      shared_config_(std::make_shared<SharedConfig>(config, context)), splice_(config.splice()) {
+  if (splice_ && !SpliceForwarder::supported()) {
+    throw EnvoyException("tcp_proxy: splice is not supported on this platform");
+  }
 
   upstream_drain_manager_slot_->set([](Event::Dispatcher&) {
     return ThreadLocal::ThreadLocalObjectSharedPtr(new UpstreamDrainManager());
@@ -167,7 +170,8 @@ void Filter::initialize(Network::ReadFilterCallbacks& callbacks, bool set_connec
         {config_->stats().downstream_cx_rx_bytes_total_,
          config_->stats().downstream_cx_rx_bytes_buffered_,
          config_->stats().downstream_cx_tx_bytes_total_,
-         config_->stats().downstream_cx_tx_bytes_buffered_, nullptr});
+         config_->stats().downstream_cx_tx_bytes_buffered_, nullptr, nullptr, nullptr, nullptr,
+         nullptr});
   }
 }
 
@@ -262,7 +266,7 @@ void Filter::UpstreamCallbacks::onUpstreamData(Buffer::Instance& data, bool end_
 
 void Filter::UpstreamCallbacks::onBytesSent() {
   if (drainer_ == nullptr) {
-    parent_->resetIdleTimer();
+    parent_->onUpstreamBytesSent();
   } else {
     drainer_->onBytesSent();
   }
@@ -403,8 +407,16 @@ Network::FilterStatus Filter::onData(Buffer::Instance& data, bool end_stream) {
 }
 
 void Filter::onDownstreamEvent(Network::ConnectionEvent event) {
+  // Spliced data never sits in the upstream connection's write buffer, so there is nothing to
+  // drain after a remote close.
+  bool spliced = false;
+  if (event == Network::ConnectionEvent::RemoteClose ||
+      event == Network::ConnectionEvent::LocalClose) {
+    spliced = stopSplice();
+  }
+
   if (upstream_conn_data_) {
-    if (event == Network::ConnectionEvent::RemoteClose) {
+    if (event == Network::ConnectionEvent::RemoteClose && !spliced) {
       upstream_conn_data_->connection().close(Network::ConnectionCloseType::FlushWrite);
 
       // Events raised from the previous line may cause upstream_conn_data_ to be NULL if
@@ -419,7 +431,8 @@ void Filter::onDownstreamEvent(Network::ConnectionEvent event) {
           upstream_conn_data_.reset();
         }
       }
-    } else if (event == Network::ConnectionEvent::LocalClose) {
+    } else if (event == Network::ConnectionEvent::LocalClose ||
+               event == Network::ConnectionEvent::RemoteClose) {
       upstream_conn_data_->connection().close(Network::ConnectionCloseType::NoFlush);
       upstream_conn_data_.reset();
       disableIdleTimer();
@@ -450,6 +463,7 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
 
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
+    stopSplice();
     upstream_conn_data_.reset();
     disableIdleTimer();
 
@@ -467,14 +481,17 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
       }
     }
   } else if (event == Network::ConnectionEvent::Connected) {
-    // Re-enable downstream reads now that the upstream connection is established
-    // so we have a place to send downstream data to.
-    read_callbacks_->connection().readDisable(false);
-
     read_callbacks_->upstreamHost()->outlierDetector().putResult(
         Upstream::Outlier::Result::SUCCESS);
     onConnectionSuccess();
 
+    // Re-enable downstream reads now that the upstream connection is established
+    // so we have a place to send downstream data to. When splicing, both connections stay read
+    // disabled and the forwarder moves the data instead.
+    if (!config_->splice() || !startSplice()) {
+      read_callbacks_->connection().readDisable(false);
+    }
+
     getRequestInfo().setRequestedServerName(read_callbacks_->connection().requestedServerName());
     ENVOY_LOG(debug, "TCP:onUpstreamEvent(), requestedServerName: {}",
               getRequestInfo().requestedServerName());
@@ -487,6 +504,8 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
           [upstream_callbacks = upstream_callbacks_]() { upstream_callbacks->onIdleTimeout(); });
       resetIdleTimer();
       read_callbacks_->connection().addBytesSentCallback([this](uint64_t) { resetIdleTimer(); });
+    }
+    if (config_->idleTimeout() || splice_pending_) {
       upstream_conn_data_->connection().addBytesSentCallback(
           [upstream_callbacks = upstream_callbacks_](uint64_t) {
             upstream_callbacks->onBytesSent();
@@ -495,6 +514,87 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
   }
 }
 
+bool Filter::startSplice() {
+  Network::Connection& downstream = read_callbacks_->connection();
+  Network::Connection& upstream = upstream_conn_data_->connection();
+  // The kernel can only move plaintext.
+  if (downstream.ssl() != nullptr || upstream.ssl() != nullptr) {
+    return false;
+  }
+
+  upstream.readDisable(true);
+  // Data written by onConnectionSuccess(), such as a WebSocket upgrade request, must reach the
+  // upstream before any spliced data. Both connections stay read disabled until it has been sent.
+  if (upstream.bufferedWriteBytes() > 0) {
+    ENVOY_CONN_LOG(debug, "splicing once the upstream connection is flushed", downstream);
+    splice_pending_ = true;
+    return true;
+  }
+
+  if (!createSpliceForwarder()) {
+    upstream.readDisable(false);
+    return false;
+  }
+  return true;
+}
+
+bool Filter::createSpliceForwarder() {
+  Network::Connection& downstream = read_callbacks_->connection();
+  splice_forwarder_ = SpliceForwarder::create(downstream.dispatcher(), downstream,
+                                              upstream_conn_data_->connection(), *this);
+  if (splice_forwarder_ == nullptr) {
+    return false;
+  }
+
+  ENVOY_CONN_LOG(debug, "splicing to upstream", downstream);
+  config_->stats().downstream_cx_splice_total_.inc();
+  return true;
+}
+
+void Filter::onUpstreamBytesSent() {
+  resetIdleTimer();
+
+  if (splice_pending_ && upstream_conn_data_->connection().bufferedWriteBytes() == 0) {
+    splice_pending_ = false;
+    if (!createSpliceForwarder()) {
+      upstream_conn_data_->connection().readDisable(false);
+      read_callbacks_->connection().readDisable(false);
+    }
+  }
+}
+
+bool Filter::stopSplice() {
+  splice_pending_ = false;
+  if (splice_forwarder_ == nullptr) {
+    return false;
+  }
+
+  // This may be called from within one of the forwarder's callbacks.
+  splice_forwarder_->disable();
+  read_callbacks_->connection().dispatcher().deferredDelete(std::move(splice_forwarder_));
+  return true;
+}
+
+void Filter::onSplicedUpstream(uint64_t bytes) {
+  getRequestInfo().addBytesReceived(bytes);
+  config_->stats().downstream_cx_rx_bytes_total_.add(bytes);
+  read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_tx_bytes_total_.add(bytes);
+  resetIdleTimer();
+}
+
+void Filter::onSplicedDownstream(uint64_t bytes) {
+  getRequestInfo().addBytesSent(bytes);
+  config_->stats().downstream_cx_tx_bytes_total_.add(bytes);
+  read_callbacks_->upstreamHost()->cluster().stats().upstream_cx_rx_bytes_total_.add(bytes);
+  resetIdleTimer();
+}
+
+void Filter::onSpliceComplete(bool error) {
+  // Closing the downstream connection also closes the upstream one and stops the forwarder.
+  read_callbacks_->connection().close(error ? Network::ConnectionCloseType::NoFlush
+                                            : Network::ConnectionCloseType::FlushWrite);
+}
+
 void Filter::onIdleTimeout() {
   ENVOY_CONN_LOG(debug, "Session timed out", read_callbacks_->connection());
   config_->stats().idle_timeout_.inc();
@@ -24,6 +24,7 @@
 #include "common/network/filter_impl.h"
 #include "common/network/utility.h"
 #include "common/request_info/request_info_impl.h"
+#include "common/tcp_proxy/splice_forwarder.h"
 #include "common/upstream/load_balancer_impl.h"
 
 namespace Envoy {
@@ -40,6 +41,7 @@ namespace TcpProxy {
   GAUGE  (downstream_cx_tx_bytes_buffered)                                                         \
   COUNTER(downstream_cx_total)                                                                     \
   COUNTER(downstream_cx_no_route)                                                                  \
+  COUNTER(downstream_cx_splice_total)                                                              \
   COUNTER(downstream_flow_control_paused_reading_total)                                            \
   COUNTER(downstream_flow_control_resumed_reading_total)                                           \
   COUNTER(idle_timeout)                                                                            \
@@ -112,6 +114,7 @@ public:
   const Router::MetadataMatchCriteria* metadataMatchCriteria() {
     return cluster_metadata_match_criteria_.get();
   }
+  bool splice() const { return splice_; }
 
 private:
   struct Route {
@@ -131,6 +134,7 @@ private:
   ThreadLocal::SlotPtr upstream_drain_manager_slot_;
   SharedConfigSharedPtr shared_config_;
   std::unique_ptr<const Router::MetadataMatchCriteria> cluster_metadata_match_criteria_;
+  const bool splice_;
 };
 
 typedef std::shared_ptr<Config> ConfigSharedPtr;
@@ -143,6 +147,7 @@ typedef std::shared_ptr<Config> ConfigSharedPtr;
 class Filter : public Network::ReadFilter,
                public Upstream::LoadBalancerContextBase,
                Tcp::ConnectionPool::Callbacks,
+               SpliceForwarder::Callbacks,
                protected Logger::Loggable<Logger::Id::filter> {
 public:
   Filter(ConfigSharedPtr config, Upstream::ClusterManager& cluster_manager);
@@ -159,6 +164,11 @@ public:
   void onPoolReady(Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
                    Upstream::HostDescriptionConstSharedPtr host) override;
 
+  // SpliceForwarder::Callbacks
+  void onSplicedUpstream(uint64_t bytes) override;
+  void onSplicedDownstream(uint64_t bytes) override;
+  void onSpliceComplete(bool error) override;
+
   // Upstream::LoadBalancerContext
   const Router::MetadataMatchCriteria* metadataMatchCriteria() override {
     return config_->metadataMatchCriteria();
@@ -241,6 +251,10 @@ protected:
   void onIdleTimeout();
   void resetIdleTimer();
   void disableIdleTimer();
+  void onUpstreamBytesSent();
+  bool startSplice();
+  bool createSpliceForwarder();
+  bool stopSplice();
 
   const ConfigSharedPtr config_;
   Upstream::ClusterManager& cluster_manager_;
@@ -252,6 +266,10 @@ protected:
   std::shared_ptr<UpstreamCallbacks> upstream_callbacks_; // shared_ptr required for passing as a
                                                           // read filter.
   RequestInfo::RequestInfoImpl request_info_;
+  // Set while data is moved in the kernel rather than through the connections' filter chains.
+  SpliceForwarderPtr splice_forwarder_;
+  // Set while splicing waits for the data already written to the upstream connection to be sent.
+  bool splice_pending_{};
   uint32_t connect_attempts_{};
   bool connecting_{};
 };
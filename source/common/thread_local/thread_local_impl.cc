@@ -18,6 +18,7 @@ InstanceImpl::~InstanceImpl() {
   ASSERT(std::this_thread::get_id() == main_thread_id_);
   ASSERT(shutdown_);
   thread_local_data_.data_.clear();
+  thread_local_data_.versions_.clear();
 }
 
 SlotPtr InstanceImpl::allocateSlot() {
@@ -38,10 +39,32 @@ SlotPtr InstanceImpl::allocateSlot() {
 }
 
 ThreadLocalObjectSharedPtr InstanceImpl::SlotImpl::get() {
+  // A single load tells whether an object was published since this thread last looked.
+  const std::vector<uint64_t>& versions = thread_local_data_.versions_;
+  if (version_.load(std::memory_order_acquire) !=
+      (index_ < versions.size() ? versions[index_] : 0)) {
+    refreshPublished();
+  }
+
   ASSERT(thread_local_data_.data_.size() > index_);
   return thread_local_data_.data_[index_];
 }
 
+void InstanceImpl::SlotImpl::refreshPublished() {
+  Thread::LockGuard lock(published_lock_);
+  const uint64_t version = version_.load(std::memory_order_relaxed);
+  if (published_ != nullptr) {
+    setThreadLocal(index_, published_, version);
+  } else {
+    // set() was called since the last publish(). Keep the current object until the posted one
+    // replaces it.
+    ASSERT(version == 0);
+    if (index_ < thread_local_data_.versions_.size()) {
+      thread_local_data_.versions_[index_] = 0;
+    }
+  }
+}
+
 void InstanceImpl::registerThread(Event::Dispatcher& dispatcher, bool main_thread) {
   ASSERT(std::this_thread::get_id() == main_thread_id_);
   ASSERT(!shutdown_);
@@ -75,6 +98,7 @@ void InstanceImpl::removeSlot(SlotImpl& slot) {
     // will be sequenced after this removal.
     if (index < thread_local_data_.data_.size()) {
       thread_local_data_.data_[index] = nullptr;
+      thread_local_data_.versions_[index] = 0;
     }
   });
 }
@@ -114,6 +138,12 @@ void InstanceImpl::SlotImpl::set(InitializeCb cb) {
   ASSERT(std::this_thread::get_id() == parent_.main_thread_id_);
   ASSERT(!parent_.shutdown_);
 
+  {
+    Thread::LockGuard lock(published_lock_);
+    published_ = nullptr;
+    version_.store(0, std::memory_order_release);
+  }
+
   for (Event::Dispatcher& dispatcher : parent_.registered_threads_) {
     const uint32_t index = index_;
     dispatcher.post([index, cb, &dispatcher]() -> void { setThreadLocal(index, cb(dispatcher)); });
@@ -123,12 +153,25 @@ void InstanceImpl::SlotImpl::set(InitializeCb cb) {
   setThreadLocal(index_, cb(*parent_.main_thread_dispatcher_));
 }
 
-void InstanceImpl::setThreadLocal(uint32_t index, ThreadLocalObjectSharedPtr object) {
+void InstanceImpl::SlotImpl::publish(ThreadLocalObjectSharedPtr object) {
+  ASSERT(std::this_thread::get_id() == parent_.main_thread_id_);
+  ASSERT(!parent_.shutdown_);
+  ASSERT(object != nullptr);
+
+  Thread::LockGuard lock(published_lock_);
+  published_ = std::move(object);
+  version_.store(++parent_.last_version_, std::memory_order_release);
+}
+
+void InstanceImpl::setThreadLocal(uint32_t index, ThreadLocalObjectSharedPtr object,
+                                  uint64_t version) {
   if (thread_local_data_.data_.size() <= index) {
     thread_local_data_.data_.resize(index + 1);
+    thread_local_data_.versions_.resize(index + 1);
   }
 
   thread_local_data_.data_[index] = object;
+  thread_local_data_.versions_[index] = version;
 }
 
 void InstanceImpl::shutdownGlobalThreading() {
@@ -167,6 +210,7 @@ void InstanceImpl::shutdownThread() {
     it->reset();
   }
   thread_local_data_.data_.clear();
+  thread_local_data_.versions_.clear();
 }
 
 Event::Dispatcher& InstanceImpl::dispatcher() {
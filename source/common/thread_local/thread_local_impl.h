@@ -7,7 +7,10 @@
 
 #include "envoy/thread_local/thread_local.h"
 
+#include "common/common/lock_guard.h"
 #include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
 
 namespace Envoy {
 namespace ThreadLocal {
@@ -39,26 +42,40 @@ private:
       parent_.runOnAllThreads(cb, main_callback);
     }
     void set(InitializeCb cb) override;
+    void publish(ThreadLocalObjectSharedPtr object) override;
+
+    void refreshPublished();
 
     InstanceImpl& parent_;
     const uint64_t index_;
+    // Version of the last published object, 0 if the slot was last updated by set(). A thread
+    // holding another version refreshes its object from published_ on its next get().
+    std::atomic<uint64_t> version_{};
+    Thread::MutexBasicLockable published_lock_;
+    ThreadLocalObjectSharedPtr published_ GUARDED_BY(published_lock_);
   };
 
   struct ThreadLocalData {
     Event::Dispatcher* dispatcher_{};
     std::vector<ThreadLocalObjectSharedPtr> data_;
+    // Version of the published object held in each slot of data_, 0 if none.
+    std::vector<uint64_t> versions_;
   };
 
   void removeSlot(SlotImpl& slot);
   void runOnAllThreads(Event::PostCb cb);
   void runOnAllThreads(Event::PostCb cb, Event::PostCb main_callback);
-  static void setThreadLocal(uint32_t index, ThreadLocalObjectSharedPtr object);
+  static void setThreadLocal(uint32_t index, ThreadLocalObjectSharedPtr object,
+                             uint64_t version = 0);
 
   static thread_local ThreadLocalData thread_local_data_;
   std::vector<SlotImpl*> slots_;
   std::list<std::reference_wrapper<Event::Dispatcher>> registered_threads_;
   std::thread::id main_thread_id_;
   Event::Dispatcher* main_thread_dispatcher_{};
+  // Versions are unique across slots so that a thread never takes the object of a removed slot
+  // for the current one of a new slot reusing its index.
+  uint64_t last_version_{};
   std::atomic<bool> shutdown_{};
 };
 
@@ -64,9 +64,8 @@ Decision HttpTracerUtility::isTracing(const RequestInfo::RequestInfo& request_in
     return {Reason::NotTraceableRequestId, false};
   }
 
-  // TODO PERF: Avoid copy.
   UuidTraceStatus trace_status =
-      UuidUtils::isTraceableUuid(request_headers.RequestId()->value().c_str());
+      UuidUtils::isTraceableUuid(request_headers.RequestId()->value().getStringView());
 
   switch (trace_status) {
   case UuidTraceStatus::Client:
@@ -85,6 +84,12 @@ Decision HttpTracerUtility::isTracing(const RequestInfo::RequestInfo& request_in
 void HttpTracerUtility::finalizeSpan(Span& span, const Http::HeaderMap* request_headers,
                                      const RequestInfo::RequestInfo& request_info,
                                      const Config& tracing_config) {
+  // Unsampled spans only propagate the trace context, so there is no point formatting tags.
+  if (!span.sampled()) {
+    span.finishSpan();
+    return;
+  }
+
   // Pre response data.
   if (request_headers) {
     span.setTag(Tracing::Tags::get().GUID_X_REQUEST_ID,
@@ -146,7 +151,7 @@ SpanPtr HttpTracerImpl::startSpan(const Config& config, Http::HeaderMap& request
 
   SpanPtr active_span = driver_->startSpan(config, request_headers, span_name,
                                            request_info.startTime(), tracing_decision);
-  if (active_span) {
+  if (active_span && active_span->sampled()) {
     active_span->setTag(Tracing::Tags::get().COMPONENT, Tracing::Tags::get().PROXY);
     active_span->setTag(Tracing::Tags::get().NODE_ID, local_info_.nodeName());
     active_span->setTag(Tracing::Tags::get().ZONE, local_info_.zoneName());
@@ -121,6 +121,7 @@ public:
     return SpanPtr{new NullSpan()};
   }
   void setSampled(bool) override {}
+  bool sampled() const override { return false; }
 };
 
 class HttpNullTracer : public HttpTracer {
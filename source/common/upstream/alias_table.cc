@@ -0,0 +1,62 @@
+#include "common/upstream/alias_table.h"
+
+#include <limits>
+#include <numeric>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Upstream {
+
+AliasTable::AliasTable(const std::vector<double>& weights) {
+  ASSERT(!weights.empty() && weights.size() <= std::numeric_limits<uint32_t>::max());
+  const double total_weight = std::accumulate(weights.begin(), weights.end(), 0.0);
+  ASSERT(total_weight > 0);
+
+  // Scale the weights so that they average to 1, and split the columns into those that are under
+  // and over full.
+  const uint32_t size = weights.size();
+  std::vector<double> scaled(size);
+  std::vector<uint32_t> small;
+  std::vector<uint32_t> large;
+  for (uint32_t i = 0; i < size; ++i) {
+    scaled[i] = weights[i] * size / total_weight;
+    if (scaled[i] < 1.0) {
+      small.push_back(i);
+    } else {
+      large.push_back(i);
+    }
+  }
+
+  // Every column starts out picking itself. Each under full column is then topped up from an over
+  // full column, which becomes its alias. Columns left over at the end are full up to floating
+  // point error and keep picking themselves.
+  static constexpr uint64_t full_threshold = 1ULL << 32;
+  columns_.reserve(size);
+  for (uint32_t i = 0; i < size; ++i) {
+    columns_.push_back({full_threshold, i});
+  }
+  while (!small.empty() && !large.empty()) {
+    const uint32_t under = small.back();
+    small.pop_back();
+    const uint32_t over = large.back();
+
+    columns_[under] = {static_cast<uint64_t>(scaled[under] * full_threshold), over};
+    scaled[over] -= 1.0 - scaled[under];
+    if (scaled[over] < 1.0) {
+      large.pop_back();
+      small.push_back(over);
+    }
+  }
+}
+
+uint32_t AliasTable::pick(uint64_t random) const {
+  const Column& column = columns_[(random >> 32) % columns_.size()];
+  if ((random & 0xFFFFFFFF) < column.threshold_) {
+    return &column - columns_.data();
+  }
+  return column.alias_;
+}
+
+} // namespace Upstream
+} // namespace Envoy
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * Walker's alias method (https://en.wikipedia.org/wiki/Alias_method) for O(1) weighted sampling of
+ * an index, built in O(n) with Vose's algorithm. Each index owns one column of the table. A pick
+ * selects a column uniformly and then either keeps it or jumps to the column's alias, with the
+ * split chosen so that each index is selected in proportion to its weight.
+ */
+class AliasTable {
+public:
+  /**
+   * @param weights supplies the non-negative weight of each index. At least one weight must be
+   *        positive.
+   */
+  explicit AliasTable(const std::vector<double>& weights);
+
+  /**
+   * Pick an index.
+   * @param random supplies a uniformly distributed 64-bit random value. The upper 32 bits select
+   *        the column and the lower 32 bits decide between the column and its alias.
+   * @return uint32_t an index into the weights the table was built from.
+   */
+  uint32_t pick(uint64_t random) const;
+
+  /**
+   * @return uint32_t the number of indexes in the table.
+   */
+  uint32_t size() const { return columns_.size(); }
+
+private:
+  struct Column {
+    // The column's own index is picked when the lower 32 bits of the random value are below this
+    // threshold. The threshold is 1 << 32 when the column has no alias.
+    uint64_t threshold_;
+    uint32_t alias_;
+  };
+
+  std::vector<Column> columns_;
+};
+
+} // namespace Upstream
+} // namespace Envoy
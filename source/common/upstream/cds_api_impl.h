@@ -36,6 +36,10 @@ public:
 
   // Config::SubscriptionCallbacks
   void onConfigUpdate(const ResourceVector& resources, const std::string& version_info) override;
+  void onIncrementalConfigUpdate(
+      const ResourceVector& added_resources,
+      const Protobuf::RepeatedPtrField<ProtobufTypes::String>& removed_resources,
+      const std::string& system_version_info) override;
   void onConfigUpdateFailed(const EnvoyException* e) override;
   std::string resourceName(const ProtobufWkt::Any& resource) override {
     return MessageUtil::anyConvert<envoy::api::v2::Cluster>(resource).name();
@@ -46,6 +50,7 @@ private:
              const absl::optional<envoy::api::v2::core::ConfigSource>& eds_config,
              ClusterManager& cm, Event::Dispatcher& dispatcher, Runtime::RandomGenerator& random,
              const LocalInfo::LocalInfo& local_info, Stats::Scope& scope);
+  void validateUpdate(const ResourceVector& resources);
   void runInitializeCallbackIfAny();
 
   ClusterManager& cm_;
@@ -17,6 +17,7 @@
 #include "common/common/fmt.h"
 #include "common/common/utility.h"
 #include "common/config/cds_json.h"
+#include "common/config/snapshot_store.h"
 #include "common/config/utility.h"
 #include "common/filesystem/filesystem_impl.h"
 #include "common/grpc/async_client_manager_impl.h"
@@ -28,6 +29,7 @@
 #include "common/network/utility.h"
 #include "common/protobuf/utility.h"
 #include "common/router/shadow_writer_impl.h"
+#include "common/stats/stage_timer.h"
 #include "common/tcp/conn_pool.h"
 #include "common/upstream/cds_api_impl.h"
 #include "common/upstream/load_balancer_impl.h"
@@ -39,6 +41,55 @@
 namespace Envoy {
 namespace Upstream {
 
+namespace {
+
+// Picks a host, timing the pick as a hot path stage.
+HostConstSharedPtr chooseHost(LoadBalancer& lb, LoadBalancerContext* context) {
+  Stats::StageTimer timer(Stats::Stage::LbChooseHost);
+  return lb.chooseHost(context);
+}
+
+} // namespace
+
+void ClusterInitializeQueue::initialize(Cluster& cluster, std::function<void()> callback) {
+  queue_.push_back({&cluster, callback, time_source_.monotonicTime()});
+  startQueued();
+}
+
+void ClusterInitializeQueue::remove(Cluster& cluster) {
+  queue_.remove_if([&cluster](const Entry& entry) { return entry.cluster_ == &cluster; });
+  queued_.set(queue_.size());
+  if (initializing_.erase(&cluster) > 0) {
+    startQueued();
+  }
+}
+
+void ClusterInitializeQueue::startQueued() {
+  // Clusters that initialize immediately call back into here, in which case the outer call keeps
+  // going rather than recursing once for every queued cluster.
+  if (starting_) {
+    return;
+  }
+  starting_ = true;
+  while (!queue_.empty() &&
+         (max_initializing_ == 0 || initializing_.size() < max_initializing_)) {
+    Entry entry = std::move(queue_.front());
+    queue_.pop_front();
+    Cluster* cluster = entry.cluster_;
+    initializing_.insert(cluster);
+    cluster->initialize([this, cluster, entry]() -> void {
+      initializing_.erase(cluster);
+      initialize_time_.recordValue(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                       time_source_.monotonicTime() - entry.added_)
+                                       .count());
+      entry.callback_();
+      startQueued();
+    });
+  }
+  queued_.set(queue_.size());
+  starting_ = false;
+}
+
 void ClusterManagerInitHelper::addCluster(Cluster& cluster) {
   // See comments in ClusterManagerImpl::addOrUpdateCluster() for why this is only called during
   // server initialization.
@@ -47,14 +98,14 @@ void ClusterManagerInitHelper::addCluster(Cluster& cluster) {
   const auto initialize_cb = [&cluster, this] { onClusterInit(cluster); };
   if (cluster.initializePhase() == Cluster::InitializePhase::Primary) {
     primary_init_clusters_.push_back(&cluster);
-    cluster.initialize(initialize_cb);
+    initialize_queue_.initialize(cluster, initialize_cb);
   } else {
     ASSERT(cluster.initializePhase() == Cluster::InitializePhase::Secondary);
     secondary_init_clusters_.push_back(&cluster);
     if (started_secondary_initialize_) {
       // This can happen if we get a second CDS update that adds new clusters after we have
       // already started secondary init. In this case, just immediately initialize.
-      cluster.initialize(initialize_cb);
+      initialize_queue_.initialize(cluster, initialize_cb);
     }
   }
 
@@ -116,7 +167,7 @@ void ClusterManagerInitHelper::maybeFinishInitialize() {
       for (auto iter = secondary_init_clusters_.begin(); iter != secondary_init_clusters_.end();) {
         Cluster* cluster = *iter;
         ++iter;
-        cluster->initialize([cluster, this] { onClusterInit(*cluster); });
+        initialize_queue_.initialize(*cluster, [cluster, this] { onClusterInit(*cluster); });
       }
     }
 
@@ -173,15 +224,19 @@ ClusterManagerImpl::ClusterManagerImpl(const envoy::config::bootstrap::v2::Boots
                                        AccessLog::AccessLogManager& log_manager,
                                        Event::Dispatcher& main_thread_dispatcher,
                                        Server::Admin& admin)
-    : factory_(factory), runtime_(runtime), stats_(stats), tls_(tls.allocateSlot()),
+    : xds_decode_pool_(bootstrap.dynamic_resources().decode_threads()), factory_(factory),
+      runtime_(runtime), stats_(stats), tls_(tls.allocateSlot()),
       random_(random), log_manager_(log_manager),
       bind_config_(bootstrap.cluster_manager().upstream_bind_config()), local_info_(local_info),
-      cm_stats_(generateStats(stats)),
-      init_helper_([this](Cluster& cluster) { onClusterInit(cluster); }),
+      cm_stats_(generateStats(stats)), time_source_(main_thread_dispatcher.timeSystem()),
+      initialize_queue_(bootstrap.cluster_manager().max_warming_clusters(), time_source_,
+                        cm_stats_.queued_warming_clusters_, cm_stats_.cluster_warming_time_ms_),
+      init_helper_(initialize_queue_, [this](Cluster& cluster) { onClusterInit(cluster); }),
       config_tracker_entry_(
           admin.getConfigTracker().add("clusters", [this] { return dumpClusterConfigs(); })),
-      time_source_(main_thread_dispatcher.timeSystem()), dispatcher_(main_thread_dispatcher) {
-  async_client_manager_ = std::make_unique<Grpc::AsyncClientManagerImpl>(*this, tls, time_source_);
+      dispatcher_(main_thread_dispatcher) {
+  async_client_manager_ = std::make_unique<Grpc::AsyncClientManagerImpl>(
+      *this, tls, time_source_, bootstrap.cluster_manager().google_grpc_completion_threads());
   const auto& cm_config = bootstrap.cluster_manager();
   if (cm_config.has_outlier_detection()) {
     const std::string event_log_file_path = cm_config.outlier_detection().event_log_path();
@@ -208,7 +263,19 @@ ClusterManagerImpl::ClusterManagerImpl(const envoy::config::bootstrap::v2::Boots
   }
 
   // Now setup ADS if needed, this might rely on a primary cluster.
-  if (bootstrap.dynamic_resources().has_ads_config()) {
+  if (bootstrap.dynamic_resources().has_ads_config() &&
+      bootstrap.dynamic_resources().ads_config().api_type() ==
+          envoy::api::v2::core::ApiConfigSource::INCREMENTAL_GRPC) {
+    ads_mux_.reset(new Config::IncrementalGrpcMuxImpl(
+        local_info,
+        Config::Utility::factoryForGrpcApiConfigSource(
+            *async_client_manager_, bootstrap.dynamic_resources().ads_config(), stats)
+            ->create(),
+        main_thread_dispatcher,
+        *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
+            "envoy.service.discovery.v2.AggregatedDiscoveryService.IncrementalAggregatedResources"),
+        random_));
+  } else if (bootstrap.dynamic_resources().has_ads_config()) {
     ads_mux_.reset(new Config::GrpcMuxImpl(
         local_info,
         Config::Utility::factoryForGrpcApiConfigSource(
@@ -217,7 +284,11 @@ ClusterManagerImpl::ClusterManagerImpl(const envoy::config::bootstrap::v2::Boots
         main_thread_dispatcher,
         *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
             "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
-        random_));
+        random_,
+        bootstrap.dynamic_resources().ads_snapshot_directory().empty()
+            ? nullptr
+            : std::make_unique<Config::SnapshotStore>(
+                  bootstrap.dynamic_resources().ads_snapshot_directory())));
   } else {
     ads_mux_.reset(new Config::NullGrpcMuxImpl());
   }
@@ -311,7 +382,8 @@ ClusterManagerImpl::ClusterManagerImpl(const envoy::config::bootstrap::v2::Boots
 ClusterManagerStats ClusterManagerImpl::generateStats(Stats::Scope& scope) {
   const std::string final_prefix = "cluster_manager.";
   return {ALL_CLUSTER_MANAGER_STATS(POOL_COUNTER_PREFIX(scope, final_prefix),
-                                    POOL_GAUGE_PREFIX(scope, final_prefix))};
+                                    POOL_GAUGE_PREFIX(scope, final_prefix),
+                                    POOL_HISTOGRAM_PREFIX(scope, final_prefix))};
 }
 
 void ClusterManagerImpl::onClusterInit(Cluster& cluster) {
@@ -467,6 +539,13 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::api::v2::Cluster& clust
 
   if (existing_active_cluster != active_clusters_.end() ||
       existing_warming_cluster != warming_clusters_.end()) {
+    // The cluster being replaced may still be waiting for or in the middle of its initialization.
+    if (existing_active_cluster != active_clusters_.end()) {
+      initialize_queue_.remove(*existing_active_cluster->second->cluster_);
+    }
+    if (existing_warming_cluster != warming_clusters_.end()) {
+      initialize_queue_.remove(*existing_warming_cluster->second->cluster_);
+    }
     // The following init manager remove call is a NOP in the case we are already initialized. It's
     // just kept here to avoid additional logic.
     init_helper_.removeCluster(*existing_active_cluster->second->cluster_);
@@ -497,7 +576,7 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::api::v2::Cluster& clust
   } else {
     auto& cluster_entry = warming_clusters_.at(cluster_name);
     ENVOY_LOG(info, "add/update cluster {} starting warming", cluster_name);
-    cluster_entry->cluster_->initialize([this, cluster_name] {
+    initialize_queue_.initialize(*cluster_entry->cluster_, [this, cluster_name] {
       auto warming_it = warming_clusters_.find(cluster_name);
       auto& cluster_entry = *warming_it->second;
 
@@ -520,22 +599,27 @@ bool ClusterManagerImpl::addOrUpdateCluster(const envoy::api::v2::Cluster& clust
 }
 
 void ClusterManagerImpl::createOrUpdateThreadLocalCluster(ClusterData& cluster) {
-  tls_->runOnAllThreads([this, new_cluster = cluster.cluster_->info(),
-                         thread_aware_lb_factory = cluster.loadBalancerFactory()]() -> void {
+  tls_->runOnAllThreads([this, snapshot = cluster.thread_local_snapshot_]() -> void {
     ThreadLocalClusterManagerImpl& cluster_manager =
         tls_->getTyped<ThreadLocalClusterManagerImpl>();
+    const std::string& name = snapshot->info_->name();
 
-    if (cluster_manager.thread_local_clusters_.count(new_cluster->name()) > 0) {
-      ENVOY_LOG(debug, "updating TLS cluster {}", new_cluster->name());
+    cluster_manager.cluster_snapshots_[name] = snapshot;
+    if (!cluster_manager.createEagerly(*snapshot)) {
+      ENVOY_LOG(debug, "adding TLS cluster {} for creation on first use", name);
+      return;
+    }
+
+    if (cluster_manager.thread_local_clusters_.count(name) > 0) {
+      ENVOY_LOG(debug, "updating TLS cluster {}", name);
     } else {
-      ENVOY_LOG(debug, "adding TLS cluster {}", new_cluster->name());
+      ENVOY_LOG(debug, "adding TLS cluster {}", name);
     }
 
-    auto thread_local_cluster = new ThreadLocalClusterManagerImpl::ClusterEntry(
-        cluster_manager, new_cluster, thread_aware_lb_factory);
-    cluster_manager.thread_local_clusters_[new_cluster->name()].reset(thread_local_cluster);
+    ThreadLocalClusterManagerImpl::ClusterEntry& thread_local_cluster =
+        cluster_manager.createCluster(*snapshot);
     for (auto& cb : cluster_manager.update_callbacks_) {
-      cb->onClusterAddOrUpdate(*thread_local_cluster);
+      cb->onClusterAddOrUpdate(thread_local_cluster);
     }
   });
 }
@@ -546,6 +630,7 @@ bool ClusterManagerImpl::removeCluster(const std::string& cluster_name) {
   if (existing_active_cluster != active_clusters_.end() &&
       existing_active_cluster->second->added_via_api_) {
     removed = true;
+    initialize_queue_.remove(*existing_active_cluster->second->cluster_);
     init_helper_.removeCluster(*existing_active_cluster->second->cluster_);
     active_clusters_.erase(existing_active_cluster);
 
@@ -554,8 +639,9 @@ bool ClusterManagerImpl::removeCluster(const std::string& cluster_name) {
       ThreadLocalClusterManagerImpl& cluster_manager =
           tls_->getTyped<ThreadLocalClusterManagerImpl>();
 
-      ASSERT(cluster_manager.thread_local_clusters_.count(cluster_name) == 1);
+      ASSERT(cluster_manager.cluster_snapshots_.count(cluster_name) == 1);
       ENVOY_LOG(debug, "removing TLS cluster {}", cluster_name);
+      cluster_manager.cluster_snapshots_.erase(cluster_name);
       cluster_manager.thread_local_clusters_.erase(cluster_name);
       for (auto& cb : cluster_manager.update_callbacks_) {
         cb->onClusterRemoval(cluster_name);
@@ -567,6 +653,7 @@ bool ClusterManagerImpl::removeCluster(const std::string& cluster_name) {
   if (existing_warming_cluster != warming_clusters_.end() &&
       existing_warming_cluster->second->added_via_api_) {
     removed = true;
+    initialize_queue_.remove(*existing_warming_cluster->second->cluster_);
     warming_clusters_.erase(existing_warming_cluster);
     ENVOY_LOG(info, "removing warming cluster {}", cluster_name);
   }
@@ -629,6 +716,10 @@ void ClusterManagerImpl::loadCluster(const envoy::api::v2::Cluster& cluster,
         cluster_reference.info()->lbConfig());
   }
 
+  cluster_entry_it->second->thread_local_snapshot_ =
+      std::make_shared<const ThreadLocalClusterSnapshot>(ThreadLocalClusterSnapshot{
+          cluster_reference.info(), cluster_entry_it->second->loadBalancerFactory(), {}});
+
   updateGauges();
 }
 
@@ -640,12 +731,7 @@ void ClusterManagerImpl::updateGauges() {
 ThreadLocalCluster* ClusterManagerImpl::get(const std::string& cluster) {
   ThreadLocalClusterManagerImpl& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
 
-  auto entry = cluster_manager.thread_local_clusters_.find(cluster);
-  if (entry != cluster_manager.thread_local_clusters_.end()) {
-    return entry->second.get();
-  } else {
-    return nullptr;
-  }
+  return cluster_manager.getCluster(cluster);
 }
 
 Http::ConnectionPool::Instance*
@@ -653,13 +739,13 @@ ClusterManagerImpl::httpConnPoolForCluster(const std::string& cluster, ResourceP
                                            Http::Protocol protocol, LoadBalancerContext* context) {
   ThreadLocalClusterManagerImpl& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
 
-  auto entry = cluster_manager.thread_local_clusters_.find(cluster);
-  if (entry == cluster_manager.thread_local_clusters_.end()) {
+  ThreadLocalClusterManagerImpl::ClusterEntry* entry = cluster_manager.getCluster(cluster);
+  if (entry == nullptr) {
     return nullptr;
   }
 
   // Select a host and create a connection pool for it if it does not already exist.
-  return entry->second->connPool(priority, protocol, context);
+  return entry->connPool(priority, protocol, context);
 }
 
 Tcp::ConnectionPool::Instance*
@@ -667,35 +753,50 @@ ClusterManagerImpl::tcpConnPoolForCluster(const std::string& cluster, ResourcePr
                                           LoadBalancerContext* context) {
   ThreadLocalClusterManagerImpl& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
 
-  auto entry = cluster_manager.thread_local_clusters_.find(cluster);
-  if (entry == cluster_manager.thread_local_clusters_.end()) {
+  ThreadLocalClusterManagerImpl::ClusterEntry* entry = cluster_manager.getCluster(cluster);
+  if (entry == nullptr) {
     return nullptr;
   }
 
   // Select a host and create a connection pool for it if it does not already exist.
-  return entry->second->tcpConnPool(priority, context);
+  return entry->tcpConnPool(priority, context);
 }
 
 void ClusterManagerImpl::postThreadLocalClusterUpdate(const Cluster& cluster, uint32_t priority,
                                                       const HostVector& hosts_added,
                                                       const HostVector& hosts_removed) {
+  auto cluster_data_it = active_clusters_.find(cluster.info()->name());
+  if (cluster_data_it == active_clusters_.end() ||
+      cluster_data_it->second->cluster_.get() != &cluster) {
+    // The hosts of a cluster that was since replaced or removed are of no use to the threads.
+    return;
+  }
+  ClusterData& cluster_data = *cluster_data_it->second;
   const auto& host_set = cluster.prioritySet().hostSetsPerPriority()[priority];
 
-  // TODO(htuch): Can we skip these copies by exporting out const shared_ptr from HostSet?
-  HostVectorConstSharedPtr hosts_copy(new HostVector(host_set->hosts()));
-  HostVectorConstSharedPtr healthy_hosts_copy(new HostVector(host_set->healthyHosts()));
-  HostsPerLocalityConstSharedPtr hosts_per_locality_copy = host_set->hostsPerLocality().clone();
-  HostsPerLocalityConstSharedPtr healthy_hosts_per_locality_copy =
-      host_set->healthyHostsPerLocality().clone();
-
-  tls_->runOnAllThreads(
-      [this, name = cluster.info()->name(), priority, hosts_copy, healthy_hosts_copy,
-       hosts_per_locality_copy, healthy_hosts_per_locality_copy,
-       locality_weights = host_set->localityWeights(), hosts_added, hosts_removed]() {
-        ThreadLocalClusterManagerImpl::updateClusterMembership(
-            name, priority, hosts_copy, healthy_hosts_copy, hosts_per_locality_copy,
-            healthy_hosts_per_locality_copy, locality_weights, hosts_added, hosts_removed, *tls_);
-      });
+  // The host lists are immutable once set on the main thread's host set, so every worker shares
+  // them, through a new snapshot of the cluster, instead of receiving copies. The deltas are copied
+  // once here rather than once per worker with each posted callback.
+  auto new_snapshot =
+      std::make_shared<ThreadLocalClusterSnapshot>(*cluster_data.thread_local_snapshot_);
+  if (new_snapshot->host_sets_.size() <= priority) {
+    new_snapshot->host_sets_.resize(priority + 1);
+  }
+  new_snapshot->host_sets_[priority] = {host_set->hostsPtr(), host_set->healthyHostsPtr(),
+                                        host_set->hostsPerLocalityPtr(),
+                                        host_set->healthyHostsPerLocalityPtr(),
+                                        host_set->localityWeights()};
+  cluster_data.thread_local_snapshot_ = std::move(new_snapshot);
+  HostVectorConstSharedPtr hosts_added_copy(new HostVector(hosts_added));
+  HostVectorConstSharedPtr hosts_removed_copy(new HostVector(hosts_removed));
+
+  tls_->runOnAllThreads([this, name = cluster.info()->name(), priority,
+                         snapshot = cluster_data.thread_local_snapshot_, hosts_added_copy,
+                         hosts_removed_copy]() {
+    ThreadLocalClusterManagerImpl::updateClusterMembership(name, priority, snapshot,
+                                                           *hosts_added_copy, *hosts_removed_copy,
+                                                           *tls_);
+  });
 }
 
 void ClusterManagerImpl::postThreadLocalHealthFailure(const HostSharedPtr& host) {
@@ -707,16 +808,16 @@ Host::CreateConnectionData ClusterManagerImpl::tcpConnForCluster(const std::stri
                                                                  LoadBalancerContext* context) {
   ThreadLocalClusterManagerImpl& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
 
-  auto entry = cluster_manager.thread_local_clusters_.find(cluster);
-  if (entry == cluster_manager.thread_local_clusters_.end()) {
+  ThreadLocalClusterManagerImpl::ClusterEntry* entry = cluster_manager.getCluster(cluster);
+  if (entry == nullptr) {
     throw EnvoyException(fmt::format("unknown cluster '{}'", cluster));
   }
 
-  HostConstSharedPtr logical_host = entry->second->lb_->chooseHost(context);
+  HostConstSharedPtr logical_host = chooseHost(*entry->lb_, context);
   if (logical_host) {
     auto conn_info =
         logical_host->createConnection(cluster_manager.thread_local_dispatcher_, nullptr);
-    if ((entry->second->cluster_info_->features() &
+    if ((entry->cluster_info_->features() &
          ClusterInfo::Features::CLOSE_CONNECTIONS_ON_HOST_HEALTH_FAILURE) &&
         conn_info.connection_ != nullptr) {
       auto& conn_map = cluster_manager.host_tcp_conn_map_[logical_host];
@@ -726,16 +827,16 @@ Host::CreateConnectionData ClusterManagerImpl::tcpConnForCluster(const std::stri
     }
     return conn_info;
   } else {
-    entry->second->cluster_info_->stats().upstream_cx_none_healthy_.inc();
+    entry->cluster_info_->stats().upstream_cx_none_healthy_.inc();
     return {nullptr, nullptr};
   }
 }
 
 Http::AsyncClient& ClusterManagerImpl::httpAsyncClientForCluster(const std::string& cluster) {
   ThreadLocalClusterManagerImpl& cluster_manager = tls_->getTyped<ThreadLocalClusterManagerImpl>();
-  auto entry = cluster_manager.thread_local_clusters_.find(cluster);
-  if (entry != cluster_manager.thread_local_clusters_.end()) {
-    return entry->second->http_async_client_;
+  ThreadLocalClusterManagerImpl::ClusterEntry* entry = cluster_manager.getCluster(cluster);
+  if (entry != nullptr) {
+    return entry->http_async_client_;
   } else {
     throw EnvoyException(fmt::format("unknown cluster '{}'", cluster));
   }
@@ -793,28 +894,24 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl
     ClusterManagerImpl& parent, Event::Dispatcher& dispatcher,
     const absl::optional<std::string>& local_cluster_name)
     : parent_(parent), thread_local_dispatcher_(dispatcher) {
-  // If local cluster is defined then we need to initialize it first.
+  for (auto& cluster : parent.active_clusters_) {
+    cluster_snapshots_[cluster.first] = cluster.second->thread_local_snapshot_;
+  }
+
+  // If local cluster is defined then we need to initialize it first, as the load balancers of
+  // the other clusters refer to it.
   if (local_cluster_name) {
     ENVOY_LOG(debug, "adding TLS local cluster {}", local_cluster_name.value());
-    auto& local_cluster = parent.active_clusters_.at(local_cluster_name.value());
-    thread_local_clusters_[local_cluster_name.value()].reset(new ClusterEntry(
-        *this, local_cluster->cluster_->info(), local_cluster->loadBalancerFactory()));
+    local_priority_set_ =
+        &createCluster(*cluster_snapshots_.at(local_cluster_name.value())).priority_set_;
   }
 
-  local_priority_set_ = local_cluster_name
-                            ? &thread_local_clusters_[local_cluster_name.value()]->priority_set_
-                            : nullptr;
-
-  for (auto& cluster : parent.active_clusters_) {
-    // If local cluster name is set then we already initialized this cluster.
-    if (local_cluster_name && local_cluster_name.value() == cluster.first) {
-      continue;
+  // The other clusters are created on first use.
+  for (auto& cluster : cluster_snapshots_) {
+    if (thread_local_clusters_.count(cluster.first) == 0 && createEagerly(*cluster.second)) {
+      ENVOY_LOG(debug, "adding TLS initial cluster {}", cluster.first);
+      createCluster(*cluster.second);
     }
-
-    ENVOY_LOG(debug, "adding TLS initial cluster {}", cluster.first);
-    ASSERT(thread_local_clusters_.count(cluster.first) == 0);
-    thread_local_clusters_[cluster.first].reset(new ClusterEntry(
-        *this, cluster.second->cluster_->info(), cluster.second->loadBalancerFactory()));
   }
 }
 
@@ -829,6 +926,7 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::~ThreadLocalClusterManagerImp
   destroying_ = true;
   host_http_conn_pool_map_.clear();
   host_tcp_conn_pool_map_.clear();
+  shared_conn_pool_hosts_.clear();
   ASSERT(host_tcp_conn_map_.empty());
   for (auto& cluster : thread_local_clusters_) {
     if (&cluster.second->priority_set_ != local_priority_set_) {
@@ -836,10 +934,61 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::~ThreadLocalClusterManagerImp
     }
   }
   thread_local_clusters_.clear();
+  cluster_snapshots_.clear();
+}
+
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry*
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::getCluster(const std::string& name) {
+  auto entry = thread_local_clusters_.find(name);
+  if (entry != thread_local_clusters_.end()) {
+    return entry->second.get();
+  }
+
+  auto snapshot = cluster_snapshots_.find(name);
+  if (snapshot == cluster_snapshots_.end()) {
+    return nullptr;
+  }
+  return &createCluster(*snapshot->second);
+}
+
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry&
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::createCluster(
+    const ThreadLocalClusterSnapshot& snapshot) {
+  ENVOY_LOG(debug, "creating TLS cluster {}", snapshot.info_->name());
+  ClusterEntryPtr& entry = thread_local_clusters_[snapshot.info_->name()];
+  entry.reset(new ClusterEntry(*this, snapshot.info_, snapshot.lb_factory_));
+
+  // Catch up with the membership updates posted so far, as if they had been applied one by one.
+  for (uint32_t priority = 0; priority < snapshot.host_sets_.size(); ++priority) {
+    const ThreadLocalClusterSnapshot::HostSet& host_set = snapshot.host_sets_[priority];
+    if (host_set.hosts_ == nullptr) {
+      continue;
+    }
+    entry->priority_set_.getOrCreateHostSet(priority).updateHosts(
+        host_set.hosts_, host_set.healthy_hosts_, host_set.hosts_per_locality_,
+        host_set.healthy_hosts_per_locality_, host_set.locality_weights_, *host_set.hosts_,
+        HostVector{}, absl::nullopt);
+  }
+  if (entry->lb_factory_ != nullptr && !snapshot.host_sets_.empty()) {
+    entry->lb_ = entry->lb_factory_->create();
+  }
+  return *entry;
+}
+
+bool ClusterManagerImpl::ThreadLocalClusterManagerImpl::createEagerly(
+    const ThreadLocalClusterSnapshot& snapshot) const {
+  // Clusters in use stay in use across updates. Update callbacks are told about every cluster as
+  // it is added, which takes a thread local cluster. The original destination load balancer is
+  // created from the main thread's cluster, which is looked up as the cluster is added rather
+  // than at an arbitrary later time.
+  return thread_local_clusters_.count(snapshot.info_->name()) > 0 || !update_callbacks_.empty() ||
+         snapshot.info_->lbType() == LoadBalancerType::OriginalDst;
 }
 
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::drainConnPools(const HostVector& hosts) {
   for (const HostSharedPtr& host : hosts) {
+    // Other clusters sharing the pools of the host get new ones from now on.
+    removeSharedConnPoolHost(host);
     {
       auto container = host_http_conn_pool_map_.find(host);
       if (container != host_http_conn_pool_map_.end()) {
@@ -923,6 +1072,43 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::drainTcpConnPools(
   }
 }
 
+HostConstSharedPtr
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::connPoolHost(const HostConstSharedPtr& host) {
+  const absl::optional<uint64_t> key = host->cluster().sharedConnPoolKey();
+  if (!key) {
+    return host;
+  }
+
+  auto it = shared_conn_pool_hosts_
+                .emplace(std::make_pair(host->address()->asString(), key.value()), host)
+                .first;
+  return it->second;
+}
+
+HostConstSharedPtr ClusterManagerImpl::ThreadLocalClusterManagerImpl::findConnPoolHost(
+    const HostConstSharedPtr& host) const {
+  const absl::optional<uint64_t> key = host->cluster().sharedConnPoolKey();
+  if (!key) {
+    return host;
+  }
+
+  auto it = shared_conn_pool_hosts_.find(std::make_pair(host->address()->asString(), key.value()));
+  return it != shared_conn_pool_hosts_.end() ? it->second : host;
+}
+
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::removeSharedConnPoolHost(
+    const HostConstSharedPtr& host) {
+  const absl::optional<uint64_t> key = host->cluster().sharedConnPoolKey();
+  if (!key) {
+    return;
+  }
+
+  auto it = shared_conn_pool_hosts_.find(std::make_pair(host->address()->asString(), key.value()));
+  if (it != shared_conn_pool_hosts_.end() && it->second == host) {
+    shared_conn_pool_hosts_.erase(it);
+  }
+}
+
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::removeTcpConn(
     const HostConstSharedPtr& host, Network::ClientConnection& connection) {
   auto host_tcp_conn_map_it = host_tcp_conn_map_.find(host);
@@ -938,20 +1124,25 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::removeTcpConn(
 }
 
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::updateClusterMembership(
-    const std::string& name, uint32_t priority, HostVectorConstSharedPtr hosts,
-    HostVectorConstSharedPtr healthy_hosts, HostsPerLocalityConstSharedPtr hosts_per_locality,
-    HostsPerLocalityConstSharedPtr healthy_hosts_per_locality,
-    LocalityWeightsConstSharedPtr locality_weights, const HostVector& hosts_added,
-    const HostVector& hosts_removed, ThreadLocal::Slot& tls) {
+    const std::string& name, uint32_t priority, ThreadLocalClusterSnapshotConstSharedPtr snapshot,
+    const HostVector& hosts_added, const HostVector& hosts_removed, ThreadLocal::Slot& tls) {
 
   ThreadLocalClusterManagerImpl& config = tls.getTyped<ThreadLocalClusterManagerImpl>();
 
-  ASSERT(config.thread_local_clusters_.find(name) != config.thread_local_clusters_.end());
-  const auto& cluster_entry = config.thread_local_clusters_[name];
+  ASSERT(config.cluster_snapshots_.find(name) != config.cluster_snapshots_.end());
+  const ThreadLocalClusterSnapshot::HostSet& host_set = snapshot->host_sets_[priority];
+  config.cluster_snapshots_[name] = snapshot;
+  auto entry = config.thread_local_clusters_.find(name);
+  if (entry == config.thread_local_clusters_.end()) {
+    // The cluster is created from the snapshot on first use.
+    return;
+  }
+
+  const auto& cluster_entry = entry->second;
   ENVOY_LOG(debug, "membership update for TLS cluster {}", name);
   cluster_entry->priority_set_.getOrCreateHostSet(priority).updateHosts(
-      std::move(hosts), std::move(healthy_hosts), std::move(hosts_per_locality),
-      std::move(healthy_hosts_per_locality), std::move(locality_weights), hosts_added,
+      host_set.hosts_, host_set.healthy_hosts_, host_set.hosts_per_locality_,
+      host_set.healthy_hosts_per_locality_, host_set.locality_weights_, hosts_added,
       hosts_removed, absl::nullopt);
 
   // If an LB is thread aware, create a new worker local LB on membership changes.
@@ -971,8 +1162,9 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::onHostHealthFailure(
   // more granular host set changes, we should be able to capture single host changes and make them
   // more targeted.
   ThreadLocalClusterManagerImpl& config = tls.getTyped<ThreadLocalClusterManagerImpl>();
+  const HostConstSharedPtr pool_host = config.findConnPoolHost(host);
   {
-    const auto& container = config.host_http_conn_pool_map_.find(host);
+    const auto& container = config.host_http_conn_pool_map_.find(pool_host);
     if (container != config.host_http_conn_pool_map_.end()) {
       for (const auto& pair : container->second.pools_) {
         const Http::ConnectionPool::InstancePtr& pool = pair.second;
@@ -981,7 +1173,7 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::onHostHealthFailure(
     }
   }
   {
-    const auto& container = config.host_tcp_conn_pool_map_.find(host);
+    const auto& container = config.host_tcp_conn_pool_map_.find(pool_host);
     if (container != config.host_tcp_conn_pool_map_.end()) {
       for (const auto& pair : container->second.pools_) {
         const Tcp::ConnectionPool::InstancePtr& pool = pair.second;
@@ -1028,14 +1220,15 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
     lb_.reset(new SubsetLoadBalancer(cluster->lbType(), priority_set_, parent_.local_priority_set_,
                                      cluster->stats(), parent.parent_.runtime_,
                                      parent.parent_.random_, cluster->lbSubsetInfo(),
-                                     cluster->lbRingHashConfig(), cluster->lbConfig()));
+                                     cluster->lbRingHashConfig(), cluster->lbLeastRequestConfig(),
+                                     cluster->lbConfig()));
   } else {
     switch (cluster->lbType()) {
     case LoadBalancerType::LeastRequest: {
       ASSERT(lb_factory_ == nullptr);
-      lb_.reset(new LeastRequestLoadBalancer(priority_set_, parent_.local_priority_set_,
-                                             cluster->stats(), parent.parent_.runtime_,
-                                             parent.parent_.random_, cluster->lbConfig()));
+      lb_.reset(new LeastRequestLoadBalancer(
+          priority_set_, parent_.local_priority_set_, cluster->stats(), parent.parent_.runtime_,
+          parent.parent_.random_, cluster->lbConfig(), cluster->lbLeastRequestConfig()));
       break;
     }
     case LoadBalancerType::Random: {
@@ -1092,7 +1285,7 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::~ClusterEntry()
 Http::ConnectionPool::Instance*
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
     ResourcePriority priority, Http::Protocol protocol, LoadBalancerContext* context) {
-  HostConstSharedPtr host = lb_->chooseHost(context);
+  HostConstSharedPtr host = chooseHost(*lb_, context);
   if (!host) {
     ENVOY_LOG(debug, "no healthy host for HTTP connection pool");
     cluster_info_->stats().upstream_cx_none_healthy_.inc();
@@ -1117,10 +1310,12 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
     }
   }
 
-  ConnPoolsContainer& container = parent_.host_http_conn_pool_map_[host];
+  // The pools may be shared with other clusters, in which case they belong to another host.
+  const HostConstSharedPtr pool_host = parent_.connPoolHost(host);
+  ConnPoolsContainer& container = parent_.host_http_conn_pool_map_[pool_host];
   if (!container.pools_[hash_key]) {
     container.pools_[hash_key] = parent_.parent_.factory_.allocateConnPool(
-        parent_.thread_local_dispatcher_, host, priority, protocol,
+        parent_.thread_local_dispatcher_, pool_host, priority, protocol,
         have_options ? context->downstreamConnection()->socketOptions() : nullptr);
   }
 
@@ -1130,7 +1325,7 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
 Tcp::ConnectionPool::Instance*
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::tcpConnPool(
     ResourcePriority priority, LoadBalancerContext* context) {
-  HostConstSharedPtr host = lb_->chooseHost(context);
+  HostConstSharedPtr host = chooseHost(*lb_, context);
   if (!host) {
     ENVOY_LOG(debug, "no healthy host for TCP connection pool");
     cluster_info_->stats().upstream_cx_none_healthy_.inc();
@@ -1155,10 +1350,11 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::tcpConnPool(
     }
   }
 
-  TcpConnPoolsContainer& container = parent_.host_tcp_conn_pool_map_[host];
+  const HostConstSharedPtr pool_host = parent_.connPoolHost(host);
+  TcpConnPoolsContainer& container = parent_.host_tcp_conn_pool_map_[pool_host];
   if (!container.pools_[hash_key]) {
     container.pools_[hash_key] = parent_.parent_.factory_.allocateTcpConnPool(
-        parent_.thread_local_dispatcher_, host, priority,
+        parent_.thread_local_dispatcher_, pool_host, priority,
         have_options ? context->downstreamConnection()->socketOptions() : nullptr);
   }
 
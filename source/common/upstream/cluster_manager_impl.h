@@ -7,6 +7,8 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "envoy/config/bootstrap/v2/bootstrap.pb.h"
@@ -19,7 +21,9 @@
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "common/config/decode_pool_impl.h"
 #include "common/config/grpc_mux_impl.h"
+#include "common/config/incremental_grpc_mux_impl.h"
 #include "common/http/async_client_impl.h"
 #include "common/upstream/load_stats_reporter.h"
 #include "common/upstream/upstream_impl.h"
@@ -81,6 +85,58 @@ private:
   Secret::SecretManager& secret_manager_;
 };
 
+/**
+ * Bounds the number of clusters that initialize (resolve DNS, fetch their endpoints, run their
+ * first health checks, etc.) at once. The clusters beyond the bound wait, and start in the order
+ * they were added so that a management server can put the clusters that matter most, e.g. the ones
+ * its routes reference, first in a CDS response.
+ */
+class ClusterInitializeQueue {
+public:
+  /**
+   * @param max_initializing supplies the maximum number of clusters initializing at once, or 0
+   *        for no bound.
+   * @param time_source supplies the time source that the initialize time is measured with.
+   * @param queued supplies the gauge of the number of clusters waiting to initialize.
+   * @param initialize_time supplies the histogram of the time from adding a cluster until it has
+   *        initialized, in milliseconds.
+   */
+  ClusterInitializeQueue(uint32_t max_initializing, TimeSource& time_source, Stats::Gauge& queued,
+                         Stats::Histogram& initialize_time)
+      : max_initializing_(max_initializing), time_source_(time_source), queued_(queued),
+        initialize_time_(initialize_time) {}
+
+  /**
+   * Initialize a cluster, now or once another cluster has initialized.
+   * @param cluster supplies the cluster.
+   * @param callback supplies the callback to call once the cluster has initialized.
+   */
+  void initialize(Cluster& cluster, std::function<void()> callback);
+
+  /**
+   * Forget a cluster that is going away before it has initialized, freeing its place if it was
+   * initializing. This is a no-op for clusters that are not queued or initializing.
+   */
+  void remove(Cluster& cluster);
+
+private:
+  struct Entry {
+    Cluster* cluster_;
+    std::function<void()> callback_;
+    MonotonicTime added_;
+  };
+
+  void startQueued();
+
+  const uint32_t max_initializing_;
+  TimeSource& time_source_;
+  Stats::Gauge& queued_;
+  Stats::Histogram& initialize_time_;
+  std::list<Entry> queue_;
+  std::unordered_set<Cluster*> initializing_;
+  bool starting_{};
+};
+
 /**
  * This is a helper class used during cluster management initialization. Dealing with primary
  * clusters, secondary clusters, and CDS, is quite complicated, so this makes it easier to test.
@@ -88,11 +144,14 @@ private:
 class ClusterManagerInitHelper : Logger::Loggable<Logger::Id::upstream> {
 public:
   /**
+   * @param initialize_queue supplies the queue that the clusters are initialized through.
    * @param per_cluster_init_callback supplies the callback to call when a cluster has itself
    *        initialized. The cluster manager can use this for post-init processing.
    */
-  ClusterManagerInitHelper(const std::function<void(Cluster&)>& per_cluster_init_callback)
-      : per_cluster_init_callback_(per_cluster_init_callback) {}
+  ClusterManagerInitHelper(ClusterInitializeQueue& initialize_queue,
+                           const std::function<void(Cluster&)>& per_cluster_init_callback)
+      : initialize_queue_(initialize_queue),
+        per_cluster_init_callback_(per_cluster_init_callback) {}
 
   enum class State {
     // Initial state. During this state all static clusters are loaded. Any phase 1 clusters
@@ -122,6 +181,7 @@ private:
   void maybeFinishInitialize();
   void onClusterInit(Cluster& cluster);
 
+  ClusterInitializeQueue& initialize_queue_;
   std::function<void(Cluster& cluster)> per_cluster_init_callback_;
   CdsApi* cds_{};
   std::function<void()> initialized_callback_;
@@ -135,7 +195,7 @@ private:
  * All cluster manager stats. @see stats_macros.h
  */
 // clang-format off
-#define ALL_CLUSTER_MANAGER_STATS(COUNTER, GAUGE)                                                  \
+#define ALL_CLUSTER_MANAGER_STATS(COUNTER, GAUGE, HISTOGRAM)                                       \
   COUNTER(cluster_added)                                                                           \
   COUNTER(cluster_modified)                                                                        \
   COUNTER(cluster_removed)                                                                         \
@@ -144,14 +204,17 @@ private:
   COUNTER(update_merge_cancelled)                                                                  \
   COUNTER(update_out_of_merge_window)                                                              \
   GAUGE  (active_clusters)                                                                         \
-  GAUGE  (warming_clusters)
+  GAUGE  (warming_clusters)                                                                        \
+  GAUGE  (queued_warming_clusters)                                                                 \
+  HISTOGRAM(cluster_warming_time_ms)
 // clang-format on
 
 /**
  * Struct definition for all cluster manager stats. @see stats_macros.h
  */
 struct ClusterManagerStats {
-  ALL_CLUSTER_MANAGER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+  ALL_CLUSTER_MANAGER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                            GENERATE_HISTOGRAM_STRUCT)
 };
 
 /**
@@ -203,6 +266,7 @@ public:
   const envoy::api::v2::core::BindConfig& bindConfig() const override { return bind_config_; }
 
   Config::GrpcMux& adsMux() override { return *ads_mux_; }
+  Config::DecodePool& xdsDecodePool() override { return xds_decode_pool_; }
   Grpc::AsyncClientManager& grpcAsyncClientManager() override { return *async_client_manager_; }
 
   const std::string& localClusterName() const override { return local_cluster_name_; }
@@ -219,6 +283,30 @@ protected:
                                             const HostVector& hosts_removed);
 
 private:
+  /**
+   * What a thread needs to create its thread local cluster: the cluster's info, the factory of its
+   * thread aware LB if any, and the hosts of each priority last posted to the threads. Snapshots
+   * are immutable and shared by all threads, and every membership update posts a new one, so that
+   * a thread only pays for the clusters it routes to.
+   */
+  struct ThreadLocalClusterSnapshot {
+    struct HostSet {
+      HostVectorConstSharedPtr hosts_;
+      HostVectorConstSharedPtr healthy_hosts_;
+      HostsPerLocalityConstSharedPtr hosts_per_locality_;
+      HostsPerLocalityConstSharedPtr healthy_hosts_per_locality_;
+      LocalityWeightsConstSharedPtr locality_weights_;
+    };
+
+    ClusterInfoConstSharedPtr info_;
+    LoadBalancerFactorySharedPtr lb_factory_;
+    // Indexed by priority. The hosts of the priorities that were never posted are null.
+    std::vector<HostSet> host_sets_;
+  };
+
+  typedef std::shared_ptr<const ThreadLocalClusterSnapshot>
+      ThreadLocalClusterSnapshotConstSharedPtr;
+
   /**
    * Thread local cached cluster data. Each thread local cluster gets updates from the parent
    * central dynamic cluster (if applicable). It maintains load balancer state and any created
@@ -302,26 +390,49 @@ private:
     void drainConnPools(const HostVector& hosts);
     void drainConnPools(HostSharedPtr old_host, ConnPoolsContainer& container);
     void drainTcpConnPools(HostSharedPtr old_host, TcpConnPoolsContainer& container);
+    /**
+     * @return the host whose connection pools serve requests to host. This is host itself, unless
+     *         its cluster shares connection pools and a host with the same address, of a cluster
+     *         with the same ClusterInfo::sharedConnPoolKey(), had pools first.
+     */
+    HostConstSharedPtr connPoolHost(const HostConstSharedPtr& host);
+    /**
+     * Like connPoolHost(), without making host the one with the shared pools if there is none.
+     */
+    HostConstSharedPtr findConnPoolHost(const HostConstSharedPtr& host) const;
+    void removeSharedConnPoolHost(const HostConstSharedPtr& host);
     void removeTcpConn(const HostConstSharedPtr& host, Network::ClientConnection& connection);
+    /**
+     * @return the thread local cluster named name, created from its snapshot on first use, or
+     *         nullptr if there is no such cluster.
+     */
+    ClusterEntry* getCluster(const std::string& name);
+    ClusterEntry& createCluster(const ThreadLocalClusterSnapshot& snapshot);
+    /**
+     * @return whether the thread local cluster of snapshot must be created as soon as the cluster
+     *         is added or updated rather than on first use.
+     */
+    bool createEagerly(const ThreadLocalClusterSnapshot& snapshot) const;
     static void updateClusterMembership(const std::string& name, uint32_t priority,
-                                        HostVectorConstSharedPtr hosts,
-                                        HostVectorConstSharedPtr healthy_hosts,
-                                        HostsPerLocalityConstSharedPtr hosts_per_locality,
-                                        HostsPerLocalityConstSharedPtr healthy_hosts_per_locality,
-                                        LocalityWeightsConstSharedPtr locality_weights,
+                                        ThreadLocalClusterSnapshotConstSharedPtr snapshot,
                                         const HostVector& hosts_added,
                                         const HostVector& hosts_removed, ThreadLocal::Slot& tls);
     static void onHostHealthFailure(const HostSharedPtr& host, ThreadLocal::Slot& tls);
 
     ClusterManagerImpl& parent_;
     Event::Dispatcher& thread_local_dispatcher_;
+    // The clusters used on this thread so far.
     std::unordered_map<std::string, ClusterEntryPtr> thread_local_clusters_;
+    // The latest snapshot of every cluster, used or not.
+    std::unordered_map<std::string, ThreadLocalClusterSnapshotConstSharedPtr> cluster_snapshots_;
 
     // These maps are owned by the ThreadLocalClusterManagerImpl instead of the ClusterEntry
     // to prevent lifetime/ownership issues when a cluster is dynamically removed.
     std::unordered_map<HostConstSharedPtr, ConnPoolsContainer> host_http_conn_pool_map_;
     std::unordered_map<HostConstSharedPtr, TcpConnPoolsContainer> host_tcp_conn_pool_map_;
     std::unordered_map<HostConstSharedPtr, TcpConnectionsMap> host_tcp_conn_map_;
+    // Hosts whose connection pools are shared, by address and shared connection pool key.
+    std::map<std::pair<std::string, uint64_t>, HostConstSharedPtr> shared_conn_pool_hosts_;
 
     std::list<Envoy::Upstream::ClusterUpdateCallbacks*> update_callbacks_;
     const PrioritySet* local_priority_set_{};
@@ -352,6 +463,8 @@ private:
     ClusterSharedPtr cluster_;
     // Optional thread aware LB depending on the LB type. Not all clusters have one.
     ThreadAwareLoadBalancerPtr thread_aware_lb_;
+    // The snapshot last posted to the threads.
+    ThreadLocalClusterSnapshotConstSharedPtr thread_local_snapshot_;
     SystemTime last_updated_;
   };
 
@@ -414,6 +527,8 @@ private:
   void postThreadLocalHealthFailure(const HostSharedPtr& host);
   void updateGauges();
 
+  // Declared first, so that it outlives the xDS subscriptions of the clusters.
+  Config::DecodePoolImpl xds_decode_pool_;
   ClusterManagerFactory& factory_;
   Runtime::Loader& runtime_;
   Stats::Store& stats_;
@@ -428,6 +543,8 @@ private:
   const LocalInfo::LocalInfo& local_info_;
   CdsApiPtr cds_api_;
   ClusterManagerStats cm_stats_;
+  TimeSource& time_source_;
+  ClusterInitializeQueue initialize_queue_;
   ClusterManagerInitHelper init_helper_;
   Config::GrpcMuxPtr ads_mux_;
   LoadStatsReporterPtr load_stats_reporter_;
@@ -435,7 +552,6 @@ private:
   std::string local_cluster_name_;
   Grpc::AsyncClientManagerPtr async_client_manager_;
   Server::ConfigTracker::EntryOwnerPtr config_tracker_entry_;
-  TimeSource& time_source_;
   ClusterUpdatesMap updates_map_;
   Event::Dispatcher& dispatcher_;
 };
@@ -1,5 +1,10 @@
+#pragma once
+
+#include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <queue>
+#include <vector>
 
 #include "common/common/assert.h"
 
@@ -98,6 +103,107 @@ private:
   std::priority_queue<EdfEntry> queue_;
 };
 
+/**
+ * A variant of EdfScheduler that schedules small copyable handles, e.g. indexes into a host vector,
+ * instead of weak references to shared entries. Entries are kept in a d-ary min heap in a single
+ * contiguous vector, so a pick touches no reference counts and the children of a node share a few
+ * cache lines. Since entries cannot expire, the owner must rebuild the schedule whenever a handle
+ * becomes invalid. Picks follow the same deadline and FIFO tie breaking order as EdfScheduler.
+ */
+template <class Handle, uint32_t Arity = 4> class FlatEdfScheduler {
+public:
+  /**
+   * Insert entry into the heap with a given weight. The deadline will be current_time_ + 1 /
+   * weight.
+   * @param weight floating point weight.
+   * @param handle supplies the handle to schedule.
+   */
+  void add(double weight, Handle handle) {
+    ASSERT(weight > 0);
+    heap_.push_back({current_time_ + 1.0 / weight, order_offset_++, handle});
+    siftUp(heap_.size() - 1);
+  }
+
+  /**
+   * Pick the entry with the earliest deadline and reinsert it with the weight returned by
+   * calculate_weight, which is equivalent to a pick() followed by an add() on EdfScheduler but
+   * only requires a single sift. The heap must not be empty.
+   * @param calculate_weight supplies a callable returning the new weight of the picked handle.
+   * @return Handle the picked handle.
+   */
+  template <class WeightCalculator> Handle pickAndAdd(WeightCalculator calculate_weight) {
+    ASSERT(!heap_.empty());
+    Entry& top = heap_[0];
+    ASSERT(top.deadline_ >= current_time_);
+    current_time_ = top.deadline_;
+    const double weight = calculate_weight(top.handle_);
+    ASSERT(weight > 0);
+    top.deadline_ = current_time_ + 1.0 / weight;
+    top.order_offset_ = order_offset_++;
+    const Handle handle = top.handle_;
+    siftDown(0);
+    return handle;
+  }
+
+  /**
+   * @return bool whether or not the heap is empty.
+   */
+  bool empty() const { return heap_.empty(); }
+
+private:
+  struct Entry {
+    double deadline_;
+    // Tie breaker for entries with the same deadline. This is used to provide FIFO behavior.
+    uint64_t order_offset_;
+    Handle handle_;
+  };
+
+  static bool before(const Entry& lhs, const Entry& rhs) {
+    return lhs.deadline_ < rhs.deadline_ ||
+           (lhs.deadline_ == rhs.deadline_ && lhs.order_offset_ < rhs.order_offset_);
+  }
+
+  void siftUp(size_t index) {
+    while (index > 0) {
+      const size_t parent = (index - 1) / Arity;
+      if (!before(heap_[index], heap_[parent])) {
+        return;
+      }
+      std::swap(heap_[index], heap_[parent]);
+      index = parent;
+    }
+  }
+
+  void siftDown(size_t index) {
+    while (true) {
+      const size_t first_child = index * Arity + 1;
+      if (first_child >= heap_.size()) {
+        return;
+      }
+      const size_t last_child = std::min(first_child + Arity, heap_.size());
+      size_t earliest = first_child;
+      for (size_t child = first_child + 1; child < last_child; ++child) {
+        if (before(heap_[child], heap_[earliest])) {
+          earliest = child;
+        }
+      }
+      if (!before(heap_[earliest], heap_[index])) {
+        return;
+      }
+      std::swap(heap_[index], heap_[earliest]);
+      index = earliest;
+    }
+  }
+
+  // Current time in the scheduler.
+  double current_time_{};
+  // Offset used during addition to break ties when entries have the same weight but should reflect
+  // FIFO insertion order in picks.
+  uint64_t order_offset_{};
+  // Min heap for EDF, with the children of heap_[i] at heap_[i * Arity + 1] onwards.
+  std::vector<Entry> heap_;
+};
+
 #undef EDF_DEBUG
 
 } // namespace Upstream
@@ -28,11 +28,16 @@ EdsClusterImpl::EdsClusterImpl(
       cm_(factory_context.clusterManager()), local_info_(factory_context.localInfo()),
       cluster_name_(cluster.eds_cluster_config().service_name().empty()
                         ? cluster.name()
-                        : cluster.eds_cluster_config().service_name()) {
+                        : cluster.eds_cluster_config().service_name()),
+      update_coalesce_window_(
+          PROTOBUF_GET_MS_OR_DEFAULT(cluster.eds_cluster_config(), update_coalesce_window, 0)) {
   Config::Utility::checkLocalInfo("eds", local_info_);
 
   const auto& eds_config = cluster.eds_cluster_config().eds_config();
   Event::Dispatcher& dispatcher = factory_context.dispatcher();
+  if (update_coalesce_window_.count() > 0) {
+    coalesce_timer_ = dispatcher.createTimer([this]() -> void { onCoalesceWindowEnd(); });
+  }
   Runtime::RandomGenerator& random = factory_context.random();
   Upstream::ClusterManager& cm = factory_context.clusterManager();
   subscription_ = Config::SubscriptionFactory::subscriptionFromConfigSource<
@@ -59,6 +64,30 @@ void EdsClusterImpl::onConfigUpdate(const ResourceVector& resources, const std::
     throw EnvoyException(fmt::format("Unexpected EDS resource length: {}", resources.size()));
   }
   const auto& cluster_load_assignment = resources[0];
+
+  if (coalesce_timer_enabled_) {
+    // An update was applied within the coalescing window. Hold this one until the window ends,
+    // replacing any update already held. Reject invalid config now, while it can still be
+    // reported back to the management server.
+    validateClusterLoadAssignment(cluster_load_assignment, true);
+    if (pending_update_ != nullptr) {
+      info_->stats().update_coalesced_.inc();
+    }
+    pending_update_ =
+        std::make_unique<envoy::api::v2::ClusterLoadAssignment>(cluster_load_assignment);
+    return;
+  }
+
+  validateClusterLoadAssignment(cluster_load_assignment, false);
+  applyClusterLoadAssignment(cluster_load_assignment);
+  if (coalesce_timer_ != nullptr) {
+    coalesce_timer_->enableTimer(update_coalesce_window_);
+    coalesce_timer_enabled_ = true;
+  }
+}
+
+void EdsClusterImpl::validateClusterLoadAssignment(
+    const envoy::api::v2::ClusterLoadAssignment& cluster_load_assignment, bool resolve_addresses) {
   MessageUtil::validate(cluster_load_assignment);
   // TODO(PiotrSikora): Remove this hack once fixed internally.
   if (!(cluster_load_assignment.cluster_name() == cluster_name_)) {
@@ -66,15 +95,27 @@ void EdsClusterImpl::onConfigUpdate(const ResourceVector& resources, const std::
                                      cluster_load_assignment.cluster_name()));
   }
 
-  std::unordered_map<std::string, HostSharedPtr> updated_hosts;
-  PriorityStateManager priority_state_manager(*this, local_info_);
   for (const auto& locality_lb_endpoint : cluster_load_assignment.endpoints()) {
-    const uint32_t priority = locality_lb_endpoint.priority();
-
-    if (priority > 0 && !cluster_name_.empty() && cluster_name_ == cm_.localClusterName()) {
+    if (locality_lb_endpoint.priority() > 0 && !cluster_name_.empty() &&
+        cluster_name_ == cm_.localClusterName()) {
       throw EnvoyException(
           fmt::format("Unexpected non-zero priority for local cluster '{}'.", cluster_name_));
     }
+
+    // Addresses are otherwise resolved when the update is applied.
+    if (resolve_addresses) {
+      for (const auto& lb_endpoint : locality_lb_endpoint.lb_endpoints()) {
+        resolveProtoAddress(lb_endpoint.endpoint().address());
+      }
+    }
+  }
+}
+
+void EdsClusterImpl::applyClusterLoadAssignment(
+    const envoy::api::v2::ClusterLoadAssignment& cluster_load_assignment) {
+  std::unordered_map<std::string, HostSharedPtr> updated_hosts;
+  PriorityStateManager priority_state_manager(*this, local_info_);
+  for (const auto& locality_lb_endpoint : cluster_load_assignment.endpoints()) {
     priority_state_manager.initializePriorityFor(locality_lb_endpoint);
 
     for (const auto& lb_endpoint : locality_lb_endpoint.lb_endpoints()) {
@@ -129,6 +170,20 @@ void EdsClusterImpl::onConfigUpdate(const ResourceVector& resources, const std::
   onPreInitComplete();
 }
 
+void EdsClusterImpl::onCoalesceWindowEnd() {
+  coalesce_timer_enabled_ = false;
+  if (pending_update_ == nullptr) {
+    return;
+  }
+
+  // Apply the latest held update and start a new window, so that updates keep being applied at
+  // most once per window for as long as they keep arriving.
+  std::unique_ptr<envoy::api::v2::ClusterLoadAssignment> update = std::move(pending_update_);
+  applyClusterLoadAssignment(*update);
+  coalesce_timer_->enableTimer(update_coalesce_window_);
+  coalesce_timer_enabled_ = true;
+}
+
 bool EdsClusterImpl::updateHostsPerLocality(
     const uint32_t priority, const uint32_t overprovisioning_factor, const HostVector& new_hosts,
     LocalityWeightsMap& locality_weights_map, LocalityWeightsMap& new_locality_weights_map,
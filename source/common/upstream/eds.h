@@ -3,6 +3,7 @@
 #include "envoy/api/v2/core/base.pb.h"
 #include "envoy/api/v2/eds.pb.h"
 #include "envoy/config/subscription.h"
+#include "envoy/event/timer.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/secret/secret_manager.h"
 #include "envoy/stats/scope.h"
@@ -28,6 +29,13 @@ public:
 
   // Config::SubscriptionCallbacks
   void onConfigUpdate(const ResourceVector& resources, const std::string& version_info) override;
+  void onIncrementalConfigUpdate(const ResourceVector& added_resources,
+                                 const Protobuf::RepeatedPtrField<ProtobufTypes::String>&,
+                                 const std::string& system_version_info) override {
+    // Only this cluster is subscribed to, so the update is its whole assignment, or its removal
+    // when there is none, which is handled as missing from a state of the world update.
+    onConfigUpdate(added_resources, system_version_info);
+  }
   void onConfigUpdateFailed(const EnvoyException* e) override;
   std::string resourceName(const ProtobufWkt::Any& resource) override {
     return MessageUtil::anyConvert<envoy::api::v2::ClusterLoadAssignment>(resource).cluster_name();
@@ -36,6 +44,12 @@ public:
 private:
   using LocalityWeightsMap =
       std::unordered_map<envoy::api::v2::core::Locality, uint32_t, LocalityHash, LocalityEqualTo>;
+  void validateClusterLoadAssignment(
+      const envoy::api::v2::ClusterLoadAssignment& cluster_load_assignment,
+      bool resolve_addresses);
+  void applyClusterLoadAssignment(
+      const envoy::api::v2::ClusterLoadAssignment& cluster_load_assignment);
+  void onCoalesceWindowEnd();
   bool updateHostsPerLocality(const uint32_t priority, const uint32_t overprovisioning_factor,
                               const HostVector& new_hosts, LocalityWeightsMap& locality_weights_map,
                               LocalityWeightsMap& new_locality_weights_map,
@@ -50,6 +64,13 @@ private:
   const LocalInfo::LocalInfo& local_info_;
   const std::string cluster_name_;
   std::vector<LocalityWeightsMap> locality_weights_map_;
+
+  // Update coalescing. While the timer is enabled, updates are held in pending_update_ and only
+  // the latest one is applied once the window ends.
+  const std::chrono::milliseconds update_coalesce_window_;
+  Event::TimerPtr coalesce_timer_;
+  bool coalesce_timer_enabled_{};
+  std::unique_ptr<envoy::api::v2::ClusterLoadAssignment> pending_update_;
 };
 
 } // namespace Upstream
@@ -24,6 +24,7 @@ HealthCheckerImplBase::HealthCheckerImplBase(const Cluster& cluster,
       no_traffic_interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, no_traffic_interval, 60000)),
       interval_jitter_(PROTOBUF_GET_MS_OR_DEFAULT(config, interval_jitter, 0)),
       interval_jitter_percent_(config.interval_jitter_percent()),
+      initial_jitter_(PROTOBUF_GET_MS_OR_DEFAULT(config, initial_jitter, 0)),
       unhealthy_interval_(
           PROTOBUF_GET_MS_OR_DEFAULT(config, unhealthy_interval, interval_.count())),
       unhealthy_edge_interval_(
@@ -183,8 +184,11 @@ void HealthCheckerImplBase::start() {
 HealthCheckerImplBase::ActiveHealthCheckSession::ActiveHealthCheckSession(
     HealthCheckerImplBase& parent, HostSharedPtr host)
     : host_(host), parent_(parent),
-      interval_timer_(parent.dispatcher_.createTimer([this]() -> void { onIntervalBase(); })),
-      timeout_timer_(parent.dispatcher_.createTimer([this]() -> void { onTimeoutBase(); })) {
+      // Large clusters have a pair of these per host on every worker, and health check intervals
+      // and timeouts don't need better than millisecond precision.
+      interval_timer_(
+          parent.dispatcher_.createCoarseTimer([this]() -> void { onIntervalBase(); })),
+      timeout_timer_(parent.dispatcher_.createCoarseTimer([this]() -> void { onTimeoutBase(); })) {
 
   if (!host->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)) {
     parent.incHealthy();
@@ -265,6 +269,15 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::handleFailure(
   interval_timer_->enableTimer(parent_.interval(HealthState::Unhealthy, changed_state));
 }
 
+void HealthCheckerImplBase::ActiveHealthCheckSession::onInitialInterval() {
+  if (parent_.initial_jitter_.count() == 0) {
+    onIntervalBase();
+  } else {
+    interval_timer_->enableTimer(
+        std::chrono::milliseconds(parent_.random_.random() % parent_.initial_jitter_.count()));
+  }
+}
+
 void HealthCheckerImplBase::ActiveHealthCheckSession::onIntervalBase() {
   onInterval();
   timeout_timer_->enableTimer(parent_.timeout_);
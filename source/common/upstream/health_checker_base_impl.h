@@ -49,7 +49,7 @@ protected:
   public:
     virtual ~ActiveHealthCheckSession();
     HealthTransition setUnhealthy(envoy::data::core::v2alpha::HealthCheckFailureType type);
-    void start() { onIntervalBase(); }
+    void start() { onInitialInterval(); }
 
   protected:
     ActiveHealthCheckSession(HealthCheckerImplBase& parent, HostSharedPtr host);
@@ -61,6 +61,7 @@ protected:
 
   private:
     virtual void onInterval() PURE;
+    void onInitialInterval();
     void onIntervalBase();
     virtual void onTimeout() PURE;
     void onTimeoutBase();
@@ -123,6 +124,7 @@ private:
   const std::chrono::milliseconds no_traffic_interval_;
   const std::chrono::milliseconds interval_jitter_;
   const uint32_t interval_jitter_percent_;
+  const std::chrono::milliseconds initial_jitter_;
   const std::chrono::milliseconds unhealthy_interval_;
   const std::chrono::milliseconds unhealthy_edge_interval_;
   const std::chrono::milliseconds healthy_edge_interval_;
@@ -58,6 +58,9 @@ void HdsDelegate::establishNewStream() {
 
   ENVOY_LOG(debug, "Sending HealthCheckRequest {} ", health_check_request_.DebugString());
   stream_->sendMessage(health_check_request_, false);
+  // The management server may have lost the health reported on a previous stream.
+  full_report_sent_ = false;
+  reported_health_.clear();
   stats_.responses_.inc();
   backoff_strategy_->reset();
 }
@@ -67,37 +70,105 @@ void HdsDelegate::handleFailure() {
   setHdsRetryTimer();
 }
 
-// TODO(lilika): Add support for the same endpoint in different clusters/ports
+// TODO(lilika): Add support for more granular options of envoy::api::v2::core::HealthStatus
+envoy::api::v2::core::HealthStatus HdsDelegate::healthStatus(const Host& host) {
+  if (host.healthy()) {
+    return envoy::api::v2::core::HealthStatus::HEALTHY;
+  }
+  switch (host.getActiveHealthFailureType()) {
+  case Host::ActiveHealthFailureType::TIMEOUT:
+    return envoy::api::v2::core::HealthStatus::TIMEOUT;
+  case Host::ActiveHealthFailureType::UNHEALTHY:
+  case Host::ActiveHealthFailureType::UNKNOWN:
+    return envoy::api::v2::core::HealthStatus::UNHEALTHY;
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+bool HdsDelegate::shouldReport(const std::string& cluster_name, const std::string& address,
+                               envoy::api::v2::core::HealthStatus health_status) {
+  if (!report_changes_only_) {
+    return true;
+  }
+  auto result = reported_health_.emplace(cluster_name + "/" + address, health_status);
+  if (result.second) {
+    return true;
+  }
+  if (result.first->second == health_status) {
+    return false;
+  }
+  result.first->second = health_status;
+  return true;
+}
+
+void HdsDelegate::addSharedEndpointsHealth(
+    envoy::service::discovery::v2::EndpointHealthResponse& response) {
+  if (shared_endpoints_.empty()) {
+    return;
+  }
+  const ClusterManager::ClusterInfoMap clusters = cm_.clusters();
+  for (const auto& cluster_endpoints : shared_endpoints_) {
+    std::unordered_set<std::string> found;
+    auto cluster = clusters.find(cluster_endpoints.first);
+    if (cluster != clusters.end()) {
+      for (const auto& hosts : cluster->second.get().prioritySet().hostSetsPerPriority()) {
+        for (const auto& host : hosts->hosts()) {
+          const std::string& address = host->address()->asString();
+          auto endpoint = cluster_endpoints.second.find(address);
+          if (endpoint == cluster_endpoints.second.end() || !found.insert(address).second) {
+            continue;
+          }
+          const envoy::api::v2::core::HealthStatus health_status = healthStatus(*host);
+          if (shouldReport(cluster_endpoints.first, address, health_status)) {
+            auto* endpoint_health = response.add_endpoints_health();
+            endpoint_health->mutable_endpoint()->mutable_address()->MergeFrom(endpoint->second);
+            endpoint_health->set_health_status(health_status);
+          }
+        }
+      }
+    }
+    // The endpoints that are no longer hosts of the cluster are not checked by anyone.
+    for (const auto& endpoint : cluster_endpoints.second) {
+      if (found.count(endpoint.first) == 0 &&
+          shouldReport(cluster_endpoints.first, endpoint.first,
+                       envoy::api::v2::core::HealthStatus::UNKNOWN)) {
+        auto* endpoint_health = response.add_endpoints_health();
+        endpoint_health->mutable_endpoint()->mutable_address()->MergeFrom(endpoint.second);
+        endpoint_health->set_health_status(envoy::api::v2::core::HealthStatus::UNKNOWN);
+      }
+    }
+  }
+}
+
+// TODO(lilika): Add support for the same endpoint in different ports
 envoy::service::discovery::v2::HealthCheckRequestOrEndpointHealthResponse
 HdsDelegate::sendResponse() {
   envoy::service::discovery::v2::HealthCheckRequestOrEndpointHealthResponse response;
+  envoy::service::discovery::v2::EndpointHealthResponse& health_response =
+      *response.mutable_endpoint_health_response();
   for (const auto& cluster : hds_clusters_) {
     for (const auto& hosts : cluster->prioritySet().hostSetsPerPriority()) {
       for (const auto& host : hosts->hosts()) {
-        auto* endpoint = response.mutable_endpoint_health_response()->add_endpoints_health();
+        const envoy::api::v2::core::HealthStatus health_status = healthStatus(*host);
+        if (!shouldReport(cluster->info()->name(), host->address()->asString(), health_status)) {
+          continue;
+        }
+        auto* endpoint = health_response.add_endpoints_health();
         Network::Utility::addressToProtobufAddress(
             *host->address(), *endpoint->mutable_endpoint()->mutable_address());
-        // TODO(lilika): Add support for more granular options of envoy::api::v2::core::HealthStatus
-        if (host->healthy()) {
-          endpoint->set_health_status(envoy::api::v2::core::HealthStatus::HEALTHY);
-        } else {
-          if (host->getActiveHealthFailureType() == Host::ActiveHealthFailureType::TIMEOUT) {
-            endpoint->set_health_status(envoy::api::v2::core::HealthStatus::TIMEOUT);
-          } else if (host->getActiveHealthFailureType() ==
-                     Host::ActiveHealthFailureType::UNHEALTHY) {
-            endpoint->set_health_status(envoy::api::v2::core::HealthStatus::UNHEALTHY);
-          } else if (host->getActiveHealthFailureType() == Host::ActiveHealthFailureType::UNKNOWN) {
-            endpoint->set_health_status(envoy::api::v2::core::HealthStatus::UNHEALTHY);
-          } else {
-            NOT_REACHED_GCOVR_EXCL_LINE;
-          }
-        }
+        endpoint->set_health_status(health_status);
       }
     }
   }
-  ENVOY_LOG(debug, "Sending EndpointHealthResponse to server {}", response.DebugString());
-  stream_->sendMessage(response, false);
-  stats_.responses_.inc();
+  addSharedEndpointsHealth(health_response);
+
+  // With only changes reported, the intervals without any change are skipped.
+  if (!report_changes_only_ || !full_report_sent_ || health_response.endpoints_health_size() > 0) {
+    ENVOY_LOG(debug, "Sending EndpointHealthResponse to server {}", response.DebugString());
+    stream_->sendMessage(response, false);
+    stats_.responses_.inc();
+    full_report_sent_ = true;
+  }
   setHdsStreamResponseTimer();
   return response;
 }
@@ -115,7 +186,26 @@ void HdsDelegate::processMessage(
   ENVOY_LOG(debug, "New health check response message {} ", message->DebugString());
   ASSERT(message);
 
+  report_changes_only_ = message->report_changes_only();
+  full_report_sent_ = false;
+  reported_health_.clear();
+  shared_endpoints_.clear();
+  const ClusterManager::ClusterInfoMap clusters =
+      message->share_cluster_health_checks() ? cm_.clusters() : ClusterManager::ClusterInfoMap();
+
   for (const auto& cluster_health_check : message->cluster_health_checks()) {
+    // The endpoints that are hosts of the health checked cluster of the same name are already
+    // checked by its health checkers.
+    std::unordered_set<std::string> cluster_addresses;
+    auto cluster = clusters.find(cluster_health_check.cluster_name());
+    if (cluster != clusters.end() && cluster->second.get().healthChecker() != nullptr) {
+      for (const auto& hosts : cluster->second.get().prioritySet().hostSetsPerPriority()) {
+        for (const auto& host : hosts->hosts()) {
+          cluster_addresses.insert(host->address()->asString());
+        }
+      }
+    }
+
     // Create HdsCluster config
     static const envoy::api::v2::core::BindConfig bind_config;
     envoy::api::v2::Cluster cluster_config;
@@ -126,11 +216,27 @@ void HdsDelegate::processMessage(
         ClusterConnectionBufferLimitBytes);
 
     // Add endpoints to cluster
+    bool shared = false;
     for (const auto& locality_endpoints : cluster_health_check.locality_endpoints()) {
       for (const auto& endpoint : locality_endpoints.endpoints()) {
+        if (!cluster_addresses.empty()) {
+          const std::string address =
+              Network::Address::resolveProtoAddress(endpoint.address())->asString();
+          if (cluster_addresses.count(address) > 0) {
+            shared_endpoints_[cluster_health_check.cluster_name()].emplace(address,
+                                                                           endpoint.address());
+            shared = true;
+            continue;
+          }
+        }
         cluster_config.add_hosts()->MergeFrom(endpoint.address());
       }
     }
+    if (shared && cluster_config.hosts().empty()) {
+      ENVOY_LOG(debug, "All endpoints of HdsCluster {} are shared with its cluster",
+                cluster_health_check.cluster_name());
+      continue;
+    }
 
     // TODO(lilika): Add support for optional per-endpoint health checks
 
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "envoy/event/dispatcher.h"
 #include "envoy/server/transport_socket_config.h"
 #include "envoy/service/discovery/v2/hds.pb.h"
@@ -55,6 +59,7 @@ public:
   const PrioritySet& prioritySet() const override { return priority_set_; }
   void setOutlierDetector(const Outlier::DetectorSharedPtr& outlier_detector);
   HealthChecker* healthChecker() override { return health_checker_.get(); }
+  const HealthChecker* healthChecker() const override { return health_checker_.get(); }
   ClusterInfoConstSharedPtr info() const override { return info_; }
   Outlier::Detector* outlierDetector() override { return outlier_detector_.get(); }
   const Outlier::Detector* outlierDetector() const override { return outlier_detector_.get(); }
@@ -147,6 +152,12 @@ private:
   void establishNewStream();
   void
   processMessage(std::unique_ptr<envoy::service::discovery::v2::HealthCheckSpecifier>&& message);
+  // Whether the health of an endpoint is to be reported, i.e. whether it changed since the last
+  // report if only changes are reported.
+  bool shouldReport(const std::string& cluster_name, const std::string& address,
+                    envoy::api::v2::core::HealthStatus health_status);
+  void addSharedEndpointsHealth(envoy::service::discovery::v2::EndpointHealthResponse& response);
+  static envoy::api::v2::core::HealthStatus healthStatus(const Host& host);
 
   HdsDelegateStats stats_;
   const Protobuf::MethodDescriptor& service_method_;
@@ -169,6 +180,19 @@ private:
   std::vector<std::string> clusters_;
   std::vector<HdsClusterPtr> hds_clusters_;
 
+  // The endpoints that are hosts of the health checked cluster of the same name, which are
+  // reported with the cluster's health status rather than checked again. By cluster name, then by
+  // address.
+  std::unordered_map<std::string, std::unordered_map<std::string, envoy::api::v2::core::Address>>
+      shared_endpoints_;
+
+  // Whether reports only hold the endpoints whose health status changed since the last report.
+  bool report_changes_only_{};
+  // Whether a full report was sent for the current HealthCheckSpecifier on the current stream.
+  bool full_report_sent_{};
+  // The last reported health status of the endpoints, by cluster name and address.
+  std::unordered_map<std::string, envoy::api::v2::core::HealthStatus> reported_health_;
+
   Event::TimerPtr hds_stream_response_timer_;
   Event::TimerPtr hds_retry_timer_;
   BackOffStrategyPtr backoff_strategy_;
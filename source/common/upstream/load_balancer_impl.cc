@@ -9,14 +9,18 @@
 
 #include "common/common/assert.h"
 #include "common/protobuf/utility.h"
+#include "common/runtime/key_registry.h"
 
 namespace Envoy {
 namespace Upstream {
 
 namespace {
-static const std::string RuntimeZoneEnabled = "upstream.zone_routing.enabled";
-static const std::string RuntimeMinClusterSize = "upstream.zone_routing.min_cluster_size";
-static const std::string RuntimePanicThreshold = "upstream.healthy_panic_threshold";
+static const Runtime::Key RuntimeZoneEnabled =
+    Runtime::KeyRegistry::intern("upstream.zone_routing.enabled");
+static const Runtime::Key RuntimeMinClusterSize =
+    Runtime::KeyRegistry::intern("upstream.zone_routing.min_cluster_size");
+static const Runtime::Key RuntimePanicThreshold =
+    Runtime::KeyRegistry::intern("upstream.healthy_panic_threshold");
 } // namespace
 
 uint32_t LoadBalancerBase::choosePriority(uint64_t hash,
@@ -206,32 +210,26 @@ void ZoneAwareLoadBalancerBase::regenerateLocalityRoutingStructures() {
   // locality we should route. Percentage of requests routed cross locality to a specific locality
   // needed be proportional to the residual capacity upstream locality has.
   //
-  // residual_capacity contains capacity left in a given locality, we keep accumulating residual
-  // capacity to make search for sampled value easier.
   // For example, if we have the following upstream and local percentage:
   // local_percentage: 40000 40000 20000
   // upstream_percentage: 25000 50000 25000
-  // Residual capacity would look like: 0 10000 5000. Now we need to sample proportionally to
-  // bucket sizes (residual capacity). For simplicity of finding where specific
-  // sampled value is, we accumulate values in residual capacity. This is what it will look like:
-  // residual_capacity: 0 10000 15000
-  // Now to find a locality to route (bucket) we could simply iterate over residual_capacity
-  // searching where sampled value is placed.
-  state.residual_capacity_.resize(num_localities);
-
-  // Local locality (index 0) does not have residual capacity as we have routed all we could.
-  state.residual_capacity_[0] = 0;
+  // Residual capacity would look like: 0 10000 5000. We sample proportionally to the residual
+  // capacity with an alias table, so that each cross locality pick is O(1) regardless of the
+  // number of localities, and the local locality (index 0) with no residual capacity is never
+  // picked.
+  std::vector<double> residual_capacity(num_localities);
+  bool has_residual_capacity = false;
   for (size_t i = 1; i < num_localities; ++i) {
     // Only route to the localities that have additional capacity.
     if (upstream_percentage[i] > local_percentage[i]) {
-      state.residual_capacity_[i] =
-          state.residual_capacity_[i - 1] + upstream_percentage[i] - local_percentage[i];
-    } else {
-      // Locality with index "i" does not have residual capacity, but we keep accumulating previous
-      // values to make search easier on the next step.
-      state.residual_capacity_[i] = state.residual_capacity_[i - 1];
+      residual_capacity[i] = upstream_percentage[i] - local_percentage[i];
+      has_residual_capacity = true;
     }
   }
+  // Without any residual capacity, which rounding errors make possible, there is no table and
+  // picks fall back to a random locality.
+  state.residual_capacity_ =
+      has_residual_capacity ? std::make_unique<AliasTable>(residual_capacity) : nullptr;
 }
 
 void ZoneAwareLoadBalancerBase::resizePerPriorityState() {
@@ -350,25 +348,14 @@ uint32_t ZoneAwareLoadBalancerBase::tryChooseLocalLocalityHosts(const HostSet& h
 
   // This is *extremely* unlikely but possible due to rounding errors when calculating
   // locality percentages. In this case just select random locality.
-  if (state.residual_capacity_[number_of_localities - 1] == 0) {
+  if (state.residual_capacity_ == nullptr) {
     stats_.lb_zone_no_capacity_left_.inc();
     return random_.random() % number_of_localities;
   }
 
   // Random sampling to select specific locality for cross locality traffic based on the additional
   // capacity in localities.
-  uint64_t threshold = random_.random() % state.residual_capacity_[number_of_localities - 1];
-
-  // This potentially can be optimized to be O(log(N)) where N is the number of localities.
-  // Linear scan should be faster for smaller N, in most of the scenarios N will be small.
-  // TODO(htuch): is there a bug here when threshold == 0? Seems like we pick
-  // local locality in that situation. Probably should start iterating at 1.
-  int i = 0;
-  while (threshold > state.residual_capacity_[i]) {
-    i++;
-  }
-
-  return i;
+  return state.residual_capacity_->pick(random_.random());
 }
 
 ZoneAwareLoadBalancerBase::HostsSource
@@ -466,21 +453,21 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
     // weighted 1. This is because currently we don't refresh host sets if only weights change.
     // We should probably change this to refresh at all times. See the comment in
     // BaseDynamicClusterImpl::updateDynamicHostList about this.
-    for (const auto& host : hosts) {
+    for (uint32_t i = 0; i < hosts.size(); ++i) {
       // We use a fixed weight here. While the weight may change without
       // notification, this will only be stale until this host is next picked,
       // at which point it is reinserted into the EdfScheduler with its new
       // weight in chooseHost().
-      scheduler.edf_.add(hostWeight(*host), host);
+      scheduler.edf_.add(hostWeight(*hosts[i]), i);
     }
 
     // Cycle through hosts to achieve the intended offset behavior.
     // TODO(htuch): Consider how we can avoid biasing towards earlier hosts in the schedule across
     // refreshes for the weighted case.
     if (!hosts.empty()) {
+      const auto weight = [this, &hosts](uint32_t index) { return hostWeight(*hosts[index]); };
       for (uint32_t i = 0; i < seed_ % hosts.size(); ++i) {
-        auto host = scheduler.edf_.pick();
-        scheduler.edf_.add(hostWeight(*host), host);
+        scheduler.edf_.pickAndAdd(weight);
       }
     }
   };
@@ -513,14 +500,16 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* cont
   // host set if any weights change. Additionally, it has the property that if all weights are
   // the same but not 1 (like 42), we will use the EDF schedule not the unweighted pick. This is
   // not optimal. If this is fixed, remove the note in the arch overview docs for the LR LB.
+  const HostVector& hosts_to_use = hostSourceToHosts(hosts_source);
   if (stats_.max_host_weight_.value() != 1) {
-    auto host = scheduler.edf_.pick();
-    if (host != nullptr) {
-      scheduler.edf_.add(hostWeight(*host), host);
+    if (scheduler.edf_.empty()) {
+      return nullptr;
     }
-    return host;
+    const uint32_t index = scheduler.edf_.pickAndAdd(
+        [this, &hosts_to_use](uint32_t i) { return hostWeight(*hosts_to_use[i]); });
+    ASSERT(index < hosts_to_use.size());
+    return hosts_to_use[index];
   } else {
-    const HostVector& hosts_to_use = hostSourceToHosts(hosts_source);
     if (hosts_to_use.size() == 0) {
       return nullptr;
     }
@@ -528,16 +517,63 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* cont
   }
 }
 
+HostConstSharedPtr LeastRequestLoadBalancer::chooseHostOnce(LoadBalancerContext* context) {
+  if (!weighted_sampling_ || stats_.max_host_weight_.value() == 1) {
+    return EdfLoadBalancerBase::chooseHostOnce(context);
+  }
+
+  const HostsSource hosts_source = hostSourceToUse(context);
+  const auto alias_table_it = alias_tables_.find(hosts_source);
+  if (alias_table_it == alias_tables_.end()) {
+    return nullptr;
+  }
+  const HostVector& hosts_to_use = hostSourceToHosts(hosts_source);
+  ASSERT(alias_table_it->second.size() == hosts_to_use.size());
+
+  // Weighted P2C: sample the candidates in proportion to their weight, then pick the one with the
+  // fewest active requests.
+  const HostSharedPtr* candidate = nullptr;
+  for (uint32_t i = 0; i < choice_count_; ++i) {
+    const HostSharedPtr& sampled = hosts_to_use[alias_table_it->second.pick(random_.random())];
+    if (candidate == nullptr ||
+        sampled->stats().rq_active_.value() <= (*candidate)->stats().rq_active_.value()) {
+      candidate = &sampled;
+    }
+  }
+  return *candidate;
+}
+
+void LeastRequestLoadBalancer::refreshHostSource(const HostsSource& source) {
+  if (!weighted_sampling_) {
+    return;
+  }
+
+  alias_tables_.erase(source);
+  const HostVector& hosts = hostSourceToHosts(source);
+  if (hosts.empty()) {
+    return;
+  }
+  std::vector<double> weights;
+  weights.reserve(hosts.size());
+  for (const auto& host : hosts) {
+    weights.push_back(host->weight());
+  }
+  alias_tables_.emplace(source, AliasTable(weights));
+}
+
 HostConstSharedPtr LeastRequestLoadBalancer::unweightedHostPick(const HostVector& hosts_to_use,
                                                                 const HostsSource&) {
-  // This is just basic unweighted P2C.
-  const HostSharedPtr host1 = hosts_to_use[random_.random() % hosts_to_use.size()];
-  const HostSharedPtr host2 = hosts_to_use[random_.random() % hosts_to_use.size()];
-  if (host1->stats().rq_active_.value() < host2->stats().rq_active_.value()) {
-    return host1;
-  } else {
-    return host2;
+  // This is just basic unweighted P2C, generalized to choice_count_ candidates. Ties go to the
+  // later candidate.
+  const HostSharedPtr* candidate = nullptr;
+  for (uint32_t i = 0; i < choice_count_; ++i) {
+    const HostSharedPtr& sampled = hosts_to_use[random_.random() % hosts_to_use.size()];
+    if (candidate == nullptr ||
+        sampled->stats().rq_active_.value() <= (*candidate)->stats().rq_active_.value()) {
+      candidate = &sampled;
+    }
   }
+  return *candidate;
 }
 
 HostConstSharedPtr RandomLoadBalancer::chooseHostOnce(LoadBalancerContext* context) {
@@ -10,6 +10,8 @@
 #include "envoy/upstream/load_balancer.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/protobuf/utility.h"
+#include "common/upstream/alias_table.h"
 #include "common/upstream/edf_scheduler.h"
 
 namespace Envoy {
@@ -227,10 +229,10 @@ private:
     uint64_t local_percent_to_route_{};
     // Tracks the current state of locality based routing.
     LocalityRoutingState locality_routing_state_{LocalityRoutingState::NoLocalityRouting};
-    // When locality_routing_state_ == LocalityResidual this tracks the capacity
-    // for each of the non-local localities to determine what traffic should be
-    // routed where.
-    std::vector<uint64_t> residual_capacity_;
+    // When locality_routing_state_ == LocalityResidual this samples the non-local localities in
+    // proportion to their residual capacity, to determine what traffic should be routed where.
+    // nullptr if none of them has residual capacity.
+    std::unique_ptr<AliasTable> residual_capacity_;
   };
   typedef std::unique_ptr<PerPriorityState> PerPriorityStatePtr;
   // Routing state broken out for each priority level in priority_set_.
@@ -240,12 +242,14 @@ private:
 
 /**
  * Base implementation of LoadBalancer that performs weighted RR selection across the hosts in the
- * cluster. This scheduler respects host weighting and utilizes an EdfScheduler to achieve O(log
- * n) pick and insertion time complexity, O(n) memory use. The key insight is that if we schedule
- * with 1 / weight deadline, we will achieve the desired pick frequency for weighted RR in a given
- * interval. Naive implementations of weighted RR are either O(n) pick time or O(m * n) memory use,
- * where m is the weight range. We also explicitly check for the unweighted special case and use a
- * simple index to acheive O(1) scheduling in that case.
+ * cluster. This scheduler respects host weighting and utilizes a FlatEdfScheduler to achieve
+ * O(log n) pick and insertion time complexity, O(n) memory use. The schedule holds indexes into
+ * the host vector of its HostsSource, which is rebuilt on every membership change, so picks do not
+ * touch host reference counts until the chosen host is returned. The key insight is that if we
+ * schedule with 1 / weight deadline, we will achieve the desired pick frequency for weighted RR in
+ * a given interval. Naive implementations of weighted RR are either O(n) pick time or O(m * n)
+ * memory use, where m is the weight range. We also explicitly check for the unweighted special case
+ * and use a simple index to acheive O(1) scheduling in that case.
  * TODO(htuch): We use EDF at Google, but the EDF scheduler may be overkill if we don't want to
  * support large ranges of weights or arbitrary precision floating weights, we could construct an
  * explicit schedule, since m will be a small constant factor in O(m * n). This
@@ -267,8 +271,8 @@ public:
 
 protected:
   struct Scheduler {
-    // EdfScheduler for weighted LB.
-    EdfScheduler<const Host> edf_;
+    // EdfScheduler for weighted LB, scheduling indexes into the HostsSource's host vector.
+    FlatEdfScheduler<uint32_t> edf_;
   };
 
   void initialize();
@@ -329,33 +333,43 @@ private:
 /**
  * Weighted Least Request load balancer.
  *
- * In a normal setup when all hosts have the same weight of 1 it randomly picks up two healthy hosts
- * and compares number of active requests. Technique is based on
- * http://www.eecs.harvard.edu/~michaelm/postscripts/mythesis.pdf and is known as P2C (power of
- * two choices).
+ * In a normal setup when all hosts have the same weight of 1 it randomly picks up N healthy hosts
+ * (as configured by choice_count, 2 by default) and picks the one with the fewest active requests.
+ * Technique is based on http://www.eecs.harvard.edu/~michaelm/postscripts/mythesis.pdf and is
+ * known as P2C (power of two choices).
  *
  * When any hosts have a weight that is not 1, an RR EDF schedule is used. Host weight is scaled
  * by the number of active requests at pick/insert time. Thus, hosts will never fully drain as
- * they would in normal P2C, though they will get picked less and less often. In the future, we
- * can consider two alternate algorithms:
- * 1) Expand out all hosts by weight (using more memory) and do standard P2C.
- * 2) Use a weighted Maglev table, and perform P2C on two random hosts selected from the table.
- *    The benefit of the Maglev table is at the expense of resolution, memory usage is capped.
- *    Additionally, the Maglev table can be shared amongst all threads.
+ * they would in normal P2C, though they will get picked less and less often.
+ *
+ * If weighted_sampling is configured, weighted hosts are instead handled by sampling N hosts in
+ * proportion to their weight from an alias table, which is O(1) per sample, and picking the one
+ * with the fewest active requests. The alias tables are built when the host set changes, so like
+ * the EDF schedule they do not see weight changes until the next membership update.
  */
 class LeastRequestLoadBalancer : public EdfLoadBalancerBase {
 public:
-  LeastRequestLoadBalancer(const PrioritySet& priority_set, const PrioritySet* local_priority_set,
-                           ClusterStats& stats, Runtime::Loader& runtime,
-                           Runtime::RandomGenerator& random,
-                           const envoy::api::v2::Cluster::CommonLbConfig& common_config)
+  LeastRequestLoadBalancer(
+      const PrioritySet& priority_set, const PrioritySet* local_priority_set, ClusterStats& stats,
+      Runtime::Loader& runtime, Runtime::RandomGenerator& random,
+      const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+      const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig>& least_request_config)
       : EdfLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
-                            common_config) {
+                            common_config),
+        choice_count_(least_request_config.has_value()
+                          ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(least_request_config.value(),
+                                                            choice_count, 2)
+                          : 2),
+        weighted_sampling_(least_request_config.has_value() &&
+                           least_request_config.value().weighted_sampling()) {
     initialize();
   }
 
+  // Upstream::LoadBalancerBase
+  HostConstSharedPtr chooseHostOnce(LoadBalancerContext* context) override;
+
 private:
-  void refreshHostSource(const HostsSource&) override {}
+  void refreshHostSource(const HostsSource& source) override;
   double hostWeight(const Host& host) override {
     // Here we scale host weight by the number of active requests at the time we do the pick. We
     // always add 1 to avoid division by 0. Note that if all weights are 1, the EDF schedule is
@@ -371,6 +385,11 @@ private:
   }
   HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
                                         const HostsSource& source) override;
+
+  const uint32_t choice_count_;
+  const bool weighted_sampling_;
+  // Alias table for each valid non-empty HostsSource, only populated with weighted_sampling_.
+  std::unordered_map<HostsSource, AliasTable, HostsSourceHash> alias_tables_;
 };
 
 /**
@@ -2,6 +2,7 @@
 
 #include "envoy/stats/scope.h"
 
+#include "common/network/utility.h"
 #include "common/protobuf/protobuf.h"
 
 namespace Envoy {
@@ -42,9 +43,11 @@ void LoadStatsReporter::establishNewStream() {
 
 void LoadStatsReporter::sendLoadStatsRequest() {
   request_.mutable_cluster_stats()->Clear();
+  const bool report_endpoints = message_ != nullptr && message_->report_endpoint_granularity();
+  // Build the cluster map once per report rather than once per reported cluster.
+  const auto cluster_info_map = cm_.clusters();
   for (const auto& cluster_name_and_timestamp : clusters_) {
     const std::string& cluster_name = cluster_name_and_timestamp.first;
-    auto cluster_info_map = cm_.clusters();
     auto it = cluster_info_map.find(cluster_name);
     if (it == cluster_info_map.end()) {
       ENVOY_LOG(debug, "Cluster {} does not exist", cluster_name);
@@ -60,13 +63,32 @@ void LoadStatsReporter::sendLoadStatsRequest() {
         uint64_t rq_success = 0;
         uint64_t rq_error = 0;
         uint64_t rq_active = 0;
-        for (auto host : hosts) {
-          rq_success += host->stats().rq_success_.latch();
-          rq_error += host->stats().rq_error_.latch();
-          rq_active += host->stats().rq_active_.value();
+        // Only created once the locality is known to have had activity.
+        envoy::api::v2::endpoint::UpstreamLocalityStats* locality_stats = nullptr;
+        for (const auto& host : hosts) {
+          const uint64_t host_rq_success = host->stats().rq_success_.latch();
+          const uint64_t host_rq_error = host->stats().rq_error_.latch();
+          const uint64_t host_rq_active = host->stats().rq_active_.value();
+          rq_success += host_rq_success;
+          rq_error += host_rq_error;
+          rq_active += host_rq_active;
+          // Endpoints without activity in the interval are left out of the report.
+          if (report_endpoints && host_rq_success + host_rq_error + host_rq_active != 0) {
+            if (locality_stats == nullptr) {
+              locality_stats = cluster_stats->add_upstream_locality_stats();
+            }
+            auto* endpoint_stats = locality_stats->add_upstream_endpoint_stats();
+            Network::Utility::addressToProtobufAddress(*host->address(),
+                                                       *endpoint_stats->mutable_address());
+            endpoint_stats->set_total_successful_requests(host_rq_success);
+            endpoint_stats->set_total_error_requests(host_rq_error);
+            endpoint_stats->set_total_requests_in_progress(host_rq_active);
+          }
         }
         if (rq_success + rq_error + rq_active != 0) {
-          auto* locality_stats = cluster_stats->add_upstream_locality_stats();
+          if (locality_stats == nullptr) {
+            locality_stats = cluster_stats->add_upstream_locality_stats();
+          }
           locality_stats->mutable_locality()->MergeFrom(hosts[0]->locality());
           locality_stats->set_priority(host_set->priority());
           locality_stats->set_total_successful_requests(rq_success);
@@ -132,12 +154,12 @@ void LoadStatsReporter::startLoadReportPeriod() {
     }
   }
   clusters_.clear();
+  const auto cluster_info_map = cm_.clusters();
   // Reset stats for all hosts in clusters we are tracking.
   for (const std::string& cluster_name : message_->clusters()) {
     clusters_.emplace(cluster_name, existing_clusters.count(cluster_name) > 0
                                         ? existing_clusters[cluster_name]
                                         : time_source_.monotonicTime().time_since_epoch());
-    auto cluster_info_map = cm_.clusters();
     auto it = cluster_info_map.find(cluster_name);
     if (it == cluster_info_map.end()) {
       continue;
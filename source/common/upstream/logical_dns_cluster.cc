@@ -1,5 +1,6 @@
 #include "common/upstream/logical_dns_cluster.h"
 
+#include <algorithm>
 #include <chrono>
 #include <list>
 #include <string>
@@ -52,6 +53,9 @@ LogicalDnsCluster::LogicalDnsCluster(
   case envoy::api::v2::Cluster::AUTO:
     dns_lookup_family_ = Network::DnsLookupFamily::Auto;
     break;
+  case envoy::api::v2::Cluster::ALL:
+    dns_lookup_family_ = Network::DnsLookupFamily::All;
+    break;
   default:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
@@ -91,9 +95,18 @@ void LogicalDnsCluster::startResolve() {
         if (!address_list.empty()) {
           // TODO(mattklein123): Move port handling into the DNS interface.
           ASSERT(address_list.front() != nullptr);
+          const uint32_t port = Network::Utility::portFromTcpUrl(dns_url_);
           Network::Address::InstanceConstSharedPtr new_address =
-              Network::Utility::getAddressWithPort(*address_list.front(),
-                                                   Network::Utility::portFromTcpUrl(dns_url_));
+              Network::Utility::getAddressWithPort(*address_list.front(), port);
+          // With the ALL lookup family, connections race the resolved addresses so that a
+          // broken address family only delays them.
+          std::vector<Network::Address::InstanceConstSharedPtr> new_addresses;
+          if (dns_lookup_family_ == Network::DnsLookupFamily::All && address_list.size() > 1) {
+            new_addresses.reserve(address_list.size());
+            for (const auto& address : address_list) {
+              new_addresses.push_back(Network::Utility::getAddressWithPort(*address, port));
+            }
+          }
           if (!logical_host_) {
             // TODO(mattklein123): The logical host is only used in /clusters admin output. We used
             // to show the friendly DNS name in that output, but currently there is no way to
@@ -121,16 +134,19 @@ void LogicalDnsCluster::startResolve() {
                 absl::nullopt, absl::nullopt, absl::nullopt);
           }
 
-          if (!current_resolved_address_ || !(*new_address == *current_resolved_address_)) {
+          if (!current_resolved_address_ || !(*new_address == *current_resolved_address_) ||
+              !sameAddresses(new_addresses, current_resolved_addresses_)) {
             current_resolved_address_ = new_address;
+            current_resolved_addresses_ = new_addresses;
 
             // Make sure that we have an updated health check address.
             logical_host_->setHealthCheckAddress(new_address);
 
             // Capture URL to avoid a race with another update.
-            tls_->runOnAllThreads([this, new_address]() -> void {
+            tls_->runOnAllThreads([this, new_address, new_addresses]() -> void {
               PerThreadCurrentHostData& data = tls_->getTyped<PerThreadCurrentHostData>();
               data.current_resolved_address_ = new_address;
+              data.current_resolved_addresses_ = new_addresses;
             });
           }
         }
@@ -140,13 +156,26 @@ void LogicalDnsCluster::startResolve() {
       });
 }
 
+bool LogicalDnsCluster::sameAddresses(
+    const std::vector<Network::Address::InstanceConstSharedPtr>& lhs,
+    const std::vector<Network::Address::InstanceConstSharedPtr>& rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                    [](const Network::Address::InstanceConstSharedPtr& lhs,
+                       const Network::Address::InstanceConstSharedPtr& rhs) {
+                      return *lhs == *rhs;
+                    });
+}
+
 Upstream::Host::CreateConnectionData LogicalDnsCluster::LogicalHost::createConnection(
     Event::Dispatcher& dispatcher,
     const Network::ConnectionSocket::OptionsSharedPtr& options) const {
   PerThreadCurrentHostData& data = parent_.tls_->getTyped<PerThreadCurrentHostData>();
   ASSERT(data.current_resolved_address_);
-  return {HostImpl::createConnection(dispatcher, *parent_.info_, data.current_resolved_address_,
-                                     options),
+  return {data.current_resolved_addresses_.empty()
+              ? HostImpl::createConnection(dispatcher, *parent_.info_,
+                                           data.current_resolved_address_, options)
+              : HostImpl::createConnection(dispatcher, *parent_.info_,
+                                           data.current_resolved_addresses_, options),
           HostDescriptionConstSharedPtr{
               new RealHostDescription(data.current_resolved_address_, parent_.localityLbEndpoint(),
                                       parent_.lbEndpoint(), shared_from_this())}};
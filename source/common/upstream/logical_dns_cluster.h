@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "envoy/stats/scope.h"
 #include "envoy/thread_local/thread_local.h"
@@ -75,6 +76,7 @@ private:
                         HostConstSharedPtr logical_host)
         : address_(address), logical_host_(logical_host),
           metadata_(std::make_shared<envoy::api::v2::core::Metadata>(lb_endpoint.metadata())),
+          lb_metadata_(HostDescriptionImpl::extractLbMetadata(lb_endpoint.metadata())),
           health_check_address_(
               lb_endpoint.endpoint().health_check_config().port_value() == 0
                   ? address
@@ -89,6 +91,7 @@ private:
       return metadata_;
     }
     void metadata(const envoy::api::v2::core::Metadata&) override {}
+    LbMetadataConstSharedPtr lbMetadata() const override { return lb_metadata_; }
 
     const ClusterInfo& cluster() const override { return logical_host_->cluster(); }
     HealthCheckHostMonitor& healthChecker() const override {
@@ -112,6 +115,7 @@ private:
     Network::Address::InstanceConstSharedPtr address_;
     HostConstSharedPtr logical_host_;
     const std::shared_ptr<envoy::api::v2::core::Metadata> metadata_;
+    const LbMetadataConstSharedPtr lb_metadata_;
     Network::Address::InstanceConstSharedPtr health_check_address_;
     const envoy::api::v2::endpoint::LocalityLbEndpoints& locality_lb_endpoint_;
     const envoy::api::v2::endpoint::LbEndpoint& lb_endpoint_;
@@ -119,6 +123,9 @@ private:
 
   struct PerThreadCurrentHostData : public ThreadLocal::ThreadLocalObject {
     Network::Address::InstanceConstSharedPtr current_resolved_address_;
+    // All resolved addresses in connection attempt order when resolving with
+    // DnsLookupFamily::All, empty otherwise.
+    std::vector<Network::Address::InstanceConstSharedPtr> current_resolved_addresses_;
   };
 
   const envoy::api::v2::endpoint::LocalityLbEndpoints& localityLbEndpoint() const {
@@ -134,6 +141,8 @@ private:
   }
 
   void startResolve();
+  static bool sameAddresses(const std::vector<Network::Address::InstanceConstSharedPtr>& lhs,
+                            const std::vector<Network::Address::InstanceConstSharedPtr>& rhs);
 
   // ClusterImplBase
   void startPreInit() override;
@@ -146,6 +155,7 @@ private:
   std::string dns_url_;
   std::string hostname_;
   Network::Address::InstanceConstSharedPtr current_resolved_address_;
+  std::vector<Network::Address::InstanceConstSharedPtr> current_resolved_addresses_;
   HostSharedPtr logical_host_;
   Network::ActiveDnsQuery* active_dns_query_{};
   const LocalInfo::LocalInfo& local_info_;
@@ -52,6 +52,9 @@ MaglevTable::MaglevTable(const HostsPerLocality& hosts_per_locality,
   }
 
   table_.resize(table_size_);
+  // Slot occupancy is tracked in a bit vector during the build. It is much denser than table_, so
+  // the probing below mostly stays in cache even for large tables.
+  std::vector<bool> occupied(table_size_);
   uint64_t table_index = 0;
   uint32_t iteration = 1;
   while (true) {
@@ -69,14 +72,13 @@ MaglevTable::MaglevTable(const HostsPerLocality& hosts_per_locality,
         }
         entry.counts_ += max_host_weight;
       }
-      uint64_t c = permutation(entry);
-      while (table_[c] != nullptr) {
-        entry.next_++;
-        c = permutation(entry);
+      while (occupied[entry.next_]) {
+        advance(entry);
       }
 
-      table_[c] = entry.host_;
-      entry.next_++;
+      occupied[entry.next_] = true;
+      table_[entry.next_] = entry.host_;
+      advance(entry);
       table_index++;
       if (table_index == table_size_) {
         if (ENVOY_LOG_CHECK_LEVEL(trace)) {
@@ -99,8 +101,22 @@ HostConstSharedPtr MaglevTable::chooseHost(uint64_t hash) const {
   return table_[hash % table_size_];
 }
 
-uint64_t MaglevTable::permutation(const TableBuildEntry& entry) {
-  return (entry.offset_ + (entry.skip_ * entry.next_)) % table_size_;
+HostConstSharedPtr MaglevTable::chooseNextHost(uint64_t hash, uint32_t attempt) const {
+  if (table_.empty()) {
+    return nullptr;
+  }
+
+  // Neighbouring table entries are unrelated, so rehash the key for each attempt instead.
+  const absl::string_view key(reinterpret_cast<const char*>(&hash), sizeof(hash));
+  return table_[HashUtil::xxHash64(key, attempt) % table_size_];
+}
+
+void MaglevTable::advance(TableBuildEntry& entry) const {
+  // skip_ is less than table_size_, so a single subtraction keeps the slot in range.
+  entry.next_ += entry.skip_;
+  if (entry.next_ >= table_size_) {
+    entry.next_ -= table_size_;
+  }
 }
 
 } // namespace Upstream
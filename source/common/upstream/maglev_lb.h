@@ -21,6 +21,7 @@ public:
 
   // ThreadAwareLoadBalancerBase::HashingLoadBalancer
   HostConstSharedPtr chooseHost(uint64_t hash) const override;
+  HostConstSharedPtr chooseNextHost(uint64_t hash, uint32_t attempt) const override;
 
   // Recommended table size in section 5.3 of the paper.
   static const uint64_t DefaultTableSize = 65537;
@@ -28,17 +29,19 @@ public:
 private:
   struct TableBuildEntry {
     TableBuildEntry(const HostSharedPtr& host, uint64_t offset, uint64_t skip, uint64_t weight)
-        : host_(host), offset_(offset), skip_(skip), weight_(weight) {}
+        : host_(host), offset_(offset), skip_(skip), weight_(weight), next_(offset) {}
 
     HostSharedPtr host_;
     const uint64_t offset_;
     const uint64_t skip_;
     const uint64_t weight_;
     uint64_t counts_{};
-    uint64_t next_{};
+    // The current slot of the host's permutation, i.e. (offset_ + skip_ * j) % table_size_ for the
+    // j-th preference. It is advanced by adding skip_, which avoids a division per probe.
+    uint64_t next_;
   };
 
-  uint64_t permutation(const TableBuildEntry& entry);
+  void advance(TableBuildEntry& entry) const;
 
   const uint64_t table_size_;
   HostVector table_;
@@ -22,24 +22,55 @@ namespace Upstream {
 // OriginalDstCluster::LoadBalancer is never configured with any other type of cluster,
 // and throws an exception otherwise.
 
+HostSharedPtr OriginalDstCluster::HostMap::find(const std::string& address) {
+  Shard& shard = this->shard(address);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.hosts_.find(address);
+  return it != shard.hosts_.end() ? it->second : nullptr;
+}
+
+HostSharedPtr OriginalDstCluster::HostMap::insert(const HostSharedPtr& host) {
+  const std::string address = host->address()->asString();
+  Shard& shard = this->shard(address);
+  absl::MutexLock lock(&shard.mutex_);
+  return shard.hosts_.emplace(address, host).first->second;
+}
+
+void OriginalDstCluster::HostMap::remove(const HostSharedPtr& host) {
+  const std::string address = host->address()->asString();
+  Shard& shard = this->shard(address);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.hosts_.find(address);
+  if (it != shard.hosts_.end() && it->second == host) {
+    shard.hosts_.erase(it);
+  }
+}
+
+OriginalDstCluster::HostMap::Shard& OriginalDstCluster::HostMap::shard(const std::string& address) {
+  return shards_[std::hash<std::string>()(address) % shards_.size()];
+}
+
 OriginalDstCluster::LoadBalancer::LoadBalancer(
     PrioritySet& priority_set, ClusterSharedPtr& parent,
     const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>& config)
     : priority_set_(priority_set), parent_(std::static_pointer_cast<OriginalDstCluster>(parent)),
-      info_(parent->info()), use_http_header_(config ? config.value().use_http_header() : false) {
+      info_(parent->info()), use_http_header_(config ? config.value().use_http_header() : false),
+      host_map_(std::static_pointer_cast<OriginalDstCluster>(parent)->host_map_) {
   // priority_set_ is initially empty.
   priority_set_.addMemberUpdateCb(
       [this](uint32_t, const HostVector& hosts_added, const HostVector& hosts_removed) -> void {
-        // Update the hosts map
+        // Update the local hosts map
         // TODO(ramaraochavali): use cluster stats and move the log lines to debug.
         for (const HostSharedPtr& host : hosts_removed) {
           ENVOY_LOG(debug, "Removing host {}.", host->address()->asString());
-          host_map_.remove(host);
+          auto it = local_hosts_.find(host->address()->asString());
+          if (it != local_hosts_.end() && it->second == host) {
+            local_hosts_.erase(it);
+          }
         }
         for (const HostSharedPtr& host : hosts_added) {
-          if (host_map_.insert(host)) {
-            ENVOY_LOG(debug, "Adding host {}.", host->address()->asString());
-          }
+          ENVOY_LOG(debug, "Adding host {}.", host->address()->asString());
+          local_hosts_[host->address()->asString()] = host;
         }
       });
 }
@@ -63,11 +94,22 @@ HostConstSharedPtr OriginalDstCluster::LoadBalancer::chooseHost(LoadBalancerCont
 
     if (dst_host) {
       const Network::Address::Instance& dst_addr = *dst_host.get();
+      const std::string address = dst_addr.asString();
+
+      // Check if this worker already knows a host with the destination address.
+      auto it = local_hosts_.find(address);
+      if (it != local_hosts_.end()) {
+        ENVOY_LOG(debug, "Using existing host {}.", address);
+        it->second->used(true); // Mark as used.
+        return it->second;
+      }
 
-      // Check if a host with the destination address is already in the host set.
-      HostSharedPtr host = host_map_.find(dst_addr);
+      // Check if another worker has created a host with the destination address, which may not
+      // be in the host set yet.
+      HostSharedPtr host = host_map_->find(address);
       if (host) {
-        ENVOY_LOG(debug, "Using existing host {}.", host->address()->asString());
+        ENVOY_LOG(debug, "Using existing host {}.", address);
+        local_hosts_.emplace(address, host);
         host->used(true); // Mark as used.
         return std::move(host);
       }
@@ -83,18 +125,25 @@ HostConstSharedPtr OriginalDstCluster::LoadBalancer::chooseHost(LoadBalancerCont
             envoy::api::v2::core::Locality().default_instance(),
             envoy::api::v2::endpoint::Endpoint::HealthCheckConfig().default_instance()));
 
-        ENVOY_LOG(debug, "Created host {}.", host->address()->asString());
-        // Add the new host to the map. We just failed to find it in
-        // our local map above, so insert without checking (2nd arg == false).
-        host_map_.insert(host, false);
+        // Another worker may have created a host with the same address concurrently, in which case
+        // its host is used instead.
+        HostSharedPtr inserted_host = host_map_->insert(host);
+        local_hosts_.emplace(address, inserted_host);
+        if (inserted_host != host) {
+          ENVOY_LOG(debug, "Using existing host {}.", address);
+          inserted_host->used(true); // Mark as used.
+          return std::move(inserted_host);
+        }
+        ENVOY_LOG(debug, "Created host {}.", address);
 
-        if (std::shared_ptr<OriginalDstCluster> parent = parent_.lock()) {
+        std::shared_ptr<OriginalDstCluster> parent = parent_.lock();
+        if (parent && parent->queueHost(host)) {
           // lambda cannot capture a member by value.
           std::weak_ptr<OriginalDstCluster> post_parent = parent_;
-          parent->dispatcher_.post([post_parent, host]() mutable {
+          parent->dispatcher_.post([post_parent]() {
             // The main cluster may have disappeared while this post was queued.
             if (std::shared_ptr<OriginalDstCluster> parent = post_parent.lock()) {
-              parent->addHost(host);
+              parent->addPendingHosts();
             }
           });
         }
@@ -137,20 +186,36 @@ OriginalDstCluster::OriginalDstCluster(
       dispatcher_(factory_context.dispatcher()),
       cleanup_interval_ms_(
           std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(config, cleanup_interval, 5000))),
-      cleanup_timer_(dispatcher_.createTimer([this]() -> void { cleanup(); })) {
+      cleanup_timer_(dispatcher_.createTimer([this]() -> void { cleanup(); })),
+      host_map_(std::make_shared<HostMap>()) {
 
   cleanup_timer_->enableTimer(cleanup_interval_ms_);
 }
 
-void OriginalDstCluster::addHost(HostSharedPtr& host) {
+bool OriginalDstCluster::queueHost(const HostSharedPtr& host) {
+  absl::MutexLock lock(&pending_hosts_mutex_);
+  pending_hosts_.push_back(host);
+  return pending_hosts_.size() == 1;
+}
+
+void OriginalDstCluster::addPendingHosts() {
+  HostVector hosts_added;
+  {
+    absl::MutexLock lock(&pending_hosts_mutex_);
+    hosts_added.swap(pending_hosts_);
+  }
+
   // Given the current config, only EDS clusters support multiple priorities.
   ASSERT(priority_set_.hostSetsPerPriority().size() == 1);
   auto& first_host_set = priority_set_.getOrCreateHostSet(0);
-  HostVectorSharedPtr new_hosts(new HostVector(first_host_set.hosts()));
-  new_hosts->emplace_back(host);
+  HostVectorSharedPtr new_hosts(new HostVector());
+  new_hosts->reserve(first_host_set.hosts().size() + hosts_added.size());
+  new_hosts->insert(new_hosts->end(), first_host_set.hosts().begin(),
+                    first_host_set.hosts().end());
+  new_hosts->insert(new_hosts->end(), hosts_added.begin(), hosts_added.end());
   first_host_set.updateHosts(new_hosts, createHealthyHostList(*new_hosts),
                              HostsPerLocalityImpl::empty(), HostsPerLocalityImpl::empty(), {},
-                             {std::move(host)}, {}, absl::nullopt);
+                             hosts_added, {}, absl::nullopt);
 }
 
 void OriginalDstCluster::cleanup() {
@@ -168,6 +233,7 @@ void OriginalDstCluster::cleanup() {
       host->used(false); // Mark to be removed during the next round.
     } else {
       ENVOY_LOG(debug, "Removing stale host {}.", host->address()->asString());
+      host_map_->remove(host);
       to_be_removed.emplace_back(host);
     }
   }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -14,6 +16,8 @@
 #include "common/common/logger.h"
 #include "common/upstream/upstream_impl.h"
 
+#include "absl/synchronization/mutex.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -32,16 +36,50 @@ public:
   // Upstream::Cluster
   InitializePhase initializePhase() const override { return InitializePhase::Primary; }
 
+  /**
+   * Map from a host IP address/port to the HostSharedPtr of the cluster, shared by the cluster and
+   * the load balancers of all workers. The map is sharded, so that workers adding hosts for
+   * distinct destinations rarely contend, and holds a single host per address, so that workers
+   * adding a host for the same destination concurrently share it.
+   */
+  class HostMap {
+  public:
+    HostSharedPtr find(const std::string& address);
+
+    /**
+     * Insert a host, unless the map already holds a host with the same address.
+     * @return HostSharedPtr the host the map holds for the address.
+     */
+    HostSharedPtr insert(const HostSharedPtr& host);
+
+    /**
+     * Remove a host, unless the map holds another host with the same address.
+     */
+    void remove(const HostSharedPtr& host);
+
+  private:
+    struct Shard {
+      absl::Mutex mutex_;
+      std::unordered_map<std::string, HostSharedPtr> hosts_ GUARDED_BY(mutex_);
+    };
+
+    Shard& shard(const std::string& address);
+
+    std::array<Shard, 16> shards_;
+  };
+
+  typedef std::shared_ptr<HostMap> HostMapSharedPtr;
+
   /**
    * Special Load Balancer for Original Dst Cluster.
    *
    * Load balancer gets called with the downstream context which can be used to make sure the
    * Original Dst cluster has a Host for the original destination. Normally load balancers can't
    * modify clusters, but in this case we access a singleton OriginalDstCluster that we can ask to
-   * add hosts on demand. Additions are synced with all other threads so that the host set in the
-   * cluster remains (eventually) consistent. If multiple threads add a host to the same upstream
-   * address then two distinct HostSharedPtr's (with the same upstream IP address) will be added,
-   * and both of them will eventually time out.
+   * add hosts on demand. Each load balancer looks hosts up in its own map first, and then in the
+   * HostMap shared by all workers, so that a host created by any worker is used by all of them
+   * right away. Additions are synced with all other threads so that the host set in the cluster
+   * remains (eventually) consistent.
    */
   class LoadBalancer : public Upstream::LoadBalancer {
   public:
@@ -52,60 +90,27 @@ public:
     HostConstSharedPtr chooseHost(LoadBalancerContext* context) override;
 
   private:
-    /**
-     * Map from an host IP address/port to a HostSharedPtr. Due to races multiple distinct host
-     * objects with the same address can be created, so we need to use a multimap.
-     */
-    class HostMap {
-    public:
-      bool insert(const HostSharedPtr& host, bool check = true) {
-        if (check) {
-          auto range = map_.equal_range(host->address()->asString());
-          auto it = std::find_if(
-              range.first, range.second,
-              [&host](const decltype(map_)::value_type pair) { return pair.second == host; });
-          if (it != range.second) {
-            return false; // 'host' already in the map, no need to insert.
-          }
-        }
-        map_.emplace(host->address()->asString(), host);
-        return true;
-      }
-
-      void remove(const HostSharedPtr& host) {
-        auto range = map_.equal_range(host->address()->asString());
-        auto it =
-            std::find_if(range.first, range.second, [&host](const decltype(map_)::value_type pair) {
-              return pair.second == host;
-            });
-        ASSERT(it != range.second);
-        map_.erase(it);
-      }
-
-      HostSharedPtr find(const Network::Address::Instance& address) {
-        auto it = map_.find(address.asString());
-
-        if (it != map_.end()) {
-          return it->second;
-        }
-        return nullptr;
-      }
-
-    private:
-      std::unordered_multimap<std::string, HostSharedPtr> map_;
-    };
-
     Network::Address::InstanceConstSharedPtr requestOverrideHost(LoadBalancerContext* context);
 
     PrioritySet& priority_set_;                // Thread local priority set.
     std::weak_ptr<OriginalDstCluster> parent_; // Primary cluster managed by the main thread.
     ClusterInfoConstSharedPtr info_;
     const bool use_http_header_;
-    HostMap host_map_;
+    const HostMapSharedPtr host_map_;
+    // The hosts of the thread local priority set and the hosts this worker has looked up, by
+    // address, which are looked up without locking.
+    std::unordered_map<std::string, HostSharedPtr> local_hosts_;
   };
 
 private:
-  void addHost(HostSharedPtr&);
+  /**
+   * Queue a host created by a worker for addition to the host set. May be called from any thread.
+   * @return bool whether the caller has to post addPendingHosts() to the main thread, which is not
+   *         the case if it is already posted for hosts queued before.
+   */
+  bool queueHost(const HostSharedPtr& host);
+  // Add all the queued hosts to the host set with a single update.
+  void addPendingHosts();
   void cleanup();
 
   // ClusterImplBase
@@ -114,6 +119,9 @@ private:
   Event::Dispatcher& dispatcher_;
   const std::chrono::milliseconds cleanup_interval_ms_;
   Event::TimerPtr cleanup_timer_;
+  const HostMapSharedPtr host_map_;
+  absl::Mutex pending_hosts_mutex_;
+  HostVector pending_hosts_ GUARDED_BY(pending_hosts_mutex_);
 };
 
 } // namespace Upstream
@@ -1,8 +1,11 @@
 #include "common/upstream/outlier_detection_impl.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -76,6 +79,16 @@ void DetectorHostMonitorImpl::putHttpResponseCode(uint64_t response_code) {
   }
 }
 
+void DetectorHostMonitorImpl::putResponseTime(std::chrono::milliseconds time) {
+  SuccessRateAccumulatorBucket* bucket = success_rate_accumulator_bucket_.load();
+  bucket->response_time_sum_ms_ += time.count();
+  bucket->response_time_counter_++;
+}
+
+void DetectorHostMonitorImpl::updateLatency(double response_time, double weight) {
+  latency_ = latency_ < 0 ? response_time : weight * response_time + (1 - weight) * latency_;
+}
+
 Http::Code DetectorHostMonitorImpl::resultToHttpCode(Result result) {
   Http::Code http_code = Http::Code::InternalServerError;
 
@@ -125,7 +138,14 @@ DetectorConfig::DetectorConfig(const envoy::api::v2::cluster::OutlierDetection&
       enforcing_consecutive_gateway_failure_(static_cast<uint64_t>(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, enforcing_consecutive_gateway_failure, 0))),
       enforcing_success_rate_(static_cast<uint64_t>(
-          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, enforcing_success_rate, 100))) {}
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, enforcing_success_rate, 100))),
+      enforcing_latency_(
+          static_cast<uint64_t>(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, enforcing_latency, 0))),
+      latency_stdev_factor_(static_cast<uint64_t>(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, latency_stdev_factor, 1900))),
+      latency_ewma_weight_(
+          static_cast<uint64_t>(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, latency_ewma_weight, 30))) {
+}
 
 DetectorImpl::DetectorImpl(const Cluster& cluster,
                            const envoy::api::v2::cluster::OutlierDetection& config,
@@ -233,6 +253,9 @@ bool DetectorImpl::enforceEjection(EjectionType type) {
   case EjectionType::SuccessRate:
     return runtime_.snapshot().featureEnabled("outlier_detection.enforcing_success_rate",
                                               config_.enforcingSuccessRate());
+  case EjectionType::Latency:
+    return runtime_.snapshot().featureEnabled("outlier_detection.enforcing_latency",
+                                              config_.enforcingLatency());
   }
 
   NOT_REACHED_GCOVR_EXCL_LINE;
@@ -250,6 +273,9 @@ void DetectorImpl::updateEnforcedEjectionStats(EjectionType type) {
   case EjectionType::ConsecutiveGatewayFailure:
     stats_.ejections_enforced_consecutive_gateway_failure_.inc();
     break;
+  case EjectionType::Latency:
+    stats_.ejections_enforced_latency_.inc();
+    break;
   }
 }
 
@@ -343,12 +369,26 @@ void DetectorImpl::onConsecutiveErrorWorker(HostSharedPtr host, EjectionType typ
     host_monitors_[host]->resetConsecutiveGatewayFailure();
     break;
   case EjectionType::SuccessRate:
+  case EjectionType::Latency:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
 }
 
+namespace {
+
+double standardDeviation(double mean, const std::vector<double>& values) {
+  double variance = 0;
+  for (const double value : values) {
+    variance += (value - mean) * (value - mean);
+  }
+  variance /= values.size();
+  return std::sqrt(variance);
+}
+
+} // namespace
+
 Utility::EjectionPair Utility::successRateEjectionThreshold(
-    double success_rate_sum, const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
+    double success_rate_sum, const std::vector<double>& success_rates,
     double success_rate_stdev_factor) {
   // This function is using mean and standard deviation as statistical measures for outlier
   // detection. First the mean is calculated by dividing the sum of success rate data over the
@@ -365,67 +405,75 @@ Utility::EjectionPair Utility::successRateEjectionThreshold(
   // variance = 400
   // stdev = 20
   // threshold returned = 52
-  double mean = success_rate_sum / valid_success_rate_hosts.size();
-  double variance = 0;
-  std::for_each(valid_success_rate_hosts.begin(), valid_success_rate_hosts.end(),
-                [&variance, mean](HostSuccessRatePair v) {
-                  variance += std::pow(v.success_rate_ - mean, 2);
-                });
-  variance /= valid_success_rate_hosts.size();
-  double stdev = std::sqrt(variance);
+  double mean = success_rate_sum / success_rates.size();
+  double stdev = standardDeviation(mean, success_rates);
 
   return {mean, (mean - (success_rate_stdev_factor * stdev))};
 }
 
+Utility::EjectionPair Utility::latencyEjectionThreshold(double latency_sum,
+                                                        const std::vector<double>& latencies,
+                                                        double latency_stdev_factor) {
+  // The same measures as for success rate, except that slow hosts are the outliers, so the
+  // threshold is above the mean.
+  double mean = latency_sum / latencies.size();
+  double stdev = standardDeviation(mean, latencies);
+
+  return {mean, (mean + (latency_stdev_factor * stdev))};
+}
+
 void DetectorImpl::processSuccessRateEjections() {
   uint64_t success_rate_minimum_hosts = runtime_.snapshot().getInteger(
       "outlier_detection.success_rate_minimum_hosts", config_.successRateMinimumHosts());
-  uint64_t success_rate_request_volume = runtime_.snapshot().getInteger(
-      "outlier_detection.success_rate_request_volume", config_.successRateRequestVolume());
-  std::vector<HostSuccessRatePair> valid_success_rate_hosts;
-  double success_rate_sum = 0;
 
   // Reset the Detector's success rate mean and stdev.
   success_rate_average_ = -1;
   success_rate_ejection_threshold_ = -1;
 
-  // Exit early if there are not enough hosts.
-  if (host_monitors_.size() < success_rate_minimum_hosts) {
-    return;
-  }
-
-  // reserve upper bound of vector size to avoid reallocation.
-  valid_success_rate_hosts.reserve(host_monitors_.size());
-
-  for (const auto& host : host_monitors_) {
-    // Don't do work if the host is already ejected.
-    if (!host.first->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
-      absl::optional<double> host_success_rate =
-          host.second->successRateAccumulator().getSuccessRate(success_rate_request_volume);
-
-      if (host_success_rate) {
-        valid_success_rate_hosts.emplace_back(
-            HostSuccessRatePair(host.first, host_success_rate.value()));
-        success_rate_sum += host_success_rate.value();
-        host.second->successRate(host_success_rate.value());
-      }
-    }
-  }
-
-  if (valid_success_rate_hosts.size() >= success_rate_minimum_hosts) {
+  if (success_rates_.size() >= success_rate_minimum_hosts && !success_rates_.empty()) {
     double success_rate_stdev_factor =
         runtime_.snapshot().getInteger("outlier_detection.success_rate_stdev_factor",
                                        config_.successRateStdevFactor()) /
         1000.0;
+    const double success_rate_sum =
+        std::accumulate(success_rates_.begin(), success_rates_.end(), 0.0);
     Utility::EjectionPair ejection_pair = Utility::successRateEjectionThreshold(
-        success_rate_sum, valid_success_rate_hosts, success_rate_stdev_factor);
+        success_rate_sum, success_rates_, success_rate_stdev_factor);
     success_rate_average_ = ejection_pair.success_rate_average_;
     success_rate_ejection_threshold_ = ejection_pair.ejection_threshold_;
-    for (const auto& host_success_rate_pair : valid_success_rate_hosts) {
-      if (host_success_rate_pair.success_rate_ < success_rate_ejection_threshold_) {
+    for (size_t i = 0; i < success_rates_.size(); i++) {
+      if (success_rates_[i] < success_rate_ejection_threshold_) {
         stats_.ejections_success_rate_.inc(); // Deprecated.
         stats_.ejections_detected_success_rate_.inc();
-        ejectHost(host_success_rate_pair.host_, EjectionType::SuccessRate);
+        ejectHost(success_rate_hosts_[i], EjectionType::SuccessRate);
+      }
+    }
+  }
+}
+
+void DetectorImpl::processLatencyEjections() {
+  uint64_t success_rate_minimum_hosts = runtime_.snapshot().getInteger(
+      "outlier_detection.success_rate_minimum_hosts", config_.successRateMinimumHosts());
+
+  latency_average_ = -1;
+  latency_ejection_threshold_ = -1;
+
+  if (latencies_.size() >= success_rate_minimum_hosts && !latencies_.empty()) {
+    double latency_stdev_factor =
+        runtime_.snapshot().getInteger("outlier_detection.latency_stdev_factor",
+                                       config_.latencyStdevFactor()) /
+        1000.0;
+    const double latency_sum = std::accumulate(latencies_.begin(), latencies_.end(), 0.0);
+    Utility::EjectionPair ejection_pair =
+        Utility::latencyEjectionThreshold(latency_sum, latencies_, latency_stdev_factor);
+    latency_average_ = ejection_pair.success_rate_average_;
+    latency_ejection_threshold_ = ejection_pair.ejection_threshold_;
+    for (size_t i = 0; i < latencies_.size(); i++) {
+      // The host may have been ejected for its success rate in this interval.
+      if (latencies_[i] > latency_ejection_threshold_ &&
+          !latency_hosts_[i]->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
+        stats_.ejections_detected_latency_.inc();
+        ejectHost(latency_hosts_[i], EjectionType::Latency);
       }
     }
   }
@@ -433,18 +481,59 @@ void DetectorImpl::processSuccessRateEjections() {
 
 void DetectorImpl::onIntervalTimer() {
   MonotonicTime now = time_source_.monotonicTime();
-
-  for (auto host : host_monitors_) {
+  const bool enough_hosts =
+      host_monitors_.size() >=
+      runtime_.snapshot().getInteger("outlier_detection.success_rate_minimum_hosts",
+                                     config_.successRateMinimumHosts());
+  const uint64_t success_rate_request_volume = runtime_.snapshot().getInteger(
+      "outlier_detection.success_rate_request_volume", config_.successRateRequestVolume());
+  const double latency_ewma_weight =
+      std::min<uint64_t>(100, runtime_.snapshot().getInteger(
+                                  "outlier_detection.latency_ewma_weight",
+                                  config_.latencyEwmaWeight())) /
+      100.0;
+
+  success_rate_hosts_.clear();
+  success_rates_.clear();
+  latency_hosts_.clear();
+  latencies_.clear();
+
+  // A single pass over the hosts gathers the data of the interval that just ended.
+  for (const auto& host : host_monitors_) {
     checkHostForUneject(host.first, host.second, now);
 
     // Need to update the writer bucket to keep the data valid.
     host.second->updateCurrentSuccessRateBucket();
     // Refresh host success rate stat for the /clusters endpoint. If there is a new valid value, it
-    // will get updated in processSuccessRateEjections().
+    // gets updated below.
     host.second->successRate(-1);
+
+    SuccessRateAccumulator& accumulator = host.second->successRateAccumulator();
+    absl::optional<double> response_time =
+        accumulator.getResponseTime(success_rate_request_volume);
+    if (response_time) {
+      host.second->updateLatency(response_time.value(), latency_ewma_weight);
+    }
+
+    // Don't do work if the host is already ejected.
+    if (!enough_hosts || host.first->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
+      continue;
+    }
+
+    absl::optional<double> success_rate = accumulator.getSuccessRate(success_rate_request_volume);
+    if (success_rate) {
+      host.second->successRate(success_rate.value());
+      success_rate_hosts_.push_back(host.first);
+      success_rates_.push_back(success_rate.value());
+    }
+    if (response_time) {
+      latency_hosts_.push_back(host.first);
+      latencies_.push_back(host.second->latency());
+    }
   }
 
   processSuccessRateEjections();
+  processLatencyEjections();
 
   armIntervalTimer();
 }
@@ -485,6 +574,21 @@ void EventLoggerImpl::logEject(HostDescriptionConstSharedPtr host, Detector& det
     "\"cluster_average_success_rate\": \"{}\", " +
     "\"cluster_success_rate_ejection_threshold\": \"{}\"" +
     "}}\n";
+
+  static const std::string json_latency =
+    std::string("{{") +
+    "\"time\": \"{}\", " +
+    "\"secs_since_last_action\": \"{}\", " +
+    "\"cluster\": \"{}\", " +
+    "\"upstream_url\": \"{}\", " +
+    "\"action\": \"eject\", " +
+    "\"type\": \"{}\", " +
+    "\"num_ejections\": {}, " +
+    "\"enforced\": \"{}\", " +
+    "\"host_latency_ms\": \"{}\", " +
+    "\"cluster_average_latency_ms\": \"{}\", " +
+    "\"cluster_latency_ejection_threshold_ms\": \"{}\"" +
+    "}}\n";
   // clang-format on
   SystemTime now = time_source_.systemTime();
   MonotonicTime monotonic_now = time_source_.monotonicTime();
@@ -506,6 +610,14 @@ void EventLoggerImpl::logEject(HostDescriptionConstSharedPtr host, Detector& det
         host->outlierDetector().numEjections(), enforced, host->outlierDetector().successRate(),
         detector.successRateAverage(), detector.successRateEjectionThreshold()));
     break;
+  case EjectionType::Latency:
+    file_->write(fmt::format(
+        json_latency, AccessLogDateTimeFormatter::fromTime(now),
+        secsSinceLastAction(host->outlierDetector().lastUnejectionTime(), monotonic_now),
+        host->cluster().name(), host->address()->asString(), typeToString(type),
+        host->outlierDetector().numEjections(), enforced, host->outlierDetector().latency(),
+        detector.latencyAverage(), detector.latencyEjectionThreshold()));
+    break;
   }
 }
 
@@ -538,6 +650,8 @@ std::string EventLoggerImpl::typeToString(EjectionType type) {
     return "GatewayFailure";
   case EjectionType::SuccessRate:
     return "SuccessRate";
+  case EjectionType::Latency:
+    return "Latency";
   }
 
   NOT_REACHED_GCOVR_EXCL_LINE;
@@ -555,10 +669,12 @@ SuccessRateAccumulatorBucket* SuccessRateAccumulator::updateCurrentWriter() {
   // Right now current is being written to and backup is not. Flush the backup and swap.
   backup_success_rate_bucket_->success_request_counter_ = 0;
   backup_success_rate_bucket_->total_request_counter_ = 0;
+  backup_success_rate_bucket_->response_time_sum_ms_ = 0;
+  backup_success_rate_bucket_->response_time_counter_ = 0;
 
-  current_success_rate_bucket_.swap(backup_success_rate_bucket_);
+  std::swap(current_success_rate_bucket_, backup_success_rate_bucket_);
 
-  return current_success_rate_bucket_.get();
+  return current_success_rate_bucket_;
 }
 
 absl::optional<double>
@@ -571,6 +687,17 @@ SuccessRateAccumulator::getSuccessRate(uint64_t success_rate_request_volume) {
                                 backup_success_rate_bucket_->total_request_counter_);
 }
 
+absl::optional<double> SuccessRateAccumulator::getResponseTime(uint64_t request_volume) {
+  const uint64_t response_time_counter = backup_success_rate_bucket_->response_time_counter_;
+  if (response_time_counter == 0 || response_time_counter < request_volume) {
+    return absl::optional<double>();
+  }
+
+  return absl::optional<double>(
+      static_cast<double>(backup_success_rate_bucket_->response_time_sum_ms_) /
+      response_time_counter);
+}
+
 } // namespace Outlier
 } // namespace Upstream
 } // namespace Envoy
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -36,6 +37,7 @@ public:
   const absl::optional<MonotonicTime>& lastEjectionTime() override { return time_; }
   const absl::optional<MonotonicTime>& lastUnejectionTime() override { return time_; }
   double successRate() const override { return -1; }
+  double latency() const override { return -1; }
 
 private:
   const absl::optional<MonotonicTime> time_;
@@ -52,31 +54,23 @@ public:
                                             EventLoggerSharedPtr event_logger);
 };
 
-/**
- * Thin struct to facilitate calculations for success rate outlier detection.
- */
-struct HostSuccessRatePair {
-  HostSuccessRatePair(HostSharedPtr host, double success_rate)
-      : host_(host), success_rate_(success_rate) {}
-  HostSharedPtr host_;
-  double success_rate_;
-};
-
 struct SuccessRateAccumulatorBucket {
-  std::atomic<uint64_t> success_request_counter_;
-  std::atomic<uint64_t> total_request_counter_;
+  std::atomic<uint64_t> success_request_counter_{};
+  std::atomic<uint64_t> total_request_counter_{};
+  // Response times are summed by the workers, and averaged once per interval by the main thread.
+  std::atomic<uint64_t> response_time_sum_ms_{};
+  std::atomic<uint64_t> response_time_counter_{};
 };
 
 /**
  * The SuccessRateAccumulator uses the SuccessRateAccumulatorBucket to get per host success rate
- * stats. This implementation has a fixed window size of time, and thus only needs a
- * bucket to write to, and a bucket to accumulate/run stats over.
+ * and latency stats. This implementation has a fixed window size of time, and thus only needs a
+ * bucket to write to, and a bucket to accumulate/run stats over. Both buckets are held inline.
  */
 class SuccessRateAccumulator {
 public:
   SuccessRateAccumulator()
-      : current_success_rate_bucket_(new SuccessRateAccumulatorBucket()),
-        backup_success_rate_bucket_(new SuccessRateAccumulatorBucket()) {}
+      : current_success_rate_bucket_(&buckets_[0]), backup_success_rate_bucket_(&buckets_[1]) {}
 
   /**
    * This function updates the bucket to write data to.
@@ -93,10 +87,20 @@ public:
    * requests, an invalid absl::optional<double> is returned.
    */
   absl::optional<double> getSuccessRate(uint64_t success_rate_request_volume);
+  /**
+   * This function returns the average response time of a host over the same window of time as
+   * getSuccessRate(), if the request volume is high enough.
+   * @param request_volume the threshold of response times an accumulator has to have in order to
+   *                       be able to return a significant average.
+   * @return a valid absl::optional<double> with the average response time in milliseconds. If
+   * there were not enough responses, an invalid absl::optional<double> is returned.
+   */
+  absl::optional<double> getResponseTime(uint64_t request_volume);
 
 private:
-  std::unique_ptr<SuccessRateAccumulatorBucket> current_success_rate_bucket_;
-  std::unique_ptr<SuccessRateAccumulatorBucket> backup_success_rate_bucket_;
+  std::array<SuccessRateAccumulatorBucket, 2> buckets_;
+  SuccessRateAccumulatorBucket* current_success_rate_bucket_;
+  SuccessRateAccumulatorBucket* backup_success_rate_bucket_;
 };
 
 class DetectorImpl;
@@ -117,6 +121,12 @@ public:
   void updateCurrentSuccessRateBucket();
   SuccessRateAccumulator& successRateAccumulator() { return success_rate_accumulator_; }
   void successRate(double new_success_rate) { success_rate_ = new_success_rate; }
+  /**
+   * Fold the average response time of the last interval into the moving average.
+   * @param response_time the average response time of the last interval, in milliseconds.
+   * @param weight the weight of the last interval, in the range 0-1.
+   */
+  void updateLatency(double response_time, double weight);
   void resetConsecutive5xx() { consecutive_5xx_ = 0; }
   void resetConsecutiveGatewayFailure() { consecutive_gateway_failure_ = 0; }
   static Http::Code resultToHttpCode(Result result);
@@ -125,12 +135,13 @@ public:
   uint32_t numEjections() override { return num_ejections_; }
   void putHttpResponseCode(uint64_t response_code) override;
   void putResult(Result result) override;
-  void putResponseTime(std::chrono::milliseconds) override {}
+  void putResponseTime(std::chrono::milliseconds time) override;
   const absl::optional<MonotonicTime>& lastEjectionTime() override { return last_ejection_time_; }
   const absl::optional<MonotonicTime>& lastUnejectionTime() override {
     return last_unejection_time_;
   }
   double successRate() const override { return success_rate_; }
+  double latency() const override { return latency_; }
 
 private:
   std::weak_ptr<DetectorImpl> detector_;
@@ -143,6 +154,8 @@ private:
   SuccessRateAccumulator success_rate_accumulator_;
   std::atomic<SuccessRateAccumulatorBucket*> success_rate_accumulator_bucket_;
   double success_rate_;
+  // Only accessed on the main thread.
+  double latency_{-1};
 };
 
 /**
@@ -161,7 +174,9 @@ private:
   COUNTER(ejections_detected_success_rate)                                                         \
   COUNTER(ejections_enforced_success_rate)                                                         \
   COUNTER(ejections_detected_consecutive_gateway_failure)                                          \
-  COUNTER(ejections_enforced_consecutive_gateway_failure)
+  COUNTER(ejections_enforced_consecutive_gateway_failure)                                          \
+  COUNTER(ejections_detected_latency)                                                              \
+  COUNTER(ejections_enforced_latency)
 // clang-format on
 
 /**
@@ -189,6 +204,9 @@ public:
   uint64_t enforcingConsecutive5xx() { return enforcing_consecutive_5xx_; }
   uint64_t enforcingConsecutiveGatewayFailure() { return enforcing_consecutive_gateway_failure_; }
   uint64_t enforcingSuccessRate() { return enforcing_success_rate_; }
+  uint64_t enforcingLatency() { return enforcing_latency_; }
+  uint64_t latencyStdevFactor() { return latency_stdev_factor_; }
+  uint64_t latencyEwmaWeight() { return latency_ewma_weight_; }
 
 private:
   const uint64_t interval_ms_;
@@ -202,6 +220,9 @@ private:
   const uint64_t enforcing_consecutive_5xx_;
   const uint64_t enforcing_consecutive_gateway_failure_;
   const uint64_t enforcing_success_rate_;
+  const uint64_t enforcing_latency_;
+  const uint64_t latency_stdev_factor_;
+  const uint64_t latency_ewma_weight_;
 };
 
 /**
@@ -226,6 +247,8 @@ public:
   void addChangedStateCb(ChangeStateCb cb) override { callbacks_.push_back(cb); }
   double successRateAverage() const override { return success_rate_average_; }
   double successRateEjectionThreshold() const override { return success_rate_ejection_threshold_; }
+  double latencyAverage() const override { return latency_average_; }
+  double latencyEjectionThreshold() const override { return latency_ejection_threshold_; }
 
 private:
   DetectorImpl(const Cluster& cluster, const envoy::api::v2::cluster::OutlierDetection& config,
@@ -245,6 +268,7 @@ private:
   bool enforceEjection(EjectionType type);
   void updateEnforcedEjectionStats(EjectionType type);
   void processSuccessRateEjections();
+  void processLatencyEjections();
 
   DetectorConfig config_;
   Event::Dispatcher& dispatcher_;
@@ -257,6 +281,15 @@ private:
   EventLoggerSharedPtr event_logger_;
   double success_rate_average_;
   double success_rate_ejection_threshold_;
+  double latency_average_{-1};
+  double latency_ejection_threshold_{-1};
+  // The hosts with enough request volume in the last interval and their success rates and
+  // latencies, gathered in a single pass over the hosts into contiguous arrays that are reduced
+  // in batch. Kept across intervals to reuse their storage.
+  std::vector<HostSharedPtr> success_rate_hosts_;
+  std::vector<double> success_rates_;
+  std::vector<HostSharedPtr> latency_hosts_;
+  std::vector<double> latencies_;
 };
 
 class EventLoggerImpl : public EventLogger {
@@ -292,15 +325,25 @@ public:
    * This function returns an EjectionPair for success rate outlier detection. The pair contains
    * the average success rate of all valid hosts in the cluster and the ejection threshold.
    * If a host's success rate is under this threshold, the host is an outlier.
-   * @param success_rate_sum is the sum of the data in the success_rate_data vector.
-   * @param valid_success_rate_hosts is the vector containing the individual success rate data
-   *        points.
+   * @param success_rate_sum is the sum of the data in the success_rates vector.
+   * @param success_rates is the vector containing the individual success rate data points.
    * @return EjectionPair.
    */
-  static EjectionPair
-  successRateEjectionThreshold(double success_rate_sum,
-                               const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
-                               double success_rate_stdev_factor);
+  static EjectionPair successRateEjectionThreshold(double success_rate_sum,
+                                                   const std::vector<double>& success_rates,
+                                                   double success_rate_stdev_factor);
+
+  /**
+   * This function returns an EjectionPair for latency outlier detection. The pair contains the
+   * average latency of all valid hosts in the cluster and the ejection threshold. If a host's
+   * latency is over this threshold, the host is an outlier.
+   * @param latency_sum is the sum of the data in the latencies vector.
+   * @param latencies is the vector containing the individual latency data points.
+   * @return EjectionPair, whose success_rate_average_ is the average latency.
+   */
+  static EjectionPair latencyEjectionThreshold(double latency_sum,
+                                               const std::vector<double>& latencies,
+                                               double latency_stdev_factor);
 };
 
 } // namespace Outlier
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 
@@ -10,9 +12,19 @@
 
 #include "common/common/assert.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Upstream {
 
+/**
+ * Limit on parallel retries that scales with the active and pending requests of a cluster.
+ */
+struct RetryBudget {
+  double budget_percent_;
+  uint64_t min_retry_concurrency_;
+};
+
 /**
  * Implementation of ResourceManager.
  * NOTE: This implementation makes some assumptions which favor simplicity over correctness.
@@ -26,11 +38,12 @@ class ResourceManagerImpl : public ResourceManager {
 public:
   ResourceManagerImpl(Runtime::Loader& runtime, const std::string& runtime_key,
                       uint64_t max_connections, uint64_t max_pending_requests,
-                      uint64_t max_requests, uint64_t max_retries)
+                      uint64_t max_requests, uint64_t max_retries,
+                      const absl::optional<RetryBudget>& retry_budget = absl::nullopt)
       : connections_(max_connections, runtime, runtime_key + "max_connections"),
         pending_requests_(max_pending_requests, runtime, runtime_key + "max_pending_requests"),
         requests_(max_requests, runtime, runtime_key + "max_requests"),
-        retries_(max_retries, runtime, runtime_key + "max_retries") {}
+        retries_(max_retries, runtime, runtime_key, retry_budget, pending_requests_, requests_) {}
 
   // Upstream::ResourceManager
   Resource& connections() override { return connections_; }
@@ -59,10 +72,45 @@ private:
     const std::string runtime_key_;
   };
 
+  struct RetriesImpl : public ResourceImpl {
+    RetriesImpl(uint64_t max, Runtime::Loader& runtime, const std::string& runtime_key,
+                const absl::optional<RetryBudget>& budget, ResourceImpl& pending_requests,
+                ResourceImpl& requests)
+        : ResourceImpl(max, runtime, runtime_key + "max_retries"), budget_(budget),
+          budget_percent_key_(runtime_key + "retry_budget.budget_percent"),
+          min_retry_concurrency_key_(runtime_key + "retry_budget.min_retry_concurrency"),
+          pending_requests_(pending_requests), requests_(requests) {}
+
+    // Upstream::Resource
+    uint64_t max() override {
+      if (!budget_) {
+        return ResourceImpl::max();
+      }
+
+      const Runtime::Snapshot& snapshot = runtime_.snapshot();
+      // The runtime overrides the configured percentage with a whole one.
+      const uint64_t runtime_percent =
+          snapshot.getInteger(budget_percent_key_, std::numeric_limits<uint64_t>::max());
+      const double budget_percent = runtime_percent == std::numeric_limits<uint64_t>::max()
+                                        ? budget_.value().budget_percent_
+                                        : runtime_percent;
+      const uint64_t min_retry_concurrency =
+          snapshot.getInteger(min_retry_concurrency_key_, budget_.value().min_retry_concurrency_);
+      const uint64_t active = pending_requests_.current_ + requests_.current_;
+      return std::max<uint64_t>(budget_percent / 100 * active, min_retry_concurrency);
+    }
+
+    const absl::optional<RetryBudget> budget_;
+    const std::string budget_percent_key_;
+    const std::string min_retry_concurrency_key_;
+    ResourceImpl& pending_requests_;
+    ResourceImpl& requests_;
+  };
+
   ResourceImpl connections_;
   ResourceImpl pending_requests_;
   ResourceImpl requests_;
-  ResourceImpl retries_;
+  RetriesImpl retries_;
 };
 
 typedef std::unique_ptr<ResourceManagerImpl> ResourceManagerImplPtr;
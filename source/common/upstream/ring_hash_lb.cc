@@ -2,7 +2,9 @@
 
 #include <cstdint>
 #include <iostream>
+#include <limits>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "common/common/assert.h"
@@ -25,42 +27,59 @@ HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h) const {
   if (ring_.empty()) {
     return nullptr;
   }
+  return ring_[position(h)].host_;
+}
 
-  // Ported from https://github.com/RJ/ketama/blob/master/libketama/ketama.c (ketama_get_server)
-  // I've generally kept the variable names to make the code easier to compare.
-  // NOTE: The algorithm depends on using signed integers for lowp, midp, and highp. Do not
-  //       change them!
-  int64_t lowp = 0;
-  int64_t highp = ring_.size();
-  while (true) {
-    int64_t midp = (lowp + highp) / 2;
-
-    if (midp == static_cast<int64_t>(ring_.size())) {
-      return ring_[0].host_;
-    }
+HostConstSharedPtr RingHashLoadBalancer::Ring::chooseNextHost(uint64_t h, uint32_t attempt) const {
+  if (ring_.empty()) {
+    return nullptr;
+  }
+  // Walk clockwise from the entry of the hash, so that the keys of an overloaded host spread over
+  // the hosts that follow its entries.
+  return ring_[(position(h) + attempt) % ring_.size()].host_;
+}
 
-    uint64_t midval = ring_[midp].hash_;
-    uint64_t midval1 = midp == 0 ? 0 : ring_[midp - 1].hash_;
+uint64_t RingHashLoadBalancer::Ring::position(uint64_t h) const {
+  // Find the first entry whose hash is >= h, wrapping around to the first entry of the ring. Each
+  // step descends one level of the implicit tree, to the right if the node's hash is below h.
+  const uint64_t size = ring_.size();
+  uint64_t node = 1;
+  while (node <= size) {
+    node = 2 * node + (lookup_hashes_[node] < h);
+  }
+  // The answer is the last node where the search went left: drop the trailing right turns and
+  // then that left turn.
+  while (node & 1) {
+    node >>= 1;
+  }
+  node >>= 1;
+  return node == 0 ? 0 : lookup_positions_[node];
+}
 
-    if (h <= midval && h > midval1) {
-      return ring_[midp].host_;
-    }
+ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr
+RingHashLoadBalancer::createLoadBalancer(const HostSet& host_set) {
+  if (previous_rings_.size() <= host_set.priority()) {
+    previous_rings_.resize(host_set.priority() + 1);
+  }
+  RingSharedPtr& previous = previous_rings_[host_set.priority()];
 
-    if (midval < h) {
-      lowp = midp + 1;
-    } else {
-      highp = midp - 1;
-    }
+  // Note that we only compute global panic on host set refresh. Given that the runtime setting
+  // will rarely change, this is a reasonable compromise to avoid creating extra LBs when we only
+  // need to create one per priority level.
+  const HostVector& hosts = isGlobalPanic(host_set) ? host_set.hosts() : host_set.healthyHosts();
 
-    if (lowp > highp) {
-      return ring_[0].host_;
-    }
+  // Every priority is refreshed when any of them changes, so the ring of an untouched priority
+  // can be shared as is.
+  if (previous == nullptr || previous->hosts_ != hosts) {
+    previous = std::make_shared<Ring>(config_, hosts, previous.get());
   }
+  return previous;
 }
 
 RingHashLoadBalancer::Ring::Ring(
     const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& config,
-    const HostVector& hosts) {
+    const HostVector& hosts, const Ring* previous)
+    : hosts_(hosts) {
   ENVOY_LOG(trace, "ring hash: building ring");
   if (hosts.empty()) {
     return;
@@ -69,69 +88,130 @@ RingHashLoadBalancer::Ring::Ring(
   // Currently we specify the minimum size of the ring, and determine the replication factor
   // based on the number of hosts. It's possible we might want to support more sophisticated
   // configuration in the future.
-  // NOTE: Currently we keep a ring for healthy hosts and unhealthy hosts, and this is done per
-  //       thread. This is the simplest implementation, but it's expensive from a memory
-  //       standpoint and duplicates the regeneration computation. In the future we might want
-  //       to generate the rings centrally and then just RCU them out to each thread. This is
-  //       sufficient for getting started.
   const uint64_t min_ring_size =
       config ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.value(), minimum_ring_size, 1024) : 1024;
 
-  uint64_t hashes_per_host = 1;
+  hashes_per_host_ = 1;
   if (hosts.size() < min_ring_size) {
-    hashes_per_host = min_ring_size / hosts.size();
+    hashes_per_host_ = min_ring_size / hosts.size();
     if ((min_ring_size % hosts.size()) != 0) {
-      hashes_per_host++;
+      hashes_per_host_++;
     }
   }
 
-  ENVOY_LOG(info, "ring hash: min_ring_size={} hashes_per_host={}", min_ring_size, hashes_per_host);
-  ring_.reserve(hosts.size() * hashes_per_host);
+  ENVOY_LOG(info, "ring hash: min_ring_size={} hashes_per_host={}", min_ring_size,
+            hashes_per_host_);
+  ring_.reserve(hosts.size() * hashes_per_host_);
 
   const bool use_std_hash =
       config ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.value().deprecated_v1(), use_std_hash, true)
              : true;
 
-  char hash_key_buffer[196];
-  for (const auto& host : hosts) {
-    const std::string& address_string = host->address()->asString();
-    uint64_t offset_start = address_string.size();
-
-    // Currently, we support both IP and UDS addresses. The UDS max path length is ~108 on all Unix
-    // platforms that I know of. Given that, we can use a 196 char buffer which is plenty of room
-    // for UDS, '_', and up to 21 characters for the node ID. To be on the super safe side, there
-    // is a RELEASE_ASSERT here that checks this, in case someone in the future adds some type of
-    // new address that is larger, or runs on a platform where UDS is larger. I don't think it's
-    // worth the defensive coding to deal with the heap allocation case (e.g. via
-    // absl::InlinedVector) at the current time.
-    RELEASE_ASSERT(
-        address_string.size() + 1 + StringUtil::MIN_ITOA_OUT_LEN <= sizeof(hash_key_buffer), "");
-    memcpy(hash_key_buffer, address_string.c_str(), offset_start);
-    hash_key_buffer[offset_start++] = '_';
-    for (uint64_t i = 0; i < hashes_per_host; i++) {
-      const uint64_t total_hash_key_len =
-          offset_start +
-          StringUtil::itoa(hash_key_buffer + offset_start, StringUtil::MIN_ITOA_OUT_LEN, i);
-      absl::string_view hash_key(hash_key_buffer, total_hash_key_len);
-
-      // Sadly std::hash provides no mechanism for hashing arbitrary bytes so we must copy here.
-      // xxHash is done wihout copies.
-      const uint64_t hash = use_std_hash ? std::hash<std::string>()(std::string(hash_key))
-                                         : HashUtil::xxHash64(hash_key);
-      ENVOY_LOG(trace, "ring hash: hash_key={} hash={}", hash_key.data(), hash);
-      ring_.push_back({hash, host});
+  // A host's entries only depend on its address and the number of hashes per host, so when the
+  // latter did not change the previous ring can be reused for all hosts it already contains.
+  if (previous != nullptr && previous->hashes_per_host_ == hashes_per_host_) {
+    buildIncremental(*previous, use_std_hash);
+  } else {
+    for (const auto& host : hosts) {
+      addHostEntries(host, use_std_hash, ring_);
     }
+    std::sort(ring_.begin(), ring_.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
+      return lhs.hash_ < rhs.hash_;
+    });
   }
 
-  std::sort(ring_.begin(), ring_.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
-    return lhs.hash_ < rhs.hash_;
-  });
   if (ENVOY_LOG_CHECK_LEVEL(trace)) {
     for (const auto& entry : ring_) {
       ENVOY_LOG(trace, "ring hash: host={} hash={}", entry.host_->address()->asString(),
                 entry.hash_);
     }
   }
+
+  RELEASE_ASSERT(ring_.size() < std::numeric_limits<uint32_t>::max(), "");
+  lookup_hashes_.resize(ring_.size() + 1);
+  lookup_positions_.resize(ring_.size() + 1);
+  buildLookupTable(0, 1);
+}
+
+uint64_t RingHashLoadBalancer::Ring::buildLookupTable(uint64_t position, uint64_t node) {
+  // An in-order walk of the implicit tree visits the nodes in sorted order.
+  if (node <= ring_.size()) {
+    position = buildLookupTable(position, 2 * node);
+    lookup_hashes_[node] = ring_[position].hash_;
+    lookup_positions_[node] = position++;
+    position = buildLookupTable(position, 2 * node + 1);
+  }
+  return position;
+}
+
+void RingHashLoadBalancer::Ring::addHostEntries(const HostConstSharedPtr& host, bool use_std_hash,
+                                                std::vector<RingEntry>& entries) const {
+  char hash_key_buffer[196];
+  const std::string& address_string = host->address()->asString();
+  uint64_t offset_start = address_string.size();
+
+  // Currently, we support both IP and UDS addresses. The UDS max path length is ~108 on all Unix
+  // platforms that I know of. Given that, we can use a 196 char buffer which is plenty of room
+  // for UDS, '_', and up to 21 characters for the node ID. To be on the super safe side, there
+  // is a RELEASE_ASSERT here that checks this, in case someone in the future adds some type of
+  // new address that is larger, or runs on a platform where UDS is larger. I don't think it's
+  // worth the defensive coding to deal with the heap allocation case (e.g. via
+  // absl::InlinedVector) at the current time.
+  RELEASE_ASSERT(
+      address_string.size() + 1 + StringUtil::MIN_ITOA_OUT_LEN <= sizeof(hash_key_buffer), "");
+  memcpy(hash_key_buffer, address_string.c_str(), offset_start);
+  hash_key_buffer[offset_start++] = '_';
+  for (uint64_t i = 0; i < hashes_per_host_; i++) {
+    const uint64_t total_hash_key_len =
+        offset_start +
+        StringUtil::itoa(hash_key_buffer + offset_start, StringUtil::MIN_ITOA_OUT_LEN, i);
+    absl::string_view hash_key(hash_key_buffer, total_hash_key_len);
+
+    // Sadly std::hash provides no mechanism for hashing arbitrary bytes so we must copy here.
+    // xxHash is done wihout copies.
+    const uint64_t hash = use_std_hash ? std::hash<std::string>()(std::string(hash_key))
+                                       : HashUtil::xxHash64(hash_key);
+    ENVOY_LOG(trace, "ring hash: hash_key={} hash={}", hash_key.data(), hash);
+    entries.push_back({hash, host});
+  }
+}
+
+void RingHashLoadBalancer::Ring::buildIncremental(const Ring& previous, bool use_std_hash) {
+  std::unordered_set<const Host*> current_hosts;
+  for (const auto& host : hosts_) {
+    current_hosts.insert(host.get());
+  }
+  std::unordered_set<const Host*> previous_hosts;
+  for (const auto& host : previous.hosts_) {
+    previous_hosts.insert(host.get());
+  }
+
+  // Only the hosts that are new to this ring are hashed and sorted.
+  std::vector<RingEntry> added;
+  for (const auto& host : hosts_) {
+    if (previous_hosts.count(host.get()) == 0) {
+      addHostEntries(host, use_std_hash, added);
+    }
+  }
+  std::sort(added.begin(), added.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
+    return lhs.hash_ < rhs.hash_;
+  });
+  ENVOY_LOG(debug, "ring hash: incremental rebuild added={} previous_size={}", added.size(),
+            previous.ring_.size());
+
+  // The previous ring is already sorted, so dropping the entries of removed hosts and merging in
+  // the new entries keeps the ring sorted in a single pass.
+  auto next_added = added.begin();
+  for (const RingEntry& entry : previous.ring_) {
+    if (current_hosts.count(entry.host_.get()) == 0) {
+      continue;
+    }
+    while (next_added != added.end() && next_added->hash_ < entry.hash_) {
+      ring_.push_back(*next_added++);
+    }
+    ring_.push_back(entry);
+  }
+  ring_.insert(ring_.end(), next_added, added.end());
 }
 
 } // namespace Upstream
@@ -17,7 +17,8 @@ namespace Upstream {
  * In the future it would be nice to support:
  * 1) Weighting.
  * 2) Per-zone rings and optional zone aware routing (not all applications will want this).
- * 3) Max request fallback to support hot shards (not all applications will want this).
+ * Hot shards can be spread with consistent hashing with bounded loads, which walks the ring from
+ * an overloaded host to the next ones.
  */
 class RingHashLoadBalancer : public ThreadAwareLoadBalancerBase,
                              Logger::Loggable<Logger::Id::upstream> {
@@ -34,29 +35,43 @@ private:
   };
 
   struct Ring : public HashingLoadBalancer {
+    /**
+     * Build a ring for hosts. If previous is not null and was built with the same number of
+     * hashes per host, only the entries of hosts that were added since previous are hashed, and
+     * they are merged into the still valid entries of previous rather than sorting the whole ring.
+     */
     Ring(const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& config,
-         const HostVector& hosts);
+         const HostVector& hosts, const Ring* previous);
 
     // ThreadAwareLoadBalancerBase::HashingLoadBalancer
     HostConstSharedPtr chooseHost(uint64_t hash) const override;
+    HostConstSharedPtr chooseNextHost(uint64_t hash, uint32_t attempt) const override;
 
+    // The position in ring_ of the first entry whose hash is >= hash. ring_ must not be empty.
+    uint64_t position(uint64_t hash) const;
+    void addHostEntries(const HostConstSharedPtr& host, bool use_std_hash,
+                        std::vector<RingEntry>& entries) const;
+    void buildIncremental(const Ring& previous, bool use_std_hash);
+    uint64_t buildLookupTable(uint64_t position, uint64_t node);
+
+    const HostVector hosts_;
+    uint64_t hashes_per_host_{};
     std::vector<RingEntry> ring_;
+    // The hashes of ring_ in Eytzinger (breadth first) order, starting at index 1, so the top
+    // levels of a search share a few cache lines instead of each probe touching a RingEntry.
+    // lookup_positions_[i] is the position in ring_ of lookup_hashes_[i].
+    std::vector<uint64_t> lookup_hashes_;
+    std::vector<uint32_t> lookup_positions_;
   };
-  typedef std::shared_ptr<const Ring> RingConstSharedPtr;
+  typedef std::shared_ptr<Ring> RingSharedPtr;
 
   // ThreadAwareLoadBalancerBase
-  HashingLoadBalancerSharedPtr createLoadBalancer(const HostSet& host_set) override {
-    // Note that we only compute global panic on host set refresh. Given that the runtime setting
-    // will rarely change, this is a reasonable compromise to avoid creating extra LBs when we only
-    // need to create one per priority level.
-    if (isGlobalPanic(host_set)) {
-      return std::make_shared<Ring>(config_, host_set.hosts());
-    } else {
-      return std::make_shared<Ring>(config_, host_set.healthyHosts());
-    }
-  }
+  HashingLoadBalancerSharedPtr createLoadBalancer(const HostSet& host_set) override;
 
   const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& config_;
+  // The most recently built ring for each priority, used as the base of the next rebuild. Only
+  // accessed from the main thread.
+  std::vector<RingSharedPtr> previous_rings_;
 };
 
 } // namespace Upstream
@@ -21,8 +21,10 @@ SubsetLoadBalancer::SubsetLoadBalancer(
     ClusterStats& stats, Runtime::Loader& runtime, Runtime::RandomGenerator& random,
     const LoadBalancerSubsetInfo& subsets,
     const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& lb_ring_hash_config,
+    const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig>& least_request_config,
     const envoy::api::v2::Cluster::CommonLbConfig& common_config)
-    : lb_type_(lb_type), lb_ring_hash_config_(lb_ring_hash_config), common_config_(common_config),
+    : lb_type_(lb_type), lb_ring_hash_config_(lb_ring_hash_config),
+      least_request_config_(least_request_config), common_config_(common_config),
       stats_(stats), runtime_(runtime), random_(random), fallback_policy_(subsets.fallbackPolicy()),
       default_subset_metadata_(subsets.defaultSubset().fields().begin(),
                                subsets.defaultSubset().fields().end()),
@@ -37,19 +39,19 @@ SubsetLoadBalancer::SubsetLoadBalancer(
   // Configure future updates.
   original_priority_set_callback_handle_ = priority_set.addMemberUpdateCb(
       [this](uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed) {
-        if (!hosts_added.size() && !hosts_removed.size()) {
+        const bool metadata_changed = snapshotHostMetadata(priority, hosts_removed);
+        if ((!hosts_added.size() && !hosts_removed.size()) || metadata_changed) {
           // It's possible that metadata changed, without hosts being added nor removed.
           // If so we need to add any new subsets, remove unused ones, and regroup hosts into
           // the right subsets.
           //
-          // Note, note, note: if metadata for existing endpoints changed _and_ hosts were also
-          // added or removed, we don't need to hit this path. That's fine, given that
-          // findOrCreateSubset() will be called from processSubsets because it'll be triggered by
-          // either hosts_added or hosts_removed. That's where the new subsets will be created.
+          // Subsets track their members incrementally from the deltas, so if metadata for
+          // existing endpoints changed _and_ hosts were also added or removed we must take this
+          // path as well: the deltas alone would leave the changed hosts in their old subsets.
           refreshSubsets(priority);
         } else {
           // This is a regular update with deltas.
-          update(priority, hosts_added, hosts_removed);
+          update(priority, hosts_added, hosts_removed, false);
         }
       });
 }
@@ -68,14 +70,40 @@ SubsetLoadBalancer::~SubsetLoadBalancer() {
 
 void SubsetLoadBalancer::refreshSubsets() {
   for (auto& host_set : original_priority_set_.hostSetsPerPriority()) {
-    update(host_set->priority(), host_set->hosts(), {});
+    snapshotHostMetadata(host_set->priority(), {});
+    update(host_set->priority(), host_set->hosts(), {}, true);
   }
 }
 
 void SubsetLoadBalancer::refreshSubsets(uint32_t priority) {
   const auto& host_sets = original_priority_set_.hostSetsPerPriority();
   ASSERT(priority < host_sets.size());
-  update(priority, host_sets[priority]->hosts(), {});
+  update(priority, host_sets[priority]->hosts(), {}, true);
+}
+
+// Records the metadata of each host at the given priority and forgets the removed hosts. Returns
+// true if a previously recorded host's metadata has been replaced since the last snapshot. Host
+// metadata is replaced rather than mutated, so this only compares pointers.
+bool SubsetLoadBalancer::snapshotHostMetadata(uint32_t priority, const HostVector& hosts_removed) {
+  for (const auto& host : hosts_removed) {
+    host_metadata_.erase(host);
+  }
+
+  bool changed = false;
+  const auto& host_sets = original_priority_set_.hostSetsPerPriority();
+  ASSERT(priority < host_sets.size());
+  for (const auto& host : host_sets[priority]->hosts()) {
+    auto metadata = host->metadata();
+    auto it = host_metadata_.find(host);
+    if (it == host_metadata_.end()) {
+      host_metadata_.emplace(host, std::move(metadata));
+    } else if (it->second != metadata) {
+      it->second = std::move(metadata);
+      changed = true;
+    }
+  }
+
+  return changed;
 }
 
 HostConstSharedPtr SubsetLoadBalancer::chooseHost(LoadBalancerContext* context) {
@@ -109,7 +137,7 @@ HostConstSharedPtr SubsetLoadBalancer::tryChooseHostFromContext(LoadBalancerCont
   }
 
   // Route has metadata match criteria defined, see if we have a matching subset.
-  LbSubsetEntryPtr entry = findSubset(match_criteria->metadataMatchCriteria());
+  LbSubsetEntryPtr entry = findSubset(*match_criteria);
   if (entry == nullptr || !entry->active()) {
     // No matching subset or subset not active: use fallback policy.
     return nullptr;
@@ -120,45 +148,42 @@ HostConstSharedPtr SubsetLoadBalancer::tryChooseHostFromContext(LoadBalancerCont
   return entry->priority_subset_->lb_->chooseHost(context);
 }
 
-// Iterates over the given metadata match criteria (which must be lexically sorted by key) and find
-// a matching LbSubsetEnryPtr, if any.
-SubsetLoadBalancer::LbSubsetEntryPtr SubsetLoadBalancer::findSubset(
-    const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& match_criteria) {
-  const LbSubsetMap* subsets = &subsets_;
-
-  // Because the match_criteria and the host metadata used to populate subsets_ are sorted in the
-  // same order, we can iterate over the criteria and perform a lookup for each key and value,
-  // starting with the root LbSubsetMap and using the previous iteration's LbSubsetMap thereafter
-  // (tracked in subsets). If ever a criterion's key or value is not found, there is no subset for
-  // this criteria. If we reach the last criterion, we've found the LbSubsetEntry for the criteria,
-  // which may or may not have a subset attached to it.
-  for (uint32_t i = 0; i < match_criteria.size(); i++) {
-    const Router::MetadataMatchCriterion& match_criterion = *match_criteria[i];
-    const auto& subset_it = subsets->find(match_criterion.name());
-    if (subset_it == subsets->end()) {
-      // No subsets with this key (at this level in the hierarchy).
-      break;
+// Finds the initialized LbSubsetEntryPtr whose metadata equals the given match criteria (which
+// must be lexically sorted by key), if any. Candidates come from a single lookup of the criteria's
+// precomputed hash in subset_index_ and are then compared key by key to rule out collisions.
+SubsetLoadBalancer::LbSubsetEntryPtr
+SubsetLoadBalancer::findSubset(const Router::MetadataMatchCriteria& match_criteria) {
+  const auto& criteria = match_criteria.metadataMatchCriteria();
+  const auto range = subset_index_.equal_range(match_criteria.hash());
+  for (auto it = range.first; it != range.second; ++it) {
+    const SubsetMetadata& kvs = it->second->kvs_;
+    if (kvs.size() != criteria.size()) {
+      continue;
     }
 
-    const ValueSubsetMap& vs_map = subset_it->second;
-    const auto& vs_it = vs_map.find(match_criterion.value());
-    if (vs_it == vs_map.end()) {
-      // No subsets with this value.
-      break;
+    bool matches = true;
+    for (uint32_t i = 0; i < criteria.size() && matches; i++) {
+      matches = kvs[i].first == criteria[i]->name() && kvs[i].second == criteria[i]->value();
     }
 
-    const LbSubsetEntryPtr& entry = vs_it->second;
-    if (i + 1 == match_criteria.size()) {
-      // We've reached the end of the criteria, and they all matched.
-      return entry;
+    if (matches) {
+      return it->second;
     }
-
-    subsets = &entry->children_;
   }
 
   return nullptr;
 }
 
+// Hashes the given lexically sorted metadata the same way Router::MetadataMatchCriteria::hash()
+// hashes route criteria.
+uint64_t SubsetLoadBalancer::subsetHash(const SubsetMetadata& kvs) {
+  uint64_t hash = 0;
+  for (const auto& kv : kvs) {
+    hash = HashedValue::combine(hash, kv.first, kv.second);
+  }
+  return hash;
+}
+
 void SubsetLoadBalancer::updateFallbackSubset(uint32_t priority, const HostVector& hosts_added,
                                               const HostVector& hosts_removed) {
   if (fallback_policy_ == envoy::api::v2::Cluster::LbSubsetConfig::NO_FALLBACK) {
@@ -188,19 +213,22 @@ void SubsetLoadBalancer::updateFallbackSubset(uint32_t priority, const HostVecto
   }
 
   // Subsequent updates: add/remove hosts.
-  fallback_subset_->priority_subset_->update(priority, hosts_added, hosts_removed);
+  fallback_subset_->priority_subset_->update(priority, hosts_added, hosts_removed, false);
 }
 
 // Iterates over the added and removed hosts, looking up an LbSubsetEntryPtr for each. For every
 // unique LbSubsetEntryPtr found, it either invokes new_cb or update_cb depending on whether the
-// LbSubsetEntryPtr is already initialized (update_cb) or not (new_cb). In addition, update_cb is
-// invoked for any otherwise unmodified but active and initialized LbSubsetEntryPtr to allow host
+// LbSubsetEntryPtr is already initialized (update_cb) or not (new_cb). update_cb receives only the
+// added and removed hosts that belong to that entry. In addition, update_cb is invoked with no
+// hosts for any otherwise unmodified but active and initialized LbSubsetEntryPtr to allow host
 // health to be updated.
 void SubsetLoadBalancer::processSubsets(
     const HostVector& hosts_added, const HostVector& hosts_removed,
-    std::function<void(LbSubsetEntryPtr)> update_cb,
+    std::function<void(LbSubsetEntryPtr, const HostVector&, const HostVector&)> update_cb,
     std::function<void(LbSubsetEntryPtr, HostPredicate, const SubsetMetadata&, bool)> new_cb) {
   std::unordered_set<LbSubsetEntryPtr> subsets_modified;
+  // Per-entry added and removed hosts for entries that were initialized before this update.
+  std::unordered_map<LbSubsetEntryPtr, std::pair<HostVector, HostVector>> subset_deltas;
 
   std::pair<const HostVector&, bool> steps[] = {{hosts_added, true}, {hosts_removed, false}};
   for (const auto& step : steps) {
@@ -215,25 +243,39 @@ void SubsetLoadBalancer::processSubsets(
         if (!kvs.empty()) {
           // The host has metadata for each key, find or create its subset.
           LbSubsetEntryPtr entry = findOrCreateSubset(subsets_, kvs, 0);
-          if (subsets_modified.find(entry) != subsets_modified.end()) {
-            // We've already invoked the callback for this entry.
-            continue;
+          auto delta_it = subset_deltas.find(entry);
+          if (delta_it == subset_deltas.end()) {
+            if (!subsets_modified.emplace(entry).second) {
+              // We've already created this entry from the complete host set.
+              continue;
+            }
+
+            if (!entry->initialized()) {
+              HostPredicate predicate =
+                  std::bind(&SubsetLoadBalancer::hostMatches, this, kvs, std::placeholders::_1);
+
+              new_cb(entry, predicate, kvs, adding_hosts);
+              continue;
+            }
+
+            delta_it =
+                subset_deltas.emplace(entry, std::make_pair(HostVector(), HostVector())).first;
           }
-          subsets_modified.emplace(entry);
 
-          if (entry->initialized()) {
-            update_cb(entry);
+          if (adding_hosts) {
+            delta_it->second.first.emplace_back(host);
           } else {
-            HostPredicate predicate =
-                std::bind(&SubsetLoadBalancer::hostMatches, this, kvs, std::placeholders::_1);
-
-            new_cb(entry, predicate, kvs, adding_hosts);
+            delta_it->second.second.emplace_back(host);
           }
         }
       }
     }
   }
 
+  for (const auto& delta : subset_deltas) {
+    update_cb(delta.first, delta.second.first, delta.second.second);
+  }
+
   forEachSubset(subsets_, [&](LbSubsetEntryPtr entry) {
     if (subsets_modified.find(entry) != subsets_modified.end()) {
       // Already handled due to hosts being added or removed.
@@ -241,7 +283,7 @@ void SubsetLoadBalancer::processSubsets(
     }
 
     if (entry->initialized() && entry->active()) {
-      update_cb(entry);
+      update_cb(entry, {}, {});
     }
   });
 }
@@ -249,13 +291,17 @@ void SubsetLoadBalancer::processSubsets(
 // Given the addition and/or removal of hosts, update all subsets for this priority level, creating
 // new subsets as necessary.
 void SubsetLoadBalancer::update(uint32_t priority, const HostVector& hosts_added,
-                                const HostVector& hosts_removed) {
+                                const HostVector& hosts_removed, bool full_refresh) {
   updateFallbackSubset(priority, hosts_added, hosts_removed);
 
   processSubsets(hosts_added, hosts_removed,
-                 [&](LbSubsetEntryPtr entry) {
+                 [&](LbSubsetEntryPtr entry, const HostVector& entry_hosts_added,
+                     const HostVector& entry_hosts_removed) {
+                   // On a full refresh entry_hosts_added is every host at this priority that
+                   // belongs to the entry, so it replaces the previous membership.
                    const bool active_before = entry->active();
-                   entry->priority_subset_->update(priority, hosts_added, hosts_removed);
+                   entry->priority_subset_->update(priority, entry_hosts_added,
+                                                   entry_hosts_removed, full_refresh);
 
                    if (active_before && !entry->active()) {
                      stats_.lb_subsets_active_.dec();
@@ -267,7 +313,6 @@ void SubsetLoadBalancer::update(uint32_t priority, const HostVector& hosts_added
                  },
                  [&](LbSubsetEntryPtr entry, HostPredicate predicate, const SubsetMetadata& kvs,
                      bool adding_host) {
-                   UNREFERENCED_PARAMETER(kvs);
                    if (adding_host) {
                      ENVOY_LOG(debug, "subset lb: creating load balancer for {}",
                                describeMetadata(kvs));
@@ -277,6 +322,9 @@ void SubsetLoadBalancer::update(uint32_t priority, const HostVector& hosts_added
                      // uninitialized.)
                      entry->priority_subset_.reset(
                          new PrioritySubsetImpl(*this, predicate, locality_weight_aware_));
+                     // HashedValue isn't assignable, so the entry's metadata is moved in.
+                     entry->kvs_ = SubsetMetadata(kvs);
+                     subset_index_.emplace(subsetHash(kvs), entry);
                      stats_.lb_subsets_active_.inc();
                      stats_.lb_subsets_created_.inc();
                    }
@@ -284,24 +332,11 @@ void SubsetLoadBalancer::update(uint32_t priority, const HostVector& hosts_added
 }
 
 bool SubsetLoadBalancer::hostMatches(const SubsetMetadata& kvs, const Host& host) {
-  const envoy::api::v2::core::Metadata& host_metadata = *host.metadata();
-  const auto filter_it =
-      host_metadata.filter_metadata().find(Config::MetadataFilters::get().ENVOY_LB);
-
-  if (filter_it == host_metadata.filter_metadata().end()) {
-    return kvs.size() == 0;
-  }
-
-  const ProtobufWkt::Struct& data_struct = filter_it->second;
-  const auto& fields = data_struct.fields();
-
+  const LbMetadataConstSharedPtr lb_metadata = host.lbMetadata();
   for (const auto& kv : kvs) {
-    const auto entry_it = fields.find(kv.first);
-    if (entry_it == fields.end()) {
-      return false;
-    }
-
-    if (!ValueUtil::equal(entry_it->second, kv.second)) {
+    const auto entry_it = lb_metadata->find(kv.first);
+    // Values with different hashes are compared without looking at them.
+    if (entry_it == lb_metadata->end() || entry_it->second != kv.second) {
       return false;
     }
   }
@@ -316,19 +351,13 @@ SubsetLoadBalancer::extractSubsetMetadata(const std::set<std::string>& subset_ke
                                           const Host& host) {
   SubsetMetadata kvs;
 
-  const envoy::api::v2::core::Metadata& metadata = *host.metadata();
-  const auto& filter_it = metadata.filter_metadata().find(Config::MetadataFilters::get().ENVOY_LB);
-  if (filter_it == metadata.filter_metadata().end()) {
-    return kvs;
-  }
-
-  const auto& fields = filter_it->second.fields();
-  for (const auto key : subset_keys) {
-    const auto it = fields.find(key);
-    if (it == fields.end()) {
+  const LbMetadataConstSharedPtr lb_metadata = host.lbMetadata();
+  for (const auto& key : subset_keys) {
+    const auto it = lb_metadata->find(key);
+    if (it == lb_metadata->end()) {
       break;
     }
-    kvs.emplace_back(std::pair<std::string, ProtobufWkt::Value>(key, it->second));
+    kvs.emplace_back(key, it->second);
   }
 
   if (kvs.size() != subset_keys.size()) {
@@ -352,7 +381,7 @@ std::string SubsetLoadBalancer::describeMetadata(const SubsetLoadBalancer::Subse
       first = false;
     }
 
-    buf << it.first << "=" << MessageUtil::getJsonStringFromMessage(it.second);
+    buf << it.first << "=" << MessageUtil::getJsonStringFromMessage(it.second.value());
   }
 
   return buf.str();
@@ -366,8 +395,7 @@ SubsetLoadBalancer::findOrCreateSubset(LbSubsetMap& subsets, const SubsetMetadat
   ASSERT(idx < kvs.size());
 
   const std::string& name = kvs[idx].first;
-  const ProtobufWkt::Value& pb_value = kvs[idx].second;
-  const HashedValue value(pb_value);
+  const HashedValue& value = kvs[idx].second;
   LbSubsetEntryPtr entry;
 
   const auto& kv_it = subsets.find(name);
@@ -425,14 +453,15 @@ SubsetLoadBalancer::PrioritySubsetImpl::PrioritySubsetImpl(const SubsetLoadBalan
   }
 
   for (size_t i = 0; i < subset_lb.original_priority_set_.hostSetsPerPriority().size(); ++i) {
-    update(i, subset_lb.original_priority_set_.hostSetsPerPriority()[i]->hosts(), {});
+    update(i, subset_lb.original_priority_set_.hostSetsPerPriority()[i]->hosts(), {}, true);
   }
 
   switch (subset_lb.lb_type_) {
   case LoadBalancerType::LeastRequest:
     lb_.reset(new LeastRequestLoadBalancer(*this, subset_lb.original_local_priority_set_,
                                            subset_lb.stats_, subset_lb.runtime_, subset_lb.random_,
-                                           subset_lb.common_config_));
+                                           subset_lb.common_config_,
+                                           subset_lb.least_request_config_));
     break;
 
   case LoadBalancerType::Random:
@@ -475,25 +504,32 @@ SubsetLoadBalancer::PrioritySubsetImpl::PrioritySubsetImpl(const SubsetLoadBalan
   triggerCallbacks();
 }
 
-// Given hosts_added and hosts_removed, update the underlying HostSet. The hosts_added Hosts must
-// be filtered to match hosts that belong in this subset. The hosts_removed Hosts are ignored if
-// they are not currently a member of this subset.
+// Given hosts_added and hosts_removed, update the underlying HostSet. The hosts_added Hosts are
+// filtered by the predicate to find hosts that belong in this subset; any that no longer match
+// leave it. The hosts_removed Hosts are ignored if they are not currently a member of this subset.
+// If replace_members is true, hosts_added is the complete list of candidate hosts and any other
+// current members are dropped.
 void SubsetLoadBalancer::HostSubsetImpl::update(const HostVector& hosts_added,
                                                 const HostVector& hosts_removed,
-                                                std::function<bool(const Host&)> predicate) {
-  std::unordered_set<HostSharedPtr> predicate_added;
+                                                std::function<bool(const Host&)> predicate,
+                                                bool replace_members) {
+  if (replace_members) {
+    members_.clear();
+  }
 
   HostVector filtered_added;
-  for (const auto host : hosts_added) {
+  for (const auto& host : hosts_added) {
     if (predicate(*host)) {
-      predicate_added.insert(host);
+      members_.emplace(host.get(), host);
       filtered_added.emplace_back(host);
+    } else {
+      members_.erase(host.get());
     }
   }
 
   HostVector filtered_removed;
-  for (const auto host : hosts_removed) {
-    if (predicate(*host)) {
+  for (const auto& host : hosts_removed) {
+    if (members_.erase(host.get()) == 1) {
       filtered_removed.emplace_back(host);
     }
   }
@@ -501,12 +537,11 @@ void SubsetLoadBalancer::HostSubsetImpl::update(const HostVector& hosts_added,
   HostVectorSharedPtr hosts(new HostVector());
   HostVectorSharedPtr healthy_hosts(new HostVector());
 
-  // It's possible that hosts_added == original_host_set_.hosts(), e.g.: when
-  // calling refreshSubsets() if only metadata change. If so, we can avoid the
-  // predicate() call.
-  for (const auto host : original_host_set_.hosts()) {
-    bool host_seen = predicate_added.count(host) == 1;
-    if (host_seen || predicate(*host)) {
+  // Membership is maintained incrementally from the deltas above, so rebuilding the host lists
+  // only needs a lookup per host rather than a predicate() call with its metadata lookups.
+  const auto is_member = [this](const Host& host) { return members_.count(&host) == 1; };
+  for (const auto& host : original_host_set_.hosts()) {
+    if (is_member(*host)) {
       hosts->emplace_back(host);
       if (host->healthy()) {
         healthy_hosts->emplace_back(host);
@@ -514,21 +549,15 @@ void SubsetLoadBalancer::HostSubsetImpl::update(const HostVector& hosts_added,
     }
   }
 
-  // Calling predicate() is expensive since it involves metadata lookups; so we
-  // avoid it in the 2nd call to filter() by using the result from the first call
-  // to filter() as the starting point.
-  //
-  // Also, if we only have one locality we can avoid the first call to filter() by
-  // just creating a new HostsPerLocality from the list of all hosts.
-  //
-  // TODO(rgs1): merge these two filter() calls in one loop.
+  // If we only have one locality we can avoid the call to filter() by just creating a new
+  // HostsPerLocality from the list of all hosts.
   HostsPerLocalityConstSharedPtr hosts_per_locality;
 
   if (original_host_set_.hostsPerLocality().get().size() == 1) {
     hosts_per_locality.reset(
         new HostsPerLocalityImpl(*hosts, original_host_set_.hostsPerLocality().hasLocalLocality()));
   } else {
-    hosts_per_locality = original_host_set_.hostsPerLocality().filter(predicate);
+    hosts_per_locality = original_host_set_.hostsPerLocality().filter(is_member);
   }
 
   HostsPerLocalityConstSharedPtr healthy_hosts_per_locality =
@@ -558,9 +587,10 @@ HostSetImplPtr SubsetLoadBalancer::PrioritySubsetImpl::createHostSet(
 
 void SubsetLoadBalancer::PrioritySubsetImpl::update(uint32_t priority,
                                                     const HostVector& hosts_added,
-                                                    const HostVector& hosts_removed) {
+                                                    const HostVector& hosts_removed,
+                                                    bool replace_members) {
   HostSubsetImpl* host_subset = getOrCreateHostSubset(priority);
-  host_subset->update(hosts_added, hosts_removed, predicate_);
+  host_subset->update(hosts_added, hosts_removed, predicate_, replace_members);
 
   if (host_subset->hosts().empty() != empty_) {
     empty_ = true;
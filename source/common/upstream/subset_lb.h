@@ -26,6 +26,8 @@ public:
       ClusterStats& stats, Runtime::Loader& runtime, Runtime::RandomGenerator& random,
       const LoadBalancerSubsetInfo& subsets,
       const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>& lb_ring_hash_config,
+      const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig>&
+          least_request_config,
       const envoy::api::v2::Cluster::CommonLbConfig& common_config);
   ~SubsetLoadBalancer();
 
@@ -43,7 +45,7 @@ private:
           original_host_set_(original_host_set), locality_weight_aware_(locality_weight_aware) {}
 
     void update(const HostVector& hosts_added, const HostVector& hosts_removed,
-                HostPredicate predicate);
+                HostPredicate predicate, bool replace_members);
 
     void triggerCallbacks() { HostSetImpl::runUpdateCallbacks({}, {}); }
     bool empty() { return hosts().empty(); }
@@ -51,6 +53,9 @@ private:
   private:
     const HostSet& original_host_set_;
     const bool locality_weight_aware_;
+    // Hosts of original_host_set_ currently in this subset, keyed by address so that
+    // HostsPerLocality::filter() can test membership without re-evaluating the predicate.
+    std::unordered_map<const Host*, HostSharedPtr> members_;
   };
 
   // Represents a subset of an original PrioritySet.
@@ -59,7 +64,8 @@ private:
     PrioritySubsetImpl(const SubsetLoadBalancer& subset_lb, HostPredicate predicate,
                        bool locality_weight_aware);
 
-    void update(uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed);
+    void update(uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed,
+                bool replace_members);
 
     bool empty() { return empty_; }
 
@@ -92,7 +98,8 @@ private:
   typedef std::shared_ptr<HostSubsetImpl> HostSubsetImplPtr;
   typedef std::shared_ptr<PrioritySubsetImpl> PrioritySubsetImplPtr;
 
-  typedef std::vector<std::pair<std::string, ProtobufWkt::Value>> SubsetMetadata;
+  // Values are hashed once, when taken from the host's LbMetadata or the config.
+  typedef std::vector<std::pair<std::string, HashedValue>> SubsetMetadata;
 
   class LbSubsetEntry;
   typedef std::shared_ptr<LbSubsetEntry> LbSubsetEntryPtr;
@@ -111,28 +118,34 @@ private:
 
     // Only initialized if a match exists at this level.
     PrioritySubsetImplPtr priority_subset_;
+
+    // The full metadata of this entry. Only set once the entry is initialized.
+    SubsetMetadata kvs_;
   };
 
   // Create filtered default subset (if necessary) and other subsets based on current hosts.
   void refreshSubsets();
   void refreshSubsets(uint32_t priority);
+  bool snapshotHostMetadata(uint32_t priority, const HostVector& hosts_removed);
 
-  // Called by HostSet::MemberUpdateCb
-  void update(uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed);
+  // Called by HostSet::MemberUpdateCb. If full_refresh is true, hosts_added holds every host at
+  // this priority and subset membership is rebuilt from it.
+  void update(uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed,
+              bool full_refresh);
 
   void updateFallbackSubset(uint32_t priority, const HostVector& hosts_added,
                             const HostVector& hosts_removed);
   void processSubsets(
       const HostVector& hosts_added, const HostVector& hosts_removed,
-      std::function<void(LbSubsetEntryPtr)> update_cb,
+      std::function<void(LbSubsetEntryPtr, const HostVector&, const HostVector&)> update_cb,
       std::function<void(LbSubsetEntryPtr, HostPredicate, const SubsetMetadata&, bool)> cb);
 
   HostConstSharedPtr tryChooseHostFromContext(LoadBalancerContext* context, bool& host_chosen);
 
   bool hostMatches(const SubsetMetadata& kvs, const Host& host);
 
-  LbSubsetEntryPtr
-  findSubset(const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& matches);
+  LbSubsetEntryPtr findSubset(const Router::MetadataMatchCriteria& match_criteria);
+  static uint64_t subsetHash(const SubsetMetadata& kvs);
 
   LbSubsetEntryPtr findOrCreateSubset(LbSubsetMap& subsets, const SubsetMetadata& kvs,
                                       uint32_t idx);
@@ -143,6 +156,7 @@ private:
 
   const LoadBalancerType lb_type_;
   const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig> lb_ring_hash_config_;
+  const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig> least_request_config_;
   const envoy::api::v2::Cluster::CommonLbConfig common_config_;
   ClusterStats& stats_;
   Runtime::Loader& runtime_;
@@ -161,8 +175,17 @@ private:
   // Forms a trie-like structure. Requires lexically sorted Host and Route metadata.
   LbSubsetMap subsets_;
 
+  // Initialized entries of subsets_, keyed by subsetHash() of their metadata. Lets findSubset()
+  // resolve route criteria with a single lookup on the criteria's precomputed hash.
+  std::unordered_multimap<uint64_t, LbSubsetEntryPtr> subset_index_;
+
   const bool locality_weight_aware_;
 
+  // Last seen metadata of each host, used to detect metadata changes that arrive alongside host
+  // additions or removals.
+  std::unordered_map<HostSharedPtr, std::shared_ptr<const envoy::api::v2::core::Metadata>>
+      host_metadata_;
+
   friend class SubsetLoadBalancerDescribeMetadataTester;
 };
 
@@ -1,8 +1,19 @@
 #include "common/upstream/thread_aware_lb_impl.h"
 
+#include "common/protobuf/utility.h"
+
 namespace Envoy {
 namespace Upstream {
 
+uint32_t ThreadAwareLoadBalancerBase::hashBalanceFactor(
+    const envoy::api::v2::Cluster::CommonLbConfig& common_config) {
+  if (!common_config.has_consistent_hashing_lb_config()) {
+    return 0;
+  }
+  return PROTOBUF_GET_WRAPPED_OR_DEFAULT(common_config.consistent_hashing_lb_config(),
+                                         hash_balance_factor, 0);
+}
+
 void ThreadAwareLoadBalancerBase::initialize() {
   // TODO(mattklein123): In the future, once initialized and the initial LB is built, it would be
   // better to use a background thread for computing LB updates. This has the substantial benefit
@@ -27,6 +38,9 @@ void ThreadAwareLoadBalancerBase::refresh() {
     const auto& per_priority_state = (*per_priority_state_vector)[priority];
     per_priority_state->current_lb_ = createLoadBalancer(*host_set);
     per_priority_state->global_panic_ = isGlobalPanic(*host_set);
+    per_priority_state->num_hosts_ = per_priority_state->global_panic_
+                                         ? host_set->hosts().size()
+                                         : host_set->healthyHosts().size();
   }
 
   {
@@ -56,11 +70,69 @@ ThreadAwareLoadBalancerBase::LoadBalancerImpl::chooseHost(LoadBalancerContext* c
   if (per_priority_state->global_panic_) {
     stats_.lb_healthy_panic_.inc();
   }
-  return per_priority_state->current_lb_->chooseHost(h);
+  if (hash_balance_factor_ == 0 || per_priority_state->num_hosts_ <= 1) {
+    return per_priority_state->current_lb_->chooseHost(h);
+  }
+
+  if (host_requests_.size() <= priority) {
+    host_requests_.resize(priority + 1);
+  }
+  return chooseHostWithBoundedLoad(*per_priority_state, host_requests_[priority], h);
+}
+
+HostConstSharedPtr ThreadAwareLoadBalancerBase::LoadBalancerImpl::chooseHostWithBoundedLoad(
+    const PerPriorityState& per_priority_state, HostRequests& host_requests, uint64_t hash) {
+  const uint64_t num_hosts = per_priority_state.num_hosts_;
+  // A host may receive this request if it stays within the factor times the average, rounded up
+  // so that a host can always receive at least one request.
+  const uint64_t max_requests =
+      (hash_balance_factor_ * (host_requests.total_ + 1) + 100 * num_hosts - 1) / (100 * num_hosts);
+
+  HostConstSharedPtr host = per_priority_state.current_lb_->chooseHost(hash);
+  if (host == nullptr) {
+    return nullptr;
+  }
+  uint64_t* requests = &host_requests.requests_[host.get()];
+  if (*requests >= max_requests) {
+    // Some host is at or below the average, so walking twice as many candidates as there are hosts
+    // finds one unless the candidates repeat hosts. Otherwise the least loaded candidate is used.
+    stats_.lb_hash_bounded_load_fallback_.inc();
+    for (uint32_t attempt = 1; attempt < 2 * num_hosts; ++attempt) {
+      HostConstSharedPtr candidate = per_priority_state.current_lb_->chooseNextHost(hash, attempt);
+      uint64_t* candidate_requests = &host_requests.requests_[candidate.get()];
+      if (*candidate_requests < *requests) {
+        host = std::move(candidate);
+        requests = candidate_requests;
+        if (*requests < max_requests) {
+          break;
+        }
+      }
+    }
+  }
+
+  ++*requests;
+  if (++host_requests.total_ >= HostRequests::DecayRequestsPerHost * num_hosts) {
+    host_requests.decay();
+  }
+  return host;
+}
+
+void ThreadAwareLoadBalancerBase::HostRequests::decay() {
+  total_ = 0;
+  for (auto it = requests_.begin(); it != requests_.end();) {
+    it->second /= 2;
+    total_ += it->second;
+    if (it->second == 0) {
+      // Forget the hosts that no longer receive requests.
+      it = requests_.erase(it);
+    } else {
+      ++it;
+    }
+  }
 }
 
 LoadBalancerPtr ThreadAwareLoadBalancerBase::LoadBalancerFactoryImpl::create() {
-  auto lb = std::make_unique<LoadBalancerImpl>(stats_, random_);
+  auto lb = std::make_unique<LoadBalancerImpl>(stats_, random_, hash_balance_factor_);
 
   // We must protect current_lb_ via a RW lock since it is accessed and written to by multiple
   // threads. All complex processing has already been precalculated however.
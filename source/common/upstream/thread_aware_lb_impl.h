@@ -1,5 +1,8 @@
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
 #include "common/upstream/load_balancer_impl.h"
 
 #include "absl/synchronization/mutex.h"
@@ -21,6 +24,15 @@ public:
   public:
     virtual ~HashingLoadBalancer() {}
     virtual HostConstSharedPtr chooseHost(uint64_t hash) const PURE;
+
+    /**
+     * Choose a fallback candidate for a hash, used by consistent hashing with bounded loads when
+     * the host returned by chooseHost() is overloaded. The candidates of a hash must be stable, so
+     * that the keys of an overloaded host also spread consistently.
+     * @param hash supplies the hash.
+     * @param attempt supplies the number of the fallback, starting at 1.
+     */
+    virtual HostConstSharedPtr chooseNextHost(uint64_t hash, uint32_t attempt) const PURE;
   };
   typedef std::shared_ptr<HashingLoadBalancer> HashingLoadBalancerSharedPtr;
 
@@ -38,43 +50,72 @@ protected:
                               Runtime::Loader& runtime, Runtime::RandomGenerator& random,
                               const envoy::api::v2::Cluster::CommonLbConfig& common_config)
       : LoadBalancerBase(priority_set, stats, runtime, random, common_config),
-        factory_(new LoadBalancerFactoryImpl(stats, random)) {}
+        factory_(new LoadBalancerFactoryImpl(stats, random, hashBalanceFactor(common_config))) {}
 
 private:
   struct PerPriorityState {
     std::shared_ptr<HashingLoadBalancer> current_lb_;
     bool global_panic_{};
+    // The number of hosts current_lb_ chooses from.
+    uint32_t num_hosts_{};
   };
   typedef std::unique_ptr<PerPriorityState> PerPriorityStatePtr;
 
+  /**
+   * The requests a worker recently sent to the hosts of a priority, which estimate their load for
+   * consistent hashing with bounded loads. The estimates are halved once the hosts received
+   * DecayRequestsPerHost requests on average, so that they follow changes of the key distribution.
+   */
+  struct HostRequests {
+    static constexpr uint64_t DecayRequestsPerHost = 64;
+
+    void decay();
+
+    std::unordered_map<const Host*, uint64_t> requests_;
+    uint64_t total_{};
+  };
+
   struct LoadBalancerImpl : public LoadBalancer {
-    LoadBalancerImpl(ClusterStats& stats, Runtime::RandomGenerator& random)
-        : stats_(stats), random_(random) {}
+    LoadBalancerImpl(ClusterStats& stats, Runtime::RandomGenerator& random,
+                     uint32_t hash_balance_factor)
+        : stats_(stats), random_(random), hash_balance_factor_(hash_balance_factor) {}
 
     // Upstream::LoadBalancer
     HostConstSharedPtr chooseHost(LoadBalancerContext* context) override;
 
+    HostConstSharedPtr chooseHostWithBoundedLoad(const PerPriorityState& per_priority_state,
+                                                 HostRequests& host_requests, uint64_t hash);
+
     ClusterStats& stats_;
     Runtime::RandomGenerator& random_;
+    // The percentage of the average requests per host above which a host is skipped, or 0 if hosts
+    // are chosen purely by hash.
+    const uint32_t hash_balance_factor_;
     std::shared_ptr<std::vector<PerPriorityStatePtr>> per_priority_state_;
     std::shared_ptr<std::vector<uint32_t>> per_priority_load_;
+    // Indexed by priority. Only used with bounded loads.
+    std::vector<HostRequests> host_requests_;
   };
 
   struct LoadBalancerFactoryImpl : public LoadBalancerFactory {
-    LoadBalancerFactoryImpl(ClusterStats& stats, Runtime::RandomGenerator& random)
-        : stats_(stats), random_(random) {}
+    LoadBalancerFactoryImpl(ClusterStats& stats, Runtime::RandomGenerator& random,
+                            uint32_t hash_balance_factor)
+        : stats_(stats), random_(random), hash_balance_factor_(hash_balance_factor) {}
 
     // Upstream::LoadBalancerFactory
     LoadBalancerPtr create() override;
 
     ClusterStats& stats_;
     Runtime::RandomGenerator& random_;
+    const uint32_t hash_balance_factor_;
     absl::Mutex mutex_;
     std::shared_ptr<std::vector<PerPriorityStatePtr>> per_priority_state_ GUARDED_BY(mutex_);
     // This is split out of PerPriorityState so LoadBalancerBase::ChoosePriorirty can be reused.
     std::shared_ptr<std::vector<uint32_t>> per_priority_load_ GUARDED_BY(mutex_);
   };
 
+  static uint32_t hashBalanceFactor(const envoy::api::v2::Cluster::CommonLbConfig& common_config);
+
   virtual HashingLoadBalancerSharedPtr createLoadBalancer(const HostSet& host_set) PURE;
   void refresh();
 
@@ -5,6 +5,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -70,6 +71,9 @@ uint64_t parseFeatures(const envoy::api::v2::Cluster& config) {
   if (config.close_connections_on_host_health_failure()) {
     features |= ClusterInfoImpl::Features::CLOSE_CONNECTIONS_ON_HOST_HEALTH_FAILURE;
   }
+  if (config.upstream_connection_options().tcp_latency_options().quick_ack()) {
+    features |= ClusterInfoImpl::Features::TCP_QUICK_ACK;
+  }
   return features;
 }
 
@@ -98,6 +102,15 @@ parseClusterSocketOptions(const envoy::api::v2::Cluster& config,
         cluster_options,
         Network::SocketOptionFactory::buildTcpKeepaliveOptions(parseTcpKeepaliveConfig(config)));
   }
+  if (config.upstream_connection_options().tcp_fast_open()) {
+    Network::Socket::appendOptions(cluster_options,
+                                   Network::SocketOptionFactory::buildTcpFastOpenConnectOptions());
+  }
+  if (config.upstream_connection_options().has_tcp_latency_options()) {
+    Network::Socket::appendOptions(cluster_options,
+                                   Network::SocketOptionFactory::buildTcpLatencyOptions(
+                                       config.upstream_connection_options().tcp_latency_options()));
+  }
   // Cluster socket_options trump cluster manager wide.
   if (bind_config.socket_options().size() + config.upstream_bind_config().socket_options().size() >
       0) {
@@ -144,8 +157,170 @@ parseExtensionProtocolOptions(const envoy::api::v2::Cluster& config) {
   return options;
 }
 
+absl::optional<uint64_t> parseSharedConnPoolKey(const envoy::api::v2::Cluster& config) {
+  if (!config.share_connection_pools()) {
+    return absl::nullopt;
+  }
+
+  // Only the settings that the connection pools and their connections are created with.
+  envoy::api::v2::Cluster pool_config;
+  *pool_config.mutable_connect_timeout() = config.connect_timeout();
+  *pool_config.mutable_per_connection_buffer_limit_bytes() =
+      config.per_connection_buffer_limit_bytes();
+  *pool_config.mutable_per_connection_buffer_limit_max_bytes() =
+      config.per_connection_buffer_limit_max_bytes();
+  *pool_config.mutable_max_requests_per_connection() = config.max_requests_per_connection();
+  *pool_config.mutable_prefetch_ratio() = config.prefetch_ratio();
+  *pool_config.mutable_pending_request_queue() = config.pending_request_queue();
+  *pool_config.mutable_circuit_breakers() = config.circuit_breakers();
+  *pool_config.mutable_tls_context() = config.tls_context();
+  *pool_config.mutable_transport_socket() = config.transport_socket();
+  *pool_config.mutable_common_http_protocol_options() = config.common_http_protocol_options();
+  *pool_config.mutable_http_protocol_options() = config.http_protocol_options();
+  *pool_config.mutable_http2_protocol_options() = config.http2_protocol_options();
+  *pool_config.mutable_upstream_bind_config() = config.upstream_bind_config();
+  *pool_config.mutable_upstream_connection_options() = config.upstream_connection_options();
+  return MessageUtil::hash(pool_config);
+}
+
+// Interns the objects that hosts build from protobuf messages, so that hosts with equivalent
+// messages share a single object. An object leaves the table once the last host releases it.
+// Object must be constructible from the message, and return it from message().
+template <class Message, class Object> class InternTable {
+public:
+  std::shared_ptr<Object> get(const Message& message) {
+    const size_t hash = MessageUtil::hash(message);
+    absl::MutexLock lock(&mutex_);
+    const auto range = objects_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      // Objects are only deleted once their deleter removed them from the table, so the raw
+      // pointer is valid while the lock is held. An expired object is skipped, and no reference
+      // is released with the lock held, as that may run the deleter.
+      if (Protobuf::util::MessageDifferencer::Equivalent(it->second.first->message(), message)) {
+        std::shared_ptr<Object> object = it->second.second.lock();
+        if (object != nullptr) {
+          return object;
+        }
+      }
+    }
+
+    std::shared_ptr<Object> object(new Object(message), [this, hash](Object* object) {
+      release(hash, object);
+    });
+    objects_.emplace(hash, std::make_pair(object.get(), std::weak_ptr<Object>(object)));
+    return object;
+  }
+
+private:
+  void release(size_t hash, Object* object) {
+    {
+      absl::MutexLock lock(&mutex_);
+      const auto range = objects_.equal_range(hash);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.first == object) {
+          objects_.erase(it);
+          break;
+        }
+      }
+    }
+    delete object;
+  }
+
+  absl::Mutex mutex_;
+  std::unordered_multimap<size_t, std::pair<Object*, std::weak_ptr<Object>>> objects_
+      GUARDED_BY(mutex_);
+};
+
+struct InternedLocality {
+  explicit InternedLocality(const envoy::api::v2::core::Locality& locality) : locality_(locality) {}
+  const envoy::api::v2::core::Locality& message() const { return locality_; }
+
+  const envoy::api::v2::core::Locality locality_;
+};
+
+// The metadata of a host along with its envoy.lb values.
+struct InternedMetadata {
+  explicit InternedMetadata(const envoy::api::v2::core::Metadata& metadata)
+      : metadata_(metadata), lb_metadata_(HostDescriptionImpl::extractLbMetadata(metadata)) {}
+  const envoy::api::v2::core::Metadata& message() const { return metadata_; }
+
+  envoy::api::v2::core::Metadata metadata_;
+  const LbMetadataConstSharedPtr lb_metadata_;
+};
+
+// The tables are never destroyed, so that they outlive the hosts released during static
+// destruction.
+InternTable<envoy::api::v2::core::Locality, InternedLocality>& localityTable() {
+  static auto* table = new InternTable<envoy::api::v2::core::Locality, InternedLocality>();
+  return *table;
+}
+
+InternTable<envoy::api::v2::core::Metadata, InternedMetadata>& metadataTable() {
+  static auto* table = new InternTable<envoy::api::v2::core::Metadata, InternedMetadata>();
+  return *table;
+}
+
+std::shared_ptr<const envoy::api::v2::core::Locality>
+internLocality(const envoy::api::v2::core::Locality& locality) {
+  std::shared_ptr<InternedLocality> interned = localityTable().get(locality);
+  return std::shared_ptr<const envoy::api::v2::core::Locality>(interned, &interned->locality_);
+}
+
 } // namespace
 
+HostDescriptionImpl::HostDescriptionImpl(
+    ClusterInfoConstSharedPtr cluster, const std::string& hostname,
+    Network::Address::InstanceConstSharedPtr dest_address,
+    const envoy::api::v2::core::Metadata& metadata, const envoy::api::v2::core::Locality& locality,
+    const envoy::api::v2::endpoint::Endpoint::HealthCheckConfig& health_check_config)
+    : cluster_(cluster), hostname_(hostname), address_(dest_address),
+      health_check_address_(health_check_config.port_value() == 0
+                                ? dest_address
+                                : Network::Utility::getAddressWithPort(
+                                      *dest_address, health_check_config.port_value())),
+      canary_(Config::Metadata::metadataValue(metadata, Config::MetadataFilters::get().ENVOY_LB,
+                                              Config::MetadataEnvoyLbKeys::get().CANARY)
+                  .bool_value()),
+      locality_(internLocality(locality)) {
+  std::shared_ptr<InternedMetadata> interned = metadataTable().get(metadata);
+  metadata_ = std::shared_ptr<envoy::api::v2::core::Metadata>(interned, &interned->metadata_);
+  lb_metadata_ = interned->lb_metadata_;
+}
+
+HostDescriptionImpl::~HostDescriptionImpl() { delete stats_store_.load(); }
+
+void HostDescriptionImpl::metadata(const envoy::api::v2::core::Metadata& new_metadata) {
+  // Hosts with equivalent metadata share it, so it is replaced rather than modified in place.
+  std::shared_ptr<InternedMetadata> interned = metadataTable().get(new_metadata);
+  absl::WriterMutexLock lock(&metadata_mutex_);
+  metadata_ = std::shared_ptr<envoy::api::v2::core::Metadata>(interned, &interned->metadata_);
+  lb_metadata_ = interned->lb_metadata_;
+}
+
+HostDescriptionImpl::HostStatsStore& HostDescriptionImpl::statsStore() const {
+  HostStatsStore* store = stats_store_.load(std::memory_order_acquire);
+  if (store == nullptr) {
+    // Threads racing to create the stats agree on the first one stored.
+    std::unique_ptr<HostStatsStore> created = std::make_unique<HostStatsStore>();
+    if (stats_store_.compare_exchange_strong(store, created.get(), std::memory_order_acq_rel)) {
+      store = created.release();
+    }
+  }
+  return *store;
+}
+
+LbMetadataConstSharedPtr
+HostDescriptionImpl::extractLbMetadata(const envoy::api::v2::core::Metadata& metadata) {
+  auto lb_metadata = std::make_shared<LbMetadata>();
+  const auto filter_it = metadata.filter_metadata().find(Config::MetadataFilters::get().ENVOY_LB);
+  if (filter_it != metadata.filter_metadata().end()) {
+    for (const auto& field : filter_it->second.fields()) {
+      lb_metadata->emplace(field.first, HashedValue(field.second));
+    }
+  }
+  return lb_metadata;
+}
+
 Host::CreateConnectionData
 HostImpl::createConnection(Event::Dispatcher& dispatcher,
                            const Network::ConnectionSocket::OptionsSharedPtr& options) const {
@@ -162,6 +337,35 @@ Network::ClientConnectionPtr
 HostImpl::createConnection(Event::Dispatcher& dispatcher, const ClusterInfo& cluster,
                            Network::Address::InstanceConstSharedPtr address,
                            const Network::ConnectionSocket::OptionsSharedPtr& options) {
+  Network::ClientConnectionPtr connection = dispatcher.createClientConnection(
+      address, cluster.sourceAddress(), cluster.transportSocketFactory().createTransportSocket(),
+      connectionOptions(cluster, options));
+  connection->setBufferLimits(cluster.perConnectionBufferLimitBytes());
+  connection->setBufferLimitAutoTuning(cluster.perConnectionBufferLimitMaxBytes());
+  if (cluster.features() & ClusterInfo::Features::TCP_QUICK_ACK) {
+    connection->quickAck(true);
+  }
+  return connection;
+}
+
+Network::ClientConnectionPtr
+HostImpl::createConnection(Event::Dispatcher& dispatcher, const ClusterInfo& cluster,
+                           const std::vector<Network::Address::InstanceConstSharedPtr>& addresses,
+                           const Network::ConnectionSocket::OptionsSharedPtr& options) {
+  Network::ClientConnectionPtr connection = dispatcher.createHappyEyeballsConnection(
+      addresses, cluster.sourceAddress(), cluster.transportSocketFactory().createTransportSocket(),
+      connectionOptions(cluster, options));
+  connection->setBufferLimits(cluster.perConnectionBufferLimitBytes());
+  connection->setBufferLimitAutoTuning(cluster.perConnectionBufferLimitMaxBytes());
+  if (cluster.features() & ClusterInfo::Features::TCP_QUICK_ACK) {
+    connection->quickAck(true);
+  }
+  return connection;
+}
+
+Network::ConnectionSocket::OptionsSharedPtr
+HostImpl::connectionOptions(const ClusterInfo& cluster,
+                            const Network::ConnectionSocket::OptionsSharedPtr& options) {
   Network::ConnectionSocket::OptionsSharedPtr connection_options;
   if (cluster.clusterSocketOptions() != nullptr) {
     if (options) {
@@ -175,12 +379,7 @@ HostImpl::createConnection(Event::Dispatcher& dispatcher, const ClusterInfo& clu
   } else {
     connection_options = options;
   }
-
-  Network::ClientConnectionPtr connection = dispatcher.createClientConnection(
-      address, cluster.sourceAddress(), cluster.transportSocketFactory().createTransportSocket(),
-      connection_options);
-  connection->setBufferLimits(cluster.perConnectionBufferLimitBytes());
-  return connection;
+  return connection_options;
 }
 
 void HostImpl::weight(uint32_t new_weight) { weight_ = std::max(1U, std::min(128U, new_weight)); }
@@ -314,10 +513,13 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
     : runtime_(runtime), name_(config.name()), type_(config.type()),
       max_requests_per_connection_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_requests_per_connection, 0)),
+      prefetch_ratio_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, prefetch_ratio, 1.0)),
       connect_timeout_(
           std::chrono::milliseconds(PROTOBUF_GET_MS_REQUIRED(config, connect_timeout))),
       per_connection_buffer_limit_bytes_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
+      per_connection_buffer_limit_max_bytes_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_max_bytes, 0)),
       transport_socket_factory_(std::move(socket_factory)), stats_scope_(std::move(stats_scope)),
       stats_(generateStats(*stats_scope_)),
       load_report_stats_(generateLoadReportStats(load_report_stats_store_)),
@@ -328,11 +530,13 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
       maintenance_mode_runtime_key_(fmt::format("upstream.maintenance_mode.{}", name_)),
       source_address_(getSourceAddress(config, bind_config)),
       lb_ring_hash_config_(config.ring_hash_lb_config()),
+      lb_least_request_config_(config.least_request_lb_config()),
       lb_original_dst_config_(config.original_dst_lb_config()), added_via_api_(added_via_api),
       lb_subset_(LoadBalancerSubsetInfoImpl(config.lb_subset_config())),
       metadata_(config.metadata()), common_lb_config_(config.common_lb_config()),
       cluster_socket_options_(parseClusterSocketOptions(config, bind_config)),
-      drain_connections_on_host_removal_(config.drain_connections_on_host_removal()) {
+      drain_connections_on_host_removal_(config.drain_connections_on_host_removal()),
+      shared_conn_pool_key_(parseSharedConnPoolKey(config)) {
 
   switch (config.lb_policy()) {
   case envoy::api::v2::Cluster::ROUND_ROBIN:
@@ -369,11 +573,35 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
     }
   }
 
+  // The per host feedback of a shared pool, such as active requests and outlier detection, goes to
+  // the host the pool was created for, which may belong to another cluster.
+  if (config.share_connection_pools()) {
+    if (lb_type_ == LoadBalancerType::LeastRequest) {
+      throw EnvoyException(
+          "cluster: 'share_connection_pools' may not be used with LB type 'least_request'");
+    }
+    if (config.has_outlier_detection()) {
+      throw EnvoyException(
+          "cluster: 'share_connection_pools' may not be used with 'outlier_detection'");
+    }
+  }
+
   if (config.common_http_protocol_options().has_idle_timeout()) {
     idle_timeout_ = std::chrono::milliseconds(
         DurationUtil::durationToMilliseconds(config.common_http_protocol_options().idle_timeout()));
   }
 
+  if (config.has_pending_request_queue()) {
+    const auto& queue_config = config.pending_request_queue();
+    pending_request_queue_ = PendingRequestQueueConfig{
+        std::chrono::milliseconds(PROTOBUF_GET_MS_REQUIRED(queue_config, target_delay)),
+        std::chrono::milliseconds(PROTOBUF_GET_MS_REQUIRED(queue_config, interval))};
+    if (pending_request_queue_->target_delay_ >= pending_request_queue_->interval_) {
+      throw EnvoyException(
+          "cluster: pending request queue target_delay must be less than interval");
+    }
+  }
+
   // TODO(htuch): Remove this temporary workaround when we have
   // https://github.com/lyft/protoc-gen-validate/issues/97 resolved. This just provides early
   // validation of sanity of fields that we should catch at config ingestion.
@@ -651,11 +879,9 @@ void ClusterImplBase::reloadHealthyHosts() {
   }
 
   for (auto& host_set : prioritySet().hostSetsPerPriority()) {
-    // TODO(htuch): Can we skip these copies by exporting out const shared_ptr from HostSet?
-    HostVectorConstSharedPtr hosts_copy(new HostVector(host_set->hosts()));
-    HostsPerLocalityConstSharedPtr hosts_per_locality_copy = host_set->hostsPerLocality().clone();
-    host_set->updateHosts(hosts_copy, createHealthyHostList(host_set->hosts()),
-                          hosts_per_locality_copy,
+    // Host lists are never mutated once set, so the unchanged ones are shared rather than copied.
+    host_set->updateHosts(host_set->hostsPtr(), createHealthyHostList(host_set->hosts()),
+                          host_set->hostsPerLocalityPtr(),
                           createHealthyHostLists(host_set->hostsPerLocality()),
                           host_set->localityWeights(), {}, {}, absl::nullopt);
   }
@@ -693,6 +919,7 @@ ClusterInfoImpl::ResourceManagers::load(const envoy::api::v2::Cluster& config,
   uint64_t max_pending_requests = 1024;
   uint64_t max_requests = 1024;
   uint64_t max_retries = 3;
+  absl::optional<RetryBudget> retry_budget;
 
   std::string priority_name;
   switch (priority) {
@@ -721,9 +948,16 @@ ClusterInfoImpl::ResourceManagers::load(const envoy::api::v2::Cluster& config,
         PROTOBUF_GET_WRAPPED_OR_DEFAULT(*it, max_pending_requests, max_pending_requests);
     max_requests = PROTOBUF_GET_WRAPPED_OR_DEFAULT(*it, max_requests, max_requests);
     max_retries = PROTOBUF_GET_WRAPPED_OR_DEFAULT(*it, max_retries, max_retries);
+    if (it->has_retry_budget()) {
+      const auto& budget = it->retry_budget();
+      retry_budget = RetryBudget{
+          budget.has_budget_percent() ? budget.budget_percent().value() : 20.0,
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(budget, min_retry_concurrency, 3)};
+    }
   }
-  return ResourceManagerImplPtr{new ResourceManagerImpl(
-      runtime, runtime_prefix, max_connections, max_pending_requests, max_requests, max_retries)};
+  return ResourceManagerImplPtr{new ResourceManagerImpl(runtime, runtime_prefix, max_connections,
+                                                        max_pending_requests, max_requests,
+                                                        max_retries, retry_budget)};
 }
 
 PriorityStateManager::PriorityStateManager(ClusterImplBase& cluster,
@@ -1080,6 +1314,9 @@ StrictDnsClusterImpl::StrictDnsClusterImpl(
   case envoy::api::v2::Cluster::AUTO:
     dns_lookup_family_ = Network::DnsLookupFamily::Auto;
     break;
+  case envoy::api::v2::Cluster::ALL:
+    dns_lookup_family_ = Network::DnsLookupFamily::All;
+    break;
   default:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
@@ -65,18 +65,8 @@ public:
       Network::Address::InstanceConstSharedPtr dest_address,
       const envoy::api::v2::core::Metadata& metadata,
       const envoy::api::v2::core::Locality& locality,
-      const envoy::api::v2::endpoint::Endpoint::HealthCheckConfig& health_check_config)
-      : cluster_(cluster), hostname_(hostname), address_(dest_address),
-        health_check_address_(health_check_config.port_value() == 0
-                                  ? dest_address
-                                  : Network::Utility::getAddressWithPort(
-                                        *dest_address, health_check_config.port_value())),
-        canary_(Config::Metadata::metadataValue(metadata, Config::MetadataFilters::get().ENVOY_LB,
-                                                Config::MetadataEnvoyLbKeys::get().CANARY)
-                    .bool_value()),
-        metadata_(std::make_shared<envoy::api::v2::core::Metadata>(metadata)),
-        locality_(locality), stats_{ALL_HOST_STATS(POOL_COUNTER(stats_store_),
-                                                   POOL_GAUGE(stats_store_))} {}
+      const envoy::api::v2::endpoint::Endpoint::HealthCheckConfig& health_check_config);
+  ~HostDescriptionImpl();
 
   // Upstream::HostDescription
   bool canary() const override { return canary_; }
@@ -95,9 +85,10 @@ public:
     absl::ReaderMutexLock lock(&metadata_mutex_);
     return metadata_;
   }
-  virtual void metadata(const envoy::api::v2::core::Metadata& new_metadata) override {
-    absl::WriterMutexLock lock(&metadata_mutex_);
-    metadata_ = std::make_shared<envoy::api::v2::core::Metadata>(new_metadata);
+  virtual void metadata(const envoy::api::v2::core::Metadata& new_metadata) override;
+  LbMetadataConstSharedPtr lbMetadata() const override {
+    absl::ReaderMutexLock lock(&metadata_mutex_);
+    return lb_metadata_;
   }
 
   const ClusterInfo& cluster() const override { return *cluster_; }
@@ -119,7 +110,7 @@ public:
       return *null_outlier_detector;
     }
   }
-  const HostStats& stats() const override { return stats_; }
+  const HostStats& stats() const override { return statsStore().stats_; }
   const std::string& hostname() const override { return hostname_; }
   Network::Address::InstanceConstSharedPtr address() const override { return address_; }
   Network::Address::InstanceConstSharedPtr healthCheckAddress() const override {
@@ -127,9 +118,29 @@ public:
   }
   // Setting health check address is usually done at initialization. This is NOP by default.
   void setHealthCheckAddress(Network::Address::InstanceConstSharedPtr) override {}
-  const envoy::api::v2::core::Locality& locality() const override { return locality_; }
+  const envoy::api::v2::core::Locality& locality() const override { return *locality_; }
+
+  /**
+   * @param metadata supplies the metadata of a host.
+   * @return LbMetadataConstSharedPtr the hashed values of the envoy.lb metadata.
+   */
+  static LbMetadataConstSharedPtr extractLbMetadata(const envoy::api::v2::core::Metadata& metadata);
 
 protected:
+  // The stats of a host. They are only created once the host is used, as most hosts of large
+  // clusters are never used by a given Envoy.
+  struct HostStatsStore {
+    HostStatsStore() : stats_{ALL_HOST_STATS(POOL_COUNTER(store_), POOL_GAUGE(store_))} {}
+
+    Stats::IsolatedStoreImpl store_;
+    HostStats stats_;
+  };
+
+  /**
+   * @return HostStatsStore& the stats of the host, created on first use by any thread.
+   */
+  HostStatsStore& statsStore() const;
+
   ClusterInfoConstSharedPtr cluster_;
   const std::string hostname_;
   Network::Address::InstanceConstSharedPtr address_;
@@ -137,9 +148,10 @@ protected:
   std::atomic<bool> canary_;
   mutable absl::Mutex metadata_mutex_;
   std::shared_ptr<envoy::api::v2::core::Metadata> metadata_ GUARDED_BY(metadata_mutex_);
-  const envoy::api::v2::core::Locality locality_;
-  Stats::IsolatedStoreImpl stats_store_;
-  HostStats stats_;
+  LbMetadataConstSharedPtr lb_metadata_ GUARDED_BY(metadata_mutex_);
+  // Interned, so that the hosts of a locality share it.
+  const std::shared_ptr<const envoy::api::v2::core::Locality> locality_;
+  mutable std::atomic<HostStatsStore*> stats_store_{};
   Outlier::DetectorHostMonitorPtr outlier_detector_;
   HealthCheckHostMonitorPtr health_checker_;
 };
@@ -162,12 +174,16 @@ public:
   }
 
   // Upstream::Host
-  std::vector<Stats::CounterSharedPtr> counters() const override { return stats_store_.counters(); }
+  std::vector<Stats::CounterSharedPtr> counters() const override {
+    return statsStore().store_.counters();
+  }
   CreateConnectionData
   createConnection(Event::Dispatcher& dispatcher,
                    const Network::ConnectionSocket::OptionsSharedPtr& options) const override;
   CreateConnectionData createHealthCheckConnection(Event::Dispatcher& dispatcher) const override;
-  std::vector<Stats::GaugeSharedPtr> gauges() const override { return stats_store_.gauges(); }
+  std::vector<Stats::GaugeSharedPtr> gauges() const override {
+    return statsStore().store_.gauges();
+  }
   void healthFlagClear(HealthFlag flag) override { health_flags_ &= ~enumToInt(flag); }
   bool healthFlagGet(HealthFlag flag) const override { return health_flags_ & enumToInt(flag); }
   void healthFlagSet(HealthFlag flag) override { health_flags_ |= enumToInt(flag); }
@@ -196,8 +212,18 @@ protected:
   createConnection(Event::Dispatcher& dispatcher, const ClusterInfo& cluster,
                    Network::Address::InstanceConstSharedPtr address,
                    const Network::ConnectionSocket::OptionsSharedPtr& options);
+  // Races connection attempts to the addresses in order, @see
+  // Event::Dispatcher::createHappyEyeballsConnection().
+  static Network::ClientConnectionPtr
+  createConnection(Event::Dispatcher& dispatcher, const ClusterInfo& cluster,
+                   const std::vector<Network::Address::InstanceConstSharedPtr>& addresses,
+                   const Network::ConnectionSocket::OptionsSharedPtr& options);
 
 private:
+  static Network::ConnectionSocket::OptionsSharedPtr
+  connectionOptions(const ClusterInfo& cluster,
+                    const Network::ConnectionSocket::OptionsSharedPtr& options);
+
   std::atomic<uint64_t> health_flags_{};
   ActiveHealthFailureType active_health_failure_type_{};
   std::atomic<uint32_t> weight_;
@@ -271,6 +297,14 @@ public:
   const HostsPerLocality& healthyHostsPerLocality() const override {
     return *healthy_hosts_per_locality_;
   }
+  HostVectorConstSharedPtr hostsPtr() const override { return hosts_; }
+  HostVectorConstSharedPtr healthyHostsPtr() const override { return healthy_hosts_; }
+  HostsPerLocalityConstSharedPtr hostsPerLocalityPtr() const override {
+    return hosts_per_locality_;
+  }
+  HostsPerLocalityConstSharedPtr healthyHostsPerLocalityPtr() const override {
+    return healthy_hosts_per_locality_;
+  }
   LocalityWeightsConstSharedPtr localityWeights() const override { return locality_weights_; }
   absl::optional<uint32_t> chooseLocality() override;
   uint32_t priority() const override { return priority_; }
@@ -373,6 +407,9 @@ public:
   uint32_t perConnectionBufferLimitBytes() const override {
     return per_connection_buffer_limit_bytes_;
   }
+  uint32_t perConnectionBufferLimitMaxBytes() const override {
+    return per_connection_buffer_limit_max_bytes_;
+  }
   uint64_t features() const override { return features_; }
   const Http::Http2Settings& http2Settings() const override { return http2_settings_; }
   ProtocolOptionsConfigConstSharedPtr
@@ -383,12 +420,20 @@ public:
   lbRingHashConfig() const override {
     return lb_ring_hash_config_;
   }
+  const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig>&
+  lbLeastRequestConfig() const override {
+    return lb_least_request_config_;
+  }
   const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>&
   lbOriginalDstConfig() const override {
     return lb_original_dst_config_;
   }
   bool maintenanceMode() const override;
   uint64_t maxRequestsPerConnection() const override { return max_requests_per_connection_; }
+  float prefetchRatio() const override { return prefetch_ratio_; }
+  const absl::optional<PendingRequestQueueConfig>& pendingRequestQueue() const override {
+    return pending_request_queue_;
+  }
   const std::string& name() const override { return name_; }
   ResourceManager& resourceManager(ResourcePriority priority) const override;
   Network::TransportSocketFactory& transportSocketFactory() const override {
@@ -408,6 +453,7 @@ public:
   };
 
   bool drainConnectionsOnHostRemoval() const override { return drain_connections_on_host_removal_; }
+  absl::optional<uint64_t> sharedConnPoolKey() const override { return shared_conn_pool_key_; }
 
 private:
   struct ResourceManagers {
@@ -426,9 +472,12 @@ private:
   const std::string name_;
   const envoy::api::v2::Cluster::DiscoveryType type_;
   const uint64_t max_requests_per_connection_;
+  const float prefetch_ratio_;
+  absl::optional<PendingRequestQueueConfig> pending_request_queue_;
   const std::chrono::milliseconds connect_timeout_;
   absl::optional<std::chrono::milliseconds> idle_timeout_;
   const uint32_t per_connection_buffer_limit_bytes_;
+  const uint32_t per_connection_buffer_limit_max_bytes_;
   Network::TransportSocketFactoryPtr transport_socket_factory_;
   Stats::ScopePtr stats_scope_;
   mutable ClusterStats stats_;
@@ -442,6 +491,7 @@ private:
   const Network::Address::InstanceConstSharedPtr source_address_;
   LoadBalancerType lb_type_;
   absl::optional<envoy::api::v2::Cluster::RingHashLbConfig> lb_ring_hash_config_;
+  absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig> lb_least_request_config_;
   absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig> lb_original_dst_config_;
   const bool added_via_api_;
   LoadBalancerSubsetInfoImpl lb_subset_;
@@ -449,6 +499,7 @@ private:
   const envoy::api::v2::Cluster::CommonLbConfig common_lb_config_;
   const Network::ConnectionSocket::OptionsSharedPtr cluster_socket_options_;
   const bool drain_connections_on_host_removal_;
+  const absl::optional<uint64_t> shared_conn_pool_key_;
 };
 
 /**
@@ -504,6 +555,7 @@ public:
 
   // Upstream::Cluster
   HealthChecker* healthChecker() override { return health_checker_.get(); }
+  const HealthChecker* healthChecker() const override { return health_checker_.get(); }
   ClusterInfoConstSharedPtr info() const override { return info_; }
   Outlier::Detector* outlierDetector() override { return outlier_detector_.get(); }
   const Outlier::Detector* outlierDetector() const override { return outlier_detector_.get(); }
@@ -3,9 +3,12 @@
 #include <iostream>
 #include <memory>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/compiler_requirements.h"
 #include "common/common/perf_annotation.h"
+#include "common/common/regex.h"
 #include "common/event/libevent.h"
+#include "common/network/connection_impl.h"
 #include "common/network/utility.h"
 #include "common/stats/thread_local_store.h"
 
@@ -43,6 +46,18 @@ MainCommonBase::MainCommonBase(OptionsImpl& options) : options_(options) {
   Event::Libevent::Global::initialize();
   RELEASE_ASSERT(Envoy::Server::validateProtoDescriptors(), "");
 
+  // These process wide settings must be in place before any dispatcher, connection, buffer or
+  // regex is created, including by config validation.
+  Event::Libevent::Global::setBackend(
+      options_.eventLoopBackend() == Server::EventLoopBackend::EpollChangelist
+          ? Event::Libevent::Backend::EpollChangelist
+          : Event::Libevent::Backend::Default);
+  Network::ConnectionImpl::setReadBudget(options_.readBudgetBytes());
+  Buffer::OwnedImpl::useOldImpl(options_.useLibeventBuffers());
+  Regex::Utility::setDefaultEngine(options_.useStdRegex() ? Regex::Engine::StdRegex
+                                                          : Regex::Engine::GoogleRe2);
+  Regex::Utility::setMaxProgramSize(options_.maxRegexProgramSize());
+
   switch (options_.mode()) {
   case Server::Mode::InitOnly:
   case Server::Mode::Serve: {
@@ -33,7 +33,7 @@ HttpGrpcAccessLogFactory::createAccessLogInstance(const Protobuf::Message& confi
             return std::make_shared<GrpcAccessLogStreamerImpl>(
                 context.clusterManager().grpcAsyncClientManager().factoryForGrpcService(
                     grpc_service, context.scope(), false),
-                context.threadLocal(), context.localInfo());
+                context.threadLocal(), context.localInfo(), context.scope());
           });
 
   return std::make_shared<HttpGrpcAccessLog>(std::move(filter), proto_config,
@@ -1,8 +1,11 @@
 #include "extensions/access_loggers/http_grpc/grpc_access_log_impl.h"
 
+#include <tuple>
+
 #include "common/common/assert.h"
 #include "common/http/header_map_impl.h"
 #include "common/network/utility.h"
+#include "common/protobuf/utility.h"
 #include "common/request_info/utility.h"
 
 namespace Envoy {
@@ -12,54 +15,99 @@ namespace HttpGrpc {
 
 GrpcAccessLogStreamerImpl::GrpcAccessLogStreamerImpl(Grpc::AsyncClientFactoryPtr&& factory,
                                                      ThreadLocal::SlotAllocator& tls,
-                                                     const LocalInfo::LocalInfo& local_info)
+                                                     const LocalInfo::LocalInfo& local_info,
+                                                     Stats::Scope& scope)
     : tls_slot_(tls.allocateSlot()) {
-  SharedStateSharedPtr shared_state = std::make_shared<SharedState>(std::move(factory), local_info);
-  tls_slot_->set([shared_state](Event::Dispatcher&) {
-    return ThreadLocal::ThreadLocalObjectSharedPtr{new ThreadLocalStreamer(shared_state)};
+  SharedStateSharedPtr shared_state =
+      std::make_shared<SharedState>(std::move(factory), local_info, scope);
+  tls_slot_->set([shared_state](Event::Dispatcher& dispatcher) {
+    return ThreadLocal::ThreadLocalObjectSharedPtr{
+        new ThreadLocalStreamer(shared_state, dispatcher)};
   });
 }
 
-void GrpcAccessLogStreamerImpl::ThreadLocalStream::onRemoteClose(Grpc::Status::GrpcStatus,
-                                                                 const std::string&) {
-  auto it = parent_.stream_map_.find(log_name_);
-  ASSERT(it != parent_.stream_map_.end());
-  if (it->second.stream_ != nullptr) {
-    // Only erase if we have a stream. Otherwise we had an inline failure and we will clear the
-    // stream data in send().
-    parent_.stream_map_.erase(it);
-  }
+GrpcAccessLogStreamerImpl::ThreadLocalStream::ThreadLocalStream(
+    ThreadLocalStreamer& parent,
+    const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config)
+    : parent_(parent), log_name_(config.log_name()),
+      buffer_size_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, buffer_size_bytes, 16384)),
+      buffer_flush_interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, buffer_flush_interval, 1000)),
+      flush_timer_(parent.dispatcher_.createTimer([this]() -> void {
+        flush();
+        flush_timer_->enableTimer(buffer_flush_interval_);
+      })) {
+  flush_timer_->enableTimer(buffer_flush_interval_);
 }
 
-GrpcAccessLogStreamerImpl::ThreadLocalStreamer::ThreadLocalStreamer(
-    const SharedStateSharedPtr& shared_state)
-    : client_(shared_state->factory_->create()), shared_state_(shared_state) {}
+void GrpcAccessLogStreamerImpl::ThreadLocalStream::send(
+    envoy::service::accesslog::v2::StreamAccessLogsMessage& message) {
+  auto* log_entries = message_.mutable_http_logs()->mutable_log_entry();
+  for (auto& log_entry : *message.mutable_http_logs()->mutable_log_entry()) {
+    message_size_bytes_ += log_entry.ByteSizeLong();
+    log_entries->Add()->Swap(&log_entry);
+  }
 
-void GrpcAccessLogStreamerImpl::ThreadLocalStreamer::send(
-    envoy::service::accesslog::v2::StreamAccessLogsMessage& message, const std::string& log_name) {
-  auto stream_it = stream_map_.find(log_name);
-  if (stream_it == stream_map_.end()) {
-    stream_it = stream_map_.emplace(log_name, ThreadLocalStream(*this, log_name)).first;
+  if (message_size_bytes_ >= buffer_size_bytes_) {
+    flush();
+  }
+}
+
+void GrpcAccessLogStreamerImpl::ThreadLocalStream::flush() {
+  const int num_log_entries = message_.http_logs().log_entry_size();
+  if (num_log_entries == 0) {
+    return;
   }
 
-  auto& stream_entry = stream_it->second;
-  if (stream_entry.stream_ == nullptr) {
-    stream_entry.stream_ =
-        client_->start(*Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
-                           "envoy.service.accesslog.v2.AccessLogService.StreamAccessLogs"),
-                       stream_entry);
+  if (stream_ == nullptr) {
+    stream_ =
+        parent_.client_->start(*Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
+                                   "envoy.service.accesslog.v2.AccessLogService.StreamAccessLogs"),
+                               *this);
 
-    auto* identifier = message.mutable_identifier();
-    *identifier->mutable_node() = shared_state_->local_info_.node();
-    identifier->set_log_name(log_name);
+    // The first message on a stream identifies the log.
+    auto* identifier = message_.mutable_identifier();
+    *identifier->mutable_node() = parent_.shared_state_->local_info_.node();
+    identifier->set_log_name(log_name_);
   }
 
-  if (stream_entry.stream_ != nullptr) {
-    stream_entry.stream_->sendMessage(message, false);
+  if (stream_ != nullptr) {
+    stream_->sendMessage(message_, false);
+    parent_.shared_state_->stats_.logs_written_.add(num_log_entries);
   } else {
-    // Clear out the stream data due to stream creation failure.
-    stream_map_.erase(stream_it);
+    // The stream could not be created. Rather than buffering without bound until the access log
+    // service comes back, drop what we have and try again with the next batch.
+    parent_.shared_state_->stats_.logs_dropped_.add(num_log_entries);
+  }
+
+  message_.Clear();
+  message_size_bytes_ = 0;
+}
+
+void GrpcAccessLogStreamerImpl::ThreadLocalStream::onRemoteClose(Grpc::Status::GrpcStatus,
+                                                                 const std::string&) {
+  // Buffered entries are sent on a new stream with the next flush. This may also be called inline
+  // from start() if the stream could not be created, in which case flush() drops them.
+  stream_ = nullptr;
+}
+
+GrpcAccessLogStreamerImpl::ThreadLocalStreamer::ThreadLocalStreamer(
+    const SharedStateSharedPtr& shared_state, Event::Dispatcher& dispatcher)
+    : dispatcher_(dispatcher), client_(shared_state->factory_->create()),
+      shared_state_(shared_state) {}
+
+void GrpcAccessLogStreamerImpl::ThreadLocalStreamer::send(
+    envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
+    const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config) {
+  auto stream_it = stream_map_.find(config.log_name());
+  if (stream_it == stream_map_.end()) {
+    // Constructed in place, as the flush timer and the gRPC stream refer to it.
+    stream_it = stream_map_
+                    .emplace(std::piecewise_construct, std::forward_as_tuple(config.log_name()),
+                             std::forward_as_tuple(*this, config))
+                    .first;
   }
+
+  stream_it->second.send(message);
 }
 
 HttpGrpcAccessLog::HttpGrpcAccessLog(
@@ -337,8 +385,7 @@ void HttpGrpcAccessLog::log(const Http::HeaderMap* request_headers,
     }
   }
 
-  // TODO(mattklein123): Consider batching multiple logs and flushing.
-  grpc_access_log_streamer_->send(message, config_.common_config().log_name());
+  grpc_access_log_streamer_->send(message, config_.common_config());
 }
 
 } // namespace HttpGrpc
@@ -1,16 +1,21 @@
 #pragma once
 
+#include <chrono>
 #include <unordered_map>
 #include <vector>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/config/accesslog/v2/als.pb.h"
 #include "envoy/config/filter/accesslog/v2/accesslog.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
 #include "envoy/grpc/async_client.h"
 #include "envoy/grpc/async_client_manager.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/service/accesslog/v2/als.pb.h"
 #include "envoy/singleton/instance.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 #include "envoy/thread_local/thread_local.h"
 
 namespace Envoy {
@@ -18,7 +23,21 @@ namespace Extensions {
 namespace AccessLoggers {
 namespace HttpGrpc {
 
-// TODO(mattklein123): Stats
+/**
+ * All gRPC access log stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_GRPC_ACCESS_LOG_STATS(COUNTER)                                                         \
+  COUNTER(logs_written)                                                                            \
+  COUNTER(logs_dropped)
+// clang-format on
+
+/**
+ * Struct definition for all gRPC access log stats. @see stats_macros.h
+ */
+struct GrpcAccessLogStats {
+  ALL_GRPC_ACCESS_LOG_STATS(GENERATE_COUNTER_STRUCT)
+};
 
 /**
  * Interface for an access log streamer. The streamer deals with threading and sends access logs
@@ -29,12 +48,14 @@ public:
   virtual ~GrpcAccessLogStreamer() {}
 
   /**
-   * Send an access log.
+   * Send an access log. The log entries are moved out of the message and may be buffered, to be
+   * sent batched with other entries of the same log.
    * @param message supplies the access log to send.
-   * @param log_name supplies the name of the log stream to send on.
+   * @param config supplies the configuration of the log, including the name of the log stream to
+   *        send on.
    */
   virtual void send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
-                    const std::string& log_name) PURE;
+                    const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config) PURE;
 };
 
 typedef std::shared_ptr<GrpcAccessLogStreamer> GrpcAccessLogStreamerSharedPtr;
@@ -46,12 +67,12 @@ typedef std::shared_ptr<GrpcAccessLogStreamer> GrpcAccessLogStreamerSharedPtr;
 class GrpcAccessLogStreamerImpl : public Singleton::Instance, public GrpcAccessLogStreamer {
 public:
   GrpcAccessLogStreamerImpl(Grpc::AsyncClientFactoryPtr&& factory, ThreadLocal::SlotAllocator& tls,
-                            const LocalInfo::LocalInfo& local_info);
+                            const LocalInfo::LocalInfo& local_info, Stats::Scope& scope);
 
   // GrpcAccessLogStreamer
   void send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
-            const std::string& log_name) override {
-    tls_slot_->getTyped<ThreadLocalStreamer>().send(message, log_name);
+            const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config) override {
+    tls_slot_->getTyped<ThreadLocalStreamer>().send(message, config);
   }
 
 private:
@@ -60,11 +81,15 @@ private:
    * slot to be destroyed while the streamers hold onto the shared state.
    */
   struct SharedState {
-    SharedState(Grpc::AsyncClientFactoryPtr&& factory, const LocalInfo::LocalInfo& local_info)
-        : factory_(std::move(factory)), local_info_(local_info) {}
+    SharedState(Grpc::AsyncClientFactoryPtr&& factory, const LocalInfo::LocalInfo& local_info,
+                Stats::Scope& scope)
+        : factory_(std::move(factory)), local_info_(local_info),
+          stats_({ALL_GRPC_ACCESS_LOG_STATS(
+              POOL_COUNTER_PREFIX(scope, "access_logs.grpc_access_log."))}) {}
 
     Grpc::AsyncClientFactoryPtr factory_;
     const LocalInfo::LocalInfo& local_info_;
+    GrpcAccessLogStats stats_;
   };
 
   typedef std::shared_ptr<SharedState> SharedStateSharedPtr;
@@ -76,8 +101,11 @@ private:
    */
   struct ThreadLocalStream : public Grpc::TypedAsyncStreamCallbacks<
                                  envoy::service::accesslog::v2::StreamAccessLogsResponse> {
-    ThreadLocalStream(ThreadLocalStreamer& parent, const std::string& log_name)
-        : parent_(parent), log_name_(log_name) {}
+    ThreadLocalStream(ThreadLocalStreamer& parent,
+                      const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config);
+
+    void send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message);
+    void flush();
 
     // Grpc::TypedAsyncStreamCallbacks
     void onCreateInitialMetadata(Http::HeaderMap&) override {}
@@ -89,6 +117,12 @@ private:
 
     ThreadLocalStreamer& parent_;
     const std::string log_name_;
+    const uint64_t buffer_size_bytes_;
+    const std::chrono::milliseconds buffer_flush_interval_;
+    Event::TimerPtr flush_timer_;
+    // Cleared rather than replaced once sent, so that the entries it allocated are reused.
+    envoy::service::accesslog::v2::StreamAccessLogsMessage message_;
+    uint64_t message_size_bytes_{};
     Grpc::AsyncStream* stream_{};
   };
 
@@ -96,10 +130,11 @@ private:
    * Per-thread multi-stream state.
    */
   struct ThreadLocalStreamer : public ThreadLocal::ThreadLocalObject {
-    ThreadLocalStreamer(const SharedStateSharedPtr& shared_state);
+    ThreadLocalStreamer(const SharedStateSharedPtr& shared_state, Event::Dispatcher& dispatcher);
     void send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
-              const std::string& log_name);
+              const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config);
 
+    Event::Dispatcher& dispatcher_;
     Grpc::AsyncClientPtr client_;
     std::unordered_map<std::string, ThreadLocalStream> stream_map_;
     SharedStateSharedPtr shared_state_;
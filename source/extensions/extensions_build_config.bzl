@@ -23,7 +23,9 @@ EXTENSIONS = {
     # HTTP filters
     #
 
+    "envoy.filters.http.adaptive_concurrency":          "//source/extensions/filters/http/adaptive_concurrency:config",
     "envoy.filters.http.buffer":                        "//source/extensions/filters/http/buffer:config",
+    "envoy.filters.http.cache":                         "//source/extensions/filters/http/cache:config",
     "envoy.filters.http.cors":                          "//source/extensions/filters/http/cors:config",
     "envoy.filters.http.dynamo":                        "//source/extensions/filters/http/dynamo:config",
     "envoy.filters.http.ext_authz":                     "//source/extensions/filters/http/ext_authz:config",
@@ -71,10 +73,17 @@ EXTENSIONS = {
     "envoy.filters.network.tcp_proxy":                  "//source/extensions/filters/network/tcp_proxy:config",
     "envoy.filters.network.thrift_proxy":               "//source/extensions/filters/network/thrift_proxy:config",
 
+    #
+    # UDP listener filters
+    #
+
+    "envoy.filters.udp.udp_proxy":                      "//source/extensions/filters/udp/udp_proxy:config",
+
     #
     # Resource monitors
     #
 
+    "envoy.resource_monitors.cgroup_memory":            "//source/extensions/resource_monitors/cgroup_memory:config",
     "envoy.resource_monitors.fixed_heap":               "//source/extensions/resource_monitors/fixed_heap:config",
     "envoy.resource_monitors.injected_resource":        "//source/extensions/resource_monitors/injected_resource:config",
 
@@ -134,7 +143,9 @@ WINDOWS_EXTENSIONS = {
     # HTTP filters
     #
 
+    #"envoy.filters.http.adaptive_concurrency":          "//source/extensions/filters/http/adaptive_concurrency:config",
     #"envoy.filters.http.buffer":                        "//source/extensions/filters/http/buffer:config",
+    #"envoy.filters.http.cache":                         "//source/extensions/filters/http/cache:config",
     #"envoy.filters.http.cors":                          "//source/extensions/filters/http/cors:config",
     #"envoy.filters.http.dynamo":                        "//source/extensions/filters/http/dynamo:config",
     #"envoy.filters.http.ext_authz":                     "//source/extensions/filters/http/ext_authz:config",
@@ -10,6 +10,8 @@
 #include "envoy/service/auth/v2alpha/external_auth.pb.h"
 #include "envoy/tracing/http_tracer.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Filters {
@@ -42,6 +44,8 @@ struct Response {
   std::string body;
   // Optional http status used only on denied response.
   Http::Code status_code{};
+  // Optional time for which the authorization service allows the decision to be reused.
+  absl::optional<std::chrono::seconds> max_age;
 };
 
 typedef std::unique_ptr<Response> ResponsePtr;
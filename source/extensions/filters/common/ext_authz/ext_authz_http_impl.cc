@@ -3,7 +3,11 @@
 #include "common/common/enum_to_int.h"
 #include "common/http/async_client_impl.h"
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -18,6 +22,29 @@ const Http::HeaderMap* getZeroContentLengthHeader() {
       new Http::HeaderMapImpl{{Http::Headers::get().ContentLength, std::to_string(0)}};
   return header_map;
 }
+
+// Reads the max-age directive of a cache-control header, unless the header forbids caching.
+absl::optional<std::chrono::seconds> maxAge(const Http::HeaderEntry* cache_control) {
+  if (cache_control == nullptr) {
+    return absl::nullopt;
+  }
+
+  absl::optional<std::chrono::seconds> max_age;
+  for (absl::string_view directive : absl::StrSplit(cache_control->value().c_str(), ',')) {
+    directive = absl::StripAsciiWhitespace(directive);
+    if (absl::EqualsIgnoreCase(directive, "no-cache") ||
+        absl::EqualsIgnoreCase(directive, "no-store")) {
+      return std::chrono::seconds(0);
+    }
+
+    uint32_t seconds;
+    if (absl::StartsWithIgnoreCase(directive, "max-age=") &&
+        absl::SimpleAtoi(directive.substr(sizeof("max-age=") - 1), &seconds)) {
+      max_age = std::chrono::seconds(seconds);
+    }
+  }
+  return max_age;
+}
 } // namespace
 
 RawHttpClientImpl::RawHttpClientImpl(
@@ -81,6 +108,7 @@ void RawHttpClientImpl::onSuccess(Http::MessagePtr&& response) {
     authz_response->status_code = Http::Code::Forbidden;
     authz_response->status = CheckStatus::Denied;
   }
+  authz_response->max_age = maxAge(response->headers().CacheControl());
 
   for (const auto& allowed_header : allowed_authorization_headers_) {
     const auto* entry = response->headers().get(allowed_header);
@@ -10,6 +10,16 @@ namespace Filters {
 namespace Common {
 namespace Lua {
 
+namespace {
+// The most finished coroutines that each worker keeps for reuse.
+const uint64_t MaxPooledCoroutines = 128;
+
+int appendBytecode(lua_State*, const void* data, size_t size, void* bytecode) {
+  static_cast<std::string*>(bytecode)->append(static_cast<const char*>(data), size);
+  return 0;
+}
+} // namespace
+
 Coroutine::Coroutine(const std::pair<lua_State*, lua_State*>& new_thread_state)
     : coroutine_state_(new_thread_state, false) {}
 
@@ -39,25 +49,38 @@ void Coroutine::resume(int num_args, const std::function<void()>& yield_callback
     yield_callback();
   } else {
     state_ = State::Finished;
+    failed_ = true;
     const char* error = lua_tostring(coroutine_state_.get(), -1);
     throw LuaException(error);
   }
 }
 
+void Coroutine::reset() {
+  ASSERT(reusable());
+  // Drop the values returned by the previous function.
+  lua_settop(coroutine_state_.get(), 0);
+  state_ = State::NotStarted;
+}
+
 ThreadLocalState::ThreadLocalState(const std::string& code, ThreadLocal::SlotAllocator& tls)
     : tls_slot_(tls.allocateSlot()) {
 
-  // First verify that the supplied code can be parsed.
+  // First verify that the supplied code can be parsed and run. The code is compiled once, here,
+  // and the workers only load the resulting bytecode. The bytecode keeps the debug information,
+  // so errors are reported as if the code had been loaded from source.
   CSmartPtr<lua_State, lua_close> state(lua_open());
   luaL_openlibs(state.get());
 
-  if (0 != luaL_dostring(state.get(), code.c_str())) {
+  std::string bytecode;
+  if (0 != luaL_loadstring(state.get(), code.c_str()) ||
+      0 != lua_dump(state.get(), appendBytecode, &bytecode) ||
+      0 != lua_pcall(state.get(), 0, LUA_MULTRET, 0)) {
     throw LuaException(fmt::format("script load error: {}", lua_tostring(state.get(), -1)));
   }
 
   // Now initialize on all threads.
-  tls_slot_->set([code](Event::Dispatcher&) {
-    return ThreadLocal::ThreadLocalObjectSharedPtr{new LuaThreadLocal(code)};
+  tls_slot_->set([bytecode](Event::Dispatcher&) {
+    return ThreadLocal::ThreadLocalObjectSharedPtr{new LuaThreadLocal(bytecode)};
   });
 }
 
@@ -84,13 +107,39 @@ uint64_t ThreadLocalState::registerGlobal(const std::string& global) {
 }
 
 CoroutinePtr ThreadLocalState::createCoroutine() {
-  lua_State* state = tls_slot_->getTyped<LuaThreadLocal>().state_.get();
+  LuaThreadLocal& tls = tls_slot_->getTyped<LuaThreadLocal>();
+  if (!tls.coroutine_pool_.empty()) {
+    CoroutinePtr coroutine = std::move(tls.coroutine_pool_.back());
+    tls.coroutine_pool_.pop_back();
+    return coroutine;
+  }
+
+  lua_State* state = tls.state_.get();
   return CoroutinePtr{new Coroutine({lua_newthread(state), state})};
 }
 
-ThreadLocalState::LuaThreadLocal::LuaThreadLocal(const std::string& code) : state_(lua_open()) {
+void ThreadLocalState::releaseCoroutine(CoroutinePtr&& coroutine) {
+  if (coroutine == nullptr || !coroutine->reusable()) {
+    return;
+  }
+
+  LuaThreadLocal& tls = tls_slot_->getTyped<LuaThreadLocal>();
+  if (tls.coroutine_pool_.size() < MaxPooledCoroutines) {
+    coroutine->reset();
+    tls.coroutine_pool_.push_back(std::move(coroutine));
+  }
+}
+
+uint64_t ThreadLocalState::pooledCoroutines() {
+  return tls_slot_->getTyped<LuaThreadLocal>().coroutine_pool_.size();
+}
+
+ThreadLocalState::LuaThreadLocal::LuaThreadLocal(const std::string& bytecode)
+    : state_(lua_open()) {
   luaL_openlibs(state_.get());
-  int rc = luaL_dostring(state_.get(), code.c_str());
+  int rc = luaL_loadbuffer(state_.get(), bytecode.data(), bytecode.size(), "bytecode");
+  ASSERT(rc == 0);
+  rc = lua_pcall(state_.get(), 0, LUA_MULTRET, 0);
   ASSERT(rc == 0);
 }
 
@@ -324,9 +324,21 @@ public:
    */
   void resume(int num_args, const std::function<void()>& yield_callback);
 
+  /**
+   * @return bool whether the coroutine ran to completion without an error, so that its Lua thread
+   *         can start another function.
+   */
+  bool reusable() const { return state_ == State::Finished && !failed_; }
+
+  /**
+   * Return a reusable coroutine to the NotStarted state.
+   */
+  void reset();
+
 private:
   LuaRef<lua_State> coroutine_state_;
   State state_{State::NotStarted};
+  bool failed_{};
 };
 
 typedef std::unique_ptr<Coroutine> CoroutinePtr;
@@ -341,10 +353,22 @@ public:
   ThreadLocalState(const std::string& code, ThreadLocal::SlotAllocator& tls);
 
   /**
-   * @return CoroutinePtr a new coroutine.
+   * @return CoroutinePtr a new coroutine, which may reuse the Lua thread of a released one.
    */
   CoroutinePtr createCoroutine();
 
+  /**
+   * Release a coroutine that is no longer needed. If it finished without an error, its Lua thread
+   * is kept for a later createCoroutine() on the same worker instead of being garbage collected.
+   * @param coroutine supplies the coroutine, which may be nullptr.
+   */
+  void releaseCoroutine(CoroutinePtr&& coroutine);
+
+  /**
+   * @return uint64_t the number of coroutines kept for reuse by the current worker.
+   */
+  uint64_t pooledCoroutines();
+
   /**
    * @return a global reference previously registered via registerGlobal(). This may return
    *         LUA_REFNIL if there was no such global.
@@ -385,10 +409,12 @@ public:
 
 private:
   struct LuaThreadLocal : public ThreadLocal::ThreadLocalObject {
-    LuaThreadLocal(const std::string& code);
+    LuaThreadLocal(const std::string& bytecode);
 
     CSmartPtr<lua_State, lua_close> state_;
     std::vector<int> global_slots_;
+    // Declared after the state so that the coroutines are released before it is closed.
+    std::vector<CoroutinePtr> coroutine_pool_;
   };
 
   ThreadLocal::SlotPtr tls_slot_;
@@ -1,5 +1,7 @@
 #include "extensions/filters/common/rbac/engine_impl.h"
 
+#include <map>
+
 #include "common/http/header_map_impl.h"
 
 namespace Envoy {
@@ -12,8 +14,19 @@ RoleBasedAccessControlEngineImpl::RoleBasedAccessControlEngineImpl(
     const envoy::config::rbac::v2alpha::RBAC& rules)
     : allowed_if_matched_(rules.action() ==
                           envoy::config::rbac::v2alpha::RBAC_Action::RBAC_Action_ALLOW) {
+  std::map<std::string, const envoy::config::rbac::v2alpha::Policy*> sorted_policies;
   for (const auto& policy : rules.policies()) {
-    policies_.insert(std::make_pair(policy.first, policy.second));
+    sorted_policies.emplace(policy.first, &policy.second);
+  }
+
+  std::vector<const envoy::config::rbac::v2alpha::Policy*> policies;
+  for (const auto& policy : sorted_policies) {
+    policies_.emplace_back(policy.first, PolicyMatcher(*policy.second));
+    policies.push_back(policy.second);
+  }
+
+  if (policies_.size() >= MinIndexedPolicies) {
+    index_ = std::make_unique<const PolicyIndex>(policies);
   }
 }
 
@@ -21,16 +34,30 @@ bool RoleBasedAccessControlEngineImpl::allowed(const Network::Connection& connec
                                                const Envoy::Http::HeaderMap& headers,
                                                const envoy::api::v2::core::Metadata& metadata,
                                                std::string* effective_policy_id) const {
-  bool matched = false;
+  const std::pair<std::string, PolicyMatcher>* matched_policy = nullptr;
 
-  for (auto it = policies_.begin(); it != policies_.end(); it++) {
-    if (it->second.matches(connection, headers, metadata)) {
-      matched = true;
-      if (effective_policy_id != nullptr) {
-        *effective_policy_id = it->first;
+  if (index_ == nullptr) {
+    for (const auto& policy : policies_) {
+      if (policy.second.matches(connection, headers, metadata)) {
+        matched_policy = &policy;
+        break;
       }
-      break;
     }
+  } else {
+    // Only the candidates may match, and they are in order, so the first match is the same.
+    std::vector<uint32_t> candidates;
+    index_->candidates(connection, headers, candidates);
+    for (uint32_t candidate : candidates) {
+      if (policies_[candidate].second.matches(connection, headers, metadata)) {
+        matched_policy = &policies_[candidate];
+        break;
+      }
+    }
+  }
+
+  const bool matched = matched_policy != nullptr;
+  if (matched && effective_policy_id != nullptr) {
+    *effective_policy_id = matched_policy->first;
   }
 
   // only allowed if:
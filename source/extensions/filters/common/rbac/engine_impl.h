@@ -1,9 +1,14 @@
 #pragma once
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "envoy/config/filter/http/rbac/v2/rbac.pb.h"
 
 #include "extensions/filters/common/rbac/engine.h"
 #include "extensions/filters/common/rbac/matchers.h"
+#include "extensions/filters/common/rbac/policy_index.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -21,10 +26,20 @@ public:
 
   bool allowed(const Network::Connection& connection) const override;
 
+  /**
+   * @return bool whether the policies are looked up in an index rather than evaluated in turn.
+   */
+  bool indexed() const { return index_ != nullptr; }
+
+  // Fewer policies are evaluated in turn, as indexing them costs more than it saves.
+  static const size_t MinIndexedPolicies = 16;
+
 private:
   const bool allowed_if_matched_;
 
-  std::map<std::string, PolicyMatcher> policies_;
+  // The policies ordered by name, which is the order they are evaluated in.
+  std::vector<std::pair<std::string, PolicyMatcher>> policies_;
+  PolicyIndexConstPtr index_;
 };
 
 } // namespace RBAC
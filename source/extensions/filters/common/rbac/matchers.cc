@@ -1,5 +1,7 @@
 #include "extensions/filters/common/rbac/matchers.h"
 
+#include <algorithm>
+
 #include "common/common/assert.h"
 
 namespace Envoy {
@@ -8,6 +10,70 @@ namespace Filters {
 namespace Common {
 namespace RBAC {
 
+namespace {
+
+// The relative cost of evaluating a rule, so that composite matchers evaluate the cheap rules
+// first and short-circuit before the expensive ones.
+uint32_t cost(const envoy::api::v2::route::HeaderMatcher& header) {
+  return header.header_match_specifier_case() ==
+                 envoy::api::v2::route::HeaderMatcher::HeaderMatchSpecifierCase::kRegexMatch
+             ? 5
+             : 3;
+}
+
+uint32_t cost(const envoy::config::rbac::v2alpha::Permission& permission) {
+  switch (permission.rule_case()) {
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kAny:
+    return 0;
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kDestinationPort:
+    return 1;
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kDestinationIp:
+    return 2;
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kHeader:
+    return cost(permission.header());
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kMetadata:
+    return 4;
+  default:
+    return 6;
+  }
+}
+
+uint32_t cost(const envoy::config::rbac::v2alpha::Principal& principal) {
+  switch (principal.identifier_case()) {
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kAny:
+    return 0;
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kSourceIp:
+    return 2;
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kHeader:
+    return cost(principal.header());
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kAuthenticated:
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kMetadata:
+    return 4;
+  default:
+    return 6;
+  }
+}
+
+// The rules are side effect free, so the result of a composite matcher does not depend on their
+// order.
+template <class Rule>
+std::vector<MatcherConstSharedPtr> createOrdered(const Protobuf::RepeatedPtrField<Rule>& rules) {
+  std::vector<const Rule*> ordered;
+  for (const auto& rule : rules) {
+    ordered.push_back(&rule);
+  }
+  std::stable_sort(ordered.begin(), ordered.end(),
+                   [](const Rule* lhs, const Rule* rhs) { return cost(*lhs) < cost(*rhs); });
+
+  std::vector<MatcherConstSharedPtr> matchers;
+  for (const Rule* rule : ordered) {
+    matchers.push_back(Matcher::create(*rule));
+  }
+  return matchers;
+}
+
+} // namespace
+
 MatcherConstSharedPtr Matcher::create(const envoy::config::rbac::v2alpha::Permission& permission) {
   switch (permission.rule_case()) {
   case envoy::config::rbac::v2alpha::Permission::RuleCase::kAndRules:
@@ -54,17 +120,11 @@ MatcherConstSharedPtr Matcher::create(const envoy::config::rbac::v2alpha::Princi
   }
 }
 
-AndMatcher::AndMatcher(const envoy::config::rbac::v2alpha::Permission_Set& set) {
-  for (const auto& rule : set.rules()) {
-    matchers_.push_back(Matcher::create(rule));
-  }
-}
+AndMatcher::AndMatcher(const envoy::config::rbac::v2alpha::Permission_Set& set)
+    : matchers_(createOrdered(set.rules())) {}
 
-AndMatcher::AndMatcher(const envoy::config::rbac::v2alpha::Principal_Set& set) {
-  for (const auto& id : set.ids()) {
-    matchers_.push_back(Matcher::create(id));
-  }
-}
+AndMatcher::AndMatcher(const envoy::config::rbac::v2alpha::Principal_Set& set)
+    : matchers_(createOrdered(set.ids())) {}
 
 bool AndMatcher::matches(const Network::Connection& connection,
                          const Envoy::Http::HeaderMap& headers,
@@ -79,18 +139,12 @@ bool AndMatcher::matches(const Network::Connection& connection,
 }
 
 OrMatcher::OrMatcher(
-    const Protobuf::RepeatedPtrField<::envoy::config::rbac::v2alpha::Permission>& rules) {
-  for (const auto& rule : rules) {
-    matchers_.push_back(Matcher::create(rule));
-  }
-}
+    const Protobuf::RepeatedPtrField<::envoy::config::rbac::v2alpha::Permission>& rules)
+    : matchers_(createOrdered(rules)) {}
 
 OrMatcher::OrMatcher(
-    const Protobuf::RepeatedPtrField<::envoy::config::rbac::v2alpha::Principal>& ids) {
-  for (const auto& id : ids) {
-    matchers_.push_back(Matcher::create(id));
-  }
-}
+    const Protobuf::RepeatedPtrField<::envoy::config::rbac::v2alpha::Principal>& ids)
+    : matchers_(createOrdered(ids)) {}
 
 bool OrMatcher::matches(const Network::Connection& connection,
                         const Envoy::Http::HeaderMap& headers,
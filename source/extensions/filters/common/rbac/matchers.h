@@ -64,7 +64,7 @@ public:
 
 /**
  * A composite matcher where all sub-matchers must match for this to return true. Evaluation
- * short-circuits on the first non-match.
+ * short-circuits on the first non-match, and the cheapest sub-matchers are evaluated first.
  */
 class AndMatcher : public Matcher {
 public:
@@ -80,7 +80,7 @@ private:
 
 /**
  * A composite matcher where only one sub-matcher must match for this to return true. Evaluation
- * short-circuits on the first match.
+ * short-circuits on the first match, and the cheapest sub-matchers are evaluated first.
  */
 class OrMatcher : public Matcher {
 public:
@@ -0,0 +1,239 @@
+#include "extensions/filters/common/rbac/policy_index.h"
+
+#include <algorithm>
+
+#include "common/http/header_utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+namespace {
+
+typedef std::vector<std::pair<uint32_t, std::vector<Network::Address::CidrRange>>> CidrRangeData;
+
+// An invalid range never matches, so it is no condition of a match.
+void addRange(Network::Address::CidrRange&& range,
+              std::vector<Network::Address::CidrRange>& ranges) {
+  if (range.isValid()) {
+    ranges.push_back(std::move(range));
+  }
+}
+
+void append(const std::vector<uint32_t>& policies, std::vector<uint32_t>& candidates) {
+  candidates.insert(candidates.end(), policies.begin(), policies.end());
+}
+
+} // namespace
+
+PolicyIndex::PolicyIndex(const std::vector<const envoy::config::rbac::v2alpha::Policy*>& policies) {
+  CidrRangeData source_ips;
+  CidrRangeData destination_ips;
+
+  for (uint32_t i = 0; i < policies.size(); i++) {
+    // A policy matches if one of its permissions and one of its principals match, so either list
+    // gives the conditions one of which the policy requires.
+    Conditions conditions;
+    bool indexed = std::all_of(
+        policies[i]->permissions().begin(), policies[i]->permissions().end(),
+        [&conditions](const envoy::config::rbac::v2alpha::Permission& permission) {
+          return collect(permission, conditions);
+        });
+    if (!indexed) {
+      conditions = Conditions();
+      indexed = std::all_of(
+          policies[i]->principals().begin(), policies[i]->principals().end(),
+          [&conditions](const envoy::config::rbac::v2alpha::Principal& principal) {
+            return collect(principal, conditions);
+          });
+    }
+
+    if (indexed) {
+      add(i, conditions, source_ips, destination_ips);
+    } else {
+      unindexed_.push_back(i);
+    }
+  }
+
+  if (!source_ips.empty()) {
+    source_ips_ = std::make_unique<Network::LcTrie::LcTrie<uint32_t>>(source_ips);
+  }
+  if (!destination_ips.empty()) {
+    destination_ips_ = std::make_unique<Network::LcTrie::LcTrie<uint32_t>>(destination_ips);
+  }
+}
+
+bool PolicyIndex::collect(const envoy::config::rbac::v2alpha::Permission& permission,
+                          Conditions& conditions) {
+  switch (permission.rule_case()) {
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kAndRules:
+    // Every rule is required, so the first one which has conditions will do.
+    for (const auto& rule : permission.and_rules().rules()) {
+      Conditions rule_conditions;
+      if (collect(rule, rule_conditions)) {
+        return collect(rule, conditions);
+      }
+    }
+    return false;
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kOrRules:
+    for (const auto& rule : permission.or_rules().rules()) {
+      if (!collect(rule, conditions)) {
+        return false;
+      }
+    }
+    return true;
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kHeader:
+    return collect(permission.header(), conditions);
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kDestinationIp:
+    addRange(Network::Address::CidrRange::create(permission.destination_ip()),
+             conditions.destination_ips_);
+    return true;
+  case envoy::config::rbac::v2alpha::Permission::RuleCase::kDestinationPort:
+    conditions.ports_.push_back(permission.destination_port());
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool PolicyIndex::collect(const envoy::config::rbac::v2alpha::Principal& principal,
+                          Conditions& conditions) {
+  switch (principal.identifier_case()) {
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kAndIds:
+    for (const auto& id : principal.and_ids().ids()) {
+      Conditions id_conditions;
+      if (collect(id, id_conditions)) {
+        return collect(id, conditions);
+      }
+    }
+    return false;
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kOrIds:
+    for (const auto& id : principal.or_ids().ids()) {
+      if (!collect(id, conditions)) {
+        return false;
+      }
+    }
+    return true;
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kHeader:
+    return collect(principal.header(), conditions);
+  case envoy::config::rbac::v2alpha::Principal::IdentifierCase::kSourceIp:
+    addRange(Network::Address::CidrRange::create(principal.source_ip()), conditions.source_ips_);
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool PolicyIndex::collect(const envoy::api::v2::route::HeaderMatcher& header,
+                          Conditions& conditions) {
+  const Http::HeaderUtility::HeaderData data(header);
+  if (data.invert_match_) {
+    return false;
+  }
+
+  switch (data.header_match_type_) {
+  case Http::HeaderUtility::HeaderMatchType::Value:
+    // An empty value matches any value.
+    if (data.value_.empty()) {
+      return false;
+    }
+    conditions.exact_headers_.emplace_back(data.name_.get(), data.value_);
+    return true;
+  case Http::HeaderUtility::HeaderMatchType::Prefix:
+    conditions.prefix_headers_.emplace_back(data.name_.get(), data.value_);
+    return true;
+  default:
+    return false;
+  }
+}
+
+void PolicyIndex::add(uint32_t policy, const Conditions& conditions, CidrRangeData& source_ips,
+                      CidrRangeData& destination_ips) {
+  for (uint32_t port : conditions.ports_) {
+    ports_[port].push_back(policy);
+  }
+  if (!conditions.source_ips_.empty()) {
+    source_ips.emplace_back(policy, conditions.source_ips_);
+  }
+  if (!conditions.destination_ips_.empty()) {
+    destination_ips.emplace_back(policy, conditions.destination_ips_);
+  }
+
+  auto header_index = [this](const std::string& name) -> HeaderIndex& {
+    for (auto& header : headers_) {
+      if (header.first.get() == name) {
+        return header.second;
+      }
+    }
+    headers_.emplace_back(Http::LowerCaseString(name), HeaderIndex());
+    return headers_.back().second;
+  };
+  for (const auto& header : conditions.exact_headers_) {
+    header_index(header.first).exact_[header.second].push_back(policy);
+  }
+  for (const auto& header : conditions.prefix_headers_) {
+    HeaderIndex& index = header_index(header.first);
+    index.prefixes_[header.second].push_back(policy);
+    index.prefix_lengths_.insert(header.second.size());
+  }
+}
+
+void PolicyIndex::candidates(const Network::Connection& connection, const Http::HeaderMap& headers,
+                             std::vector<uint32_t>& candidates) const {
+  candidates = unindexed_;
+
+  if (!ports_.empty() || destination_ips_ != nullptr) {
+    const Network::Address::InstanceConstSharedPtr& address = connection.localAddress();
+    if (address->ip() != nullptr) {
+      auto it = ports_.find(address->ip()->port());
+      if (it != ports_.end()) {
+        append(it->second, candidates);
+      }
+      if (destination_ips_ != nullptr) {
+        append(destination_ips_->lookup(address), candidates);
+      }
+    }
+  }
+
+  if (source_ips_ != nullptr) {
+    const Network::Address::InstanceConstSharedPtr& address = connection.remoteAddress();
+    if (address->ip() != nullptr) {
+      append(source_ips_->lookup(address), candidates);
+    }
+  }
+
+  for (const auto& header : headers_) {
+    const Http::HeaderEntry* entry = headers.get(header.first);
+    if (entry == nullptr) {
+      continue;
+    }
+
+    const absl::string_view value = entry->value().getStringView();
+    const HeaderIndex& index = header.second;
+    auto exact = index.exact_.find(std::string(value));
+    if (exact != index.exact_.end()) {
+      append(exact->second, candidates);
+    }
+    for (size_t length : index.prefix_lengths_) {
+      if (length > value.size()) {
+        break;
+      }
+      auto prefix = index.prefixes_.find(std::string(value.substr(0, length)));
+      if (prefix != index.prefixes_.end()) {
+        append(prefix->second, candidates);
+      }
+    }
+  }
+
+  // A policy may be found by several of its conditions.
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+}
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
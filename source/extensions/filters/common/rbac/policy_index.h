@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "envoy/config/rbac/v2alpha/rbac.pb.h"
+#include "envoy/http/header_map.h"
+#include "envoy/network/connection.h"
+
+#include "common/network/cidr_range.h"
+#include "common/network/lc_trie.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+/**
+ * An index of a list of policies by the cheap conditions each of them requires: an exact or prefix
+ * header value, a destination port, or a source or destination CIDR range. Given a request, the
+ * index finds the policies whose required conditions hold, which are the only ones that may match.
+ * A policy is indexed by its permissions if every permission requires such a condition, or else by
+ * its principals. The policies which require none are always candidates.
+ */
+class PolicyIndex {
+public:
+  /**
+   * @param policies supplies the policies, in the order they are evaluated.
+   */
+  PolicyIndex(const std::vector<const envoy::config::rbac::v2alpha::Policy*>& policies);
+
+  /**
+   * Find the policies which may match a request.
+   * @param connection supplies the downstream connection.
+   * @param headers supplies the request headers.
+   * @param candidates receives the positions of the policies in the list, in ascending order.
+   */
+  void candidates(const Network::Connection& connection, const Http::HeaderMap& headers,
+                  std::vector<uint32_t>& candidates) const;
+
+  /**
+   * @return uint32_t the number of policies which are always candidates.
+   */
+  uint32_t unindexed() const { return unindexed_.size(); }
+
+private:
+  // The conditions one of which a policy requires.
+  struct Conditions {
+    std::vector<uint32_t> ports_;
+    std::vector<Network::Address::CidrRange> source_ips_;
+    std::vector<Network::Address::CidrRange> destination_ips_;
+    // Header names and values.
+    std::vector<std::pair<std::string, std::string>> exact_headers_;
+    std::vector<std::pair<std::string, std::string>> prefix_headers_;
+  };
+
+  struct HeaderIndex {
+    std::unordered_map<std::string, std::vector<uint32_t>> exact_;
+    std::unordered_map<std::string, std::vector<uint32_t>> prefixes_;
+    // The lengths of the prefixes, so that a value is looked up once per length.
+    std::set<size_t> prefix_lengths_;
+  };
+
+  static bool collect(const envoy::config::rbac::v2alpha::Permission& permission,
+                      Conditions& conditions);
+  static bool collect(const envoy::config::rbac::v2alpha::Principal& principal,
+                      Conditions& conditions);
+  static bool collect(const envoy::api::v2::route::HeaderMatcher& header, Conditions& conditions);
+  void add(uint32_t policy, const Conditions& conditions,
+           std::vector<std::pair<uint32_t, std::vector<Network::Address::CidrRange>>>& source_ips,
+           std::vector<std::pair<uint32_t, std::vector<Network::Address::CidrRange>>>&
+               destination_ips);
+
+  std::vector<uint32_t> unindexed_;
+  std::unordered_map<uint32_t, std::vector<uint32_t>> ports_;
+  std::vector<std::pair<Http::LowerCaseString, HeaderIndex>> headers_;
+  std::unique_ptr<Network::LcTrie::LcTrie<uint32_t>> source_ips_;
+  std::unique_ptr<Network::LcTrie::LcTrie<uint32_t>> destination_ips_;
+};
+
+typedef std::unique_ptr<const PolicyIndex> PolicyIndexConstPtr;
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
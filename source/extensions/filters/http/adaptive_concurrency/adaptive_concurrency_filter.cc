@@ -0,0 +1,54 @@
+#include "extensions/filters/http/adaptive_concurrency/adaptive_concurrency_filter.h"
+
+#include "envoy/http/codes.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+AdaptiveConcurrencyFilterConfig::AdaptiveConcurrencyFilterConfig(
+    ConcurrencyControllerSharedPtr controller, const std::string& stats_prefix,
+    Stats::Scope& scope, TimeSource& time_source)
+    : controller_(std::move(controller)),
+      stats_({ALL_ADAPTIVE_CONCURRENCY_FILTER_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix))}),
+      time_source_(time_source) {}
+
+AdaptiveConcurrencyFilter::AdaptiveConcurrencyFilter(
+    AdaptiveConcurrencyFilterConfigSharedPtr config)
+    : config_(std::move(config)) {}
+
+Http::FilterHeadersStatus AdaptiveConcurrencyFilter::decodeHeaders(Http::HeaderMap&, bool) {
+  if (config_->controller().forwardingDecision() == RequestForwardingAction::Block) {
+    config_->stats().rq_blocked_.inc();
+    decoder_callbacks_->sendLocalReply(Http::Code::ServiceUnavailable, "reached concurrency limit",
+                                       nullptr);
+    return Http::FilterHeadersStatus::StopIteration;
+  }
+
+  rq_start_time_ = config_->timeSource().monotonicTime();
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterHeadersStatus AdaptiveConcurrencyFilter::encodeHeaders(Http::HeaderMap&, bool) {
+  // The latency is taken up to the response headers, which is when the upstream has done its work.
+  if (rq_start_time_) {
+    config_->controller().recordLatencySample(config_->timeSource().monotonicTime() -
+                                              rq_start_time_.value());
+    rq_start_time_.reset();
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+void AdaptiveConcurrencyFilter::onDestroy() {
+  // The stream was reset before a response.
+  if (rq_start_time_) {
+    config_->controller().cancelLatencySample();
+    rq_start_time_.reset();
+  }
+}
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/common/time.h"
+#include "envoy/http/filter.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "extensions/filters/http/adaptive_concurrency/concurrency_controller.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+/**
+ * All stats for the adaptive concurrency filter. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_ADAPTIVE_CONCURRENCY_FILTER_STATS(COUNTER)                                             \
+  COUNTER(rq_blocked)
+// clang-format on
+
+/**
+ * Wrapper struct for adaptive concurrency filter stats. @see stats_macros.h
+ */
+struct AdaptiveConcurrencyFilterStats {
+  ALL_ADAPTIVE_CONCURRENCY_FILTER_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Configuration for the adaptive concurrency filter.
+ */
+class AdaptiveConcurrencyFilterConfig {
+public:
+  AdaptiveConcurrencyFilterConfig(ConcurrencyControllerSharedPtr controller,
+                                  const std::string& stats_prefix, Stats::Scope& scope,
+                                  TimeSource& time_source);
+
+  ConcurrencyController& controller() { return *controller_; }
+  AdaptiveConcurrencyFilterStats& stats() { return stats_; }
+  TimeSource& timeSource() { return time_source_; }
+
+private:
+  const ConcurrencyControllerSharedPtr controller_;
+  AdaptiveConcurrencyFilterStats stats_;
+  TimeSource& time_source_;
+};
+
+typedef std::shared_ptr<AdaptiveConcurrencyFilterConfig> AdaptiveConcurrencyFilterConfigSharedPtr;
+
+/**
+ * A filter that rejects requests with a 503 while the number of outstanding requests is at the
+ * concurrency limit of its controller, and reports the latency of the requests it forwards to the
+ * controller.
+ */
+class AdaptiveConcurrencyFilter : public Http::StreamFilter {
+public:
+  AdaptiveConcurrencyFilter(AdaptiveConcurrencyFilterConfigSharedPtr config);
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus decodeData(Buffer::Instance&, bool) override {
+    return Http::FilterDataStatus::Continue;
+  }
+  Http::FilterTrailersStatus decodeTrailers(Http::HeaderMap&) override {
+    return Http::FilterTrailersStatus::Continue;
+  }
+  void setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callbacks) override {
+    decoder_callbacks_ = &callbacks;
+  }
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encode100ContinueHeaders(Http::HeaderMap&) override {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance&, bool) override {
+    return Http::FilterDataStatus::Continue;
+  }
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap&) override {
+    return Http::FilterTrailersStatus::Continue;
+  }
+  void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks&) override {}
+
+private:
+  AdaptiveConcurrencyFilterConfigSharedPtr config_;
+  Http::StreamDecoderFilterCallbacks* decoder_callbacks_{};
+  // Set while the request is outstanding in the controller.
+  absl::optional<MonotonicTime> rq_start_time_;
+};
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+enum class RequestForwardingAction {
+  // The request may be forwarded.
+  Forward,
+  // The concurrency limit is reached and the request must not be forwarded.
+  Block
+};
+
+/**
+ * Tracks the outstanding requests of an adaptive concurrency filter against a concurrency limit.
+ * It is shared by the filters of all workers, so implementations must be thread safe.
+ */
+class ConcurrencyController {
+public:
+  virtual ~ConcurrencyController() {}
+
+  /**
+   * Decide whether a request may be forwarded. A forwarded request is outstanding until
+   * recordLatencySample() or cancelLatencySample() is called for it.
+   * @return RequestForwardingAction whether the request may be forwarded.
+   */
+  virtual RequestForwardingAction forwardingDecision() PURE;
+
+  /**
+   * Complete an outstanding request.
+   * @param rq_latency supplies the time it took the upstream to respond.
+   */
+  virtual void recordLatencySample(std::chrono::nanoseconds rq_latency) PURE;
+
+  /**
+   * Complete an outstanding request without a response, e.g. if the stream was reset.
+   */
+  virtual void cancelLatencySample() PURE;
+
+  /**
+   * @return uint32_t the current concurrency limit.
+   */
+  virtual uint32_t concurrencyLimit() const PURE;
+};
+
+typedef std::shared_ptr<ConcurrencyController> ConcurrencyControllerSharedPtr;
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
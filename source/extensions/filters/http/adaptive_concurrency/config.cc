@@ -0,0 +1,44 @@
+#include "extensions/filters/http/adaptive_concurrency/config.h"
+
+#include <string>
+
+#include "envoy/config/filter/http/adaptive_concurrency/v2alpha/adaptive_concurrency.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "extensions/filters/http/adaptive_concurrency/adaptive_concurrency_filter.h"
+#include "extensions/filters/http/adaptive_concurrency/gradient_controller.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+Http::FilterFactoryCb AdaptiveConcurrencyFilterFactory::createFilterFactoryFromProtoTyped(
+    const envoy::config::filter::http::adaptive_concurrency::v2alpha::AdaptiveConcurrency&
+        proto_config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
+  const std::string prefix = stats_prefix + "adaptive_concurrency.";
+  // The controller is shared by the filters of all workers, and its timers run on the main thread.
+  ConcurrencyControllerSharedPtr controller = std::make_shared<GradientController>(
+      GradientControllerConfig(proto_config.gradient_controller_config()), context.dispatcher(),
+      prefix + "gradient_controller.", context.scope());
+  AdaptiveConcurrencyFilterConfigSharedPtr filter_config =
+      std::make_shared<AdaptiveConcurrencyFilterConfig>(controller, prefix, context.scope(),
+                                                        context.timeSource());
+
+  return [filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addStreamFilter(std::make_shared<AdaptiveConcurrencyFilter>(filter_config));
+  };
+}
+
+/**
+ * Static registration for the adaptive concurrency filter. @see RegisterFactory.
+ */
+static Registry::RegisterFactory<AdaptiveConcurrencyFilterFactory,
+                                 Server::Configuration::NamedHttpFilterConfigFactory>
+    register_;
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
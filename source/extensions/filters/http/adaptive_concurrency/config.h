@@ -0,0 +1,32 @@
+#pragma once
+
+#include "envoy/config/filter/http/adaptive_concurrency/v2alpha/adaptive_concurrency.pb.h"
+
+#include "extensions/filters/http/common/factory_base.h"
+#include "extensions/filters/http/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+/**
+ * Config registration for the adaptive concurrency filter. @see NamedHttpFilterConfigFactory.
+ */
+class AdaptiveConcurrencyFilterFactory
+    : public Common::FactoryBase<
+          envoy::config::filter::http::adaptive_concurrency::v2alpha::AdaptiveConcurrency> {
+public:
+  AdaptiveConcurrencyFilterFactory() : FactoryBase(HttpFilterNames::get().AdaptiveConcurrency) {}
+
+private:
+  Http::FilterFactoryCb createFilterFactoryFromProtoTyped(
+      const envoy::config::filter::http::adaptive_concurrency::v2alpha::AdaptiveConcurrency&
+          proto_config,
+      const std::string& stats_prefix, Server::Configuration::FactoryContext& context) override;
+};
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,149 @@
+#include "extensions/filters/http/adaptive_concurrency/gradient_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/common/assert.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+GradientControllerConfig::GradientControllerConfig(
+    const envoy::config::filter::http::adaptive_concurrency::v2alpha::GradientControllerConfig&
+        proto_config)
+    : sample_interval_(PROTOBUF_GET_MS_OR_DEFAULT(proto_config, sample_interval, 100)),
+      sample_aggregate_percentile_(proto_config.has_sample_aggregate_percentile()
+                                       ? proto_config.sample_aggregate_percentile().value() / 100
+                                       : 0.5),
+      buffer_(proto_config.has_buffer() ? proto_config.buffer().value() / 100 : 0.25),
+      min_rtt_calc_interval_(
+          PROTOBUF_GET_MS_OR_DEFAULT(proto_config, min_rtt_calc_interval, 60000)),
+      min_rtt_request_count_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, min_rtt_request_count, 50)),
+      min_concurrency_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, min_concurrency, 3)),
+      max_concurrency_limit_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, max_concurrency_limit, 1000)) {}
+
+GradientController::GradientController(const GradientControllerConfig& config,
+                                       Event::Dispatcher& dispatcher,
+                                       const std::string& stats_prefix, Stats::Scope& scope)
+    : config_(config), stats_(generateStats(stats_prefix, scope)),
+      concurrency_limit_(config_.minConcurrency()), deferred_limit_(config_.minConcurrency()) {
+  stats_.concurrency_limit_.set(concurrency_limit_);
+  sample_timer_ = dispatcher.createTimer([this]() -> void { onSampleInterval(); });
+  min_rtt_calc_timer_ = dispatcher.createTimer([this]() -> void { startMinRttCalculation(); });
+  // Nothing is known about the upstream yet, so start by measuring its minimum RTT.
+  startMinRttCalculation();
+  sample_timer_->enableTimer(config_.sampleInterval());
+}
+
+GradientControllerStats GradientController::generateStats(const std::string& prefix,
+                                                          Stats::Scope& scope) {
+  return {ALL_GRADIENT_CONTROLLER_STATS(POOL_GAUGE_PREFIX(scope, prefix))};
+}
+
+RequestForwardingAction GradientController::forwardingDecision() {
+  // Take the slot first, so that racing workers cannot both take the last one.
+  if (++num_rq_outstanding_ > concurrency_limit_) {
+    --num_rq_outstanding_;
+    return RequestForwardingAction::Block;
+  }
+  return RequestForwardingAction::Forward;
+}
+
+void GradientController::recordLatencySample(std::chrono::nanoseconds rq_latency) {
+  cancelLatencySample();
+
+  absl::MutexLock lock(&mutex_);
+  latency_samples_.push_back(rq_latency);
+  if (in_min_rtt_calc_ && latency_samples_.size() >= config_.minRttRequestCount()) {
+    updateMinRtt();
+  }
+}
+
+void GradientController::cancelLatencySample() {
+  ASSERT(num_rq_outstanding_ > 0);
+  --num_rq_outstanding_;
+}
+
+void GradientController::onSampleInterval() {
+  {
+    absl::MutexLock lock(&mutex_);
+    // While the minimum RTT is measured, the samples are kept for it.
+    if (!in_min_rtt_calc_ && !latency_samples_.empty()) {
+      const std::chrono::nanoseconds sample_rtt =
+          aggregateSamples(config_.sampleAggregatePercentile());
+      stats_.sample_rtt_msecs_.set(
+          std::chrono::duration_cast<std::chrono::milliseconds>(sample_rtt).count());
+      setConcurrencyLimit(calculateNewLimit(sample_rtt));
+    }
+  }
+  sample_timer_->enableTimer(config_.sampleInterval());
+}
+
+void GradientController::startMinRttCalculation() {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!in_min_rtt_calc_) {
+      in_min_rtt_calc_ = true;
+      deferred_limit_ = concurrency_limit_;
+      latency_samples_.clear();
+      stats_.min_rtt_calculation_active_.set(1);
+      setConcurrencyLimit(config_.minConcurrency());
+    }
+  }
+  min_rtt_calc_timer_->enableTimer(config_.minRttCalcInterval());
+}
+
+void GradientController::updateMinRtt() {
+  ASSERT(in_min_rtt_calc_);
+  // The minimum RTT is measured at the lowest concurrency, where the upstream should not queue.
+  // Taking a percentile rather than the lowest sample keeps outliers from skewing it.
+  min_rtt_ = aggregateSamples(config_.sampleAggregatePercentile());
+  stats_.min_rtt_msecs_.set(
+      std::chrono::duration_cast<std::chrono::milliseconds>(min_rtt_).count());
+  in_min_rtt_calc_ = false;
+  stats_.min_rtt_calculation_active_.set(0);
+  setConcurrencyLimit(deferred_limit_);
+}
+
+std::chrono::nanoseconds GradientController::aggregateSamples(double percentile) {
+  ASSERT(!latency_samples_.empty());
+  const size_t index =
+      std::min(latency_samples_.size() - 1,
+               static_cast<size_t>(percentile * static_cast<double>(latency_samples_.size())));
+  std::nth_element(latency_samples_.begin(), latency_samples_.begin() + index,
+                   latency_samples_.end());
+  const std::chrono::nanoseconds aggregate = latency_samples_[index];
+  latency_samples_.clear();
+  return aggregate;
+}
+
+uint32_t GradientController::calculateNewLimit(std::chrono::nanoseconds sample_rtt) {
+  // A gradient below 1 means requests are queueing in the upstream, so the limit shrinks. It is
+  // bounded so that a single interval can at most halve or double the limit.
+  const double buffered_min_rtt = min_rtt_.count() * (1 + config_.buffer());
+  const double gradient =
+      sample_rtt.count() > 0
+          ? std::max(0.5, std::min(2.0, buffered_min_rtt / sample_rtt.count()))
+          : 2.0;
+  const double limit = concurrency_limit_ * gradient;
+  // The headroom absorbs bursts, and lets the limit grow while the gradient is 1.
+  const double new_limit = limit + std::sqrt(limit);
+  return std::max(config_.minConcurrency(),
+                  static_cast<uint32_t>(std::min<double>(config_.maxConcurrencyLimit(),
+                                                         new_limit)));
+}
+
+void GradientController::setConcurrencyLimit(uint32_t limit) {
+  concurrency_limit_ = limit;
+  stats_.concurrency_limit_.set(limit);
+}
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
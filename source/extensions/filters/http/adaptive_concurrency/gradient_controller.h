@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "envoy/config/filter/http/adaptive_concurrency/v2alpha/adaptive_concurrency.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/thread_annotations.h"
+
+#include "extensions/filters/http/adaptive_concurrency/concurrency_controller.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+/**
+ * All stats for the gradient controller. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_GRADIENT_CONTROLLER_STATS(GAUGE)                                                       \
+  GAUGE(concurrency_limit)                                                                         \
+  GAUGE(min_rtt_calculation_active)                                                                \
+  GAUGE(min_rtt_msecs)                                                                             \
+  GAUGE(sample_rtt_msecs)
+// clang-format on
+
+/**
+ * Wrapper struct for gradient controller stats. @see stats_macros.h
+ */
+struct GradientControllerStats {
+  ALL_GRADIENT_CONTROLLER_STATS(GENERATE_GAUGE_STRUCT)
+};
+
+class GradientControllerConfig {
+public:
+  GradientControllerConfig(
+      const envoy::config::filter::http::adaptive_concurrency::v2alpha::GradientControllerConfig&
+          proto_config);
+
+  std::chrono::milliseconds sampleInterval() const { return sample_interval_; }
+  double sampleAggregatePercentile() const { return sample_aggregate_percentile_; }
+  double buffer() const { return buffer_; }
+  std::chrono::milliseconds minRttCalcInterval() const { return min_rtt_calc_interval_; }
+  uint32_t minRttRequestCount() const { return min_rtt_request_count_; }
+  uint32_t minConcurrency() const { return min_concurrency_; }
+  uint32_t maxConcurrencyLimit() const { return max_concurrency_limit_; }
+
+private:
+  const std::chrono::milliseconds sample_interval_;
+  // As a fraction of 1.
+  const double sample_aggregate_percentile_;
+  // As a fraction of the minimum RTT.
+  const double buffer_;
+  const std::chrono::milliseconds min_rtt_calc_interval_;
+  const uint32_t min_rtt_request_count_;
+  const uint32_t min_concurrency_;
+  const uint32_t max_concurrency_limit_;
+};
+
+/**
+ * Concurrency controller that follows the gradient between the minimum round-trip time (RTT) of
+ * the upstream and the latency of recent requests. Every sample interval, the concurrency limit is
+ * multiplied by minimum RTT / sampled latency, so that it shrinks once requests queue up in the
+ * upstream and grows while they do not, and some headroom is added to it. The minimum RTT is
+ * measured periodically with the limit lowered to its minimum, so that it follows changes in the
+ * upstream's capacity.
+ *
+ * The timers run on the main thread, while the filters of all workers forward requests and record
+ * their latency.
+ */
+class GradientController : public ConcurrencyController {
+public:
+  GradientController(const GradientControllerConfig& config, Event::Dispatcher& dispatcher,
+                     const std::string& stats_prefix, Stats::Scope& scope);
+
+  // AdaptiveConcurrency::ConcurrencyController
+  RequestForwardingAction forwardingDecision() override;
+  void recordLatencySample(std::chrono::nanoseconds rq_latency) override;
+  void cancelLatencySample() override;
+  uint32_t concurrencyLimit() const override { return concurrency_limit_; }
+
+private:
+  static GradientControllerStats generateStats(const std::string& prefix, Stats::Scope& scope);
+
+  void onSampleInterval();
+  void startMinRttCalculation();
+  void updateMinRtt() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  std::chrono::nanoseconds aggregateSamples(double percentile) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  uint32_t calculateNewLimit(std::chrono::nanoseconds sample_rtt) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void setConcurrencyLimit(uint32_t limit);
+
+  const GradientControllerConfig config_;
+  GradientControllerStats stats_;
+  std::atomic<uint32_t> concurrency_limit_;
+  std::atomic<uint32_t> num_rq_outstanding_{};
+  absl::Mutex mutex_;
+  std::vector<std::chrono::nanoseconds> latency_samples_ GUARDED_BY(mutex_);
+  std::chrono::nanoseconds min_rtt_ GUARDED_BY(mutex_){};
+  bool in_min_rtt_calc_ GUARDED_BY(mutex_){};
+  // The limit to restore once the minimum RTT has been measured.
+  uint32_t deferred_limit_ GUARDED_BY(mutex_);
+  Event::TimerPtr sample_timer_;
+  Event::TimerPtr min_rtt_calc_timer_;
+};
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include "extensions/filters/http/buffer/buffer_filter.h"
 
+#include "envoy/common/exception.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/timer.h"
 #include "envoy/http/codes.h"
@@ -11,6 +12,7 @@
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
 #include "common/http/utility.h"
+#include "common/protobuf/utility.h"
 
 #include "extensions/filters/http/well_known_names.h"
 
@@ -24,7 +26,10 @@ BufferFilterSettings::BufferFilterSettings(
     : disabled_(false),
       max_request_bytes_(static_cast<uint64_t>(proto_config.max_request_bytes().value())),
       max_request_time_(
-          std::chrono::seconds(PROTOBUF_GET_SECONDS_REQUIRED(proto_config, max_request_time))) {}
+          std::chrono::seconds(PROTOBUF_GET_SECONDS_REQUIRED(proto_config, max_request_time))),
+      stream_after_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, stream_after_bytes, 0)) {
+  validate();
+}
 
 BufferFilterSettings::BufferFilterSettings(
     const envoy::config::filter::http::buffer::v2::BufferPerRoute& proto_config)
@@ -36,7 +41,19 @@ BufferFilterSettings::BufferFilterSettings(
       max_request_time_(std::chrono::seconds(
           proto_config.has_buffer()
               ? PROTOBUF_GET_SECONDS_REQUIRED(proto_config.buffer(), max_request_time)
-              : 0)) {}
+              : 0)),
+      stream_after_bytes_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config.buffer(), stream_after_bytes, 0)) {
+  validate();
+}
+
+void BufferFilterSettings::validate() const {
+  if (stream_after_bytes_ > max_request_bytes_) {
+    throw EnvoyException(
+        fmt::format("buffer filter: stream_after_bytes {} exceeds max_request_bytes {}",
+                    stream_after_bytes_, max_request_bytes_));
+  }
+}
 
 BufferFilterConfig::BufferFilterConfig(
     const envoy::config::filter::http::buffer::v2::Buffer& proto_config,
@@ -81,18 +98,36 @@ Http::FilterHeadersStatus BufferFilter::decodeHeaders(Http::HeaderMap&, bool end
   }
 
   callbacks_->setDecoderBufferLimit(settings_->maxRequestBytes());
-  request_timeout_ = callbacks_->dispatcher().createTimer([this]() -> void { onRequestTimeout(); });
+  // The timeout is almost always cancelled by the end of the request, so use a coarse timer.
+  request_timeout_ =
+      callbacks_->dispatcher().createCoarseTimer([this]() -> void { onRequestTimeout(); });
   request_timeout_->enableTimer(settings_->maxRequestTime());
 
   return Http::FilterHeadersStatus::StopIteration;
 }
 
-Http::FilterDataStatus BufferFilter::decodeData(Buffer::Instance&, bool end_stream) {
+Http::FilterDataStatus BufferFilter::decodeData(Buffer::Instance& data, bool end_stream) {
+  if (streaming_) {
+    return Http::FilterDataStatus::Continue;
+  }
+
   if (end_stream) {
     resetInternalState();
     return Http::FilterDataStatus::Continue;
   }
 
+  const uint64_t stream_after_bytes = settings_->streamAfterBytes();
+  if (stream_after_bytes > 0) {
+    const Buffer::Instance* buffered = callbacks_->decodingBuffer();
+    if ((buffered != nullptr ? buffered->length() : 0) + data.length() >= stream_after_bytes) {
+      // Enough of the body has been seen: forward what was buffered and stream the rest. The
+      // decoder buffer limit now only applies flow control rather than a 413.
+      streaming_ = true;
+      resetInternalState();
+      return Http::FilterDataStatus::Continue;
+    }
+  }
+
   // Buffer until the complete request has been processed or the ConnectionManagerImpl sends a 413.
   return Http::FilterDataStatus::StopIterationAndBuffer;
 }
@@ -40,11 +40,16 @@ public:
   bool disabled() const { return disabled_; }
   uint64_t maxRequestBytes() const { return max_request_bytes_; }
   std::chrono::seconds maxRequestTime() const { return max_request_time_; }
+  // The number of body bytes after which the request is streamed, or 0 to buffer it completely.
+  uint64_t streamAfterBytes() const { return stream_after_bytes_; }
 
 private:
+  void validate() const;
+
   bool disabled_;
   uint64_t max_request_bytes_;
   std::chrono::seconds max_request_time_;
+  uint64_t stream_after_bytes_;
 };
 
 /**
@@ -66,7 +71,9 @@ private:
 typedef std::shared_ptr<BufferFilterConfig> BufferFilterConfigSharedPtr;
 
 /**
- * A filter that is capable of buffering an entire request before dispatching it upstream.
+ * A filter that is capable of buffering an entire request before dispatching it upstream. If
+ * stream_after_bytes is configured, only the first bytes of the body are buffered and the rest of
+ * the request is streamed.
  */
 class BufferFilter : public Http::StreamDecoderFilter {
 public:
@@ -94,6 +101,7 @@ private:
   Http::StreamDecoderFilterCallbacks* callbacks_{};
   Event::TimerPtr request_timeout_;
   bool config_initialized_{};
+  bool streaming_{};
 };
 
 } // namespace BufferFilter
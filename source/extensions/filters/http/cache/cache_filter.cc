@@ -0,0 +1,272 @@
+#include "extensions/filters/http/cache/cache_filter.h"
+
+#include <chrono>
+
+#include "envoy/http/codes.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/enum_to_int.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/cache/cache_policy.h"
+#include "extensions/filters/http/cache/lru_cache.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+
+const Http::LowerCaseString& ageHeader() {
+  static const Http::LowerCaseString* header = new Http::LowerCaseString("age");
+  return *header;
+}
+
+} // namespace
+
+CacheFilterConfig::CacheFilterConfig(
+    const envoy::config::filter::http::cache::v2alpha::Cache& config,
+    const std::string& stats_prefix, Stats::Scope& scope, ThreadLocal::SlotAllocator& tls,
+    TimeSource& time_source)
+    : stats_{ALL_CACHE_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix + "cache."))},
+      max_body_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_body_bytes, 1024 * 1024)),
+      time_source_(time_source), tls_(tls.allocateSlot()) {
+  switch (config.storage_case()) {
+  case envoy::config::filter::http::cache::v2alpha::Cache::kSharedLru:
+    cache_ = std::make_unique<SharedLruCache>(
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.shared_lru(), max_entries, 10000),
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.shared_lru(), shards, 16), stats_.eviction_);
+    break;
+  case envoy::config::filter::http::cache::v2alpha::Cache::kWorkerLru:
+  case envoy::config::filter::http::cache::v2alpha::Cache::STORAGE_NOT_SET:
+    cache_ = std::make_unique<WorkerLruCache>(
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.worker_lru(), max_entries, 1000), tls,
+        stats_.eviction_);
+    break;
+  }
+
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalFills>();
+  });
+}
+
+bool CacheFilterConfig::startFill(const std::string& key, CacheFillWaiter& waiter) {
+  ThreadLocalFills& fills = tls_->getTyped<ThreadLocalFills>();
+  auto it = fills.pending_.find(key);
+  if (it == fills.pending_.end()) {
+    fills.pending_.emplace(key, PendingFill{&waiter, {}});
+    return true;
+  }
+
+  it->second.waiters_.push_back(&waiter);
+  stats_.coalesced_.inc();
+  return false;
+}
+
+void CacheFilterConfig::completeFill(const std::string& key, CachedResponseSharedPtr response) {
+  ThreadLocalFills& fills = tls_->getTyped<ThreadLocalFills>();
+  auto it = fills.pending_.find(key);
+  ASSERT(it != fills.pending_.end());
+  const std::list<CacheFillWaiter*> waiters = std::move(it->second.waiters_);
+  fills.pending_.erase(it);
+
+  for (CacheFillWaiter* waiter : waiters) {
+    waiter->onFillComplete(response);
+  }
+}
+
+void CacheFilterConfig::cancelFill(const std::string& key, CacheFillWaiter& waiter) {
+  ThreadLocalFills& fills = tls_->getTyped<ThreadLocalFills>();
+  auto it = fills.pending_.find(key);
+  ASSERT(it != fills.pending_.end());
+  if (it->second.filler_ != &waiter) {
+    it->second.waiters_.remove(&waiter);
+    return;
+  }
+
+  // The first waiter to fill again takes over the fill, and the others wait for it.
+  const std::list<CacheFillWaiter*> waiters = std::move(it->second.waiters_);
+  fills.pending_.erase(it);
+  for (CacheFillWaiter* other : waiters) {
+    other->onFillCancelled();
+  }
+}
+
+std::string CacheFilter::key(const Http::HeaderMap& headers) {
+  // Neither the scheme nor the host hold a space.
+  return absl::StrCat(headers.ForwardedProto() ? headers.ForwardedProto()->value().c_str() : "",
+                      " ", headers.Host() ? headers.Host()->value().c_str() : "", " ",
+                      headers.Path() ? headers.Path()->value().c_str() : "");
+}
+
+Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::HeaderMap& headers, bool) {
+  if (!CachePolicy::requestCacheable(headers)) {
+    config_->stats().bypass_.inc();
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  request_headers_ = &headers;
+  key_ = key(headers);
+  CachedResponseSharedPtr response = config_->cache().lookup(key_);
+  if (response != nullptr && response->expiry_ > config_->timeSource().monotonicTime() &&
+      CachePolicy::varyMatches(*response, headers)) {
+    ENVOY_STREAM_LOG(trace, "cache filter serving a cached response", *decoder_callbacks_);
+    config_->stats().hit_.inc();
+    serve(*response);
+    return Http::FilterHeadersStatus::StopIteration;
+  }
+
+  config_->stats().miss_.inc();
+  return fill() ? Http::FilterHeadersStatus::Continue : Http::FilterHeadersStatus::StopIteration;
+}
+
+Http::FilterDataStatus CacheFilter::decodeData(Buffer::Instance&, bool) {
+  if (served_) {
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+  return waiter_ ? Http::FilterDataStatus::StopIterationAndBuffer
+                 : Http::FilterDataStatus::Continue;
+}
+
+Http::FilterTrailersStatus CacheFilter::decodeTrailers(Http::HeaderMap&) {
+  return waiter_ || served_ ? Http::FilterTrailersStatus::StopIteration
+                           : Http::FilterTrailersStatus::Continue;
+}
+
+Http::FilterHeadersStatus CacheFilter::encodeHeaders(Http::HeaderMap& headers, bool end_stream) {
+  if (!filler_) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  const absl::optional<std::chrono::seconds> lifetime = CachePolicy::freshnessLifetime(headers);
+  if (!lifetime) {
+    abandonFill();
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  response_ = std::make_shared<CachedResponse>();
+  if (!CachePolicy::varyHeaders(headers, *request_headers_, *response_)) {
+    abandonFill();
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  response_->headers_ = std::make_unique<Http::HeaderMapImpl>(headers);
+  response_->response_time_ = config_->timeSource().monotonicTime();
+  response_->expiry_ = response_->response_time_ + lifetime.value();
+  if (end_stream) {
+    completeFill(std::move(response_));
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus CacheFilter::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (response_ == nullptr) {
+    return Http::FilterDataStatus::Continue;
+  }
+
+  if (response_->body_.size() + data.length() > config_->maxBodyBytes()) {
+    abandonFill();
+    return Http::FilterDataStatus::Continue;
+  }
+
+  response_->body_.append(data.toString());
+  if (end_stream) {
+    completeFill(std::move(response_));
+  }
+  return Http::FilterDataStatus::Continue;
+}
+
+Http::FilterTrailersStatus CacheFilter::encodeTrailers(Http::HeaderMap&) {
+  // Responses with trailers are not cached.
+  if (filler_) {
+    abandonFill();
+  }
+  return Http::FilterTrailersStatus::Continue;
+}
+
+void CacheFilter::onDestroy() {
+  if (filler_ || waiter_) {
+    filler_ = false;
+    waiter_ = false;
+    response_.reset();
+    config_->cancelFill(key_, *this);
+  }
+}
+
+void CacheFilter::onFillComplete(CachedResponseSharedPtr response) {
+  waiter_ = false;
+  if (response != nullptr && CachePolicy::varyMatches(*response, *request_headers_)) {
+    serve(*response);
+    return;
+  }
+
+  // The response could not be cached, or varies on headers this request differs in.
+  decoder_callbacks_->continueDecoding();
+}
+
+void CacheFilter::onFillCancelled() {
+  waiter_ = false;
+  if (fill()) {
+    decoder_callbacks_->continueDecoding();
+  }
+}
+
+bool CacheFilter::fill() {
+  if (!config_->startFill(key_, *this)) {
+    ENVOY_STREAM_LOG(trace, "cache filter waiting for a concurrent fill", *decoder_callbacks_);
+    waiter_ = true;
+    return false;
+  }
+
+  filler_ = true;
+  return true;
+}
+
+void CacheFilter::serve(const CachedResponse& response) {
+  served_ = true;
+  Http::HeaderMapPtr headers = std::make_unique<Http::HeaderMapImpl>(*response.headers_);
+  headers->remove(ageHeader());
+  headers->addReferenceKey(ageHeader(),
+                           std::chrono::duration_cast<std::chrono::seconds>(
+                               config_->timeSource().monotonicTime() - response.response_time_)
+                               .count());
+
+  bool end_stream = response.body_.empty();
+  if (CachePolicy::etagMatches(*request_headers_, *response.headers_)) {
+    config_->stats().validated_.inc();
+    headers->Status()->value(enumToInt(Http::Code::NotModified));
+    headers->removeContentLength();
+    end_stream = true;
+  }
+
+  decoder_callbacks_->encodeHeaders(std::move(headers), end_stream);
+  if (!end_stream) {
+    Buffer::OwnedImpl body(response.body_);
+    decoder_callbacks_->encodeData(body, true);
+  }
+}
+
+void CacheFilter::completeFill(CachedResponseSharedPtr response) {
+  filler_ = false;
+  config_->cache().insert(key_, response);
+  config_->stats().insert_.inc();
+  config_->completeFill(key_, std::move(response));
+}
+
+void CacheFilter::abandonFill() {
+  filler_ = false;
+  response_.reset();
+  config_->stats().not_cacheable_.inc();
+  config_->completeFill(key_, nullptr);
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/common/pure.h"
+#include "envoy/common/time.h"
+#include "envoy/config/filter/http/cache/v2alpha/cache.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * All cache filter stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_CACHE_STATS(COUNTER)                                                                   \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(coalesced)                                                                               \
+  COUNTER(validated)                                                                               \
+  COUNTER(insert)                                                                                  \
+  COUNTER(eviction)                                                                                \
+  COUNTER(not_cacheable)                                                                           \
+  COUNTER(bypass)
+// clang-format on
+
+/**
+ * Struct definition for all cache filter stats. @see stats_macros.h
+ */
+struct CacheStats {
+  ALL_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Callbacks of a request waiting for the response of another request with the same key.
+ */
+class CacheFillWaiter {
+public:
+  virtual ~CacheFillWaiter() {}
+
+  /**
+   * Called when the response that the waiter waited for is complete.
+   * @param response supplies the response, or nullptr if it could not be cached, in which case
+   *        the waiter must be forwarded upstream.
+   */
+  virtual void onFillComplete(CachedResponseSharedPtr response) PURE;
+
+  /**
+   * Called when the request that the waiter waited for was reset, so that the waiter must fill
+   * the cache by itself.
+   */
+  virtual void onFillCancelled() PURE;
+};
+
+/**
+ * Configuration for the cache filter, which owns the storage of the responses. The concurrent
+ * misses of a key on a worker are coalesced: the first request with the key is forwarded
+ * upstream to fill the cache, and the following ones wait for its response.
+ */
+class CacheFilterConfig {
+public:
+  CacheFilterConfig(const envoy::config::filter::http::cache::v2alpha::Cache& config,
+                    const std::string& stats_prefix, Stats::Scope& scope,
+                    ThreadLocal::SlotAllocator& tls, TimeSource& time_source);
+
+  HttpCache& cache() { return *cache_; }
+  CacheStats& stats() { return stats_; }
+  TimeSource& timeSource() { return time_source_; }
+  uint64_t maxBodyBytes() const { return max_body_bytes_; }
+
+  /**
+   * Start the fill of a key which missed the cache.
+   * @param key supplies the key of the request.
+   * @param waiter supplies the callbacks of the request.
+   * @return bool true if the request must be forwarded upstream and then report its response
+   *         with completeFill(), or false if it waits for the response of another request.
+   */
+  bool startFill(const std::string& key, CacheFillWaiter& waiter);
+
+  /**
+   * Hand the response of a fill to the waiting requests.
+   * @param key supplies the key of the request.
+   * @param response supplies the response, or nullptr if it could not be cached.
+   */
+  void completeFill(const std::string& key, CachedResponseSharedPtr response);
+
+  /**
+   * Cancel the fill of a request, or stop waiting for another fill. The requests waiting for a
+   * cancelled fill are told to fill again.
+   * @param key supplies the key of the request.
+   * @param waiter supplies the callbacks the request started the fill with.
+   */
+  void cancelFill(const std::string& key, CacheFillWaiter& waiter);
+
+private:
+  struct PendingFill {
+    CacheFillWaiter* filler_;
+    std::list<CacheFillWaiter*> waiters_;
+  };
+
+  struct ThreadLocalFills : public ThreadLocal::ThreadLocalObject {
+    std::unordered_map<std::string, PendingFill> pending_;
+  };
+
+  CacheStats stats_;
+  const uint64_t max_body_bytes_;
+  TimeSource& time_source_;
+  HttpCachePtr cache_;
+  ThreadLocal::SlotPtr tls_;
+};
+
+typedef std::shared_ptr<CacheFilterConfig> CacheFilterConfigSharedPtr;
+
+/**
+ * A filter that serves fresh cached responses to GET requests, and caches the responses that
+ * allow it.
+ */
+class CacheFilter : public Http::StreamFilter,
+                    public CacheFillWaiter,
+                    public Logger::Loggable<Logger::Id::filter> {
+public:
+  CacheFilter(CacheFilterConfigSharedPtr config) : config_(std::move(config)) {}
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus decodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus decodeTrailers(Http::HeaderMap& trailers) override;
+  void setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callbacks) override {
+    decoder_callbacks_ = &callbacks;
+  }
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encode100ContinueHeaders(Http::HeaderMap&) override {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap& trailers) override;
+  void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks& callbacks) override {
+    encoder_callbacks_ = &callbacks;
+  }
+
+  // Cache::CacheFillWaiter
+  void onFillComplete(CachedResponseSharedPtr response) override;
+  void onFillCancelled() override;
+
+  /**
+   * @param headers supplies the headers of a request.
+   * @return std::string the key of the response to the request.
+   */
+  static std::string key(const Http::HeaderMap& headers);
+
+private:
+  bool fill();
+  void serve(const CachedResponse& response);
+  void completeFill(CachedResponseSharedPtr response);
+  void abandonFill();
+
+  CacheFilterConfigSharedPtr config_;
+  Http::StreamDecoderFilterCallbacks* decoder_callbacks_{};
+  Http::StreamEncoderFilterCallbacks* encoder_callbacks_{};
+  Http::HeaderMap* request_headers_{};
+  std::string key_;
+  // Whether this request is forwarded upstream to fill the cache, or waits for another request
+  // that is.
+  bool filler_{};
+  bool waiter_{};
+  // Whether this request was served a cached response, so that its body is not forwarded.
+  bool served_{};
+  // The response being collected by the filler, once its headers allowed it to be cached.
+  std::shared_ptr<CachedResponse> response_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,156 @@
+#include "extensions/filters/http/cache/cache_policy.h"
+
+#include <string>
+
+#include "common/http/headers.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+
+const Http::LowerCaseString& ifNoneMatch() {
+  static const Http::LowerCaseString* header = new Http::LowerCaseString("if-none-match");
+  return *header;
+}
+
+bool hasDirective(const Http::HeaderEntry* cache_control, absl::string_view name) {
+  if (cache_control == nullptr) {
+    return false;
+  }
+
+  for (absl::string_view directive : absl::StrSplit(cache_control->value().c_str(), ',')) {
+    directive = absl::StripAsciiWhitespace(directive);
+    // A directive may have an argument, such as the field names of a qualified private.
+    if (absl::StartsWithIgnoreCase(directive, name) &&
+        (directive.size() == name.size() || directive[name.size()] == '=')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Strips the weakness indicator, for the weak comparison of entity tags.
+absl::string_view opaqueTag(absl::string_view etag) {
+  etag = absl::StripAsciiWhitespace(etag);
+  if (absl::StartsWith(etag, "W/")) {
+    etag.remove_prefix(2);
+  }
+  return etag;
+}
+
+} // namespace
+
+bool CachePolicy::requestCacheable(const Http::HeaderMap& headers) {
+  if (headers.Method() == nullptr ||
+      headers.Method()->value() != Http::Headers::get().MethodValues.Get.c_str() ||
+      headers.Authorization() != nullptr) {
+    return false;
+  }
+
+  const Http::HeaderEntry* cache_control = headers.CacheControl();
+  return !hasDirective(cache_control, "no-store") && !hasDirective(cache_control, "no-cache");
+}
+
+absl::optional<std::chrono::seconds>
+CachePolicy::freshnessLifetime(const Http::HeaderMap& headers) {
+  if (headers.Status() == nullptr || headers.Status()->value() != "200" ||
+      headers.get(Http::Headers::get().SetCookie) != nullptr) {
+    return absl::nullopt;
+  }
+
+  const Http::HeaderEntry* cache_control = headers.CacheControl();
+  if (cache_control == nullptr || hasDirective(cache_control, "no-store") ||
+      hasDirective(cache_control, "no-cache") || hasDirective(cache_control, "private")) {
+    return absl::nullopt;
+  }
+
+  absl::optional<std::chrono::seconds> max_age;
+  absl::optional<std::chrono::seconds> s_maxage;
+  for (absl::string_view directive : absl::StrSplit(cache_control->value().c_str(), ',')) {
+    directive = absl::StripAsciiWhitespace(directive);
+    uint32_t seconds;
+    if (absl::StartsWithIgnoreCase(directive, "max-age=") &&
+        absl::SimpleAtoi(directive.substr(sizeof("max-age=") - 1), &seconds)) {
+      max_age = std::chrono::seconds(seconds);
+    } else if (absl::StartsWithIgnoreCase(directive, "s-maxage=") &&
+               absl::SimpleAtoi(directive.substr(sizeof("s-maxage=") - 1), &seconds)) {
+      s_maxage = std::chrono::seconds(seconds);
+    }
+  }
+
+  // The lifetime for shared caches overrides the general one.
+  const absl::optional<std::chrono::seconds> lifetime = s_maxage ? s_maxage : max_age;
+  if (!lifetime || lifetime.value().count() == 0) {
+    return absl::nullopt;
+  }
+  return lifetime;
+}
+
+bool CachePolicy::varyHeaders(const Http::HeaderMap& response_headers,
+                              const Http::HeaderMap& request_headers, CachedResponse& response) {
+  const Http::HeaderEntry* vary = response_headers.Vary();
+  if (vary == nullptr) {
+    return true;
+  }
+
+  for (absl::string_view name :
+       absl::StrSplit(vary->value().c_str(), ',', absl::SkipWhitespace())) {
+    name = absl::StripAsciiWhitespace(name);
+    if (name == Http::Headers::get().VaryValues.Wildcard) {
+      return false;
+    }
+
+    Http::LowerCaseString header{std::string(name)};
+    const Http::HeaderEntry* entry = request_headers.get(header);
+    response.vary_.emplace_back(std::move(header),
+                                entry ? absl::optional<std::string>(entry->value().c_str())
+                                      : absl::nullopt);
+  }
+  return true;
+}
+
+bool CachePolicy::varyMatches(const CachedResponse& response,
+                              const Http::HeaderMap& request_headers) {
+  for (const auto& vary : response.vary_) {
+    const Http::HeaderEntry* entry = request_headers.get(vary.first);
+    if (entry == nullptr) {
+      if (vary.second.has_value()) {
+        return false;
+      }
+    } else if (!vary.second.has_value() || vary.second.value() != entry->value().c_str()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CachePolicy::etagMatches(const Http::HeaderMap& request_headers,
+                              const Http::HeaderMap& response_headers) {
+  const Http::HeaderEntry* if_none_match = request_headers.get(ifNoneMatch());
+  const Http::HeaderEntry* etag = response_headers.Etag();
+  if (if_none_match == nullptr || etag == nullptr) {
+    return false;
+  }
+
+  const absl::string_view tag = opaqueTag(etag->value().c_str());
+  for (absl::string_view candidate : absl::StrSplit(if_none_match->value().c_str(), ',')) {
+    candidate = absl::StripAsciiWhitespace(candidate);
+    if (candidate == "*" || opaqueTag(candidate) == tag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
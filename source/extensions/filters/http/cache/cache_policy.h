@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+
+#include "envoy/http/header_map.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * The rules deciding which requests and responses are cached, and which cached responses a
+ * request may be served, following RFC 7234 for a shared cache. Only responses that state their
+ * freshness lifetime with a max-age or s-maxage directive are cached.
+ */
+class CachePolicy {
+public:
+  /**
+   * @param headers supplies the headers of a request.
+   * @return bool whether the request may be served from the cache and its response cached. Only
+   *         GET requests without credentials that do not ask to bypass the cache are.
+   */
+  static bool requestCacheable(const Http::HeaderMap& headers);
+
+  /**
+   * @param headers supplies the headers of a response.
+   * @return absl::optional<std::chrono::seconds> how long the response stays fresh, or
+   *         absl::nullopt if it must not be cached.
+   */
+  static absl::optional<std::chrono::seconds> freshnessLifetime(const Http::HeaderMap& headers);
+
+  /**
+   * Record the request headers a response varies on.
+   * @param response_headers supplies the headers of the response.
+   * @param request_headers supplies the headers of the request.
+   * @param response supplies the cached response whose vary_ is filled.
+   * @return bool false if the response varies on something other than request headers, and so
+   *         must not be cached.
+   */
+  static bool varyHeaders(const Http::HeaderMap& response_headers,
+                          const Http::HeaderMap& request_headers, CachedResponse& response);
+
+  /**
+   * @param response supplies a cached response.
+   * @param request_headers supplies the headers of a request with the key of the response.
+   * @return bool whether the request has the values of the headers the response varies on.
+   */
+  static bool varyMatches(const CachedResponse& response, const Http::HeaderMap& request_headers);
+
+  /**
+   * @param request_headers supplies the headers of a request.
+   * @param response_headers supplies the headers of the cached response.
+   * @return bool whether the request is conditional on an entity tag the response has, so that
+   *         it is answered with a 304 rather than the response body.
+   */
+  static bool etagMatches(const Http::HeaderMap& request_headers,
+                          const Http::HeaderMap& response_headers);
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
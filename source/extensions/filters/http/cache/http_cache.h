@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "envoy/common/pure.h"
+#include "envoy/common/time.h"
+#include "envoy/http/header_map.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * A cached response. It is immutable once it is inserted in a cache, and so may be served by
+ * several workers at once.
+ */
+struct CachedResponse {
+  Http::HeaderMapPtr headers_;
+  std::string body_;
+  // When the response was received, from which its age is counted.
+  MonotonicTime response_time_;
+  // When the response stops being fresh.
+  MonotonicTime expiry_;
+  // The request headers the response varies on, with the values they had in the request, or
+  // absl::nullopt if the request did not have them.
+  std::vector<std::pair<Http::LowerCaseString, absl::optional<std::string>>> vary_;
+};
+
+typedef std::shared_ptr<const CachedResponse> CachedResponseSharedPtr;
+
+/**
+ * The storage of a cache of responses. The responses are looked up and inserted by the workers,
+ * and whether a response is fresh or matches a request is left to the caller.
+ */
+class HttpCache {
+public:
+  virtual ~HttpCache() {}
+
+  /**
+   * Look up a response.
+   * @param key supplies the key of the request.
+   * @return CachedResponseSharedPtr the response, which stays valid if it is evicted, or nullptr
+   *         if none is stored.
+   */
+  virtual CachedResponseSharedPtr lookup(const std::string& key) PURE;
+
+  /**
+   * Store a response, replacing any response stored with the same key.
+   * @param key supplies the key of the request.
+   * @param response supplies the response.
+   */
+  virtual void insert(const std::string& key, CachedResponseSharedPtr response) PURE;
+};
+
+typedef std::unique_ptr<HttpCache> HttpCachePtr;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
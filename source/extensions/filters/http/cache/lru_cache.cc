@@ -0,0 +1,85 @@
+#include "extensions/filters/http/cache/lru_cache.h"
+
+#include <functional>
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+LruCache::LruCache(uint64_t max_entries, Stats::Counter& evictions)
+    : max_entries_(max_entries), evictions_(evictions) {}
+
+CachedResponseSharedPtr LruCache::lookup(const std::string& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+
+  lru_.splice(lru_.begin(), lru_, it->second.lru_entry_);
+  return it->second.response_;
+}
+
+void LruCache::insert(const std::string& key, CachedResponseSharedPtr response) {
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    it->second.response_ = std::move(response);
+    lru_.splice(lru_.begin(), lru_, it->second.lru_entry_);
+    return;
+  }
+
+  if (entries_.size() == max_entries_) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+    evictions_.inc();
+  }
+
+  lru_.push_front(key);
+  entries_.emplace(key, Entry{std::move(response), lru_.begin()});
+}
+
+WorkerLruCache::WorkerLruCache(uint64_t max_entries, ThreadLocal::SlotAllocator& tls,
+                               Stats::Counter& evictions)
+    : tls_(tls.allocateSlot()) {
+  tls_->set(
+      [max_entries, &evictions](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+        return std::make_shared<ThreadLocalCache>(max_entries, evictions);
+      });
+}
+
+CachedResponseSharedPtr WorkerLruCache::lookup(const std::string& key) {
+  return tls_->getTyped<ThreadLocalCache>().cache_.lookup(key);
+}
+
+void WorkerLruCache::insert(const std::string& key, CachedResponseSharedPtr response) {
+  tls_->getTyped<ThreadLocalCache>().cache_.insert(key, std::move(response));
+}
+
+SharedLruCache::SharedLruCache(uint64_t max_entries, uint32_t shards, Stats::Counter& evictions) {
+  // Each shard holds its share of the responses, rounded up.
+  const uint64_t max_shard_entries = (max_entries + shards - 1) / shards;
+  for (uint32_t i = 0; i < shards; i++) {
+    shards_.push_back(std::make_unique<Shard>(max_shard_entries, evictions));
+  }
+}
+
+CachedResponseSharedPtr SharedLruCache::lookup(const std::string& key) {
+  Shard& shard = this->shard(key);
+  absl::MutexLock lock(&shard.mutex_);
+  return shard.cache_.lookup(key);
+}
+
+void SharedLruCache::insert(const std::string& key, CachedResponseSharedPtr response) {
+  Shard& shard = this->shard(key);
+  absl::MutexLock lock(&shard.mutex_);
+  shard.cache_.insert(key, std::move(response));
+}
+
+SharedLruCache::Shard& SharedLruCache::shard(const std::string& key) {
+  return *shards_[std::hash<std::string>()(key) % shards_.size()];
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
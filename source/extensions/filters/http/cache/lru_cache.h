@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/stats/stats.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/thread_annotations.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * An LRU bounded map of responses. It is not thread safe.
+ */
+class LruCache {
+public:
+  /**
+   * @param max_entries supplies the number of responses held, the least recently used being
+   *                    evicted.
+   * @param evictions supplies the counter of evicted responses.
+   */
+  LruCache(uint64_t max_entries, Stats::Counter& evictions);
+
+  CachedResponseSharedPtr lookup(const std::string& key);
+  void insert(const std::string& key, CachedResponseSharedPtr response);
+
+  /**
+   * @return size_t the number of responses held.
+   */
+  size_t size() const { return entries_.size(); }
+
+private:
+  struct Entry {
+    CachedResponseSharedPtr response_;
+    std::list<std::string>::iterator lru_entry_;
+  };
+
+  const uint64_t max_entries_;
+  Stats::Counter& evictions_;
+  std::unordered_map<std::string, Entry> entries_;
+  // Keys from the most to the least recently used.
+  std::list<std::string> lru_;
+};
+
+/**
+ * A cache held by each worker, which needs no locking.
+ */
+class WorkerLruCache : public HttpCache {
+public:
+  WorkerLruCache(uint64_t max_entries, ThreadLocal::SlotAllocator& tls, Stats::Counter& evictions);
+
+  // HttpCache
+  CachedResponseSharedPtr lookup(const std::string& key) override;
+  void insert(const std::string& key, CachedResponseSharedPtr response) override;
+
+private:
+  struct ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
+    ThreadLocalCache(uint64_t max_entries, Stats::Counter& evictions)
+        : cache_(max_entries, evictions) {}
+
+    LruCache cache_;
+  };
+
+  ThreadLocal::SlotPtr tls_;
+};
+
+/**
+ * A cache shared by all workers. The keys are split in shards by their hash, each shard being an
+ * LruCache with its own lock, so that workers rarely contend.
+ */
+class SharedLruCache : public HttpCache {
+public:
+  /**
+   * @param max_entries supplies the number of responses held by all the shards.
+   * @param shards supplies the number of shards.
+   * @param evictions supplies the counter of evicted responses.
+   */
+  SharedLruCache(uint64_t max_entries, uint32_t shards, Stats::Counter& evictions);
+
+  // HttpCache
+  CachedResponseSharedPtr lookup(const std::string& key) override;
+  void insert(const std::string& key, CachedResponseSharedPtr response) override;
+
+private:
+  struct Shard {
+    Shard(uint64_t max_entries, Stats::Counter& evictions) : cache_(max_entries, evictions) {}
+
+    absl::Mutex mutex_;
+    LruCache cache_ GUARDED_BY(mutex_);
+  };
+
+  Shard& shard(const std::string& key);
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
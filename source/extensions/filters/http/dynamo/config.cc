@@ -14,9 +14,12 @@ namespace Dynamo {
 Http::FilterFactoryCb
 DynamoFilterConfig::createFilter(const std::string& stat_prefix,
                                  Server::Configuration::FactoryContext& context) {
-  return [&context, stat_prefix](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamFilter(Http::StreamFilterSharedPtr{
-        new Dynamo::DynamoFilter(context.runtime(), stat_prefix, context.scope())});
+  Stats::DynamicStatsCacheSharedPtr dynamic_stats =
+      std::make_shared<Stats::DynamicStatsCache>(context.scope(), context.threadLocal());
+  return [&context, stat_prefix,
+          dynamic_stats](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addStreamFilter(Http::StreamFilterSharedPtr{new Dynamo::DynamoFilter(
+        context.runtime(), stat_prefix, context.scope(), dynamic_stats)});
   };
 }
 
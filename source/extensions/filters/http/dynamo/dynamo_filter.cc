@@ -3,15 +3,12 @@
 #include <chrono>
 #include <cstdint>
 #include <string>
-#include <vector>
 
-#include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
 #include "common/http/codes.h"
 #include "common/http/exception.h"
 #include "common/http/utility.h"
-#include "common/json/json_loader.h"
 
 #include "extensions/filters/http/dynamo/dynamo_request_parser.h"
 #include "extensions/filters/http/dynamo/dynamo_utility.h"
@@ -25,134 +22,102 @@ Http::FilterHeadersStatus DynamoFilter::decodeHeaders(Http::HeaderMap& headers,
   if (enabled_) {
     start_decode_ = std::chrono::steady_clock::now();
     operation_ = RequestParser::parseOperation(headers);
-    return Http::FilterHeadersStatus::StopIteration;
-  } else {
-    return Http::FilterHeadersStatus::Continue;
+    request_parser_ = std::make_unique<RequestBodyParser>(operation_);
   }
+
+  return Http::FilterHeadersStatus::Continue;
 }
 
 Http::FilterDataStatus DynamoFilter::decodeData(Buffer::Instance& data, bool end_stream) {
-  if (enabled_ && end_stream) {
-    onDecodeComplete(data);
+  if (enabled_) {
+    // The body is parsed as it passes through rather than buffered.
+    request_parser_->parse(data);
+    if (end_stream) {
+      onDecodeComplete();
+    }
   }
 
-  if (!enabled_ || end_stream) {
-    return Http::FilterDataStatus::Continue;
-  } else {
-    // Buffer until the complete request has been processed.
-    return Http::FilterDataStatus::StopIterationAndBuffer;
-  }
+  return Http::FilterDataStatus::Continue;
 }
 
 Http::FilterTrailersStatus DynamoFilter::decodeTrailers(Http::HeaderMap&) {
   if (enabled_) {
-    Buffer::OwnedImpl empty;
-    onDecodeComplete(empty);
+    onDecodeComplete();
   }
 
   return Http::FilterTrailersStatus::Continue;
 }
 
-void DynamoFilter::onDecodeComplete(const Buffer::Instance& data) {
-  std::string body = buildBody(decoder_callbacks_->decodingBuffer(), data);
-  if (!body.empty()) {
-    try {
-      Json::ObjectSharedPtr json_body = Json::Factory::loadFromString(body);
-      table_descriptor_ = RequestParser::parseTable(operation_, *json_body);
-    } catch (const Json::Exception& jsonEx) {
+void DynamoFilter::onDecodeComplete() {
+  if (!request_parser_->empty()) {
+    if (request_parser_->finish()) {
+      table_descriptor_ = request_parser_->table();
+    } else {
       // Body parsing failed. This should not happen, just put a stat for that.
       scope_.counter(fmt::format("{}invalid_req_body", stat_prefix_)).inc();
     }
   }
 }
 
-void DynamoFilter::onEncodeComplete(const Buffer::Instance& data) {
+void DynamoFilter::onEncodeComplete() {
   ASSERT(enabled_);
   uint64_t status = Http::Utility::getResponseStatus(*response_headers_);
   chargeBasicStats(status);
 
-  std::string body = buildBody(encoder_callbacks_->encodingBuffer(), data);
-  if (!body.empty()) {
-    try {
-      Json::ObjectSharedPtr json_body = Json::Factory::loadFromString(body);
-      chargeTablePartitionIdStats(*json_body);
+  if (!response_parser_.empty()) {
+    if (response_parser_.finish()) {
+      chargeTablePartitionIdStats();
 
       if (Http::CodeUtility::is4xx(status)) {
-        chargeFailureSpecificStats(*json_body);
+        chargeFailureSpecificStats();
       }
       // Batch Operations will always return status 200 for a partial or full success. Check
       // unprocessed keys to determine partial success.
       // http://docs.aws.amazon.com/amazondynamodb/latest/developerguide/Programming.Errors.html#Programming.Errors.BatchOperations
       if (RequestParser::isBatchOperation(operation_)) {
-        chargeUnProcessedKeysStats(*json_body);
+        chargeUnProcessedKeysStats();
       }
-    } catch (const Json::Exception&) {
+    } else {
       // Body parsing failed. This should not happen, just put a stat for that.
       scope_.counter(fmt::format("{}invalid_resp_body", stat_prefix_)).inc();
     }
   }
+
+  response_parser_.reset();
 }
 
 Http::FilterHeadersStatus DynamoFilter::encodeHeaders(Http::HeaderMap& headers, bool end_stream) {
-  Http::FilterHeadersStatus status = Http::FilterHeadersStatus::Continue;
   if (enabled_) {
     response_headers_ = &headers;
 
     if (end_stream) {
-      Buffer::OwnedImpl empty;
-      onEncodeComplete(empty);
-    } else {
-      status = Http::FilterHeadersStatus::StopIteration;
+      onEncodeComplete();
     }
   }
 
-  return status;
+  return Http::FilterHeadersStatus::Continue;
 }
 
 Http::FilterDataStatus DynamoFilter::encodeData(Buffer::Instance& data, bool end_stream) {
-  if (enabled_ && end_stream) {
-    onEncodeComplete(data);
+  if (enabled_) {
+    // The body is parsed as it passes through rather than buffered.
+    response_parser_.parse(data);
+    if (end_stream) {
+      onEncodeComplete();
+    }
   }
 
-  if (!enabled_ || end_stream) {
-    return Http::FilterDataStatus::Continue;
-  } else {
-    // Buffer until the complete response has been processed.
-    return Http::FilterDataStatus::StopIterationAndBuffer;
-  }
+  return Http::FilterDataStatus::Continue;
 }
 
 Http::FilterTrailersStatus DynamoFilter::encodeTrailers(Http::HeaderMap&) {
   if (enabled_) {
-    Buffer::OwnedImpl empty;
-    onEncodeComplete(empty);
+    onEncodeComplete();
   }
 
   return Http::FilterTrailersStatus::Continue;
 }
 
-std::string DynamoFilter::buildBody(const Buffer::Instance* buffered,
-                                    const Buffer::Instance& last) {
-  std::string body;
-  if (buffered) {
-    uint64_t num_slices = buffered->getRawSlices(nullptr, 0);
-    Buffer::RawSlice slices[num_slices];
-    buffered->getRawSlices(slices, num_slices);
-    for (Buffer::RawSlice& slice : slices) {
-      body.append(static_cast<const char*>(slice.mem_), slice.len_);
-    }
-  }
-
-  uint64_t num_slices = last.getRawSlices(nullptr, 0);
-  Buffer::RawSlice slices[num_slices];
-  last.getRawSlices(slices, num_slices);
-  for (Buffer::RawSlice& slice : slices) {
-    body.append(static_cast<const char*>(slice.mem_), slice.len_);
-  }
-
-  return body;
-}
-
 void DynamoFilter::chargeBasicStats(uint64_t status) {
   if (!operation_.empty()) {
     chargeStatsPerEntity(operation_, "operation", status);
@@ -174,53 +139,47 @@ void DynamoFilter::chargeStatsPerEntity(const std::string& entity, const std::st
   std::chrono::milliseconds latency = std::chrono::duration_cast<std::chrono::milliseconds>(
       std::chrono::steady_clock::now() - start_decode_);
 
-  std::string group_string =
+  const std::string group_string =
       Http::CodeUtility::groupStringForResponseCode(static_cast<Http::Code>(status));
+  const std::string status_string = std::to_string(status);
 
-  scope_.counter(fmt::format("{}{}.{}.upstream_rq_total", stat_prefix_, entity_type, entity)).inc();
-  scope_
-      .counter(fmt::format("{}{}.{}.upstream_rq_total_{}", stat_prefix_, entity_type, entity,
-                           group_string))
+  dynamic_stats_->counter({stat_prefix_, entity_type, ".", entity, ".upstream_rq_total"}).inc();
+  dynamic_stats_
+      ->counter({stat_prefix_, entity_type, ".", entity, ".upstream_rq_total_", group_string})
       .inc();
-  scope_
-      .counter(fmt::format("{}{}.{}.upstream_rq_total_{}", stat_prefix_, entity_type, entity,
-                           std::to_string(status)))
+  dynamic_stats_
+      ->counter({stat_prefix_, entity_type, ".", entity, ".upstream_rq_total_", status_string})
       .inc();
 
-  scope_.histogram(fmt::format("{}{}.{}.upstream_rq_time", stat_prefix_, entity_type, entity))
+  dynamic_stats_->histogram({stat_prefix_, entity_type, ".", entity, ".upstream_rq_time"})
       .recordValue(latency.count());
-  scope_
-      .histogram(fmt::format("{}{}.{}.upstream_rq_time_{}", stat_prefix_, entity_type, entity,
-                             group_string))
+  dynamic_stats_
+      ->histogram({stat_prefix_, entity_type, ".", entity, ".upstream_rq_time_", group_string})
       .recordValue(latency.count());
-  scope_
-      .histogram(fmt::format("{}{}.{}.upstream_rq_time_{}", stat_prefix_, entity_type, entity,
-                             std::to_string(status)))
+  dynamic_stats_
+      ->histogram({stat_prefix_, entity_type, ".", entity, ".upstream_rq_time_", status_string})
       .recordValue(latency.count());
 }
 
-void DynamoFilter::chargeUnProcessedKeysStats(const Json::Object& json_body) {
+void DynamoFilter::chargeUnProcessedKeysStats() {
   // The unprocessed keys block contains a list of tables and keys for that table that did not
   // complete apart of the batch operation. Only the table names will be logged for errors.
-  std::vector<std::string> unprocessed_tables = RequestParser::parseBatchUnProcessedKeys(json_body);
-  for (const std::string& unprocessed_table : unprocessed_tables) {
-    scope_
-        .counter(
-            fmt::format("{}error.{}.BatchFailureUnprocessedKeys", stat_prefix_, unprocessed_table))
+  for (const std::string& unprocessed_table : response_parser_.unprocessedTables()) {
+    dynamic_stats_
+        ->counter({stat_prefix_, "error.", unprocessed_table, ".BatchFailureUnprocessedKeys"})
         .inc();
   }
 }
 
-void DynamoFilter::chargeFailureSpecificStats(const Json::Object& json_body) {
-  std::string error_type = RequestParser::parseErrorType(json_body);
+void DynamoFilter::chargeFailureSpecificStats() {
+  const std::string& error_type = response_parser_.errorType();
 
   if (!error_type.empty()) {
     if (table_descriptor_.table_name.empty()) {
-      scope_.counter(fmt::format("{}error.no_table.{}", stat_prefix_, error_type)).inc();
+      dynamic_stats_->counter({stat_prefix_, "error.no_table.", error_type}).inc();
     } else {
-      scope_
-          .counter(
-              fmt::format("{}error.{}.{}", stat_prefix_, table_descriptor_.table_name, error_type))
+      dynamic_stats_
+          ->counter({stat_prefix_, "error.", table_descriptor_.table_name, ".", error_type})
           .inc();
     }
   } else {
@@ -228,14 +187,12 @@ void DynamoFilter::chargeFailureSpecificStats(const Json::Object& json_body) {
   }
 }
 
-void DynamoFilter::chargeTablePartitionIdStats(const Json::Object& json_body) {
+void DynamoFilter::chargeTablePartitionIdStats() {
   if (table_descriptor_.table_name.empty() || operation_.empty()) {
     return;
   }
 
-  std::vector<RequestParser::PartitionDescriptor> partitions =
-      RequestParser::parsePartitions(json_body);
-  for (const RequestParser::PartitionDescriptor& partition : partitions) {
+  for (const RequestParser::PartitionDescriptor& partition : response_parser_.partitions()) {
     std::string scope_string =
         Utility::buildPartitionStatString(stat_prefix_, table_descriptor_.table_name, operation_,
                                           partition.partition_id_, scope_.statsOptions());
@@ -1,13 +1,14 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 
 #include "envoy/http/filter.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
 
-#include "common/json/json_loader.h"
+#include "common/stats/dynamic_stats_cache.h"
 
 #include "extensions/filters/http/dynamo/dynamo_request_parser.h"
 
@@ -21,11 +22,14 @@ namespace Dynamo {
  * It captures RPS/latencies:
  *  1) Per table per response code (and group of response codes, e.g., 2xx/3xx/etc)
  *  2) Per operation per response code (and group of response codes, e.g., 2xx/3xx/etc)
+ * Request and response bodies are parsed as they stream through, so neither is buffered.
  */
 class DynamoFilter : public Http::StreamFilter {
 public:
-  DynamoFilter(Runtime::Loader& runtime, const std::string& stat_prefix, Stats::Scope& scope)
-      : runtime_(runtime), stat_prefix_(stat_prefix + "dynamodb."), scope_(scope) {
+  DynamoFilter(Runtime::Loader& runtime, const std::string& stat_prefix, Stats::Scope& scope,
+               const Stats::DynamicStatsCacheSharedPtr& dynamic_stats)
+      : runtime_(runtime), stat_prefix_(stat_prefix + "dynamodb."), scope_(scope),
+        dynamic_stats_(dynamic_stats) {
     enabled_ = runtime_.snapshot().featureEnabled("dynamodb.filter_enabled", 100);
   }
 
@@ -52,23 +56,26 @@ public:
   }
 
 private:
-  void onDecodeComplete(const Buffer::Instance& data);
-  void onEncodeComplete(const Buffer::Instance& data);
-  std::string buildBody(const Buffer::Instance* buffered, const Buffer::Instance& last);
+  void onDecodeComplete();
+  void onEncodeComplete();
   void chargeBasicStats(uint64_t status);
   void chargeStatsPerEntity(const std::string& entity, const std::string& entity_type,
                             uint64_t status);
-  void chargeFailureSpecificStats(const Json::Object& json_body);
-  void chargeUnProcessedKeysStats(const Json::Object& json_body);
-  void chargeTablePartitionIdStats(const Json::Object& json_body);
+  void chargeFailureSpecificStats();
+  void chargeUnProcessedKeysStats();
+  void chargeTablePartitionIdStats();
 
   Runtime::Loader& runtime_;
   std::string stat_prefix_;
   Stats::Scope& scope_;
+  // The stats named after operations, tables and errors.
+  const Stats::DynamicStatsCacheSharedPtr dynamic_stats_;
 
   bool enabled_{};
   std::string operation_{};
   RequestParser::TableDescriptor table_descriptor_{"", true};
+  std::unique_ptr<RequestBodyParser> request_parser_;
+  ResponseBodyParser response_parser_;
   std::string error_type_{};
   MonotonicTime start_decode_;
   Http::HeaderMap* response_headers_;
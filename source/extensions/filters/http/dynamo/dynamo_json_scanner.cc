@@ -0,0 +1,457 @@
+#include "extensions/filters/http/dynamo/dynamo_json_scanner.h"
+
+#include "common/common/assert.h"
+
+#include "absl/strings/numbers.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Dynamo {
+
+namespace {
+
+bool isWhitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+bool isNumberChar(char c) {
+  return isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+// Matches -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool isValidNumber(const std::string& number) {
+  const char* c = number.c_str();
+  if (*c == '-') {
+    c++;
+  }
+  if (*c == '0') {
+    c++;
+  } else if (isDigit(*c)) {
+    while (isDigit(*c)) {
+      c++;
+    }
+  } else {
+    return false;
+  }
+  if (*c == '.') {
+    c++;
+    if (!isDigit(*c)) {
+      return false;
+    }
+    while (isDigit(*c)) {
+      c++;
+    }
+  }
+  if (*c == 'e' || *c == 'E') {
+    c++;
+    if (*c == '+' || *c == '-') {
+      c++;
+    }
+    if (!isDigit(*c)) {
+      return false;
+    }
+    while (isDigit(*c)) {
+      c++;
+    }
+  }
+  return *c == '\0';
+}
+
+int hexValue(char c) {
+  if (isDigit(c)) {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+} // namespace
+
+JsonScanner::JsonScanner(JsonScannerCallbacks& callbacks) : callbacks_(callbacks) { reset(); }
+
+void JsonScanner::reset() {
+  state_ = State::Value;
+  stack_.clear();
+  path_.clear();
+  reported_ = false;
+  key_ = false;
+  empty_ = true;
+  token_.clear();
+  literal_ = nullptr;
+  literal_index_ = 0;
+  code_unit_ = 0;
+  code_unit_digits_ = 0;
+  high_surrogate_ = 0;
+}
+
+void JsonScanner::scan(const Buffer::Instance& data) {
+  uint64_t num_slices = data.getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  data.getRawSlices(slices, num_slices);
+  for (const Buffer::RawSlice& slice : slices) {
+    scan(static_cast<const char*>(slice.mem_), slice.len_);
+  }
+}
+
+void JsonScanner::scan(const char* data, uint64_t length) {
+  if (length > 0) {
+    empty_ = false;
+  }
+
+  for (uint64_t i = 0; i < length && state_ != State::Error; i++) {
+    if (state_ == State::String && !reported_) {
+      // Skip the bulk of the strings that are not reported, such as item attributes.
+      while (i < length && data[i] != '"' && data[i] != '\\' &&
+             static_cast<uint8_t>(data[i]) >= 0x20) {
+        i++;
+      }
+      if (i == length) {
+        break;
+      }
+    }
+
+    consume(data[i]);
+  }
+}
+
+bool JsonScanner::finish() {
+  if (state_ == State::Number && stack_.empty()) {
+    endNumber();
+  }
+
+  return state_ == State::Done;
+}
+
+void JsonScanner::consume(char c) {
+  switch (state_) {
+  case State::Value:
+    if (!isWhitespace(c)) {
+      startValue(c);
+    }
+    return;
+
+  case State::FirstMemberOrEnd:
+    if (c == '}') {
+      stack_.pop_back();
+      endValue();
+    } else if (!isWhitespace(c)) {
+      startMember(c);
+    }
+    return;
+
+  case State::Member:
+    if (!isWhitespace(c)) {
+      startMember(c);
+    }
+    return;
+
+  case State::Colon:
+    if (c == ':') {
+      state_ = State::Value;
+    } else if (!isWhitespace(c)) {
+      fail();
+    }
+    return;
+
+  case State::FirstValueOrEnd:
+    if (c == ']') {
+      stack_.pop_back();
+      endValue();
+    } else if (!isWhitespace(c)) {
+      startValue(c);
+    }
+    return;
+
+  case State::AfterValue: {
+    if (isWhitespace(c)) {
+      return;
+    }
+
+    const Container& top = stack_.back();
+    if (c == ',') {
+      state_ = top.object_ ? State::Member : State::Value;
+    } else if (c == (top.object_ ? '}' : ']')) {
+      stack_.pop_back();
+      endValue();
+    } else {
+      fail();
+    }
+    return;
+  }
+
+  case State::String:
+    if (c == '"') {
+      endString();
+    } else if (c == '\\') {
+      state_ = State::Escape;
+    } else if (static_cast<uint8_t>(c) < 0x20) {
+      fail();
+    } else if (reported_) {
+      token_.push_back(c);
+    }
+    return;
+
+  case State::Escape: {
+    char unescaped;
+    switch (c) {
+    case '"':
+    case '\\':
+    case '/':
+      unescaped = c;
+      break;
+    case 'b':
+      unescaped = '\b';
+      break;
+    case 'f':
+      unescaped = '\f';
+      break;
+    case 'n':
+      unescaped = '\n';
+      break;
+    case 'r':
+      unescaped = '\r';
+      break;
+    case 't':
+      unescaped = '\t';
+      break;
+    case 'u':
+      code_unit_ = 0;
+      code_unit_digits_ = 0;
+      state_ = State::Unicode;
+      return;
+    default:
+      fail();
+      return;
+    }
+
+    if (reported_) {
+      token_.push_back(unescaped);
+    }
+    state_ = State::String;
+    return;
+  }
+
+  case State::Unicode: {
+    const int value = hexValue(c);
+    if (value < 0) {
+      fail();
+      return;
+    }
+
+    code_unit_ = (code_unit_ << 4) | value;
+    if (++code_unit_digits_ == 4) {
+      onCodeUnit();
+    }
+    return;
+  }
+
+  case State::SurrogateEscape:
+    if (c == '\\') {
+      state_ = State::SurrogateU;
+    } else {
+      fail();
+    }
+    return;
+
+  case State::SurrogateU:
+    if (c == 'u') {
+      code_unit_ = 0;
+      code_unit_digits_ = 0;
+      state_ = State::Unicode;
+    } else {
+      fail();
+    }
+    return;
+
+  case State::Number:
+    if (isNumberChar(c)) {
+      token_.push_back(c);
+    } else if (endNumber()) {
+      // The character after the number belongs to the enclosing container.
+      consume(c);
+    }
+    return;
+
+  case State::Literal:
+    if (c != literal_[literal_index_]) {
+      fail();
+    } else if (literal_[++literal_index_] == '\0') {
+      endValue();
+    }
+    return;
+
+  case State::Done:
+    if (!isWhitespace(c)) {
+      fail();
+    }
+    return;
+
+  case State::Error:
+    return;
+  }
+
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+bool JsonScanner::memberReported() const {
+  return !stack_.empty() && stack_.back().object_ && stack_.back().member_reported_;
+}
+
+void JsonScanner::startValue(char c) {
+  reported_ = memberReported();
+
+  switch (c) {
+  case '{':
+    // The root object is visible, nested objects if they are the value of a reported member.
+    stack_.push_back({true, stack_.empty() || reported_, false});
+    state_ = State::FirstMemberOrEnd;
+    return;
+  case '[':
+    stack_.push_back({false, false, false});
+    state_ = State::FirstValueOrEnd;
+    return;
+  case '"':
+    key_ = false;
+    token_.clear();
+    state_ = State::String;
+    return;
+  case 't':
+    literal_ = "true";
+    break;
+  case 'f':
+    literal_ = "false";
+    break;
+  case 'n':
+    literal_ = "null";
+    break;
+  default:
+    if (c == '-' || isDigit(c)) {
+      token_.assign(1, c);
+      state_ = State::Number;
+    } else {
+      fail();
+    }
+    return;
+  }
+
+  literal_index_ = 1;
+  state_ = State::Literal;
+}
+
+void JsonScanner::startMember(char c) {
+  if (c != '"') {
+    fail();
+    return;
+  }
+
+  reported_ = stack_.back().visible_;
+  key_ = true;
+  token_.clear();
+  state_ = State::String;
+}
+
+void JsonScanner::endString() {
+  if (key_) {
+    if (reported_) {
+      path_.push_back(token_);
+      stack_.back().member_reported_ = callbacks_.onMember(path_);
+      if (!stack_.back().member_reported_) {
+        path_.pop_back();
+      }
+    }
+    state_ = State::Colon;
+    return;
+  }
+
+  if (reported_) {
+    callbacks_.onString(path_, token_);
+  }
+  endValue();
+}
+
+bool JsonScanner::endNumber() {
+  if (!isValidNumber(token_)) {
+    fail();
+    return false;
+  }
+
+  if (reported_) {
+    double value;
+    if (!absl::SimpleAtod(token_, &value)) {
+      fail();
+      return false;
+    }
+    callbacks_.onNumber(path_, value);
+  }
+  endValue();
+  return true;
+}
+
+void JsonScanner::endValue() {
+  if (stack_.empty()) {
+    state_ = State::Done;
+    return;
+  }
+
+  Container& top = stack_.back();
+  if (top.object_ && top.member_reported_) {
+    path_.pop_back();
+    top.member_reported_ = false;
+  }
+  state_ = State::AfterValue;
+}
+
+void JsonScanner::onCodeUnit() {
+  state_ = State::String;
+
+  if (high_surrogate_ != 0) {
+    if (code_unit_ < 0xDC00 || code_unit_ > 0xDFFF) {
+      fail();
+      return;
+    }
+
+    appendCodePoint(0x10000 + ((high_surrogate_ - 0xD800) << 10) + (code_unit_ - 0xDC00));
+    high_surrogate_ = 0;
+  } else if (code_unit_ >= 0xD800 && code_unit_ <= 0xDBFF) {
+    // The low surrogate must follow as another escape.
+    high_surrogate_ = code_unit_;
+    state_ = State::SurrogateEscape;
+  } else if (code_unit_ >= 0xDC00 && code_unit_ <= 0xDFFF) {
+    fail();
+  } else {
+    appendCodePoint(code_unit_);
+  }
+}
+
+void JsonScanner::appendCodePoint(uint32_t code_point) {
+  if (!reported_) {
+    return;
+  }
+
+  if (code_point < 0x80) {
+    token_.push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    token_.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    token_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    token_.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    token_.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    token_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    token_.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    token_.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    token_.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    token_.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+} // namespace Dynamo
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Dynamo {
+
+/**
+ * Callbacks for the members found by a JsonScanner. The members of the root object are reported,
+ * as are the members of an object that is the value of a reported member, if onMember() asked for
+ * it. Nothing inside an array is reported. The path of a member lists the member names from the
+ * root down to the member itself.
+ */
+class JsonScannerCallbacks {
+public:
+  virtual ~JsonScannerCallbacks() {}
+
+  /**
+   * Called when the name of a member has been read.
+   * @param path supplies the path of the member.
+   * @return bool whether to report the value of the member, and the members nested in it.
+   */
+  virtual bool onMember(const std::vector<std::string>& path) PURE;
+
+  /**
+   * Called when the value of a member is a string.
+   * @param path supplies the path of the member.
+   * @param value supplies the unescaped string.
+   */
+  virtual void onString(const std::vector<std::string>& path, const std::string& value) PURE;
+
+  /**
+   * Called when the value of a member is a number.
+   * @param path supplies the path of the member.
+   * @param value supplies the number.
+   */
+  virtual void onNumber(const std::vector<std::string>& path, double value) PURE;
+};
+
+/**
+ * A forward only JSON scanner that validates a document as it arrives in arbitrary pieces and
+ * reports the members its callbacks need. Only the member names on the current path and the
+ * token being read are held, so the document itself never has to be buffered.
+ */
+class JsonScanner {
+public:
+  JsonScanner(JsonScannerCallbacks& callbacks);
+
+  /**
+   * Scan the next piece of the document.
+   * @param data supplies the piece, which is not drained.
+   */
+  void scan(const Buffer::Instance& data);
+
+  /**
+   * Complete the document.
+   * @return bool whether all the pieces formed a single valid JSON value.
+   */
+  bool finish();
+
+  /**
+   * @return bool whether nothing has been scanned since construction or the last reset.
+   */
+  bool empty() const { return empty_; }
+
+  /**
+   * Discard the state of the document, to scan another one.
+   */
+  void reset();
+
+private:
+  enum class State {
+    Value,
+    FirstMemberOrEnd,
+    Member,
+    Colon,
+    FirstValueOrEnd,
+    AfterValue,
+    String,
+    Escape,
+    Unicode,
+    SurrogateEscape,
+    SurrogateU,
+    Number,
+    Literal,
+    Done,
+    Error,
+  };
+
+  struct Container {
+    bool object_;
+    // Whether the members of this object are reported.
+    bool visible_;
+    // Whether the value of the member being read is reported, and so the member is on the path.
+    bool member_reported_;
+  };
+
+  void scan(const char* data, uint64_t length);
+  void consume(char c);
+  void startValue(char c);
+  void startMember(char c);
+  void endString();
+  bool endNumber();
+  void endValue();
+  void onCodeUnit();
+  void appendCodePoint(uint32_t code_point);
+  bool memberReported() const;
+  void fail() { state_ = State::Error; }
+
+  JsonScannerCallbacks& callbacks_;
+
+  State state_;
+  std::vector<Container> stack_;
+  std::vector<std::string> path_;
+  // Whether the string or number being read is reported.
+  bool reported_;
+  bool key_;
+  bool empty_;
+  std::string token_;
+  const char* literal_;
+  uint32_t literal_index_;
+  uint32_t code_unit_;
+  uint32_t code_unit_digits_;
+  uint32_t high_surrogate_;
+};
+
+} // namespace Dynamo
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -71,11 +71,9 @@ RequestParser::TableDescriptor RequestParser::parseTable(const std::string& oper
   TableDescriptor table{"", true};
 
   // Simple operations on a single table, have "TableName" explicitly specified.
-  if (find(SINGLE_TABLE_OPERATIONS.begin(), SINGLE_TABLE_OPERATIONS.end(), operation) !=
-      SINGLE_TABLE_OPERATIONS.end()) {
+  if (isSingleTableOperation(operation)) {
     table.table_name = json_data.getString("TableName", "");
-  } else if (find(BATCH_OPERATIONS.begin(), BATCH_OPERATIONS.end(), operation) !=
-             BATCH_OPERATIONS.end()) {
+  } else if (isBatchOperation(operation)) {
     Json::ObjectSharedPtr tables = json_data.getObject("RequestItems", true);
     tables->iterate([&table](const std::string& key, const Json::Object&) {
       if (table.table_name.empty()) {
@@ -104,13 +102,16 @@ std::vector<std::string> RequestParser::parseBatchUnProcessedKeys(const Json::Ob
   return unprocessed_tables;
 }
 std::string RequestParser::parseErrorType(const Json::Object& json_data) {
-  std::string error_type = json_data.getString("__type", "");
-  if (error_type.empty()) {
+  return parseErrorType(json_data.getString("__type", ""));
+}
+
+std::string RequestParser::parseErrorType(const std::string& type) {
+  if (type.empty()) {
     return "";
   }
 
   for (const std::string& supported_error_type : SUPPORTED_ERROR_TYPES) {
-    if (StringUtil::endsWith(error_type, supported_error_type)) {
+    if (StringUtil::endsWith(type, supported_error_type)) {
       return supported_error_type;
     }
   }
@@ -118,6 +119,11 @@ std::string RequestParser::parseErrorType(const Json::Object& json_data) {
   return "";
 }
 
+bool RequestParser::isSingleTableOperation(const std::string& operation) {
+  return find(SINGLE_TABLE_OPERATIONS.begin(), SINGLE_TABLE_OPERATIONS.end(), operation) !=
+         SINGLE_TABLE_OPERATIONS.end();
+}
+
 bool RequestParser::isBatchOperation(const std::string& operation) {
   return find(BATCH_OPERATIONS.begin(), BATCH_OPERATIONS.end(), operation) !=
          BATCH_OPERATIONS.end();
@@ -143,6 +149,67 @@ RequestParser::parsePartitions(const Json::Object& json_data) {
   return partition_descriptors;
 }
 
+bool RequestBodyParser::onMember(const std::vector<std::string>& path) {
+  // The tables of batch operations are the members of "RequestItems", in the order of the body.
+  if (path.size() == 2 && RequestParser::isBatchOperation(operation_) && table_.is_single_table) {
+    if (table_.table_name.empty()) {
+      table_.table_name = path[1];
+    } else if (table_.table_name != path[1]) {
+      table_.table_name = "";
+      table_.is_single_table = false;
+    }
+  }
+
+  return path.size() == 1 && (path[0] == "TableName" || path[0] == "RequestItems");
+}
+
+void RequestBodyParser::onString(const std::vector<std::string>& path, const std::string& value) {
+  if (path.size() == 1 && path[0] == "TableName" &&
+      RequestParser::isSingleTableOperation(operation_)) {
+    table_.table_name = value;
+  }
+}
+
+void ResponseBodyParser::reset() {
+  scanner_.reset();
+  error_type_.clear();
+  unprocessed_tables_.clear();
+  partitions_.clear();
+}
+
+bool ResponseBodyParser::onMember(const std::vector<std::string>& path) {
+  if (path.size() == 2 && path[0] == "UnprocessedKeys") {
+    unprocessed_tables_.emplace_back(path[1]);
+    return false;
+  }
+
+  // The partitions are the members of "ConsumedCapacity.Partitions".
+  switch (path.size()) {
+  case 1:
+    return path[0] == "__type" || path[0] == "UnprocessedKeys" || path[0] == "ConsumedCapacity";
+  case 2:
+    return path[0] == "ConsumedCapacity" && path[1] == "Partitions";
+  case 3:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void ResponseBodyParser::onString(const std::vector<std::string>& path,
+                                  const std::string& value) {
+  if (path.size() == 1 && path[0] == "__type") {
+    error_type_ = RequestParser::parseErrorType(value);
+  }
+}
+
+void ResponseBodyParser::onNumber(const std::vector<std::string>& path, double value) {
+  if (path.size() == 3) {
+    // Stats counter only increments by whole numbers, capacity is round up to the nearest integer.
+    partitions_.emplace_back(path[2], static_cast<uint64_t>(std::ceil(value)));
+  }
+}
+
 } // namespace Dynamo
 } // namespace HttpFilters
 } // namespace Extensions
@@ -8,6 +8,8 @@
 
 #include "common/json/json_loader.h"
 
+#include "extensions/filters/http/dynamo/dynamo_json_scanner.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
@@ -58,6 +60,11 @@ public:
    */
   static TableDescriptor parseTable(const std::string& operation, const Json::Object& json_data);
 
+  /**
+   * @return true if the operation is in the set of supported SINGLE_TABLE_OPERATIONS
+   */
+  static bool isSingleTableOperation(const std::string& operation);
+
   /**
    * Parse error details which might be provided for a given response code.
    * @return empty string if cannot get error details.
@@ -70,6 +77,12 @@ public:
    */
   static std::string parseErrorType(const Json::Object& json_data);
 
+  /**
+   * Map the __type of an error response to a supported error type.
+   * @return empty string if the error type is not supported.
+   */
+  static std::string parseErrorType(const std::string& type);
+
   /**
    * Parse unprocessed keys for batch operation results.
    * @return empty set if there are no unprocessed keys or a set of table names that did not get
@@ -102,6 +115,102 @@ private:
   RequestParser() {}
 };
 
+/**
+ * Parses the table out of a request body while the body streams through, without buffering it.
+ */
+class RequestBodyParser : public JsonScannerCallbacks {
+public:
+  RequestBodyParser(const std::string& operation) : operation_(operation), scanner_(*this) {}
+
+  /**
+   * Parse the next piece of the body.
+   */
+  void parse(const Buffer::Instance& data) { scanner_.scan(data); }
+
+  /**
+   * Complete the body.
+   * @return bool whether the body was valid json.
+   */
+  bool finish() { return scanner_.finish(); }
+
+  /**
+   * @return bool whether the body was empty.
+   */
+  bool empty() const { return scanner_.empty(); }
+
+  /**
+   * @return the table of the request, as RequestParser::parseTable() would parse it.
+   */
+  const RequestParser::TableDescriptor& table() const { return table_; }
+
+  // JsonScannerCallbacks
+  bool onMember(const std::vector<std::string>& path) override;
+  void onString(const std::vector<std::string>& path, const std::string& value) override;
+  void onNumber(const std::vector<std::string>&, double) override {}
+
+private:
+  const std::string operation_;
+  JsonScanner scanner_;
+  RequestParser::TableDescriptor table_{"", true};
+};
+
+/**
+ * Parses the error type, unprocessed keys and partitions out of a response body while the body
+ * streams through, without buffering it.
+ */
+class ResponseBodyParser : public JsonScannerCallbacks {
+public:
+  ResponseBodyParser() : scanner_(*this) {}
+
+  /**
+   * Parse the next piece of the body.
+   */
+  void parse(const Buffer::Instance& data) { scanner_.scan(data); }
+
+  /**
+   * Complete the body.
+   * @return bool whether the body was valid json.
+   */
+  bool finish() { return scanner_.finish(); }
+
+  /**
+   * @return bool whether the body was empty.
+   */
+  bool empty() const { return scanner_.empty(); }
+
+  /**
+   * Discard what was parsed, to parse another body.
+   */
+  void reset();
+
+  /**
+   * @return the error type, as RequestParser::parseErrorType() would parse it.
+   */
+  const std::string& errorType() const { return error_type_; }
+
+  /**
+   * @return the tables with unprocessed keys, as RequestParser::parseBatchUnProcessedKeys() would
+   * parse them.
+   */
+  const std::vector<std::string>& unprocessedTables() const { return unprocessed_tables_; }
+
+  /**
+   * @return the partitions, as RequestParser::parsePartitions() would parse them.
+   */
+  const std::vector<RequestParser::PartitionDescriptor>& partitions() const { return partitions_; }
+
+  // JsonScannerCallbacks
+  bool onMember(const std::vector<std::string>& path) override;
+  void onString(const std::vector<std::string>& path, const std::string& value) override;
+  void onNumber(const std::vector<std::string>& path, double value) override;
+
+private:
+  JsonScanner scanner_;
+  std::string error_type_;
+  std::vector<std::string> unprocessed_tables_;
+  std::vector<RequestParser::PartitionDescriptor> partitions_;
+};
+
 } // namespace Dynamo
 } // namespace HttpFilters
 } // namespace Extensions
@@ -19,11 +19,12 @@ namespace ExtAuthz {
 
 Http::FilterFactoryCb ExtAuthzFilterConfig::createFilterFactoryFromProtoTyped(
     const envoy::config::filter::http::ext_authz::v2alpha::ExtAuthz& proto_config,
-    const std::string&, Server::Configuration::FactoryContext& context) {
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
 
-  const auto filter_config =
-      std::make_shared<FilterConfig>(proto_config, context.localInfo(), context.scope(),
-                                     context.runtime(), context.clusterManager());
+  const auto filter_config = std::make_shared<FilterConfig>(
+      proto_config, context.localInfo(), context.scope(), context.runtime(),
+      context.clusterManager(), context.threadLocal(), context.dispatcher().timeSystem(),
+      stats_prefix);
 
   if (proto_config.has_http_service()) {
     const uint32_t timeout_ms = PROTOBUF_GET_MS_OR_DEFAULT(proto_config.http_service().server_uri(),
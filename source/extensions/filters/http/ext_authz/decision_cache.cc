@@ -0,0 +1,154 @@
+#include "extensions/filters/http/ext_authz/decision_cache.h"
+
+#include "common/common/assert.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+
+using Filters::Common::ExtAuthz::CheckStatus;
+using Filters::Common::ExtAuthz::Response;
+
+DecisionCache::DecisionCache(
+    const envoy::config::filter::http::ext_authz::v2alpha::DecisionCache& config,
+    ThreadLocal::SlotAllocator& tls, TimeSource& time_source, Stats::Scope& scope,
+    const std::string& stats_prefix)
+    : path_segments_(config.path_segments()),
+      ttl_(PROTOBUF_GET_MS_OR_DEFAULT(config, ttl, 10000)),
+      denied_ttl_(PROTOBUF_GET_MS_OR_DEFAULT(config, denied_ttl, 0)),
+      max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, 10000)),
+      tls_(tls.allocateSlot()), time_source_(time_source),
+      stats_{ALL_DECISION_CACHE_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix))} {
+  for (const auto& header : config.key_headers()) {
+    key_headers_.emplace_back(header);
+  }
+
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalCache>();
+  });
+}
+
+std::string DecisionCache::key(const Http::HeaderMap& headers) const {
+  absl::string_view path = headers.Path() ? headers.Path()->value().c_str() : "";
+  path = path.substr(0, path.find('?'));
+  if (path_segments_ > 0) {
+    // The path starts with a slash, so the slash ending the last segment kept is the next one.
+    size_t end = 0;
+    for (uint32_t segment = 0; segment < path_segments_ && end != absl::string_view::npos;
+         segment++) {
+      end = path.find('/', end + 1);
+    }
+    path = path.substr(0, end);
+  }
+
+  // Header values never hold a new line, which separates the parts of the key. A missing header
+  // and an empty one have distinct keys.
+  std::string key;
+  absl::StrAppend(&key, headers.Method() ? headers.Method()->value().c_str() : "", "\n",
+                  headers.Host() ? headers.Host()->value().c_str() : "", "\n", path);
+  for (const Http::LowerCaseString& header : key_headers_) {
+    const Http::HeaderEntry* entry = headers.get(header);
+    absl::StrAppend(&key, "\n", entry ? "=" : "", entry ? entry->value().c_str() : "");
+  }
+  return key;
+}
+
+CachedResponseSharedPtr DecisionCache::lookup(const std::string& key) {
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  auto it = cache.entries_.find(key);
+  if (it != cache.entries_.end() && it->second.expiry_ <= time_source_.monotonicTime()) {
+    cache.lru_.erase(it->second.lru_entry_);
+    cache.entries_.erase(it);
+    it = cache.entries_.end();
+  }
+
+  if (it == cache.entries_.end()) {
+    stats_.miss_.inc();
+    return nullptr;
+  }
+
+  cache.lru_.splice(cache.lru_.begin(), cache.lru_, it->second.lru_entry_);
+  stats_.hit_.inc();
+  return it->second.response_;
+}
+
+bool DecisionCache::startCheck(const std::string& key, DecisionCacheWaiter& waiter) {
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  auto it = cache.pending_.find(key);
+  if (it == cache.pending_.end()) {
+    cache.pending_.emplace(key, PendingCheck{&waiter, {}});
+    return true;
+  }
+
+  it->second.waiters_.push_back(&waiter);
+  stats_.coalesced_.inc();
+  return false;
+}
+
+void DecisionCache::completeCheck(const std::string& key, const Response& response) {
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  auto it = cache.pending_.find(key);
+  ASSERT(it != cache.pending_.end());
+  const std::list<DecisionCacheWaiter*> waiters = std::move(it->second.waiters_);
+  cache.pending_.erase(it);
+
+  if (response.status != CheckStatus::Error && ttl(response).count() > 0) {
+    insert(cache, key, response);
+  }
+
+  for (DecisionCacheWaiter* waiter : waiters) {
+    waiter->onDecision(response);
+  }
+}
+
+void DecisionCache::cancelCheck(const std::string& key, DecisionCacheWaiter& waiter) {
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  auto it = cache.pending_.find(key);
+  ASSERT(it != cache.pending_.end());
+  if (it->second.checker_ != &waiter) {
+    it->second.waiters_.remove(&waiter);
+    return;
+  }
+
+  // The first waiter to check again takes over the check, and the others wait for it.
+  const std::list<DecisionCacheWaiter*> waiters = std::move(it->second.waiters_);
+  cache.pending_.erase(it);
+  for (DecisionCacheWaiter* other : waiters) {
+    other->onCheckCancelled();
+  }
+}
+
+std::chrono::milliseconds DecisionCache::ttl(const Response& response) const {
+  if (response.max_age.has_value()) {
+    return response.max_age.value();
+  }
+  return response.status == CheckStatus::OK ? ttl_ : denied_ttl_;
+}
+
+void DecisionCache::insert(ThreadLocalCache& cache, const std::string& key,
+                           const Response& response) {
+  auto it = cache.entries_.find(key);
+  if (it != cache.entries_.end()) {
+    // The entry expired but has not been looked up since.
+    cache.lru_.erase(it->second.lru_entry_);
+    cache.entries_.erase(it);
+  } else if (cache.entries_.size() == max_entries_) {
+    cache.entries_.erase(cache.lru_.back());
+    cache.lru_.pop_back();
+    stats_.eviction_.inc();
+  }
+
+  cache.lru_.push_front(key);
+  cache.entries_.emplace(key, Entry{std::make_shared<const Response>(response),
+                                    time_source_.monotonicTime() + ttl(response),
+                                    cache.lru_.begin()});
+}
+
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
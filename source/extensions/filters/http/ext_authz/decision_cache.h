@@ -0,0 +1,153 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/common/pure.h"
+#include "envoy/common/time.h"
+#include "envoy/config/filter/http/ext_authz/v2alpha/ext_authz.pb.h"
+#include "envoy/http/header_map.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "extensions/filters/common/ext_authz/ext_authz.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+
+/**
+ * All decision cache stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_DECISION_CACHE_STATS(COUNTER)                                                          \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(coalesced)                                                                               \
+  COUNTER(eviction)
+// clang-format on
+
+/**
+ * Struct definition for all decision cache stats. @see stats_macros.h
+ */
+struct DecisionCacheStats {
+  ALL_DECISION_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+typedef std::shared_ptr<const Filters::Common::ExtAuthz::Response> CachedResponseSharedPtr;
+
+/**
+ * Callbacks of a request waiting for the check of another request with the same key.
+ */
+class DecisionCacheWaiter {
+public:
+  virtual ~DecisionCacheWaiter() {}
+
+  /**
+   * Called when the check that the waiter joined completed.
+   * @param response supplies the response of the check.
+   */
+  virtual void onDecision(const Filters::Common::ExtAuthz::Response& response) PURE;
+
+  /**
+   * Called when the check that the waiter joined was cancelled, so that the waiter must check
+   * again by itself.
+   */
+  virtual void onCheckCancelled() PURE;
+};
+
+/**
+ * A per worker cache of the decisions of the authorization service, which also coalesces the
+ * concurrent checks of requests with the same key. The first request with a key that misses the
+ * cache checks, and the following ones wait for its decision.
+ */
+class DecisionCache {
+public:
+  DecisionCache(const envoy::config::filter::http::ext_authz::v2alpha::DecisionCache& config,
+                ThreadLocal::SlotAllocator& tls, TimeSource& time_source, Stats::Scope& scope,
+                const std::string& stats_prefix);
+
+  /**
+   * @param headers supplies the headers of a request.
+   * @return std::string the key of the decision for the request.
+   */
+  std::string key(const Http::HeaderMap& headers) const;
+
+  /**
+   * Look up a decision.
+   * @param key supplies the key of the request.
+   * @return CachedResponseSharedPtr the decision, or nullptr if none is cached.
+   */
+  CachedResponseSharedPtr lookup(const std::string& key);
+
+  /**
+   * Start the check of a request which missed the cache.
+   * @param key supplies the key of the request.
+   * @param waiter supplies the callbacks of the request.
+   * @return bool true if the request must call the authorization service and then report the
+   *         decision with completeCheck(), or false if it waits for the check of another request.
+   */
+  bool startCheck(const std::string& key, DecisionCacheWaiter& waiter);
+
+  /**
+   * Report the decision of a check, which is cached and handed to the waiting requests.
+   * @param key supplies the key of the request.
+   * @param response supplies the response of the authorization service.
+   */
+  void completeCheck(const std::string& key,
+                     const Filters::Common::ExtAuthz::Response& response);
+
+  /**
+   * Cancel the check of a request, or stop waiting for another check. The requests waiting for
+   * a cancelled check are told to check again.
+   * @param key supplies the key of the request.
+   * @param waiter supplies the callbacks the request started the check with.
+   */
+  void cancelCheck(const std::string& key, DecisionCacheWaiter& waiter);
+
+private:
+  struct Entry {
+    CachedResponseSharedPtr response_;
+    MonotonicTime expiry_;
+    std::list<std::string>::iterator lru_entry_;
+  };
+
+  struct PendingCheck {
+    DecisionCacheWaiter* checker_;
+    std::list<DecisionCacheWaiter*> waiters_;
+  };
+
+  struct ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
+    std::unordered_map<std::string, Entry> entries_;
+    // Keys from the most to the least recently used.
+    std::list<std::string> lru_;
+    std::unordered_map<std::string, PendingCheck> pending_;
+  };
+
+  std::chrono::milliseconds ttl(const Filters::Common::ExtAuthz::Response& response) const;
+  void insert(ThreadLocalCache& cache, const std::string& key,
+              const Filters::Common::ExtAuthz::Response& response);
+
+  std::vector<Http::LowerCaseString> key_headers_;
+  const uint32_t path_segments_;
+  const std::chrono::milliseconds ttl_;
+  const std::chrono::milliseconds denied_ttl_;
+  const uint64_t max_entries_;
+  ThreadLocal::SlotPtr tls_;
+  TimeSource& time_source_;
+  DecisionCacheStats stats_;
+};
+
+typedef std::unique_ptr<DecisionCache> DecisionCachePtr;
+
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -23,16 +23,42 @@ void Filter::initiateCall(const Http::HeaderMap& headers) {
   }
   cluster_ = cluster->info();
 
-  Filters::Common::ExtAuthz::CheckRequestUtils::createHttpCheck(callbacks_, headers,
-                                                                check_request_);
-
   state_ = State::Calling;
   // Don't let the filter chain continue as we are going to invoke check call.
   filter_return_ = FilterReturn::StopDecoding;
   initiating_call_ = true;
+
+  DecisionCache* cache = config_->decisionCache();
+  if (cache != nullptr) {
+    cache_key_ = cache->key(headers);
+    CachedResponseSharedPtr cached_response = cache->lookup(cache_key_);
+    if (cached_response != nullptr) {
+      ENVOY_STREAM_LOG(trace, "Ext_authz filter using a cached decision", *callbacks_);
+      onComplete(std::make_unique<Filters::Common::ExtAuthz::Response>(*cached_response));
+      initiating_call_ = false;
+      return;
+    }
+  }
+
+  check();
+  initiating_call_ = false;
+}
+
+void Filter::check() {
+  DecisionCache* cache = config_->decisionCache();
+  if (cache != nullptr) {
+    if (!cache->startCheck(cache_key_, *this)) {
+      ENVOY_STREAM_LOG(trace, "Ext_authz filter waiting for a concurrent check", *callbacks_);
+      cache_waiter_ = true;
+      return;
+    }
+    cache_checker_ = true;
+  }
+
+  Filters::Common::ExtAuthz::CheckRequestUtils::createHttpCheck(callbacks_, *request_headers_,
+                                                                check_request_);
   ENVOY_STREAM_LOG(trace, "Ext_authz filter calling authorization server", *callbacks_);
   client_->check(*this, check_request_, callbacks_->activeSpan());
-  initiating_call_ = false;
 }
 
 Http::FilterHeadersStatus Filter::decodeHeaders(Http::HeaderMap& headers, bool) {
@@ -60,13 +86,32 @@ void Filter::setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callb
 void Filter::onDestroy() {
   if (state_ == State::Calling) {
     state_ = State::Complete;
-    client_->cancel();
+    if (!cache_waiter_) {
+      client_->cancel();
+    }
+    if (cache_checker_ || cache_waiter_) {
+      config_->decisionCache()->cancelCheck(cache_key_, *this);
+    }
   }
 }
 
+void Filter::onDecision(const Filters::Common::ExtAuthz::Response& response) {
+  cache_waiter_ = false;
+  onComplete(std::make_unique<Filters::Common::ExtAuthz::Response>(response));
+}
+
+void Filter::onCheckCancelled() {
+  cache_waiter_ = false;
+  check();
+}
+
 void Filter::onComplete(Filters::Common::ExtAuthz::ResponsePtr&& response) {
   ASSERT(cluster_);
   state_ = State::Complete;
+  if (cache_checker_) {
+    cache_checker_ = false;
+    config_->decisionCache()->completeCheck(cache_key_, *response);
+  }
 
   using Filters::Common::ExtAuthz::CheckStatus;
 
@@ -5,11 +5,13 @@
 #include <string>
 #include <vector>
 
+#include "envoy/common/time.h"
 #include "envoy/config/filter/http/ext_authz/v2alpha/ext_authz.pb.h"
 #include "envoy/http/filter.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
+#include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/common/assert.h"
@@ -18,6 +20,7 @@
 
 #include "extensions/filters/common/ext_authz/ext_authz.h"
 #include "extensions/filters/common/ext_authz/ext_authz_grpc_impl.h"
+#include "extensions/filters/http/ext_authz/decision_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -36,13 +39,20 @@ class FilterConfig {
 public:
   FilterConfig(const envoy::config::filter::http::ext_authz::v2alpha::ExtAuthz& config,
                const LocalInfo::LocalInfo& local_info, Stats::Scope& scope,
-               Runtime::Loader& runtime, Upstream::ClusterManager& cm)
+               Runtime::Loader& runtime, Upstream::ClusterManager& cm,
+               ThreadLocal::SlotAllocator& tls, TimeSource& time_source,
+               const std::string& stats_prefix)
       : local_info_(local_info), scope_(scope), runtime_(runtime), cm_(cm),
         cluster_name_(config.grpc_service().envoy_grpc().cluster_name()),
         allowed_authorization_headers_(
             toAuthorizationHeaders(config.http_service().allowed_authorization_headers())),
         allowed_request_headers_(toRequestHeaders(config.http_service().allowed_request_headers())),
-        failure_mode_allow_(config.failure_mode_allow()) {}
+        failure_mode_allow_(config.failure_mode_allow()),
+        decision_cache_(config.has_decision_cache()
+                            ? std::make_unique<DecisionCache>(
+                                  config.decision_cache(), tls, time_source, scope,
+                                  stats_prefix + "ext_authz.decision_cache.")
+                            : nullptr) {}
 
   const LocalInfo::LocalInfo& localInfo() const { return local_info_; }
   Runtime::Loader& runtime() { return runtime_; }
@@ -56,6 +66,8 @@ public:
 
   bool failureModeAllow() const { return failure_mode_allow_; }
 
+  DecisionCache* decisionCache() const { return decision_cache_.get(); }
+
 private:
   static Http::LowerCaseStrUnorderedSet toRequestHeaders(
       const Protobuf::RepeatedPtrField<Envoy::ProtobufTypes::String>& request_headers) {
@@ -88,6 +100,7 @@ private:
   Http::LowerCaseStrUnorderedSet allowed_authorization_headers_;
   Http::LowerCaseStrUnorderedSet allowed_request_headers_;
   bool failure_mode_allow_;
+  DecisionCachePtr decision_cache_;
 };
 
 typedef std::shared_ptr<FilterConfig> FilterConfigSharedPtr;
@@ -98,7 +111,8 @@ typedef std::shared_ptr<FilterConfig> FilterConfigSharedPtr;
  */
 class Filter : public Logger::Loggable<Logger::Id::filter>,
                public Http::StreamDecoderFilter,
-               public Filters::Common::ExtAuthz::RequestCallbacks {
+               public Filters::Common::ExtAuthz::RequestCallbacks,
+               public DecisionCacheWaiter {
 public:
   Filter(FilterConfigSharedPtr config, Filters::Common::ExtAuthz::ClientPtr&& client)
       : config_(config), client_(std::move(client)) {}
@@ -115,6 +129,10 @@ public:
   // ExtAuthz::RequestCallbacks
   void onComplete(Filters::Common::ExtAuthz::ResponsePtr&&) override;
 
+  // ExtAuthz::DecisionCacheWaiter
+  void onDecision(const Filters::Common::ExtAuthz::Response& response) override;
+  void onCheckCancelled() override;
+
 private:
   void addResponseHeaders(Http::HeaderMap& header_map, const Http::HeaderVector& headers);
   // State of this filter's communication with the external authorization service.
@@ -126,6 +144,7 @@ private:
   // the filter chain should stop. Otherwise the filter chain can continue to the next filter.
   enum class FilterReturn { ContinueDecoding, StopDecoding };
   void initiateCall(const Http::HeaderMap& headers);
+  void check();
   Http::HeaderMapPtr getHeaderMap(const Filters::Common::ExtAuthz::ResponsePtr& reponse);
   FilterConfigSharedPtr config_;
   Filters::Common::ExtAuthz::ClientPtr client_;
@@ -137,6 +156,11 @@ private:
   // Used to identify if the callback to onComplete() is synchronous (on the stack) or asynchronous.
   bool initiating_call_{};
   envoy::service::auth::v2alpha::CheckRequest check_request_{};
+  // The key of the request in the decision cache, if there is one.
+  std::string cache_key_;
+  // Whether this request calls the service for its key, or waits for another request that does.
+  bool cache_checker_{};
+  bool cache_waiter_{};
 };
 
 } // namespace ExtAuthz
@@ -18,6 +18,7 @@
 #include "common/http/headers.h"
 #include "common/http/utility.h"
 #include "common/protobuf/utility.h"
+#include "common/runtime/key_registry.h"
 
 #include "extensions/filters/http/well_known_names.h"
 
@@ -26,10 +27,14 @@ namespace Extensions {
 namespace HttpFilters {
 namespace Fault {
 
-const std::string FaultFilter::DELAY_PERCENT_KEY = "fault.http.delay.fixed_delay_percent";
-const std::string FaultFilter::ABORT_PERCENT_KEY = "fault.http.abort.abort_percent";
-const std::string FaultFilter::DELAY_DURATION_KEY = "fault.http.delay.fixed_duration_ms";
-const std::string FaultFilter::ABORT_HTTP_STATUS_KEY = "fault.http.abort.http_status";
+const Runtime::Key FaultFilter::DELAY_PERCENT_KEY =
+    Runtime::KeyRegistry::intern("fault.http.delay.fixed_delay_percent");
+const Runtime::Key FaultFilter::ABORT_PERCENT_KEY =
+    Runtime::KeyRegistry::intern("fault.http.abort.abort_percent");
+const Runtime::Key FaultFilter::DELAY_DURATION_KEY =
+    Runtime::KeyRegistry::intern("fault.http.delay.fixed_duration_ms");
+const Runtime::Key FaultFilter::ABORT_HTTP_STATUS_KEY =
+    Runtime::KeyRegistry::intern("fault.http.abort.http_status");
 
 FaultSettings::FaultSettings(const envoy::config::filter::http::fault::v2::HTTPFault& fault) {
 
@@ -115,7 +120,10 @@ Http::FilterHeadersStatus FaultFilter::decodeHeaders(Http::HeaderMap& headers, b
 
   absl::optional<uint64_t> duration_ms = delayDuration();
   if (duration_ms) {
-    delay_timer_ = callbacks_->dispatcher().createTimer([this]() -> void { postDelayInjection(); });
+    // Many requests may be delayed at once, so schedule the delay on the timer wheel rather than
+    // adding a libevent timer per request.
+    delay_timer_ =
+        callbacks_->dispatcher().createCoarseTimer([this]() -> void { postDelayInjection(); });
     delay_timer_->enableTimer(std::chrono::milliseconds(duration_ms.value()));
     recordDelaysInjectedStats();
     callbacks_->requestInfo().setResponseFlag(RequestInfo::ResponseFlag::DelayInjected);
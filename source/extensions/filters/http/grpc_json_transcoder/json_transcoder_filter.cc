@@ -11,6 +11,7 @@
 #include "common/http/headers.h"
 #include "common/http/utility.h"
 #include "common/protobuf/protobuf.h"
+#include "common/protobuf/utility.h"
 
 #include "google/api/annotations.pb.h"
 #include "google/api/http.pb.h"
@@ -132,6 +133,8 @@ JsonTranscoderConfig::JsonTranscoderConfig(
   print_options_.preserve_proto_field_names = print_config.preserve_proto_field_names();
 
   match_incoming_request_route_ = proto_config.match_incoming_request_route();
+  max_request_message_bytes_ =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, max_request_message_bytes, 0);
 }
 
 bool JsonTranscoderConfig::matchIncomingRequestInfo() const {
@@ -242,10 +245,7 @@ Http::FilterHeadersStatus JsonTranscoderFilter::decodeHeaders(Http::HeaderMap& h
     const auto& request_status = transcoder_->RequestStatus();
     if (!request_status.ok()) {
       ENVOY_LOG(debug, "Transcoding request error {}", request_status.ToString());
-      error_ = true;
-      decoder_callbacks_->sendLocalReply(Http::Code::BadRequest, request_status.error_message(),
-                                         nullptr);
-
+      sendRequestError(Http::Code::BadRequest, request_status.error_message());
       return Http::FilterHeadersStatus::StopIteration;
     }
 
@@ -266,22 +266,34 @@ Http::FilterDataStatus JsonTranscoderFilter::decodeData(Buffer::Instance& data,
     return Http::FilterDataStatus::Continue;
   }
 
+  request_message_bytes_ += data.length();
   request_in_.move(data);
 
   if (end_stream) {
     request_in_.finish();
   }
 
+  // The messages which are complete are forwarded right away, and the transcoder only holds the
+  // part of the request after them.
   readToBuffer(*transcoder_->RequestOutput(), data);
+  if (data.length() > 0) {
+    request_message_bytes_ = 0;
+  }
 
   const auto& request_status = transcoder_->RequestStatus();
 
   if (!request_status.ok()) {
     ENVOY_LOG(debug, "Transcoding request error {}", request_status.ToString());
-    error_ = true;
-    decoder_callbacks_->sendLocalReply(Http::Code::BadRequest, request_status.error_message(),
-                                       nullptr);
+    sendRequestError(Http::Code::BadRequest, request_status.error_message());
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
 
+  const uint64_t max_request_message_bytes = config_.maxRequestMessageBytes();
+  if (max_request_message_bytes > 0 && request_message_bytes_ > max_request_message_bytes) {
+    ENVOY_LOG(debug, "Transcoding request error: message exceeds {} bytes",
+              max_request_message_bytes);
+    data.drain(data.length());
+    sendRequestError(Http::Code::PayloadTooLarge, "Request message too large");
     return Http::FilterDataStatus::StopIterationNoBuffer;
   }
   return Http::FilterDataStatus::Continue;
@@ -429,6 +441,11 @@ bool JsonTranscoderFilter::readToBuffer(Protobuf::io::ZeroCopyInputStream& strea
   return false;
 }
 
+void JsonTranscoderFilter::sendRequestError(Http::Code code, const std::string& message) {
+  error_ = true;
+  decoder_callbacks_->sendLocalReply(code, message, nullptr);
+}
+
 void JsonTranscoderFilter::buildResponseFromHttpBodyOutput(Http::HeaderMap& response_headers,
                                                            Buffer::Instance& data) {
   std::vector<Grpc::Frame> frames;
@@ -73,6 +73,12 @@ public:
    */
   bool matchIncomingRequestInfo() const;
 
+  /**
+   * @return uint64_t the largest request message the filter holds while transcoding it, or 0 if
+   *         request messages are not bounded.
+   */
+  uint64_t maxRequestMessageBytes() const { return max_request_message_bytes_; }
+
 private:
   /**
    * Convert method descriptor to RequestInfo that needed for transcoding library
@@ -87,6 +93,7 @@ private:
   Protobuf::util::JsonPrintOptions print_options_;
 
   bool match_incoming_request_route_{false};
+  uint64_t max_request_message_bytes_{0};
 };
 
 typedef std::shared_ptr<JsonTranscoderConfig> JsonTranscoderConfigSharedPtr;
@@ -118,6 +125,7 @@ public:
 
 private:
   bool readToBuffer(Protobuf::io::ZeroCopyInputStream& stream, Buffer::Instance& data);
+  void sendRequestError(Http::Code code, const std::string& message);
   void buildResponseFromHttpBodyOutput(Http::HeaderMap& response_headers, Buffer::Instance& data);
   bool hasHttpBodyAsOutputType();
 
@@ -131,6 +139,9 @@ private:
   Http::HeaderMap* response_headers_{nullptr};
   Grpc::Decoder decoder_;
 
+  // The bytes of the request received since the last transcoded message, which the transcoder
+  // holds until the next message is complete.
+  uint64_t request_message_bytes_{0};
   bool error_{false};
   bool has_http_body_output_{false};
 };
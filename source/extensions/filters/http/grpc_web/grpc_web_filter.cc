@@ -105,10 +105,14 @@ Http::FilterDataStatus GrpcWebFilter::decodeData(Buffer::Instance& data, bool en
 
   const uint64_t needed = available / 4 * 4 - decoding_buffer_.length();
   decoding_buffer_.move(data, needed);
-  const std::string decoded = Base64::decode(
-      std::string(static_cast<const char*>(decoding_buffer_.linearize(decoding_buffer_.length())),
-                  decoding_buffer_.length()));
-  if (decoded.empty()) {
+  // Set aside the incomplete block at the end, so that the decoded data can be written straight
+  // into the emptied data buffer.
+  char leftover[3];
+  const uint64_t leftover_length = data.length();
+  ASSERT(leftover_length < 4);
+  data.copyOut(0, leftover_length, leftover);
+  data.drain(leftover_length);
+  if (!Base64::decode(decoding_buffer_, decoding_buffer_.length(), data)) {
     // Error happened when decoding base64.
     decoder_callbacks_->sendLocalReply(Http::Code::BadRequest,
                                        "Bad gRPC-web request, invalid base64 data.", nullptr);
@@ -116,8 +120,7 @@ Http::FilterDataStatus GrpcWebFilter::decodeData(Buffer::Instance& data, bool en
   }
 
   decoding_buffer_.drain(decoding_buffer_.length());
-  decoding_buffer_.move(data);
-  data.add(decoded);
+  decoding_buffer_.add(leftover, leftover_length);
   // Any block of 4 bytes or more should have been decoded and passed through.
   ASSERT(decoding_buffer_.length() < 4);
   return Http::FilterDataStatus::Continue;
@@ -169,9 +172,9 @@ Http::FilterDataStatus GrpcWebFilter::encodeData(Buffer::Instance& data, bool) {
     const uint32_t length = htonl(frame.length_);
     temp.add(&length, 4);
     if (frame.length_ > 0) {
-      temp.add(*frame.data_);
+      temp.move(*frame.data_);
     }
-    data.add(Base64::encode(temp, temp.length()));
+    Base64::encode(temp, temp.length(), data);
   }
   return Http::FilterDataStatus::Continue;
 }
@@ -206,7 +209,8 @@ Http::FilterTrailersStatus GrpcWebFilter::encodeTrailers(Http::HeaderMap& traile
   buffer.add(&length, 4);
   buffer.move(temp);
   if (is_text_response_) {
-    Buffer::OwnedImpl encoded(Base64::encode(buffer, buffer.length()));
+    Buffer::OwnedImpl encoded;
+    Base64::encode(buffer, buffer.length(), encoded);
     encoder_callbacks_->addEncodedData(encoded, true);
   } else {
     encoder_callbacks_->addEncodedData(buffer, true);
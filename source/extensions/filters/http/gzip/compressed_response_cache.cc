@@ -0,0 +1,71 @@
+#include "extensions/filters/http/gzip/compressed_response_cache.h"
+
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Gzip {
+
+CompressedResponseCache::CompressedResponseCache(
+    const envoy::config::filter::http::gzip::v2::Gzip::CompressedResponseCache& config,
+    ThreadLocal::SlotAllocator& tls, Stats::Scope& scope, const std::string& stats_prefix)
+    : max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, 1000)),
+      max_body_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_body_bytes, 1024 * 1024)),
+      tls_(tls.allocateSlot()),
+      stats_{ALL_COMPRESSED_RESPONSE_CACHE_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix))} {
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalCache>();
+  });
+}
+
+bool CompressedResponseCache::cacheable(const std::string& etag) {
+  // Weak entity tags may be shared by bodies which differ.
+  return etag.size() >= 2 && etag.front() == '"' && etag.back() == '"';
+}
+
+std::string CompressedResponseCache::key(const std::string& authority, const std::string& path,
+                                         const std::string& etag) {
+  // Neither the authority nor the path hold a space.
+  return absl::StrCat(authority, " ", path, " ", etag);
+}
+
+CompressedBodySharedPtr CompressedResponseCache::lookup(const std::string& key) {
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  auto it = cache.entries_.find(key);
+  if (it == cache.entries_.end()) {
+    stats_.miss_.inc();
+    return nullptr;
+  }
+
+  cache.lru_.splice(cache.lru_.begin(), cache.lru_, it->second.lru_entry_);
+  stats_.hit_.inc();
+  return it->second.body_;
+}
+
+void CompressedResponseCache::insert(const std::string& key, std::string&& body) {
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  auto it = cache.entries_.find(key);
+  if (it != cache.entries_.end()) {
+    // Another stream of the worker missed concurrently and completed first.
+    return;
+  }
+
+  if (cache.entries_.size() == max_entries_) {
+    cache.entries_.erase(cache.lru_.back());
+    cache.lru_.pop_back();
+    stats_.eviction_.inc();
+  }
+
+  cache.lru_.push_front(key);
+  cache.entries_.emplace(key,
+                         Entry{std::make_shared<const std::string>(std::move(body)),
+                               cache.lru_.begin()});
+}
+
+} // namespace Gzip
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/config/filter/http/gzip/v2/gzip.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Gzip {
+
+/**
+ * All compressed response cache stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_COMPRESSED_RESPONSE_CACHE_STATS(COUNTER)                                               \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(eviction)                                                                                \
+  COUNTER(too_large)
+// clang-format on
+
+/**
+ * Struct definition for all compressed response cache stats. @see stats_macros.h
+ */
+struct CompressedResponseCacheStats {
+  ALL_COMPRESSED_RESPONSE_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+typedef std::shared_ptr<const std::string> CompressedBodySharedPtr;
+
+/**
+ * A per worker, LRU bounded cache of compressed response bodies. The entries are keyed by the
+ * request authority and path and the strong entity tag of the response, which identifies the
+ * exact bytes of the body, so that an entry never needs to be invalidated.
+ */
+class CompressedResponseCache {
+public:
+  CompressedResponseCache(
+      const envoy::config::filter::http::gzip::v2::Gzip::CompressedResponseCache& config,
+      ThreadLocal::SlotAllocator& tls, Stats::Scope& scope, const std::string& stats_prefix);
+
+  /**
+   * @param etag supplies the value of an ETag header.
+   * @return bool whether the entity tag is strong, and so responses with it can be cached.
+   */
+  static bool cacheable(const std::string& etag);
+
+  /**
+   * @param authority supplies the authority of the request.
+   * @param path supplies the path of the request.
+   * @param etag supplies the strong entity tag of the response.
+   * @return std::string the key of the response.
+   */
+  static std::string key(const std::string& authority, const std::string& path,
+                         const std::string& etag);
+
+  /**
+   * Look up a compressed body.
+   * @param key supplies the key of the response.
+   * @return CompressedBodySharedPtr the body, which stays valid if the entry is evicted, or
+   *         nullptr on a miss.
+   */
+  CompressedBodySharedPtr lookup(const std::string& key);
+
+  /**
+   * Cache the compressed body of a response that missed.
+   * @param key supplies the key of the response.
+   * @param body supplies the complete compressed body.
+   */
+  void insert(const std::string& key, std::string&& body);
+
+  /**
+   * @return uint64_t the largest compressed body that is cached. Larger bodies are not collected.
+   */
+  uint64_t maxBodyBytes() const { return max_body_bytes_; }
+
+  /**
+   * Count a body that was not cached for being larger than maxBodyBytes().
+   */
+  void onTooLarge() { stats_.too_large_.inc(); }
+
+private:
+  struct Entry {
+    CompressedBodySharedPtr body_;
+    std::list<std::string>::iterator lru_entry_;
+  };
+
+  struct ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
+    std::unordered_map<std::string, Entry> entries_;
+    // Keys from the most to the least recently used.
+    std::list<std::string> lru_;
+  };
+
+  const uint64_t max_entries_;
+  const uint64_t max_body_bytes_;
+  ThreadLocal::SlotPtr tls_;
+  CompressedResponseCacheStats stats_;
+};
+
+typedef std::unique_ptr<CompressedResponseCache> CompressedResponseCachePtr;
+
+} // namespace Gzip
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
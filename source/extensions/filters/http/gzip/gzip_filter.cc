@@ -41,16 +41,23 @@ const std::vector<std::string>& defaultContentEncoding() {
 
 GzipFilterConfig::GzipFilterConfig(const envoy::config::filter::http::gzip::v2::Gzip& gzip,
                                    const std::string& stats_prefix, Stats::Scope& scope,
-                                   Runtime::Loader& runtime)
+                                   Runtime::Loader& runtime, ThreadLocal::SlotAllocator& tls)
     : compression_level_(compressionLevelEnum(gzip.compression_level())),
       compression_strategy_(compressionStrategyEnum(gzip.compression_strategy())),
       content_length_(contentLengthUint(gzip.content_length().value())),
       memory_level_(memoryLevelUint(gzip.memory_level().value())),
       window_bits_(windowBitsUint(gzip.window_bits().value())),
+      compressor_factory_(compression_level_, compression_strategy_, window_bits_, memory_level_),
       content_type_values_(contentTypeSet(gzip.content_type())),
       disable_on_etag_header_(gzip.disable_on_etag_header()),
       remove_accept_encoding_header_(gzip.remove_accept_encoding_header()),
-      stats_(generateStats(stats_prefix + "gzip.", scope)), runtime_(runtime) {}
+      stats_(generateStats(stats_prefix + "gzip.", scope)), runtime_(runtime) {
+  // Responses with an etag are not compressed when disable_on_etag_header is set.
+  if (gzip.has_compressed_response_cache() && !disable_on_etag_header_) {
+    cache_ = std::make_unique<CompressedResponseCache>(gzip.compressed_response_cache(), tls, scope,
+                                                       stats_prefix + "gzip.cache.");
+  }
+}
 
 Compressor::ZlibCompressorImpl::CompressionLevel GzipFilterConfig::compressionLevelEnum(
     envoy::config::filter::http::gzip::v2::Gzip_CompressionLevel_Enum compression_level) {
@@ -103,7 +110,7 @@ uint64_t GzipFilterConfig::windowBitsUint(Protobuf::uint32 window_bits) {
 }
 
 GzipFilter::GzipFilter(const GzipFilterConfigSharedPtr& config)
-    : skip_compression_{true}, compressed_data_(), compressor_(), config_(config) {}
+    : skip_compression_{true}, config_(config) {}
 
 Http::FilterHeadersStatus GzipFilter::decodeHeaders(Http::HeaderMap& headers, bool) {
   if (config_->runtime().snapshot().featureEnabled("gzip.filter_enabled", 100) &&
@@ -112,6 +119,10 @@ Http::FilterHeadersStatus GzipFilter::decodeHeaders(Http::HeaderMap& headers, bo
     if (config_->removeAcceptEncodingHeader()) {
       headers.removeAcceptEncoding();
     }
+    if (config_->cache() != nullptr && headers.Host() && headers.Path()) {
+      authority_ = headers.Host()->value().c_str();
+      path_ = headers.Path()->value().c_str();
+    }
   } else {
     config_->stats().not_compressed_.inc();
   }
@@ -123,12 +134,14 @@ Http::FilterHeadersStatus GzipFilter::encodeHeaders(Http::HeaderMap& headers, bo
   if (!end_stream && !skip_compression_ && isMinimumContentLength(headers) &&
       isContentTypeAllowed(headers) && !hasCacheControlNoTransform(headers) &&
       isEtagAllowed(headers) && isTransferEncodingAllowed(headers) && !headers.ContentEncoding()) {
+    lookupCachedBody(headers);
     sanitizeEtagHeader(headers);
     insertVaryHeader(headers);
     headers.removeContentLength();
-    headers.insertContentEncoding().value(Http::Headers::get().ContentEncodingValues.Gzip);
-    compressor_.init(config_->compressionLevel(), config_->compressionStrategy(),
-                     config_->windowBits(), config_->memoryLevel());
+    headers.insertContentEncoding().value(config_->compressorFactory().contentEncoding());
+    if (cached_body_ == nullptr) {
+      compressor_ = config_->compressorFactory().createCompressor();
+    }
     config_->stats().compressed_.inc();
   } else if (!skip_compression_) {
     skip_compression_ = true;
@@ -140,12 +153,78 @@ Http::FilterHeadersStatus GzipFilter::encodeHeaders(Http::HeaderMap& headers, bo
 Http::FilterDataStatus GzipFilter::encodeData(Buffer::Instance& data, bool end_stream) {
   if (!skip_compression_) {
     config_->stats().total_uncompressed_bytes_.add(data.length());
-    compressor_.compress(data, end_stream ? Compressor::State::Finish : Compressor::State::Flush);
+    if (cached_body_ != nullptr) {
+      // The body is assumed to be the one the strong etag was cached with.
+      data.drain(data.length());
+      if (end_stream) {
+        addCachedBody(data);
+      }
+    } else {
+      compressor_->compress(data,
+                            end_stream ? Compressor::State::Finish : Compressor::State::Flush);
+      if (caching_) {
+        collectCachedBody(data, end_stream);
+      }
+    }
     config_->stats().total_compressed_bytes_.add(data.length());
   }
   return Http::FilterDataStatus::Continue;
 }
 
+Http::FilterTrailersStatus GzipFilter::encodeTrailers(Http::HeaderMap&) {
+  if (!skip_compression_ && cached_body_ != nullptr) {
+    Buffer::OwnedImpl data;
+    addCachedBody(data);
+    config_->stats().total_compressed_bytes_.add(data.length());
+    encoder_callbacks_->addEncodedData(data, false);
+  }
+  return Http::FilterTrailersStatus::Continue;
+}
+
+void GzipFilter::lookupCachedBody(Http::HeaderMap& headers) {
+  // Partial responses share the etag of the whole body.
+  if (config_->cache() == nullptr || authority_.empty() || !headers.Etag() || !headers.Status() ||
+      headers.Status()->value() != "200" ||
+      !CompressedResponseCache::cacheable(headers.Etag()->value().c_str())) {
+    return;
+  }
+
+  cache_key_ = CompressedResponseCache::key(authority_, path_, headers.Etag()->value().c_str());
+  cached_body_ = config_->cache()->lookup(cache_key_);
+  caching_ = cached_body_ == nullptr;
+}
+
+void GzipFilter::addCachedBody(Buffer::Instance& data) {
+  // The fragment holds a reference to the body, which may be evicted meanwhile.
+  CompressedBodySharedPtr body = cached_body_;
+  data.addBufferFragment(*new Buffer::BufferFragmentImpl(
+      body->data(), body->size(),
+      [body](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+        delete fragment;
+      }));
+}
+
+void GzipFilter::collectCachedBody(const Buffer::Instance& data, bool end_stream) {
+  if (cache_body_.size() + data.length() > config_->cache()->maxBodyBytes()) {
+    config_->cache()->onTooLarge();
+    caching_ = false;
+    cache_body_ = std::string();
+    return;
+  }
+
+  const uint64_t num_slices = data.getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  data.getRawSlices(slices, num_slices);
+  for (const Buffer::RawSlice& slice : slices) {
+    cache_body_.append(static_cast<const char*>(slice.mem_), slice.len_);
+  }
+
+  if (end_stream) {
+    config_->cache()->insert(cache_key_, std::move(cache_body_));
+    caching_ = false;
+  }
+}
+
 bool GzipFilter::hasCacheControlNoTransform(Http::HeaderMap& headers) const {
   const Http::HeaderEntry* cache_control = headers.CacheControl();
   if (cache_control) {
@@ -7,6 +7,7 @@
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
 
 #include "common/buffer/buffer_impl.h"
 #include "common/compressor/zlib_compressor_impl.h"
@@ -15,6 +16,8 @@
 #include "common/json/json_validator.h"
 #include "common/protobuf/protobuf.h"
 
+#include "extensions/filters/http/gzip/compressed_response_cache.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
@@ -59,8 +62,8 @@ class GzipFilterConfig {
 
 public:
   GzipFilterConfig(const envoy::config::filter::http::gzip::v2::Gzip& gzip,
-                   const std::string& stats_prefix,
-                   Stats::Scope& scope, Runtime::Loader& runtime);
+                   const std::string& stats_prefix, Stats::Scope& scope,
+                   Runtime::Loader& runtime, ThreadLocal::SlotAllocator& tls);
 
   Compressor::ZlibCompressorImpl::CompressionLevel compressionLevel() const {
     return compression_level_;
@@ -69,6 +72,8 @@ public:
     return compression_strategy_;
   }
 
+  const Compressor::CompressorFactory& compressorFactory() const { return compressor_factory_; }
+  CompressedResponseCache* cache() const { return cache_.get(); }
   Runtime::Loader& runtime() { return runtime_; }
   GzipStats& stats() { return stats_; }
   const StringUtil::CaseUnorderedSet& contentTypeValues() const { return content_type_values_; }
@@ -100,12 +105,14 @@ private:
   int32_t content_length_;
   int32_t memory_level_;
   int32_t window_bits_;
+  const Compressor::ZlibCompressorFactory compressor_factory_;
 
   StringUtil::CaseUnorderedSet content_type_values_;
   bool disable_on_etag_header_;
   bool remove_accept_encoding_header_;
   GzipStats stats_;
   Runtime::Loader& runtime_;
+  CompressedResponseCachePtr cache_;
 };
 typedef std::shared_ptr<GzipFilterConfig> GzipFilterConfigSharedPtr;
 
@@ -137,9 +144,7 @@ public:
   }
   Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
   Http::FilterDataStatus encodeData(Buffer::Instance& buffer, bool end_stream) override;
-  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap&) override {
-    return Http::FilterTrailersStatus::Continue;
-  }
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap&) override;
   void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks& callbacks) override {
     encoder_callbacks_ = &callbacks;
   }
@@ -158,12 +163,25 @@ private:
 
   void sanitizeEtagHeader(Http::HeaderMap& headers);
   void insertVaryHeader(Http::HeaderMap& headers);
+  void lookupCachedBody(Http::HeaderMap& headers);
+  void addCachedBody(Buffer::Instance& data);
+  void collectCachedBody(const Buffer::Instance& data, bool end_stream);
 
   bool skip_compression_;
-  Buffer::OwnedImpl compressed_data_;
-  Compressor::ZlibCompressorImpl compressor_;
+  // Only created for the responses that are compressed.
+  Compressor::CompressorPtr compressor_;
   GzipFilterConfigSharedPtr config_;
 
+  // The following are only used with a compressed response cache.
+  std::string authority_;
+  std::string path_;
+  std::string cache_key_;
+  // The cached body replacing the body of the response on a hit.
+  CompressedBodySharedPtr cached_body_;
+  // The compressed body being collected on a miss.
+  std::string cache_body_;
+  bool caching_{};
+
   Http::StreamDecoderFilterCallbacks* decoder_callbacks_{nullptr};
   Http::StreamEncoderFilterCallbacks* encoder_callbacks_{nullptr};
 };
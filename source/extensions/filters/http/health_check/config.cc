@@ -38,20 +38,20 @@ Http::FilterFactoryCb HealthCheckFilterConfig::createFilterFactoryFromProtoTyped
                                                     std::chrono::milliseconds(cache_time_ms)));
   }
 
-  ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages;
+  ClusterHealthTrackerConstSharedPtr cluster_health_tracker;
   if (!pass_through_mode && !proto_config.cluster_min_healthy_percentages().empty()) {
-    auto cluster_to_percentage = std::make_unique<ClusterMinHealthyPercentages>();
+    auto cluster_to_percentage = std::make_shared<ClusterMinHealthyPercentages>();
     for (const auto& item : proto_config.cluster_min_healthy_percentages()) {
       cluster_to_percentage->emplace(std::make_pair(item.first, item.second.value()));
     }
-    cluster_min_healthy_percentages = std::move(cluster_to_percentage);
+    cluster_health_tracker = std::make_shared<ClusterHealthTracker>(
+        context.clusterManager(), context.threadLocal(), std::move(cluster_to_percentage));
   }
 
   return [&context, pass_through_mode, cache_manager, header_match_data,
-          cluster_min_healthy_percentages](Http::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addStreamFilter(std::make_shared<HealthCheckFilter>(context, pass_through_mode,
-                                                                  cache_manager, header_match_data,
-                                                                  cluster_min_healthy_percentages));
+          cluster_health_tracker](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addStreamFilter(std::make_shared<HealthCheckFilter>(
+        context, pass_through_mode, cache_manager, header_match_data, cluster_health_tracker));
   };
 }
 
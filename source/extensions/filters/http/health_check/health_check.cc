@@ -32,6 +32,93 @@ void HealthCheckCacheManager::onTimer() {
   clear_cache_timer_->enableTimer(timeout_);
 }
 
+ClusterHealthTracker::ClusterHealthTracker(
+    Upstream::ClusterManager& cluster_manager, ThreadLocal::SlotAllocator& tls,
+    ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages)
+    : tls_(tls.allocateSlot()) {
+  tls_->set([&cluster_manager, cluster_min_healthy_percentages](
+                Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalTracker>(cluster_manager, cluster_min_healthy_percentages);
+  });
+}
+
+ClusterHealthTracker::ThreadLocalTracker::ThreadLocalTracker(
+    Upstream::ClusterManager& cluster_manager,
+    ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages)
+    : cluster_min_healthy_percentages_(std::move(cluster_min_healthy_percentages)) {
+  for (const auto& item : *cluster_min_healthy_percentages_) {
+    Upstream::ThreadLocalCluster* cluster = cluster_manager.get(item.first);
+    if (cluster != nullptr) {
+      watch(item.first, *cluster);
+    }
+  }
+  update();
+  cluster_update_callbacks_ = cluster_manager.addThreadLocalClusterUpdateCallbacks(*this);
+}
+
+ClusterHealthTracker::ThreadLocalTracker::~ThreadLocalTracker() {
+  for (const auto& item : clusters_) {
+    item.second.member_update_cb_->remove();
+  }
+}
+
+void ClusterHealthTracker::ThreadLocalTracker::onClusterAddOrUpdate(
+    Upstream::ThreadLocalCluster& cluster) {
+  const std::string& cluster_name = cluster.info()->name();
+  if (cluster_min_healthy_percentages_->count(cluster_name) == 0) {
+    return;
+  }
+
+  // The cluster being replaced has already been destroyed along with its callbacks.
+  clusters_.erase(cluster_name);
+  watch(cluster_name, cluster);
+  update();
+}
+
+void ClusterHealthTracker::ThreadLocalTracker::onClusterRemoval(const std::string& cluster_name) {
+  if (clusters_.erase(cluster_name) > 0) {
+    update();
+  }
+}
+
+void ClusterHealthTracker::ThreadLocalTracker::watch(const std::string& cluster_name,
+                                                     Upstream::ThreadLocalCluster& cluster) {
+  Common::CallbackHandle* member_update_cb = cluster.prioritySet().addMemberUpdateCb(
+      [this](uint32_t, const Upstream::HostVector&, const Upstream::HostVector&) -> void {
+        update();
+      });
+  clusters_[cluster_name] = WatchedCluster{&cluster, member_update_cb};
+}
+
+void ClusterHealthTracker::ThreadLocalTracker::update() {
+  healthy_ = true;
+  for (const auto& item : *cluster_min_healthy_percentages_) {
+    const double min_healthy_percentage = item.second;
+    auto it = clusters_.find(item.first);
+    if (it == clusters_.end()) {
+      // If the cluster does not exist at all, consider the service unhealthy.
+      healthy_ = false;
+      return;
+    }
+
+    uint64_t membership_total = 0;
+    uint64_t membership_healthy = 0;
+    for (const auto& host_set : it->second.cluster_->prioritySet().hostSetsPerPriority()) {
+      membership_total += host_set->hosts().size();
+      membership_healthy += host_set->healthyHosts().size();
+    }
+
+    // If the cluster exists but is empty, consider the service unhealthy unless the specified
+    // minimum percent healthy for the cluster happens to be zero. Otherwise, consider the service
+    // unhealthy if fewer than the specified percentage of the servers in the cluster are healthy.
+    if ((membership_total == 0 && min_healthy_percentage > 0.0) ||
+        membership_healthy < membership_total * min_healthy_percentage / 100.0) {
+      healthy_ = false;
+      return;
+    }
+  }
+}
+
 Http::FilterHeadersStatus HealthCheckFilter::decodeHeaders(Http::HeaderMap& headers,
                                                            bool end_stream) {
   if (Http::HeaderUtility::matchHeaders(headers, *header_match_data_)) {
@@ -102,40 +189,8 @@ void HealthCheckFilter::onComplete() {
   } else {
     if (cache_manager_) {
       final_status = cache_manager_->getCachedResponseCode();
-    } else if (cluster_min_healthy_percentages_ != nullptr &&
-               !cluster_min_healthy_percentages_->empty()) {
-      // Check the status of the specified upstream cluster(s) to determine the right response.
-      auto& clusterManager = context_.clusterManager();
-      for (const auto& item : *cluster_min_healthy_percentages_) {
-        const std::string& cluster_name = item.first;
-        const double min_healthy_percentage = item.second;
-        auto* cluster = clusterManager.get(cluster_name);
-        if (cluster == nullptr) {
-          // If the cluster does not exist at all, consider the service unhealthy.
-          final_status = Http::Code::ServiceUnavailable;
-          break;
-        }
-        const auto& stats = cluster->info()->stats();
-        const uint64_t membership_total = stats.membership_total_.value();
-        if (membership_total == 0) {
-          // If the cluster exists but is empty, consider the service unhealty unless
-          // the specified minimum percent healthy for the cluster happens to be zero.
-          if (min_healthy_percentage == 0.0) {
-            continue;
-          } else {
-            final_status = Http::Code::ServiceUnavailable;
-            break;
-          }
-        }
-        // In the general case, consider the service unhealthy if fewer than the
-        // specified percentage of the servers in the cluster are healthy.
-        // TODO(brian-pane) switch to purely integer-based math here, because the
-        //                  int-to-float conversions and floating point division are slow.
-        if (stats.membership_healthy_.value() < membership_total * min_healthy_percentage / 100.0) {
-          final_status = Http::Code::ServiceUnavailable;
-          break;
-        }
-      }
+    } else if (cluster_health_tracker_ != nullptr && !cluster_health_tracker_->healthy()) {
+      final_status = Http::Code::ServiceUnavailable;
     }
 
     if (!Http::CodeUtility::is2xx(enumToInt(final_status))) {
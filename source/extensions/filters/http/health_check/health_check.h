@@ -4,10 +4,14 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
+#include "envoy/common/callback.h"
 #include "envoy/http/codes.h"
 #include "envoy/http/filter.h"
 #include "envoy/server/filter_config.h"
+#include "envoy/thread_local/thread_local.h"
+#include "envoy/upstream/cluster_manager.h"
 
 #include "common/http/header_utility.h"
 
@@ -51,6 +55,53 @@ typedef std::shared_ptr<const ClusterMinHealthyPercentages>
 
 typedef std::shared_ptr<std::vector<Http::HeaderUtility::HeaderData>> HeaderDataVectorSharedPtr;
 
+/**
+ * Tracks whether the clusters of cluster_min_healthy_percentages have enough healthy hosts. Each
+ * worker recomputes the decision from its own view of the clusters whenever the membership or
+ * health of one of them changes, or one of them is added or removed, so that a health check only
+ * reads the precomputed decision.
+ */
+class ClusterHealthTracker {
+public:
+  ClusterHealthTracker(Upstream::ClusterManager& cluster_manager, ThreadLocal::SlotAllocator& tls,
+                       ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages);
+
+  /**
+   * @return bool whether every cluster exists and has at least its minimum percentage of healthy
+   *         hosts, as seen by the calling thread.
+   */
+  bool healthy() const { return tls_->getTyped<ThreadLocalTracker>().healthy_; }
+
+private:
+  struct ThreadLocalTracker : public ThreadLocal::ThreadLocalObject,
+                              public Upstream::ClusterUpdateCallbacks {
+    ThreadLocalTracker(Upstream::ClusterManager& cluster_manager,
+                       ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages);
+    ~ThreadLocalTracker();
+
+    // Upstream::ClusterUpdateCallbacks
+    void onClusterAddOrUpdate(Upstream::ThreadLocalCluster& cluster) override;
+    void onClusterRemoval(const std::string& cluster_name) override;
+
+    void watch(const std::string& cluster_name, Upstream::ThreadLocalCluster& cluster);
+    void update();
+
+    struct WatchedCluster {
+      Upstream::ThreadLocalCluster* cluster_;
+      Common::CallbackHandle* member_update_cb_;
+    };
+
+    const ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages_;
+    std::unordered_map<std::string, WatchedCluster> clusters_;
+    bool healthy_{};
+    Upstream::ClusterUpdateCallbacksHandlePtr cluster_update_callbacks_;
+  };
+
+  ThreadLocal::SlotPtr tls_;
+};
+
+typedef std::shared_ptr<const ClusterHealthTracker> ClusterHealthTrackerConstSharedPtr;
+
 /**
  * Health check responder filter.
  */
@@ -59,10 +110,10 @@ public:
   HealthCheckFilter(Server::Configuration::FactoryContext& context, bool pass_through_mode,
                     HealthCheckCacheManagerSharedPtr cache_manager,
                     HeaderDataVectorSharedPtr header_match_data,
-                    ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages)
+                    ClusterHealthTrackerConstSharedPtr cluster_health_tracker)
       : context_(context), pass_through_mode_(pass_through_mode), cache_manager_(cache_manager),
         header_match_data_(std::move(header_match_data)),
-        cluster_min_healthy_percentages_(cluster_min_healthy_percentages) {}
+        cluster_health_tracker_(std::move(cluster_health_tracker)) {}
 
   // Http::StreamFilterBase
   void onDestroy() override {}
@@ -98,7 +149,7 @@ private:
   bool pass_through_mode_{};
   HealthCheckCacheManagerSharedPtr cache_manager_;
   const HeaderDataVectorSharedPtr header_match_data_;
-  ClusterMinHealthyPercentagesConstSharedPtr cluster_min_healthy_percentages_;
+  const ClusterHealthTrackerConstSharedPtr cluster_health_tracker_;
 };
 
 } // namespace HealthCheck
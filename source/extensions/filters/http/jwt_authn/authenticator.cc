@@ -38,9 +38,15 @@ public:
   void sanitizePayloadHeaders(Http::HeaderMap& headers) const override;
 
 private:
+  // Accept the token if it is cached as verified. Return true if it did.
+  bool verifyCachedToken();
+
   // Verify with a specific public key.
   void verifyKey();
 
+  // Forward the payload of a verified token and complete.
+  void handleGoodJwt(const std::string& payload_str_base64url);
+
   // Calls the callback with status.
   void doneWithStatus(const Status& status);
 
@@ -98,6 +104,10 @@ void AuthenticatorImpl::verify(Http::HeaderMap& headers, Authenticator::Callback
   // Only process the first token for now.
   token_.swap(tokens[0]);
 
+  if (verifyCachedToken()) {
+    return;
+  }
+
   const Status status = jwt_.parseFromString(token_->token());
   if (status != Status::Ok) {
     doneWithStatus(status);
@@ -161,6 +171,11 @@ void AuthenticatorImpl::verify(Http::HeaderMap& headers, Authenticator::Callback
   // of using the same jwks comes. The request 2 will trigger another remote fetching for the
   // jwks. This can be optimized; the same remote jwks fetching can be shared by two requrests.
   if (jwks_data_->getJwtProvider().has_remote_jwks()) {
+    // Another worker or filter may have fetched the jwks already.
+    if (jwks_data_->loadSharedRemoteJwks()) {
+      verifyKey();
+      return;
+    }
     if (!fetcher_) {
       fetcher_ = createJwksFetcherCb_(config_->cm());
     }
@@ -189,6 +204,38 @@ void AuthenticatorImpl::onDestroy() {
   }
 }
 
+bool AuthenticatorImpl::verifyCachedToken() {
+  TokenCache* token_cache = config_->getCache().getTokenCache();
+  if (token_cache == nullptr) {
+    return false;
+  }
+  const TokenCache::Entry* entry = token_cache->lookup(token_->token());
+  if (entry == nullptr) {
+    return false;
+  }
+  // Tokens found in other locations than their issuer's get rejected by the full verification.
+  if (!token_->isIssuerSpecified(entry->issuer_)) {
+    return false;
+  }
+
+  jwks_data_ = config_->getCache().getJwksCache().findByIssuer(entry->issuer_);
+  ASSERT(jwks_data_ != nullptr);
+  const auto unix_timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+                                  std::chrono::system_clock::now().time_since_epoch())
+                                  .count();
+  // The token is verified again once it expired, or the keys it was verified with are replaced.
+  if ((entry->exp_ > 0 && entry->exp_ < unix_timestamp) || jwks_data_->isExpired() ||
+      jwks_data_->getJwksObj() == nullptr ||
+      entry->jwks_.lock().get() != jwks_data_->getJwksObj()) {
+    token_cache->remove(token_->token());
+    return false;
+  }
+
+  config_->stats().verified_token_cache_hit_.inc();
+  handleGoodJwt(entry->payload_str_base64url_);
+  return true;
+}
+
 // Verify with a specific public key.
 void AuthenticatorImpl::verifyKey() {
   const Status status = ::google::jwt_verify::verifyJwt(jwt_, *jwks_data_->getJwksObj());
@@ -197,11 +244,20 @@ void AuthenticatorImpl::verifyKey() {
     return;
   }
 
+  TokenCache* token_cache = config_->getCache().getTokenCache();
+  if (token_cache != nullptr) {
+    token_cache->insert(token_->token(), {jwt_.iss_, jwt_.exp_, jwt_.payload_str_base64url_,
+                                          jwks_data_->getSharedJwksObj()});
+  }
+  handleGoodJwt(jwt_.payload_str_base64url_);
+}
+
+void AuthenticatorImpl::handleGoodJwt(const std::string& payload_str_base64url) {
   // Forward the payload
   const auto& provider = jwks_data_->getJwtProvider();
   if (!provider.forward_payload_header().empty()) {
     headers_->addCopy(Http::LowerCaseString(provider.forward_payload_header()),
-                      jwt_.payload_str_base64url_);
+                      payload_str_base64url);
   }
 
   if (!provider.forward()) {
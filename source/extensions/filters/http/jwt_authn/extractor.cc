@@ -176,14 +176,14 @@ std::vector<JwtLocationConstPtr> ExtractorImpl::extract(const Http::HeaderMap& h
   }
 
   // Check query parameter locations.
-  const auto& params = Http::Utility::parseQueryString(headers.Path()->value().c_str());
+  const Http::Utility::QueryParamsView params(headers.Path()->value().getStringView());
   for (const auto& location_it : param_locations_) {
     const auto& param_key = location_it.first;
     const auto& location_spec = location_it.second;
-    const auto& it = params.find(param_key);
-    if (it != params.end()) {
+    const absl::optional<absl::string_view> value = params.get(param_key);
+    if (value) {
       tokens.push_back(std::make_unique<const JwtParamLocation>(
-          it->second, location_spec.specified_issuers_, param_key));
+          std::string(value.value()), location_spec.specified_issuers_, param_key));
     }
   }
   return tokens;
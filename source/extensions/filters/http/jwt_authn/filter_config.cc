@@ -0,0 +1,31 @@
+#include "extensions/filters/http/jwt_authn/filter_config.h"
+
+#include "envoy/singleton/manager.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+// Singleton registration via macro defined in envoy/singleton/manager.h
+SINGLETON_MANAGER_REGISTRATION(jwt_authn_shared_jwks_store);
+
+FilterConfig::FilterConfig(
+    const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& proto_config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context)
+    : proto_config_(proto_config), stats_(generateStats(stats_prefix, context.scope())),
+      shared_jwks_store_(context.singletonManager().getTyped<SharedJwksStore>(
+          SINGLETON_MANAGER_REGISTERED_NAME(jwt_authn_shared_jwks_store),
+          [] { return std::make_shared<SharedJwksStore>(); })),
+      tls_(context.threadLocal().allocateSlot()), cm_(context.clusterManager()) {
+  ENVOY_LOG(info, "Loaded JwtAuthConfig: {}", proto_config_.DebugString());
+  tls_->set([this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalCache>(proto_config_, shared_jwks_store_);
+  });
+  extractor_ = Extractor::create(proto_config_);
+}
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
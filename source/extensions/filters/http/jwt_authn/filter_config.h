@@ -9,6 +9,7 @@
 
 #include "extensions/filters/http/jwt_authn/extractor.h"
 #include "extensions/filters/http/jwt_authn/jwks_cache.h"
+#include "extensions/filters/http/jwt_authn/token_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -17,23 +18,31 @@ namespace JwtAuthn {
 
 /**
  * Making cache as a thread local object, its read/write operations don't need to be protected.
- * Now it only has jwks_cache, but in the future, it will have token cache: to cache the tokens
- * with their verification results.
+ * It has the jwks_cache, and the token cache: to cache the tokens with their verification results.
  */
 class ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
 public:
   // Load the config from envoy config.
   ThreadLocalCache(
-      const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config) {
-    jwks_cache_ = JwksCache::create(config);
+      const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config,
+      SharedJwksStoreSharedPtr shared_jwks_store) {
+    jwks_cache_ = JwksCache::create(config, std::move(shared_jwks_store));
+    if (config.verified_token_cache_size() > 0) {
+      token_cache_ = std::make_unique<TokenCache>(config.verified_token_cache_size());
+    }
   }
 
   // Get the JwksCache object.
   JwksCache& getJwksCache() { return *jwks_cache_; }
 
+  // Get the TokenCache object, nullptr if verified tokens are not cached.
+  TokenCache* getTokenCache() { return token_cache_.get(); }
+
 private:
   // The JwksCache object.
   JwksCachePtr jwks_cache_;
+  // The TokenCache object.
+  TokenCachePtr token_cache_;
 };
 
 /**
@@ -43,7 +52,8 @@ private:
 // clang-format off
 #define ALL_JWT_AUTHN_FILTER_STATS(COUNTER)                                                        \
   COUNTER(allowed)                                                                                 \
-  COUNTER(denied)
+  COUNTER(denied)                                                                                  \
+  COUNTER(verified_token_cache_hit)
 // clang-format on
 
 /**
@@ -60,15 +70,7 @@ class FilterConfig : public Logger::Loggable<Logger::Id::config> {
 public:
   FilterConfig(
       const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& proto_config,
-      const std::string& stats_prefix, Server::Configuration::FactoryContext& context)
-      : proto_config_(proto_config), stats_(generateStats(stats_prefix, context.scope())),
-        tls_(context.threadLocal().allocateSlot()), cm_(context.clusterManager()) {
-    ENVOY_LOG(info, "Loaded JwtAuthConfig: {}", proto_config_.DebugString());
-    tls_->set([this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-      return std::make_shared<ThreadLocalCache>(proto_config_);
-    });
-    extractor_ = Extractor::create(proto_config_);
-  }
+      const std::string& stats_prefix, Server::Configuration::FactoryContext& context);
 
   JwtAuthnFilterStats& stats() { return stats_; }
 
@@ -96,6 +98,8 @@ private:
   ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication proto_config_;
   // The stats for the filter.
   JwtAuthnFilterStats stats_;
+  // The remote jwks shared by all workers and filters.
+  SharedJwksStoreSharedPtr shared_jwks_store_;
   // Thread local slot to store per-thread auth store
   ThreadLocal::SlotPtr tls_;
   // the cluster manager object.
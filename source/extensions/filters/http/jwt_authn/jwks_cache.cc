@@ -1,7 +1,9 @@
 #include "extensions/filters/http/jwt_authn/jwks_cache.h"
 
 #include <chrono>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 
 #include "common/common/logger.h"
 #include "common/config/datasource.h"
@@ -25,7 +27,8 @@ constexpr int PubkeyCacheExpirationSec = 600;
 
 class JwksDataImpl : public JwksCache::JwksData, public Logger::Loggable<Logger::Id::filter> {
 public:
-  JwksDataImpl(const JwtProvider& jwt_provider) : jwt_provider_(jwt_provider) {
+  JwksDataImpl(const JwtProvider& jwt_provider, SharedJwksStoreSharedPtr shared_jwks_store)
+      : jwt_provider_(jwt_provider), shared_jwks_store_(std::move(shared_jwks_store)) {
     std::vector<std::string> audiences;
     for (const auto& aud : jwt_provider_.audiences()) {
       audiences.push_back(aud);
@@ -40,7 +43,7 @@ public:
       if (ptr->getStatus() != Status::Ok) {
         ENVOY_LOG(warn, "Invalid inline jwks for issuer: {}, jwks: {}", jwt_provider_.issuer(),
                   inline_jwks);
-        jwks_obj_.reset(nullptr);
+        jwks_obj_.reset();
       }
     }
   }
@@ -53,10 +56,31 @@ public:
 
   const Jwks* getJwksObj() const override { return jwks_obj_.get(); }
 
+  std::shared_ptr<const Jwks> getSharedJwksObj() const override { return jwks_obj_; }
+
   bool isExpired() const override { return std::chrono::steady_clock::now() >= expiration_time_; }
 
   const ::google::jwt_verify::Jwks* setRemoteJwks(::google::jwt_verify::JwksPtr&& jwks) override {
-    return setKey(std::move(jwks), getRemoteJwksExpirationTime());
+    const Jwks* jwks_obj = setKey(std::move(jwks), getRemoteJwksExpirationTime());
+    if (shared_jwks_store_ != nullptr && jwks_obj->getStatus() == Status::Ok) {
+      shared_jwks_store_->set(jwt_provider_.remote_jwks().http_uri().uri(),
+                              {jwks_obj_, expiration_time_});
+    }
+    return jwks_obj;
+  }
+
+  bool loadSharedRemoteJwks() override {
+    if (shared_jwks_store_ == nullptr || !jwt_provider_.has_remote_jwks()) {
+      return false;
+    }
+    SharedJwksStore::Entry entry =
+        shared_jwks_store_->find(jwt_provider_.remote_jwks().http_uri().uri());
+    if (entry.jwks_ == nullptr || std::chrono::steady_clock::now() >= entry.expiration_time_) {
+      return false;
+    }
+    jwks_obj_ = std::move(entry.jwks_);
+    expiration_time_ = entry.expiration_time_;
+    return true;
   }
 
 private:
@@ -81,10 +105,12 @@ private:
 
   // The jwt provider config.
   const JwtProvider& jwt_provider_;
+  // The store to share remote jwks through, may be nullptr.
+  const SharedJwksStoreSharedPtr shared_jwks_store_;
   // Check audience object
   ::google::jwt_verify::CheckAudiencePtr audiences_;
-  // The generated jwks object.
-  ::google::jwt_verify::JwksPtr jwks_obj_;
+  // The generated jwks object, shared with other workers and filters if remote.
+  std::shared_ptr<const Jwks> jwks_obj_;
   // The pubkey expiration time.
   std::chrono::steady_clock::time_point expiration_time_;
 };
@@ -92,10 +118,11 @@ private:
 class JwksCacheImpl : public JwksCache {
 public:
   // Load the config from envoy config.
-  JwksCacheImpl(const JwtAuthentication& config) {
+  JwksCacheImpl(const JwtAuthentication& config, SharedJwksStoreSharedPtr shared_jwks_store) {
     for (const auto& it : config.providers()) {
       const auto& provider = it.second;
-      jwks_data_map_.emplace(provider.issuer(), provider);
+      jwks_data_map_.emplace(std::piecewise_construct, std::forward_as_tuple(provider.issuer()),
+                             std::forward_as_tuple(provider, shared_jwks_store));
     }
   }
 
@@ -114,9 +141,21 @@ private:
 
 } // namespace
 
+SharedJwksStore::Entry SharedJwksStore::find(const std::string& uri) {
+  absl::MutexLock lock(&mutex_);
+  auto it = entries_.find(uri);
+  return it == entries_.end() ? Entry{} : it->second;
+}
+
+void SharedJwksStore::set(const std::string& uri, const Entry& entry) {
+  absl::MutexLock lock(&mutex_);
+  entries_[uri] = entry;
+}
+
 JwksCachePtr JwksCache::create(
-    const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config) {
-  return JwksCachePtr(new JwksCacheImpl(config));
+    const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config,
+    SharedJwksStoreSharedPtr shared_jwks_store) {
+  return JwksCachePtr(new JwksCacheImpl(config, std::move(shared_jwks_store)));
 }
 
 } // namespace JwtAuthn
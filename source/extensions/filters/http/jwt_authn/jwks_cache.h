@@ -1,8 +1,17 @@
 #pragma once
 
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
 #include "envoy/common/pure.h"
 #include "envoy/config/filter/http/jwt_authn/v2alpha/config.pb.h"
+#include "envoy/singleton/instance.h"
+
+#include "common/common/thread_annotations.h"
 
+#include "absl/synchronization/mutex.h"
 #include "jwt_verify_lib/jwks.h"
 
 namespace Envoy {
@@ -13,6 +22,30 @@ namespace JwtAuthn {
 class JwksCache;
 typedef std::unique_ptr<JwksCache> JwksCachePtr;
 
+/**
+ * Remote Jwks shared by the JwksCaches of all workers and filters, so that the Jwks of an URI is
+ * fetched and parsed once per cache duration, instead of once per worker and filter.
+ */
+class SharedJwksStore : public Singleton::Instance {
+public:
+  struct Entry {
+    std::shared_ptr<const ::google::jwt_verify::Jwks> jwks_;
+    std::chrono::steady_clock::time_point expiration_time_;
+  };
+
+  // Get the Jwks last fetched from an URI. Its jwks_ is nullptr if none was.
+  Entry find(const std::string& uri);
+
+  // Store the Jwks fetched from an URI.
+  void set(const std::string& uri, const Entry& entry);
+
+private:
+  absl::Mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_ GUARDED_BY(mutex_);
+};
+
+typedef std::shared_ptr<SharedJwksStore> SharedJwksStoreSharedPtr;
+
 /**
  * Interface to access all configured Jwt rules and their cached Jwks objects.
  * It only caches Jwks specified in the config.
@@ -50,20 +83,28 @@ public:
     // Get the Jwks object.
     virtual const ::google::jwt_verify::Jwks* getJwksObj() const PURE;
 
+    // Get the Jwks object, as shared with the tokens verified with it.
+    virtual std::shared_ptr<const ::google::jwt_verify::Jwks> getSharedJwksObj() const PURE;
+
     // Return true if jwks object is expired.
     virtual bool isExpired() const PURE;
 
     // Set a remote Jwks.
     virtual const ::google::jwt_verify::Jwks*
     setRemoteJwks(::google::jwt_verify::JwksPtr&& jwks) PURE;
+
+    // Use the valid remote Jwks another worker or filter fetched, if any. Return true if it did.
+    virtual bool loadSharedRemoteJwks() PURE;
   };
 
   // Lookup issuer cache map. The cache only stores Jwks specified in the config.
   virtual JwksData* findByIssuer(const std::string& name) PURE;
 
-  // Factory function to create an instance.
+  // Factory function to create an instance. Remote Jwks are shared through shared_jwks_store, if
+  // not nullptr.
   static JwksCachePtr
-  create(const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config);
+  create(const ::envoy::config::filter::http::jwt_authn::v2alpha::JwtAuthentication& config,
+         SharedJwksStoreSharedPtr shared_jwks_store = nullptr);
 };
 
 } // namespace JwtAuthn
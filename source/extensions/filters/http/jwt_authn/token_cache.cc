@@ -0,0 +1,46 @@
+#include "extensions/filters/http/jwt_authn/token_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+TokenCache::TokenCache(uint32_t capacity) : capacity_(capacity) {}
+
+const TokenCache::Entry* TokenCache::lookup(const std::string& token) {
+  auto it = entries_.find(token);
+  if (it == entries_.end()) {
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return &it->second->second;
+}
+
+void TokenCache::insert(const std::string& token, Entry&& entry) {
+  auto it = entries_.find(token);
+  if (it != entries_.end()) {
+    it->second->second = std::move(entry);
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return;
+  }
+
+  if (lru_.size() >= capacity_) {
+    entries_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+  lru_.emplace_front(token, std::move(entry));
+  entries_.emplace(token, lru_.begin());
+}
+
+void TokenCache::remove(const std::string& token) {
+  auto it = entries_.find(token);
+  if (it != entries_.end()) {
+    lru_.erase(it->second);
+    entries_.erase(it);
+  }
+}
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "jwt_verify_lib/jwks.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+
+/**
+ * Cache of the tokens a filter has verified on a worker, so that a token sent on many requests
+ * is only parsed and has its signature verified once. Once full, the least recently used tokens
+ * are evicted.
+ */
+class TokenCache {
+public:
+  // What a verified token is checked against on later requests.
+  struct Entry {
+    // The "iss" claim.
+    std::string issuer_;
+    // The "exp" claim, 0 if the token does not expire.
+    int64_t exp_;
+    // The payload, to forward in a header.
+    std::string payload_str_base64url_;
+    // The Jwks the signature was verified with. The token is verified again once it is replaced.
+    std::weak_ptr<const ::google::jwt_verify::Jwks> jwks_;
+  };
+
+  // The capacity is the maximum number of tokens to store.
+  explicit TokenCache(uint32_t capacity);
+
+  // Lookup a token. The pointer is valid until the cache is modified.
+  const Entry* lookup(const std::string& token);
+
+  // Store a verified token, replacing any entry stored for it.
+  void insert(const std::string& token, Entry&& entry);
+
+  // Remove a token, if stored.
+  void remove(const std::string& token);
+
+private:
+  // Most recently used first. Tokens are compared whole, as a hash collision must not let a
+  // forged token pass for a verified one.
+  typedef std::list<std::pair<std::string, Entry>> LruList;
+
+  const uint32_t capacity_;
+  LruList lru_;
+  std::unordered_map<std::string, LruList::iterator> entries_;
+};
+
+typedef std::unique_ptr<TokenCache> TokenCachePtr;
+
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
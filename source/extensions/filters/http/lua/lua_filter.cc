@@ -458,6 +458,11 @@ void Filter::onDestroy() {
   if (response_stream_wrapper_.get()) {
     response_stream_wrapper_.get()->onReset();
   }
+
+  // Coroutines that finished are reused by later streams on this worker, which spares creating
+  // and collecting a Lua thread per script invocation.
+  config_->releaseCoroutine(std::move(request_coroutine_));
+  config_->releaseCoroutine(std::move(response_coroutine_));
 }
 
 Http::FilterHeadersStatus Filter::doHeaders(StreamHandleRef& handle,
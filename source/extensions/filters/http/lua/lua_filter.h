@@ -260,6 +260,9 @@ public:
   FilterConfig(const std::string& lua_code, ThreadLocal::SlotAllocator& tls,
                Upstream::ClusterManager& cluster_manager);
   Filters::Common::Lua::CoroutinePtr createCoroutine() { return lua_state_.createCoroutine(); }
+  void releaseCoroutine(Filters::Common::Lua::CoroutinePtr&& coroutine) {
+    lua_state_.releaseCoroutine(std::move(coroutine));
+  }
   int requestFunctionRef() { return lua_state_.getGlobalRef(request_function_slot_); }
   int responseFunctionRef() { return lua_state_.getGlobalRef(response_function_slot_); }
   uint64_t runtimeBytesUsed() { return lua_state_.runtimeBytesUsed(); }
@@ -0,0 +1,131 @@
+#include "extensions/filters/http/ratelimit/local_quota.h"
+
+#include "common/common/token_bucket_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RateLimitFilter {
+
+LocalQuota::LocalQuota(const envoy::config::filter::http::rate_limit::v2::LocalQuota& config,
+                       ThreadLocal::SlotAllocator& tls, TimeSource& time_source,
+                       Stats::Scope& scope, const std::string& stats_prefix)
+    : lease_hits_(config.lease_hits()),
+      lease_duration_(PROTOBUF_GET_MS_OR_DEFAULT(config, lease_duration, 1000)),
+      max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, 10000)),
+      fallback_max_tokens_(config.fallback_bucket().max_tokens()),
+      fallback_fill_rate_(config.fallback_bucket().fill_rate()), tls_(tls.allocateSlot()),
+      time_source_(time_source),
+      stats_{ALL_LOCAL_QUOTA_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix))} {
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalQuota>();
+  });
+}
+
+std::string LocalQuota::key(const std::vector<RateLimit::Descriptor>& descriptors) {
+  // Descriptor keys and values are header values or configured strings, which never hold a new
+  // line or a tab.
+  std::string key;
+  for (const RateLimit::Descriptor& descriptor : descriptors) {
+    for (const RateLimit::DescriptorEntry& entry : descriptor.entries_) {
+      absl::StrAppend(&key, entry.key_, "\t", entry.value_, "\t");
+    }
+    key.push_back('\n');
+  }
+  return key;
+}
+
+bool LocalQuota::consume(const std::string& key) {
+  Entry* entry = find(key);
+  if (entry == nullptr || entry->hits_ == 0 || entry->expiry_ <= time_source_.monotonicTime()) {
+    stats_.lease_miss_.inc();
+    return false;
+  }
+
+  entry->hits_--;
+  stats_.lease_hit_.inc();
+  return true;
+}
+
+uint32_t LocalQuota::leaseHits(const std::string& key) {
+  Entry* entry = find(key);
+  if (entry != nullptr && entry->over_limit_until_ > time_source_.monotonicTime()) {
+    return 1;
+  }
+  return lease_hits_;
+}
+
+void LocalQuota::onLimit(const std::string& key, uint32_t hits, RateLimit::LimitStatus status) {
+  if (status == RateLimit::LimitStatus::Error) {
+    return;
+  }
+
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (status == RateLimit::LimitStatus::OverLimit) {
+    if (hits > 1) {
+      // The remaining quota may still admit single hits.
+      findOrInsert(key).over_limit_until_ = now + lease_duration_;
+    }
+    return;
+  }
+
+  if (hits > 1) {
+    // Concurrent calls with the same descriptors each lease hits, which add up.
+    Entry& entry = findOrInsert(key);
+    entry.hits_ = (entry.expiry_ > now ? entry.hits_ : 0) + hits - 1;
+    entry.expiry_ = now + lease_duration_;
+  }
+}
+
+bool LocalQuota::consumeFallback(const std::string& key) {
+  Entry& entry = findOrInsert(key);
+  if (entry.fallback_ == nullptr) {
+    entry.fallback_ =
+        std::make_unique<TokenBucketImpl>(fallback_max_tokens_, time_source_, fallback_fill_rate_);
+  }
+
+  if (!entry.fallback_->consume()) {
+    stats_.fallback_over_limit_.inc();
+    return false;
+  }
+  stats_.fallback_ok_.inc();
+  return true;
+}
+
+LocalQuota::Entry* LocalQuota::find(const std::string& key) {
+  ThreadLocalQuota& quota = tls_->getTyped<ThreadLocalQuota>();
+  auto it = quota.entries_.find(key);
+  if (it == quota.entries_.end()) {
+    return nullptr;
+  }
+
+  quota.lru_.splice(quota.lru_.begin(), quota.lru_, it->second.lru_entry_);
+  return &it->second;
+}
+
+LocalQuota::Entry& LocalQuota::findOrInsert(const std::string& key) {
+  Entry* entry = find(key);
+  if (entry != nullptr) {
+    return *entry;
+  }
+
+  ThreadLocalQuota& quota = tls_->getTyped<ThreadLocalQuota>();
+  if (quota.entries_.size() == max_entries_) {
+    quota.entries_.erase(quota.lru_.back());
+    quota.lru_.pop_back();
+    stats_.eviction_.inc();
+  }
+
+  quota.lru_.push_front(key);
+  Entry& new_entry = quota.entries_[key];
+  new_entry.lru_entry_ = quota.lru_.begin();
+  return new_entry;
+}
+
+} // namespace RateLimitFilter
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/common/token_bucket.h"
+#include "envoy/config/filter/http/rate_limit/v2/rate_limit.pb.h"
+#include "envoy/ratelimit/ratelimit.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RateLimitFilter {
+
+/**
+ * All local quota stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_LOCAL_QUOTA_STATS(COUNTER)                                                             \
+  COUNTER(lease_hit)                                                                               \
+  COUNTER(lease_miss)                                                                              \
+  COUNTER(fallback_ok)                                                                             \
+  COUNTER(fallback_over_limit)                                                                     \
+  COUNTER(eviction)
+// clang-format on
+
+/**
+ * Struct definition for all local quota stats. @see stats_macros.h
+ */
+struct LocalQuotaStats {
+  ALL_LOCAL_QUOTA_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * A per worker tier of quota in front of the rate limit service. The hits leased from the service
+ * for a set of descriptors are used by the following requests with the same descriptors, and a
+ * token bucket per set may limit the requests while the service cannot be queried.
+ */
+class LocalQuota {
+public:
+  LocalQuota(const envoy::config::filter::http::rate_limit::v2::LocalQuota& config,
+             ThreadLocal::SlotAllocator& tls, TimeSource& time_source, Stats::Scope& scope,
+             const std::string& stats_prefix);
+
+  /**
+   * @param descriptors supplies the descriptors of a request.
+   * @return std::string the key of the descriptor set.
+   */
+  static std::string key(const std::vector<RateLimit::Descriptor>& descriptors);
+
+  /**
+   * Use a hit of the lease of a descriptor set.
+   * @param key supplies the key of the descriptor set.
+   * @return bool whether the lease had an unused hit, and so the request needs no call.
+   */
+  bool consume(const std::string& key);
+
+  /**
+   * @param key supplies the key of the descriptor set.
+   * @return uint32_t the number of hits the call of a request which missed the lease asks for.
+   */
+  uint32_t leaseHits(const std::string& key);
+
+  /**
+   * Report the status of a call which asked for leaseHits().
+   * @param key supplies the key of the descriptor set.
+   * @param hits supplies the number of hits the call asked for, one of which the calling request
+   *        uses.
+   * @param status supplies the status of the call.
+   */
+  void onLimit(const std::string& key, uint32_t hits, RateLimit::LimitStatus status);
+
+  /**
+   * @return bool whether requests are limited locally when the service cannot be queried.
+   */
+  bool hasFallback() const { return fallback_max_tokens_ > 0; }
+
+  /**
+   * Limit a request by the fallback bucket of its descriptor set.
+   * @param key supplies the key of the descriptor set.
+   * @return bool whether the bucket had a token for the request.
+   */
+  bool consumeFallback(const std::string& key);
+
+private:
+  struct Entry {
+    // The unused hits of the lease and when they expire.
+    uint32_t hits_{};
+    MonotonicTime expiry_;
+    // Until when the calls ask for single hits, after a lease was over limit.
+    MonotonicTime over_limit_until_;
+    TokenBucketPtr fallback_;
+    std::list<std::string>::iterator lru_entry_;
+  };
+
+  struct ThreadLocalQuota : public ThreadLocal::ThreadLocalObject {
+    std::unordered_map<std::string, Entry> entries_;
+    // Keys from the most to the least recently used.
+    std::list<std::string> lru_;
+  };
+
+  Entry* find(const std::string& key);
+  Entry& findOrInsert(const std::string& key);
+
+  const uint32_t lease_hits_;
+  const std::chrono::milliseconds lease_duration_;
+  const uint64_t max_entries_;
+  const uint32_t fallback_max_tokens_;
+  const double fallback_fill_rate_;
+  ThreadLocal::SlotPtr tls_;
+  TimeSource& time_source_;
+  LocalQuotaStats stats_;
+};
+
+typedef std::unique_ptr<LocalQuota> LocalQuotaPtr;
+
+} // namespace RateLimitFilter
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -50,12 +50,24 @@ void Filter::initiateCall(const Http::HeaderMap& headers) {
                                  route_entry, headers);
   }
 
-  if (!descriptors.empty()) {
-    state_ = State::Calling;
-    initiating_call_ = true;
-    client_->limit(*this, config_->domain(), descriptors, callbacks_->activeSpan());
-    initiating_call_ = false;
+  if (descriptors.empty()) {
+    return;
+  }
+
+  LocalQuota* quota = config_->localQuota();
+  if (quota != nullptr) {
+    quota_key_ = LocalQuota::key(descriptors);
+    if (quota->consume(quota_key_)) {
+      // The request uses a hit leased by an earlier call.
+      return;
+    }
+    hits_addend_ = quota->leaseHits(quota_key_);
   }
+
+  state_ = State::Calling;
+  initiating_call_ = true;
+  client_->limit(*this, config_->domain(), descriptors, hits_addend_, callbacks_->activeSpan());
+  initiating_call_ = false;
 }
 
 Http::FilterHeadersStatus Filter::decodeHeaders(Http::HeaderMap& headers, bool) {
@@ -141,6 +153,16 @@ void Filter::complete(RateLimit::LimitStatus status, Http::HeaderMapPtr&& header
     break;
   }
 
+  LocalQuota* quota = config_->localQuota();
+  if (quota != nullptr) {
+    quota->onLimit(quota_key_, hits_addend_, status);
+    if (status == RateLimit::LimitStatus::Error && quota->hasFallback()) {
+      // The local bucket decides in place of the failure mode.
+      status = quota->consumeFallback(quota_key_) ? RateLimit::LimitStatus::OK
+                                                  : RateLimit::LimitStatus::OverLimit;
+    }
+  }
+
   if (status == RateLimit::LimitStatus::OverLimit &&
       config_->runtime().snapshot().featureEnabled("ratelimit.http_filter_enforcing", 100)) {
     state_ = State::Responded;
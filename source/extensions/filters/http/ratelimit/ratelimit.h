@@ -11,11 +11,14 @@
 #include "envoy/ratelimit/ratelimit.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
+#include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/common/assert.h"
 #include "common/http/header_map_impl.h"
 
+#include "extensions/filters/http/ratelimit/local_quota.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
@@ -33,12 +36,19 @@ class FilterConfig {
 public:
   FilterConfig(const envoy::config::filter::http::rate_limit::v2::RateLimit& config,
                const LocalInfo::LocalInfo& local_info, Stats::Scope& scope,
-               Runtime::Loader& runtime, Upstream::ClusterManager& cm)
+               Runtime::Loader& runtime, Upstream::ClusterManager& cm,
+               ThreadLocal::SlotAllocator& tls, TimeSource& time_source,
+               const std::string& stats_prefix)
       : domain_(config.domain()), stage_(static_cast<uint64_t>(config.stage())),
         request_type_(config.request_type().empty() ? stringToType("both")
                                                     : stringToType(config.request_type())),
         local_info_(local_info), scope_(scope), runtime_(runtime), cm_(cm),
-        failure_mode_deny_(config.failure_mode_deny()) {}
+        failure_mode_deny_(config.failure_mode_deny()) {
+    if (config.has_local_quota()) {
+      local_quota_ = std::make_unique<LocalQuota>(config.local_quota(), tls, time_source, scope,
+                                                  stats_prefix + "ratelimit.local_quota.");
+    }
+  }
   const std::string& domain() const { return domain_; }
   const LocalInfo::LocalInfo& localInfo() const { return local_info_; }
   uint64_t stage() const { return stage_; }
@@ -46,6 +56,7 @@ public:
   Stats::Scope& scope() { return scope_; }
   Upstream::ClusterManager& cm() { return cm_; }
   FilterRequestType requestType() const { return request_type_; }
+  LocalQuota* localQuota() { return local_quota_.get(); }
 
   bool failureModeAllow() const { return !failure_mode_deny_; }
 
@@ -69,6 +80,7 @@ private:
   Runtime::Loader& runtime_;
   Upstream::ClusterManager& cm_;
   const bool failure_mode_deny_;
+  LocalQuotaPtr local_quota_;
 };
 
 typedef std::shared_ptr<FilterConfig> FilterConfigSharedPtr;
@@ -118,6 +130,9 @@ private:
   Upstream::ClusterInfoConstSharedPtr cluster_;
   bool initiating_call_{};
   Http::HeaderMapPtr headers_to_add_;
+  // The key of the descriptors and the hits the call asked for, when there is a local quota.
+  std::string quota_key_;
+  uint32_t hits_addend_{1};
 };
 
 } // namespace RateLimitFilter
@@ -48,6 +48,10 @@ public:
   const std::string JwtAuthn = "envoy.filters.http.jwt_authn";
   // Header to metadata filter
   const std::string HeaderToMetadata = "envoy.filters.http.header_to_metadata";
+  // Adaptive concurrency filter
+  const std::string AdaptiveConcurrency = "envoy.filters.http.adaptive_concurrency";
+  // Cache filter
+  const std::string Cache = "envoy.filters.http.cache";
 
   // Converts names from v1 to v2
   const Config::V1Converter v1_converter_;
@@ -32,6 +32,21 @@ Network::FilterStatus Filter::onAccept(Network::ListenerFilterCallbacks& cb) {
   ENVOY_LOG(debug, "proxy_protocol: New connection accepted");
   Network::ConnectionSocket& socket = cb.socket();
   ASSERT(file_event_.get() == nullptr);
+  cb_ = &cb;
+
+  // The header is usually sent along with the first data of the connection, so it is often
+  // readable by the time the connection is accepted. Read it straight away, which saves
+  // registering a file event and waking up for it.
+  switch (tryReadHeader()) {
+  case ParseState::Done:
+    return Network::FilterStatus::Continue;
+  case ParseState::Error:
+    cb.continueFilterChain(false);
+    return Network::FilterStatus::StopIteration;
+  case ParseState::Continue:
+    break;
+  }
+
   file_event_ =
       cb.dispatcher().createFileEvent(socket.fd(),
                                       [this](uint32_t events) {
@@ -39,20 +54,30 @@ Network::FilterStatus Filter::onAccept(Network::ListenerFilterCallbacks& cb) {
                                         onRead();
                                       },
                                       Event::FileTriggerType::Edge, Event::FileReadyType::Read);
-  cb_ = &cb;
   return Network::FilterStatus::StopIteration;
 }
 
 void Filter::onRead() {
+  const ParseState parse_state = tryReadHeader();
+  if (parse_state == ParseState::Continue) {
+    return;
+  }
+
+  // Release the file event so that we do not interfere with the connection read events.
+  file_event_.reset();
+  cb_->continueFilterChain(parse_state == ParseState::Done);
+}
+
+Filter::ParseState Filter::tryReadHeader() {
   try {
-    onReadWorker();
+    return onReadWorker() ? ParseState::Done : ParseState::Continue;
   } catch (const EnvoyException& ee) {
     config_->stats_.downstream_cx_proxy_proto_error_.inc();
-    cb_->continueFilterChain(false);
+    return ParseState::Error;
   }
 }
 
-void Filter::onReadWorker() {
+bool Filter::onReadWorker() {
   Network::ConnectionSocket& socket = cb_->socket();
 
   if ((!proxy_protocol_header_.has_value() && !readProxyHeader(socket.fd())) ||
@@ -60,7 +85,7 @@ void Filter::onReadWorker() {
     // We return if a) we do not yet have the header, or b) we have the header but not yet all
     // the extension data. In both cases we'll be called again when the socket is ready to read
     // and pick up where we left off.
-    return;
+    return false;
   }
 
   if (proxy_protocol_header_.has_value() && !proxy_protocol_header_.value().local_command_) {
@@ -87,10 +112,7 @@ void Filter::onReadWorker() {
     }
     socket.setRemoteAddress(proxy_protocol_header_.value().remote_address_);
   }
-
-  // Release the file event so that we do not interfere with the connection read events.
-  file_event_.reset();
-  cb_->continueFilterChain(true);
+  return true;
 }
 
 size_t Filter::lenV2Address(char* buf) {
@@ -65,8 +65,22 @@ private:
       PROXY_PROTO_V2_HEADER_LEN + PROXY_PROTO_V2_ADDR_LEN_UNIX;
   static const size_t MAX_PROXY_PROTO_LEN_V1 = 108;
 
+  enum class ParseState {
+    // More data is needed to read the header.
+    Continue,
+    // The header has been read, and the filter chain may continue.
+    Done,
+    // The header is invalid, and the connection must be closed.
+    Error
+  };
+
   void onRead();
-  void onReadWorker();
+  ParseState tryReadHeader();
+  /**
+   * @return bool true if the header has been read and applied, false if more data is needed.
+   * Throws EnvoyException if the header is invalid.
+   */
+  bool onReadWorker();
 
   /**
    * Helper function that attempts to read the proxy header
@@ -73,6 +73,20 @@ Network::FilterStatus Filter::onAccept(Network::ListenerFilterCallbacks& cb) {
   ENVOY_LOG(debug, "tls inspector: new connection accepted");
   Network::ConnectionSocket& socket = cb.socket();
   ASSERT(file_event_ == nullptr);
+  cb_ = &cb;
+
+  // The ClientHello usually arrives right behind the handshake, so it is often readable by the
+  // time the connection is accepted. Inspect it straight away, which saves registering a file
+  // event and waking up for it.
+  switch (onRead()) {
+  case ParseState::Done:
+    return Network::FilterStatus::Continue;
+  case ParseState::Error:
+    cb.continueFilterChain(false);
+    return Network::FilterStatus::StopIteration;
+  case ParseState::Continue:
+    break;
+  }
 
   file_event_ = cb.dispatcher().createFileEvent(
       socket.fd(),
@@ -84,7 +98,10 @@ Network::FilterStatus Filter::onAccept(Network::ListenerFilterCallbacks& cb) {
         }
 
         ASSERT(events == Event::FileReadyType::Read);
-        onRead();
+        const ParseState parse_state = onRead();
+        if (parse_state != ParseState::Continue) {
+          done(parse_state == ParseState::Done);
+        }
       },
       Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Closed);
 
@@ -95,7 +112,6 @@ Network::FilterStatus Filter::onAccept(Network::ListenerFilterCallbacks& cb) {
   // TODO(ggreenway): Move timeout and close-detection to the filter manager
   // so that it applies to all listener filters.
 
-  cb_ = &cb;
   return Network::FilterStatus::StopIteration;
 }
 
@@ -130,7 +146,7 @@ void Filter::onServername(absl::string_view name) {
   clienthello_success_ = true;
 }
 
-void Filter::onRead() {
+Filter::ParseState Filter::onRead() {
   // This receive code is somewhat complicated, because it must be done as a MSG_PEEK because
   // there is no way for a listener-filter to pass payload data to the ConnectionImpl and filters
   // that get created later.
@@ -149,11 +165,10 @@ void Filter::onRead() {
   ENVOY_LOG(trace, "tls inspector: recv: {}", result.rc_);
 
   if (result.rc_ == -1 && result.errno_ == EAGAIN) {
-    return;
+    return ParseState::Continue;
   } else if (result.rc_ < 0) {
     config_->stats().read_error_.inc();
-    done(false);
-    return;
+    return ParseState::Error;
   }
 
   // Because we're doing a MSG_PEEK, data we've seen before gets returned every time, so
@@ -162,8 +177,9 @@ void Filter::onRead() {
     const uint8_t* data = buf_ + read_;
     const size_t len = result.rc_ - read_;
     read_ = result.rc_;
-    parseClientHello(data, len);
+    return parseClientHello(data, len);
   }
+  return ParseState::Continue;
 }
 
 void Filter::onTimeout() {
@@ -179,7 +195,7 @@ void Filter::done(bool success) {
   cb_->continueFilterChain(success);
 }
 
-void Filter::parseClientHello(const void* data, size_t len) {
+Filter::ParseState Filter::parseClientHello(const void* data, size_t len) {
   // Ownership is passed to ssl_ in SSL_set_bio()
   bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(data, len));
 
@@ -200,9 +216,9 @@ void Filter::parseClientHello(const void* data, size_t len) {
       // We've hit the specified size limit. This is an unreasonably large ClientHello;
       // indicate failure.
       config_->stats().client_hello_too_large_.inc();
-      done(false);
+      return ParseState::Error;
     }
-    break;
+    return ParseState::Continue;
   case SSL_ERROR_SSL:
     if (clienthello_success_) {
       config_->stats().tls_found_.inc();
@@ -215,11 +231,9 @@ void Filter::parseClientHello(const void* data, size_t len) {
     } else {
       config_->stats().tls_not_found_.inc();
     }
-    done(true);
-    break;
+    return ParseState::Done;
   default:
-    done(false);
-    break;
+    return ParseState::Error;
   }
 }
 
@@ -70,8 +70,17 @@ public:
   Network::FilterStatus onAccept(Network::ListenerFilterCallbacks& cb) override;
 
 private:
-  void parseClientHello(const void* data, size_t len);
-  void onRead();
+  enum class ParseState {
+    // More data is needed to parse the ClientHello.
+    Continue,
+    // Inspection is complete, and the filter chain may continue.
+    Done,
+    // Inspection failed, and the connection must be closed.
+    Error
+  };
+
+  ParseState parseClientHello(const void* data, size_t len);
+  ParseState onRead();
   void onTimeout();
   void done(bool success);
   void onALPN(const unsigned char* data, unsigned int len);
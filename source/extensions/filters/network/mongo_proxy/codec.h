@@ -23,7 +23,6 @@ class Message {
 public:
   enum class OpCode {
     OP_REPLY = 1,
-    OP_MSG = 1000,
     OP_UPDATE = 2001,
     OP_INSERT = 2002,
     OP_QUERY = 2004,
@@ -31,7 +30,8 @@ public:
     OP_DELETE = 2006,
     OP_KILL_CURSORS = 2007,
     OP_COMMAND = 2010,
-    OP_COMMANDREPLY = 2011
+    OP_COMMANDREPLY = 2011,
+    OP_MSG = 2013
   };
 
   virtual ~Message(){};
@@ -152,6 +152,18 @@ public:
   virtual void numberReturned(int32_t number_returned) PURE;
   virtual const std::list<Bson::DocumentSharedPtr>& documents() const PURE;
   virtual std::list<Bson::DocumentSharedPtr>& documents() PURE;
+
+  /**
+   * @return uint64_t the number of documents in the reply. This is known even if the decoder
+   *         skipped the documents rather than decoding them into documents().
+   */
+  virtual uint64_t numberOfDocuments() const PURE;
+
+  /**
+   * @return uint64_t the total size in bytes of the documents in the reply. This is known even if
+   *         the decoder skipped the documents rather than decoding them into documents().
+   */
+  virtual uint64_t documentsByteSize() const PURE;
 };
 
 typedef std::unique_ptr<ReplyMessage> ReplyMessagePtr;
@@ -187,6 +199,50 @@ public:
 
 typedef std::unique_ptr<CommandReplyMessage> CommandReplyMessagePtr;
 
+/**
+ * Mongo OP_MSG message, used by MongoDB 3.6 and later for both commands and their replies.
+ */
+class OpMsgMessage : public virtual Message {
+public:
+  struct Flags {
+    // clang-format off
+    static const int32_t ChecksumPresent = 0x1 << 0;
+    static const int32_t MoreToCome      = 0x1 << 1;
+    static const int32_t ExhaustAllowed  = 0x1 << 16;
+    // clang-format on
+  };
+
+  /**
+   * A kind 1 section, holding the documents of one argument of the command.
+   */
+  struct DocumentSequence {
+    std::string identifier_;
+    std::list<Bson::DocumentSharedPtr> documents_;
+  };
+
+  virtual bool operator==(const OpMsgMessage& rhs) const PURE;
+
+  virtual int32_t flags() const PURE;
+  virtual void flags(int32_t flags) PURE;
+
+  /**
+   * @return the kind 0 section holding the command or the reply, or nullptr if the decoder skipped
+   *         the sections of the message.
+   */
+  virtual const Bson::Document* body() const PURE;
+  virtual void body(Bson::DocumentSharedPtr&& body) PURE;
+  virtual const std::list<DocumentSequence>& documentSequences() const PURE;
+  virtual std::list<DocumentSequence>& documentSequences() PURE;
+
+  /**
+   * @return uint64_t the total size in bytes of the documents in all the sections. This is known
+   *         even if the decoder skipped the sections rather than decoding them.
+   */
+  virtual uint64_t documentsByteSize() const PURE;
+};
+
+typedef std::unique_ptr<OpMsgMessage> OpMsgMessagePtr;
+
 /**
  * General callbacks for dispatching decoded mongo messages to a sink.
  */
@@ -201,6 +257,7 @@ public:
   virtual void decodeReply(ReplyMessagePtr&& message) PURE;
   virtual void decodeCommand(CommandMessagePtr&& message) PURE;
   virtual void decodeCommandReply(CommandReplyMessagePtr&& message) PURE;
+  virtual void decodeOpMsg(OpMsgMessagePtr&& message) PURE;
 };
 
 /**
@@ -229,6 +286,7 @@ public:
   virtual void encodeReply(const ReplyMessage& message) PURE;
   virtual void encodeCommand(const CommandMessage& message) PURE;
   virtual void encodeCommandReply(const CommandReplyMessage& message) PURE;
+  virtual void encodeOpMsg(const OpMsgMessage& message) PURE;
 };
 
 } // namespace MongoProxy
@@ -11,6 +11,7 @@
 
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
+#include "common/common/utility.h"
 
 #include "extensions/filters/network/mongo_proxy/bson_impl.h"
 
@@ -38,6 +39,18 @@ MessageImpl::documentListToString(const std::list<Bson::DocumentSharedPtr>& docu
   return out.str();
 }
 
+uint64_t MessageImpl::skipDocument(Buffer::Instance& data) {
+  const int32_t document_length = Bson::BufferHelper::peekInt32(data);
+  // The smallest document is its length followed by its terminating null byte.
+  if (document_length < static_cast<int32_t>(Int32Length + 1) ||
+      static_cast<uint64_t>(document_length) > data.length()) {
+    throw EnvoyException("invalid BSON message length");
+  }
+
+  data.drain(document_length);
+  return document_length;
+}
+
 void GetMoreMessageImpl::fromBuffer(uint32_t, Buffer::Instance& data) {
   ENVOY_LOG(trace, "decoding get more message");
   Bson::BufferHelper::removeInt32(data); // "zero" (unused)
@@ -190,7 +203,12 @@ void ReplyMessageImpl::fromBuffer(uint32_t, Buffer::Instance& data) {
   starting_from_ = Bson::BufferHelper::removeInt32(data);
   number_returned_ = Bson::BufferHelper::removeInt32(data);
   for (int32_t i = 0; i < number_returned_; i++) {
-    documents_.emplace_back(Bson::DocumentImpl::create(data));
+    if (skip_documents_) {
+      skipped_documents_byte_size_ += skipDocument(data);
+      skipped_documents_++;
+    } else {
+      documents_.emplace_back(Bson::DocumentImpl::create(data));
+    }
   }
 
   ENVOY_LOG(trace, "{}", toString(true));
@@ -199,8 +217,8 @@ void ReplyMessageImpl::fromBuffer(uint32_t, Buffer::Instance& data) {
 bool ReplyMessageImpl::operator==(const ReplyMessage& rhs) const {
   if (!(requestId() == rhs.requestId() && responseTo() == rhs.responseTo() &&
         flags() == rhs.flags() && cursorId() == rhs.cursorId() &&
-        startingFrom() == rhs.startingFrom() && numberReturned() == rhs.numberReturned())) {
-
+        startingFrom() == rhs.startingFrom() && numberReturned() == rhs.numberReturned() &&
+        documents().size() == rhs.documents().size())) {
     return false;
   }
 
@@ -219,7 +237,25 @@ std::string ReplyMessageImpl::toString(bool full) const {
       R"EOF({{"opcode": "OP_REPLY", "id": {}, "response_to": {}, "flags": "{:#x}", "cursor": "{}", )EOF"
       R"EOF("from": {}, "returned": {}, "documents": {}}})EOF",
       request_id_, response_to_, flags_, cursor_id_, starting_from_, number_returned_,
-      full ? documentListToString(documents_) : std::to_string(documents_.size()));
+      full && !skip_documents_ ? documentListToString(documents_)
+                               : std::to_string(numberOfDocuments()));
+}
+
+uint64_t ReplyMessageImpl::numberOfDocuments() const {
+  return skip_documents_ ? skipped_documents_ : documents_.size();
+}
+
+uint64_t ReplyMessageImpl::documentsByteSize() const {
+  if (skip_documents_) {
+    return skipped_documents_byte_size_;
+  }
+
+  uint64_t byte_size = 0;
+  for (const Bson::DocumentSharedPtr& document : documents_) {
+    byte_size += document->byteSize();
+  }
+
+  return byte_size;
 }
 
 /*
@@ -342,6 +378,153 @@ bool CommandReplyMessageImpl::operator==(const CommandReplyMessage& rhs) const {
 
   return true;
 }
+// OP_MSG implementation.
+void OpMsgMessageImpl::fromBuffer(uint32_t message_length, Buffer::Instance& data) {
+  ENVOY_LOG(trace, "decoding OP_MSG message");
+  ASSERT(data.length() >= message_length);
+  if (message_length < Int32Length) {
+    throw EnvoyException("invalid OP_MSG message length");
+  }
+
+  flags_ = Bson::BufferHelper::removeInt32(data);
+  const uint32_t checksum_length = (flags_ & Flags::ChecksumPresent) ? Int32Length : 0;
+  if (message_length < Int32Length + checksum_length) {
+    throw EnvoyException("invalid OP_MSG message length");
+  }
+
+  // The length of the data that follows the sections, the checksum included.
+  const uint64_t sections_end = data.length() - (message_length - Int32Length - checksum_length);
+  uint32_t body_sections = 0;
+  while (data.length() > sections_end) {
+    const uint8_t kind = Bson::BufferHelper::removeByte(data);
+    switch (kind) {
+    case 0: {
+      body_sections++;
+      if (skip_sections_) {
+        skipped_documents_byte_size_ += skipDocument(data);
+      } else {
+        body_ = Bson::DocumentImpl::create(data);
+      }
+      break;
+    }
+
+    case 1: {
+      const int32_t sequence_length = Bson::BufferHelper::peekInt32(data);
+      if (sequence_length < static_cast<int32_t>(Int32Length) ||
+          static_cast<uint64_t>(sequence_length) > data.length() - sections_end) {
+        throw EnvoyException("invalid OP_MSG document sequence length");
+      }
+
+      const uint64_t sequence_end = data.length() - sequence_length;
+      data.drain(Int32Length);
+      std::string identifier = Bson::BufferHelper::removeCString(data);
+      if (skip_sections_) {
+        while (data.length() > sequence_end) {
+          skipped_documents_byte_size_ += skipDocument(data);
+        }
+      } else {
+        document_sequences_.emplace_back();
+        document_sequences_.back().identifier_ = std::move(identifier);
+        while (data.length() > sequence_end) {
+          document_sequences_.back().documents_.emplace_back(Bson::DocumentImpl::create(data));
+        }
+      }
+
+      if (data.length() != sequence_end) {
+        throw EnvoyException("invalid OP_MSG document sequence length");
+      }
+      break;
+    }
+
+    default:
+      throw EnvoyException(fmt::format("invalid OP_MSG section kind {}", kind));
+    }
+  }
+
+  if (data.length() != sections_end || body_sections != 1) {
+    throw EnvoyException("invalid OP_MSG message");
+  }
+
+  // The CRC-32C checksum is not verified, as messages are only sniffed.
+  data.drain(checksum_length);
+
+  ENVOY_LOG(trace, "{}", toString(true));
+}
+
+std::string OpMsgMessageImpl::toString(bool full) const {
+  return fmt::format(
+      R"EOF({{"opcode": "OP_MSG", "id": {}, "response_to": {}, "flags": "{:#x}", "body": {}, )EOF"
+      R"EOF("sequences": {}, "size": {}}})EOF",
+      request_id_, response_to_, flags_, full && body_ ? body_->toString() : "\"{...}\"",
+      full ? documentSequencesToString() : std::to_string(document_sequences_.size()),
+      documentsByteSize());
+}
+
+std::string OpMsgMessageImpl::documentSequencesToString() const {
+  std::stringstream out;
+  out << "[";
+
+  bool first = true;
+  for (const DocumentSequence& sequence : document_sequences_) {
+    if (!first) {
+      out << ", ";
+    }
+
+    out << fmt::format(R"EOF({{"identifier": "{}", "documents": {}}})EOF",
+                       StringUtil::escape(sequence.identifier_),
+                       documentListToString(sequence.documents_));
+    first = false;
+  }
+
+  out << "]";
+  return out.str();
+}
+
+bool OpMsgMessageImpl::operator==(const OpMsgMessage& rhs) const {
+  if (!(requestId() == rhs.requestId() && responseTo() == rhs.responseTo() &&
+        flags() == rhs.flags() && !body() == !rhs.body() &&
+        documentSequences().size() == rhs.documentSequences().size())) {
+    return false;
+  }
+
+  if (body()) {
+    if (!(*body() == *rhs.body())) {
+      return false;
+    }
+  }
+
+  for (auto i = documentSequences().begin(), j = rhs.documentSequences().begin();
+       i != documentSequences().end(); i++, j++) {
+    if (!(i->identifier_ == j->identifier_ && i->documents_.size() == j->documents_.size())) {
+      return false;
+    }
+
+    for (auto k = i->documents_.begin(), l = j->documents_.begin(); k != i->documents_.end();
+         k++, l++) {
+      if (!(**k == **l)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+uint64_t OpMsgMessageImpl::documentsByteSize() const {
+  if (skip_sections_) {
+    return skipped_documents_byte_size_;
+  }
+
+  uint64_t byte_size = body_ ? body_->byteSize() : 0;
+  for (const DocumentSequence& sequence : document_sequences_) {
+    for (const Bson::DocumentSharedPtr& document : sequence.documents_) {
+      byte_size += document->byteSize();
+    }
+  }
+
+  return byte_size;
+}
+
 bool DecoderImpl::decode(Buffer::Instance& data) {
   // See if we have enough data for the message length.
   ENVOY_LOG(trace, "decoding {} bytes", data.length());
@@ -367,7 +550,8 @@ bool DecoderImpl::decode(Buffer::Instance& data) {
 
   switch (op_code) {
   case Message::OpCode::OP_REPLY: {
-    std::unique_ptr<ReplyMessageImpl> message(new ReplyMessageImpl(request_id, response_to));
+    std::unique_ptr<ReplyMessageImpl> message(
+        new ReplyMessageImpl(request_id, response_to, skip_reply_documents_));
     message->fromBuffer(message_length, data);
     callbacks_.decodeReply(std::move(message));
     break;
@@ -417,6 +601,15 @@ bool DecoderImpl::decode(Buffer::Instance& data) {
     break;
   }
 
+  case Message::OpCode::OP_MSG: {
+    // Requests have no response to, and their commands are needed for stats.
+    std::unique_ptr<OpMsgMessageImpl> message(new OpMsgMessageImpl(
+        request_id, response_to, skip_reply_documents_ && response_to != 0));
+    message->fromBuffer(message_length, data);
+    callbacks_.decodeOpMsg(std::move(message));
+    break;
+  }
+
   default:
     throw EnvoyException(fmt::format("invalid mongo op {}", static_cast<int32_t>(op_code)));
   }
@@ -572,6 +765,45 @@ void EncoderImpl::encodeCommandReply(const CommandReplyMessage& message) {
     document->encode(output_);
   }
 }
+
+void EncoderImpl::encodeOpMsg(const OpMsgMessage& message) {
+  if (!message.body()) {
+    throw EnvoyException("invalid OP_MSG message");
+  }
+
+  // https://docs.mongodb.com/manual/reference/mongodb-wire-protocol/#op-msg
+  int32_t total_size = Message::MessageHeaderSize + Message::Int32Length + sizeof(uint8_t) +
+                       message.body()->byteSize();
+  for (const OpMsgMessage::DocumentSequence& sequence : message.documentSequences()) {
+    total_size += sizeof(uint8_t) + documentSequenceByteSize(sequence);
+  }
+
+  // Checksums are not computed, so the flag is never set.
+  encodeCommonHeader(total_size, message, Message::OpCode::OP_MSG);
+  Bson::BufferHelper::writeInt32(output_, message.flags() & ~OpMsgMessage::Flags::ChecksumPresent);
+  const uint8_t body_kind = 0;
+  output_.add(&body_kind, sizeof(body_kind));
+  message.body()->encode(output_);
+  for (const OpMsgMessage::DocumentSequence& sequence : message.documentSequences()) {
+    const uint8_t sequence_kind = 1;
+    output_.add(&sequence_kind, sizeof(sequence_kind));
+    Bson::BufferHelper::writeInt32(output_, documentSequenceByteSize(sequence));
+    Bson::BufferHelper::writeCString(output_, sequence.identifier_);
+    for (const Bson::DocumentSharedPtr& document : sequence.documents_) {
+      document->encode(output_);
+    }
+  }
+}
+
+int32_t EncoderImpl::documentSequenceByteSize(const OpMsgMessage::DocumentSequence& sequence) {
+  int32_t byte_size =
+      Message::Int32Length + sequence.identifier_.size() + Message::StringPaddingLength;
+  for (const Bson::DocumentSharedPtr& document : sequence.documents_) {
+    byte_size += document->byteSize();
+  }
+
+  return byte_size;
+}
 } // namespace MongoProxy
 } // namespace NetworkFilters
 } // namespace Extensions
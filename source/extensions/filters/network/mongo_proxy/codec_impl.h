@@ -28,6 +28,13 @@ public:
 protected:
   std::string documentListToString(const std::list<Bson::DocumentSharedPtr>& documents) const;
 
+  /**
+   * Drain a BSON document from a buffer without decoding it, using its length prefix.
+   * @param data supplies the buffer.
+   * @return uint64_t the size of the document.
+   */
+  static uint64_t skipDocument(Buffer::Instance& data);
+
   const int32_t request_id_;
   const int32_t response_to_;
 };
@@ -158,7 +165,12 @@ class ReplyMessageImpl : public MessageImpl,
                          public ReplyMessage,
                          Logger::Loggable<Logger::Id::mongo> {
 public:
-  using MessageImpl::MessageImpl;
+  /**
+   * @param skip_documents supplies whether fromBuffer() only counts and measures the documents,
+   *        leaving documents() empty.
+   */
+  ReplyMessageImpl(int32_t request_id, int32_t response_to, bool skip_documents = false)
+      : MessageImpl(request_id, response_to), skip_documents_(skip_documents) {}
 
   // MessageImpl
   void fromBuffer(uint32_t message_length, Buffer::Instance& data) override;
@@ -178,13 +190,19 @@ public:
   void numberReturned(int32_t number_returned) override { number_returned_ = number_returned; }
   const std::list<Bson::DocumentSharedPtr>& documents() const override { return documents_; }
   std::list<Bson::DocumentSharedPtr>& documents() override { return documents_; }
+  uint64_t numberOfDocuments() const override;
+  uint64_t documentsByteSize() const override;
 
 private:
+  const bool skip_documents_;
   int32_t flags_{};
   int64_t cursor_id_{};
   int32_t starting_from_{};
   int32_t number_returned_{};
   std::list<Bson::DocumentSharedPtr> documents_;
+  // The number and size of the documents when they are skipped.
+  uint64_t skipped_documents_{};
+  uint64_t skipped_documents_byte_size_{};
 };
 
 // OP_COMMAND message.
@@ -249,9 +267,56 @@ private:
   std::list<Bson::DocumentSharedPtr> output_docs_;
 };
 
+// OP_MSG message.
+class OpMsgMessageImpl : public MessageImpl,
+                         public OpMsgMessage,
+                         Logger::Loggable<Logger::Id::mongo> {
+public:
+  /**
+   * @param skip_sections supplies whether fromBuffer() only measures the sections, leaving the
+   *        body and the document sequences empty.
+   */
+  OpMsgMessageImpl(int32_t request_id, int32_t response_to, bool skip_sections = false)
+      : MessageImpl(request_id, response_to), skip_sections_(skip_sections) {}
+
+  // MessageImpl
+  void fromBuffer(uint32_t message_length, Buffer::Instance& data) override;
+
+  // Mongo::Message
+  std::string toString(bool full) const override;
+
+  // Mongo::OpMsgMessage
+  bool operator==(const OpMsgMessage& rhs) const override;
+  int32_t flags() const override { return flags_; }
+  void flags(int32_t flags) override { flags_ = flags; }
+  const Bson::Document* body() const override { return body_.get(); }
+  void body(Bson::DocumentSharedPtr&& body) override { body_ = std::move(body); }
+  const std::list<DocumentSequence>& documentSequences() const override {
+    return document_sequences_;
+  }
+  std::list<DocumentSequence>& documentSequences() override { return document_sequences_; }
+  uint64_t documentsByteSize() const override;
+
+private:
+  std::string documentSequencesToString() const;
+
+  const bool skip_sections_;
+  int32_t flags_{};
+  Bson::DocumentSharedPtr body_;
+  std::list<DocumentSequence> document_sequences_;
+  // The size of the documents when the sections are skipped.
+  uint64_t skipped_documents_byte_size_{};
+};
+
 class DecoderImpl : public Decoder, Logger::Loggable<Logger::Id::mongo> {
 public:
-  DecoderImpl(DecoderCallbacks& callbacks) : callbacks_(callbacks) {}
+  /**
+   * @param skip_reply_documents supplies whether the documents of replies are skipped rather than
+   *        decoded, for callbacks that only need their number and size. This covers the documents
+   *        of OP_REPLY messages and the sections of OP_MSG messages that respond to a request.
+   */
+  DecoderImpl(DecoderCallbacks& callbacks, bool skip_reply_documents = false)
+      : callbacks_(callbacks), skip_reply_documents_(skip_reply_documents) {}
 
   // Mongo::Decoder
   void onData(Buffer::Instance& data) override;
@@ -260,6 +325,7 @@ private:
   bool decode(Buffer::Instance& data);
 
   DecoderCallbacks& callbacks_;
+  const bool skip_reply_documents_;
 };
 
 class EncoderImpl : public Encoder, Logger::Loggable<Logger::Id::mongo> {
@@ -274,9 +340,11 @@ public:
   void encodeReply(const ReplyMessage& message) override;
   void encodeCommand(const CommandMessage& message) override;
   void encodeCommandReply(const CommandReplyMessage& message) override;
+  void encodeOpMsg(const OpMsgMessage& message) override;
 
 private:
   void encodeCommonHeader(int32_t total_size, const Message& message, Message::OpCode op);
+  static int32_t documentSequenceByteSize(const OpMsgMessage::DocumentSequence& sequence);
 
   Buffer::Instance& output_;
 };
@@ -33,10 +33,12 @@ Network::FilterFactoryCb MongoProxyFilterConfigFactory::createFilterFactoryFromP
     fault_config = std::make_shared<FaultConfig>(proto_config.delay());
   }
 
-  return [stat_prefix, &context, access_log,
+  Stats::DynamicStatsCacheSharedPtr dynamic_stats =
+      std::make_shared<Stats::DynamicStatsCache>(context.scope(), context.threadLocal());
+  return [stat_prefix, &context, dynamic_stats, access_log,
           fault_config](Network::FilterManager& filter_manager) -> void {
     filter_manager.addFilter(std::make_shared<ProdProxyFilter>(
-        stat_prefix, context.scope(), context.runtime(), access_log, fault_config,
+        stat_prefix, context.scope(), dynamic_stats, context.runtime(), access_log, fault_config,
         context.drainDecision(), context.random()));
   };
 }
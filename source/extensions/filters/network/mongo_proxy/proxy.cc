@@ -40,11 +40,13 @@ void AccessLog::logMessage(const Message& message, bool full,
 }
 
 ProxyFilter::ProxyFilter(const std::string& stat_prefix, Stats::Scope& scope,
+                         const Stats::DynamicStatsCacheSharedPtr& dynamic_stats,
                          Runtime::Loader& runtime, AccessLogSharedPtr access_log,
                          const FaultConfigSharedPtr& fault_config,
                          const Network::DrainDecision& drain_decision,
                          Runtime::RandomGenerator& generator)
-    : stat_prefix_(stat_prefix), scope_(scope), stats_(generateStats(stat_prefix, scope)),
+    : stat_prefix_(stat_prefix), dynamic_stats_(dynamic_stats),
+      stats_(generateStats(stat_prefix, scope)),
       runtime_(runtime), drain_decision_(drain_decision), generator_(generator),
       access_log_(access_log), fault_config_(fault_config) {
   if (!runtime_.snapshot().featureEnabled(MongoRuntimeConfig::get().ConnectionLoggingEnabled,
@@ -104,21 +106,17 @@ void ProxyFilter::decodeQuery(QueryMessagePtr&& message) {
   ActiveQueryPtr active_query(new ActiveQuery(*this, *message));
   if (!active_query->query_info_.command().empty()) {
     // First field key is the operation.
-    scope_.counter(fmt::format("{}cmd.{}.total", stat_prefix_, active_query->query_info_.command()))
+    dynamic_stats_->counter({stat_prefix_, "cmd.", active_query->query_info_.command(), ".total"})
         .inc();
   } else {
     // Normal query, get stats on a per collection basis first.
-    std::string collection_stat_prefix =
-        fmt::format("{}collection.{}", stat_prefix_, active_query->query_info_.collection());
+    const std::string& collection = active_query->query_info_.collection();
     QueryMessageInfo::QueryType query_type = active_query->query_info_.type();
-    chargeQueryStats(collection_stat_prefix, query_type);
+    chargeQueryStats(collection, "", query_type);
 
     // Callsite stats if we have it.
     if (!active_query->query_info_.callsite().empty()) {
-      std::string callsite_stat_prefix =
-          fmt::format("{}collection.{}.callsite.{}", stat_prefix_,
-                      active_query->query_info_.collection(), active_query->query_info_.callsite());
-      chargeQueryStats(callsite_stat_prefix, query_type);
+      chargeQueryStats(collection, active_query->query_info_.callsite(), query_type);
     }
 
     // Global stats.
@@ -135,13 +133,23 @@ void ProxyFilter::decodeQuery(QueryMessagePtr&& message) {
   active_query_list_.emplace_back(std::move(active_query));
 }
 
-void ProxyFilter::chargeQueryStats(const std::string& prefix,
+void ProxyFilter::chargeQueryStats(absl::string_view collection, absl::string_view callsite,
                                    QueryMessageInfo::QueryType query_type) {
-  scope_.counter(fmt::format("{}.query.total", prefix)).inc();
+  const absl::string_view callsite_prefix = callsite.empty() ? "" : ".callsite.";
+  dynamic_stats_
+      ->counter(
+          {stat_prefix_, "collection.", collection, callsite_prefix, callsite, ".query.total"})
+      .inc();
   if (query_type == QueryMessageInfo::QueryType::ScatterGet) {
-    scope_.counter(fmt::format("{}.query.scatter_get", prefix)).inc();
+    dynamic_stats_
+        ->counter({stat_prefix_, "collection.", collection, callsite_prefix, callsite,
+                   ".query.scatter_get"})
+        .inc();
   } else if (query_type == QueryMessageInfo::QueryType::MultiGet) {
-    scope_.counter(fmt::format("{}.query.multi_get", prefix)).inc();
+    dynamic_stats_
+        ->counter({stat_prefix_, "collection.", collection, callsite_prefix, callsite,
+                   ".query.multi_get"})
+        .inc();
   }
 }
 
@@ -166,23 +174,13 @@ void ProxyFilter::decodeReply(ReplyMessagePtr&& message) {
       continue;
     }
 
-    if (!active_query.query_info_.command().empty()) {
-      std::string stat_prefix =
-          fmt::format("{}cmd.{}", stat_prefix_, active_query.query_info_.command());
-      chargeReplyStats(active_query, stat_prefix, *message);
-    } else {
-      // Collection stats first.
-      std::string stat_prefix =
-          fmt::format("{}collection.{}.query", stat_prefix_, active_query.query_info_.collection());
-      chargeReplyStats(active_query, stat_prefix, *message);
-
-      // Callsite stats if we have it.
-      if (!active_query.query_info_.callsite().empty()) {
-        std::string callsite_stat_prefix =
-            fmt::format("{}collection.{}.callsite.{}.query", stat_prefix_,
-                        active_query.query_info_.collection(), active_query.query_info_.callsite());
-        chargeReplyStats(active_query, callsite_stat_prefix, *message);
-      }
+    // Command stats, or collection stats first.
+    chargeReplyStats(active_query, "", *message);
+
+    // Callsite stats if we have it.
+    if (active_query.query_info_.command().empty() &&
+        !active_query.query_info_.callsite().empty()) {
+      chargeReplyStats(active_query, active_query.query_info_.callsite(), *message);
     }
 
     active_query_list_.erase(i);
@@ -225,21 +223,49 @@ void ProxyFilter::decodeCommandReply(CommandReplyMessagePtr&& message) {
   ENVOY_LOG(debug, "decoded COMMANDREPLY: {}", message->toString(true));
 }
 
+void ProxyFilter::decodeOpMsg(OpMsgMessagePtr&& message) {
+  if (message->responseTo() != 0) {
+    stats_.op_msg_reply_.inc();
+    logMessage(*message, false);
+    ENVOY_LOG(debug, "decoded OP_MSG reply: {}", message->toString(true));
+    return;
+  }
+
+  tryInjectDelay();
+
+  stats_.op_msg_.inc();
+  logMessage(*message, true);
+  ENVOY_LOG(debug, "decoded OP_MSG: {}", message->toString(true));
+
+  // First field key of the body is the command.
+  const Bson::Document* body = message->body();
+  if (body && !body->values().empty()) {
+    dynamic_stats_->counter({stat_prefix_, "cmd.", body->values().front()->key(), ".total"}).inc();
+  }
+}
+
 void ProxyFilter::onDrainClose() {
   read_callbacks_->connection().close(Network::ConnectionCloseType::FlushWrite);
 }
 
-void ProxyFilter::chargeReplyStats(ActiveQuery& active_query, const std::string& prefix,
+void ProxyFilter::chargeReplyStats(ActiveQuery& active_query, absl::string_view callsite,
                                    const ReplyMessage& message) {
-  uint64_t reply_documents_byte_size = 0;
-  for (const Bson::DocumentSharedPtr& document : message.documents()) {
-    reply_documents_byte_size += document->byteSize();
-  }
-
-  scope_.histogram(fmt::format("{}.reply_num_docs", prefix))
-      .recordValue(message.documents().size());
-  scope_.histogram(fmt::format("{}.reply_size", prefix)).recordValue(reply_documents_byte_size);
-  scope_.histogram(fmt::format("{}.reply_time_ms", prefix))
+  // The replies of commands are charged to the command, and those of queries to the collection.
+  QueryMessageInfo& query_info = active_query.query_info_;
+  const bool command = !query_info.command().empty();
+  const absl::string_view type = command ? "cmd." : "collection.";
+  const absl::string_view name = command ? query_info.command() : query_info.collection();
+  const absl::string_view callsite_prefix = callsite.empty() ? "" : ".callsite.";
+  const absl::string_view query = command ? "" : ".query";
+
+  dynamic_stats_
+      ->histogram({stat_prefix_, type, name, callsite_prefix, callsite, query, ".reply_num_docs"})
+      .recordValue(message.numberOfDocuments());
+  dynamic_stats_
+      ->histogram({stat_prefix_, type, name, callsite_prefix, callsite, query, ".reply_size"})
+      .recordValue(message.documentsByteSize());
+  dynamic_stats_
+      ->histogram({stat_prefix_, type, name, callsite_prefix, callsite, query, ".reply_time_ms"})
       .recordValue(std::chrono::duration_cast<std::chrono::milliseconds>(
                        std::chrono::steady_clock::now() - active_query.start_time_)
                        .count());
@@ -311,7 +337,8 @@ Network::FilterStatus ProxyFilter::onWrite(Buffer::Instance& data, bool) {
 }
 
 DecoderPtr ProdProxyFilter::createDecoder(DecoderCallbacks& callbacks) {
-  return DecoderPtr{new DecoderImpl(callbacks)};
+  // Replies are only logged in summary and charged by their number and size of documents.
+  return DecoderPtr{new DecoderImpl(callbacks, true)};
 }
 
 absl::optional<uint64_t> ProxyFilter::delayDuration() {
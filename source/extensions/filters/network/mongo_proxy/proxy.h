@@ -22,6 +22,7 @@
 #include "common/network/filter_impl.h"
 #include "common/protobuf/utility.h"
 #include "common/singleton/const_singleton.h"
+#include "common/stats/dynamic_stats_cache.h"
 
 #include "extensions/filters/network/mongo_proxy/codec.h"
 #include "extensions/filters/network/mongo_proxy/utility.h"
@@ -70,7 +71,9 @@ typedef ConstSingleton<MongoRuntimeConfigKeys> MongoRuntimeConfig;
   COUNTER(cx_destroy_remote_with_active_rq)                                                        \
   COUNTER(cx_drain_close)                                                                          \
   COUNTER(op_command)                                                                              \
-  COUNTER(op_command_reply)
+  COUNTER(op_command_reply)                                                                        \
+  COUNTER(op_msg)                                                                                  \
+  COUNTER(op_msg_reply)
 // clang-format on
 
 /**
@@ -125,7 +128,8 @@ class ProxyFilter : public Network::Filter,
                     public Network::ConnectionCallbacks,
                     Logger::Loggable<Logger::Id::mongo> {
 public:
-  ProxyFilter(const std::string& stat_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
+  ProxyFilter(const std::string& stat_prefix, Stats::Scope& scope,
+              const Stats::DynamicStatsCacheSharedPtr& dynamic_stats, Runtime::Loader& runtime,
               AccessLogSharedPtr access_log, const FaultConfigSharedPtr& fault_config,
               const Network::DrainDecision& drain_decision, Runtime::RandomGenerator& generator);
   ~ProxyFilter();
@@ -151,6 +155,7 @@ public:
   void decodeReply(ReplyMessagePtr&& message) override;
   void decodeCommand(CommandMessagePtr&& message) override;
   void decodeCommandReply(CommandReplyMessagePtr&& message) override;
+  void decodeOpMsg(OpMsgMessagePtr&& message) override;
 
   // Network::ConnectionCallbacks
   void onEvent(Network::ConnectionEvent event) override;
@@ -179,8 +184,9 @@ private:
                                                  POOL_HISTOGRAM_PREFIX(scope, prefix))};
   }
 
-  void chargeQueryStats(const std::string& prefix, QueryMessageInfo::QueryType query_type);
-  void chargeReplyStats(ActiveQuery& active_query, const std::string& prefix,
+  void chargeQueryStats(absl::string_view collection, absl::string_view callsite,
+                        QueryMessageInfo::QueryType query_type);
+  void chargeReplyStats(ActiveQuery& active_query, absl::string_view callsite,
                         const ReplyMessage& message);
   void doDecode(Buffer::Instance& buffer);
   void logMessage(Message& message, bool full);
@@ -191,7 +197,8 @@ private:
 
   std::unique_ptr<Decoder> decoder_;
   std::string stat_prefix_;
-  Stats::Scope& scope_;
+  // The stats named after commands, collections and callsites.
+  const Stats::DynamicStatsCacheSharedPtr dynamic_stats_;
   MongoProxyStats stats_;
   Runtime::Loader& runtime_;
   const Network::DrainDecision& drain_decision_;
@@ -26,6 +26,12 @@ public:
   RespValue() : type_(RespType::Null) {}
   ~RespValue() { cleanup(); }
 
+  /**
+   * Deep copy a RESP value. A payload held in a buffer (see hasBuffer()) is shared by the copies.
+   */
+  RespValue(const RespValue& other);
+  RespValue& operator=(const RespValue& other);
+
   /**
    * Convert a RESP value to a string for debugging purposes.
    */
@@ -42,6 +48,17 @@ public:
   int64_t& asInteger();
   int64_t asInteger() const;
 
+  /**
+   * A bulk string may hold its payload in a buffer instead of a string, so that large payloads
+   * can be moved out of the buffer they were read into and forwarded without being copied. Once
+   * the value has been encoded, the buffer must not be modified anymore. asString() copies the
+   * payload into a string when it is called on such a value, the first time only. asBuffer()
+   * switches a bulk string to holding its payload in a buffer.
+   */
+  bool hasBuffer() const { return type_ == RespType::BulkString && buffer_ != nullptr; }
+  Buffer::Instance& asBuffer();
+  const std::shared_ptr<Buffer::Instance>& sharedBuffer() const;
+
   /**
    * Get/set the type of the RespValue. A RespValue can only be a single type at a time. Each time
    * type() is called the type is changed and then the type specific as* methods can be used.
@@ -52,11 +69,14 @@ public:
 private:
   union {
     std::vector<RespValue> array_;
-    std::string string_;
+    // Mutable as a buffered payload is copied into the string by asString() const.
+    mutable std::string string_;
     int64_t integer_;
   };
+  mutable std::shared_ptr<Buffer::Instance> buffer_;
 
   void cleanup();
+  void flattenBuffer() const;
 
   RespType type_;
 };
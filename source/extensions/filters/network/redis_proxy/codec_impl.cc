@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
 #include "common/common/utility.h"
@@ -13,6 +14,62 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace RedisProxy {
 
+namespace {
+
+// Smaller payloads are copied, as moving them out of the read buffer would cost about as much.
+constexpr uint64_t MinBufferedBulkStringSize = 16384;
+
+// References part of a buffered bulk string from an output buffer, keeping the bulk string's
+// buffer alive for as long as the output buffer needs it.
+class BulkStringFragment : public Buffer::BufferFragment {
+public:
+  BulkStringFragment(const std::shared_ptr<Buffer::Instance>& buffer, const Buffer::RawSlice& slice)
+      : buffer_(buffer), slice_(slice) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return slice_.mem_; }
+  size_t size() const override { return slice_.len_; }
+  void done() override { delete this; }
+
+private:
+  const std::shared_ptr<Buffer::Instance> buffer_;
+  const Buffer::RawSlice slice_;
+};
+
+} // namespace
+
+RespValue::RespValue(const RespValue& other) : type_(RespType::Null) { *this = other; }
+
+RespValue& RespValue::operator=(const RespValue& other) {
+  if (&other == this) {
+    return *this;
+  }
+
+  type(other.type_);
+  switch (type_) {
+  case RespType::Array: {
+    array_ = other.array_;
+    break;
+  }
+  case RespType::SimpleString:
+  case RespType::BulkString:
+  case RespType::Error: {
+    string_ = other.string_;
+    buffer_ = other.buffer_;
+    break;
+  }
+  case RespType::Integer: {
+    integer_ = other.integer_;
+    break;
+  }
+  case RespType::Null: {
+    break;
+  }
+  }
+
+  return *this;
+}
+
 std::string RespValue::toString() const {
   switch (type_) {
   case RespType::Array: {
@@ -28,7 +85,8 @@ std::string RespValue::toString() const {
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error:
-    return fmt::format("\"{}\"", asString());
+    // Not flattening a buffered payload, as this is only used for logging.
+    return fmt::format("\"{}\"", hasBuffer() ? buffer_->toString() : string_);
   case RespType::Null:
     return "null";
   case RespType::Integer:
@@ -51,15 +109,38 @@ const std::vector<RespValue>& RespValue::asArray() const {
 std::string& RespValue::asString() {
   ASSERT(type_ == RespType::BulkString || type_ == RespType::Error ||
          type_ == RespType::SimpleString);
+  flattenBuffer();
   return string_;
 }
 
 const std::string& RespValue::asString() const {
   ASSERT(type_ == RespType::BulkString || type_ == RespType::Error ||
          type_ == RespType::SimpleString);
+  flattenBuffer();
   return string_;
 }
 
+Buffer::Instance& RespValue::asBuffer() {
+  ASSERT(type_ == RespType::BulkString);
+  if (buffer_ == nullptr) {
+    buffer_ = std::make_shared<Buffer::OwnedImpl>(string_);
+    string_.clear();
+  }
+  return *buffer_;
+}
+
+const std::shared_ptr<Buffer::Instance>& RespValue::sharedBuffer() const {
+  ASSERT(hasBuffer());
+  return buffer_;
+}
+
+void RespValue::flattenBuffer() const {
+  if (buffer_ != nullptr) {
+    string_ = buffer_->toString();
+    buffer_.reset();
+  }
+}
+
 int64_t& RespValue::asInteger() {
   ASSERT(type_ == RespType::Integer);
   return integer_;
@@ -71,6 +152,8 @@ int64_t RespValue::asInteger() const {
 }
 
 void RespValue::cleanup() {
+  buffer_.reset();
+
   // Need to manually delete because of the union.
   switch (type_) {
   case RespType::Array: {
@@ -114,17 +197,35 @@ void RespValue::type(RespType type) {
 }
 
 void DecoderImpl::decode(Buffer::Instance& data) {
-  uint64_t num_slices = data.getRawSlices(nullptr, 0);
-  Buffer::RawSlice slices[num_slices];
-  data.getRawSlices(slices, num_slices);
-  for (const Buffer::RawSlice& slice : slices) {
-    parseSlice(slice);
-  }
+  while (data.length() > 0) {
+    if (state_ == State::BulkStringBody && pending_value_stack_.front().value_->hasBuffer()) {
+      uint64_t length = std::min(pending_integer_.integer_, data.length());
+      pending_value_stack_.front().value_->asBuffer().move(data, length);
+      pending_integer_.integer_ -= length;
+      if (pending_integer_.integer_ == 0) {
+        state_ = State::CR;
+      }
+      continue;
+    }
+
+    uint64_t num_slices = data.getRawSlices(nullptr, 0);
+    Buffer::RawSlice slices[num_slices];
+    data.getRawSlices(slices, num_slices);
+    uint64_t parsed = 0;
+    for (const Buffer::RawSlice& slice : slices) {
+      const uint64_t slice_parsed = parseSlice(slice);
+      parsed += slice_parsed;
+      if (slice_parsed < slice.len_) {
+        // Stopped at the payload of a buffered bulk string, which is moved out of data above.
+        break;
+      }
+    }
 
-  data.drain(data.length());
+    data.drain(parsed);
+  }
 }
 
-void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
+uint64_t DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
   const char* buffer = reinterpret_cast<const char*>(slice.mem_);
   uint64_t remaining = slice.len_;
 
@@ -244,6 +345,9 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
         ASSERT(current_value.value_->type() == RespType::BulkString);
         if (!pending_integer_.negative_) {
           // TODO(mattklein123): reserve and define max length since we don't stream currently.
+          if (pending_integer_.integer_ >= MinBufferedBulkStringSize) {
+            current_value.value_->asBuffer();
+          }
           state_ = State::BulkStringBody;
         } else {
           // Null bulk string. Switch type to null and move to value complete.
@@ -257,6 +361,9 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
 
     case State::BulkStringBody: {
       ASSERT(!pending_integer_.negative_);
+      if (pending_value_stack_.front().value_->hasBuffer()) {
+        return slice.len_ - remaining;
+      }
       uint64_t length_to_copy =
           std::min(static_cast<uint64_t>(pending_integer_.integer_), remaining);
       pending_value_stack_.front().value_->asString().append(buffer, length_to_copy);
@@ -332,6 +439,8 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
     }
     }
   }
+
+  return slice.len_;
 }
 
 void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
@@ -345,7 +454,11 @@ void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
     break;
   }
   case RespType::BulkString: {
-    encodeBulkString(value.asString(), out);
+    if (value.hasBuffer()) {
+      encodeBulkBuffer(value.sharedBuffer(), out);
+    } else {
+      encodeBulkString(value.asString(), out);
+    }
     break;
   }
   case RespType::Error: {
@@ -376,16 +489,34 @@ void EncoderImpl::encodeArray(const std::vector<RespValue>& array, Buffer::Insta
   }
 }
 
+void EncoderImpl::encodeBulkBuffer(const std::shared_ptr<Buffer::Instance>& bulk_buffer,
+                                   Buffer::Instance& out) {
+  encodeBulkStringLength(bulk_buffer->length(), out);
+  uint64_t num_slices = bulk_buffer->getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  bulk_buffer->getRawSlices(slices, num_slices);
+  for (const Buffer::RawSlice& slice : slices) {
+    if (slice.len_ > 0) {
+      out.addBufferFragment(*new BulkStringFragment(bulk_buffer, slice));
+    }
+  }
+  out.add("\r\n", 2);
+}
+
 void EncoderImpl::encodeBulkString(const std::string& string, Buffer::Instance& out) {
+  encodeBulkStringLength(string.size(), out);
+  out.add(string);
+  out.add("\r\n", 2);
+}
+
+void EncoderImpl::encodeBulkStringLength(uint64_t length, Buffer::Instance& out) {
   char buffer[32];
   char* current = buffer;
   *current++ = '$';
-  current += StringUtil::itoa(current, 31, string.size());
+  current += StringUtil::itoa(current, 31, length);
   *current++ = '\r';
   *current++ = '\n';
   out.add(buffer, current - buffer);
-  out.add(string);
-  out.add("\r\n", 2);
 }
 
 void EncoderImpl::encodeError(const std::string& string, Buffer::Instance& out) {
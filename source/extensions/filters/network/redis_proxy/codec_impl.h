@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <forward_list>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -18,6 +19,8 @@ namespace RedisProxy {
  * Decoder implementation of https://redis.io/topics/protocol
  *
  * This implementation buffers when needed and will always consume all bytes passed for decoding.
+ * Large bulk string payloads are moved out of the decoded buffer rather than copied, see
+ * RespValue::hasBuffer().
  */
 class DecoderImpl : public Decoder, Logger::Loggable<Logger::Id::redis> {
 public:
@@ -55,7 +58,11 @@ private:
     uint64_t current_array_element_;
   };
 
-  void parseSlice(const Buffer::RawSlice& slice);
+  /**
+   * @return uint64_t the number of bytes of the slice that were parsed. Parsing stops early at the
+   *         payload of a bulk string that is held in a buffer, which is moved instead.
+   */
+  uint64_t parseSlice(const Buffer::RawSlice& slice);
 
   DecoderCallbacks& callbacks_;
   State state_{State::ValueRootStart};
@@ -85,7 +92,10 @@ public:
 
 private:
   void encodeArray(const std::vector<RespValue>& array, Buffer::Instance& out);
+  void encodeBulkBuffer(const std::shared_ptr<Buffer::Instance>& bulk_buffer,
+                        Buffer::Instance& out);
   void encodeBulkString(const std::string& string, Buffer::Instance& out);
+  void encodeBulkStringLength(uint64_t length, Buffer::Instance& out);
   void encodeError(const std::string& string, Buffer::Instance& out);
   void encodeInteger(int64_t integer, Buffer::Instance& out);
   void encodeSimpleString(const std::string& string, Buffer::Instance& out);
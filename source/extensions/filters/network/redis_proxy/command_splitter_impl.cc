@@ -12,6 +12,8 @@
 
 #include "extensions/filters/network/redis_proxy/supported_commands.h"
 
+#include "absl/strings/numbers.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
@@ -48,11 +50,20 @@ void SingleServerRequest::cancel() {
   handle_ = nullptr;
 }
 
-SplitRequestPtr SimpleRequest::create(ConnPool::Instance& conn_pool,
+SplitRequestPtr SimpleRequest::create(ConnPool::Instance& conn_pool, ResponseCache* cache,
                                       const RespValue& incoming_request,
                                       SplitCallbacks& callbacks) {
   std::unique_ptr<SimpleRequest> request_ptr{new SimpleRequest(callbacks)};
 
+  if (cache && cache->cached(incoming_request.asArray()[0].asString())) {
+    RespValuePtr response = cache->lookup(incoming_request, request_ptr->cache_key_);
+    if (response) {
+      callbacks.onResponse(std::move(response));
+      return nullptr;
+    }
+    request_ptr->cache_ = cache;
+  }
+
   request_ptr->handle_ = conn_pool.makeRequest(incoming_request.asArray()[1].asString(),
                                                incoming_request, *request_ptr);
   if (!request_ptr->handle_) {
@@ -63,7 +74,14 @@ SplitRequestPtr SimpleRequest::create(ConnPool::Instance& conn_pool,
   return std::move(request_ptr);
 }
 
-SplitRequestPtr EvalRequest::create(ConnPool::Instance& conn_pool,
+void SimpleRequest::onResponse(RespValuePtr&& response) {
+  if (cache_) {
+    cache_->insert(cache_key_, *response);
+  }
+  SingleServerRequest::onResponse(std::move(response));
+}
+
+SplitRequestPtr EvalRequest::create(ConnPool::Instance& conn_pool, ResponseCache*,
                                     const RespValue& incoming_request, SplitCallbacks& callbacks) {
 
   // EVAL looks like: EVAL script numkeys key [key ...] arg [arg ...]
@@ -105,34 +123,94 @@ void FragmentedRequest::onChildFailure(uint32_t index) {
   onChildResponse(Utility::makeError("upstream failure"), index);
 }
 
-SplitRequestPtr MGETRequest::create(ConnPool::Instance& conn_pool,
+std::vector<std::vector<uint32_t>>
+FragmentedRequest::groupByShard(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
+                                const std::vector<uint32_t>& key_args) {
+  std::vector<std::vector<uint32_t>> groups;
+  std::unordered_map<std::string, uint64_t> group_by_shard;
+  for (const uint32_t key_arg : key_args) {
+    const std::string shard = conn_pool.shardForKey(incoming_request.asArray()[key_arg].asString());
+    if (shard.empty()) {
+      // Keys without a known shard are sent on their own.
+      groups.push_back({key_arg});
+      continue;
+    }
+
+    auto it = group_by_shard.emplace(shard, groups.size()).first;
+    if (it->second == groups.size()) {
+      groups.emplace_back();
+    }
+    groups[it->second].push_back(key_arg);
+  }
+  return groups;
+}
+
+SplitRequestPtr MGETRequest::create(ConnPool::Instance& conn_pool, ResponseCache* cache,
                                     const RespValue& incoming_request, SplitCallbacks& callbacks) {
   std::unique_ptr<MGETRequest> request_ptr{new MGETRequest(callbacks)};
-
-  request_ptr->num_pending_responses_ = incoming_request.asArray().size() - 1;
-  request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
+  const std::vector<RespValue>& args = incoming_request.asArray();
 
   request_ptr->pending_response_.reset(new RespValue());
   request_ptr->pending_response_->type(RespType::Array);
-  std::vector<RespValue> responses(request_ptr->num_pending_responses_);
+  std::vector<RespValue> responses(args.size() - 1);
   request_ptr->pending_response_->asArray().swap(responses);
 
   std::vector<RespValue> values(2);
   values[0].type(RespType::BulkString);
   values[0].asString() = "get";
   values[1].type(RespType::BulkString);
-  RespValue single_mget;
-  single_mget.type(RespType::Array);
-  single_mget.asArray().swap(values);
+  RespValue single_get;
+  single_get.type(RespType::Array);
+  single_get.asArray().swap(values);
+
+  if (cache && cache->cached(single_get.asArray()[0].asString())) {
+    request_ptr->cache_ = cache;
+    request_ptr->cache_keys_.resize(args.size() - 1);
+  }
 
-  for (uint64_t i = 1; i < incoming_request.asArray().size(); i++) {
-    request_ptr->pending_requests_.emplace_back(*request_ptr, i - 1);
+  std::vector<uint32_t> key_args;
+  for (uint32_t i = 1; i < args.size(); i++) {
+    if (request_ptr->cache_) {
+      single_get.asArray()[1].asString() = args[i].asString();
+      RespValuePtr response = cache->lookup(single_get, request_ptr->cache_keys_[i - 1]);
+      if (response) {
+        request_ptr->onKeyResponse(*response, i - 1);
+        continue;
+      }
+    }
+    key_args.push_back(i);
+  }
+
+  const std::vector<std::vector<uint32_t>> groups =
+      groupByShard(conn_pool, incoming_request, key_args);
+  request_ptr->num_pending_responses_ = groups.size();
+  request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
+  if (request_ptr->num_pending_responses_ == 0) {
+    callbacks.onResponse(std::move(request_ptr->pending_response_));
+    return nullptr;
+  }
+
+  for (const std::vector<uint32_t>& group : groups) {
+    request_ptr->pending_requests_.emplace_back(*request_ptr,
+                                                request_ptr->pending_requests_.size());
     PendingRequest& pending_request = request_ptr->pending_requests_.back();
+    pending_request.key_args_ = group;
+
+    // A single key is sent as a GET, whose response can be cached.
+    RespValue request;
+    request.type(RespType::Array);
+    request.asArray().reserve(group.size() + 1);
+    request.asArray().emplace_back();
+    request.asArray().back().type(RespType::BulkString);
+    request.asArray().back().asString() = group.size() > 1 ? "mget" : "get";
+    for (const uint32_t key_arg : group) {
+      request.asArray().push_back(args[key_arg]);
+    }
 
-    single_mget.asArray()[1].asString() = incoming_request.asArray()[i].asString();
-    ENVOY_LOG(debug, "redis: parallel get: '{}'", single_mget.toString());
-    pending_request.handle_ = conn_pool.makeRequest(incoming_request.asArray()[i].asString(),
-                                                    single_mget, pending_request);
+    ENVOY_LOG(debug, "redis: parallel {}: '{}'", request.asArray()[0].asString(),
+              request.toString());
+    pending_request.handle_ =
+        conn_pool.makeRequest(args[group.front()].asString(), request, pending_request);
     if (!pending_request.handle_) {
       pending_request.onResponse(Utility::makeError("no upstream host"));
     }
@@ -142,15 +220,57 @@ SplitRequestPtr MGETRequest::create(ConnPool::Instance& conn_pool,
 }
 
 void MGETRequest::onChildResponse(RespValuePtr&& value, uint32_t index) {
-  pending_requests_[index].handle_ = nullptr;
+  PendingRequest& pending_request = pending_requests_[index];
+  const std::vector<uint32_t>& key_args = pending_request.key_args_;
 
-  pending_response_->asArray()[index].type(value->type());
-  switch (value->type()) {
+  if (key_args.size() == 1) {
+    // Only responses from upstream are cached, not local errors.
+    if (cache_ && pending_request.handle_) {
+      cache_->insert(cache_keys_[key_args[0] - 1], *value);
+    }
+    onKeyResponse(*value, key_args[0] - 1);
+  } else if (value->type() == RespType::Array && value->asArray().size() == key_args.size()) {
+    for (uint64_t i = 0; i < key_args.size(); i++) {
+      RespValue& key_value = value->asArray()[i];
+      // MGET also returns a null for a key that does not hold a string, to which GET returns an
+      // error, so only strings are cached.
+      if (cache_ && key_value.type() == RespType::BulkString) {
+        cache_->insert(cache_keys_[key_args[i] - 1], key_value);
+      }
+      if (key_value.type() == RespType::Error) {
+        // An MGET never returns errors within its response.
+        key_value.type(RespType::Integer);
+      }
+      onKeyResponse(key_value, key_args[i] - 1);
+    }
+  } else {
+    // An error, such as a failure, applies to every key. Other responses are protocol errors.
+    if (value->type() != RespType::Error) {
+      value->type(RespType::Integer);
+    }
+    for (const uint32_t key_arg : key_args) {
+      RespValue key_value(*value);
+      onKeyResponse(key_value, key_arg - 1);
+    }
+  }
+  pending_request.handle_ = nullptr;
+
+  ASSERT(num_pending_responses_ > 0);
+  if (--num_pending_responses_ == 0) {
+    ENVOY_LOG(debug, "redis: response: '{}'", pending_response_->toString());
+    callbacks_.onResponse(std::move(pending_response_));
+  }
+}
+
+void MGETRequest::onKeyResponse(RespValue& value, uint32_t key_index) {
+  RespValue& response = pending_response_->asArray()[key_index];
+  response.type(value.type());
+  switch (value.type()) {
   case RespType::Array:
   case RespType::Integer:
   case RespType::SimpleString: {
-    pending_response_->asArray()[index].type(RespType::Error);
-    pending_response_->asArray()[index].asString() = "upstream protocol error";
+    response.type(RespType::Error);
+    response.asString() = "upstream protocol error";
     error_count_++;
     break;
   }
@@ -159,55 +279,61 @@ void MGETRequest::onChildResponse(RespValuePtr&& value, uint32_t index) {
     FALLTHRU;
   }
   case RespType::BulkString: {
-    pending_response_->asArray()[index].asString().swap(value->asString());
+    if (value.hasBuffer()) {
+      response.asBuffer().move(value.asBuffer());
+    } else {
+      response.asString().swap(value.asString());
+    }
     break;
   }
   case RespType::Null:
     break;
   }
-
-  ASSERT(num_pending_responses_ > 0);
-  if (--num_pending_responses_ == 0) {
-    ENVOY_LOG(debug, "redis: response: '{}'", pending_response_->toString());
-    callbacks_.onResponse(std::move(pending_response_));
-  }
 }
 
-SplitRequestPtr MSETRequest::create(ConnPool::Instance& conn_pool,
+SplitRequestPtr MSETRequest::create(ConnPool::Instance& conn_pool, ResponseCache*,
                                     const RespValue& incoming_request, SplitCallbacks& callbacks) {
-  if ((incoming_request.asArray().size() - 1) % 2 != 0) {
+  const std::vector<RespValue>& args = incoming_request.asArray();
+  if ((args.size() - 1) % 2 != 0) {
     onWrongNumberOfArguments(callbacks, incoming_request);
     return nullptr;
   }
 
   std::unique_ptr<MSETRequest> request_ptr{new MSETRequest(callbacks)};
 
-  request_ptr->num_pending_responses_ = (incoming_request.asArray().size() - 1) / 2;
+  std::vector<uint32_t> key_args;
+  for (uint32_t i = 1; i < args.size(); i += 2) {
+    key_args.push_back(i);
+  }
+  const std::vector<std::vector<uint32_t>> groups =
+      groupByShard(conn_pool, incoming_request, key_args);
+  request_ptr->num_pending_responses_ = groups.size();
   request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
 
   request_ptr->pending_response_.reset(new RespValue());
   request_ptr->pending_response_->type(RespType::SimpleString);
 
-  std::vector<RespValue> values(3);
-  values[0].type(RespType::BulkString);
-  values[0].asString() = "set";
-  values[1].type(RespType::BulkString);
-  values[2].type(RespType::BulkString);
-  RespValue single_mset;
-  single_mset.type(RespType::Array);
-  single_mset.asArray().swap(values);
-
-  uint64_t fragment_index = 0;
-  for (uint64_t i = 1; i < incoming_request.asArray().size(); i += 2) {
-    request_ptr->pending_requests_.emplace_back(*request_ptr, fragment_index++);
+  for (const std::vector<uint32_t>& group : groups) {
+    request_ptr->pending_requests_.emplace_back(*request_ptr,
+                                                request_ptr->pending_requests_.size());
     PendingRequest& pending_request = request_ptr->pending_requests_.back();
+    pending_request.key_args_ = group;
+
+    RespValue request;
+    request.type(RespType::Array);
+    request.asArray().reserve(group.size() * 2 + 1);
+    request.asArray().emplace_back();
+    request.asArray().back().type(RespType::BulkString);
+    request.asArray().back().asString() = group.size() > 1 ? "mset" : "set";
+    for (const uint32_t key_arg : group) {
+      request.asArray().push_back(args[key_arg]);
+      request.asArray().push_back(args[key_arg + 1]);
+    }
 
-    single_mset.asArray()[1].asString() = incoming_request.asArray()[i].asString();
-    single_mset.asArray()[2].asString() = incoming_request.asArray()[i + 1].asString();
-
-    ENVOY_LOG(debug, "redis: parallel set: '{}'", single_mset.toString());
-    pending_request.handle_ = conn_pool.makeRequest(incoming_request.asArray()[i].asString(),
-                                                    single_mset, pending_request);
+    ENVOY_LOG(debug, "redis: parallel {}: '{}'", request.asArray()[0].asString(),
+              request.toString());
+    pending_request.handle_ =
+        conn_pool.makeRequest(args[group.front()].asString(), request, pending_request);
     if (!pending_request.handle_) {
       pending_request.onResponse(Utility::makeError("no upstream host"));
     }
@@ -244,34 +370,41 @@ void MSETRequest::onChildResponse(RespValuePtr&& value, uint32_t index) {
   }
 }
 
-SplitRequestPtr SplitKeysSumResultRequest::create(ConnPool::Instance& conn_pool,
+SplitRequestPtr SplitKeysSumResultRequest::create(ConnPool::Instance& conn_pool, ResponseCache*,
                                                   const RespValue& incoming_request,
                                                   SplitCallbacks& callbacks) {
   std::unique_ptr<SplitKeysSumResultRequest> request_ptr{new SplitKeysSumResultRequest(callbacks)};
+  const std::vector<RespValue>& args = incoming_request.asArray();
 
-  request_ptr->num_pending_responses_ = incoming_request.asArray().size() - 1;
+  std::vector<uint32_t> key_args;
+  for (uint32_t i = 1; i < args.size(); i++) {
+    key_args.push_back(i);
+  }
+  const std::vector<std::vector<uint32_t>> groups =
+      groupByShard(conn_pool, incoming_request, key_args);
+  request_ptr->num_pending_responses_ = groups.size();
   request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
 
   request_ptr->pending_response_.reset(new RespValue());
   request_ptr->pending_response_->type(RespType::Integer);
 
-  std::vector<RespValue> values(2);
-  values[0].type(RespType::BulkString);
-  values[0].asString() = incoming_request.asArray()[0].asString();
-  values[1].type(RespType::BulkString);
-  RespValue single_fragment;
-  single_fragment.type(RespType::Array);
-  single_fragment.asArray().swap(values);
-
-  for (uint64_t i = 1; i < incoming_request.asArray().size(); i++) {
-    request_ptr->pending_requests_.emplace_back(*request_ptr, i - 1);
+  for (const std::vector<uint32_t>& group : groups) {
+    request_ptr->pending_requests_.emplace_back(*request_ptr,
+                                                request_ptr->pending_requests_.size());
     PendingRequest& pending_request = request_ptr->pending_requests_.back();
+    pending_request.key_args_ = group;
+
+    RespValue request;
+    request.type(RespType::Array);
+    request.asArray().reserve(group.size() + 1);
+    request.asArray().push_back(args[0]);
+    for (const uint32_t key_arg : group) {
+      request.asArray().push_back(args[key_arg]);
+    }
 
-    single_fragment.asArray()[1].asString() = incoming_request.asArray()[i].asString();
-    ENVOY_LOG(debug, "redis: parallel {}: '{}'", incoming_request.asArray()[0].asString(),
-              single_fragment.toString());
-    pending_request.handle_ = conn_pool.makeRequest(incoming_request.asArray()[i].asString(),
-                                                    single_fragment, pending_request);
+    ENVOY_LOG(debug, "redis: parallel {}: '{}'", args[0].asString(), request.toString());
+    pending_request.handle_ =
+        conn_pool.makeRequest(args[group.front()].asString(), request, pending_request);
     if (!pending_request.handle_) {
       pending_request.onResponse(Utility::makeError("no upstream host"));
     }
@@ -306,11 +439,13 @@ void SplitKeysSumResultRequest::onChildResponse(RespValuePtr&& value, uint32_t i
   }
 }
 
-InstanceImpl::InstanceImpl(ConnPool::InstancePtr&& conn_pool, Stats::Scope& scope,
-                           const std::string& stat_prefix)
-    : conn_pool_(std::move(conn_pool)), simple_command_handler_(*conn_pool_),
-      eval_command_handler_(*conn_pool_), mget_handler_(*conn_pool_), mset_handler_(*conn_pool_),
-      split_keys_sum_result_handler_(*conn_pool_),
+InstanceImpl::InstanceImpl(ConnPool::InstancePtr&& conn_pool, ResponseCachePtr&& cache,
+                           Stats::Scope& scope, const std::string& stat_prefix)
+    : conn_pool_(std::move(conn_pool)), cache_(std::move(cache)),
+      simple_command_handler_(*conn_pool_, cache_.get()),
+      eval_command_handler_(*conn_pool_, cache_.get()), mget_handler_(*conn_pool_, cache_.get()),
+      mset_handler_(*conn_pool_, cache_.get()),
+      split_keys_sum_result_handler_(*conn_pool_, cache_.get()),
       stats_{ALL_COMMAND_SPLITTER_STATS(POOL_COUNTER_PREFIX(scope, stat_prefix + "splitter."))} {
   // TODO(mattklein123) PERF: Make this a trie (like in header_map_impl).
   for (const std::string& command : SupportedCommands::simpleCommands()) {
@@ -370,6 +505,9 @@ SplitRequestPtr InstanceImpl::makeRequest(const RespValue& request, SplitCallbac
 
   ENVOY_LOG(debug, "redis: splitting '{}'", request.toString());
   handler->second.total_.inc();
+  if (cache_ && SupportedCommands::readOnlyCommands().count(to_lower_string) == 0) {
+    invalidateKeys(request, handler->second.handler_.get());
+  }
   return handler->second.handler_.get().startRequest(request, callbacks);
 }
 
@@ -378,6 +516,29 @@ void InstanceImpl::onInvalidRequest(SplitCallbacks& callbacks) {
   callbacks.onResponse(Utility::makeError("invalid request"));
 }
 
+void InstanceImpl::invalidateKeys(const RespValue& request, const CommandHandler& handler) {
+  const std::vector<RespValue>& args = request.asArray();
+  if (&handler == &simple_command_handler_) {
+    cache_->invalidate(args[1].asString());
+  } else if (&handler == &eval_command_handler_) {
+    // EVAL script numkeys key [key ...] arg [arg ...]
+    uint64_t num_keys;
+    if (absl::SimpleAtoi(args[2].asString(), &num_keys)) {
+      for (uint64_t i = 3; i < args.size() && i - 3 < num_keys; i++) {
+        cache_->invalidate(args[i].asString());
+      }
+    }
+  } else if (&handler == &mset_handler_) {
+    for (uint64_t i = 1; i < args.size(); i += 2) {
+      cache_->invalidate(args[i].asString());
+    }
+  } else {
+    for (uint64_t i = 1; i < args.size(); i++) {
+      cache_->invalidate(args[i].asString());
+    }
+  }
+}
+
 void InstanceImpl::addHandler(Stats::Scope& scope, const std::string& stat_prefix,
                               const std::string& name, CommandHandler& handler) {
   std::string to_lower_name(name);
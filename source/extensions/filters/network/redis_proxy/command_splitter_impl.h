@@ -12,6 +12,7 @@
 
 #include "extensions/filters/network/redis_proxy/command_splitter.h"
 #include "extensions/filters/network/redis_proxy/conn_pool.h"
+#include "extensions/filters/network/redis_proxy/response_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -33,9 +34,11 @@ public:
 
 class CommandHandlerBase {
 protected:
-  CommandHandlerBase(ConnPool::Instance& conn_pool) : conn_pool_(conn_pool) {}
+  CommandHandlerBase(ConnPool::Instance& conn_pool, ResponseCache* cache)
+      : conn_pool_(conn_pool), cache_(cache) {}
 
   ConnPool::Instance& conn_pool_;
+  ResponseCache* cache_;
 };
 
 class SplitRequestBase : public SplitRequest {
@@ -65,15 +68,23 @@ protected:
 };
 
 /**
- * SimpleRequest hashes the first argument as the key.
+ * SimpleRequest hashes the first argument as the key. Responses to cached commands are served
+ * from the response cache when possible.
  */
 class SimpleRequest : public SingleServerRequest {
 public:
-  static SplitRequestPtr create(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
-                                SplitCallbacks& callbacks);
+  static SplitRequestPtr create(ConnPool::Instance& conn_pool, ResponseCache* cache,
+                                const RespValue& incoming_request, SplitCallbacks& callbacks);
+
+  // RedisProxy::ConnPool::PoolCallbacks
+  void onResponse(RespValuePtr&& response) override;
 
 private:
   SimpleRequest(SplitCallbacks& callbacks) : SingleServerRequest(callbacks) {}
+
+  // Set when the response is to be cached.
+  ResponseCache* cache_{};
+  ResponseCache::Key cache_key_;
 };
 
 /**
@@ -81,17 +92,17 @@ private:
  */
 class EvalRequest : public SingleServerRequest {
 public:
-  static SplitRequestPtr create(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
-                                SplitCallbacks& callbacks);
+  static SplitRequestPtr create(ConnPool::Instance& conn_pool, ResponseCache* cache,
+                                const RespValue& incoming_request, SplitCallbacks& callbacks);
 
 private:
   EvalRequest(SplitCallbacks& callbacks) : SingleServerRequest(callbacks) {}
 };
 
 /**
- * FragmentedRequest is a base class for requests that contains multiple keys. An individual request
- * is sent to the appropriate server for each key. The responses from all servers are combined and
- * returned to the client.
+ * FragmentedRequest is a base class for requests that contains multiple keys. The keys are grouped
+ * by the shard that they hash to, and an individual request is sent to the appropriate server for
+ * each group. The responses from all servers are combined and returned to the client.
  */
 class FragmentedRequest : public SplitRequestBase {
 public:
@@ -115,8 +126,21 @@ protected:
     FragmentedRequest& parent_;
     const uint32_t index_;
     ConnPool::PoolRequest* handle_{};
+    // The indexes in the incoming request of the keys sent by this request.
+    std::vector<uint32_t> key_args_;
   };
 
+  /**
+   * Group keys by the shard that they hash to, keeping their order within each group.
+   * @param conn_pool supplies the connection pool that the requests are sent to.
+   * @param incoming_request supplies the incoming request.
+   * @param key_args supplies the indexes in the incoming request of the keys to group.
+   * @return std::vector<std::vector<uint32_t>> the indexes of the keys of each group.
+   */
+  static std::vector<std::vector<uint32_t>> groupByShard(ConnPool::Instance& conn_pool,
+                                                         const RespValue& incoming_request,
+                                                         const std::vector<uint32_t>& key_args);
+
   virtual void onChildResponse(RespValuePtr&& value, uint32_t index) PURE;
   void onChildFailure(uint32_t index);
 
@@ -128,31 +152,38 @@ protected:
 };
 
 /**
- * MGETRequest takes each key from the command and sends a GET for each to the appropriate Redis
- * server. The response contains the result from each command.
+ * MGETRequest takes the keys from the command whose responses are not cached, and sends an MGET
+ * with the keys of each shard, or a GET for a single key, to the appropriate Redis server. The
+ * response contains the result for each key.
  */
 class MGETRequest : public FragmentedRequest, Logger::Loggable<Logger::Id::redis> {
 public:
-  static SplitRequestPtr create(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
-                                SplitCallbacks& callbacks);
+  static SplitRequestPtr create(ConnPool::Instance& conn_pool, ResponseCache* cache,
+                                const RespValue& incoming_request, SplitCallbacks& callbacks);
 
 private:
   MGETRequest(SplitCallbacks& callbacks) : FragmentedRequest(callbacks) {}
 
   // RedisProxy::CommandSplitter::FragmentedRequest
   void onChildResponse(RespValuePtr&& value, uint32_t index) override;
+
+  void onKeyResponse(RespValue& value, uint32_t key_index);
+
+  // Set when the responses to the GETs are to be cached.
+  ResponseCache* cache_{};
+  std::vector<ResponseCache::Key> cache_keys_;
 };
 
 /**
- * SplitKeysSumResultRequest takes each key from the command and sends the same incoming command
- * with each key to the appropriate Redis server. The response from each Redis (which must be an
- * integer) is summed and returned to the user. If there is any error or failure in processing the
- * fragmented commands, an error will be returned.
+ * SplitKeysSumResultRequest groups the keys from the command by shard and sends the same incoming
+ * command with the keys of each shard to the appropriate Redis server. The response from each Redis
+ * (which must be an integer) is summed and returned to the user. If there is any error or failure
+ * in processing the fragmented commands, an error will be returned.
  */
 class SplitKeysSumResultRequest : public FragmentedRequest, Logger::Loggable<Logger::Id::redis> {
 public:
-  static SplitRequestPtr create(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
-                                SplitCallbacks& callbacks);
+  static SplitRequestPtr create(ConnPool::Instance& conn_pool, ResponseCache* cache,
+                                const RespValue& incoming_request, SplitCallbacks& callbacks);
 
 private:
   SplitKeysSumResultRequest(SplitCallbacks& callbacks) : FragmentedRequest(callbacks) {}
@@ -164,14 +195,14 @@ private:
 };
 
 /**
- * MSETRequest takes each key and value pair from the command and sends a SET for each to the
- * appropriate Redis server. The response is an OK if all commands succeeded or an ERR if any
- * failed.
+ * MSETRequest groups the key and value pairs from the command by the shard of their key, and sends
+ * an MSET with the pairs of each shard, or a SET for a single pair, to the appropriate Redis
+ * server. The response is an OK if all commands succeeded or an ERR if any failed.
  */
 class MSETRequest : public FragmentedRequest, Logger::Loggable<Logger::Id::redis> {
 public:
-  static SplitRequestPtr create(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
-                                SplitCallbacks& callbacks);
+  static SplitRequestPtr create(ConnPool::Instance& conn_pool, ResponseCache* cache,
+                                const RespValue& incoming_request, SplitCallbacks& callbacks);
 
 private:
   MSETRequest(SplitCallbacks& callbacks) : FragmentedRequest(callbacks) {}
@@ -187,9 +218,10 @@ private:
 template <class RequestClass>
 class CommandHandlerFactory : public CommandHandler, CommandHandlerBase {
 public:
-  CommandHandlerFactory(ConnPool::Instance& conn_pool) : CommandHandlerBase(conn_pool) {}
+  CommandHandlerFactory(ConnPool::Instance& conn_pool, ResponseCache* cache)
+      : CommandHandlerBase(conn_pool, cache) {}
   SplitRequestPtr startRequest(const RespValue& request, SplitCallbacks& callbacks) {
-    return RequestClass::create(conn_pool_, request, callbacks);
+    return RequestClass::create(conn_pool_, cache_, request, callbacks);
   }
 };
 
@@ -211,7 +243,7 @@ struct InstanceStats {
 
 class InstanceImpl : public Instance, Logger::Loggable<Logger::Id::redis> {
 public:
-  InstanceImpl(ConnPool::InstancePtr&& conn_pool, Stats::Scope& scope,
+  InstanceImpl(ConnPool::InstancePtr&& conn_pool, ResponseCachePtr&& cache, Stats::Scope& scope,
                const std::string& stat_prefix);
 
   // RedisProxy::CommandSplitter::Instance
@@ -226,8 +258,10 @@ private:
   void addHandler(Stats::Scope& scope, const std::string& stat_prefix, const std::string& name,
                   CommandHandler& handler);
   void onInvalidRequest(SplitCallbacks& callbacks);
+  void invalidateKeys(const RespValue& request, const CommandHandler& handler);
 
   ConnPool::InstancePtr conn_pool_;
+  ResponseCachePtr cache_;
   CommandHandlerFactory<SimpleRequest> simple_command_handler_;
   CommandHandlerFactory<EvalRequest> eval_command_handler_;
   CommandHandlerFactory<MGETRequest> mget_handler_;
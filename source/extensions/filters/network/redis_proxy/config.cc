@@ -12,6 +12,7 @@
 #include "extensions/filters/network/redis_proxy/command_splitter_impl.h"
 #include "extensions/filters/network/redis_proxy/conn_pool_impl.h"
 #include "extensions/filters/network/redis_proxy/proxy_filter.h"
+#include "extensions/filters/network/redis_proxy/response_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -32,8 +33,14 @@ Network::FilterFactoryCb RedisProxyFilterConfigFactory::createFilterFactoryFromP
   ConnPool::InstancePtr conn_pool(new ConnPool::InstanceImpl(
       filter_config->cluster_name_, context.clusterManager(),
       ConnPool::ClientFactoryImpl::instance_, context.threadLocal(), proto_config.settings()));
+  CommandSplitter::ResponseCachePtr cache;
+  if (proto_config.has_response_cache()) {
+    cache.reset(new CommandSplitter::ResponseCache(proto_config.response_cache(),
+                                                   context.threadLocal(), context.timeSource(),
+                                                   context.scope(), filter_config->stat_prefix_));
+  }
   std::shared_ptr<CommandSplitter::Instance> splitter(new CommandSplitter::InstanceImpl(
-      std::move(conn_pool), context.scope(), filter_config->stat_prefix_));
+      std::move(conn_pool), std::move(cache), context.scope(), filter_config->stat_prefix_));
   return [splitter, filter_config](Network::FilterManager& filter_manager) -> void {
     DecoderFactoryImpl factory;
     filter_manager.addReadFilter(std::make_shared<ProxyFilter>(
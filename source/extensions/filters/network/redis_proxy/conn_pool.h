@@ -71,6 +71,13 @@ public:
    *         for some reason.
    */
   virtual PoolRequest* makeRequest(const RespValue& request, PoolCallbacks& callbacks) PURE;
+
+  /**
+   * @return double the expected cost of a request to the remote redis server: the peak weighted
+   *         moving average of the response times in microseconds, decaying while no responses are
+   *         received, multiplied by one more than the number of requests awaiting a response.
+   */
+  virtual double latencyCost() PURE;
 };
 
 typedef std::unique_ptr<Client> ClientPtr;
@@ -132,6 +139,15 @@ public:
    */
   virtual PoolRequest* makeRequest(const std::string& hash_key, const RespValue& request,
                                    PoolCallbacks& callbacks) PURE;
+
+  /**
+   * Identifies the shard that a request would be sent to, so that the keys of a multi key command
+   * can be grouped into a single request per shard.
+   * @param hash_key supplies the key to use for consistent hashing.
+   * @return std::string an identifier of the shard, which is the same for all the keys that can be
+   *         sent in a single request, or an empty string if the shard is unknown.
+   */
+  virtual std::string shardForKey(const std::string& hash_key) PURE;
 };
 
 typedef std::unique_ptr<Instance> InstancePtr;
@@ -1,5 +1,6 @@
 #include "extensions/filters/network/redis_proxy/conn_pool_impl.h"
 
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -7,12 +8,22 @@
 
 #include "common/common/assert.h"
 
+#include "extensions/filters/network/redis_proxy/supported_commands.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
 namespace RedisProxy {
 namespace ConnPool {
 
+namespace {
+
+// How quickly the latency of a client forgets a slow response once responses are fast again, or
+// while it receives none.
+constexpr double LatencyDecayMicroseconds = 10 * 1000 * 1000;
+
+} // namespace
+
 ConfigImpl::ConfigImpl(
     const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings& config)
     : op_timeout_(PROTOBUF_GET_MS_REQUIRED(config, op_timeout)) {}
@@ -33,9 +44,11 @@ ClientPtr ClientImpl::create(Upstream::HostConstSharedPtr host, Event::Dispatche
 
 ClientImpl::ClientImpl(Upstream::HostConstSharedPtr host, Event::Dispatcher& dispatcher,
                        EncoderPtr&& encoder, DecoderFactory& decoder_factory, const Config& config)
-    : host_(host), encoder_(std::move(encoder)), decoder_(decoder_factory.create(*this)),
-      config_(config),
-      connect_or_op_timer_(dispatcher.createTimer([this]() -> void { onConnectOrOpTimeout(); })) {
+    : host_(host), time_source_(dispatcher.timeSystem()), encoder_(std::move(encoder)),
+      decoder_(decoder_factory.create(*this)), config_(config),
+      connect_or_op_timer_(dispatcher.createTimer([this]() -> void { onConnectOrOpTimeout(); })),
+      flush_timer_(dispatcher.createTimer([this]() -> void { flushRequests(); })),
+      latency_updated_(time_source_.monotonicTime()) {
   host->cluster().stats().upstream_cx_total_.inc();
   host->stats().cx_total_.inc();
   host->cluster().stats().upstream_cx_active_.inc();
@@ -57,7 +70,15 @@ PoolRequest* ClientImpl::makeRequest(const RespValue& request, PoolCallbacks& ca
 
   pending_requests_.emplace_back(*this, callbacks);
   encoder_->encode(request, encoder_buffer_);
-  connection_->write(encoder_buffer_, false);
+
+  // Requests are written once per event loop iteration, so that the requests pipelined by all
+  // downstream connections during an iteration are written together. Writing each request to the
+  // connection separately would leave a slice per request in its write buffer, and so take up to
+  // one writev() per handful of requests.
+  if (!flush_pending_) {
+    flush_pending_ = true;
+    flush_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
 
   // Only boost the op timeout if:
   // - We are not already connected. Otherwise, we are governed by the connect timeout and the timer
@@ -72,6 +93,21 @@ PoolRequest* ClientImpl::makeRequest(const RespValue& request, PoolCallbacks& ca
   return &pending_requests_.back();
 }
 
+double ClientImpl::latencyCost() {
+  return latency_ * latencyWeight(time_source_.monotonicTime()) * (pending_requests_.size() + 1);
+}
+
+double ClientImpl::latencyWeight(MonotonicTime now) const {
+  const double elapsed =
+      std::chrono::duration_cast<std::chrono::microseconds>(now - latency_updated_).count();
+  return std::exp(-elapsed / LatencyDecayMicroseconds);
+}
+
+void ClientImpl::flushRequests() {
+  flush_pending_ = false;
+  connection_->write(encoder_buffer_, false);
+}
+
 void ClientImpl::onConnectOrOpTimeout() {
   putOutlierEvent(Upstream::Outlier::Result::TIMEOUT);
   if (connected_) {
@@ -127,6 +163,9 @@ void ClientImpl::onEvent(Network::ConnectionEvent event) {
     }
 
     connect_or_op_timer_->disableTimer();
+    flush_timer_->disableTimer();
+    flush_pending_ = false;
+    encoder_buffer_.drain(encoder_buffer_.length());
   } else if (event == Network::ConnectionEvent::Connected) {
     connected_ = true;
     ASSERT(!pending_requests_.empty());
@@ -142,6 +181,26 @@ void ClientImpl::onEvent(Network::ConnectionEvent event) {
 void ClientImpl::onRespValue(RespValuePtr&& value) {
   ASSERT(!pending_requests_.empty());
   PendingRequest& request = pending_requests_.front();
+
+  // A slow response raises the latency at once, so that slow servers are avoided quickly, while
+  // fast responses lower it gradually.
+  const MonotonicTime now = time_source_.monotonicTime();
+  const double response_time =
+      std::chrono::duration_cast<std::chrono::microseconds>(now - request.start_time_).count();
+  const double weight = latencyWeight(now);
+  if (response_time > latency_ * weight) {
+    latency_ = response_time;
+  } else {
+    latency_ = latency_ * weight + response_time * (1 - weight);
+  }
+  latency_updated_ = now;
+
+  if (value->type() == RespType::Error) {
+    host_->stats().rq_error_.inc();
+  } else {
+    host_->stats().rq_success_.inc();
+  }
+
   if (!request.canceled_) {
     request.callbacks_.onResponse(std::move(value));
   } else {
@@ -161,7 +220,8 @@ void ClientImpl::onRespValue(RespValuePtr&& value) {
 }
 
 ClientImpl::PendingRequest::PendingRequest(ClientImpl& parent, PoolCallbacks& callbacks)
-    : parent_(parent), callbacks_(callbacks) {
+    : parent_(parent), callbacks_(callbacks),
+      start_time_(parent.time_source_.monotonicTime()) {
   parent.host_->cluster().stats().upstream_rq_total_.inc();
   parent.host_->stats().rq_total_.inc();
   parent.host_->cluster().stats().upstream_rq_active_.inc();
@@ -188,11 +248,39 @@ ClientPtr ClientFactoryImpl::create(Upstream::HostConstSharedPtr host,
                             config);
 }
 
+namespace {
+
+// Redirections are normally followed once, or twice during resharding. More means a misconfigured
+// cluster, which the caller gets the error of.
+constexpr uint32_t MaxRedirections = 5;
+
+RespValue makeCommand(const std::vector<std::string>& arguments) {
+  RespValue command;
+  command.type(RespType::Array);
+  std::vector<RespValue> values(arguments.size());
+  for (uint64_t i = 0; i < arguments.size(); i++) {
+    values[i].type(RespType::BulkString);
+    values[i].asString() = arguments[i];
+  }
+  command.asArray().swap(values);
+  return command;
+}
+
+} // namespace
+
 InstanceImpl::InstanceImpl(
     const std::string& cluster_name, Upstream::ClusterManager& cm, ClientFactory& client_factory,
     ThreadLocal::SlotAllocator& tls,
     const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings& config)
-    : cm_(cm), client_factory_(client_factory), tls_(tls.allocateSlot()), config_(config) {
+    : cm_(cm), client_factory_(client_factory), config_(config),
+      redis_cluster_(config.has_redis_cluster()),
+      slots_refresh_interval_(
+          PROTOBUF_GET_MS_OR_DEFAULT(config.redis_cluster(), slots_refresh_interval, 10000)),
+      read_from_replicas_(config.redis_cluster().read_from_replicas()),
+      replica_selection_(config.redis_cluster().replica_selection()),
+      cluster_slots_request_(makeCommand({"CLUSTER", "SLOTS"})),
+      asking_request_(makeCommand({"ASKING"})), readonly_request_(makeCommand({"READONLY"})),
+      tls_(tls.allocateSlot()) {
   tls_->set([this, cluster_name](
                 Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     return std::make_shared<ThreadLocalPool>(*this, dispatcher, cluster_name);
@@ -204,9 +292,22 @@ PoolRequest* InstanceImpl::makeRequest(const std::string& hash_key, const RespVa
   return tls_->getTyped<ThreadLocalPool>().makeRequest(hash_key, value, callbacks);
 }
 
+std::string InstanceImpl::shardForKey(const std::string& hash_key) {
+  return tls_->getTyped<ThreadLocalPool>().shardForKey(hash_key);
+}
+
+bool InstanceImpl::readOnly(const RespValue& request) const {
+  // The command splitter only forwards arrays of bulk strings.
+  ASSERT(request.type() == RespType::Array && !request.asArray().empty());
+  std::string command = request.asArray()[0].asString();
+  to_lower_table_.toLowerCase(command);
+  return SupportedCommands::readOnlyCommands().count(command) > 0;
+}
+
 InstanceImpl::ThreadLocalPool::ThreadLocalPool(InstanceImpl& parent, Event::Dispatcher& dispatcher,
                                                const std::string& cluster_name)
-    : parent_(parent), dispatcher_(dispatcher), cluster_(parent_.cm_.get(cluster_name)) {
+    : parent_(parent), dispatcher_(dispatcher), cluster_(parent_.cm_.get(cluster_name)),
+      slots_request_(*this) {
 
   // TODO(mattklein123): Redis is not currently safe for use with CDS. In order to make this work
   //                     we will need to add thread local cluster removal callbacks so that we can
@@ -216,11 +317,24 @@ InstanceImpl::ThreadLocalPool::ThreadLocalPool(InstanceImpl& parent, Event::Disp
       [this](uint32_t, const std::vector<Upstream::HostSharedPtr>&,
              const std::vector<Upstream::HostSharedPtr>& hosts_removed) -> void {
         onHostsRemoved(hosts_removed);
+        if (parent_.redis_cluster_) {
+          updateHostsByAddress();
+        }
       });
+
+  if (parent_.redis_cluster_) {
+    updateHostsByAddress();
+    slots_refresh_timer_ = dispatcher_.createTimer([this]() -> void { refreshSlots(); });
+    slots_refresh_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
 }
 
 InstanceImpl::ThreadLocalPool::~ThreadLocalPool() {
   local_host_set_member_update_cb_handle_->remove();
+  if (slots_request_.handle_ != nullptr) {
+    slots_request_.handle_->cancel();
+    slots_request_.handle_ = nullptr;
+  }
   while (!client_map_.empty()) {
     client_map_.begin()->second->redis_client_->close();
   }
@@ -241,21 +355,207 @@ void InstanceImpl::ThreadLocalPool::onHostsRemoved(
 PoolRequest* InstanceImpl::ThreadLocalPool::makeRequest(const std::string& hash_key,
                                                         const RespValue& request,
                                                         PoolCallbacks& callbacks) {
+  if (parent_.redis_cluster_) {
+    return makeClusterRequest(hash_key, request, callbacks);
+  }
+
   LbContextImpl lb_context(hash_key);
   Upstream::HostConstSharedPtr host = cluster_->loadBalancer().chooseHost(&lb_context);
   if (!host) {
     return nullptr;
   }
 
+  return threadLocalActiveClient(host).redis_client_->makeRequest(request, callbacks);
+}
+
+PoolRequest* InstanceImpl::ThreadLocalPool::makeClusterRequest(const std::string& hash_key,
+                                                               const RespValue& request,
+                                                               PoolCallbacks& callbacks) {
+  Upstream::HostConstSharedPtr host;
+  const SlotMap::Shard* shard =
+      slot_map_ != nullptr ? slot_map_->shard(SlotMap::slotForKey(hash_key)) : nullptr;
+  if (shard != nullptr) {
+    if (parent_.read_from_replicas_ && !shard->replicas_.empty() && parent_.readOnly(request)) {
+      host = replicaForShard(*shard);
+    }
+    if (!host) {
+      host = hostForAddress(shard->master_);
+    }
+  }
+  if (!host) {
+    // Until the slot map is known, any node redirects the request to the right one.
+    LbContextImpl lb_context(hash_key);
+    host = cluster_->loadBalancer().chooseHost(&lb_context);
+    if (!host) {
+      return nullptr;
+    }
+  }
+
+  ClusterRequestPtr cluster_request(new ClusterRequest(*this, request, callbacks));
+  if (!cluster_request->send(host, false)) {
+    return nullptr;
+  }
+  cluster_request->moveIntoList(std::move(cluster_request), cluster_requests_);
+  return cluster_requests_.front().get();
+}
+
+std::string InstanceImpl::ThreadLocalPool::shardForKey(const std::string& hash_key) {
+  if (parent_.redis_cluster_) {
+    // Redis Cluster rejects the multi key commands whose keys are in different slots, even when
+    // the slots are served by the same node.
+    return std::to_string(SlotMap::slotForKey(hash_key));
+  }
+
+  LbContextImpl lb_context(hash_key);
+  Upstream::HostConstSharedPtr host = cluster_->loadBalancer().chooseHost(&lb_context);
+  return host ? host->address()->asString() : "";
+}
+
+InstanceImpl::ThreadLocalActiveClient&
+InstanceImpl::ThreadLocalPool::threadLocalActiveClient(Upstream::HostConstSharedPtr host) {
   ThreadLocalActiveClientPtr& client = client_map_[host];
   if (!client) {
     client.reset(new ThreadLocalActiveClient(*this));
     client->host_ = host;
     client->redis_client_ = parent_.client_factory_.create(host, dispatcher_, parent_.config_);
     client->redis_client_->addConnectionCallbacks(*client);
+    if (parent_.read_from_replicas_) {
+      // Replicas only serve reads of connections in read only mode, which masters ignore.
+      client->redis_client_->makeRequest(parent_.readonly_request_, null_callbacks_);
+    }
+  }
+
+  return *client;
+}
+
+Upstream::HostConstSharedPtr
+InstanceImpl::ThreadLocalPool::hostForAddress(const std::string& address) {
+  auto it = hosts_by_address_.find(address);
+  return it != hosts_by_address_.end() ? it->second : nullptr;
+}
+
+Upstream::HostConstSharedPtr
+InstanceImpl::ThreadLocalPool::replicaForShard(const SlotMap::Shard& shard) {
+  const std::vector<std::string>& replicas = shard.replicas_;
+  const uint64_t index = next_replica_++ % replicas.size();
+  Upstream::HostConstSharedPtr host = hostForAddress(replicas[index]);
+  if (parent_.replica_selection_ != envoy::config::filter::network::redis_proxy::v2::RedisProxy::
+                                        ConnPoolSettings::RedisCluster::LEAST_LATENCY ||
+      replicas.size() == 1) {
+    return host;
+  }
+
+  // Comparing two replicas rather than all of them still steers the commands away from a slow
+  // replica, while the others share them instead of all going to the fastest one.
+  Upstream::HostConstSharedPtr other = hostForAddress(replicas[(index + 1) % replicas.size()]);
+  if (!host) {
+    return other;
+  }
+  if (!other) {
+    return host;
+  }
+
+  if (host->healthy() != other->healthy()) {
+    return host->healthy() ? host : other;
+  }
+  return latencyCost(other) < latencyCost(host) ? other : host;
+}
+
+double InstanceImpl::ThreadLocalPool::latencyCost(const Upstream::HostConstSharedPtr& host) {
+  // A replica without a connection yet is tried first, which measures its latency.
+  auto it = client_map_.find(host);
+  return it != client_map_.end() ? it->second->redis_client_->latencyCost() : 0;
+}
+
+void InstanceImpl::ThreadLocalPool::updateHostsByAddress() {
+  hosts_by_address_.clear();
+  for (const auto& host_set : cluster_->prioritySet().hostSetsPerPriority()) {
+    for (const Upstream::HostSharedPtr& host : host_set->hosts()) {
+      hosts_by_address_.emplace(host->address()->asString(), host);
+    }
+  }
+}
+
+void InstanceImpl::ThreadLocalPool::onSlotMoved(uint16_t slot, const std::string& address) {
+  if (slot_map_ != nullptr) {
+    slot_map_->moveSlot(slot, address);
   }
+  // Other slots have likely moved too.
+  if (slots_request_.handle_ == nullptr) {
+    slots_refresh_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
+void InstanceImpl::ThreadLocalPool::refreshSlots() {
+  if (slots_request_.handle_ != nullptr) {
+    return;
+  }
+
+  Upstream::HostConstSharedPtr host = cluster_->loadBalancer().chooseHost(nullptr);
+  if (host) {
+    slots_request_.handle_ = threadLocalActiveClient(host).redis_client_->makeRequest(
+        parent_.cluster_slots_request_, slots_request_);
+  }
+  if (slots_request_.handle_ == nullptr) {
+    slots_refresh_timer_->enableTimer(parent_.slots_refresh_interval_);
+  }
+}
+
+void InstanceImpl::SlotsRequest::onResponse(RespValuePtr&& value) {
+  handle_ = nullptr;
+  SlotMapPtr slot_map = SlotMap::create(*value);
+  if (slot_map != nullptr) {
+    parent_.slot_map_ = std::move(slot_map);
+  } else {
+    ENVOY_LOG(debug, "redis: invalid CLUSTER SLOTS response: {}", value->toString());
+  }
+  parent_.slots_refresh_timer_->enableTimer(parent_.parent_.slots_refresh_interval_);
+}
+
+void InstanceImpl::SlotsRequest::onFailure() {
+  handle_ = nullptr;
+  parent_.slots_refresh_timer_->enableTimer(parent_.parent_.slots_refresh_interval_);
+}
+
+bool InstanceImpl::ClusterRequest::send(Upstream::HostConstSharedPtr host, bool asking) {
+  Client& client = *parent_.threadLocalActiveClient(host).redis_client_;
+  if (asking) {
+    // Only allows the next command of the connection to access the slot being imported.
+    client.makeRequest(parent_.parent_.asking_request_, parent_.null_callbacks_);
+  }
+  handle_ = client.makeRequest(request_, *this);
+  return handle_ != nullptr;
+}
+
+void InstanceImpl::ClusterRequest::cancel() {
+  handle_->cancel();
+  handle_ = nullptr;
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.cluster_requests_));
+}
+
+void InstanceImpl::ClusterRequest::onResponse(RespValuePtr&& value) {
+  handle_ = nullptr;
+  absl::optional<SlotMap::Redirection> redirection = SlotMap::parseRedirection(*value);
+  if (redirection.has_value() && redirections_ < MaxRedirections) {
+    ENVOY_LOG(debug, "redis: following redirection: {}", value->asString());
+    if (!redirection.value().ask_) {
+      parent_.onSlotMoved(redirection.value().slot_, redirection.value().address_);
+    }
+    Upstream::HostConstSharedPtr host = parent_.hostForAddress(redirection.value().address_);
+    redirections_++;
+    if (host && send(host, redirection.value().ask_)) {
+      return;
+    }
+  }
+
+  callbacks_.onResponse(std::move(value));
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.cluster_requests_));
+}
 
-  return client->redis_client_->makeRequest(request, callbacks);
+void InstanceImpl::ClusterRequest::onFailure() {
+  handle_ = nullptr;
+  callbacks_.onFailure();
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.cluster_requests_));
 }
 
 void InstanceImpl::ThreadLocalActiveClient::onEvent(Network::ConnectionEvent event) {
@@ -8,17 +8,22 @@
 #include <unordered_map>
 #include <vector>
 
+#include "envoy/common/time.h"
 #include "envoy/config/filter/network/redis_proxy/v2/redis_proxy.pb.h"
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/buffer/buffer_impl.h"
+#include "common/common/linked_object.h"
+#include "common/common/logger.h"
+#include "common/common/to_lower_table.h"
 #include "common/network/filter_impl.h"
 #include "common/protobuf/utility.h"
 #include "common/upstream/load_balancer_impl.h"
 
 #include "extensions/filters/network/redis_proxy/codec_impl.h"
 #include "extensions/filters/network/redis_proxy/conn_pool.h"
+#include "extensions/filters/network/redis_proxy/slot_map.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -55,6 +60,7 @@ public:
   }
   void close() override;
   PoolRequest* makeRequest(const RespValue& request, PoolCallbacks& callbacks) override;
+  double latencyCost() override;
 
 private:
   struct UpstreamReadFilter : public Network::ReadFilterBaseImpl {
@@ -78,14 +84,17 @@ private:
 
     ClientImpl& parent_;
     PoolCallbacks& callbacks_;
+    const MonotonicTime start_time_;
     bool canceled_{};
   };
 
   ClientImpl(Upstream::HostConstSharedPtr host, Event::Dispatcher& dispatcher, EncoderPtr&& encoder,
              DecoderFactory& decoder_factory, const Config& config);
+  void flushRequests();
   void onConnectOrOpTimeout();
   void onData(Buffer::Instance& data);
   void putOutlierEvent(Upstream::Outlier::Result result);
+  double latencyWeight(MonotonicTime now) const;
 
   // RedisProxy::DecoderCallbacks
   void onRespValue(RespValuePtr&& value) override;
@@ -96,6 +105,7 @@ private:
   void onBelowWriteBufferLowWatermark() override {}
 
   Upstream::HostConstSharedPtr host_;
+  TimeSource& time_source_;
   Network::ClientConnectionPtr connection_;
   EncoderPtr encoder_;
   Buffer::OwnedImpl encoder_buffer_;
@@ -103,7 +113,13 @@ private:
   const Config& config_;
   std::list<PendingRequest> pending_requests_;
   Event::TimerPtr connect_or_op_timer_;
+  Event::TimerPtr flush_timer_;
   bool connected_{};
+  bool flush_pending_{};
+  // The peak weighted moving average of the response times in microseconds, as of
+  // latency_updated_.
+  double latency_{};
+  MonotonicTime latency_updated_;
 };
 
 class ClientFactoryImpl : public ClientFactory {
@@ -128,6 +144,7 @@ public:
   // RedisProxy::ConnPool::Instance
   PoolRequest* makeRequest(const std::string& hash_key, const RespValue& request,
                            PoolCallbacks& callbacks) override;
+  std::string shardForKey(const std::string& hash_key) override;
 
 private:
   struct ThreadLocalPool;
@@ -147,19 +164,85 @@ private:
 
   typedef std::unique_ptr<ThreadLocalActiveClient> ThreadLocalActiveClientPtr;
 
+  /**
+   * A request to a Redis Cluster, which keeps a copy of the request in order to follow
+   * redirections.
+   */
+  struct ClusterRequest : public PoolRequest,
+                          public PoolCallbacks,
+                          public Event::DeferredDeletable,
+                          LinkedObject<ClusterRequest>,
+                          Logger::Loggable<Logger::Id::redis> {
+    ClusterRequest(ThreadLocalPool& parent, const RespValue& request, PoolCallbacks& callbacks)
+        : parent_(parent), request_(request), callbacks_(callbacks) {}
+
+    bool send(Upstream::HostConstSharedPtr host, bool asking);
+
+    // RedisProxy::ConnPool::PoolRequest
+    void cancel() override;
+
+    // RedisProxy::ConnPool::PoolCallbacks
+    void onResponse(RespValuePtr&& value) override;
+    void onFailure() override;
+
+    ThreadLocalPool& parent_;
+    const RespValue request_;
+    PoolCallbacks& callbacks_;
+    PoolRequest* handle_{};
+    uint32_t redirections_{};
+  };
+
+  typedef std::unique_ptr<ClusterRequest> ClusterRequestPtr;
+
+  struct SlotsRequest : public PoolCallbacks, Logger::Loggable<Logger::Id::redis> {
+    SlotsRequest(ThreadLocalPool& parent) : parent_(parent) {}
+
+    // RedisProxy::ConnPool::PoolCallbacks
+    void onResponse(RespValuePtr&& value) override;
+    void onFailure() override;
+
+    ThreadLocalPool& parent_;
+    PoolRequest* handle_{};
+  };
+
+  // Callbacks for the ASKING and READONLY commands, whose responses are ignored.
+  struct NullPoolCallbacks : public PoolCallbacks {
+    // RedisProxy::ConnPool::PoolCallbacks
+    void onResponse(RespValuePtr&&) override {}
+    void onFailure() override {}
+  };
+
   struct ThreadLocalPool : public ThreadLocal::ThreadLocalObject {
     ThreadLocalPool(InstanceImpl& parent, Event::Dispatcher& dispatcher,
                     const std::string& cluster_name);
     ~ThreadLocalPool();
     PoolRequest* makeRequest(const std::string& hash_key, const RespValue& request,
                              PoolCallbacks& callbacks);
+    PoolRequest* makeClusterRequest(const std::string& hash_key, const RespValue& request,
+                                    PoolCallbacks& callbacks);
+    std::string shardForKey(const std::string& hash_key);
+    ThreadLocalActiveClient& threadLocalActiveClient(Upstream::HostConstSharedPtr host);
+    Upstream::HostConstSharedPtr hostForAddress(const std::string& address);
+    Upstream::HostConstSharedPtr replicaForShard(const SlotMap::Shard& shard);
+    double latencyCost(const Upstream::HostConstSharedPtr& host);
     void onHostsRemoved(const std::vector<Upstream::HostSharedPtr>& hosts_removed);
+    void onSlotMoved(uint16_t slot, const std::string& address);
+    void refreshSlots();
+    void updateHostsByAddress();
 
     InstanceImpl& parent_;
     Event::Dispatcher& dispatcher_;
     Upstream::ThreadLocalCluster* cluster_;
     std::unordered_map<Upstream::HostConstSharedPtr, ThreadLocalActiveClientPtr> client_map_;
     Envoy::Common::CallbackHandle* local_host_set_member_update_cb_handle_;
+    // The following are only used with a Redis Cluster.
+    SlotMapPtr slot_map_;
+    std::unordered_map<std::string, Upstream::HostConstSharedPtr> hosts_by_address_;
+    std::list<ClusterRequestPtr> cluster_requests_;
+    SlotsRequest slots_request_;
+    Event::TimerPtr slots_refresh_timer_;
+    NullPoolCallbacks null_callbacks_;
+    uint64_t next_replica_{};
   };
 
   struct LbContextImpl : public Upstream::LoadBalancerContextBase {
@@ -171,10 +254,21 @@ private:
     const absl::optional<uint64_t> hash_key_;
   };
 
+  bool readOnly(const RespValue& request) const;
+
   Upstream::ClusterManager& cm_;
   ClientFactory& client_factory_;
-  ThreadLocal::SlotPtr tls_;
   ConfigImpl config_;
+  const bool redis_cluster_;
+  const std::chrono::milliseconds slots_refresh_interval_;
+  const bool read_from_replicas_;
+  const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings::
+      RedisCluster::ReplicaSelection replica_selection_;
+  RespValue cluster_slots_request_;
+  RespValue asking_request_;
+  RespValue readonly_request_;
+  const ToLowerTable to_lower_table_;
+  ThreadLocal::SlotPtr tls_;
 };
 
 } // namespace ConnPool
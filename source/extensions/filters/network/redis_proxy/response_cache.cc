@@ -0,0 +1,171 @@
+#include "extensions/filters/network/redis_proxy/response_cache.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/network/redis_proxy/supported_commands.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace CommandSplitter {
+
+ResponseCache::ResponseCache(
+    const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ResponseCache& config,
+    ThreadLocal::SlotAllocator& tls, TimeSource& time_source, Stats::Scope& scope,
+    const std::string& stat_prefix)
+    : ttl_(PROTOBUF_GET_MS_REQUIRED(config, ttl)),
+      max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, 10000)),
+      tls_(tls.allocateSlot()), time_source_(time_source),
+      stats_{ALL_RESPONSE_CACHE_STATS(POOL_COUNTER_PREFIX(scope, stat_prefix + "cache."))} {
+  for (const std::string& command : config.commands()) {
+    std::string to_lower_command(command);
+    to_lower_table_.toLowerCase(to_lower_command);
+    // Only the commands that read the single key in their first argument can be invalidated.
+    const std::vector<std::string>& simple_commands = SupportedCommands::simpleCommands();
+    if (SupportedCommands::readOnlyCommands().count(to_lower_command) == 0 ||
+        std::find(simple_commands.begin(), simple_commands.end(), to_lower_command) ==
+            simple_commands.end()) {
+      throw EnvoyException(fmt::format("redis: cannot cache the responses to '{}'", command));
+    }
+    commands_.insert(to_lower_command);
+  }
+  if (commands_.empty()) {
+    commands_ = {"get", "hget"};
+  }
+
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalCache>();
+  });
+}
+
+bool ResponseCache::cached(const std::string& command) const {
+  std::string to_lower_command(command);
+  to_lower_table_.toLowerCase(to_lower_command);
+  return commands_.count(to_lower_command) > 0;
+}
+
+RespValuePtr ResponseCache::lookup(const RespValue& request, Key& key) {
+  ASSERT(request.type() == RespType::Array && request.asArray().size() >= 2);
+  const std::vector<RespValue>& args = request.asArray();
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+
+  key.key_ = args[1].asString();
+  key.command_ = args[0].asString();
+  to_lower_table_.toLowerCase(key.command_);
+  // Length prefix the other arguments, so that different arguments never share an entry.
+  for (uint64_t i = 2; i < args.size(); i++) {
+    absl::StrAppend(&key.command_, " ", args[i].asString().size(), ":", args[i].asString());
+  }
+  key.generation_ = cache.generation_;
+
+  auto key_entries = cache.keys_.find(key.key_);
+  if (key_entries != cache.keys_.end()) {
+    auto entry = key_entries->second.entries_.find(key.command_);
+    if (entry != key_entries->second.entries_.end()) {
+      if (entry->second.expiry_ > time_source_.monotonicTime()) {
+        cache.lru_.splice(cache.lru_.begin(), cache.lru_, key_entries->second.lru_entry_);
+        stats_.hit_.inc();
+        return std::make_unique<RespValue>(entry->second.response_);
+      }
+
+      key_entries->second.entries_.erase(entry);
+      cache.size_--;
+      if (key_entries->second.entries_.empty()) {
+        cache.erase(key_entries);
+      }
+    }
+  }
+
+  stats_.miss_.inc();
+  return nullptr;
+}
+
+void ResponseCache::insert(const Key& key, const RespValue& response) {
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  if (key.generation_ != cache.generation_ || !cacheable(response)) {
+    return;
+  }
+
+  auto key_entries = cache.keys_.find(key.key_);
+  if (key_entries == cache.keys_.end()) {
+    cache.lru_.push_front(key.key_);
+    key_entries = cache.keys_.emplace(key.key_, KeyEntries()).first;
+    key_entries->second.lru_entry_ = cache.lru_.begin();
+  } else {
+    cache.lru_.splice(cache.lru_.begin(), cache.lru_, key_entries->second.lru_entry_);
+  }
+
+  auto inserted = key_entries->second.entries_.emplace(key.command_, Entry());
+  if (inserted.second) {
+    cache.size_++;
+  }
+  inserted.first->second.response_ = response;
+  inserted.first->second.expiry_ = time_source_.monotonicTime() + ttl_;
+
+  // Evict whole keys, so that the most recently used one is kept even if it has more entries
+  // than the limit.
+  while (cache.size_ > max_entries_ && cache.lru_.size() > 1) {
+    stats_.eviction_.inc();
+    cache.erase(cache.keys_.find(cache.lru_.back()));
+  }
+}
+
+void ResponseCache::invalidate(const std::string& key) {
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  cache.generation_++;
+
+  auto key_entries = cache.keys_.find(key);
+  if (key_entries != cache.keys_.end()) {
+    ENVOY_LOG(debug, "redis: invalidating cached responses for '{}'", key);
+    stats_.invalidation_.inc();
+    cache.erase(key_entries);
+  }
+}
+
+bool ResponseCache::cacheable(const RespValue& response) {
+  switch (response.type()) {
+  case RespType::Error:
+    return false;
+  case RespType::BulkString:
+    // Large bulk strings are forwarded in buffers that are moved rather than copied.
+    return !response.hasBuffer();
+  case RespType::Array:
+    for (const RespValue& value : response.asArray()) {
+      if (!cacheable(value)) {
+        return false;
+      }
+    }
+    return true;
+  case RespType::Null:
+  case RespType::SimpleString:
+  case RespType::Integer:
+    return true;
+  }
+
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+void ResponseCache::ThreadLocalCache::erase(
+    std::unordered_map<std::string, KeyEntries>::iterator it) {
+  ASSERT(it != keys_.end());
+  size_ -= it->second.entries_.size();
+  lru_.erase(it->second.lru_entry_);
+  keys_.erase(it);
+}
+
+} // namespace CommandSplitter
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
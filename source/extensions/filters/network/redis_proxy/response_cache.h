@@ -0,0 +1,137 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "envoy/common/time.h"
+#include "envoy/config/filter/network/redis_proxy/v2/redis_proxy.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/logger.h"
+#include "common/common/to_lower_table.h"
+
+#include "extensions/filters/network/redis_proxy/codec.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace CommandSplitter {
+
+/**
+ * All response cache stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_RESPONSE_CACHE_STATS(COUNTER)                                                          \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(eviction)                                                                                \
+  COUNTER(invalidation)
+// clang-format on
+
+/**
+ * Struct definition for all response cache stats. @see stats_macros.h
+ */
+struct ResponseCacheStats {
+  ALL_RESPONSE_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * A per worker, TTL bounded cache of the responses to commands that only read a single key. The
+ * entries of a key are invalidated by the worker when a command that may write the key goes
+ * through it. Writes through other workers or other clients are only seen when entries expire.
+ */
+class ResponseCache : Logger::Loggable<Logger::Id::redis> {
+public:
+  ResponseCache(
+      const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ResponseCache& config,
+      ThreadLocal::SlotAllocator& tls, TimeSource& time_source, Stats::Scope& scope,
+      const std::string& stat_prefix);
+
+  /**
+   * Identifies the entry of a request, as returned by a cache miss.
+   */
+  struct Key {
+    // The key of the request.
+    std::string key_;
+    // The command and its arguments other than the key.
+    std::string command_;
+    // The number of invalidations on the worker when the request was looked up.
+    uint64_t generation_;
+  };
+
+  /**
+   * @param command supplies a command, in any case.
+   * @return bool whether the responses to the command are cached.
+   */
+  bool cached(const std::string& command) const;
+
+  /**
+   * Look up the response to a request of a cached command.
+   * @param request supplies the request.
+   * @param key is set to the entry of the request on a miss.
+   * @return RespValuePtr a copy of the cached response, or nullptr on a miss.
+   */
+  RespValuePtr lookup(const RespValue& request, Key& key);
+
+  /**
+   * Cache the response to a request that missed. Nothing is cached if a key was invalidated on
+   * the worker since the lookup, as the response may predate the write, or if the response is an
+   * error or holds a bulk string that is too large to be copied.
+   * @param key supplies the entry of the request.
+   * @param response supplies the response.
+   */
+  void insert(const Key& key, const RespValue& response);
+
+  /**
+   * Drop the cached responses of a key, when a command that may write the key is sent.
+   * @param key supplies the key.
+   */
+  void invalidate(const std::string& key);
+
+private:
+  struct Entry {
+    RespValue response_;
+    MonotonicTime expiry_;
+  };
+
+  struct KeyEntries {
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string>::iterator lru_entry_;
+  };
+
+  struct ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
+    void erase(std::unordered_map<std::string, KeyEntries>::iterator it);
+
+    std::unordered_map<std::string, KeyEntries> keys_;
+    // Keys from the most to the least recently used.
+    std::list<std::string> lru_;
+    uint64_t size_{};
+    uint64_t generation_{};
+  };
+
+  static bool cacheable(const RespValue& response);
+
+  const std::chrono::milliseconds ttl_;
+  const uint64_t max_entries_;
+  std::unordered_set<std::string> commands_;
+  ThreadLocal::SlotPtr tls_;
+  TimeSource& time_source_;
+  ResponseCacheStats stats_;
+  const ToLowerTable to_lower_table_;
+};
+
+typedef std::unique_ptr<ResponseCache> ResponseCachePtr;
+
+} // namespace CommandSplitter
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,168 @@
+#include "extensions/filters/network/redis_proxy/slot_map.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/network/utility.h"
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+
+namespace {
+
+// CRC16-CCITT (XMODEM), as specified by the Redis Cluster specification.
+uint16_t crc16(absl::string_view data) {
+  uint16_t crc = 0;
+  for (const char c : data) {
+    crc ^= static_cast<uint16_t>(static_cast<uint8_t>(c)) << 8;
+    for (uint32_t i = 0; i < 8; i++) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                           : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+// Returns the address of a node in the format of Network::Address::Instance::asString(), or an
+// empty string if the IP or port are not valid.
+std::string nodeAddress(const std::string& ip, int64_t port) {
+  if (port <= 0 || port > std::numeric_limits<uint16_t>::max()) {
+    return "";
+  }
+  try {
+    Network::Address::InstanceConstSharedPtr address =
+        Network::Utility::parseInternetAddress(ip, static_cast<uint16_t>(port));
+    return address != nullptr ? address->asString() : "";
+  } catch (const EnvoyException&) {
+    return "";
+  }
+}
+
+// A node is an array of its IP, port and ID, possibly followed by more fields.
+std::string nodeAddress(const RespValue& node) {
+  if (node.type() != RespType::Array || node.asArray().size() < 2 ||
+      node.asArray()[0].type() != RespType::BulkString ||
+      node.asArray()[1].type() != RespType::Integer) {
+    return "";
+  }
+  return nodeAddress(node.asArray()[0].asString(), node.asArray()[1].asInteger());
+}
+
+} // namespace
+
+const uint16_t SlotMap::NumSlots;
+const uint32_t SlotMap::NoShard;
+
+uint16_t SlotMap::slotForKey(absl::string_view key) {
+  const size_t start = key.find('{');
+  if (start != absl::string_view::npos) {
+    const size_t end = key.find('}', start + 1);
+    if (end != absl::string_view::npos && end != start + 1) {
+      key = key.substr(start + 1, end - start - 1);
+    }
+  }
+  return crc16(key) % NumSlots;
+}
+
+std::unique_ptr<SlotMap> SlotMap::create(const RespValue& response) {
+  if (response.type() != RespType::Array) {
+    return nullptr;
+  }
+
+  std::unique_ptr<SlotMap> slot_map(new SlotMap());
+  for (const RespValue& range : response.asArray()) {
+    // Each range is an array of its first and last slots, followed by its master and replicas.
+    if (range.type() != RespType::Array || range.asArray().size() < 3) {
+      return nullptr;
+    }
+    const std::vector<RespValue>& fields = range.asArray();
+    if (fields[0].type() != RespType::Integer || fields[1].type() != RespType::Integer) {
+      return nullptr;
+    }
+    const int64_t first = fields[0].asInteger();
+    const int64_t last = fields[1].asInteger();
+    if (first < 0 || first > last || last >= NumSlots) {
+      return nullptr;
+    }
+
+    Shard shard;
+    for (uint64_t i = 2; i < fields.size(); i++) {
+      std::string address = nodeAddress(fields[i]);
+      if (address.empty()) {
+        return nullptr;
+      }
+      if (i == 2) {
+        shard.master_ = std::move(address);
+      } else {
+        shard.replicas_.push_back(std::move(address));
+      }
+    }
+
+    slot_map->shards_.push_back(std::move(shard));
+    for (int64_t slot = first; slot <= last; slot++) {
+      slot_map->slots_[slot] = slot_map->shards_.size() - 1;
+    }
+  }
+
+  return slot_map;
+}
+
+absl::optional<SlotMap::Redirection> SlotMap::parseRedirection(const RespValue& response) {
+  // The error is "MOVED <slot> <ip>:<port>" or "ASK <slot> <ip>:<port>", where IPv6 addresses
+  // are not enclosed in brackets.
+  if (response.type() != RespType::Error) {
+    return absl::nullopt;
+  }
+  const std::vector<absl::string_view> parts = absl::StrSplit(response.asString(), ' ');
+  if (parts.size() != 3 || (parts[0] != "MOVED" && parts[0] != "ASK")) {
+    return absl::nullopt;
+  }
+  uint32_t slot;
+  if (!absl::SimpleAtoi(parts[1], &slot) || slot >= NumSlots) {
+    return absl::nullopt;
+  }
+  const size_t colon = parts[2].rfind(':');
+  int64_t port;
+  if (colon == absl::string_view::npos || !absl::SimpleAtoi(parts[2].substr(colon + 1), &port)) {
+    return absl::nullopt;
+  }
+  std::string address = nodeAddress(std::string(parts[2].substr(0, colon)), port);
+  if (address.empty()) {
+    return absl::nullopt;
+  }
+
+  return Redirection{parts[0] == "ASK", static_cast<uint16_t>(slot), std::move(address)};
+}
+
+const SlotMap::Shard* SlotMap::shard(uint16_t slot) const {
+  ASSERT(slot < NumSlots);
+  return slots_[slot] != NoShard ? &shards_[slots_[slot]] : nullptr;
+}
+
+void SlotMap::moveSlot(uint16_t slot, const std::string& address) {
+  ASSERT(slot < NumSlots);
+  for (uint32_t i = 0; i < shards_.size(); i++) {
+    if (shards_[i].master_ == address) {
+      slots_[slot] = i;
+      return;
+    }
+  }
+  shards_.push_back({address, {}});
+  slots_[slot] = shards_.size() - 1;
+}
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "extensions/filters/network/redis_proxy/codec.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+
+/**
+ * The nodes serving the hash slots of a Redis Cluster, as reported by the CLUSTER SLOTS command.
+ * See https://redis.io/topics/cluster-spec. Nodes are identified by their address, in the format
+ * of Network::Address::Instance::asString().
+ */
+class SlotMap {
+public:
+  static const uint16_t NumSlots = 16384;
+
+  /**
+   * The master serving a range of slots, and its replicas.
+   */
+  struct Shard {
+    std::string master_;
+    std::vector<std::string> replicas_;
+  };
+
+  /**
+   * A MOVED or ASK redirection, sent by a node that does not serve the slot of a request.
+   */
+  struct Redirection {
+    bool ask_;
+    uint16_t slot_;
+    std::string address_;
+  };
+
+  /**
+   * @param key supplies the key to hash.
+   * @return uint16_t the slot of the key. When the key contains a non empty hash tag, that is a
+   *         substring between the first { and the first } following it, only the hash tag is
+   *         hashed, so that related keys can be put in the same slot.
+   */
+  static uint16_t slotForKey(absl::string_view key);
+
+  /**
+   * @param response supplies a CLUSTER SLOTS response.
+   * @return std::unique_ptr<SlotMap> the slot map, or nullptr if the response is not valid.
+   */
+  static std::unique_ptr<SlotMap> create(const RespValue& response);
+
+  /**
+   * @param response supplies a response from a Redis Cluster node.
+   * @return absl::optional<Redirection> the redirection if the response is a MOVED or ASK error.
+   */
+  static absl::optional<Redirection> parseRedirection(const RespValue& response);
+
+  /**
+   * @return const Shard* the shard serving a slot, or nullptr if the slot is not served.
+   */
+  const Shard* shard(uint16_t slot) const;
+
+  /**
+   * Update the master of a slot, following a MOVED redirection. The replicas of the new master
+   * are not known until the slot map is refreshed.
+   */
+  void moveSlot(uint16_t slot, const std::string& address);
+
+private:
+  static const uint32_t NoShard = UINT32_MAX;
+
+  SlotMap() : slots_(NumSlots, NoShard) {}
+
+  std::vector<Shard> shards_;
+  // The index in shards_ of the shard serving each slot.
+  std::vector<uint32_t> slots_;
+};
+
+typedef std::unique_ptr<SlotMap> SlotMapPtr;
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
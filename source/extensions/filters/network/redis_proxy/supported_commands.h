@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "common/common/macros.h"
@@ -44,6 +45,20 @@ struct SupportedCommands {
     CONSTRUCT_ON_FIRST_USE(std::vector<std::string>, "del", "exists", "touch", "unlink");
   }
 
+  /**
+   * @return commands which only read, and so can be served by replicas
+   */
+  static const std::unordered_set<std::string>& readOnlyCommands() {
+    CONSTRUCT_ON_FIRST_USE(
+        std::unordered_set<std::string>, "bitcount", "bitpos", "dump", "exists", "geodist",
+        "geohash", "geopos", "georadius_ro", "georadiusbymember_ro", "get", "getbit", "getrange",
+        "hexists", "hget", "hgetall", "hkeys", "hlen", "hmget", "hscan", "hstrlen", "hvals",
+        "lindex", "llen", "lrange", "pttl", "scard", "sismember", "smembers", "srandmember",
+        "sscan", "strlen", "ttl", "type", "zcard", "zcount", "zlexcount", "zrange", "zrangebylex",
+        "zrangebyscore", "zrank", "zrevrange", "zrevrangebylex", "zrevrangebyscore", "zrevrank",
+        "zscan", "zscore");
+  }
+
   /**
    * @return mget command
    */
@@ -1,5 +1,7 @@
 #include "extensions/filters/network/thrift_proxy/buffer_helper.h"
 
+#include <cstring>
+
 #include "common/common/byte_order.h"
 
 namespace Envoy {
@@ -7,6 +9,19 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace ThriftProxy {
 
+namespace {
+
+// Packs the low 7 bits of each byte of a little-endian word into the low 56 bits of the result, by
+// merging pairs of 7, then 14, then 28 bit groups.
+uint64_t packVarIntGroups(uint64_t word) {
+  word &= 0x7f7f7f7f7f7f7f7fULL;
+  word = (word & 0x007f007f007f007fULL) | ((word & 0x7f007f007f007f00ULL) >> 1);
+  word = (word & 0x00003fff00003fffULL) | ((word & 0x3fff00003fff0000ULL) >> 2);
+  return (word & 0x000000000fffffffULL) | ((word & 0x0fffffff00000000ULL) >> 4);
+}
+
+} // namespace
+
 int8_t BufferHelper::peekI8(Buffer::Instance& buffer, uint64_t offset) {
   if (buffer.length() < offset + 1) {
     throw EnvoyException("buffer underflow");
@@ -139,20 +154,34 @@ uint64_t BufferHelper::peekVarInt(Buffer::Instance& buffer, uint64_t offset, int
     throw EnvoyException("buffer underflow");
   }
 
-  // Need at most 10 bytes for a 64-bit var int.
+  // Need at most 10 bytes for a 64-bit var int. They are copied out at once rather than peeked at
+  // one by one. The bytes past the end of the buffer are padded with continuation bits, so that
+  // they never end the var int.
   const uint64_t last = std::min(buffer.length() - offset, static_cast<uint64_t>(10));
+  uint8_t bytes[10];
+  memset(bytes, 0x80, sizeof(bytes));
+  buffer.copyOut(offset, last, bytes);
+
+  // Note: the compact protocol spec says these variable-length ints are encoded as big-endian,
+  // but the Apache C++, Java, and Python implementations read and write them little-endian.
+  uint64_t word;
+  memcpy(&word, bytes, sizeof(word));
+  word = le64toh(word);
+
+  // The var int ends at the first byte without its continuation (high) bit, which is found without
+  // branching per byte for the var ints of up to 8 bytes, i.e. of values up to 56 bits.
+  const uint64_t stop_bits = ~word & 0x8080808080808080ULL;
+  if (stop_bits != 0) {
+    // Keep the bytes up to the one with the lowest stop bit.
+    size = (__builtin_ctzll(stop_bits) >> 3) + 1;
+    return packVarIntGroups(word & (stop_bits ^ (stop_bits - 1)));
+  }
 
-  uint8_t shift = 0;
-  uint64_t result = 0;
-  for (uint64_t i = 0; i < last; i++) {
-    uint8_t b = peekI8(buffer, offset + i);
-
-    // Note: the compact protocol spec says these variable-length ints are encoded as big-endian,
-    // but the Apache C++, Java, and Python implementations read and write them little-endian.
-    result |= static_cast<uint64_t>(b & 0x7f) << shift;
-    shift += 7;
+  uint64_t result = packVarIntGroups(word);
+  for (uint64_t i = sizeof(word); i < last; i++) {
+    result |= static_cast<uint64_t>(bytes[i] & 0x7f) << (7 * i);
 
-    if ((b & 0x80) == 0) {
+    if ((bytes[i] & 0x80) == 0) {
       // End of encoded int.
       size = i + 1;
       return result;
@@ -373,7 +373,10 @@ bool CompactProtocolImpl::readString(Buffer::Instance& buffer, std::string& valu
   }
 
   buffer.drain(len_size);
-  value.assign(static_cast<const char*>(buffer.linearize(str_len)), str_len);
+  // Copy the string out of the buffer slices, rather than first linearizing the buffer when it
+  // spans slices.
+  value.resize(str_len);
+  buffer.copyOut(0, str_len, &value[0]);
   buffer.drain(str_len);
   return true;
 }
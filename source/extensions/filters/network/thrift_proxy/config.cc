@@ -7,6 +7,7 @@
 #include "envoy/registry/registry.h"
 
 #include "common/config/utility.h"
+#include "common/protobuf/utility.h"
 
 #include "extensions/filters/network/thrift_proxy/auto_protocol_impl.h"
 #include "extensions/filters/network/thrift_proxy/auto_transport_impl.h"
@@ -90,7 +91,9 @@ lookupProtocol(envoy::config::filter::network::thrift_proxy::v2alpha1::ProtocolT
 ProtocolOptionsConfigImpl::ProtocolOptionsConfigImpl(
     const envoy::config::filter::network::thrift_proxy::v2alpha1::ThriftProtocolOptions& config)
     : transport_(lookupTransport(config.transport())),
-      protocol_(lookupProtocol(config.protocol())) {}
+      protocol_(lookupProtocol(config.protocol())),
+      max_requests_per_connection_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_requests_per_connection, 1)) {}
 
 TransportType ProtocolOptionsConfigImpl::transport(TransportType downstream_transport) const {
   return (transport_ == TransportType::Auto) ? downstream_transport : transport_;
@@ -100,6 +103,10 @@ ProtocolType ProtocolOptionsConfigImpl::protocol(ProtocolType downstream_protoco
   return (protocol_ == ProtocolType::Auto) ? downstream_protocol : protocol_;
 }
 
+uint32_t ProtocolOptionsConfigImpl::maxRequestsPerConnection() const {
+  return max_requests_per_connection_;
+}
+
 Network::FilterFactoryCb ThriftProxyFilterConfigFactory::createFilterFactoryFromProtoTyped(
     const envoy::config::filter::network::thrift_proxy::v2alpha1::ThriftProxy& proto_config,
     Server::Configuration::FactoryContext& context) {
@@ -124,7 +131,8 @@ ConfigImpl::ConfigImpl(
     : context_(context), stats_prefix_(fmt::format("thrift.{}.", config.stat_prefix())),
       stats_(ThriftFilterStats::generateStats(stats_prefix_, context_.scope())),
       transport_(lookupTransport(config.transport())), proto_(lookupProtocol(config.protocol())),
-      route_matcher_(new Router::RouteMatcher(config.route_config())) {
+      route_matcher_(new Router::RouteMatcher(config.route_config())),
+      payload_passthrough_(config.payload_passthrough()) {
 
   // Construct the only Thrift DecoderFilter: the Router
   auto& factory =
@@ -29,10 +29,12 @@ public:
   // ProtocolOptionsConfig
   TransportType transport(TransportType downstream_transport) const override;
   ProtocolType protocol(ProtocolType downstream_protocol) const override;
+  uint32_t maxRequestsPerConnection() const override;
 
 private:
   const TransportType transport_;
   const ProtocolType protocol_;
+  const uint32_t max_requests_per_connection_;
 };
 
 /**
@@ -80,6 +82,7 @@ public:
   TransportPtr createTransport() override;
   ProtocolPtr createProtocol() override;
   Router::Config& routerConfig() override { return *this; }
+  bool payloadPassthrough() const override { return payload_passthrough_; }
 
 private:
   Server::Configuration::FactoryContext& context_;
@@ -88,6 +91,7 @@ private:
   const TransportType transport_;
   const ProtocolType proto_;
   std::unique_ptr<Router::RouteMatcher> route_matcher_;
+  const bool payload_passthrough_;
 
   std::list<ThriftFilters::FilterFactoryCb> filter_factories_;
 };
@@ -282,6 +282,10 @@ FilterStatus ConnectionManager::ActiveRpc::messageBegin(MessageMetadataSharedPtr
   return event_handler_->messageBegin(metadata);
 }
 
+bool ConnectionManager::ActiveRpc::passthroughEnabled() const {
+  return parent_.config_.payloadPassthrough() && event_handler_->passthroughEnabled();
+}
+
 void ConnectionManager::ActiveRpc::createFilterChain() {
   parent_.config_.filterFactory().createFilterChain(*this);
 }
@@ -35,6 +35,11 @@ public:
   virtual TransportPtr createTransport() PURE;
   virtual ProtocolPtr createProtocol() PURE;
   virtual Router::Config& routerConfig() PURE;
+
+  /**
+   * @return bool whether the bodies of requests may be forwarded without being decoded.
+   */
+  virtual bool payloadPassthrough() const PURE;
 };
 
 /**
@@ -46,6 +51,11 @@ public:
 
   virtual TransportType transport(TransportType downstream_transport) const PURE;
   virtual ProtocolType protocol(ProtocolType downstream_protocol) const PURE;
+
+  /**
+   * @return uint32_t the maximum number of requests that may share an upstream connection.
+   */
+  virtual uint32_t maxRequestsPerConnection() const PURE;
 };
 
 /**
@@ -130,6 +140,7 @@ private:
     // DecoderEventHandler
     FilterStatus transportEnd() override;
     FilterStatus messageBegin(MessageMetadataSharedPtr metadata) override;
+    bool passthroughEnabled() const override;
 
     // ThriftFilters::DecoderFilterCallbacks
     uint64_t streamId() const override { return stream_id_; }
@@ -4,7 +4,9 @@
 
 #include "envoy/common/exception.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
+#include "common/common/fmt.h"
 #include "common/common/macros.h"
 
 #include "extensions/filters/network/thrift_proxy/app_exception_impl.h"
@@ -14,8 +16,10 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace ThriftProxy {
 
-// MessageBegin -> StructBegin
+// MessageBegin -> StructBegin, or
+// MessageBegin -> PassthroughData (framed message, if the handler allows it)
 DecoderStateMachine::DecoderStatus DecoderStateMachine::messageBegin(Buffer::Instance& buffer) {
+  const uint64_t length = buffer.length();
   if (!proto_.readMessageBegin(buffer, *metadata_)) {
     return DecoderStatus(ProtocolState::WaitForData);
   }
@@ -23,7 +27,21 @@ DecoderStateMachine::DecoderStatus DecoderStateMachine::messageBegin(Buffer::Ins
   stack_.clear();
   stack_.emplace_back(Frame(ProtocolState::MessageEnd));
 
-  return DecoderStatus(ProtocolState::StructBegin, handler_.messageBegin(metadata_));
+  const FilterStatus status = handler_.messageBegin(metadata_);
+
+  // The size of the body is only known when the transport frames the message.
+  if (metadata_->hasFrameSize() && handler_.passthroughEnabled()) {
+    const uint64_t message_begin_bytes = length - buffer.length();
+    if (metadata_->frameSize() < message_begin_bytes) {
+      throw EnvoyException(fmt::format("invalid thrift frame size {} for message of {} bytes",
+                                       metadata_->frameSize(), message_begin_bytes));
+    }
+
+    body_bytes_ = metadata_->frameSize() - message_begin_bytes;
+    return DecoderStatus(ProtocolState::PassthroughData, status);
+  }
+
+  return DecoderStatus(ProtocolState::StructBegin, status);
 }
 
 // MessageEnd -> Done
@@ -35,6 +53,19 @@ DecoderStateMachine::DecoderStatus DecoderStateMachine::messageEnd(Buffer::Insta
   return DecoderStatus(ProtocolState::Done, handler_.messageEnd());
 }
 
+// PassthroughData -> MessageEnd
+DecoderStateMachine::DecoderStatus
+DecoderStateMachine::passthroughData(Buffer::Instance& buffer) {
+  if (buffer.length() < body_bytes_) {
+    return DecoderStatus(ProtocolState::WaitForData);
+  }
+
+  Buffer::OwnedImpl body;
+  body.move(buffer, body_bytes_);
+
+  return DecoderStatus(ProtocolState::MessageEnd, handler_.passthroughData(body));
+}
+
 // StructBegin -> FieldBegin
 DecoderStateMachine::DecoderStatus DecoderStateMachine::structBegin(Buffer::Instance& buffer) {
   std::string name;
@@ -288,6 +319,8 @@ DecoderStateMachine::DecoderStatus DecoderStateMachine::handleState(Buffer::Inst
   switch (state_) {
   case ProtocolState::MessageBegin:
     return messageBegin(buffer);
+  case ProtocolState::PassthroughData:
+    return passthroughData(buffer);
   case ProtocolState::StructBegin:
     return structBegin(buffer);
   case ProtocolState::StructEnd:
@@ -19,6 +19,7 @@ namespace ThriftProxy {
   FUNCTION(WaitForData)                                                                            \
   FUNCTION(MessageBegin)                                                                           \
   FUNCTION(MessageEnd)                                                                             \
+  FUNCTION(PassthroughData)                                                                        \
   FUNCTION(StructBegin)                                                                            \
   FUNCTION(StructEnd)                                                                              \
   FUNCTION(FieldBegin)                                                                             \
@@ -131,6 +132,7 @@ private:
   // or ProtocolState::WaitForData if more data is required.
   DecoderStatus messageBegin(Buffer::Instance& buffer);
   DecoderStatus messageEnd(Buffer::Instance& buffer);
+  DecoderStatus passthroughData(Buffer::Instance& buffer);
   DecoderStatus structBegin(Buffer::Instance& buffer);
   DecoderStatus structEnd(Buffer::Instance& buffer);
   DecoderStatus fieldBegin(Buffer::Instance& buffer);
@@ -167,6 +169,8 @@ private:
   DecoderEventHandler& handler_;
   ProtocolState state_;
   std::vector<Frame> stack_;
+  // The number of bytes in the body of a message that is passed through.
+  uint64_t body_bytes_{};
 };
 
 typedef std::unique_ptr<DecoderStateMachine> DecoderStateMachinePtr;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "envoy/buffer/buffer.h"
+
 #include "extensions/filters/network/thrift_proxy/metadata.h"
 #include "extensions/filters/network/thrift_proxy/thrift.h"
 
@@ -132,6 +134,22 @@ public:
    * @return FilterStatus to indicate if filter chain iteration should continue
    */
   virtual FilterStatus setEnd() PURE;
+
+  /**
+   * Indicates whether the body of the current message may be handed over undecoded, via
+   * passthroughData, instead of as struct, field and value events. Asked once per message, after
+   * messageBegin.
+   * @return bool true if the body of the message may be passed through
+   */
+  virtual bool passthroughEnabled() const PURE;
+
+  /**
+   * Indicates that the undecoded body of a message was received: every byte of the message after
+   * its message begin. Followed by messageEnd.
+   * @param data the body of the message, which may be drained or moved
+   * @return FilterStatus to indicate if filter chain iteration should continue
+   */
+  virtual FilterStatus passthroughData(Buffer::Instance& data) PURE;
 };
 
 typedef std::shared_ptr<DecoderEventHandler> DecoderEventHandlerSharedPtr;
@@ -178,6 +196,10 @@ public:
     return event_handler_->setBegin(elem_type, size);
   }
   FilterStatus setEnd() override { return event_handler_->setEnd(); }
+  bool passthroughEnabled() const override { return event_handler_->passthroughEnabled(); }
+  FilterStatus passthroughData(Buffer::Instance& data) override {
+    return event_handler_->passthroughData(data);
+  }
 
 protected:
   DecoderEventHandler* event_handler_{};
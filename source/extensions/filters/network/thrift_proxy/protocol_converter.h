@@ -121,6 +121,14 @@ public:
     return FilterStatus::Continue;
   }
 
+  // Converting a message requires its decoded body, unless the protocols match.
+  bool passthroughEnabled() const override { return false; }
+
+  FilterStatus passthroughData(Buffer::Instance& data) override {
+    buffer_->move(data);
+    return FilterStatus::Continue;
+  }
+
 protected:
   ProtocolType protocolType() const { return proto_->type(); }
 
@@ -1,6 +1,7 @@
 #include "extensions/filters/network/thrift_proxy/router/config.h"
 
 #include "envoy/registry/registry.h"
+#include "envoy/thread_local/thread_local.h"
 
 #include "extensions/filters/network/thrift_proxy/router/router_impl.h"
 
@@ -16,8 +17,14 @@ ThriftFilters::FilterFactoryCb RouterFilterConfig::createFilterFactoryFromProtoT
   UNREFERENCED_PARAMETER(proto_config);
   UNREFERENCED_PARAMETER(stat_prefix);
 
-  return [&context](ThriftFilters::FilterChainFactoryCallbacks& callbacks) -> void {
-    callbacks.addDecoderFilter(std::make_shared<Router>(context.clusterManager()));
+  std::shared_ptr<ThreadLocal::Slot> tls = context.threadLocal().allocateSlot();
+  tls->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ConnectionMultiplexer>();
+  });
+
+  return [&context, tls](ThriftFilters::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addDecoderFilter(std::make_shared<Router>(
+        context.clusterManager(), tls->getTyped<ConnectionMultiplexer>()));
   };
 }
 
@@ -0,0 +1,236 @@
+#include "extensions/filters/network/thrift_proxy/router/connection_multiplexer.h"
+
+#include <algorithm>
+#include <string>
+
+#include "envoy/common/exception.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+
+#include "extensions/filters/network/thrift_proxy/buffer_helper.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace ThriftProxy {
+namespace Router {
+
+const uint64_t MultiplexedConnection::SequenceIdPrefixSize;
+
+MultiplexedConnection::MultiplexedConnection(ConnectionMultiplexer& parent,
+                                             Tcp::ConnectionPool::Instance& pool,
+                                             Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
+                                             Upstream::HostDescriptionConstSharedPtr host,
+                                             TransportType transport_type,
+                                             ProtocolType protocol_type, uint32_t max_requests)
+    : parent_(parent), pool_(pool), conn_data_(std::move(conn_data)),
+      dispatcher_(conn_data_->connection().dispatcher()), host_(host),
+      transport_type_(transport_type), protocol_type_(protocol_type), max_requests_(max_requests),
+      transport_(NamedTransportConfigFactory::getFactory(transport_type).createTransport()),
+      protocol_(NamedProtocolConfigFactory::getFactory(protocol_type).createProtocol()) {
+  ASSERT(transport_type_ == TransportType::Framed || transport_type_ == TransportType::Header);
+
+  conn_data_->addUpstreamCallbacks(*this);
+  conn_state_ = conn_data_->connectionStateTyped<ThriftConnectionState>();
+  if (conn_state_ == nullptr) {
+    conn_data_->setConnectionState(std::make_unique<ThriftConnectionState>());
+    conn_state_ = conn_data_->connectionStateTyped<ThriftConnectionState>();
+  }
+}
+
+bool MultiplexedConnection::available(TransportType transport_type,
+                                      ProtocolType protocol_type) const {
+  return !released_ && transport_type == transport_type_ && protocol_type == protocol_type_ &&
+         requests_.size() + abandoned_requests_.size() < max_requests_;
+}
+
+void MultiplexedConnection::addRequest(int32_t sequence_id,
+                                       Tcp::ConnectionPool::UpstreamCallbacks& callbacks) {
+  ASSERT(!released_);
+  ASSERT(requests_.count(sequence_id) == 0);
+  requests_[sequence_id] = &callbacks;
+}
+
+void MultiplexedConnection::removeRequest(int32_t sequence_id, bool response_pending) {
+  if (requests_.erase(sequence_id) == 0) {
+    // The response was already handed over.
+    return;
+  }
+
+  if (response_pending) {
+    abandoned_requests_.insert(sequence_id);
+  }
+
+  if (requests_.empty()) {
+    release();
+  }
+}
+
+void MultiplexedConnection::onUpstreamData(Buffer::Instance& data, bool end_stream) {
+  try {
+    // Both the framed and the header transports prefix each frame with its size.
+    while (!released_ && data.length() >= sizeof(int32_t)) {
+      const int32_t frame_size = BufferHelper::peekI32(data);
+      if (frame_size <= 0) {
+        throw EnvoyException(fmt::format("invalid thrift frame size {}", frame_size));
+      }
+
+      const uint64_t length = static_cast<uint64_t>(frame_size) + sizeof(int32_t);
+      if (data.length() < length) {
+        // Wait for the rest of the frame.
+        break;
+      }
+
+      Buffer::OwnedImpl frame;
+      frame.move(data, length);
+
+      const int32_t sequence_id = sequenceId(frame);
+      auto request = requests_.find(sequence_id);
+      if (request == requests_.end()) {
+        if (abandoned_requests_.erase(sequence_id) == 0) {
+          throw EnvoyException(
+              fmt::format("unexpected thrift response sequence id {}", sequence_id));
+        }
+
+        ENVOY_CONN_LOG(debug, "discarding response to abandoned thrift request {}",
+                       conn_data_->connection(), sequence_id);
+        continue;
+      }
+
+      Tcp::ConnectionPool::UpstreamCallbacks& callbacks = *request->second;
+      requests_.erase(request);
+      callbacks.onUpstreamData(frame, true);
+
+      if (requests_.empty() && !released_) {
+        release();
+      }
+    }
+  } catch (const EnvoyException& ex) {
+    ENVOY_CONN_LOG(debug, "thrift multiplexed connection error: {}", conn_data_->connection(),
+                   ex.what());
+    // Closing the connection resets the requests that still wait on it.
+    conn_data_->connection().close(Network::ConnectionCloseType::NoFlush);
+    return;
+  }
+
+  if (released_) {
+    // Nothing more is expected from the connection.
+    data.drain(data.length());
+    return;
+  }
+
+  if (end_stream) {
+    // No more responses will arrive.
+    conn_data_->connection().close(Network::ConnectionCloseType::NoFlush);
+  }
+}
+
+void MultiplexedConnection::onEvent(Network::ConnectionEvent event) {
+  if (released_) {
+    return;
+  }
+
+  ASSERT(event != Network::ConnectionEvent::Connected);
+
+  // The callbacks may remove their requests, so stop tracking them first.
+  std::unordered_map<int32_t, Tcp::ConnectionPool::UpstreamCallbacks*> requests;
+  requests.swap(requests_);
+  abandoned_requests_.clear();
+  released_ = true;
+
+  for (auto& request : requests) {
+    request.second->onEvent(event);
+  }
+
+  parent_.removeConnection(*this);
+}
+
+int32_t MultiplexedConnection::sequenceId(const Buffer::Instance& frame) {
+  // The message begins near the start of the frame, so avoid copying all of a large frame.
+  const uint64_t prefix_size = std::min(frame.length(), SequenceIdPrefixSize);
+  std::string prefix(prefix_size, '\0');
+  frame.copyOut(0, prefix_size, &prefix[0]);
+
+  Buffer::OwnedImpl buffer(prefix);
+  absl::optional<int32_t> sequence_id = decodeSequenceId(buffer);
+  if (!sequence_id.has_value() && prefix_size < frame.length()) {
+    Buffer::OwnedImpl whole_frame(frame);
+    sequence_id = decodeSequenceId(whole_frame);
+  }
+
+  if (!sequence_id.has_value()) {
+    throw EnvoyException("invalid thrift response frame");
+  }
+
+  return sequence_id.value();
+}
+
+absl::optional<int32_t> MultiplexedConnection::decodeSequenceId(Buffer::Instance& buffer) {
+  MessageMetadata metadata;
+  if (!transport_->decodeFrameStart(buffer, metadata) ||
+      !protocol_->readMessageBegin(buffer, metadata) || !metadata.hasSequenceId()) {
+    return absl::nullopt;
+  }
+
+  return metadata.sequenceId();
+}
+
+void MultiplexedConnection::release() {
+  ASSERT(!released_ && requests_.empty());
+  released_ = true;
+
+  if (!abandoned_requests_.empty()) {
+    // A late response would be read by the next user of the connection.
+    conn_data_->connection().close(Network::ConnectionCloseType::NoFlush);
+  }
+
+  // The connection returns to its pool when this is deleted.
+  parent_.removeConnection(*this);
+}
+
+MultiplexedConnection* ConnectionMultiplexer::connection(Tcp::ConnectionPool::Instance& pool,
+                                                         TransportType transport_type,
+                                                         ProtocolType protocol_type) {
+  auto connections = connections_.find(&pool);
+  if (connections == connections_.end()) {
+    return nullptr;
+  }
+
+  for (MultiplexedConnectionPtr& connection : connections->second) {
+    if (connection->available(transport_type, protocol_type)) {
+      return connection.get();
+    }
+  }
+
+  return nullptr;
+}
+
+MultiplexedConnection& ConnectionMultiplexer::addConnection(
+    Tcp::ConnectionPool::Instance& pool, Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
+    Upstream::HostDescriptionConstSharedPtr host, TransportType transport_type,
+    ProtocolType protocol_type, uint32_t max_requests) {
+  MultiplexedConnectionPtr connection(new MultiplexedConnection(
+      *this, pool, std::move(conn_data), host, transport_type, protocol_type, max_requests));
+  MultiplexedConnection& ref = *connection;
+  connection->moveIntoList(std::move(connection), connections_[&pool]);
+  return ref;
+}
+
+void ConnectionMultiplexer::removeConnection(MultiplexedConnection& connection) {
+  auto connections = connections_.find(&connection.pool_);
+  ASSERT(connections != connections_.end());
+
+  // The connection may be in the middle of a callback.
+  connection.dispatcher_.deferredDelete(connection.removeFromList(connections->second));
+  if (connections->second.empty()) {
+    connections_.erase(connections);
+  }
+}
+
+} // namespace Router
+} // namespace ThriftProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
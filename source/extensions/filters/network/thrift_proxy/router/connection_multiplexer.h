@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/tcp/conn_pool.h"
+#include "envoy/thread_local/thread_local.h"
+#include "envoy/upstream/upstream.h"
+
+#include "common/common/linked_object.h"
+#include "common/common/logger.h"
+
+#include "extensions/filters/network/thrift_proxy/conn_state.h"
+#include "extensions/filters/network/thrift_proxy/protocol.h"
+#include "extensions/filters/network/thrift_proxy/transport.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace ThriftProxy {
+namespace Router {
+
+class ConnectionMultiplexer;
+
+/**
+ * An upstream connection that carries the requests of many routers at once. Routers make the
+ * sequence ids of their requests unique on the connection, and each response frame is handed to
+ * the router whose request has the frame's sequence id.
+ */
+class MultiplexedConnection : public Tcp::ConnectionPool::UpstreamCallbacks,
+                              public Event::DeferredDeletable,
+                              public LinkedObject<MultiplexedConnection>,
+                              Logger::Loggable<Logger::Id::thrift> {
+public:
+  MultiplexedConnection(ConnectionMultiplexer& parent, Tcp::ConnectionPool::Instance& pool,
+                        Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
+                        Upstream::HostDescriptionConstSharedPtr host, TransportType transport_type,
+                        ProtocolType protocol_type, uint32_t max_requests);
+
+  /**
+   * @param transport_type supplies the transport of a request.
+   * @param protocol_type supplies the protocol of a request.
+   * @return bool whether the connection can carry another request with the transport and
+   *         protocol.
+   */
+  bool available(TransportType transport_type, ProtocolType protocol_type) const;
+
+  /**
+   * Wait for the response to a request written to the connection. The response is handed to the
+   * callbacks as a single frame with end_stream set, after which the request no longer waits. If
+   * the connection closes first, the callbacks get the close event instead.
+   * @param sequence_id supplies the sequence id of the request.
+   * @param callbacks supplies the callbacks of the request.
+   */
+  void addRequest(int32_t sequence_id, Tcp::ConnectionPool::UpstreamCallbacks& callbacks);
+
+  /**
+   * Stop waiting for the response to a request. Once no request waits, the connection is returned
+   * to its pool, or closed if a response may still arrive for a request that stopped waiting.
+   * @param sequence_id supplies the sequence id of the request.
+   * @param response_pending supplies whether the upstream may still send a response.
+   */
+  void removeRequest(int32_t sequence_id, bool response_pending);
+
+  Network::ClientConnection& connection() { return conn_data_->connection(); }
+  ThriftConnectionState& connectionState() { return *conn_state_; }
+  const Upstream::HostDescriptionConstSharedPtr& host() const { return host_; }
+
+  // Tcp::ConnectionPool::UpstreamCallbacks
+  void onUpstreamData(Buffer::Instance& data, bool end_stream) override;
+  void onEvent(Network::ConnectionEvent event) override;
+  void onAboveWriteBufferHighWatermark() override {}
+  void onBelowWriteBufferLowWatermark() override {}
+
+private:
+  friend class ConnectionMultiplexer;
+
+  // The number of bytes at the start of a frame copied to find its sequence id.
+  static const uint64_t SequenceIdPrefixSize = 1024;
+
+  int32_t sequenceId(const Buffer::Instance& frame);
+  absl::optional<int32_t> decodeSequenceId(Buffer::Instance& buffer);
+  void release();
+
+  ConnectionMultiplexer& parent_;
+  Tcp::ConnectionPool::Instance& pool_;
+  Tcp::ConnectionPool::ConnectionDataPtr conn_data_;
+  Event::Dispatcher& dispatcher_;
+  const Upstream::HostDescriptionConstSharedPtr host_;
+  const TransportType transport_type_;
+  const ProtocolType protocol_type_;
+  const uint32_t max_requests_;
+  TransportPtr transport_;
+  ProtocolPtr protocol_;
+  ThriftConnectionState* conn_state_;
+
+  std::unordered_map<int32_t, Tcp::ConnectionPool::UpstreamCallbacks*> requests_;
+  // Sequence ids of the requests that stopped waiting for a response that may still arrive.
+  std::unordered_set<int32_t> abandoned_requests_;
+  bool released_{};
+};
+
+typedef std::unique_ptr<MultiplexedConnection> MultiplexedConnectionPtr;
+
+/**
+ * The upstream connections of a worker that are shared between requests, by connection pool.
+ */
+class ConnectionMultiplexer : public ThreadLocal::ThreadLocalObject {
+public:
+  /**
+   * @param pool supplies a connection pool.
+   * @param transport_type supplies the transport of a request.
+   * @param protocol_type supplies the protocol of a request.
+   * @return MultiplexedConnection* a shared connection of the pool that can carry the request, or
+   *         nullptr if there is none.
+   */
+  MultiplexedConnection* connection(Tcp::ConnectionPool::Instance& pool,
+                                    TransportType transport_type, ProtocolType protocol_type);
+
+  /**
+   * Share a connection of a pool between requests. The connection stays shared until it closes or
+   * no request waits on it.
+   * @param pool supplies the pool of the connection.
+   * @param conn_data supplies the connection.
+   * @param host supplies the upstream host of the connection.
+   * @param transport_type supplies the transport of the requests on the connection.
+   * @param protocol_type supplies the protocol of the requests on the connection.
+   * @param max_requests supplies the maximum number of requests waiting on the connection.
+   * @return MultiplexedConnection& the shared connection.
+   */
+  MultiplexedConnection& addConnection(Tcp::ConnectionPool::Instance& pool,
+                                       Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
+                                       Upstream::HostDescriptionConstSharedPtr host,
+                                       TransportType transport_type, ProtocolType protocol_type,
+                                       uint32_t max_requests);
+
+private:
+  friend class MultiplexedConnection;
+
+  void removeConnection(MultiplexedConnection& connection);
+
+  std::unordered_map<Tcp::ConnectionPool::Instance*, std::list<MultiplexedConnectionPtr>>
+      connections_;
+};
+
+} // namespace Router
+} // namespace ThriftProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
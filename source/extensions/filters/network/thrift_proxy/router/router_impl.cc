@@ -18,11 +18,7 @@ namespace Router {
 
 RouteEntryImplBase::RouteEntryImplBase(
     const envoy::config::filter::network::thrift_proxy::v2alpha1::Route& route)
-    : cluster_name_(route.route().cluster()) {
-  for (const auto& header_map : route.match().headers()) {
-    config_headers_.push_back(header_map);
-  }
-
+    : cluster_name_(route.route().cluster()), config_headers_(route.match().headers()) {
   if (route.route().has_metadata_match()) {
     const auto filter_it = route.route().metadata_match().filter_metadata().find(
         Envoy::Config::MetadataFilters::get().ENVOY_LB);
@@ -75,7 +71,7 @@ RouteConstSharedPtr RouteEntryImplBase::clusterEntry(uint64_t random_value) cons
 }
 
 bool RouteEntryImplBase::headersMatch(const Http::HeaderMap& headers) const {
-  return Http::HeaderUtility::matchHeaders(headers, config_headers_);
+  return config_headers_.matches(headers);
 }
 
 RouteEntryImplBase::WeightedClusterEntry::WeightedClusterEntry(
@@ -275,7 +271,9 @@ FilterStatus Router::messageBegin(MessageMetadataSharedPtr metadata) {
 
   ENVOY_STREAM_LOG(debug, "router decoding request", *callbacks_);
 
-  upstream_request_.reset(new UpstreamRequest(*this, *conn_pool, metadata, transport, protocol));
+  const uint32_t max_requests = options ? options->maxRequestsPerConnection() : 1;
+  upstream_request_.reset(
+      new UpstreamRequest(*this, *conn_pool, metadata, transport, protocol, max_requests));
   return upstream_request_->start();
 }
 
@@ -288,11 +286,19 @@ FilterStatus Router::messageEnd() {
 
   upstream_request_->transport_->encodeFrame(transport_buffer, *upstream_request_->metadata_,
                                              upstream_request_buffer_);
-  upstream_request_->conn_data_->connection().write(transport_buffer, false);
+  upstream_request_->connection().write(transport_buffer, false);
   upstream_request_->onRequestComplete();
   return FilterStatus::Continue;
 }
 
+bool Router::passthroughEnabled() const {
+  // The body of the request is forwarded as is, so it must already be in the upstream protocol.
+  // Upgraded protocols add a request header that the body lacks.
+  return upstream_request_ != nullptr &&
+         upstream_request_->protocol_->type() == callbacks_->downstreamProtocolType() &&
+         !upstream_request_->protocol_->supportsUpgrade();
+}
+
 void Router::onUpstreamData(Buffer::Instance& data, bool end_stream) {
   ASSERT(!upstream_request_->response_complete_);
 
@@ -335,6 +341,9 @@ void Router::onUpstreamData(Buffer::Instance& data, bool end_stream) {
 void Router::onEvent(Network::ConnectionEvent event) {
   ASSERT(upstream_request_ && !upstream_request_->response_complete_);
 
+  // A shared connection no longer tracks this request once it is closed.
+  upstream_request_->multiplexed_connection_ = nullptr;
+
   switch (event) {
   case Network::ConnectionEvent::RemoteClose:
     upstream_request_->onResetStream(
@@ -366,8 +375,9 @@ void Router::cleanup() { upstream_request_.reset(); }
 
 Router::UpstreamRequest::UpstreamRequest(Router& parent, Tcp::ConnectionPool::Instance& pool,
                                          MessageMetadataSharedPtr& metadata,
-                                         TransportType transport_type, ProtocolType protocol_type)
-    : parent_(parent), conn_pool_(pool), metadata_(metadata),
+                                         TransportType transport_type, ProtocolType protocol_type,
+                                         uint32_t max_requests)
+    : parent_(parent), conn_pool_(pool), metadata_(metadata), max_requests_(max_requests),
       transport_(NamedTransportConfigFactory::getFactory(transport_type).createTransport()),
       protocol_(NamedProtocolConfigFactory::getFactory(protocol_type).createProtocol()),
       request_complete_(false), response_started_(false), response_complete_(false) {}
@@ -375,6 +385,15 @@ Router::UpstreamRequest::UpstreamRequest(Router& parent, Tcp::ConnectionPool::In
 Router::UpstreamRequest::~UpstreamRequest() {}
 
 FilterStatus Router::UpstreamRequest::start() {
+  if (multiplexed()) {
+    MultiplexedConnection* connection =
+        parent_.multiplexer_.connection(conn_pool_, transport_->type(), protocol_->type());
+    if (connection != nullptr) {
+      onMultiplexedConnection(*connection, false);
+      return FilterStatus::Continue;
+    }
+  }
+
   Tcp::ConnectionPool::Cancellable* handle = conn_pool_.newConnection(*this);
   if (handle) {
     // Pause while we wait for a connection.
@@ -395,6 +414,15 @@ void Router::UpstreamRequest::resetStream() {
     conn_pool_handle_->cancel();
   }
 
+  if (multiplexed_connection_ != nullptr) {
+    // Other requests share the connection, so leave it open and discard a late response.
+    conn_state_ = nullptr;
+    multiplexed_connection_->removeRequest(
+        metadata_->sequenceId(),
+        request_complete_ && metadata_->messageType() != MessageType::Oneway);
+    multiplexed_connection_ = nullptr;
+  }
+
   if (conn_data_ != nullptr) {
     conn_state_ = nullptr;
     conn_data_->connection().close(Network::ConnectionCloseType::NoFlush);
@@ -416,10 +444,19 @@ void Router::UpstreamRequest::onPoolReady(Tcp::ConnectionPool::ConnectionDataPtr
   // Only invoke continueDecoding if we'd previously stopped the filter chain.
   bool continue_decoding = conn_pool_handle_ != nullptr;
 
+  conn_pool_handle_ = nullptr;
+
+  if (multiplexed()) {
+    onMultiplexedConnection(
+        parent_.multiplexer_.addConnection(conn_pool_, std::move(conn_data), host,
+                                           transport_->type(), protocol_->type(), max_requests_),
+        continue_decoding);
+    return;
+  }
+
   onUpstreamHostSelected(host);
   conn_data_ = std::move(conn_data);
   conn_data_->addUpstreamCallbacks(parent_);
-  conn_pool_handle_ = nullptr;
 
   conn_state_ = conn_data_->connectionStateTyped<ThriftConnectionState>();
   if (conn_state_ == nullptr) {
@@ -439,12 +476,24 @@ void Router::UpstreamRequest::onPoolReady(Tcp::ConnectionPool::ConnectionDataPtr
   onRequestStart(continue_decoding);
 }
 
+void Router::UpstreamRequest::onMultiplexedConnection(MultiplexedConnection& connection,
+                                                      bool continue_decoding) {
+  multiplexed_connection_ = &connection;
+  conn_state_ = &connection.connectionState();
+  onUpstreamHostSelected(connection.host());
+  onRequestStart(continue_decoding);
+}
+
 void Router::UpstreamRequest::onRequestStart(bool continue_decoding) {
   parent_.initProtocolConverter(*protocol_, parent_.upstream_request_buffer_);
 
   metadata_->setSequenceId(conn_state_->nextSequenceId());
   parent_.convertMessageBegin(metadata_);
 
+  if (multiplexed_connection_ != nullptr) {
+    multiplexed_connection_->addRequest(metadata_->sequenceId(), parent_);
+  }
+
   if (continue_decoding) {
     parent_.callbacks_->continueDecoding();
   }
@@ -456,12 +505,34 @@ void Router::UpstreamRequest::onResponseComplete() {
   response_complete_ = true;
   conn_state_ = nullptr;
   conn_data_.reset();
+
+  if (multiplexed_connection_ != nullptr) {
+    multiplexed_connection_->removeRequest(metadata_->sequenceId(), false);
+    multiplexed_connection_ = nullptr;
+  }
 }
 
 void Router::UpstreamRequest::onUpstreamHostSelected(Upstream::HostDescriptionConstSharedPtr host) {
   upstream_host_ = host;
 }
 
+bool Router::UpstreamRequest::multiplexed() const {
+  // Responses can only be told apart when each one is a frame of a known size. Protocols that
+  // upgrade connections hold per connection state that requests could not share.
+  return max_requests_ > 1 &&
+         (transport_->type() == TransportType::Framed ||
+          transport_->type() == TransportType::Header) &&
+         !protocol_->supportsUpgrade();
+}
+
+Network::ClientConnection& Router::UpstreamRequest::connection() {
+  if (multiplexed_connection_ != nullptr) {
+    return multiplexed_connection_->connection();
+  }
+
+  return conn_data_->connection();
+}
+
 void Router::UpstreamRequest::onResetStream(Tcp::ConnectionPool::PoolFailureReason reason) {
   if (metadata_->messageType() == MessageType::Oneway) {
     // For oneway requests, we should not attempt a response. Reset the downstream to signal
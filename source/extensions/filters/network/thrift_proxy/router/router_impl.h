@@ -15,6 +15,7 @@
 
 #include "extensions/filters/network/thrift_proxy/conn_manager.h"
 #include "extensions/filters/network/thrift_proxy/filters/filter.h"
+#include "extensions/filters/network/thrift_proxy/router/connection_multiplexer.h"
 #include "extensions/filters/network/thrift_proxy/router/router.h"
 #include "extensions/filters/network/thrift_proxy/thrift_object.h"
 
@@ -81,7 +82,7 @@ private:
   typedef std::shared_ptr<WeightedClusterEntry> WeightedClusterEntrySharedPtr;
 
   const std::string cluster_name_;
-  std::vector<Http::HeaderUtility::HeaderData> config_headers_;
+  const Http::HeaderUtility::HeaderMatcherSet config_headers_;
   std::vector<WeightedClusterEntrySharedPtr> weighted_clusters_;
   uint64_t total_cluster_weight_;
   Envoy::Router::MetadataMatchCriteriaConstPtr metadata_match_criteria_;
@@ -137,7 +138,8 @@ class Router : public Tcp::ConnectionPool::UpstreamCallbacks,
                public ThriftFilters::DecoderFilter,
                Logger::Loggable<Logger::Id::thrift> {
 public:
-  Router(Upstream::ClusterManager& cluster_manager) : cluster_manager_(cluster_manager) {}
+  Router(Upstream::ClusterManager& cluster_manager, ConnectionMultiplexer& multiplexer)
+      : cluster_manager_(cluster_manager), multiplexer_(multiplexer) {}
 
   ~Router() {}
 
@@ -151,6 +153,7 @@ public:
   FilterStatus transportEnd() override;
   FilterStatus messageBegin(MessageMetadataSharedPtr metadata) override;
   FilterStatus messageEnd() override;
+  bool passthroughEnabled() const override;
 
   // Upstream::LoadBalancerContext
   const Network::Connection* downstreamConnection() const override;
@@ -171,7 +174,7 @@ private:
   struct UpstreamRequest : public Tcp::ConnectionPool::Callbacks {
     UpstreamRequest(Router& parent, Tcp::ConnectionPool::Instance& pool,
                     MessageMetadataSharedPtr& metadata, TransportType transport_type,
-                    ProtocolType protocol_type);
+                    ProtocolType protocol_type, uint32_t max_requests);
     ~UpstreamRequest();
 
     FilterStatus start();
@@ -183,18 +186,25 @@ private:
     void onPoolReady(Tcp::ConnectionPool::ConnectionDataPtr&& conn,
                      Upstream::HostDescriptionConstSharedPtr host) override;
 
+    void onMultiplexedConnection(MultiplexedConnection& connection, bool continue_decoding);
     void onRequestStart(bool continue_decoding);
     void onRequestComplete();
     void onResponseComplete();
     void onUpstreamHostSelected(Upstream::HostDescriptionConstSharedPtr host);
     void onResetStream(Tcp::ConnectionPool::PoolFailureReason reason);
 
+    bool multiplexed() const;
+    Network::ClientConnection& connection();
+
     Router& parent_;
     Tcp::ConnectionPool::Instance& conn_pool_;
     MessageMetadataSharedPtr metadata_;
+    const uint32_t max_requests_;
 
     Tcp::ConnectionPool::Cancellable* conn_pool_handle_{};
     Tcp::ConnectionPool::ConnectionDataPtr conn_data_;
+    // Set instead of conn_data_ when the connection is shared with other requests.
+    MultiplexedConnection* multiplexed_connection_{};
     Upstream::HostDescriptionConstSharedPtr upstream_host_;
     ThriftConnectionState* conn_state_{};
     TransportPtr transport_;
@@ -210,6 +220,7 @@ private:
   void cleanup();
 
   Upstream::ClusterManager& cluster_manager_;
+  ConnectionMultiplexer& multiplexer_;
 
   ThriftFilters::DecoderFilterCallbacks* callbacks_{};
   RouteConstSharedPtr route_{};
@@ -0,0 +1,171 @@
+#include "extensions/filters/udp/udp_proxy/udp_proxy_filter.h"
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+
+UdpProxyFilterConfig::UdpProxyFilterConfig(
+    Upstream::ClusterManager& cluster_manager, Stats::Scope& scope,
+    const envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig& config)
+    : cluster_manager_(cluster_manager), cluster_(config.cluster()),
+      session_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(config, idle_timeout, 60 * 1000)),
+      stats_scope_(scope.createScope(fmt::format("udp.{}.", config.stat_prefix()))),
+      stats_(generateStats(*stats_scope_)) {}
+
+UdpProxyStats UdpProxyFilterConfig::generateStats(Stats::Scope& scope) {
+  return {ALL_UDP_PROXY_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope))};
+}
+
+UdpProxyFilter::UdpProxyFilter(Network::UdpReadFilterCallbacks& callbacks,
+                               const UdpProxyFilterConfigSharedPtr& config)
+    : UdpListenerReadFilter(callbacks), config_(config),
+      dispatcher_(callbacks.udpListener().dispatcher()) {}
+
+UdpProxyFilter::~UdpProxyFilter() {
+  config_->stats().downstream_sess_active_.sub(sessions_.size());
+}
+
+void UdpProxyFilter::onData(Network::UdpRecvData& data) {
+  const std::string& peer_address = data.peer_address_->asString();
+  auto it = sessions_.find(peer_address);
+  if (it == sessions_.end()) {
+    Upstream::ThreadLocalCluster* cluster = config_->getCluster();
+    Upstream::HostConstSharedPtr host;
+    if (cluster != nullptr) {
+      LoadBalancerContext context(*data.peer_address_);
+      host = cluster->loadBalancer().chooseHost(&context);
+    }
+    if (host == nullptr) {
+      ENVOY_LOG(debug, "no healthy upstream host for udp peer {}", peer_address);
+      config_->stats().downstream_sess_no_healthy_host_.inc();
+      return;
+    }
+
+    ENVOY_LOG(debug, "new udp session for peer {} to host {}", peer_address,
+              host->address()->asString());
+    config_->stats().downstream_sess_total_.inc();
+    config_->stats().downstream_sess_active_.inc();
+    it = sessions_
+             .emplace(peer_address,
+                      std::make_unique<ActiveSession>(*this, data.peer_address_, host))
+             .first;
+  }
+
+  config_->stats().downstream_sess_rx_datagrams_.inc();
+  it->second->write(*data.buffer_);
+}
+
+void UdpProxyFilter::removeSession(const ActiveSession& session, const std::string& peer_address) {
+  auto it = sessions_.find(peer_address);
+  ASSERT(it != sessions_.end() && it->second.get() == &session);
+  config_->stats().downstream_sess_active_.dec();
+  // The session is removed from its own timer callback.
+  dispatcher_.deferredDelete(std::move(it->second));
+  sessions_.erase(it);
+}
+
+UdpProxyFilter::LoadBalancerContext::LoadBalancerContext(
+    const Network::Address::Instance& peer_address) {
+  if (peer_address.ip() != nullptr) {
+    hash_ = HashUtil::xxHash64(peer_address.ip()->addressAsString());
+  }
+}
+
+UdpProxyFilter::ActiveSession::ActiveSession(
+    UdpProxyFilter& parent, const Network::Address::InstanceConstSharedPtr& peer_address,
+    const Upstream::HostConstSharedPtr& host)
+    : parent_(parent), peer_address_(peer_address), host_(host),
+      fd_(host->address()->socket(Network::Address::SocketType::Datagram)),
+      idle_timer_(parent.dispatcher_.createTimer([this] { onIdleTimer(); })) {
+  RELEASE_ASSERT(fd_ != -1, "");
+  // Connecting a datagram socket only sets its default destination, and makes the kernel drop
+  // datagrams from other sources.
+  const Api::SysCallIntResult result = host_->address()->connect(fd_);
+  if (result.rc_ == -1) {
+    ENVOY_LOG(debug, "udp session to {} failed to connect: {}", host_->address()->asString(),
+              strerror(result.errno_));
+  }
+  file_event_ = parent.dispatcher_.createFileEvent(
+      fd_, [this](uint32_t) { onReadReady(); }, Event::FileTriggerType::Level,
+      Event::FileReadyType::Read);
+  idle_timer_->enableTimer(parent_.config_->sessionTimeout());
+}
+
+UdpProxyFilter::ActiveSession::~ActiveSession() {
+  file_event_.reset();
+  ::close(fd_);
+}
+
+void UdpProxyFilter::ActiveSession::write(Buffer::Instance& data) {
+  idle_timer_->enableTimer(parent_.config_->sessionTimeout());
+
+  const uint64_t num_slices = data.getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  data.getRawSlices(slices, num_slices);
+  iovec iovs[num_slices];
+  for (uint64_t i = 0; i < num_slices; ++i) {
+    iovs[i].iov_base = slices[i].mem_;
+    iovs[i].iov_len = slices[i].len_;
+  }
+
+  const Api::SysCallSizeResult result = host_->address()->sendTo(fd_, iovs, num_slices);
+  if (result.rc_ == -1) {
+    ENVOY_LOG(trace, "udp send to {} failed: {}", host_->address()->asString(),
+              strerror(result.errno_));
+    parent_.config_->stats().upstream_tx_errors_.inc();
+  }
+}
+
+void UdpProxyFilter::ActiveSession::onReadReady() {
+  idle_timer_->enableTimer(parent_.config_->sessionTimeout());
+  parent_.reader_.read(
+      fd_,
+      [this](const char* data, uint64_t size, const sockaddr_storage&, socklen_t) {
+        onReply(data, size);
+      },
+      [this]() { flushReplies(); });
+}
+
+void UdpProxyFilter::ActiveSession::onReply(const char* data, uint64_t size) {
+  ASSERT(num_replies_ < Network::UdpBatchReader::MAX_BATCH_SIZE);
+  replies_[num_replies_].mem_ = const_cast<char*>(data);
+  replies_[num_replies_].len_ = size;
+  num_replies_++;
+}
+
+void UdpProxyFilter::ActiveSession::flushReplies() {
+  if (num_replies_ == 0) {
+    return;
+  }
+
+  // Datagrams are not queued, so the replies that do not fit into the socket send buffer are
+  // dropped, as they would be by a congested network.
+  const Api::SysCallIntResult result =
+      parent_.read_callbacks_->udpListener().sendBatch(*peer_address_, replies_, num_replies_);
+  const uint32_t sent = result.rc_ > 0 ? result.rc_ : 0;
+  parent_.config_->stats().downstream_sess_tx_datagrams_.add(sent);
+  parent_.config_->stats().downstream_sess_tx_errors_.add(num_replies_ - sent);
+  num_replies_ = 0;
+}
+
+void UdpProxyFilter::ActiveSession::onIdleTimer() {
+  ENVOY_LOG(debug, "udp session for peer {} timed out", peer_address_->asString());
+  parent_.config_->stats().idle_timeout_.inc();
+  file_event_.reset();
+  parent_.removeSession(*this, peer_address_->asString());
+}
+
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/config/filter/udp/udp_proxy/v2alpha/udp_proxy.pb.h"
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/file_event.h"
+#include "envoy/event/timer.h"
+#include "envoy/network/filter.h"
+#include "envoy/network/listener.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/upstream/cluster_manager.h"
+#include "envoy/upstream/upstream.h"
+
+#include "common/common/logger.h"
+#include "common/network/udp_listener_impl.h"
+#include "common/upstream/load_balancer_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+
+/**
+ * All udp proxy stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_UDP_PROXY_STATS(COUNTER, GAUGE)                                                        \
+  COUNTER(downstream_sess_total)                                                                   \
+  GAUGE  (downstream_sess_active)                                                                  \
+  COUNTER(downstream_sess_rx_datagrams)                                                            \
+  COUNTER(downstream_sess_tx_datagrams)                                                            \
+  COUNTER(downstream_sess_tx_errors)                                                               \
+  COUNTER(downstream_sess_no_healthy_host)                                                         \
+  COUNTER(idle_timeout)                                                                            \
+  COUNTER(upstream_tx_errors)
+// clang-format on
+
+/**
+ * Struct definition for all udp proxy stats. @see stats_macros.h
+ */
+struct UdpProxyStats {
+  ALL_UDP_PROXY_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * Configuration shared by the UDP proxy filters of all workers.
+ */
+class UdpProxyFilterConfig {
+public:
+  UdpProxyFilterConfig(
+      Upstream::ClusterManager& cluster_manager, Stats::Scope& scope,
+      const envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig& config);
+
+  Upstream::ThreadLocalCluster* getCluster() const { return cluster_manager_.get(cluster_); }
+  std::chrono::milliseconds sessionTimeout() const { return session_timeout_; }
+  UdpProxyStats& stats() const { return stats_; }
+
+private:
+  static UdpProxyStats generateStats(Stats::Scope& scope);
+
+  Upstream::ClusterManager& cluster_manager_;
+  const std::string cluster_;
+  const std::chrono::milliseconds session_timeout_;
+  Stats::ScopePtr stats_scope_;
+  mutable UdpProxyStats stats_;
+};
+
+typedef std::shared_ptr<const UdpProxyFilterConfig> UdpProxyFilterConfigSharedPtr;
+
+/**
+ * UDP listener filter forwarding the datagrams of each downstream peer to an upstream host over a
+ * session with its own connected upstream socket. Replies are read in batches and sent back to
+ * the peer from the listener's socket with a single sendBatch() per batch.
+ */
+class UdpProxyFilter : public Network::UdpListenerReadFilter,
+                       Logger::Loggable<Logger::Id::filter> {
+public:
+  UdpProxyFilter(Network::UdpReadFilterCallbacks& callbacks,
+                 const UdpProxyFilterConfigSharedPtr& config);
+  ~UdpProxyFilter();
+
+  // Network::UdpListenerReadFilter
+  void onData(Network::UdpRecvData& data) override;
+
+  size_t numSessions() const { return sessions_.size(); }
+
+private:
+  /**
+   * A downstream peer and the upstream host its datagrams are forwarded to. The session is closed
+   * when no datagram was forwarded in either direction for the session timeout.
+   */
+  class ActiveSession : public Event::DeferredDeletable {
+  public:
+    ActiveSession(UdpProxyFilter& parent,
+                  const Network::Address::InstanceConstSharedPtr& peer_address,
+                  const Upstream::HostConstSharedPtr& host);
+    ~ActiveSession();
+
+    void write(Buffer::Instance& data);
+
+  private:
+    void onReadReady();
+    void onIdleTimer();
+    void onReply(const char* data, uint64_t size);
+    void flushReplies();
+
+    UdpProxyFilter& parent_;
+    const Network::Address::InstanceConstSharedPtr peer_address_;
+    const Upstream::HostConstSharedPtr host_;
+    const int fd_;
+    Event::FileEventPtr file_event_;
+    const Event::TimerPtr idle_timer_;
+    // The replies of the batch being read, pointing into the storage of the parent's reader.
+    Buffer::RawSlice replies_[Network::UdpBatchReader::MAX_BATCH_SIZE];
+    uint32_t num_replies_{};
+  };
+
+  typedef std::unique_ptr<ActiveSession> ActiveSessionPtr;
+
+  /**
+   * Hashes the downstream peer's IP address, so that hashing load balancers send the datagrams of
+   * a peer to the same host across sessions and workers.
+   */
+  class LoadBalancerContext : public Upstream::LoadBalancerContextBase {
+  public:
+    LoadBalancerContext(const Network::Address::Instance& peer_address);
+
+    // Upstream::LoadBalancerContext
+    absl::optional<uint64_t> computeHashKey() override { return hash_; }
+
+  private:
+    absl::optional<uint64_t> hash_;
+  };
+
+  void removeSession(const ActiveSession& session, const std::string& peer_address);
+
+  const UdpProxyFilterConfigSharedPtr config_;
+  Event::Dispatcher& dispatcher_;
+  // Reads the replies of all sessions, which are only read on this filter's worker.
+  Network::UdpBatchReader reader_;
+  // Sessions by the downstream peer's address.
+  std::unordered_map<std::string, ActiveSessionPtr> sessions_;
+};
+
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
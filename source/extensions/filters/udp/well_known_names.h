@@ -0,0 +1,23 @@
+#pragma once
+
+#include "common/singleton/const_singleton.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+
+/**
+ * Well-known UDP listener filter names.
+ * NOTE: New filters should use the well known name: envoy.filters.udp.name.
+ */
+class UdpFilterNameValues {
+public:
+  // UDP proxy filter
+  const std::string UdpProxy = "envoy.filters.udp.udp_proxy";
+};
+
+typedef ConstSingleton<UdpFilterNameValues> UdpFilterNames;
+
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
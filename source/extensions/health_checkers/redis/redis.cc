@@ -5,6 +5,14 @@ namespace Extensions {
 namespace HealthCheckers {
 namespace RedisHealthChecker {
 
+namespace {
+
+uint64_t failureCount(const Upstream::HostStats& stats) {
+  return stats.rq_error_.value() + stats.rq_timeout_.value() + stats.cx_connect_fail_.value();
+}
+
+} // namespace
+
 RedisHealthChecker::RedisHealthChecker(
     const Upstream::Cluster& cluster, const envoy::api::v2::core::HealthCheck& config,
     const envoy::config::health_checker::redis::v2::Redis& redis_config,
@@ -12,7 +20,8 @@ RedisHealthChecker::RedisHealthChecker(
     Upstream::HealthCheckEventLoggerPtr&& event_logger,
     Extensions::NetworkFilters::RedisProxy::ConnPool::ClientFactory& client_factory)
     : HealthCheckerImplBase(cluster, config, dispatcher, runtime, random, std::move(event_logger)),
-      client_factory_(client_factory), key_(redis_config.key()) {
+      client_factory_(client_factory), key_(redis_config.key()),
+      skip_probe_on_traffic_(redis_config.skip_probe_on_traffic()) {
   if (!key_.empty()) {
     type_ = Type::Exists;
   } else {
@@ -22,7 +31,12 @@ RedisHealthChecker::RedisHealthChecker(
 
 RedisHealthChecker::RedisActiveHealthCheckSession::RedisActiveHealthCheckSession(
     RedisHealthChecker& parent, const Upstream::HostSharedPtr& host)
-    : ActiveHealthCheckSession(parent, host), parent_(parent) {}
+    : ActiveHealthCheckSession(parent, host), parent_(parent) {
+  if (parent_.skip_probe_on_traffic_ && parent_.type_ == Type::Ping) {
+    skipped_check_timer_ = parent_.dispatcher_.createTimer([this]() -> void { handleSuccess(); });
+  }
+  updateTrafficCounts();
+}
 
 RedisHealthChecker::RedisActiveHealthCheckSession::~RedisActiveHealthCheckSession() {
   if (current_request_) {
@@ -44,7 +58,25 @@ void RedisHealthChecker::RedisActiveHealthCheckSession::onEvent(Network::Connect
   }
 }
 
+bool RedisHealthChecker::RedisActiveHealthCheckSession::trafficSinceLastCheck() const {
+  const Upstream::HostStats& stats = host_->stats();
+  return stats.rq_success_.value() > rq_success_ && failureCount(stats) == rq_failures_;
+}
+
+void RedisHealthChecker::RedisActiveHealthCheckSession::updateTrafficCounts() {
+  // The counters include the checks themselves, so they are read after each check.
+  const Upstream::HostStats& stats = host_->stats();
+  rq_success_ = stats.rq_success_.value();
+  rq_failures_ = failureCount(stats);
+}
+
 void RedisHealthChecker::RedisActiveHealthCheckSession::onInterval() {
+  if (skipped_check_timer_ != nullptr && trafficSinceLastCheck()) {
+    updateTrafficCounts();
+    skipped_check_timer_->enableTimer(std::chrono::milliseconds(0));
+    return;
+  }
+
   if (!client_) {
     client_ = parent_.client_factory_.create(host_, parent_.dispatcher_, *this);
     client_->addConnectionCallbacks(*this);
@@ -67,6 +99,7 @@ void RedisHealthChecker::RedisActiveHealthCheckSession::onInterval() {
 void RedisHealthChecker::RedisActiveHealthCheckSession::onResponse(
     Extensions::NetworkFilters::RedisProxy::RespValuePtr&& value) {
   current_request_ = nullptr;
+  updateTrafficCounts();
 
   switch (parent_.type_) {
   case Type::Exists:
@@ -96,6 +129,7 @@ void RedisHealthChecker::RedisActiveHealthCheckSession::onResponse(
 
 void RedisHealthChecker::RedisActiveHealthCheckSession::onFailure() {
   current_request_ = nullptr;
+  updateTrafficCounts();
   handleFailure(envoy::data::core::v2alpha::HealthCheckFailureType::NETWORK);
 }
 
@@ -103,6 +137,7 @@ void RedisHealthChecker::RedisActiveHealthCheckSession::onTimeout() {
   current_request_->cancel();
   current_request_ = nullptr;
   client_->close();
+  updateTrafficCounts();
 }
 
 RedisHealthChecker::HealthCheckRequest::HealthCheckRequest(const std::string& key) {
@@ -51,6 +51,9 @@ private:
     void onInterval() override;
     void onTimeout() override;
 
+    bool trafficSinceLastCheck() const;
+    void updateTrafficCounts();
+
     // Extensions::NetworkFilters::RedisProxy::ConnPool::Config
     bool disableOutlierEvents() const override { return true; }
     std::chrono::milliseconds opTimeout() const override {
@@ -70,6 +73,11 @@ private:
     RedisHealthChecker& parent_;
     Extensions::NetworkFilters::RedisProxy::ConnPool::ClientPtr client_;
     Extensions::NetworkFilters::RedisProxy::ConnPool::PoolRequest* current_request_{};
+    // Passes a check skipped because of proxied commands, once the check has started.
+    Event::TimerPtr skipped_check_timer_;
+    // The host counters as of the last check, to tell whether proxied commands succeeded since.
+    uint64_t rq_success_{};
+    uint64_t rq_failures_{};
   };
 
   enum class Type { Ping, Exists };
@@ -91,6 +99,7 @@ private:
   Extensions::NetworkFilters::RedisProxy::ConnPool::ClientFactory& client_factory_;
   Type type_;
   const std::string key_;
+  const bool skip_probe_on_traffic_;
 };
 
 } // namespace RedisHealthChecker
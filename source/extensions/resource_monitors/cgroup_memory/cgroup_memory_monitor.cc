@@ -0,0 +1,104 @@
+#include "extensions/resource_monitors/cgroup_memory/cgroup_memory_monitor.h"
+
+#include "envoy/common/exception.h"
+
+#include "common/common/fmt.h"
+#include "common/filesystem/filesystem_impl.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace CgroupMemoryMonitor {
+
+namespace {
+// cgroup v1 reports the largest page aligned int64 when there is no limit.
+constexpr uint64_t CgroupV1Unlimited = 0x7FFFFFFFFFFFF000;
+} // namespace
+
+CgroupMemoryStatsReader::CgroupMemoryStatsReader(const std::string& cgroup_path)
+    : path_(cgroup_path) {
+  v2_ = Filesystem::fileExists(path_ + "/memory.current");
+  if (!v2_ && !Filesystem::fileExists(path_ + "/memory.usage_in_bytes")) {
+    path_ += "/memory";
+  }
+}
+
+std::string CgroupMemoryStatsReader::readFile(const std::string& name) {
+  return Filesystem::fileReadToEnd(fmt::format("{}/{}", path_, name));
+}
+
+uint64_t CgroupMemoryStatsReader::readBytes(const std::string& name) {
+  uint64_t bytes;
+  if (!absl::SimpleAtoi(absl::StripAsciiWhitespace(readFile(name)), &bytes)) {
+    throw EnvoyException(fmt::format("failed to parse {}/{}", path_, name));
+  }
+  return bytes;
+}
+
+uint64_t CgroupMemoryStatsReader::workingSetBytes() {
+  const uint64_t usage = readBytes(v2_ ? "memory.current" : "memory.usage_in_bytes");
+  const absl::string_view inactive_file_key = v2_ ? "inactive_file" : "total_inactive_file";
+
+  uint64_t inactive_file = 0;
+  const std::string stat = readFile("memory.stat");
+  for (absl::string_view line : absl::StrSplit(stat, '\n', absl::SkipEmpty())) {
+    const std::pair<absl::string_view, absl::string_view> entry = absl::StrSplit(line, ' ');
+    if (entry.first == inactive_file_key) {
+      if (!absl::SimpleAtoi(entry.second, &inactive_file)) {
+        throw EnvoyException(fmt::format("failed to parse {} of {}/memory.stat",
+                                         inactive_file_key, path_));
+      }
+      break;
+    }
+  }
+
+  return inactive_file < usage ? usage - inactive_file : 0;
+}
+
+absl::optional<uint64_t> CgroupMemoryStatsReader::limitBytes() {
+  if (v2_) {
+    if (absl::StripAsciiWhitespace(readFile("memory.max")) == "max") {
+      return absl::nullopt;
+    }
+    return readBytes("memory.max");
+  }
+
+  const uint64_t limit = readBytes("memory.limit_in_bytes");
+  if (limit >= CgroupV1Unlimited) {
+    return absl::nullopt;
+  }
+  return limit;
+}
+
+CgroupMemoryMonitor::CgroupMemoryMonitor(
+    const envoy::config::resource_monitor::cgroup_memory::v2alpha::CgroupMemoryConfig& config,
+    std::unique_ptr<CgroupMemoryStatsReader> stats)
+    : max_memory_(config.max_memory_bytes()), stats_(std::move(stats)) {}
+
+void CgroupMemoryMonitor::updateResourceUsage(Server::ResourceMonitor::Callbacks& callbacks) {
+  try {
+    absl::optional<uint64_t> limit = stats_->limitBytes();
+    if (max_memory_ > 0 && (!limit.has_value() || max_memory_ < limit.value())) {
+      limit = max_memory_;
+    }
+    if (!limit.has_value() || limit.value() == 0) {
+      throw EnvoyException("cgroup has no memory limit and max_memory_bytes is not set");
+    }
+
+    Server::ResourceUsage usage;
+    usage.resource_pressure_ =
+        std::min(1.0, stats_->workingSetBytes() / static_cast<double>(limit.value()));
+    callbacks.onSuccess(usage);
+  } catch (const EnvoyException& error) {
+    callbacks.onFailure(error);
+  }
+}
+
+} // namespace CgroupMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
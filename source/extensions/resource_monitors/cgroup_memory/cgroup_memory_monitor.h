@@ -0,0 +1,56 @@
+#pragma once
+
+#include "envoy/config/resource_monitor/cgroup_memory/v2alpha/cgroup_memory.pb.validate.h"
+#include "envoy/server/resource_monitor.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace CgroupMemoryMonitor {
+
+/**
+ * Helper class for reading the memory accounting of a cgroup v1 or v2 memory controller.
+ * Throws EnvoyException when the accounting files can not be read.
+ */
+class CgroupMemoryStatsReader {
+public:
+  CgroupMemoryStatsReader(const std::string& cgroup_path);
+  virtual ~CgroupMemoryStatsReader() {}
+
+  // Memory charged to the cgroup less its inactive file backed pages.
+  virtual uint64_t workingSetBytes();
+  // Memory limit of the cgroup, if it has one.
+  virtual absl::optional<uint64_t> limitBytes();
+
+private:
+  std::string readFile(const std::string& name);
+  uint64_t readBytes(const std::string& name);
+
+  std::string path_;
+  bool v2_;
+};
+
+/**
+ * Memory monitor of the cgroup Envoy runs in, so that the overload manager can act before the
+ * cgroup's OOM killer does.
+ */
+class CgroupMemoryMonitor : public Server::ResourceMonitor {
+public:
+  CgroupMemoryMonitor(
+      const envoy::config::resource_monitor::cgroup_memory::v2alpha::CgroupMemoryConfig& config,
+      std::unique_ptr<CgroupMemoryStatsReader> stats);
+
+  // Server::ResourceMonitor
+  void updateResourceUsage(Server::ResourceMonitor::Callbacks& callbacks) override;
+
+private:
+  const uint64_t max_memory_;
+  std::unique_ptr<CgroupMemoryStatsReader> stats_;
+};
+
+} // namespace CgroupMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,33 @@
+#include "extensions/resource_monitors/cgroup_memory/config.h"
+
+#include "envoy/registry/registry.h"
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/resource_monitors/cgroup_memory/cgroup_memory_monitor.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace CgroupMemoryMonitor {
+
+Server::ResourceMonitorPtr CgroupMemoryMonitorFactory::createResourceMonitorFromProtoTyped(
+    const envoy::config::resource_monitor::cgroup_memory::v2alpha::CgroupMemoryConfig& config,
+    Server::Configuration::ResourceMonitorFactoryContext& /*unused_context*/) {
+  const std::string& cgroup_path =
+      config.cgroup_path().empty() ? "/sys/fs/cgroup" : config.cgroup_path();
+  return std::make_unique<CgroupMemoryMonitor>(
+      config, std::make_unique<CgroupMemoryStatsReader>(cgroup_path));
+}
+
+/**
+ * Static registration for the cgroup memory resource monitor factory. @see RegistryFactory.
+ */
+static Registry::RegisterFactory<CgroupMemoryMonitorFactory,
+                                 Server::Configuration::ResourceMonitorFactory>
+    registered_;
+
+} // namespace CgroupMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
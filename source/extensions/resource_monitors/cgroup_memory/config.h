@@ -0,0 +1,29 @@
+#pragma once
+
+#include "envoy/config/resource_monitor/cgroup_memory/v2alpha/cgroup_memory.pb.validate.h"
+#include "envoy/server/resource_monitor_config.h"
+
+#include "extensions/resource_monitors/common/factory_base.h"
+#include "extensions/resource_monitors/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace CgroupMemoryMonitor {
+
+class CgroupMemoryMonitorFactory
+    : public Common::FactoryBase<
+          envoy::config::resource_monitor::cgroup_memory::v2alpha::CgroupMemoryConfig> {
+public:
+  CgroupMemoryMonitorFactory() : FactoryBase(ResourceMonitorNames::get().CgroupMemory) {}
+
+private:
+  Server::ResourceMonitorPtr createResourceMonitorFromProtoTyped(
+      const envoy::config::resource_monitor::cgroup_memory::v2alpha::CgroupMemoryConfig& config,
+      Server::Configuration::ResourceMonitorFactoryContext& context) override;
+};
+
+} // namespace CgroupMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
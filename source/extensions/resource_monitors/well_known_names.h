@@ -12,6 +12,9 @@ namespace ResourceMonitors {
  */
 class ResourceMonitorNameValues {
 public:
+  // Memory monitor of the cgroup Envoy runs in.
+  const std::string CgroupMemory = "envoy.resource_monitors.cgroup_memory";
+
   // Heap monitor with statically configured max.
   const std::string FixedHeap = "envoy.resource_monitors.fixed_heap";
 
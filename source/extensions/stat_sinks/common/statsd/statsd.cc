@@ -1,7 +1,11 @@
 #include "extensions/stat_sinks/common/statsd/statsd.h"
 
+#include <sys/socket.h>
+
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 #include "envoy/common/exception.h"
@@ -38,61 +42,112 @@ void Writer::write(const std::string& message) {
   ::send(fd_, message.c_str(), message.size(), MSG_DONTWAIT);
 }
 
+void Writer::writeBatch(const std::vector<std::string>& messages) {
+#if defined(__linux__)
+  // Well below UIO_MAXIOV, the most datagrams the kernel takes in one call.
+  constexpr size_t MaxDatagramsPerCall = 64;
+  mmsghdr headers[MaxDatagramsPerCall];
+  iovec iov[MaxDatagramsPerCall];
+  size_t next = 0;
+  while (next < messages.size()) {
+    const size_t count = std::min(MaxDatagramsPerCall, messages.size() - next);
+    for (size_t i = 0; i < count; i++) {
+      const std::string& message = messages[next + i];
+      iov[i].iov_base = const_cast<char*>(message.data());
+      iov[i].iov_len = message.size();
+      memset(&headers[i], 0, sizeof(headers[i]));
+      headers[i].msg_hdr.msg_iov = &iov[i];
+      headers[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int rc = ::sendmmsg(fd_, headers, count, MSG_DONTWAIT);
+    // sendmmsg() stops at the first datagram it cannot send. Drop that one and go on with the
+    // rest, as write() would.
+    next += rc > 0 ? rc : 1;
+  }
+#else
+  for (const std::string& message : messages) {
+    write(message);
+  }
+#endif
+}
+
 UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
                              Network::Address::InstanceConstSharedPtr address, const bool use_tag,
-                             const std::string& prefix)
+                             const std::string& prefix, uint64_t max_bytes_per_datagram)
     : tls_(tls.allocateSlot()), server_address_(std::move(address)), use_tag_(use_tag),
-      prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix) {
+      prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix),
+      max_bytes_per_datagram_(max_bytes_per_datagram) {
   tls_->set([this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     return std::make_shared<Writer>(this->server_address_);
   });
 }
 
 void UdpStatsdSink::flush(Stats::Source& source) {
-  Writer& writer = tls_->getTyped<Writer>();
-  for (const Stats::CounterSharedPtr& counter : source.cachedCounters()) {
-    if (counter->used()) {
-      uint64_t delta = counter->latch();
-      writer.write(fmt::format("{}.{}:{}|c{}", prefix_, getName(*counter), delta,
-                               buildTagStr(counter->tags())));
-    }
+  std::vector<std::string> datagrams;
+  std::string message;
+  for (const Stats::CounterSnapshot& snapshot : source.cachedCounterSnapshots()) {
+    buildMessage(snapshot.counter_, snapshot.delta_, "c", message);
+    addMessage(message, datagrams);
   }
 
-  for (const Stats::GaugeSharedPtr& gauge : source.cachedGauges()) {
-    if (gauge->used()) {
-      writer.write(fmt::format("{}.{}:{}|g{}", prefix_, getName(*gauge), gauge->value(),
-                               buildTagStr(gauge->tags())));
-    }
+  for (const Stats::GaugeSnapshot& snapshot : source.cachedGaugeSnapshots()) {
+    buildMessage(snapshot.gauge_, snapshot.value_, "g", message);
+    addMessage(message, datagrams);
+  }
+
+  if (!datagrams.empty()) {
+    tls_->getTyped<Writer>().writeBatch(datagrams);
   }
 }
 
 void UdpStatsdSink::onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) {
   // For statsd histograms are all timers.
-  const std::string message(fmt::format("{}.{}:{}|ms{}", prefix_, getName(histogram),
-                                        std::chrono::milliseconds(value).count(),
-                                        buildTagStr(histogram.tags())));
+  std::string message;
+  buildMessage(histogram, std::chrono::milliseconds(value).count(), "ms", message);
   tls_->getTyped<Writer>().write(message);
 }
 
-const std::string UdpStatsdSink::getName(const Stats::Metric& metric) {
+void UdpStatsdSink::buildMessage(const Stats::Metric& metric, uint64_t value, const char* type,
+                                 std::string& message) const {
+  message.clear();
+  message.append(prefix_);
+  message.push_back('.');
   if (use_tag_) {
-    return metric.tagExtractedName();
+    message.append(metric.tagExtractedName());
   } else {
-    return metric.name();
+    message.append(metric.name());
   }
-}
+  message.push_back(':');
+  message.append(std::to_string(value));
+  message.push_back('|');
+  message.append(type);
 
-const std::string UdpStatsdSink::buildTagStr(const std::vector<Stats::Tag>& tags) {
-  if (!use_tag_ || tags.empty()) {
-    return "";
+  if (!use_tag_ || metric.tags().empty()) {
+    return;
+  }
+  message.append("|#");
+  bool first = true;
+  for (const Stats::Tag& tag : metric.tags()) {
+    if (!first) {
+      message.push_back(',');
+    }
+    first = false;
+    message.append(tag.name_);
+    message.push_back(':');
+    message.append(tag.value_);
   }
+}
 
-  std::vector<std::string> tag_strings;
-  tag_strings.reserve(tags.size());
-  for (const Stats::Tag& tag : tags) {
-    tag_strings.emplace_back(tag.name_ + ":" + tag.value_);
+void UdpStatsdSink::addMessage(const std::string& message,
+                               std::vector<std::string>& datagrams) const {
+  // A message larger than the limit still goes out, in a datagram of its own.
+  if (max_bytes_per_datagram_ == 0 || datagrams.empty() ||
+      datagrams.back().size() + 1 + message.size() > max_bytes_per_datagram_) {
+    datagrams.push_back(message);
+    return;
   }
-  return "|#" + StringUtil::join(tag_strings, ",");
+  datagrams.back().push_back('\n');
+  datagrams.back().append(message);
 }
 
 TcpStatsdSink::TcpStatsdSink(const LocalInfo::LocalInfo& local_info,
@@ -113,16 +168,12 @@ TcpStatsdSink::TcpStatsdSink(const LocalInfo::LocalInfo& local_info,
 void TcpStatsdSink::flush(Stats::Source& source) {
   TlsSink& tls_sink = tls_->getTyped<TlsSink>();
   tls_sink.beginFlush(true);
-  for (const Stats::CounterSharedPtr& counter : source.cachedCounters()) {
-    if (counter->used()) {
-      tls_sink.flushCounter(counter->name(), counter->latch());
-    }
+  for (const Stats::CounterSnapshot& snapshot : source.cachedCounterSnapshots()) {
+    tls_sink.flushCounter(snapshot.counter_.get().name(), snapshot.delta_);
   }
 
-  for (const Stats::GaugeSharedPtr& gauge : source.cachedGauges()) {
-    if (gauge->used()) {
-      tls_sink.flushGauge(gauge->name(), gauge->value());
-    }
+  for (const Stats::GaugeSnapshot& snapshot : source.cachedGaugeSnapshots()) {
+    tls_sink.flushGauge(snapshot.gauge_.get().name(), snapshot.value_);
   }
   tls_sink.endFlush(true);
 }
@@ -244,7 +295,8 @@ void TcpStatsdSink::TlsSink::write(Buffer::Instance& buffer) {
                                      parent_.cluster_info_->stats().upstream_cx_rx_bytes_buffered_,
                                      parent_.cluster_info_->stats().upstream_cx_tx_bytes_total_,
                                      parent_.cluster_info_->stats().upstream_cx_tx_bytes_buffered_,
-                                     &parent_.cluster_info_->stats().bind_errors_});
+                                     &parent_.cluster_info_->stats().bind_errors_,
+                                     nullptr, nullptr, nullptr, nullptr});
     connection_->connect();
   }
 
@@ -33,6 +33,11 @@ public:
   virtual ~Writer();
 
   virtual void write(const std::string& message);
+  /**
+   * Send each message as its own datagram, with as few system calls as the platform allows.
+   * Like write(), messages that do not fit in the socket buffer are dropped.
+   */
+  virtual void writeBatch(const std::vector<std::string>& messages);
   // Called in unit test to validate address.
   int getFdForTests() const { return fd_; };
 
@@ -45,13 +50,20 @@ private:
  */
 class UdpStatsdSink : public Stats::Sink {
 public:
+  /**
+   * @param max_bytes_per_datagram supplies the size up to which flushed metrics are packed into
+   *        one datagram, separated by newlines. 0 sends each metric in its own datagram.
+   */
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, Network::Address::InstanceConstSharedPtr address,
-                const bool use_tag, const std::string& prefix = getDefaultPrefix());
+                const bool use_tag, const std::string& prefix = getDefaultPrefix(),
+                uint64_t max_bytes_per_datagram = 0);
   // For testing.
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, const std::shared_ptr<Writer>& writer,
-                const bool use_tag, const std::string& prefix = getDefaultPrefix())
+                const bool use_tag, const std::string& prefix = getDefaultPrefix(),
+                uint64_t max_bytes_per_datagram = 0)
       : tls_(tls.allocateSlot()), use_tag_(use_tag),
-        prefix_(prefix.empty() ? getDefaultPrefix() : prefix) {
+        prefix_(prefix.empty() ? getDefaultPrefix() : prefix),
+        max_bytes_per_datagram_(max_bytes_per_datagram) {
     tls_->set(
         [writer](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr { return writer; });
   }
@@ -64,16 +76,20 @@ public:
   int getFdForTests() { return tls_->getTyped<Writer>().getFdForTests(); }
   bool getUseTagForTest() { return use_tag_; }
   const std::string& getPrefix() { return prefix_; }
+  uint64_t getMaxBytesPerDatagramForTest() { return max_bytes_per_datagram_; }
 
 private:
-  const std::string getName(const Stats::Metric& metric);
-  const std::string buildTagStr(const std::vector<Stats::Tag>& tags);
+  // Formats into message, whose capacity is reused across metrics.
+  void buildMessage(const Stats::Metric& metric, uint64_t value, const char* type,
+                    std::string& message) const;
+  void addMessage(const std::string& message, std::vector<std::string>& datagrams) const;
 
   ThreadLocal::SlotPtr tls_;
   Network::Address::InstanceConstSharedPtr server_address_;
   const bool use_tag_;
   // Prefix for all flushed stats.
   const std::string prefix_;
+  const uint64_t max_bytes_per_datagram_;
 };
 
 /**
@@ -1,9 +1,8 @@
 #include "extensions/stat_sinks/hystrix/hystrix.h"
 
+#include <algorithm>
 #include <chrono>
 #include <ctime>
-#include <iostream>
-#include <sstream>
 
 #include "envoy/stats/scope.h"
 
@@ -22,63 +21,63 @@ namespace StatSinks {
 namespace Hystrix {
 
 const uint64_t HystrixSink::DEFAULT_NUM_BUCKETS;
-ClusterStatsCache::ClusterStatsCache(const std::string& cluster_name)
-    : cluster_name_(cluster_name) {}
+ClusterStatsCache::ClusterStatsCache(const std::string& cluster_name, uint64_t window_size)
+    : cluster_name_(cluster_name), window_size_(window_size),
+      values_(NUM_ROLLING_STATS * window_size) {}
+
+void ClusterStatsCache::pushNewValues(uint64_t index, const RollingStatValues& values) {
+  for (size_t stat = 0; stat < NUM_ROLLING_STATS; ++stat) {
+    uint64_t* window = &values_[stat * window_size_];
+    if (initialized_) {
+      window[index] = values[stat];
+    } else {
+      std::fill(window, window + window_size_, values[stat]);
+    }
+  }
+  initialized_ = true;
+}
+
+uint64_t ClusterStatsCache::getRollingValue(RollingStat stat, uint64_t index) const {
+  const uint64_t* rolling_window = window(stat);
+  // If the counter was reset, the result is negative
+  // better return 0, will be back to normal once one rolling window passes.
+  const uint64_t newest = rolling_window[index];
+  const uint64_t oldest = rolling_window[(index + 1) % window_size_];
+  return newest < oldest ? 0 : newest - oldest;
+}
 
-void ClusterStatsCache::printToStream(std::stringstream& out_str) {
+void ClusterStatsCache::printToString(std::string& out_str) const {
   const std::string cluster_name_prefix = absl::StrCat(cluster_name_, ".");
 
-  printRollingWindow(absl::StrCat(cluster_name_prefix, "success"), success_, out_str);
-  printRollingWindow(absl::StrCat(cluster_name_prefix, "errors"), errors_, out_str);
-  printRollingWindow(absl::StrCat(cluster_name_prefix, "timeouts"), timeouts_, out_str);
-  printRollingWindow(absl::StrCat(cluster_name_prefix, "rejected"), rejected_, out_str);
-  printRollingWindow(absl::StrCat(cluster_name_prefix, "total"), total_, out_str);
+  printRollingWindow(absl::StrCat(cluster_name_prefix, "success"), RollingStat::Success, out_str);
+  printRollingWindow(absl::StrCat(cluster_name_prefix, "errors"), RollingStat::Errors, out_str);
+  printRollingWindow(absl::StrCat(cluster_name_prefix, "timeouts"), RollingStat::Timeouts,
+                     out_str);
+  printRollingWindow(absl::StrCat(cluster_name_prefix, "rejected"), RollingStat::Rejected,
+                     out_str);
+  printRollingWindow(absl::StrCat(cluster_name_prefix, "total"), RollingStat::Total, out_str);
 }
 
-void ClusterStatsCache::printRollingWindow(absl::string_view name, RollingWindow rolling_window,
-                                           std::stringstream& out_str) {
-  out_str << name << " | ";
-  for (auto specific_stat_vec_itr = rolling_window.begin();
-       specific_stat_vec_itr != rolling_window.end(); ++specific_stat_vec_itr) {
-    out_str << *specific_stat_vec_itr << " | ";
+void ClusterStatsCache::printRollingWindow(absl::string_view name, RollingStat stat,
+                                           std::string& out_str) const {
+  absl::StrAppend(&out_str, name, " | ");
+  const uint64_t* rolling_window = window(stat);
+  for (uint64_t i = 0; i < window_size_; ++i) {
+    absl::StrAppend(&out_str, rolling_window[i], " | ");
   }
-  out_str << std::endl;
+  out_str += '\n';
 }
 
 void HystrixSink::addHistogramToStream(const QuantileLatencyMap& latency_map, absl::string_view key,
-                                       std::stringstream& ss) {
-  // TODO: Consider if we better use join here
-  ss << ", \"" << key << "\": {";
+                                       std::string& ss) {
+  absl::StrAppend(&ss, ", \"", key, "\": {");
   bool is_first = true;
   for (const std::pair<double, double>& element : latency_map) {
     const std::string quantile = fmt::sprintf("%g", element.first * 100);
     HystrixSink::addDoubleToStream(quantile, element.second, ss, is_first);
     is_first = false;
   }
-  ss << "}";
-}
-
-// Add new value to rolling window, in place of oldest one.
-void HystrixSink::pushNewValue(RollingWindow& rolling_window, uint64_t value) {
-  if (rolling_window.empty()) {
-    rolling_window.resize(window_size_, value);
-  } else {
-    rolling_window[current_index_] = value;
-  }
-}
-
-uint64_t HystrixSink::getRollingValue(RollingWindow rolling_window) {
-
-  if (rolling_window.empty()) {
-    return 0;
-  }
-  // If the counter was reset, the result is negative
-  // better return 0, will be back to normal once one rolling window passes.
-  if (rolling_window[current_index_] < rolling_window[(current_index_ + 1) % window_size_]) {
-    return 0;
-  } else {
-    return rolling_window[current_index_] - rolling_window[(current_index_ + 1) % window_size_];
-  }
+  ss += '}';
 }
 
 void HystrixSink::updateRollingWindowMap(const Upstream::ClusterInfo& cluster_info,
@@ -92,8 +91,6 @@ void HystrixSink::updateRollingWindowMap(const Upstream::ClusterInfo& cluster_in
   uint64_t timeouts = cluster_stats.upstream_rq_timeout_.value() +
                       cluster_stats.upstream_rq_per_try_timeout_.value();
 
-  pushNewValue(cluster_stats_cache.timeouts_, timeouts);
-
   // Combining errors+retry errors - retries are counted as separate requests
   // (alternative: each request including the retries counted as 1)
   // since timeouts are 504 (or 408), deduce them from here ("-" sign).
@@ -104,18 +101,15 @@ void HystrixSink::updateRollingWindowMap(const Upstream::ClusterInfo& cluster_in
                     cluster_stats_scope.counter("retry.upstream_rq_4xx").value() -
                     cluster_stats.upstream_rq_timeout_.value();
 
-  pushNewValue(cluster_stats_cache.errors_, errors);
-
   uint64_t success = cluster_stats_scope.counter("upstream_rq_2xx").value();
-  pushNewValue(cluster_stats_cache.success_, success);
-
   uint64_t rejected = cluster_stats.upstream_rq_pending_overflow_.value();
-  pushNewValue(cluster_stats_cache.rejected_, rejected);
 
   // should not take from upstream_rq_total since it is updated before its components,
   // leading to wrong results such as error percentage higher than 100%
   uint64_t total = errors + timeouts + success + rejected;
-  pushNewValue(cluster_stats_cache.total_, total);
+
+  // In RollingStat order.
+  cluster_stats_cache.pushNewValues(current_index_, {success, errors, timeouts, rejected, total});
 
   ENVOY_LOG(trace, "{}", printRollingWindows());
 }
@@ -123,49 +117,53 @@ void HystrixSink::updateRollingWindowMap(const Upstream::ClusterInfo& cluster_in
 void HystrixSink::resetRollingWindow() { cluster_stats_cache_map_.clear(); }
 
 void HystrixSink::addStringToStream(absl::string_view key, absl::string_view value,
-                                    std::stringstream& info, bool is_first) {
-  std::string quoted_value = absl::StrCat("\"", value, "\"");
-  addInfoToStream(key, quoted_value, info, is_first);
+                                    std::string& info, bool is_first) {
+  if (!is_first) {
+    info += ", ";
+  }
+  absl::StrAppend(&info, "\"", key, "\": \"", value, "\"");
 }
 
-void HystrixSink::addIntToStream(absl::string_view key, uint64_t value, std::stringstream& info,
+void HystrixSink::addIntToStream(absl::string_view key, uint64_t value, std::string& info,
                                  bool is_first) {
-  addInfoToStream(key, std::to_string(value), info, is_first);
+  if (!is_first) {
+    info += ", ";
+  }
+  absl::StrAppend(&info, "\"", key, "\": ", value);
 }
 
-void HystrixSink::addDoubleToStream(absl::string_view key, double value, std::stringstream& info,
+void HystrixSink::addDoubleToStream(absl::string_view key, double value, std::string& info,
                                     bool is_first) {
   addInfoToStream(key, std::to_string(value), info, is_first);
 }
 
 void HystrixSink::addInfoToStream(absl::string_view key, absl::string_view value,
-                                  std::stringstream& info, bool is_first) {
+                                  std::string& info, bool is_first) {
   if (!is_first) {
-    info << ", ";
+    info += ", ";
   }
-  std::string added_info = absl::StrCat("\"", key, "\": ", value);
-  info << added_info;
+  absl::StrAppend(&info, "\"", key, "\": ", value);
 }
 
 void HystrixSink::addHystrixCommand(ClusterStatsCache& cluster_stats_cache,
                                     absl::string_view cluster_name,
                                     uint64_t max_concurrent_requests, uint64_t reporting_hosts,
                                     std::chrono::milliseconds rolling_window_ms,
-                                    const QuantileLatencyMap& histogram, std::stringstream& ss) {
+                                    const QuantileLatencyMap& histogram, std::string& ss) {
 
   std::time_t currentTime = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
 
-  ss << "data: {";
+  ss += "data: {";
   addStringToStream("type", "HystrixCommand", ss, true);
   addStringToStream("name", cluster_name, ss);
   addStringToStream("group", "NA", ss);
   addIntToStream("currentTime", static_cast<uint64_t>(currentTime), ss);
   addInfoToStream("isCircuitBreakerOpen", "false", ss);
 
-  uint64_t errors = getRollingValue(cluster_stats_cache.errors_);
-  uint64_t timeouts = getRollingValue(cluster_stats_cache.timeouts_);
-  uint64_t rejected = getRollingValue(cluster_stats_cache.rejected_);
-  uint64_t total = getRollingValue(cluster_stats_cache.total_);
+  uint64_t errors = cluster_stats_cache.getRollingValue(RollingStat::Errors, current_index_);
+  uint64_t timeouts = cluster_stats_cache.getRollingValue(RollingStat::Timeouts, current_index_);
+  uint64_t rejected = cluster_stats_cache.getRollingValue(RollingStat::Rejected, current_index_);
+  uint64_t total = cluster_stats_cache.getRollingValue(RollingStat::Total, current_index_);
 
   uint64_t error_rate = total == 0 ? 0 : (100 * (errors + timeouts + rejected)) / total;
 
@@ -188,7 +186,8 @@ void HystrixSink::addHystrixCommand(ClusterStatsCache& cluster_stats_cache,
   // there is no parallel counter in Envoy since as a result of errors (outlier detection)
   // requests are not rejected, but rather the node is removed from load balancer healthy pool.
   addIntToStream("rollingCountShortCircuited", 0, ss);
-  addIntToStream("rollingCountSuccess", getRollingValue(cluster_stats_cache.success_), ss);
+  addIntToStream("rollingCountSuccess",
+                 cluster_stats_cache.getRollingValue(RollingStat::Success, current_index_), ss);
   addIntToStream("rollingCountThreadPoolRejected", 0, ss);
   addIntToStream("rollingCountTimeout", timeouts, ss);
   addIntToStream("rollingCountBadRequests", 0, ss);
@@ -212,15 +211,15 @@ void HystrixSink::addHystrixCommand(ClusterStatsCache& cluster_stats_cache,
   addIntToStream("propertyValue_metricsRollingStatisticalWindowInMilliseconds",
                  rolling_window_ms.count(), ss);
 
-  ss << "}" << std::endl << std::endl;
+  ss += "}\n\n";
 }
 
 void HystrixSink::addHystrixThreadPool(absl::string_view cluster_name, uint64_t queue_size,
                                        uint64_t reporting_hosts,
                                        std::chrono::milliseconds rolling_window_ms,
-                                       std::stringstream& ss) {
+                                       std::string& ss) {
 
-  ss << "data: {";
+  ss += "data: {";
   addIntToStream("currentPoolSize", 0, ss, true);
   addIntToStream("rollingMaxActiveThreads", 0, ss);
   addIntToStream("currentActiveCount", 0, ss);
@@ -238,7 +237,7 @@ void HystrixSink::addHystrixThreadPool(absl::string_view cluster_name, uint64_t
   addIntToStream("rollingCountThreadsExecuted", 0, ss);
   addIntToStream("currentMaximumPoolSize", 0, ss);
 
-  ss << "}" << std::endl << std::endl;
+  ss += "}\n\n";
 }
 
 void HystrixSink::addClusterStatsToStream(ClusterStatsCache& cluster_stats_cache,
@@ -247,7 +246,7 @@ void HystrixSink::addClusterStatsToStream(ClusterStatsCache& cluster_stats_cache
                                           uint64_t reporting_hosts,
                                           std::chrono::milliseconds rolling_window_ms,
                                           const QuantileLatencyMap& histogram,
-                                          std::stringstream& ss) {
+                                          std::string& ss) {
 
   addHystrixCommand(cluster_stats_cache, cluster_name, max_concurrent_requests, reporting_hosts,
                     rolling_window_ms, histogram, ss);
@@ -256,13 +255,13 @@ void HystrixSink::addClusterStatsToStream(ClusterStatsCache& cluster_stats_cache
 }
 
 const std::string HystrixSink::printRollingWindows() {
-  std::stringstream out_str;
+  std::string out_str;
 
   for (auto& itr : cluster_stats_cache_map_) {
     ClusterStatsCache& cluster_stats_cache = *(itr.second);
-    cluster_stats_cache.printToStream(out_str);
+    cluster_stats_cache.printToString(out_str);
   }
-  return out_str.str();
+  return out_str;
 }
 
 HystrixSink::HystrixSink(Server::Instance& server, const uint64_t num_buckets)
@@ -321,7 +320,10 @@ void HystrixSink::flush(Stats::Source& source) {
     return;
   }
   incCounter();
-  std::stringstream ss;
+  // The event is serialized once and shared by all the connected dashboards.
+  auto event = std::make_shared<std::string>();
+  std::string& ss = *event;
+  ss.reserve(last_event_size_);
   Upstream::ClusterManager::ClusterInfoMap clusters = server_.clusterManager().clusters();
 
   // Save a map of the relevant histograms per cluster in a convenient format.
@@ -356,14 +358,17 @@ void HystrixSink::flush(Stats::Source& source) {
     }
   }
 
+  static const QuantileLatencyMap empty_histogram;
   for (auto& cluster : clusters) {
     Upstream::ClusterInfoConstSharedPtr cluster_info = cluster.second.get().info();
 
     std::unique_ptr<ClusterStatsCache>& cluster_stats_cache_ptr =
         cluster_stats_cache_map_[cluster_info->name()];
     if (cluster_stats_cache_ptr == nullptr) {
-      cluster_stats_cache_ptr = std::make_unique<ClusterStatsCache>(cluster_info->name());
+      cluster_stats_cache_ptr =
+          std::make_unique<ClusterStatsCache>(cluster_info->name(), window_size_);
     }
+    const auto histogram = time_histograms.find(cluster_info->name());
 
     // update rolling window with cluster stats
     updateRollingWindowMap(*cluster_info, *cluster_stats_cache_ptr);
@@ -373,21 +378,22 @@ void HystrixSink::flush(Stats::Source& source) {
         *cluster_stats_cache_ptr, cluster_info->name(),
         cluster_info->resourceManager(Upstream::ResourcePriority::Default).pendingRequests().max(),
         cluster_info->statsScope().gauge("membership_total").value(), server_.statsFlushInterval(),
-        time_histograms[cluster_info->name()], ss);
-  }
-
-  Buffer::OwnedImpl data;
-  for (auto callbacks : callbacks_list_) {
-    data.add(ss.str());
-    callbacks->encodeData(data, false);
+        histogram != time_histograms.end() ? histogram->second : empty_histogram, ss);
   }
 
   // send keep alive ping
   // TODO (@trabetti) : is it ok to send together with data?
-  Buffer::OwnedImpl ping_data;
+  ss += ":\n\n";
+  last_event_size_ = ss.size();
+
   for (auto callbacks : callbacks_list_) {
-    ping_data.add(":\n\n");
-    callbacks->encodeData(ping_data, false);
+    Buffer::OwnedImpl data;
+    data.addBufferFragment(*new Buffer::BufferFragmentImpl(
+        event->data(), event->size(),
+        [event](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) {
+          delete fragment;
+        }));
+    callbacks->encodeData(data, false);
   }
 
   // check if any clusters were removed, and remove from cache
@@ -1,7 +1,8 @@
 #pragma once
 
-#include <map>
+#include <array>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "envoy/server/admin.h"
@@ -15,9 +16,6 @@ namespace Extensions {
 namespace StatSinks {
 namespace Hystrix {
 
-typedef std::vector<uint64_t> RollingWindow;
-typedef std::map<const std::string, RollingWindow> RollingStatsMap;
-
 using QuantileLatencyMap = std::unordered_map<double, double>;
 static const std::vector<double> hystrix_quantiles = {0,    0.25, 0.5,   0.75, 0.90,
                                                       0.95, 0.99, 0.995, 1};
@@ -26,20 +24,43 @@ struct {
   const std::string AllowHeadersHystrix{"Accept, Cache-Control, X-Requested-With, Last-Event-ID"};
 } AccessControlAllowHeadersValue;
 
+/**
+ * The statistics of a cluster kept over the rolling window.
+ */
+enum class RollingStat { Success, Errors, Timeouts, Rejected, Total };
+const size_t NUM_ROLLING_STATS = 5;
+typedef std::array<uint64_t, NUM_ROLLING_STATS> RollingStatValues;
+
+/**
+ * Fixed capacity ring buffers of the last window_size values of each RollingStat of a cluster,
+ * allocated once when the cluster is first seen. All the ring buffers of all the clusters share the
+ * position of the newest value, which is advanced by the sink on each flush.
+ */
 struct ClusterStatsCache {
-  ClusterStatsCache(const std::string& cluster_name);
-
-  void printToStream(std::stringstream& out_str);
-  void printRollingWindow(absl::string_view name, RollingWindow rolling_window,
-                          std::stringstream& out_str);
-  std::string cluster_name_;
-
-  // Rolling windows
-  RollingWindow errors_;
-  RollingWindow success_;
-  RollingWindow total_;
-  RollingWindow timeouts_;
-  RollingWindow rejected_;
+  ClusterStatsCache(const std::string& cluster_name, uint64_t window_size);
+
+  /**
+   * Store the newest value of each stat at index. The first values pushed fill the whole window.
+   */
+  void pushNewValues(uint64_t index, const RollingStatValues& values);
+
+  /**
+   * @return the change of the stat over the window ending at index.
+   */
+  uint64_t getRollingValue(RollingStat stat, uint64_t index) const;
+
+  void printToString(std::string& out_str) const;
+  void printRollingWindow(absl::string_view name, RollingStat stat, std::string& out_str) const;
+
+  const uint64_t* window(RollingStat stat) const {
+    return &values_[static_cast<size_t>(stat) * window_size_];
+  }
+
+  const std::string cluster_name_;
+  const uint64_t window_size_;
+  bool initialized_{};
+  // The ring buffers of the stats, one after the other in RollingStat order.
+  std::vector<uint64_t> values_;
 };
 
 typedef std::unique_ptr<ClusterStatsCache> ClusterStatsCachePtr;
@@ -62,11 +83,6 @@ public:
    */
   void unregisterConnection(Http::StreamDecoderFilterCallbacks* callbacks_to_remove);
 
-  /**
-   * Add new value to top of rolling window, pushing out the oldest value.
-   */
-  void pushNewValue(RollingWindow& rolling_window, uint64_t value);
-
   /**
    * Increment pointer of next value to add to rolling window.
    */
@@ -79,7 +95,7 @@ public:
                                absl::string_view cluster_name, uint64_t max_concurrent_requests,
                                uint64_t reporting_hosts,
                                std::chrono::milliseconds rolling_window_ms,
-                               const QuantileLatencyMap& histogram, std::stringstream& ss);
+                               const QuantileLatencyMap& histogram, std::string& ss);
 
   /**
    * Calculate values needed to create the stream and write into the map.
@@ -97,39 +113,34 @@ public:
   const std::string printRollingWindows();
 
   /**
-   * Get the statistic's value change over the rolling window time frame.
-   */
-  uint64_t getRollingValue(RollingWindow rolling_window);
-
-  /**
-   * Format the given key and value to "key"=value, and adding to the stringstream.
+   * Format the given key and value to "key"=value, and append it to the string.
    */
-  static void addInfoToStream(absl::string_view key, absl::string_view value,
-                              std::stringstream& info, bool is_first = false);
+  static void addInfoToStream(absl::string_view key, absl::string_view value, std::string& info,
+                              bool is_first = false);
 
   /**
-   * Format the given key and double value to "key"=<string of uint64_t>, and adding to the
-   * stringstream.
+   * Format the given key and double value to "key"=<string of double>, and append it to the
+   * string.
    */
-  static void addDoubleToStream(absl::string_view key, double value, std::stringstream& info,
+  static void addDoubleToStream(absl::string_view key, double value, std::string& info,
                                 bool is_first);
 
   /**
-   * Format the given key and absl::string_view value to "key"="value", and adding to the
-   * stringstream.
+   * Format the given key and absl::string_view value to "key"="value", and append it to the
+   * string.
    */
-  static void addStringToStream(absl::string_view key, absl::string_view value,
-                                std::stringstream& info, bool is_first = false);
+  static void addStringToStream(absl::string_view key, absl::string_view value, std::string& info,
+                                bool is_first = false);
 
   /**
-   * Format the given key and uint64_t value to "key"=<string of uint64_t>, and adding to the
-   * stringstream.
+   * Format the given key and uint64_t value to "key"=<string of uint64_t>, and append it to the
+   * string.
    */
-  static void addIntToStream(absl::string_view key, uint64_t value, std::stringstream& info,
+  static void addIntToStream(absl::string_view key, uint64_t value, std::string& info,
                              bool is_first = false);
 
   static void addHistogramToStream(const QuantileLatencyMap& latency_map, absl::string_view key,
-                                   std::stringstream& ss);
+                                   std::string& ss);
 
 private:
   /**
@@ -138,20 +149,22 @@ private:
   void addHystrixCommand(ClusterStatsCache& cluster_stats_cache, absl::string_view cluster_name,
                          uint64_t max_concurrent_requests, uint64_t reporting_hosts,
                          std::chrono::milliseconds rolling_window_ms,
-                         const QuantileLatencyMap& histogram, std::stringstream& ss);
+                         const QuantileLatencyMap& histogram, std::string& ss);
 
   /**
    * Generate HystrixThreadPool event stream.
    */
   void addHystrixThreadPool(absl::string_view cluster_name, uint64_t queue_size,
                             uint64_t reporting_hosts, std::chrono::milliseconds rolling_window_ms,
-                            std::stringstream& ss);
+                            std::string& ss);
 
   std::vector<Http::StreamDecoderFilterCallbacks*> callbacks_list_;
   Server::Instance& server_;
   uint64_t current_index_;
   const uint64_t window_size_;
   static const uint64_t DEFAULT_NUM_BUCKETS = 10;
+  // Size of the last event, to size the next one up front.
+  size_t last_event_size_{};
 
   // Map from cluster names to a struct of all of that cluster's stat windows.
   std::unordered_map<std::string, ClusterStatsCachePtr> cluster_stats_cache_map_;
@@ -6,6 +6,7 @@
 
 #include "common/grpc/async_client_impl.h"
 #include "common/network/resolver_impl.h"
+#include "common/protobuf/utility.h"
 
 #include "extensions/stat_sinks/metrics_service/grpc_metrics_service_impl.h"
 #include "extensions/stat_sinks/well_known_names.h"
@@ -29,7 +30,10 @@ Stats::SinkPtr MetricsServiceSinkFactory::createStatsSink(const Protobuf::Messag
               grpc_service, server.stats(), false),
           server.threadLocal(), server.localInfo());
 
-  return std::make_unique<MetricsServiceSink>(grpc_metrics_streamer, server.timeSystem());
+  return std::make_unique<MetricsServiceSink>(
+      grpc_metrics_streamer, server.timeSystem(), sink_config.report_counters_as_deltas(),
+      sink_config.use_metric_name_ids(),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(sink_config, batch_size_bytes, 0));
 }
 
 ProtobufTypes::MessagePtr MetricsServiceSinkFactory::createEmptyConfigProto() {
@@ -31,7 +31,7 @@ void GrpcMetricsStreamerImpl::ThreadLocalStream::onRemoteClose(Grpc::Status::Grp
   // Only erase if we have a stream. Otherwise we had an inline failure and we will clear the
   // stream data in send().
   if (parent_.thread_local_stream_->stream_ != nullptr) {
-    parent_.thread_local_stream_ = nullptr;
+    parent_.resetStream();
   }
 }
 
@@ -57,45 +57,97 @@ void GrpcMetricsStreamerImpl::ThreadLocalStreamer::send(
   if (thread_local_stream_->stream_ != nullptr) {
     thread_local_stream_->stream_->sendMessage(message, false);
   } else {
-    thread_local_stream_ = nullptr;
+    resetStream();
   }
 }
 
-MetricsServiceSink::MetricsServiceSink(const GrpcMetricsStreamerSharedPtr& grpc_metrics_streamer,
-                                       Event::TimeSystem& time_system)
-    : grpc_metrics_streamer_(grpc_metrics_streamer), time_system_(time_system) {}
+void GrpcMetricsStreamerImpl::ThreadLocalStreamer::resetStream() {
+  thread_local_stream_ = nullptr;
+  stream_generation_++;
+}
 
-void MetricsServiceSink::flushCounter(const Stats::Counter& counter) {
+MetricsServiceSink::MetricsServiceSink(const GrpcMetricsStreamerSharedPtr& grpc_metrics_streamer,
+                                       Event::TimeSystem& time_system,
+                                       bool report_counters_as_deltas, bool use_metric_name_ids,
+                                       uint64_t batch_size_bytes)
+    : grpc_metrics_streamer_(grpc_metrics_streamer), time_system_(time_system),
+      report_counters_as_deltas_(report_counters_as_deltas),
+      use_metric_name_ids_(use_metric_name_ids), batch_size_bytes_(batch_size_bytes) {}
+
+io::prometheus::client::MetricFamily*
+MetricsServiceSink::addMetricFamily(const std::string& name,
+                                    io::prometheus::client::MetricType type) {
   io::prometheus::client::MetricFamily* metrics_family = message_.add_envoy_metrics();
-  metrics_family->set_type(io::prometheus::client::MetricType::COUNTER);
-  metrics_family->set_name(counter.name());
+  metrics_family->set_type(type);
+  if (!use_metric_name_ids_) {
+    metrics_family->set_name(name);
+    return metrics_family;
+  }
+
+  auto it = metric_name_ids_.find(name);
+  if (it == metric_name_ids_.end()) {
+    it = metric_name_ids_.emplace(name, metric_name_ids_.size()).first;
+    auto* metric_name = message_.add_metric_names();
+    metric_name->set_id(it->second);
+    metric_name->set_name(name);
+    message_size_bytes_ += metric_name->ByteSizeLong();
+  }
+  message_.add_envoy_metric_name_ids(it->second);
+  return metrics_family;
+}
+
+void MetricsServiceSink::onMetricAdded() {
+  if (batch_size_bytes_ == 0) {
+    return;
+  }
+  const int size = message_.envoy_metrics_size();
+  message_size_bytes_ += message_.envoy_metrics(size - 1).ByteSizeLong();
+  if (message_size_bytes_ >= batch_size_bytes_) {
+    sendMessage();
+  }
+}
+
+void MetricsServiceSink::sendMessage() {
+  grpc_metrics_streamer_->send(message_);
+  message_.Clear();
+  message_size_bytes_ = 0;
+  message_sent_ = true;
+  checkStreamGeneration();
+}
+
+void MetricsServiceSink::checkStreamGeneration() {
+  const uint64_t stream_generation = grpc_metrics_streamer_->streamGeneration();
+  if (stream_generation != stream_generation_) {
+    metric_name_ids_.clear();
+    stream_generation_ = stream_generation;
+  }
+}
+
+void MetricsServiceSink::flushCounter(const Stats::Counter& counter, uint64_t value) {
+  io::prometheus::client::MetricFamily* metrics_family =
+      addMetricFamily(counter.name(), io::prometheus::client::MetricType::COUNTER);
   auto* metric = metrics_family->add_metric();
-  metric->set_timestamp_ms(std::chrono::duration_cast<std::chrono::milliseconds>(
-                               time_system_.systemTime().time_since_epoch())
-                               .count());
+  metric->set_timestamp_ms(timestamp_ms_);
   auto* counter_metric = metric->mutable_counter();
-  counter_metric->set_value(counter.value());
+  counter_metric->set_value(value);
+  onMetricAdded();
 }
 
-void MetricsServiceSink::flushGauge(const Stats::Gauge& gauge) {
-  io::prometheus::client::MetricFamily* metrics_family = message_.add_envoy_metrics();
-  metrics_family->set_type(io::prometheus::client::MetricType::GAUGE);
-  metrics_family->set_name(gauge.name());
+void MetricsServiceSink::flushGauge(const Stats::Gauge& gauge, uint64_t value) {
+  io::prometheus::client::MetricFamily* metrics_family =
+      addMetricFamily(gauge.name(), io::prometheus::client::MetricType::GAUGE);
   auto* metric = metrics_family->add_metric();
-  metric->set_timestamp_ms(std::chrono::duration_cast<std::chrono::milliseconds>(
-                               time_system_.systemTime().time_since_epoch())
-                               .count());
+  metric->set_timestamp_ms(timestamp_ms_);
   auto* gauage_metric = metric->mutable_gauge();
-  gauage_metric->set_value(gauge.value());
+  gauage_metric->set_value(value);
+  onMetricAdded();
 }
+
 void MetricsServiceSink::flushHistogram(const Stats::ParentHistogram& histogram) {
-  io::prometheus::client::MetricFamily* metrics_family = message_.add_envoy_metrics();
-  metrics_family->set_type(io::prometheus::client::MetricType::SUMMARY);
-  metrics_family->set_name(histogram.name());
+  io::prometheus::client::MetricFamily* metrics_family =
+      addMetricFamily(histogram.name(), io::prometheus::client::MetricType::SUMMARY);
   auto* metric = metrics_family->add_metric();
-  metric->set_timestamp_ms(std::chrono::duration_cast<std::chrono::milliseconds>(
-                               time_system_.systemTime().time_since_epoch())
-                               .count());
+  metric->set_timestamp_ms(timestamp_ms_);
   auto* summary_metric = metric->mutable_summary();
   const Stats::HistogramStatistics& hist_stats = histogram.intervalStatistics();
   for (size_t i = 0; i < hist_stats.supportedQuantiles().size(); i++) {
@@ -103,27 +155,38 @@ void MetricsServiceSink::flushHistogram(const Stats::ParentHistogram& histogram)
     quantile->set_quantile(hist_stats.supportedQuantiles()[i]);
     quantile->set_value(hist_stats.computedQuantiles()[i]);
   }
+  onMetricAdded();
 }
 
 void MetricsServiceSink::flush(Stats::Source& source) {
-  message_.clear_envoy_metrics();
-  const std::vector<Stats::CounterSharedPtr>& counters = source.cachedCounters();
-  const std::vector<Stats::GaugeSharedPtr>& gauges = source.cachedGauges();
+  message_.Clear();
+  message_size_bytes_ = 0;
+  message_sent_ = false;
+  // The stream may have been lost since the previous flush.
+  checkStreamGeneration();
+  timestamp_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      time_system_.systemTime().time_since_epoch())
+                      .count();
+
+  const std::vector<Stats::CounterSnapshot>& counters = source.cachedCounterSnapshots();
+  const std::vector<Stats::GaugeSnapshot>& gauges = source.cachedGaugeSnapshots();
   const std::vector<Stats::ParentHistogramSharedPtr>& histograms = source.cachedHistograms();
-  // TODO(mrice32): there's probably some more sophisticated preallocation we can do here where we
-  // actually preallocate the submessages and then pass ownership to the proto (rather than just
-  // preallocating the pointer array).
-  message_.mutable_envoy_metrics()->Reserve(counters.size() + gauges.size() + histograms.size());
-  for (const Stats::CounterSharedPtr& counter : counters) {
-    if (counter->used()) {
-      flushCounter(*counter);
+  if (batch_size_bytes_ == 0) {
+    // TODO(mrice32): there's probably some more sophisticated preallocation we can do here where
+    // we actually preallocate the submessages and then pass ownership to the proto (rather than
+    // just preallocating the pointer array).
+    message_.mutable_envoy_metrics()->Reserve(counters.size() + gauges.size() + histograms.size());
+  }
+  for (const Stats::CounterSnapshot& counter : counters) {
+    if (!report_counters_as_deltas_) {
+      flushCounter(counter.counter_, counter.counter_.get().value());
+    } else if (counter.delta_ > 0) {
+      flushCounter(counter.counter_, counter.delta_);
     }
   }
 
-  for (const Stats::GaugeSharedPtr& gauge : gauges) {
-    if (gauge->used()) {
-      flushGauge(*gauge);
-    }
+  for (const Stats::GaugeSnapshot& gauge : gauges) {
+    flushGauge(gauge.gauge_, gauge.value_);
   }
 
   for (const Stats::ParentHistogramSharedPtr& histogram : histograms) {
@@ -132,10 +195,9 @@ void MetricsServiceSink::flush(Stats::Source& source) {
     }
   }
 
-  grpc_metrics_streamer_->send(message_);
-  // for perf reasons, clear the identifer after the first flush.
-  if (message_.has_identifier()) {
-    message_.clear_identifier();
+  // Send the remaining metrics. A flush always sends at least one message.
+  if (message_.envoy_metrics_size() > 0 || !message_sent_) {
+    sendMessage();
   }
 }
 
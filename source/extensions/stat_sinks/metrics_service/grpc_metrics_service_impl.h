@@ -1,5 +1,8 @@
 #pragma once
 
+#include <string>
+#include <unordered_map>
+
 #include "envoy/grpc/async_client.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/network/connection.h"
@@ -35,6 +38,12 @@ public:
    * @param message supplies the metrics to send.
    */
   virtual void send(envoy::service::metrics::v2::StreamMetricsMessage& message) PURE;
+
+  /**
+   * @return a number which changes whenever the stream that messages are sent on is lost. The next
+   *         message is then sent on a new stream, whose receiver knows none of the metric names.
+   */
+  virtual uint64_t streamGeneration() PURE;
 };
 
 typedef std::shared_ptr<GrpcMetricsStreamer> GrpcMetricsStreamerSharedPtr;
@@ -52,6 +61,9 @@ public:
   void send(envoy::service::metrics::v2::StreamMetricsMessage& message) override {
     tls_slot_->getTyped<ThreadLocalStreamer>().send(message);
   }
+  uint64_t streamGeneration() override {
+    return tls_slot_->getTyped<ThreadLocalStreamer>().stream_generation_;
+  }
 
 private:
   /**
@@ -97,10 +109,12 @@ private:
   struct ThreadLocalStreamer : public ThreadLocal::ThreadLocalObject {
     ThreadLocalStreamer(const SharedStateSharedPtr& shared_state);
     void send(envoy::service::metrics::v2::StreamMetricsMessage& message);
+    void resetStream();
 
     Grpc::AsyncClientPtr client_;
     ThreadLocalStreamSharedPtr thread_local_stream_ = nullptr;
     SharedStateSharedPtr shared_state_;
+    uint64_t stream_generation_{};
   };
 
   ThreadLocal::SlotPtr tls_slot_;
@@ -112,18 +126,46 @@ class MetricsServiceSink : public Stats::Sink {
 public:
   // MetricsService::Sink
   MetricsServiceSink(const GrpcMetricsStreamerSharedPtr& grpc_metrics_streamer,
-                     Event::TimeSystem& time_system);
+                     Event::TimeSystem& time_system, bool report_counters_as_deltas,
+                     bool use_metric_name_ids, uint64_t batch_size_bytes);
   void flush(Stats::Source& source) override;
   void onHistogramComplete(const Stats::Histogram&, uint64_t) override {}
 
-  void flushCounter(const Stats::Counter& counter);
-  void flushGauge(const Stats::Gauge& gauge);
+  void flushCounter(const Stats::Counter& counter, uint64_t value);
+  void flushGauge(const Stats::Gauge& gauge, uint64_t value);
   void flushHistogram(const Stats::ParentHistogram& histogram);
 
 private:
+  /**
+   * Add a metric to the message, naming it either by name or by the id of its name.
+   */
+  io::prometheus::client::MetricFamily* addMetricFamily(const std::string& name,
+                                                        io::prometheus::client::MetricType type);
+  /**
+   * Account for the size of the last metric added, and send the message if it reached the batch
+   * size.
+   */
+  void onMetricAdded();
+  void sendMessage();
+  /**
+   * Forget the ids of the metric names if the stream they were sent on was lost.
+   */
+  void checkStreamGeneration();
+
   GrpcMetricsStreamerSharedPtr grpc_metrics_streamer_;
   envoy::service::metrics::v2::StreamMetricsMessage message_;
   Event::TimeSystem& time_system_;
+  const bool report_counters_as_deltas_;
+  const bool use_metric_name_ids_;
+  // Zero if the metrics of a flush are sent in a single message.
+  const uint64_t batch_size_bytes_;
+  uint64_t message_size_bytes_{};
+  // Whether a message was sent during the current flush.
+  bool message_sent_{};
+  int64_t timestamp_ms_{};
+  // The ids of the metric names sent on the current stream.
+  std::unordered_map<std::string, uint32_t> metric_name_ids_;
+  uint64_t stream_generation_{};
 };
 
 } // namespace MetricsService
@@ -15,6 +15,10 @@ namespace Common {
 namespace Ot {
 
 namespace {
+// Span contexts up to this size are serialized and base64 encoded on the stack, and their encoding
+// fits the inline storage of a header value.
+constexpr size_t MaxInlineSpanContextSize = 96;
+
 class OpenTracingHTTPHeadersWriter : public opentracing::HTTPHeadersWriter {
 public:
   explicit OpenTracingHTTPHeadersWriter(Http::HeaderMap& request_headers)
@@ -23,9 +27,16 @@ public:
   // opentracing::HTTPHeadersWriter
   opentracing::expected<void> Set(opentracing::string_view key,
                                   opentracing::string_view value) const override {
-    Http::LowerCaseString lowercase_key{key};
+    const Http::LowerCaseString lowercase_key{key};
+    const Http::HeaderEntry* entry;
+    if (request_headers_.lookup(lowercase_key, &entry) == Http::HeaderMap::Lookup::Found) {
+      // An inline header has a single entry, so its value is overwritten in place, reusing its
+      // storage.
+      request_headers_.get(lowercase_key)->value(value.data(), value.size());
+      return {};
+    }
     request_headers_.remove(lowercase_key);
-    request_headers_.addCopy(std::move(lowercase_key), value);
+    request_headers_.addCopy(lowercase_key, value);
     return {};
   }
 
@@ -82,8 +93,8 @@ private:
 } // namespace
 
 OpenTracingSpan::OpenTracingSpan(OpenTracingDriver& driver,
-                                 std::unique_ptr<opentracing::Span>&& span)
-    : driver_{driver}, span_(std::move(span)) {}
+                                 std::unique_ptr<opentracing::Span>&& span, bool sampled)
+    : driver_{driver}, span_(std::move(span)), sampled_(sampled) {}
 
 void OpenTracingSpan::finishSpan() { span_->Finish(); }
 
@@ -97,18 +108,30 @@ void OpenTracingSpan::setTag(const std::string& name, const std::string& value)
 
 void OpenTracingSpan::injectContext(Http::HeaderMap& request_headers) {
   if (driver_.propagationMode() == OpenTracingDriver::PropagationMode::SingleHeader) {
-    // Inject the span context using Envoy's single-header format.
-    std::ostringstream oss;
-    const opentracing::expected<void> was_successful =
-        span_->tracer().Inject(span_->context(), oss);
-    if (!was_successful) {
-      ENVOY_LOG(debug, "Failed to inject span context: {}", was_successful.error().message());
-      driver_.tracerStats().span_context_injection_error_.inc();
+    // Inject the span context using Envoy's single-header format. Small span contexts are
+    // serialized and encoded without allocating, directly into the inline header.
+    char context[MaxInlineSpanContextSize];
+    OutputMemoryStream ostream{context, sizeof(context)};
+    opentracing::expected<void> was_successful = span_->tracer().Inject(span_->context(), ostream);
+    if (was_successful && ostream.good()) {
+      char encoded[(MaxInlineSpanContextSize + 2) / 3 * 4];
+      const uint64_t encoded_size = Base64::encode(context, ostream.size(), encoded);
+      request_headers.insertOtSpanContext().value(encoded, encoded_size);
       return;
     }
-    const std::string current_span_context = oss.str();
-    request_headers.insertOtSpanContext().value(
-        Base64::encode(current_span_context.c_str(), current_span_context.length()));
+    if (!ostream.good()) {
+      // The span context did not fit, so it is serialized again into allocated storage.
+      std::ostringstream oss;
+      was_successful = span_->tracer().Inject(span_->context(), oss);
+      if (was_successful) {
+        const std::string current_span_context = oss.str();
+        request_headers.insertOtSpanContext().value(
+            Base64::encode(current_span_context.c_str(), current_span_context.length()));
+        return;
+      }
+    }
+    ENVOY_LOG(debug, "Failed to inject span context: {}", was_successful.error().message());
+    driver_.tracerStats().span_context_injection_error_.inc();
   } else {
     // Inject the context using the tracer's standard HTTP header format.
     const OpenTracingHTTPHeadersWriter writer{request_headers};
@@ -124,6 +147,7 @@ void OpenTracingSpan::injectContext(Http::HeaderMap& request_headers) {
 
 void OpenTracingSpan::setSampled(bool sampled) {
   span_->SetTag(opentracing::ext::sampling_priority, sampled ? 1 : 0);
+  sampled_ = sampled;
 }
 
 Tracing::SpanPtr OpenTracingSpan::spawnChild(const Tracing::Config&, const std::string& name,
@@ -131,7 +155,7 @@ Tracing::SpanPtr OpenTracingSpan::spawnChild(const Tracing::Config&, const std::
   std::unique_ptr<opentracing::Span> ot_span = span_->tracer().StartSpan(
       name, {opentracing::ChildOf(&span_->context()), opentracing::StartTimestamp(start_time)});
   RELEASE_ASSERT(ot_span != nullptr, "");
-  return Tracing::SpanPtr{new OpenTracingSpan{driver_, std::move(ot_span)}};
+  return Tracing::SpanPtr{new OpenTracingSpan{driver_, std::move(ot_span), sampled_}};
 }
 
 OpenTracingDriver::OpenTracingDriver(Stats::Store& stats)
@@ -148,10 +172,22 @@ Tracing::SpanPtr OpenTracingDriver::startSpan(const Tracing::Config& config,
   std::unique_ptr<opentracing::SpanContext> parent_span_ctx;
   if (propagation_mode == PropagationMode::SingleHeader && request_headers.OtSpanContext()) {
     opentracing::expected<std::unique_ptr<opentracing::SpanContext>> parent_span_ctx_maybe;
-    std::string parent_context = Base64::decode(request_headers.OtSpanContext()->value().c_str());
+    const Http::HeaderString& encoded = request_headers.OtSpanContext()->value();
+    // Small span contexts are decoded on the stack, larger ones into allocated storage.
+    char inline_context[MaxInlineSpanContextSize];
+    std::string allocated_context;
+    const char* parent_context = inline_context;
+    uint64_t parent_context_size;
+    if (encoded.size() / 4 * 3 <= sizeof(inline_context)) {
+      parent_context_size = Base64::decode(encoded.c_str(), encoded.size(), inline_context);
+    } else {
+      allocated_context = Base64::decode(std::string(encoded.c_str(), encoded.size()));
+      parent_context = allocated_context.data();
+      parent_context_size = allocated_context.size();
+    }
 
-    if (!parent_context.empty()) {
-      InputConstMemoryStream istream{parent_context.data(), parent_context.size()};
+    if (parent_context_size > 0) {
+      InputConstMemoryStream istream{parent_context, parent_context_size};
       parent_span_ctx_maybe = tracer.Extract(istream);
     } else {
       parent_span_ctx_maybe =
@@ -190,7 +226,8 @@ Tracing::SpanPtr OpenTracingDriver::startSpan(const Tracing::Config& config,
                       config.operationName() == Tracing::OperationName::Egress
                           ? opentracing::ext::span_kind_rpc_client
                           : opentracing::ext::span_kind_rpc_server);
-  return Tracing::SpanPtr{new OpenTracingSpan{*this, std::move(active_span)}};
+  return Tracing::SpanPtr{
+      new OpenTracingSpan{*this, std::move(active_span), tracing_decision.traced}};
 }
 
 } // namespace Ot
@@ -29,7 +29,8 @@ class OpenTracingDriver;
 
 class OpenTracingSpan : public Tracing::Span, Logger::Loggable<Logger::Id::tracing> {
 public:
-  OpenTracingSpan(OpenTracingDriver& driver, std::unique_ptr<opentracing::Span>&& span);
+  OpenTracingSpan(OpenTracingDriver& driver, std::unique_ptr<opentracing::Span>&& span,
+                  bool sampled);
 
   // Tracing::Span
   void finishSpan() override;
@@ -39,10 +40,14 @@ public:
   Tracing::SpanPtr spawnChild(const Tracing::Config& config, const std::string& name,
                               SystemTime start_time) override;
   void setSampled(bool) override;
+  bool sampled() const override { return sampled_; }
 
 private:
   OpenTracingDriver& driver_;
   std::unique_ptr<opentracing::Span> span_;
+  // The OpenTracing API does not expose the tracer's sampling decision, so this only tracks
+  // whether Envoy asked for the span not to be sampled.
+  bool sampled_;
 };
 
 /**
@@ -5,28 +5,26 @@ namespace Extensions {
 namespace Tracers {
 namespace Zipkin {
 
-// TODO(fabolive): Need to avoid the copy to improve performance.
-bool SpanBuffer::addSpan(const Span& span) {
-  if (span_buffer_.size() == span_buffer_.capacity()) {
+bool SpanBuffer::addSpan(Span&& span) {
+  if (pending_spans_ == max_spans_) {
     // Buffer full
     return false;
   }
-  span_buffer_.push_back(std::move(span));
+
+  if (pending_spans_ > 0) {
+    serialized_spans_ += ",";
+  }
+  serialized_spans_ += span.toJson();
+  pending_spans_++;
 
   return true;
 }
 
 std::string SpanBuffer::toStringifiedJsonArray() {
-  std::string stringified_json_array = "[";
-
-  if (pendingSpans()) {
-    stringified_json_array += span_buffer_[0].toJson();
-    const uint64_t size = span_buffer_.size();
-    for (uint64_t i = 1; i < size; i++) {
-      stringified_json_array += ",";
-      stringified_json_array += span_buffer_[i].toJson();
-    }
-  }
+  std::string stringified_json_array;
+  stringified_json_array.reserve(serialized_spans_.size() + 2);
+  stringified_json_array += "[";
+  stringified_json_array += serialized_spans_;
   stringified_json_array += "]";
 
   return stringified_json_array;
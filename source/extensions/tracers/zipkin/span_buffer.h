@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 #include "extensions/tracers/zipkin/zipkin_core_types.h"
 
 namespace Envoy {
@@ -9,7 +11,8 @@ namespace Zipkin {
 
 /**
  * This class implements a simple buffer to store Zipkin tracing spans
- * prior to flushing them.
+ * prior to flushing them. Spans are serialized as they are added, so that only their JSON
+ * representation is kept until the buffer is flushed.
  */
 class SpanBuffer {
 public:
@@ -31,27 +34,31 @@ public:
    *
    * @param size The desired buffer size.
    */
-  void allocateBuffer(uint64_t size) { span_buffer_.reserve(size); }
+  void allocateBuffer(uint64_t size) { max_spans_ = size; }
 
   /**
-   * Adds the given Zipkin span to the buffer.
+   * Serializes the given Zipkin span into the buffer.
    *
    * @param span The span to be added to the buffer.
    *
    * @return true if the span was successfully added, or false if the buffer was full.
    */
-  bool addSpan(const Span& span);
+  bool addSpan(Span&& span);
 
   /**
    * Empties the buffer. This method is supposed to be called when all buffered spans
    * have been sent to to the Zipkin service.
    */
-  void clear() { span_buffer_.clear(); }
+  void clear() {
+    // Keeps the memory of the serialized spans, to be reused for the next ones.
+    serialized_spans_.clear();
+    pending_spans_ = 0;
+  }
 
   /**
    * @return the number of spans currently buffered.
    */
-  uint64_t pendingSpans() { return span_buffer_.size(); }
+  uint64_t pendingSpans() { return pending_spans_; }
 
   /**
    * @return the contents of the buffer as a stringified array of JSONs, where
@@ -60,8 +67,10 @@ public:
   std::string toStringifiedJsonArray();
 
 private:
-  // We use a pre-allocated vector to improve performance
-  std::vector<Span> span_buffer_;
+  uint64_t max_spans_{};
+  uint64_t pending_spans_{};
+  // The JSONs of the buffered spans, separated by commas.
+  std::string serialized_spans_;
 };
 
 } // namespace Zipkin
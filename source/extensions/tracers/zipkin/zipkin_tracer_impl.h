@@ -68,6 +68,8 @@ public:
 
   void setSampled(bool sampled) override;
 
+  bool sampled() const override { return span_.sampled(); }
+
   /**
    * @return a reference to the Zipkin::Span object.
    */
@@ -165,11 +167,11 @@ public:
   /**
    * Implementation of Zipkin::Reporter::reportSpan().
    *
-   * Buffers the given span and calls flushSpans() if the buffer is full.
+   * Serializes the given span into the buffer and calls flushSpans() if the buffer is full.
    *
    * @param span The span to be buffered.
    */
-  void reportSpan(const Span& span) override;
+  void reportSpan(Span&& span) override;
 
   // Http::AsyncClient::Callbacks.
   // The callbacks below record Zipkin-span-related stats.
@@ -16,33 +16,53 @@ TsiFrameProtector::TsiFrameProtector(CFrameProtectorPtr&& frame_protector)
 tsi_result TsiFrameProtector::protect(Buffer::Instance& input, Buffer::Instance& output) {
   ASSERT(frame_protector_);
 
-  unsigned char protected_buffer[BUFFER_SIZE];
-  while (input.length() > 0) {
-    auto* message_bytes = reinterpret_cast<unsigned char*>(input.linearize(input.length()));
-    size_t protected_buffer_size = BUFFER_SIZE;
-    size_t processed_message_size = input.length();
-    tsi_result result =
-        tsi_frame_protector_protect(frame_protector_.get(), message_bytes, &processed_message_size,
-                                    protected_buffer, &protected_buffer_size);
-    if (result != TSI_OK) {
-      ASSERT(result != TSI_INVALID_ARGUMENT && result != TSI_UNIMPLEMENTED);
-      return result;
+  // The slices of the input are passed to TSI as they are, rather than linearizing the input first,
+  // as TSI buffers the input of a frame until it is complete. Frames are written directly into
+  // space reserved in the output.
+  const uint64_t num_slices = input.getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  input.getRawSlices(slices, num_slices);
+  uint64_t processed_size = 0;
+  for (const Buffer::RawSlice& slice : slices) {
+    const auto* message_bytes = static_cast<const unsigned char*>(slice.mem_);
+    size_t remaining_size = slice.len_;
+    while (remaining_size > 0) {
+      Buffer::RawSlice protected_slice;
+      output.reserve(BUFFER_SIZE, &protected_slice, 1);
+      size_t protected_buffer_size = BUFFER_SIZE;
+      size_t processed_message_size = remaining_size;
+      tsi_result result = tsi_frame_protector_protect(
+          frame_protector_.get(), message_bytes, &processed_message_size,
+          static_cast<unsigned char*>(protected_slice.mem_), &protected_buffer_size);
+      protected_slice.len_ = result == TSI_OK ? protected_buffer_size : 0;
+      output.commit(&protected_slice, 1);
+      if (result != TSI_OK) {
+        ASSERT(result != TSI_INVALID_ARGUMENT && result != TSI_UNIMPLEMENTED);
+        input.drain(processed_size);
+        return result;
+      }
+      message_bytes += processed_message_size;
+      remaining_size -= processed_message_size;
+      processed_size += processed_message_size;
     }
-    output.add(protected_buffer, protected_buffer_size);
-    input.drain(processed_message_size);
   }
+  input.drain(processed_size);
 
-  // TSI may buffer some of the input internally. Flush its buffer to protected_buffer.
+  // TSI may buffer some of the input internally. Flush its buffer to the output.
   size_t still_pending_size;
   do {
+    Buffer::RawSlice protected_slice;
+    output.reserve(BUFFER_SIZE, &protected_slice, 1);
     size_t protected_buffer_size = BUFFER_SIZE;
     tsi_result result = tsi_frame_protector_protect_flush(
-        frame_protector_.get(), protected_buffer, &protected_buffer_size, &still_pending_size);
+        frame_protector_.get(), static_cast<unsigned char*>(protected_slice.mem_),
+        &protected_buffer_size, &still_pending_size);
+    protected_slice.len_ = result == TSI_OK ? protected_buffer_size : 0;
+    output.commit(&protected_slice, 1);
     if (result != TSI_OK) {
       ASSERT(result != TSI_INVALID_ARGUMENT && result != TSI_UNIMPLEMENTED);
       return result;
     }
-    output.add(protected_buffer, protected_buffer_size);
   } while (still_pending_size > 0);
 
   return TSI_OK;
@@ -51,22 +71,36 @@ tsi_result TsiFrameProtector::protect(Buffer::Instance& input, Buffer::Instance&
 tsi_result TsiFrameProtector::unprotect(Buffer::Instance& input, Buffer::Instance& output) {
   ASSERT(frame_protector_);
 
-  unsigned char unprotected_buffer[BUFFER_SIZE];
-
-  while (input.length() > 0) {
-    auto* message_bytes = reinterpret_cast<unsigned char*>(input.linearize(input.length()));
-    size_t unprotected_buffer_size = BUFFER_SIZE;
-    size_t processed_message_size = input.length();
-    tsi_result result = tsi_frame_protector_unprotect(frame_protector_.get(), message_bytes,
-                                                      &processed_message_size, unprotected_buffer,
-                                                      &unprotected_buffer_size);
-    if (result != TSI_OK) {
-      ASSERT(result != TSI_INVALID_ARGUMENT && result != TSI_UNIMPLEMENTED);
-      return result;
+  // As for protect(), frames may span slices of the input, and are unprotected directly into space
+  // reserved in the output.
+  const uint64_t num_slices = input.getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  input.getRawSlices(slices, num_slices);
+  uint64_t processed_size = 0;
+  for (const Buffer::RawSlice& slice : slices) {
+    const auto* message_bytes = static_cast<const unsigned char*>(slice.mem_);
+    size_t remaining_size = slice.len_;
+    while (remaining_size > 0) {
+      Buffer::RawSlice unprotected_slice;
+      output.reserve(BUFFER_SIZE, &unprotected_slice, 1);
+      size_t unprotected_buffer_size = BUFFER_SIZE;
+      size_t processed_message_size = remaining_size;
+      tsi_result result = tsi_frame_protector_unprotect(
+          frame_protector_.get(), message_bytes, &processed_message_size,
+          static_cast<unsigned char*>(unprotected_slice.mem_), &unprotected_buffer_size);
+      unprotected_slice.len_ = result == TSI_OK ? unprotected_buffer_size : 0;
+      output.commit(&unprotected_slice, 1);
+      if (result != TSI_OK) {
+        ASSERT(result != TSI_INVALID_ARGUMENT && result != TSI_UNIMPLEMENTED);
+        input.drain(processed_size);
+        return result;
+      }
+      message_bytes += processed_message_size;
+      remaining_size -= processed_message_size;
+      processed_size += processed_message_size;
     }
-    output.add(unprotected_buffer, unprotected_buffer_size);
-    input.drain(processed_message_size);
   }
+  input.drain(processed_size);
 
   return TSI_OK;
 }
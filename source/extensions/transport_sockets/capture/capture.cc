@@ -1,6 +1,5 @@
 #include "extensions/transport_sockets/capture/capture.h"
 
-#include "common/buffer/buffer_impl.h"
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
 #include "common/network/utility.h"
@@ -11,11 +10,13 @@ namespace Extensions {
 namespace TransportSockets {
 namespace Capture {
 
-CaptureSocket::CaptureSocket(
-    const std::string& path_prefix,
-    envoy::config::transport_socket::capture::v2alpha::FileSink::Format format,
-    Network::TransportSocketPtr&& transport_socket)
-    : path_prefix_(path_prefix), format_(format), transport_socket_(std::move(transport_socket)) {}
+CaptureSocket::CaptureSocket(const std::string& path_prefix, Format format,
+                             uint64_t max_buffered_bytes, CaptureWriterSharedPtr writer,
+                             CaptureStats& stats, Network::TransportSocketPtr&& transport_socket)
+    : path_prefix_(path_prefix), format_(format), max_buffered_bytes_(max_buffered_bytes),
+      writer_(std::move(writer)), stats_(stats),
+      trace_(std::make_unique<envoy::data::tap::v2alpha::Trace>()),
+      transport_socket_(std::move(transport_socket)) {}
 
 void CaptureSocket::setTransportSocketCallbacks(Network::TransportSocketCallbacks& callbacks) {
   callbacks_ = &callbacks;
@@ -29,25 +30,16 @@ bool CaptureSocket::canFlushClose() { return transport_socket_->canFlushClose();
 void CaptureSocket::closeSocket(Network::ConnectionEvent event) {
   // The caller should have invoked setTransportSocketCallbacks() prior to this.
   ASSERT(callbacks_ != nullptr);
-  auto* connection = trace_.mutable_connection();
-  connection->set_id(callbacks_->connection().id());
-  Network::Utility::addressToProtobufAddress(*callbacks_->connection().localAddress(),
-                                             *connection->mutable_local_address());
-  Network::Utility::addressToProtobufAddress(*callbacks_->connection().remoteAddress(),
-                                             *connection->mutable_remote_address());
-  const bool text_format =
-      format_ == envoy::config::transport_socket::capture::v2alpha::FileSink::PROTO_TEXT;
-  const std::string path = fmt::format("{}_{}.{}", path_prefix_, callbacks_->connection().id(),
-                                       text_format ? "pb_text" : "pb");
-  ENVOY_LOG_MISC(debug, "Writing socket trace for [C{}] to {}", callbacks_->connection().id(),
-                 path);
-  ENVOY_LOG_MISC(trace, "Socket trace for [C{}]: {}", callbacks_->connection().id(),
-                 trace_.DebugString());
-  std::ofstream proto_stream(path);
-  if (text_format) {
-    proto_stream << trace_.DebugString();
+  if (writer_ != nullptr) {
+    emitSegment(true);
   } else {
-    trace_.SerializeToOstream(&proto_stream);
+    setConnection();
+    const std::string path = this->path();
+    ENVOY_LOG_MISC(debug, "Writing socket trace for [C{}] to {}", callbacks_->connection().id(),
+                   path);
+    ENVOY_LOG_MISC(trace, "Socket trace for [C{}]: {}", callbacks_->connection().id(),
+                   trace_->DebugString());
+    TraceFile(path, format_).append(*trace_);
   }
   transport_socket_->closeSocket(event);
 }
@@ -55,51 +47,101 @@ void CaptureSocket::closeSocket(Network::ConnectionEvent event) {
 Network::IoResult CaptureSocket::doRead(Buffer::Instance& buffer) {
   Network::IoResult result = transport_socket_->doRead(buffer);
   if (result.bytes_processed_ > 0) {
-    // TODO(htuch): avoid linearizing
-    char* data = static_cast<char*>(buffer.linearize(buffer.length())) +
-                 (buffer.length() - result.bytes_processed_);
-    auto* event = trace_.add_events();
-    event->mutable_timestamp()->MergeFrom(Protobuf::util::TimeUtil::NanosecondsToTimestamp(
-        std::chrono::duration_cast<std::chrono::nanoseconds>(
-            std::chrono::system_clock::now().time_since_epoch())
-            .count()));
-    event->mutable_read()->set_data(data, result.bytes_processed_);
+    // Copy the read slices out rather than linearizing the whole buffer.
+    std::string data;
+    data.resize(result.bytes_processed_);
+    buffer.copyOut(buffer.length() - result.bytes_processed_, result.bytes_processed_, &data[0]);
+    addEvent(result.bytes_processed_).mutable_read()->set_data(std::move(data));
+    onEventAdded();
   }
 
   return result;
 }
 
 Network::IoResult CaptureSocket::doWrite(Buffer::Instance& buffer, bool end_stream) {
-  // TODO(htuch): avoid copy.
-  Buffer::OwnedImpl copy(buffer);
+  // The inner socket drains the buffer, so it's copied out first.
+  std::string data;
+  data.resize(buffer.length());
+  if (!data.empty()) {
+    buffer.copyOut(0, data.size(), &data[0]);
+  }
   Network::IoResult result = transport_socket_->doWrite(buffer, end_stream);
   if (result.bytes_processed_ > 0) {
-    // TODO(htuch): avoid linearizing.
-    char* data = static_cast<char*>(copy.linearize(result.bytes_processed_));
-    auto* event = trace_.add_events();
-    event->mutable_timestamp()->MergeFrom(Protobuf::util::TimeUtil::NanosecondsToTimestamp(
-        std::chrono::duration_cast<std::chrono::nanoseconds>(
-            std::chrono::system_clock::now().time_since_epoch())
-            .count()));
-    event->mutable_write()->set_data(data, result.bytes_processed_);
-    event->mutable_write()->set_end_stream(end_stream);
+    data.resize(result.bytes_processed_);
+    auto* write = addEvent(result.bytes_processed_).mutable_write();
+    write->set_data(std::move(data));
+    write->set_end_stream(end_stream);
+    onEventAdded();
   }
   return result;
 }
 
+envoy::data::tap::v2alpha::Event& CaptureSocket::addEvent(uint64_t bytes) {
+  auto* event = trace_->add_events();
+  event->mutable_timestamp()->MergeFrom(Protobuf::util::TimeUtil::NanosecondsToTimestamp(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count()));
+  buffered_bytes_ += bytes;
+  return *event;
+}
+
+void CaptureSocket::onEventAdded() {
+  if (writer_ != nullptr && buffered_bytes_ >= max_buffered_bytes_) {
+    emitSegment(false);
+  }
+}
+
+void CaptureSocket::setConnection() {
+  if (connection_set_) {
+    return;
+  }
+  connection_set_ = true;
+  auto* connection = trace_->mutable_connection();
+  connection->set_id(callbacks_->connection().id());
+  Network::Utility::addressToProtobufAddress(*callbacks_->connection().localAddress(),
+                                             *connection->mutable_local_address());
+  Network::Utility::addressToProtobufAddress(*callbacks_->connection().remoteAddress(),
+                                             *connection->mutable_remote_address());
+}
+
+void CaptureSocket::emitSegment(bool last) {
+  // Only the first segment carries the connection properties.
+  setConnection();
+  stats_.events_dropped_.add(
+      writer_->write(path(), format_, std::move(trace_), buffered_bytes_, last));
+  trace_ = std::make_unique<envoy::data::tap::v2alpha::Trace>();
+  buffered_bytes_ = 0;
+}
+
+std::string CaptureSocket::path() const {
+  return fmt::format("{}_{}.{}", path_prefix_, callbacks_->connection().id(),
+                     TraceFile::extension(format_));
+}
+
 void CaptureSocket::onConnected() { transport_socket_->onConnected(); }
 
 const Ssl::Connection* CaptureSocket::ssl() const { return transport_socket_->ssl(); }
 
 CaptureSocketFactory::CaptureSocketFactory(
-    const std::string& path_prefix,
-    envoy::config::transport_socket::capture::v2alpha::FileSink::Format format,
+    const std::string& path_prefix, Format format, uint64_t max_buffered_bytes,
+    uint64_t max_pending_bytes, uint64_t connection_sampling_interval, Stats::Scope& scope,
     Network::TransportSocketFactoryPtr&& transport_socket_factory)
-    : path_prefix_(path_prefix), format_(format),
+    : path_prefix_(path_prefix), format_(format), max_buffered_bytes_(max_buffered_bytes),
+      connection_sampling_interval_(connection_sampling_interval),
+      writer_(max_buffered_bytes > 0 ? std::make_shared<CaptureWriter>(max_pending_bytes)
+                                     : nullptr),
+      stats_{ALL_CAPTURE_STATS(POOL_COUNTER_PREFIX(scope, "capture."))},
       transport_socket_factory_(std::move(transport_socket_factory)) {}
 
 Network::TransportSocketPtr CaptureSocketFactory::createTransportSocket() const {
-  return std::make_unique<CaptureSocket>(path_prefix_, format_,
+  // Sockets that are not sampled are not wrapped at all.
+  if (connections_++ % connection_sampling_interval_ != 0) {
+    return transport_socket_factory_->createTransportSocket();
+  }
+  stats_.connections_captured_.inc();
+  return std::make_unique<CaptureSocket>(path_prefix_, format_, max_buffered_bytes_, writer_,
+                                         stats_,
                                          transport_socket_factory_->createTransportSocket());
 }
 
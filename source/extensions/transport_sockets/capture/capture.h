@@ -1,20 +1,46 @@
 #pragma once
 
-#include <fstream>
+#include <atomic>
 
 #include "envoy/config/transport_socket/capture/v2alpha/capture.pb.h"
 #include "envoy/data/tap/v2alpha/capture.pb.h"
 #include "envoy/network/transport_socket.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "extensions/transport_sockets/capture/capture_writer.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace TransportSockets {
 namespace Capture {
 
+/**
+ * All capture stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_CAPTURE_STATS(COUNTER)                                                                 \
+  COUNTER(connections_captured)                                                                    \
+  COUNTER(events_dropped)
+// clang-format on
+
+/**
+ * Struct definition for all capture stats. @see stats_macros.h
+ */
+struct CaptureStats {
+  ALL_CAPTURE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
 class CaptureSocket : public Network::TransportSocket {
 public:
-  CaptureSocket(const std::string& path_prefix,
-                envoy::config::transport_socket::capture::v2alpha::FileSink::Format format,
+  /**
+   * @param max_buffered_bytes supplies the bytes of events after which they are handed to the
+   *        writer. Only used with a writer.
+   * @param writer supplies the writer thread of the trace, or nullptr to write the whole trace
+   *        when the socket closes.
+   */
+  CaptureSocket(const std::string& path_prefix, Format format, uint64_t max_buffered_bytes,
+                CaptureWriterSharedPtr writer, CaptureStats& stats,
                 Network::TransportSocketPtr&& transport_socket);
 
   // Network::TransportSocket
@@ -28,21 +54,36 @@ public:
   const Ssl::Connection* ssl() const override;
 
 private:
+  envoy::data::tap::v2alpha::Event& addEvent(uint64_t bytes);
+  void onEventAdded();
+  void setConnection();
+  void emitSegment(bool last);
+  std::string path() const;
+
   const std::string& path_prefix_;
-  const envoy::config::transport_socket::capture::v2alpha::FileSink::Format format_;
-  // TODO(htuch): Buffering the entire trace until socket close won't scale to
-  // long lived connections or large transfers. We could emit multiple capture
-  // files with bounded size, with identical connection ID to allow later
-  // reassembly.
-  envoy::data::tap::v2alpha::Trace trace_;
+  const Format format_;
+  const uint64_t max_buffered_bytes_;
+  CaptureWriterSharedPtr writer_;
+  CaptureStats& stats_;
+  // The events not yet handed to the writer, or the whole trace without a writer.
+  TracePtr trace_;
+  uint64_t buffered_bytes_{};
+  bool connection_set_{};
   Network::TransportSocketPtr transport_socket_;
   Network::TransportSocketCallbacks* callbacks_{};
 };
 
 class CaptureSocketFactory : public Network::TransportSocketFactory {
 public:
-  CaptureSocketFactory(const std::string& path_prefix,
-                       envoy::config::transport_socket::capture::v2alpha::FileSink::Format format,
+  /**
+   * @param max_buffered_bytes supplies the bytes of events after which a socket hands them to the
+   *        writer thread, or 0 to write the traces when the sockets close.
+   * @param max_pending_bytes supplies the bound of the bytes queued to the writer thread.
+   * @param connection_sampling_interval supplies the interval of the captured sockets.
+   */
+  CaptureSocketFactory(const std::string& path_prefix, Format format, uint64_t max_buffered_bytes,
+                       uint64_t max_pending_bytes, uint64_t connection_sampling_interval,
+                       Stats::Scope& scope,
                        Network::TransportSocketFactoryPtr&& transport_socket_factory);
 
   // Network::TransportSocketFactory
@@ -51,7 +92,13 @@ public:
 
 private:
   const std::string path_prefix_;
-  const envoy::config::transport_socket::capture::v2alpha::FileSink::Format format_;
+  const Format format_;
+  const uint64_t max_buffered_bytes_;
+  const uint64_t connection_sampling_interval_;
+  // Sockets are created by the workers concurrently.
+  mutable std::atomic<uint64_t> connections_{};
+  CaptureWriterSharedPtr writer_;
+  mutable CaptureStats stats_;
   Network::TransportSocketFactoryPtr transport_socket_factory_;
 };
 
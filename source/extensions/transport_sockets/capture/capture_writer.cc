@@ -0,0 +1,295 @@
+#include "extensions/transport_sockets/capture/capture_writer.h"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/common/logger.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Capture {
+
+namespace {
+
+// libpcap file header fields, for microsecond timestamps and raw IP packets.
+constexpr uint32_t PCAP_MAGIC = 0xa1b2c3d4;
+constexpr uint16_t PCAP_VERSION_MAJOR = 2;
+constexpr uint16_t PCAP_VERSION_MINOR = 4;
+constexpr uint32_t PCAP_SNAPLEN = 65535;
+constexpr uint32_t PCAP_LINKTYPE_RAW = 101;
+
+constexpr uint64_t IPV4_HEADER_SIZE = 20;
+constexpr uint64_t IPV6_HEADER_SIZE = 40;
+constexpr uint64_t TCP_HEADER_SIZE = 20;
+// Larger events are split into several packets, so that each fits the snap length.
+constexpr uint64_t MAX_PACKET_PAYLOAD = PCAP_SNAPLEN - IPV6_HEADER_SIZE - TCP_HEADER_SIZE;
+
+constexpr uint8_t IP_PROTOCOL_TCP = 6;
+constexpr uint8_t IP_TTL = 64;
+constexpr uint8_t TCP_FLAG_FIN = 0x01;
+constexpr uint8_t TCP_FLAG_PSH = 0x08;
+constexpr uint8_t TCP_FLAG_ACK = 0x10;
+
+// Appends the value in host order, as the libpcap headers are.
+template <class T> void appendHostOrder(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendNetworkOrder16(std::string& out, uint16_t value) { appendHostOrder(out, htons(value)); }
+
+void appendNetworkOrder32(std::string& out, uint32_t value) { appendHostOrder(out, htonl(value)); }
+
+// @return the IPv4 header checksum of the header starting at header.
+uint16_t ipv4Checksum(const uint8_t* header) {
+  uint32_t sum = 0;
+  for (uint64_t i = 0; i < IPV4_HEADER_SIZE; i += 2) {
+    sum += (header[i] << 8) | header[i + 1];
+  }
+  while (sum >> 16) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+  return ~sum;
+}
+
+// Sets ip to the network order bytes of the IP of the address, if it is of the family. Otherwise
+// ip is left unchanged.
+void parseIp(const envoy::api::v2::core::Address& address, bool ipv6, std::string& ip,
+             uint16_t& port) {
+  uint8_t bytes[sizeof(in6_addr)];
+  if (inet_pton(ipv6 ? AF_INET6 : AF_INET, address.socket_address().address().c_str(), bytes) ==
+      1) {
+    ip.assign(reinterpret_cast<const char*>(bytes), ipv6 ? sizeof(in6_addr) : sizeof(in_addr));
+    port = address.socket_address().port_value();
+  }
+}
+
+} // namespace
+
+TraceFile::TraceFile(const std::string& path, Format format)
+    : stream_(path, std::ios::binary), format_(format), local_ip_(sizeof(in_addr), '\0'),
+      remote_ip_(sizeof(in_addr), '\0') {
+  if (format_ == envoy::config::transport_socket::capture::v2alpha::FileSink::PCAP) {
+    std::string header;
+    appendHostOrder(header, PCAP_MAGIC);
+    appendHostOrder(header, PCAP_VERSION_MAJOR);
+    appendHostOrder(header, PCAP_VERSION_MINOR);
+    appendHostOrder(header, int32_t(0));  // GMT to local correction.
+    appendHostOrder(header, uint32_t(0)); // Accuracy of timestamps.
+    appendHostOrder(header, PCAP_SNAPLEN);
+    appendHostOrder(header, PCAP_LINKTYPE_RAW);
+    stream_.write(header.data(), header.size());
+  }
+}
+
+const char* TraceFile::extension(Format format) {
+  switch (format) {
+  case envoy::config::transport_socket::capture::v2alpha::FileSink::PROTO_TEXT:
+    return "pb_text";
+  case envoy::config::transport_socket::capture::v2alpha::FileSink::PCAP:
+    return "pcap";
+  default:
+    return "pb";
+  }
+}
+
+void TraceFile::append(const envoy::data::tap::v2alpha::Trace& trace) {
+  switch (format_) {
+  case envoy::config::transport_socket::capture::v2alpha::FileSink::PROTO_TEXT:
+    // Only the first segment has the connection, so the segments parse as a single trace.
+    stream_ << trace.DebugString();
+    break;
+  case envoy::config::transport_socket::capture::v2alpha::FileSink::PCAP:
+    appendPcap(trace);
+    break;
+  default:
+    // Serialized messages concatenate into the merged message.
+    trace.SerializeToOstream(&stream_);
+    break;
+  }
+  stream_.flush();
+}
+
+void TraceFile::appendPcap(const envoy::data::tap::v2alpha::Trace& trace) {
+  if (trace.has_connection()) {
+    const auto& connection = trace.connection();
+    in6_addr ipv6_address;
+    ipv6_ = inet_pton(AF_INET6, connection.local_address().socket_address().address().c_str(),
+                      &ipv6_address) == 1;
+    if (ipv6_) {
+      local_ip_.assign(sizeof(in6_addr), '\0');
+      remote_ip_.assign(sizeof(in6_addr), '\0');
+    }
+    parseIp(connection.local_address(), ipv6_, local_ip_, local_port_);
+    parseIp(connection.remote_address(), ipv6_, remote_ip_, remote_port_);
+  }
+
+  for (const auto& event : trace.events()) {
+    const bool read = event.has_read();
+    const std::string& data = read ? event.read().data() : event.write().data();
+    const bool end_stream = !read && event.write().end_stream();
+    uint64_t offset = 0;
+    do {
+      const uint64_t length = std::min<uint64_t>(data.size() - offset, MAX_PACKET_PAYLOAD);
+      const bool last_packet = offset + length == data.size();
+      appendPcapPacket(event, read, data, offset, length, end_stream && last_packet);
+      offset += length;
+    } while (offset < data.size());
+  }
+}
+
+void TraceFile::appendPcapPacket(const envoy::data::tap::v2alpha::Event& event, bool read,
+                                 const std::string& data, uint64_t offset, uint64_t length,
+                                 bool fin) {
+  // Reads are sent by the remote end of the connection, and writes by the local end.
+  const std::string& source_ip = read ? remote_ip_ : local_ip_;
+  const std::string& destination_ip = read ? local_ip_ : remote_ip_;
+  uint32_t& seq = read ? remote_seq_ : local_seq_;
+  const uint32_t ack = read ? local_seq_ : remote_seq_;
+  const uint64_t ip_packet_size =
+      (ipv6_ ? IPV6_HEADER_SIZE : IPV4_HEADER_SIZE) + TCP_HEADER_SIZE + length;
+
+  std::string packet;
+  packet.reserve(16 + ip_packet_size);
+  appendHostOrder(packet, static_cast<uint32_t>(event.timestamp().seconds()));
+  appendHostOrder(packet, static_cast<uint32_t>(event.timestamp().nanos() / 1000));
+  appendHostOrder(packet, static_cast<uint32_t>(ip_packet_size));
+  appendHostOrder(packet, static_cast<uint32_t>(ip_packet_size));
+
+  if (ipv6_) {
+    appendNetworkOrder32(packet, 0x60000000); // Version, traffic class and flow label.
+    appendNetworkOrder16(packet, TCP_HEADER_SIZE + length);
+    packet.push_back(IP_PROTOCOL_TCP);
+    packet.push_back(IP_TTL);
+    packet.append(source_ip);
+    packet.append(destination_ip);
+  } else {
+    const size_t header_start = packet.size();
+    packet.push_back(0x45); // Version and header length.
+    packet.push_back(0);    // Type of service.
+    appendNetworkOrder16(packet, ip_packet_size);
+    appendNetworkOrder16(packet, 0);      // Identification.
+    appendNetworkOrder16(packet, 0x4000); // Don't fragment.
+    packet.push_back(IP_TTL);
+    packet.push_back(IP_PROTOCOL_TCP);
+    appendNetworkOrder16(packet, 0); // Checksum, set below.
+    packet.append(source_ip);
+    packet.append(destination_ip);
+    const uint16_t checksum =
+        ipv4Checksum(reinterpret_cast<const uint8_t*>(packet.data() + header_start));
+    packet[header_start + 10] = checksum >> 8;
+    packet[header_start + 11] = checksum & 0xff;
+  }
+
+  appendNetworkOrder16(packet, read ? remote_port_ : local_port_);
+  appendNetworkOrder16(packet, read ? local_port_ : remote_port_);
+  appendNetworkOrder32(packet, seq);
+  appendNetworkOrder32(packet, ack);
+  packet.push_back(0x50); // Header length.
+  packet.push_back(TCP_FLAG_ACK | TCP_FLAG_PSH | (fin ? TCP_FLAG_FIN : 0));
+  appendNetworkOrder16(packet, 65535); // Window.
+  // The checksum is left out, as the stream is synthesized.
+  appendNetworkOrder16(packet, 0);
+  appendNetworkOrder16(packet, 0); // Urgent pointer.
+  packet.append(data, offset, length);
+
+  seq += length + (fin ? 1 : 0);
+  stream_.write(packet.data(), packet.size());
+}
+
+CaptureWriter::CaptureWriter(uint64_t max_pending_bytes) : max_pending_bytes_(max_pending_bytes) {}
+
+CaptureWriter::~CaptureWriter() {
+  {
+    Thread::LockGuard lock(mutex_);
+    exit_ = true;
+    ready_event_.notifyOne();
+  }
+
+  if (thread_ != nullptr) {
+    thread_->join();
+  }
+}
+
+uint64_t CaptureWriter::write(const std::string& path, Format format, TracePtr&& trace,
+                              uint64_t bytes, bool last) {
+  uint64_t dropped = 0;
+  Thread::LockGuard lock(mutex_);
+  if (thread_ == nullptr) {
+    thread_.reset(new Thread::Thread([this]() -> void { threadRoutine(); }));
+  }
+
+  if (pending_bytes_ + bytes > max_pending_bytes_) {
+    // Drop the events, but keep the connection properties and the end of the trace.
+    dropped = trace->events_size();
+    trace->clear_events();
+    bytes = 0;
+    if (!last && !trace->has_connection()) {
+      return dropped;
+    }
+  }
+
+  pending_bytes_ += bytes;
+  pending_.push_back({path, format, std::move(trace), bytes, last});
+  ready_event_.notifyOne();
+  return dropped;
+}
+
+void CaptureWriter::drain() {
+  Thread::LockGuard lock(mutex_);
+  while (!pending_.empty() || writing_) {
+    // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+    idle_event_.wait(mutex_);
+  }
+}
+
+void CaptureWriter::threadRoutine() {
+  while (true) {
+    Segment segment;
+    {
+      Thread::LockGuard lock(mutex_);
+      while (pending_.empty() && !exit_) {
+        ready_event_.wait(mutex_);
+      }
+
+      // Write the queued segments before exiting.
+      if (pending_.empty()) {
+        return;
+      }
+
+      segment = std::move(pending_.front());
+      pending_.pop_front();
+      pending_bytes_ -= segment.bytes_;
+      writing_ = true;
+    }
+
+    writeSegment(segment);
+
+    {
+      Thread::LockGuard lock(mutex_);
+      writing_ = false;
+      if (pending_.empty()) {
+        idle_event_.notifyAll();
+      }
+    }
+  }
+}
+
+void CaptureWriter::writeSegment(Segment& segment) {
+  std::unique_ptr<TraceFile>& file = files_[segment.path_];
+  if (file == nullptr) {
+    ENVOY_LOG_MISC(debug, "Writing socket trace to {}", segment.path_);
+    file = std::make_unique<TraceFile>(segment.path_, segment.format_);
+  }
+  file->append(*segment.trace_);
+  if (segment.last_) {
+    files_.erase(segment.path_);
+  }
+}
+
+} // namespace Capture
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/config/transport_socket/capture/v2alpha/capture.pb.h"
+#include "envoy/data/tap/v2alpha/capture.pb.h"
+
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Capture {
+
+typedef envoy::config::transport_socket::capture::v2alpha::FileSink::Format Format;
+typedef std::unique_ptr<envoy::data::tap::v2alpha::Trace> TracePtr;
+
+/**
+ * The file of the trace of a socket. The trace may be appended in several segments, the first of
+ * which carries the connection properties.
+ */
+class TraceFile {
+public:
+  TraceFile(const std::string& path, Format format);
+
+  /**
+   * Append a segment of the trace to the file.
+   */
+  void append(const envoy::data::tap::v2alpha::Trace& trace);
+
+  /**
+   * @return the extension of the files of the format, without the leading dot.
+   */
+  static const char* extension(Format format);
+
+private:
+  void appendPcap(const envoy::data::tap::v2alpha::Trace& trace);
+  void appendPcapPacket(const envoy::data::tap::v2alpha::Event& event, bool read,
+                        const std::string& data, uint64_t offset, uint64_t length, bool fin);
+
+  std::ofstream stream_;
+  const Format format_;
+  // The state of the synthesized TCP stream of PCAP files.
+  bool ipv6_{};
+  std::string local_ip_;
+  std::string remote_ip_;
+  uint16_t local_port_{};
+  uint16_t remote_port_{};
+  uint32_t local_seq_{1};
+  uint32_t remote_seq_{1};
+};
+
+/**
+ * Thread appending the trace segments of the sockets that share it to their files, so that the
+ * workers do not block on file IO. The bytes of events waiting to be written are bounded, and the
+ * events of segments beyond the bound are dropped. The thread is started by the first segment.
+ */
+class CaptureWriter {
+public:
+  CaptureWriter(uint64_t max_pending_bytes);
+  ~CaptureWriter();
+
+  /**
+   * Queue a segment of the trace of a socket. The file of the socket is closed after its last
+   * segment.
+   * @param path supplies the path of the trace file of the socket.
+   * @param format supplies the format of the file.
+   * @param trace supplies the segment.
+   * @param bytes supplies the number of bytes of the events of the segment.
+   * @param last supplies whether this is the last segment of the socket.
+   * @return the number of events dropped because too many bytes are pending.
+   */
+  uint64_t write(const std::string& path, Format format, TracePtr&& trace, uint64_t bytes,
+                 bool last);
+
+  /**
+   * Wait for the queued segments to be written. For tests.
+   */
+  void drain();
+
+private:
+  struct Segment {
+    std::string path_;
+    Format format_;
+    TracePtr trace_;
+    uint64_t bytes_;
+    bool last_;
+  };
+
+  void threadRoutine();
+  void writeSegment(Segment& segment);
+
+  const uint64_t max_pending_bytes_;
+  Thread::MutexBasicLockable mutex_;
+  Thread::CondVar ready_event_; // Signalled when a segment is queued or the thread should exit.
+  Thread::CondVar idle_event_;  // Signalled when the thread has written the queued segments.
+  std::deque<Segment> pending_ GUARDED_BY(mutex_);
+  uint64_t pending_bytes_ GUARDED_BY(mutex_){};
+  bool writing_ GUARDED_BY(mutex_){};
+  bool exit_ GUARDED_BY(mutex_){};
+  Thread::ThreadPtr thread_;
+  // The files of the sockets whose last segment has not been written yet. Only used by the thread.
+  std::unordered_map<std::string, std::unique_ptr<TraceFile>> files_;
+};
+
+typedef std::shared_ptr<CaptureWriter> CaptureWriterSharedPtr;
+
+} // namespace Capture
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
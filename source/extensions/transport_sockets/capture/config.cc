@@ -14,6 +14,25 @@ namespace Extensions {
 namespace TransportSockets {
 namespace Capture {
 
+namespace {
+
+constexpr uint64_t DEFAULT_MAX_PENDING_BYTES = 64 * 1024 * 1024;
+
+Network::TransportSocketFactoryPtr createCaptureSocketFactory(
+    const envoy::config::transport_socket::capture::v2alpha::Capture& config,
+    Server::Configuration::TransportSocketFactoryContext& context,
+    Network::TransportSocketFactoryPtr&& inner_transport_factory) {
+  const auto& file_sink = config.file_sink();
+  return std::make_unique<CaptureSocketFactory>(
+      file_sink.path_prefix(), file_sink.format(),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(file_sink, max_buffered_bytes, 0),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(file_sink, max_pending_bytes, DEFAULT_MAX_PENDING_BYTES),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, connection_sampling_interval, 1),
+      context.statsScope(), std::move(inner_transport_factory));
+}
+
+} // namespace
+
 Network::TransportSocketFactoryPtr UpstreamCaptureSocketConfigFactory::createTransportSocketFactory(
     const Protobuf::Message& message,
     Server::Configuration::TransportSocketFactoryContext& context) {
@@ -26,9 +45,7 @@ Network::TransportSocketFactoryPtr UpstreamCaptureSocketConfigFactory::createTra
       outer_config.transport_socket(), inner_config_factory);
   auto inner_transport_factory =
       inner_config_factory.createTransportSocketFactory(*inner_factory_config, context);
-  return std::make_unique<CaptureSocketFactory>(outer_config.file_sink().path_prefix(),
-                                                outer_config.file_sink().format(),
-                                                std::move(inner_transport_factory));
+  return createCaptureSocketFactory(outer_config, context, std::move(inner_transport_factory));
 }
 
 Network::TransportSocketFactoryPtr
@@ -44,9 +61,7 @@ DownstreamCaptureSocketConfigFactory::createTransportSocketFactory(
       outer_config.transport_socket(), inner_config_factory);
   auto inner_transport_factory = inner_config_factory.createTransportSocketFactory(
       *inner_factory_config, context, server_names);
-  return std::make_unique<CaptureSocketFactory>(outer_config.file_sink().path_prefix(),
-                                                outer_config.file_sink().format(),
-                                                std::move(inner_transport_factory));
+  return createCaptureSocketFactory(outer_config, context, std::move(inner_transport_factory));
 }
 
 ProtobufTypes::MessagePtr CaptureSocketConfigFactory::createEmptyConfigProto() {
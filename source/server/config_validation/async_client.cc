@@ -12,6 +12,11 @@ ValidationAsyncClient::send(MessagePtr&&, Callbacks&,
   return nullptr;
 }
 
+AsyncClient::Request* ValidationAsyncClient::send(MessagePtr&&, Callbacks&,
+                                                  const RequestOptions&) {
+  return nullptr;
+}
+
 AsyncClient::Stream* ValidationAsyncClient::start(StreamCallbacks&,
                                                   const absl::optional<std::chrono::milliseconds>&,
                                                   bool) {
@@ -24,6 +24,8 @@ public:
   // Http::AsyncClient
   AsyncClient::Request* send(MessagePtr&& request, Callbacks& callbacks,
                              const absl::optional<std::chrono::milliseconds>& timeout) override;
+  AsyncClient::Request* send(MessagePtr&& request, Callbacks& callbacks,
+                             const RequestOptions& options) override;
   AsyncClient::Stream* start(StreamCallbacks& callbacks,
                              const absl::optional<std::chrono::milliseconds>& timeout,
                              bool buffer_body_for_retry) override;
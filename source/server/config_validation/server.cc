@@ -44,6 +44,8 @@ ValidationInstance::ValidationInstance(Options& options, Event::TimeSystem& time
       dispatcher_(api_->allocateDispatcher(time_system)),
       singleton_manager_(new Singleton::ManagerImpl()),
       access_log_manager_(*api_, *dispatcher_, access_log_lock, store),
+      overload_manager_(*dispatcher_, stats_store_, thread_local_,
+                        envoy::config::overload::v2alpha::OverloadManager()),
       listener_manager_(*this, *this, *this, time_system_) {
   try {
     initialize(options, local_address, component_factory);
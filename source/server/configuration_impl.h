@@ -102,6 +102,16 @@ public:
    */
   static bool buildFilterChain(Network::ListenerFilterManager& filter_manager,
                                const std::vector<Network::ListenerFilterFactoryCb>& factories);
+
+  /**
+   * Given a UdpListenerFilterManager and a list of factories, create the read filters of a UDP
+   * listener.
+   * @return false if there are no factories, as the listener would drop all datagrams.
+   */
+  static bool
+  buildUdpFilterChain(Network::UdpListenerFilterManager& filter_manager,
+                      Network::UdpReadFilterCallbacks& callbacks,
+                      const std::vector<Network::UdpListenerFilterFactoryCb>& factories);
 };
 
 /**
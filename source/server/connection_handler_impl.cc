@@ -1,11 +1,14 @@
 #include "server/connection_handler_impl.h"
 
+#include <algorithm>
+
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/timer.h"
 #include "envoy/network/filter.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/timespan.h"
 
+#include "common/common/fmt.h"
 #include "common/network/connection_impl.h"
 #include "common/network/utility.h"
 
@@ -14,11 +17,24 @@
 namespace Envoy {
 namespace Server {
 
-ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher)
-    : logger_(logger), dispatcher_(dispatcher) {}
+ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                                             absl::optional<uint32_t> worker_index)
+    : logger_(logger), dispatcher_(dispatcher), worker_index_(worker_index) {}
 
 void ConnectionHandlerImpl::addListener(Network::ListenerConfig& config) {
+  if (config.socketType() == Network::Address::SocketType::Datagram) {
+    ActiveUdpListenerPtr l(new ActiveUdpListener(*this, config));
+    if (disable_listeners_) {
+      l->udp_listener_->disable();
+    }
+    udp_listeners_.emplace_back(std::move(l));
+    return;
+  }
+
   ActiveListenerPtr l(new ActiveListener(*this, config));
+  if (disable_listeners_ && l->listener_ != nullptr) {
+    l->listener_->disable();
+  }
   listeners_.emplace_back(config.socket().localAddress(), std::move(l));
 }
 
@@ -30,6 +46,24 @@ void ConnectionHandlerImpl::removeListeners(uint64_t listener_tag) {
       ++listener;
     }
   }
+  removeUdpListeners(listener_tag);
+}
+
+void ConnectionHandlerImpl::removeUdpListeners(uint64_t listener_tag) {
+  udp_listeners_.remove_if([listener_tag](const ActiveUdpListenerPtr& listener) {
+    return listener->listener_tag_ == listener_tag;
+  });
+}
+
+void ConnectionHandlerImpl::removeFilterChains(
+    uint64_t listener_tag, const std::unordered_set<const Network::FilterChain*>& filter_chains,
+    std::function<void()> completion) {
+  ActiveListener* listener = findActiveListenerByTag(listener_tag);
+  if (listener == nullptr) {
+    completion();
+    return;
+  }
+  listener->removeFilterChains(filter_chains, completion);
 }
 
 void ConnectionHandlerImpl::stopListeners(uint64_t listener_tag) {
@@ -38,12 +72,38 @@ void ConnectionHandlerImpl::stopListeners(uint64_t listener_tag) {
       listener.second->listener_.reset();
     }
   }
+  // UDP listeners have no connections to drain, and their filters can not outlive the listener
+  // they send through.
+  removeUdpListeners(listener_tag);
 }
 
 void ConnectionHandlerImpl::stopListeners() {
   for (auto& listener : listeners_) {
     listener.second->listener_.reset();
   }
+  udp_listeners_.clear();
+}
+
+void ConnectionHandlerImpl::disableListeners() {
+  disable_listeners_ = true;
+  for (auto& listener : listeners_) {
+    if (listener.second->listener_ != nullptr) {
+      listener.second->listener_->disable();
+    }
+  }
+  for (auto& listener : udp_listeners_) {
+    listener->udp_listener_->disable();
+  }
+}
+
+void ConnectionHandlerImpl::enableListeners() {
+  disable_listeners_ = false;
+  for (auto& listener : listeners_) {
+    listener.second->maybeResumeAccepting();
+  }
+  for (auto& listener : udp_listeners_) {
+    listener->udp_listener_->enable();
+  }
 }
 
 void ConnectionHandlerImpl::ActiveListener::removeConnection(ActiveConnection& connection) {
@@ -53,6 +113,61 @@ void ConnectionHandlerImpl::ActiveListener::removeConnection(ActiveConnection& c
   parent_.dispatcher_.deferredDelete(std::move(removed));
   ASSERT(parent_.num_connections_ > 0);
   parent_.num_connections_--;
+  maybeRemove();
+}
+
+void ConnectionHandlerImpl::ActiveListener::removeFilterChains(
+    const std::unordered_set<const Network::FilterChain*>& filter_chains,
+    std::function<void()> completion) {
+  // Only stopped listeners are removed this way, so no new connections are added meanwhile.
+  ASSERT(listener_ == nullptr);
+  removal_completion_ = completion;
+
+  // Closing a connection removes it from connections_.
+  std::vector<Network::Connection*> to_close;
+  for (const auto& active_connection : connections_) {
+    if (filter_chains.count(active_connection->filter_chain_) > 0) {
+      to_close.push_back(active_connection->connection_.get());
+    }
+  }
+  for (Network::Connection* connection : to_close) {
+    connection->close(Network::ConnectionCloseType::NoFlush);
+  }
+
+  maybeRemove();
+}
+
+void ConnectionHandlerImpl::ActiveListener::maybeRemove() {
+  if (removal_completion_ == nullptr || !connections_.empty()) {
+    return;
+  }
+
+  // This may run from within the close callback of the last connection, so the listener is
+  // removed from the event loop instead.
+  ConnectionHandlerImpl& parent = parent_;
+  const uint64_t listener_tag = listener_tag_;
+  std::function<void()> completion = std::move(removal_completion_);
+  removal_completion_ = nullptr;
+  parent_.dispatcher_.post([&parent, listener_tag, completion]() -> void {
+    parent.removeListeners(listener_tag);
+    completion();
+  });
+}
+
+ConnectionHandlerImpl::ActiveUdpListener::ActiveUdpListener(ConnectionHandlerImpl& parent,
+                                                            Network::ListenerConfig& config)
+    : udp_listener_(parent.dispatcher_.createUdpListener(config.socket(), *this)),
+      listener_tag_(config.listenerTag()) {
+  if (!config.filterChainFactory().createUdpListenerFilterChain(*this, *this)) {
+    ENVOY_LOG_TO_LOGGER(parent.logger_, debug, "no udp listener filters for {}",
+                        config.socket().localAddress()->asString());
+  }
+}
+
+void ConnectionHandlerImpl::ActiveUdpListener::onData(Network::UdpRecvData&& data) {
+  for (auto& filter : read_filters_) {
+    filter->onData(data);
+  }
 }
 
 ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& parent,
@@ -68,9 +183,37 @@ ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& par
                                                       Network::ListenerConfig& config)
     : parent_(parent), listener_(std::move(listener)),
       stats_(generateStats(config.listenerScope())), listener_tag_(config.listenerTag()),
-      config_(config) {}
+      config_(config) {
+  if (parent_.worker_index_) {
+    per_worker_scope_ = config.listenerScope().createScope(
+        fmt::format("worker_{}.", parent_.worker_index_.value()));
+    per_worker_stats_.emplace(generatePerHandlerStats(*per_worker_scope_));
+  }
+
+  const Network::AcceptLimits& accept_limits = config.acceptLimits();
+  if (accept_limits.max_accepts_per_event_loop_ > 0) {
+    event_loop_timer_ = parent_.dispatcher_.createTimer([this]() -> void {
+      accepts_this_event_loop_ = 0;
+      event_loop_limited_ = false;
+      maybeResumeAccepting();
+    });
+  }
+  if (accept_limits.accepts_per_second_ > 0) {
+    accept_rate_limiter_ = std::make_unique<TokenBucketImpl>(
+        std::max<uint32_t>(accept_limits.accept_burst_, 1), parent_.dispatcher_.timeSystem(),
+        accept_limits.accepts_per_second_);
+    rate_limit_timer_ = parent_.dispatcher_.createTimer([this]() -> void {
+      rate_limited_ = false;
+      maybeResumeAccepting();
+    });
+  }
+
+  config_.connectionBalancer().registerHandler(*this);
+}
 
 ConnectionHandlerImpl::ActiveListener::~ActiveListener() {
+  config_.connectionBalancer().unregisterHandler(*this);
+
   // Purge sockets that have not progressed to connections. This should only happen when
   // a listener filter stops iteration and never resumes.
   while (!sockets_.empty()) {
@@ -120,6 +263,16 @@ ConnectionHandlerImpl::findActiveListenerByAddress(const Network::Address::Insta
   return (listener_it != listeners_.end()) ? listener_it->second.get() : nullptr;
 }
 
+ConnectionHandlerImpl::ActiveListener*
+ConnectionHandlerImpl::findActiveListenerByTag(uint64_t listener_tag) {
+  for (auto& listener : listeners_) {
+    if (listener.second->listener_tag_ == listener_tag) {
+      return listener.second.get();
+    }
+  }
+  return nullptr;
+}
+
 void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
   if (success) {
     if (iter_ == accept_filters_.end()) {
@@ -148,8 +301,10 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
     if (new_listener != nullptr) {
       // Hands off connections redirected by iptables to the listener associated with the
       // original destination address. Pass 'hand_off_restored_destionations' as false to
-      // prevent further redirection.
-      new_listener->onAccept(std::move(socket_), false);
+      // prevent further redirection. The connection is not balanced again; it stays on this
+      // worker.
+      new_listener->incNumConnections();
+      new_listener->onAcceptWorker(std::move(socket_), false, true);
     } else {
       // Set default transport protocol if none of the listener filters did it.
       if (socket_->detectedTransportProtocol().empty()) {
@@ -159,6 +314,10 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
       // Create a new connection on this listener.
       listener_.newConnection(std::move(socket_));
     }
+  } else {
+    // The filter may have failed from onAccept(). Stop iterating so that the socket is closed
+    // rather than kept waiting for the filter to continue.
+    iter_ = accept_filters_.end();
   }
 
   // Filter execution concluded, unlink and delete this ActiveSocket if it was linked.
@@ -170,7 +329,54 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
 
 void ConnectionHandlerImpl::ActiveListener::onAccept(
     Network::ConnectionSocketPtr&& socket, bool hand_off_restored_destination_connections) {
-  Network::Address::InstanceConstSharedPtr local_address = socket->localAddress();
+  checkAcceptLimits();
+  onAcceptWorker(std::move(socket), hand_off_restored_destination_connections, false);
+}
+
+void ConnectionHandlerImpl::ActiveListener::checkAcceptLimits() {
+  const Network::AcceptLimits& accept_limits = config_.acceptLimits();
+  if (event_loop_timer_ != nullptr) {
+    if (accepts_this_event_loop_++ == 0) {
+      // A zero timeout fires on the next event loop iteration, after the current accept loop.
+      event_loop_timer_->enableTimer(std::chrono::milliseconds(0));
+    }
+    if (accepts_this_event_loop_ >= accept_limits.max_accepts_per_event_loop_) {
+      // Leave the remaining connections queued so that other events get handled first.
+      event_loop_limited_ = true;
+      listener_->disable();
+    }
+  }
+
+  // The connection has already been accepted, so it is handled even if it exceeds the rate.
+  if (accept_rate_limiter_ != nullptr && !rate_limited_ && !accept_rate_limiter_->consume()) {
+    stats_.accept_rate_limited_.inc();
+    rate_limited_ = true;
+    listener_->disable();
+    // Wait until the bucket has refilled by at least one connection.
+    const uint64_t rate = accept_limits.accepts_per_second_;
+    rate_limit_timer_->enableTimer(std::chrono::milliseconds((1000 + rate - 1) / rate));
+  }
+}
+
+void ConnectionHandlerImpl::ActiveListener::maybeResumeAccepting() {
+  if (listener_ != nullptr && !parent_.disable_listeners_ && !event_loop_limited_ &&
+      !rate_limited_) {
+    listener_->enable();
+  }
+}
+
+void ConnectionHandlerImpl::ActiveListener::onAcceptWorker(
+    Network::ConnectionSocketPtr&& socket, bool hand_off_restored_destination_connections,
+    bool rebalanced) {
+  if (!rebalanced) {
+    Network::BalancedConnectionHandler& target_handler =
+        config_.connectionBalancer().pickTargetHandler(*this);
+    if (&target_handler != this) {
+      target_handler.post(std::move(socket));
+      return;
+    }
+  }
+
   auto active_socket = std::make_unique<ActiveSocket>(*this, std::move(socket),
                                                       hand_off_restored_destination_connections);
 
@@ -200,6 +406,7 @@ void ConnectionHandlerImpl::ActiveListener::newConnection(Network::ConnectionSoc
   Network::ConnectionPtr new_connection =
       parent_.dispatcher_.createServerConnection(std::move(socket), std::move(transport_socket));
   new_connection->setBufferLimits(config_.perConnectionBufferLimitBytes());
+  new_connection->setBufferLimitAutoTuning(config_.perConnectionBufferLimitMaxBytes());
 
   const bool empty_filter_chain = !config_.filterChainFactory().createNetworkFilterChain(
       *new_connection, filter_chain->networkFilterFactories());
@@ -210,21 +417,51 @@ void ConnectionHandlerImpl::ActiveListener::newConnection(Network::ConnectionSoc
     return;
   }
 
-  onNewConnection(std::move(new_connection));
+  addConnection(std::move(new_connection), filter_chain);
 }
 
 void ConnectionHandlerImpl::ActiveListener::onNewConnection(
     Network::ConnectionPtr&& new_connection) {
+  addConnection(std::move(new_connection), nullptr);
+}
+
+void ConnectionHandlerImpl::ActiveListener::addConnection(
+    Network::ConnectionPtr&& new_connection, const Network::FilterChain* filter_chain) {
   ENVOY_CONN_LOG_TO_LOGGER(parent_.logger_, debug, "new connection", *new_connection);
 
   // If the connection is already closed, we can just let this connection immediately die.
   if (new_connection->state() != Network::Connection::State::Closed) {
     ActiveConnectionPtr active_connection(new ActiveConnection(*this, std::move(new_connection)));
+    active_connection->filter_chain_ = filter_chain;
     active_connection->moveIntoList(std::move(active_connection), connections_);
     parent_.num_connections_++;
   }
 }
 
+void ConnectionHandlerImpl::ActiveListener::incNumConnections() { num_listener_connections_++; }
+
+void ConnectionHandlerImpl::ActiveListener::decNumConnections() {
+  ASSERT(num_listener_connections_ > 0);
+  num_listener_connections_--;
+}
+
+void ConnectionHandlerImpl::ActiveListener::post(Network::ConnectionSocketPtr&& socket) {
+  // Posted callbacks must be copyable, so the socket is moved into a shared_ptr. The listener may
+  // be removed before the callback runs, so it is looked up again by tag; if it is gone, the
+  // socket is closed when the callback is destroyed.
+  std::shared_ptr<Network::ConnectionSocketPtr> socket_to_rebalance =
+      std::make_shared<Network::ConnectionSocketPtr>(std::move(socket));
+  ConnectionHandlerImpl& parent = parent_;
+  const uint64_t listener_tag = listener_tag_;
+  parent_.dispatcher_.post([socket_to_rebalance, &parent, listener_tag]() -> void {
+    ActiveListener* listener = parent.findActiveListenerByTag(listener_tag);
+    if (listener != nullptr) {
+      listener->onAcceptWorker(std::move(*socket_to_rebalance),
+                               listener->config_.handOffRestoredDestinationConnections(), true);
+    }
+  });
+}
+
 ConnectionHandlerImpl::ActiveConnection::ActiveConnection(ActiveListener& listener,
                                                           Network::ConnectionPtr&& new_connection)
     : listener_(listener), connection_(std::move(new_connection)),
@@ -232,12 +469,24 @@ ConnectionHandlerImpl::ActiveConnection::ActiveConnection(ActiveListener& listen
   // We just universally set no delay on connections. Theoretically we might at some point want
   // to make this configurable.
   connection_->noDelay(true);
+  if (listener_.config_.tcpQuickAck()) {
+    connection_->quickAck(true);
+  }
   connection_->addConnectionCallbacks(*this);
   listener_.stats_.downstream_cx_total_.inc();
   listener_.stats_.downstream_cx_active_.inc();
+  if (listener_.per_worker_stats_) {
+    listener_.per_worker_stats_->downstream_cx_total_.inc();
+    listener_.per_worker_stats_->downstream_cx_active_.inc();
+  }
+  listener_.incNumConnections();
 }
 
 ConnectionHandlerImpl::ActiveConnection::~ActiveConnection() {
+  listener_.decNumConnections();
+  if (listener_.per_worker_stats_) {
+    listener_.per_worker_stats_->downstream_cx_active_.dec();
+  }
   listener_.stats_.downstream_cx_active_.dec();
   listener_.stats_.downstream_cx_destroy_.inc();
   conn_length_->complete();
@@ -247,5 +496,9 @@ ListenerStats ConnectionHandlerImpl::generateStats(Stats::Scope& scope) {
   return {ALL_LISTENER_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
 }
 
+PerHandlerListenerStats ConnectionHandlerImpl::generatePerHandlerStats(Stats::Scope& scope) {
+  return {ALL_PER_HANDLER_LISTENER_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope))};
+}
+
 } // namespace Server
 } // namespace Envoy
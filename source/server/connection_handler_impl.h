@@ -2,11 +2,14 @@
 
 #include <atomic>
 #include <cstdint>
+#include <functional>
 #include <list>
 #include <memory>
+#include <unordered_set>
 
 #include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
+#include "envoy/event/timer.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/network/filter.h"
@@ -18,7 +21,9 @@
 
 #include "common/common/linked_object.h"
 #include "common/common/non_copyable.h"
+#include "common/common/token_bucket_impl.h"
 
+#include "absl/types/optional.h"
 #include "spdlog/spdlog.h"
 
 namespace Envoy {
@@ -30,7 +35,14 @@ namespace Server {
   COUNTER  (downstream_cx_destroy)                                                                 \
   GAUGE    (downstream_cx_active)                                                                  \
   HISTOGRAM(downstream_cx_length_ms)                                                               \
-  COUNTER  (no_filter_chain_match)
+  COUNTER  (no_filter_chain_match)                                                                 \
+  COUNTER  (accept_rate_limited)
+// clang-format on
+
+// clang-format off
+#define ALL_PER_HANDLER_LISTENER_STATS(COUNTER, GAUGE)                                             \
+  COUNTER  (downstream_cx_total)                                                                   \
+  GAUGE    (downstream_cx_active)
 // clang-format on
 
 /**
@@ -40,26 +52,45 @@ struct ListenerStats {
   ALL_LISTENER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
+/**
+ * Wrapper struct for per-worker listener stats. @see stats_macros.h
+ */
+struct PerHandlerListenerStats {
+  ALL_PER_HANDLER_LISTENER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
 /**
  * Server side connection handler. This is used both by workers as well as the
  * main thread for non-threaded listeners.
  */
 class ConnectionHandlerImpl : public Network::ConnectionHandler, NonCopyable {
 public:
-  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher);
+  /**
+   * @param worker_index supplies the index of the worker owning the handler, if any. Workers'
+   *        handlers additionally record per-worker listener stats.
+   */
+  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                        absl::optional<uint32_t> worker_index = absl::nullopt);
 
   // Network::ConnectionHandler
   uint64_t numConnections() override { return num_connections_; }
   void addListener(Network::ListenerConfig& config) override;
   void removeListeners(uint64_t listener_tag) override;
+  void removeFilterChains(uint64_t listener_tag,
+                          const std::unordered_set<const Network::FilterChain*>& filter_chains,
+                          std::function<void()> completion) override;
   void stopListeners(uint64_t listener_tag) override;
   void stopListeners() override;
+  void disableListeners() override;
+  void enableListeners() override;
 
   Network::Listener* findListenerByAddress(const Network::Address::Instance& address) override;
 
 private:
   struct ActiveListener;
   ActiveListener* findActiveListenerByAddress(const Network::Address::Instance& address);
+  ActiveListener* findActiveListenerByTag(uint64_t listener_tag);
+  void removeUdpListeners(uint64_t listener_tag);
 
   struct ActiveConnection;
   typedef std::unique_ptr<ActiveConnection> ActiveConnectionPtr;
@@ -69,7 +100,8 @@ private:
   /**
    * Wrapper for an active listener owned by this handler.
    */
-  struct ActiveListener : public Network::ListenerCallbacks {
+  struct ActiveListener : public Network::ListenerCallbacks,
+                          public Network::BalancedConnectionHandler {
     ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerConfig& config);
 
     ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerPtr&& listener,
@@ -82,6 +114,35 @@ private:
                   bool hand_off_restored_destination_connections) override;
     void onNewConnection(Network::ConnectionPtr&& new_connection) override;
 
+    // Network::BalancedConnectionHandler
+    uint64_t numConnections() const override { return num_listener_connections_; }
+    void incNumConnections() override;
+    void post(Network::ConnectionSocketPtr&& socket) override;
+
+    /**
+     * Run the listener filters on an accepted socket and create its connection.
+     * @param rebalanced supplies whether the connection balancer already assigned the socket to
+     *        this listener.
+     */
+    void onAcceptWorker(Network::ConnectionSocketPtr&& socket,
+                        bool hand_off_restored_destination_connections, bool rebalanced);
+
+    /**
+     * Uncount a connection or socket of the listener. @see incNumConnections().
+     */
+    void decNumConnections();
+
+    /**
+     * Count a connection accepted by the listener against its accept limits, and pause accepting
+     * if a limit is reached.
+     */
+    void checkAcceptLimits();
+
+    /**
+     * Resume accepting unless an accept limit or disableListeners() still pauses the listener.
+     */
+    void maybeResumeAccepting();
+
     /**
      * Remove and destroy an active connection.
      * @param connection supplies the connection to remove.
@@ -93,17 +154,79 @@ private:
      */
     void newConnection(Network::ConnectionSocketPtr&& socket);
 
+    /**
+     * Track a new connection.
+     * @param filter_chain supplies the filter chain the connection was created from, if any.
+     */
+    void addConnection(Network::ConnectionPtr&& new_connection,
+                       const Network::FilterChain* filter_chain);
+
+    /**
+     * @see ConnectionHandler::removeFilterChains().
+     */
+    void removeFilterChains(const std::unordered_set<const Network::FilterChain*>& filter_chains,
+                            std::function<void()> completion);
+
+    /**
+     * Remove the listener if removeFilterChains() was called and no connections are left.
+     */
+    void maybeRemove();
+
     ConnectionHandlerImpl& parent_;
     Network::ListenerPtr listener_;
     ListenerStats stats_;
+    Stats::ScopePtr per_worker_scope_;
+    absl::optional<PerHandlerListenerStats> per_worker_stats_;
     std::list<ActiveSocketPtr> sockets_;
     std::list<ActiveConnectionPtr> connections_;
     const uint64_t listener_tag_;
     Network::ListenerConfig& config_;
+    // Sockets and connections of this listener, plus sockets the connection balancer has assigned
+    // to it from other workers but that it has not picked up yet. Read by other workers' balancing.
+    std::atomic<uint64_t> num_listener_connections_{};
+    // Fires on the event loop iteration after the first accept of an iteration, to reset the
+    // per-iteration accept count. Only set with a max_accepts_per_event_loop_ limit.
+    Event::TimerPtr event_loop_timer_;
+    uint32_t accepts_this_event_loop_{};
+    bool event_loop_limited_{};
+    // Only set with an accepts_per_second_ limit.
+    std::unique_ptr<TokenBucketImpl> accept_rate_limiter_;
+    Event::TimerPtr rate_limit_timer_;
+    bool rate_limited_{};
+    // Set by removeFilterChains() until the listener is removed.
+    std::function<void()> removal_completion_;
   };
 
   typedef std::unique_ptr<ActiveListener> ActiveListenerPtr;
 
+  /**
+   * Wrapper for an active UDP listener owned by this handler. There are no connections, its read
+   * filters receive the datagrams of all peers.
+   */
+  struct ActiveUdpListener : public Network::UdpListenerCallbacks,
+                             public Network::UdpListenerFilterManager,
+                             public Network::UdpReadFilterCallbacks {
+    ActiveUdpListener(ConnectionHandlerImpl& parent, Network::ListenerConfig& config);
+
+    // Network::UdpListenerCallbacks
+    void onData(Network::UdpRecvData&& data) override;
+
+    // Network::UdpListenerFilterManager
+    void addReadFilter(Network::UdpListenerReadFilterPtr&& filter) override {
+      read_filters_.emplace_back(std::move(filter));
+    }
+
+    // Network::UdpReadFilterCallbacks
+    Network::UdpListener& udpListener() override { return *udp_listener_; }
+
+    Network::UdpListenerPtr udp_listener_;
+    // Destroyed before the listener the filters send through.
+    std::list<Network::UdpListenerReadFilterPtr> read_filters_;
+    const uint64_t listener_tag_;
+  };
+
+  typedef std::unique_ptr<ActiveUdpListener> ActiveUdpListenerPtr;
+
   /**
    * Wrapper for an active connection owned by this handler.
    */
@@ -127,6 +250,7 @@ private:
     ActiveListener& listener_;
     Network::ConnectionPtr connection_;
     Stats::TimespanPtr conn_length_;
+    const Network::FilterChain* filter_chain_{};
   };
 
   /**
@@ -141,7 +265,10 @@ private:
         : listener_(listener), socket_(std::move(socket)),
           hand_off_restored_destination_connections_(hand_off_restored_destination_connections),
           iter_(accept_filters_.end()) {}
-    ~ActiveSocket() { accept_filters_.clear(); }
+    ~ActiveSocket() {
+      accept_filters_.clear();
+      listener_.decNumConnections();
+    }
 
     // Network::ListenerFilterManager
     void addAcceptFilter(Network::ListenerFilterPtr&& filter) override {
@@ -161,11 +288,15 @@ private:
   };
 
   static ListenerStats generateStats(Stats::Scope& scope);
+  static PerHandlerListenerStats generatePerHandlerStats(Stats::Scope& scope);
 
   spdlog::logger& logger_;
   Event::Dispatcher& dispatcher_;
+  const absl::optional<uint32_t> worker_index_;
   std::list<std::pair<Network::Address::InstanceConstSharedPtr, ActiveListenerPtr>> listeners_;
+  std::list<ActiveUdpListenerPtr> udp_listeners_;
   std::atomic<uint64_t> num_connections_{};
+  bool disable_listeners_{};
 };
 
 } // namespace Server
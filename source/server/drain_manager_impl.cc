@@ -4,16 +4,36 @@
 #include <cstdint>
 #include <functional>
 
+#include "envoy/common/time.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/timer.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/server/instance.h"
+#include "envoy/server/overload_manager.h"
 
 #include "common/common/assert.h"
 
 namespace Envoy {
 namespace Server {
 
+namespace {
+
+// How far a drain sequence advances per tick, in milliseconds of the drain time.
+constexpr uint64_t DrainTickMs = 1000;
+
+/**
+ * The drain closes of a thread in the current second. Workers serve the connections of all
+ * listeners, so the drain managers of all listeners share the budget of each worker.
+ */
+struct DrainClosePacer {
+  MonotonicTime window_start_;
+  uint32_t closes_{};
+};
+
+thread_local DrainClosePacer drain_close_pacer;
+
+} // namespace
+
 DrainManagerImpl::DrainManagerImpl(Instance& server, envoy::api::v2::Listener::DrainType drain_type)
     : server_(server), drain_type_(drain_type) {}
 
@@ -25,25 +45,67 @@ bool DrainManagerImpl::drainClose() const {
   // would allow the other side to fail health check for the host which will require some thread
   // jumps versus immediately start GOAWAY/connection thrashing.
   if (drain_type_ == envoy::api::v2::Listener_DrainType_DEFAULT && server_.healthCheckFailed()) {
-    return true;
+    return paceDrainClose();
   }
 
   if (!draining()) {
     return false;
   }
 
+  return drainCurveClose() && paceDrainClose();
+}
+
+bool DrainManagerImpl::drainCurveClose() const {
   // We use the tick time as in increasing chance that we shutdown connections.
-  return static_cast<uint64_t>(drain_time_completed_.load()) >
-         (server_.random().random() % server_.options().drainTime().count());
+  const uint64_t completed_ms = drain_time_completed_ms_.load();
+  const uint64_t drain_time_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(server_.options().drainTime()).count();
+  switch (server_.options().drainCurve()) {
+  case DrainCurve::Linear:
+    return completed_ms > server_.random().random() % drain_time_ms;
+  case DrainCurve::Quadratic: {
+    const double completed = static_cast<double>(completed_ms) / drain_time_ms;
+    return completed * completed * drain_time_ms > server_.random().random() % drain_time_ms;
+  }
+  case DrainCurve::Immediate:
+    return true;
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+bool DrainManagerImpl::paceDrainClose() const {
+  const uint32_t drain_close_rate = server_.options().drainCloseRate();
+  if (drain_close_rate == 0) {
+    return true;
+  }
+
+  // Connections which are not closed now are closed by a later request or response.
+  DrainClosePacer& pacer = drain_close_pacer;
+  const MonotonicTime now = server_.timeSystem().monotonicTime();
+  if (now - pacer.window_start_ >= std::chrono::seconds(1)) {
+    pacer.window_start_ = now;
+    pacer.closes_ = 0;
+  }
+  if (pacer.closes_ >= drain_close_rate) {
+    return false;
+  }
+  pacer.closes_++;
+  return true;
 }
 
 void DrainManagerImpl::drainSequenceTick() {
-  ENVOY_LOG(trace, "drain tick #{}", drain_time_completed_.load());
-  ASSERT(drain_time_completed_.load() < server_.options().drainTime().count());
-  ++drain_time_completed_;
+  const uint64_t drain_time_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(server_.options().drainTime()).count();
+  ENVOY_LOG(trace, "drain tick at {}ms", drain_time_completed_ms_.load());
+  ASSERT(drain_time_completed_ms_.load() < drain_time_ms);
+
+  // Clients reconnect more slowly while the server is overloaded.
+  const bool slow = server_.overloadManager().getThreadLocalOverloadState().getState(
+                        OverloadActionNames::get().SlowDrain) == OverloadActionState::Active;
+  drain_time_completed_ms_ += slow ? DrainTickMs / 2 : DrainTickMs;
 
-  if (drain_time_completed_.load() < server_.options().drainTime().count()) {
-    drain_tick_timer_->enableTimer(std::chrono::milliseconds(1000));
+  if (drain_time_completed_ms_.load() < drain_time_ms) {
+    drain_tick_timer_->enableTimer(std::chrono::milliseconds(DrainTickMs));
   } else if (drain_sequence_completion_) {
     drain_sequence_completion_();
   }
@@ -15,7 +15,9 @@ namespace Server {
  * Implementation of drain manager that does the following by default:
  * 1) Terminates the parent process after 15 minutes.
  * 2) Drains the parent process over a period of 10 minutes where drain close becomes more
- *    likely each second that passes.
+ *    likely each second that passes, following the drain curve of the options.
+ * The drain closes of each worker are paced at the drain close rate of the options, and the drain
+ * sequence advances at half speed while the slow drain overload action is active.
  */
 class DrainManagerImpl : Logger::Loggable<Logger::Id::main>, public DrainManager {
 public:
@@ -28,12 +30,14 @@ public:
 
 private:
   bool draining() const { return drain_tick_timer_ != nullptr; }
+  bool drainCurveClose() const;
+  bool paceDrainClose() const;
   void drainSequenceTick();
 
   Instance& server_;
   const envoy::api::v2::Listener::DrainType drain_type_;
   Event::TimerPtr drain_tick_timer_;
-  std::atomic<uint32_t> drain_time_completed_{};
+  std::atomic<uint64_t> drain_time_completed_ms_{};
   Event::TimerPtr parent_shutdown_timer_;
   std::function<void()> drain_sequence_completion_;
 };
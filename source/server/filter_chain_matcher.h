@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Server {
+
+/**
+ * Map from transport or application protocol names to values. Listeners only match on a handful of
+ * distinct protocols, so entries are kept contiguous and scanned linearly, which is faster than
+ * hashing for such sizes and lets lookups take an absl::string_view without allocating.
+ */
+template <class T> class ProtocolMap {
+public:
+  /**
+   * @return T& the value for name, which is default constructed if it did not exist yet. The
+   *         reference is only valid until the next insertion.
+   */
+  T& operator[](const std::string& name) {
+    for (auto& entry : entries_) {
+      if (entry.first == name) {
+        return entry.second;
+      }
+    }
+    entries_.emplace_back(name, T());
+    return entries_.back().second;
+  }
+
+  /**
+   * @return const T* the value for name, or nullptr if there is none.
+   */
+  const T* find(absl::string_view name) const {
+    for (const auto& entry : entries_) {
+      if (entry.first == name) {
+        return &entry.second;
+      }
+    }
+    return nullptr;
+  }
+
+private:
+  std::vector<std::pair<std::string, T>> entries_;
+};
+
+/**
+ * Matches server names against exact names ("www.example.com"), wildcard domains (".example.com"
+ * for "*.example.com") and a catch-all (""), using the same keys as the maps filter chains are
+ * added to. Names are stored in a trie of their labels in reverse order, so a lookup walks the
+ * requested name's labels from right to left once, without hashing or allocating, no matter how
+ * many names are configured.
+ *
+ * An exact match wins over a wildcard match, and a longer wildcard domain wins over a shorter one.
+ * Wildcard domains only match names with at least one more label, i.e. ".example.com" matches
+ * "www.example.com" but not "example.com".
+ */
+template <class T> class ServerNameTrie {
+public:
+  void add(absl::string_view name, const T& value) {
+    if (name.empty()) {
+      catch_all_ = std::make_unique<T>(value);
+      return;
+    }
+
+    const bool wildcard = name[0] == '.';
+    if (wildcard) {
+      name.remove_prefix(1);
+    }
+
+    Node* node = &root_;
+    while (true) {
+      const size_t dot = name.rfind('.');
+      node = &node->child(dot == absl::string_view::npos ? name : name.substr(dot + 1));
+      if (dot == absl::string_view::npos) {
+        break;
+      }
+      name = name.substr(0, dot);
+    }
+    (wildcard ? node->wildcard_ : node->exact_) = std::make_unique<T>(value);
+  }
+
+  /**
+   * @return const T* the value of the most specific match for server_name, or nullptr if there is
+   *         none.
+   */
+  const T* find(absl::string_view server_name) const {
+    if (server_name.empty()) {
+      return catch_all_.get();
+    }
+
+    const T* wildcard = nullptr;
+    const Node* node = &root_;
+    while (true) {
+      const size_t dot = server_name.rfind('.');
+      node = node->findChild(dot == absl::string_view::npos ? server_name
+                                                            : server_name.substr(dot + 1));
+      if (node == nullptr) {
+        break;
+      }
+      if (dot == absl::string_view::npos) {
+        if (node->exact_ != nullptr) {
+          return node->exact_.get();
+        }
+        break;
+      }
+      server_name = server_name.substr(0, dot);
+      // The labels left of the matched suffix must not be empty.
+      if (dot > 0 && node->wildcard_ != nullptr) {
+        wildcard = node->wildcard_.get();
+      }
+    }
+
+    return wildcard != nullptr ? wildcard : catch_all_.get();
+  }
+
+private:
+  struct Node {
+    typedef std::pair<std::string, std::unique_ptr<Node>> Child;
+
+    static bool labelLess(const Child& child, absl::string_view label) {
+      return absl::string_view(child.first) < label;
+    }
+
+    Node& child(absl::string_view label) {
+      auto it = std::lower_bound(children_.begin(), children_.end(), label, labelLess);
+      if (it == children_.end() || it->first != label) {
+        it = children_.emplace(it, std::string(label), std::make_unique<Node>());
+      }
+      return *it->second;
+    }
+
+    const Node* findChild(absl::string_view label) const {
+      const auto it = std::lower_bound(children_.begin(), children_.end(), label, labelLess);
+      return it != children_.end() && it->first == label ? it->second.get() : nullptr;
+    }
+
+    // Sorted by label for binary search.
+    std::vector<Child> children_;
+    std::unique_ptr<T> exact_;
+    std::unique_ptr<T> wildcard_;
+  };
+
+  Node root_;
+  std::unique_ptr<T> catch_all_;
+};
+
+} // namespace Server
+} // namespace Envoy
@@ -5,7 +5,9 @@
 #include <sys/types.h>
 #include <sys/un.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 #include "envoy/event/dispatcher.h"
@@ -28,7 +30,7 @@ namespace Server {
 
 // Increment this whenever there is a shared memory / RPC change that will prevent a hot restart
 // from working. Operations code can then cope with this and do a full restart.
-const uint64_t SharedMemory::VERSION = 10;
+const uint64_t SharedMemory::VERSION = 12;
 
 static BlockMemoryHashSetOptions blockMemHashOptions(uint64_t max_stats) {
   BlockMemoryHashSetOptions hash_set_options;
@@ -147,13 +149,16 @@ HotRestartImpl::HotRestartImpl(Options& options)
 }
 
 Stats::RawStatData* HotRestartImpl::alloc(absl::string_view name) {
+  // Hash before locking, so that the lock, which is shared with the other processes, is only held
+  // to walk the slot's chain.
+  const uint64_t hash = Stats::RawStatData::hash(name);
   // Try to find the existing slot in shared memory, otherwise allocate a new one.
   Thread::LockGuard lock(stat_lock_);
   // In production, the name is truncated in ThreadLocalStore before this
   // is called. This is just a sanity check to make sure that actually happens;
   // it is coded as an if/return-null to facilitate testing.
   ASSERT(name.length() <= options_.statsOptions().maxNameLength());
-  auto value_created = stats_set_->insert(name);
+  auto value_created = stats_set_->insert(name, hash);
   Stats::RawStatData* data = value_created.first;
   if (data == nullptr) {
     return nullptr;
@@ -168,13 +173,15 @@ Stats::RawStatData* HotRestartImpl::alloc(absl::string_view name) {
 }
 
 void HotRestartImpl::free(Stats::RawStatData& data) {
+  // The name does not change while we hold our reference.
+  const uint64_t hash = Stats::RawStatData::hash(data.key());
   // We must hold the lock since the reference decrement can race with an initialize above.
   Thread::LockGuard lock(stat_lock_);
   ASSERT(data.ref_count_ > 0);
   if (--data.ref_count_ > 0) {
     return;
   }
-  bool key_removed = stats_set_->remove(data.key());
+  bool key_removed = stats_set_->remove(data.key(), hash);
   ASSERT(key_removed);
   memset(static_cast<void*>(&data), 0,
          Stats::RawStatData::structSizeWithOptions(options_.statsOptions()));
@@ -228,7 +235,8 @@ void HotRestartImpl::drainParentListeners() {
   shmem_.flags_ &= ~SharedMemory::Flags::INITIALIZING;
 }
 
-int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
+int HotRestartImpl::duplicateParentListenSocket(const std::string& address,
+                                                uint32_t worker_index) {
   if (options_.restartEpoch() == 0 || parent_terminated_) {
     return -1;
   }
@@ -236,6 +244,7 @@ int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
   RpcGetListenSocketRequest rpc;
   ASSERT(address.length() < sizeof(rpc.address_));
   StringUtil::strlcpy(rpc.address_, address.c_str(), sizeof(rpc.address_));
+  rpc.worker_index_ = worker_index;
   sendMessage(parent_address_, rpc);
   RpcGetListenSocketReply* reply =
       receiveTypedRpc<RpcGetListenSocketReply, RpcMessageType::GetListenSocketReply>();
@@ -274,6 +283,33 @@ void HotRestartImpl::getParentStats(GetParentStatsInfo& info) {
   info.num_connections_ = reply->num_connections_;
 }
 
+std::string HotRestartImpl::getParentTlsSessions() {
+  // See large comment in getParentStats() on why this operation is locked.
+  Thread::LockGuard lock(init_lock_);
+  std::string sessions;
+  if (options_.restartEpoch() == 0 || parent_terminated_) {
+    return sessions;
+  }
+
+  RpcGetTlsSessionsRequest rpc;
+  while (true) {
+    rpc.offset_ = sessions.size();
+    sendMessage(parent_address_, rpc);
+    RpcBase* base_message = receiveRpc(true);
+    if (base_message->type_ == RpcMessageType::UnknownRequestReply) {
+      // A parent built before the transfer was supported.
+      return "";
+    }
+    RELEASE_ASSERT(base_message->type_ == RpcMessageType::GetTlsSessionsReply, "");
+    RELEASE_ASSERT(base_message->length_ == sizeof(RpcGetTlsSessionsReply), "");
+    RpcGetTlsSessionsReply* reply = reinterpret_cast<RpcGetTlsSessionsReply*>(base_message);
+    sessions.append(reinterpret_cast<const char*>(reply->data_), reply->data_length_);
+    if (reply->data_length_ == 0 || sessions.size() >= reply->total_length_) {
+      return sessions;
+    }
+  }
+}
+
 void HotRestartImpl::initialize(Event::Dispatcher& dispatcher, Server::Instance& server) {
   socket_event_ =
       dispatcher.createFileEvent(my_domain_socket_,
@@ -362,10 +398,15 @@ void HotRestartImpl::onGetListenSocket(RpcGetListenSocketRequest& rpc) {
   RpcGetListenSocketReply reply;
   reply.fd_ = -1;
 
-  Network::Address::InstanceConstSharedPtr addr =
-      Network::Utility::resolveUrl(std::string(rpc.address_));
-  for (const auto& listener : server_->listenerManager().listeners()) {
-    if (*listener.get().socket().localAddress() == *addr) {
+  const std::string url(rpc.address_);
+  Network::Address::InstanceConstSharedPtr addr = Network::Utility::resolveUrl(url);
+  // A TCP and a UDP listener can share an address.
+  const Network::Address::SocketType socket_type = Network::Utility::urlIsUdpScheme(url)
+                                                       ? Network::Address::SocketType::Datagram
+                                                       : Network::Address::SocketType::Stream;
+  for (const auto& listener : server_->listenerManager().workerListeners(rpc.worker_index_)) {
+    if (listener.get().socketType() == socket_type &&
+        *listener.get().socket().localAddress() == *addr) {
       reply.fd_ = listener.get().socket().fd();
       break;
     }
@@ -402,6 +443,25 @@ void HotRestartImpl::onGetListenSocket(RpcGetListenSocketRequest& rpc) {
   }
 }
 
+void HotRestartImpl::onGetTlsSessions(RpcGetTlsSessionsRequest& rpc) {
+  if (rpc.offset_ == 0) {
+    tls_sessions_ = server_->sslContextManager().exportServerSessions();
+  }
+
+  RpcGetTlsSessionsReply reply;
+  reply.total_length_ = tls_sessions_.size();
+  if (rpc.offset_ < tls_sessions_.size()) {
+    reply.data_length_ =
+        std::min<uint64_t>(sizeof(reply.data_), tls_sessions_.size() - rpc.offset_);
+    memcpy(reply.data_, tls_sessions_.data() + rpc.offset_, reply.data_length_);
+  }
+  if (rpc.offset_ + reply.data_length_ >= tls_sessions_.size()) {
+    // The child has all of the sessions.
+    std::string().swap(tls_sessions_);
+  }
+  sendMessage(child_address_, reply);
+}
+
 void HotRestartImpl::onSocketEvent() {
   while (true) {
     RpcBase* base_message = receiveRpc(false);
@@ -435,6 +495,12 @@ void HotRestartImpl::onSocketEvent() {
       break;
     }
 
+    case RpcMessageType::GetTlsSessionsRequest: {
+      RpcGetTlsSessionsRequest* message = reinterpret_cast<RpcGetTlsSessionsRequest*>(base_message);
+      onGetTlsSessions(*message);
+      break;
+    }
+
     case RpcMessageType::DrainListenersRequest: {
       server_->drainListeners();
       break;
@@ -122,8 +122,9 @@ public:
 
   // Server::HotRestart
   void drainParentListeners() override;
-  int duplicateParentListenSocket(const std::string& address) override;
+  int duplicateParentListenSocket(const std::string& address, uint32_t worker_index) override;
   void getParentStats(GetParentStatsInfo& info) override;
+  std::string getParentTlsSessions() override;
   void initialize(Event::Dispatcher& dispatcher, Server::Instance& server) override;
   void shutdownParentAdmin(ShutdownParentAdminInfo& info) override;
   void terminateParent() override;
@@ -153,7 +154,9 @@ private:
     TerminateRequest = 6,
     UnknownRequestReply = 7,
     GetStatsRequest = 8,
-    GetStatsReply = 9
+    GetStatsReply = 9,
+    GetTlsSessionsRequest = 10,
+    GetTlsSessionsReply = 11
   };
 
   struct RpcBase {
@@ -168,6 +171,7 @@ private:
     RpcGetListenSocketRequest() : RpcBase(RpcMessageType::GetListenSocketRequest, sizeof(*this)) {}
 
     char address_[256]{0};
+    uint32_t worker_index_{0};
   } __attribute__((packed));
 
   struct RpcGetListenSocketReply : public RpcBase {
@@ -190,6 +194,22 @@ private:
     uint64_t unused_[16]{0};
   } __attribute__((packed));
 
+  // The sessions do not fit in a single datagram, so the child fetches them in chunks. The parent
+  // serializes the sessions on the first request, at offset 0, and serves the chunks from there.
+  struct RpcGetTlsSessionsRequest : public RpcBase {
+    RpcGetTlsSessionsRequest() : RpcBase(RpcMessageType::GetTlsSessionsRequest, sizeof(*this)) {}
+
+    uint64_t offset_{0};
+  } __attribute__((packed));
+
+  struct RpcGetTlsSessionsReply : public RpcBase {
+    RpcGetTlsSessionsReply() : RpcBase(RpcMessageType::GetTlsSessionsReply, sizeof(*this)) {}
+
+    uint64_t total_length_{0};
+    uint32_t data_length_{0};
+    uint8_t data_[4000]{0};
+  } __attribute__((packed));
+
   template <class rpc_class, RpcMessageType rpc_type> rpc_class* receiveTypedRpc() {
     RpcBase* base_message = receiveRpc(true);
     RELEASE_ASSERT(base_message->length_ == sizeof(rpc_class), "");
@@ -201,6 +221,7 @@ private:
   void initDomainSocketAddress(sockaddr_un* address);
   sockaddr_un createDomainSocketAddress(uint64_t id);
   void onGetListenSocket(RpcGetListenSocketRequest& rpc);
+  void onGetTlsSessions(RpcGetTlsSessionsRequest& rpc);
   void onSocketEvent();
   RpcBase* receiveRpc(bool block);
   void sendMessage(sockaddr_un& address, RpcBase& rpc);
@@ -222,6 +243,8 @@ private:
   std::array<uint8_t, 4096> rpc_buffer_;
   Server::Instance* server_{};
   bool parent_terminated_{};
+  // The sessions being fetched by the child.
+  std::string tls_sessions_;
 };
 
 } // namespace Server
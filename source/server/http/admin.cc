@@ -13,6 +13,7 @@
 #include "envoy/admin/v2alpha/clusters.pb.h"
 #include "envoy/admin/v2alpha/config_dump.pb.h"
 #include "envoy/admin/v2alpha/memory.pb.h"
+#include "envoy/common/exception.h"
 #include "envoy/filesystem/filesystem.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/server/hot_restart.h"
@@ -26,9 +27,12 @@
 #include "common/access_log/access_log_formatter.h"
 #include "common/access_log/access_log_impl.h"
 #include "common/buffer/buffer_impl.h"
+#include "common/buffer/memory_account.h"
 #include "common/common/assert.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/fmt.h"
+#include "common/common/macros.h"
+#include "common/common/thread.h"
 #include "common/common/utility.h"
 #include "common/common/version.h"
 #include "common/html/utility.h"
@@ -47,8 +51,11 @@
 
 #include "extensions/access_loggers/file/file_access_log_impl.h"
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 
 // TODO(mattklein123): Switch to JSON interface methods and remove rapidjson dependency.
@@ -148,6 +155,173 @@ void populateFallbackResponseHeaders(Http::Code code, Http::HeaderMap& header_ma
   header_map.addReference(headers.XContentTypeOptions, headers.XContentTypeOptionValues.Nosniff);
 }
 
+// Metrics formatted per dispatcher iteration by the streamed /stats formats.
+constexpr uint64_t StatsPerChunk = 1000;
+
+// Bounds of the duration of a /pprof/profile CPU profile.
+constexpr uint64_t DefaultProfileSeconds = 30;
+constexpr uint64_t MaxProfileSeconds = 600;
+
+const std::string& octetStreamContentType() {
+  CONSTRUCT_ON_FIRST_USE(std::string, "application/octet-stream");
+}
+
+absl::optional<std::regex> statsFilter(const Http::Utility::QueryParams& params) {
+  return (params.find("filter") != params.end())
+             ? absl::optional<std::regex>{std::regex(params.at("filter"))}
+             : absl::nullopt;
+}
+
+/**
+ * Formats the first chunk of a response, and continues the response with the remaining chunks on
+ * later dispatcher iterations.
+ */
+void streamResponse(std::function<bool(Buffer::Instance& response)> next_chunk,
+                    Buffer::Instance& response, AdminStream& admin_stream) {
+  if (next_chunk(response)) {
+    admin_stream.setResponseContinuation(std::move(next_chunk));
+  }
+}
+
+/**
+ * The plain text /stats output, sorted by name.
+ */
+class StatsTextFormatter {
+public:
+  StatsTextFormatter(
+      std::vector<std::pair<std::string, uint64_t>>&& stats,
+      std::vector<std::pair<std::string, Stats::ParentHistogramSharedPtr>>&& histograms)
+      : stats_(std::move(stats)), histograms_(std::move(histograms)) {}
+
+  bool formatChunk(Buffer::Instance& response) {
+    const size_t total = stats_.size() + histograms_.size();
+    const size_t end = std::min<size_t>(next_ + StatsPerChunk, total);
+    for (; next_ < end; next_++) {
+      if (next_ < stats_.size()) {
+        response.add(fmt::format("{}: {}\n", stats_[next_].first, stats_[next_].second));
+      } else {
+        const auto& histogram = histograms_[next_ - stats_.size()];
+        response.add(fmt::format("{}: {}\n", histogram.first, histogram.second->summary()));
+      }
+    }
+    return next_ < total;
+  }
+
+private:
+  const std::vector<std::pair<std::string, uint64_t>> stats_;
+  const std::vector<std::pair<std::string, Stats::ParentHistogramSharedPtr>> histograms_;
+  size_t next_{};
+};
+
+// Whether the name of the resource held by an entry of a config dump, e.g. the cluster of a
+// DynamicCluster, matches the regex. Entries without a named resource always match.
+bool resourceNameMatches(const Protobuf::Message& entry, const std::regex& regex) {
+  const Protobuf::Descriptor* descriptor = entry.GetDescriptor();
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const Protobuf::FieldDescriptor* field = descriptor->field(i);
+    if (field->is_repeated() || field->cpp_type() != Protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+      continue;
+    }
+    const Protobuf::Message& resource = entry.GetReflection()->GetMessage(entry, field);
+    const Protobuf::FieldDescriptor* name = resource.GetDescriptor()->FindFieldByName("name");
+    if (name != nullptr && !name->is_repeated() &&
+        name->cpp_type() == Protobuf::FieldDescriptor::CPPTYPE_STRING) {
+      return std::regex_search(resource.GetReflection()->GetString(resource, name), regex);
+    }
+  }
+  return true;
+}
+
+// Removes the entries whose resource name does not match the regex from the repeated fields of a
+// config dump, e.g. the static and dynamic clusters of a ClustersConfigDump.
+void filterConfigDump(Protobuf::Message& dump, const std::regex& regex) {
+  const Protobuf::Descriptor* descriptor = dump.GetDescriptor();
+  const Protobuf::Reflection* reflection = dump.GetReflection();
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const Protobuf::FieldDescriptor* field = descriptor->field(i);
+    if (!field->is_repeated() || field->cpp_type() != Protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+      continue;
+    }
+    const int size = reflection->FieldSize(dump, field);
+    int kept = 0;
+    for (int j = 0; j < size; j++) {
+      if (resourceNameMatches(reflection->GetRepeatedMessage(dump, field, j), regex)) {
+        if (kept != j) {
+          reflection->SwapElements(&dump, field, kept, j);
+        }
+        kept++;
+      }
+    }
+    for (int j = kept; j < size; j++) {
+      reflection->RemoveLast(&dump, field);
+    }
+  }
+}
+
+/**
+ * The /config_dump output, which collects and formats the config of one ConfigTracker key per
+ * dispatcher iteration. The binary output is the concatenation of ConfigDumps holding one config
+ * each, which parses as a single ConfigDump.
+ */
+class ConfigDumpFormatter {
+public:
+  ConfigDumpFormatter(const ConfigTracker& config_tracker, std::vector<std::string>&& keys,
+                      absl::optional<std::regex>&& name_regex, bool binary)
+      : config_tracker_(config_tracker), keys_(std::move(keys)), name_regex_(std::move(name_regex)),
+        binary_(binary) {}
+
+  bool formatChunk(Buffer::Instance& response) {
+    if (next_ == 0 && !binary_) {
+      response.add(keys_.empty() ? "{}\n" : "{\n \"configs\": [\n");
+    }
+    if (next_ < keys_.size()) {
+      // The component tracking the config may have been destroyed since the dump started.
+      const auto& callbacks = config_tracker_.getCallbacksMap();
+      const auto it = callbacks.find(keys_[next_++]);
+      if (it != callbacks.end()) {
+        ProtobufTypes::MessagePtr message = it->second();
+        RELEASE_ASSERT(message, "");
+        formatConfig(*message, response);
+      }
+    }
+    if (next_ < keys_.size()) {
+      return true;
+    }
+    if (!keys_.empty() && !binary_) {
+      response.add("\n ]\n}\n");
+    }
+    return false;
+  }
+
+private:
+  void formatConfig(Protobuf::Message& message, Buffer::Instance& response) {
+    if (name_regex_.has_value()) {
+      filterConfigDump(message, name_regex_.value());
+    }
+    envoy::admin::v2alpha::ConfigDump dump;
+    dump.add_configs()->PackFrom(message);
+    if (binary_) {
+      response.add(dump.SerializeAsString());
+      return;
+    }
+
+    // Indent the pretty-printed config as an element of the configs array.
+    std::string json = MessageUtil::getJsonStringFromMessage(dump.configs(0), true);
+    while (!json.empty() && json.back() == '\n') {
+      json.pop_back();
+    }
+    response.add(absl::StrCat(formatted_configs_++ > 0 ? ",\n  " : "  ",
+                              absl::StrReplaceAll(json, {{"\n", "\n  "}})));
+  }
+
+  const ConfigTracker& config_tracker_;
+  const std::vector<std::string> keys_;
+  const absl::optional<std::regex> name_regex_;
+  const bool binary_;
+  size_t next_{};
+  uint64_t formatted_configs_{};
+};
+
 } // namespace
 
 AdminFilter::AdminFilter(AdminImpl& parent) : parent_(parent) {}
@@ -175,11 +349,55 @@ Http::FilterTrailersStatus AdminFilter::decodeTrailers(Http::HeaderMap&) {
 }
 
 void AdminFilter::onDestroy() {
+  if (continue_timer_ != nullptr) {
+    callbacks_->removeDownstreamWatermarkCallbacks(*this);
+    continue_timer_.reset();
+  }
+  continuation_ = nullptr;
   for (const auto& callback : on_destroy_callbacks_) {
     callback();
   }
 }
 
+void AdminFilter::onAboveWriteBufferHighWatermark() { above_write_buffer_high_watermark_ = true; }
+
+void AdminFilter::onBelowWriteBufferLowWatermark() {
+  above_write_buffer_high_watermark_ = false;
+  if (continuation_) {
+    continue_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
+void AdminFilter::setResponseContinuation(
+    std::function<bool(Buffer::Instance& response)> continuation) {
+  continuation_ = std::move(continuation);
+}
+
+bool AdminFilter::continueResponse(Buffer::Instance& response) {
+  if (!continuation_) {
+    return false;
+  }
+  if (!continuation_(response)) {
+    continuation_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void AdminFilter::onContinue() {
+  Buffer::OwnedImpl response;
+  const bool more = continueResponse(response);
+  const bool end_stream = !more && end_stream_on_complete_;
+  if (response.length() > 0 || end_stream) {
+    callbacks_->encodeData(response, end_stream);
+  }
+  // Encoding may have taken the connection over its high watermark, in which case the next chunk
+  // waits for the client to read.
+  if (more && !above_write_buffer_high_watermark_) {
+    continue_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
 void AdminFilter::addOnDestroyCallback(std::function<void()> cb) {
   on_destroy_callbacks_.push_back(std::move(cb));
 }
@@ -408,20 +626,52 @@ Http::Code AdminImpl::handlerClusters(absl::string_view url, Http::HeaderMap& re
   return Http::Code::OK;
 }
 
-// TODO(jsedgwick) Use query params to list available dumps, selectively dump, etc
-Http::Code AdminImpl::handlerConfigDump(absl::string_view, Http::HeaderMap& response_headers,
-                                        Buffer::Instance& response, AdminStream&) const {
-  envoy::admin::v2alpha::ConfigDump dump;
+Http::Code AdminImpl::handlerConfigDump(absl::string_view url, Http::HeaderMap& response_headers,
+                                        Buffer::Instance& response,
+                                        AdminStream& admin_stream) const {
+  const Http::Utility::QueryParams params = Http::Utility::parseQueryString(url);
+  const auto format = params.find("format");
+  if (format != params.end() && format->second != "json" && format->second != "proto") {
+    response.add("usage: /config_dump?resource=<keys>&name_regex=<regex>&format=<json|proto>\n");
+    return Http::Code::BadRequest;
+  }
+  absl::optional<std::regex> name_regex;
+  const auto name_regex_param = params.find("name_regex");
+  if (name_regex_param != params.end()) {
+    try {
+      name_regex = std::regex(name_regex_param->second);
+    } catch (const std::regex_error& e) {
+      response.add(fmt::format("invalid name_regex: {}\n", e.what()));
+      return Http::Code::BadRequest;
+    }
+  }
+
+  // Only the configs of the requested keys, e.g. "clusters,listeners", are collected.
+  const auto resource_param = params.find("resource");
+  std::vector<std::string> resources;
+  if (resource_param != params.end()) {
+    resources = absl::StrSplit(resource_param->second, ',');
+  }
+  std::vector<std::string> keys;
   for (const auto& key_callback_pair : config_tracker_.getCallbacksMap()) {
-    ProtobufTypes::MessagePtr message = key_callback_pair.second();
-    RELEASE_ASSERT(message, "");
-    auto& any_message = *(dump.add_configs());
-    any_message.PackFrom(*message);
+    if (resources.empty() ||
+        std::find(resources.begin(), resources.end(), key_callback_pair.first) != resources.end()) {
+      keys.push_back(key_callback_pair.first);
+    }
   }
 
-  response_headers.insertContentType().value().setReference(
-      Http::Headers::get().ContentTypeValues.Json);
-  response.add(MessageUtil::getJsonStringFromMessage(dump, true)); // pretty-print
+  const bool binary = format != params.end() && format->second == "proto";
+  if (binary) {
+    response_headers.insertContentType().value().setReference(octetStreamContentType());
+  } else {
+    response_headers.insertContentType().value().setReference(
+        Http::Headers::get().ContentTypeValues.Json);
+  }
+  auto formatter = std::make_shared<ConfigDumpFormatter>(config_tracker_, std::move(keys),
+                                                         std::move(name_regex), binary);
+  streamResponse(
+      [formatter](Buffer::Instance& response) -> bool { return formatter->formatChunk(response); },
+      response, admin_stream);
   return Http::Code::OK;
 }
 
@@ -449,6 +699,41 @@ Http::Code AdminImpl::handlerCpuProfiler(absl::string_view url, Http::HeaderMap&
   return Http::Code::OK;
 }
 
+Http::Code AdminImpl::handlerContention(absl::string_view, Http::HeaderMap&,
+                                        Buffer::Instance& response, AdminStream&) {
+  const Thread::MutexContention::Profile profile = Thread::MutexContention::profile();
+  response.add(fmt::format("enabled: {}\n", Thread::MutexContention::enabled()));
+  response.add(fmt::format("contentions: {}\n", profile.contentions_));
+  response.add(fmt::format(
+      "wait_time_us: {}\n",
+      std::chrono::duration_cast<std::chrono::microseconds>(profile.wait_time_).count()));
+  response.add("wait_us_histogram:\n");
+  for (size_t i = 0; i < profile.buckets_.size(); i++) {
+    if (profile.buckets_[i] == 0) {
+      continue;
+    }
+    const uint64_t lower = i == 0 ? 0 : uint64_t(1) << (i - 1);
+    const std::string upper =
+        i == profile.buckets_.size() - 1 ? "inf" : std::to_string(uint64_t(1) << i);
+    response.add(fmt::format("  [{}, {}): {}\n", lower, upper, profile.buckets_[i]));
+  }
+  return Http::Code::OK;
+}
+
+Http::Code AdminImpl::handlerContentionProfiler(absl::string_view url, Http::HeaderMap&,
+                                                Buffer::Instance& response, AdminStream&) {
+  Http::Utility::QueryParams query_params = Http::Utility::parseQueryString(url);
+  if (query_params.size() != 1 || query_params.begin()->first != "enable" ||
+      (query_params.begin()->second != "y" && query_params.begin()->second != "n")) {
+    response.add("?enable=<y|n>\n");
+    return Http::Code::BadRequest;
+  }
+
+  Thread::MutexContention::enable(query_params.begin()->second == "y");
+  response.add("OK\n");
+  return Http::Code::OK;
+}
+
 Http::Code AdminImpl::handlerHealthcheckFail(absl::string_view, Http::HeaderMap&,
                                              Buffer::Instance& response, AdminStream&) {
   server_.failHealthcheck(true);
@@ -505,6 +790,84 @@ Http::Code AdminImpl::handlerMemory(absl::string_view, Http::HeaderMap&, Buffer:
   return Http::Code::OK;
 }
 
+Http::Code AdminImpl::handlerPprofHeap(absl::string_view, Http::HeaderMap&,
+                                       Buffer::Instance& response, AdminStream&) {
+  std::string sample;
+  if (!Profiler::Heap::sample(sample)) {
+    response.add("heap sampling requires tcmalloc\n");
+    return Http::Code::NotImplemented;
+  }
+  response.add(sample);
+  return Http::Code::OK;
+}
+
+Http::Code AdminImpl::handlerPprofProfile(absl::string_view url, Http::HeaderMap& response_headers,
+                                          Buffer::Instance& response, AdminStream& admin_stream) {
+  const Http::Utility::QueryParams params = Http::Utility::parseQueryString(url);
+  uint64_t seconds = DefaultProfileSeconds;
+  const auto it = params.find("seconds");
+  if ((it != params.end() && !absl::SimpleAtoi(it->second, &seconds)) || seconds == 0 ||
+      seconds > MaxProfileSeconds) {
+    response.add(fmt::format("usage: /pprof/profile?seconds=<1-{}>\n", MaxProfileSeconds));
+    return Http::Code::BadRequest;
+  }
+
+  if (Profiler::Cpu::profilerEnabled()) {
+    response.add("the CPU profiler is already running\n");
+    return Http::Code::Conflict;
+  }
+  if (!Profiler::Cpu::startProfiler(profile_path_)) {
+    response.add("failure to start the profiler\n");
+    return Http::Code::InternalServerError;
+  }
+
+  // The profile is sent once the profiler stops, and the profiler stops early if the request
+  // ends first.
+  Http::StreamDecoderFilterCallbacks& callbacks = admin_stream.getDecoderFilterCallbacks();
+  auto profiling = std::make_shared<bool>(true);
+  std::shared_ptr<Event::Timer> timer =
+      callbacks.dispatcher().createTimer([this, &callbacks, profiling]() -> void {
+        *profiling = false;
+        Profiler::Cpu::stopProfiler();
+        Buffer::OwnedImpl profile;
+        try {
+          profile.add(server_.api().fileReadToEnd(profile_path_));
+        } catch (const EnvoyException& e) {
+          ENVOY_LOG(error, "failure to read the CPU profile: {}", e.what());
+        }
+        callbacks.encodeData(profile, true);
+      });
+  timer->enableTimer(std::chrono::seconds(seconds));
+  admin_stream.addOnDestroyCallback([profiling, timer]() -> void {
+    timer->disableTimer();
+    if (*profiling) {
+      *profiling = false;
+      Profiler::Cpu::stopProfiler();
+    }
+  });
+
+  admin_stream.setEndStreamOnComplete(false);
+  response_headers.insertContentType().value().setReference(octetStreamContentType());
+  return Http::Code::OK;
+}
+
+Http::Code AdminImpl::handlerMemoryTop(absl::string_view url, Http::HeaderMap&,
+                                       Buffer::Instance& response, AdminStream&) {
+  const Http::Utility::QueryParams params = Http::Utility::parseQueryString(url);
+  uint64_t limit = 10;
+  const auto it = params.find("limit");
+  if (it != params.end() && !absl::SimpleAtoi(it->second, &limit)) {
+    response.add("usage: /memory/top?limit=<count>\n");
+    return Http::Code::BadRequest;
+  }
+
+  for (const Buffer::MemoryConsumer& consumer :
+       Buffer::MemoryAccountRegistrySingleton::get().largest(limit)) {
+    response.add(fmt::format("{} {}\n", consumer.bytes_, consumer.description_));
+  }
+  return Http::Code::OK;
+}
+
 Http::Code AdminImpl::handlerResetCounters(absl::string_view, Http::HeaderMap&,
                                            Buffer::Instance& response, AdminStream&) {
   for (const Stats::CounterSharedPtr& counter : server_.stats().counters()) {
@@ -528,67 +891,111 @@ Http::Code AdminImpl::handlerServerInfo(absl::string_view, Http::HeaderMap&,
 
 Http::Code AdminImpl::handlerStats(absl::string_view url, Http::HeaderMap& response_headers,
                                    Buffer::Instance& response, AdminStream& admin_stream) {
-  Http::Code rc = Http::Code::OK;
   const Http::Utility::QueryParams params = Http::Utility::parseQueryString(url);
+  const auto format = params.find("format");
+  if (format != params.end() && format->second == "prometheus") {
+    return handlerPrometheusStats(url, response_headers, response, admin_stream);
+  }
+  if (format != params.end() && format->second != "json") {
+    response.add("usage: /stats?format=json  or /stats?format=prometheus \n");
+    response.add("\n");
+    return Http::Code::NotFound;
+  }
 
   const bool used_only = params.find("usedonly") != params.end();
-  const bool has_format = !(params.find("format") == params.end());
-  const absl::optional<std::regex> regex =
-      (params.find("filter") != params.end())
-          ? absl::optional<std::regex>{std::regex(params.at("filter"))}
-          : absl::nullopt;
+  const absl::optional<std::regex> regex = statsFilter(params);
+
+  if (format != params.end()) {
+    std::map<std::string, uint64_t> all_stats;
+    for (const Stats::CounterSharedPtr& counter : server_.stats().counters()) {
+      if (shouldShowMetric(counter, used_only, regex)) {
+        all_stats.emplace(counter->name(), counter->value());
+      }
+    }
 
-  std::map<std::string, uint64_t> all_stats;
+    for (const Stats::GaugeSharedPtr& gauge : server_.stats().gauges()) {
+      if (shouldShowMetric(gauge, used_only, regex)) {
+        all_stats.emplace(gauge->name(), gauge->value());
+      }
+    }
+
+    response_headers.insertContentType().value().setReference(
+        Http::Headers::get().ContentTypeValues.Json);
+    response.add(AdminImpl::statsAsJson(all_stats, server_.stats().histograms(), used_only, regex));
+    return Http::Code::OK;
+  }
+
+  // Display plain stats if format query param is not there.
+  std::vector<std::pair<std::string, uint64_t>> all_stats;
   for (const Stats::CounterSharedPtr& counter : server_.stats().counters()) {
     if (shouldShowMetric(counter, used_only, regex)) {
-      all_stats.emplace(counter->name(), counter->value());
+      all_stats.emplace_back(counter->name(), counter->value());
     }
   }
 
   for (const Stats::GaugeSharedPtr& gauge : server_.stats().gauges()) {
     if (shouldShowMetric(gauge, used_only, regex)) {
-      all_stats.emplace(gauge->name(), gauge->value());
+      all_stats.emplace_back(gauge->name(), gauge->value());
     }
   }
 
-  if (has_format) {
-    const std::string format_value = params.at("format");
-    if (format_value == "json") {
-      response_headers.insertContentType().value().setReference(
-          Http::Headers::get().ContentTypeValues.Json);
-      response.add(
-          AdminImpl::statsAsJson(all_stats, server_.stats().histograms(), used_only, regex));
-    } else if (format_value == "prometheus") {
-      return handlerPrometheusStats(url, response_headers, response, admin_stream);
-    } else {
-      response.add("usage: /stats?format=json  or /stats?format=prometheus \n");
-      response.add("\n");
-      rc = Http::Code::NotFound;
-    }
-  } else { // Display plain stats if format query param is not there.
-    for (auto stat : all_stats) {
-      response.add(fmt::format("{}: {}\n", stat.first, stat.second));
+  const auto by_name = [](const auto& lhs, const auto& rhs) -> bool {
+    return lhs.first < rhs.first;
+  };
+  // A counter hides a gauge of the same name.
+  std::stable_sort(all_stats.begin(), all_stats.end(), by_name);
+  all_stats.erase(std::unique(all_stats.begin(), all_stats.end(),
+                              [](const auto& lhs, const auto& rhs) -> bool {
+                                return lhs.first == rhs.first;
+                              }),
+                  all_stats.end());
+
+  // TODO(ramaraochavali): See the comment in ThreadLocalStoreImpl::histograms() for why duplicate
+  // histograms are all output. When shared storage is implemented they can be deduplicated too.
+  std::vector<std::pair<std::string, Stats::ParentHistogramSharedPtr>> all_histograms;
+  for (const Stats::ParentHistogramSharedPtr& histogram : server_.stats().histograms()) {
+    if (shouldShowMetric(histogram, used_only, regex)) {
+      all_histograms.emplace_back(histogram->name(), histogram);
     }
-    // TOOD(ramaraochavali): See the comment in ThreadLocalStoreImpl::histograms() for why we use a
-    // multimap here. This makes sure that duplicate histograms get output. When shared storage is
-    // implemented this can be switched back to a normal map.
-    std::multimap<std::string, std::string> all_histograms;
-    for (const Stats::ParentHistogramSharedPtr& histogram : server_.stats().histograms()) {
-      if (shouldShowMetric(histogram, used_only, regex)) {
-        all_histograms.emplace(histogram->name(), histogram->summary());
-      }
+  }
+  std::stable_sort(all_histograms.begin(), all_histograms.end(), by_name);
+
+  auto formatter =
+      std::make_shared<StatsTextFormatter>(std::move(all_stats), std::move(all_histograms));
+  streamResponse(
+      [formatter](Buffer::Instance& response) -> bool { return formatter->formatChunk(response); },
+      response, admin_stream);
+  return Http::Code::OK;
+}
+
+Http::Code AdminImpl::handlerPrometheusStats(absl::string_view url, Http::HeaderMap&,
+                                             Buffer::Instance& response,
+                                             AdminStream& admin_stream) {
+  const Http::Utility::QueryParams params = Http::Utility::parseQueryString(url);
+  const bool used_only = params.find("usedonly") != params.end();
+  const absl::optional<std::regex> regex = statsFilter(params);
+
+  std::vector<Stats::CounterSharedPtr> counters;
+  for (Stats::CounterSharedPtr& counter : server_.stats().counters()) {
+    if (shouldShowMetric(counter, used_only, regex)) {
+      counters.push_back(std::move(counter));
     }
-    for (auto histogram : all_histograms) {
-      response.add(fmt::format("{}: {}\n", histogram.first, histogram.second));
+  }
+
+  std::vector<Stats::GaugeSharedPtr> gauges;
+  for (Stats::GaugeSharedPtr& gauge : server_.stats().gauges()) {
+    if (shouldShowMetric(gauge, used_only, regex)) {
+      gauges.push_back(std::move(gauge));
     }
   }
-  return rc;
-}
 
-Http::Code AdminImpl::handlerPrometheusStats(absl::string_view, Http::HeaderMap&,
-                                             Buffer::Instance& response, AdminStream&) {
-  PrometheusStatsFormatter::statsAsPrometheus(server_.stats().counters(), server_.stats().gauges(),
-                                              response);
+  auto formatter =
+      std::make_shared<PrometheusStatsFormatter>(std::move(counters), std::move(gauges));
+  streamResponse(
+      [formatter](Buffer::Instance& response) -> bool {
+        return formatter->formatChunk(StatsPerChunk, response);
+      },
+      response, admin_stream);
   return Http::Code::OK;
 }
 
@@ -614,32 +1021,43 @@ std::string PrometheusStatsFormatter::metricName(const std::string& extractedNam
   return fmt::format("envoy_{0}", sanitizeName(extractedName));
 }
 
+PrometheusStatsFormatter::PrometheusStatsFormatter(std::vector<Stats::CounterSharedPtr>&& counters,
+                                                   std::vector<Stats::GaugeSharedPtr>&& gauges)
+    : counters_(std::move(counters)), gauges_(std::move(gauges)) {}
+
 // TODO(ramaraochavali): Add summary histogram output for Prometheus.
 uint64_t
 PrometheusStatsFormatter::statsAsPrometheus(const std::vector<Stats::CounterSharedPtr>& counters,
                                             const std::vector<Stats::GaugeSharedPtr>& gauges,
                                             Buffer::Instance& response) {
-  std::unordered_set<std::string> metric_type_tracker;
-  for (const auto& counter : counters) {
-    const std::string tags = formattedTags(counter->tags());
-    const std::string metric_name = metricName(counter->tagExtractedName());
-    if (metric_type_tracker.find(metric_name) == metric_type_tracker.end()) {
-      metric_type_tracker.insert(metric_name);
-      response.add(fmt::format("# TYPE {0} counter\n", metric_name));
+  PrometheusStatsFormatter formatter(std::vector<Stats::CounterSharedPtr>(counters),
+                                     std::vector<Stats::GaugeSharedPtr>(gauges));
+  formatter.formatChunk(counters.size() + gauges.size(), response);
+  return formatter.metric_type_tracker_.size();
+}
+
+bool PrometheusStatsFormatter::formatChunk(uint64_t max_metrics, Buffer::Instance& response) {
+  const size_t total = counters_.size() + gauges_.size();
+  const size_t end = std::min<size_t>(next_ + max_metrics, total);
+  for (; next_ < end; next_++) {
+    if (next_ < counters_.size()) {
+      formatMetric(*counters_[next_], "counter", counters_[next_]->value(), response);
+    } else {
+      const Stats::Gauge& gauge = *gauges_[next_ - counters_.size()];
+      formatMetric(gauge, "gauge", gauge.value(), response);
     }
-    response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, counter->value()));
   }
+  return next_ < total;
+}
 
-  for (const auto& gauge : gauges) {
-    const std::string tags = formattedTags(gauge->tags());
-    const std::string metric_name = metricName(gauge->tagExtractedName());
-    if (metric_type_tracker.find(metric_name) == metric_type_tracker.end()) {
-      metric_type_tracker.insert(metric_name);
-      response.add(fmt::format("# TYPE {0} gauge\n", metric_name));
-    }
-    response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, gauge->value()));
+void PrometheusStatsFormatter::formatMetric(const Stats::Metric& metric, const char* type,
+                                            uint64_t value, Buffer::Instance& response) {
+  const std::string tags = formattedTags(metric.tags());
+  const std::string metric_name = metricName(metric.tagExtractedName());
+  if (metric_type_tracker_.insert(metric_name).second) {
+    response.add(fmt::format("# TYPE {0} {1}\n", metric_name, type));
   }
-  return metric_type_tracker.size();
+  response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, value));
 }
 
 std::string
@@ -884,11 +1302,19 @@ void AdminFilter::onComplete() {
   RELEASE_ASSERT(request_headers_, "");
   Http::Code code = parent_.runCallback(path, *header_map, response, *this);
   populateFallbackResponseHeaders(code, *header_map);
-  callbacks_->encodeHeaders(std::move(header_map),
-                            end_stream_on_complete_ && response.length() == 0);
+  const bool end_stream = end_stream_on_complete_ && !continuation_;
+  callbacks_->encodeHeaders(std::move(header_map), end_stream && response.length() == 0);
 
   if (response.length() > 0) {
-    callbacks_->encodeData(response, end_stream_on_complete_);
+    callbacks_->encodeData(response, end_stream);
+  }
+
+  if (continuation_) {
+    callbacks_->addDownstreamWatermarkCallbacks(*this);
+    continue_timer_ = callbacks_->dispatcher().createTimer([this]() -> void { onContinue(); });
+    if (!above_write_buffer_high_watermark_) {
+      continue_timer_->enableTimer(std::chrono::milliseconds(0));
+    }
   }
 }
 
@@ -912,6 +1338,10 @@ AdminImpl::AdminImpl(const std::string& access_log_path, const std::string& prof
            false},
           {"/config_dump", "dump current Envoy configs (experimental)",
            MAKE_ADMIN_HANDLER(handlerConfigDump), false, false},
+          {"/contention", "print the mutex contention profile",
+           MAKE_ADMIN_HANDLER(handlerContention), false, false},
+          {"/contentionprofiler", "enable/disable the mutex contention profiler",
+           MAKE_ADMIN_HANDLER(handlerContentionProfiler), false, true},
           {"/cpuprofiler", "enable/disable the CPU profiler",
            MAKE_ADMIN_HANDLER(handlerCpuProfiler), false, true},
           {"/healthcheck/fail", "cause the server to fail health checks",
@@ -926,6 +1356,12 @@ AdminImpl::AdminImpl(const std::string& access_log_path, const std::string& prof
            true},
           {"/memory", "print current allocation/heap usage", MAKE_ADMIN_HANDLER(handlerMemory),
            false, false},
+          {"/memory/top", "print the streams and connections buffering the most memory",
+           MAKE_ADMIN_HANDLER(handlerMemoryTop), false, false},
+          {"/pprof/heap", "print a sample of the live heap allocations in pprof format",
+           MAKE_ADMIN_HANDLER(handlerPprofHeap), false, false},
+          {"/pprof/profile", "profile the CPU for ?seconds=<count> and print it in pprof format",
+           MAKE_ADMIN_HANDLER(handlerPprofProfile), false, false},
           {"/quitquitquit", "exit the server", MAKE_ADMIN_HANDLER(handlerQuitQuitQuit), false,
            true},
           {"/reset_counters", "reset all counters to zero",
@@ -1142,6 +1578,8 @@ Http::Code AdminImpl::request(absl::string_view path_and_query, absl::string_vie
   Buffer::OwnedImpl response;
 
   Http::Code code = runCallback(path_and_query, response_headers, response, filter);
+  while (filter.continueResponse(response)) {
+  }
   populateFallbackResponseHeaders(code, response_headers);
   body = response.toString();
   return code;
@@ -4,10 +4,12 @@
 #include <list>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "envoy/admin/v2alpha/clusters.pb.h"
+#include "envoy/event/timer.h"
 #include "envoy/http/filter.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/listen_socket.h"
@@ -26,6 +28,7 @@
 #include "common/http/date_provider_impl.h"
 #include "common/http/default_server_string.h"
 #include "common/http/utility.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/raw_buffer_socket.h"
 #include "common/stats/isolated_store_impl.h"
 
@@ -76,6 +79,10 @@ public:
   createNetworkFilterChain(Network::Connection& connection,
                            const std::vector<Network::FilterFactoryCb>& filter_factories) override;
   bool createListenerFilterChain(Network::ListenerFilterManager&) override { return true; }
+  bool createUdpListenerFilterChain(Network::UdpListenerFilterManager&,
+                                    Network::UdpReadFilterCallbacks&) override {
+    return false;
+  }
 
   // Http::FilterChainFactory
   void createFilterChain(Http::FilterChainFactoryCallbacks& callbacks) override;
@@ -191,6 +198,11 @@ private:
                              Buffer::Instance& response, AdminStream&);
   Http::Code handlerConfigDump(absl::string_view path_and_query, Http::HeaderMap& response_headers,
                                Buffer::Instance& response, AdminStream&) const;
+  Http::Code handlerContention(absl::string_view path_and_query, Http::HeaderMap& response_headers,
+                               Buffer::Instance& response, AdminStream&);
+  Http::Code handlerContentionProfiler(absl::string_view path_and_query,
+                                       Http::HeaderMap& response_headers,
+                                       Buffer::Instance& response, AdminStream&);
   Http::Code handlerCpuProfiler(absl::string_view path_and_query, Http::HeaderMap& response_headers,
                                 Buffer::Instance& response, AdminStream&);
   Http::Code handlerHealthcheckFail(absl::string_view path_and_query,
@@ -211,6 +223,13 @@ private:
                             Buffer::Instance& response, AdminStream&);
   Http::Code handlerMemory(absl::string_view path_and_query, Http::HeaderMap& response_headers,
                            Buffer::Instance& response, AdminStream&);
+  Http::Code handlerPprofHeap(absl::string_view path_and_query, Http::HeaderMap& response_headers,
+                              Buffer::Instance& response, AdminStream&);
+  Http::Code handlerPprofProfile(absl::string_view path_and_query,
+                                 Http::HeaderMap& response_headers, Buffer::Instance& response,
+                                 AdminStream&);
+  Http::Code handlerMemoryTop(absl::string_view path_and_query, Http::HeaderMap& response_headers,
+                              Buffer::Instance& response, AdminStream&);
   Http::Code handlerMain(const std::string& path, Buffer::Instance& response, AdminStream&);
   Http::Code handlerQuitQuitQuit(absl::string_view path_and_query,
                                  Http::HeaderMap& response_headers, Buffer::Instance& response,
@@ -243,15 +262,25 @@ private:
     Network::Socket& socket() override { return parent_.mutable_socket(); }
     bool bindToPort() override { return true; }
     bool handOffRestoredDestinationConnections() const override { return false; }
-    uint32_t perConnectionBufferLimitBytes() override { return 0; }
+    // Lets continued responses pause while the client catches up.
+    uint32_t perConnectionBufferLimitBytes() override { return 1024 * 1024; }
+    uint32_t perConnectionBufferLimitMaxBytes() override { return 0; }
     Stats::Scope& listenerScope() override { return *scope_; }
     uint64_t listenerTag() const override { return 0; }
     const std::string& name() const override { return name_; }
+    Network::ConnectionBalancer& connectionBalancer() override { return connection_balancer_; }
+    const Network::AcceptLimits& acceptLimits() const override { return accept_limits_; }
+    bool tcpQuickAck() const override { return false; }
+    Network::Address::SocketType socketType() const override {
+      return Network::Address::SocketType::Stream;
+    }
 
     AdminImpl& parent_;
     const std::string name_;
     Stats::ScopePtr scope_;
     Http::ConnectionManagerListenerStats stats_;
+    Network::NopConnectionBalancerImpl connection_balancer_;
+    const Network::AcceptLimits accept_limits_{};
   };
 
   class AdminFilterChain : public Network::FilterChain {
@@ -297,6 +326,7 @@ private:
  * A terminal HTTP filter that implements server admin functionality.
  */
 class AdminFilter : public Http::StreamDecoderFilter,
+                    public Http::DownstreamWatermarkCallbacks,
                     public AdminStream,
                     Logger::Loggable<Logger::Id::admin> {
 public:
@@ -313,17 +343,34 @@ public:
     callbacks_ = &callbacks;
   }
 
+  // Http::DownstreamWatermarkCallbacks
+  void onAboveWriteBufferHighWatermark() override;
+  void onBelowWriteBufferLowWatermark() override;
+
   // AdminStream
   void setEndStreamOnComplete(bool end_stream) override { end_stream_on_complete_ = end_stream; }
   void addOnDestroyCallback(std::function<void()> cb) override;
   Http::StreamDecoderFilterCallbacks& getDecoderFilterCallbacks() const override;
   const Http::HeaderMap& getRequestHeaders() const override;
+  void
+  setResponseContinuation(std::function<bool(Buffer::Instance& response)> continuation) override;
+
+  /**
+   * Run the response continuation, if any, once.
+   * @param response supplies the buffer the next chunk of the body is appended to.
+   * @return bool whether the continuation has more of the body to add.
+   */
+  bool continueResponse(Buffer::Instance& response);
 
 private:
   /**
    * Called when an admin request has been completely received.
    */
   void onComplete();
+  /**
+   * Encodes the next chunk of a continued response.
+   */
+  void onContinue();
 
   AdminImpl& parent_;
   // Handlers relying on the reference should use addOnDestroyCallback()
@@ -333,6 +380,9 @@ private:
   Http::HeaderMap* request_headers_{};
   std::list<std::function<void()>> on_destroy_callbacks_;
   bool end_stream_on_complete_ = true;
+  std::function<bool(Buffer::Instance& response)> continuation_;
+  Event::TimerPtr continue_timer_;
+  bool above_write_buffer_high_watermark_{};
 };
 
 /**
@@ -342,6 +392,20 @@ private:
  */
 class PrometheusStatsFormatter {
 public:
+  /**
+   * Formats counters and gauges over several calls of formatChunk(), for responses streamed
+   * across dispatcher iterations.
+   */
+  PrometheusStatsFormatter(std::vector<Stats::CounterSharedPtr>&& counters,
+                           std::vector<Stats::GaugeSharedPtr>&& gauges);
+
+  /**
+   * Appends the next counters and gauges to the response buffer, counters first.
+   * @param max_metrics supplies the most metrics to append.
+   * @return bool whether metrics remain to be appended.
+   */
+  bool formatChunk(uint64_t max_metrics, Buffer::Instance& response);
+
   /**
    * Extracts counters and gauges and relevant tags, appending them to
    * the response buffer after sanitizing the metric / label names.
@@ -365,6 +429,15 @@ private:
    * Take a string and sanitize it according to Prometheus conventions.
    */
   static std::string sanitizeName(const std::string& name);
+
+  void formatMetric(const Stats::Metric& metric, const char* type, uint64_t value,
+                    Buffer::Instance& response);
+
+  const std::vector<Stats::CounterSharedPtr> counters_;
+  const std::vector<Stats::GaugeSharedPtr> gauges_;
+  size_t next_{};
+  // The # TYPE line is only emitted before the first metric of each name.
+  std::unordered_set<std::string> metric_type_tracker_;
 };
 
 } // namespace Server
@@ -45,15 +45,7 @@ void LdsApiImpl::initialize(std::function<void()> callback) {
 void LdsApiImpl::onConfigUpdate(const ResourceVector& resources, const std::string& version_info) {
   cm_.adsMux().pause(Config::TypeUrl::get().RouteConfiguration);
   Cleanup rds_resume([this] { cm_.adsMux().resume(Config::TypeUrl::get().RouteConfiguration); });
-  std::unordered_set<std::string> listener_names;
-  for (const auto& listener : resources) {
-    if (!listener_names.insert(listener.name()).second) {
-      throw EnvoyException(fmt::format("duplicate listener {} found", listener.name()));
-    }
-  }
-  for (const auto& listener : resources) {
-    MessageUtil::validate(listener);
-  }
+  validateUpdate(resources);
   // We need to keep track of which listeners we might need to remove.
   std::unordered_map<std::string, std::reference_wrapper<Network::ListenerConfig>>
       listeners_to_remove;
@@ -73,6 +65,46 @@ void LdsApiImpl::onConfigUpdate(const ResourceVector& resources, const std::stri
     }
   }
 
+  addOrUpdateListeners(resources, version_info);
+  version_info_ = version_info;
+  runInitializeCallbackIfAny();
+}
+
+void LdsApiImpl::onIncrementalConfigUpdate(
+    const ResourceVector& added_resources,
+    const Protobuf::RepeatedPtrField<ProtobufTypes::String>& removed_resources,
+    const std::string& system_version_info) {
+  cm_.adsMux().pause(Config::TypeUrl::get().RouteConfiguration);
+  Cleanup rds_resume([this] { cm_.adsMux().resume(Config::TypeUrl::get().RouteConfiguration); });
+  validateUpdate(added_resources);
+
+  // As with a full update, the listeners are removed first so that a new listener may take over
+  // the address of a removed one.
+  for (const auto& listener_name : removed_resources) {
+    if (listener_manager_.removeListener(listener_name)) {
+      ENVOY_LOG(info, "lds: remove listener '{}'", listener_name);
+    }
+  }
+  addOrUpdateListeners(added_resources, system_version_info);
+  version_info_ = system_version_info;
+  runInitializeCallbackIfAny();
+}
+
+void LdsApiImpl::validateUpdate(const ResourceVector& resources) {
+  std::unordered_set<std::string> listener_names;
+  for (const auto& listener : resources) {
+    if (!listener_names.insert(listener.name()).second) {
+      throw EnvoyException(fmt::format("duplicate listener {} found", listener.name()));
+    }
+  }
+  // Validation is independent for each listener, and is the bulk of the cost of a large update.
+  cm_.xdsDecodePool().parallelFor(resources.size(), [&resources](size_t i) {
+    MessageUtil::validate(resources[i]);
+  });
+}
+
+void LdsApiImpl::addOrUpdateListeners(const ResourceVector& resources,
+                                      const std::string& version_info) {
   for (const auto& listener : resources) {
     const std::string listener_name = listener.name();
     try {
@@ -86,9 +118,6 @@ void LdsApiImpl::onConfigUpdate(const ResourceVector& resources, const std::stri
           fmt::format("Error adding/updating listener {}: {}", listener_name, e.what()));
     }
   }
-
-  version_info_ = version_info;
-  runInitializeCallbackIfAny();
 }
 
 void LdsApiImpl::onConfigUpdateFailed(const EnvoyException*) {
@@ -34,12 +34,18 @@ public:
 
   // Config::SubscriptionCallbacks
   void onConfigUpdate(const ResourceVector& resources, const std::string& version_info) override;
+  void onIncrementalConfigUpdate(
+      const ResourceVector& added_resources,
+      const Protobuf::RepeatedPtrField<ProtobufTypes::String>& removed_resources,
+      const std::string& system_version_info) override;
   void onConfigUpdateFailed(const EnvoyException* e) override;
   std::string resourceName(const ProtobufWkt::Any& resource) override {
     return MessageUtil::anyConvert<envoy::api::v2::Listener>(resource).name();
   }
 
 private:
+  void validateUpdate(const ResourceVector& resources);
+  void addOrUpdateListeners(const ResourceVector& resources, const std::string& version_info);
   void runInitializeCallbackIfAny();
 
   std::unique_ptr<Config::Subscription<envoy::api::v2::Listener>> subscription_;
@@ -10,6 +10,7 @@
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
 #include "common/config/utility.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/resolver_impl.h"
 #include "common/network/socket_option_factory.h"
@@ -83,6 +84,26 @@ ProdListenerComponentFactory::createListenerFilterFactoryList_(
   return ret;
 }
 
+std::vector<Network::UdpListenerFilterFactoryCb>
+ProdListenerComponentFactory::createUdpListenerFilterFactoryList_(
+    const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
+    Configuration::ListenerFactoryContext& context) {
+  std::vector<Network::UdpListenerFilterFactoryCb> ret;
+  for (ssize_t i = 0; i < filters.size(); i++) {
+    const auto& proto_config = filters[i];
+    const ProtobufTypes::String string_name = proto_config.name();
+    ENVOY_LOG(debug, "  udp filter #{}:", i);
+    ENVOY_LOG(debug, "    name: {}", string_name);
+
+    auto& factory =
+        Config::Utility::getAndCheckFactory<Configuration::NamedUdpListenerFilterConfigFactory>(
+            string_name);
+    auto message = Config::Utility::translateToFactoryConfig(proto_config, factory);
+    ret.push_back(factory.createFilterFactoryFromProto(*message, context));
+  }
+  return ret;
+}
+
 Network::SocketSharedPtr
 ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConstSharedPtr address,
                                                  const Network::Socket::OptionsSharedPtr& options,
@@ -94,7 +115,7 @@ ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConst
   // First we try to get the socket from our parent if applicable.
   if (address->type() == Network::Address::Type::Pipe) {
     const std::string addr = fmt::format("unix://{}", address->asString());
-    const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+    const int fd = server_.hotRestart().duplicateParentListenSocket(addr, 0);
     if (fd != -1) {
       ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
       return std::make_shared<Network::UdsListenSocket>(fd, address);
@@ -102,20 +123,56 @@ ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConst
     return std::make_shared<Network::UdsListenSocket>(address);
   }
 
+  return createTcpListenSocket(address, options, bind_to_port, 0);
+}
+
+Network::SocketSharedPtr ProdListenerComponentFactory::createWorkerListenSocket(
+    Network::Address::InstanceConstSharedPtr address,
+    const Network::Socket::OptionsSharedPtr& options, uint32_t worker_index) {
+  ASSERT(address->type() == Network::Address::Type::Ip);
+  return createTcpListenSocket(address, options, true, worker_index);
+}
+
+Network::SocketSharedPtr ProdListenerComponentFactory::createTcpListenSocket(
+    Network::Address::InstanceConstSharedPtr address,
+    const Network::Socket::OptionsSharedPtr& options, bool bind_to_port, uint32_t worker_index) {
   const std::string addr = fmt::format("tcp://{}", address->asString());
-  const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+  const int fd = server_.hotRestart().duplicateParentListenSocket(addr, worker_index);
   if (fd != -1) {
-    ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
+    ENVOY_LOG(debug, "obtained socket for address {} worker {} from parent", addr, worker_index);
     return std::make_shared<Network::TcpListenSocket>(fd, address, options);
   }
   return std::make_shared<Network::TcpListenSocket>(address, options, bind_to_port);
 }
 
+Network::SocketSharedPtr ProdListenerComponentFactory::createUdpListenSocket(
+    Network::Address::InstanceConstSharedPtr address,
+    const Network::Socket::OptionsSharedPtr& options, uint32_t worker_index) {
+  ASSERT(address->type() == Network::Address::Type::Ip);
+  const std::string addr = fmt::format("udp://{}", address->asString());
+  const int fd = server_.hotRestart().duplicateParentListenSocket(addr, worker_index);
+  if (fd != -1) {
+    ENVOY_LOG(debug, "obtained socket for address {} worker {} from parent", addr, worker_index);
+    return std::make_shared<Network::UdpListenSocket>(fd, address, options);
+  }
+  return std::make_shared<Network::UdpListenSocket>(address, options, true);
+}
+
 DrainManagerPtr
 ProdListenerComponentFactory::createDrainManager(envoy::api::v2::Listener::DrainType drain_type) {
   return DrainManagerPtr{new DrainManagerImpl(server_, drain_type)};
 }
 
+namespace {
+
+uint64_t hashWithoutFilterChains(const envoy::api::v2::Listener& config) {
+  envoy::api::v2::Listener without_filter_chains(config);
+  without_filter_chains.clear_filter_chains();
+  return MessageUtil::hash(without_filter_chains);
+}
+
+} // namespace
+
 ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::string& version_info,
                            ListenerManagerImpl& parent, const std::string& name, bool modifiable,
                            bool workers_started, uint64_t hash)
@@ -123,13 +180,25 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
       global_scope_(parent_.server_.stats().createScope("")),
       listener_scope_(
           parent_.server_.stats().createScope(fmt::format("listener.{}.", address_->asString()))),
+      socket_type_(config.address().socket_address().protocol() ==
+                           envoy::api::v2::core::SocketAddress::UDP
+                       ? Network::Address::SocketType::Datagram
+                       : Network::Address::SocketType::Stream),
       bind_to_port_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.deprecated_v1(), bind_to_port, true)),
+      // UDP listeners always have a socket per worker, so that the datagrams of a peer are
+      // processed by the same worker.
+      reuse_port_((config.reuse_port() || socket_type_ == Network::Address::SocketType::Datagram) &&
+                  bind_to_port_ && address_->type() == Network::Address::Type::Ip),
       hand_off_restored_destination_connections_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false)),
       per_connection_buffer_limit_bytes_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
+      per_connection_buffer_limit_max_bytes_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_max_bytes, 0)),
+      tcp_quick_ack_(config.tcp_latency_options().quick_ack()),
       listener_tag_(parent_.factory_.nextListenerTag()), name_(name), modifiable_(modifiable),
       workers_started_(workers_started), hash_(hash),
+      hash_without_filter_chains_(hashWithoutFilterChains(config)),
       local_drain_manager_(parent.factory_.createDrainManager(config.drain_type())),
       config_(config), version_info_(version_info) {
   if (config.has_transparent()) {
@@ -138,16 +207,61 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
   if (config.has_freebind()) {
     addListenSocketOptions(Network::SocketOptionFactory::buildIpFreebindOptions());
   }
+  if (reuse_port_) {
+    addListenSocketOptions(Network::SocketOptionFactory::buildReusePortOptions());
+  }
   if (config.has_tcp_fast_open_queue_length()) {
     addListenSocketOptions(Network::SocketOptionFactory::buildTcpFastOpenOptions(
         config.tcp_fast_open_queue_length().value()));
   }
 
+  if (config.has_tcp_latency_options()) {
+    addListenSocketOptions(
+        Network::SocketOptionFactory::buildTcpLatencyOptions(config.tcp_latency_options()));
+  }
+
   if (config.socket_options().size() > 0) {
     addListenSocketOptions(
         Network::SocketOptionFactory::buildLiteralOptions(config.socket_options()));
   }
 
+  if (config.has_connection_balance_config()) {
+    // exact_balance is the only balance type, and it is required by validation.
+    ASSERT(config.connection_balance_config().has_exact_balance());
+    connection_balancer_ = std::make_unique<Network::ExactConnectionBalancerImpl>();
+  } else {
+    connection_balancer_ = std::make_unique<Network::NopConnectionBalancerImpl>();
+  }
+
+  if (config.has_accept_limits()) {
+    const auto& accept_limits = config.accept_limits();
+    accept_limits_.max_accepts_per_event_loop_ =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(accept_limits, max_accepts_per_event_loop, 0);
+    accept_limits_.accepts_per_second_ =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(accept_limits, accepts_per_second, 0);
+    accept_limits_.accept_burst_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+        accept_limits, accept_burst, accept_limits_.accepts_per_second_);
+  }
+
+  if (socket_type_ == Network::Address::SocketType::Datagram) {
+    // A UDP listener has no connections, so no filter chains. Its listener filters receive the
+    // datagrams.
+    if (!config.filter_chains().empty() ||
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false) || !bind_to_port_) {
+      throw EnvoyException(fmt::format("error adding listener '{}': udp listeners must bind to "
+                                       "their port and can not have filter chains or use "
+                                       "original dst",
+                                       address_->asString()));
+    }
+    udp_listener_filter_factories_ =
+        parent_.factory_.createUdpListenerFilterFactoryList(config.listener_filters(), *this);
+    return;
+  }
+  if (config.filter_chains().empty()) {
+    throw EnvoyException(
+        fmt::format("error adding listener '{}': no filter chains", address_->asString()));
+  }
+
   if (!config.listener_filters().empty()) {
     listener_filter_factories_ =
         parent_.factory_.createListenerFilterFactoryList(config.listener_filters(), *this);
@@ -175,6 +289,9 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
   bool need_tls_inspector = false;
   std::unordered_set<envoy::api::v2::listener::FilterChainMatch, MessageUtil, MessageUtil>
       filter_chains;
+  // Unchanged filter chains of the listener being updated can share their transport socket
+  // factories, so that e.g. TLS contexts are not created again.
+  const ListenerImpl* existing_listener = parent_.activeListenerByName(name_);
 
   for (const auto& filter_chain : config.filter_chains()) {
     const auto& filter_chain_match = filter_chain.filter_chain_match();
@@ -199,11 +316,6 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
       }
     }
 
-    auto& config_factory = Config::Utility::getAndCheckFactory<
-        Server::Configuration::DownstreamTransportSocketConfigFactory>(transport_socket.name());
-    ProtobufTypes::MessagePtr message =
-        Config::Utility::translateToFactoryConfig(transport_socket, config_factory);
-
     // Validate IP addresses.
     std::vector<std::string> destination_ips;
     for (const auto& destination_ip : filter_chain_match.prefix_ranges()) {
@@ -227,16 +339,41 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
     std::vector<std::string> application_protocols(
         filter_chain_match.application_protocols().begin(),
         filter_chain_match.application_protocols().end());
-    Server::Configuration::TransportSocketFactoryContextImpl factory_context(
-        parent_.server_.sslContextManager(), *listener_scope_, parent_.server_.clusterManager(),
-        parent_.server_.localInfo(), parent_.server_.dispatcher(), parent_.server_.random(),
-        parent_.server_.stats());
-    factory_context.setInitManager(initManager());
-    addFilterChain(
-        PROTOBUF_GET_WRAPPED_OR_DEFAULT(filter_chain_match, destination_port, 0), destination_ips,
-        server_names, filter_chain_match.transport_protocol(), application_protocols,
-        config_factory.createTransportSocketFactory(*message, factory_context, server_names),
-        parent_.factory_.createNetworkFilterFactoryList(filter_chain.filters(), *this));
+
+    const uint64_t filter_chain_hash = MessageUtil::hash(filter_chain);
+    const FilterChainImpl* existing_filter_chain =
+        existing_listener != nullptr ? existing_listener->findFilterChainByHash(filter_chain_hash)
+                                     : nullptr;
+    Stats::ScopeSharedPtr transport_socket_scope;
+    std::shared_ptr<Network::TransportSocketFactory> transport_socket_factory;
+    if (existing_filter_chain != nullptr) {
+      transport_socket_scope = existing_filter_chain->transportSocketScope();
+      transport_socket_factory = existing_filter_chain->sharedTransportSocketFactory();
+    } else {
+      auto& config_factory = Config::Utility::getAndCheckFactory<
+          Server::Configuration::DownstreamTransportSocketConfigFactory>(transport_socket.name());
+      ProtobufTypes::MessagePtr message =
+          Config::Utility::translateToFactoryConfig(transport_socket, config_factory);
+      Server::Configuration::TransportSocketFactoryContextImpl factory_context(
+          parent_.server_.sslContextManager(), *listener_scope_, parent_.server_.clusterManager(),
+          parent_.server_.localInfo(), parent_.server_.dispatcher(), parent_.server_.random(),
+          parent_.server_.stats());
+      factory_context.setInitManager(initManager());
+      transport_socket_scope = listener_scope_;
+      transport_socket_factory =
+          config_factory.createTransportSocketFactory(*message, factory_context, server_names);
+    }
+
+    auto filter_chain_factory_context = std::make_unique<FilterChainFactoryContextImpl>(*this);
+    std::vector<Network::FilterFactoryCb> filters_factory =
+        parent_.factory_.createNetworkFilterFactoryList(filter_chain.filters(),
+                                                        *filter_chain_factory_context);
+    addFilterChain(PROTOBUF_GET_WRAPPED_OR_DEFAULT(filter_chain_match, destination_port, 0),
+                   destination_ips, server_names, filter_chain_match.transport_protocol(),
+                   application_protocols,
+                   std::make_shared<FilterChainImpl>(
+                       filter_chain_hash, transport_socket_scope, transport_socket_factory,
+                       std::move(filter_chain_factory_context), std::move(filters_factory)));
 
     need_tls_inspector |= filter_chain_match.transport_protocol() == "tls" ||
                           (filter_chain_match.transport_protocol().empty() &&
@@ -279,6 +416,7 @@ ListenerImpl::~ListenerImpl() {
   // vector for clarity.
   initialize_canceled_ = true;
   destination_ports_map_.clear();
+  filter_chains_by_hash_.clear();
 }
 
 bool ListenerImpl::isWildcardServerName(const std::string& name) {
@@ -290,10 +428,8 @@ void ListenerImpl::addFilterChain(uint16_t destination_port,
                                   const std::vector<std::string>& server_names,
                                   const std::string& transport_protocol,
                                   const std::vector<std::string>& application_protocols,
-                                  Network::TransportSocketFactoryPtr&& transport_socket_factory,
-                                  std::vector<Network::FilterFactoryCb> filters_factory) {
-  const auto filter_chain = std::make_shared<FilterChainImpl>(std::move(transport_socket_factory),
-                                                              std::move(filters_factory));
+                                  const std::shared_ptr<FilterChainImpl>& filter_chain) {
+  filter_chains_by_hash_[filter_chain->hash()] = filter_chain;
   addFilterChainForDestinationPorts(destination_ports_map_, destination_port, destination_ips,
                                     server_names, transport_protocol, application_protocols,
                                     filter_chain);
@@ -368,7 +504,8 @@ void ListenerImpl::convertDestinationIPsMapToTrie() {
   for (auto& port : destination_ports_map_) {
     auto& destination_ips_pair = port.second;
     auto& destination_ips_map = destination_ips_pair.first;
-    std::vector<std::pair<ServerNamesMapSharedPtr, std::vector<Network::Address::CidrRange>>> list;
+    std::vector<std::pair<ServerNamesTrieSharedPtr, std::vector<Network::Address::CidrRange>>>
+        list;
     for (const auto& entry : destination_ips_map) {
       std::vector<Network::Address::CidrRange> subnets;
       if (entry.first == EMPTY_STRING) {
@@ -381,10 +518,13 @@ void ListenerImpl::convertDestinationIPsMapToTrie() {
       } else {
         subnets.push_back(Network::Address::CidrRange::create(entry.first));
       }
+      auto server_names_trie = std::make_shared<ServerNamesTrie>();
+      for (const auto& server_name : entry.second) {
+        server_names_trie->add(server_name.first, server_name.second);
+      }
       list.push_back(
-          std::make_pair<ServerNamesMapSharedPtr, std::vector<Network::Address::CidrRange>>(
-              std::make_shared<ServerNamesMap>(entry.second),
-              std::vector<Network::Address::CidrRange>(subnets)));
+          std::make_pair<ServerNamesTrieSharedPtr, std::vector<Network::Address::CidrRange>>(
+              std::move(server_names_trie), std::vector<Network::Address::CidrRange>(subnets)));
     }
     destination_ips_pair.second = std::make_unique<DestinationIPsTrie>(list, true);
   }
@@ -423,7 +563,7 @@ ListenerImpl::findFilterChainForDestinationIP(const DestinationIPsTrie& destinat
   }
 
   // Match on both: exact IP and wider CIDR ranges using LcTrie.
-  const auto& data = destination_ips_trie.getData(address);
+  const auto& data = destination_ips_trie.lookup(address);
   if (!data.empty()) {
     ASSERT(data.size() == 1);
     return findFilterChainForServerName(*data.back(), socket);
@@ -433,31 +573,14 @@ ListenerImpl::findFilterChainForDestinationIP(const DestinationIPsTrie& destinat
 }
 
 const Network::FilterChain*
-ListenerImpl::findFilterChainForServerName(const ServerNamesMap& server_names_map,
+ListenerImpl::findFilterChainForServerName(const ServerNamesTrie& server_names_trie,
                                            const Network::ConnectionSocket& socket) const {
-  const std::string server_name(socket.requestedServerName());
-
-  // Match on exact server name, i.e. "www.example.com" for "www.example.com".
-  const auto server_name_exact_match = server_names_map.find(server_name);
-  if (server_name_exact_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_exact_match->second, socket);
-  }
-
-  // Match on all wildcard domains, i.e. ".example.com" and ".com" for "www.example.com".
-  size_t pos = server_name.find('.', 1);
-  while (pos < server_name.size() - 1 && pos != std::string::npos) {
-    const std::string wildcard = server_name.substr(pos);
-    const auto server_name_wildcard_match = server_names_map.find(wildcard);
-    if (server_name_wildcard_match != server_names_map.end()) {
-      return findFilterChainForTransportProtocol(server_name_wildcard_match->second, socket);
-    }
-    pos = server_name.find('.', pos + 1);
-  }
-
-  // Match on a filter chain without server name requirements.
-  const auto server_name_catchall_match = server_names_map.find(EMPTY_STRING);
-  if (server_name_catchall_match != server_names_map.end()) {
-    return findFilterChainForTransportProtocol(server_name_catchall_match->second, socket);
+  // Match on exact server name, i.e. "www.example.com" for "www.example.com", then on the longest
+  // wildcard domain, i.e. ".example.com" or ".com" for "www.example.com", and finally on a filter
+  // chain without server name requirements.
+  const auto server_name_match = server_names_trie.find(socket.requestedServerName());
+  if (server_name_match != nullptr) {
+    return findFilterChainForTransportProtocol(*server_name_match, socket);
   }
 
   return nullptr;
@@ -466,18 +589,17 @@ ListenerImpl::findFilterChainForServerName(const ServerNamesMap& server_names_ma
 const Network::FilterChain* ListenerImpl::findFilterChainForTransportProtocol(
     const TransportProtocolsMap& transport_protocols_map,
     const Network::ConnectionSocket& socket) const {
-  const std::string transport_protocol(socket.detectedTransportProtocol());
-
   // Match on exact transport protocol, e.g. "tls".
-  const auto transport_protocol_match = transport_protocols_map.find(transport_protocol);
-  if (transport_protocol_match != transport_protocols_map.end()) {
-    return findFilterChainForApplicationProtocols(transport_protocol_match->second, socket);
+  const auto transport_protocol_match =
+      transport_protocols_map.find(socket.detectedTransportProtocol());
+  if (transport_protocol_match != nullptr) {
+    return findFilterChainForApplicationProtocols(*transport_protocol_match, socket);
   }
 
   // Match on a filter chain without transport protocol requirements.
   const auto any_protocol_match = transport_protocols_map.find(EMPTY_STRING);
-  if (any_protocol_match != transport_protocols_map.end()) {
-    return findFilterChainForApplicationProtocols(any_protocol_match->second, socket);
+  if (any_protocol_match != nullptr) {
+    return findFilterChainForApplicationProtocols(*any_protocol_match, socket);
   }
 
   return nullptr;
@@ -489,15 +611,15 @@ const Network::FilterChain* ListenerImpl::findFilterChainForApplicationProtocols
   // Match on exact application protocol, e.g. "h2" or "http/1.1".
   for (const auto& application_protocol : socket.requestedApplicationProtocols()) {
     const auto application_protocol_match = application_protocols_map.find(application_protocol);
-    if (application_protocol_match != application_protocols_map.end()) {
-      return application_protocol_match->second.get();
+    if (application_protocol_match != nullptr) {
+      return application_protocol_match->get();
     }
   }
 
   // Match on a filter chain without application protocol requirements.
   const auto any_protocol_match = application_protocols_map.find(EMPTY_STRING);
-  if (any_protocol_match != application_protocols_map.end()) {
-    return any_protocol_match->second.get();
+  if (any_protocol_match != nullptr) {
+    return any_protocol_match->get();
   }
 
   return nullptr;
@@ -513,6 +635,41 @@ bool ListenerImpl::createListenerFilterChain(Network::ListenerFilterManager& man
   return Configuration::FilterChainUtility::buildFilterChain(manager, listener_filter_factories_);
 }
 
+bool ListenerImpl::createUdpListenerFilterChain(Network::UdpListenerFilterManager& manager,
+                                                Network::UdpReadFilterCallbacks& callbacks) {
+  return Configuration::FilterChainUtility::buildUdpFilterChain(manager, callbacks,
+                                                                udp_listener_filter_factories_);
+}
+
+const FilterChainImpl* ListenerImpl::findFilterChainByHash(uint64_t hash) const {
+  const auto it = filter_chains_by_hash_.find(hash);
+  return it != filter_chains_by_hash_.end() ? it->second.get() : nullptr;
+}
+
+std::unordered_set<const Network::FilterChain*>
+ListenerImpl::filterChainsMissingFrom(const ListenerImpl& other) const {
+  std::unordered_set<const Network::FilterChain*> missing;
+  for (const auto& entry : filter_chains_by_hash_) {
+    if (other.findFilterChainByHash(entry.first) == nullptr) {
+      missing.insert(entry.second.get());
+    }
+  }
+  return missing;
+}
+
+void ListenerImpl::startFilterChainDrainSequence(
+    const std::unordered_set<const Network::FilterChain*>& filter_chains,
+    std::function<void()> completion) {
+  ASSERT(filter_chain_drain_manager_ == nullptr);
+  filter_chain_drain_manager_ = parent_.factory_.createDrainManager(config_.drain_type());
+  for (const auto& entry : filter_chains_by_hash_) {
+    if (filter_chains.count(entry.second.get()) > 0) {
+      entry.second->factoryContext().startDraining();
+    }
+  }
+  filter_chain_drain_manager_->startDrainSequence(completion);
+}
+
 bool ListenerImpl::drainClose() const {
   // When a listener is draining, the "drain close" decision is the union of the per-listener drain
   // manager and the server wide drain manager. This allows individual listeners to be drained and
@@ -552,9 +709,35 @@ void ListenerImpl::setSocket(const Network::SocketSharedPtr& socket) {
   ASSERT(!socket_);
   socket_ = socket;
   // Server config validation sets nullptr sockets.
-  if (socket_ && listen_socket_options_) {
+  if (socket_) {
+    applyListenSocketOptions(*socket_);
+  }
+}
+
+void ListenerImpl::setWorkerSockets(const std::vector<Network::SocketSharedPtr>& sockets) {
+  ASSERT(reuse_port_ || sockets.empty());
+  ASSERT(worker_sockets_.empty());
+  worker_sockets_ = sockets;
+  for (const auto& socket : worker_sockets_) {
+    if (socket) {
+      applyListenSocketOptions(*socket);
+    }
+    worker_configs_.emplace_back(new WorkerListenerConfig(*this, socket));
+  }
+}
+
+Network::ListenerConfig* ListenerImpl::workerConfig(uint32_t worker_index) {
+  if (!reuse_port_ || worker_index == 0) {
+    return this;
+  }
+  return worker_index <= worker_configs_.size() ? worker_configs_[worker_index - 1].get()
+                                                : nullptr;
+}
+
+void ListenerImpl::applyListenSocketOptions(Network::Socket& socket) {
+  if (listen_socket_options_) {
     // 'pre_bind = false' as bind() is never done after this.
-    bool ok = Network::Socket::applyOptions(listen_socket_options_, *socket_,
+    bool ok = Network::Socket::applyOptions(listen_socket_options_, socket,
                                             envoy::api::v2::core::SocketOption::STATE_BOUND);
     const std::string message =
         fmt::format("{}: Setting socket options {}", name_, ok ? "succeeded" : "failed");
@@ -565,9 +748,9 @@ void ListenerImpl::setSocket(const Network::SocketSharedPtr& socket) {
       ENVOY_LOG(debug, "{}", message);
     }
 
-    // Add the options to the socket_ so that STATE_LISTENING options can be
+    // Add the options to the socket so that STATE_LISTENING options can be
     // set in the worker after listen()/evconnlistener_new() is called.
-    socket_->addOptions(listen_socket_options_);
+    socket.addOptions(listen_socket_options_);
   }
 }
 
@@ -579,7 +762,7 @@ ListenerManagerImpl::ListenerManagerImpl(Instance& server,
       config_tracker_entry_(server.admin().getConfigTracker().add(
           "listeners", [this] { return dumpListenerConfigs(); })) {
   for (uint32_t i = 0; i < server.options().concurrency(); i++) {
-    workers_.emplace_back(worker_factory.createWorker());
+    workers_.emplace_back(worker_factory.createWorker(server.overloadManager()));
   }
 }
 
@@ -669,17 +852,40 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     throw EnvoyException(message);
   }
 
+  // The sockets are carried over from the existing listener, so neither may the socket layout.
+  if ((existing_warming_listener != warming_listeners_.end() &&
+       (*existing_warming_listener)->reusePort() != new_listener->reusePort()) ||
+      (existing_active_listener != active_listeners_.end() &&
+       (*existing_active_listener)->reusePort() != new_listener->reusePort())) {
+    const std::string message =
+        fmt::format("error updating listener: '{}' cannot change reuse_port of existing listener",
+                    name);
+    ENVOY_LOG(warn, "{}", message);
+    throw EnvoyException(message);
+  }
+  if ((existing_warming_listener != warming_listeners_.end() &&
+       (*existing_warming_listener)->socketType() != new_listener->socketType()) ||
+      (existing_active_listener != active_listeners_.end() &&
+       (*existing_active_listener)->socketType() != new_listener->socketType())) {
+    const std::string message = fmt::format(
+        "error updating listener: '{}' cannot change protocol of existing listener", name);
+    ENVOY_LOG(warn, "{}", message);
+    throw EnvoyException(message);
+  }
+
   bool added = false;
   if (existing_warming_listener != warming_listeners_.end()) {
     // In this case we can just replace inline.
     ASSERT(workers_started_);
     new_listener->debugLog("update warming listener");
     new_listener->setSocket((*existing_warming_listener)->getSocket());
+    new_listener->setWorkerSockets((*existing_warming_listener)->getWorkerSockets());
     *existing_warming_listener = std::move(new_listener);
   } else if (existing_active_listener != active_listeners_.end()) {
     // In this case we have no warming listener, so what we do depends on whether workers
     // have been started or not. Either way we get the socket from the existing listener.
     new_listener->setSocket((*existing_active_listener)->getSocket());
+    new_listener->setWorkerSockets((*existing_active_listener)->getWorkerSockets());
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -708,21 +914,19 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     // to see if there is a listener that has a socket bound to the address we are configured for.
     // This is an edge case, but may happen if a listener is removed and then added back with a same
     // or different name and intended to listen on the same address. This should work and not fail.
-    Network::SocketSharedPtr draining_listener_socket;
     auto existing_draining_listener = std::find_if(
         draining_listeners_.cbegin(), draining_listeners_.cend(),
         [&new_listener](const DrainingListener& listener) {
-          return *new_listener->address() == *listener.listener_->socket().localAddress();
+          return *new_listener->address() == *listener.listener_->socket().localAddress() &&
+                 new_listener->reusePort() == listener.listener_->reusePort() &&
+                 new_listener->socketType() == listener.listener_->socketType();
         });
     if (existing_draining_listener != draining_listeners_.cend()) {
-      draining_listener_socket = existing_draining_listener->listener_->getSocket();
+      new_listener->setSocket(existing_draining_listener->listener_->getSocket());
+      new_listener->setWorkerSockets(existing_draining_listener->listener_->getWorkerSockets());
+    } else {
+      createListenSockets(*new_listener);
     }
-
-    new_listener->setSocket(draining_listener_socket
-                                ? draining_listener_socket
-                                : factory_.createListenSocket(new_listener->address(),
-                                                              new_listener->listenSocketOptions(),
-                                                              new_listener->bindToPort()));
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -745,6 +949,62 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
   return true;
 }
 
+void ListenerManagerImpl::createListenSockets(ListenerImpl& listener) {
+  if (listener.socketType() == Network::Address::SocketType::Datagram) {
+    ASSERT(listener.reusePort());
+    listener.setSocket(factory_.createUdpListenSocket(
+        listener.address(), workerListenSocketOptions(listener, 0), 0));
+    const Network::Address::InstanceConstSharedPtr address =
+        listener.getSocket() ? listener.getSocket()->localAddress() : listener.address();
+    std::vector<Network::SocketSharedPtr> worker_sockets;
+    for (uint32_t worker_index = 1; worker_index < workers_.size(); worker_index++) {
+      worker_sockets.push_back(factory_.createUdpListenSocket(
+          address, workerListenSocketOptions(listener, worker_index), worker_index));
+    }
+    listener.setWorkerSockets(worker_sockets);
+    return;
+  }
+
+  if (!listener.reusePort()) {
+    listener.setSocket(factory_.createListenSocket(
+        listener.address(), listener.listenSocketOptions(), listener.bindToPort()));
+    return;
+  }
+
+  // The first socket belongs to the first worker.
+  listener.setSocket(factory_.createListenSocket(
+      listener.address(), workerListenSocketOptions(listener, 0), listener.bindToPort()));
+
+  // Every worker gets its own socket bound to the same address. If the configured address binds
+  // to port zero, use the port the OS picked for the first socket.
+  const Network::Address::InstanceConstSharedPtr address =
+      listener.getSocket() ? listener.getSocket()->localAddress() : listener.address();
+  std::vector<Network::SocketSharedPtr> worker_sockets;
+  for (uint32_t worker_index = 1; worker_index < workers_.size(); worker_index++) {
+    worker_sockets.push_back(factory_.createWorkerListenSocket(
+        address, workerListenSocketOptions(listener, worker_index), worker_index));
+  }
+  listener.setWorkerSockets(worker_sockets);
+}
+
+Network::Socket::OptionsSharedPtr
+ListenerManagerImpl::workerListenSocketOptions(ListenerImpl& listener, uint32_t worker_index) {
+  const std::vector<uint32_t>& cpus = server_.options().workerCpuAffinity();
+  if (cpus.empty()) {
+    return listener.listenSocketOptions();
+  }
+
+  // With SO_INCOMING_CPU the kernel prefers the REUSEPORT socket of the worker pinned to the CPU
+  // that received the connection, i.e. the CPU handling the NIC queue's interrupts, so that the
+  // connection is processed on the same CPU and NUMA node as its packets.
+  auto options = std::make_shared<Network::Socket::Options>();
+  Network::Socket::appendOptions(options, listener.listenSocketOptions());
+  Network::Socket::appendOptions(
+      options, Network::SocketOptionFactory::buildIncomingCpuOptions(
+                   cpus[worker_index % cpus.size()]));
+  return options;
+}
+
 bool ListenerManagerImpl::hasListenerWithAddress(const ListenerList& list,
                                                  const Network::Address::Instance& address) {
   for (const auto& listener : list) {
@@ -795,6 +1055,49 @@ void ListenerManagerImpl::drainListener(ListenerImplPtr&& listener) {
   updateWarmingActiveGauges();
 }
 
+void ListenerManagerImpl::drainFilterChains(ListenerImplPtr&& listener,
+                                            const ListenerImpl& replacement) {
+  const std::unordered_set<const Network::FilterChain*> removed_filter_chains =
+      listener->filterChainsMissingFrom(replacement);
+
+  std::list<DrainingListener>::iterator draining_it = draining_listeners_.emplace(
+      draining_listeners_.begin(), std::move(listener), workers_.size());
+  stats_.total_listeners_draining_.set(draining_listeners_.size());
+
+  // New connections are accepted by the replacement. Connections of filter chains that the
+  // replacement kept stay open on the stopped listener, so only the removed filter chains drain.
+  draining_it->listener_->debugLog("draining removed filter chains");
+  for (const auto& worker : workers_) {
+    worker->stopListener(*draining_it->listener_);
+  }
+
+  draining_it->listener_->startFilterChainDrainSequence(
+      removed_filter_chains, [this, draining_it, removed_filter_chains]() -> void {
+        draining_it->listener_->debugLog("removing filter chains");
+        for (const auto& worker : workers_) {
+          // The worker closes the connections of the removed filter chains, and removes the
+          // listener once the connections of the kept filter chains have closed as well.
+          worker->removeFilterChains(
+              *draining_it->listener_, removed_filter_chains, [this, draining_it]() -> void {
+                server_.dispatcher().post([this, draining_it]() -> void {
+                  if (--draining_it->workers_pending_removal_ == 0) {
+                    draining_it->listener_->debugLog("listener removal complete");
+                    draining_listeners_.erase(draining_it);
+                    stats_.total_listeners_draining_.set(draining_listeners_.size());
+                  }
+                });
+              });
+        }
+      });
+
+  updateWarmingActiveGauges();
+}
+
+const ListenerImpl* ListenerManagerImpl::activeListenerByName(const std::string& name) {
+  auto it = getListenerByName(active_listeners_, name);
+  return it != active_listeners_.end() ? it->get() : nullptr;
+}
+
 ListenerManagerImpl::ListenerList::iterator
 ListenerManagerImpl::getListenerByName(ListenerList& listeners, const std::string& name) {
   auto ret = listeners.end();
@@ -818,8 +1121,24 @@ std::vector<std::reference_wrapper<Network::ListenerConfig>> ListenerManagerImpl
   return ret;
 }
 
-void ListenerManagerImpl::addListenerToWorker(Worker& worker, ListenerImpl& listener) {
-  worker.addListener(listener, [this, &listener](bool success) -> void {
+std::vector<std::reference_wrapper<Network::ListenerConfig>>
+ListenerManagerImpl::workerListeners(uint32_t worker_index) {
+  std::vector<std::reference_wrapper<Network::ListenerConfig>> ret;
+  ret.reserve(active_listeners_.size());
+  for (const auto& listener : active_listeners_) {
+    Network::ListenerConfig* config = listener->workerConfig(worker_index);
+    if (config != nullptr) {
+      ret.push_back(*config);
+    }
+  }
+  return ret;
+}
+
+void ListenerManagerImpl::addListenerToWorker(Worker& worker, uint32_t worker_index,
+                                              ListenerImpl& listener) {
+  Network::ListenerConfig* config = listener.workerConfig(worker_index);
+  ASSERT(config != nullptr);
+  worker.addListener(*config, [this, &listener](bool success) -> void {
     // The add listener completion runs on the worker thread. Post back to the main thread to
     // avoid locking.
     server_.dispatcher().post([this, success, &listener]() -> void {
@@ -847,15 +1166,20 @@ void ListenerManagerImpl::addListenerToWorker(Worker& worker, ListenerImpl& list
 void ListenerManagerImpl::onListenerWarmed(ListenerImpl& listener) {
   // The warmed listener should be added first so that the worker will accept new connections
   // when it stops listening on the old listener.
+  uint32_t worker_index = 0;
   for (const auto& worker : workers_) {
-    addListenerToWorker(*worker, listener);
+    addListenerToWorker(*worker, worker_index++, listener);
   }
 
   auto existing_active_listener = getListenerByName(active_listeners_, listener.name());
   auto existing_warming_listener = getListenerByName(warming_listeners_, listener.name());
   (*existing_warming_listener)->debugLog("warm complete. updating active listener");
   if (existing_active_listener != active_listeners_.end()) {
-    drainListener(std::move(*existing_active_listener));
+    if ((*existing_active_listener)->onlyFilterChainsDiffer(listener)) {
+      drainFilterChains(std::move(*existing_active_listener), listener);
+    } else {
+      drainListener(std::move(*existing_active_listener));
+    }
     *existing_active_listener = std::move(*existing_warming_listener);
   } else {
     active_listeners_.emplace_back(std::move(*existing_warming_listener));
@@ -908,12 +1232,14 @@ void ListenerManagerImpl::startWorkers(GuardDog& guard_dog) {
   ENVOY_LOG(info, "all dependencies initialized. starting workers");
   ASSERT(!workers_started_);
   workers_started_ = true;
+  uint32_t worker_index = 0;
   for (const auto& worker : workers_) {
     ASSERT(warming_listeners_.empty());
     for (const auto& listener : active_listeners_) {
-      addListenerToWorker(*worker, *listener);
+      addListenerToWorker(*worker, worker_index, *listener);
     }
     worker->start(guard_dog);
+    worker_index++;
   }
 }
 
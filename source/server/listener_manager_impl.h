@@ -1,6 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "envoy/api/v2/listener/listener.pb.h"
 #include "envoy/network/filter.h"
@@ -15,6 +19,7 @@
 #include "common/network/cidr_range.h"
 #include "common/network/lc_trie.h"
 
+#include "server/filter_chain_matcher.h"
 #include "server/init_manager_impl.h"
 #include "server/lds_api.h"
 
@@ -43,6 +48,12 @@ public:
   static std::vector<Network::ListenerFilterFactoryCb> createListenerFilterFactoryList_(
       const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
       Configuration::ListenerFactoryContext& context);
+  /**
+   * Static worker for createUdpListenerFilterFactoryList() that can be used directly in tests.
+   */
+  static std::vector<Network::UdpListenerFilterFactoryCb> createUdpListenerFilterFactoryList_(
+      const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
+      Configuration::ListenerFactoryContext& context);
 
   // Server::ListenerComponentFactory
   LdsApiPtr createLdsApi(const envoy::api::v2::core::ConfigSource& lds_config) override {
@@ -60,13 +71,31 @@ public:
       Configuration::ListenerFactoryContext& context) override {
     return createListenerFilterFactoryList_(filters, context);
   }
+  std::vector<Network::UdpListenerFilterFactoryCb> createUdpListenerFilterFactoryList(
+      const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>& filters,
+      Configuration::ListenerFactoryContext& context) override {
+    return createUdpListenerFilterFactoryList_(filters, context);
+  }
   Network::SocketSharedPtr createListenSocket(Network::Address::InstanceConstSharedPtr address,
                                               const Network::Socket::OptionsSharedPtr& options,
                                               bool bind_to_port) override;
+  Network::SocketSharedPtr
+  createWorkerListenSocket(Network::Address::InstanceConstSharedPtr address,
+                           const Network::Socket::OptionsSharedPtr& options,
+                           uint32_t worker_index) override;
+  Network::SocketSharedPtr
+  createUdpListenSocket(Network::Address::InstanceConstSharedPtr address,
+                        const Network::Socket::OptionsSharedPtr& options,
+                        uint32_t worker_index) override;
   DrainManagerPtr createDrainManager(envoy::api::v2::Listener::DrainType drain_type) override;
   uint64_t nextListenerTag() override { return next_listener_tag_++; }
 
 private:
+  Network::SocketSharedPtr
+  createTcpListenSocket(Network::Address::InstanceConstSharedPtr address,
+                        const Network::Socket::OptionsSharedPtr& options, bool bind_to_port,
+                        uint32_t worker_index);
+
   Instance& server_;
   uint64_t next_listener_tag_{1};
 };
@@ -106,6 +135,12 @@ public:
 
   void onListenerWarmed(ListenerImpl& listener);
 
+  /**
+   * @return const ListenerImpl* the active listener with the given name, or nullptr. An update of
+   *         that listener may reuse parts of its unchanged filter chains.
+   */
+  const ListenerImpl* activeListenerByName(const std::string& name);
+
   // Server::ListenerManager
   bool addOrUpdateListener(const envoy::api::v2::Listener& config, const std::string& version_info,
                            bool modifiable) override;
@@ -114,6 +149,8 @@ public:
     lds_api_ = factory_.createLdsApi(lds_config);
   }
   std::vector<std::reference_wrapper<Network::ListenerConfig>> listeners() override;
+  std::vector<std::reference_wrapper<Network::ListenerConfig>>
+  workerListeners(uint32_t worker_index) override;
   uint64_t numConnections() override;
   bool removeListener(const std::string& listener_name) override;
   void startWorkers(GuardDog& guard_dog) override;
@@ -135,7 +172,8 @@ private:
     uint64_t workers_pending_removal_;
   };
 
-  void addListenerToWorker(Worker& worker, ListenerImpl& listener);
+  void addListenerToWorker(Worker& worker, uint32_t worker_index, ListenerImpl& listener);
+  void createListenSockets(ListenerImpl& listener);
   ProtobufTypes::MessagePtr dumpListenerConfigs();
   static ListenerManagerStats generateStats(Stats::Scope& scope);
   static bool hasListenerWithAddress(const ListenerList& list,
@@ -154,6 +192,24 @@ private:
    */
   void drainListener(ListenerImplPtr&& listener);
 
+  /**
+   * @return Network::Socket::OptionsSharedPtr the options of a worker's REUSEPORT listen socket.
+   *         When workers are pinned to CPUs, the socket is steered to connections received on the
+   *         worker's CPU.
+   */
+  Network::Socket::OptionsSharedPtr workerListenSocketOptions(ListenerImpl& listener,
+                                                              uint32_t worker_index);
+
+  /**
+   * Mark a listener for draining after it has been replaced by a listener that only differs in its
+   * filter chains. Only connections of the filter chains that the replacement changed or removed
+   * are drained and closed. The listener is removed once its remaining connections have closed on
+   * their own.
+   * @param listener supplies the listener to drain.
+   * @param replacement supplies the listener replacing it.
+   */
+  void drainFilterChains(ListenerImplPtr&& listener, const ListenerImpl& replacement);
+
   /**
    * Get a listener by name. This routine is used because listeners have inherent order in static
    * configuration and especially for tests. Thus, we can't use a map.
@@ -180,6 +236,8 @@ private:
   LdsApiPtr lds_api_;
 };
 
+class FilterChainImpl;
+
 // TODO(mattklein123): Consider getting rid of pre-worker start and post-worker start code by
 //                     initializing all listeners after workers are started.
 
@@ -215,6 +273,42 @@ public:
   bool blockUpdate(uint64_t new_hash) { return new_hash == hash_ || !modifiable_; }
   bool blockRemove() { return !modifiable_; }
 
+  /**
+   * @return bool whether the listener's configuration equals the other listener's apart from the
+   *         filter chains, so that connections of filter chains both have in common can be kept.
+   */
+  bool onlyFilterChainsDiffer(const ListenerImpl& other) const {
+    return hash_without_filter_chains_ == other.hash_without_filter_chains_;
+  }
+
+  /**
+   * @return const FilterChainImpl* the filter chain whose configuration has the given hash, or
+   *         nullptr.
+   */
+  const FilterChainImpl* findFilterChainByHash(uint64_t hash) const;
+
+  /**
+   * @return std::unordered_set<const Network::FilterChain*> the filter chains of this listener that
+   *         the other listener does not have with the same configuration.
+   */
+  std::unordered_set<const Network::FilterChain*>
+  filterChainsMissingFrom(const ListenerImpl& other) const;
+
+  /**
+   * Start draining the connections of some of the listener's filter chains.
+   * @param filter_chains supplies the filter chains to drain.
+   * @param completion supplies the completion called once the drain time has passed.
+   */
+  void startFilterChainDrainSequence(
+      const std::unordered_set<const Network::FilterChain*>& filter_chains,
+      std::function<void()> completion);
+
+  /**
+   * @return bool whether connections of filter chains drained by startFilterChainDrainSequence()
+   *         should be closed.
+   */
+  bool filterChainDrainClose() const { return filter_chain_drain_manager_->drainClose(); }
+
   /**
    * Called when a listener failed to be actually created on a worker.
    * @return TRUE if we have seen more than one worker failure.
@@ -233,6 +327,18 @@ public:
   DrainManager& localDrainManager() const { return *local_drain_manager_; }
   void setSocket(const Network::SocketSharedPtr& socket);
   void setSocketAndOptions(const Network::SocketSharedPtr& socket);
+  bool reusePort() const { return reuse_port_; }
+  const std::vector<Network::SocketSharedPtr>& getWorkerSockets() const { return worker_sockets_; }
+  /**
+   * Set the sockets of the second and subsequent workers, for a listener with a separate
+   * SO_REUSEPORT socket per worker. The first worker uses the socket from setSocket().
+   */
+  void setWorkerSockets(const std::vector<Network::SocketSharedPtr>& sockets);
+  /**
+   * @return Network::ListenerConfig* the listener as seen by the given worker, or nullptr if the
+   *         listener has a separate socket per worker but none for this worker.
+   */
+  Network::ListenerConfig* workerConfig(uint32_t worker_index);
   const Network::Socket::OptionsSharedPtr& listenSocketOptions() { return listen_socket_options_; }
   const std::string& versionInfo() { return version_info_; }
 
@@ -240,14 +346,21 @@ public:
   Network::FilterChainManager& filterChainManager() override { return *this; }
   Network::FilterChainFactory& filterChainFactory() override { return *this; }
   Network::Socket& socket() override { return *socket_; }
+  Network::Address::SocketType socketType() const override { return socket_type_; }
   bool bindToPort() override { return bind_to_port_; }
   bool handOffRestoredDestinationConnections() const override {
     return hand_off_restored_destination_connections_;
   }
   uint32_t perConnectionBufferLimitBytes() override { return per_connection_buffer_limit_bytes_; }
+  uint32_t perConnectionBufferLimitMaxBytes() override {
+    return per_connection_buffer_limit_max_bytes_;
+  }
   Stats::Scope& listenerScope() override { return *listener_scope_; }
   uint64_t listenerTag() const override { return listener_tag_; }
   const std::string& name() const override { return name_; }
+  Network::ConnectionBalancer& connectionBalancer() override { return *connection_balancer_; }
+  const Network::AcceptLimits& acceptLimits() const override { return accept_limits_; }
+  bool tcpQuickAck() const override { return tcp_quick_ack_; }
 
   // Server::Configuration::ListenerFactoryContext
   AccessLog::AccessLogManager& accessLogManager() override {
@@ -301,19 +414,58 @@ public:
   bool createNetworkFilterChain(Network::Connection& connection,
                                 const std::vector<Network::FilterFactoryCb>& factories) override;
   bool createListenerFilterChain(Network::ListenerFilterManager& manager) override;
+  bool createUdpListenerFilterChain(Network::UdpListenerFilterManager& manager,
+                                    Network::UdpReadFilterCallbacks& callbacks) override;
 
   SystemTime last_updated_;
 
 private:
-  typedef std::unordered_map<std::string, Network::FilterChainSharedPtr> ApplicationProtocolsMap;
-  typedef std::unordered_map<std::string, ApplicationProtocolsMap> TransportProtocolsMap;
+  // The listener as seen by the second and subsequent workers when it has a separate SO_REUSEPORT
+  // socket per worker. Only the socket differs from the listener itself.
+  class WorkerListenerConfig : public Network::ListenerConfig {
+  public:
+    WorkerListenerConfig(ListenerImpl& parent, const Network::SocketSharedPtr& socket)
+        : parent_(parent), socket_(socket) {}
+
+    // Network::ListenerConfig
+    Network::FilterChainManager& filterChainManager() override { return parent_; }
+    Network::FilterChainFactory& filterChainFactory() override { return parent_; }
+    Network::Socket& socket() override { return *socket_; }
+    Network::Address::SocketType socketType() const override { return parent_.socketType(); }
+    bool bindToPort() override { return parent_.bindToPort(); }
+    bool handOffRestoredDestinationConnections() const override {
+      return parent_.handOffRestoredDestinationConnections();
+    }
+    uint32_t perConnectionBufferLimitBytes() override {
+      return parent_.perConnectionBufferLimitBytes();
+    }
+    uint32_t perConnectionBufferLimitMaxBytes() override {
+      return parent_.perConnectionBufferLimitMaxBytes();
+    }
+    Stats::Scope& listenerScope() override { return parent_.listenerScope(); }
+    uint64_t listenerTag() const override { return parent_.listenerTag(); }
+    const std::string& name() const override { return parent_.name(); }
+    Network::ConnectionBalancer& connectionBalancer() override {
+      return parent_.connectionBalancer();
+    }
+    const Network::AcceptLimits& acceptLimits() const override { return parent_.acceptLimits(); }
+    bool tcpQuickAck() const override { return parent_.tcpQuickAck(); }
+
+  private:
+    ListenerImpl& parent_;
+    const Network::SocketSharedPtr socket_;
+  };
+
+  typedef ProtocolMap<Network::FilterChainSharedPtr> ApplicationProtocolsMap;
+  typedef ProtocolMap<ApplicationProtocolsMap> TransportProtocolsMap;
   // Both exact server names and wildcard domains are part of the same map, in which wildcard
   // domains are prefixed with "." (i.e. ".example.com" for "*.example.com") to differentiate
-  // between exact and wildcard entries.
+  // between exact and wildcard entries. Each map is compiled into a ServerNamesTrie for lookups.
   typedef std::unordered_map<std::string, TransportProtocolsMap> ServerNamesMap;
   typedef std::unordered_map<std::string, ServerNamesMap> DestinationIPsMap;
-  typedef std::shared_ptr<ServerNamesMap> ServerNamesMapSharedPtr;
-  typedef Network::LcTrie::LcTrie<ServerNamesMapSharedPtr> DestinationIPsTrie;
+  typedef ServerNameTrie<TransportProtocolsMap> ServerNamesTrie;
+  typedef std::shared_ptr<const ServerNamesTrie> ServerNamesTrieSharedPtr;
+  typedef Network::LcTrie::LcTrie<ServerNamesTrieSharedPtr> DestinationIPsTrie;
   typedef std::unique_ptr<DestinationIPsTrie> DestinationIPsTriePtr;
   typedef std::unordered_map<uint16_t, std::pair<DestinationIPsMap, DestinationIPsTriePtr>>
       DestinationPortsMap;
@@ -322,8 +474,7 @@ private:
                       const std::vector<std::string>& server_names,
                       const std::string& transport_protocol,
                       const std::vector<std::string>& application_protocols,
-                      Network::TransportSocketFactoryPtr&& transport_socket_factory,
-                      std::vector<Network::FilterFactoryCb> filters_factory);
+                      const std::shared_ptr<FilterChainImpl>& filter_chain);
   void addFilterChainForDestinationPorts(DestinationPortsMap& destination_ports_map,
                                          uint16_t destination_port,
                                          const std::vector<std::string>& destination_ips,
@@ -352,7 +503,7 @@ private:
   findFilterChainForDestinationIP(const DestinationIPsTrie& destination_ips_trie,
                                   const Network::ConnectionSocket& socket) const;
   const Network::FilterChain*
-  findFilterChainForServerName(const ServerNamesMap& server_names_map,
+  findFilterChainForServerName(const ServerNamesTrie& server_names_trie,
                                const Network::ConnectionSocket& socket) const;
   const Network::FilterChain*
   findFilterChainForTransportProtocol(const TransportProtocolsMap& transport_protocols_map,
@@ -362,6 +513,7 @@ private:
                                          const Network::ConnectionSocket& socket) const;
 
   static bool isWildcardServerName(const std::string& name);
+  void applyListenSocketOptions(Network::Socket& socket);
 
   // Mapping of FilterChain's configured destination ports, IPs, server names, transport protocols
   // and application protocols, using structures defined above.
@@ -370,32 +522,120 @@ private:
   ListenerManagerImpl& parent_;
   Network::Address::InstanceConstSharedPtr address_;
   Network::SocketSharedPtr socket_;
-  Stats::ScopePtr global_scope_;   // Stats with global named scope, but needed for LDS cleanup.
-  Stats::ScopePtr listener_scope_; // Stats with listener named scope.
+  std::vector<Network::SocketSharedPtr> worker_sockets_;
+  std::vector<std::unique_ptr<WorkerListenerConfig>> worker_configs_;
+  Network::ConnectionBalancerPtr connection_balancer_;
+  Network::AcceptLimits accept_limits_;
+  Stats::ScopePtr global_scope_; // Stats with global named scope, but needed for LDS cleanup.
+  // Stats with listener named scope. Shared with the transport socket factories created in it,
+  // which filter chains of later versions of the listener may reuse.
+  Stats::ScopeSharedPtr listener_scope_;
+  const Network::Address::SocketType socket_type_;
   const bool bind_to_port_;
+  const bool reuse_port_;
   const bool hand_off_restored_destination_connections_;
   const uint32_t per_connection_buffer_limit_bytes_;
+  const uint32_t per_connection_buffer_limit_max_bytes_;
+  const bool tcp_quick_ack_;
   const uint64_t listener_tag_;
   const std::string name_;
   const bool modifiable_;
   const bool workers_started_;
   const uint64_t hash_;
+  const uint64_t hash_without_filter_chains_;
   InitManagerImpl dynamic_init_manager_;
   bool initialize_canceled_{};
   std::vector<Network::ListenerFilterFactoryCb> listener_filter_factories_;
+  std::vector<Network::UdpListenerFilterFactoryCb> udp_listener_filter_factories_;
   DrainManagerPtr local_drain_manager_;
+  // Only set by startFilterChainDrainSequence().
+  DrainManagerPtr filter_chain_drain_manager_;
+  // Filter chains by the hash of their configuration.
+  std::unordered_map<uint64_t, std::shared_ptr<FilterChainImpl>> filter_chains_by_hash_;
   bool saw_listener_create_failure_{};
   const envoy::api::v2::Listener config_;
   const std::string version_info_;
   Network::Socket::OptionsSharedPtr listen_socket_options_;
 };
 
+/**
+ * Factory context for the network filters of a filter chain. It is the listener's context, except
+ * that connections are also drained when only the filter chain is drained, after a listener update
+ * changed or removed it.
+ */
+class FilterChainFactoryContextImpl : public Configuration::FactoryContext,
+                                      public Network::DrainDecision {
+public:
+  FilterChainFactoryContextImpl(ListenerImpl& listener) : listener_(listener) {}
+
+  /**
+   * Drain the filter chain's connections along with the listener's filter chain drain sequence.
+   * @see ListenerImpl::startFilterChainDrainSequence().
+   */
+  void startDraining() { draining_ = true; }
+
+  // Server::Configuration::FactoryContext
+  AccessLog::AccessLogManager& accessLogManager() override { return listener_.accessLogManager(); }
+  Upstream::ClusterManager& clusterManager() override { return listener_.clusterManager(); }
+  Event::Dispatcher& dispatcher() override { return listener_.dispatcher(); }
+  Network::DrainDecision& drainDecision() override { return *this; }
+  bool healthCheckFailed() override { return listener_.healthCheckFailed(); }
+  Tracing::HttpTracer& httpTracer() override { return listener_.httpTracer(); }
+  Init::Manager& initManager() override { return listener_.initManager(); }
+  const LocalInfo::LocalInfo& localInfo() const override { return listener_.localInfo(); }
+  Envoy::Runtime::RandomGenerator& random() override { return listener_.random(); }
+  RateLimit::ClientPtr
+  rateLimitClient(const absl::optional<std::chrono::milliseconds>& timeout) override {
+    return listener_.rateLimitClient(timeout);
+  }
+  Envoy::Runtime::Loader& runtime() override { return listener_.runtime(); }
+  Stats::Scope& scope() override { return listener_.scope(); }
+  Singleton::Manager& singletonManager() override { return listener_.singletonManager(); }
+  OverloadManager& overloadManager() override { return listener_.overloadManager(); }
+  ThreadLocal::Instance& threadLocal() override { return listener_.threadLocal(); }
+  Admin& admin() override { return listener_.admin(); }
+  Stats::Scope& listenerScope() override { return listener_.listenerScope(); }
+  const envoy::api::v2::core::Metadata& listenerMetadata() const override {
+    return listener_.listenerMetadata();
+  }
+  TimeSource& timeSource() override { return listener_.timeSource(); }
+
+  // Network::DrainDecision
+  bool drainClose() const override {
+    return (draining_ && listener_.filterChainDrainClose()) || listener_.drainClose();
+  }
+
+private:
+  ListenerImpl& listener_;
+  // Set on the main thread and read by the workers.
+  std::atomic<bool> draining_{};
+};
+
 class FilterChainImpl : public Network::FilterChain {
 public:
-  FilterChainImpl(Network::TransportSocketFactoryPtr&& transport_socket_factory,
+  /**
+   * @param hash supplies the hash of the filter chain's configuration.
+   * @param transport_socket_scope supplies the scope the transport socket factory was created in.
+   * @param transport_socket_factory supplies the transport socket factory, which may be shared
+   *        with a filter chain of an earlier version of the listener.
+   * @param factory_context supplies the context the network filter factories were created in.
+   * @param filters_factory supplies the network filter factories.
+   */
+  FilterChainImpl(uint64_t hash, const Stats::ScopeSharedPtr& transport_socket_scope,
+                  const std::shared_ptr<Network::TransportSocketFactory>& transport_socket_factory,
+                  std::unique_ptr<FilterChainFactoryContextImpl>&& factory_context,
                   std::vector<Network::FilterFactoryCb> filters_factory)
-      : transport_socket_factory_(std::move(transport_socket_factory)),
-        filters_factory_(std::move(filters_factory)) {}
+      : hash_(hash), transport_socket_scope_(transport_socket_scope),
+        transport_socket_factory_(transport_socket_factory),
+        factory_context_(std::move(factory_context)), filters_factory_(std::move(filters_factory)) {
+  }
+
+  uint64_t hash() const { return hash_; }
+  const Stats::ScopeSharedPtr& transportSocketScope() const { return transport_socket_scope_; }
+  const std::shared_ptr<Network::TransportSocketFactory>& sharedTransportSocketFactory() const {
+    return transport_socket_factory_;
+  }
+  FilterChainFactoryContextImpl& factoryContext() { return *factory_context_; }
 
   // Network::FilterChain
   const Network::TransportSocketFactory& transportSocketFactory() const override {
@@ -407,7 +647,12 @@ public:
   }
 
 private:
-  const Network::TransportSocketFactoryPtr transport_socket_factory_;
+  const uint64_t hash_;
+  // Declared before the factory, which may use it until destroyed.
+  const Stats::ScopeSharedPtr transport_socket_scope_;
+  const std::shared_ptr<Network::TransportSocketFactory> transport_socket_factory_;
+  // Declared before the filter factories, which may use it until destroyed.
+  const std::unique_ptr<FilterChainFactoryContextImpl> factory_context_;
   const std::vector<Network::FilterFactoryCb> filters_factory_;
 };
 
@@ -8,6 +8,8 @@
 #include "common/common/fmt.h"
 #include "common/common/logger.h"
 #include "common/common/macros.h"
+#include "common/common/regex.h"
+#include "common/common/utility.h"
 #include "common/common/version.h"
 #include "common/protobuf/utility.h"
 
@@ -31,6 +33,31 @@
 #endif
 
 namespace Envoy {
+namespace {
+
+// Far beyond the CPU count of any host, and keeps bogus ranges from exhausting memory.
+constexpr uint64_t MaxCpu = 65535;
+
+// Parses a comma separated list of CPUs and inclusive CPU ranges, e.g. "0-3,8,10-11".
+bool parseCpuList(const std::string& cpu_list, std::vector<uint32_t>& cpus) {
+  for (absl::string_view entry : StringUtil::splitToken(cpu_list, ",")) {
+    const std::vector<absl::string_view> bounds = StringUtil::splitToken(entry, "-", true);
+    uint64_t first;
+    uint64_t last;
+    if (bounds.size() > 2 || !StringUtil::atoul(std::string(bounds[0]).c_str(), first) ||
+        !StringUtil::atoul(std::string(bounds.back()).c_str(), last) || first > last ||
+        last > MaxCpu) {
+      return false;
+    }
+    for (uint64_t cpu = first; cpu <= last; cpu++) {
+      cpus.push_back(cpu);
+    }
+  }
+  return true;
+}
+
+} // namespace
+
 OptionsImpl::OptionsImpl(int argc, const char* const* argv,
                          const HotRestartVersionCb& hot_restart_version_cb,
                          spdlog::level::level_enum default_log_level) {
@@ -53,6 +80,33 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
       "uint32_t", cmd);
   TCLAP::ValueArg<uint32_t> concurrency("", "concurrency", "# of worker threads to run", false,
                                         std::thread::hardware_concurrency(), "uint32_t", cmd);
+  TCLAP::ValueArg<std::string> worker_cpu_affinity(
+      "", "worker-cpu-affinity",
+      "Comma separated CPUs and CPU ranges (e.g. '0-3,8') to pin worker threads to, in order",
+      false, "", "string", cmd);
+  TCLAP::ValueArg<uint32_t> blocking_pool_threads(
+      "", "blocking-pool-threads",
+      "# of threads to do blocking file and crypto work on, 0 to do it inline", false, 2,
+      "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> tls_private_key_threads(
+      "", "tls-private-key-threads",
+      "# of threads to run TLS private key operations on, 0 to run them on the workers", false, 0,
+      "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> tls_session_cache_size(
+      "", "tls-session-cache-size",
+      "# of TLS sessions to share between all TLS contexts, 0 to not share sessions", false, 0,
+      "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> tls_lazy_server_contexts(
+      "", "tls-lazy-server-contexts",
+      "# of listener TLS contexts built on first use to keep, 0 to build them with the listener",
+      false, 0, "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> dns_cache_size(
+      "", "dns-cache-size", "# of DNS resolutions to cache for their TTL, 0 to not cache them",
+      false, 0, "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> dns_cache_max_stale(
+      "", "dns-cache-max-stale",
+      "Seconds to use cached DNS resolutions for after their TTL, while resolving them again",
+      false, 30, "uint32_t", cmd);
   TCLAP::ValueArg<std::string> config_path("c", "config-path", "Path to configuration file", false,
                                            "", "string", cmd);
   TCLAP::ValueArg<std::string> config_yaml(
@@ -81,6 +135,10 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
                                           Logger::Logger::DEFAULT_LOG_FORMAT, "string", cmd);
   TCLAP::ValueArg<std::string> log_path("", "log-path", "Path to logfile", false, "", "string",
                                         cmd);
+  TCLAP::ValueArg<uint32_t> log_ring_size(
+      "", "log-ring-size",
+      "# of log messages each thread buffers for a logging thread, 0 to log synchronously", false,
+      0, "uint32_t", cmd);
   TCLAP::ValueArg<uint32_t> restart_epoch("", "restart-epoch", "hot restart epoch #", false, 0,
                                           "uint32_t", cmd);
   TCLAP::SwitchArg hot_restart_version_option("", "hot-restart-version",
@@ -96,6 +154,15 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
                                                      10000, "uint32_t", cmd);
   TCLAP::ValueArg<uint32_t> drain_time_s("", "drain-time-s", "Hot restart drain time in seconds",
                                          false, 600, "uint32_t", cmd);
+  TCLAP::ValueArg<std::string> drain_curve(
+      "", "drain-curve",
+      "How the probability of drain closing connections grows over the drain time, one of "
+      "'linear' (default), 'quadratic' or 'immediate'",
+      false, "linear", "string", cmd);
+  TCLAP::ValueArg<uint32_t> drain_close_rate(
+      "", "drain-close-rate",
+      "Max # of connections each worker drain closes per second, 0 for no limit", false, 0,
+      "uint32_t", cmd);
   TCLAP::ValueArg<uint32_t> parent_shutdown_time_s("", "parent-shutdown-time-s",
                                                    "Hot restart parent shutdown time in seconds",
                                                    false, 900, "uint32_t", cmd);
@@ -115,6 +182,26 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
                                              cmd);
   TCLAP::SwitchArg disable_hot_restart("", "disable-hot-restart",
                                        "Disable hot restart functionality", cmd, false);
+  TCLAP::SwitchArg use_libevent_buffers("", "use-libevent-buffers",
+                                        "Use the original libevent buffer implementation", cmd,
+                                        false);
+  TCLAP::ValueArg<uint32_t> buffer_slab_pool_mb(
+      "", "buffer-slab-pool-mb",
+      "Size in MB of the huge page backed pool of buffer slices, 0 to allocate them from the heap",
+      false, 0, "uint32_t", cmd);
+  TCLAP::SwitchArg use_std_regex("", "use-std-regex",
+                                 "Compile configured regexes with std::regex instead of RE2", cmd,
+                                 false);
+  TCLAP::ValueArg<std::string> event_loop_backend(
+      "", "event-loop-backend", "Event loop backend: ['default', 'epoll_changelist']", false,
+      "default", "string", cmd);
+  TCLAP::ValueArg<uint64_t> read_budget_bytes(
+      "", "read-budget-bytes",
+      "Maximum bytes a connection reads per read event before yielding (0 for no limit)", false, 0,
+      "uint64_t", cmd);
+  TCLAP::ValueArg<uint32_t> max_regex_program_size(
+      "", "max-regex-program-size", "Maximum RE2 program size of configured regexes", false,
+      Regex::Utility::DefaultMaxProgramSize, "uint32_t", cmd);
 
   cmd.setExceptionHandling(false);
   try {
@@ -171,6 +258,30 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
     throw MalformedArgvException(message);
   }
 
+  if (drain_curve.getValue() == "linear") {
+    drain_curve_ = Server::DrainCurve::Linear;
+  } else if (drain_curve.getValue() == "quadratic") {
+    drain_curve_ = Server::DrainCurve::Quadratic;
+  } else if (drain_curve.getValue() == "immediate") {
+    drain_curve_ = Server::DrainCurve::Immediate;
+  } else {
+    const std::string message =
+        fmt::format("error: unknown drain curve '{}'", drain_curve.getValue());
+    std::cerr << message << std::endl;
+    throw MalformedArgvException(message);
+  }
+
+  if (event_loop_backend.getValue() == "default") {
+    event_loop_backend_ = Server::EventLoopBackend::Default;
+  } else if (event_loop_backend.getValue() == "epoll_changelist") {
+    event_loop_backend_ = Server::EventLoopBackend::EpollChangelist;
+  } else {
+    const std::string message =
+        fmt::format("error: unknown event loop backend '{}'", event_loop_backend.getValue());
+    std::cerr << message << std::endl;
+    throw MalformedArgvException(message);
+  }
+
   if (local_address_ip_version.getValue() == "v4") {
     local_address_ip_version_ = Network::Address::IpVersion::v4;
   } else if (local_address_ip_version.getValue() == "v6") {
@@ -185,20 +296,39 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   // For base ID, scale what the user inputs by 10 so that we have spread for domain sockets.
   base_id_ = base_id.getValue() * 10;
   concurrency_ = std::max(1U, concurrency.getValue());
+  if (!parseCpuList(worker_cpu_affinity.getValue(), worker_cpu_affinity_)) {
+    const std::string message = fmt::format("error: invalid worker CPU affinity '{}'",
+                                            worker_cpu_affinity.getValue());
+    std::cerr << message << std::endl;
+    throw MalformedArgvException(message);
+  }
+  blocking_pool_threads_ = blocking_pool_threads.getValue();
+  tls_private_key_threads_ = tls_private_key_threads.getValue();
+  tls_session_cache_size_ = tls_session_cache_size.getValue();
+  tls_lazy_server_contexts_ = tls_lazy_server_contexts.getValue();
+  dns_cache_size_ = dns_cache_size.getValue();
+  dns_cache_max_stale_ = std::chrono::seconds(dns_cache_max_stale.getValue());
   config_path_ = config_path.getValue();
   config_yaml_ = config_yaml.getValue();
   v2_config_only_ = !allow_v1_config.getValue();
   if (allow_unknown_fields.getValue()) {
     MessageUtil::proto_unknown_fields = ProtoUnknownFieldsMode::Allow;
   }
+  use_libevent_buffers_ = use_libevent_buffers.getValue();
+  buffer_slab_pool_mb_ = buffer_slab_pool_mb.getValue();
+  use_std_regex_ = use_std_regex.getValue();
+  max_regex_program_size_ = max_regex_program_size.getValue();
+  read_budget_bytes_ = read_budget_bytes.getValue();
   admin_address_path_ = admin_address_path.getValue();
   log_path_ = log_path.getValue();
+  log_ring_size_ = log_ring_size.getValue();
   restart_epoch_ = restart_epoch.getValue();
   service_cluster_ = service_cluster.getValue();
   service_node_ = service_node.getValue();
   service_zone_ = service_zone.getValue();
   file_flush_interval_msec_ = std::chrono::milliseconds(file_flush_interval_msec.getValue());
   drain_time_ = std::chrono::seconds(drain_time_s.getValue());
+  drain_close_rate_ = drain_close_rate.getValue();
   parent_shutdown_time_ = std::chrono::seconds(parent_shutdown_time_s.getValue());
   max_stats_ = max_stats.getValue();
   stats_options_.max_obj_name_length_ = max_obj_name_len.getValue();
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "envoy/common/exception.h"
 #include "envoy/server/options.h"
@@ -36,6 +37,25 @@ public:
   // Setters for option fields. These are not part of the Options interface.
   void setBaseId(uint64_t base_id) { base_id_ = base_id; };
   void setConcurrency(uint32_t concurrency) { concurrency_ = concurrency; }
+  void setWorkerCpuAffinity(const std::vector<uint32_t>& worker_cpu_affinity) {
+    worker_cpu_affinity_ = worker_cpu_affinity;
+  }
+  void setBlockingPoolThreads(uint32_t blocking_pool_threads) {
+    blocking_pool_threads_ = blocking_pool_threads;
+  }
+  void setTlsPrivateKeyThreads(uint32_t tls_private_key_threads) {
+    tls_private_key_threads_ = tls_private_key_threads;
+  }
+  void setTlsSessionCacheSize(uint32_t tls_session_cache_size) {
+    tls_session_cache_size_ = tls_session_cache_size;
+  }
+  void setTlsLazyServerContexts(uint32_t tls_lazy_server_contexts) {
+    tls_lazy_server_contexts_ = tls_lazy_server_contexts;
+  }
+  void setDnsCacheSize(uint32_t dns_cache_size) { dns_cache_size_ = dns_cache_size; }
+  void setDnsCacheMaxStale(std::chrono::seconds dns_cache_max_stale) {
+    dns_cache_max_stale_ = dns_cache_max_stale;
+  }
   void setConfigPath(const std::string& config_path) { config_path_ = config_path; }
   void setConfigYaml(const std::string& config_yaml) { config_yaml_ = config_yaml; }
   void setV2ConfigOnly(bool v2_config_only) { v2_config_only_ = v2_config_only; }
@@ -46,9 +66,12 @@ public:
     local_address_ip_version_ = local_address_ip_version;
   }
   void setDrainTime(std::chrono::seconds drain_time) { drain_time_ = drain_time; }
+  void setDrainCurve(Server::DrainCurve drain_curve) { drain_curve_ = drain_curve; }
+  void setDrainCloseRate(uint32_t drain_close_rate) { drain_close_rate_ = drain_close_rate; }
   void setLogLevel(spdlog::level::level_enum log_level) { log_level_ = log_level; }
   void setLogFormat(const std::string& log_format) { log_format_ = log_format; }
   void setLogPath(const std::string& log_path) { log_path_ = log_path; }
+  void setLogRingSize(uint32_t log_ring_size) { log_ring_size_ = log_ring_size; }
   void setParentShutdownTime(std::chrono::seconds parent_shutdown_time) {
     parent_shutdown_time_ = parent_shutdown_time;
   }
@@ -67,10 +90,31 @@ public:
   void setHotRestartDisabled(bool hot_restart_disabled) {
     hot_restart_disabled_ = hot_restart_disabled;
   }
+  void setBufferSlabPoolMb(uint32_t buffer_slab_pool_mb) {
+    buffer_slab_pool_mb_ = buffer_slab_pool_mb;
+  }
+  void setUseLibeventBuffers(bool use_libevent_buffers) {
+    use_libevent_buffers_ = use_libevent_buffers;
+  }
+  void setEventLoopBackend(Server::EventLoopBackend event_loop_backend) {
+    event_loop_backend_ = event_loop_backend;
+  }
+  void setReadBudgetBytes(uint64_t read_budget_bytes) { read_budget_bytes_ = read_budget_bytes; }
+  void setUseStdRegex(bool use_std_regex) { use_std_regex_ = use_std_regex; }
+  void setMaxRegexProgramSize(uint32_t max_regex_program_size) {
+    max_regex_program_size_ = max_regex_program_size;
+  }
 
   // Server::Options
   uint64_t baseId() const override { return base_id_; }
   uint32_t concurrency() const override { return concurrency_; }
+  const std::vector<uint32_t>& workerCpuAffinity() const override { return worker_cpu_affinity_; }
+  uint32_t blockingPoolThreads() const override { return blocking_pool_threads_; }
+  uint32_t tlsPrivateKeyThreads() const override { return tls_private_key_threads_; }
+  uint32_t tlsSessionCacheSize() const override { return tls_session_cache_size_; }
+  uint32_t tlsLazyServerContexts() const override { return tls_lazy_server_contexts_; }
+  uint32_t dnsCacheSize() const override { return dns_cache_size_; }
+  std::chrono::seconds dnsCacheMaxStale() const override { return dns_cache_max_stale_; }
   const std::string& configPath() const override { return config_path_; }
   const std::string& configYaml() const override { return config_yaml_; }
   bool v2ConfigOnly() const override { return v2_config_only_; }
@@ -79,9 +123,12 @@ public:
     return local_address_ip_version_;
   }
   std::chrono::seconds drainTime() const override { return drain_time_; }
+  Server::DrainCurve drainCurve() const override { return drain_curve_; }
+  uint32_t drainCloseRate() const override { return drain_close_rate_; }
   spdlog::level::level_enum logLevel() const override { return log_level_; }
   const std::string& logFormat() const override { return log_format_; }
   const std::string& logPath() const override { return log_path_; }
+  uint32_t logRingSize() const override { return log_ring_size_; }
   std::chrono::seconds parentShutdownTime() const override { return parent_shutdown_time_; }
   uint64_t restartEpoch() const override { return restart_epoch_; }
   Server::Mode mode() const override { return mode_; }
@@ -94,10 +141,23 @@ public:
   uint64_t maxStats() const override { return max_stats_; }
   const Stats::StatsOptions& statsOptions() const override { return stats_options_; }
   bool hotRestartDisabled() const override { return hot_restart_disabled_; }
+  uint32_t bufferSlabPoolMb() const override { return buffer_slab_pool_mb_; }
+  bool useLibeventBuffers() const override { return use_libevent_buffers_; }
+  Server::EventLoopBackend eventLoopBackend() const override { return event_loop_backend_; }
+  uint64_t readBudgetBytes() const override { return read_budget_bytes_; }
+  bool useStdRegex() const override { return use_std_regex_; }
+  uint32_t maxRegexProgramSize() const override { return max_regex_program_size_; }
 
 private:
   uint64_t base_id_;
   uint32_t concurrency_;
+  std::vector<uint32_t> worker_cpu_affinity_;
+  uint32_t blocking_pool_threads_;
+  uint32_t tls_private_key_threads_;
+  uint32_t tls_session_cache_size_;
+  uint32_t tls_lazy_server_contexts_;
+  uint32_t dns_cache_size_;
+  std::chrono::seconds dns_cache_max_stale_;
   std::string config_path_;
   std::string config_yaml_;
   bool v2_config_only_;
@@ -106,17 +166,26 @@ private:
   spdlog::level::level_enum log_level_;
   std::string log_format_;
   std::string log_path_;
+  uint32_t log_ring_size_;
   uint64_t restart_epoch_;
   std::string service_cluster_;
   std::string service_node_;
   std::string service_zone_;
   std::chrono::milliseconds file_flush_interval_msec_;
   std::chrono::seconds drain_time_;
+  Server::DrainCurve drain_curve_;
+  uint32_t drain_close_rate_;
   std::chrono::seconds parent_shutdown_time_;
   Server::Mode mode_;
   uint64_t max_stats_;
   Stats::StatsOptionsImpl stats_options_;
   bool hot_restart_disabled_;
+  uint32_t buffer_slab_pool_mb_;
+  bool use_libevent_buffers_;
+  Server::EventLoopBackend event_loop_backend_;
+  uint64_t read_budget_bytes_;
+  bool use_std_regex_;
+  uint32_t max_regex_program_size_;
 };
 
 /**
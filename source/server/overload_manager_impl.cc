@@ -1,5 +1,7 @@
 #include "server/overload_manager_impl.h"
 
+#include <algorithm>
+
 #include "envoy/stats/scope.h"
 
 #include "common/common/fmt.h"
@@ -20,19 +22,53 @@ public:
   ThresholdTriggerImpl(const envoy::config::overload::v2alpha::ThresholdTrigger& config)
       : threshold_(config.value()) {}
 
-  bool updateValue(double value) {
+  bool updateValue(double value) override {
     const bool fired = isFired();
     value_ = value;
     return fired != isFired();
   }
 
-  bool isFired() const { return value_.has_value() && value_ >= threshold_; }
+  bool isFired() const override { return value_.has_value() && value_ >= threshold_; }
+
+  double value() const override { return isFired() ? 1.0 : 0.0; }
 
 private:
   const double threshold_;
   absl::optional<double> value_;
 };
 
+class ScaledTriggerImpl : public OverloadAction::Trigger {
+public:
+  ScaledTriggerImpl(const envoy::config::overload::v2alpha::ScaledTrigger& config)
+      : scaling_threshold_(config.scaling_threshold()),
+        saturation_threshold_(config.saturation_threshold()) {
+    if (scaling_threshold_ >= saturation_threshold_) {
+      throw EnvoyException("scaling_threshold must be less than saturation_threshold");
+    }
+  }
+
+  bool updateValue(double value) override {
+    const double previous = value_;
+    if (value >= saturation_threshold_) {
+      value_ = 1.0;
+    } else if (value > scaling_threshold_) {
+      value_ = (value - scaling_threshold_) / (saturation_threshold_ - scaling_threshold_);
+    } else {
+      value_ = 0.0;
+    }
+    return previous != value_;
+  }
+
+  bool isFired() const override { return value_ == 1.0; }
+
+  double value() const override { return value_; }
+
+private:
+  const double scaling_threshold_;
+  const double saturation_threshold_;
+  double value_{};
+};
+
 std::string StatsName(const std::string& a, const std::string& b) {
   return absl::StrCat("overload.", a, b);
 }
@@ -41,7 +77,8 @@ std::string StatsName(const std::string& a, const std::string& b) {
 
 OverloadAction::OverloadAction(const envoy::config::overload::v2alpha::OverloadAction& config,
                                Stats::Scope& stats_scope)
-    : active_gauge_(stats_scope.gauge(StatsName(config.name(), ".active"))) {
+    : active_gauge_(stats_scope.gauge(StatsName(config.name(), ".active"))),
+      scale_percent_gauge_(stats_scope.gauge(StatsName(config.name(), ".scale_percent"))) {
   for (const auto& trigger_config : config.triggers()) {
     TriggerPtr trigger;
 
@@ -49,6 +86,9 @@ OverloadAction::OverloadAction(const envoy::config::overload::v2alpha::OverloadA
     case envoy::config::overload::v2alpha::Trigger::kThreshold:
       trigger = std::make_unique<ThresholdTriggerImpl>(trigger_config.threshold());
       break;
+    case envoy::config::overload::v2alpha::Trigger::kScaled:
+      trigger = std::make_unique<ScaledTriggerImpl>(trigger_config.scaled());
+      break;
     default:
       NOT_REACHED_GCOVR_EXCL_LINE;
     }
@@ -60,26 +100,31 @@ OverloadAction::OverloadAction(const envoy::config::overload::v2alpha::OverloadA
   }
 
   active_gauge_.set(0);
+  scale_percent_gauge_.set(0);
 }
 
 bool OverloadAction::updateResourcePressure(const std::string& name, double pressure) {
-  const bool active = isActive();
-
   auto it = triggers_.find(name);
   ASSERT(it != triggers_.end());
-  if (it->second->updateValue(pressure)) {
-    if (it->second->isFired()) {
-      active_gauge_.set(1);
-      const auto result = fired_triggers_.insert(name);
-      ASSERT(result.second);
-    } else {
-      active_gauge_.set(0);
-      const auto result = fired_triggers_.erase(name);
-      ASSERT(result == 1);
-    }
+  if (!it->second->updateValue(pressure)) {
+    return false;
   }
 
-  return active != isActive();
+  if (it->second->isFired()) {
+    fired_triggers_.insert(name);
+  } else {
+    fired_triggers_.erase(name);
+  }
+  active_gauge_.set(isActive() ? 1 : 0);
+
+  const double scaled_value = scaled_value_;
+  scaled_value_ = 0;
+  for (const auto& trigger : triggers_) {
+    scaled_value_ = std::max(scaled_value_, trigger.second->value());
+  }
+  scale_percent_gauge_.set(scaled_value_ * 100); // convert to percent
+
+  return scaled_value != scaled_value_;
 }
 
 bool OverloadAction::isActive() const { return !fired_triggers_.empty(); }
@@ -128,15 +173,18 @@ OverloadManagerImpl::OverloadManagerImpl(
       resource_to_actions_.insert(std::make_pair(resource, name));
     }
   }
-
-  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-    return std::make_shared<ThreadLocalOverloadState>();
-  });
 }
 
 void OverloadManagerImpl::start() {
   ASSERT(!started_);
   started_ = true;
+
+  // The thread local state is set here rather than on construction so that it reaches workers
+  // that register with thread local storage after the overload manager is created.
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalOverloadState>();
+  });
+
   if (resources_.empty()) {
     return;
   }
@@ -175,15 +223,22 @@ void OverloadManagerImpl::updateResourcePressure(const std::string& resource, do
                   const std::string& action = entry.second;
                   auto action_it = actions_.find(action);
                   ASSERT(action_it != actions_.end());
+                  const bool was_active = action_it->second.isActive();
                   if (action_it->second.updateResourcePressure(resource, pressure)) {
                     const bool is_active = action_it->second.isActive();
                     const auto state =
                         is_active ? OverloadActionState::Active : OverloadActionState::Inactive;
+                    const double scaled_value = action_it->second.scaledValue();
+                    tls_->runOnAllThreads([this, action, state, scaled_value] {
+                      auto& overload_state = tls_->getTyped<ThreadLocalOverloadState>();
+                      overload_state.setState(action, state);
+                      overload_state.setScaledValue(action, scaled_value);
+                    });
+                    if (is_active == was_active) {
+                      return;
+                    }
                     ENVOY_LOG(info, "Overload action {} has become {}", action,
                               is_active ? "active" : "inactive");
-                    tls_->runOnAllThreads([this, action, state] {
-                      tls_->getTyped<ThreadLocalOverloadState>().setState(action, state);
-                    });
                     auto callback_range = action_to_callbacks_.equal_range(action);
                     std::for_each(callback_range.first, callback_range.second,
                                   [&](ActionToCallbackMap::value_type& cb_entry) {
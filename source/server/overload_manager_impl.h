@@ -24,28 +24,37 @@ public:
                  Stats::Scope& stats_scope);
 
   // Updates the current pressure for the given resource and returns whether the action
-  // has changed state.
+  // has changed state or scaled value.
   bool updateResourcePressure(const std::string& name, double pressure);
 
   // Returns whether the action is currently active or not.
   bool isActive() const;
 
+  // Returns the largest value of the triggers, in [0, 1].
+  double scaledValue() const { return scaled_value_; }
+
   class Trigger {
   public:
     virtual ~Trigger() {}
 
-    // Updates the current value of the metric and returns whether the trigger has changed state.
+    // Updates the current value of the metric and returns whether the trigger has changed state
+    // or value.
     virtual bool updateValue(double value) PURE;
 
     // Returns whether the trigger is currently fired or not.
     virtual bool isFired() const PURE;
+
+    // Returns the value of the trigger in [0, 1], which is 1 when it is fired.
+    virtual double value() const PURE;
   };
   typedef std::unique_ptr<Trigger> TriggerPtr;
 
 private:
   std::unordered_map<std::string, TriggerPtr> triggers_;
   std::unordered_set<std::string> fired_triggers_;
+  double scaled_value_{};
   Stats::Gauge& active_gauge_;
+  Stats::Gauge& scale_percent_gauge_;
 };
 
 class OverloadManagerImpl : Logger::Loggable<Logger::Id::main>, public OverloadManager {
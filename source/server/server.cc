@@ -19,6 +19,8 @@
 
 #include "common/api/api_impl.h"
 #include "common/api/os_sys_calls_impl.h"
+#include "common/buffer/memory_account.h"
+#include "common/buffer/slab_pool.h"
 #include "common/common/utility.h"
 #include "common/common/version.h"
 #include "common/config/bootstrap_json.h"
@@ -27,6 +29,7 @@
 #include "common/local_info/local_info_impl.h"
 #include "common/memory/stats.h"
 #include "common/network/address_impl.h"
+#include "common/network/dns_impl.h"
 #include "common/protobuf/utility.h"
 #include "common/router/rds_impl.h"
 #include "common/runtime/runtime_impl.h"
@@ -51,14 +54,21 @@ InstanceImpl::InstanceImpl(Options& options, Event::TimeSystem& time_system,
                            ThreadLocal::Instance& tls)
     : options_(options), time_system_(time_system), restarter_(restarter),
       start_time_(time(nullptr)), original_start_time_(start_time_), stats_store_(store),
-      thread_local_(tls), api_(new Api::Impl(options.fileFlushIntervalMsec())),
+      thread_local_(tls),
+      api_(new Api::Impl(options.fileFlushIntervalMsec(), options.blockingPoolThreads())),
       dispatcher_(api_->allocateDispatcher(time_system)),
       singleton_manager_(new Singleton::ManagerImpl()),
       handler_(new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher_)),
       random_generator_(std::move(random_generator)),
       secret_manager_(std::make_unique<Secret::SecretManagerImpl>()),
-      listener_component_factory_(*this), worker_factory_(thread_local_, *api_, hooks, time_system),
-      dns_resolver_(dispatcher_->createDnsResolver({})),
+      listener_component_factory_(*this),
+      worker_factory_(thread_local_, *api_, hooks, time_system, options.workerCpuAffinity()),
+      dns_resolver_(options.dnsCacheSize() > 0
+                        ? std::make_shared<Network::DnsResolverImpl>(
+                              *dispatcher_, std::vector<Network::Address::InstanceConstSharedPtr>{},
+                              options.dnsCacheSize(), options.dnsCacheMaxStale(),
+                              store.createScope("dns_cache."))
+                        : dispatcher_->createDnsResolver({})),
       access_log_manager_(*api_, *dispatcher_, access_log_lock, store), terminated_(false) {
 
   try {
@@ -71,6 +81,20 @@ InstanceImpl::InstanceImpl(Options& options, Event::TimeSystem& time_system,
             fmt::format("Failed to open log-file '{}'. e.what(): {}", options.logPath(), e.what()));
       }
     }
+    if (options.logRingSize() > 0) {
+      async_logger_ = std::make_unique<Logger::AsyncSinkDelegate>(
+          Logger::Registry::getSink(), options.logRingSize(), std::chrono::milliseconds(10));
+    }
+    if (options.bufferSlabPoolMb() > 0) {
+      Buffer::SlabPool::initialize(static_cast<uint64_t>(options.bufferSlabPoolMb()) << 20);
+      const Buffer::SlabPool& pool = *Buffer::SlabPool::get();
+      if (pool.size() == 0) {
+        ENVOY_LOG(warn, "failed to reserve the buffer slab pool, buffers use the heap");
+      } else {
+        ENVOY_LOG(info, "reserved {} bytes of {} huge pages for the buffer slab pool", pool.size(),
+                  pool.hugePages() ? "explicit" : "transparent");
+      }
+    }
 
     restarter_.initialize(*dispatcher_, *this);
     drain_manager_ = component_factory.createDrainManager(*this);
@@ -96,6 +120,7 @@ InstanceImpl::~InstanceImpl() {
 
   // Stop logging to file before all the AccessLogManager and its dependencies are
   // destructed to avoid crashing at shutdown.
+  async_logger_.reset();
   file_logger_.reset();
 
   // Destruct the ListenerManager explicitly, before InstanceImpl's local init_manager_ is
@@ -150,6 +175,14 @@ void InstanceImpl::flushStats() {
     server_stats_->total_connections_.set(numConnections() + info.num_connections_);
     server_stats_->days_until_first_cert_expiring_.set(
         sslContextManager().daysUntilFirstCertExpires());
+    if (async_logger_ != nullptr) {
+      server_stats_->log_messages_dropped_.set(async_logger_->droppedMessages());
+    }
+    if (Buffer::SlabPool::get() != nullptr) {
+      server_stats_->buffer_slab_pool_size_.set(Buffer::SlabPool::get()->size());
+      server_stats_->buffer_slab_pool_allocated_.set(Buffer::SlabPool::get()->allocatedBytes());
+      server_stats_->buffer_slab_pool_fallbacks_.set(Buffer::SlabPool::get()->fallbacks());
+    }
     InstanceUtil::flushMetricsToSinks(config_->statsSinks(), stats_store_.source());
     // TODO(ramaraochavali): consider adding different flush interval for histograms.
     if (stat_flush_timer_ != nullptr) {
@@ -231,6 +264,14 @@ void InstanceImpl::initialize(Options& options,
   // Needs to happen as early as possible in the instantiation to preempt the objects that require
   // stats.
   stats_store_.setTagProducer(Config::Utility::createTagProducer(bootstrap_));
+  for (const auto& limit : bootstrap_.stats_config().cardinality_limits()) {
+    stats_store_.setCardinalityLimit(limit.prefix(), limit.max_stats());
+  }
+  Stats::StatsMatcherPtr stats_matcher = Config::Utility::createStatsMatcher(bootstrap_);
+  if (stats_matcher != nullptr) {
+    stats_store_.setStatsMatcher(std::move(stats_matcher));
+  }
+  stats_store_.source().setChangedMetricsOnly(bootstrap_.stats_flush_changed_only());
 
   server_stats_.reset(
       new ServerStats{ALL_SERVER_STATS(POOL_GAUGE_PREFIX(stats_store_, "server."))});
@@ -269,6 +310,25 @@ void InstanceImpl::initialize(Options& options,
 
   loadServerFlags(initial_config.flagsPath());
 
+  // Initialize the overload manager early so other modules, including workers, can register for
+  // actions. Its thread local state is only set when it starts, after all workers exist.
+  overload_manager_.reset(
+      new OverloadManagerImpl(dispatcher(), stats(), threadLocal(), bootstrap_.overload_manager()));
+  overload_manager_->registerForAction(
+      OverloadActionNames::get().ResetHighMemoryStreams, *dispatcher_,
+      [this](OverloadActionState state) -> void { onResetHighMemoryStreams(state); });
+
+  if (bootstrap_.enable_dispatcher_stats()) {
+    dispatcher_->initializeStats(stats_store_, "main_thread.dispatcher.");
+    worker_factory_.enableDispatcherStats(stats_store_);
+  }
+  if (bootstrap_.has_hot_path_stats_sample_interval()) {
+    stage_timer_stats_ = std::make_unique<Stats::StageTimerStats>(
+        Stats::StageTimers::generateStats(stats_store_, "hot_path."));
+    Stats::StageTimers::enable(*stage_timer_stats_,
+                               bootstrap_.hot_path_stats_sample_interval().value());
+  }
+
   // Workers get created first so they register for thread local updates.
   listener_manager_.reset(
       new ListenerManagerImpl(*this, listener_component_factory_, worker_factory_, time_system_));
@@ -277,10 +337,6 @@ void InstanceImpl::initialize(Options& options,
   // whether it runs on the main thread or on workers can still use TLS.
   thread_local_.registerThread(*dispatcher_, true);
 
-  // Initialize the overload manager early so other modules can register for actions.
-  overload_manager_.reset(
-      new OverloadManagerImpl(dispatcher(), stats(), threadLocal(), bootstrap_.overload_manager()));
-
   // We can now initialize stats for threading.
   stats_store_.initializeThreading(*dispatcher_, thread_local_);
 
@@ -289,7 +345,14 @@ void InstanceImpl::initialize(Options& options,
   runtime_loader_ = component_factory.createRuntime(*this, initial_config);
 
   // Once we have runtime we can initialize the SSL context manager.
-  ssl_context_manager_.reset(new Ssl::ContextManagerImpl(*runtime_loader_));
+  ssl_context_manager_.reset(new Ssl::ContextManagerImpl(
+      *runtime_loader_, options_.tlsPrivateKeyThreads(), options_.tlsSessionCacheSize(),
+      options_.tlsLazyServerContexts()));
+  if (options_.tlsSessionCacheSize() > 0) {
+    // Let the clients of our parent resume their sessions rather than all doing full handshakes
+    // as the parent drains.
+    ssl_context_manager_->importServerSessions(restarter_.getParentTlsSessions());
+  }
 
   cluster_manager_factory_.reset(new Upstream::ProdClusterManagerFactory(
       runtime(), stats(), threadLocal(), random(), dnsResolver(), sslContextManager(), dispatcher(),
@@ -310,7 +373,8 @@ void InstanceImpl::initialize(Options& options,
   if (bootstrap_.has_hds_config()) {
     const auto& hds_config = bootstrap_.hds_config();
     async_client_manager_ = std::make_unique<Grpc::AsyncClientManagerImpl>(
-        clusterManager(), thread_local_, time_system_);
+        clusterManager(), thread_local_, time_system_,
+        bootstrap_.cluster_manager().google_grpc_completion_threads());
     hds_delegate_.reset(new Upstream::HdsDelegate(
         bootstrap_.node(), stats(),
         Config::Utility::factoryForGrpcApiConfigSource(*async_client_manager_, hds_config, stats())
@@ -333,6 +397,20 @@ void InstanceImpl::initialize(Options& options,
   guard_dog_.reset(new Server::GuardDogImpl(stats_store_, *config_, time_system_));
 }
 
+void InstanceImpl::onResetHighMemoryStreams(OverloadActionState state) {
+  if (state == OverloadActionState::Inactive) {
+    reset_high_memory_streams_timer_.reset();
+    return;
+  }
+
+  // For as long as memory is short, keep resetting the streams and connections buffering the most.
+  reset_high_memory_streams_timer_ = dispatcher_->createTimer([this]() -> void {
+    Buffer::MemoryAccountRegistrySingleton::get().resetLargest(10);
+    reset_high_memory_streams_timer_->enableTimer(std::chrono::seconds(1));
+  });
+  reset_high_memory_streams_timer_->enableTimer(std::chrono::milliseconds(0));
+}
+
 void InstanceImpl::startWorkers() {
   listener_manager_->startWorkers(*guard_dog_);
 
@@ -356,7 +434,7 @@ Runtime::LoaderPtr InstanceUtil::createRuntime(Instance& server,
     return std::make_unique<Runtime::DiskBackedLoaderImpl>(
         server.dispatcher(), server.threadLocal(), config.runtime()->symlinkRoot(),
         config.runtime()->subdirectory(), override_subdirectory, server.stats(), server.random(),
-        std::move(os_sys_calls));
+        std::move(os_sys_calls), &server.api().blockingPool());
   } else {
     return std::make_unique<Runtime::LoaderImpl>(server.random(), server.stats(),
                                                  server.threadLocal());
@@ -471,6 +549,7 @@ void InstanceImpl::terminate() {
   if (listener_manager_.get() != nullptr) {
     listener_manager_->stopWorkers();
   }
+  Stats::StageTimers::disable();
 
   // Only flush if we have not been hot restarted.
   if (stat_flush_timer_) {
@@ -22,6 +22,7 @@
 #include "common/runtime/runtime_impl.h"
 #include "common/secret/secret_manager_impl.h"
 #include "common/ssl/context_manager_impl.h"
+#include "common/stats/stage_timer.h"
 #include "common/upstream/health_discovery_service.h"
 
 #include "server/http/admin.h"
@@ -50,7 +51,11 @@ namespace Server {
   GAUGE(total_connections)                                                                         \
   GAUGE(version)                                                                                   \
   GAUGE(days_until_first_cert_expiring)                                                            \
-  GAUGE(hot_restart_epoch)
+  GAUGE(hot_restart_epoch)                                                                         \
+  GAUGE(log_messages_dropped)                                                                      \
+  GAUGE(buffer_slab_pool_size)                                                                     \
+  GAUGE(buffer_slab_pool_allocated)                                                                \
+  GAUGE(buffer_slab_pool_fallbacks)
 // clang-format on
 
 struct ServerStats {
@@ -193,6 +198,7 @@ private:
                   ComponentFactory& component_factory);
   void loadServerFlags(const absl::optional<std::string>& flags_path);
   uint64_t numConnections();
+  void onResetHighMemoryStreams(OverloadActionState state);
   void startWorkers();
   void terminate();
 
@@ -227,6 +233,8 @@ private:
   std::unique_ptr<Server::GuardDog> guard_dog_;
   bool terminated_;
   std::unique_ptr<Logger::FileSinkDelegate> file_logger_;
+  // Installed after, and so removed before, the file logger it writes to.
+  std::unique_ptr<Logger::AsyncSinkDelegate> async_logger_;
   envoy::config::bootstrap::v2::Bootstrap bootstrap_;
   ConfigTracker::EntryOwnerPtr config_tracker_entry_;
   SystemTime bootstrap_config_update_time_;
@@ -234,6 +242,9 @@ private:
   Upstream::ProdClusterInfoFactory info_factory_;
   Upstream::HdsDelegatePtr hds_delegate_;
   std::unique_ptr<OverloadManagerImpl> overload_manager_;
+  Event::TimerPtr reset_high_memory_streams_timer_;
+  // Set when the hot path stages are timed.
+  std::unique_ptr<Stats::StageTimerStats> stage_timer_stats_;
   std::unique_ptr<RunHelper> run_helper_;
 };
 
@@ -14,17 +14,32 @@
 namespace Envoy {
 namespace Server {
 
-WorkerPtr ProdWorkerFactory::createWorker() {
+WorkerPtr ProdWorkerFactory::createWorker(OverloadManager& overload_manager) {
   Event::DispatcherPtr dispatcher(api_.allocateDispatcher(time_system_));
-  return WorkerPtr{new WorkerImpl(
-      tls_, hooks_, std::move(dispatcher),
-      Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher)})};
+  const uint32_t worker_index = next_worker_index_++;
+  if (dispatcher_stats_scope_ != nullptr) {
+    dispatcher->initializeStats(*dispatcher_stats_scope_,
+                                fmt::format("worker_{}.dispatcher.", worker_index));
+  }
+  absl::optional<uint32_t> cpu;
+  if (!cpu_affinity_.empty()) {
+    cpu = cpu_affinity_[worker_index % cpu_affinity_.size()];
+  }
+  return WorkerPtr{new WorkerImpl(tls_, hooks_, std::move(dispatcher),
+                                  Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(
+                                      ENVOY_LOGGER(), *dispatcher, worker_index)},
+                                  overload_manager, cpu)};
 }
 
 WorkerImpl::WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks,
-                       Event::DispatcherPtr&& dispatcher, Network::ConnectionHandlerPtr handler)
-    : tls_(tls), hooks_(hooks), dispatcher_(std::move(dispatcher)), handler_(std::move(handler)) {
+                       Event::DispatcherPtr&& dispatcher, Network::ConnectionHandlerPtr handler,
+                       OverloadManager& overload_manager, absl::optional<uint32_t> cpu)
+    : tls_(tls), hooks_(hooks), dispatcher_(std::move(dispatcher)), handler_(std::move(handler)),
+      cpu_(cpu) {
   tls_.registerThread(*dispatcher_, false);
+  overload_manager.registerForAction(
+      OverloadActionNames::get().StopAcceptingConnections, *dispatcher_,
+      [this](OverloadActionState state) -> void { stopAcceptingConnectionsCb(state); });
 }
 
 void WorkerImpl::addListener(Network::ListenerConfig& listener, AddListenerCompletion completion) {
@@ -62,6 +77,20 @@ void WorkerImpl::removeListener(Network::ListenerConfig& listener,
   });
 }
 
+void WorkerImpl::removeFilterChains(
+    Network::ListenerConfig& listener,
+    const std::unordered_set<const Network::FilterChain*>& filter_chains,
+    std::function<void()> completion) {
+  ASSERT(thread_);
+  const uint64_t listener_tag = listener.listenerTag();
+  dispatcher_->post([this, listener_tag, filter_chains, completion]() -> void {
+    handler_->removeFilterChains(listener_tag, filter_chains, [this, completion]() -> void {
+      completion();
+      hooks_.onWorkerListenerRemoved();
+    });
+  });
+}
+
 void WorkerImpl::start(GuardDog& guard_dog) {
   ASSERT(!thread_);
   thread_.reset(new Thread::Thread([this, &guard_dog]() -> void { threadRoutine(guard_dog); }));
@@ -87,7 +116,27 @@ void WorkerImpl::stopListeners() {
   dispatcher_->post([this]() -> void { handler_->stopListeners(); });
 }
 
+void WorkerImpl::stopAcceptingConnectionsCb(OverloadActionState state) {
+  switch (state) {
+  case OverloadActionState::Active:
+    handler_->disableListeners();
+    break;
+  case OverloadActionState::Inactive:
+    handler_->enableListeners();
+    break;
+  }
+}
+
 void WorkerImpl::threadRoutine(GuardDog& guard_dog) {
+  // Pin before the event loop runs, so that memory the worker allocates from here on is local to
+  // its CPU's NUMA node.
+  if (cpu_.has_value()) {
+    if (Thread::Thread::setCurrentThreadCpuAffinity(cpu_.value())) {
+      ENVOY_LOG(debug, "worker pinned to CPU {}", cpu_.value());
+    } else {
+      ENVOY_LOG(warn, "unable to pin worker to CPU {}", cpu_.value());
+    }
+  }
   ENVOY_LOG(debug, "worker entering dispatch loop");
   auto watchdog = guard_dog.createWatchDog(Thread::Thread::currentThreadId());
   watchdog->startWatchdog(*dispatcher_);
@@ -2,12 +2,15 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "envoy/api/api.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/server/guarddog.h"
 #include "envoy/server/listener_manager.h"
+#include "envoy/server/overload_manager.h"
 #include "envoy/server/worker.h"
+#include "envoy/stats/scope.h"
 #include "envoy/thread_local/thread_local.h"
 
 #include "common/common/logger.h"
@@ -15,23 +18,38 @@
 
 #include "server/test_hooks.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Server {
 
 class ProdWorkerFactory : public WorkerFactory, Logger::Loggable<Logger::Id::main> {
 public:
+  /**
+   * @param cpu_affinity supplies the CPUs to pin workers to, see Options::workerCpuAffinity().
+   */
   ProdWorkerFactory(ThreadLocal::Instance& tls, Api::Api& api, TestHooks& hooks,
-                    Event::TimeSystem& time_system)
-      : tls_(tls), api_(api), hooks_(hooks), time_system_(time_system) {}
+                    Event::TimeSystem& time_system, const std::vector<uint32_t>& cpu_affinity)
+      : tls_(tls), api_(api), hooks_(hooks), time_system_(time_system),
+        cpu_affinity_(cpu_affinity) {}
+
+  /**
+   * Have the dispatchers of the workers created from now on record their stats.
+   * @param scope supplies the scope of the stats, see Event::Dispatcher::initializeStats().
+   */
+  void enableDispatcherStats(Stats::Scope& scope) { dispatcher_stats_scope_ = &scope; }
 
   // Server::WorkerFactory
-  WorkerPtr createWorker() override;
+  WorkerPtr createWorker(OverloadManager& overload_manager) override;
 
 private:
   ThreadLocal::Instance& tls_;
   Api::Api& api_;
   TestHooks& hooks_;
   Event::TimeSystem& time_system_;
+  const std::vector<uint32_t> cpu_affinity_;
+  uint32_t next_worker_index_{};
+  Stats::Scope* dispatcher_stats_scope_{};
 };
 
 /**
@@ -39,13 +57,20 @@ private:
  */
 class WorkerImpl : public Worker, Logger::Loggable<Logger::Id::main> {
 public:
+  /**
+   * @param cpu supplies the CPU to pin the worker thread to, if any.
+   */
   WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks, Event::DispatcherPtr&& dispatcher,
-             Network::ConnectionHandlerPtr handler);
+             Network::ConnectionHandlerPtr handler, OverloadManager& overload_manager,
+             absl::optional<uint32_t> cpu);
 
   // Server::Worker
   void addListener(Network::ListenerConfig& listener, AddListenerCompletion completion) override;
   uint64_t numConnections() override;
   void removeListener(Network::ListenerConfig& listener, std::function<void()> completion) override;
+  void removeFilterChains(Network::ListenerConfig& listener,
+                          const std::unordered_set<const Network::FilterChain*>& filter_chains,
+                          std::function<void()> completion) override;
   void start(GuardDog& guard_dog) override;
   void stop() override;
   void stopListener(Network::ListenerConfig& listener) override;
@@ -53,11 +78,13 @@ public:
 
 private:
   void threadRoutine(GuardDog& guard_dog);
+  void stopAcceptingConnectionsCb(OverloadActionState state);
 
   ThreadLocal::Instance& tls_;
   TestHooks& hooks_;
   Event::DispatcherPtr dispatcher_;
   Network::ConnectionHandlerPtr handler_;
+  const absl::optional<uint32_t> cpu_;
   Thread::ThreadPtr thread_;
 };
 
@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <atomic>
+#include <string>
+
 #include "common/access_log/access_log_formatter.h"
 #include "common/network/address_impl.h"
 
@@ -6,11 +10,40 @@
 
 #include "testing/base/public/benchmark.h"
 
+#ifdef TCMALLOC
+#include "gperftools/malloc_hook.h"
+#endif
+
 namespace {
 
 static std::unique_ptr<Envoy::AccessLog::FormatterImpl> formatter;
 static std::unique_ptr<Envoy::TestRequestInfo> request_info;
 
+// Heap allocations made while counting_allocations is set. This relies on tcmalloc's hooks, and
+// counts nothing without it.
+static std::atomic<uint64_t> allocations{0};
+static std::atomic<bool> counting_allocations{false};
+
+#ifdef TCMALLOC
+void countAllocation(const void*, size_t) {
+  if (counting_allocations) {
+    allocations++;
+  }
+}
+#endif
+
+// Runs the benchmark loop with allocation counting, and reports the allocations per iteration.
+template <class Function> void runCountingAllocations(benchmark::State& state, Function function) {
+  allocations = 0;
+  counting_allocations = true;
+  for (auto _ : state) {
+    function();
+  }
+  counting_allocations = false;
+  state.counters["allocations_per_line"] =
+      static_cast<double>(allocations) / std::max<size_t>(1, state.iterations());
+}
+
 } // namespace
 
 namespace Envoy {
@@ -20,15 +53,32 @@ static void BM_AccessLogFormatter(benchmark::State& state) {
   Http::TestHeaderMapImpl request_headers;
   Http::TestHeaderMapImpl response_headers;
   Http::TestHeaderMapImpl response_trailers;
-  for (auto _ : state) {
+  runCountingAllocations(state, [&]() -> void {
     output_bytes +=
         formatter->format(request_headers, response_headers, response_trailers, *request_info)
             .length();
-  }
+  });
   benchmark::DoNotOptimize(output_bytes);
 }
 BENCHMARK(BM_AccessLogFormatter);
 
+// Formats into a reused string, as the file access log does.
+static void BM_AccessLogFormatterFormatInto(benchmark::State& state) {
+  size_t output_bytes = 0;
+  Http::TestHeaderMapImpl request_headers;
+  Http::TestHeaderMapImpl response_headers;
+  Http::TestHeaderMapImpl response_trailers;
+  std::string log_line;
+  runCountingAllocations(state, [&]() -> void {
+    log_line.clear();
+    formatter->formatInto(request_headers, response_headers, response_trailers, *request_info,
+                          log_line);
+    output_bytes += log_line.length();
+  });
+  benchmark::DoNotOptimize(output_bytes);
+}
+BENCHMARK(BM_AccessLogFormatterFormatInto);
+
 } // namespace Envoy
 
 // Boilerplate main(), which discovers benchmarks in the same file and runs them.
@@ -43,6 +93,9 @@ int main(int argc, char** argv) {
   request_info = std::make_unique<Envoy::TestRequestInfo>();
   request_info->setDownstreamRemoteAddress(
       std::make_shared<Envoy::Network::Address::Ipv4Instance>("203.0.113.1"));
+#ifdef TCMALLOC
+  MallocHook::AddNewHook(&countAllocation);
+#endif
   benchmark::Initialize(&argc, argv);
   if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
     return 1;
@@ -498,6 +498,26 @@ TEST(AccessLogFormatterTest, CompositeFormatterSuccess) {
   }
 }
 
+TEST(AccessLogFormatterTest, CompositeFormatterFormatInto) {
+  RequestInfo::MockRequestInfo request_info;
+  Http::TestHeaderMapImpl request_header{{"first", "GET"}, {":path", "/"}};
+  Http::TestHeaderMapImpl response_header{{"second", "PUT"}};
+  Http::TestHeaderMapImpl response_trailer{{"third", "POST"}};
+  absl::optional<Http::Protocol> protocol = Http::Protocol::Http11;
+  EXPECT_CALL(request_info, protocol()).WillRepeatedly(Return(protocol));
+
+  const std::string format =
+      "%PROTOCOL% %REQ(FIRST):2% %RESP(SECOND)% %TRAILER(NOT-EXIST?THIRD)% %REQ(NOT-EXIST)%\n";
+  FormatterImpl formatter(format);
+
+  // formatInto() appends the same line that format() returns.
+  std::string output = "prefix ";
+  formatter.formatInto(request_header, response_header, response_trailer, request_info, output);
+  EXPECT_EQ("prefix HTTP/1.1 GE PUT POST -\n", output);
+  EXPECT_EQ("HTTP/1.1 GE PUT POST -\n",
+            formatter.format(request_header, response_header, response_trailer, request_info));
+}
+
 TEST(AccessLogFormatterTest, ParserFailures) {
   AccessLogFormatParser parser;
 
@@ -16,6 +16,7 @@
 #include "test/mocks/access_log/mocks.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/filesystem/mocks.h"
+#include "test/mocks/router/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
 #include "test/mocks/upstream/mocks.h"
@@ -869,6 +870,69 @@ config:
       "response_flag_filter {\n  flags: \"UnsupportedFlag\"\n}\n");
 }
 
+TEST_F(AccessLogImplTest, SampleBudgetFilter) {
+  const std::string yaml = R"EOF(
+name: envoy.file_access_log
+filter:
+  sample_budget_filter:
+    max_entries: 2
+    interval: 1s
+config:
+  path: /dev/null
+  )EOF";
+
+  InstanceSharedPtr log = AccessLogFactory::fromProto(parseAccessLogFromV2Yaml(yaml), context_);
+
+  // Without history, requests are logged until the budget is used up.
+  EXPECT_CALL(context_.random_, random()).Times(0);
+  EXPECT_CALL(*file_, write(_)).Times(2);
+  log->log(&request_headers_, &response_headers_, &response_trailers_, request_info_);
+  log->log(&request_headers_, &response_headers_, &response_trailers_, request_info_);
+  log->log(&request_headers_, &response_headers_, &response_trailers_, request_info_);
+
+  // Three requests in the previous interval, so each is logged with a probability of 2/3.
+  request_info_.start_time_monotonic_ += std::chrono::seconds(1);
+  EXPECT_CALL(context_.random_, random()).WillOnce(Return(2)).WillOnce(Return(4));
+  EXPECT_CALL(*file_, write(_));
+  log->log(&request_headers_, &response_headers_, &response_trailers_, request_info_);
+  log->log(&request_headers_, &response_headers_, &response_trailers_, request_info_);
+
+  // Another route has a budget of its own.
+  NiceMock<Router::MockRouteEntry> route_entry;
+  request_info_.route_entry_ = &route_entry;
+  EXPECT_CALL(*file_, write(_));
+  log->log(&request_headers_, &response_headers_, &response_trailers_, request_info_);
+
+  // Requests that started before the current interval count towards it.
+  request_info_.route_entry_ = nullptr;
+  request_info_.start_time_monotonic_ -= std::chrono::seconds(1);
+  EXPECT_CALL(context_.random_, random()).WillOnce(Return(3));
+  EXPECT_CALL(*file_, write(_));
+  log->log(&request_headers_, &response_headers_, &response_trailers_, request_info_);
+  EXPECT_CALL(*file_, write(_)).Times(0);
+  log->log(&request_headers_, &response_headers_, &response_trailers_, request_info_);
+
+  // Once a whole interval passed without requests, the history is gone.
+  request_info_.start_time_monotonic_ += std::chrono::seconds(3);
+  EXPECT_CALL(context_.random_, random()).Times(0);
+  EXPECT_CALL(*file_, write(_));
+  log->log(&request_headers_, &response_headers_, &response_trailers_, request_info_);
+}
+
+TEST_F(AccessLogImplTest, SampleBudgetFilterZeroEntries) {
+  const std::string yaml = R"EOF(
+name: envoy.file_access_log
+filter:
+  sample_budget_filter:
+    max_entries: 0
+config:
+  path: /dev/null
+  )EOF";
+
+  EXPECT_THROW(AccessLogFactory::fromProto(parseAccessLogFromV2Yaml(yaml), context_),
+               ProtoValidationException);
+}
+
 } // namespace
 } // namespace AccessLog
 } // namespace Envoy
@@ -0,0 +1,148 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "common/buffer/buffer_impl.h"
+
+#include "test/test_common/allocation_counter.h"
+
+#include "absl/strings/string_view.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+
+// Each benchmark takes the buffer implementation as its first argument: 0 for the slice based
+// implementation, 1 for the evbuffer based one.
+static void setImplementation(benchmark::State& state) {
+  Buffer::OwnedImpl::useOldImpl(state.range(0) != 0);
+}
+
+static const char Input[] = "the quick brown fox jumps over the lazy dog\r\n"
+                            "the quick brown fox jumps over the lazy dog\r\n";
+static constexpr size_t InputLength = sizeof(Input) - 1;
+
+static void reportAllocations(benchmark::State& state, const AllocationCounter& counter) {
+  state.counters["allocs_per_iter"] =
+      static_cast<double>(counter.allocations()) / state.iterations();
+}
+
+// Construct and destroy a buffer holding one small chunk, e.g. an encoded header block.
+static void BM_BufferCreateSmall(benchmark::State& state) {
+  setImplementation(state);
+  uint64_t length = 0;
+  AllocationCounter counter;
+  for (auto _ : state) {
+    Buffer::OwnedImpl buffer(Input, InputLength);
+    length += buffer.length();
+  }
+  benchmark::DoNotOptimize(length);
+  reportAllocations(state, counter);
+}
+BENCHMARK(BM_BufferCreateSmall)->Arg(0)->Arg(1);
+
+// Append many small chunks and then drain them, like a codec assembling an output frame.
+static void BM_BufferAddDrain(benchmark::State& state) {
+  setImplementation(state);
+  const uint64_t num_adds = state.range(1);
+  Buffer::OwnedImpl buffer;
+  AllocationCounter counter;
+  for (auto _ : state) {
+    for (uint64_t i = 0; i < num_adds; i++) {
+      buffer.add(Input, InputLength);
+    }
+    buffer.drain(buffer.length());
+  }
+  benchmark::DoNotOptimize(buffer.length());
+  reportAllocations(state, counter);
+}
+BENCHMARK(BM_BufferAddDrain)->Args({0, 1})->Args({1, 1})->Args({0, 100})->Args({1, 100});
+
+// Simulate proxying a body: read it in 16KB chunks, move it to a second buffer and write it out.
+static void BM_BufferProxyBody(benchmark::State& state) {
+  setImplementation(state);
+  const uint64_t body_size = state.range(1);
+  constexpr uint64_t ReadSize = 16384;
+  Buffer::OwnedImpl read_buffer;
+  Buffer::OwnedImpl write_buffer;
+  AllocationCounter counter;
+  for (auto _ : state) {
+    for (uint64_t read = 0; read < body_size; read += ReadSize) {
+      Buffer::RawSlice slices[2];
+      const uint64_t num_slices = read_buffer.reserve(ReadSize, slices, 2);
+      uint64_t remaining = ReadSize;
+      for (uint64_t i = 0; i < num_slices; i++) {
+        slices[i].len_ = std::min<uint64_t>(slices[i].len_, remaining);
+        memset(slices[i].mem_, 'a', slices[i].len_);
+        remaining -= slices[i].len_;
+      }
+      read_buffer.commit(slices, num_slices);
+      write_buffer.move(read_buffer);
+    }
+    write_buffer.drain(write_buffer.length());
+  }
+  benchmark::DoNotOptimize(write_buffer.length());
+  reportAllocations(state, counter);
+}
+BENCHMARK(BM_BufferProxyBody)
+    ->Args({0, 16384})
+    ->Args({1, 16384})
+    ->Args({0, 1 << 20})
+    ->Args({1, 1 << 20});
+
+// Move a fixed amount of data back and forth between two buffers.
+static void BM_BufferMovePartial(benchmark::State& state) {
+  setImplementation(state);
+  const uint64_t move_size = state.range(1);
+  const std::string data(1 << 20, 'a');
+  Buffer::OwnedImpl buffer1(data);
+  Buffer::OwnedImpl buffer2;
+  AllocationCounter counter;
+  for (auto _ : state) {
+    buffer2.move(buffer1, move_size);
+    buffer1.move(buffer2, move_size);
+  }
+  benchmark::DoNotOptimize(buffer1.length());
+  reportAllocations(state, counter);
+}
+BENCHMARK(BM_BufferMovePartial)->Args({0, 100})->Args({1, 100})->Args({0, 65536})->Args({1, 65536});
+
+// Linearize the start of a buffer assembled from many small chunks.
+static void BM_BufferLinearize(benchmark::State& state) {
+  setImplementation(state);
+  const uint64_t linearize_size = state.range(1);
+  for (auto _ : state) {
+    state.PauseTiming();
+    Buffer::OwnedImpl buffer;
+    for (uint64_t i = 0; i < linearize_size / InputLength + 1; i++) {
+      Buffer::OwnedImpl chunk(Input, InputLength);
+      buffer.move(chunk);
+    }
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(buffer.linearize(linearize_size));
+  }
+}
+BENCHMARK(BM_BufferLinearize)->Args({0, 1024})->Args({1, 1024})->Args({0, 16384})->Args({1, 16384});
+
+// Search for a delimiter that lies at the end of a large buffer.
+static void BM_BufferSearch(benchmark::State& state) {
+  setImplementation(state);
+  const std::string data(state.range(1), 'a');
+  Buffer::OwnedImpl buffer(data);
+  buffer.add("\r\n\r\n");
+  ssize_t result = 0;
+  for (auto _ : state) {
+    result += buffer.search("\r\n\r\n", 4, 0);
+  }
+  benchmark::DoNotOptimize(result);
+}
+BENCHMARK(BM_BufferSearch)->Args({0, 16384})->Args({1, 16384});
+
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,400 @@
+#include <random>
+
+#include "common/buffer/buffer_impl.h"
+
+#include "test/common/buffer/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+class DummySlice : public Slice {
+public:
+  DummySlice(const std::string& data, const std::function<void()>& deletion_callback)
+      : Slice(0, data.size(), data.size()), deletion_callback_(deletion_callback) {
+    base_ = reinterpret_cast<uint8_t*>(const_cast<char*>(data.c_str()));
+  }
+  ~DummySlice() override {
+    if (deletion_callback_ != nullptr) {
+      deletion_callback_();
+    }
+  }
+
+private:
+  const std::function<void()> deletion_callback_;
+};
+
+TEST(SliceTest, OwnedSliceCapacity) {
+  SlicePtr slice = OwnedSlice::create(1);
+  EXPECT_EQ(0, slice->dataSize());
+  EXPECT_EQ(4096, slice->reservableSize());
+
+  slice = OwnedSlice::create(0);
+  EXPECT_EQ(4096, slice->reservableSize());
+
+  slice = OwnedSlice::create(4097);
+  EXPECT_EQ(8192, slice->reservableSize());
+
+  slice = OwnedSlice::create(OwnedSlice::slabCapacity() + 1);
+  EXPECT_EQ(OwnedSlice::slabCapacity() + 4096, slice->reservableSize());
+}
+
+TEST(SliceTest, OwnedSliceRecycling) {
+  SlicePtr slice1 = OwnedSlice::create(16384);
+  SlicePtr slice2 = OwnedSlice::create(16384);
+  const uint64_t cached = OwnedSlice::cachedSlabsForTest(16384);
+
+  // Freed slabs go back to the calling thread's free list.
+  slice1.reset();
+  slice2.reset();
+  EXPECT_EQ(cached + 2, OwnedSlice::cachedSlabsForTest(16384));
+
+  // A new slice of the same class is served from the free list.
+  SlicePtr slice3 = OwnedSlice::create(16000);
+  EXPECT_EQ(cached + 1, OwnedSlice::cachedSlabsForTest(16384));
+  EXPECT_EQ(16384, slice3->reservableSize());
+
+  // Slices larger than the slab capacity are never cached.
+  SlicePtr large = OwnedSlice::create(OwnedSlice::slabCapacity() + 1);
+  large.reset();
+  EXPECT_EQ(cached + 1, OwnedSlice::cachedSlabsForTest(16384));
+}
+
+TEST(SliceTest, AppendPrependDrain) {
+  SlicePtr slice = OwnedSlice::create(4096);
+  EXPECT_EQ(5, slice->append("hello", 5));
+  EXPECT_EQ("hello", std::string(reinterpret_cast<const char*>(slice->data()), 5));
+
+  // There's no room in front of the content.
+  EXPECT_EQ(0, slice->prepend("x", 1));
+
+  slice->drain(2);
+  EXPECT_EQ(3, slice->dataSize());
+  EXPECT_EQ(2, slice->prepend("xyz", 3));
+  EXPECT_EQ("yzllo", std::string(reinterpret_cast<const char*>(slice->data()), 5));
+
+  // Draining all content resets the slice so its full capacity is reservable again.
+  slice->drain(5);
+  EXPECT_EQ(0, slice->dataSize());
+  EXPECT_EQ(4096, slice->reservableSize());
+
+  // Prepending to an empty slice puts the content at the end.
+  EXPECT_EQ(3, slice->prepend("abc", 3));
+  EXPECT_EQ(0, slice->reservableSize());
+  EXPECT_EQ(1, slice->prepend("d", 1));
+  EXPECT_EQ("dabc", std::string(reinterpret_cast<const char*>(slice->data()), 4));
+}
+
+TEST(SliceTest, ReserveCommit) {
+  SlicePtr slice = OwnedSlice::create(4096);
+  EXPECT_EQ(nullptr, slice->reserve(0).mem_);
+
+  RawSlice reservation = slice->reserve(10000);
+  EXPECT_NE(nullptr, reservation.mem_);
+  EXPECT_EQ(4096, reservation.len_);
+  memcpy(reservation.mem_, "abcd", 4);
+  reservation.len_ = 4;
+
+  // A reservation from another slice can't be committed.
+  SlicePtr other = OwnedSlice::create(4096);
+  EXPECT_FALSE(other->commit(reservation));
+
+  EXPECT_TRUE(slice->commit(reservation));
+  EXPECT_EQ(4, slice->dataSize());
+  EXPECT_EQ(4092, slice->reservableSize());
+
+  // Committing the same reservation twice fails since the reservable section has moved.
+  EXPECT_FALSE(slice->commit(reservation));
+
+  // A slice with an outstanding reservation keeps its Data section in place when drained.
+  reservation = slice->reserve(1);
+  slice->drain(4);
+  EXPECT_EQ(0, slice->prepend("x", 1));
+  EXPECT_TRUE(slice->commit(reservation));
+  EXPECT_EQ(1, slice->dataSize());
+}
+
+TEST(UnownedSliceTest, CreateDelete) {
+  constexpr char input[] = "hello world";
+  bool release_callback_called = false;
+  BufferFragmentImpl fragment(
+      input, sizeof(input) - 1,
+      [&release_callback_called](const void*, size_t, const BufferFragmentImpl*) {
+        release_callback_called = true;
+      });
+  auto slice = std::make_unique<UnownedSlice>(fragment);
+  EXPECT_EQ(11, slice->dataSize());
+  EXPECT_EQ(0, slice->reservableSize());
+  EXPECT_EQ(0, slice->append("x", 1));
+  EXPECT_EQ(0, slice->prepend("x", 1));
+  EXPECT_EQ(0, memcmp(slice->data(), input, slice->dataSize()));
+  EXPECT_FALSE(release_callback_called);
+  slice.reset(nullptr);
+  EXPECT_TRUE(release_callback_called);
+}
+
+TEST(SliceDequeTest, CreateDelete) {
+  bool slice1_deleted = false;
+  bool slice2_deleted = false;
+  bool slice3_deleted = false;
+
+  {
+    // Create an empty deque.
+    SliceDeque slices;
+    EXPECT_TRUE(slices.empty());
+    EXPECT_EQ(0, slices.size());
+
+    // Append a slice and verify that the deque is no longer empty.
+    SlicePtr slice1(new DummySlice("slice1", [&slice1_deleted]() { slice1_deleted = true; }));
+    slices.emplace_back(std::move(slice1));
+    EXPECT_FALSE(slices.empty());
+    ASSERT_EQ(1, slices.size());
+    EXPECT_FALSE(slice1_deleted);
+    EXPECT_EQ(6, slices.front()->dataSize());
+
+    // Append another slice and verify the size.
+    SlicePtr slice2(new DummySlice("slice2", [&slice2_deleted]() { slice2_deleted = true; }));
+    slices.emplace_back(std::move(slice2));
+    EXPECT_FALSE(slices.empty());
+    ASSERT_EQ(2, slices.size());
+    EXPECT_FALSE(slice2_deleted);
+
+    // Prepend a slice and verify the size.
+    SlicePtr slice3(new DummySlice("slice3", [&slice3_deleted]() { slice3_deleted = true; }));
+    slices.emplace_front(std::move(slice3));
+    EXPECT_FALSE(slices.empty());
+    ASSERT_EQ(3, slices.size());
+    EXPECT_FALSE(slice3_deleted);
+
+    // Remove the first slice and verify that it was deleted.
+    slices.pop_front();
+    ASSERT_EQ(2, slices.size());
+    EXPECT_TRUE(slice3_deleted);
+    EXPECT_FALSE(slice1_deleted);
+    EXPECT_FALSE(slice2_deleted);
+
+    // Remove the last slice and verify that it was deleted.
+    slices.pop_back();
+    ASSERT_EQ(1, slices.size());
+    EXPECT_TRUE(slice2_deleted);
+    EXPECT_FALSE(slice1_deleted);
+  }
+
+  // Verify that the remaining slice was deleted when the deque went out of scope.
+  EXPECT_TRUE(slice1_deleted);
+}
+
+TEST(SliceDequeTest, GrowRing) {
+  SliceDeque slices;
+  // Interleave front and back insertions so the ring wraps before it grows.
+  for (uint64_t i = 0; i < 50; i++) {
+    const std::string content = absl::StrCat(i);
+    SlicePtr slice = OwnedSlice::create(content.data(), content.size());
+    if (i % 2 == 0) {
+      slices.emplace_back(std::move(slice));
+    } else {
+      slices.emplace_front(std::move(slice));
+    }
+  }
+  ASSERT_EQ(50, slices.size());
+  std::string contents;
+  for (size_t i = 0; i < slices.size(); i++) {
+    contents.append(reinterpret_cast<const char*>(slices[i]->data()), slices[i]->dataSize());
+  }
+  std::string expected;
+  for (int i = 49; i >= 0; i -= 2) {
+    absl::StrAppend(&expected, i);
+  }
+  for (int i = 0; i < 50; i += 2) {
+    absl::StrAppend(&expected, i);
+  }
+  EXPECT_EQ(expected, contents);
+}
+
+TEST(OwnedImplTest, Pin) {
+  OwnedImpl source;
+  OwnedImpl first("hello ");
+  OwnedImpl second("pinned world");
+  source.move(first);
+  source.move(second);
+  RawSlice source_slices[2];
+  ASSERT_EQ(2, source.getRawSlices(source_slices, 2));
+
+  // The first slice is moved whole, and the second is moved with a copy of its tail left behind.
+  OwnedImpl pinned;
+  pinned.pin(source, 12);
+  EXPECT_EQ(" world", source.toString());
+  EXPECT_EQ(18, pinned.length());
+  RawSlice pinned_slices[2];
+  ASSERT_EQ(2, pinned.getRawSlices(pinned_slices, 2));
+  EXPECT_EQ(source_slices[0].mem_, pinned_slices[0].mem_);
+  EXPECT_EQ(source_slices[1].mem_, pinned_slices[1].mem_);
+
+  source.drain(source.length());
+  source.add("other");
+  EXPECT_EQ("hello pinned world", pinned.toString());
+
+  pinned.pin(source, 5);
+  EXPECT_EQ(0, source.length());
+  EXPECT_EQ("hello pinned worldother", pinned.toString());
+}
+
+TEST(OwnedImplTest, MovePartialSharesSlice) {
+  const std::string content(16384, 'a');
+  OwnedImpl source(content + "b");
+  RawSlice source_slice;
+  ASSERT_EQ(1, source.getRawSlices(&source_slice, 1));
+
+  // Moving most of a slice shares its storage rather than copying it.
+  OwnedImpl destination;
+  destination.move(source, 8192);
+  RawSlice destination_slice;
+  ASSERT_EQ(1, destination.getRawSlices(&destination_slice, 1));
+  EXPECT_EQ(source_slice.mem_, destination_slice.mem_);
+  RawSlice remaining_slice;
+  ASSERT_EQ(1, source.getRawSlices(&remaining_slice, 1));
+  EXPECT_EQ(static_cast<uint8_t*>(source_slice.mem_) + 8192, remaining_slice.mem_);
+
+  // Neither part can be appended to in place, so the content of the other part stays intact.
+  destination.add("c");
+  source.prepend("d");
+  EXPECT_EQ(content.substr(0, 8192) + "c", destination.toString());
+  EXPECT_EQ("d" + content.substr(8192) + "b", source.toString());
+
+  // The storage outlives the buffer that it was moved from.
+  source.drain(source.length());
+  source = OwnedImpl();
+  EXPECT_EQ(content.substr(0, 8192) + "c", destination.toString());
+
+  // Moving a small part of a slice copies it.
+  OwnedImpl small("hello world");
+  destination.move(small, 5);
+  EXPECT_EQ(content.substr(0, 8192) + "chello", destination.toString());
+  EXPECT_EQ(" world", small.toString());
+}
+
+TEST(OwnedImplTest, ShareReferencesLargeSlices) {
+  const std::string content(16384, 'a');
+  OwnedImpl source(content);
+  OwnedImpl small("hello");
+  source.move(small);
+  RawSlice source_slices[2];
+  ASSERT_EQ(2, source.getRawSlices(source_slices, 2));
+
+  // The large slice is shared and the small one is copied. The source keeps its content.
+  OwnedImpl shared;
+  shared.share(source);
+  EXPECT_EQ(content + "hello", source.toString());
+  EXPECT_EQ(content + "hello", shared.toString());
+  RawSlice shared_slices[2];
+  ASSERT_EQ(2, shared.getRawSlices(shared_slices, 2));
+  EXPECT_EQ(source_slices[0].mem_, shared_slices[0].mem_);
+  EXPECT_NE(source_slices[1].mem_, shared_slices[1].mem_);
+
+  // Copies of either buffer reference the shared slice too.
+  OwnedImpl copy(source);
+  RawSlice copy_slices[2];
+  ASSERT_EQ(2, copy.getRawSlices(copy_slices, 2));
+  EXPECT_EQ(source_slices[0].mem_, copy_slices[0].mem_);
+
+  // Draining and appending to one buffer leaves the others intact, and the storage outlives the
+  // buffer that it was shared from.
+  shared.drain(8192);
+  shared.add("b");
+  source.drain(source.length());
+  source = OwnedImpl();
+  EXPECT_EQ(content.substr(8192) + "hellob", shared.toString());
+  EXPECT_EQ(content + "hello", copy.toString());
+}
+
+// Apply the same random sequence of operations to an evbuffer based and a slice based buffer and
+// verify that their content never diverges.
+TEST(BufferImplementationTest, RandomOperationsMatch) {
+  const bool prior_use_old_impl = OwnedImpl::usingOldImpl();
+  OwnedImpl::useOldImpl(true);
+  OwnedImpl old_buffer;
+  OwnedImpl old_other;
+  OwnedImpl::useOldImpl(false);
+  OwnedImpl new_buffer;
+  OwnedImpl new_other;
+  OwnedImpl::useOldImpl(prior_use_old_impl);
+
+  std::mt19937 prng(1); // PRNG with a fixed seed, for repeatability
+  std::uniform_int_distribution<uint64_t> size_distribution(0, 20000);
+  for (uint64_t i = 0; i < 2000; i++) {
+    const uint64_t size = size_distribution(prng);
+    const std::string data(size, 'a' + i % 26);
+    switch (prng() % 8) {
+    case 0:
+      old_buffer.add(data);
+      new_buffer.add(data);
+      break;
+    case 1:
+      old_buffer.prepend(data);
+      new_buffer.prepend(data);
+      break;
+    case 2: {
+      const uint64_t drain_size = std::min(size, old_buffer.length());
+      old_buffer.drain(drain_size);
+      new_buffer.drain(drain_size);
+      break;
+    }
+    case 3:
+      old_other.add(data);
+      new_other.add(data);
+      old_buffer.move(old_other);
+      new_buffer.move(new_other);
+      break;
+    case 4: {
+      old_other.add(data);
+      new_other.add(data);
+      const uint64_t move_size = old_other.length() / 2;
+      old_buffer.move(old_other, move_size);
+      new_buffer.move(new_other, move_size);
+      break;
+    }
+    case 5: {
+      const uint32_t linearize_size = std::min(size, old_buffer.length());
+      if (linearize_size == 0) {
+        break;
+      }
+      ASSERT_EQ(0, memcmp(old_buffer.linearize(linearize_size),
+                          new_buffer.linearize(linearize_size), linearize_size));
+      break;
+    }
+    case 6: {
+      if (size == 0) {
+        break;
+      }
+      for (OwnedImpl* buffer : {&old_buffer, &new_buffer}) {
+        RawSlice iovecs[2];
+        const uint64_t num_reserved = buffer->reserve(size, iovecs, 2);
+        uint64_t remaining = size;
+        for (uint64_t j = 0; j < num_reserved; j++) {
+          iovecs[j].len_ = std::min<uint64_t>(iovecs[j].len_, remaining);
+          memset(iovecs[j].mem_, 'z', iovecs[j].len_);
+          remaining -= iovecs[j].len_;
+        }
+        buffer->commit(iovecs, num_reserved);
+      }
+      break;
+    }
+    case 7: {
+      const std::string needle = data.substr(0, 3) + "z";
+      ASSERT_EQ(old_buffer.search(needle.data(), needle.size(), 0),
+                new_buffer.search(needle.data(), needle.size(), 0));
+      break;
+    }
+    }
+    ASSERT_EQ(old_buffer.length(), new_buffer.length());
+    ASSERT_EQ(old_other.length(), new_other.length());
+  }
+  EXPECT_EQ(old_buffer.toString(), new_buffer.toString());
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
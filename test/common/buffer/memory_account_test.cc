@@ -0,0 +1,113 @@
+#include "common/buffer/memory_account.h"
+
+#include "test/mocks/event/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+class TestMemoryAccount : public MemoryAccount {
+public:
+  TestMemoryAccount(Event::Dispatcher& dispatcher, const std::string& name)
+      : MemoryAccount(dispatcher), name_(name) {}
+
+  // Buffer::MemoryAccount
+  std::string describe() const override { return name_; }
+  void resetOwner() override { resets_++; }
+
+  const std::string name_;
+  uint32_t resets_{};
+};
+
+class MemoryAccountTest : public testing::Test {
+public:
+  MemoryAccountTest() {
+    ON_CALL(dispatcher_, post(_)).WillByDefault(Invoke([this](Event::PostCb cb) {
+      posted_.push_back(cb);
+    }));
+  }
+
+  void runPosted() {
+    for (auto& cb : posted_) {
+      cb();
+    }
+    posted_.clear();
+  }
+
+  MemoryAccountRegistry& registry_{MemoryAccountRegistrySingleton::get()};
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  std::vector<Event::PostCb> posted_;
+};
+
+TEST_F(MemoryAccountTest, ChargeAndCredit) {
+  TestMemoryAccount account(dispatcher_, "account");
+  account.charge(10);
+  account.charge(5);
+  EXPECT_EQ(15, account.balance());
+  account.credit(15);
+  EXPECT_EQ(0, account.balance());
+}
+
+TEST_F(MemoryAccountTest, Largest) {
+  TestMemoryAccount small(dispatcher_, "small");
+  TestMemoryAccount large(dispatcher_, "large");
+  TestMemoryAccount medium(dispatcher_, "medium");
+  TestMemoryAccount empty(dispatcher_, "empty");
+  small.charge(1);
+  large.charge(100);
+  medium.charge(10);
+
+  std::vector<MemoryConsumer> consumers = registry_.largest(2);
+  ASSERT_EQ(2, consumers.size());
+  EXPECT_EQ("large", consumers[0].description_);
+  EXPECT_EQ(100, consumers[0].bytes_);
+  EXPECT_EQ("medium", consumers[1].description_);
+  EXPECT_EQ(10, consumers[1].bytes_);
+
+  // Accounts that never held memory are not registered, and closed ones are removed.
+  large.close();
+  consumers = registry_.largest(10);
+  ASSERT_EQ(2, consumers.size());
+  EXPECT_EQ("medium", consumers[0].description_);
+  EXPECT_EQ("small", consumers[1].description_);
+
+  // A closed account is not registered again.
+  large.charge(1);
+  EXPECT_EQ(2, registry_.largest(10).size());
+}
+
+TEST_F(MemoryAccountTest, ResetLargest) {
+  TestMemoryAccount small(dispatcher_, "small");
+  TestMemoryAccount large(dispatcher_, "large");
+  small.charge(1);
+  large.charge(100);
+
+  EXPECT_EQ(1, registry_.resetLargest(1));
+  ASSERT_EQ(1, posted_.size());
+  EXPECT_EQ(0, large.resets_);
+  runPosted();
+  EXPECT_EQ(1, large.resets_);
+  EXPECT_EQ(0, small.resets_);
+
+  // Owners that went away before the reset ran are skipped.
+  EXPECT_EQ(2, registry_.resetLargest(10));
+  large.close();
+  runPosted();
+  EXPECT_EQ(1, large.resets_);
+  EXPECT_EQ(1, small.resets_);
+
+  // Accounts which no longer hold memory are not reset.
+  small.credit(1);
+  EXPECT_EQ(0, registry_.resetLargest(10));
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
@@ -1,6 +1,7 @@
 #include "common/api/os_sys_calls_impl.h"
 #include "common/buffer/buffer_impl.h"
 
+#include "test/common/buffer/utility.h"
 #include "test/mocks/api/mocks.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 
@@ -15,14 +16,15 @@ namespace Envoy {
 namespace Buffer {
 namespace {
 
-class OwnedImplTest : public testing::Test {
+class OwnedImplTest : public BufferImplementationParamTest {
 public:
-  OwnedImplTest() {}
-
   bool release_callback_called_ = false;
 };
 
-TEST_F(OwnedImplTest, AddBufferFragmentNoCleanup) {
+INSTANTIATE_TEST_CASE_P(OwnedImplTest, OwnedImplTest,
+                        testing::ValuesIn({BufferImplementation::Old, BufferImplementation::New}));
+
+TEST_P(OwnedImplTest, AddBufferFragmentNoCleanup) {
   char input[] = "hello world";
   BufferFragmentImpl frag(input, 11, nullptr);
   Buffer::OwnedImpl buffer;
@@ -33,7 +35,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentNoCleanup) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, AddBufferFragmentWithCleanup) {
+TEST_P(OwnedImplTest, AddBufferFragmentWithCleanup) {
   char input[] = "hello world";
   BufferFragmentImpl frag(input, 11, [this](const void*, size_t, const BufferFragmentImpl*) {
     release_callback_called_ = true;
@@ -51,7 +53,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentWithCleanup) {
   EXPECT_TRUE(release_callback_called_);
 }
 
-TEST_F(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
+TEST_P(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
   char input_stack[] = "hello world";
   char* input = new char[11];
   std::copy(input_stack, input_stack + 11, input);
@@ -76,7 +78,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
   EXPECT_TRUE(release_callback_called_);
 }
 
-TEST_F(OwnedImplTest, Prepend) {
+TEST_P(OwnedImplTest, Prepend) {
   std::string suffix = "World!", prefix = "Hello, ";
   Buffer::OwnedImpl buffer;
   buffer.add(suffix);
@@ -86,7 +88,7 @@ TEST_F(OwnedImplTest, Prepend) {
   EXPECT_EQ(prefix + suffix, buffer.toString());
 }
 
-TEST_F(OwnedImplTest, PrependToEmptyBuffer) {
+TEST_P(OwnedImplTest, PrependToEmptyBuffer) {
   std::string data = "Hello, World!";
   Buffer::OwnedImpl buffer;
   buffer.prepend(data);
@@ -100,7 +102,29 @@ TEST_F(OwnedImplTest, PrependToEmptyBuffer) {
   EXPECT_EQ(data, buffer.toString());
 }
 
-TEST_F(OwnedImplTest, PrependBuffer) {
+// Prepending in front of partly drained read-only slices must not write into the referenced
+// storage.
+TEST_P(OwnedImplTest, PrependToReadOnlySlices) {
+  char input[] = "hello world";
+  BufferFragmentImpl frag(input, 11, nullptr);
+  Buffer::OwnedImpl buffer;
+  buffer.addBufferFragment(frag);
+  buffer.drain(6);
+  buffer.prepend("hi ");
+  EXPECT_EQ("hi world", buffer.toString());
+  EXPECT_STREQ("hello world", input);
+
+  const std::string long_string(8192, 'a');
+  Buffer::OwnedImpl source(long_string);
+  Buffer::OwnedImpl copy;
+  copy.share(source);
+  copy.drain(10);
+  copy.prepend("bbb");
+  EXPECT_EQ("bbb" + long_string.substr(10), copy.toString());
+  EXPECT_EQ(long_string, source.toString());
+}
+
+TEST_P(OwnedImplTest, PrependBuffer) {
   std::string suffix = "World!", prefix = "Hello, ";
   Buffer::OwnedImpl buffer;
   buffer.add(suffix);
@@ -114,7 +138,7 @@ TEST_F(OwnedImplTest, PrependBuffer) {
   EXPECT_EQ(0, prefixBuffer.length());
 }
 
-TEST_F(OwnedImplTest, Write) {
+TEST_P(OwnedImplTest, Write) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
@@ -152,7 +176,31 @@ TEST_F(OwnedImplTest, Write) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, Read) {
+TEST_P(OwnedImplTest, WriteGathersSlices) {
+  Api::MockOsSysCalls os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  // Build a buffer out of more slices than one writev() takes.
+  Buffer::OwnedImpl buffer;
+  for (int i = 0; i < 100; i++) {
+    Buffer::OwnedImpl slice(std::string(10, 'a'));
+    buffer.move(slice);
+  }
+
+  EXPECT_CALL(os_sys_calls, writev(_, _, 64))
+      .WillOnce(Return(Api::SysCallSizeResult{640, 0}));
+  Api::SysCallIntResult result = buffer.write(-1);
+  EXPECT_EQ(640, result.rc_);
+  EXPECT_EQ(360, buffer.length());
+
+  EXPECT_CALL(os_sys_calls, writev(_, _, 36))
+      .WillOnce(Return(Api::SysCallSizeResult{360, 0}));
+  result = buffer.write(-1);
+  EXPECT_EQ(360, result.rc_);
+  EXPECT_EQ(0, buffer.length());
+}
+
+TEST_P(OwnedImplTest, Read) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
@@ -173,7 +221,213 @@ TEST_F(OwnedImplTest, Read) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, ToString) {
+// Emptied buffers hand their slabs back to the thread's free list rather than keeping them.
+TEST(OwnedImplNewTest, EmptyBufferReleasesStorage) {
+  Api::MockOsSysCalls os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  Buffer::OwnedImpl buffer;
+
+  // Fill the reserved slab, and reserve another with a read that finds no data.
+  EXPECT_CALL(os_sys_calls, readv(_, _, _))
+      .WillOnce(Return(Api::SysCallSizeResult{16384, 0}))
+      .WillOnce(Return(Api::SysCallSizeResult{-1, EAGAIN}));
+  EXPECT_EQ(16384, buffer.read(-1, 16384).rc_);
+  EXPECT_EQ(-1, buffer.read(-1, 16384).rc_);
+
+  // Draining the data releases the full slab and the unused one.
+  const uint64_t cached = OwnedSlice::cachedSlabsForTest(16384);
+  buffer.drain(16384);
+  EXPECT_EQ(cached + 2, OwnedSlice::cachedSlabsForTest(16384));
+
+  // A read that finds no data in an empty buffer doesn't keep the slab it reserved.
+  EXPECT_CALL(os_sys_calls, readv(_, _, _)).WillOnce(Return(Api::SysCallSizeResult{-1, EAGAIN}));
+  EXPECT_EQ(-1, buffer.read(-1, 16384).rc_);
+  EXPECT_EQ(cached + 2, OwnedSlice::cachedSlabsForTest(16384));
+  EXPECT_EQ(0, buffer.length());
+}
+
+// Emptying a buffer keeps the slices of an outstanding reservation, so that its commit isn't lost.
+TEST(OwnedImplNewTest, ReserveDrainCommit) {
+  Buffer::OwnedImpl buffer;
+  buffer.add("abc", 3);
+  RawSlice iovec;
+  ASSERT_EQ(1, buffer.reserve(16384, &iovec, 1));
+  buffer.drain(3);
+  EXPECT_EQ(0, buffer.length());
+
+  memcpy(iovec.mem_, "hello", 5);
+  iovec.len_ = 5;
+  buffer.commit(&iovec, 1);
+  EXPECT_EQ(5, buffer.length());
+  EXPECT_EQ("hello", buffer.toString());
+}
+
+TEST_P(OwnedImplTest, AddEmptyFragment) {
+  char input[] = "hello world";
+  BufferFragmentImpl frag1(input, 11, [](const void*, size_t, const BufferFragmentImpl*) {});
+  BufferFragmentImpl frag2("", 0, [this](const void*, size_t, const BufferFragmentImpl*) {
+    release_callback_called_ = true;
+  });
+  Buffer::OwnedImpl buffer;
+  buffer.addBufferFragment(frag1);
+  EXPECT_EQ(11, buffer.length());
+
+  buffer.addBufferFragment(frag2);
+  EXPECT_EQ(11, buffer.length());
+
+  buffer.drain(11);
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_TRUE(release_callback_called_);
+}
+
+TEST_P(OwnedImplTest, MoveFragmentKeepsReference) {
+  char input[] = "hello world";
+  BufferFragmentImpl frag(input, 11, [this](const void*, size_t, const BufferFragmentImpl*) {
+    release_callback_called_ = true;
+  });
+  Buffer::OwnedImpl buffer1;
+  buffer1.add("abc");
+  buffer1.addBufferFragment(frag);
+
+  Buffer::OwnedImpl buffer2;
+  buffer2.move(buffer1);
+  EXPECT_EQ(0, buffer1.length());
+  EXPECT_EQ(14, buffer2.length());
+  EXPECT_FALSE(release_callback_called_);
+  EXPECT_EQ("abchello world", buffer2.toString());
+
+  buffer2.drain(14);
+  EXPECT_TRUE(release_callback_called_);
+}
+
+TEST_P(OwnedImplTest, MovePartial) {
+  Buffer::OwnedImpl buffer1;
+  Buffer::OwnedImpl buffer2;
+  const std::string long_string(20000, 'a');
+  buffer1.add("hello");
+  buffer1.add(long_string);
+  buffer1.add("world");
+
+  buffer2.move(buffer1, 3);
+  EXPECT_EQ("hel", buffer2.toString());
+  buffer2.move(buffer1, 2 + long_string.size() + 1);
+  EXPECT_EQ("hello" + long_string + "w", buffer2.toString());
+  EXPECT_EQ("orld", buffer1.toString());
+  buffer2.move(buffer1, 4);
+  EXPECT_EQ(0, buffer1.length());
+  EXPECT_EQ("hello" + long_string + "world", buffer2.toString());
+}
+
+TEST_P(OwnedImplTest, ReserveCommit) {
+  Buffer::OwnedImpl buffer;
+  RawSlice iovecs[2];
+
+  // Reserve and commit less than the reservation.
+  uint64_t num_reserved = buffer.reserve(100, iovecs, 2);
+  ASSERT_GE(num_reserved, 1);
+  ASSERT_GE(iovecs[0].len_, 100);
+  memcpy(iovecs[0].mem_, "hello", 5);
+  iovecs[0].len_ = 5;
+  buffer.commit(iovecs, 1);
+  EXPECT_EQ("hello", buffer.toString());
+
+  // A reservation that doesn't fit in the remaining space of the last slice.
+  num_reserved = buffer.reserve(40000, iovecs, 2);
+  uint64_t reserved = 0;
+  for (uint64_t i = 0; i < num_reserved; i++) {
+    memset(iovecs[i].mem_, 'x', iovecs[i].len_);
+    reserved += iovecs[i].len_;
+  }
+  EXPECT_GE(reserved, 40000);
+  buffer.commit(iovecs, num_reserved);
+  EXPECT_EQ(5 + reserved, buffer.length());
+  EXPECT_EQ("hello" + std::string(reserved, 'x'), buffer.toString());
+
+  // Reserving with a single iovec always yields a single contiguous reservation.
+  num_reserved = buffer.reserve(20000, iovecs, 1);
+  EXPECT_EQ(1, num_reserved);
+  EXPECT_GE(iovecs[0].len_, 20000);
+  iovecs[0].len_ = 0;
+  buffer.commit(iovecs, 1);
+  EXPECT_EQ(5 + reserved, buffer.length());
+}
+
+TEST_P(OwnedImplTest, Linearize) {
+  Buffer::OwnedImpl buffer;
+  const std::string a(10000, 'a');
+  const std::string b(10000, 'b');
+  buffer.add(a);
+  buffer.add(b);
+  buffer.drain(1);
+  const std::string expected = a.substr(1) + b;
+  EXPECT_EQ(expected.substr(0, 15000),
+            std::string(static_cast<const char*>(buffer.linearize(15000)), 15000));
+  EXPECT_EQ(expected.size(), buffer.length());
+  EXPECT_EQ(expected, buffer.toString());
+}
+
+TEST_P(OwnedImplTest, Search) {
+  char input[] = "fragment";
+  BufferFragmentImpl frag(input, 8, nullptr);
+  Buffer::OwnedImpl buffer;
+  buffer.add("abcde");
+  buffer.addBufferFragment(frag);
+  buffer.add("fgh", 3);
+
+  EXPECT_EQ(0, buffer.search("abc", 3, 0));
+  EXPECT_EQ(-1, buffer.search("abc", 3, 1));
+  // Matches spanning slices.
+  EXPECT_EQ(3, buffer.search("defr", 4, 0));
+  EXPECT_EQ(12, buffer.search("tfg", 3, 0));
+  EXPECT_EQ(-1, buffer.search("tfgx", 4, 0));
+  EXPECT_EQ(-1, buffer.search("hi", 2, 0));
+  EXPECT_EQ(15, buffer.search("h", 1, 0));
+  EXPECT_EQ(2, buffer.search("", 0, 2));
+  EXPECT_EQ(-1, buffer.search("a", 1, 100));
+}
+
+TEST_P(OwnedImplTest, CopyOutAcrossSlices) {
+  char input[] = "fragment";
+  BufferFragmentImpl frag(input, 8, nullptr);
+  Buffer::OwnedImpl buffer;
+  buffer.add("abcde");
+  buffer.addBufferFragment(frag);
+  buffer.add("fgh", 3);
+
+  char out[10];
+  buffer.copyOut(3, sizeof(out), out);
+  EXPECT_EQ("defragment", std::string(out, sizeof(out)));
+  buffer.copyOut(13, 3, out);
+  EXPECT_EQ("fgh", std::string(out, 3));
+}
+
+TEST_P(OwnedImplTest, PrependLarge) {
+  Buffer::OwnedImpl buffer;
+  const std::string suffix = "suffix";
+  const std::string prefix(20000, 'p');
+  buffer.add(suffix);
+  buffer.prepend(prefix);
+  buffer.prepend("x");
+  EXPECT_EQ("x" + prefix + suffix, buffer.toString());
+}
+
+TEST_P(OwnedImplTest, GetRawSlicesSkipsEmpty) {
+  Buffer::OwnedImpl buffer;
+  RawSlice iovecs[2];
+  const uint64_t num_reserved = buffer.reserve(100, iovecs, 2);
+  buffer.commit(iovecs, 0);
+  UNREFERENCED_PARAMETER(num_reserved);
+  EXPECT_EQ(0, buffer.getRawSlices(nullptr, 0));
+  EXPECT_EQ(0, buffer.length());
+
+  buffer.add("hello");
+  RawSlice out[1];
+  EXPECT_EQ(1, buffer.getRawSlices(out, 1));
+  EXPECT_EQ("hello", std::string(static_cast<const char*>(out[0].mem_), out[0].len_));
+}
+
+TEST_P(OwnedImplTest, ToString) {
   Buffer::OwnedImpl buffer;
   EXPECT_EQ("", buffer.toString());
   auto append = [&buffer](absl::string_view str) { buffer.add(str.data(), str.size()); };
@@ -188,6 +442,20 @@ TEST_F(OwnedImplTest, ToString) {
   EXPECT_EQ(absl::StrCat("Hello, world!" + long_string), buffer.toString());
 }
 
+TEST_P(OwnedImplTest, MoveConstructAndAssign) {
+  Buffer::OwnedImpl source("hello");
+  Buffer::OwnedImpl moved(std::move(source));
+  EXPECT_EQ("hello", moved.toString());
+  EXPECT_EQ(0, source.length());
+
+  moved = Buffer::OwnedImpl("world");
+  EXPECT_EQ("world", moved.toString());
+
+  // The moved from buffer is still usable.
+  source.add("again");
+  EXPECT_EQ("again", source.toString());
+}
+
 } // namespace
 } // namespace Buffer
 } // namespace Envoy
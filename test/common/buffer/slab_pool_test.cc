@@ -0,0 +1,87 @@
+#include <cstdint>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/buffer/slab_pool.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+// Blocks are aligned, owned by the pool, and recycled per size class.
+TEST(SlabPoolTest, AllocateRelease) {
+  SlabPool pool(1);
+  ASSERT_EQ(SlabPool::HugePageSize, pool.size());
+
+  void* block = pool.allocate(0, 100);
+  ASSERT_NE(nullptr, block);
+  EXPECT_TRUE(pool.owns(block));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(block) % 64);
+  EXPECT_EQ(128, pool.allocatedBytes());
+
+  int on_stack;
+  EXPECT_FALSE(pool.owns(&on_stack));
+
+  pool.release(0, 100, block);
+  EXPECT_EQ(0, pool.allocatedBytes());
+  void* other_class = pool.allocate(1, 100);
+  EXPECT_NE(block, other_class);
+  EXPECT_EQ(block, pool.allocate(0, 100));
+  EXPECT_EQ(0, pool.fallbacks());
+}
+
+// Allocations fail once the pool is exhausted, until blocks are released.
+TEST(SlabPoolTest, Exhausted) {
+  SlabPool pool(SlabPool::HugePageSize);
+  const uint64_t block_size = SlabPool::HugePageSize / 16;
+  std::vector<void*> blocks;
+  for (uint32_t i = 0; i < 16; ++i) {
+    blocks.push_back(pool.allocate(0, block_size));
+    ASSERT_NE(nullptr, blocks.back());
+  }
+  EXPECT_EQ(nullptr, pool.allocate(0, block_size));
+  EXPECT_EQ(nullptr, pool.allocate(1, 64));
+  EXPECT_EQ(2, pool.fallbacks());
+
+  pool.release(0, block_size, blocks.back());
+  EXPECT_EQ(blocks.back(), pool.allocate(0, block_size));
+  EXPECT_EQ(SlabPool::HugePageSize, pool.allocatedBytes());
+}
+
+// Once the process-wide pool is reserved, slices whose thread has no cached slab are carved from
+// it, and are returned to it once the thread's slab cache is full.
+TEST(SlabPoolTest, OwnedSlices) {
+  SlabPool::initialize(4 * SlabPool::HugePageSize);
+  SlabPool* pool = SlabPool::get();
+  ASSERT_NE(nullptr, pool);
+  ASSERT_NE(0, pool->size());
+
+  // Later calls keep the existing pool.
+  SlabPool::initialize(SlabPool::HugePageSize);
+  EXPECT_EQ(pool, SlabPool::get());
+
+  uint64_t allocated_bytes;
+  {
+    std::vector<SlicePtr> slices;
+    for (uint32_t i = 0; i < 80; ++i) {
+      slices.push_back(OwnedSlice::create(4096));
+      EXPECT_TRUE(pool->owns(slices.back()->data()));
+    }
+    allocated_bytes = pool->allocatedBytes();
+    EXPECT_LT(80 * 4096, allocated_bytes);
+  }
+  EXPECT_EQ(64, OwnedSlice::cachedSlabsForTest(4096));
+  EXPECT_GT(allocated_bytes, pool->allocatedBytes());
+  EXPECT_LT(64 * 4096, pool->allocatedBytes());
+
+  OwnedImpl buffer(std::string(100, 'a'));
+  Buffer::RawSlice slice;
+  ASSERT_EQ(1, buffer.getRawSlices(&slice, 1));
+  EXPECT_TRUE(pool->owns(slice.mem_));
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "common/buffer/buffer_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * The buffer implementations a test can be run against.
+ */
+enum class BufferImplementation {
+  // The evbuffer based implementation.
+  Old,
+  // The native slice based implementation.
+  New,
+};
+
+/**
+ * Base class for tests that are parameterized based on BufferImplementation. Buffers constructed
+ * within the test use the implementation selected by the test parameter.
+ */
+class BufferImplementationParamTest : public testing::TestWithParam<BufferImplementation> {
+protected:
+  BufferImplementationParamTest() {
+    prior_use_old_impl_ = OwnedImpl::usingOldImpl();
+    OwnedImpl::useOldImpl(GetParam() == BufferImplementation::Old);
+  }
+
+  virtual ~BufferImplementationParamTest() { OwnedImpl::useOldImpl(prior_use_old_impl_); }
+
+private:
+  bool prior_use_old_impl_;
+};
+
+} // namespace Buffer
+} // namespace Envoy
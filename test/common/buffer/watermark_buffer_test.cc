@@ -3,8 +3,14 @@
 #include "common/buffer/buffer_impl.h"
 #include "common/buffer/watermark_buffer.h"
 
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+
 #include "gtest/gtest.h"
 
+using testing::Invoke;
+using testing::NiceMock;
+
 namespace Envoy {
 namespace Buffer {
 namespace {
@@ -52,6 +58,17 @@ TEST_F(WatermarkBufferTest, AddString) {
   EXPECT_EQ(11, buffer_.length());
 }
 
+TEST_F(WatermarkBufferTest, AddBufferFragment) {
+  BufferFragmentImpl first(TEN_BYTES, 10, nullptr);
+  buffer_.addBufferFragment(first);
+  EXPECT_EQ(0, times_high_watermark_called_);
+  BufferFragmentImpl second(TEN_BYTES, 1, nullptr);
+  buffer_.addBufferFragment(second);
+  EXPECT_EQ(1, times_high_watermark_called_);
+  EXPECT_EQ(11, buffer_.length());
+  buffer_.drain(11);
+}
+
 TEST_F(WatermarkBufferTest, AddBuffer) {
   OwnedImpl first(TEN_BYTES);
   buffer_.add(first);
@@ -270,6 +287,136 @@ TEST_F(WatermarkBufferTest, MoveBackWithWatermarks) {
   EXPECT_EQ(1, low_watermark_buffer1);
 }
 
+class TestMemoryAccount : public MemoryAccount {
+public:
+  TestMemoryAccount(Event::Dispatcher& dispatcher) : MemoryAccount(dispatcher) {}
+
+  // Buffer::MemoryAccount
+  std::string describe() const override { return "test"; }
+  void resetOwner() override {}
+};
+
+TEST_F(WatermarkBufferTest, ChargesAccount) {
+  Event::MockDispatcher dispatcher;
+  TestMemoryAccount account(dispatcher);
+  buffer_.add(TEN_BYTES, 4);
+  buffer_.setAccount(&account);
+  EXPECT_EQ(4, account.balance());
+
+  buffer_.add(TEN_BYTES, 10);
+  EXPECT_EQ(14, account.balance());
+  buffer_.drain(6);
+  EXPECT_EQ(8, account.balance());
+
+  {
+    // Moving data charges the receiving buffer and credits the moved from one.
+    TestMemoryAccount account1(dispatcher);
+    Buffer::WatermarkBuffer buffer1{[]() -> void {}, []() -> void {}};
+    buffer1.setAccount(&account1);
+    buffer1.move(buffer_, 5);
+    EXPECT_EQ(3, account.balance());
+    EXPECT_EQ(5, account1.balance());
+
+    buffer_.move(buffer1);
+    EXPECT_EQ(8, account.balance());
+    EXPECT_EQ(0, account1.balance());
+  }
+
+  buffer_.setAccount(nullptr);
+  EXPECT_EQ(0, account.balance());
+  buffer_.setAccount(&account);
+  EXPECT_EQ(8, account.balance());
+
+  {
+    // Destroying a buffer credits its account.
+    Buffer::WatermarkBuffer buffer1{[]() -> void {}, []() -> void {}};
+    buffer1.setAccount(&account);
+    buffer1.add(TEN_BYTES, 10);
+    EXPECT_EQ(18, account.balance());
+  }
+  EXPECT_EQ(8, account.balance());
+  buffer_.setAccount(nullptr);
+}
+
+class WatermarkBufferAutoTuningTest : public WatermarkBufferTest {
+public:
+  WatermarkBufferAutoTuningTest() {
+    ON_CALL(time_system_, monotonicTime()).WillByDefault(Invoke([this]() { return now_; }));
+    buffer_.setAutoTuning(100, time_system_);
+  }
+
+  // Fill the buffer above its high watermark and drain it after the given time.
+  void fillAndDrain(std::chrono::milliseconds drain_time) {
+    const uint32_t times_high_watermark_called = times_high_watermark_called_;
+    const uint32_t times_low_watermark_called = times_low_watermark_called_;
+    buffer_.add(std::string(buffer_.highWatermark() + 1, 'a'));
+    EXPECT_EQ(times_high_watermark_called + 1, times_high_watermark_called_);
+    now_ += drain_time;
+    buffer_.drain(buffer_.length());
+    EXPECT_EQ(times_low_watermark_called + 1, times_low_watermark_called_);
+  }
+
+  NiceMock<MockTimeSystem> time_system_;
+  MonotonicTime now_;
+};
+
+// A quickly drained buffer grows up to the maximum, at most doubling at a time.
+TEST_F(WatermarkBufferAutoTuningTest, GrowsWithDrainRate) {
+  fillAndDrain(std::chrono::milliseconds(1));
+  EXPECT_EQ(20, buffer_.highWatermark());
+
+  // Going up to the new high watermark does not pause the writer.
+  buffer_.add(std::string(20, 'a'));
+  EXPECT_EQ(1, times_high_watermark_called_);
+  buffer_.drain(20);
+
+  fillAndDrain(std::chrono::milliseconds(1));
+  EXPECT_EQ(40, buffer_.highWatermark());
+  fillAndDrain(std::chrono::milliseconds(1));
+  EXPECT_EQ(80, buffer_.highWatermark());
+  fillAndDrain(std::chrono::milliseconds(1));
+  EXPECT_EQ(100, buffer_.highWatermark());
+  fillAndDrain(std::chrono::milliseconds(1));
+  EXPECT_EQ(100, buffer_.highWatermark());
+}
+
+// The high watermark settles at the bytes drained in AutoTuneDrainTime, and goes no lower than the
+// configured one.
+TEST_F(WatermarkBufferAutoTuningTest, ShrinksWithDrainRate) {
+  fillAndDrain(std::chrono::milliseconds(1));
+  fillAndDrain(std::chrono::milliseconds(1));
+  EXPECT_EQ(40, buffer_.highWatermark());
+
+  // 41 bytes in 136ms is 30 bytes per AutoTuneDrainTime.
+  fillAndDrain(std::chrono::milliseconds(136));
+  EXPECT_EQ(30, buffer_.highWatermark());
+  fillAndDrain(std::chrono::seconds(10));
+  EXPECT_EQ(15, buffer_.highWatermark());
+  fillAndDrain(std::chrono::seconds(10));
+  EXPECT_EQ(10, buffer_.highWatermark());
+}
+
+// A buffer that was not above its high watermark for AutoTuneIdleTimeout goes back to the
+// configured watermark.
+TEST_F(WatermarkBufferAutoTuningTest, ResetsWhenIdle) {
+  fillAndDrain(std::chrono::milliseconds(1));
+  EXPECT_EQ(20, buffer_.highWatermark());
+
+  now_ += WatermarkBuffer::AutoTuneIdleTimeout + std::chrono::milliseconds(1);
+  buffer_.add(TEN_BYTES, 10);
+  EXPECT_EQ(1, times_high_watermark_called_);
+  buffer_.add("a", 1);
+  EXPECT_EQ(2, times_high_watermark_called_);
+  EXPECT_EQ(10, buffer_.highWatermark());
+}
+
+// Auto tuning is disabled by a maximum not above the configured watermark.
+TEST_F(WatermarkBufferAutoTuningTest, Disabled) {
+  buffer_.setAutoTuning(10, time_system_);
+  fillAndDrain(std::chrono::milliseconds(1));
+  EXPECT_EQ(10, buffer_.highWatermark());
+}
+
 } // namespace
 } // namespace Buffer
 } // namespace Envoy
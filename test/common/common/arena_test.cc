@@ -0,0 +1,114 @@
+#include <list>
+#include <string>
+
+#include "common/common/arena.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+TEST(ArenaTest, Allocate) {
+  Arena arena(1024);
+  EXPECT_EQ(0, arena.numBlocks());
+  EXPECT_EQ(0, arena.bytesAllocated());
+
+  void* first = arena.allocate(1);
+  void* second = arena.allocate(8, 8);
+  EXPECT_EQ(1, arena.numBlocks());
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(second) % 8);
+  EXPECT_EQ(static_cast<uint8_t*>(first) + 8, second);
+  EXPECT_EQ(16, arena.bytesAllocated());
+
+  // Fill the first block, after which a second, larger block is allocated.
+  arena.allocate(1024 - 16, 1);
+  EXPECT_EQ(1, arena.numBlocks());
+  arena.allocate(1024, 1);
+  EXPECT_EQ(2, arena.numBlocks());
+  arena.allocate(1024, 1);
+  EXPECT_EQ(2, arena.numBlocks());
+
+  // Allocations larger than the next block get a block of their own.
+  arena.allocate(10000, 1);
+  EXPECT_EQ(3, arena.numBlocks());
+}
+
+TEST(ArenaTest, ZeroInitialBlockSize) {
+  // Every block is sized to fit the allocation that needed it.
+  Arena arena(0);
+  arena.allocate(10);
+  EXPECT_EQ(1, arena.numBlocks());
+  arena.allocate(100);
+  EXPECT_EQ(2, arena.numBlocks());
+}
+
+class Tracked {
+public:
+  Tracked(bool& destroyed) : destroyed_(destroyed) {}
+  ~Tracked() { destroyed_ = true; }
+
+private:
+  bool& destroyed_;
+};
+
+TEST(ArenaTest, ArenaPtr) {
+  Arena arena(1024);
+  bool arena_destroyed = false;
+  bool heap_destroyed = false;
+  {
+    ArenaPtr<Tracked> in_arena = makeArenaPtr<Tracked>(&arena, arena_destroyed);
+    ArenaPtr<Tracked> on_heap = makeArenaPtr<Tracked>(nullptr, heap_destroyed);
+    EXPECT_EQ(1, arena.numBlocks());
+    EXPECT_EQ(sizeof(Tracked), arena.bytesAllocated());
+  }
+  EXPECT_TRUE(arena_destroyed);
+  EXPECT_TRUE(heap_destroyed);
+}
+
+TEST(ArenaTest, Allocator) {
+  Arena arena(4096);
+  {
+    std::list<std::string, ArenaAllocator<std::string>> list{ArenaAllocator<std::string>(&arena)};
+    for (int i = 0; i < 10; i++) {
+      list.push_back("hello");
+    }
+    EXPECT_EQ(1, arena.numBlocks());
+    EXPECT_LE(10 * sizeof(std::string), arena.bytesAllocated());
+  }
+
+  std::list<std::string, ArenaAllocator<std::string>> heap_list{
+      ArenaAllocator<std::string>(nullptr)};
+  heap_list.push_back("hello");
+  EXPECT_EQ("hello", heap_list.front());
+}
+
+TEST(ArenaSizeHistogramTest, RecommendedBlockSize) {
+  ArenaSizeHistogram histogram;
+  EXPECT_EQ(ArenaSizeHistogram::DefaultBlockSize, histogram.recommendedBlockSize());
+
+  for (int i = 0; i < 90; i++) {
+    histogram.record(1000);
+  }
+  for (int i = 0; i < 10; i++) {
+    histogram.record(100000);
+  }
+  EXPECT_EQ(1024, histogram.recommendedBlockSize());
+
+  histogram.record(100000);
+  EXPECT_EQ(ArenaSizeHistogram::MaxBlockSize, histogram.recommendedBlockSize());
+}
+
+TEST(ArenaSizeHistogramTest, Decay) {
+  ArenaSizeHistogram histogram;
+  for (uint64_t i = 0; i < ArenaSizeHistogram::DecayInterval - 1; i++) {
+    histogram.record(100);
+  }
+  EXPECT_EQ(ArenaSizeHistogram::MinBlockSize, histogram.recommendedBlockSize());
+
+  // Once old samples decay, a shift in sizes takes over the estimate quickly.
+  for (uint64_t i = 0; i < ArenaSizeHistogram::DecayInterval; i++) {
+    histogram.record(3000);
+  }
+  EXPECT_EQ(4096, histogram.recommendedBlockSize());
+}
+
+} // namespace Envoy
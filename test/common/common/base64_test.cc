@@ -1,4 +1,6 @@
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "common/buffer/buffer_impl.h"
 #include "common/common/base64.h"
@@ -8,6 +10,29 @@
 #include "gtest/gtest.h"
 
 namespace Envoy {
+namespace {
+
+// A buffer with a slice per piece, so that groups of characters can be split across slices.
+class SlicedBuffer {
+public:
+  SlicedBuffer(const std::vector<std::string>& pieces) : pieces_(pieces) {
+    for (const std::string& piece : pieces_) {
+      fragments_.emplace_back(
+          std::make_unique<Buffer::BufferFragmentImpl>(piece.data(), piece.size(), nullptr));
+      buffer_.addBufferFragment(*fragments_.back());
+    }
+  }
+
+  Buffer::Instance& buffer() { return buffer_; }
+
+private:
+  const std::vector<std::string> pieces_;
+  std::vector<std::unique_ptr<Buffer::BufferFragmentImpl>> fragments_;
+  Buffer::OwnedImpl buffer_;
+};
+
+} // namespace
+
 TEST(Base64Test, EmptyBufferEncode) {
   {
     Buffer::OwnedImpl buffer;
@@ -87,6 +112,26 @@ TEST(Base64Test, DecodeFailure) {
   EXPECT_EQ("", Base64::decode("123"));
 }
 
+TEST(Base64Test, CharBufferRoundTrip) {
+  char encoded[8];
+  EXPECT_EQ(0, Base64::encode("", 0, encoded));
+  EXPECT_EQ(4, Base64::encode("fo", 2, encoded));
+  EXPECT_EQ("Zm8=", std::string(encoded, 4));
+  EXPECT_EQ(8, Base64::encode("foobar", 6, encoded));
+  EXPECT_EQ("Zm9vYmFy", std::string(encoded, 8));
+
+  char decoded[6];
+  EXPECT_EQ(6, Base64::decode("Zm9vYmFy", 8, decoded));
+  EXPECT_EQ("foobar", std::string(decoded, 6));
+  EXPECT_EQ(4, Base64::decode("Zm9vYg==", 8, decoded));
+  EXPECT_EQ("foob", std::string(decoded, 4));
+
+  EXPECT_EQ(0, Base64::decode("", 0, decoded));
+  EXPECT_EQ(0, Base64::decode("Zm9", 3, decoded));
+  EXPECT_EQ(0, Base64::decode("Zh==", 4, decoded));
+  EXPECT_EQ(0, Base64::decode("Zg..", 4, decoded));
+}
+
 TEST(Base64Test, MultiSlicesBufferEncode) {
   Buffer::OwnedImpl buffer;
   buffer.add("foob", 4);
@@ -109,6 +154,77 @@ TEST(Base64Test, BinaryBufferEncode) {
   EXPECT_EQ("AAECAwgKCQCqvN4=", Base64::encode(buffer, 30));
 }
 
+TEST(Base64Test, EncodeToBuffer) {
+  SlicedBuffer sliced({"foob", "ar"});
+  Buffer::Instance& input = sliced.buffer();
+
+  Buffer::OwnedImpl output("prefix:");
+  Base64::encode(input, 0, output);
+  EXPECT_EQ("prefix:", output.toString());
+  Base64::encode(input, 4, output);
+  EXPECT_EQ("prefix:Zm9vYg==", output.toString());
+  Base64::encode(input, 7, output);
+  EXPECT_EQ("prefix:Zm9vYg==Zm9vYmFy", output.toString());
+  EXPECT_EQ(6, input.length());
+}
+
+TEST(Base64Test, DecodeFromBuffer) {
+  SlicedBuffer sliced({"Zm9", "vY", "g==Zm9v"});
+  Buffer::Instance& input = sliced.buffer();
+
+  Buffer::OwnedImpl output("prefix:");
+  EXPECT_TRUE(Base64::decode(input, 8, output));
+  EXPECT_EQ("prefix:foob", output.toString());
+  EXPECT_EQ(12, input.length());
+
+  Buffer::OwnedImpl unpadded("Zm9vYmFy");
+  EXPECT_TRUE(Base64::decode(unpadded, 8, output));
+  EXPECT_EQ("prefix:foobfoobar", output.toString());
+}
+
+TEST(Base64Test, DecodeFromBufferFailure) {
+  Buffer::OwnedImpl output;
+  for (const std::string& input : {"==Zg", "=Zm8", "Zm=8", "Zg=A", "Zh==", "Zm9=", "Zg..", "..Zg",
+                                   "A===", "Zm9vYg==Zm9v"}) {
+    Buffer::OwnedImpl buffer(input);
+    EXPECT_FALSE(Base64::decode(buffer, buffer.length(), output)) << input;
+  }
+
+  Buffer::OwnedImpl buffer("Zm9vYmFy");
+  EXPECT_FALSE(Base64::decode(buffer, 0, output));
+  EXPECT_FALSE(Base64::decode(buffer, 6, output));
+  EXPECT_FALSE(Base64::decode(buffer, 12, output));
+  EXPECT_EQ(0, output.length());
+
+  // A failed decode does not leave a reservation that would break appending to the output.
+  output.add("foo");
+  EXPECT_EQ("foo", output.toString());
+}
+
+TEST(Base64Test, BufferRoundTrip) {
+  std::string binary;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    binary.push_back(static_cast<char>(i * 7));
+  }
+
+  for (uint64_t slice_length = 1; slice_length < 20; ++slice_length) {
+    std::vector<std::string> pieces;
+    for (uint64_t i = 0; i < binary.size(); i += slice_length) {
+      pieces.push_back(binary.substr(i, slice_length));
+    }
+    SlicedBuffer sliced(pieces);
+    Buffer::OwnedImpl encoded;
+    Base64::encode(sliced.buffer(), binary.size(), encoded);
+    EXPECT_EQ(Base64::encode(binary.data(), binary.size()), encoded.toString());
+
+    SlicedBuffer sliced_encoded({encoded.toString().substr(0, slice_length),
+                                 encoded.toString().substr(slice_length)});
+    Buffer::OwnedImpl decoded;
+    EXPECT_TRUE(Base64::decode(sliced_encoded.buffer(), encoded.length(), decoded));
+    EXPECT_EQ(binary, decoded.toString());
+  }
+}
+
 TEST(Base64UrlTest, EncodeString) {
   EXPECT_EQ("", Base64Url::encode("", 0));
   EXPECT_EQ("AAA", Base64Url::encode("\0\0", 2));
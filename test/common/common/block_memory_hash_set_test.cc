@@ -189,6 +189,21 @@ TEST_F(BlockMemoryHashSetTest, tooManyValues) {
   hash_set1.sanityCheck();
 }
 
+TEST_F(BlockMemoryHashSetTest, PrecomputedHash) {
+  setUp<TestValue>();
+  BlockMemoryHashSet<TestValue> hash_set1(hash_set_options_, true, memory_.get(), stats_options_);
+  const uint64_t hash = TestValue::hash("key");
+  ValueCreatedPair vc = hash_set1.insert("key", hash);
+  EXPECT_TRUE(vc.second);
+  EXPECT_EQ(vc.first, hash_set1.get("key"));
+  EXPECT_EQ(vc.first, hash_set1.get("key", hash));
+  EXPECT_FALSE(hash_set1.insert("key").second);
+  hash_set1.sanityCheck();
+  EXPECT_TRUE(hash_set1.remove("key", hash));
+  EXPECT_EQ(nullptr, hash_set1.get("key"));
+  hash_set1.sanityCheck();
+}
+
 TEST_F(BlockMemoryHashSetTest, severalKeysZeroHash) {
   setUp<TestValueZeroHash>();
   BlockMemoryHashSet<TestValueZeroHash> hash_set1(hash_set_options_, true, memory_.get(),
@@ -0,0 +1,94 @@
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "common/common/blocking_pool_impl.h"
+#include "common/event/dispatcher_impl.h"
+
+#include "test/test_common/test_time.h"
+
+#include "absl/synchronization/notification.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Thread {
+namespace {
+
+class BlockingPoolImplTest : public testing::Test {
+protected:
+  BlockingPoolImplTest() : dispatcher_(test_time_.timeSystem()) {}
+
+  DangerousDeprecatedTestTime test_time_;
+  Event::DispatcherImpl dispatcher_;
+};
+
+// The work runs on one of the threads, and its result is handed to the completion callback on the
+// dispatcher.
+TEST_F(BlockingPoolImplTest, PostResultBack) {
+  BlockingPoolImpl pool(2);
+  const std::thread::id dispatcher_thread = std::this_thread::get_id();
+  std::thread::id work_thread;
+  std::string result;
+  bool completed = false;
+  BlockingWorkPtr work = pool.post(
+      [&]() -> void {
+        work_thread = std::this_thread::get_id();
+        result = "hello";
+      },
+      dispatcher_,
+      [&]() -> void {
+        EXPECT_EQ(dispatcher_thread, std::this_thread::get_id());
+        EXPECT_EQ("hello", result);
+        completed = true;
+        dispatcher_.exit();
+      });
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+  EXPECT_TRUE(completed);
+  EXPECT_NE(dispatcher_thread, work_thread);
+}
+
+// Without threads the work runs inline, but the completion callback still runs from the event loop.
+TEST_F(BlockingPoolImplTest, NoThreads) {
+  BlockingPoolImpl pool(0);
+  bool ran = false;
+  bool completed = false;
+  BlockingWorkPtr work =
+      pool.post([&]() -> void { ran = true; }, dispatcher_, [&]() -> void { completed = true; });
+  EXPECT_TRUE(ran);
+  EXPECT_FALSE(completed);
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_TRUE(completed);
+}
+
+// Destroying the handle of queued work cancels it, and destroying the handle of running work waits
+// for it, so that neither completion callback runs.
+TEST_F(BlockingPoolImplTest, Cancel) {
+  BlockingPoolImpl pool(1);
+  absl::Notification running;
+  absl::Notification unblock;
+  std::atomic<bool> finished{false};
+  BlockingWorkPtr blocked = pool.post(
+      [&]() -> void {
+        running.Notify();
+        unblock.WaitForNotification();
+        finished = true;
+      },
+      dispatcher_, []() -> void { FAIL(); });
+  std::atomic<bool> queued_ran{false};
+  BlockingWorkPtr queued =
+      pool.post([&]() -> void { queued_ran = true; }, dispatcher_, []() -> void { FAIL(); });
+
+  running.WaitForNotification();
+  queued.reset();
+  Thread unblocker([&]() -> void { unblock.Notify(); });
+  blocked.reset();
+  EXPECT_TRUE(finished);
+  unblocker.join();
+
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_FALSE(queued_ran);
+}
+
+} // namespace
+} // namespace Thread
+} // namespace Envoy
@@ -0,0 +1,100 @@
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "common/common/logger.h"
+#include "common/common/logger_delegates.h"
+#include "common/common/thread.h"
+
+#include "test/test_common/logging.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Logger {
+namespace {
+
+class AsyncSinkDelegateTest : public testing::Test {
+protected:
+  AsyncSinkDelegateTest()
+      : recording_(Registry::getSink()), log_format_(Registry::logFormat()),
+        log_level_(GET_MISC_LOGGER().level()) {
+    Registry::setLogFormat("[%n] %v");
+    GET_MISC_LOGGER().set_level(spdlog::level::info);
+  }
+
+  ~AsyncSinkDelegateTest() {
+    GET_MISC_LOGGER().set_level(log_level_);
+    Registry::setLogFormat(log_format_);
+  }
+
+  LogRecordingSink recording_;
+  const std::string log_format_;
+  const spdlog::level::level_enum log_level_;
+};
+
+// Messages are formatted with the log format in place when the delegate was installed, which is
+// restored when it is removed.
+TEST_F(AsyncSinkDelegateTest, FormatOnFlush) {
+  {
+    AsyncSinkDelegate async(Registry::getSink(), 16, std::chrono::hours(1));
+    EXPECT_EQ("%v", Registry::logFormat());
+    ENVOY_LOG_MISC(info, "message {}", 1);
+    async.flush();
+    ASSERT_EQ(1, recording_.messages().size());
+    EXPECT_EQ("[misc] message 1\n", recording_.messages()[0]);
+    EXPECT_EQ(0, async.droppedMessages());
+  }
+  EXPECT_EQ("[%n] %v", Registry::logFormat());
+}
+
+// The messages of threads that exited before the next drain are not lost.
+TEST_F(AsyncSinkDelegateTest, MultipleThreads) {
+  AsyncSinkDelegate async(Registry::getSink(), 1024, std::chrono::hours(1));
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < 4; ++i) {
+    threads.emplace_back(new Thread::Thread([]() {
+      for (uint32_t j = 0; j < 100; ++j) {
+        ENVOY_LOG_MISC(info, "message {}", j);
+      }
+    }));
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+  async.flush();
+  EXPECT_EQ(400, recording_.messages().size());
+  EXPECT_EQ(0, async.droppedMessages());
+}
+
+// Messages logged while the ring of their thread is full are counted and reported rather than
+// blocking the thread.
+TEST_F(AsyncSinkDelegateTest, DropWhenFull) {
+  AsyncSinkDelegate async(Registry::getSink(), 4, std::chrono::hours(1));
+  for (uint32_t i = 0; i < 100; ++i) {
+    ENVOY_LOG_MISC(info, "message {}", i);
+  }
+  async.flush();
+
+  // The consumer thread may drain the ring concurrently, so only the totals are deterministic.
+  uint64_t written = 0;
+  uint64_t reported_dropped = 0;
+  for (const std::string& message : recording_.messages()) {
+    if (absl::StartsWith(message, "dropped ")) {
+      uint64_t dropped;
+      ASSERT_TRUE(absl::SimpleAtoi(message.substr(8, message.find(' ', 8) - 8), &dropped));
+      reported_dropped += dropped;
+    } else {
+      written++;
+    }
+  }
+  EXPECT_EQ(100, written + async.droppedMessages());
+  EXPECT_EQ(async.droppedMessages(), reported_dropped);
+}
+
+} // namespace
+} // namespace Logger
+} // namespace Envoy
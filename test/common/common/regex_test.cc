@@ -0,0 +1,90 @@
+#include <string>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/regex.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Regex {
+namespace {
+
+class RegexEngineTest : public testing::TestWithParam<Engine> {};
+
+INSTANTIATE_TEST_CASE_P(Engines, RegexEngineTest,
+                        testing::Values(Engine::GoogleRe2, Engine::StdRegex));
+
+TEST_P(RegexEngineTest, Match) {
+  CompiledMatcherPtr regex = Utility::parseRegex("/foo/[^/]+/bar", GetParam());
+  EXPECT_TRUE(regex->match("/foo/1234/bar"));
+  EXPECT_FALSE(regex->match("/foo/1234/bar/baz"));
+  EXPECT_FALSE(regex->match("/a/foo/1234/bar"));
+  EXPECT_FALSE(regex->match("/foo//bar"));
+
+  // Only the given length of the value is matched.
+  const std::string path = "/foo/1234/bar?a=b";
+  EXPECT_TRUE(regex->match(absl::string_view(path.data(), path.find('?'))));
+  EXPECT_FALSE(regex->match(path));
+}
+
+TEST_P(RegexEngineTest, Search) {
+  CompiledMatcherPtr regex = Utility::parseRegex("\\.((\\w+?)\\.)(x)?", GetParam());
+  EXPECT_EQ(3, regex->numCaptureGroups());
+
+  const std::string value = "cluster.foo.bar";
+  absl::string_view submatches[4];
+  EXPECT_TRUE(regex->search(value, submatches, 4));
+  EXPECT_EQ(".foo.", submatches[0]);
+  EXPECT_EQ("foo.", submatches[1]);
+  EXPECT_EQ(value.data() + 8, submatches[1].data());
+  EXPECT_EQ("foo", submatches[2]);
+  EXPECT_EQ(nullptr, submatches[3].data());
+
+  EXPECT_TRUE(regex->search(value, nullptr, 0));
+  EXPECT_FALSE(regex->search("cluster", submatches, 4));
+}
+
+TEST_P(RegexEngineTest, Invalid) {
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex("(+invalid)", GetParam()), EnvoyException,
+                          "^Invalid regex '\\(\\+invalid\\)': ");
+}
+
+TEST(RegexTest, GoogleRe2RejectsLookahead) {
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex("^foo(?=\\.)", Engine::GoogleRe2), EnvoyException,
+                          "^Invalid regex");
+  EXPECT_TRUE(Utility::parseRegex("^foo(?=\\.)", Engine::StdRegex)->search("foo.bar", nullptr, 0));
+}
+
+TEST(RegexTest, GoogleRe2LongInput) {
+  // A backtracking engine recurses on every repetition of the group.
+  CompiledMatcherPtr regex = Utility::parseRegex("(a|b)*", Engine::GoogleRe2);
+  EXPECT_TRUE(regex->match(std::string(1 << 20, 'a')));
+}
+
+TEST(RegexTest, MaxProgramSize) {
+  const std::string regex = "/(foo|bar|baz){1,10}";
+  EXPECT_NO_THROW(Utility::parseRegex(regex, Engine::GoogleRe2));
+
+  Utility::setMaxProgramSize(10);
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex(regex, Engine::GoogleRe2), EnvoyException,
+                          "RE2 program size of [0-9]+ > max program size of 10");
+  // The limit doesn't apply to std::regex.
+  EXPECT_NO_THROW(Utility::parseRegex(regex, Engine::StdRegex));
+  Utility::setMaxProgramSize(Utility::DefaultMaxProgramSize);
+}
+
+TEST(RegexTest, DefaultEngine) {
+  EXPECT_EQ(Engine::GoogleRe2, Utility::defaultEngine());
+  EXPECT_THROW(Utility::parseRegex("^foo(?=\\.)"), EnvoyException);
+
+  Utility::setDefaultEngine(Engine::StdRegex);
+  EXPECT_TRUE(Utility::parseRegex("^foo(?=\\.)")->search("foo.bar", nullptr, 0));
+  Utility::setDefaultEngine(Engine::GoogleRe2);
+}
+
+} // namespace
+} // namespace Regex
+} // namespace Envoy
@@ -0,0 +1,67 @@
+#include <chrono>
+#include <thread>
+
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Thread {
+
+TEST(MutexContentionTest, Bucket) {
+  EXPECT_EQ(0, MutexContention::bucket(std::chrono::nanoseconds(999)));
+  EXPECT_EQ(1, MutexContention::bucket(std::chrono::microseconds(1)));
+  EXPECT_EQ(2, MutexContention::bucket(std::chrono::microseconds(2)));
+  EXPECT_EQ(2, MutexContention::bucket(std::chrono::microseconds(3)));
+  EXPECT_EQ(10, MutexContention::bucket(std::chrono::milliseconds(1)));
+  EXPECT_EQ(MutexContention::NumBuckets - 1, MutexContention::bucket(std::chrono::hours(1)));
+}
+
+TEST(MutexContentionTest, EnableClearsProfile) {
+  MutexContention::enable(true);
+  MutexContention::record(std::chrono::microseconds(10));
+  EXPECT_EQ(1, MutexContention::profile().contentions_);
+
+  // Enabling an enabled profile keeps it.
+  MutexContention::enable(true);
+  EXPECT_EQ(1, MutexContention::profile().contentions_);
+
+  MutexContention::enable(false);
+  MutexContention::enable(true);
+  const MutexContention::Profile profile = MutexContention::profile();
+  EXPECT_EQ(0, profile.contentions_);
+  EXPECT_EQ(std::chrono::nanoseconds(0), profile.wait_time_);
+  for (uint64_t count : profile.buckets_) {
+    EXPECT_EQ(0, count);
+  }
+  MutexContention::enable(false);
+}
+
+TEST(MutexContentionTest, ContendedLock) {
+  MutexBasicLockable mutex;
+  MutexContention::enable(true);
+
+  mutex.lock();
+  Thread waiter([&mutex]() { LockGuard lock(mutex); });
+  // Give the waiter time to block on the mutex.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  mutex.unlock();
+  waiter.join();
+
+  const MutexContention::Profile profile = MutexContention::profile();
+  MutexContention::enable(false);
+  EXPECT_LE(1, profile.contentions_);
+  EXPECT_LT(std::chrono::nanoseconds(0), profile.wait_time_);
+}
+
+TEST(MutexContentionTest, UncontendedLockNotRecorded) {
+  MutexBasicLockable mutex;
+  MutexContention::enable(true);
+  { LockGuard lock(mutex); }
+  EXPECT_EQ(0, MutexContention::profile().contentions_);
+  MutexContention::enable(false);
+}
+
+} // namespace Thread
+} // namespace Envoy
@@ -26,5 +26,16 @@ TEST(ToLowerTableTest, All) {
     table.toLowerCase(input);
     EXPECT_EQ(input, "\x90hello\x90");
   }
+  {
+    // Longer than a SIMD block, with the characters around the upper case letters.
+    std::string input("Access-Control-Request-Method@AZ[`az{\xc1\xda");
+    table.toLowerCase(input);
+    EXPECT_EQ(input, "access-control-request-method@az[`az{\xc1\xda");
+  }
+  {
+    std::string input("@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~");
+    table.toLowerCase(input);
+    EXPECT_EQ(input, "@abcdefghijklmnopqrstuvwxyz[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~");
+  }
 }
 } // namespace Envoy
@@ -153,6 +153,25 @@ TEST(InputConstMemoryStream, All) {
   }
 }
 
+TEST(OutputMemoryStream, All) {
+  char data[4];
+  {
+    OutputMemoryStream ostream{data, sizeof(data)};
+    ostream << 123;
+    EXPECT_TRUE(ostream.good());
+    EXPECT_EQ(3, ostream.size());
+    EXPECT_EQ("123", std::string(data, ostream.size()));
+  }
+
+  {
+    // Writes beyond the region fail rather than allocate.
+    OutputMemoryStream ostream{data, sizeof(data)};
+    ostream << "12345";
+    EXPECT_FALSE(ostream.good());
+    EXPECT_EQ(4, ostream.size());
+  }
+}
+
 TEST(StringUtil, WhitespaceChars) {
   EXPECT_NE(nullptr, strchr(StringUtil::WhitespaceChars, ' '));
   EXPECT_NE(nullptr, strchr(StringUtil::WhitespaceChars, '\t'));
@@ -306,6 +325,9 @@ TEST(StringUtil, StringViewCaseFindToken) {
   EXPECT_FALSE(StringUtil::caseFindToken("", "", "a"));
   EXPECT_TRUE(StringUtil::caseFindToken(" ", " ", "", true));
   EXPECT_FALSE(StringUtil::caseFindToken(" ", " ", "", false));
+  EXPECT_TRUE(StringUtil::caseFindToken("keep-alive, Upgrade, HTTP2-Settings", ",", "upgrade"));
+  EXPECT_TRUE(StringUtil::caseFindToken("a=1; b, c", ",;", "C"));
+  EXPECT_FALSE(StringUtil::caseFindToken("a=1; b, c", ",;", "a"));
   EXPECT_TRUE(StringUtil::caseFindToken("A=5", ".", "A=5"));
 }
 
@@ -316,6 +338,24 @@ TEST(StringUtil, StringViewCaseCompare) {
   EXPECT_FALSE(StringUtil::caseCompare("hello", "hello world"));
 }
 
+// Strings longer than a SIMD block, differing in and past the first block.
+TEST(StringUtil, StringViewCaseCompareLong) {
+  EXPECT_TRUE(
+      StringUtil::caseCompare("Access-Control-Request-Method", "access-control-request-method"));
+  EXPECT_TRUE(
+      StringUtil::caseCompare("X-ENVOY-UPSTREAM-SERVICE-TIME", "x-envoy-upstream-service-time"));
+  EXPECT_FALSE(
+      StringUtil::caseCompare("access-control-request-method", "access-control-request-metho_"));
+  EXPECT_FALSE(
+      StringUtil::caseCompare("access-control-request-method", "_ccess-control-request-method"));
+  EXPECT_FALSE(StringUtil::caseCompare("0123456789abcdef0", "0123456789ABCDEF1"));
+  EXPECT_TRUE(StringUtil::caseCompare("0123456789ABCDEF", "0123456789abcdef"));
+  // Only ASCII letters are folded: '@' and '`', '[' and '{' differ by the case bit.
+  EXPECT_FALSE(StringUtil::caseCompare("@@@@@@@@@@@@@@@@[", "````````````````{"));
+  EXPECT_FALSE(StringUtil::caseCompare("[[[[[[[[[[[[[[[[", "{{{{{{{{{{{{{{{{"));
+  EXPECT_FALSE(StringUtil::caseCompare(std::string(16, '\xc1'), std::string(16, '\xe1')));
+}
+
 TEST(StringUtil, StringViewCropRight) {
   EXPECT_EQ("hello", StringUtil::cropRight("hello; world\t\f\v\n\r", ";"));
   EXPECT_EQ("foo ", StringUtil::cropRight("foo ; ; ; ; ; ; ", ";"));
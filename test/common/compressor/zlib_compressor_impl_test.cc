@@ -203,6 +203,25 @@ TEST_F(ZlibCompressorImplTest, CompressWithNotCommonParams) {
   expectValidFinishedBuffer(accumulation_buffer, input_size);
 }
 
+// Verifies that the factory creates initialized compressors for the configured encoding.
+TEST_F(ZlibCompressorImplTest, Factory) {
+  ZlibCompressorFactory gzip_factory(ZlibCompressorImpl::CompressionLevel::Standard,
+                                     ZlibCompressorImpl::CompressionStrategy::Standard,
+                                     gzip_window_bits, memory_level);
+  EXPECT_EQ("gzip", gzip_factory.contentEncoding());
+
+  Buffer::OwnedImpl buffer;
+  TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size);
+  CompressorPtr compressor = gzip_factory.createCompressor();
+  compressor->compress(buffer, State::Finish);
+  expectValidFinishedBuffer(buffer, default_input_size);
+
+  ZlibCompressorFactory deflate_factory(ZlibCompressorImpl::CompressionLevel::Standard,
+                                        ZlibCompressorImpl::CompressionStrategy::Standard, 15,
+                                        memory_level);
+  EXPECT_EQ("deflate", deflate_factory.contentEncoding());
+}
+
 } // namespace
 } // namespace Compressor
 } // namespace Envoy
\ No newline at end of file
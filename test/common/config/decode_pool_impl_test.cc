@@ -0,0 +1,61 @@
+#include <atomic>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/config/decode_pool_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Config {
+
+// Without threads, the indices are run in order on the calling thread.
+TEST(DecodePoolImplTest, NoThreads) {
+  DecodePoolImpl pool(0);
+  std::vector<size_t> indices;
+  pool.parallelFor(4, [&indices](size_t i) { indices.push_back(i); });
+  EXPECT_EQ((std::vector<size_t>{0, 1, 2, 3}), indices);
+}
+
+TEST(DecodePoolImplTest, Empty) {
+  DecodePoolImpl pool(2);
+  pool.parallelFor(0, [](size_t) { FAIL(); });
+}
+
+// Every index is run exactly once, and all of them have been run when parallelFor() returns.
+TEST(DecodePoolImplTest, EveryIndexOnce) {
+  DecodePoolImpl pool(4);
+  for (size_t count : {1, 2, 3, 1000}) {
+    std::vector<std::atomic<uint32_t>> runs(count);
+    pool.parallelFor(count, [&runs](size_t i) { runs[i]++; });
+    for (size_t i = 0; i < count; i++) {
+      EXPECT_EQ(1, runs[i].load()) << "count " << count << " index " << i;
+    }
+  }
+}
+
+// The exception of the lowest index is rethrown, once all the indices have been run.
+TEST(DecodePoolImplTest, Exception) {
+  DecodePoolImpl pool(4);
+  std::atomic<uint32_t> runs{0};
+  EXPECT_THROW_WITH_MESSAGE(pool.parallelFor(100,
+                                             [&runs](size_t i) {
+                                               runs++;
+                                               if (i == 17 || i == 60) {
+                                                 throw EnvoyException(std::to_string(i));
+                                               }
+                                             }),
+                            EnvoyException, "17");
+  EXPECT_EQ(100, runs.load());
+
+  // The pool is still usable.
+  runs = 0;
+  pool.parallelFor(100, [&runs](size_t) { runs++; });
+  EXPECT_EQ(100, runs.load());
+}
+
+} // namespace Config
+} // namespace Envoy
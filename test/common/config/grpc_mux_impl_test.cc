@@ -12,6 +12,7 @@
 #include "test/mocks/grpc/mocks.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/runtime/mocks.h"
+#include "test/test_common/environment.h"
 #include "test/test_common/logging.h"
 #include "test/test_common/utility.h"
 
@@ -38,12 +39,12 @@ public:
     dispatcher_.setTimeSystem(mock_time_system_);
   }
 
-  void setup() {
+  void setup(SnapshotStorePtr snapshot_store = nullptr) {
     grpc_mux_.reset(new GrpcMuxImpl(
         local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
         *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
             "envoy.service.discovery.v2.AggregatedDiscoveryService.StreamAggregatedResources"),
-        random_));
+        random_, std::move(snapshot_store)));
   }
 
   void expectSendMessage(const std::string& type_url,
@@ -210,6 +211,8 @@ TEST_F(GrpcMuxImplTest, WildcardWatch) {
     envoy::api::v2::ClusterLoadAssignment load_assignment;
     load_assignment.set_cluster_name("x");
     response->add_resources()->PackFrom(load_assignment);
+    // Wildcard watches receive the resources without them being named.
+    EXPECT_CALL(callbacks_, resourceName(_)).Times(0);
     EXPECT_CALL(callbacks_, onConfigUpdate(_, "1"))
         .WillOnce(
             Invoke([&load_assignment](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources,
@@ -465,6 +468,91 @@ TEST_F(GrpcMuxImplTest, UnwatchedTypeRejectsResources) {
                       grpc_mux_->onReceiveMessage(std::move(response)));
 }
 
+// Validate that the persisted response is applied until the management server responds, and that
+// the accepted response replaces it.
+TEST_F(GrpcMuxImplTest, Snapshot) {
+  const std::string directory = TestEnvironment::temporaryPath("grpc_mux_impl_test_snapshot");
+  TestEnvironment::createPath(directory);
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  envoy::api::v2::ClusterLoadAssignment load_assignment;
+  load_assignment.set_cluster_name("x");
+  {
+    envoy::api::v2::DiscoveryResponse snapshot;
+    snapshot.set_type_url(type_url);
+    snapshot.set_version_info("1");
+    snapshot.add_resources()->PackFrom(load_assignment);
+    SnapshotStore(directory).store(snapshot);
+  }
+
+  // Timers are matched in the reverse order of their creation: the retry timer comes first.
+  Event::MockTimer* snapshot_timer = new Event::MockTimer(&dispatcher_);
+  new Event::MockTimer(&dispatcher_);
+  setup(std::make_unique<SnapshotStore>(directory));
+
+  InSequence s;
+  EXPECT_CALL(*snapshot_timer, enableTimer(std::chrono::milliseconds(0)));
+  auto foo_sub = grpc_mux_->subscribe(type_url, {"x"}, callbacks_);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  // The snapshot's version is not reported.
+  expectSendMessage(type_url, {"x"}, "");
+  grpc_mux_->start();
+
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, "1"));
+  snapshot_timer->callback_();
+
+  std::unique_ptr<envoy::api::v2::DiscoveryResponse> response(
+      new envoy::api::v2::DiscoveryResponse());
+  response->set_type_url(type_url);
+  response->set_version_info("2");
+  response->add_resources()->PackFrom(load_assignment);
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, "2"));
+  expectSendMessage(type_url, {"x"}, "2");
+  grpc_mux_->onReceiveMessage(std::move(response));
+  EXPECT_EQ("2", SnapshotStore(directory).load(type_url)->version_info());
+
+  // A later watch is not given the snapshot once the management server has responded.
+  NiceMock<MockGrpcMuxCallbacks> bar_callbacks;
+  EXPECT_CALL(*snapshot_timer, enableTimer(_)).Times(0);
+  EXPECT_CALL(bar_callbacks, onConfigUpdate(_, _)).Times(0);
+  expectSendMessage(type_url, {"y", "x"}, "2");
+  auto bar_sub = grpc_mux_->subscribe(type_url, {"y"}, bar_callbacks);
+
+  expectSendMessage(type_url, {"x"}, "2");
+  bar_sub.reset();
+  expectSendMessage(type_url, {}, "2");
+}
+
+// Validate that a rejected snapshot is dropped without reporting a failure.
+TEST_F(GrpcMuxImplTest, SnapshotRejected) {
+  const std::string directory =
+      TestEnvironment::temporaryPath("grpc_mux_impl_test_snapshot_rejected");
+  TestEnvironment::createPath(directory);
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  {
+    envoy::api::v2::DiscoveryResponse snapshot;
+    snapshot.set_type_url(type_url);
+    snapshot.set_version_info("1");
+    snapshot.add_resources()->PackFrom(envoy::api::v2::ClusterLoadAssignment());
+    SnapshotStore(directory).store(snapshot);
+  }
+
+  Event::MockTimer* snapshot_timer = new Event::MockTimer(&dispatcher_);
+  new Event::MockTimer(&dispatcher_);
+  setup(std::make_unique<SnapshotStore>(directory));
+
+  auto foo_sub = grpc_mux_->subscribe(type_url, {}, callbacks_);
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, "1"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>&,
+                          const std::string&) { throw EnvoyException("bad config"); }));
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(_)).Times(0);
+  EXPECT_LOG_CONTAINS("warn", "xDS snapshot for " + type_url + " rejected: bad config",
+                      snapshot_timer->callback_());
+
+  // The snapshot is not applied again.
+  EXPECT_CALL(callbacks_, onConfigUpdate(_, _)).Times(0);
+  snapshot_timer->callback_();
+}
+
 TEST_F(GrpcMuxImplTest, BadLocalInfoEmptyClusterName) {
   EXPECT_CALL(local_info_, clusterName()).WillOnce(Return(""));
   EXPECT_THROW_WITH_MESSAGE(
@@ -3,6 +3,7 @@
 #include "envoy/api/v2/eds.pb.h"
 
 #include "common/common/hash.h"
+#include "common/config/decode_pool_impl.h"
 #include "common/config/grpc_subscription_impl.h"
 #include "common/config/resources.h"
 
@@ -42,7 +43,7 @@ public:
     }));
     subscription_.reset(new GrpcEdsSubscriptionImpl(
         local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_, random_,
-        *method_descriptor_, stats_));
+        *method_descriptor_, decode_pool_, stats_));
   }
 
   ~GrpcSubscriptionTestHarness() { EXPECT_CALL(async_stream_, sendMessage(_, false)); }
@@ -137,6 +138,7 @@ public:
   envoy::api::v2::core::Node node_;
   NiceMock<Config::MockSubscriptionCallbacks<envoy::api::v2::ClusterLoadAssignment>> callbacks_;
   Grpc::MockAsyncStream async_stream_;
+  DecodePoolImpl decode_pool_{2};
   std::unique_ptr<GrpcEdsSubscriptionImpl> subscription_;
   std::string last_response_nonce_;
   std::vector<std::string> last_cluster_names_;
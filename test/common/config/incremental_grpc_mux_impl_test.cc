@@ -0,0 +1,356 @@
+#include "envoy/api/v2/discovery.pb.h"
+#include "envoy/api/v2/eds.pb.h"
+
+#include "common/config/incremental_grpc_mux_impl.h"
+#include "common/config/protobuf_link_hacks.h"
+#include "common/config/resources.h"
+#include "common/protobuf/protobuf.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/config/mocks.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/grpc/mocks.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::InSequence;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+class IncrementalGrpcMuxImplTest : public testing::Test {
+public:
+  IncrementalGrpcMuxImplTest() : async_client_(new Grpc::MockAsyncClient()) {
+    dispatcher_.setTimeSystem(mock_time_system_);
+  }
+
+  void setup() {
+    grpc_mux_.reset(new IncrementalGrpcMuxImpl(
+        local_info_, std::unique_ptr<Grpc::MockAsyncClient>(async_client_), dispatcher_,
+        *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
+            "envoy.service.discovery.v2.AggregatedDiscoveryService.IncrementalAggregatedResources"),
+        random_));
+  }
+
+  void expectSendMessage(const std::string& type_url, const std::vector<std::string>& subscribe,
+                         const std::vector<std::string>& unsubscribe,
+                         const std::map<std::string, std::string>& initial_versions = {},
+                         const std::string& nonce = "",
+                         const Protobuf::int32 error_code = Grpc::Status::GrpcStatus::Ok,
+                         const std::string& error_message = "") {
+    envoy::api::v2::IncrementalDiscoveryRequest expected_request;
+    expected_request.mutable_node()->CopyFrom(local_info_.node());
+    expected_request.set_type_url(type_url);
+    for (const auto& resource : subscribe) {
+      expected_request.add_resource_names_subscribe(resource);
+    }
+    for (const auto& resource : unsubscribe) {
+      expected_request.add_resource_names_unsubscribe(resource);
+    }
+    for (const auto& version : initial_versions) {
+      (*expected_request.mutable_initial_resource_versions())[version.first] = version.second;
+    }
+    expected_request.set_response_nonce(nonce);
+    if (error_code != Grpc::Status::GrpcStatus::Ok) {
+      ::google::rpc::Status* error_detail = expected_request.mutable_error_detail();
+      error_detail->set_code(error_code);
+      error_detail->set_message(error_message);
+    }
+    EXPECT_CALL(async_stream_, sendMessage(ProtoEq(expected_request), false));
+  }
+
+  std::unique_ptr<envoy::api::v2::IncrementalDiscoveryResponse>
+  response(const std::string& type_url, const std::string& version, const std::string& nonce,
+           const std::vector<std::string>& added, const std::vector<std::string>& removed = {}) {
+    std::unique_ptr<envoy::api::v2::IncrementalDiscoveryResponse> response(
+        new envoy::api::v2::IncrementalDiscoveryResponse());
+    response->set_type_url(type_url);
+    response->set_system_version_info(version);
+    response->set_nonce(nonce);
+    for (const auto& name : added) {
+      envoy::api::v2::ClusterLoadAssignment load_assignment;
+      load_assignment.set_cluster_name(name);
+      auto* resource = response->add_resources();
+      resource->set_version(version);
+      resource->mutable_resource()->PackFrom(load_assignment);
+    }
+    for (const auto& name : removed) {
+      response->add_removed_resources(name);
+    }
+    return response;
+  }
+
+  static std::vector<std::string>
+  clusterNames(const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& resources) {
+    std::vector<std::string> names;
+    for (const auto& resource : resources) {
+      names.push_back(
+          MessageUtil::anyConvert<envoy::api::v2::ClusterLoadAssignment>(resource).cluster_name());
+    }
+    return names;
+  }
+
+  static std::vector<std::string>
+  removedNames(const Protobuf::RepeatedPtrField<ProtobufTypes::String>& resources) {
+    return std::vector<std::string>(resources.begin(), resources.end());
+  }
+
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Runtime::MockRandomGenerator random_;
+  Grpc::MockAsyncClient* async_client_;
+  Grpc::MockAsyncStream async_stream_;
+  std::unique_ptr<IncrementalGrpcMuxImpl> grpc_mux_;
+  NiceMock<MockGrpcMuxCallbacks> callbacks_;
+  NiceMock<MockTimeSystem> mock_time_system_;
+  NiceMock<LocalInfo::MockLocalInfo> local_info_;
+};
+
+// Validate that only the changes of the subscriptions are sent once the stream is established.
+TEST_F(IncrementalGrpcMuxImplTest, MultipleTypeUrlStreams) {
+  setup();
+  InSequence s;
+  auto foo_sub = grpc_mux_->subscribe("foo", {"x", "y"}, callbacks_);
+  auto bar_sub = grpc_mux_->subscribe("bar", {}, callbacks_);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage("foo", {"x", "y"}, {});
+  expectSendMessage("bar", {}, {});
+  grpc_mux_->start();
+  expectSendMessage("bar", {"z"}, {});
+  auto bar_z_sub = grpc_mux_->subscribe("bar", {"z"}, callbacks_);
+  expectSendMessage("bar", {"zz"}, {});
+  auto bar_zz_sub = grpc_mux_->subscribe("bar", {"zz"}, callbacks_);
+  // A name that is already subscribed to is not sent again.
+  auto foo_x_sub = grpc_mux_->subscribe("foo", {"x"}, callbacks_);
+  expectSendMessage("bar", {}, {"zz"});
+  expectSendMessage("bar", {}, {"z"});
+  expectSendMessage("foo", {}, {"x", "y"});
+}
+
+// Validate that a new stream resubscribes to every name, with the versions already held.
+TEST_F(IncrementalGrpcMuxImplTest, ResetStream) {
+  Event::MockTimer* timer = nullptr;
+  Event::TimerCb timer_cb;
+  EXPECT_CALL(dispatcher_, createTimer_(_)).WillOnce(Invoke([&timer, &timer_cb](Event::TimerCb cb) {
+    timer_cb = cb;
+    EXPECT_EQ(nullptr, timer);
+    timer = new Event::MockTimer();
+    return timer;
+  }));
+  setup();
+  InSequence s;
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  auto foo_sub = grpc_mux_->subscribe(type_url, {"x", "y"}, callbacks_);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"x", "y"}, {});
+  grpc_mux_->start();
+
+  EXPECT_CALL(callbacks_, onIncrementalConfigUpdate(_, _, "1"));
+  expectSendMessage(type_url, {}, {}, {}, "nonce1");
+  grpc_mux_->onReceiveMessage(response(type_url, "1", "nonce1", {"x"}));
+
+  EXPECT_CALL(random_, random());
+  ASSERT_TRUE(timer != nullptr); // initialized from dispatcher mock.
+  EXPECT_CALL(*timer, enableTimer(_));
+  grpc_mux_->onRemoteClose(Grpc::Status::GrpcStatus::Canceled, "");
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"x", "y"}, {}, {{"x", "1"}});
+  timer_cb();
+
+  expectSendMessage(type_url, {}, {"x", "y"});
+}
+
+// Validate pause-resume behavior.
+TEST_F(IncrementalGrpcMuxImplTest, PauseResume) {
+  setup();
+  InSequence s;
+  auto foo_sub = grpc_mux_->subscribe("foo", {"x", "y"}, callbacks_);
+  grpc_mux_->pause("foo");
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  grpc_mux_->start();
+  expectSendMessage("foo", {"x", "y"}, {});
+  grpc_mux_->resume("foo");
+  grpc_mux_->pause("foo");
+  auto foo_z_sub = grpc_mux_->subscribe("foo", {"z"}, callbacks_);
+  auto foo_zz_sub = grpc_mux_->subscribe("foo", {"zz"}, callbacks_);
+  // The changes made during the pause are sent together.
+  expectSendMessage("foo", {"z", "zz"}, {});
+  grpc_mux_->resume("foo");
+  grpc_mux_->pause("foo");
+}
+
+// Validate behavior when type URL mismatches occur.
+TEST_F(IncrementalGrpcMuxImplTest, TypeUrlMismatch) {
+  setup();
+  InSequence s;
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  auto foo_sub = grpc_mux_->subscribe(type_url, {"x"}, callbacks_);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"x"}, {});
+  grpc_mux_->start();
+
+  auto message = response(type_url, "1", "nonce1", {"x"});
+  message->mutable_resources(0)->mutable_resource()->set_type_url("bar");
+  EXPECT_CALL(callbacks_, onIncrementalConfigUpdate(_, _, _)).Times(0);
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(_));
+  expectSendMessage(type_url, {}, {}, {}, "nonce1", Grpc::Status::GrpcStatus::Internal,
+                    fmt::format("bar does not match {} type URL is IncrementalDiscoveryResponse {}",
+                                type_url, message->DebugString()));
+  grpc_mux_->onReceiveMessage(std::move(message));
+
+  expectSendMessage(type_url, {}, {"x"});
+}
+
+// Validate that the watches on all resources see every change.
+TEST_F(IncrementalGrpcMuxImplTest, WildcardWatch) {
+  setup();
+  InSequence s;
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  auto foo_sub = grpc_mux_->subscribe(type_url, {}, callbacks_);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {}, {});
+  grpc_mux_->start();
+
+  EXPECT_CALL(callbacks_, onIncrementalConfigUpdate(_, _, "1"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added,
+                          const Protobuf::RepeatedPtrField<ProtobufTypes::String>& removed,
+                          const std::string&) {
+        EXPECT_EQ((std::vector<std::string>{"x", "y"}), clusterNames(added));
+        EXPECT_EQ((std::vector<std::string>{"z"}), removedNames(removed));
+      }));
+  expectSendMessage(type_url, {}, {}, {}, "nonce1");
+  grpc_mux_->onReceiveMessage(response(type_url, "1", "nonce1", {"x", "y"}, {"z"}));
+}
+
+// Validate that the watches on named resources only see the changes of those resources.
+TEST_F(IncrementalGrpcMuxImplTest, WatchDemux) {
+  setup();
+  InSequence s;
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  NiceMock<MockGrpcMuxCallbacks> foo_callbacks;
+  auto foo_sub = grpc_mux_->subscribe(type_url, {"x", "y"}, foo_callbacks);
+  NiceMock<MockGrpcMuxCallbacks> bar_callbacks;
+  auto bar_sub = grpc_mux_->subscribe(type_url, {"y", "z"}, bar_callbacks);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"x", "y", "z"}, {});
+  grpc_mux_->start();
+
+  EXPECT_CALL(bar_callbacks, onIncrementalConfigUpdate(_, _, _)).Times(0);
+  EXPECT_CALL(foo_callbacks, onIncrementalConfigUpdate(_, _, "1"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added,
+                          const Protobuf::RepeatedPtrField<ProtobufTypes::String>& removed,
+                          const std::string&) {
+        EXPECT_EQ((std::vector<std::string>{"x"}), clusterNames(added));
+        EXPECT_TRUE(removed.empty());
+      }));
+  expectSendMessage(type_url, {}, {}, {}, "nonce1");
+  grpc_mux_->onReceiveMessage(response(type_url, "1", "nonce1", {"x"}));
+
+  EXPECT_CALL(foo_callbacks, onIncrementalConfigUpdate(_, _, "2"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added,
+                          const Protobuf::RepeatedPtrField<ProtobufTypes::String>& removed,
+                          const std::string&) {
+        EXPECT_EQ((std::vector<std::string>{"y"}), clusterNames(added));
+        EXPECT_TRUE(removed.empty());
+      }));
+  EXPECT_CALL(bar_callbacks, onIncrementalConfigUpdate(_, _, "2"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added,
+                          const Protobuf::RepeatedPtrField<ProtobufTypes::String>& removed,
+                          const std::string&) {
+        EXPECT_EQ((std::vector<std::string>{"y"}), clusterNames(added));
+        EXPECT_EQ((std::vector<std::string>{"z"}), removedNames(removed));
+      }));
+  expectSendMessage(type_url, {}, {}, {}, "nonce2");
+  grpc_mux_->onReceiveMessage(response(type_url, "2", "nonce2", {"y"}, {"z"}));
+
+  // Only the names left without a watch are unsubscribed from.
+  expectSendMessage(type_url, {}, {"z"});
+  expectSendMessage(type_url, {}, {"x", "y"});
+}
+
+// Validate that a watch on a name that is already subscribed to is handed the accepted resource,
+// as the management server does not send it again.
+TEST_F(IncrementalGrpcMuxImplTest, NewWatchOnSubscribedResource) {
+  setup();
+  InSequence s;
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  NiceMock<MockGrpcMuxCallbacks> foo_callbacks;
+  auto foo_sub = grpc_mux_->subscribe(type_url, {"x"}, foo_callbacks);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"x"}, {});
+  grpc_mux_->start();
+
+  EXPECT_CALL(foo_callbacks, onIncrementalConfigUpdate(_, _, "1"));
+  expectSendMessage(type_url, {}, {}, {}, "nonce1");
+  grpc_mux_->onReceiveMessage(response(type_url, "1", "nonce1", {"x"}));
+
+  NiceMock<MockGrpcMuxCallbacks> bar_callbacks;
+  EXPECT_CALL(async_stream_, sendMessage(_, _)).Times(0);
+  EXPECT_CALL(bar_callbacks, onIncrementalConfigUpdate(_, _, "1"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>& added,
+                          const Protobuf::RepeatedPtrField<ProtobufTypes::String>& removed,
+                          const std::string&) {
+        EXPECT_EQ((std::vector<std::string>{"x"}), clusterNames(added));
+        EXPECT_TRUE(removed.empty());
+      }));
+  auto bar_sub = grpc_mux_->subscribe(type_url, {"x"}, bar_callbacks);
+
+  // A rejection by the new watch is reported to it alone.
+  NiceMock<MockGrpcMuxCallbacks> baz_callbacks;
+  EXPECT_CALL(baz_callbacks, onIncrementalConfigUpdate(_, _, "1"))
+      .WillOnce(Invoke([](const Protobuf::RepeatedPtrField<ProtobufWkt::Any>&,
+                          const Protobuf::RepeatedPtrField<ProtobufTypes::String>&,
+                          const std::string&) { throw EnvoyException("bad config"); }));
+  EXPECT_CALL(baz_callbacks, onConfigUpdateFailed(_));
+  auto baz_sub = grpc_mux_->subscribe(type_url, {"x"}, baz_callbacks);
+  testing::Mock::VerifyAndClearExpectations(&async_stream_);
+
+  expectSendMessage(type_url, {}, {"x"});
+}
+
+// Validate that an unwatched type is acknowledged without being applied.
+TEST_F(IncrementalGrpcMuxImplTest, UnwatchedTypeAccepted) {
+  setup();
+  InSequence s;
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  auto foo_sub = grpc_mux_->subscribe(type_url, {"x"}, callbacks_);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"x"}, {});
+  grpc_mux_->start();
+
+  expectSendMessage(type_url, {}, {"x"});
+  foo_sub.reset();
+
+  EXPECT_CALL(callbacks_, onIncrementalConfigUpdate(_, _, _)).Times(0);
+  expectSendMessage(type_url, {}, {}, {}, "nonce1");
+  grpc_mux_->onReceiveMessage(response(type_url, "1", "nonce1", {}, {"x"}));
+}
+
+// Validate that the type URL may be left implicit when a single API is served.
+TEST_F(IncrementalGrpcMuxImplTest, ImplicitTypeUrl) {
+  setup();
+  InSequence s;
+  const std::string& type_url = Config::TypeUrl::get().ClusterLoadAssignment;
+  auto foo_sub = grpc_mux_->subscribe(type_url, {"x"}, callbacks_);
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage(type_url, {"x"}, {});
+  grpc_mux_->start();
+
+  EXPECT_CALL(callbacks_, onIncrementalConfigUpdate(_, _, "1"));
+  expectSendMessage(type_url, {}, {}, {}, "nonce1");
+  grpc_mux_->onReceiveMessage(response("", "1", "nonce1", {"x"}));
+
+  expectSendMessage(type_url, {}, {"x"});
+}
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
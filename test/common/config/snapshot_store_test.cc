@@ -0,0 +1,76 @@
+#include "envoy/api/v2/cds.pb.h"
+
+#include "common/config/resources.h"
+#include "common/config/snapshot_store.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/logging.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Config {
+namespace {
+
+class SnapshotStoreTest : public testing::Test {
+public:
+  SnapshotStoreTest() : directory_(TestEnvironment::temporaryPath("snapshot_store_test")) {
+    TestEnvironment::createPath(directory_);
+    store_ = std::make_unique<SnapshotStore>(directory_);
+  }
+
+  const std::string directory_;
+  SnapshotStorePtr store_;
+};
+
+TEST_F(SnapshotStoreTest, MissingDirectory) {
+  EXPECT_THROW_WITH_MESSAGE(SnapshotStore(directory_ + "/missing"), EnvoyException,
+                            "xDS snapshot directory " + directory_ + "/missing does not exist");
+}
+
+TEST_F(SnapshotStoreTest, Path) {
+  EXPECT_EQ(directory_ + "/envoy.api.v2.Cluster.pb", store_->path(TypeUrl::get().Cluster));
+}
+
+TEST_F(SnapshotStoreTest, RoundTrip) {
+  envoy::api::v2::DiscoveryResponse response;
+  response.set_type_url(TypeUrl::get().Cluster);
+  response.set_version_info("1");
+  envoy::api::v2::Cluster cluster;
+  cluster.set_name("foo");
+  response.add_resources()->PackFrom(cluster);
+  store_->store(response);
+
+  auto snapshot = store_->load(TypeUrl::get().Cluster);
+  ASSERT_NE(nullptr, snapshot);
+  EXPECT_TRUE(TestUtility::protoEqual(response, *snapshot));
+
+  // A later response replaces the snapshot.
+  response.set_version_info("2");
+  store_->store(response);
+  EXPECT_EQ("2", store_->load(TypeUrl::get().Cluster)->version_info());
+}
+
+TEST_F(SnapshotStoreTest, Missing) {
+  EXPECT_EQ(nullptr, store_->load(TypeUrl::get().Listener));
+}
+
+TEST_F(SnapshotStoreTest, Corrupt) {
+  const std::string path = TestEnvironment::writeStringToFileForTest(
+      "snapshot_store_test/envoy.api.v2.RouteConfiguration.pb", "\xff\xff\xff");
+  EXPECT_LOG_CONTAINS("warn", "Ignoring unreadable xDS snapshot " + path,
+                      EXPECT_EQ(nullptr, store_->load(TypeUrl::get().RouteConfiguration)));
+}
+
+TEST_F(SnapshotStoreTest, TypeUrlMismatch) {
+  envoy::api::v2::DiscoveryResponse response;
+  response.set_type_url(TypeUrl::get().Cluster);
+  TestEnvironment::writeStringToFileForTest(
+      "snapshot_store_test/envoy.api.v2.ClusterLoadAssignment.pb", response.SerializeAsString());
+  EXPECT_EQ(nullptr, store_->load(TypeUrl::get().ClusterLoadAssignment));
+}
+
+} // namespace
+} // namespace Config
+} // namespace Envoy
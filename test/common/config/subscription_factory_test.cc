@@ -19,6 +19,7 @@
 
 using ::testing::_;
 using ::testing::Invoke;
+using ::testing::Property;
 using ::testing::Return;
 
 namespace Envoy {
@@ -307,17 +308,48 @@ TEST_F(SubscriptionFactoryTest, GrpcSubscription) {
   subscriptionFromConfigSource(config)->start({"static_cluster"}, callbacks_);
 }
 
+TEST_F(SubscriptionFactoryTest, IncrementalGrpcSubscription) {
+  envoy::api::v2::core::ConfigSource config;
+  auto* api_config_source = config.mutable_api_config_source();
+  api_config_source->set_api_type(envoy::api::v2::core::ApiConfigSource::INCREMENTAL_GRPC);
+  api_config_source->add_grpc_services()->mutable_envoy_grpc()->set_cluster_name("static_cluster");
+  Upstream::ClusterManager::ClusterInfoMap cluster_map;
+  NiceMock<Upstream::MockCluster> cluster;
+  cluster_map.emplace("static_cluster", cluster);
+  EXPECT_CALL(cm_, clusters()).WillOnce(Return(cluster_map));
+  EXPECT_CALL(cm_, grpcAsyncClientManager()).WillOnce(ReturnRef(cm_.async_client_manager_));
+  EXPECT_CALL(cm_.async_client_manager_, factoryForGrpcService(_, _, _))
+      .WillOnce(Invoke([](const envoy::api::v2::core::GrpcService&, Stats::Scope&, bool) {
+        auto async_client_factory = std::make_unique<Grpc::MockAsyncClientFactory>();
+        EXPECT_CALL(*async_client_factory, create()).WillOnce(Invoke([] {
+          auto async_client = std::make_unique<Grpc::MockAsyncClient>();
+          EXPECT_CALL(*async_client,
+                      start(Property(&Protobuf::MethodDescriptor::full_name,
+                                     "envoy.api.v2.EndpointDiscoveryService.IncrementalEndpoints"),
+                            _))
+              .WillOnce(Return(nullptr));
+          return async_client;
+        }));
+        return async_client_factory;
+      }));
+  EXPECT_CALL(random_, random());
+  EXPECT_CALL(dispatcher_, createTimer_(_));
+  EXPECT_CALL(callbacks_, onConfigUpdateFailed(_));
+  subscriptionFromConfigSource(config)->start({"static_cluster"}, callbacks_);
+}
+
 INSTANTIATE_TEST_CASE_P(SubscriptionFactoryTestApiConfigSource,
                         SubscriptionFactoryTestApiConfigSource,
                         ::testing::Values(envoy::api::v2::core::ApiConfigSource::REST_LEGACY,
                                           envoy::api::v2::core::ApiConfigSource::REST,
-                                          envoy::api::v2::core::ApiConfigSource::GRPC));
+                                          envoy::api::v2::core::ApiConfigSource::GRPC,
+                                          envoy::api::v2::core::ApiConfigSource::INCREMENTAL_GRPC));
 
 TEST_P(SubscriptionFactoryTestApiConfigSource, NonExistentCluster) {
   envoy::api::v2::core::ConfigSource config;
   auto* api_config_source = config.mutable_api_config_source();
   api_config_source->set_api_type(GetParam());
-  if (api_config_source->api_type() == envoy::api::v2::core::ApiConfigSource::GRPC) {
+  if (Utility::isGrpcApiConfigSource(*api_config_source)) {
     api_config_source->add_grpc_services()->mutable_envoy_grpc()->set_cluster_name(
         "static_cluster");
   } else {
@@ -335,7 +367,7 @@ TEST_P(SubscriptionFactoryTestApiConfigSource, DynamicCluster) {
   envoy::api::v2::core::ConfigSource config;
   auto* api_config_source = config.mutable_api_config_source();
   api_config_source->set_api_type(GetParam());
-  if (api_config_source->api_type() == envoy::api::v2::core::ApiConfigSource::GRPC) {
+  if (Utility::isGrpcApiConfigSource(*api_config_source)) {
     api_config_source->add_grpc_services()->mutable_envoy_grpc()->set_cluster_name(
         "static_cluster");
   } else {
@@ -357,7 +389,7 @@ TEST_P(SubscriptionFactoryTestApiConfigSource, EDSClusterBackingEDSCluster) {
   envoy::api::v2::core::ConfigSource config;
   auto* api_config_source = config.mutable_api_config_source();
   api_config_source->set_api_type(GetParam());
-  if (api_config_source->api_type() == envoy::api::v2::core::ApiConfigSource::GRPC) {
+  if (Utility::isGrpcApiConfigSource(*api_config_source)) {
     api_config_source->add_grpc_services()->mutable_envoy_grpc()->set_cluster_name(
         "static_cluster");
   } else {
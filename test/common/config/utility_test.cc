@@ -216,6 +216,23 @@ TEST(UtilityTest, CheckFilesystemSubscriptionBackingPath) {
 
 // TEST(UtilityTest, FactoryForGrpcApiConfigSource) should catch misconfigured
 // API configs along the dimension of ApiConfigSource type.
+TEST(UtilityTest, IncrementalGrpcMethod) {
+  EXPECT_EQ("envoy.api.v2.ClusterDiscoveryService.IncrementalClusters",
+            Utility::incrementalGrpcMethod("envoy.api.v2.ClusterDiscoveryService.StreamClusters")
+                .full_name());
+  EXPECT_EQ("envoy.api.v2.EndpointDiscoveryService.IncrementalEndpoints",
+            Utility::incrementalGrpcMethod("envoy.api.v2.EndpointDiscoveryService.StreamEndpoints")
+                .full_name());
+  EXPECT_EQ("envoy.api.v2.RouteDiscoveryService.IncrementalRoutes",
+            Utility::incrementalGrpcMethod("envoy.api.v2.RouteDiscoveryService.StreamRoutes")
+                .full_name());
+  EXPECT_THROW_WITH_MESSAGE(
+      Utility::incrementalGrpcMethod("envoy.api.v2.ListenerDiscoveryService.StreamListeners"),
+      EnvoyException,
+      "envoy::api::v2::core::ConfigSource type INCREMENTAL_GRPC is not supported by "
+      "envoy.api.v2.ListenerDiscoveryService.StreamListeners");
+}
+
 TEST(UtilityTest, FactoryForGrpcApiConfigSource) {
   NiceMock<Grpc::MockAsyncClientManager> async_client_manager;
   Stats::MockStore scope;
@@ -279,7 +296,8 @@ TEST(UtilityTest, FactoryForGrpcApiConfigSource) {
     api_config_source.add_cluster_names("foo");
     EXPECT_THROW_WITH_REGEX(
         Utility::factoryForGrpcApiConfigSource(async_client_manager, api_config_source, scope),
-        EnvoyException, "envoy::api::v2::core::ConfigSource type must be GRPC:");
+        EnvoyException,
+        "envoy::api::v2::core::ConfigSource type must be GRPC or INCREMENTAL_GRPC:");
   }
 
   {
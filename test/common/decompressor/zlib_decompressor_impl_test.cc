@@ -189,6 +189,28 @@ TEST_F(ZlibDecompressorImplTest, DecompressWithSmallOutputBuffer) {
   EXPECT_EQ(original_text, decompressed_text);
 }
 
+// Verifies that the output of the compressor and of the decompressor follows the data that the
+// output buffers already hold.
+TEST_F(ZlibDecompressorImplTest, AppendToOutput) {
+  Buffer::OwnedImpl buffer;
+  TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size);
+  const std::string original_text{buffer.toString()};
+
+  Envoy::Compressor::ZlibCompressorImpl compressor(64);
+  compressor.init(Envoy::Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+                  Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard,
+                  gzip_window_bits, memory_level);
+  compressor.compress(buffer, Compressor::State::Finish);
+
+  Buffer::OwnedImpl output_buffer("prefix");
+  ZlibDecompressorImpl decompressor(64);
+  decompressor.init(gzip_window_bits);
+  decompressor.decompress(buffer, output_buffer);
+
+  EXPECT_EQ("prefix" + original_text, output_buffer.toString());
+  EXPECT_EQ(compressor.checksum(), decompressor.checksum());
+}
+
 // Exercises decompression with other supported zlib initialization params.
 TEST_F(ZlibDecompressorImplTest, CompressDecompressWithUncommonParams) {
   // Test with different memory levels.
@@ -1,16 +1,22 @@
 #include <functional>
+#include <vector>
 
 #include "common/common/lock_guard.h"
 #include "common/common/thread.h"
 #include "common/event/dispatcher_impl.h"
 
 #include "test/mocks/common.h"
+#include "test/mocks/stats/mocks.h"
 #include "test/test_common/test_time.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::_;
+using testing::AnyNumber;
 using testing::InSequence;
+using testing::NiceMock;
+using testing::Property;
 
 namespace Envoy {
 namespace Event {
@@ -168,5 +174,56 @@ TEST_F(DispatcherImplTest, Timer) {
   }
 }
 
+// The approximate time is read once per callback, and read again in the next callback.
+TEST(DispatcherApproximateTimeTest, InvalidatedPerCallback) {
+  NiceMock<MockTimeSystem> time_system;
+  uint64_t reads = 0;
+  ON_CALL(time_system, monotonicTime()).WillByDefault(testing::Invoke([&reads]() {
+    return MonotonicTime(std::chrono::seconds(++reads));
+  }));
+  DispatcherImpl dispatcher(time_system);
+
+  std::vector<MonotonicTime> times;
+  for (int i = 0; i < 2; ++i) {
+    dispatcher.post([&dispatcher, &times]() -> void {
+      times.push_back(dispatcher.approximateTimeSource().monotonicTime());
+      times.push_back(dispatcher.approximateTimeSource().monotonicTime());
+    });
+  }
+  dispatcher.run(Dispatcher::RunType::NonBlock);
+
+  ASSERT_EQ(4, times.size());
+  EXPECT_EQ(times[0], times[1]);
+  EXPECT_EQ(times[2], times[3]);
+  EXPECT_LT(times[1], times[2]);
+}
+
+TEST(DispatcherStatsTest, RecordsCallbacks) {
+  DangerousDeprecatedTestTime test_time;
+  DispatcherImpl dispatcher(test_time.timeSystem());
+  NiceMock<Stats::MockIsolatedStatsStore> store;
+  dispatcher.initializeStats(store, "test.dispatcher.");
+  EXPECT_CALL(store, deliverHistogramToSinks(_, _)).Times(AnyNumber());
+
+  EXPECT_CALL(store, deliverHistogramToSinks(
+                         Property(&Stats::Metric::name, "test.dispatcher.post_us"), _));
+  dispatcher.post([]() -> void {});
+  dispatcher.post([]() -> void {});
+  dispatcher.run(Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(2UL, store.gauge("test.dispatcher.post_queue_depth").value());
+
+  EXPECT_CALL(store, deliverHistogramToSinks(
+                         Property(&Stats::Metric::name, "test.dispatcher.timer_us"), _));
+  TimerPtr timer = dispatcher.createTimer([&dispatcher]() -> void { dispatcher.exit(); });
+  timer->enableTimer(std::chrono::milliseconds(0));
+  dispatcher.run(Dispatcher::RunType::Block);
+
+  EXPECT_CALL(store, deliverHistogramToSinks(
+                         Property(&Stats::Metric::name, "test.dispatcher.deferred_delete_us"), _));
+  dispatcher.deferredDelete(DeferredDeletablePtr{new TestDeferredDeletable([]() -> void {})});
+  dispatcher.clearDeferredDeleteList();
+  EXPECT_EQ(1UL, store.gauge("test.dispatcher.deferred_delete_queue_depth").value());
+}
+
 } // namespace Event
 } // namespace Envoy
@@ -3,6 +3,7 @@
 #include "envoy/event/file_event.h"
 
 #include "common/event/dispatcher_impl.h"
+#include "common/event/libevent.h"
 
 #include "test/mocks/common.h"
 #include "test/test_common/environment.h"
@@ -165,5 +166,40 @@ TEST_F(FileEventImplTest, SetEnabled) {
   dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
 }
 
+#ifdef __linux__
+// Queued interest changes must still be applied before the loop polls.
+TEST_F(FileEventImplTest, EpollChangelist) {
+  Libevent::Global::setBackend(Libevent::Backend::EpollChangelist);
+  DispatcherImpl dispatcher(test_time_.timeSystem());
+  Libevent::Global::setBackend(Libevent::Backend::Default);
+
+  ReadyWatcher read_event;
+  EXPECT_CALL(read_event, ready()).Times(2);
+  ReadyWatcher write_event;
+  EXPECT_CALL(write_event, ready()).Times(1);
+
+  Event::FileEventPtr file_event = dispatcher.createFileEvent(
+      fds_[0],
+      [&](uint32_t events) -> void {
+        if (events & FileReadyType::Read) {
+          read_event.ready();
+        }
+
+        if (events & FileReadyType::Write) {
+          write_event.ready();
+        }
+      },
+      FileTriggerType::Edge, FileReadyType::Read);
+
+  dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+
+  file_event->setEnabled(0);
+  dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+
+  file_event->setEnabled(FileReadyType::Read | FileReadyType::Write);
+  dispatcher.run(Event::Dispatcher::RunType::NonBlock);
+}
+#endif
+
 } // namespace Event
 } // namespace Envoy
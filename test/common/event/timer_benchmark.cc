@@ -0,0 +1,62 @@
+// Usage: bazel run //test/common/event:timer_benchmark
+
+#include <chrono>
+#include <vector>
+
+#include "common/event/dispatcher_impl.h"
+#include "common/event/libevent.h"
+#include "common/event/real_time_system.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+// Re-arms and cancels a population of pending timers, as idle timeouts do on every stream event.
+void rearmTimers(benchmark::State& state, bool coarse) {
+  RealTimeSystem time_system;
+  DispatcherImpl dispatcher(time_system);
+  const uint64_t num_timers = state.range(0);
+
+  std::vector<TimerPtr> timers;
+  for (uint64_t i = 0; i < num_timers; i++) {
+    auto cb = []() -> void {};
+    timers.push_back(coarse ? dispatcher.createCoarseTimer(cb) : dispatcher.createTimer(cb));
+    timers.back()->enableTimer(std::chrono::milliseconds(60000 + i % 1000));
+  }
+
+  uint64_t i = 0;
+  for (auto _ : state) {
+    Timer& timer = *timers[i++ % num_timers];
+    timer.enableTimer(std::chrono::milliseconds(60000 + i % 1000));
+    timer.disableTimer();
+    timer.enableTimer(std::chrono::milliseconds(60000 + i % 1000));
+  }
+}
+
+void BM_LibeventTimerRearm(benchmark::State& state) { rearmTimers(state, false); }
+BENCHMARK(BM_LibeventTimerRearm)->Arg(100)->Arg(10000)->Arg(1000000);
+
+void BM_CoarseTimerRearm(benchmark::State& state) { rearmTimers(state, true); }
+BENCHMARK(BM_CoarseTimerRearm)->Arg(100)->Arg(10000)->Arg(1000000);
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  // TODO(mattklein123): Provide a common bazel benchmark wrapper much like we do for normal tests,
+  // fuzz, etc.
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn,
+                                      Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+  Envoy::Event::Libevent::Global::initialize();
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,150 @@
+#include <chrono>
+
+#include "common/event/timer_wheel.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::AnyNumber;
+using testing::NiceMock;
+using testing::ReturnPointee;
+using testing::_;
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+// Hands out a single MockTimer to drive the wheel's tick.
+class TestScheduler : public Scheduler {
+public:
+  TimerPtr createTimer(const TimerCb& cb) override {
+    tick_timer_ = new NiceMock<MockTimer>();
+    tick_timer_->callback_ = cb;
+    EXPECT_CALL(*tick_timer_, enableTimer(_)).Times(AnyNumber());
+    return TimerPtr{tick_timer_};
+  }
+
+  MockTimer* tick_timer_{};
+};
+
+class TimerWheelTest : public testing::Test {
+protected:
+  TimerWheelTest() {
+    ON_CALL(time_system_, monotonicTime()).WillByDefault(ReturnPointee(&now_));
+    wheel_ = std::make_unique<TimerWheel>(scheduler_, time_system_);
+  }
+
+  // Advance time and run the tick timer, as the event loop would when it expires.
+  void advance(uint64_t ms) {
+    now_ += std::chrono::milliseconds(ms);
+    scheduler_.tick_timer_->callback_();
+  }
+
+  MonotonicTime now_;
+  NiceMock<MockTimeSystem> time_system_;
+  TestScheduler scheduler_;
+  std::unique_ptr<TimerWheel> wheel_;
+};
+
+TEST_F(TimerWheelTest, FiresAfterTimeout) {
+  ReadyWatcher watcher;
+  TimerPtr timer = wheel_->createTimer([&]() -> void { watcher.ready(); });
+
+  // The timeout is rounded up to the next whole tick.
+  EXPECT_CALL(*scheduler_.tick_timer_, enableTimer(std::chrono::milliseconds(101)));
+  timer->enableTimer(std::chrono::milliseconds(100));
+
+  EXPECT_CALL(watcher, ready()).Times(0);
+  advance(100);
+
+  EXPECT_CALL(watcher, ready());
+  advance(1);
+
+  // Nothing is left to fire.
+  EXPECT_CALL(watcher, ready()).Times(0);
+  advance(1000);
+}
+
+TEST_F(TimerWheelTest, DisableAndReenable) {
+  ReadyWatcher watcher1;
+  ReadyWatcher watcher2;
+  TimerPtr timer1 = wheel_->createTimer([&]() -> void { watcher1.ready(); });
+  TimerPtr timer2 = wheel_->createTimer([&]() -> void { watcher2.ready(); });
+
+  timer1->enableTimer(std::chrono::milliseconds(10));
+  timer2->enableTimer(std::chrono::milliseconds(10));
+  timer1->disableTimer();
+  timer2->enableTimer(std::chrono::milliseconds(50));
+
+  EXPECT_CALL(watcher1, ready()).Times(0);
+  EXPECT_CALL(watcher2, ready()).Times(0);
+  advance(11);
+
+  EXPECT_CALL(watcher2, ready());
+  advance(40);
+
+  // Destroying a pending timer unregisters it.
+  timer1->enableTimer(std::chrono::milliseconds(5));
+  timer1.reset();
+  advance(10);
+}
+
+TEST_F(TimerWheelTest, BeyondOneRevolution) {
+  ReadyWatcher watcher;
+  TimerPtr timer = wheel_->createTimer([&]() -> void { watcher.ready(); });
+  const uint64_t timeout = 3 * TimerWheel::NumSlots + 7;
+  timer->enableTimer(std::chrono::milliseconds(timeout));
+
+  // The tick timer is armed once per revolution until the timer expires.
+  EXPECT_CALL(watcher, ready()).Times(0);
+  for (uint32_t i = 0; i < 3; i++) {
+    advance(TimerWheel::NumSlots);
+  }
+  advance(7);
+
+  EXPECT_CALL(watcher, ready());
+  advance(1);
+}
+
+TEST_F(TimerWheelTest, LateTickFiresEverythingExpired) {
+  ReadyWatcher watcher;
+  std::vector<TimerPtr> timers;
+  for (uint32_t i = 1; i <= 10; i++) {
+    timers.push_back(wheel_->createTimer([&]() -> void { watcher.ready(); }));
+    timers.back()->enableTimer(std::chrono::milliseconds(i * 1000));
+  }
+
+  // The event loop was blocked for longer than a revolution.
+  EXPECT_CALL(watcher, ready()).Times(10);
+  advance(20000);
+}
+
+TEST_F(TimerWheelTest, CallbacksModifyTimers) {
+  ReadyWatcher watcher;
+  TimerPtr timer2;
+  TimerPtr timer1 = wheel_->createTimer([&]() -> void {
+    watcher.ready();
+    // Destroy another expired timer before it runs, and re-arm this one.
+    timer2.reset();
+    timer1->enableTimer(std::chrono::milliseconds(0));
+  });
+  timer2 = wheel_->createTimer([&]() -> void { FAIL(); });
+
+  timer1->enableTimer(std::chrono::milliseconds(5));
+  timer2->enableTimer(std::chrono::milliseconds(5));
+
+  // A zero timeout from within a callback runs on the next tick, not in the same one.
+  EXPECT_CALL(*scheduler_.tick_timer_, enableTimer(std::chrono::milliseconds(1)));
+  EXPECT_CALL(watcher, ready());
+  advance(6);
+
+  EXPECT_CALL(watcher, ready());
+  advance(1);
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
@@ -1,4 +1,5 @@
 #include <chrono>
+#include <memory>
 #include <string>
 
 #include "common/api/os_sys_calls_impl.h"
@@ -33,7 +34,8 @@ TEST(FileSystemImpl, BadFile) {
   Thread::MutexBasicLockable lock;
   Stats::IsolatedStoreImpl store;
   EXPECT_CALL(dispatcher, createTimer_(_));
-  EXPECT_THROW(Filesystem::FileImpl("", dispatcher, lock, store, std::chrono::milliseconds(10000)),
+  EXPECT_THROW(Filesystem::FileImpl("", dispatcher, lock, store, std::chrono::milliseconds(10000),
+                                    std::make_shared<Filesystem::FileFlusher>()),
                EnvoyException);
 }
 
@@ -114,7 +116,8 @@ TEST(FileSystemImpl, flushToLogFilePeriodically) {
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            std::make_shared<Filesystem::FileFlusher>());
 
   EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(40)));
   EXPECT_CALL(os_sys_calls, write_(_, _, _))
@@ -167,7 +170,8 @@ TEST(FileSystemImpl, flushToLogFileOnDemand) {
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            std::make_shared<Filesystem::FileFlusher>());
 
   EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(40)));
 
@@ -241,7 +245,8 @@ TEST(FileSystemImpl, reopenFile) {
 
   Sequence sq;
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(5));
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            std::make_shared<Filesystem::FileFlusher>());
 
   EXPECT_CALL(os_sys_calls, write_(_, _, _))
       .InSequence(sq)
@@ -310,7 +315,8 @@ TEST(FilesystemImpl, reopenThrows) {
   Sequence sq;
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(5));
 
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            std::make_shared<Filesystem::FileFlusher>());
   EXPECT_CALL(os_sys_calls, close(5)).InSequence(sq);
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(-1));
 
@@ -346,7 +352,8 @@ TEST(FilesystemImpl, bigDataChunkShouldBeFlushedWithoutTimer) {
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            std::make_shared<Filesystem::FileFlusher>());
 
   EXPECT_CALL(os_sys_calls, write_(_, _, _))
       .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
@@ -391,4 +398,40 @@ TEST(FilesystemImpl, bigDataChunkShouldBeFlushedWithoutTimer) {
     }
   }
 }
+
+TEST(FilesystemImpl, filesShareFlusher) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  Thread::MutexBasicLockable mutex;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  Filesystem::FileFlusherSharedPtr flusher = std::make_shared<Filesystem::FileFlusher>();
+
+  EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5)).WillOnce(Return(6));
+  Filesystem::FileImpl file1("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                             flusher);
+  Filesystem::FileImpl file2("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                             flusher);
+
+  EXPECT_CALL(os_sys_calls, write_(5, _, _))
+      .WillOnce(Invoke([](int, const void* buffer, size_t num_bytes) -> ssize_t {
+        EXPECT_EQ("file1", std::string(reinterpret_cast<const char*>(buffer), num_bytes));
+        return num_bytes;
+      }));
+  EXPECT_CALL(os_sys_calls, write_(6, _, _))
+      .WillOnce(Invoke([](int, const void* buffer, size_t num_bytes) -> ssize_t {
+        EXPECT_EQ("file2", std::string(reinterpret_cast<const char*>(buffer), num_bytes));
+        return num_bytes;
+      }));
+
+  file1.write("file1");
+  file2.write("file2");
+
+  {
+    Thread::LockGuard lock(os_sys_calls.write_mutex_);
+    while (os_sys_calls.num_writes_ != 2) {
+      os_sys_calls.write_event_.wait(os_sys_calls.write_mutex_);
+    }
+  }
+}
 } // namespace Envoy
@@ -24,7 +24,7 @@ public:
 };
 
 TEST_F(AsyncClientManagerImplTest, EnvoyGrpcOk) {
-  AsyncClientManagerImpl async_client_manager(cm_, tls_, test_time_.timeSystem());
+  AsyncClientManagerImpl async_client_manager(cm_, tls_, test_time_.timeSystem(), 0);
   envoy::api::v2::core::GrpcService grpc_service;
   grpc_service.mutable_envoy_grpc()->set_cluster_name("foo");
 
@@ -39,7 +39,7 @@ TEST_F(AsyncClientManagerImplTest, EnvoyGrpcOk) {
 }
 
 TEST_F(AsyncClientManagerImplTest, EnvoyGrpcUnknown) {
-  AsyncClientManagerImpl async_client_manager(cm_, tls_, test_time_.timeSystem());
+  AsyncClientManagerImpl async_client_manager(cm_, tls_, test_time_.timeSystem(), 0);
   envoy::api::v2::core::GrpcService grpc_service;
   grpc_service.mutable_envoy_grpc()->set_cluster_name("foo");
 
@@ -49,7 +49,7 @@ TEST_F(AsyncClientManagerImplTest, EnvoyGrpcUnknown) {
 }
 
 TEST_F(AsyncClientManagerImplTest, EnvoyGrpcDynamicCluster) {
-  AsyncClientManagerImpl async_client_manager(cm_, tls_, test_time_.timeSystem());
+  AsyncClientManagerImpl async_client_manager(cm_, tls_, test_time_.timeSystem(), 0);
   envoy::api::v2::core::GrpcService grpc_service;
   grpc_service.mutable_envoy_grpc()->set_cluster_name("foo");
 
@@ -65,7 +65,21 @@ TEST_F(AsyncClientManagerImplTest, EnvoyGrpcDynamicCluster) {
 
 TEST_F(AsyncClientManagerImplTest, GoogleGrpc) {
   EXPECT_CALL(scope_, createScope_("grpc.foo."));
-  AsyncClientManagerImpl async_client_manager(cm_, tls_, test_time_.timeSystem());
+  AsyncClientManagerImpl async_client_manager(cm_, tls_, test_time_.timeSystem(), 0);
+  envoy::api::v2::core::GrpcService grpc_service;
+  grpc_service.mutable_google_grpc()->set_stat_prefix("foo");
+
+#ifdef ENVOY_GOOGLE_GRPC
+  EXPECT_NE(nullptr, async_client_manager.factoryForGrpcService(grpc_service, scope_, false));
+#else
+  EXPECT_THROW_WITH_MESSAGE(async_client_manager.factoryForGrpcService(grpc_service, scope_, false),
+                            EnvoyException, "Google C++ gRPC client is not linked");
+#endif
+}
+
+TEST_F(AsyncClientManagerImplTest, GoogleGrpcSharedCompletionThreads) {
+  EXPECT_CALL(scope_, createScope_("grpc.foo."));
+  AsyncClientManagerImpl async_client_manager(cm_, tls_, test_time_.timeSystem(), 2);
   envoy::api::v2::core::GrpcService grpc_service;
   grpc_service.mutable_google_grpc()->set_stat_prefix("foo");
 
@@ -78,7 +92,7 @@ TEST_F(AsyncClientManagerImplTest, GoogleGrpc) {
 }
 
 TEST_F(AsyncClientManagerImplTest, EnvoyGrpcUnknownOk) {
-  AsyncClientManagerImpl async_client_manager(cm_, tls_, test_time_.timeSystem());
+  AsyncClientManagerImpl async_client_manager(cm_, tls_, test_time_.timeSystem(), 0);
   envoy::api::v2::core::GrpcService grpc_service;
   grpc_service.mutable_envoy_grpc()->set_cluster_name("foo");
 
@@ -104,6 +104,29 @@ TEST(GrpcCodecTest, decodeInvalidFrame) {
   EXPECT_EQ(size, buffer.length());
 }
 
+TEST(GrpcCodecTest, decodeInvalidSecondFrame) {
+  helloworld::HelloRequest request;
+  request.set_name("hello");
+
+  Buffer::OwnedImpl buffer;
+  std::array<uint8_t, 5> header;
+  Encoder encoder;
+  encoder.newFrame(GRPC_FH_DEFAULT, request.ByteSize(), header);
+  buffer.add(header.data(), 5);
+  buffer.add(request.SerializeAsString());
+  encoder.newFrame(0b10u, request.ByteSize(), header);
+  buffer.add(header.data(), 5);
+  size_t size = buffer.length();
+
+  // The valid first frame is not consumed either.
+  std::vector<Frame> frames;
+  Decoder decoder;
+  EXPECT_FALSE(decoder.decode(buffer, frames));
+  EXPECT_EQ(size, buffer.length());
+  EXPECT_EQ(static_cast<size_t>(0), frames.size());
+  EXPECT_EQ(false, decoder.hasBufferedData());
+}
+
 TEST(GrpcCodecTest, decodeEmptyFrame) {
   Buffer::OwnedImpl buffer("\0\0\0\0", 5);
 
@@ -168,5 +191,36 @@ TEST(GrpcCodecTest, decodeMultipleFrame) {
   }
 }
 
+TEST(GrpcCodecTest, decodeSplitFrames) {
+  const std::string payload(100000, 'a');
+  Buffer::OwnedImpl input;
+  std::array<uint8_t, 5> header;
+  Encoder encoder;
+  encoder.newFrame(GRPC_FH_DEFAULT, payload.size(), header);
+  input.add(header.data(), 5);
+  input.add(payload);
+  encoder.newFrame(GRPC_FH_COMPRESSED, 3, header);
+  input.add(header.data(), 5);
+  input.add("bcd");
+  const std::string encoded = input.toString();
+
+  // Feed the frames in chunks splitting the headers and the payloads.
+  std::vector<Frame> frames;
+  Decoder decoder;
+  for (size_t offset = 0; offset < encoded.size(); offset += 7919) {
+    Buffer::OwnedImpl buffer(encoded.substr(offset, 7919));
+    EXPECT_TRUE(decoder.decode(buffer, frames));
+    EXPECT_EQ(static_cast<size_t>(0), buffer.length());
+  }
+  EXPECT_EQ(false, decoder.hasBufferedData());
+  ASSERT_EQ(static_cast<size_t>(2), frames.size());
+  EXPECT_EQ(GRPC_FH_DEFAULT, frames[0].flags_);
+  EXPECT_EQ(payload.size(), frames[0].length_);
+  EXPECT_EQ(payload, frames[0].data_->toString());
+  EXPECT_EQ(GRPC_FH_COMPRESSED, frames[1].flags_);
+  EXPECT_EQ(static_cast<uint32_t>(3), frames[1].length_);
+  EXPECT_EQ("bcd", frames[1].data_->toString());
+}
+
 } // namespace Grpc
 } // namespace Envoy
@@ -47,15 +47,15 @@ public:
   EnvoyGoogleAsyncClientImplTest()
       : dispatcher_(test_time_.timeSystem()),
         method_descriptor_(helloworld::Greeter::descriptor()->FindMethodByName("SayHello")) {
-    envoy::api::v2::core::GrpcService config;
-    auto* google_grpc = config.mutable_google_grpc();
+    auto* google_grpc = config_.mutable_google_grpc();
     google_grpc->set_target_uri("fake_address");
     google_grpc->set_stat_prefix("test_cluster");
     tls_ = std::make_unique<GoogleAsyncClientThreadLocal>();
     grpc_client_ = std::make_unique<GoogleAsyncClientImpl>(dispatcher_, *tls_, stub_factory_,
-                                                           stats_store_, config);
+                                                           stats_store_, config_);
   }
 
+  envoy::api::v2::core::GrpcService config_;
   DangerousDeprecatedTestTime test_time_;
   Event::DispatcherImpl dispatcher_;
   std::unique_ptr<GoogleAsyncClientThreadLocal> tls_;
@@ -102,6 +102,34 @@ TEST_F(EnvoyGoogleAsyncClientImplTest, RequestHttpStartFail) {
   EXPECT_EQ(grpc_request, nullptr);
 }
 
+// Validate that the calls of a silo sharing a completion queue pool are issued on the completion
+// queue assigned to the silo.
+TEST_F(EnvoyGoogleAsyncClientImplTest, SharedCompletionQueue) {
+  auto cq_pool = std::make_shared<GoogleCompletionQueuePool>(1);
+  grpc_client_.reset();
+  tls_ = std::make_unique<GoogleAsyncClientThreadLocal>(cq_pool);
+  grpc_client_ = std::make_unique<GoogleAsyncClientImpl>(dispatcher_, *tls_, stub_factory_,
+                                                         stats_store_, config_);
+
+  EXPECT_CALL(*stub_factory_.stub_, PrepareCall_(_, _, &tls_->completionQueue()))
+      .WillOnce(Return(nullptr));
+  MockAsyncStreamCallbacks<helloworld::HelloReply> grpc_callbacks;
+  EXPECT_CALL(grpc_callbacks, onCreateInitialMetadata(_));
+  EXPECT_CALL(grpc_callbacks, onReceiveTrailingMetadata_(_));
+  EXPECT_CALL(grpc_callbacks, onRemoteClose(Status::GrpcStatus::Unavailable, ""));
+  EXPECT_EQ(nullptr, grpc_client_->start(*method_descriptor_, grpc_callbacks));
+}
+
+// Validate that the silos sharing a completion queue pool are spread over its queues.
+TEST(GoogleCompletionQueuePoolTest, RoundRobin) {
+  auto cq_pool = std::make_shared<GoogleCompletionQueuePool>(2);
+  GoogleAsyncClientThreadLocal tls1(cq_pool);
+  GoogleAsyncClientThreadLocal tls2(cq_pool);
+  GoogleAsyncClientThreadLocal tls3(cq_pool);
+  EXPECT_NE(&tls1.completionQueue(), &tls2.completionQueue());
+  EXPECT_EQ(&tls1.completionQueue(), &tls3.completionQueue());
+}
+
 } // namespace
 } // namespace Grpc
 } // namespace Envoy
@@ -644,6 +644,77 @@ TEST_F(AsyncClientImplTest, CancelRequest) {
   request->cancel();
 }
 
+TEST_F(AsyncClientImplTest, DiscardResponseBody) {
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](StreamDecoder& decoder,
+                           ConnectionPool::Callbacks& callbacks) -> ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(stream_encoder_, cm_.conn_pool_.host_);
+        response_decoder_ = &decoder;
+        return nullptr;
+      }));
+
+  EXPECT_CALL(stream_encoder_, encodeHeaders(HeaderMapEqualRef(&message_->headers()), true));
+  EXPECT_CALL(callbacks_, onSuccess_(_)).WillOnce(Invoke([](Message* response) -> void {
+    EXPECT_EQ(200, Utility::getResponseStatus(response->headers()));
+    EXPECT_EQ(nullptr, response->body());
+  }));
+
+  AsyncClient::RequestOptions options;
+  options.discard_response_body = true;
+  client_.send(std::move(message_), callbacks_, options);
+  response_decoder_->decodeHeaders(HeaderMapPtr(new TestHeaderMapImpl{{":status", "200"}}), false);
+  Buffer::OwnedImpl data("response body");
+  response_decoder_->decodeData(data, true);
+  EXPECT_EQ(0, data.length());
+}
+
+TEST_F(AsyncClientImplTest, MaxResponseBodyBytes) {
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](StreamDecoder& decoder,
+                           ConnectionPool::Callbacks& callbacks) -> ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(stream_encoder_, cm_.conn_pool_.host_);
+        response_decoder_ = &decoder;
+        return nullptr;
+      }));
+
+  EXPECT_CALL(stream_encoder_, encodeHeaders(HeaderMapEqualRef(&message_->headers()), true));
+
+  AsyncClient::RequestOptions options;
+  options.max_response_body_bytes = 8;
+  client_.send(std::move(message_), callbacks_, options);
+  response_decoder_->decodeHeaders(HeaderMapPtr(new TestHeaderMapImpl{{":status", "200"}}), false);
+  Buffer::OwnedImpl data1("1234");
+  response_decoder_->decodeData(data1, false);
+
+  // The failure is only reported with its actual reason, not as a reset as well.
+  EXPECT_CALL(stream_encoder_.stream_, resetStream(_));
+  EXPECT_CALL(callbacks_, onFailure(AsyncClient::FailureReason::ResponseBodyTooLarge));
+  Buffer::OwnedImpl data2("56789");
+  response_decoder_->decodeData(data2, false);
+}
+
+TEST_F(AsyncClientImplTest, MaxResponseBodyBytesNotExceeded) {
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](StreamDecoder& decoder,
+                           ConnectionPool::Callbacks& callbacks) -> ConnectionPool::Cancellable* {
+        callbacks.onPoolReady(stream_encoder_, cm_.conn_pool_.host_);
+        response_decoder_ = &decoder;
+        return nullptr;
+      }));
+
+  EXPECT_CALL(stream_encoder_, encodeHeaders(HeaderMapEqualRef(&message_->headers()), true));
+  EXPECT_CALL(callbacks_, onSuccess_(_)).WillOnce(Invoke([](Message* response) -> void {
+    EXPECT_EQ("12345678", response->bodyAsString());
+  }));
+
+  AsyncClient::RequestOptions options;
+  options.max_response_body_bytes = 8;
+  client_.send(std::move(message_), callbacks_, options);
+  response_decoder_->decodeHeaders(HeaderMapPtr(new TestHeaderMapImpl{{":status", "200"}}), false);
+  Buffer::OwnedImpl data("12345678");
+  response_decoder_->decodeData(data, true);
+}
+
 TEST_F(AsyncClientImplTest, DestroyWithActiveStream) {
   EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
       .WillOnce(Invoke([&](StreamDecoder&,
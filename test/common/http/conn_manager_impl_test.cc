@@ -12,6 +12,7 @@
 #include "common/access_log/access_log_formatter.h"
 #include "common/access_log/access_log_impl.h"
 #include "common/buffer/buffer_impl.h"
+#include "common/buffer/memory_account.h"
 #include "common/common/empty_string.h"
 #include "common/common/macros.h"
 #include "common/http/conn_manager_impl.h"
@@ -47,6 +48,7 @@ using testing::_;
 using testing::AnyNumber;
 using testing::AtLeast;
 using testing::DoAll;
+using testing::HasSubstr;
 using testing::InSequence;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
@@ -962,6 +964,52 @@ TEST_F(HttpConnectionManagerImplTest, TestAccessLog) {
   conn_manager_->onData(fake_input, false);
 }
 
+TEST_F(HttpConnectionManagerImplTest, StreamArena) {
+  setup(false, "");
+  ON_CALL(runtime_.snapshot_, featureEnabled("http_connection_manager.stream_arena_enabled", 0))
+      .WillByDefault(Return(true));
+
+  std::shared_ptr<MockStreamDecoderFilter> decoder_filter(
+      new NiceMock<MockStreamDecoderFilter>());
+  std::shared_ptr<MockStreamFilter> filter(new NiceMock<MockStreamFilter>());
+  std::shared_ptr<MockStreamEncoderFilter> encoder_filter(
+      new NiceMock<MockStreamEncoderFilter>());
+  std::shared_ptr<AccessLog::MockInstance> handler(new NiceMock<AccessLog::MockInstance>());
+
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.addStreamDecoderFilter(decoder_filter);
+        callbacks.addStreamFilter(filter);
+        callbacks.addStreamEncoderFilter(encoder_filter);
+        callbacks.addAccessLogHandler(handler);
+      }));
+
+  EXPECT_CALL(*filter, decodeHeaders(_, true)).Times(2);
+  EXPECT_CALL(*filter, encodeHeaders(_, true)).Times(2);
+  EXPECT_CALL(*encoder_filter, encodeHeaders(_, true)).Times(2);
+  EXPECT_CALL(*filter, onDestroy()).Times(2);
+  EXPECT_CALL(*handler, log(_, _, _, _)).Times(2);
+
+  NiceMock<MockStreamEncoder> encoder;
+  EXPECT_CALL(*codec_, dispatch(_)).WillRepeatedly(Invoke([&](Buffer::Instance& data) -> void {
+    StreamDecoder* decoder = &conn_manager_->newStream(encoder);
+    HeaderMapPtr headers{
+        new TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+
+    HeaderMapPtr response_headers{new TestHeaderMapImpl{{":status", "200"}}};
+    decoder_filter->callbacks_->encodeHeaders(std::move(response_headers), true);
+    data.drain(2);
+  }));
+
+  // Run two streams, the second of which sizes its arena from the first.
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+  filter_callbacks_.connection_.dispatcher_.to_delete_.clear();
+  EXPECT_EQ(2U, stats_.named_.downstream_rq_completed_.value());
+}
+
 TEST_F(HttpConnectionManagerImplTest, TestAccessLogWithTrailers) {
   setup(false, "");
 
@@ -1716,6 +1764,38 @@ TEST_F(HttpConnectionManagerImplTest, WebSocketPrefixAndAutoHostRewrite) {
   EXPECT_EQ(0U, stats_.named_.downstream_cx_websocket_active_.value());
 }
 
+// The stream idle timer does not apply to upgraded WebSocket connections.
+TEST_F(HttpConnectionManagerImplTest, WebSocketDisablesStreamIdleTimer) {
+  stream_idle_timeout_ = std::chrono::milliseconds(10);
+  setup(false, "");
+
+  EXPECT_CALL(cluster_manager_, tcpConnPoolForCluster("fake_cluster", _, _))
+      .WillOnce(Return(&conn_pool_));
+  configureRouteForWebsocket(route_config_provider_.route_config_->route_->route_entry_);
+
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance& data) -> void {
+    Event::MockTimer* idle_timer = new Event::MockTimer(&filter_callbacks_.connection_.dispatcher_);
+    EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(10)));
+    StreamDecoder* decoder = &conn_manager_->newStream(response_encoder_);
+
+    EXPECT_CALL(*idle_timer, disableTimer());
+    HeaderMapPtr headers{new TestHeaderMapImpl{{":authority", "host"},
+                                               {":method", "GET"},
+                                               {":path", "/"},
+                                               {"connection", "Upgrade"},
+                                               {"upgrade", "websocket"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+    data.drain(4);
+  }));
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+  EXPECT_EQ(1U, stats_.named_.downstream_cx_websocket_active_.value());
+
+  filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
+  conn_manager_.reset();
+}
+
 TEST_F(HttpConnectionManagerImplTest, WebSocketEarlyData) {
   setup(false, "");
 
@@ -2136,6 +2216,43 @@ TEST_F(HttpConnectionManagerImplTest, IdleTimeout) {
   EXPECT_EQ(1U, stats_.named_.downstream_cx_idle_timeout_.value());
 }
 
+TEST_F(HttpConnectionManagerImplTest, IdleTimeoutReducedWhenOverloaded) {
+  idle_timeout_ = (std::chrono::milliseconds(10000));
+  overload_manager_.overload_state_.setScaledValue(
+      Server::OverloadActionNames::get().ReduceTimeouts, 0.5);
+  Event::MockTimer* idle_timer = new Event::MockTimer(&filter_callbacks_.connection_.dispatcher_);
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(5000)));
+  setup(false, "");
+
+  MockStreamDecoderFilter* filter = new NiceMock<MockStreamDecoderFilter>();
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.addStreamDecoderFilter(StreamDecoderFilterSharedPtr{filter});
+      }));
+
+  NiceMock<MockStreamEncoder> encoder;
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance&) -> void {
+    StreamDecoder* decoder = &conn_manager_->newStream(encoder);
+    HeaderMapPtr headers{
+        new TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+    decoder->decodeHeaders(std::move(headers), true);
+  }));
+
+  EXPECT_CALL(*idle_timer, disableTimer());
+  EXPECT_CALL(*filter, decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  // The timeout is not reduced below a second.
+  overload_manager_.overload_state_.setScaledValue(
+      Server::OverloadActionNames::get().ReduceTimeouts, 1);
+  EXPECT_CALL(*idle_timer, enableTimer(std::chrono::milliseconds(1000)));
+  HeaderMapPtr response_headers{new TestHeaderMapImpl{{":status", "200"}}};
+  filter->callbacks_->encodeHeaders(std::move(response_headers), true);
+}
+
 TEST_F(HttpConnectionManagerImplTest, IntermediateBufferingEarlyResponse) {
   InSequence s;
   setup(false, "");
@@ -2220,6 +2337,114 @@ TEST_F(HttpConnectionManagerImplTest, DoubleBuffering) {
   decoder_filters_[1]->callbacks_->continueDecoding();
 }
 
+// A stream's filter lists are reserved to the size of the previous chain on the connection, so a
+// longer chain grows them while its filters are added. Stopped iteration must still resume at the
+// filter after the one continuing it.
+TEST_F(HttpConnectionManagerImplTest, FilterChainLongerThanPreviousChain) {
+  InSequence s;
+  setup(false, "");
+
+  std::shared_ptr<MockStreamDecoderFilter> first_filter(new NiceMock<MockStreamDecoderFilter>());
+  std::vector<std::shared_ptr<MockStreamDecoderFilter>> decoder_filters;
+  std::vector<std::shared_ptr<MockStreamEncoderFilter>> encoder_filters;
+  for (int i = 0; i < 3; i++) {
+    decoder_filters.emplace_back(new NiceMock<MockStreamDecoderFilter>());
+    encoder_filters.emplace_back(new NiceMock<MockStreamEncoderFilter>());
+  }
+
+  NiceMock<MockStreamEncoder> encoder;
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance& data) -> void {
+    for (int i = 0; i < 2; i++) {
+      StreamDecoder* decoder = &conn_manager_->newStream(encoder);
+      HeaderMapPtr headers{
+          new TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}}};
+      decoder->decodeHeaders(std::move(headers), true);
+    }
+    data.drain(4);
+  }));
+
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.addStreamDecoderFilter(first_filter);
+      }));
+  EXPECT_CALL(*first_filter, decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        for (int i = 0; i < 3; i++) {
+          callbacks.addStreamDecoderFilter(decoder_filters[i]);
+          callbacks.addStreamEncoderFilter(encoder_filters[i]);
+        }
+      }));
+  EXPECT_CALL(*decoder_filters[0], decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+
+  EXPECT_CALL(*decoder_filters[1], decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::Continue));
+  EXPECT_CALL(*decoder_filters[2], decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  decoder_filters[0]->callbacks_->continueDecoding();
+
+  EXPECT_CALL(*encoder_filters[0], encodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::Continue));
+  EXPECT_CALL(*encoder_filters[1], encodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  HeaderMapPtr response_headers{new TestHeaderMapImpl{{":status", "200"}}};
+  decoder_filters[2]->callbacks_->encodeHeaders(std::move(response_headers), true);
+
+  EXPECT_CALL(*encoder_filters[2], encodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::Continue));
+  EXPECT_CALL(encoder, encodeHeaders(_, true));
+  encoder_filters[1]->callbacks_->continueEncoding();
+}
+
+// An accepted upgrade only installs the upgrade filter chain, and the next stream on the connection
+// still gets the default chain.
+TEST_F(HttpConnectionManagerImplTest, UpgradeFilterChainReplacesDefaultChain) {
+  InSequence s;
+  setup(false, "envoy-custom-server", false);
+
+  std::shared_ptr<MockStreamFilter> upgrade_filter(new NiceMock<MockStreamFilter>());
+  std::shared_ptr<MockStreamDecoderFilter> decoder_filter(new NiceMock<MockStreamDecoderFilter>());
+
+  NiceMock<MockStreamEncoder> encoder;
+  EXPECT_CALL(*codec_, dispatch(_)).WillOnce(Invoke([&](Buffer::Instance& data) -> void {
+    StreamDecoder* decoder = &conn_manager_->newStream(encoder);
+    HeaderMapPtr headers{new TestHeaderMapImpl{{":authority", "host"},
+                                               {":method", "GET"},
+                                               {":path", "/"},
+                                               {"connection", "Upgrade"},
+                                               {"upgrade", "foo"}}};
+    decoder->decodeHeaders(std::move(headers), false);
+
+    decoder = &conn_manager_->newStream(encoder);
+    headers.reset(
+        new TestHeaderMapImpl{{":authority", "host"}, {":path", "/"}, {":method", "GET"}});
+    decoder->decodeHeaders(std::move(headers), true);
+    data.drain(4);
+  }));
+
+  EXPECT_CALL(filter_factory_, createUpgradeFilterChain("foo", _))
+      .WillOnce(Invoke([&](absl::string_view, FilterChainFactoryCallbacks& callbacks) -> bool {
+        callbacks.addStreamFilter(upgrade_filter);
+        return true;
+      }));
+  EXPECT_CALL(*upgrade_filter, decodeHeaders(_, false))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainFactoryCallbacks& callbacks) -> void {
+        callbacks.addStreamDecoderFilter(decoder_filter);
+      }));
+  EXPECT_CALL(*decoder_filter, decodeHeaders(_, true))
+      .WillOnce(Return(FilterHeadersStatus::StopIteration));
+
+  Buffer::OwnedImpl fake_input("1234");
+  conn_manager_->onData(fake_input, false);
+}
+
 TEST_F(HttpConnectionManagerImplTest, ZeroByteDataFiltering) {
   InSequence s;
   setup(false, "");
@@ -2965,6 +3190,27 @@ TEST_F(HttpConnectionManagerImplTest, HitFilterWatermarkLimits) {
   encoder_filters_[0]->callbacks_->setEncoderBufferLimit((buffer_len + 1) * 2);
 }
 
+TEST_F(HttpConnectionManagerImplTest, BufferedDataChargedToStreamAccount) {
+  initial_buffer_limit_ = 10;
+  streaming_filter_ = false;
+  setup(false, "");
+  setUpEncoderAndDecoder();
+  sendReqestHeadersAndData();
+
+  // The request data buffered for the filter is charged to the stream.
+  std::vector<Buffer::MemoryConsumer> consumers =
+      Buffer::MemoryAccountRegistrySingleton::get().largest(1);
+  ASSERT_EQ(1, consumers.size());
+  EXPECT_EQ(5, consumers[0].bytes_);
+  EXPECT_THAT(consumers[0].description_, HasSubstr("stream"));
+
+  // Resetting the stream releases the account.
+  EXPECT_CALL(stream_, resetStream(StreamResetReason::LocalReset));
+  expectOnDestroy();
+  EXPECT_EQ(1, Buffer::MemoryAccountRegistrySingleton::get().resetLargest(1));
+  EXPECT_EQ(0, Buffer::MemoryAccountRegistrySingleton::get().largest(1).size());
+}
+
 TEST_F(HttpConnectionManagerImplTest, HitRequestBufferLimits) {
   initial_buffer_limit_ = 10;
   streaming_filter_ = false;
@@ -150,6 +150,41 @@ TEST_F(ConnectionManagerUtilityTest, SkipXffAppendPassThruUseRemoteAddress) {
   EXPECT_STREQ("198.51.100.1", headers.ForwardedFor()->value().c_str());
 }
 
+// Verify that a policy resolved once applies to the requests of the connection without consulting
+// the config or the connection's address again.
+TEST_F(ConnectionManagerUtilityTest, ResolvedPolicyAppliesToSeveralRequests) {
+  connection_.remote_address_ = std::make_shared<Network::Address::Ipv4Instance>("10.0.0.1");
+  ON_CALL(config_, useRemoteAddress()).WillByDefault(Return(true));
+  user_agent_ = "bar";
+  via_ = "1.1 envoy";
+  EXPECT_CALL(local_info_, nodeName()).WillOnce(Return(canary_node_));
+  const RequestMutationPolicy policy(config_, connection_, local_info_);
+  EXPECT_TRUE(policy.remote_address_internal_);
+  EXPECT_EQ(connection_.remote_address_.get(), policy.xff_address_);
+
+  EXPECT_CALL(config_, useRemoteAddress()).Times(0);
+  EXPECT_CALL(config_, xffNumTrustedHops()).Times(0);
+  EXPECT_CALL(config_, skipXffAppend()).Times(0);
+  EXPECT_CALL(config_, userAgent()).Times(0);
+  EXPECT_CALL(config_, via()).Times(0);
+  EXPECT_CALL(config_, generateRequestId()).Times(0);
+  EXPECT_CALL(connection_, remoteAddress()).Times(2);
+  for (int i = 0; i < 2; i++) {
+    TestHeaderMapImpl headers{{"x-request-id", "id"}};
+    EXPECT_EQ("10.0.0.1:0",
+              ConnectionManagerUtility::mutateRequestHeaders(headers, connection_, config_, policy,
+                                                             route_config_, random_, runtime_)
+                  ->asString());
+    EXPECT_EQ("true", headers.get_(Headers::get().EnvoyInternalRequest));
+    EXPECT_EQ("10.0.0.1", headers.get_(Headers::get().ForwardedFor));
+    EXPECT_EQ("http", headers.get_(Headers::get().ForwardedProto));
+    EXPECT_EQ("bar", headers.get_(Headers::get().EnvoyDownstreamServiceCluster));
+    EXPECT_EQ("canary", headers.get_(Headers::get().EnvoyDownstreamServiceNode));
+    EXPECT_EQ("1.1 envoy", headers.get_(Headers::get().Via));
+    EXPECT_EQ("id", headers.get_(Headers::get().RequestId));
+  }
+}
+
 // Verify internal request and XFF is set when we are using remote address the address is internal.
 TEST_F(ConnectionManagerUtilityTest, UseRemoteAddressWhenLocalHostRemoteAddress) {
   connection_.remote_address_ = std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1");
@@ -34,5 +34,34 @@ TEST(DateProviderImplTest, All) {
   EXPECT_NE(nullptr, headers.Date());
 }
 
+// Response header blocks are shared until the next refresh, and headers reference their Date.
+TEST(DateProviderImplTest, ResponseHeaderBlock) {
+  Event::MockDispatcher dispatcher;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  Event::MockTimer* timer = new Event::MockTimer(&dispatcher);
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(500))).Times(2);
+
+  TlsCachingDateProviderImpl provider(dispatcher, tls);
+  ResponseHeaderBlockConstSharedPtr block = provider.responseHeaderBlock();
+  EXPECT_EQ(block, provider.responseHeaderBlock());
+
+  HeaderMapImpl headers;
+  DateProvider::referenceDateHeader(headers, *block);
+  EXPECT_EQ(HeaderString::Type::Pinned, headers.Date()->value().type());
+  EXPECT_EQ(block->date_.c_str(), headers.Date()->value().c_str());
+
+  // The block outlives the refresh for as long as it is held.
+  timer->callback_();
+  EXPECT_NE(block, provider.responseHeaderBlock());
+  EXPECT_EQ(block->date_, headers.Date()->value().getStringView());
+}
+
+TEST(DateProviderImplTest, SlowResponseHeaderBlock) {
+  SlowDateProviderImpl provider;
+  HeaderMapImpl headers;
+  provider.setDateHeader(headers);
+  EXPECT_EQ(headers.Date()->value().size(), provider.responseHeaderBlock()->date_.size());
+}
+
 } // namespace Http
 } // namespace Envoy
@@ -0,0 +1,160 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/http/header_map_impl.h"
+
+#include "test/test_common/allocation_counter.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+
+// The headers of a typical browser request, followed by range(0) custom headers.
+static std::vector<std::pair<std::string, std::string>> requestHeaders(benchmark::State& state) {
+  std::vector<std::pair<std::string, std::string>> headers{
+      {":method", "GET"},
+      {":path", "/api/v1/users/1234/profile?fields=name,email"},
+      {":authority", "www.example.com"},
+      {":scheme", "https"},
+      {"user-agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+                     "Chrome/68.0.3440.106 Safari/537.36"},
+      {"accept", "text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,*/*;q=0.8"},
+      {"accept-encoding", "gzip, deflate, br"},
+      {"accept-language", "en-US,en;q=0.9"},
+      {"cookie", "session=8a3f0e5c6c1e4f4b9f3a1c2d3e4f5a6b"},
+      {"x-request-id", "8a3f0e5c-6c1e-4f4b-9f3a-1c2d3e4f5a6b"}};
+  for (int64_t i = 0; i < state.range(0); i++) {
+    headers.emplace_back("x-custom-header-" + std::to_string(i), "custom value");
+  }
+  return headers;
+}
+
+// Moves copies of the headers into a map, as the codecs do.
+static void addHeaders(HeaderMapImpl& map,
+                       const std::vector<std::pair<std::string, std::string>>& headers) {
+  for (const auto& header : headers) {
+    HeaderString key;
+    key.setCopy(header.first.data(), header.first.size());
+    HeaderString value;
+    value.setCopy(header.second.data(), header.second.size());
+    map.addViaMove(std::move(key), std::move(value));
+  }
+}
+
+static void reportAllocations(benchmark::State& state, const AllocationCounter& counter) {
+  state.counters["allocs_per_iter"] =
+      static_cast<double>(counter.allocations()) / state.iterations();
+}
+
+// Build and destroy the map of a decoded request.
+static void BM_HeaderMapDecode(benchmark::State& state) {
+  const auto headers = requestHeaders(state);
+  AllocationCounter counter;
+  for (auto _ : state) {
+    HeaderMapImpl map;
+    addHeaders(map, headers);
+    benchmark::DoNotOptimize(map.size());
+  }
+  reportAllocations(state, counter);
+}
+BENCHMARK(BM_HeaderMapDecode)->Arg(0)->Arg(20);
+
+// Copy a request map, as the router does for retries and shadowing.
+static void BM_HeaderMapCopy(benchmark::State& state) {
+  HeaderMapImpl source;
+  addHeaders(source, requestHeaders(state));
+  AllocationCounter counter;
+  for (auto _ : state) {
+    HeaderMapImpl map(source);
+    benchmark::DoNotOptimize(map.size());
+  }
+  reportAllocations(state, counter);
+}
+BENCHMARK(BM_HeaderMapCopy)->Arg(0)->Arg(20);
+
+// Look up an inline header, a custom header at the end of the map and a missing header.
+static void BM_HeaderMapLookup(benchmark::State& state) {
+  HeaderMapImpl map;
+  addHeaders(map, requestHeaders(state));
+  const LowerCaseString last("x-request-id");
+  const LowerCaseString missing("x-missing");
+  size_t found = 0;
+  for (auto _ : state) {
+    found += map.Host() != nullptr;
+    found += map.get(last) != nullptr;
+    found += map.get(missing) != nullptr;
+  }
+  benchmark::DoNotOptimize(found);
+}
+BENCHMARK(BM_HeaderMapLookup)->Arg(0)->Arg(20);
+
+// Check whether header names are inline headers, as every insertion of a decoded header does: an
+// inline header, a custom header of the same length and a name sharing an inline header's slot.
+static void BM_HeaderMapStaticLookup(benchmark::State& state) {
+  HeaderMapImpl map;
+  addHeaders(map, requestHeaders(state));
+  const LowerCaseString names[] = {LowerCaseString("access-control-allow-headers"),
+                                   LowerCaseString("x-custom-request-header-name"),
+                                   LowerCaseString("access-control-allow-hxaders")};
+  size_t supported = 0;
+  for (auto _ : state) {
+    for (const LowerCaseString& name : names) {
+      const HeaderEntry* entry;
+      supported += map.lookup(name, &entry) != HeaderMap::Lookup::NotSupported;
+    }
+  }
+  benchmark::DoNotOptimize(supported);
+}
+BENCHMARK(BM_HeaderMapStaticLookup)->Arg(0)->Arg(20);
+
+// Add and remove a custom header and an inline header, as filters mutating requests do.
+static void BM_HeaderMapAddRemove(benchmark::State& state) {
+  HeaderMapImpl map;
+  addHeaders(map, requestHeaders(state));
+  const LowerCaseString key("x-forwarded-client-cert");
+  const std::string value("By=spiffe://cluster.local/ns/default/sa/frontend");
+  AllocationCounter counter;
+  for (auto _ : state) {
+    map.addReference(key, value);
+    map.insertEnvoyUpstreamRequestTimeoutMs().value(uint64_t(15000));
+    map.remove(key);
+    map.removeEnvoyUpstreamRequestTimeoutMs();
+  }
+  benchmark::DoNotOptimize(map.size());
+  reportAllocations(state, counter);
+}
+BENCHMARK(BM_HeaderMapAddRemove)->Arg(0)->Arg(20);
+
+// Visit every header, as the codecs do when encoding.
+static void BM_HeaderMapIterate(benchmark::State& state) {
+  HeaderMapImpl map;
+  addHeaders(map, requestHeaders(state));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    map.iterate(
+        [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+          *static_cast<size_t*>(context) += header.key().size() + header.value().size();
+          return HeaderMap::Iterate::Continue;
+        },
+        &bytes);
+  }
+  benchmark::DoNotOptimize(bytes);
+}
+BENCHMARK(BM_HeaderMapIterate)->Arg(0)->Arg(20);
+
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -261,6 +261,25 @@ TEST(HeaderStringTest, All) {
     EXPECT_EQ(HeaderString::Type::Reference, string.type());
   }
 
+  // Set pinned, switch to inline on mutation.
+  {
+    const std::string pinned_string("hello\0world", 11);
+    HeaderString string;
+    string.setPinned(pinned_string.c_str(), 5);
+    EXPECT_EQ(string.c_str(), pinned_string.c_str());
+    EXPECT_EQ(5U, string.size());
+    EXPECT_EQ(HeaderString::Type::Pinned, string.type());
+
+    HeaderString moved(std::move(string));
+    EXPECT_EQ(moved.c_str(), pinned_string.c_str());
+    EXPECT_EQ(HeaderString::Type::Pinned, moved.type());
+
+    moved.append("!", 1);
+    EXPECT_EQ("hello!", moved.getStringView());
+    EXPECT_EQ(HeaderString::Type::Dynamic, moved.type());
+    EXPECT_EQ(std::string("hello\0world", 11), pinned_string);
+  }
+
   // getString
   {
     std::string static_string("HELLO");
@@ -649,6 +668,31 @@ TEST(HeaderMapImplTest, Lookup) {
     EXPECT_EQ(HeaderMap::Lookup::NotFound, headers.lookup(Headers::get().Host, &entry));
     EXPECT_EQ(nullptr, entry);
   }
+
+  // Names hashing to the slot of a predefined inline header are not mistaken for it.
+  {
+    const HeaderEntry* entry;
+    EXPECT_EQ(HeaderMap::Lookup::NotSupported,
+              headers.lookup(LowerCaseString{"access-control-allow-hxaders"}, &entry));
+    EXPECT_EQ(HeaderMap::Lookup::NotSupported, headers.lookup(LowerCaseString{"c"}, &entry));
+    EXPECT_EQ(HeaderMap::Lookup::NotSupported, headers.lookup(LowerCaseString{""}, &entry));
+  }
+}
+
+// Every predefined inline header, and the legacy host header, is found by its name.
+TEST(HeaderMapImplTest, InlineHeadersByName) {
+#define INLINE_HEADER_BY_NAME(name)                                                                \
+  {                                                                                                \
+    HeaderMapImpl headers;                                                                         \
+    headers.addCopy(Headers::get().name, "value");                                                 \
+    EXPECT_NE(nullptr, headers.name()) << Headers::get().name.get();                               \
+  }
+  ALL_INLINE_HEADERS(INLINE_HEADER_BY_NAME)
+#undef INLINE_HEADER_BY_NAME
+
+  HeaderMapImpl headers;
+  headers.addCopy(Headers::get().HostLegacy, "value");
+  EXPECT_STREQ("value", headers.Host()->value().c_str());
 }
 
 TEST(HeaderMapImplTest, Get) {
@@ -902,6 +946,62 @@ TEST(HeaderMapImplTest, PseudoHeaderOrder) {
   }
 }
 
+// Validate that entries keep their address and the map keeps its order while the backing storage
+// grows and removed entries are recycled.
+TEST(HeaderMapImplTest, ManyHeaders) {
+  HeaderMapImpl headers;
+  const HeaderEntry& content_type = headers.insertContentType();
+  headers.insertContentType().value(std::string("text/html"));
+
+  std::vector<LowerCaseString> keys;
+  for (int i = 0; i < 200; i++) {
+    keys.emplace_back("key-" + std::to_string(i));
+  }
+  for (int i = 0; i < 200; i++) {
+    headers.addReferenceKey(keys[i], i);
+  }
+  const HeaderEntry* last = headers.get(keys[199]);
+  headers.insertMethod().value(std::string("GET"));
+  EXPECT_EQ(202UL, headers.size());
+  EXPECT_EQ(&content_type, headers.ContentType());
+  EXPECT_STREQ("text/html", content_type.value().c_str());
+
+  // Remove every other header and then add them back, which reuses the freed storage.
+  for (int i = 0; i < 200; i += 2) {
+    headers.remove(keys[i]);
+  }
+  EXPECT_EQ(102UL, headers.size());
+  for (int i = 0; i < 200; i += 2) {
+    headers.addReferenceKey(keys[i], i);
+  }
+  EXPECT_EQ(202UL, headers.size());
+  EXPECT_EQ(last, headers.get(keys[199]));
+  EXPECT_STREQ("199", last->value().c_str());
+
+  std::vector<std::string> expected{":method", "content-type"};
+  for (int i = 1; i < 200; i += 2) {
+    expected.push_back(keys[i].get());
+  }
+  for (int i = 0; i < 200; i += 2) {
+    expected.push_back(keys[i].get());
+  }
+  std::vector<std::string> actual;
+  headers.iterate(
+      [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+        static_cast<std::vector<std::string>*>(context)->push_back(header.key().c_str());
+        return HeaderMap::Iterate::Continue;
+      },
+      &actual);
+  EXPECT_EQ(expected, actual);
+
+  headers.removePrefix(LowerCaseString("key-"));
+  EXPECT_EQ(2UL, headers.size());
+  EXPECT_STREQ("GET", headers.Method()->value().c_str());
+  headers.removeMethod();
+  EXPECT_EQ(nullptr, headers.Method());
+  EXPECT_EQ(1UL, headers.size());
+}
+
 // Validate that TestHeaderMapImpl copy construction and assignment works. This is a
 // regression for where we were missing a valid copy constructor and had the
 // default (dangerous) move semantics takeover.
@@ -20,6 +20,15 @@ envoy::api::v2::route::HeaderMatcher parseHeaderMatcherFromYaml(const std::strin
   return header_matcher;
 }
 
+Protobuf::RepeatedPtrField<envoy::api::v2::route::HeaderMatcher>
+parseHeaderMatchersFromYaml(const std::vector<std::string>& yamls) {
+  Protobuf::RepeatedPtrField<envoy::api::v2::route::HeaderMatcher> header_matchers;
+  for (const std::string& yaml : yamls) {
+    *header_matchers.Add() = parseHeaderMatcherFromYaml(yaml);
+  }
+  return header_matchers;
+}
+
 TEST(HeaderDataConstructorTest, JsonConstructor) {
   Json::ObjectSharedPtr json =
       Json::Factory::loadFromString("{\"name\":\"test-header\", \"value\":\"value\"}");
@@ -31,6 +40,20 @@ TEST(HeaderDataConstructorTest, JsonConstructor) {
   EXPECT_EQ("value", header_data.value_);
 }
 
+TEST(HeaderDataConstructorTest, InlineHeaderGetter) {
+  const HeaderUtility::HeaderData path_data(parseHeaderMatcherFromYaml("name: \":path\""));
+  EXPECT_NE(nullptr, path_data.inline_getter_);
+  TestHeaderMapImpl headers{{":path", "/"}};
+  EXPECT_EQ(headers.Path(), (headers.*path_data.inline_getter_)());
+
+  const HeaderUtility::HeaderData other_data(parseHeaderMatcherFromYaml("name: test-header"));
+  EXPECT_EQ(nullptr, other_data.inline_getter_);
+
+  // The legacy host header is not an inline header key, as the map stores it as :authority.
+  const HeaderUtility::HeaderData host_data(parseHeaderMatcherFromYaml("name: host"));
+  EXPECT_EQ(nullptr, host_data.inline_getter_);
+}
+
 TEST(HeaderDataConstructorTest, NoSpecifierSet) {
   const std::string yaml = R"EOF(
 name: test-header
@@ -403,6 +426,102 @@ invert_match: true
   EXPECT_FALSE(HeaderUtility::matchHeaders(unmatching_headers, header_data));
 }
 
+TEST(HeaderMatcherSetTest, Empty) {
+  const HeaderUtility::HeaderMatcherSet matcher_set(parseHeaderMatchersFromYaml({}));
+  EXPECT_TRUE(matcher_set.matches(TestHeaderMapImpl{}));
+  EXPECT_TRUE(matcher_set.matches(TestHeaderMapImpl{{"some-header", "a"}}));
+}
+
+TEST(HeaderMatcherSetTest, InlineHeaders) {
+  const HeaderUtility::HeaderMatcherSet matcher_set(parseHeaderMatchersFromYaml({
+      "{name: \":method\", exact_match: GET}",
+      "{name: \":path\", prefix_match: /api}",
+      "{name: content-type, present_match: true, invert_match: true}",
+  }));
+  EXPECT_TRUE(matcher_set.matches(TestHeaderMapImpl{{":method", "GET"}, {":path", "/api/v1"}}));
+  EXPECT_FALSE(matcher_set.matches(TestHeaderMapImpl{{":method", "PUT"}, {":path", "/api/v1"}}));
+  EXPECT_FALSE(matcher_set.matches(TestHeaderMapImpl{{":method", "GET"}, {":path", "/other"}}));
+  EXPECT_FALSE(matcher_set.matches(TestHeaderMapImpl{{":path", "/api/v1"}}));
+  EXPECT_FALSE(matcher_set.matches(TestHeaderMapImpl{
+      {":method", "GET"}, {":path", "/api/v1"}, {"content-type", "text/plain"}}));
+}
+
+TEST(HeaderMatcherSetTest, SingleHeader) {
+  const HeaderUtility::HeaderMatcherSet matcher_set(parseHeaderMatchersFromYaml({
+      "{name: match-header, prefix_match: a}",
+      "{name: match-header, suffix_match: c}",
+  }));
+  EXPECT_TRUE(matcher_set.matches(TestHeaderMapImpl{{"match-header", "abc"}}));
+  EXPECT_FALSE(matcher_set.matches(TestHeaderMapImpl{{"match-header", "abd"}}));
+  EXPECT_FALSE(matcher_set.matches(TestHeaderMapImpl{{"other-header", "abc"}}));
+}
+
+// The conditions on several headers are resolved in a single pass, and are equivalent to matching
+// each condition by itself.
+TEST(HeaderMatcherSetTest, MultipleHeaders) {
+  const auto header_matchers = parseHeaderMatchersFromYaml({
+      "{name: header-a, exact_match: a}",
+      "{name: header-b, range_match: {start: 1, end: 10}}",
+      "{name: header-b, regex_match: \"[0-9]\"}",
+      "{name: header-c, present_match: true, invert_match: true}",
+      "{name: header-d, suffix_match: d, invert_match: true}",
+      "{name: \":path\", exact_match: /}",
+  });
+  const HeaderUtility::HeaderMatcherSet matcher_set(header_matchers);
+  const std::vector<HeaderUtility::HeaderData> header_data(header_matchers.begin(),
+                                                           header_matchers.end());
+  auto matches = [&](const TestHeaderMapImpl& headers) -> bool {
+    const bool match = matcher_set.matches(headers);
+    EXPECT_EQ(HeaderUtility::matchHeaders(headers, header_data), match);
+    return match;
+  };
+
+  EXPECT_TRUE(matches({{":path", "/"}, {"header-a", "a"}, {"header-b", "5"}}));
+  EXPECT_TRUE(matches({{":path", "/"}, {"header-b", "5"}, {"header-a", "a"}, {"header-d", "e"}}));
+  EXPECT_FALSE(matches({{":path", "/"}, {"header-a", "a"}, {"header-b", "15"}}));
+  EXPECT_FALSE(matches({{":path", "/"}, {"header-a", "a"}, {"header-b", "5"}, {"header-c", "c"}}));
+  EXPECT_FALSE(matches({{":path", "/"}, {"header-a", "a"}, {"header-b", "5"}, {"header-d", "d"}}));
+  EXPECT_FALSE(matches({{":path", "/"}, {"header-a", "a"}}));
+  EXPECT_FALSE(matches({{":path", "/"}, {"header-b", "5"}}));
+  EXPECT_FALSE(matches({{":path", "/other"}, {"header-a", "a"}, {"header-b", "5"}}));
+
+  // Only the first header with a key is matched.
+  EXPECT_FALSE(matches({{":path", "/"}, {"header-a", "b"}, {"header-a", "a"}, {"header-b", "5"}}));
+  EXPECT_TRUE(matches({{":path", "/"}, {"header-a", "a"}, {"header-b", "5"}, {"header-b", "50"}}));
+}
+
+// Sets referencing more headers than a pass tracks look the headers up one by one.
+TEST(HeaderMatcherSetTest, ManyHeaders) {
+  std::vector<std::string> yamls;
+  TestHeaderMapImpl headers;
+  for (int i = 0; i < 100; i++) {
+    const std::string index = std::to_string(i);
+    yamls.push_back("{name: header-" + index + ", exact_match: \"" + index + "\"}");
+    headers.addCopy("header-" + index, index);
+  }
+  const HeaderUtility::HeaderMatcherSet matcher_set(parseHeaderMatchersFromYaml(yamls));
+  EXPECT_TRUE(matcher_set.matches(headers));
+  headers.remove("header-99");
+  EXPECT_FALSE(matcher_set.matches(headers));
+}
+
+// A pass tracks up to 64 headers.
+TEST(HeaderMatcherSetTest, MaxHeadersPerPass) {
+  std::vector<std::string> yamls;
+  TestHeaderMapImpl headers;
+  for (int i = 0; i < 64; i++) {
+    const std::string index = std::to_string(i);
+    yamls.push_back("{name: header-" + index + ", exact_match: \"" + index + "\"}");
+    headers.addCopy("header-" + index, index);
+  }
+  const HeaderUtility::HeaderMatcherSet matcher_set(parseHeaderMatchersFromYaml(yamls));
+  EXPECT_TRUE(matcher_set.matches(headers));
+  headers.remove("header-63");
+  EXPECT_FALSE(matcher_set.matches(headers));
+  headers.addCopy("header-63", "0");
+  EXPECT_FALSE(matcher_set.matches(headers));
+}
+
 TEST(HeaderAddTest, HeaderAdd) {
   TestHeaderMapImpl headers{{"myheader1", "123value"}};
   TestHeaderMapImpl headers_to_add{{"myheader2", "456value"}};
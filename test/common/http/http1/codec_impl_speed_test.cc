@@ -0,0 +1,140 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http1/codec_impl.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/allocation_counter.h"
+#include "test/test_common/utility.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+// Keeps the decoded headers alive until the next message, as a filter chain would.
+class BenchmarkCallbacks : public ServerConnectionCallbacks, public StreamDecoder {
+public:
+  // Http::ServerConnectionCallbacks
+  StreamDecoder& newStream(StreamEncoder& response_encoder) override {
+    encoder_ = &response_encoder;
+    return *this;
+  }
+  void onGoAway() override {}
+
+  // Http::StreamDecoder
+  void decode100ContinueHeaders(HeaderMapPtr&&) override {}
+  void decodeHeaders(HeaderMapPtr&& headers, bool) override { headers_ = std::move(headers); }
+  void decodeData(Buffer::Instance& data, bool) override { body_bytes_ += data.length(); }
+  void decodeTrailers(HeaderMapPtr&&) override {}
+
+  StreamEncoder* encoder_{};
+  HeaderMapPtr headers_;
+  uint64_t body_bytes_{};
+};
+
+// A typical browser request, with cookie_size bytes of cookies.
+static std::string makeRequest(uint64_t cookie_size) {
+  return "GET /api/v1/users/1234/profile?fields=name,email HTTP/1.1\r\n"
+         "Host: www.example.com\r\n"
+         "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+         "Chrome/68.0.3440.106 Safari/537.36\r\n"
+         "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,*/*;q=0.8\r\n"
+         "Accept-Encoding: gzip, deflate, br\r\n"
+         "Accept-Language: en-US,en;q=0.9\r\n"
+         "Cookie: session=" +
+         std::string(cookie_size, 'c') +
+         "\r\n"
+         "X-Request-Id: 8a3f0e5c-6c1e-4f4b-9f3a-1c2d3e4f5a6b\r\n"
+         "\r\n";
+}
+
+static void reportAllocations(benchmark::State& state, const AllocationCounter& counter) {
+  state.counters["allocs_per_iter"] =
+      static_cast<double>(counter.allocations()) / state.iterations();
+}
+
+// Decode a request and encode its response on a server connection. range(0) selects the parser:
+// 0 for http_parser, 1 for the vectorized one. range(1) is the size of the request cookie.
+static void BM_Http1ServerRequest(benchmark::State& state) {
+  testing::NiceMock<Network::MockConnection> connection;
+  BenchmarkCallbacks callbacks;
+  Http1Settings settings;
+  settings.use_vectorized_parser_ = state.range(0) != 0;
+  ServerConnectionImpl codec(connection, callbacks, settings);
+  const std::string request = makeRequest(state.range(1));
+  const TestHeaderMapImpl response_headers{{":status", "200"},
+                                           {"content-type", "application/json"},
+                                           {"content-length", "128"},
+                                           {"date", "Mon, 15 Oct 2018 10:00:00 GMT"},
+                                           {"server", "envoy"},
+                                           {"x-envoy-upstream-service-time", "3"}};
+  const std::string response_body(128, 'a');
+
+  AllocationCounter counter;
+  for (auto _ : state) {
+    Buffer::OwnedImpl input(request);
+    codec.dispatch(input);
+    callbacks.encoder_->encodeHeaders(response_headers, false);
+    Buffer::OwnedImpl body(response_body);
+    callbacks.encoder_->encodeData(body, true);
+  }
+  reportAllocations(state, counter);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * request.size());
+}
+BENCHMARK(BM_Http1ServerRequest)->Args({0, 32})->Args({1, 32})->Args({0, 4000})->Args({1, 4000});
+
+// Encode a request and decode its response on a client connection. range(0) is the size of the
+// response body.
+static void BM_Http1ClientRequest(benchmark::State& state) {
+  testing::NiceMock<Network::MockConnection> connection;
+  BenchmarkCallbacks callbacks;
+  ClientConnectionImpl codec(connection, callbacks);
+  const TestHeaderMapImpl request_headers{
+      {":method", "GET"},
+      {":path", "/api/v1/users/1234/profile?fields=name,email"},
+      {":authority", "www.example.com"},
+      {"user-agent", "Mozilla/5.0 (X11; Linux x86_64)"},
+      {"accept-encoding", "gzip, deflate, br"},
+      {"x-request-id", "8a3f0e5c-6c1e-4f4b-9f3a-1c2d3e4f5a6b"},
+      {"x-forwarded-proto", "https"},
+      {"x-envoy-expected-rq-timeout-ms", "15000"}};
+  const std::string response = "HTTP/1.1 200 OK\r\n"
+                               "Content-Type: application/json\r\n"
+                               "Content-Length: " +
+                               std::to_string(state.range(0)) +
+                               "\r\n"
+                               "Date: Mon, 15 Oct 2018 10:00:00 GMT\r\n"
+                               "Server: upstream\r\n"
+                               "\r\n" +
+                               std::string(state.range(0), 'a');
+
+  AllocationCounter counter;
+  for (auto _ : state) {
+    StreamEncoder& encoder = codec.newStream(callbacks);
+    encoder.encodeHeaders(request_headers, true);
+    Buffer::OwnedImpl input(response);
+    codec.dispatch(input);
+  }
+  reportAllocations(state, counter);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * response.size());
+}
+BENCHMARK(BM_Http1ClientRequest)->Arg(0)->Arg(16384);
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
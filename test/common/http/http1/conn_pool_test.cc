@@ -11,6 +11,7 @@
 #include "test/common/http/common.h"
 #include "test/common/upstream/utility.h"
 #include "test/mocks/buffer/mocks.h"
+#include "test/mocks/common.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/network/mocks.h"
@@ -30,6 +31,7 @@ using testing::Invoke;
 using testing::NiceMock;
 using testing::Property;
 using testing::Return;
+using testing::ReturnPointee;
 using testing::ReturnRef;
 using testing::SaveArg;
 
@@ -289,6 +291,44 @@ TEST_F(Http1ConnPoolImplTest, MultipleRequestAndResponse) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that connections are prefetched up to the prefetch ratio and the connection limit.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchConnections) {
+  cluster_->prefetch_ratio_ = 1.5;
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 2, 1024, 1024, 1));
+
+  // The first request creates a connection for itself, and a second one is prefetched.
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::Pending);
+  EXPECT_EQ(2U, conn_pool_.test_clients_.size());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(*conn_pool_.test_clients_[0].connect_timer_, disableTimer());
+  r1.expectNewStream();
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  r1.startRequest();
+  EXPECT_CALL(*conn_pool_.test_clients_[1].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // The second request uses the prefetched connection. Another one would be prefetched for it, but
+  // the connection limit has been reached.
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::Immediate);
+  r2.startRequest();
+  EXPECT_EQ(2U, conn_pool_.test_clients_.size());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  r1.completeResponse(false);
+  r2.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 /**
  * Test when we overflow max pending requests.
  */
@@ -317,6 +357,97 @@ TEST_F(Http1ConnPoolImplTest, MaxPendingRequests) {
   EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pending_overflow_.value());
 }
 
+/**
+ * Test that with a pending request queue, requests are served in order while the queue drains
+ * within the interval, even if they waited longer than the target delay.
+ */
+TEST_F(Http1ConnPoolImplTest, PendingRequestQueueInOrder) {
+  NiceMock<MockTimeSystem> time_system;
+  MonotonicTime now;
+  ON_CALL(time_system, monotonicTime()).WillByDefault(ReturnPointee(&now));
+  dispatcher_.setTimeSystem(time_system);
+  cluster_->pending_request_queue_ =
+      Upstream::PendingRequestQueueConfig{std::chrono::milliseconds(10),
+                                          std::chrono::milliseconds(100)};
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1024, 1024, 1));
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Pending);
+  now += std::chrono::milliseconds(20);
+  ActiveTestRequest r3(*this, 0, ActiveTestRequest::Type::Pending);
+
+  // The queue has not been non-empty for an interval yet, so the oldest request is served even
+  // though it waited longer than the target delay.
+  now += std::chrono::milliseconds(30);
+  conn_pool_.expectEnableUpstreamReady();
+  r1.completeResponse(false);
+  r2.expectNewStream();
+  conn_pool_.expectAndRunUpstreamReady();
+  r2.startRequest();
+
+  // Once the queue has not drained for an interval, the last request is past the target delay.
+  now += std::chrono::milliseconds(200);
+  conn_pool_.expectEnableUpstreamReady();
+  r2.completeResponse(false);
+  EXPECT_CALL(r3.callbacks_.pool_failure_, ready());
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pending_dropped_.value());
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that with a pending request queue, once the queue has not drained for an interval, the
+ * newest request is served first and the requests that waited longer than the target delay are
+ * dropped.
+ */
+TEST_F(Http1ConnPoolImplTest, PendingRequestQueueOverloaded) {
+  NiceMock<MockTimeSystem> time_system;
+  MonotonicTime now;
+  ON_CALL(time_system, monotonicTime()).WillByDefault(ReturnPointee(&now));
+  dispatcher_.setTimeSystem(time_system);
+  cluster_->pending_request_queue_ =
+      Upstream::PendingRequestQueueConfig{std::chrono::milliseconds(10),
+                                          std::chrono::milliseconds(100)};
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1024, 1024, 1));
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Pending);
+  now += std::chrono::milliseconds(150);
+  ActiveTestRequest r3(*this, 0, ActiveTestRequest::Type::Pending);
+  now += std::chrono::milliseconds(5);
+  ActiveTestRequest r4(*this, 0, ActiveTestRequest::Type::Pending);
+
+  // The oldest request is dropped, and the newest one is served before the other.
+  now += std::chrono::milliseconds(5);
+  conn_pool_.expectEnableUpstreamReady();
+  r1.completeResponse(false);
+  EXPECT_CALL(r2.callbacks_.pool_failure_, ready());
+  r4.expectNewStream();
+  conn_pool_.expectAndRunUpstreamReady();
+  r4.startRequest();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pending_dropped_.value());
+
+  // The queue still has not drained, and the remaining request is now past the target delay.
+  now += std::chrono::milliseconds(10);
+  conn_pool_.expectEnableUpstreamReady();
+  r4.completeResponse(false);
+  EXPECT_CALL(r3.callbacks_.pool_failure_, ready());
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(2U, cluster_->stats_.upstream_rq_pending_dropped_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_pending_active_.value());
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 /**
  * Tests a connection failure before a request is bound which should result in the pending request
  * getting purged.
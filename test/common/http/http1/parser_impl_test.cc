@@ -0,0 +1,384 @@
+#include <climits>
+#include <string>
+
+#include "common/http/http1/legacy_parser_impl.h"
+#include "common/http/http1/vectorized_parser_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+/**
+ * Records parser callbacks as a string. Consecutive fragments of the same element are coalesced,
+ * so the log does not depend on how the input was split.
+ */
+class RecordingCallbacks : public ParserCallbacks {
+public:
+  // Http1::ParserCallbacks
+  void onMessageBegin() override { event("begin"); }
+  void onUrl(const char* data, size_t length) override { fragment("url", data, length); }
+  void onHeaderField(const char* data, size_t length) override {
+    fragment("field", data, length);
+  }
+  void onHeaderValue(const char* data, size_t length) override {
+    fragment("value", data, length);
+  }
+  int onHeadersComplete() override {
+    event("headers");
+    return headers_complete_rc_;
+  }
+  void onBody(const char* data, size_t length) override { fragment("body", data, length); }
+  void onMessageComplete() override {
+    event("complete");
+    if (pause_on_message_complete_) {
+      parser_->pause();
+    }
+  }
+
+  void event(const std::string& name) {
+    log_ += name + " ";
+    last_fragment_.clear();
+  }
+
+  void fragment(const std::string& name, const char* data, size_t length) {
+    if (last_fragment_ == name) {
+      // Reopen the previous fragment.
+      log_.resize(log_.size() - 2);
+    } else {
+      log_ += name + "(";
+    }
+    log_.append(data, length);
+    log_ += ") ";
+    last_fragment_ = name;
+  }
+
+  std::string log_;
+  std::string last_fragment_;
+  int headers_complete_rc_{};
+  bool pause_on_message_complete_{};
+  Parser* parser_{};
+};
+
+enum class ParserImpl { Legacy, Vectorized };
+
+class ParserImplTest : public testing::TestWithParam<ParserImpl> {
+public:
+  void initialize(MessageType type) {
+    if (GetParam() == ParserImpl::Legacy) {
+      parser_.reset(new LegacyHttpParserImpl(type, callbacks_));
+    } else {
+      parser_.reset(new VectorizedParserImpl(type, callbacks_));
+    }
+    callbacks_.parser_ = parser_.get();
+  }
+
+  // Parse the whole input, splitting it at split_point if non-zero.
+  void parse(const std::string& input, size_t split_point = 0) {
+    if (split_point == 0) {
+      EXPECT_EQ(input.size(), parser_->execute(input.data(), input.size()));
+    } else {
+      EXPECT_EQ(split_point, parser_->execute(input.data(), split_point));
+      EXPECT_EQ(input.size() - split_point,
+                parser_->execute(input.data() + split_point, input.size() - split_point));
+    }
+    EXPECT_FALSE(parser_->hasError()) << parser_->errorName();
+  }
+
+  // Verify that the input gives the expected log however it is split.
+  void expectLog(MessageType type, const std::string& input, const std::string& expected_log) {
+    for (size_t split_point = 0; split_point < input.size(); split_point++) {
+      callbacks_.log_.clear();
+      callbacks_.last_fragment_.clear();
+      initialize(type);
+      parse(input, split_point);
+      EXPECT_EQ(expected_log, callbacks_.log_) << "split at " << split_point;
+    }
+  }
+
+  void expectError(MessageType type, const std::string& input, const std::string& error) {
+    initialize(type);
+    parser_->execute(input.data(), input.size());
+    EXPECT_TRUE(parser_->hasError()) << input;
+    EXPECT_EQ(error, parser_->errorName()) << input;
+  }
+
+  RecordingCallbacks callbacks_;
+  ParserPtr parser_;
+};
+
+INSTANTIATE_TEST_CASE_P(Parsers, ParserImplTest,
+                        testing::Values(ParserImpl::Legacy, ParserImpl::Vectorized));
+
+TEST_P(ParserImplTest, SimpleRequest) {
+  expectLog(MessageType::Request, "GET /foo?bar=baz HTTP/1.1\r\nHost: example.com\r\nx:\r\n\r\n",
+            "begin url(/foo?bar=baz) field(Host) value(example.com) field(x) value() headers "
+            "complete ");
+  EXPECT_EQ(HTTP_GET, parser_->method());
+  EXPECT_TRUE(parser_->isHttp11());
+  EXPECT_FALSE(parser_->isChunked());
+  EXPECT_EQ(ULLONG_MAX, parser_->contentLength());
+}
+
+TEST_P(ParserImplTest, Methods) {
+  initialize(MessageType::Request);
+  parse("M-SEARCH * HTTP/1.1\r\n\r\nPATCH / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n"
+        "\r\nPURGE / HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(HTTP_PURGE, parser_->method());
+  EXPECT_EQ("begin url(*) headers complete begin url(/) field(Connection) value(keep-alive) "
+            "headers complete begin url(/) headers complete ",
+            callbacks_.log_);
+}
+
+TEST_P(ParserImplTest, Http10) {
+  initialize(MessageType::Request);
+  parse("GET / HTTP/1.0\r\n\r\n");
+  EXPECT_FALSE(parser_->isHttp11());
+
+  // Without keep-alive, the connection is done after the first request.
+  const std::string next("GET / HTTP/1.1\r\n\r\n");
+  parser_->execute(next.data(), next.size());
+  EXPECT_TRUE(parser_->hasError());
+  EXPECT_STREQ("HPE_CLOSED_CONNECTION", parser_->errorName());
+}
+
+TEST_P(ParserImplTest, ContentLengthBody) {
+  expectLog(MessageType::Request,
+            "POST / HTTP/1.1\r\nContent-Length: 5\r\n\r\nhelloGET / HTTP/1.1\r\n\r\n",
+            "begin url(/) field(Content-Length) value(5) headers body(hello) complete begin url(/) "
+            "headers complete ");
+}
+
+TEST_P(ParserImplTest, ChunkedBody) {
+  expectLog(MessageType::Request,
+            "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+            "5;ext=1\r\nhello\r\nA\r\n0123456789\r\n0\r\n\r\n",
+            "begin url(/) field(Transfer-Encoding) value(chunked) headers body(hello0123456789) "
+            "complete ");
+  EXPECT_TRUE(parser_->isChunked());
+}
+
+TEST_P(ParserImplTest, PauseOnMessageComplete) {
+  initialize(MessageType::Request);
+  callbacks_.pause_on_message_complete_ = true;
+  const std::string first("GET /a HTTP/1.1\r\n\r\n");
+  const std::string input = first + "GET /b HTTP/1.1\r\n\r\n";
+  EXPECT_EQ(first.size(), parser_->execute(input.data(), input.size()));
+  EXPECT_FALSE(parser_->hasError());
+  EXPECT_STREQ("HPE_PAUSED", parser_->errorName());
+  EXPECT_EQ(0, parser_->execute(input.data() + first.size(), input.size() - first.size()));
+  EXPECT_EQ("begin url(/a) headers complete ", callbacks_.log_);
+
+  parser_->resume();
+  EXPECT_EQ(input.size() - first.size(),
+            parser_->execute(input.data() + first.size(), input.size() - first.size()));
+  EXPECT_EQ("begin url(/a) headers complete begin url(/b) headers complete ", callbacks_.log_);
+}
+
+TEST_P(ParserImplTest, SkipBody) {
+  initialize(MessageType::Response);
+  callbacks_.headers_complete_rc_ = 1;
+  parse("HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nHTTP/1.1 200 OK\r\n\r\n");
+  EXPECT_EQ("begin field(Content-Length) value(5) headers complete begin headers complete ",
+            callbacks_.log_);
+}
+
+TEST_P(ParserImplTest, Upgrade) {
+  initialize(MessageType::Request);
+  callbacks_.headers_complete_rc_ = 2;
+  const std::string headers("GET / HTTP/1.1\r\nConnection: upgrade\r\nUpgrade: foo\r\n\r\n");
+  const std::string input = headers + "websocket data";
+  EXPECT_EQ(headers.size(), parser_->execute(input.data(), input.size()));
+  EXPECT_EQ("begin url(/) field(Connection) value(upgrade) field(Upgrade) value(foo) headers "
+            "complete ",
+            callbacks_.log_);
+}
+
+TEST_P(ParserImplTest, ResponseBodyUntilEof) {
+  initialize(MessageType::Response);
+  parse("HTTP/1.1 200 OK\r\nServer: test\r\n\r\nhello");
+  EXPECT_EQ(200, parser_->statusCode());
+  EXPECT_EQ("begin field(Server) value(test) headers body(hello) ", callbacks_.log_);
+  parser_->execute(nullptr, 0);
+  EXPECT_FALSE(parser_->hasError());
+  EXPECT_EQ("begin field(Server) value(test) headers body(hello) complete ", callbacks_.log_);
+}
+
+TEST_P(ParserImplTest, ResponseWithoutBody) {
+  expectLog(MessageType::Response,
+            "HTTP/1.1 204 No Content\r\n\r\nHTTP/1.1 304 Not Modified\r\n\r\n"
+            "HTTP/1.1 100 Continue\r\n\r\n",
+            "begin headers complete begin headers complete begin headers complete ");
+  EXPECT_EQ(100, parser_->statusCode());
+}
+
+TEST_P(ParserImplTest, EofDuringMessage) {
+  initialize(MessageType::Request);
+  const std::string input("GET / HTTP/1.1\r\nHost: ");
+  parser_->execute(input.data(), input.size());
+  EXPECT_FALSE(parser_->hasError());
+  parser_->execute(nullptr, 0);
+  EXPECT_STREQ("HPE_INVALID_EOF_STATE", parser_->errorName());
+}
+
+TEST_P(ParserImplTest, HeaderOverflow) {
+  initialize(MessageType::Request);
+  const std::string request_line("GET / HTTP/1.1\r\n");
+  parser_->execute(request_line.data(), request_line.size());
+  const std::string header("foo: " + std::string(1024, 'q') + "\r\n");
+  for (int i = 0; i < 79; ++i) {
+    EXPECT_EQ(header.size(), parser_->execute(header.data(), header.size()));
+  }
+  EXPECT_FALSE(parser_->hasError());
+  parser_->execute(header.data(), header.size());
+  EXPECT_STREQ("HPE_HEADER_OVERFLOW", parser_->errorName());
+}
+
+TEST_P(ParserImplTest, Errors) {
+  expectError(MessageType::Request, "bad", "HPE_INVALID_METHOD");
+  expectError(MessageType::Request, "GETT / HTTP/1.1\r\n\r\n", "HPE_INVALID_METHOD");
+  expectError(MessageType::Request, "GET / HTTP/1.1\r\nfoo: b\x01r\r\n\r\n",
+              "HPE_INVALID_HEADER_TOKEN");
+  expectError(MessageType::Request, "POST / HTTP/1.1\r\ncontent-length: 1x\r\n\r\n",
+              "HPE_INVALID_CONTENT_LENGTH");
+  expectError(MessageType::Request,
+              "POST / HTTP/1.1\r\ncontent-length: 1\r\ncontent-length: 1\r\n\r\n",
+              "HPE_UNEXPECTED_CONTENT_LENGTH");
+  expectError(MessageType::Request,
+              "POST / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\nzz\r\n",
+              "HPE_INVALID_CHUNK_SIZE");
+  expectError(MessageType::Response, "FOO", "HPE_INVALID_CONSTANT");
+  expectError(MessageType::Response, "HTTP/1.1 abc\r\n\r\n", "HPE_INVALID_STATUS");
+}
+
+TEST_P(ParserImplTest, InvalidMethodDetectedEarly) {
+  initialize(MessageType::Request);
+  EXPECT_EQ(1, parser_->execute("G", 1));
+  EXPECT_EQ("begin ", callbacks_.log_);
+  parser_->execute("g", 1);
+  EXPECT_STREQ("HPE_INVALID_METHOD", parser_->errorName());
+}
+
+class VectorizedParserImplTest : public ParserImplTest {};
+
+INSTANTIATE_TEST_CASE_P(Vectorized, VectorizedParserImplTest,
+                        testing::Values(ParserImpl::Vectorized));
+
+// Header values long enough to exercise the SIMD scan and its scalar tail, with an invalid byte at
+// every position.
+TEST_P(VectorizedParserImplTest, LongHeaderValues) {
+  for (size_t length = 1; length < 100; length++) {
+    const std::string value(length, 'v');
+    initialize(MessageType::Request);
+    callbacks_.log_.clear();
+    parse("GET / HTTP/1.1\r\nfoo: " + value + "\r\n\r\n");
+    EXPECT_EQ("begin url(/) field(foo) value(" + value + ") headers complete ", callbacks_.log_);
+
+    for (size_t i = 0; i < length; i++) {
+      std::string bad_value = value;
+      bad_value[i] = '\x7f';
+      expectError(MessageType::Request, "GET / HTTP/1.1\r\nfoo: " + bad_value + "\r\n\r\n",
+                  "HPE_INVALID_HEADER_TOKEN");
+    }
+  }
+}
+
+TEST_P(VectorizedParserImplTest, LongHeaderNames) {
+  for (size_t length = 1; length < 70; length++) {
+    const std::string name(length, 'n');
+    initialize(MessageType::Request);
+    callbacks_.log_.clear();
+    parse("GET / HTTP/1.1\r\n" + name + "|~: v\r\n\r\n");
+    EXPECT_EQ("begin url(/) field(" + name + "|~) value(v) headers complete ", callbacks_.log_);
+
+    for (const char bad : std::string(" \"(),/;<=>?@[\\]{}\x7f\x80")) {
+      expectError(MessageType::Request, "GET / HTTP/1.1\r\n" + name + bad + ": v\r\n\r\n",
+                  "HPE_INVALID_HEADER_TOKEN");
+    }
+  }
+}
+
+TEST_P(VectorizedParserImplTest, HeaderValueWhitespace) {
+  expectLog(MessageType::Request, "GET / HTTP/1.1\nfoo: \t bar baz \t \nempty:   \n\n",
+            "begin url(/) field(foo) value(bar baz) field(empty) value() headers complete ");
+}
+
+TEST_P(VectorizedParserImplTest, HighBytesInValues) {
+  expectLog(MessageType::Request, "GET /\xc3\xa9 HTTP/1.1\r\nfoo: \xc3\xa9\x80\xff\r\n\r\n",
+            "begin url(/\xc3\xa9) field(foo) value(\xc3\xa9\x80\xff) headers complete ");
+}
+
+TEST_P(VectorizedParserImplTest, Http09) {
+  initialize(MessageType::Request);
+  parse("GET /\r\n\r\n");
+  EXPECT_EQ("begin url(/) headers complete ", callbacks_.log_);
+  EXPECT_FALSE(parser_->isHttp11());
+}
+
+TEST_P(VectorizedParserImplTest, Connect) {
+  initialize(MessageType::Request);
+  const std::string headers("CONNECT example.com:443 HTTP/1.1\r\n\r\n");
+  const std::string input = headers + "tunnel";
+  EXPECT_EQ(headers.size(), parser_->execute(input.data(), input.size()));
+  EXPECT_EQ(HTTP_CONNECT, parser_->method());
+  EXPECT_EQ("begin url(example.com:443) headers complete ", callbacks_.log_);
+}
+
+TEST_P(VectorizedParserImplTest, ChunkedTrailers) {
+  expectLog(MessageType::Response,
+            "HTTP/1.1 200 OK\r\ntransfer-encoding: chunked\r\n\r\n3\r\nabc\r\n0\r\n"
+            "foo: bar\r\nbaz: qux\r\n\r\nHTTP/1.1 204 No Content\r\n\r\n",
+            "begin field(transfer-encoding) value(chunked) headers body(abc) complete begin "
+            "headers complete ");
+}
+
+TEST_P(VectorizedParserImplTest, StrictErrors) {
+  expectError(MessageType::Request, "GET / HTTP/1.1\r\nfoo bar: baz\r\n\r\n",
+              "HPE_INVALID_HEADER_TOKEN");
+  expectError(MessageType::Request, "GET / HTTP/1.1\r\nfoo: bar\r\n baz\r\n\r\n",
+              "HPE_INVALID_HEADER_TOKEN");
+  expectError(MessageType::Request, "GET / HTTP/1.1\r\n: bar\r\n\r\n",
+              "HPE_INVALID_HEADER_TOKEN");
+  expectError(MessageType::Request, "GET / HTTP/1.1\r\nfoo: b\rr\r\n\r\n", "HPE_LF_EXPECTED");
+  expectError(MessageType::Request, "GET /\x01 HTTP/1.1\r\n\r\n", "HPE_INVALID_URL");
+  expectError(MessageType::Request, "GET / HTZP/1.1\r\n\r\n", "HPE_INVALID_CONSTANT");
+  expectError(MessageType::Request, "GET / HTTP/1.x\r\n\r\n", "HPE_INVALID_VERSION");
+  expectError(MessageType::Request,
+              "POST / HTTP/1.1\r\ntransfer-encoding: chunked\r\ncontent-length: 1\r\n\r\n",
+              "HPE_UNEXPECTED_CONTENT_LENGTH");
+  expectError(MessageType::Request,
+              "POST / HTTP/1.1\r\ncontent-length: 99999999999999999999\r\n\r\n",
+              "HPE_INVALID_CONTENT_LENGTH");
+  expectError(MessageType::Request,
+              "POST / HTTP/1.1\r\ntransfer-encoding: chunked\r\n\r\n3\r\nabcd",
+              "HPE_INVALID_CHUNK_SIZE");
+  expectError(MessageType::Request, "XYZ", "HPE_INVALID_METHOD");
+  expectError(MessageType::Response, "HTTP/1.1 20 OK\r\n\r\n", "HPE_INVALID_STATUS");
+  expectError(MessageType::Response, "HTTX", "HPE_INVALID_CONSTANT");
+}
+
+// A CR that is not followed by a LF must not end the header block early, nor hide the lines after
+// it, however the block is split.
+TEST_P(VectorizedParserImplTest, BareCrAfterHeaderLine) {
+  const std::string input = "GET / HTTP/1.1\r\nA: b\r\n\rX: evil\r\n\r\n";
+  for (size_t split_point = 1; split_point <= input.size(); split_point++) {
+    initialize(MessageType::Request);
+    callbacks_.log_.clear();
+    callbacks_.last_fragment_.clear();
+    const size_t consumed = parser_->execute(input.data(), split_point);
+    if (!parser_->hasError()) {
+      parser_->execute(input.data() + consumed, input.size() - consumed);
+    }
+    EXPECT_TRUE(parser_->hasError()) << "split at " << split_point;
+    EXPECT_STREQ("HPE_LF_EXPECTED", parser_->errorName()) << "split at " << split_point;
+    EXPECT_EQ(std::string::npos, callbacks_.log_.find("headers "))
+        << "split at " << split_point;
+  }
+}
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,80 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+
+#include "common/http/http1/legacy_parser_impl.h"
+#include "common/http/http1/vectorized_parser_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+// Touches every span so that the callback cost is comparable between parsers.
+class CountingCallbacks : public ParserCallbacks {
+public:
+  // Http1::ParserCallbacks
+  void onMessageBegin() override {}
+  void onUrl(const char*, size_t length) override { bytes_ += length; }
+  void onHeaderField(const char*, size_t length) override { bytes_ += length; }
+  void onHeaderValue(const char*, size_t length) override { bytes_ += length; }
+  int onHeadersComplete() override { return 0; }
+  void onBody(const char*, size_t length) override { bytes_ += length; }
+  void onMessageComplete() override { messages_++; }
+
+  size_t bytes_{};
+  size_t messages_{};
+};
+
+// A typical browser request, with range(0) bytes of cookies.
+static std::string makeRequest(benchmark::State& state) {
+  return "GET /api/v1/users/1234/profile?fields=name,email HTTP/1.1\r\n"
+         "Host: www.example.com\r\n"
+         "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+         "Chrome/68.0.3440.106 Safari/537.36\r\n"
+         "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,*/*;q=0.8\r\n"
+         "Accept-Encoding: gzip, deflate, br\r\n"
+         "Accept-Language: en-US,en;q=0.9\r\n"
+         "Cache-Control: no-cache\r\n"
+         "Cookie: session=" +
+         std::string(state.range(0), 'c') +
+         "\r\n"
+         "X-Request-Id: 8a3f0e5c-6c1e-4f4b-9f3a-1c2d3e4f5a6b\r\n"
+         "\r\n";
+}
+
+template <class ParserType> static void parseRequests(benchmark::State& state) {
+  const std::string request = makeRequest(state);
+  CountingCallbacks callbacks;
+  ParserType parser(MessageType::Request, callbacks);
+  for (auto _ : state) {
+    parser.execute(request.data(), request.size());
+  }
+  benchmark::DoNotOptimize(callbacks.bytes_);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * request.size());
+}
+
+static void BM_LegacyParser(benchmark::State& state) {
+  parseRequests<LegacyHttpParserImpl>(state);
+}
+BENCHMARK(BM_LegacyParser)->Arg(0)->Arg(200)->Arg(4000);
+
+static void BM_VectorizedParser(benchmark::State& state) {
+  parseRequests<VectorizedParserImpl>(state);
+}
+BENCHMARK(BM_VectorizedParser)->Arg(0)->Arg(200)->Arg(4000);
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
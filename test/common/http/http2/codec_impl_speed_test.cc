@@ -0,0 +1,128 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http2/codec_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/allocation_counter.h"
+#include "test/test_common/utility.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+// Accepts the streams of either side of a connection, keeping the last decoded headers alive.
+class BenchmarkCallbacks : public ServerConnectionCallbacks, public StreamDecoder {
+public:
+  // Http::ServerConnectionCallbacks
+  StreamDecoder& newStream(StreamEncoder& response_encoder) override {
+    encoder_ = &response_encoder;
+    return *this;
+  }
+  void onGoAway() override {}
+
+  // Http::StreamDecoder
+  void decode100ContinueHeaders(HeaderMapPtr&&) override {}
+  void decodeHeaders(HeaderMapPtr&& headers, bool) override { headers_ = std::move(headers); }
+  void decodeData(Buffer::Instance&, bool) override {}
+  void decodeTrailers(HeaderMapPtr&&) override {}
+
+  StreamEncoder* encoder_{};
+  HeaderMapPtr headers_;
+};
+
+// Dispatches the data written by one side of the connection to the other. Data written while
+// the other side is dispatching is queued, as it would be by the network.
+class Pipe {
+public:
+  Pipe(Network::MockConnection& connection, ConnectionImpl& peer) : peer_(peer) {
+    ON_CALL(connection, write(testing::_, testing::_))
+        .WillByDefault(testing::Invoke([this](Buffer::Instance& data, bool) -> void {
+          buffer_.move(data);
+          if (!dispatching_) {
+            dispatching_ = true;
+            while (buffer_.length() > 0) {
+              peer_.dispatch(buffer_);
+            }
+            dispatching_ = false;
+          }
+        }));
+  }
+
+private:
+  ConnectionImpl& peer_;
+  Buffer::OwnedImpl buffer_;
+  bool dispatching_{};
+};
+
+// Send requests with range(0) custom headers and their responses over a connection whose HPACK
+// dynamic table has range(1) bytes. The request id of each request is unique, as in practice.
+static void BM_Http2Request(benchmark::State& state) {
+  Stats::IsolatedStoreImpl stats_store;
+  Http2Settings settings;
+  settings.hpack_table_size_ = state.range(1);
+  testing::NiceMock<Network::MockConnection> client_connection;
+  testing::NiceMock<Network::MockConnection> server_connection;
+  BenchmarkCallbacks client_callbacks;
+  BenchmarkCallbacks server_callbacks;
+  ClientConnectionImpl client(client_connection, client_callbacks, stats_store, settings);
+  ServerConnectionImpl server(server_connection, server_callbacks, stats_store, settings);
+  Pipe client_to_server(client_connection, server);
+  Pipe server_to_client(server_connection, client);
+
+  TestHeaderMapImpl request_headers{
+      {":method", "GET"},
+      {":path", "/api/v1/users/1234/profile?fields=name,email"},
+      {":authority", "www.example.com"},
+      {":scheme", "https"},
+      {"user-agent", "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) "
+                     "Chrome/68.0.3440.106 Safari/537.36"},
+      {"accept", "text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,*/*;q=0.8"},
+      {"accept-encoding", "gzip, deflate, br"},
+      {"accept-language", "en-US,en;q=0.9"},
+      {"cookie", "session=8a3f0e5c6c1e4f4b9f3a1c2d3e4f5a6b"},
+      {"x-request-id", "0"}};
+  for (int64_t i = 0; i < state.range(0); i++) {
+    request_headers.addCopy("x-custom-header-" + std::to_string(i), "custom value");
+  }
+  const TestHeaderMapImpl response_headers{{":status", "200"},
+                                           {"content-type", "application/json"},
+                                           {"date", "Mon, 15 Oct 2018 10:00:00 GMT"},
+                                           {"server", "envoy"},
+                                           {"x-envoy-upstream-service-time", "3"}};
+  HeaderEntry* request_id = request_headers.get(LowerCaseString("x-request-id"));
+
+  AllocationCounter counter;
+  uint64_t requests = 0;
+  for (auto _ : state) {
+    request_id->value(++requests);
+    client.newStream(client_callbacks).encodeHeaders(request_headers, true);
+    server_callbacks.encoder_->encodeHeaders(response_headers, true);
+    // Closed streams are deferred deleted.
+    client_connection.dispatcher_.to_delete_.clear();
+    server_connection.dispatcher_.to_delete_.clear();
+  }
+  state.counters["allocs_per_iter"] =
+      static_cast<double>(counter.allocations()) / state.iterations();
+}
+BENCHMARK(BM_Http2Request)->Args({0, 4096})->Args({30, 4096})->Args({30, 0});
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
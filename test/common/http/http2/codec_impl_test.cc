@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "envoy/http/codec.h"
 #include "envoy/stats/scope.h"
@@ -361,6 +363,61 @@ TEST_P(Http2CodecImplTest, TrailingHeadersLargeBody) {
   response_encoder_->encodeTrailers(TestHeaderMapImpl{{"trailing", "header"}});
 }
 
+// Headers and trailers of every stream are built in an array owned by the connection. Later
+// messages with fewer headers must not pick up entries left over from earlier ones.
+TEST_P(Http2CodecImplTest, SequentialMessagesWithFewerHeaders) {
+  initialize();
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  request_headers.addCopy("x-first", "1");
+  request_headers.addCopy("x-second", "2");
+  EXPECT_CALL(request_decoder_, decodeHeaders_(HeaderMapEqual(&request_headers), true));
+  request_encoder_->encodeHeaders(request_headers, true);
+
+  TestHeaderMapImpl response_headers{{":status", "200"}, {"x-first", "1"}, {"x-second", "2"}};
+  EXPECT_CALL(response_decoder_, decodeHeaders_(HeaderMapEqual(&response_headers), true));
+  response_encoder_->encodeHeaders(response_headers, true);
+
+  MockStreamDecoder response_decoder2;
+  request_encoder_ = &client_.newStream(response_decoder2);
+  MockStreamDecoder request_decoder2;
+  EXPECT_CALL(server_callbacks_, newStream(_))
+      .WillOnce(Invoke([&](StreamEncoder& encoder) -> StreamDecoder& {
+        response_encoder_ = &encoder;
+        return request_decoder2;
+      }));
+
+  TestHeaderMapImpl request_headers2;
+  HttpTestUtility::addDefaultHeaders(request_headers2);
+  EXPECT_CALL(request_decoder2, decodeHeaders_(HeaderMapEqual(&request_headers2), true));
+  request_encoder_->encodeHeaders(request_headers2, true);
+
+  TestHeaderMapImpl response_headers2{{":status", "404"}};
+  EXPECT_CALL(response_decoder2, decodeHeaders_(HeaderMapEqual(&response_headers2), true));
+  response_encoder_->encodeHeaders(response_headers2, true);
+}
+
+TEST_P(Http2CodecImplTest, TrailersAfterLargerHeaders) {
+  initialize();
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  request_headers.addCopy("x-first", "1");
+  EXPECT_CALL(request_decoder_, decodeHeaders_(HeaderMapEqual(&request_headers), false));
+  request_encoder_->encodeHeaders(request_headers, false);
+  TestHeaderMapImpl request_trailers{{"trailing", "header"}};
+  EXPECT_CALL(request_decoder_, decodeTrailers_(HeaderMapEqual(&request_trailers)));
+  request_encoder_->encodeTrailers(request_trailers);
+
+  TestHeaderMapImpl response_headers{{":status", "200"}, {"x-first", "1"}, {"x-second", "2"}};
+  EXPECT_CALL(response_decoder_, decodeHeaders_(HeaderMapEqual(&response_headers), false));
+  response_encoder_->encodeHeaders(response_headers, false);
+  TestHeaderMapImpl response_trailers{{"grpc-status", "0"}};
+  EXPECT_CALL(response_decoder_, decodeTrailers_(HeaderMapEqual(&response_trailers)));
+  response_encoder_->encodeTrailers(response_trailers);
+}
+
 class Http2CodecImplDeferredResetTest : public Http2CodecImplTest {};
 
 TEST_P(Http2CodecImplDeferredResetTest, DeferredResetClient) {
@@ -735,6 +792,194 @@ INSTANTIATE_TEST_CASE_P(Http2CodecImplTestDefaultSettings, Http2CodecImplTest,
 INSTANTIATE_TEST_CASE_P(Http2CodecImplTestEdgeSettings, Http2CodecImplTest,
                         ::testing::Combine(HTTP2SETTINGS_EDGE_COMBINE, HTTP2SETTINGS_EDGE_COMBINE));
 
+// With reference_received_data, large DATA payloads are handed to the decoder without copying
+// them out of the dispatched buffer.
+TEST(Http2CodecReferencedDataTest, ReferencesReceivedData) {
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Network::MockConnection> client_connection;
+  MockConnectionCallbacks client_callbacks;
+  TestClientConnectionImpl client(client_connection, client_callbacks, stats_store,
+                                  Http2Settings());
+  Http2Settings server_http2settings;
+  server_http2settings.reference_received_data_ = true;
+  NiceMock<Network::MockConnection> server_connection;
+  MockServerConnectionCallbacks server_callbacks;
+  TestServerConnectionImpl server(server_connection, server_callbacks, stats_store,
+                                  server_http2settings);
+
+  Buffer::OwnedImpl client_output;
+  ON_CALL(client_connection, write(_, _))
+      .WillByDefault(
+          Invoke([&](Buffer::Instance& data, bool) -> void { client_output.move(data); }));
+
+  MockStreamDecoder response_decoder;
+  StreamEncoder& request_encoder = client.newStream(response_decoder);
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  request_encoder.encodeHeaders(request_headers, false);
+  Buffer::OwnedImpl body(std::string(16384, 'a'));
+  request_encoder.encodeData(body, true);
+
+  std::vector<Buffer::RawSlice> input_slices(client_output.getRawSlices(nullptr, 0));
+  client_output.getRawSlices(input_slices.data(), input_slices.size());
+
+  MockStreamDecoder request_decoder;
+  Buffer::OwnedImpl received;
+  EXPECT_CALL(server_callbacks, newStream(_))
+      .WillOnce(Invoke([&](StreamEncoder&) -> StreamDecoder& { return request_decoder; }));
+  EXPECT_CALL(request_decoder, decodeHeaders_(_, false));
+  EXPECT_CALL(request_decoder, decodeData(_, true))
+      .WillOnce(Invoke([&](Buffer::Instance& data, bool) -> void { received.move(data); }));
+  server.dispatch(client_output);
+  EXPECT_EQ(0, client_output.length());
+  EXPECT_EQ(std::string(16384, 'a'), received.toString());
+
+  // The received data still points into the slices that were dispatched.
+  std::vector<Buffer::RawSlice> received_slices(received.getRawSlices(nullptr, 0));
+  received.getRawSlices(received_slices.data(), received_slices.size());
+  for (const Buffer::RawSlice& slice : received_slices) {
+    const uint8_t* mem = static_cast<const uint8_t*>(slice.mem_);
+    EXPECT_TRUE(std::any_of(input_slices.begin(), input_slices.end(),
+                            [mem, &slice](const Buffer::RawSlice& input) -> bool {
+                              const uint8_t* input_mem = static_cast<const uint8_t*>(input.mem_);
+                              return mem >= input_mem &&
+                                     mem + slice.len_ <= input_mem + input.len_;
+                            }));
+  }
+}
+
+// With prioritize_streams, the DATA frames encoded while the connection is write blocked are held
+// until it drains, and then sent by stream weight.
+TEST(Http2CodecPrioritizeStreamsTest, HoldsDataUntilConnectionDrains) {
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Network::MockConnection> client_connection;
+  MockConnectionCallbacks client_callbacks;
+  TestClientConnectionImpl client(client_connection, client_callbacks, stats_store,
+                                  Http2Settings());
+  Http2Settings server_http2settings;
+  server_http2settings.prioritize_streams_ = true;
+  NiceMock<Network::MockConnection> server_connection;
+  MockServerConnectionCallbacks server_callbacks;
+  TestServerConnectionImpl server(server_connection, server_callbacks, stats_store,
+                                  server_http2settings);
+
+  Http2CodecImplTest::ConnectionWrapper client_wrapper;
+  Http2CodecImplTest::ConnectionWrapper server_wrapper;
+  uint64_t server_bytes_written = 0;
+  ON_CALL(client_connection, write(_, _))
+      .WillByDefault(Invoke(
+          [&](Buffer::Instance& data, bool) -> void { server_wrapper.dispatch(data, server); }));
+  ON_CALL(server_connection, write(_, _))
+      .WillByDefault(Invoke([&](Buffer::Instance& data, bool) -> void {
+        server_bytes_written += data.length();
+        client_wrapper.dispatch(data, client);
+      }));
+
+  MockStreamDecoder response_decoders[2];
+  MockStreamDecoder request_decoders[2];
+  StreamEncoder* response_encoders[2];
+  EXPECT_CALL(server_callbacks, newStream(_))
+      .WillOnce(Invoke([&](StreamEncoder& encoder) -> StreamDecoder& {
+        response_encoders[0] = &encoder;
+        return request_decoders[0];
+      }))
+      .WillOnce(Invoke([&](StreamEncoder& encoder) -> StreamDecoder& {
+        response_encoders[1] = &encoder;
+        return request_decoders[1];
+      }));
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  std::vector<int> received_frames;
+  for (int i = 0; i < 2; i++) {
+    EXPECT_CALL(request_decoders[i], decodeHeaders_(_, true));
+    client.newStream(response_decoders[i]).encodeHeaders(request_headers, true);
+    EXPECT_CALL(response_decoders[i], decodeHeaders_(_, false));
+    EXPECT_CALL(response_decoders[i], decodeData(_, _))
+        .WillRepeatedly(Invoke([&received_frames, i](Buffer::Instance& data, bool) -> void {
+          received_frames.push_back(i);
+          data.drain(data.length());
+        }));
+  }
+
+  response_encoders[0]->getStream().setPriorityWeight(16);
+  response_encoders[1]->getStream().setPriorityWeight(256);
+  TestHeaderMapImpl response_headers{{":status", "200"}};
+  response_encoders[0]->encodeHeaders(response_headers, false);
+  response_encoders[1]->encodeHeaders(response_headers, false);
+
+  server.onUnderlyingConnectionAboveWriteBufferHighWatermark();
+  const uint64_t bytes_written = server_bytes_written;
+  Buffer::OwnedImpl first_body(std::string(3 * 16384, 'a'));
+  response_encoders[0]->encodeData(first_body, true);
+  Buffer::OwnedImpl second_body(std::string(3 * 16384, 'b'));
+  response_encoders[1]->encodeData(second_body, true);
+  EXPECT_EQ(bytes_written, server_bytes_written);
+  EXPECT_TRUE(received_frames.empty());
+
+  // Both streams start at the same point, after which the heavier second stream sends all of its
+  // frames before the next frame of the first one.
+  server.onUnderlyingConnectionBelowWriteBufferLowWatermark();
+  EXPECT_EQ(std::vector<int>({0, 1, 1, 1, 0, 0}), received_frames);
+}
+
+// With an auto tuned window size limit, the receive windows grow from their initial sizes as DATA
+// fills them, up to the limit.
+TEST(Http2CodecAutoTunedWindowTest, GrowsWindowsUpToLimit) {
+  Stats::IsolatedStoreImpl stats_store;
+  Http2Settings client_http2settings;
+  client_http2settings.initial_stream_window_size_ = Http2Settings::MIN_INITIAL_STREAM_WINDOW_SIZE;
+  client_http2settings.initial_connection_window_size_ =
+      Http2Settings::MIN_INITIAL_CONNECTION_WINDOW_SIZE;
+  client_http2settings.auto_tuned_window_size_limit_ = 100000;
+  NiceMock<Network::MockConnection> client_connection;
+  MockConnectionCallbacks client_callbacks;
+  TestClientConnectionImpl client(client_connection, client_callbacks, stats_store,
+                                  client_http2settings);
+  NiceMock<Network::MockConnection> server_connection;
+  MockServerConnectionCallbacks server_callbacks;
+  TestServerConnectionImpl server(server_connection, server_callbacks, stats_store,
+                                  Http2Settings());
+
+  Http2CodecImplTest::ConnectionWrapper client_wrapper;
+  Http2CodecImplTest::ConnectionWrapper server_wrapper;
+  ON_CALL(client_connection, write(_, _))
+      .WillByDefault(Invoke(
+          [&](Buffer::Instance& data, bool) -> void { server_wrapper.dispatch(data, server); }));
+  ON_CALL(server_connection, write(_, _))
+      .WillByDefault(Invoke(
+          [&](Buffer::Instance& data, bool) -> void { client_wrapper.dispatch(data, client); }));
+
+  MockStreamDecoder response_decoder;
+  MockStreamDecoder request_decoder;
+  StreamEncoder* response_encoder = nullptr;
+  EXPECT_CALL(server_callbacks, newStream(_))
+      .WillOnce(Invoke([&](StreamEncoder& encoder) -> StreamDecoder& {
+        response_encoder = &encoder;
+        return request_decoder;
+      }));
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder, decodeHeaders_(_, true));
+  client.newStream(response_decoder).encodeHeaders(request_headers, true);
+
+  uint64_t received = 0;
+  EXPECT_CALL(response_decoder, decodeHeaders_(_, false));
+  EXPECT_CALL(response_decoder, decodeData(_, _))
+      .WillRepeatedly(Invoke([&received](Buffer::Instance& data, bool) -> void {
+        received += data.length();
+        data.drain(data.length());
+      }));
+  TestHeaderMapImpl response_headers{{":status", "200"}};
+  response_encoder->encodeHeaders(response_headers, false);
+  Buffer::OwnedImpl body(std::string(1024 * 1024, 'a'));
+  response_encoder->encodeData(body, true);
+
+  EXPECT_EQ(1024 * 1024, received);
+  EXPECT_EQ(100000, nghttp2_session_get_local_settings(client.session(),
+                                                       NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE));
+  EXPECT_EQ(100000, nghttp2_session_get_effective_local_window_size(client.session()));
+}
+
 TEST(Http2CodecUtility, reconstituteCrumbledCookies) {
   {
     HeaderString key;
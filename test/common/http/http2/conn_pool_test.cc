@@ -62,8 +62,9 @@ public:
     Event::DispatcherPtr client_dispatcher_;
   };
 
-  Http2ConnPoolImplTest()
-      : pool_(dispatcher_, host_, Upstream::ResourcePriority::Default, nullptr) {}
+  Http2ConnPoolImplTest(uint32_t max_connections_per_host = 1)
+      : cluster_(newCluster(max_connections_per_host)),
+        pool_(dispatcher_, host_, Upstream::ResourcePriority::Default, nullptr) {}
 
   ~Http2ConnPoolImplTest() {
     // Make sure all gauges are 0.
@@ -100,11 +101,17 @@ public:
     test_clients_[index].connection_->raiseEvent(Network::ConnectionEvent::Connected);
   }
 
+  static std::shared_ptr<Upstream::MockClusterInfo> newCluster(uint32_t max_connections_per_host) {
+    std::shared_ptr<Upstream::MockClusterInfo> cluster{new NiceMock<Upstream::MockClusterInfo>()};
+    cluster->http2_settings_.max_connections_per_host_ = max_connections_per_host;
+    return cluster;
+  }
+
   MOCK_METHOD0(onClientDestroy, void());
 
   DangerousDeprecatedTestTime test_time_;
   NiceMock<Event::MockDispatcher> dispatcher_;
-  std::shared_ptr<Upstream::MockClusterInfo> cluster_{new NiceMock<Upstream::MockClusterInfo>()};
+  std::shared_ptr<Upstream::MockClusterInfo> cluster_;
   Upstream::HostSharedPtr host_{Upstream::makeTestHost(cluster_, "tcp://127.0.0.1:80")};
   TestConnPoolImpl pool_;
   std::vector<TestCodecClient> test_clients_;
@@ -163,6 +170,9 @@ TEST_F(Http2ConnPoolImplTest, VerifyConnectionTimingStats) {
   expectClientCreate();
   EXPECT_CALL(cluster_->stats_store_,
               deliverHistogramToSinks(Property(&Stats::Metric::name, "upstream_cx_connect_ms"), _));
+  EXPECT_CALL(
+      cluster_->stats_store_,
+      deliverHistogramToSinks(Property(&Stats::Metric::name, "upstream_cx_http2_streams"), 1));
   EXPECT_CALL(cluster_->stats_store_,
               deliverHistogramToSinks(Property(&Stats::Metric::name, "upstream_cx_length_ms"), _));
 
@@ -450,6 +460,101 @@ TEST_F(Http2ConnPoolImplTest, GoAway) {
   EXPECT_EQ(1U, cluster_->stats_.upstream_cx_close_notify_.value());
 }
 
+class Http2ConnPoolImplMultipleConnectionsTest : public Http2ConnPoolImplTest {
+public:
+  Http2ConnPoolImplMultipleConnectionsTest() : Http2ConnPoolImplTest(2) {}
+};
+
+/**
+ * Verify that streams are spread over the connections by their active streams, and that another
+ * connection is only opened once the open ones are busy.
+ */
+TEST_F(Http2ConnPoolImplMultipleConnectionsTest, LeastActiveStreams) {
+  InSequence s;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(0);
+
+  // The first connection is busy, so the second one is opened.
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+  EXPECT_CALL(r2.inner_encoder_, encodeHeaders(_, true));
+  r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(1);
+
+  // Both connections have a stream, and no more may be opened.
+  ActiveTestRequest r3(*this, 0);
+  EXPECT_CALL(r3.inner_encoder_, encodeHeaders(_, true));
+  r3.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+
+  EXPECT_CALL(r2.decoder_, decodeHeaders_(_, true));
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  // The second connection now has the fewest active streams.
+  ActiveTestRequest r4(*this, 1);
+  EXPECT_CALL(r4.inner_encoder_, encodeHeaders(_, true));
+  r4.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+
+  ReadyWatcher drained;
+  pool_.addDrainedCallback([&]() -> void { drained.ready(); });
+
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  // Each connection is closed once it has no more streams.
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(r4.decoder_, decodeHeaders_(_, true));
+  r4.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(drained, ready());
+  EXPECT_CALL(r3.decoder_, decodeHeaders_(_, true));
+  r3.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_http2_total_.value());
+  EXPECT_EQ(4U, cluster_->stats_.upstream_rq_total_.value());
+}
+
+/**
+ * Verify that draining drains all the connections.
+ */
+TEST_F(Http2ConnPoolImplMultipleConnectionsTest, DrainConnections) {
+  InSequence s;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(0);
+
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+  EXPECT_CALL(r2.inner_encoder_, encodeHeaders(_, true));
+  r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(1);
+
+  // Both connections have active streams, so both are kept until their streams complete.
+  pool_.drainConnections();
+
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(r2.decoder_, decodeHeaders_(_, true));
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+}
+
 } // namespace Http2
 } // namespace Http
 } // namespace Envoy
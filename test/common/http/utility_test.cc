@@ -35,6 +35,22 @@ TEST(HttpUtility, parseQueryString) {
             Utility::parseQueryString("/logging?name=admin&level=trace"));
 }
 
+TEST(HttpUtility, QueryParamsView) {
+  EXPECT_FALSE(Utility::QueryParamsView("/hello").get("hello"));
+  EXPECT_FALSE(Utility::QueryParamsView("/hello?").get("hello"));
+  EXPECT_EQ("", Utility::QueryParamsView("/hello?hello").get("hello").value());
+  EXPECT_EQ("", Utility::QueryParamsView("/hello?hello=&").get("hello").value());
+
+  const std::string url = "/hello?hello=world&hello2=world2&hello=again";
+  const Utility::QueryParamsView params(url);
+  EXPECT_EQ("world2", params.get("hello2").value());
+  // The first value of a repeated parameter wins, as with parseQueryString().
+  EXPECT_EQ("world", params.get("hello").value());
+  EXPECT_FALSE(params.get("hello3"));
+  // The values are views of the URL.
+  EXPECT_EQ(url.data() + 13, params.get("hello").value().data());
+}
+
 TEST(HttpUtility, getResponseStatus) {
   EXPECT_THROW(Utility::getResponseStatus(TestHeaderMapImpl{}), CodecClientException);
   EXPECT_EQ(200U, Utility::getResponseStatus(TestHeaderMapImpl{{":status", "200"}}));
@@ -227,6 +243,8 @@ TEST(HttpUtility, parseHttp2Settings) {
               http2_settings.initial_stream_window_size_);
     EXPECT_EQ(Http2Settings::DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE,
               http2_settings.initial_connection_window_size_);
+    EXPECT_EQ(Http2Settings::DEFAULT_MAX_CONNECTIONS_PER_HOST,
+              http2_settings.max_connections_per_host_);
   }
 
   {
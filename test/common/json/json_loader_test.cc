@@ -289,6 +289,11 @@ TEST(JsonLoaderTest, Schema) {
     EXPECT_THROW(json->validateSchema(invalid_schema), Exception);
     EXPECT_THROW(json->validateSchema(different_schema), Exception);
     EXPECT_NO_THROW(json->validateSchema(valid_schema));
+
+    // Compiled schemas are reused, and invalid ones are not cached.
+    EXPECT_THROW(json->validateSchema(invalid_json_schema), std::invalid_argument);
+    EXPECT_THROW(json->validateSchema(different_schema), Exception);
+    EXPECT_NO_THROW(json->validateSchema(valid_schema));
   }
 
   {
@@ -0,0 +1,63 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class TestHandler : public BalancedConnectionHandler {
+public:
+  // Network::BalancedConnectionHandler
+  uint64_t numConnections() const override { return num_connections_; }
+  void incNumConnections() override { num_connections_++; }
+  void post(ConnectionSocketPtr&&) override {}
+
+  uint64_t num_connections_{};
+};
+
+TEST(ExactConnectionBalancerImplTest, PicksLeastLoadedHandler) {
+  ExactConnectionBalancerImpl balancer;
+  TestHandler handler1;
+  TestHandler handler2;
+  TestHandler handler3;
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+  balancer.registerHandler(handler3);
+
+  handler1.num_connections_ = 2;
+  handler2.num_connections_ = 1;
+  handler3.num_connections_ = 3;
+  EXPECT_EQ(&handler2, &balancer.pickTargetHandler(handler1));
+  EXPECT_EQ(2UL, handler2.num_connections_);
+
+  // Ties go to the accepting handler.
+  EXPECT_EQ(&handler1, &balancer.pickTargetHandler(handler1));
+  EXPECT_EQ(3UL, handler1.num_connections_);
+  EXPECT_EQ(&handler2, &balancer.pickTargetHandler(handler3));
+  EXPECT_EQ(3UL, handler2.num_connections_);
+
+  // Unregistered handlers are not picked.
+  handler2.num_connections_ = 0;
+  handler3.num_connections_ = 5;
+  balancer.unregisterHandler(handler2);
+  EXPECT_EQ(&handler1, &balancer.pickTargetHandler(handler3));
+  EXPECT_EQ(4UL, handler1.num_connections_);
+}
+
+TEST(NopConnectionBalancerImplTest, KeepsCurrentHandler) {
+  NopConnectionBalancerImpl balancer;
+  TestHandler handler1;
+  TestHandler handler2;
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+
+  handler1.num_connections_ = 5;
+  EXPECT_EQ(&handler1, &balancer.pickTargetHandler(handler1));
+  EXPECT_EQ(6UL, handler1.num_connections_);
+  EXPECT_EQ(0UL, handler2.num_connections_);
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
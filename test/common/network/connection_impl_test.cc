@@ -2,6 +2,7 @@
 #include <memory>
 #include <string>
 
+#include "common/api/os_sys_calls_impl.h"
 #include "common/buffer/buffer_impl.h"
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
@@ -9,9 +10,11 @@
 #include "common/network/address_impl.h"
 #include "common/network/connection_impl.h"
 #include "common/network/listen_socket_impl.h"
+#include "common/network/raw_buffer_socket.h"
 #include "common/network/utility.h"
 #include "common/runtime/runtime_impl.h"
 
+#include "test/mocks/api/mocks.h"
 #include "test/mocks/buffer/mocks.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/network/mocks.h"
@@ -21,6 +24,7 @@
 #include "test/test_common/network_utility.h"
 #include "test/test_common/printers.h"
 #include "test/test_common/test_time.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -32,7 +36,9 @@ using testing::DoAll;
 using testing::InSequence;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
+using testing::NiceMock;
 using testing::Return;
+using testing::ReturnRef;
 using testing::SaveArg;
 using testing::Sequence;
 using testing::StrictMock;
@@ -48,6 +54,52 @@ TEST(RawBufferSocket, TestBasics) {
   EXPECT_EQ("", raw_buffer_socket->protocol());
 }
 
+TEST(RawBufferSocket, AdaptiveReadSize) {
+  Api::MockOsSysCalls os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  NiceMock<MockTransportSocketCallbacks> callbacks;
+  ON_CALL(callbacks, connection()).WillByDefault(ReturnRef(callbacks.connection_));
+  RawBufferSocket socket;
+  socket.setTransportSocketCallbacks(callbacks);
+  Buffer::OwnedImpl buffer;
+
+  // Expect a read of up to expected_size bytes, returning rc.
+  auto expect_read = [&](uint64_t expected_size, ssize_t rc) {
+    EXPECT_CALL(os_sys_calls, readv(_, _, _))
+        .WillOnce(Invoke([expected_size, rc](int, const iovec* iov,
+                                             int num_iov) -> Api::SysCallSizeResult {
+          uint64_t size = 0;
+          for (int i = 0; i < num_iov; i++) {
+            size += iov[i].iov_len;
+          }
+          EXPECT_EQ(expected_size, size);
+          return {rc, rc < 0 ? EAGAIN : 0};
+        }))
+        .RetiresOnSaturation();
+  };
+
+  // Reads that fill the reservation grow it, up to MaxReadSize.
+  {
+    InSequence s;
+    expect_read(16384, 16384);
+    expect_read(32768, 32768);
+    expect_read(RawBufferSocket::MaxReadSize, RawBufferSocket::MaxReadSize);
+    expect_read(RawBufferSocket::MaxReadSize, -1);
+  }
+  EXPECT_EQ(16384 + 32768 + RawBufferSocket::MaxReadSize, socket.doRead(buffer).bytes_processed_);
+  buffer.drain(buffer.length());
+
+  // Read events that only use a small part of it shrink it, down to MinReadSize.
+  for (uint64_t size : {RawBufferSocket::MaxReadSize, 32768UL, 16384UL, 8192UL,
+                        RawBufferSocket::MinReadSize, RawBufferSocket::MinReadSize}) {
+    InSequence s;
+    expect_read(size, 100);
+    expect_read(size, -1);
+    EXPECT_EQ(100, socket.doRead(buffer).bytes_processed_);
+    buffer.drain(buffer.length());
+  }
+}
+
 TEST(ConnectionImplUtility, updateBufferStats) {
   StrictMock<Stats::MockCounter> counter;
   StrictMock<Stats::MockGauge> gauge;
@@ -358,7 +410,15 @@ TEST_P(ConnectionImplTest, SocketOptionsFailureTest) {
 
 struct MockConnectionStats {
   Connection::ConnectionStats toBufferStats() {
-    return {rx_total_, rx_current_, tx_total_, tx_current_, &bind_errors_};
+    return {rx_total_,
+            rx_current_,
+            tx_total_,
+            tx_current_,
+            &bind_errors_,
+            &read_budget_exhausted_,
+            &write_buffer_above_high_watermark_ms_,
+            &connect_fallback_wins_,
+            &tfo_syn_data_acked_};
   }
 
   StrictMock<Stats::MockCounter> rx_total_;
@@ -366,6 +426,10 @@ struct MockConnectionStats {
   StrictMock<Stats::MockCounter> tx_total_;
   StrictMock<Stats::MockGauge> tx_current_;
   StrictMock<Stats::MockCounter> bind_errors_;
+  StrictMock<Stats::MockCounter> read_budget_exhausted_;
+  StrictMock<Stats::MockCounter> write_buffer_above_high_watermark_ms_;
+  StrictMock<Stats::MockCounter> connect_fallback_wins_;
+  StrictMock<Stats::MockCounter> tfo_syn_data_acked_;
 };
 
 TEST_P(ConnectionImplTest, ConnectionStats) {
@@ -1263,9 +1327,67 @@ TEST_P(ReadBufferLimitTest, NoLimit) { readBufferLimitTest(0, 256 * 1024); }
 TEST_P(ReadBufferLimitTest, SomeLimit) {
   const uint32_t read_buffer_limit = 32 * 1024;
   // Envoy has soft limits, so as long as the first read is <= read_buffer_limit - 1 it will do a
-  // second read. The effective chunk size is then read_buffer_limit - 1 + MaxReadSize,
-  // which is currently 16384.
-  readBufferLimitTest(read_buffer_limit, read_buffer_limit - 1 + 16384);
+  // second read. The effective chunk size is then read_buffer_limit - 1 + MaxReadSize.
+  readBufferLimitTest(read_buffer_limit, read_buffer_limit - 1 + RawBufferSocket::MaxReadSize);
+}
+
+TEST_P(ReadBufferLimitTest, ReadBudget) {
+  // Like the buffer limit, the read budget is soft and counts the bytes read in one read event.
+  const uint64_t read_budget = 16 * 1024;
+  ConnectionImpl::setReadBudget(read_budget);
+  readBufferLimitTest(0, read_budget - 1 + RawBufferSocket::MaxReadSize);
+  ConnectionImpl::setReadBudget(0);
+}
+
+// A connection racing attempts to several addresses continues with the socket of the first attempt
+// that connects, here after connecting to the first address failed.
+TEST_P(ConnectionImplTest, HappyEyeballsFallback) {
+  dispatcher_.reset(new Event::DispatcherImpl(time_system_));
+  listener_ = dispatcher_->createListener(socket_, listener_callbacks_, true, false);
+
+  // Nothing listens on the port of a socket that was closed once bound.
+  Network::TcpListenSocket closed_socket(Network::Test::getCanonicalLoopbackAddress(GetParam()),
+                                         nullptr, true);
+  const Address::InstanceConstSharedPtr refused_address = closed_socket.localAddress();
+  closed_socket.close();
+
+  client_connection_ = dispatcher_->createHappyEyeballsConnection(
+      {refused_address, socket_.localAddress()}, source_address_,
+      Network::Test::createRawBufferSocket(), nullptr);
+  client_connection_->addConnectionCallbacks(client_callbacks_);
+  Stats::Counter& connect_fallback = stats_store_.counter("connect_fallback");
+  client_connection_->setConnectionStats({stats_store_.counter("rx_total"),
+                                          stats_store_.gauge("rx_current"),
+                                          stats_store_.counter("tx_total"),
+                                          stats_store_.gauge("tx_current"), nullptr, nullptr,
+                                          nullptr, &connect_fallback, nullptr});
+  client_connection_->connect();
+  client_connection_->noDelay(true);
+
+  EXPECT_CALL(listener_callbacks_, onAccept_(_, _))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket, bool) -> void {
+        Network::ConnectionPtr new_connection = dispatcher_->createServerConnection(
+            std::move(socket), Network::Test::createRawBufferSocket());
+        listener_callbacks_.onNewConnection(std::move(new_connection));
+      }));
+  EXPECT_CALL(listener_callbacks_, onNewConnection_(_))
+      .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+        server_connection_ = std::move(conn);
+        server_connection_->addConnectionCallbacks(server_callbacks_);
+      }));
+  EXPECT_CALL(client_callbacks_, onEvent(ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(1, connect_fallback.value());
+  EXPECT_EQ(socket_.localAddress()->ip()->port(),
+            client_connection_->remoteAddress()->ip()->port());
+
+  EXPECT_CALL(client_callbacks_, onEvent(ConnectionEvent::LocalClose));
+  EXPECT_CALL(server_callbacks_, onEvent(ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+  client_connection_->close(ConnectionCloseType::NoFlush);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
 class TcpClientConnectionImplTest : public testing::TestWithParam<Address::IpVersion> {
@@ -1293,6 +1415,7 @@ TEST_P(TcpClientConnectionImplTest, BadConnectNotConnRefused) {
                                          Network::Test::createRawBufferSocket(), nullptr);
   connection->connect();
   connection->noDelay(true);
+  connection->quickAck(true);
   connection->close(ConnectionCloseType::NoFlush);
   dispatcher_.run(Event::Dispatcher::RunType::Block);
 }
@@ -2,6 +2,7 @@
 #include <arpa/nameser.h>
 #include <arpa/nameser_compat.h>
 
+#include <chrono>
 #include <list>
 #include <memory>
 #include <string>
@@ -56,9 +57,9 @@ enum record_type { A, AAAA };
 class TestDnsServerQuery {
 public:
   TestDnsServerQuery(ConnectionPtr connection, const HostMap& hosts_A, const HostMap& hosts_AAAA,
-                     const CNameMap& cnames)
+                     const CNameMap& cnames, const std::chrono::seconds& ttl)
       : connection_(std::move(connection)), hosts_A_(hosts_A), hosts_AAAA_(hosts_AAAA),
-        cnames_(cnames) {
+        cnames_(cnames), ttl_(ttl) {
     connection_->addReadFilter(Network::ReadFilterSharedPtr{new ReadFilter(*this)});
   }
 
@@ -215,7 +216,7 @@ private:
           DNS_RR_SET_LEN(response_rr_fixed, sizeof(in6_addr));
         }
         DNS_RR_SET_CLASS(response_rr_fixed, C_IN);
-        DNS_RR_SET_TTL(response_rr_fixed, 0);
+        DNS_RR_SET_TTL(response_rr_fixed, parent_.ttl_.count());
         if (ips != nullptr) {
           for (const auto& it : *ips) {
             write_buffer.add(ip_question, ip_name_len);
@@ -253,6 +254,7 @@ private:
   const HostMap& hosts_A_;
   const HostMap& hosts_AAAA_;
   const CNameMap& cnames_;
+  const std::chrono::seconds& ttl_;
 };
 
 class TestDnsServer : public ListenerCallbacks {
@@ -267,7 +269,7 @@ public:
 
   void onNewConnection(ConnectionPtr&& new_connection) override {
     TestDnsServerQuery* query =
-        new TestDnsServerQuery(std::move(new_connection), hosts_A_, hosts_AAAA_, cnames_);
+        new TestDnsServerQuery(std::move(new_connection), hosts_A_, hosts_AAAA_, cnames_, ttl_);
     queries_.emplace_back(query);
   }
 
@@ -283,12 +285,15 @@ public:
     cnames_[hostname] = cname;
   }
 
+  void setTtl(const std::chrono::seconds& ttl) { ttl_ = ttl; }
+
 private:
   Event::DispatcherImpl& dispatcher_;
 
   HostMap hosts_A_;
   HostMap hosts_AAAA_;
   CNameMap cnames_;
+  std::chrono::seconds ttl_{0};
   // All queries are tracked so we can do resource reclamation when the test is
   // over.
   std::vector<std::unique_ptr<TestDnsServerQuery>> queries_;
@@ -405,7 +410,13 @@ public:
   DnsImplTest() : dispatcher_(test_time_.timeSystem()) {}
 
   void SetUp() override {
-    resolver_ = dispatcher_.createDnsResolver({});
+    if (cache_size() > 0) {
+      resolver_ = std::make_shared<DnsResolverImpl>(
+          dispatcher_, std::vector<Address::InstanceConstSharedPtr>{}, cache_size(),
+          std::chrono::seconds(30), stats_store_.createScope("dns_cache."));
+    } else {
+      resolver_ = dispatcher_.createDnsResolver({});
+    }
 
     // Instantiate TestDnsServer and listen on a random port on the loopback address.
     server_.reset(new TestDnsServer(dispatcher_));
@@ -428,6 +439,8 @@ public:
 protected:
   // Should the DnsResolverImpl use a zero timeout for c-ares queries?
   virtual bool zero_timeout() const { return false; }
+  // How many resolutions should the DnsResolverImpl cache?
+  virtual uint32_t cache_size() const { return 0; }
   std::unique_ptr<TestDnsServer> server_;
   std::unique_ptr<DnsResolverImplPeer> peer_;
   Network::MockConnectionHandler connection_handler_;
@@ -725,6 +738,39 @@ TEST_P(DnsImplTest, MultiARecordLookupWithV6) {
   EXPECT_TRUE(hasAddress(address_list, "1::2:3:4"));
 }
 
+// The ALL family returns the addresses of both families, alternating from the IPv6 ones.
+TEST_P(DnsImplTest, AllLookupFamily) {
+  server_->addHosts("some.good.domain", {"201.134.56.7"}, A);
+  server_->addHosts("some.good.domain", {"1::2", "1::2:3"}, AAAA);
+  server_->addHosts("some.v4.domain", {"201.134.56.7"}, A);
+  std::list<Address::InstanceConstSharedPtr> address_list;
+  EXPECT_NE(nullptr, resolver_->resolve(
+                         "some.good.domain", DnsLookupFamily::All,
+                         [&](const std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                           address_list = results;
+                           dispatcher_.exit();
+                         }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+  ASSERT_EQ(3, address_list.size());
+  auto it = address_list.begin();
+  EXPECT_EQ("1::2", (*it++)->ip()->addressAsString());
+  EXPECT_EQ("201.134.56.7", (*it++)->ip()->addressAsString());
+  EXPECT_EQ("1::2:3", (*it++)->ip()->addressAsString());
+
+  // A name with addresses of a single family resolves to those.
+  EXPECT_NE(nullptr, resolver_->resolve(
+                         "some.v4.domain", DnsLookupFamily::All,
+                         [&](const std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                           address_list = results;
+                           dispatcher_.exit();
+                         }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+  ASSERT_EQ(1, address_list.size());
+  EXPECT_EQ("201.134.56.7", address_list.front()->ip()->addressAsString());
+}
+
 // Validate working of cancellation provided by ActiveDnsQuery return.
 TEST_P(DnsImplTest, Cancel) {
   server_->addHosts("some.good.domain", {"201.134.56.7"}, A);
@@ -773,6 +819,108 @@ TEST_P(DnsImplZeroTimeoutTest, Timeout) {
   EXPECT_TRUE(address_list.empty());
 }
 
+class DnsImplCacheTest : public DnsImplTest {
+protected:
+  uint32_t cache_size() const override { return 2; }
+};
+
+// Parameterize the DNS test server socket address.
+INSTANTIATE_TEST_CASE_P(IpVersions, DnsImplCacheTest,
+                        testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                        TestUtility::ipTestParamsToString);
+
+// Validate that resolutions are returned from the cache until their TTL expires, by lookup family.
+TEST_P(DnsImplCacheTest, Hit) {
+  server_->addHosts("some.good.domain", {"201.134.56.7"}, A);
+  server_->setTtl(std::chrono::seconds(300));
+  std::list<Address::InstanceConstSharedPtr> address_list;
+  EXPECT_NE(nullptr, resolver_->resolve(
+                         "some.good.domain", DnsLookupFamily::V4Only,
+                         [&](const std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                           address_list = results;
+                           dispatcher_.exit();
+                         }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+  EXPECT_TRUE(hasAddress(address_list, "201.134.56.7"));
+  EXPECT_EQ(1U, stats_store_.counter("dns_cache.miss").value());
+  EXPECT_EQ(1U, stats_store_.gauge("dns_cache.size").value());
+
+  address_list.clear();
+  EXPECT_EQ(nullptr, resolver_->resolve(
+                         "some.good.domain", DnsLookupFamily::V4Only,
+                         [&](const std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                           address_list = results;
+                         }));
+  EXPECT_TRUE(hasAddress(address_list, "201.134.56.7"));
+  EXPECT_EQ(1U, stats_store_.counter("dns_cache.hit").value());
+  EXPECT_EQ(0U, stats_store_.counter("dns_cache.prefetch").value());
+
+  EXPECT_NE(nullptr, resolver_->resolve(
+                         "some.good.domain", DnsLookupFamily::Auto,
+                         [&](const std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                           address_list = results;
+                           dispatcher_.exit();
+                         }));
+
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+  EXPECT_TRUE(hasAddress(address_list, "201.134.56.7"));
+  EXPECT_EQ(2U, stats_store_.counter("dns_cache.miss").value());
+  EXPECT_EQ(2U, stats_store_.gauge("dns_cache.size").value());
+}
+
+// Validate that the least recently used resolution is evicted from a full cache.
+TEST_P(DnsImplCacheTest, Eviction) {
+  server_->addHosts("a.good.domain", {"1.2.3.4"}, A);
+  server_->addHosts("b.good.domain", {"1.2.3.5"}, A);
+  server_->addHosts("c.good.domain", {"1.2.3.6"}, A);
+  server_->setTtl(std::chrono::seconds(300));
+  std::list<Address::InstanceConstSharedPtr> address_list;
+  for (const std::string name : {"a.good.domain", "b.good.domain", "a.good.domain",
+                                 "c.good.domain", "a.good.domain", "b.good.domain"}) {
+    // Cache hits complete synchronously, outside of the dispatcher loop.
+    bool pending = false;
+    address_list.clear();
+    if (resolver_->resolve(name, DnsLookupFamily::V4Only,
+                           [&](const std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                             address_list = results;
+                             if (pending) {
+                               dispatcher_.exit();
+                             }
+                           }) != nullptr) {
+      pending = true;
+      dispatcher_.run(Event::Dispatcher::RunType::Block);
+    }
+    EXPECT_EQ(1U, address_list.size());
+  }
+
+  EXPECT_EQ(2U, stats_store_.counter("dns_cache.hit").value());
+  EXPECT_EQ(4U, stats_store_.counter("dns_cache.miss").value());
+  EXPECT_EQ(2U, stats_store_.counter("dns_cache.eviction").value());
+  EXPECT_EQ(2U, stats_store_.gauge("dns_cache.size").value());
+}
+
+// Validate that records with a zero TTL, and failed resolutions, are not cached.
+TEST_P(DnsImplCacheTest, Uncacheable) {
+  server_->addHosts("some.good.domain", {"201.134.56.7"}, A);
+  std::list<Address::InstanceConstSharedPtr> address_list;
+  for (const std::string name : {"some.good.domain", "some.good.domain", "some.bad.domain",
+                                 "some.bad.domain"}) {
+    EXPECT_NE(nullptr, resolver_->resolve(
+                           name, DnsLookupFamily::V4Only,
+                           [&](const std::list<Address::InstanceConstSharedPtr>&& results) -> void {
+                             address_list = results;
+                             dispatcher_.exit();
+                           }));
+    dispatcher_.run(Event::Dispatcher::RunType::Block);
+  }
+
+  EXPECT_TRUE(address_list.empty());
+  EXPECT_EQ(0U, stats_store_.counter("dns_cache.hit").value());
+  EXPECT_EQ(4U, stats_store_.counter("dns_cache.miss").value());
+  EXPECT_EQ(0U, stats_store_.gauge("dns_cache.size").value());
+}
+
 // Validate that the resolution timeout timer is enabled if we don't resolve
 // immediately.
 TEST(DnsImplUnitTest, PendingTimerEnable) {
@@ -21,6 +21,17 @@ std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> lc_trie_nested_pref
 
 std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> lc_trie_minimal;
 
+std::vector<Envoy::Network::Address::InstanceConstSharedPtr> large_ipv4_addresses;
+
+std::vector<Envoy::Network::Address::InstanceConstSharedPtr> large_ipv6_addresses;
+
+std::unique_ptr<Envoy::Network::LcTrie::LcTrie<uint32_t>> lc_trie_large_ipv4;
+
+std::unique_ptr<Envoy::Network::LcTrie::LcTrie<uint32_t>> lc_trie_large_ipv6;
+
+// The number of prefixes in each of the large tables.
+constexpr uint32_t NumLargePrefixes = 100000;
+
 } // namespace
 
 namespace Envoy {
@@ -95,6 +106,58 @@ static void BM_LcTrieLookupMinimal(benchmark::State& state) {
 
 BENCHMARK(BM_LcTrieLookupMinimal);
 
+static void BM_LcTrieGetDataLargeIpv4(benchmark::State& state) {
+  static size_t i = 0;
+  size_t output_tags = 0;
+  for (auto _ : state) {
+    i++;
+    i %= large_ipv4_addresses.size();
+    output_tags += lc_trie_large_ipv4->getData(large_ipv4_addresses[i]).size();
+  }
+  benchmark::DoNotOptimize(output_tags);
+}
+
+BENCHMARK(BM_LcTrieGetDataLargeIpv4);
+
+static void BM_LcTrieLookupLargeIpv4(benchmark::State& state) {
+  static size_t i = 0;
+  size_t output_tags = 0;
+  for (auto _ : state) {
+    i++;
+    i %= large_ipv4_addresses.size();
+    output_tags += lc_trie_large_ipv4->lookup(large_ipv4_addresses[i]).size();
+  }
+  benchmark::DoNotOptimize(output_tags);
+}
+
+BENCHMARK(BM_LcTrieLookupLargeIpv4);
+
+static void BM_LcTrieGetDataLargeIpv6(benchmark::State& state) {
+  static size_t i = 0;
+  size_t output_tags = 0;
+  for (auto _ : state) {
+    i++;
+    i %= large_ipv6_addresses.size();
+    output_tags += lc_trie_large_ipv6->getData(large_ipv6_addresses[i]).size();
+  }
+  benchmark::DoNotOptimize(output_tags);
+}
+
+BENCHMARK(BM_LcTrieGetDataLargeIpv6);
+
+static void BM_LcTrieLookupLargeIpv6(benchmark::State& state) {
+  static size_t i = 0;
+  size_t output_tags = 0;
+  for (auto _ : state) {
+    i++;
+    i %= large_ipv6_addresses.size();
+    output_tags += lc_trie_large_ipv6->lookup(large_ipv6_addresses[i]).size();
+  }
+  benchmark::DoNotOptimize(output_tags);
+}
+
+BENCHMARK(BM_LcTrieLookupLargeIpv6);
+
 } // namespace Envoy
 
 // Boilerplate main(), which discovers benchmarks in the same file and runs them.
@@ -132,6 +195,39 @@ int main(int argc, char** argv) {
       std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(tag_data_nested_prefixes);
   lc_trie_minimal = std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(tag_data_minimal);
 
+  // Construct two large tables of scattered prefixes tagged by ID, such as routing tables: IPv4
+  // /24s and IPv6 /48s, under a catch all prefix of each version. Half of the test addresses are
+  // within one of the scattered prefixes.
+  std::vector<std::pair<uint32_t, std::vector<Envoy::Network::Address::CidrRange>>> large_ipv4;
+  std::vector<std::pair<uint32_t, std::vector<Envoy::Network::Address::CidrRange>>> large_ipv6;
+  for (uint32_t i = 0; i < NumLargePrefixes; i++) {
+    // Knuth's multiplicative hash spreads the prefixes over the address space.
+    const uint32_t bits = i * 2654435761u;
+    large_ipv4.push_back(
+        {i,
+         {Envoy::Network::Address::CidrRange::create(fmt::format(
+             "{}.{}.{}.0/24", (bits >> 24) & 0xff, (bits >> 16) & 0xff, (bits >> 8) & 0xff))}});
+    large_ipv6.push_back({i,
+                          {Envoy::Network::Address::CidrRange::create(fmt::format(
+                              "2001:{:x}:{:x}::/48", bits >> 16, bits & 0xffff))}});
+    if (i % 1000 == 0) {
+      large_ipv4_addresses.push_back(Envoy::Network::Utility::parseInternetAddress(
+          fmt::format("{}.{}.{}.7", (bits >> 24) & 0xff, (bits >> 16) & 0xff, (bits >> 8) & 0xff)));
+      large_ipv6_addresses.push_back(Envoy::Network::Utility::parseInternetAddress(
+          fmt::format("2001:{:x}:{:x}:ab::7", bits >> 16, bits & 0xffff)));
+      large_ipv4_addresses.push_back(Envoy::Network::Utility::parseInternetAddress(
+          fmt::format("{}.0.0.1", (i / 1000) % 256)));
+      large_ipv6_addresses.push_back(Envoy::Network::Utility::parseInternetAddress(
+          fmt::format("2002:{:x}::1", i / 1000)));
+    }
+  }
+  large_ipv4.push_back(
+      {NumLargePrefixes, {Envoy::Network::Address::CidrRange::create("0.0.0.0/0")}});
+  large_ipv6.push_back({NumLargePrefixes, {Envoy::Network::Address::CidrRange::create("::/0")}});
+
+  lc_trie_large_ipv4 = std::make_unique<Envoy::Network::LcTrie::LcTrie<uint32_t>>(large_ipv4);
+  lc_trie_large_ipv6 = std::make_unique<Envoy::Network::LcTrie::LcTrie<uint32_t>>(large_ipv6);
+
   benchmark::Initialize(&argc, argv);
   if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
     return 1;
@@ -322,6 +322,72 @@ TEST_F(LcTrieTest, ExclusiveNestedPrefixesWithCatchAll) {
   expectIPAndTags(test_case);
 }
 
+// IPv6 prefixes which end in either half of the address, or span both.
+TEST_F(LcTrieTest, Ipv6AcrossHalves) {
+  std::vector<std::vector<std::string>> cidr_range_strings = {
+      {"2001:db8:0:10::/60"},         // tag_0
+      {"2001:db8:0:20::/64"},         // tag_1
+      {"2001:db8:0:21:ff00::/72"},    // tag_2
+      {"2001:db8:0:21:1:2::/96"},     // tag_3
+      {"2001:db8:0:21:1:2:3:4/128"},  // tag_4
+      {"2001:db8:0:21:8000::/65"},    // tag_5
+      {"2001:db8:1::/48", "::1/128"}, // tag_6
+  };
+  setup(cidr_range_strings);
+
+  std::vector<std::pair<std::string, std::vector<std::string>>> test_case = {
+      {"2001:db8:0:1f::1", {"tag_0"}},
+      {"2001:db8:0:20:ffff::", {"tag_1"}},
+      {"2001:db8:0:21:ff12::", {"tag_2", "tag_5"}},
+      {"2001:db8:0:21:1:2:ffff:0", {"tag_3"}},
+      {"2001:db8:0:21:1:2:3:4", {"tag_3", "tag_4"}},
+      {"2001:db8:0:21:1:3::", {}},
+      {"2001:db8:0:21:c000::", {"tag_5"}},
+      {"2001:db8:1:ffff::", {"tag_6"}},
+      {"::1", {"tag_6"}},
+      {"::2", {}}};
+  expectIPAndTags(test_case);
+}
+
+// Lookups return the data of the trie rather than copies of it.
+TEST_F(LcTrieTest, Lookup) {
+  setup({{"10.0.0.0/8", "2001:db8::/32"}, {"10.1.0.0/16"}});
+
+  const std::vector<std::string>& data = trie_->lookup(Utility::parseInternetAddress("10.2.3.4"));
+  EXPECT_EQ(std::vector<std::string>{"tag_0"}, data);
+  EXPECT_EQ(&data, &trie_->lookup(Utility::parseInternetAddress("10.3.4.5")));
+
+  std::vector<std::string> nested(trie_->lookup(Utility::parseInternetAddress("10.1.2.3")));
+  std::sort(nested.begin(), nested.end());
+  EXPECT_EQ((std::vector<std::string>{"tag_0", "tag_1"}), nested);
+
+  EXPECT_EQ(std::vector<std::string>{"tag_0"},
+            trie_->lookup(Utility::parseInternetAddress("2001:db8::1")));
+  EXPECT_TRUE(trie_->lookup(Utility::parseInternetAddress("11.0.0.1")).empty());
+  EXPECT_TRUE(trie_->lookup(Utility::parseInternetAddress("2001:db9::1")).empty());
+}
+
+// Tries with 2^16 prefixes or more branch 16 ways at the root.
+TEST_F(LcTrieTest, LargeRootBranchingFactor) {
+  std::vector<std::vector<std::string>> cidr_range_strings;
+  for (uint32_t i = 0; i < (1 << 16); i++) {
+    cidr_range_strings.push_back({fmt::format("10.{}.{}.0/24", i >> 8, i & 0xff),
+                                  fmt::format("2001:db8:{:x}::/48", i)});
+  }
+  setup(cidr_range_strings);
+
+  std::vector<std::pair<std::string, std::vector<std::string>>> test_case = {
+      {"10.0.0.1", {"tag_0"}},
+      {"10.18.52.255", {"tag_4660"}},
+      {"10.255.255.0", {"tag_65535"}},
+      {"11.0.0.1", {}},
+      {"2001:db8::1", {"tag_0"}},
+      {"2001:db8:1234:ffff::", {"tag_4660"}},
+      {"2001:db8:ffff::", {"tag_65535"}},
+      {"2001:db9::", {}}};
+  expectIPAndTags(test_case);
+}
+
 // Ensure the trie will reject inputs that would cause it to exceed the maximum 2^20 nodes
 // when using the default fill factor.
 TEST_F(LcTrieTest, MaximumEntriesExceptionDefault) {
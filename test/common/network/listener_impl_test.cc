@@ -244,5 +244,29 @@ TEST_P(ListenerImplTest, WildcardListenerIpv4Compat) {
   dispatcher_.run(Event::Dispatcher::RunType::Block);
 }
 
+TEST_P(ListenerImplTest, DisableAndEnable) {
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(version_), nullptr,
+                                  true);
+  Network::MockListenerCallbacks listener_callbacks;
+  Network::TestListenerImpl listener(dispatcher_, socket, listener_callbacks, true, false);
+
+  // While disabled, the connection waits in the accept queue.
+  listener.disable();
+  Network::ClientConnectionPtr client_connection = dispatcher_.createClientConnection(
+      socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
+      Network::Test::createRawBufferSocket(), nullptr);
+  client_connection->connect();
+  EXPECT_CALL(listener_callbacks, onAccept_(_, _)).Times(0);
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+
+  listener.enable();
+  EXPECT_CALL(listener_callbacks, onAccept_(_, _))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr&, bool) -> void {
+        client_connection->close(ConnectionCloseType::NoFlush);
+        dispatcher_.exit();
+      }));
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+}
+
 } // namespace Network
 } // namespace Envoy
@@ -0,0 +1,166 @@
+#include <sys/socket.h>
+
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/network/address_impl.h"
+#include "common/network/listen_socket_impl.h"
+#include "common/network/udp_listener_impl.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/network_utility.h"
+#include "test/test_common/test_time.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/string_view.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class UdpListenerImplTest : public testing::TestWithParam<Address::IpVersion> {
+protected:
+  UdpListenerImplTest()
+      : dispatcher_(test_time_.timeSystem()),
+        socket_(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr, true),
+        client_socket_(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr, true),
+        listener_(dispatcher_.createUdpListener(socket_, listener_callbacks_)) {}
+
+  // Send a datagram from the client socket to the listener.
+  void sendFromClient(const std::string& data) {
+    iovec iov{const_cast<char*>(data.data()), data.size()};
+    EXPECT_EQ(static_cast<ssize_t>(data.size()),
+              socket_.localAddress()->sendTo(client_socket_.fd(), &iov, 1).rc_);
+  }
+
+  DangerousDeprecatedTestTime test_time_;
+  Event::DispatcherImpl dispatcher_;
+  UdpListenSocket socket_;
+  UdpListenSocket client_socket_;
+  MockUdpListenerCallbacks listener_callbacks_;
+  UdpListenerPtr listener_;
+};
+
+INSTANTIATE_TEST_CASE_P(IpVersions, UdpListenerImplTest,
+                        testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                        TestUtility::ipTestParamsToString);
+
+// Datagrams are delivered in order with the addresses of both ends, including those beyond the
+// first batch.
+TEST_P(UdpListenerImplTest, ReceiveBatches) {
+  const uint32_t num_datagrams = UdpBatchReader::MAX_BATCH_SIZE + 3;
+  for (uint32_t i = 0; i < num_datagrams; ++i) {
+    sendFromClient(std::to_string(i));
+  }
+
+  uint32_t received = 0;
+  EXPECT_CALL(listener_callbacks_, onData_(_))
+      .Times(num_datagrams)
+      .WillRepeatedly(Invoke([&](UdpRecvData& data) -> void {
+        EXPECT_EQ(std::to_string(received), data.buffer_->toString());
+        EXPECT_EQ(socket_.localAddress()->asString(), data.local_address_->asString());
+        EXPECT_EQ(client_socket_.localAddress()->asString(), data.peer_address_->asString());
+        if (++received == num_datagrams) {
+          dispatcher_.exit();
+        }
+      }));
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+}
+
+// Datagrams larger than the receive buffer are dropped rather than delivered truncated.
+TEST_P(UdpListenerImplTest, DropTruncated) {
+  sendFromClient(std::string(UdpBatchReader::MAX_DATAGRAM_SIZE + 1, 'a'));
+  sendFromClient("hello");
+
+  EXPECT_CALL(listener_callbacks_, onData_(_)).WillOnce(Invoke([&](UdpRecvData& data) -> void {
+    EXPECT_EQ("hello", data.buffer_->toString());
+    dispatcher_.exit();
+  }));
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+}
+
+// No datagrams are delivered while the listener is disabled.
+TEST_P(UdpListenerImplTest, DisableEnable) {
+  listener_->disable();
+  sendFromClient("hello");
+  EXPECT_CALL(listener_callbacks_, onData_(_)).Times(0);
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+
+  listener_->enable();
+  EXPECT_CALL(listener_callbacks_, onData_(_)).WillOnce(Invoke([&](UdpRecvData& data) -> void {
+    EXPECT_EQ("hello", data.buffer_->toString());
+    dispatcher_.exit();
+  }));
+  dispatcher_.run(Event::Dispatcher::RunType::Block);
+}
+
+// The batch callback follows the datagrams of each batch, which are still valid at that point.
+TEST_P(UdpListenerImplTest, BatchDone) {
+  listener_.reset();
+  sendFromClient("hello");
+  sendFromClient("world");
+
+  std::vector<absl::string_view> batch;
+  std::vector<std::string> flushed;
+  UdpBatchReader reader;
+  reader.read(
+      socket_.fd(),
+      [&](const char* data, uint64_t size, const sockaddr_storage&, socklen_t) {
+        batch.emplace_back(data, size);
+      },
+      [&]() {
+        EXPECT_FALSE(batch.empty());
+        for (const absl::string_view datagram : batch) {
+          flushed.emplace_back(datagram);
+        }
+        batch.clear();
+      });
+  EXPECT_TRUE(batch.empty());
+  EXPECT_EQ(std::vector<std::string>({"hello", "world"}), flushed);
+}
+
+// A reply is sent from the listener's socket, and the buffer is drained.
+TEST_P(UdpListenerImplTest, Send) {
+  Buffer::OwnedImpl data("hello");
+  data.add(" world");
+  EXPECT_EQ(11, listener_->send(*client_socket_.localAddress(), data).rc_);
+  EXPECT_EQ(0, data.length());
+
+  char received[16];
+  sockaddr_storage peer_address;
+  socklen_t peer_address_length = sizeof(peer_address);
+  const ssize_t rc = ::recvfrom(client_socket_.fd(), received, sizeof(received), 0,
+                                reinterpret_cast<sockaddr*>(&peer_address), &peer_address_length);
+  ASSERT_EQ(11, rc);
+  EXPECT_EQ("hello world", std::string(received, rc));
+  EXPECT_EQ(socket_.localAddress()->asString(),
+            Address::addressFromSockAddr(peer_address, peer_address_length)->asString());
+}
+
+// A batch of datagrams is sent in order from the listener's socket.
+TEST_P(UdpListenerImplTest, SendBatch) {
+  const std::string first = "hello";
+  const std::string second = "world";
+  const Buffer::RawSlice datagrams[] = {{const_cast<char*>(first.data()), first.size()},
+                                        {const_cast<char*>(second.data()), second.size()}};
+  EXPECT_EQ(2, listener_->sendBatch(*client_socket_.localAddress(), datagrams, 2).rc_);
+
+  char received[16];
+  ssize_t rc = ::recv(client_socket_.fd(), received, sizeof(received), 0);
+  EXPECT_EQ("hello", std::string(received, rc));
+  rc = ::recv(client_socket_.fd(), received, sizeof(received), 0);
+  EXPECT_EQ("world", std::string(received, rc));
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
@@ -60,6 +60,12 @@ TEST(NetworkUtility, resolveUrl) {
   EXPECT_EQ("[1::2:3]:4", Utility::resolveUrl("tcp://[1::2:3]:4")->asString());
   EXPECT_EQ("[a::1]:0", Utility::resolveUrl("tcp://[a::1]:0")->asString());
   EXPECT_EQ("[a:b:c:d::]:0", Utility::resolveUrl("tcp://[a:b:c:d::]:0")->asString());
+
+  EXPECT_THROW(Utility::resolveUrl("udp://127.0.0.1"), EnvoyException);
+  EXPECT_EQ("1.2.3.4:1234", Utility::resolveUrl("udp://1.2.3.4:1234")->asString());
+  EXPECT_EQ("[::1]:1", Utility::resolveUrl("udp://[::1]:1")->asString());
+  EXPECT_TRUE(Utility::urlIsUdpScheme("udp://1.2.3.4:1234"));
+  EXPECT_FALSE(Utility::urlIsUdpScheme("tcp://1.2.3.4:1234"));
 }
 
 TEST(NetworkUtility, ParseInternetAddress) {
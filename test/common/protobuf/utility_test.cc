@@ -1,5 +1,6 @@
 #include <unordered_set>
 
+#include "envoy/api/v2/cds.pb.h"
 #include "envoy/config/bootstrap/v2/bootstrap.pb.h"
 #include "envoy/config/bootstrap/v2/bootstrap.pb.validate.h"
 
@@ -242,6 +243,27 @@ TEST(UtilityTest, AnyConvertWrongFields) {
                             "Protobuf message (type google.protobuf.Timestamp) has unknown fields");
 }
 
+// Messages can be unpacked in place, e.g. onto an arena which then owns their fields.
+TEST(UtilityTest, UnpackToArena) {
+  envoy::api::v2::Cluster cluster;
+  cluster.set_name("foo");
+  cluster.mutable_connect_timeout()->set_seconds(1);
+  ProtobufWkt::Any source_any;
+  source_any.PackFrom(cluster);
+
+  Protobuf::Arena arena;
+  envoy::api::v2::Cluster* arena_cluster =
+      Protobuf::Arena::CreateMessage<envoy::api::v2::Cluster>(&arena);
+  MessageUtil::unpackTo(source_any, *arena_cluster);
+  EXPECT_EQ(&arena, arena_cluster->GetArena());
+  EXPECT_EQ(&arena, arena_cluster->connect_timeout().GetArena());
+  EXPECT_TRUE(Protobuf::util::MessageDifferencer::Equals(cluster, *arena_cluster));
+
+  ProtobufWkt::Timestamp timestamp;
+  EXPECT_THROW_WITH_REGEX(MessageUtil::unpackTo(source_any, timestamp), EnvoyException,
+                          "Unable to unpack .*");
+}
+
 TEST(UtilityTest, JsonConvertSuccess) {
   ProtobufWkt::Duration source_duration;
   source_duration.set_seconds(42);
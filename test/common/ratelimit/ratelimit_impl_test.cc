@@ -89,7 +89,8 @@ TEST_P(RateLimitGrpcClientTest, Basic) {
               return &async_request_;
             }));
 
-    client_->limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, Tracing::NullSpan::instance());
+    client_->limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, 1,
+                   Tracing::NullSpan::instance());
 
     client_->onCreateInitialMetadata(headers);
     EXPECT_EQ(nullptr, headers.RequestId());
@@ -108,7 +109,7 @@ TEST_P(RateLimitGrpcClientTest, Basic) {
     EXPECT_CALL(*async_client_, send(_, ProtoEq(request), _, _, _))
         .WillOnce(Return(&async_request_));
 
-    client_->limit(request_callbacks_, "foo", {{{{"foo", "bar"}, {"bar", "baz"}}}},
+    client_->limit(request_callbacks_, "foo", {{{{"foo", "bar"}, {"bar", "baz"}}}}, 1,
                    Tracing::NullSpan::instance());
 
     client_->onCreateInitialMetadata(headers);
@@ -129,7 +130,7 @@ TEST_P(RateLimitGrpcClientTest, Basic) {
         .WillOnce(Return(&async_request_));
 
     client_->limit(request_callbacks_, "foo",
-                   {{{{"foo", "bar"}, {"bar", "baz"}}}, {{{"foo2", "bar2"}, {"bar2", "baz2"}}}},
+                   {{{{"foo", "bar"}, {"bar", "baz"}}}, {{{"foo2", "bar2"}, {"bar2", "baz2"}}}}, 1,
                    Tracing::NullSpan::instance());
 
     response.reset(new envoy::service::ratelimit::v2::RateLimitResponse());
@@ -138,13 +139,27 @@ TEST_P(RateLimitGrpcClientTest, Basic) {
   }
 }
 
+TEST_P(RateLimitGrpcClientTest, HitsAddend) {
+  setClient(GetParam());
+
+  envoy::service::ratelimit::v2::RateLimitRequest request;
+  GrpcClientImpl::createRequest(request, "foo", {{{{"foo", "bar"}}}}, 5);
+  EXPECT_EQ(5U, request.hits_addend());
+  EXPECT_CALL(*async_client_, send(_, ProtoEq(request), _, _, _))
+      .WillOnce(Return(&async_request_));
+  client_->limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, 5, Tracing::NullSpan::instance());
+
+  EXPECT_CALL(async_request_, cancel());
+  client_->cancel();
+}
+
 TEST_P(RateLimitGrpcClientTest, Cancel) {
   setClient(GetParam());
   std::unique_ptr<envoy::service::ratelimit::v2::RateLimitResponse> response;
 
   EXPECT_CALL(*async_client_, send(_, _, _, _, _)).WillOnce(Return(&async_request_));
 
-  client_->limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, Tracing::NullSpan::instance());
+  client_->limit(request_callbacks_, "foo", {{{{"foo", "bar"}}}}, 1, Tracing::NullSpan::instance());
 
   EXPECT_CALL(async_request_, cancel());
   client_->cancel();
@@ -186,7 +201,7 @@ TEST(RateLimitNullFactoryTest, Basic) {
   ClientPtr client = factory.create(absl::optional<std::chrono::milliseconds>());
   MockRequestCallbacks request_callbacks;
   EXPECT_CALL(request_callbacks, complete_(LimitStatus::OK, _));
-  client->limit(request_callbacks, "foo", {{{{"foo", "bar"}}}}, Tracing::NullSpan::instance());
+  client->limit(request_callbacks, "foo", {{{{"foo", "bar"}}}}, 1, Tracing::NullSpan::instance());
   client->cancel();
 }
 
@@ -166,5 +166,44 @@ TEST_F(FilterStateImplTest, HasData) {
   EXPECT_FALSE(filter_state().hasDataWithName("test_2"));
 }
 
+TEST_F(FilterStateImplTest, RegisteredKeys) {
+  const FilterState::Key& key_1 = FilterStateKeys::registerKey("test.key_1");
+  const FilterState::Key& key_2 = FilterStateKeys::registerKey("test.key_2");
+  EXPECT_EQ(&key_1, &FilterStateKeys::registerKey("test.key_1"));
+  EXPECT_EQ(&key_1, FilterStateKeys::find("test.key_1"));
+  EXPECT_EQ(nullptr, FilterStateKeys::find("test.unregistered"));
+  EXPECT_EQ("test.key_2", key_2.name());
+  EXPECT_NE(key_1.slot(), key_2.slot());
+
+  filter_state().setData(key_2, std::make_unique<SimpleType>(2));
+  EXPECT_FALSE(filter_state().hasDataWithKey(key_1));
+  EXPECT_TRUE(filter_state().hasData<SimpleType>(key_2));
+  EXPECT_FALSE(filter_state().hasData<TestStoredTypeTracking>(key_2));
+  EXPECT_EQ(2, filter_state().getData<SimpleType>(key_2).access());
+  EXPECT_THROW_WITH_MESSAGE(filter_state().getData<SimpleType>(key_1), EnvoyException,
+                            "FilterState::getData<T> called for unknown data name.");
+  EXPECT_THROW_WITH_MESSAGE(filter_state().getData<TestStoredTypeTracking>(key_2),
+                            EnvoyException,
+                            "Data stored under test.key_2 cannot be coerced to specified type");
+  EXPECT_THROW_WITH_MESSAGE(filter_state().setData(key_2, std::make_unique<SimpleType>(3)),
+                            EnvoyException, "FilterState::setData<T> called twice with same name.");
+}
+
+// Data stored under a registered key is also accessible by its name, and the other way around.
+TEST_F(FilterStateImplTest, RegisteredKeyByName) {
+  const FilterState::Key& key = FilterStateKeys::registerKey("test.key_by_name");
+
+  filter_state().setData("test.key_by_name", std::make_unique<SimpleType>(1));
+  EXPECT_TRUE(filter_state().hasDataWithKey(key));
+  EXPECT_EQ(1, filter_state().getData<SimpleType>(key).access());
+  EXPECT_THROW_WITH_MESSAGE(filter_state().setData(key, std::make_unique<SimpleType>(2)),
+                            EnvoyException, "FilterState::setData<T> called twice with same name.");
+
+  resetFilterState();
+  filter_state().setData(key, std::make_unique<SimpleType>(3));
+  EXPECT_TRUE(filter_state().hasDataWithName("test.key_by_name"));
+  EXPECT_EQ(3, filter_state().getData<SimpleType>("test.key_by_name").access());
+}
+
 } // namespace RequestInfo
 } // namespace Envoy
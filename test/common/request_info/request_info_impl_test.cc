@@ -153,6 +153,33 @@ TEST(RequestInfoImplTest, MiscSettersAndGetters) {
   }
 }
 
+// The rarely set fields read as unset until one of them is set, and the rest of the request info,
+// including the upstream timings set by every proxied request, stays within a few cache lines.
+TEST(RequestInfoImplTest, RareFields) {
+  EXPECT_LE(sizeof(RequestInfoImpl), 4 * 64);
+
+  RequestInfoImpl request_info(Http::Protocol::Http2);
+  const RequestInfoImpl& const_request_info = request_info;
+  request_info.resetUpstreamTimings();
+  request_info.setRequestedServerName("");
+  EXPECT_EQ(nullptr, request_info.upstreamLocalAddress());
+  EXPECT_EQ(0, request_info.dynamicMetadata().filter_metadata_size());
+  EXPECT_FALSE(const_request_info.perRequestState().hasDataWithName("test"));
+  EXPECT_EQ("", request_info.requestedServerName());
+
+  request_info.onFirstUpstreamTxByteSent();
+  EXPECT_TRUE(request_info.firstUpstreamTxByteSent());
+  EXPECT_FALSE(request_info.lastUpstreamTxByteSent());
+  EXPECT_FALSE(request_info.firstUpstreamRxByteReceived());
+  EXPECT_EQ(nullptr, request_info.upstreamLocalAddress());
+  EXPECT_EQ("", request_info.requestedServerName());
+  request_info.resetUpstreamTimings();
+  EXPECT_FALSE(request_info.firstUpstreamTxByteSent());
+
+  request_info.perRequestState().setData("test", std::make_unique<TestIntAccessor>(1));
+  EXPECT_TRUE(const_request_info.perRequestState().hasDataWithName("test"));
+}
+
 TEST(RequestInfoImplTest, DynamicMetadataTest) {
   RequestInfoImpl request_info(Http::Protocol::Http2);
   EXPECT_EQ(0, request_info.dynamicMetadata().filter_metadata_size());
@@ -253,7 +253,7 @@ TEST(RouteMatcherTest, TestRoutes) {
         {"pattern": "^/rides$", "method": "POST", "name": "ride_request"},
         {"pattern": "^/rides/\\d+$", "method": "PUT", "name": "update_ride"},
         {"pattern": "^/users/\\d+/chargeaccounts$", "method": "POST", "name": "cc_add"},
-        {"pattern": "^/users/\\d+/chargeaccounts/(?!validate)\\w+$", "method": "PUT",
+        {"pattern": "^/users/\\d+/chargeaccounts/[a-z]+\\d+$", "method": "PUT",
          "name": "cc_add"},
         {"pattern": "^/users$", "method": "POST", "name": "create_user_login"},
         {"pattern": "^/users/\\d+$", "method": "PUT", "name": "update_user"},
@@ -560,6 +560,73 @@ virtual_hosts:
             config.route(genHeaders("example.com", "/", "GET"), 0)->routeEntry()->clusterName());
 }
 
+// Virtual hosts built on demand are held up to the configured limit, and their routes stay valid
+// after they are released.
+TEST(RouteMatcherTest, VirtualHostsBuiltOnDemand) {
+  std::string yaml = R"EOF(
+max_virtual_hosts_built_on_demand: 1
+virtual_hosts:
+  - name: foo
+    domains: ["foo.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "foo" }
+  - name: wildcard
+    domains: ["*.bar.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "bar" }
+  - name: websocket
+    domains: ["ws.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "ws", use_websocket: true }
+  - name: default
+    domains: ["*"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "default" }
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, false);
+  EXPECT_EQ(0, config.numVirtualHostsBuiltOnDemand());
+
+  RouteConstSharedPtr foo = config.route(genHeaders("foo.com", "/", "GET"), 0);
+  EXPECT_EQ("foo", foo->routeEntry()->clusterName());
+  EXPECT_EQ(1, config.numVirtualHostsBuiltOnDemand());
+  EXPECT_EQ("foo", config.route(genHeaders("foo.com", "/", "GET"), 0)->routeEntry()->clusterName());
+
+  EXPECT_EQ("bar",
+            config.route(genHeaders("www.bar.com", "/", "GET"), 0)->routeEntry()->clusterName());
+  EXPECT_EQ("default",
+            config.route(genHeaders("example.com", "/", "GET"), 0)->routeEntry()->clusterName());
+  EXPECT_EQ(1, config.numVirtualHostsBuiltOnDemand());
+  EXPECT_EQ("foo", foo->routeEntry()->virtualHost().name());
+
+  // Virtual hosts with WebSocket routes are built with the route table.
+  EXPECT_EQ("ws", config.route(genHeaders("ws.com", "/", "GET"), 0)->routeEntry()->clusterName());
+  EXPECT_EQ("default", config.route(genHeaders("example.com", "/", "GET"), 0)
+                           ->routeEntry()
+                           ->virtualHost()
+                           .name());
+  EXPECT_EQ(1, config.numVirtualHostsBuiltOnDemand());
+
+  // Virtual hosts built on demand are still validated with the route table.
+  const std::string invalid_yaml = R"EOF(
+max_virtual_hosts_built_on_demand: 1
+virtual_hosts:
+  - name: regex
+    domains: ["*"]
+    routes:
+      - match: { regex: "/(+invalid)" }
+        route: { cluster: "regex" }
+  )EOF";
+  EXPECT_THROW_WITH_REGEX(
+      TestConfigImpl(parseRouteConfigurationFromV2Yaml(invalid_yaml), factory_context, true),
+      EnvoyException, "Invalid regex '/\\(\\+invalid\\)':");
+}
+
 TEST(RouteMatcherTest, TestRoutesWithInvalidRegex) {
   std::string invalid_route = R"EOF(
 virtual_hosts:
@@ -1944,6 +2011,50 @@ TEST(RouteMatcherTest, Runtime) {
             config.route(genHeaders("www.lyft.com", "/", "GET"), 20)->routeEntry()->clusterName());
 }
 
+// Validate that first match ordering is preserved across path match types and case sensitivity.
+TEST(RouteMatcherTest, FirstMatchAcrossPathMatchTypes) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: www2
+    domains: ["www.lyft.com"]
+    routes:
+      - match:
+          prefix: "/foo"
+          headers:
+            - name: x-foo
+              exact_match: bar
+        route: { cluster: header }
+      - match: { regex: "/foo/b.*" }
+        route: { cluster: regex }
+      - match: { path: "/FOO/BAZ", case_sensitive: false }
+        route: { cluster: exact_insensitive }
+      - match: { prefix: "/foo/", case_sensitive: true }
+        route: { cluster: prefix }
+      - match: { path: "/foo/qux" }
+        route: { cluster: shadowed_exact }
+      - match: { prefix: "/" }
+        route: { cluster: default }
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, true);
+
+  auto cluster = [&config](const std::string& path) -> std::string {
+    return config.route(genHeaders("www.lyft.com", path, "GET"), 0)->routeEntry()->clusterName();
+  };
+  EXPECT_EQ("regex", cluster("/foo/bar"));
+  EXPECT_EQ("regex", cluster("/foo/baz"));
+  EXPECT_EQ("exact_insensitive", cluster("/Foo/Baz"));
+  EXPECT_EQ("exact_insensitive", cluster("/foo/BAZ?a=b"));
+  EXPECT_EQ("prefix", cluster("/foo/qux"));
+  EXPECT_EQ("default", cluster("/Foo/qux"));
+  EXPECT_EQ("default", cluster("/fo"));
+
+  Http::TestHeaderMapImpl headers = genHeaders("www.lyft.com", "/foo/bar", "GET");
+  headers.addCopy("x-foo", "bar");
+  EXPECT_EQ("header", config.route(headers, 0)->routeEntry()->clusterName());
+}
+
 TEST(RouteMatcherTest, ShadowClusterNotFound) {
   std::string json = R"EOF(
 {
@@ -3888,6 +3999,16 @@ TEST(MetadataMatchCriteriaImpl, Merge) {
 
   EXPECT_EQ((*it)->name(), "c");
   EXPECT_EQ((*it)->value().value().string_value(), "override3");
+
+  // The merged criteria hash the same as equivalent criteria built directly.
+  auto merged_struct = ProtobufWkt::Struct();
+  auto merged_fields = merged_struct.mutable_fields();
+  merged_fields->insert({"a", v1});
+  merged_fields->insert({"b", pv2});
+  merged_fields->insert({"b++", v2});
+  merged_fields->insert({"c", v3});
+  EXPECT_EQ(MetadataMatchCriteriaImpl(merged_struct).hash(), matches->hash());
+  EXPECT_NE(parent_matches.hash(), matches->hash());
 }
 
 TEST(RouteEntryMetadataMatchTest, ParsesMetadata) {
@@ -4608,6 +4729,33 @@ virtual_hosts:
   EXPECT_EQ(7 * 1000, route_entry->idleTimeout().value().count());
 }
 
+TEST(RouteConfigurationV2, RetryShadowBufferLimit) {
+  const std::string yaml = R"EOF(
+name: RetryShadowBufferLimit
+virtual_hosts:
+  - name: limits
+    domains: [limit.lyft.com]
+    routes:
+      - match: { prefix: "/limited"}
+        route:
+          cluster: some-cluster
+          retry_shadow_buffer_limit_bytes: 1024
+      - match: { prefix: "/"}
+        route:
+          cluster: some-cluster
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, true);
+  EXPECT_EQ(1024U, config.route(genHeaders("limit.lyft.com", "/limited", "GET"), 0)
+                       ->routeEntry()
+                       ->retryShadowBufferLimit()
+                       .value());
+  EXPECT_EQ(absl::nullopt, config.route(genHeaders("limit.lyft.com", "/", "GET"), 0)
+                               ->routeEntry()
+                               ->retryShadowBufferLimit());
+}
+
 class PerFilterConfigsTest : public testing::Test {
 public:
   PerFilterConfigsTest()
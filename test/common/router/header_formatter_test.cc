@@ -761,5 +761,73 @@ route:
             header_map.get_("x-request-start-range"));
 }
 
+// Values without variables are added as constants, with escaped percent signs unescaped.
+TEST(HeaderParserTest, EvaluateEscapedStaticHeaders) {
+  const std::string yaml = R"EOF(
+match: { prefix: "/new_endpoint" }
+route:
+  cluster: www2
+  request_headers_to_add:
+    - header:
+        key: "x-percent"
+        value: "100%% static"
+      append: false
+)EOF";
+
+  HeaderParserPtr req_header_parser =
+      HeaderParser::configure(parseRouteFromV2Yaml(yaml).route().request_headers_to_add());
+  Http::TestHeaderMapImpl header_map{{":method", "POST"}, {"x-percent", "old"}};
+  NiceMock<Envoy::RequestInfo::MockRequestInfo> request_info;
+  req_header_parser->evaluateHeaders(header_map, request_info);
+  EXPECT_EQ("100% static", header_map.get_("x-percent"));
+  EXPECT_EQ(2UL, header_map.size());
+}
+
+// A merged parser applies the operations of the parsers in turn, and outlives them.
+TEST(HeaderParserTest, Merge) {
+  const std::string first_yaml = R"EOF(
+match: { prefix: "/" }
+route:
+  cluster: www2
+  response_headers_to_add:
+    - header:
+        key: "x-first"
+        value: "first"
+    - header:
+        key: "x-client-ip"
+        value: "%DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT%"
+  response_headers_to_remove: ["x-second", "x-old"]
+)EOF";
+  const std::string second_yaml = R"EOF(
+match: { prefix: "/" }
+route:
+  cluster: www2
+  response_headers_to_add:
+    - header:
+        key: "x-second"
+        value: "second"
+  response_headers_to_remove: ["x-first"]
+)EOF";
+
+  HeaderParserPtr merged;
+  {
+    const auto first = parseRouteFromV2Yaml(first_yaml).route();
+    const auto second = parseRouteFromV2Yaml(second_yaml).route();
+    HeaderParserPtr first_parser = HeaderParser::configure(first.response_headers_to_add(),
+                                                           first.response_headers_to_remove());
+    HeaderParserPtr second_parser = HeaderParser::configure(second.response_headers_to_add(),
+                                                            second.response_headers_to_remove());
+    merged = HeaderParser::merge({first_parser.get(), second_parser.get()});
+  }
+
+  Http::TestHeaderMapImpl header_map{{":status", "200"}, {"x-old", "old"}};
+  NiceMock<Envoy::RequestInfo::MockRequestInfo> request_info;
+  merged->evaluateHeaders(header_map, request_info);
+  EXPECT_FALSE(header_map.has("x-first"));
+  EXPECT_FALSE(header_map.has("x-old"));
+  EXPECT_EQ("second", header_map.get_("x-second"));
+  EXPECT_TRUE(header_map.has("x-client-ip"));
+}
+
 } // namespace Router
 } // namespace Envoy
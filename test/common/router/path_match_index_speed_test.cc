@@ -0,0 +1,84 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+#include <vector>
+
+#include "common/common/utility.h"
+#include "common/router/path_match_index.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Router {
+
+// Generate range(0) prefix routes, one per service, followed by a catch-all. The request matches
+// the last service route, which is the worst case for a linear scan.
+static std::vector<PathMatchIndex::Entry> makeEntries(benchmark::State& state) {
+  std::vector<PathMatchIndex::Entry> entries;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    entries.push_back({PathMatchType::Prefix, "/api/v1/service" + std::to_string(i) + "/", true});
+  }
+  entries.push_back({PathMatchType::Prefix, "/", true});
+  return entries;
+}
+
+static std::string makePath(benchmark::State& state) {
+  return "/api/v1/service" + std::to_string(state.range(0) - 1) + "/users/1234?limit=10";
+}
+
+// Baseline: test the prefix of every route in order, as VirtualHostImpl did without the index.
+static void BM_LinearPrefixMatch(benchmark::State& state) {
+  const std::vector<PathMatchIndex::Entry> entries = makeEntries(state);
+  const std::string path = makePath(state);
+  size_t matched = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < entries.size(); i++) {
+      if (StringUtil::startsWith(path.c_str(), entries[i].matcher_, true)) {
+        matched += i;
+        break;
+      }
+    }
+  }
+  benchmark::DoNotOptimize(matched);
+}
+BENCHMARK(BM_LinearPrefixMatch)->Arg(10)->Arg(100)->Arg(1000)->Arg(3000);
+
+static void BM_IndexedPrefixMatch(benchmark::State& state) {
+  const std::vector<PathMatchIndex::Entry> entries = makeEntries(state);
+  const PathMatchIndex index(entries);
+  const std::string path = makePath(state);
+  size_t matched = 0;
+  for (auto _ : state) {
+    index.forEachCandidate(path, [&](uint32_t i) -> bool {
+      if (StringUtil::startsWith(path.c_str(), entries[i].matcher_, true)) {
+        matched += i;
+        return true;
+      }
+      return false;
+    });
+  }
+  benchmark::DoNotOptimize(matched);
+}
+BENCHMARK(BM_IndexedPrefixMatch)->Arg(10)->Arg(100)->Arg(1000)->Arg(3000);
+
+static void BM_IndexConstruct(benchmark::State& state) {
+  const std::vector<PathMatchIndex::Entry> entries = makeEntries(state);
+  for (auto _ : state) {
+    PathMatchIndex index(entries);
+    benchmark::DoNotOptimize(&index);
+  }
+}
+BENCHMARK(BM_IndexConstruct)->Arg(10)->Arg(3000);
+
+} // namespace Router
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
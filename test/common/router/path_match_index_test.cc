@@ -0,0 +1,83 @@
+#include <string>
+#include <vector>
+
+#include "common/router/path_match_index.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+std::vector<uint32_t> candidates(const PathMatchIndex& index, const std::string& path) {
+  std::vector<uint32_t> result;
+  index.forEachCandidate(path, [&result](uint32_t i) -> bool {
+    result.push_back(i);
+    return false;
+  });
+  return result;
+}
+
+TEST(PathMatchIndexTest, Empty) {
+  PathMatchIndex index({});
+  EXPECT_EQ(std::vector<uint32_t>{}, candidates(index, "/"));
+  EXPECT_EQ(std::vector<uint32_t>{}, candidates(index, ""));
+}
+
+TEST(PathMatchIndexTest, CandidatesInRouteOrder) {
+  PathMatchIndex index({
+      {PathMatchType::Prefix, "/foo/bar", true},  // 0
+      {PathMatchType::Exact, "/foo", true},       // 1
+      {PathMatchType::Regex, "/b.*", true},       // 2
+      {PathMatchType::Prefix, "/FOO", false},     // 3
+      {PathMatchType::Prefix, "/foo", true},      // 4
+      {PathMatchType::Exact, "/foo/bar", false},  // 5
+      {PathMatchType::Prefix, "/", true},         // 6
+      {PathMatchType::Prefix, "", true},          // 7
+      {PathMatchType::Exact, "/Foo", true},       // 8
+  });
+
+  EXPECT_EQ((std::vector<uint32_t>{1, 2, 3, 4, 6, 7}), candidates(index, "/foo"));
+  EXPECT_EQ((std::vector<uint32_t>{1, 2, 3, 4, 6, 7}), candidates(index, "/foo?a=b"));
+  EXPECT_EQ((std::vector<uint32_t>{0, 2, 3, 4, 5, 6, 7}), candidates(index, "/foo/bar"));
+  EXPECT_EQ((std::vector<uint32_t>{0, 2, 3, 4, 6, 7}), candidates(index, "/foo/bar/baz"));
+  EXPECT_EQ((std::vector<uint32_t>{2, 3, 5, 6, 7}), candidates(index, "/FOO/BAR"));
+  EXPECT_EQ((std::vector<uint32_t>{2, 3, 6, 7, 8}), candidates(index, "/Foo"));
+  EXPECT_EQ((std::vector<uint32_t>{2, 6, 7}), candidates(index, "/fo"));
+  EXPECT_EQ((std::vector<uint32_t>{2, 7}), candidates(index, "foo"));
+  // Prefix routes match against the query string as well.
+  EXPECT_EQ((std::vector<uint32_t>{2, 6, 7}), candidates(index, "/?/foo/bar"));
+}
+
+TEST(PathMatchIndexTest, StopsAtFirstMatch) {
+  PathMatchIndex index({
+      {PathMatchType::Prefix, "/", true},
+      {PathMatchType::Prefix, "/foo", true},
+      {PathMatchType::Prefix, "/foo/bar", true},
+  });
+
+  std::vector<uint32_t> visited;
+  EXPECT_TRUE(index.forEachCandidate("/foo/bar", [&visited](uint32_t i) -> bool {
+    visited.push_back(i);
+    return i == 1;
+  }));
+  EXPECT_EQ((std::vector<uint32_t>{0, 1}), visited);
+
+  EXPECT_FALSE(index.forEachCandidate("/bar", [](uint32_t) -> bool { return false; }));
+}
+
+TEST(PathMatchIndexTest, DuplicateMatchers) {
+  PathMatchIndex index({
+      {PathMatchType::Prefix, "/foo", true},
+      {PathMatchType::Exact, "/foo", true},
+      {PathMatchType::Prefix, "/foo", true},
+      {PathMatchType::Exact, "/foo", true},
+  });
+
+  EXPECT_EQ((std::vector<uint32_t>{0, 1, 2, 3}), candidates(index, "/foo"));
+  EXPECT_EQ((std::vector<uint32_t>{0, 2}), candidates(index, "/foo/"));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
@@ -540,6 +540,8 @@ virtual_hosts:
   EXPECT_EQ(&dynamic_cast<RdsRouteConfigProviderImpl&>(*provider_).subscription(),
             &dynamic_cast<RdsRouteConfigProviderImpl&>(*provider2).subscription());
   EXPECT_EQ(&provider_->configInfo().value().config_, &provider2->configInfo().value().config_);
+  // The providers share the route table.
+  EXPECT_EQ(provider_->config(), provider2->config());
 
   std::string config_json2 = R"EOF(
     {
@@ -567,6 +569,9 @@ virtual_hosts:
   dynamic_cast<RdsRouteConfigProviderImpl&>(*provider3)
       .subscription()
       .onConfigUpdate(route_configs, "provider3");
+  // The route configuration has the same content, so the route table is shared across
+  // subscriptions.
+  EXPECT_EQ(provider_->config(), provider3->config());
 
   EXPECT_EQ(2UL,
             route_config_provider_manager_->dumpRouteConfigs()->dynamic_route_configs().size());
@@ -589,6 +594,68 @@ virtual_hosts:
             route_config_provider_manager_->dumpRouteConfigs()->dynamic_route_configs().size());
 }
 
+TEST_F(RouteConfigProviderManagerImplTest, StaticSharedRouteTable) {
+  const auto route_config = parseRouteConfigurationFromV2Yaml(R"EOF(
+name: foo
+virtual_hosts:
+  - name: bar
+    domains: ["*"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: baz }
+)EOF");
+  ON_CALL(factory_context_, timeSource()).WillByDefault(ReturnRef(time_source_));
+
+  RouteConfigProviderPtr provider1 =
+      route_config_provider_manager_->createStaticRouteConfigProvider(route_config,
+                                                                      factory_context_);
+  RouteConfigProviderPtr provider2 =
+      route_config_provider_manager_->createStaticRouteConfigProvider(route_config,
+                                                                      factory_context_);
+  EXPECT_EQ(provider1->config(), provider2->config());
+
+  // A route configuration with other content has its own route table.
+  auto other_route_config = route_config;
+  other_route_config.set_name("other");
+  RouteConfigProviderPtr provider3 =
+      route_config_provider_manager_->createStaticRouteConfigProvider(other_route_config,
+                                                                      factory_context_);
+  EXPECT_NE(provider1->config(), provider3->config());
+  EXPECT_EQ("other", provider3->config()->name());
+
+  // Once released, the route table is built again.
+  provider1.reset();
+  provider2.reset();
+  RouteConfigProviderPtr provider4 =
+      route_config_provider_manager_->createStaticRouteConfigProvider(route_config,
+                                                                      factory_context_);
+  EXPECT_EQ("foo", provider4->config()->name());
+}
+
+// Route tables whose virtual hosts are built on demand are not shared, as they build them with the
+// factory context of their provider.
+TEST_F(RouteConfigProviderManagerImplTest, StaticRouteTableBuiltOnDemandNotShared) {
+  const auto route_config = parseRouteConfigurationFromV2Yaml(R"EOF(
+name: foo
+max_virtual_hosts_built_on_demand: 10
+virtual_hosts:
+  - name: bar
+    domains: ["*"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: baz }
+)EOF");
+  ON_CALL(factory_context_, timeSource()).WillByDefault(ReturnRef(time_source_));
+
+  RouteConfigProviderPtr provider1 =
+      route_config_provider_manager_->createStaticRouteConfigProvider(route_config,
+                                                                      factory_context_);
+  RouteConfigProviderPtr provider2 =
+      route_config_provider_manager_->createStaticRouteConfigProvider(route_config,
+                                                                      factory_context_);
+  EXPECT_NE(provider1->config(), provider2->config());
+}
+
 // Negative test for protoc-gen-validate constraints.
 TEST_F(RouteConfigProviderManagerImplTest, ValidateFail) {
   setup();
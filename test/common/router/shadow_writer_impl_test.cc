@@ -26,12 +26,13 @@ void expectShadowWriter(absl::string_view host, absl::string_view shadowed_host)
   EXPECT_CALL(cm, httpAsyncClientForCluster("foo")).WillOnce(ReturnRef(cm.async_client_));
   Http::MockAsyncClientRequest request(&cm.async_client_);
   Http::AsyncClient::Callbacks* callback;
-  EXPECT_CALL(cm.async_client_,
-              send_(_, _, absl::optional<std::chrono::milliseconds>(std::chrono::milliseconds(5))))
+  EXPECT_CALL(cm.async_client_, sendWithOptions_(_, _, _))
       .WillOnce(Invoke(
           [&](Http::MessagePtr& inner_message, Http::AsyncClient::Callbacks& callbacks,
-              const absl::optional<std::chrono::milliseconds>&) -> Http::AsyncClient::Request* {
+              const Http::AsyncClient::RequestOptions& options) -> Http::AsyncClient::Request* {
             EXPECT_EQ(message, inner_message);
+            EXPECT_EQ(std::chrono::milliseconds(5), options.timeout.value());
+            EXPECT_TRUE(options.discard_response_body);
             EXPECT_EQ(shadowed_host, message->headers().Host()->value().c_str());
             callback = &callbacks;
             return &request;
@@ -45,12 +46,13 @@ void expectShadowWriter(absl::string_view host, absl::string_view shadowed_host)
   message.reset(new Http::RequestMessageImpl());
   message->headers().insertHost().value(std::string(host));
   EXPECT_CALL(cm, httpAsyncClientForCluster("bar")).WillOnce(ReturnRef(cm.async_client_));
-  EXPECT_CALL(cm.async_client_,
-              send_(_, _, absl::optional<std::chrono::milliseconds>(std::chrono::milliseconds(10))))
+  EXPECT_CALL(cm.async_client_, sendWithOptions_(_, _, _))
       .WillOnce(Invoke(
           [&](Http::MessagePtr& inner_message, Http::AsyncClient::Callbacks& callbacks,
-              const absl::optional<std::chrono::milliseconds>&) -> Http::AsyncClient::Request* {
+              const Http::AsyncClient::RequestOptions& options) -> Http::AsyncClient::Request* {
             EXPECT_EQ(message, inner_message);
+            EXPECT_EQ(std::chrono::milliseconds(10), options.timeout.value());
+            EXPECT_TRUE(options.discard_response_body);
             EXPECT_EQ(shadowed_host, message->headers().Host()->value().c_str());
             callback = &callbacks;
             return &request;
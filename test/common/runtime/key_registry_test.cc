@@ -0,0 +1,27 @@
+#include <string>
+#include <vector>
+
+#include "common/runtime/key_registry.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Runtime {
+
+TEST(KeyRegistryTest, Intern) {
+  const Key foo = KeyRegistry::intern("key_registry_test.foo");
+  const Key bar = KeyRegistry::intern("key_registry_test.bar");
+  EXPECT_EQ("key_registry_test.foo", foo.name());
+  EXPECT_EQ("key_registry_test.bar", bar.name());
+  EXPECT_NE(foo.index(), bar.index());
+  EXPECT_EQ(foo.index(), KeyRegistry::intern("key_registry_test.foo").index());
+
+  std::vector<std::string> names;
+  KeyRegistry::iterate([&names](const std::string& name) { names.push_back(name); });
+  ASSERT_GT(names.size(), bar.index());
+  EXPECT_EQ("key_registry_test.foo", names[foo.index()]);
+  EXPECT_EQ("key_registry_test.bar", names[bar.index()]);
+}
+
+} // namespace Runtime
+} // namespace Envoy
@@ -1,6 +1,8 @@
 #include <memory>
 #include <string>
 
+#include "common/common/blocking_pool_impl.h"
+#include "common/runtime/key_registry.h"
 #include "common/runtime/runtime_impl.h"
 #include "common/stats/isolated_store_impl.h"
 
@@ -11,6 +13,7 @@
 #include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/environment.h"
 
+#include "absl/synchronization/notification.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -18,7 +21,7 @@ using testing::_;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
-using testing::ReturnNew;
+using testing::SaveArg;
 
 namespace Envoy {
 namespace Runtime {
@@ -72,8 +75,9 @@ public:
   }
 
   void setup() {
-    EXPECT_CALL(dispatcher, createFilesystemWatcher_())
-        .WillOnce(ReturnNew<NiceMock<Filesystem::MockWatcher>>());
+    auto* watcher = new NiceMock<Filesystem::MockWatcher>();
+    ON_CALL(*watcher, addWatch(_, _, _)).WillByDefault(SaveArg<2>(&on_changed_));
+    EXPECT_CALL(dispatcher, createFilesystemWatcher_()).WillOnce(Return(watcher));
 
     os_sys_calls_ = new NiceMock<Api::MockOsSysCalls>;
     ON_CALL(*os_sys_calls_, stat(_, _))
@@ -83,16 +87,26 @@ public:
         }));
   }
 
-  void run(const std::string& primary_dir, const std::string& override_dir) {
+  void run(const std::string& primary_dir, const std::string& override_dir,
+           Thread::BlockingPool* blocking_pool = nullptr) {
     Api::OsSysCallsPtr os_sys_calls(os_sys_calls_);
-    loader.reset(new DiskBackedLoaderImpl(dispatcher, tls,
-                                          TestEnvironment::temporaryPath(primary_dir), "envoy",
-                                          override_dir, store, generator, std::move(os_sys_calls)));
+    loader.reset(new DiskBackedLoaderImpl(
+        dispatcher, tls, TestEnvironment::temporaryPath(primary_dir), "envoy", override_dir, store,
+        generator, std::move(os_sys_calls), blocking_pool));
+  }
+
+  // Expect the completion callback of a reload on the blocking pool to be posted.
+  void expectReloadPosted(absl::Notification& posted, std::function<void()>& on_complete) {
+    EXPECT_CALL(dispatcher, post(_)).WillOnce(Invoke([&](std::function<void()> callback) -> void {
+      on_complete = callback;
+      posted.Notify();
+    }));
   }
 
   Event::MockDispatcher dispatcher;
   NiceMock<ThreadLocal::MockInstance> tls;
   NiceMock<Api::MockOsSysCalls>* os_sys_calls_{};
+  Filesystem::Watcher::OnChangedCb on_changed_;
 
   Stats::IsolatedStoreImpl store;
   MockRandomGenerator generator;
@@ -137,6 +151,28 @@ TEST_F(DiskBackedLoaderImplTest, All) {
   EXPECT_EQ("hello override", loader->snapshot().get("file1"));
 }
 
+TEST_F(DiskBackedLoaderImplTest, InternedKeys) {
+  const Key file3 = KeyRegistry::intern("file3");
+  const Key file4 = KeyRegistry::intern("file4");
+  const Key invalid = KeyRegistry::intern("invalid");
+  setup();
+  run("test/common/runtime/test_data/current", "envoy_override");
+
+  EXPECT_EQ(2UL, loader->snapshot().getInteger(file3, 1));
+  EXPECT_EQ(1UL, loader->snapshot().getInteger(invalid, 1));
+
+  EXPECT_CALL(generator, random()).WillOnce(Return(1));
+  EXPECT_TRUE(loader->snapshot().featureEnabled(file3, 1));
+  EXPECT_TRUE(loader->snapshot().featureEnabled(file3, 1, 1));
+  EXPECT_FALSE(loader->snapshot().featureEnabled(file3, 1, 3));
+  EXPECT_FALSE(loader->snapshot().featureEnabled(file4, 1, 200, 300));
+  EXPECT_TRUE(loader->snapshot().featureEnabled(file4, 1, 122, 300));
+
+  // Keys interned after the snapshot was built are looked up by name.
+  EXPECT_EQ("hello override", loader->snapshot().get("file1"));
+  EXPECT_EQ(123UL, loader->snapshot().getInteger(KeyRegistry::intern("file5"), 1));
+}
+
 TEST_F(DiskBackedLoaderImplTest, GetLayers) {
   setup();
   run("test/common/runtime/test_data/current", "envoy_override");
@@ -203,6 +239,8 @@ TEST_F(DiskBackedLoaderImplTest, mergeValues) {
   setup();
   run("test/common/runtime/test_data/current", "envoy_override");
   testNewOverrides(*loader, store);
+  // Admin changes reuse the layers loaded from disk.
+  EXPECT_CALL(*os_sys_calls_, stat(_, _)).Times(0);
 
   // Override string
   loader->mergeValues({{"file2", "new world"}});
@@ -235,6 +273,39 @@ TEST_F(DiskBackedLoaderImplTest, mergeValues) {
   EXPECT_EQ(0, store.gauge("runtime.admin_overrides_active").value());
 }
 
+// Once the runtime directory is swapped, the runtime is reloaded on the blocking pool, and the new
+// snapshot is loaded on the dispatcher.
+TEST_F(DiskBackedLoaderImplTest, ReloadOnBlockingPool) {
+  setup();
+  Thread::BlockingPoolImpl blocking_pool(1);
+  run("test/common/runtime/test_data/current", "envoy_override", &blocking_pool);
+  const Snapshot::OverrideLayerConstSharedPtr root_layer = loader->snapshot().getLayers()[0];
+  EXPECT_EQ(1, store.counter("runtime.override_dir_exists").value());
+
+  absl::Notification posted;
+  std::function<void()> on_complete;
+  expectReloadPosted(posted, on_complete);
+  on_changed_(Filesystem::Watcher::Events::MovedTo);
+  // Swapped again during the reload.
+  on_changed_(Filesystem::Watcher::Events::MovedTo);
+  posted.WaitForNotification();
+  EXPECT_EQ(2, store.counter("runtime.override_dir_exists").value());
+  EXPECT_EQ(root_layer, loader->snapshot().getLayers()[0]);
+
+  // The second swap is reloaded once the first reload completed.
+  absl::Notification posted_again;
+  std::function<void()> on_complete_again;
+  expectReloadPosted(posted_again, on_complete_again);
+  on_complete();
+  EXPECT_NE(root_layer, loader->snapshot().getLayers()[0]);
+  EXPECT_EQ("hello override", loader->snapshot().get("file1"));
+
+  posted_again.WaitForNotification();
+  on_complete_again();
+  EXPECT_EQ(3, store.counter("runtime.override_dir_exists").value());
+  EXPECT_EQ("world", loader->snapshot().get("file2"));
+}
+
 TEST(LoaderImplTest, All) {
   MockRandomGenerator generator;
   NiceMock<ThreadLocal::MockInstance> tls;
@@ -263,5 +334,36 @@ TEST(DiskLayer, Loop) {
       EnvoyException, "Walk recursion depth exceded 16");
 }
 
+// Validate that the values of unchanged files are taken from the previous layer.
+TEST(DiskLayer, Previous) {
+  const std::string path = TestEnvironment::temporaryPath("runtime_disk_layer_previous");
+  TestEnvironment::writeStringToFileForTest("runtime_disk_layer_previous/foo", "1");
+  NiceMock<Api::MockOsSysCalls> os_syscalls;
+  // Only report the type and size of files, so that files keeping their size are unchanged.
+  ON_CALL(os_syscalls, stat(_, _))
+      .WillByDefault(Invoke([](const char* filename, struct stat* stat) {
+        struct stat file_stat;
+        const int rc = ::stat(filename, &file_stat);
+        *stat = {};
+        stat->st_mode = file_stat.st_mode;
+        stat->st_size = file_stat.st_size;
+        return Api::SysCallIntResult{rc, errno};
+      }));
+
+  DiskLayer layer1("test", path, os_syscalls);
+  EXPECT_EQ("1", layer1.values().at("foo").string_value_);
+
+  TestEnvironment::writeStringToFileForTest("runtime_disk_layer_previous/foo", "2");
+  TestEnvironment::writeStringToFileForTest("runtime_disk_layer_previous/bar", "3");
+  DiskLayer layer2("test", path, os_syscalls, &layer1);
+  EXPECT_EQ(1UL, layer2.values().at("foo").uint_value_.value());
+  EXPECT_EQ("3", layer2.values().at("bar").string_value_);
+
+  TestEnvironment::writeStringToFileForTest("runtime_disk_layer_previous/foo", "22");
+  DiskLayer layer3("test", path, os_syscalls, &layer2);
+  EXPECT_EQ("22", layer3.values().at("foo").string_value_);
+  EXPECT_EQ("3", layer3.values().at("bar").string_value_);
+}
+
 } // namespace Runtime
 } // namespace Envoy
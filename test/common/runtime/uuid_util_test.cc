@@ -33,6 +33,15 @@ TEST(UUIDUtilsTest, mod) {
 
   EXPECT_TRUE(UuidUtils::uuidModBy("ffffffff-0012-0110-00ff-0c00400600ff", result, 10000));
   EXPECT_EQ(7295, result);
+
+  EXPECT_TRUE(UuidUtils::uuidModBy("FFFFFFFF-0012-0110-00ff-0c00400600ff", result, 10000));
+  EXPECT_EQ(7295, result);
+
+  // The uuid must start with 8 hex digits.
+  EXPECT_FALSE(UuidUtils::uuidModBy("fffffff", result, 100));
+  EXPECT_FALSE(UuidUtils::uuidModBy("fffffffg-0012-0110-00ff-0c00400600ff", result, 100));
+  EXPECT_FALSE(UuidUtils::uuidModBy("-0000001-0012-0110-00ff-0c00400600ff", result, 100));
+  EXPECT_FALSE(UuidUtils::uuidModBy("0x000001-0012-0110-00ff-0c00400600ff", result, 100));
 }
 
 TEST(UUIDUtilsTest, checkDistribution) {
@@ -91,4 +100,15 @@ TEST(UUIDUtilsTest, setAndCheckTraceable) {
   std::string invalid_uuid = "";
   EXPECT_FALSE(UuidUtils::setTraceableUuid(invalid_uuid, UuidTraceStatus::Forced));
 }
+
+TEST(UUIDUtilsTest, setTraceableInBuffer) {
+  char uuid[] = "a121e9e1-feae-4136-9e0e-6fac343d56c9";
+  const size_t length = sizeof(uuid) - 1;
+  EXPECT_TRUE(UuidUtils::setTraceableUuid(uuid, length, UuidTraceStatus::Sampled));
+  EXPECT_EQ(UuidTraceStatus::Sampled, UuidUtils::isTraceableUuid(absl::string_view(uuid, length)));
+  EXPECT_EQ("a121e9e1-feae-9136-9e0e-6fac343d56c9", std::string(uuid, length));
+
+  EXPECT_FALSE(UuidUtils::setTraceableUuid(uuid, length - 1, UuidTraceStatus::Forced));
+  EXPECT_EQ(UuidTraceStatus::Sampled, UuidUtils::isTraceableUuid(absl::string_view(uuid, length)));
+}
 } // namespace Envoy
@@ -120,21 +120,55 @@ TEST_F(SecretManagerImplTest, DuplicateStaticCertificateValidationContextSecret)
 // supported.
 TEST_F(SecretManagerImplTest, NotImplementedException) {
   envoy::api::v2::auth::Secret secret_config;
+  secret_config.set_name("abc.com");
 
+  std::unique_ptr<SecretManager> secret_manager(new SecretManagerImpl());
+
+  EXPECT_THROW_WITH_MESSAGE(secret_manager->addStaticSecret(secret_config), EnvoyException,
+                            "Secret type not implemented");
+}
+
+// Validate that secret manager adds static session ticket keys secret successfully.
+TEST_F(SecretManagerImplTest, SessionTicketKeysSecretLoadSuccess) {
+  envoy::api::v2::auth::Secret secret_config;
   const std::string yaml =
       R"EOF(
 name: "abc.com"
 session_ticket_keys:
   keys:
-    - filename: "{{ test_rundir }}/test/common/ssl/test_data/selfsigned_cert.pem"
+    - filename: "{{ test_rundir }}/test/common/ssl/test_data/ticket_key_a"
+    - filename: "{{ test_rundir }}/test/common/ssl/test_data/ticket_key_b"
 )EOF";
-
   MessageUtil::loadFromYaml(TestEnvironment::substitute(yaml), secret_config);
-
   std::unique_ptr<SecretManager> secret_manager(new SecretManagerImpl());
+  secret_manager->addStaticSecret(secret_config);
+
+  ASSERT_EQ(secret_manager->findStaticTlsSessionTicketKeysProvider("undefined"), nullptr);
+  ASSERT_NE(secret_manager->findStaticTlsSessionTicketKeysProvider("abc.com"), nullptr);
+  EXPECT_EQ(2, secret_manager->findStaticTlsSessionTicketKeysProvider("abc.com")
+                   ->secret()
+                   ->keys()
+                   .size());
 
   EXPECT_THROW_WITH_MESSAGE(secret_manager->addStaticSecret(secret_config), EnvoyException,
-                            "Secret type not implemented");
+                            "Duplicate static TlsSessionTicketKeys secret name abc.com");
+}
+
+// Validate that secret manager throws an exception when a static session ticket key has the wrong
+// length.
+TEST_F(SecretManagerImplTest, SessionTicketKeysSecretWrongLength) {
+  envoy::api::v2::auth::Secret secret_config;
+  const std::string yaml =
+      R"EOF(
+name: "abc.com"
+session_ticket_keys:
+  keys:
+    - filename: "{{ test_rundir }}/test/common/ssl/test_data/selfsigned_cert.pem"
+)EOF";
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(yaml), secret_config);
+  std::unique_ptr<SecretManager> secret_manager(new SecretManagerImpl());
+
+  EXPECT_THROW(secret_manager->addStaticSecret(secret_config), EnvoyException);
 }
 
 TEST_F(SecretManagerImplTest, SdsDynamicSecretUpdateSuccess) {
@@ -180,6 +214,59 @@ tls_certificate:
             secret_provider->secret()->privateKey());
 }
 
+TEST_F(SecretManagerImplTest, SdsDynamicSessionTicketKeysUpdateSuccess) {
+  std::unique_ptr<SecretManager> secret_manager(std::make_unique<SecretManagerImpl>());
+
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> secret_context;
+
+  envoy::api::v2::core::ConfigSource config_source;
+  NiceMock<LocalInfo::MockLocalInfo> local_info;
+  NiceMock<Event::MockDispatcher> dispatcher;
+  NiceMock<Runtime::MockRandomGenerator> random;
+  Stats::IsolatedStoreImpl stats;
+  NiceMock<Upstream::MockClusterManager> cluster_manager;
+  NiceMock<Init::MockManager> init_manager;
+  EXPECT_CALL(secret_context, localInfo()).WillOnce(ReturnRef(local_info));
+  EXPECT_CALL(secret_context, dispatcher()).WillOnce(ReturnRef(dispatcher));
+  EXPECT_CALL(secret_context, random()).WillOnce(ReturnRef(random));
+  EXPECT_CALL(secret_context, stats()).WillOnce(ReturnRef(stats));
+  EXPECT_CALL(secret_context, clusterManager()).WillOnce(ReturnRef(cluster_manager));
+  EXPECT_CALL(secret_context, initManager()).WillRepeatedly(Return(&init_manager));
+
+  auto secret_provider = secret_manager->findOrCreateTlsSessionTicketKeysProvider(
+      config_source, "abc.com", secret_context);
+  EXPECT_EQ(secret_provider, secret_manager->findOrCreateTlsSessionTicketKeysProvider(
+                                 config_source, "abc.com", secret_context));
+  EXPECT_EQ(nullptr, secret_provider->secret());
+
+  int updates = 0;
+  secret_provider->addUpdateCallback([&updates]() { updates++; });
+
+  const std::string yaml =
+      R"EOF(
+name: "abc.com"
+session_ticket_keys:
+  keys:
+    - filename: "{{ test_rundir }}/test/common/ssl/test_data/ticket_key_a"
+)EOF";
+  Protobuf::RepeatedPtrField<envoy::api::v2::auth::Secret> secret_resources;
+  auto secret_config = secret_resources.Add();
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(yaml), *secret_config);
+  dynamic_cast<SdsApi&>(*secret_provider).onConfigUpdate(secret_resources, "");
+  EXPECT_EQ(1, updates);
+  ASSERT_EQ(1, secret_provider->secret()->keys().size());
+
+  // An identical update does not run the callbacks again.
+  dynamic_cast<SdsApi&>(*secret_provider).onConfigUpdate(secret_resources, "");
+  EXPECT_EQ(1, updates);
+
+  secret_config->mutable_session_ticket_keys()->add_keys()->set_filename(
+      TestEnvironment::substitute("{{ test_rundir }}/test/common/ssl/test_data/ticket_key_b"));
+  dynamic_cast<SdsApi&>(*secret_provider).onConfigUpdate(secret_resources, "");
+  EXPECT_EQ(2, updates);
+  EXPECT_EQ(2, secret_provider->secret()->keys().size());
+}
+
 } // namespace
 } // namespace Secret
 } // namespace Envoy
@@ -0,0 +1,46 @@
+#include "common/ssl/certificate_matcher.h"
+
+#include "gtest/gtest.h"
+#include "openssl/sha.h"
+
+namespace Envoy {
+namespace Ssl {
+
+// Mirrors ContextImpl::dNSNameMatch().
+TEST(SubjectAltNameMatcherTest, DnsName) {
+  SubjectAltNameMatcher matcher({"lyft.com", "a.b.lyft.com", "alyft.com"});
+  EXPECT_TRUE(matcher.matchesDnsName("lyft.com"));
+  EXPECT_TRUE(matcher.matchesDnsName("*.lyft.com"));
+  EXPECT_TRUE(matcher.matchesDnsName("*.b.lyft.com"));
+  EXPECT_TRUE(matcher.matchesDnsName("*.com"));
+  EXPECT_FALSE(matcher.matchesDnsName("*.a.b.lyft.com"));
+  EXPECT_FALSE(matcher.matchesDnsName("*lyft.com"));
+  EXPECT_FALSE(matcher.matchesDnsName("*.test.com"));
+  EXPECT_FALSE(matcher.matchesDnsName("b.lyft.com"));
+  EXPECT_FALSE(matcher.matchesDnsName(""));
+  EXPECT_FALSE(matcher.matchesDnsName("*."));
+
+  SubjectAltNameMatcher empty_matcher({""});
+  EXPECT_FALSE(empty_matcher.matchesDnsName("*lyft.com"));
+}
+
+TEST(SubjectAltNameMatcherTest, Uri) {
+  SubjectAltNameMatcher matcher({"spiffe://lyft.com/test-team"});
+  EXPECT_TRUE(matcher.matchesUri("spiffe://lyft.com/test-team"));
+  EXPECT_FALSE(matcher.matchesUri("spiffe://lyft.com/test"));
+  // Names with embedded NULs are compared whole.
+  EXPECT_FALSE(matcher.matchesUri(absl::string_view("spiffe://lyft.com/test-team\0x", 29)));
+}
+
+TEST(CertificateHashSetTest, Contains) {
+  std::vector<uint8_t> hash1(SHA256_DIGEST_LENGTH, 1);
+  std::vector<uint8_t> hash2(SHA256_DIGEST_LENGTH, 2);
+  CertificateHashSet set({hash1});
+  EXPECT_FALSE(set.empty());
+  EXPECT_TRUE(set.contains(hash1.data()));
+  EXPECT_FALSE(set.contains(hash2.data()));
+  EXPECT_TRUE(CertificateHashSet({}).empty());
+}
+
+} // namespace Ssl
+} // namespace Envoy
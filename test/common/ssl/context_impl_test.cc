@@ -178,6 +178,33 @@ TEST_F(SslContextImplTest, TestNoCert) {
   EXPECT_EQ("", context->getCertChainInformation());
 }
 
+TEST_F(SslContextImplTest, ExportImportServerSessions) {
+  Runtime::MockLoader runtime;
+  ContextManagerImpl manager(runtime, 0, 16);
+  EXPECT_EQ("", manager.exportServerSessions());
+
+  bssl::UniquePtr<SSL_CTX> ctx(SSL_CTX_new(TLS_method()));
+  bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_new(ctx.get()));
+  const uint8_t id[] = {1, 2, 3, 4};
+  ASSERT_TRUE(SSL_SESSION_set1_id(session.get(), id, sizeof(id)));
+  uint8_t* data;
+  size_t length;
+  ASSERT_TRUE(SSL_SESSION_to_bytes(session.get(), &data, &length));
+  const uint32_t length32 = length;
+  std::string sessions(reinterpret_cast<const char*>(&length32), sizeof(length32));
+  sessions.append(reinterpret_cast<const char*>(data), length);
+  OPENSSL_free(data);
+
+  // A truncated trailing session is ignored.
+  manager.importServerSessions(sessions + sessions.substr(0, sessions.size() - 1));
+  EXPECT_EQ(sessions, manager.exportServerSessions());
+
+  // Without a shared session cache there is nothing to export or import into.
+  ContextManagerImpl uncached_manager(runtime);
+  uncached_manager.importServerSessions(sessions);
+  EXPECT_EQ("", uncached_manager.exportServerSessions());
+}
+
 class SslServerContextImplTicketTest : public SslContextImplTest {
 public:
   static void loadConfig(ServerContextConfigImpl& cfg) {
@@ -297,10 +324,11 @@ TEST_F(SslServerContextImplTicketTest, TicketKeyInlineStringFailTooSmall) {
   EXPECT_THROW(loadConfigV2(cfg), EnvoyException);
 }
 
-TEST_F(SslServerContextImplTicketTest, TicketKeySdsFail) {
+TEST_F(SslServerContextImplTicketTest, TicketKeyMissingStaticSecret) {
   envoy::api::v2::auth::DownstreamTlsContext cfg;
-  cfg.mutable_session_ticket_keys_sds_secret_config();
-  EXPECT_THROW_WITH_MESSAGE(loadConfigV2(cfg), EnvoyException, "SDS not supported yet");
+  cfg.mutable_session_ticket_keys_sds_secret_config()->set_name("missing");
+  EXPECT_THROW_WITH_MESSAGE(loadConfigV2(cfg), EnvoyException,
+                            "Unknown static session ticket keys: missing");
 }
 
 TEST_F(SslServerContextImplTicketTest, CRLSuccess) {
@@ -653,6 +681,35 @@ TEST(ServerContextConfigImplTest, SecretNotReady) {
   ServerContextConfigImpl server_context_config(tls_context, factory_context);
   // When sds secret is not downloaded, config is not ready.
   EXPECT_FALSE(server_context_config.isReady());
+  EXPECT_TRUE(server_context_config.hasDynamicSecrets());
+}
+
+TEST(ServerContextConfigImplTest, DynamicRecordSizing) {
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context;
+  tls_context.mutable_common_tls_context()->add_tls_certificates();
+  EXPECT_FALSE(
+      ServerContextConfigImpl(tls_context, factory_context).dynamicRecordSizing().has_value());
+
+  envoy::api::v2::auth::DynamicRecordSizing* sizing =
+      tls_context.mutable_common_tls_context()->mutable_dynamic_record_sizing();
+  {
+    ServerContextConfigImpl server_context_config(tls_context, factory_context);
+    ASSERT_TRUE(server_context_config.dynamicRecordSizing().has_value());
+    EXPECT_EQ(0U, server_context_config.dynamicRecordSizing()->small_record_size_);
+    EXPECT_EQ(65536U, server_context_config.dynamicRecordSizing()->ramp_up_bytes_);
+    EXPECT_EQ(std::chrono::milliseconds(1000),
+              server_context_config.dynamicRecordSizing()->idle_timeout_);
+  }
+
+  sizing->mutable_small_record_size()->set_value(1200);
+  sizing->mutable_ramp_up_bytes()->set_value(8192);
+  sizing->mutable_idle_timeout()->set_seconds(5);
+  ServerContextConfigImpl server_context_config(tls_context, factory_context);
+  EXPECT_EQ(1200U, server_context_config.dynamicRecordSizing()->small_record_size_);
+  EXPECT_EQ(8192U, server_context_config.dynamicRecordSizing()->ramp_up_bytes_);
+  EXPECT_EQ(std::chrono::milliseconds(5000),
+            server_context_config.dynamicRecordSizing()->idle_timeout_);
 }
 
 // TlsCertificate messages must have a cert for servers.
@@ -670,6 +727,91 @@ TEST(ServerContextImplTest, TlsCertificateNonEmpty) {
                             "Server TlsCertificates must have a certificate specified");
 }
 
+class LazyServerContextTest : public SslCertsTest {
+protected:
+  std::unique_ptr<ServerContextConfigImpl> serverContextConfig() {
+    envoy::api::v2::auth::DownstreamTlsContext tls_context;
+    envoy::api::v2::auth::TlsCertificate* server_cert =
+        tls_context.mutable_common_tls_context()->add_tls_certificates();
+    server_cert->mutable_certificate_chain()->set_filename(
+        TestEnvironment::substitute("{{ test_tmpdir }}/unittestcert.pem"));
+    server_cert->mutable_private_key()->set_filename(
+        TestEnvironment::substitute("{{ test_tmpdir }}/unittestkey.pem"));
+    return std::make_unique<ServerContextConfigImpl>(tls_context, factory_context_);
+  }
+
+  uint32_t builtContexts(ContextManagerImpl& manager) {
+    uint32_t contexts = 0;
+    manager.iterateContexts([&contexts](const Context&) -> void { contexts++; });
+    return contexts;
+  }
+
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  Stats::IsolatedStoreImpl store_;
+};
+
+// Server contexts are built eagerly unless the manager bounds the number of lazy ones.
+TEST_F(LazyServerContextTest, DisabledByDefault) {
+  ContextManagerImpl manager(runtime_);
+  auto config = serverContextConfig();
+  EXPECT_FALSE(config->hasDynamicSecrets());
+  EXPECT_EQ(nullptr, manager.createLazySslServerContext(store_, *config, {}));
+}
+
+TEST_F(LazyServerContextTest, BuiltOnFirstUse) {
+  ContextManagerImpl manager(runtime_, 0, 0, 10);
+  auto config = serverContextConfig();
+  LazyServerContextPtr lazy_context = manager.createLazySslServerContext(store_, *config, {});
+  ASSERT_NE(nullptr, lazy_context);
+  EXPECT_EQ(0U, builtContexts(manager));
+
+  ServerContextSharedPtr context = lazy_context->get();
+  ASSERT_NE(nullptr, context);
+  EXPECT_EQ(1U, builtContexts(manager));
+  EXPECT_EQ(context, lazy_context->get());
+  EXPECT_EQ(1U, builtContexts(manager));
+}
+
+// Beyond the limit, the contexts not used since the last sweep are released, and are built again
+// when used next.
+TEST_F(LazyServerContextTest, ReleasedBeyondLimit) {
+  ContextManagerImpl manager(runtime_, 0, 0, 1);
+  auto config_a = serverContextConfig();
+  auto config_b = serverContextConfig();
+  LazyServerContextPtr lazy_a = manager.createLazySslServerContext(store_, *config_a, {});
+  LazyServerContextPtr lazy_b = manager.createLazySslServerContext(store_, *config_b, {});
+
+  std::weak_ptr<ServerContext> context_a = lazy_a->get();
+  EXPECT_FALSE(context_a.expired());
+  // Connections keep using a released context until they close.
+  ServerContextSharedPtr connection_a = lazy_a->get();
+
+  ServerContextSharedPtr context_b = lazy_b->get();
+  ASSERT_NE(nullptr, context_b);
+  EXPECT_FALSE(context_a.expired());
+  connection_a.reset();
+  EXPECT_TRUE(context_a.expired());
+  EXPECT_EQ(1U, builtContexts(manager));
+
+  // Building a again releases b, which was not used since.
+  EXPECT_NE(nullptr, lazy_a->get());
+  EXPECT_EQ(2U, builtContexts(manager));
+  context_b.reset();
+  EXPECT_EQ(1U, builtContexts(manager));
+}
+
+// Configuration errors surface when the context is first used.
+TEST_F(LazyServerContextTest, BuildFailure) {
+  ContextManagerImpl manager(runtime_, 0, 0, 10);
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  tls_context.mutable_common_tls_context()->add_tls_certificates();
+  ServerContextConfigImpl config(tls_context, factory_context_);
+  LazyServerContextPtr lazy_context = manager.createLazySslServerContext(store_, config, {});
+  EXPECT_EQ(nullptr, lazy_context->get());
+  EXPECT_EQ(0U, builtContexts(manager));
+}
+
 // Cannot ignore certificate expiration without a trusted CA.
 TEST(ServerContextConfigImplTest, InvalidIgnoreCertsNoCA) {
   envoy::api::v2::auth::DownstreamTlsContext tls_context;
@@ -0,0 +1,83 @@
+#include <map>
+#include <string>
+
+#include "common/ssl/session_cache.h"
+
+#include "gtest/gtest.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+class LruSessionCacheTest : public testing::Test {
+public:
+  bssl::UniquePtr<SSL_SESSION> newSession() {
+    return bssl::UniquePtr<SSL_SESSION>(SSL_SESSION_new(ctx_.get()));
+  }
+
+  bssl::UniquePtr<SSL_CTX> ctx_{SSL_CTX_new(TLS_method())};
+};
+
+TEST_F(LruSessionCacheTest, InsertLookupRemove) {
+  LruSessionCache cache(16);
+  bssl::UniquePtr<SSL_SESSION> session1 = newSession();
+  bssl::UniquePtr<SSL_SESSION> session2 = newSession();
+
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  cache.insert("a", session1.get());
+  EXPECT_EQ(session1.get(), cache.lookup("a").get());
+
+  cache.insert("a", session2.get());
+  EXPECT_EQ(session2.get(), cache.lookup("a").get());
+
+  cache.remove("a");
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  cache.remove("a");
+}
+
+TEST_F(LruSessionCacheTest, SessionsOutliveCallerReferences) {
+  LruSessionCache cache(16);
+  SSL_SESSION* session = newSession().release();
+  cache.insert("a", session);
+  SSL_SESSION_free(session);
+
+  bssl::UniquePtr<SSL_SESSION> found = cache.lookup("a");
+  EXPECT_EQ(session, found.get());
+}
+
+TEST_F(LruSessionCacheTest, EvictsLeastRecentlyUsed) {
+  LruSessionCache cache(16);
+  bssl::UniquePtr<SSL_SESSION> session = newSession();
+  for (int i = 0; i < 1000; i++) {
+    cache.insert(std::to_string(i), session.get());
+  }
+
+  uint32_t cached = 0;
+  for (int i = 0; i < 1000; i++) {
+    if (cache.lookup(std::to_string(i)) != nullptr) {
+      cached++;
+    }
+  }
+  EXPECT_GT(cached, 0);
+  EXPECT_LE(cached, 16);
+  // The most recently inserted session is never evicted.
+  EXPECT_NE(nullptr, cache.lookup("999"));
+}
+
+TEST_F(LruSessionCacheTest, Iterate) {
+  LruSessionCache cache(16);
+  bssl::UniquePtr<SSL_SESSION> session1 = newSession();
+  bssl::UniquePtr<SSL_SESSION> session2 = newSession();
+  cache.insert("a", session1.get());
+  cache.insert("b", session2.get());
+
+  std::map<std::string, SSL_SESSION*> sessions;
+  cache.iterate([&sessions](const std::string& key, SSL_SESSION* session) {
+    sessions.emplace(key, session);
+  });
+  EXPECT_EQ((std::map<std::string, SSL_SESSION*>{{"a", session1.get()}, {"b", session2.get()}}),
+            sessions);
+}
+
+} // namespace Ssl
+} // namespace Envoy
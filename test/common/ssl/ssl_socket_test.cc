@@ -11,6 +11,7 @@
 #include "common/network/address_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/utility.h"
+#include "common/secret/sds_api.h"
 #include "common/ssl/context_config_impl.h"
 #include "common/ssl/context_impl.h"
 #include "common/ssl/ssl_socket.h"
@@ -1674,6 +1675,242 @@ TEST_P(SslSocketTest, HalfClose) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+// Test that data and half-closes flow both ways when the kernel encrypts the records sent. Kernels
+// without TLS support fall back to encrypting in the SSL, which must work just the same.
+TEST_P(SslSocketTest, KernelTlsOffloadHalfClose) {
+  Stats::IsolatedStoreImpl stats_store;
+  Runtime::MockLoader runtime;
+
+  envoy::api::v2::auth::DownstreamTlsContext server_tls_context;
+  server_tls_context.mutable_common_tls_context()->set_kernel_tls_offload(true);
+  server_tls_context.mutable_common_tls_context()->mutable_tls_params()->add_cipher_suites(
+      "ECDHE-RSA-AES128-GCM-SHA256");
+  envoy::api::v2::auth::TlsCertificate* server_cert =
+      server_tls_context.mutable_common_tls_context()->add_tls_certificates();
+  server_cert->mutable_certificate_chain()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestcert.pem"));
+  server_cert->mutable_private_key()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestkey.pem"));
+  auto server_cfg = std::make_unique<ServerContextConfigImpl>(server_tls_context, factory_context_);
+  ContextManagerImpl manager(runtime);
+  Ssl::ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager, stats_store,
+                                                        std::vector<std::string>{});
+
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr,
+                                  true);
+  Network::MockListenerCallbacks listener_callbacks;
+  Network::ListenerPtr listener =
+      dispatcher_->createListener(socket, listener_callbacks, true, false);
+  std::shared_ptr<Network::MockReadFilter> server_read_filter(new Network::MockReadFilter());
+  std::shared_ptr<Network::MockReadFilter> client_read_filter(new Network::MockReadFilter());
+
+  envoy::api::v2::auth::UpstreamTlsContext client_tls_context;
+  client_tls_context.mutable_common_tls_context()->set_kernel_tls_offload(true);
+  auto client_cfg = std::make_unique<ClientContextConfigImpl>(client_tls_context, factory_context_);
+  ClientSslSocketFactory client_ssl_socket_factory(std::move(client_cfg), manager, stats_store);
+  Network::ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+      socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
+      client_ssl_socket_factory.createTransportSocket(), nullptr);
+  client_connection->enableHalfClose(true);
+  client_connection->addReadFilter(client_read_filter);
+  client_connection->connect();
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+
+  Network::ConnectionPtr server_connection;
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  EXPECT_CALL(listener_callbacks, onAccept_(_, _))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket, bool) -> void {
+        Network::ConnectionPtr new_connection = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory.createTransportSocket());
+        listener_callbacks.onNewConnection(std::move(new_connection));
+      }));
+  EXPECT_CALL(listener_callbacks, onNewConnection_(_))
+      .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+        server_connection = std::move(conn);
+        server_connection->enableHalfClose(true);
+        server_connection->addReadFilter(server_read_filter);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+        Buffer::OwnedImpl data("hello");
+        server_connection->write(data, true);
+      }));
+
+  EXPECT_CALL(*server_read_filter, onNewConnection())
+      .WillOnce(Return(Network::FilterStatus::Continue));
+  EXPECT_CALL(*client_read_filter, onNewConnection())
+      .WillOnce(Return(Network::FilterStatus::Continue));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected));
+  EXPECT_CALL(*client_read_filter, onData(BufferStringEqual("hello"), true))
+      .WillOnce(Invoke([&](Buffer::Instance&, bool) -> Network::FilterStatus {
+        Buffer::OwnedImpl buffer("world");
+        client_connection->write(buffer, true);
+        return Network::FilterStatus::Continue;
+      }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(*server_read_filter, onData(BufferStringEqual("world"), true));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+}
+
+// Test that the server sends small records until it ramped up, and full size records after.
+TEST_P(SslSocketTest, DynamicRecordSizing) {
+  Stats::IsolatedStoreImpl stats_store;
+  Runtime::MockLoader runtime;
+
+  envoy::api::v2::auth::DownstreamTlsContext server_tls_context;
+  envoy::api::v2::auth::DynamicRecordSizing* sizing =
+      server_tls_context.mutable_common_tls_context()->mutable_dynamic_record_sizing();
+  sizing->mutable_small_record_size()->set_value(1024);
+  sizing->mutable_ramp_up_bytes()->set_value(4096);
+  // AES-GCM records carry an 8 byte explicit nonce and a 16 byte tag besides the plaintext.
+  server_tls_context.mutable_common_tls_context()->mutable_tls_params()->add_cipher_suites(
+      "ECDHE-RSA-AES128-GCM-SHA256");
+  envoy::api::v2::auth::TlsCertificate* server_cert =
+      server_tls_context.mutable_common_tls_context()->add_tls_certificates();
+  server_cert->mutable_certificate_chain()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestcert.pem"));
+  server_cert->mutable_private_key()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestkey.pem"));
+  auto server_cfg = std::make_unique<ServerContextConfigImpl>(server_tls_context, factory_context_);
+  ContextManagerImpl manager(runtime);
+  Ssl::ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager, stats_store,
+                                                        std::vector<std::string>{});
+
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr,
+                                  true);
+  Network::MockListenerCallbacks listener_callbacks;
+  Network::ListenerPtr listener =
+      dispatcher_->createListener(socket, listener_callbacks, true, false);
+  std::shared_ptr<Network::MockReadFilter> client_read_filter(new Network::MockReadFilter());
+
+  envoy::api::v2::auth::UpstreamTlsContext client_tls_context;
+  auto client_cfg = std::make_unique<ClientContextConfigImpl>(client_tls_context, factory_context_);
+  ClientSslSocketFactory client_ssl_socket_factory(std::move(client_cfg), manager, stats_store);
+  Network::ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+      socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
+      client_ssl_socket_factory.createTransportSocket(), nullptr);
+  client_connection->addReadFilter(client_read_filter);
+
+  // Record the lengths of the application data records the client receives.
+  std::vector<size_t> record_lengths;
+  const Ssl::SslSocket* ssl_socket = dynamic_cast<const Ssl::SslSocket*>(client_connection->ssl());
+  SSL_set_msg_callback(ssl_socket->rawSslForTest(),
+                       [](int write_p, int, int content_type, const void* buf, size_t len, SSL*,
+                          void* arg) -> void {
+                         const uint8_t* header = static_cast<const uint8_t*>(buf);
+                         if (!write_p && content_type == SSL3_RT_HEADER && len == 5 &&
+                             header[0] == SSL3_RT_APPLICATION_DATA) {
+                           static_cast<std::vector<size_t>*>(arg)->push_back((header[3] << 8) |
+                                                                             header[4]);
+                         }
+                       });
+  SSL_set_msg_callback_arg(ssl_socket->rawSslForTest(), &record_lengths);
+  client_connection->connect();
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+
+  Network::ConnectionPtr server_connection;
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  EXPECT_CALL(listener_callbacks, onAccept_(_, _))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket, bool) -> void {
+        Network::ConnectionPtr new_connection = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory.createTransportSocket());
+        listener_callbacks.onNewConnection(std::move(new_connection));
+      }));
+  EXPECT_CALL(listener_callbacks, onNewConnection_(_))
+      .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+        server_connection = std::move(conn);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+        Buffer::OwnedImpl data(std::string(32768, 'a'));
+        server_connection->write(data, false);
+      }));
+
+  EXPECT_CALL(*client_read_filter, onNewConnection())
+      .WillOnce(Return(Network::FilterStatus::Continue));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected));
+  uint64_t bytes_received = 0;
+  EXPECT_CALL(*client_read_filter, onData(_, false))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) -> Network::FilterStatus {
+        bytes_received += data.length();
+        data.drain(data.length());
+        if (bytes_received == 32768) {
+          client_connection->close(Network::ConnectionCloseType::NoFlush);
+        }
+        return Network::FilterStatus::StopIteration;
+      }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(std::vector<size_t>({1048, 1048, 1048, 1048, 16408, 12312}), record_lengths);
+}
+
+// Test that a handshake completes when the server runs its private key operations on a thread pool.
+TEST_P(SslSocketTest, PrivateKeyOperationsOnThreadPool) {
+  Stats::IsolatedStoreImpl stats_store;
+  Runtime::MockLoader runtime;
+
+  std::string server_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_tmpdir }}/unittestcert.pem",
+    "private_key_file": "{{ test_tmpdir }}/unittestkey.pem"
+  }
+  )EOF";
+
+  Json::ObjectSharedPtr server_ctx_loader = TestEnvironment::jsonLoadFromString(server_ctx_json);
+  auto server_cfg = std::make_unique<ServerContextConfigImpl>(*server_ctx_loader, factory_context_);
+  ContextManagerImpl manager(runtime, 2);
+  Ssl::ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager, stats_store,
+                                                        std::vector<std::string>{});
+
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr,
+                                  true);
+  Network::MockListenerCallbacks callbacks;
+  Network::MockConnectionHandler connection_handler;
+  Network::ListenerPtr listener = dispatcher_->createListener(socket, callbacks, true, false);
+
+  Json::ObjectSharedPtr client_ctx_loader = TestEnvironment::jsonLoadFromString("{}");
+  auto client_cfg = std::make_unique<ClientContextConfigImpl>(*client_ctx_loader, factory_context_);
+  ClientSslSocketFactory client_ssl_socket_factory(std::move(client_cfg), manager, stats_store);
+  Network::ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+      socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
+      client_ssl_socket_factory.createTransportSocket(), nullptr);
+  client_connection->connect();
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+
+  Network::ConnectionPtr server_connection;
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  EXPECT_CALL(callbacks, onAccept_(_, _))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket, bool) -> void {
+        Network::ConnectionPtr new_connection = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory.createTransportSocket());
+        callbacks.onNewConnection(std::move(new_connection));
+      }));
+  EXPECT_CALL(callbacks, onNewConnection_(_))
+      .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+        server_connection = std::move(conn);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+      }));
+
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+        client_connection->close(Network::ConnectionCloseType::NoFlush);
+      }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+}
+
 TEST_P(SslSocketTest, ClientAuthMultipleCAs) {
   Stats::IsolatedStoreImpl stats_store;
   Runtime::MockLoader runtime;
@@ -2072,6 +2309,217 @@ TEST_P(SslSocketTest, TicketSessionResumptionDifferentServerCertIntermediateCA)
                               GetParam());
 }
 
+// Test that a new client connection resumes the session of an earlier connection to the same
+// server from the session cache the context manager shares between contexts.
+TEST_P(SslSocketTest, SharedSessionCacheResumption) {
+  Stats::IsolatedStoreImpl stats_store;
+  Runtime::MockLoader runtime;
+  ContextManagerImpl manager(runtime, 0, 16);
+
+  std::string server_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_tmpdir }}/unittestcert.pem",
+    "private_key_file": "{{ test_tmpdir }}/unittestkey.pem"
+  }
+  )EOF";
+
+  Json::ObjectSharedPtr server_ctx_loader = TestEnvironment::jsonLoadFromString(server_ctx_json);
+  auto server_cfg = std::make_unique<ServerContextConfigImpl>(*server_ctx_loader, factory_context_);
+  Ssl::ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager, stats_store,
+                                                        std::vector<std::string>{});
+
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr,
+                                  true);
+  NiceMock<Network::MockListenerCallbacks> callbacks;
+  Network::ListenerPtr listener = dispatcher_->createListener(socket, callbacks, true, false);
+
+  Json::ObjectSharedPtr client_ctx_loader = TestEnvironment::jsonLoadFromString("{}");
+  auto client_cfg = std::make_unique<ClientContextConfigImpl>(*client_ctx_loader, factory_context_);
+  ClientSslSocketFactory client_ssl_socket_factory(std::move(client_cfg), manager, stats_store);
+
+  Network::ConnectionPtr server_connection;
+  EXPECT_CALL(callbacks, onAccept_(_, _))
+      .WillRepeatedly(Invoke([&](Network::ConnectionSocketPtr& socket, bool) -> void {
+        Network::ConnectionPtr new_connection = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory.createTransportSocket());
+        callbacks.onNewConnection(std::move(new_connection));
+      }));
+
+  for (int i = 0; i < 2; i++) {
+    Network::ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+        socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
+        client_ssl_socket_factory.createTransportSocket(), nullptr);
+    Network::MockConnectionCallbacks client_connection_callbacks;
+    client_connection->addConnectionCallbacks(client_connection_callbacks);
+    client_connection->connect();
+
+    Network::MockConnectionCallbacks server_connection_callbacks;
+    EXPECT_CALL(callbacks, onNewConnection_(_))
+        .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+          server_connection = std::move(conn);
+          server_connection->addConnectionCallbacks(server_connection_callbacks);
+        }));
+
+    // Wait for both sides to complete the handshake.
+    unsigned connect_count = 0;
+    auto stopSecondTime = [&]() {
+      if (++connect_count == 2) {
+        client_connection->close(Network::ConnectionCloseType::NoFlush);
+        server_connection->close(Network::ConnectionCloseType::NoFlush);
+        dispatcher_->exit();
+      }
+    };
+    EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { stopSecondTime(); }));
+    EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { stopSecondTime(); }));
+    EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+    EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    server_connection.reset();
+  }
+
+  // One for client, one for server
+  EXPECT_EQ(2UL, stats_store.counter("ssl.session_reused").value());
+}
+
+// Session ticket keys updated by SDS are rotated without rebuilding the context. Tickets of the
+// keys rotated out are still accepted until the following rotation.
+TEST_P(SslSocketTest, TicketKeyRotationBySds) {
+  Stats::IsolatedStoreImpl stats_store;
+  Runtime::MockLoader runtime;
+  ContextManagerImpl manager(runtime);
+
+  NiceMock<LocalInfo::MockLocalInfo> local_info;
+  NiceMock<Runtime::MockRandomGenerator> random;
+  NiceMock<Upstream::MockClusterManager> cluster_manager;
+  NiceMock<Init::MockManager> init_manager;
+  ON_CALL(factory_context_, localInfo()).WillByDefault(ReturnRef(local_info));
+  ON_CALL(factory_context_, dispatcher()).WillByDefault(ReturnRef(*dispatcher_));
+  ON_CALL(factory_context_, random()).WillByDefault(ReturnRef(random));
+  ON_CALL(factory_context_, stats()).WillByDefault(ReturnRef(stats_store));
+  ON_CALL(factory_context_, clusterManager()).WillByDefault(ReturnRef(cluster_manager));
+  ON_CALL(factory_context_, initManager()).WillByDefault(Return(&init_manager));
+
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  envoy::api::v2::auth::TlsCertificate* server_cert =
+      tls_context.mutable_common_tls_context()->add_tls_certificates();
+  server_cert->mutable_certificate_chain()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestcert.pem"));
+  server_cert->mutable_private_key()->set_filename(
+      TestEnvironment::substitute("{{ test_tmpdir }}/unittestkey.pem"));
+  auto* sds_secret_config = tls_context.mutable_session_ticket_keys_sds_secret_config();
+  sds_secret_config->set_name("ticket_keys");
+  sds_secret_config->mutable_sds_config();
+
+  auto server_cfg = std::make_unique<ServerContextConfigImpl>(tls_context, factory_context_);
+  EXPECT_FALSE(server_cfg->isReady());
+  Ssl::ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager, stats_store,
+                                                        std::vector<std::string>{});
+  auto secret_provider =
+      factory_context_.secretManager().findOrCreateTlsSessionTicketKeysProvider(
+          sds_secret_config->sds_config(), "ticket_keys", factory_context_);
+
+  const auto updateKeys = [&](const std::vector<std::string>& keys) {
+    Protobuf::RepeatedPtrField<envoy::api::v2::auth::Secret> secret_resources;
+    auto* secret = secret_resources.Add();
+    secret->set_name("ticket_keys");
+    for (const std::string& key : keys) {
+      secret->mutable_session_ticket_keys()->add_keys()->set_inline_bytes(key);
+    }
+    dynamic_cast<Secret::SdsApi&>(*secret_provider).onConfigUpdate(secret_resources, "");
+  };
+  const std::string key_a = TestEnvironment::readFileToStringForTest(
+      TestEnvironment::substitute("{{ test_rundir }}/test/common/ssl/test_data/ticket_key_a"));
+  const std::string key_b = TestEnvironment::readFileToStringForTest(
+      TestEnvironment::substitute("{{ test_rundir }}/test/common/ssl/test_data/ticket_key_b"));
+  const std::string key_c(80, 'c');
+
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr,
+                                  true);
+  NiceMock<Network::MockListenerCallbacks> callbacks;
+  Network::ListenerPtr listener = dispatcher_->createListener(socket, callbacks, true, false);
+
+  Json::ObjectSharedPtr client_ctx_loader = TestEnvironment::jsonLoadFromString("{}");
+  auto client_cfg = std::make_unique<ClientContextConfigImpl>(*client_ctx_loader, factory_context_);
+  ClientSslSocketFactory client_ssl_socket_factory(std::move(client_cfg), manager, stats_store);
+
+  Network::ConnectionPtr server_connection;
+  EXPECT_CALL(callbacks, onAccept_(_, _))
+      .WillRepeatedly(Invoke([&](Network::ConnectionSocketPtr& socket, bool) -> void {
+        Network::ConnectionPtr new_connection = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory.createTransportSocket());
+        callbacks.onNewConnection(std::move(new_connection));
+      }));
+
+  // Connects, resuming resume_session if set, and keeps the session of the connection.
+  bssl::UniquePtr<SSL_SESSION> session;
+  const auto connect = [&](SSL_SESSION* resume_session) -> bool {
+    Network::ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+        socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
+        client_ssl_socket_factory.createTransportSocket(), nullptr);
+    SSL* client_ssl =
+        dynamic_cast<const Ssl::SslSocket*>(client_connection->ssl())->rawSslForTest();
+    if (resume_session != nullptr) {
+      SSL_set_session(client_ssl, resume_session);
+    }
+    Network::MockConnectionCallbacks client_connection_callbacks;
+    client_connection->addConnectionCallbacks(client_connection_callbacks);
+    client_connection->connect();
+
+    Network::MockConnectionCallbacks server_connection_callbacks;
+    EXPECT_CALL(callbacks, onNewConnection_(_))
+        .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+          server_connection = std::move(conn);
+          server_connection->addConnectionCallbacks(server_connection_callbacks);
+        }));
+
+    // Wait for both sides to complete the handshake.
+    unsigned connect_count = 0;
+    auto stopSecondTime = [&]() {
+      if (++connect_count == 2) {
+        client_connection->close(Network::ConnectionCloseType::NoFlush);
+        server_connection->close(Network::ConnectionCloseType::NoFlush);
+        dispatcher_->exit();
+      }
+    };
+    EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { stopSecondTime(); }));
+    EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+          session.reset(SSL_get1_session(client_ssl));
+          stopSecondTime();
+        }));
+    EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+    EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+    server_connection.reset();
+    return SSL_session_reused(client_ssl);
+  };
+
+  // The first keys complete the config, which builds the context.
+  updateKeys({key_a});
+  EXPECT_EQ(1UL, stats_store.counter("server.ssl_context_update_by_sds").value());
+  EXPECT_FALSE(connect(nullptr));
+  bssl::UniquePtr<SSL_SESSION> key_a_session = std::move(session);
+  EXPECT_TRUE(connect(key_a_session.get()));
+
+  // Key a only decrypts now, and the context is kept.
+  updateKeys({key_b});
+  EXPECT_EQ(1UL, stats_store.counter("server.ssl_context_update_by_sds").value());
+  EXPECT_EQ(1UL, stats_store.counter("server.session_ticket_keys_update_by_sds").value());
+  EXPECT_TRUE(connect(key_a_session.get()));
+  bssl::UniquePtr<SSL_SESSION> key_b_session = std::move(session);
+
+  // Key a is gone after the next rotation, while key b only decrypts.
+  updateKeys({key_c});
+  EXPECT_EQ(2UL, stats_store.counter("server.session_ticket_keys_update_by_sds").value());
+  EXPECT_FALSE(connect(key_a_session.get()));
+  EXPECT_TRUE(connect(key_b_session.get()));
+}
+
 // Sessions cannot be resumed because the server certificates are different and the SANs
 // are not identical
 TEST_P(SslSocketTest, TicketSessionResumptionDifferentServerCertDifferentSAN) {
@@ -0,0 +1,54 @@
+#include <string>
+
+#include "common/stats/dynamic_stats_cache.h"
+
+#include "test/mocks/stats/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Stats {
+namespace {
+
+// A name is looked up in the scope once, whatever the pieces it is built from.
+TEST(DynamicStatsCacheTest, LookupOnce) {
+  NiceMock<MockStore> store;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  DynamicStatsCache cache(store, tls);
+
+  EXPECT_CALL(store, counter("mongo.collection.foo.query.total"));
+  cache.counter({"mongo.", "collection.", "foo", ".query.total"}).inc();
+  cache.counter({"mongo.collection.", "foo.query", ".total"}).inc();
+
+  EXPECT_CALL(store, histogram("mongo.collection.foo.query.total"));
+  cache.histogram({"mongo.collection.foo", ".query.total"}).recordValue(1);
+  cache.histogram({"mongo.collection.foo", ".query.total"}).recordValue(2);
+  EXPECT_EQ(2, cache.size());
+}
+
+// The cache starts over once it is full, and the stats it handed out stay valid.
+TEST(DynamicStatsCacheTest, MaxEntries) {
+  NiceMock<MockStore> store;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  DynamicStatsCache cache(store, tls, 2);
+
+  EXPECT_CALL(store, counter(_)).Times(4);
+  cache.counter({"a"});
+  cache.counter({"b"});
+  cache.counter({"a"});
+  EXPECT_EQ(2, cache.size());
+  cache.counter({"c"});
+  EXPECT_EQ(1, cache.size());
+  Counter& a = cache.counter({"a"});
+  EXPECT_EQ(2, cache.size());
+  a.inc();
+}
+
+} // namespace
+} // namespace Stats
+} // namespace Envoy
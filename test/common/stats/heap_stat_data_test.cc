@@ -17,7 +17,7 @@ TEST(HeapStatDataTest, HeapNoTruncate) {
   const std::string long_string(stats_options.maxNameLength() + 1, 'A');
   HeapStatData* stat{};
   EXPECT_NO_LOGS(stat = alloc.alloc(long_string));
-  EXPECT_EQ(stat->key(), long_string);
+  EXPECT_EQ(stat->name(), long_string);
   alloc.free(*stat);
 }
 
@@ -38,5 +38,26 @@ TEST(HeapStatDataTest, HeapAlloc) {
   alloc.free(*stat_3);
 }
 
+// Names are stored as symbols, and decoded back to the original name.
+TEST(HeapStatDataTest, HeapSymbolizedNames) {
+  HeapStatDataAllocator alloc;
+  HeapStatData* stat_1 = alloc.alloc("cluster.foo.upstream_cx_total");
+  HeapStatData* stat_2 = alloc.alloc("cluster.foo.upstream_rq_total");
+  HeapStatData* stat_3 = alloc.alloc("cluster..foo.");
+  EXPECT_EQ(3U, stat_1->symbols().size());
+  EXPECT_EQ(stat_1->symbols()[0], stat_2->symbols()[0]);
+  EXPECT_EQ(stat_1->symbols()[1], stat_2->symbols()[1]);
+  EXPECT_NE(stat_1->symbols()[2], stat_2->symbols()[2]);
+  EXPECT_EQ("cluster.foo.upstream_cx_total", stat_1->name());
+  EXPECT_EQ("cluster.foo.upstream_rq_total", stat_2->name());
+  EXPECT_EQ("cluster..foo.", stat_3->name());
+  alloc.free(*stat_1);
+
+  // Symbols shared with a freed stat remain valid.
+  EXPECT_EQ("cluster.foo.upstream_rq_total", stat_2->name());
+  alloc.free(*stat_2);
+  alloc.free(*stat_3);
+}
+
 } // namespace Stats
 } // namespace Envoy
@@ -1,5 +1,6 @@
 #include <vector>
 
+#include "common/stats/isolated_store_impl.h"
 #include "common/stats/source_impl.h"
 
 #include "test/mocks/stats/mocks.h"
@@ -47,5 +48,57 @@ TEST(SourceImplTest, Caching) {
   EXPECT_EQ(source.cachedHistograms(), stored_histograms);
 }
 
+// Counters are latched once per snapshot, and unused metrics are left out.
+TEST(SourceImplTest, Snapshots) {
+  IsolatedStoreImpl store;
+  SourceImpl source(store);
+  store.counter("c1").add(3);
+  store.counter("c2");
+  store.gauge("g1").set(7);
+  store.gauge("g2");
+
+  ASSERT_EQ(1U, source.cachedCounterSnapshots().size());
+  EXPECT_EQ("c1", source.cachedCounterSnapshots()[0].counter_.get().name());
+  EXPECT_EQ(3U, source.cachedCounterSnapshots()[0].delta_);
+  ASSERT_EQ(1U, source.cachedGaugeSnapshots().size());
+  EXPECT_EQ("g1", source.cachedGaugeSnapshots()[0].gauge_.get().name());
+  EXPECT_EQ(7U, source.cachedGaugeSnapshots()[0].value_);
+
+  // The counter was latched by the first snapshot only.
+  EXPECT_EQ(0U, store.counter("c1").latch());
+  source.clearCache();
+  ASSERT_EQ(1U, source.cachedCounterSnapshots().size());
+  EXPECT_EQ(0U, source.cachedCounterSnapshots()[0].delta_);
+  ASSERT_EQ(1U, source.cachedGaugeSnapshots().size());
+}
+
+// Only metrics that changed since the previous snapshot are included.
+TEST(SourceImplTest, ChangedMetricsOnly) {
+  IsolatedStoreImpl store;
+  SourceImpl source(store);
+  source.setChangedMetricsOnly(true);
+  store.counter("c1").inc();
+  store.counter("c2").inc();
+  store.gauge("g1").set(1);
+  store.gauge("g2").set(2);
+
+  EXPECT_EQ(2U, source.cachedCounterSnapshots().size());
+  EXPECT_EQ(2U, source.cachedGaugeSnapshots().size());
+
+  source.clearCache();
+  store.counter("c2").add(5);
+  store.gauge("g1").set(3);
+  ASSERT_EQ(1U, source.cachedCounterSnapshots().size());
+  EXPECT_EQ("c2", source.cachedCounterSnapshots()[0].counter_.get().name());
+  EXPECT_EQ(5U, source.cachedCounterSnapshots()[0].delta_);
+  ASSERT_EQ(1U, source.cachedGaugeSnapshots().size());
+  EXPECT_EQ("g1", source.cachedGaugeSnapshots()[0].gauge_.get().name());
+  EXPECT_EQ(3U, source.cachedGaugeSnapshots()[0].value_);
+
+  source.clearCache();
+  EXPECT_EQ(0U, source.cachedCounterSnapshots().size());
+  EXPECT_EQ(0U, source.cachedGaugeSnapshots().size());
+}
+
 } // namespace Stats
 } // namespace Envoy
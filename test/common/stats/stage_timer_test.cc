@@ -0,0 +1,74 @@
+#include "common/stats/stage_timer.h"
+
+#include "test/mocks/stats/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Stats {
+
+class StageTimerTest : public testing::Test {
+public:
+  StageTimerTest()
+      : stats_{codec_dispatch_, decoder_filters_, encoder_filters_,
+               lb_choose_host_, tls_read_, tls_write_} {
+    for (MockHistogram* histogram : {&codec_dispatch_, &decoder_filters_, &encoder_filters_,
+                                     &lb_choose_host_, &tls_read_, &tls_write_}) {
+      histogram->store_ = nullptr;
+    }
+  }
+
+  ~StageTimerTest() { StageTimers::disable(); }
+
+  NiceMock<MockHistogram> codec_dispatch_;
+  NiceMock<MockHistogram> decoder_filters_;
+  NiceMock<MockHistogram> encoder_filters_;
+  NiceMock<MockHistogram> lb_choose_host_;
+  NiceMock<MockHistogram> tls_read_;
+  NiceMock<MockHistogram> tls_write_;
+  StageTimerStats stats_;
+};
+
+TEST_F(StageTimerTest, Disabled) {
+  EXPECT_EQ(nullptr, StageTimers::sample(Stage::TlsRead));
+  EXPECT_CALL(tls_read_, recordValue(_)).Times(0);
+  StageTimer timer(Stage::TlsRead);
+}
+
+TEST_F(StageTimerTest, RecordsEveryStage) {
+  StageTimers::enable(stats_, 1);
+  EXPECT_EQ(&codec_dispatch_, StageTimers::sample(Stage::HttpCodecDispatch));
+  EXPECT_EQ(&decoder_filters_, StageTimers::sample(Stage::HttpDecoderFilters));
+  EXPECT_EQ(&encoder_filters_, StageTimers::sample(Stage::HttpEncoderFilters));
+  EXPECT_EQ(&lb_choose_host_, StageTimers::sample(Stage::LbChooseHost));
+  EXPECT_EQ(&tls_read_, StageTimers::sample(Stage::TlsRead));
+  EXPECT_EQ(&tls_write_, StageTimers::sample(Stage::TlsWrite));
+
+  EXPECT_CALL(lb_choose_host_, recordValue(_));
+  { StageTimer timer(Stage::LbChooseHost); }
+}
+
+TEST_F(StageTimerTest, SamplesEachStageSeparately) {
+  StageTimers::enable(stats_, 3);
+  // Interleaving the stages does not change which executions of each stage are sampled.
+  EXPECT_CALL(tls_read_, recordValue(_)).Times(2);
+  EXPECT_CALL(tls_write_, recordValue(_)).Times(2);
+  for (int i = 0; i < 6; i++) {
+    StageTimer read_timer(Stage::TlsRead);
+    StageTimer write_timer(Stage::TlsWrite);
+  }
+}
+
+TEST_F(StageTimerTest, DisableStopsRecording) {
+  StageTimers::enable(stats_, 1);
+  StageTimers::disable();
+  EXPECT_CALL(tls_write_, recordValue(_)).Times(0);
+  StageTimer timer(Stage::TlsWrite);
+}
+
+} // namespace Stats
+} // namespace Envoy
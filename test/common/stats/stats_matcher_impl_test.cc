@@ -0,0 +1,77 @@
+#include "envoy/config/metrics/v2/stats.pb.h"
+
+#include "common/stats/stats_matcher_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+
+class StatsMatcherTest : public testing::Test {
+protected:
+  envoy::type::matcher::StringMatcher* inclusionList() {
+    return stats_config_.mutable_stats_matcher()->mutable_inclusion_list()->add_patterns();
+  }
+  envoy::type::matcher::StringMatcher* exclusionList() {
+    return stats_config_.mutable_stats_matcher()->mutable_exclusion_list()->add_patterns();
+  }
+  void initMatcher() { stats_matcher_ = std::make_unique<StatsMatcherImpl>(stats_config_); }
+
+  envoy::config::metrics::v2::StatsConfig stats_config_;
+  std::unique_ptr<StatsMatcherImpl> stats_matcher_;
+};
+
+TEST_F(StatsMatcherTest, CheckDefault) {
+  // With no matcher, all stats are created.
+  initMatcher();
+  EXPECT_FALSE(stats_matcher_->rejects("foo"));
+  EXPECT_FALSE(stats_matcher_->rejects(""));
+}
+
+TEST_F(StatsMatcherTest, CheckRejectAll) {
+  stats_config_.mutable_stats_matcher()->set_reject_all(true);
+  initMatcher();
+  EXPECT_TRUE(stats_matcher_->rejects("foo"));
+  EXPECT_TRUE(stats_matcher_->rejects(""));
+
+  stats_config_.mutable_stats_matcher()->set_reject_all(false);
+  initMatcher();
+  EXPECT_FALSE(stats_matcher_->rejects("foo"));
+}
+
+TEST_F(StatsMatcherTest, CheckExclusion) {
+  exclusionList()->set_exact("cluster.foo.upstream_rq_total");
+  exclusionList()->set_prefix("listener.");
+  exclusionList()->set_suffix(".upstream_cx_length_ms");
+  exclusionList()->set_regex(".*\\.http1\\..*");
+  initMatcher();
+
+  EXPECT_TRUE(stats_matcher_->rejects("cluster.foo.upstream_rq_total"));
+  EXPECT_FALSE(stats_matcher_->rejects("cluster.foo.upstream_rq_total2"));
+  EXPECT_TRUE(stats_matcher_->rejects("listener.0.0.0.0_80.downstream_cx_total"));
+  EXPECT_TRUE(stats_matcher_->rejects("cluster.foo.upstream_cx_length_ms"));
+  EXPECT_TRUE(stats_matcher_->rejects("cluster.foo.http1.dropped_headers"));
+  EXPECT_FALSE(stats_matcher_->rejects("cluster.foo.upstream_cx_total"));
+  EXPECT_FALSE(stats_matcher_->rejects("server.listener.count"));
+}
+
+TEST_F(StatsMatcherTest, CheckInclusion) {
+  inclusionList()->set_prefix("cluster.");
+  inclusionList()->set_exact("server.live");
+  initMatcher();
+
+  EXPECT_FALSE(stats_matcher_->rejects("cluster.foo.upstream_rq_total"));
+  EXPECT_FALSE(stats_matcher_->rejects("server.live"));
+  EXPECT_TRUE(stats_matcher_->rejects("server.uptime"));
+  EXPECT_TRUE(stats_matcher_->rejects("listener.0.0.0.0_80.downstream_cx_total"));
+}
+
+TEST_F(StatsMatcherTest, InvalidRegex) {
+  exclusionList()->set_regex("(+invalid");
+  EXPECT_THROW(initMatcher(), EnvoyException);
+}
+
+} // namespace Stats
+} // namespace Envoy
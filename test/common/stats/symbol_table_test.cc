@@ -1,10 +1,12 @@
 #include <string>
 
+#include "common/common/thread.h"
 #include "common/stats/symbol_table_impl.h"
 
 #include "test/test_common/logging.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
 
 namespace Envoy {
@@ -180,5 +182,25 @@ TEST_F(StatNameTest, TestShrinkingExpectation) {
   EXPECT_EQ(table_size_0, table_.size());
 }
 
+TEST_F(StatNameTest, ConcurrentEncodeAndFree) {
+  // Threads repeatedly create and release names sharing most of their segments, so that references
+  // are taken on symbols whose last reference is concurrently being released.
+  StatNamePtr stat_a = table_.encode("a");
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < 4; ++i) {
+    threads.emplace_back(new Thread::Thread([this, i]() -> void {
+      for (uint32_t j = 0; j < 1000; ++j) {
+        const std::string name = absl::StrCat("a.b", j % 3, ".c", (i + j) % 2);
+        EXPECT_EQ(name, table_.encode(name)->toString());
+      }
+    }));
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ("a", stat_a->toString());
+  EXPECT_EQ(1, table_.size());
+}
+
 } // namespace Stats
 } // namespace Envoy
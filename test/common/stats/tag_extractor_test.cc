@@ -3,6 +3,7 @@
 #include "envoy/common/exception.h"
 #include "envoy/config/metrics/v2/stats.pb.h"
 
+#include "common/common/regex.h"
 #include "common/config/well_known_names.h"
 #include "common/stats/tag_extractor_impl.h"
 #include "common/stats/tag_producer_impl.h"
@@ -63,6 +64,56 @@ TEST(TagExtractorTest, BadRegex) {
                           EnvoyException, "Invalid regex '\\+invalid':");
 }
 
+// Regexes of the forms matched without a regex engine extract the same tags as the regexes.
+TEST(TagExtractorTest, CompiledExtractorsMatchRegexes) {
+  const std::vector<std::string> regexes = {"^cluster\\.((.*?)\\.)",
+                                            "^auth\\.clientssl\\.((.*?)\\.)\\w+?$",
+                                            "_rq(_(\\d{3}))$", "_rq_(\\d)xx$", "x(\\d{2})(y)$"};
+  const std::vector<std::string> names = {"cluster.foo.upstream_rq_200",
+                                          "cluster..upstream_rq_2xx",
+                                          "cluster.foo",
+                                          "cluster.fo\no.bar",
+                                          "clusterfoo.bar",
+                                          "auth.clientssl.foo.bar.total",
+                                          "auth.clientssl.foo.bar.",
+                                          "auth.clientssl.total",
+                                          "auth.clientssl..total",
+                                          "auth.clientssl.foo.to-tal",
+                                          "upstream_rq_20",
+                                          "_rq_200",
+                                          "upstream_rq_2xxx",
+                                          "x12y",
+                                          "x1yy"};
+  for (const std::string& regex : regexes) {
+    const TagExtractorPtr compiled = TagExtractorImpl::createTagExtractor("foo", regex);
+    const TagExtractorImpl reference("foo", regex);
+    EXPECT_EQ(nullptr, dynamic_cast<const TagExtractorImpl*>(compiled.get())) << regex;
+    EXPECT_EQ(reference.prefixToken(), compiled->prefixToken()) << regex;
+    for (const std::string& name : names) {
+      std::vector<Tag> tags;
+      IntervalSetImpl<size_t> remove_characters;
+      std::vector<Tag> reference_tags;
+      IntervalSetImpl<size_t> reference_remove_characters;
+      EXPECT_EQ(reference.extractTag(name, reference_tags, reference_remove_characters),
+                compiled->extractTag(name, tags, remove_characters))
+          << regex << " " << name;
+      EXPECT_EQ(StringUtil::removeCharacters(name, reference_remove_characters),
+                StringUtil::removeCharacters(name, remove_characters))
+          << regex << " " << name;
+      ASSERT_EQ(reference_tags.size(), tags.size());
+      if (!tags.empty()) {
+        EXPECT_EQ(reference_tags[0].value_, tags[0].value_) << regex << " " << name;
+      }
+    }
+  }
+
+  // Anything else is left to the regex engine.
+  for (const std::string regex : {"^cluster\\.((.+?)\\.)", "_rq(_(\\d+))$", "^cluster\\.(\\w+)$"}) {
+    const TagExtractorPtr extractor = TagExtractorImpl::createTagExtractor("foo", regex);
+    EXPECT_NE(nullptr, dynamic_cast<const TagExtractorImpl*>(extractor.get())) << regex;
+  }
+}
+
 class DefaultTagRegexTester {
 public:
   DefaultTagRegexTester() : tag_extractors_(envoy::config::metrics::v2::StatsConfig()) {}
@@ -338,7 +389,10 @@ TEST(TagExtractorTest, ExtractRegexPrefix) {
 
   EXPECT_EQ("", extractRegexPrefix("^prefix(foo)."));
   EXPECT_EQ("prefix", extractRegexPrefix("^prefix\\.foo"));
+  // Lookahead assertions are only supported by std::regex.
+  Regex::Utility::setDefaultEngine(Regex::Engine::StdRegex);
   EXPECT_EQ("prefix_optional", extractRegexPrefix("^prefix_optional(?=\\.)"));
+  Regex::Utility::setDefaultEngine(Regex::Engine::GoogleRe2);
   EXPECT_EQ("", extractRegexPrefix("^notACompleteToken"));   //
   EXPECT_EQ("onlyToken", extractRegexPrefix("^onlyToken$")); //
   EXPECT_EQ("", extractRegexPrefix("(prefix)"));
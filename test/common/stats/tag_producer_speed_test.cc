@@ -0,0 +1,55 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+#include <vector>
+
+#include "envoy/config/metrics/v2/stats.pb.h"
+
+#include "common/stats/tag_producer_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Stats {
+
+// A sample of the stats created for each cluster.
+static const std::vector<std::string> ClusterStatNames = {
+    "upstream_cx_total", "upstream_cx_active", "upstream_cx_connect_fail", "upstream_rq_total",
+    "upstream_rq_active", "upstream_rq_timeout", "upstream_rq_200", "upstream_rq_2xx",
+    "upstream_rq_503", "upstream_rq_5xx", "membership_healthy", "lb_healthy_panic"};
+
+// Extracts the default tags from the stat names of range(0) clusters, as happens when CDS delivers
+// many clusters at once, reporting the names processed per second.
+static void BM_ProduceTags(benchmark::State& state) {
+  const TagProducerImpl tag_producer{envoy::config::metrics::v2::StatsConfig()};
+  std::vector<std::string> names;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    for (const std::string& stat_name : ClusterStatNames) {
+      names.push_back(fmt::format("cluster.cluster_{}.{}", i, stat_name));
+    }
+  }
+
+  size_t size = 0;
+  for (auto _ : state) {
+    for (const std::string& name : names) {
+      std::vector<Tag> tags;
+      size += tag_producer.produceTags(name, tags).size();
+    }
+  }
+  benchmark::DoNotOptimize(size);
+  state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(BM_ProduceTags)->Arg(1)->Arg(1000);
+
+} // namespace Stats
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,96 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/memory/stats.h"
+#include "common/stats/heap_stat_data.h"
+#include "common/stats/stats_options_impl.h"
+#include "common/stats/thread_local_store.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Stats {
+
+// A sample of the stats created for each cluster.
+static const std::vector<std::string> ClusterStatNames = {
+    "upstream_cx_total", "upstream_cx_active", "upstream_cx_http1_total", "upstream_cx_http2_total",
+    "upstream_cx_connect_fail", "upstream_cx_destroy", "upstream_rq_total", "upstream_rq_active",
+    "upstream_rq_pending_total", "upstream_rq_pending_active", "upstream_rq_timeout",
+    "upstream_rq_retry", "membership_change", "membership_healthy", "membership_total",
+    "update_attempt", "update_success", "update_failure", "lb_healthy_panic", "max_host_weight"};
+
+// Creates range(1) cluster-like scopes, spread across range(0) threads, each populated with a set
+// of counters, as happens when CDS delivers many clusters at once.
+static void BM_CreateScopesConcurrently(benchmark::State& state) {
+  const uint32_t num_threads = state.range(0);
+  const uint32_t num_scopes = state.range(1);
+  StatsOptionsImpl options;
+  HeapStatDataAllocator alloc;
+  for (auto _ : state) {
+    ThreadLocalStoreImpl store(options, alloc);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < num_threads; ++i) {
+      threads.emplace_back([&store, i, num_threads, num_scopes]() -> void {
+        std::vector<ScopePtr> scopes;
+        for (uint32_t j = i; j < num_scopes; j += num_threads) {
+          scopes.emplace_back(store.createScope(fmt::format("cluster.cluster_{}.", j)));
+          for (const std::string& name : ClusterStatNames) {
+            scopes.back()->counter(name);
+          }
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    store.shutdownThreading();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * num_scopes);
+}
+BENCHMARK(BM_CreateScopesConcurrently)
+    ->ArgPair(1, 10000)
+    ->ArgPair(2, 10000)
+    ->ArgPair(4, 10000)
+    ->ArgPair(8, 10000)
+    ->UseRealTime();
+
+// Reports the heap memory used by range(0) cluster-like scopes and their counters, per cluster.
+// This relies on tcmalloc, and reports zero without it.
+static void BM_MemoryPerCluster(benchmark::State& state) {
+  const uint32_t num_scopes = state.range(0);
+  StatsOptionsImpl options;
+  HeapStatDataAllocator alloc;
+  uint64_t bytes = 0;
+  for (auto _ : state) {
+    ThreadLocalStoreImpl store(options, alloc);
+    const uint64_t start = Memory::Stats::totalCurrentlyAllocated();
+    std::vector<ScopePtr> scopes;
+    for (uint32_t i = 0; i < num_scopes; ++i) {
+      scopes.emplace_back(store.createScope(fmt::format("cluster.cluster_{}.", i)));
+      for (const std::string& name : ClusterStatNames) {
+        scopes.back()->counter(name);
+      }
+    }
+    bytes = Memory::Stats::totalCurrentlyAllocated() - start;
+    scopes.clear();
+    store.shutdownThreading();
+  }
+  state.counters["bytes_per_cluster"] = static_cast<double>(bytes) / num_scopes;
+}
+BENCHMARK(BM_MemoryPerCluster)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+} // namespace Stats
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -1,9 +1,11 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 #include "common/common/c_smart_ptr.h"
+#include "common/stats/stats_matcher_impl.h"
 #include "common/stats/thread_local_store.h"
 
 #include "test/mocks/event/mocks.h"
@@ -314,6 +316,92 @@ TEST_F(StatsThreadLocalStoreTest, ScopeDelete) {
   EXPECT_CALL(*alloc_, free(_));
 }
 
+TEST_F(StatsThreadLocalStoreTest, CardinalityLimit) {
+  InSequence s;
+  EXPECT_CALL(*alloc_, alloc(_));
+  store_->setCardinalityLimit("cluster.", 2);
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  ScopePtr scope1 = store_->createScope("cluster.a.");
+  EXPECT_CALL(*alloc_, alloc(_)).Times(2);
+  scope1->counter("c1");
+  scope1->gauge("g1");
+
+  // Refused stats take no shared memory and are not listed, but can still be used.
+  Counter& c2 = scope1->counter("c2");
+  c2.inc();
+  EXPECT_EQ(&c2, &scope1->counter("c2"));
+  scope1->gauge("g2").set(5);
+  EXPECT_EQ(2UL, store_->counter("stats.cardinality_limited").value());
+  EXPECT_EQ(3UL, store_->counters().size());
+  EXPECT_EQ(1UL, store_->gauges().size());
+
+  // Stats outside of the prefix are not limited.
+  EXPECT_CALL(*alloc_, alloc(_));
+  store_->counter("other");
+
+  // Deleting the scope makes room again.
+  EXPECT_CALL(main_thread_dispatcher_, post(_));
+  EXPECT_CALL(tls_, runOnAllThreads(_));
+  EXPECT_CALL(*alloc_, free(_)).Times(2);
+  scope1.reset();
+
+  ScopePtr scope2 = store_->createScope("cluster.b.");
+  EXPECT_CALL(*alloc_, alloc(_)).Times(2);
+  scope2->counter("c1");
+  scope2->counter("c2");
+  EXPECT_EQ(2UL, store_->counter("stats.cardinality_limited").value());
+  EXPECT_EQ(5UL, store_->counters().size());
+
+  EXPECT_CALL(main_thread_dispatcher_, post(_));
+  EXPECT_CALL(tls_, runOnAllThreads(_));
+  EXPECT_CALL(*alloc_, free(_)).Times(2);
+  scope2.reset();
+
+  store_->shutdownThreading();
+  tls_.shutdownThread();
+
+  // Includes the overflow, cardinality_limited and other stats.
+  EXPECT_CALL(*alloc_, free(_)).Times(3);
+}
+
+TEST_F(StatsThreadLocalStoreTest, StatsMatcher) {
+  InSequence s;
+  envoy::config::metrics::v2::StatsConfig stats_config;
+  stats_config.mutable_stats_matcher()->mutable_exclusion_list()->add_patterns()->set_prefix(
+      "cluster.");
+  store_->setStatsMatcher(std::make_unique<StatsMatcherImpl>(stats_config));
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  // Rejected stats take no shared memory and are not listed, but can still be used.
+  ScopePtr scope1 = store_->createScope("cluster.a.");
+  Counter& c1 = scope1->counter("c1");
+  c1.inc();
+  EXPECT_EQ(&c1, &scope1->counter("c1"));
+  scope1->gauge("g1").set(5);
+  Histogram& h1 = scope1->histogram("h1");
+  h1.recordValue(100);
+  EXPECT_EQ(&h1, &scope1->histogram("h1"));
+  EXPECT_EQ(1UL, store_->counters().size());
+  EXPECT_EQ(0UL, store_->gauges().size());
+  EXPECT_EQ(0UL, store_->histograms().size());
+
+  // Other stats are created as usual.
+  EXPECT_CALL(*alloc_, alloc(_));
+  store_->counter("other");
+  EXPECT_EQ(2UL, store_->counters().size());
+
+  EXPECT_CALL(main_thread_dispatcher_, post(_));
+  EXPECT_CALL(tls_, runOnAllThreads(_));
+  scope1.reset();
+
+  store_->shutdownThreading();
+  tls_.shutdownThread();
+
+  // Includes the overflow and other stats.
+  EXPECT_CALL(*alloc_, free(_)).Times(2);
+}
+
 TEST_F(StatsThreadLocalStoreTest, NestedScopes) {
   InSequence s;
   store_->initializeThreading(main_thread_dispatcher_, tls_);
@@ -492,6 +580,35 @@ TEST_F(HeapStatsThreadLocalStoreTest, NonHotRestartNoTruncation) {
   tls_.shutdownThread();
 }
 
+// Scopes are populated concurrently from several threads, each thread contending with the others
+// on overlapping scopes that share stats.
+TEST_F(HeapStatsThreadLocalStoreTest, ConcurrentScopeCreation) {
+  const uint32_t num_threads = 4;
+  const uint32_t num_scopes = 50;
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    threads.emplace_back([this, i]() -> void {
+      for (uint32_t j = 0; j < num_scopes; ++j) {
+        ScopePtr own_scope = store_->createScope(fmt::format("thread{}.scope{}.", i, j));
+        own_scope->counter("c1").inc();
+        own_scope->gauge("g1").set(j);
+        ScopePtr shared_scope = store_->createScope(fmt::format("shared{}.", j));
+        shared_scope->counter("c1").inc();
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  // The scopes are gone, only the overflow stat in the default scope remains.
+  EXPECT_EQ(1UL, store_->counters().size());
+  EXPECT_EQ(0UL, store_->gauges().size());
+  EXPECT_EQ(0UL, store_->counter("stats.overflow").value());
+
+  store_->shutdownThreading();
+}
+
 TEST_F(StatsThreadLocalStoreTest, ShuttingDown) {
   InSequence s;
   store_->initializeThreading(main_thread_dispatcher_, tls_);
@@ -597,6 +714,21 @@ TEST_F(HistogramTest, MultiHistogramMultipleMerges) {
   EXPECT_EQ(2, validateMerge());
 }
 
+TEST_F(HistogramTest, UnchangedHistogramMerges) {
+  Histogram& h1 = store_->histogram("h1");
+
+  expectCallAndAccumulate(h1, 5);
+  EXPECT_EQ(1, validateMerge());
+
+  // Intervals without values keep the cumulative statistics and empty the interval ones, however
+  // many of them there are.
+  EXPECT_EQ(1, validateMerge());
+  EXPECT_EQ(1, validateMerge());
+
+  expectCallAndAccumulate(h1, 7);
+  EXPECT_EQ(1, validateMerge());
+}
+
 TEST_F(HistogramTest, BasicScopeHistogramMerge) {
   ScopePtr scope1 = store_->createScope("scope1.");
 
@@ -0,0 +1,148 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "common/event/dispatcher_impl.h"
+#include "common/tcp_proxy/splice_forwarder.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/test_time.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::InSequence;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::_;
+
+namespace Envoy {
+namespace TcpProxy {
+namespace {
+
+class MockSpliceCallbacks : public SpliceForwarder::Callbacks {
+public:
+  MOCK_METHOD1(onSplicedUpstream, void(uint64_t bytes));
+  MOCK_METHOD1(onSplicedDownstream, void(uint64_t bytes));
+  MOCK_METHOD1(onSpliceComplete, void(bool error));
+};
+
+#ifdef __linux__
+
+class SpliceForwarderTest : public testing::Test {
+public:
+  SpliceForwarderTest() : dispatcher_(test_time_.timeSystem()) {
+    // client <-> downstream and upstream <-> server stand in for the two proxied connections.
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, client_fds_));
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, server_fds_));
+    ON_CALL(downstream_, fd()).WillByDefault(Return(client_fds_[1]));
+    ON_CALL(upstream_, fd()).WillByDefault(Return(server_fds_[0]));
+  }
+
+  ~SpliceForwarderTest() {
+    forwarder_.reset();
+    for (int fd : {client_fds_[0], client_fds_[1], server_fds_[0], server_fds_[1]}) {
+      close(fd);
+    }
+  }
+
+  // Run the event loop until fd has size bytes to read, and return them.
+  std::string readFrom(int fd, size_t size) {
+    std::string data;
+    while (data.size() < size) {
+      dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+      char buf[1024];
+      const ssize_t rc = read(fd, buf, sizeof(buf));
+      if (rc > 0) {
+        data.append(buf, rc);
+      }
+    }
+    return data;
+  }
+
+  int client_fds_[2];
+  int server_fds_[2];
+  DangerousDeprecatedTestTime test_time_;
+  Event::DispatcherImpl dispatcher_;
+  NiceMock<Network::MockConnection> downstream_;
+  NiceMock<Network::MockConnection> upstream_;
+  MockSpliceCallbacks callbacks_;
+  SpliceForwarderPtr forwarder_;
+};
+
+TEST_F(SpliceForwarderTest, ForwardsBothDirections) {
+  // Data written before the forwarder exists is picked up too.
+  ASSERT_EQ(5, write(client_fds_[0], "hello", 5));
+  forwarder_ = SpliceForwarder::create(dispatcher_, downstream_, upstream_, callbacks_);
+  ASSERT_NE(nullptr, forwarder_);
+
+  EXPECT_CALL(callbacks_, onSplicedUpstream(5));
+  EXPECT_EQ("hello", readFrom(server_fds_[1], 5));
+
+  EXPECT_CALL(callbacks_, onSplicedDownstream(5));
+  ASSERT_EQ(5, write(server_fds_[1], "world", 5));
+  EXPECT_EQ("world", readFrom(client_fds_[0], 5));
+}
+
+TEST_F(SpliceForwarderTest, HalfCloseThenComplete) {
+  forwarder_ = SpliceForwarder::create(dispatcher_, downstream_, upstream_, callbacks_);
+  ASSERT_NE(nullptr, forwarder_);
+
+  // The client half-closes first, and the server still gets to respond.
+  EXPECT_CALL(upstream_, write(_, true)).WillOnce(Invoke([&](Buffer::Instance& data, bool) {
+    EXPECT_EQ(0, data.length());
+    shutdown(server_fds_[0], SHUT_WR);
+  }));
+  shutdown(client_fds_[0], SHUT_WR);
+  char buf[1];
+  while (read(server_fds_[1], buf, sizeof(buf)) != 0) {
+    dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  {
+    InSequence s;
+    EXPECT_CALL(callbacks_, onSplicedDownstream(3));
+    EXPECT_CALL(downstream_, write(_, true)).WillOnce(Invoke([&](Buffer::Instance&, bool) {
+      shutdown(client_fds_[1], SHUT_WR);
+    }));
+    EXPECT_CALL(callbacks_, onSpliceComplete(false)).WillOnce(Invoke([&](bool) {
+      forwarder_->disable();
+    }));
+  }
+  ASSERT_EQ(3, write(server_fds_[1], "bye", 3));
+  shutdown(server_fds_[1], SHUT_WR);
+  EXPECT_EQ("bye", readFrom(client_fds_[0], 3));
+  while (read(client_fds_[0], buf, sizeof(buf)) != 0) {
+    dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  }
+}
+
+TEST_F(SpliceForwarderTest, ErrorOnClosedDestination) {
+  forwarder_ = SpliceForwarder::create(dispatcher_, downstream_, upstream_, callbacks_);
+  ASSERT_NE(nullptr, forwarder_);
+
+  // The server went away, so moving the client's data to it fails.
+  close(server_fds_[1]);
+  server_fds_[1] = -1;
+  bool complete = false;
+  EXPECT_CALL(callbacks_, onSpliceComplete(true)).WillOnce(Invoke([&](bool) {
+    forwarder_->disable();
+    complete = true;
+  }));
+  ASSERT_EQ(5, write(client_fds_[0], "hello", 5));
+  while (!complete) {
+    dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  }
+}
+
+#else
+
+TEST(SpliceForwarderTest, NotSupported) { EXPECT_FALSE(SpliceForwarder::supported()); }
+
+#endif
+
+} // namespace
+} // namespace TcpProxy
+} // namespace Envoy
@@ -83,6 +83,35 @@ TEST_F(ThreadLocalInstanceImplTest, All) {
   tls_.shutdownThread();
 }
 
+// Validate that publish() posts nothing and that set() takes over from it.
+TEST_F(ThreadLocalInstanceImplTest, Publish) {
+  SlotPtr slot = tls_.allocateSlot();
+
+  std::shared_ptr<TestThreadLocalObject> object1(new TestThreadLocalObject());
+  TestThreadLocalObject& object_ref1 = *object1;
+  EXPECT_CALL(thread_dispatcher_, post(_)).Times(0);
+  slot->publish(object1);
+  object1.reset();
+  EXPECT_EQ(&object_ref1, slot->get().get());
+
+  // The first object is released once the main thread, the only one that picked it up, moves to
+  // the second one.
+  std::shared_ptr<TestThreadLocalObject> object2(new TestThreadLocalObject());
+  TestThreadLocalObject& object_ref2 = *object2;
+  slot->publish(object2);
+  object2.reset();
+  EXPECT_CALL(object_ref1, onDestroy());
+  EXPECT_EQ(&object_ref2, slot->get().get());
+
+  EXPECT_CALL(object_ref2, onDestroy());
+  TestThreadLocalObject& object_ref3 = setObject(*slot);
+  EXPECT_EQ(&object_ref3, slot->get().get());
+
+  tls_.shutdownGlobalThreading();
+  EXPECT_CALL(object_ref3, onDestroy());
+  tls_.shutdownThread();
+}
+
 // TODO(ramaraochavali): Run this test with real threads. The current issue in the unit
 // testing environment is, the post to main_dispatcher is not working as expected.
 
@@ -142,5 +171,33 @@ TEST(ThreadLocalInstanceImplDispatcherTest, Dispatcher) {
   tls.shutdownThread();
 }
 
+// Validate that other threads pick up a published object on their next get().
+TEST(ThreadLocalInstanceImplPublishTest, PublishAcrossThreads) {
+  InstanceImpl tls;
+
+  DangerousDeprecatedTestTime test_time;
+  Event::DispatcherImpl main_dispatcher(test_time.timeSystem());
+  Event::DispatcherImpl thread_dispatcher(test_time.timeSystem());
+
+  tls.registerThread(main_dispatcher, true);
+  tls.registerThread(thread_dispatcher, false);
+  SlotPtr slot = tls.allocateSlot();
+
+  auto object1 = std::make_shared<ThreadLocalObject>();
+  slot->publish(object1);
+  Thread::Thread([&slot, &object1]() { EXPECT_EQ(object1, slot->get()); }).join();
+  EXPECT_EQ(object1, slot->get());
+
+  auto object2 = std::make_shared<ThreadLocalObject>();
+  slot->publish(object2);
+  Thread::Thread([&slot, &object2]() { EXPECT_EQ(object2, slot->get()); }).join();
+  EXPECT_EQ(object2, slot->get());
+  // Neither the slot nor any thread holds the first object anymore.
+  EXPECT_EQ(1, object1.use_count());
+
+  tls.shutdownGlobalThreading();
+  tls.shutdownThread();
+}
+
 } // namespace ThreadLocal
 } // namespace Envoy
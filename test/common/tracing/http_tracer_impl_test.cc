@@ -160,6 +160,19 @@ TEST(HttpConnManFinalizerImpl, NullRequestHeaders) {
   HttpTracerUtility::finalizeSpan(*span, nullptr, request_info, config);
 }
 
+TEST(HttpConnManFinalizerImpl, UnsampledSpan) {
+  std::unique_ptr<NiceMock<MockSpan>> span(new NiceMock<MockSpan>());
+  NiceMock<RequestInfo::MockRequestInfo> request_info;
+  Http::TestHeaderMapImpl request_headers{{"x-request-id", "id"}, {":path", "/test"}};
+
+  ON_CALL(*span, sampled()).WillByDefault(Return(false));
+  EXPECT_CALL(*span, setTag(_, _)).Times(0);
+  EXPECT_CALL(*span, finishSpan());
+
+  NiceMock<MockConfig> config;
+  HttpTracerUtility::finalizeSpan(*span, &request_headers, request_info, config);
+}
+
 TEST(HttpConnManFinalizerImpl, UpstreamClusterTagSet) {
   std::unique_ptr<NiceMock<MockSpan>> span(new NiceMock<MockSpan>());
   NiceMock<RequestInfo::MockRequestInfo> request_info;
@@ -295,6 +308,7 @@ TEST(HttpNullTracerTest, BasicFunctionality) {
   span_ptr->setTag("foo", "bar");
   span_ptr->injectContext(request_headers);
   EXPECT_NE(nullptr, span_ptr->spawnChild(config, "foo", std::chrono::system_clock::now()));
+  EXPECT_FALSE(span_ptr->sampled());
 }
 
 class HttpTracerImplTest : public Test {
@@ -338,5 +352,19 @@ TEST_F(HttpTracerImplTest, BasicFunctionalityNodeSet) {
   tracer_->startSpan(config_, request_headers_, request_info_, {Reason::Sampling, true});
 }
 
+TEST_F(HttpTracerImplTest, UnsampledSpanNotTagged) {
+  EXPECT_CALL(request_info_, startTime());
+  EXPECT_CALL(config_, operationName()).Times(2);
+
+  NiceMock<MockSpan>* span = new NiceMock<MockSpan>();
+  ON_CALL(*span, sampled()).WillByDefault(Return(false));
+  EXPECT_CALL(*driver_, startSpan_(_, _, "ingress", request_info_.start_time_, _))
+      .WillOnce(Return(span));
+  EXPECT_CALL(*span, setTag(_, _)).Times(0);
+
+  tracer_->startSpan(config_, request_headers_, request_info_,
+                     {Reason::NotTraceableRequestId, false});
+}
+
 } // namespace Tracing
 } // namespace Envoy
@@ -0,0 +1,58 @@
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "common/upstream/alias_table.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+// Pick with every column and the given fraction of the coin range, and count the results.
+std::vector<uint32_t> pickAll(const AliasTable& table, uint32_t steps) {
+  std::vector<uint32_t> counts(table.size());
+  for (uint64_t column = 0; column < table.size(); ++column) {
+    for (uint64_t step = 0; step < steps; ++step) {
+      const uint64_t coin = (step << 32) / steps;
+      counts[table.pick((column << 32) | coin)]++;
+    }
+  }
+  return counts;
+}
+
+TEST(AliasTableTest, Single) {
+  AliasTable table({3});
+  EXPECT_EQ(1U, table.size());
+  EXPECT_EQ(0U, table.pick(0));
+  EXPECT_EQ(0U, table.pick(std::numeric_limits<uint64_t>::max()));
+}
+
+// Equal weights never use an alias.
+TEST(AliasTableTest, Unweighted) {
+  AliasTable table({1, 1, 1, 1});
+  for (uint64_t column = 0; column < 4; ++column) {
+    EXPECT_EQ(column, table.pick(column << 32));
+    EXPECT_EQ(column, table.pick((column << 32) | 0xFFFFFFFF));
+  }
+}
+
+// Every index is picked exactly in proportion to its weight when the whole random range is
+// covered.
+TEST(AliasTableTest, Weighted) {
+  AliasTable table({1, 2, 3, 0, 10});
+  // The weights sum to 16 over 5 columns, so 16 steps per column give 5 picks per unit of weight.
+  const std::vector<uint32_t> counts = pickAll(table, 16);
+  EXPECT_EQ(std::vector<uint32_t>({5, 10, 15, 0, 50}), counts);
+}
+
+// The column is selected by the upper 32 bits and wraps around the table size.
+TEST(AliasTableTest, ColumnWraps) {
+  AliasTable table({1, 1, 1});
+  EXPECT_EQ(1U, table.pick(4ULL << 32));
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
@@ -146,6 +146,34 @@ TEST_F(CdsApiImplTest, ValidateDuplicateClusters) {
   EXPECT_CALL(request_, cancel());
 }
 
+// Validate that an incremental update only touches the clusters that changed.
+TEST_F(CdsApiImplTest, IncrementalUpdate) {
+  InSequence s;
+
+  setup(true);
+
+  Protobuf::RepeatedPtrField<envoy::api::v2::Cluster> clusters;
+  clusters.Add()->set_name("cluster1");
+  Protobuf::RepeatedPtrField<ProtobufTypes::String> removed;
+  *removed.Add() = "cluster2";
+
+  EXPECT_CALL(cm_, clusters()).Times(0);
+  EXPECT_CALL(cm_, removeCluster("cluster2")).WillOnce(Return(true));
+  expectAdd("cluster1", "1");
+  EXPECT_CALL(initialized_, ready());
+  dynamic_cast<CdsApiImpl*>(cds_.get())->onIncrementalConfigUpdate(clusters, removed, "1");
+  EXPECT_EQ("1", cds_->versionInfo());
+
+  // Duplicates are rejected before any cluster is touched.
+  clusters.Add()->set_name("cluster1");
+  EXPECT_CALL(cm_, removeCluster(_)).Times(0);
+  EXPECT_THROW_WITH_MESSAGE(
+      dynamic_cast<CdsApiImpl*>(cds_.get())->onIncrementalConfigUpdate(clusters, removed, "2"),
+      EnvoyException, "duplicate cluster cluster1 found");
+  EXPECT_EQ("1", cds_->versionInfo());
+  EXPECT_CALL(request_, cancel());
+}
+
 TEST_F(CdsApiImplTest, InvalidOptions) {
   const std::string config_json = R"EOF(
   {
@@ -24,6 +24,7 @@
 #include "test/mocks/tcp/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/logging.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 #include "test/test_common/utility.h"
 
@@ -400,6 +401,36 @@ TEST_F(ClusterManagerImplTest, LocalClusterDefined) {
   factory_.tls_.shutdownThread();
 }
 
+// Thread local clusters other than the local cluster are created on first use, with the hosts
+// posted to the threads until then.
+TEST_F(ClusterManagerImplTest, ThreadLocalClusterCreatedOnFirstUse) {
+  const std::string json = fmt::sprintf(
+      R"EOF(
+  {
+    "local_cluster_name": "new_cluster",
+    %s
+  }
+  )EOF",
+      clustersJson(
+          {defaultStaticClusterJson("cluster_1"), defaultStaticClusterJson("new_cluster")}));
+
+  EXPECT_LOG_NOT_CONTAINS("debug", "creating TLS cluster cluster_1",
+                          create(parseBootstrapFromJson(json)));
+
+  ThreadLocalCluster* cluster = nullptr;
+  EXPECT_LOG_CONTAINS("debug", "creating TLS cluster cluster_1",
+                      cluster = cluster_manager_->get("cluster_1"));
+  ASSERT_NE(nullptr, cluster);
+  EXPECT_EQ(1UL, cluster->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+  EXPECT_NE(nullptr, cluster->loadBalancer().chooseHost(nullptr));
+
+  EXPECT_LOG_NOT_CONTAINS("debug", "creating TLS cluster",
+                          EXPECT_EQ(cluster, cluster_manager_->get("cluster_1")));
+  EXPECT_EQ(nullptr, cluster_manager_->get("cluster_2"));
+
+  factory_.tls_.shutdownThread();
+}
+
 TEST_F(ClusterManagerImplTest, DuplicateCluster) {
   const std::string json = fmt::sprintf(
       "{%s}",
@@ -1031,6 +1062,59 @@ dynamic_warming_clusters:
   EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
 }
 
+// Clusters beyond max_warming_clusters start warming once an earlier cluster has warmed or has gone
+// away, in the order they were added.
+TEST_F(ClusterManagerImplTest, MaxWarmingClusters) {
+  const std::string yaml = R"EOF(
+cluster_manager:
+  max_warming_clusters: 1
+  )EOF";
+
+  create(parseBootstrapFromV2Yaml(yaml));
+
+  ReadyWatcher initialized;
+  EXPECT_CALL(initialized, ready());
+  cluster_manager_->setInitializedCb([&]() -> void { initialized.ready(); });
+
+  std::shared_ptr<MockCluster> cluster1(new NiceMock<MockCluster>());
+  cluster1->info_->name_ = "cluster1";
+  std::shared_ptr<MockCluster> cluster2(new NiceMock<MockCluster>());
+  cluster2->info_->name_ = "cluster2";
+  std::shared_ptr<MockCluster> cluster3(new NiceMock<MockCluster>());
+  cluster3->info_->name_ = "cluster3";
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _, _))
+      .WillOnce(Return(cluster1))
+      .WillOnce(Return(cluster2))
+      .WillOnce(Return(cluster3));
+  EXPECT_CALL(*cluster1, initialize(_));
+  EXPECT_CALL(*cluster2, initialize(_)).Times(0);
+  EXPECT_CALL(*cluster3, initialize(_)).Times(0);
+  EXPECT_TRUE(cluster_manager_->addOrUpdateCluster(defaultStaticCluster("cluster1"), ""));
+  EXPECT_TRUE(cluster_manager_->addOrUpdateCluster(defaultStaticCluster("cluster2"), ""));
+  EXPECT_TRUE(cluster_manager_->addOrUpdateCluster(defaultStaticCluster("cluster3"), ""));
+  checkStats(3 /*added*/, 0 /*modified*/, 0 /*removed*/, 0 /*active*/, 3 /*warming*/);
+  EXPECT_EQ(2, factory_.stats_.gauge("cluster_manager.queued_warming_clusters").value());
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster2.get()));
+
+  // Warming the first cluster starts the second.
+  EXPECT_CALL(*cluster2, initialize(_));
+  cluster1->initialize_callback_();
+  checkStats(3 /*added*/, 0 /*modified*/, 0 /*removed*/, 1 /*active*/, 2 /*warming*/);
+  EXPECT_EQ(1, factory_.stats_.gauge("cluster_manager.queued_warming_clusters").value());
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster3.get()));
+
+  // Removing the second cluster while it warms starts the third.
+  EXPECT_CALL(*cluster3, initialize(_));
+  EXPECT_TRUE(cluster_manager_->removeCluster("cluster2"));
+  EXPECT_EQ(0, factory_.stats_.gauge("cluster_manager.queued_warming_clusters").value());
+  cluster3->initialize_callback_();
+  checkStats(3 /*added*/, 0 /*modified*/, 1 /*removed*/, 2 /*active*/, 0 /*warming*/);
+
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster2.get()));
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster3.get()));
+}
+
 TEST_F(ClusterManagerImplTest, DynamicAddRemove) {
   const std::string json = R"EOF(
   {
@@ -1451,6 +1535,16 @@ TEST_F(ClusterManagerImplTest, DynamicHostRemove) {
 
   dns_callback(TestUtility::makeDnsResponse({"127.0.0.1", "127.0.0.2"}));
 
+  // The thread local host set shares the primary cluster's host lists rather than copying them.
+  const HostSet& primary_host_set =
+      *cluster_manager_->clusters().at("cluster_1").get().prioritySet().hostSetsPerPriority()[0];
+  const HostSet& tls_host_set =
+      *cluster_manager_->get("cluster_1")->prioritySet().hostSetsPerPriority()[0];
+  EXPECT_EQ(2UL, tls_host_set.hosts().size());
+  EXPECT_EQ(primary_host_set.hostsPtr(), tls_host_set.hostsPtr());
+  EXPECT_EQ(primary_host_set.healthyHostsPtr(), tls_host_set.healthyHostsPtr());
+  EXPECT_EQ(primary_host_set.hostsPerLocalityPtr(), tls_host_set.hostsPerLocalityPtr());
+
   // After we are initialized, we should immediately get called back if someone asks for an
   // initialize callback.
   EXPECT_CALL(initialized, ready());
@@ -1681,6 +1775,150 @@ TEST_F(ClusterManagerImplTest, ConnPoolDestroyWithDraining) {
   factory_.tls_.shutdownThread();
 }
 
+// Clusters that share connection pools get the same pools for hosts with the same address, until
+// the host that the pools were created for is removed.
+TEST_F(ClusterManagerImplTest, SharedConnPools) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: cluster_1
+      connect_timeout: 0.250s
+      type: STRICT_DNS
+      dns_resolvers:
+      - socket_address:
+          address: 1.2.3.4
+          port_value: 80
+      lb_policy: ROUND_ROBIN
+      share_connection_pools: true
+      hosts:
+      - socket_address:
+          address: localhost
+          port_value: 11001
+    - name: cluster_2
+      connect_timeout: 0.250s
+      type: STATIC
+      lb_policy: ROUND_ROBIN
+      share_connection_pools: true
+      hosts:
+      - socket_address:
+          address: 127.0.0.2
+          port_value: 11001
+    - name: cluster_3
+      connect_timeout: 0.250s
+      type: STATIC
+      lb_policy: ROUND_ROBIN
+      hosts:
+      - socket_address:
+          address: 127.0.0.2
+          port_value: 11001
+  )EOF";
+
+  std::shared_ptr<Network::MockDnsResolver> dns_resolver(new Network::MockDnsResolver());
+  EXPECT_CALL(factory_.dispatcher_, createDnsResolver(_)).WillOnce(Return(dns_resolver));
+
+  Network::DnsResolver::ResolveCb dns_callback;
+  Event::MockTimer* dns_timer_ = new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  Network::MockActiveDnsQuery active_dns_query;
+  EXPECT_CALL(*dns_resolver, resolve(_, _, _))
+      .WillRepeatedly(DoAll(SaveArg<2>(&dns_callback), Return(&active_dns_query)));
+  create(parseBootstrapFromV2Yaml(yaml));
+  dns_callback(TestUtility::makeDnsResponse({"127.0.0.2"}));
+
+  EXPECT_CALL(factory_, allocateConnPool_(_))
+      .Times(3)
+      .WillRepeatedly(ReturnNew<Http::ConnectionPool::MockInstance>());
+  EXPECT_CALL(factory_, allocateTcpConnPool_(_))
+      .Times(3)
+      .WillRepeatedly(ReturnNew<Tcp::ConnectionPool::MockInstance>());
+
+  Http::ConnectionPool::MockInstance* cp1 =
+      dynamic_cast<Http::ConnectionPool::MockInstance*>(cluster_manager_->httpConnPoolForCluster(
+          "cluster_1", ResourcePriority::Default, Http::Protocol::Http11, nullptr));
+  Tcp::ConnectionPool::MockInstance* tcp1 = dynamic_cast<Tcp::ConnectionPool::MockInstance*>(
+      cluster_manager_->tcpConnPoolForCluster("cluster_1", ResourcePriority::Default, nullptr));
+  EXPECT_EQ(cp1, cluster_manager_->httpConnPoolForCluster("cluster_2", ResourcePriority::Default,
+                                                          Http::Protocol::Http11, nullptr));
+  EXPECT_EQ(tcp1, cluster_manager_->tcpConnPoolForCluster("cluster_2", ResourcePriority::Default,
+                                                         nullptr));
+
+  // A cluster that does not share its pools gets its own.
+  EXPECT_NE(cp1, cluster_manager_->httpConnPoolForCluster("cluster_3", ResourcePriority::Default,
+                                                          Http::Protocol::Http11, nullptr));
+  EXPECT_NE(tcp1, cluster_manager_->tcpConnPoolForCluster("cluster_3", ResourcePriority::Default,
+                                                         nullptr));
+
+  // Removing the host of cluster_1 drains its pools, and cluster_2 gets new ones.
+  Http::ConnectionPool::Instance::DrainedCb drained_cb;
+  EXPECT_CALL(*cp1, addDrainedCallback(_)).WillOnce(SaveArg<0>(&drained_cb));
+  Tcp::ConnectionPool::Instance::DrainedCb tcp_drained_cb;
+  EXPECT_CALL(*tcp1, addDrainedCallback(_)).WillOnce(SaveArg<0>(&tcp_drained_cb));
+  dns_timer_->callback_();
+  dns_callback(TestUtility::makeDnsResponse({}));
+
+  EXPECT_NE(cp1, cluster_manager_->httpConnPoolForCluster("cluster_2", ResourcePriority::Default,
+                                                          Http::Protocol::Http11, nullptr));
+  EXPECT_NE(tcp1, cluster_manager_->tcpConnPoolForCluster("cluster_2", ResourcePriority::Default,
+                                                         nullptr));
+
+  EXPECT_CALL(factory_.tls_.dispatcher_, deferredDelete_(_)).Times(2);
+  drained_cb();
+  tcp_drained_cb();
+
+  factory_.tls_.shutdownThread();
+}
+
+// A shared pool belongs to the host of the cluster that created it, which gets the per host
+// feedback of every cluster using the pool, and a health failure of any of their hosts for the
+// address drains it.
+TEST_F(ClusterManagerImplTest, SharedConnPoolsHostFeedback) {
+  const std::string json = fmt::sprintf(
+      "{%s}", clustersJson({defaultStaticClusterJson("cluster_1"),
+                            defaultStaticClusterJson("cluster_2")}));
+  std::shared_ptr<MockCluster> cluster1(new NiceMock<MockCluster>());
+  cluster1->info_->name_ = "cluster_1";
+  std::shared_ptr<MockCluster> cluster2(new NiceMock<MockCluster>());
+  cluster2->info_->name_ = "cluster_2";
+  for (const auto& cluster : {cluster1, cluster2}) {
+    ON_CALL(*cluster->info_, sharedConnPoolKey())
+        .WillByDefault(Return(absl::optional<uint64_t>(1)));
+    ON_CALL(*cluster, initializePhase()).WillByDefault(Return(Cluster::InitializePhase::Primary));
+    EXPECT_CALL(*cluster, initialize(_))
+        .WillOnce(Invoke([](std::function<void()> initialize_callback) {
+          initialize_callback();
+        }));
+  }
+  HostSharedPtr host1 = makeTestHost(cluster1->info_, "tcp://127.0.0.1:80");
+  cluster1->prioritySet().getMockHostSet(0)->hosts_ = {host1};
+  HostSharedPtr host2 = makeTestHost(cluster2->info_, "tcp://127.0.0.1:80");
+  cluster2->prioritySet().getMockHostSet(0)->hosts_ = {host2};
+
+  MockHealthChecker health_checker;
+  ON_CALL(*cluster2, healthChecker()).WillByDefault(Return(&health_checker));
+  EXPECT_CALL(health_checker, addHostCheckCompleteCb(_));
+
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _, _))
+      .WillOnce(Return(cluster1))
+      .WillOnce(Return(cluster2));
+  create(parseBootstrapFromJson(json));
+
+  // The pool that cluster_2 gets is the one created for the host of cluster_1, so the active
+  // requests, outlier detection and host stats of cluster_2's requests are recorded there.
+  Http::ConnectionPool::MockInstance* cp = new Http::ConnectionPool::MockInstance();
+  EXPECT_CALL(factory_, allocateConnPool_(HostConstSharedPtr(host1))).WillOnce(Return(cp));
+  EXPECT_EQ(cp, cluster_manager_->httpConnPoolForCluster("cluster_1", ResourcePriority::Default,
+                                                         Http::Protocol::Http11, nullptr));
+  EXPECT_EQ(cp, cluster_manager_->httpConnPoolForCluster("cluster_2", ResourcePriority::Default,
+                                                         Http::Protocol::Http11, nullptr));
+
+  // A health failure of the host of cluster_2 drains the pool of cluster_1 as well.
+  EXPECT_CALL(*cp, drainConnections());
+  host2->healthFlagSet(Host::HealthFlag::FAILED_ACTIVE_HC);
+  health_checker.runCallbacks(host2, HealthTransition::Changed);
+
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster2.get()));
+}
+
 TEST_F(ClusterManagerImplTest, OriginalDstInitialization) {
   const std::string json = R"EOF(
   {
@@ -2004,11 +2242,106 @@ TEST_F(ClusterManagerImplTest, MergedUpdatesDestroyedOnUpdate) {
   EXPECT_EQ(0, factory_.stats_.gauge("cluster_manager.warming_clusters").value());
 }
 
+class ClusterInitializeQueueTest : public testing::Test {
+public:
+  void setup(uint32_t max_initializing) {
+    queue_ = std::make_unique<ClusterInitializeQueue>(max_initializing, time_source_, queued_,
+                                                      initialize_time_);
+  }
+
+  NiceMock<MockTimeSource> time_source_;
+  NiceMock<Stats::MockGauge> queued_;
+  NiceMock<Stats::MockHistogram> initialize_time_;
+  ReadyWatcher initialized_;
+  std::unique_ptr<ClusterInitializeQueue> queue_;
+};
+
+TEST_F(ClusterInitializeQueueTest, Unbounded) {
+  setup(0);
+  NiceMock<MockCluster> cluster1;
+  NiceMock<MockCluster> cluster2;
+  EXPECT_CALL(cluster1, initialize(_));
+  EXPECT_CALL(cluster2, initialize(_));
+  queue_->initialize(cluster1, [this] { initialized_.ready(); });
+  queue_->initialize(cluster2, [this] { initialized_.ready(); });
+
+  EXPECT_CALL(initialized_, ready()).Times(2);
+  cluster2.initialize_callback_();
+  cluster1.initialize_callback_();
+}
+
+TEST_F(ClusterInitializeQueueTest, Bounded) {
+  InSequence s;
+  setup(1);
+  NiceMock<MockCluster> cluster1;
+  NiceMock<MockCluster> cluster2;
+
+  EXPECT_CALL(cluster1, initialize(_));
+  EXPECT_CALL(queued_, set(0));
+  queue_->initialize(cluster1, [this] { initialized_.ready(); });
+  EXPECT_CALL(queued_, set(1));
+  queue_->initialize(cluster2, [this] { initialized_.ready(); });
+
+  EXPECT_CALL(time_source_, monotonicTime())
+      .WillOnce(Return(MonotonicTime(std::chrono::milliseconds(42))));
+  EXPECT_CALL(initialize_time_, recordValue(42));
+  EXPECT_CALL(initialized_, ready());
+  EXPECT_CALL(cluster2, initialize(_));
+  EXPECT_CALL(queued_, set(0));
+  cluster1.initialize_callback_();
+}
+
+// Clusters that initialize immediately let the next ones start without recursing.
+TEST_F(ClusterInitializeQueueTest, ImmediateInitialize) {
+  setup(1);
+  std::vector<std::unique_ptr<NiceMock<MockCluster>>> clusters;
+  for (int i = 0; i < 3; i++) {
+    clusters.emplace_back(new NiceMock<MockCluster>());
+  }
+  // The first cluster holds the only place until it initializes.
+  queue_->initialize(*clusters[0], [this] { initialized_.ready(); });
+  for (int i = 1; i < 3; i++) {
+    EXPECT_CALL(*clusters[i], initialize(_))
+        .WillOnce(Invoke([](std::function<void()> callback) -> void { callback(); }));
+    queue_->initialize(*clusters[i], [this] { initialized_.ready(); });
+  }
+
+  EXPECT_CALL(initialized_, ready()).Times(3);
+  clusters[0]->initialize_callback_();
+}
+
+// A cluster that goes away gives up its place, whether it is queued or initializing.
+TEST_F(ClusterInitializeQueueTest, Remove) {
+  setup(1);
+  NiceMock<MockCluster> cluster1;
+  NiceMock<MockCluster> cluster2;
+  NiceMock<MockCluster> cluster3;
+  queue_->initialize(cluster1, [this] { initialized_.ready(); });
+  queue_->initialize(cluster2, [this] { initialized_.ready(); });
+  queue_->initialize(cluster3, [this] { initialized_.ready(); });
+
+  EXPECT_CALL(cluster2, initialize(_)).Times(0);
+  queue_->remove(cluster2);
+  EXPECT_CALL(cluster3, initialize(_));
+  queue_->remove(cluster1);
+
+  // Unknown clusters are ignored.
+  queue_->remove(cluster1);
+
+  EXPECT_CALL(initialized_, ready());
+  cluster3.initialize_callback_();
+}
+
 class ClusterManagerInitHelperTest : public testing::Test {
 public:
   MOCK_METHOD1(onClusterInit, void(Cluster& cluster));
 
-  ClusterManagerInitHelper init_helper_{[this](Cluster& cluster) { onClusterInit(cluster); }};
+  NiceMock<MockTimeSource> time_source_;
+  NiceMock<Stats::MockGauge> queued_;
+  NiceMock<Stats::MockHistogram> initialize_time_;
+  ClusterInitializeQueue initialize_queue_{0, time_source_, queued_, initialize_time_};
+  ClusterManagerInitHelper init_helper_{initialize_queue_,
+                                        [this](Cluster& cluster) { onClusterInit(cluster); }};
 };
 
 TEST_F(ClusterManagerInitHelperTest, ImmediateInitialize) {
@@ -2539,6 +2872,68 @@ TEST_F(TcpKeepaliveTest, TcpKeepaliveWithAllOptions) {
   expectSetsockoptSoKeepalive(7, 4, 1);
 }
 
+// The latency options of the Cluster are applied to the socket of its connections, and quick ACKs
+// are enabled on the connections.
+TEST_F(TcpKeepaliveTest, TcpLatencyOptions) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: TcpKeepaliveCluster
+      connect_timeout: 0.250s
+      lb_policy: ROUND_ROBIN
+      type: STATIC
+      hosts:
+      - socket_address:
+          address: "127.0.0.1"
+          port_value: 11001
+      upstream_connection_options:
+        tcp_latency_options:
+          busy_poll_us: 50
+          notsent_lowat: 16384
+          quick_ack: true
+  )EOF";
+  initialize(yaml);
+  const bool supported =
+      ENVOY_SOCKET_SO_BUSY_POLL.has_value() && ENVOY_SOCKET_TCP_NOTSENT_LOWAT.has_value();
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  EXPECT_CALL(factory_.tls_.dispatcher_, createClientConnection_(_, _, _, _))
+      .WillOnce(
+          Invoke([this, supported](Network::Address::InstanceConstSharedPtr,
+                                   Network::Address::InstanceConstSharedPtr,
+                                   Network::TransportSocketPtr&,
+                                   const Network::ConnectionSocket::OptionsSharedPtr& options)
+                     -> Network::ClientConnection* {
+            EXPECT_NE(nullptr, options.get());
+            EXPECT_EQ(2, options->size());
+            NiceMock<Network::MockConnectionSocket> socket;
+            EXPECT_EQ(supported, (Network::Socket::applyOptions(
+                                     options, socket,
+                                     envoy::api::v2::core::SocketOption::STATE_PREBIND)));
+            return connection_;
+          }));
+  EXPECT_CALL(*connection_, quickAck(true));
+  if (!supported) {
+    cluster_manager_->tcpConnForCluster("TcpKeepaliveCluster", nullptr);
+    return;
+  }
+  EXPECT_CALL(os_sys_calls, setsockopt_(_, ENVOY_SOCKET_SO_BUSY_POLL.value().first,
+                                        ENVOY_SOCKET_SO_BUSY_POLL.value().second, _, sizeof(int)))
+      .WillOnce(Invoke([](int, int, int, const void* optval, socklen_t) -> int {
+        EXPECT_EQ(50, *static_cast<const int*>(optval));
+        return 0;
+      }));
+  EXPECT_CALL(os_sys_calls,
+              setsockopt_(_, ENVOY_SOCKET_TCP_NOTSENT_LOWAT.value().first,
+                          ENVOY_SOCKET_TCP_NOTSENT_LOWAT.value().second, _, sizeof(int)))
+      .WillOnce(Invoke([](int, int, int, const void* optval, socklen_t) -> int {
+        EXPECT_EQ(16384, *static_cast<const int*>(optval));
+        return 0;
+      }));
+  auto conn_data = cluster_manager_->tcpConnForCluster("TcpKeepaliveCluster", nullptr);
+  EXPECT_EQ(connection_, conn_data.connection_.get());
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
@@ -71,6 +71,66 @@ TEST(EdfSchedulerTest, Expired) {
   EXPECT_EQ(nullptr, sched.pick());
 }
 
+// Validate we get regular RR behavior when all weights are the same.
+TEST(FlatEdfSchedulerTest, Unweighted) {
+  FlatEdfScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 128;
+  EXPECT_TRUE(sched.empty());
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    sched.add(1, i);
+  }
+  EXPECT_FALSE(sched.empty());
+
+  for (uint32_t rounds = 0; rounds < 128; ++rounds) {
+    for (uint32_t i = 0; i < num_entries; ++i) {
+      EXPECT_EQ(i, sched.pickAndAdd([](uint32_t) { return 1; }));
+    }
+  }
+}
+
+// Validate we get weighted RR behavior when weights are distinct.
+TEST(FlatEdfSchedulerTest, Weighted) {
+  FlatEdfScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 128;
+  uint32_t pick_count[num_entries];
+  const auto weight = [](uint32_t i) { return i + 1; };
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    sched.add(weight(i), i);
+    pick_count[i] = 0;
+  }
+
+  for (uint32_t i = 0; i < (num_entries * (1 + num_entries)) / 2; ++i) {
+    ++pick_count[sched.pickAndAdd(weight)];
+  }
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    EXPECT_EQ(i + 1, pick_count[i]);
+  }
+}
+
+// The flat scheduler picks in exactly the same order as EdfScheduler, including when weights
+// change between picks.
+TEST(FlatEdfSchedulerTest, MatchesEdfScheduler) {
+  EdfScheduler<uint32_t> sched;
+  FlatEdfScheduler<uint32_t> flat_sched;
+  constexpr uint32_t num_entries = 37;
+  std::shared_ptr<uint32_t> entries[num_entries];
+  const auto weight = [](uint32_t i, uint32_t round) { return (i * 7 + round) % 5 + 1; };
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(weight(i, 0), entries[i]);
+    flat_sched.add(weight(i, 0), i);
+  }
+
+  for (uint32_t round = 1; round < 1000; ++round) {
+    auto p = sched.pick();
+    sched.add(weight(*p, round), p);
+    EXPECT_EQ(*p, flat_sched.pickAndAdd([round, &weight](uint32_t i) { return weight(i, round); }));
+  }
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
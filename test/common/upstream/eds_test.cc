@@ -1331,5 +1331,82 @@ TEST_F(EdsTest, MalformedIP) {
                             "setting cluster type to 'STRICT_DNS' or 'LOGICAL_DNS'");
 }
 
+// Updates arriving within the coalescing window are held and only the latest one is applied.
+TEST_F(EdsTest, CoalescedUpdates) {
+  Event::MockTimer* coalesce_timer = new Event::MockTimer(&dispatcher_);
+  resetCluster(R"EOF(
+      name: name
+      connect_timeout: 0.25s
+      type: EDS
+      lb_policy: ROUND_ROBIN
+      eds_cluster_config:
+        service_name: fare
+        eds_config:
+          api_config_source:
+            cluster_names:
+            - eds
+            refresh_delay: 1s
+        update_coalesce_window: 3s
+  )EOF");
+
+  Protobuf::RepeatedPtrField<envoy::api::v2::ClusterLoadAssignment> resources;
+  auto* cluster_load_assignment = resources.Add();
+  cluster_load_assignment->set_cluster_name("fare");
+
+  auto set_endpoints = [cluster_load_assignment](std::vector<uint32_t> ports) {
+    cluster_load_assignment->clear_endpoints();
+    auto* endpoints = cluster_load_assignment->add_endpoints();
+    for (const uint32_t port : ports) {
+      auto* socket_address = endpoints->add_lb_endpoints()
+                                 ->mutable_endpoint()
+                                 ->mutable_address()
+                                 ->mutable_socket_address();
+      socket_address->set_address("1.2.3.4");
+      socket_address->set_port_value(port);
+    }
+  };
+  auto hosts_size = [this]() {
+    return cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size();
+  };
+
+  // The first update applies immediately and opens a window.
+  bool initialized = false;
+  cluster_->initialize([&initialized] { initialized = true; });
+  set_endpoints({80});
+  EXPECT_CALL(*coalesce_timer, enableTimer(std::chrono::milliseconds(3000)));
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources, ""));
+  EXPECT_TRUE(initialized);
+  EXPECT_EQ(1UL, hosts_size());
+
+  // Updates within the window are held; invalid ones are still rejected immediately.
+  set_endpoints({80, 81});
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources, ""));
+  set_endpoints({80, 81, 82});
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources, ""));
+  cluster_load_assignment->add_endpoints()
+      ->add_lb_endpoints()
+      ->mutable_endpoint()
+      ->mutable_address()
+      ->mutable_socket_address()
+      ->set_address("foo.bar.com");
+  EXPECT_THROW(cluster_->onConfigUpdate(resources, ""), EnvoyException);
+  EXPECT_EQ(1UL, hosts_size());
+  EXPECT_EQ(1UL, stats_.counter("cluster.name.update_coalesced").value());
+
+  // The latest valid update applies when the window ends, and opens another window.
+  EXPECT_CALL(*coalesce_timer, enableTimer(std::chrono::milliseconds(3000)));
+  coalesce_timer->callback_();
+  EXPECT_EQ(3UL, hosts_size());
+
+  // A window with no updates closes without applying anything; the next update is immediate.
+  coalesce_timer->callback_();
+  EXPECT_EQ(3UL, hosts_size());
+  set_endpoints({80});
+  EXPECT_CALL(*coalesce_timer, enableTimer(std::chrono::milliseconds(3000)));
+  VERBOSE_EXPECT_NO_THROW(cluster_->onConfigUpdate(resources, ""));
+  EXPECT_EQ(1UL, hosts_size());
+  EXPECT_EQ(1UL, stats_.counter("cluster.name.update_coalesced").value());
+}
+
 } // namespace Upstream
 } // namespace Envoy
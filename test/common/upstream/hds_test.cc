@@ -3,6 +3,7 @@
 #include "common/ssl/context_manager_impl.h"
 #include "common/upstream/health_discovery_service.h"
 
+#include "test/common/upstream/utility.h"
 #include "test/mocks/access_log/mocks.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/grpc/mocks.h"
@@ -300,5 +301,66 @@ TEST_F(HdsTest, TestSendResponseOneEndpointTimeout) {
             1234);
 }
 
+// Tests that the endpoints of the health checked cluster of the same name are not checked again,
+// and that only the endpoints whose health changed are reported, if any
+TEST_F(HdsTest, TestSendResponseSharedChangesOnly) {
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  EXPECT_CALL(async_stream_, sendMessage(_, _));
+  createHdsDelegate();
+
+  // The cluster "anna" is health checked and has the endpoint as host
+  NiceMock<MockCluster> cluster;
+  MockHealthChecker health_checker;
+  ON_CALL(testing::Const(cluster), healthChecker()).WillByDefault(Return(&health_checker));
+  HostSharedPtr host = makeTestHost(cluster.info_, "tcp://127.0.0.0:1234");
+  cluster.prioritySet().getMockHostSet(0)->hosts_ = {host};
+  ClusterManager::ClusterInfoMap clusters{{"anna", cluster}};
+  ON_CALL(cm_, clusters()).WillByDefault(Return(clusters));
+
+  // Create Message
+  message.reset(createSimpleMessage());
+  message->set_report_changes_only(true);
+  message->set_share_cluster_health_checks(true);
+
+  // Process message without creating a HdsCluster
+  EXPECT_CALL(test_factory_, createClusterInfo(_, _, _, _, _, _, _, _, _, _)).Times(0);
+  EXPECT_CALL(*server_response_timer_, enableTimer(_)).Times(AtLeast(1));
+  hds_delegate_->onReceiveMessage(std::move(message));
+
+  // The first report is full
+  EXPECT_CALL(async_stream_, sendMessage(_, false));
+  auto msg = hds_delegate_->sendResponse();
+  ASSERT_EQ(1, msg.endpoint_health_response().endpoints_health_size());
+  EXPECT_EQ(envoy::api::v2::core::HealthStatus::HEALTHY,
+            msg.endpoint_health_response().endpoints_health(0).health_status());
+  EXPECT_EQ("127.0.0.0", msg.endpoint_health_response()
+                             .endpoints_health(0)
+                             .endpoint()
+                             .address()
+                             .socket_address()
+                             .address());
+
+  // Nothing is sent without any change
+  EXPECT_CALL(async_stream_, sendMessage(_, _)).Times(0);
+  msg = hds_delegate_->sendResponse();
+  EXPECT_EQ(0, msg.endpoint_health_response().endpoints_health_size());
+
+  // The endpoint failed the cluster's health checks
+  host->healthFlagSet(Host::HealthFlag::FAILED_ACTIVE_HC);
+  EXPECT_CALL(async_stream_, sendMessage(_, false));
+  msg = hds_delegate_->sendResponse();
+  ASSERT_EQ(1, msg.endpoint_health_response().endpoints_health_size());
+  EXPECT_EQ(envoy::api::v2::core::HealthStatus::UNHEALTHY,
+            msg.endpoint_health_response().endpoints_health(0).health_status());
+
+  // The endpoint is no longer a host of the cluster
+  cluster.prioritySet().getMockHostSet(0)->hosts_.clear();
+  EXPECT_CALL(async_stream_, sendMessage(_, false));
+  msg = hds_delegate_->sendResponse();
+  ASSERT_EQ(1, msg.endpoint_health_response().endpoints_health_size());
+  EXPECT_EQ(envoy::api::v2::core::HealthStatus::UNKNOWN,
+            msg.endpoint_health_response().endpoints_health(0).health_status());
+}
+
 } // namespace Upstream
 } // namespace Envoy
@@ -1,11 +1,13 @@
 // Usage: bazel run //test/common/upstream:load_balancer_benchmark
 
 #include "common/runtime/runtime_impl.h"
+#include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/maglev_lb.h"
 #include "common/upstream/ring_hash_lb.h"
 #include "common/upstream/upstream_impl.h"
 
 #include "test/common/upstream/utility.h"
+#include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 
 #include "testing/base/public/benchmark.h"
@@ -86,16 +88,21 @@ void BM_MaglevLoadBalancerBuildTable(benchmark::State& state) {
   for (auto _ : state) {
     state.PauseTiming();
     const uint64_t num_hosts = state.range(0);
+    const uint64_t table_size = state.range(1);
     BaseTester tester(num_hosts);
     state.ResumeTiming();
     MaglevTable table(HostsPerLocalityImpl(tester.priority_set_.getOrCreateHostSet(0).hosts()),
-                      nullptr);
+                      nullptr, table_size);
   }
 }
 BENCHMARK(BM_MaglevLoadBalancerBuildTable)
-    ->Arg(100)
-    ->Arg(200)
-    ->Arg(500)
+    ->Args({100, MaglevTable::DefaultTableSize})
+    ->Args({200, MaglevTable::DefaultTableSize})
+    ->Args({500, MaglevTable::DefaultTableSize})
+    ->Args({2000, MaglevTable::DefaultTableSize})
+    ->Args({500, 655373})
+    ->Args({2000, 655373})
+    ->Args({2000, 1048583})
     ->Unit(benchmark::kMillisecond);
 
 class TestLoadBalancerContext : public LoadBalancerContextBase {
@@ -163,6 +170,7 @@ BENCHMARK(BM_RingHashLoadBalancerChooseHost)
     ->Args({100, 256000, 100000})
     ->Args({200, 256000, 100000})
     ->Args({500, 256000, 100000})
+    ->Args({2000, 1048576, 100000})
     ->Unit(benchmark::kMillisecond);
 
 void BM_MaglevLoadBalancerChooseHost(benchmark::State& state) {
@@ -340,6 +348,59 @@ BENCHMARK(BM_MaglevLoadBalancerWeighted)
     ->Args({500, 95, 75, 25, 10000})
     ->Unit(benchmark::kMillisecond);
 
+class ZoneAwareTester {
+public:
+  // The upstream cluster has 10 hosts in each locality but the local one, which has 2, while the
+  // local cluster has 10 hosts in each locality. Most requests are routed cross locality.
+  ZoneAwareTester(uint64_t num_localities) {
+    ON_CALL(runtime_.snapshot_, featureEnabled("upstream.zone_routing.enabled", 100))
+        .WillByDefault(testing::Return(true));
+    lb_ = std::make_unique<RoundRobinLoadBalancer>(priority_set_, &local_priority_set_, stats_,
+                                                   runtime_, random_, common_config_);
+    updateHostSet(priority_set_.getOrCreateHostSet(0), num_localities, 2, 0);
+    updateHostSet(local_priority_set_.getOrCreateHostSet(0), num_localities, 10, 1);
+  }
+
+  void updateHostSet(HostSet& host_set, uint64_t num_localities, uint64_t local_hosts,
+                     uint64_t cluster) {
+    HostVector hosts;
+    std::vector<HostVector> hosts_per_locality(num_localities);
+    for (uint64_t i = 0; i < num_localities; i++) {
+      for (uint64_t j = 0; j < (i == 0 ? local_hosts : 10); j++) {
+        hosts_per_locality[i].push_back(
+            makeTestHost(info_, fmt::format("tcp://10.{}.{}.{}:6379", cluster, i, j)));
+        hosts.push_back(hosts_per_locality[i].back());
+      }
+    }
+    HostVectorConstSharedPtr updated_hosts{new HostVector(hosts)};
+    HostsPerLocalitySharedPtr updated_hosts_per_locality{
+        new HostsPerLocalityImpl(std::move(hosts_per_locality), true)};
+    host_set.updateHosts(updated_hosts, updated_hosts, updated_hosts_per_locality,
+                         updated_hosts_per_locality, {}, hosts, {}, absl::nullopt);
+  }
+
+  PrioritySetImpl priority_set_;
+  PrioritySetImpl local_priority_set_;
+  std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
+  Stats::IsolatedStoreImpl stats_store_;
+  ClusterStats stats_{ClusterInfoImpl::generateStats(stats_store_)};
+  NiceMock<Runtime::MockLoader> runtime_;
+  Runtime::RandomGeneratorImpl random_;
+  envoy::api::v2::Cluster::CommonLbConfig common_config_;
+  std::unique_ptr<RoundRobinLoadBalancer> lb_;
+};
+
+void BM_ZoneAwareLoadBalancerChooseHost(benchmark::State& state) {
+  const uint64_t num_localities = state.range(0);
+  ZoneAwareTester tester(num_localities);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tester.lb_->chooseHost(nullptr));
+  }
+  state.counters["cross_zone_percent"] =
+      100.0 * tester.stats_.lb_zone_routing_cross_zone_.value() / state.iterations();
+}
+BENCHMARK(BM_ZoneAwareLoadBalancerChooseHost)->Arg(3)->Arg(10)->Arg(50)->Arg(200);
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
@@ -62,7 +62,8 @@ TEST(DISABLED_LeastRequestLoadBalancerWeightTest, Weight) {
   NiceMock<Runtime::MockLoader> runtime;
   Runtime::RandomGeneratorImpl random;
   envoy::api::v2::Cluster::CommonLbConfig common_config;
-  LeastRequestLoadBalancer lb_{priority_set, nullptr, stats, runtime, random, common_config};
+  LeastRequestLoadBalancer lb_{priority_set, nullptr, stats,        runtime,
+                               random,       common_config, absl::nullopt};
 
   std::unordered_map<HostConstSharedPtr, uint64_t> host_hits;
   const uint64_t total_requests = 100;
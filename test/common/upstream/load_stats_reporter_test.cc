@@ -3,6 +3,7 @@
 
 #include "common/upstream/load_stats_reporter.h"
 
+#include "test/common/upstream/utility.h"
 #include "test/mocks/event/mocks.h"
 #include "test/mocks/grpc/mocks.h"
 #include "test/mocks/local_info/mocks.h"
@@ -54,10 +55,12 @@ public:
     EXPECT_CALL(async_stream_, sendMessage(ProtoEq(expected_request), false));
   }
 
-  void deliverLoadStatsResponse(const std::vector<std::string>& cluster_names) {
+  void deliverLoadStatsResponse(const std::vector<std::string>& cluster_names,
+                                bool report_endpoint_granularity = false) {
     std::unique_ptr<envoy::service::load_stats::v2::LoadStatsResponse> response(
         new envoy::service::load_stats::v2::LoadStatsResponse());
     response->mutable_load_reporting_interval()->set_seconds(42);
+    response->set_report_endpoint_granularity(report_endpoint_granularity);
     std::copy(cluster_names.begin(), cluster_names.end(),
               Protobuf::RepeatedPtrFieldBackInserter(response->mutable_clusters()));
 
@@ -221,6 +224,46 @@ TEST_F(LoadStatsReporterTest, ExistingClusters) {
   response_timer_cb_();
 }
 
+// Validate that only the endpoints with activity are reported at endpoint granularity.
+TEST_F(LoadStatsReporterTest, EndpointGranularity) {
+  EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
+  expectSendMessage({});
+  createLoadStatsReporter();
+  NiceMock<MockCluster> foo_cluster;
+  HostSharedPtr active_host = makeTestHost(foo_cluster.info_, "tcp://127.0.0.1:80");
+  HostSharedPtr idle_host = makeTestHost(foo_cluster.info_, "tcp://127.0.0.1:81");
+  foo_cluster.prioritySet().getMockHostSet(0)->hosts_per_locality_ =
+      std::make_shared<HostsPerLocalityImpl>(HostVector({active_host, idle_host}));
+  MockClusterManager::ClusterInfoMap cluster_info{{"foo", foo_cluster}};
+  ON_CALL(cm_, clusters()).WillByDefault(Return(cluster_info));
+  EXPECT_CALL(time_system_, monotonicTime())
+      .WillOnce(Return(MonotonicTime(std::chrono::microseconds(3))));
+  deliverLoadStatsResponse({"foo"}, true);
+
+  active_host->stats().rq_success_.add(3);
+  active_host->stats().rq_error_.inc();
+  EXPECT_CALL(time_system_, monotonicTime())
+      .WillOnce(Return(MonotonicTime(std::chrono::microseconds(4))));
+  {
+    envoy::api::v2::endpoint::ClusterStats foo_cluster_stats;
+    foo_cluster_stats.set_cluster_name("foo");
+    auto* locality_stats = foo_cluster_stats.add_upstream_locality_stats();
+    auto* endpoint_stats = locality_stats->add_upstream_endpoint_stats();
+    endpoint_stats->mutable_address()->mutable_socket_address()->set_address("127.0.0.1");
+    endpoint_stats->mutable_address()->mutable_socket_address()->set_port_value(80);
+    endpoint_stats->set_total_successful_requests(3);
+    endpoint_stats->set_total_error_requests(1);
+    locality_stats->mutable_locality();
+    locality_stats->set_total_successful_requests(3);
+    locality_stats->set_total_error_requests(1);
+    foo_cluster_stats.mutable_load_report_interval()->MergeFrom(
+        Protobuf::util::TimeUtil::MicrosecondsToDuration(1));
+    expectSendMessage({foo_cluster_stats});
+  }
+  EXPECT_CALL(*response_timer_, enableTimer(std::chrono::milliseconds(42000)));
+  response_timer_cb_();
+}
+
 // Validate that the client can recover from a remote stream closure via retry.
 TEST_F(LoadStatsReporterTest, RemoteStreamClose) {
   EXPECT_CALL(*async_client_, start(_, _)).WillOnce(Return(&async_stream_));
@@ -413,5 +413,56 @@ TEST_F(LogicalDnsClusterTest, Basic) {
   testBasicSetup(basic_yaml_load_assignment, "foo.bar.com", 8000);
 }
 
+// With the ALL lookup family, connections race the resolved addresses in resolution order.
+TEST_F(LogicalDnsClusterTest, AllLookupFamily) {
+  const std::string yaml = R"EOF(
+  name: name
+  type: LOGICAL_DNS
+  dns_refresh_rate: 4s
+  connect_timeout: 0.25s
+  lb_policy: ROUND_ROBIN
+  dns_lookup_family: ALL
+  hosts:
+  - socket_address:
+      address: foo.bar.com
+      port_value: 443
+  )EOF";
+
+  expectResolve(Network::DnsLookupFamily::All, "foo.bar.com");
+  setupFromV2Yaml(yaml);
+
+  EXPECT_CALL(membership_updated_, ready());
+  EXPECT_CALL(initialized_, ready());
+  EXPECT_CALL(*resolve_timer_, enableTimer(std::chrono::milliseconds(4000)));
+  dns_callback_(TestUtility::makeDnsResponse({"::1", "127.0.0.1"}));
+  HostSharedPtr logical_host = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0];
+
+  EXPECT_CALL(dispatcher_, createHappyEyeballsConnection_(_, _, _, _))
+      .WillOnce(Invoke([](const std::vector<Network::Address::InstanceConstSharedPtr>& addresses,
+                          Network::Address::InstanceConstSharedPtr,
+                          Network::TransportSocketPtr&,
+                          const Network::ConnectionSocket::OptionsSharedPtr&)
+                           -> Network::ClientConnection* {
+        EXPECT_EQ(2, addresses.size());
+        EXPECT_EQ("[::1]:443", addresses[0]->asString());
+        EXPECT_EQ("127.0.0.1:443", addresses[1]->asString());
+        return new NiceMock<Network::MockClientConnection>();
+      }));
+  Host::CreateConnectionData data = logical_host->createConnection(dispatcher_, nullptr);
+  EXPECT_EQ("[::1]:443", data.host_description_->address()->asString());
+
+  // A single resolved address is connected to directly.
+  expectResolve(Network::DnsLookupFamily::All, "foo.bar.com");
+  resolve_timer_->callback_();
+  EXPECT_CALL(*resolve_timer_, enableTimer(_));
+  dns_callback_(TestUtility::makeDnsResponse({"127.0.0.1"}));
+
+  EXPECT_CALL(dispatcher_,
+              createClientConnection_(
+                  PointeesEq(Network::Utility::resolveUrl("tcp://127.0.0.1:443")), _, _, _))
+      .WillOnce(Return(new NiceMock<Network::MockClientConnection>()));
+  logical_host->createConnection(dispatcher_, nullptr);
+}
+
 } // namespace Upstream
 } // namespace Envoy
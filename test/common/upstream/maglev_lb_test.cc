@@ -71,6 +71,32 @@ TEST_F(MaglevLoadBalancerTest, Basic) {
   }
 }
 
+// With bounded loads, the requests of a hot key spread to other hosts once its host is above its
+// bound.
+TEST_F(MaglevLoadBalancerTest, BoundedLoad) {
+  host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90"),
+                      makeTestHost(info_, "tcp://127.0.0.1:91"),
+                      makeTestHost(info_, "tcp://127.0.0.1:92")};
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  common_config_.mutable_consistent_hashing_lb_config()->mutable_hash_balance_factor()->set_value(
+      200);
+  init(7);
+
+  LoadBalancerPtr lb = lb_->factory()->create();
+  TestLoadBalancerContext context(0);
+  const HostConstSharedPtr host = lb->chooseHost(&context);
+  EXPECT_EQ(host, lb->chooseHost(&context));
+  uint32_t host_requests = 2;
+  for (uint32_t i = 2; i < 60; ++i) {
+    if (lb->chooseHost(&context) == host) {
+      host_requests++;
+    }
+  }
+  EXPECT_LE(host_requests, 40U);
+  EXPECT_LT(0UL, stats_.lb_hash_bounded_load_fallback_.value());
+}
+
 // Weighted sanity test.
 TEST_F(MaglevLoadBalancerTest, Weighted) {
   host_set_.hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:90", 1),
@@ -486,6 +486,108 @@ TEST_F(OriginalDstClusterTest, MultipleClusters) {
   EXPECT_EQ(host, second.hostSetsPerPriority()[0]->hosts()[0]);
 }
 
+// Validate that a host created by one worker is used by the others before it is in the host set.
+TEST_F(OriginalDstClusterTest, SharedHostMap) {
+  std::string json = R"EOF(
+  {
+    "name": "name",
+    "connect_timeout_ms": 1250,
+    "type": "original_dst",
+    "lb_type": "original_dst_lb"
+  }
+  )EOF";
+
+  EXPECT_CALL(initialized_, ready());
+  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
+  setupFromJson(json);
+
+  NiceMock<Network::MockConnection> connection;
+  TestLoadBalancerContext lb_context(&connection);
+  connection.local_address_ = std::make_shared<Network::Address::Ipv4Instance>("10.10.11.11");
+  EXPECT_CALL(connection, localAddressRestored()).WillRepeatedly(Return(true));
+
+  PrioritySetImpl second;
+  OriginalDstCluster::LoadBalancer lb1(cluster_->prioritySet(), cluster_,
+                                       cluster_->info()->lbOriginalDstConfig());
+  OriginalDstCluster::LoadBalancer lb2(second, cluster_, cluster_->info()->lbOriginalDstConfig());
+  Event::PostCb post_cb;
+  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  HostConstSharedPtr host1 = lb1.chooseHost(&lb_context);
+  HostConstSharedPtr host2 = lb2.chooseHost(&lb_context);
+  ASSERT_NE(host1, nullptr);
+  EXPECT_EQ(host1, host2);
+
+  EXPECT_CALL(membership_updated_, ready());
+  post_cb();
+  ASSERT_EQ(1UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+  EXPECT_EQ(host1, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]);
+
+  // Once the host is removed, a new one is created.
+  EXPECT_CALL(*cleanup_timer_, enableTimer(_)).Times(2);
+  EXPECT_CALL(membership_updated_, ready());
+  cleanup_timer_->callback_();
+  cleanup_timer_->callback_();
+  EXPECT_EQ(0UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+
+  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  HostConstSharedPtr host3 = lb1.chooseHost(&lb_context);
+  ASSERT_NE(host3, nullptr);
+  EXPECT_NE(host1, host3);
+}
+
+// Validate that the hosts created before the main thread adds them are added with one update.
+TEST_F(OriginalDstClusterTest, BatchedAdditions) {
+  std::string json = R"EOF(
+  {
+    "name": "name",
+    "connect_timeout_ms": 1250,
+    "type": "original_dst",
+    "lb_type": "original_dst_lb"
+  }
+  )EOF";
+
+  EXPECT_CALL(initialized_, ready());
+  EXPECT_CALL(*cleanup_timer_, enableTimer(_));
+  setupFromJson(json);
+
+  NiceMock<Network::MockConnection> connection1;
+  TestLoadBalancerContext lb_context1(&connection1);
+  connection1.local_address_ = std::make_shared<Network::Address::Ipv4Instance>("10.10.11.11");
+  EXPECT_CALL(connection1, localAddressRestored()).WillRepeatedly(Return(true));
+
+  NiceMock<Network::MockConnection> connection2;
+  TestLoadBalancerContext lb_context2(&connection2);
+  connection2.local_address_ = std::make_shared<Network::Address::Ipv4Instance>("10.10.11.12");
+  EXPECT_CALL(connection2, localAddressRestored()).WillRepeatedly(Return(true));
+
+  OriginalDstCluster::LoadBalancer lb(cluster_->prioritySet(), cluster_,
+                                      cluster_->info()->lbOriginalDstConfig());
+  Event::PostCb post_cb;
+  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  HostConstSharedPtr host1 = lb.chooseHost(&lb_context1);
+  HostConstSharedPtr host2 = lb.chooseHost(&lb_context2);
+  ASSERT_NE(host1, nullptr);
+  ASSERT_NE(host2, nullptr);
+  EXPECT_NE(host1, host2);
+
+  EXPECT_CALL(membership_updated_, ready());
+  post_cb();
+  ASSERT_EQ(2UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+  EXPECT_EQ(host1, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]);
+  EXPECT_EQ(host2, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[1]);
+
+  // The next host is posted again.
+  NiceMock<Network::MockConnection> connection3;
+  TestLoadBalancerContext lb_context3(&connection3);
+  connection3.local_address_ = std::make_shared<Network::Address::Ipv4Instance>("10.10.11.13");
+  EXPECT_CALL(connection3, localAddressRestored()).WillRepeatedly(Return(true));
+  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&post_cb));
+  EXPECT_NE(nullptr, lb.chooseHost(&lb_context3));
+  EXPECT_CALL(membership_updated_, ready());
+  post_cb();
+  EXPECT_EQ(3UL, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts().size());
+}
+
 TEST_F(OriginalDstClusterTest, UseHttpHeaderEnabled) {
   std::string yaml = R"EOF(
     name: "name"
@@ -134,6 +134,9 @@ TEST_F(OutlierDetectorImplTest, DetectorStaticConfig) {
   EXPECT_EQ(50UL, detector->config().successRateMinimumHosts());
   EXPECT_EQ(200UL, detector->config().successRateRequestVolume());
   EXPECT_EQ(3000UL, detector->config().successRateStdevFactor());
+  EXPECT_EQ(0UL, detector->config().enforcingLatency());
+  EXPECT_EQ(1900UL, detector->config().latencyStdevFactor());
+  EXPECT_EQ(30UL, detector->config().latencyEwmaWeight());
 }
 
 TEST_F(OutlierDetectorImplTest, DestroyWithActive) {
@@ -541,6 +544,72 @@ TEST_F(OutlierDetectorImplTest, BasicFlowSuccessRate) {
   EXPECT_EQ(-1, detector->successRateEjectionThreshold());
 }
 
+TEST_F(OutlierDetectorImplTest, BasicFlowLatency) {
+  EXPECT_CALL(cluster_.prioritySet(), addMemberUpdateCb(_));
+  addHosts({
+      "tcp://127.0.0.1:80",
+      "tcp://127.0.0.1:81",
+      "tcp://127.0.0.1:82",
+      "tcp://127.0.0.1:83",
+      "tcp://127.0.0.1:84",
+  });
+
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  std::shared_ptr<DetectorImpl> detector(DetectorImpl::create(
+      cluster_, empty_outlier_detection_, dispatcher_, runtime_, time_source_, event_logger_));
+  detector->addChangedStateCb([&](HostSharedPtr host) -> void { checker_.check(host); });
+
+  ON_CALL(runtime_.snapshot_, featureEnabled("outlier_detection.enforcing_latency", 0))
+      .WillByDefault(Return(true));
+
+  // Four hosts respond in 10ms and the last one in 100ms.
+  for (int i = 0; i < 100; i++) {
+    for (size_t j = 0; j < 4; j++) {
+      hosts_[j]->outlierDetector().putResponseTime(std::chrono::milliseconds(10));
+    }
+    hosts_[4]->outlierDetector().putResponseTime(std::chrono::milliseconds(100));
+  }
+
+  EXPECT_CALL(time_source_, monotonicTime())
+      .Times(2)
+      .WillRepeatedly(Return(MonotonicTime(std::chrono::milliseconds(10000))));
+  EXPECT_CALL(checker_, check(hosts_[4]));
+  EXPECT_CALL(*event_logger_, logEject(std::static_pointer_cast<const HostDescription>(hosts_[4]),
+                                       _, EjectionType::Latency, true));
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  interval_timer_->callback_();
+  EXPECT_EQ(100, hosts_[4]->outlierDetector().latency());
+  EXPECT_EQ(10, hosts_[0]->outlierDetector().latency());
+  EXPECT_EQ(28, detector->latencyAverage());
+  EXPECT_DOUBLE_EQ(96.4, detector->latencyEjectionThreshold());
+  // Latency ejection does not depend on the success rate.
+  EXPECT_EQ(-1, detector->successRateAverage());
+  EXPECT_TRUE(hosts_[4]->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK));
+  EXPECT_EQ(1UL, cluster_.info_->stats_store_.gauge("outlier_detection.ejections_active").value());
+  EXPECT_EQ(
+      1UL,
+      cluster_.info_->stats_store_.counter("outlier_detection.ejections_detected_latency").value());
+  EXPECT_EQ(
+      1UL,
+      cluster_.info_->stats_store_.counter("outlier_detection.ejections_enforced_latency").value());
+
+  // The next interval moves the latencies by the weight of the new response times, and the
+  // ejected host is no longer considered.
+  for (int i = 0; i < 100; i++) {
+    hosts_[0]->outlierDetector().putResponseTime(std::chrono::milliseconds(20));
+    hosts_[4]->outlierDetector().putResponseTime(std::chrono::milliseconds(20));
+  }
+  EXPECT_CALL(time_source_, monotonicTime())
+      .WillOnce(Return(MonotonicTime(std::chrono::milliseconds(19999))));
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  interval_timer_->callback_();
+  EXPECT_DOUBLE_EQ(13, hosts_[0]->outlierDetector().latency());
+  EXPECT_DOUBLE_EQ(76, hosts_[4]->outlierDetector().latency());
+  EXPECT_EQ(-1, detector->latencyAverage());
+  EXPECT_EQ(-1, detector->latencyEjectionThreshold());
+  EXPECT_TRUE(hosts_[4]->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK));
+}
+
 TEST_F(OutlierDetectorImplTest, RemoveWhileEjected) {
   EXPECT_CALL(cluster_.prioritySet(), addMemberUpdateCb(_));
   addHosts({"tcp://127.0.0.1:80"});
@@ -819,11 +888,7 @@ TEST(OutlierDetectionEventLoggerImplTest, All) {
 }
 
 TEST(OutlierUtility, SRThreshold) {
-  std::vector<HostSuccessRatePair> data = {
-      HostSuccessRatePair(nullptr, 50),  HostSuccessRatePair(nullptr, 100),
-      HostSuccessRatePair(nullptr, 100), HostSuccessRatePair(nullptr, 100),
-      HostSuccessRatePair(nullptr, 100),
-  };
+  std::vector<double> data = {50, 100, 100, 100, 100};
   double sum = 450;
 
   Utility::EjectionPair ejection_pair = Utility::successRateEjectionThreshold(sum, data, 1.9);
@@ -831,6 +896,15 @@ TEST(OutlierUtility, SRThreshold) {
   EXPECT_EQ(90.0, ejection_pair.success_rate_average_);
 }
 
+TEST(OutlierUtility, LatencyThreshold) {
+  std::vector<double> data = {10, 10, 10, 10, 100};
+  double sum = 140;
+
+  Utility::EjectionPair ejection_pair = Utility::latencyEjectionThreshold(sum, data, 1.9);
+  EXPECT_DOUBLE_EQ(96.4, ejection_pair.ejection_threshold_);
+  EXPECT_EQ(28.0, ejection_pair.success_rate_average_);
+}
+
 TEST(DetectorHostMonitorImpl, resultToHttpCode) {
   EXPECT_EQ(Http::Code::OK, DetectorHostMonitorImpl::resultToHttpCode(Result::SUCCESS));
   EXPECT_EQ(Http::Code::GatewayTimeout, DetectorHostMonitorImpl::resultToHttpCode(Result::TIMEOUT));
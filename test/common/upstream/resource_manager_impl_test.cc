@@ -5,6 +5,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::_;
 using testing::NiceMock;
 using testing::Return;
 
@@ -47,5 +48,46 @@ TEST(ResourceManagerImplTest, RuntimeResourceManager) {
   EXPECT_FALSE(resource_manager.retries().canCreate());
 }
 
+TEST(ResourceManagerImplTest, RetryBudget) {
+  NiceMock<Runtime::MockLoader> runtime;
+  ResourceManagerImpl resource_manager(runtime, "circuit_breakers.retry_budget_test.default.", 100,
+                                       100, 100, 1, RetryBudget{25, 2});
+
+  // The minimum applies at low load, whatever max_retries is.
+  EXPECT_EQ(2U, resource_manager.retries().max());
+  resource_manager.retries().inc();
+  resource_manager.retries().inc();
+  EXPECT_FALSE(resource_manager.retries().canCreate());
+
+  // The limit grows with the active and pending requests.
+  for (int i = 0; i < 10; i++) {
+    resource_manager.requests().inc();
+    resource_manager.pendingRequests().inc();
+  }
+  EXPECT_EQ(5U, resource_manager.retries().max());
+  EXPECT_TRUE(resource_manager.retries().canCreate());
+
+  EXPECT_CALL(
+      runtime.snapshot_,
+      getInteger("circuit_breakers.retry_budget_test.default.retry_budget.budget_percent", _))
+      .WillOnce(Return(50U))
+      .RetiresOnSaturation();
+  EXPECT_EQ(10U, resource_manager.retries().max());
+
+  EXPECT_CALL(
+      runtime.snapshot_,
+      getInteger("circuit_breakers.retry_budget_test.default.retry_budget.min_retry_concurrency",
+                 2U))
+      .WillOnce(Return(20U));
+  EXPECT_EQ(20U, resource_manager.retries().max());
+
+  for (int i = 0; i < 10; i++) {
+    resource_manager.requests().dec();
+    resource_manager.pendingRequests().dec();
+  }
+  resource_manager.retries().dec();
+  resource_manager.retries().dec();
+}
+
 } // namespace Upstream
 } // namespace Envoy
@@ -278,5 +278,79 @@ TEST_P(RingHashLoadBalancerTest, UnevenHosts) {
   }
 }
 
+// Rebuilding the ring incrementally after hosts are added and removed must produce the same ring as
+// building it from scratch.
+TEST_P(RingHashLoadBalancerTest, IncrementalRebuild) {
+  hostSet().hosts_ = {
+      makeTestHost(info_, "tcp://127.0.0.1:90"), makeTestHost(info_, "tcp://127.0.0.1:91"),
+      makeTestHost(info_, "tcp://127.0.0.1:92"), makeTestHost(info_, "tcp://127.0.0.1:93")};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+
+  config_ = (envoy::api::v2::Cluster::RingHashLbConfig());
+  config_.value().mutable_minimum_ring_size()->set_value(12);
+  config_.value().mutable_deprecated_v1()->mutable_use_std_hash()->set_value(false);
+  init();
+
+  // Replace :91 with :94, which keeps the number of hashes per host the same.
+  HostSharedPtr removed = hostSet().hosts_[1];
+  HostSharedPtr added = makeTestHost(info_, "tcp://127.0.0.1:94");
+  hostSet().hosts_ = {hostSet().hosts_[0], hostSet().hosts_[2], hostSet().hosts_[3], added};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({added}, {removed});
+  LoadBalancerPtr lb = lb_->factory()->create();
+
+  NiceMock<MockPrioritySet> priority_set;
+  MockHostSet& host_set = *priority_set.getMockHostSet(GetParam() ? 0 : 1);
+  host_set.hosts_ = hostSet().hosts_;
+  host_set.healthy_hosts_ = hostSet().hosts_;
+  RingHashLoadBalancer full_lb(priority_set, stats_, runtime_, random_, config_, common_config_);
+  full_lb.initialize();
+  LoadBalancerPtr expected_lb = full_lb.factory()->create();
+
+  for (uint64_t i = 0; i < 1000; i++) {
+    TestLoadBalancerContext context(i * (std::numeric_limits<uint64_t>::max() / 1000));
+    HostConstSharedPtr host = lb->chooseHost(&context);
+    EXPECT_NE(removed, host);
+    EXPECT_EQ(expected_lb->chooseHost(&context), host);
+  }
+}
+
+// With bounded loads, the requests of a hot key walk the ring past the hosts that are above their
+// bound.
+TEST_P(RingHashLoadBalancerTest, BoundedLoad) {
+  hostSet().hosts_ = {
+      makeTestHost(info_, "tcp://127.0.0.1:90"), makeTestHost(info_, "tcp://127.0.0.1:91"),
+      makeTestHost(info_, "tcp://127.0.0.1:92"), makeTestHost(info_, "tcp://127.0.0.1:93"),
+      makeTestHost(info_, "tcp://127.0.0.1:94"), makeTestHost(info_, "tcp://127.0.0.1:95")};
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+
+  config_ = (envoy::api::v2::Cluster::RingHashLbConfig());
+  config_.value().mutable_minimum_ring_size()->set_value(12);
+  config_.value().mutable_deprecated_v1()->mutable_use_std_hash()->set_value(false);
+  common_config_.mutable_consistent_hashing_lb_config()->mutable_hash_balance_factor()->set_value(
+      150);
+  init();
+
+  // The ring is the same as in the Basic test: hash 0 maps to :94, followed by :92 and :90.
+  LoadBalancerPtr lb = lb_->factory()->create();
+  TestLoadBalancerContext context(0);
+  EXPECT_EQ(hostSet().hosts_[4], lb->chooseHost(&context));
+  EXPECT_EQ(hostSet().hosts_[2], lb->chooseHost(&context));
+  EXPECT_EQ(hostSet().hosts_[0], lb->chooseHost(&context));
+  EXPECT_EQ(2UL, stats_.lb_hash_bounded_load_fallback_.value());
+
+  // No host receives more than 1.5 times the average.
+  std::unordered_map<HostConstSharedPtr, uint32_t> requests{
+      {hostSet().hosts_[4], 1}, {hostSet().hosts_[2], 1}, {hostSet().hosts_[0], 1}};
+  for (uint32_t i = 3; i < 120; ++i) {
+    requests[lb->chooseHost(&context)]++;
+  }
+  for (const auto& host_requests : requests) {
+    EXPECT_LE(host_requests.second, 30U);
+  }
+}
+
 } // namespace Upstream
 } // namespace Envoy
@@ -38,7 +38,7 @@ public:
   typedef std::vector<std::pair<std::string, ProtobufWkt::Value>> MetadataVector;
 
   void test(std::string expected, const MetadataVector& metadata) {
-    SubsetLoadBalancer::SubsetMetadata subset_metadata(metadata);
+    SubsetLoadBalancer::SubsetMetadata subset_metadata(metadata.begin(), metadata.end());
     EXPECT_EQ(expected, lb_.get()->describeMetadata(subset_metadata));
   }
 
@@ -70,6 +70,7 @@ public:
 
       matches_.emplace_back(
           std::make_shared<const TestMetadataMatchCriterion>(it.first, HashedValue(v)));
+      hash_ = HashedValue::combine(hash_, it.first, HashedValue(v));
     }
   }
 
@@ -77,6 +78,7 @@ public:
   metadataMatchCriteria() const override {
     return matches_;
   }
+  uint64_t hash() const override { return hash_; }
 
   Router::MetadataMatchCriteriaConstPtr
   mergeMatchCriteria(const ProtobufWkt::Struct&) const override {
@@ -85,6 +87,19 @@ public:
 
 private:
   std::vector<Router::MetadataMatchCriterionConstSharedPtr> matches_;
+  uint64_t hash_{};
+};
+
+// Criteria that report an arbitrary hash, to simulate hash collisions.
+class CollidingMetadataMatchCriteria : public TestMetadataMatchCriteria {
+public:
+  CollidingMetadataMatchCriteria(const std::map<std::string, std::string> matches, uint64_t hash)
+      : TestMetadataMatchCriteria(matches), colliding_hash_(hash) {}
+
+  uint64_t hash() const override { return colliding_hash_; }
+
+private:
+  const uint64_t colliding_hash_;
 };
 
 class TestLoadBalancerContext : public LoadBalancerContextBase {
@@ -93,6 +108,8 @@ public:
       std::initializer_list<std::map<std::string, std::string>::value_type> metadata_matches)
       : matches_(
             new TestMetadataMatchCriteria(std::map<std::string, std::string>(metadata_matches))) {}
+  TestLoadBalancerContext(const std::shared_ptr<Router::MetadataMatchCriteria>& matches)
+      : matches_(matches) {}
 
   // Upstream::LoadBalancerContext
   absl::optional<uint64_t> computeHashKey() override { return {}; }
@@ -174,7 +191,8 @@ public:
     }
 
     lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, runtime_, random_,
-                                     subset_info_, ring_hash_lb_config_, common_config_));
+                                     subset_info_, ring_hash_lb_config_, least_request_lb_config_,
+                                     common_config_));
   }
 
   void zoneAwareInit(const std::vector<HostURLMetadataMap>& host_metadata_per_locality,
@@ -218,7 +236,7 @@ public:
 
     lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, &local_priority_set_, stats_,
                                      runtime_, random_, subset_info_, ring_hash_lb_config_,
-                                     common_config_));
+                                     least_request_lb_config_, common_config_));
   }
 
   HostSharedPtr makeHost(const std::string& url, const HostMetadata& metadata) {
@@ -373,6 +391,7 @@ public:
   NiceMock<MockLoadBalancerSubsetInfo> subset_info_;
   std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
   envoy::api::v2::Cluster::RingHashLbConfig ring_hash_lb_config_;
+  envoy::api::v2::Cluster::LeastRequestLbConfig least_request_lb_config_;
   envoy::api::v2::Cluster::CommonLbConfig common_config_;
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Runtime::MockRandomGenerator> random_;
@@ -534,6 +553,31 @@ TEST_F(SubsetLoadBalancerTest, BalancesSubset) {
   EXPECT_EQ(4U, stats_.lb_subsets_selected_.value());
 }
 
+TEST_F(SubsetLoadBalancerTest, SubsetLookupVerifiesCriteriaOnHashCollision) {
+  EXPECT_CALL(subset_info_, fallbackPolicy())
+      .WillRepeatedly(Return(envoy::api::v2::Cluster::LbSubsetConfig::NO_FALLBACK));
+
+  std::vector<std::set<std::string>> subset_keys = {{"version"}};
+  EXPECT_CALL(subset_info_, subsetKeys()).WillRepeatedly(ReturnRef(subset_keys));
+
+  init({
+      {"tcp://127.0.0.1:80", {{"version", "1.0"}}},
+      {"tcp://127.0.0.1:81", {{"version", "1.1"}}},
+  });
+
+  // Criteria for an unknown version whose hash collides with the 1.0 subset.
+  TestMetadataMatchCriteria criteria_10({{"version", "1.0"}});
+  TestLoadBalancerContext context_colliding(std::make_shared<CollidingMetadataMatchCriteria>(
+      std::map<std::string, std::string>{{"version", "2.0"}}, criteria_10.hash()));
+  // Criteria for the 1.1 subset whose hash collides with the 1.0 subset.
+  TestLoadBalancerContext context_11_colliding(std::make_shared<CollidingMetadataMatchCriteria>(
+      std::map<std::string, std::string>{{"version", "1.1"}}, criteria_10.hash()));
+
+  EXPECT_EQ(nullptr, lb_->chooseHost(&context_colliding));
+  EXPECT_EQ(nullptr, lb_->chooseHost(&context_11_colliding));
+  EXPECT_EQ(0U, stats_.lb_subsets_selected_.value());
+}
+
 TEST_P(SubsetLoadBalancerTest, BalancesSubsetAfterUpdate) {
   EXPECT_CALL(subset_info_, fallbackPolicy())
       .WillRepeatedly(Return(envoy::api::v2::Cluster::LbSubsetConfig::NO_FALLBACK));
@@ -992,7 +1036,8 @@ TEST_F(SubsetLoadBalancerTest, IgnoresHostsWithoutMetadata) {
   host_set_.healthy_hosts_per_locality_ = host_set_.hosts_per_locality_;
 
   lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, runtime_, random_,
-                                   subset_info_, ring_hash_lb_config_, common_config_));
+                                   subset_info_, ring_hash_lb_config_, least_request_lb_config_,
+                                   common_config_));
 
   TestLoadBalancerContext context_version({{"version", "1.0"}});
 
@@ -1396,7 +1441,8 @@ TEST_F(SubsetLoadBalancerTest, DisabledLocalityWeightAwareness) {
       host_set_, {1, 100});
 
   lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, runtime_, random_,
-                                   subset_info_, ring_hash_lb_config_, common_config_));
+                                   subset_info_, ring_hash_lb_config_, least_request_lb_config_,
+                                   common_config_));
 
   TestLoadBalancerContext context({{"version", "1.1"}});
 
@@ -1424,7 +1470,8 @@ TEST_F(SubsetLoadBalancerTest, EnabledLocalityWeightAwareness) {
       host_set_, {1, 100});
 
   lb_.reset(new SubsetLoadBalancer(lb_type_, priority_set_, nullptr, stats_, runtime_, random_,
-                                   subset_info_, ring_hash_lb_config_, common_config_));
+                                   subset_info_, ring_hash_lb_config_, least_request_lb_config_,
+                                   common_config_));
 
   TestLoadBalancerContext context({{"version", "1.1"}});
 
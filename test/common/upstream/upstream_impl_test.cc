@@ -760,6 +760,78 @@ TEST(HostImplTest, HostnameCanaryAndLocality) {
   EXPECT_EQ("world", host.locality().sub_zone());
 }
 
+// The envoy.lb metadata is hashed when the host is created and when its metadata is replaced.
+TEST(HostImplTest, LbMetadata) {
+  MockCluster cluster;
+  envoy::api::v2::core::Metadata metadata;
+  Config::Metadata::mutableMetadataValue(metadata, Config::MetadataFilters::get().ENVOY_LB,
+                                         "version")
+      .set_string_value("1.0");
+  Config::Metadata::mutableMetadataValue(metadata, "other", "stage").set_string_value("prod");
+  HostSharedPtr host = makeTestHost(cluster.info_, "tcp://10.0.0.1:1234", metadata);
+
+  LbMetadataConstSharedPtr lb_metadata = host->lbMetadata();
+  ASSERT_EQ(1, lb_metadata->size());
+  EXPECT_EQ("1.0", lb_metadata->at("version").value().string_value());
+  ProtobufWkt::Value version;
+  version.set_string_value("1.0");
+  EXPECT_EQ(HashedValue(version), lb_metadata->at("version"));
+
+  host->metadata(envoy::api::v2::core::Metadata());
+  EXPECT_TRUE(host->lbMetadata()->empty());
+  // Holders of the previous metadata keep it.
+  EXPECT_EQ(1, lb_metadata->size());
+}
+
+// Hosts with equivalent localities and metadata share them.
+TEST(HostImplTest, SharedLocalityAndMetadata) {
+  MockCluster cluster;
+  envoy::api::v2::core::Metadata metadata;
+  Config::Metadata::mutableMetadataValue(metadata, Config::MetadataFilters::get().ENVOY_LB,
+                                         "version")
+      .set_string_value("1.0");
+  envoy::api::v2::core::Locality locality;
+  locality.set_zone("us-east-1a");
+  auto make_host = [&](const std::string& url) {
+    return std::make_shared<HostImpl>(
+        cluster.info_, "", Network::Utility::resolveUrl(url), metadata, 1, locality,
+        envoy::api::v2::endpoint::Endpoint::HealthCheckConfig::default_instance());
+  };
+
+  HostSharedPtr host1 = make_host("tcp://10.0.0.1:1234");
+  HostSharedPtr host2 = make_host("tcp://10.0.0.2:1234");
+  EXPECT_EQ(&host1->locality(), &host2->locality());
+  EXPECT_EQ(host1->metadata(), host2->metadata());
+  EXPECT_EQ(host1->lbMetadata(), host2->lbMetadata());
+
+  locality.set_zone("us-east-1b");
+  HostSharedPtr host3 = make_host("tcp://10.0.0.3:1234");
+  EXPECT_NE(&host1->locality(), &host3->locality());
+  EXPECT_EQ("us-east-1b", host3->locality().zone());
+
+  // Replacing the metadata of a host leaves the other hosts' alone.
+  host2->metadata(envoy::api::v2::core::Metadata());
+  EXPECT_NE(host1->metadata(), host2->metadata());
+  EXPECT_EQ("1.0", host1->lbMetadata()->at("version").value().string_value());
+}
+
+// Host stats are created on first use.
+TEST(HostImplTest, Stats) {
+  MockCluster cluster;
+  HostSharedPtr host = makeTestHost(cluster.info_, "tcp://10.0.0.1:1234");
+  host->stats().rq_total_.inc();
+  EXPECT_EQ(1, host->stats().rq_total_.value());
+
+  bool found = false;
+  for (const Stats::CounterSharedPtr& counter : host->counters()) {
+    if (counter->name() == "rq_total") {
+      EXPECT_EQ(1, counter->value());
+      found = true;
+    }
+  }
+  EXPECT_TRUE(found);
+}
+
 TEST(StaticClusterImplTest, InitialHosts) {
   Stats::IsolatedStoreImpl stats;
   Ssl::MockContextManager ssl_context_manager;
@@ -1532,6 +1604,102 @@ TEST_F(ClusterInfoImplTest, Metadata) {
 }
 
 // Cluster extension protocol options fails validation when configured for an unregistered filter.
+TEST_F(ClusterInfoImplTest, RetryBudget) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+    circuit_breakers:
+      thresholds:
+      - priority: DEFAULT
+        max_retries: 10
+        retry_budget:
+          budget_percent:
+            value: 10
+      - priority: HIGH
+        max_retries: 10
+  )EOF";
+
+  auto cluster = makeCluster(yaml);
+  // Without load, the default minimum of the budget applies instead of max_retries.
+  EXPECT_EQ(3U, cluster->info()->resourceManager(ResourcePriority::Default).retries().max());
+  EXPECT_EQ(10U, cluster->info()->resourceManager(ResourcePriority::High).retries().max());
+}
+
+// The pending request queue bounds are parsed, and the target delay must be below the interval.
+TEST_F(ClusterInfoImplTest, PendingRequestQueue) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+    pending_request_queue: { target_delay: 0.005s, interval: 0.1s }
+  )EOF";
+
+  auto cluster = makeCluster(yaml);
+  ASSERT_TRUE(cluster->info()->pendingRequestQueue().has_value());
+  EXPECT_EQ(std::chrono::milliseconds(5), cluster->info()->pendingRequestQueue()->target_delay_);
+  EXPECT_EQ(std::chrono::milliseconds(100), cluster->info()->pendingRequestQueue()->interval_);
+
+  const std::string invalid_yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+    pending_request_queue: { target_delay: 0.1s, interval: 0.1s }
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(
+      makeCluster(invalid_yaml), EnvoyException,
+      "cluster: pending request queue target_delay must be less than interval");
+}
+
+// Shared connection pools report per host feedback to another cluster's host, so they can't be
+// combined with what depends on it.
+TEST_F(ClusterInfoImplTest, SharedConnPoolsRejectPerHostFeedback) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+    share_connection_pools: true
+  )EOF";
+
+  EXPECT_TRUE(makeCluster(yaml)->info()->sharedConnPoolKey().has_value());
+
+  const std::string least_request_yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: LEAST_REQUEST
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+    share_connection_pools: true
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(
+      makeCluster(least_request_yaml), EnvoyException,
+      "cluster: 'share_connection_pools' may not be used with LB type 'least_request'");
+
+  const std::string outlier_detection_yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+    share_connection_pools: true
+    outlier_detection: {}
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(
+      makeCluster(outlier_detection_yaml), EnvoyException,
+      "cluster: 'share_connection_pools' may not be used with 'outlier_detection'");
+}
+
 TEST_F(ClusterInfoImplTest, ExtensionProtocolOptionsForUnknownFilter) {
   const std::string yaml = R"EOF(
     name: name
@@ -8,8 +8,12 @@
 
 #include <unistd.h>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/lock_guard.h"
+#include "common/common/regex.h"
 #include "common/common/thread.h"
+#include "common/event/libevent.h"
+#include "common/network/connection_impl.h"
 #include "common/runtime/runtime_impl.h"
 
 #include "exe/main_common.h"
@@ -110,6 +114,41 @@ TEST_P(MainCommonTest, ConstructDestructHotRestartDisabledNoInit) {
   EXPECT_TRUE(main_common.run());
 }
 
+// Process wide settings from the command line are applied when the server starts, not when the
+// options are parsed.
+TEST_P(MainCommonTest, ApplyProcessWideOptions) {
+  addArg("--disable-hot-restart");
+  addArg("--use-libevent-buffers");
+  addArg("--event-loop-backend");
+  addArg("epoll_changelist");
+  addArg("--read-budget-bytes");
+  addArg("65536");
+  addArg("--use-std-regex");
+  addArg("--max-regex-program-size");
+  addArg("5000");
+  initOnly();
+  OptionsImpl options(argc(), argv(), &MainCommon::hotRestartVersion, spdlog::level::info);
+  EXPECT_FALSE(Buffer::OwnedImpl::usingOldImpl());
+  EXPECT_EQ(Event::Libevent::Backend::Default, Event::Libevent::Global::backend());
+  EXPECT_EQ(0, Network::ConnectionImpl::readBudget());
+  EXPECT_EQ(Regex::Engine::GoogleRe2, Regex::Utility::defaultEngine());
+  EXPECT_EQ(Regex::Utility::DefaultMaxProgramSize, Regex::Utility::maxProgramSize());
+  {
+    MainCommonBase main_common(options);
+    EXPECT_TRUE(Buffer::OwnedImpl::usingOldImpl());
+    EXPECT_EQ(Event::Libevent::Backend::EpollChangelist, Event::Libevent::Global::backend());
+    EXPECT_EQ(65536, Network::ConnectionImpl::readBudget());
+    EXPECT_EQ(Regex::Engine::StdRegex, Regex::Utility::defaultEngine());
+    EXPECT_EQ(5000, Regex::Utility::maxProgramSize());
+    EXPECT_TRUE(main_common.run());
+  }
+  Buffer::OwnedImpl::useOldImpl(false);
+  Event::Libevent::Global::setBackend(Event::Libevent::Backend::Default);
+  Network::ConnectionImpl::setReadBudget(0);
+  Regex::Utility::setDefaultEngine(Regex::Engine::GoogleRe2);
+  Regex::Utility::setMaxProgramSize(Regex::Utility::DefaultMaxProgramSize);
+}
+
 // Ensurees that existing users of main_common() can link.
 TEST_P(MainCommonTest, LegacyMain) {
 #ifdef ENVOY_HANDLE_SIGNALS
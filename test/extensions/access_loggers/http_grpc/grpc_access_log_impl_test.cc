@@ -1,8 +1,10 @@
 #include "common/network/address_impl.h"
+#include "common/stats/isolated_store_impl.h"
 
 #include "extensions/access_loggers/http_grpc/grpc_access_log_impl.h"
 
 #include "test/mocks/access_log/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/grpc/mocks.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/request_info/mocks.h"
@@ -31,7 +33,7 @@ public:
       return Grpc::AsyncClientPtr{async_client_};
     }));
     streamer_ = std::make_unique<GrpcAccessLogStreamerImpl>(Grpc::AsyncClientFactoryPtr{factory_},
-                                                            tls_, local_info_);
+                                                            tls_, local_info_, stats_store_);
   }
 
   void expectStreamStart(MockAccessLogStream& stream, AccessLogCallbacks** callbacks_to_set) {
@@ -43,8 +45,24 @@ public:
         }));
   }
 
+  // Configuration that sends each log entry on its own.
+  envoy::config::accesslog::v2::CommonGrpcAccessLogConfig
+  unbufferedConfig(const std::string& name) {
+    envoy::config::accesslog::v2::CommonGrpcAccessLogConfig config;
+    config.set_log_name(name);
+    config.mutable_buffer_size_bytes()->set_value(0);
+    return config;
+  }
+
+  envoy::service::accesslog::v2::StreamAccessLogsMessage logMessage(const std::string& path) {
+    envoy::service::accesslog::v2::StreamAccessLogsMessage message;
+    message.mutable_http_logs()->add_log_entry()->mutable_request()->set_path(path);
+    return message;
+  }
+
   NiceMock<ThreadLocal::MockInstance> tls_;
   LocalInfo::MockLocalInfo local_info_;
+  Stats::IsolatedStoreImpl stats_store_;
   Grpc::MockAsyncClient* async_client_{new Grpc::MockAsyncClient};
   Grpc::MockAsyncClientFactory* factory_{new Grpc::MockAsyncClientFactory};
   std::unique_ptr<GrpcAccessLogStreamerImpl> streamer_;
@@ -53,19 +71,36 @@ public:
 // Test basic stream logging flow.
 TEST_F(GrpcAccessLogStreamerImplTest, BasicFlow) {
   InSequence s;
+  const auto config_log1 = unbufferedConfig("log1");
+  const auto config_log2 = unbufferedConfig("log2");
 
   // Start a stream for the first log.
   MockAccessLogStream stream1;
   AccessLogCallbacks* callbacks1;
   expectStreamStart(stream1, &callbacks1);
   EXPECT_CALL(local_info_, node());
-  EXPECT_CALL(stream1, sendMessage(_, false));
-  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log1;
-  streamer_->send(message_log1, "log1");
-
-  message_log1.Clear();
-  EXPECT_CALL(stream1, sendMessage(_, false));
-  streamer_->send(message_log1, "log1");
+  EXPECT_CALL(stream1, sendMessage(_, false))
+      .WillOnce(Invoke([](const Protobuf::Message& message, bool) {
+        const auto& log_message =
+            dynamic_cast<const envoy::service::accesslog::v2::StreamAccessLogsMessage&>(message);
+        EXPECT_EQ("log1", log_message.identifier().log_name());
+        ASSERT_EQ(1, log_message.http_logs().log_entry_size());
+        EXPECT_EQ("/a", log_message.http_logs().log_entry(0).request().path());
+      }));
+  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log1 = logMessage("/a");
+  streamer_->send(message_log1, config_log1);
+
+  // Only the first message on a stream carries the identifier.
+  EXPECT_CALL(stream1, sendMessage(_, false))
+      .WillOnce(Invoke([](const Protobuf::Message& message, bool) {
+        const auto& log_message =
+            dynamic_cast<const envoy::service::accesslog::v2::StreamAccessLogsMessage&>(message);
+        EXPECT_FALSE(log_message.has_identifier());
+        ASSERT_EQ(1, log_message.http_logs().log_entry_size());
+        EXPECT_EQ("/b", log_message.http_logs().log_entry(0).request().path());
+      }));
+  message_log1 = logMessage("/b");
+  streamer_->send(message_log1, config_log1);
 
   // Start a stream for the second log.
   MockAccessLogStream stream2;
@@ -73,8 +108,8 @@ TEST_F(GrpcAccessLogStreamerImplTest, BasicFlow) {
   expectStreamStart(stream2, &callbacks2);
   EXPECT_CALL(local_info_, node());
   EXPECT_CALL(stream2, sendMessage(_, false));
-  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log2;
-  streamer_->send(message_log2, "log2");
+  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log2 = logMessage("/c");
+  streamer_->send(message_log2, config_log2);
 
   // Verify that sending an empty response message doesn't do anything bad.
   callbacks1->onReceiveMessage(
@@ -85,7 +120,11 @@ TEST_F(GrpcAccessLogStreamerImplTest, BasicFlow) {
   expectStreamStart(stream2, &callbacks2);
   EXPECT_CALL(local_info_, node());
   EXPECT_CALL(stream2, sendMessage(_, false));
-  streamer_->send(message_log2, "log2");
+  message_log2 = logMessage("/d");
+  streamer_->send(message_log2, config_log2);
+
+  EXPECT_EQ(4U, stats_store_.counter("access_logs.grpc_access_log.logs_written").value());
+  EXPECT_EQ(0U, stats_store_.counter("access_logs.grpc_access_log.logs_dropped").value());
 }
 
 // Test that stream failure is handled correctly.
@@ -99,15 +138,72 @@ TEST_F(GrpcAccessLogStreamerImplTest, StreamFailure) {
             return nullptr;
           }));
   EXPECT_CALL(local_info_, node());
-  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log1;
-  streamer_->send(message_log1, "log1");
+  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log1 = logMessage("/a");
+  streamer_->send(message_log1, unbufferedConfig("log1"));
+
+  EXPECT_EQ(0U, stats_store_.counter("access_logs.grpc_access_log.logs_written").value());
+  EXPECT_EQ(1U, stats_store_.counter("access_logs.grpc_access_log.logs_dropped").value());
+}
+
+// Test that log entries are batched until the buffer is full or the flush timer fires.
+TEST_F(GrpcAccessLogStreamerImplTest, Batching) {
+  InSequence s;
+
+  envoy::config::accesslog::v2::CommonGrpcAccessLogConfig config;
+  config.set_log_name("log1");
+  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log1 = logMessage("/a");
+  config.mutable_buffer_size_bytes()->set_value(
+      2 * message_log1.http_logs().log_entry(0).ByteSizeLong());
+  config.mutable_buffer_flush_interval()->set_seconds(5);
+
+  Event::MockTimer* flush_timer = new Event::MockTimer(&tls_.dispatcher_);
+  EXPECT_CALL(*flush_timer, enableTimer(std::chrono::milliseconds(5000)));
+  streamer_->send(message_log1, config);
+
+  // The second entry fills the buffer.
+  MockAccessLogStream stream1;
+  AccessLogCallbacks* callbacks1;
+  expectStreamStart(stream1, &callbacks1);
+  EXPECT_CALL(local_info_, node());
+  EXPECT_CALL(stream1, sendMessage(_, false))
+      .WillOnce(Invoke([](const Protobuf::Message& message, bool) {
+        const auto& log_message =
+            dynamic_cast<const envoy::service::accesslog::v2::StreamAccessLogsMessage&>(message);
+        EXPECT_EQ("log1", log_message.identifier().log_name());
+        ASSERT_EQ(2, log_message.http_logs().log_entry_size());
+        EXPECT_EQ("/a", log_message.http_logs().log_entry(0).request().path());
+        EXPECT_EQ("/b", log_message.http_logs().log_entry(1).request().path());
+      }));
+  message_log1 = logMessage("/b");
+  streamer_->send(message_log1, config);
+
+  // The timer sends what is left.
+  message_log1 = logMessage("/c");
+  streamer_->send(message_log1, config);
+  EXPECT_CALL(stream1, sendMessage(_, false))
+      .WillOnce(Invoke([](const Protobuf::Message& message, bool) {
+        const auto& log_message =
+            dynamic_cast<const envoy::service::accesslog::v2::StreamAccessLogsMessage&>(message);
+        EXPECT_FALSE(log_message.has_identifier());
+        ASSERT_EQ(1, log_message.http_logs().log_entry_size());
+        EXPECT_EQ("/c", log_message.http_logs().log_entry(0).request().path());
+      }));
+  EXPECT_CALL(*flush_timer, enableTimer(std::chrono::milliseconds(5000)));
+  flush_timer->callback_();
+
+  // Nothing is sent when there is nothing buffered.
+  EXPECT_CALL(*flush_timer, enableTimer(std::chrono::milliseconds(5000)));
+  flush_timer->callback_();
+
+  EXPECT_EQ(3U, stats_store_.counter("access_logs.grpc_access_log.logs_written").value());
 }
 
 class MockGrpcAccessLogStreamer : public GrpcAccessLogStreamer {
 public:
   // GrpcAccessLogStreamer
-  MOCK_METHOD2(send, void(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
-                          const std::string& log_name));
+  MOCK_METHOD2(send,
+               void(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
+                    const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config));
 };
 
 class HttpGrpcAccessLogTest : public testing::Test {
@@ -125,10 +221,12 @@ public:
 
     envoy::service::accesslog::v2::StreamAccessLogsMessage expected_request_msg;
     MessageUtil::loadFromYaml(expected_request_msg_yaml, expected_request_msg);
-    EXPECT_CALL(*streamer_, send(_, "hello_log"))
+    EXPECT_CALL(*streamer_, send(_, _))
         .WillOnce(Invoke(
-            [expected_request_msg](envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
-                                   const std::string&) {
+            [expected_request_msg](
+                envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
+                const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config) {
+              EXPECT_EQ("hello_log", config.log_name());
               EXPECT_EQ(message.DebugString(), expected_request_msg.DebugString());
             }));
   }
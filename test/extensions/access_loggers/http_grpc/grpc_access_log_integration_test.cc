@@ -44,6 +44,8 @@ public:
           envoy::config::accesslog::v2::HttpGrpcAccessLogConfig config;
           auto* common_config = config.mutable_common_config();
           common_config->set_log_name("foo");
+          // Send each log entry in its own message.
+          common_config->mutable_buffer_size_bytes()->set_value(0);
           setGrpcService(*common_config->mutable_grpc_service(), "accesslog",
                          fake_upstreams_.back()->localAddress());
           MessageUtil::jsonConvert(config, *access_log->mutable_config());
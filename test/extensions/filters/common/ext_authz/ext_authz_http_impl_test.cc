@@ -199,6 +199,30 @@ TEST_F(ExtAuthzHttpClientTest, AuthorizationDeniedWithAllAttributes) {
   client_.onSuccess(std::move(check_response));
 }
 
+// Test that the cache-control header of the response sets the max age of the decision.
+TEST_F(ExtAuthzHttpClientTest, AuthorizationMaxAge) {
+  envoy::service::auth::v2alpha::CheckRequest request;
+  absl::optional<std::chrono::seconds> max_age;
+  EXPECT_CALL(request_callbacks_, onComplete_(_))
+      .WillRepeatedly(Invoke([&max_age](ResponsePtr& response) { max_age = response->max_age; }));
+
+  const auto respond = [this, &request](const std::string& cache_control) {
+    const auto headers = TestCommon::makeHeaderValueOption(
+        {{":status", "200", false}, {"cache-control", cache_control, false}});
+    client_.check(request_callbacks_, request, Tracing::NullSpan::instance());
+    client_.onSuccess(TestCommon::makeMessageResponse(headers));
+  };
+
+  respond("");
+  EXPECT_FALSE(max_age.has_value());
+  respond("private, max-age=30");
+  EXPECT_EQ(std::chrono::seconds(30), max_age.value());
+  respond("max-age=30, no-store");
+  EXPECT_EQ(std::chrono::seconds(0), max_age.value());
+  respond("max-age=invalid");
+  EXPECT_FALSE(max_age.has_value());
+}
+
 // Test the client when an unknown error occurs.
 TEST_F(ExtAuthzHttpClientTest, AuthorizationRequestError) {
   envoy::service::auth::v2alpha::CheckRequest request;
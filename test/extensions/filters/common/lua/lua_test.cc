@@ -152,6 +152,63 @@ TEST_F(LuaTest, MarkDead) {
   lua_gc(cr1->luaState(), LUA_GCCOLLECT, 0);
 }
 
+// Finished coroutines are reused, failed and yielded ones are not.
+TEST_F(LuaTest, CoroutinePool) {
+  const std::string SCRIPT{R"EOF(
+    function callMe(object)
+      object:testCall()
+    end
+
+    function fail()
+      error("failed")
+    end
+
+    function yieldMe()
+      coroutine.yield()
+    end
+  )EOF"};
+
+  setup(SCRIPT);
+  EXPECT_NE(LUA_REFNIL, state_->getGlobalRef(state_->registerGlobal("callMe")));
+  EXPECT_NE(LUA_REFNIL, state_->getGlobalRef(state_->registerGlobal("fail")));
+  EXPECT_NE(LUA_REFNIL, state_->getGlobalRef(state_->registerGlobal("yieldMe")));
+
+  CoroutinePtr cr(state_->createCoroutine());
+  lua_State* thread = cr->luaState();
+  for (int i = 0; i < 2; i++) {
+    LuaRef<TestObject> ref(TestObject::create(cr->luaState()), true);
+    EXPECT_CALL(*ref.get(), doTestCall(_));
+    cr->start(state_->getGlobalRef(0), 1, yield_callback_);
+    EXPECT_TRUE(cr->reusable());
+    state_->releaseCoroutine(std::move(cr));
+    EXPECT_EQ(1U, state_->pooledCoroutines());
+
+    cr = state_->createCoroutine();
+    EXPECT_EQ(0U, state_->pooledCoroutines());
+    EXPECT_EQ(thread, cr->luaState());
+    EXPECT_EQ(Coroutine::State::NotStarted, cr->state());
+    EXPECT_EQ(0, lua_gettop(cr->luaState()));
+
+    EXPECT_CALL(*ref.get(), onDestroy());
+    ref.reset();
+    lua_gc(cr->luaState(), LUA_GCCOLLECT, 0);
+  }
+
+  EXPECT_THROW_WITH_MESSAGE(cr->start(state_->getGlobalRef(1), 0, yield_callback_), LuaException,
+                            "[string \"...\"]:7: failed");
+  EXPECT_FALSE(cr->reusable());
+  state_->releaseCoroutine(std::move(cr));
+  EXPECT_EQ(0U, state_->pooledCoroutines());
+
+  cr = state_->createCoroutine();
+  EXPECT_NE(thread, cr->luaState());
+  EXPECT_CALL(on_yield_, ready());
+  cr->start(state_->getGlobalRef(2), 0, yield_callback_);
+  EXPECT_FALSE(cr->reusable());
+  state_->releaseCoroutine(std::move(cr));
+  EXPECT_EQ(0U, state_->pooledCoroutines());
+}
+
 } // namespace Lua
 } // namespace Common
 } // namespace Filters
@@ -0,0 +1,117 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/network/utility.h"
+
+#include "extensions/filters/common/rbac/engine_impl.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+// One policy per service, each allowing a path prefix to a client subnet.
+constexpr int NumPolicies = 2000;
+
+static envoy::config::rbac::v2alpha::RBAC rbac() {
+  envoy::config::rbac::v2alpha::RBAC rbac;
+  rbac.set_action(envoy::config::rbac::v2alpha::RBAC_Action::RBAC_Action_ALLOW);
+  for (int i = 0; i < NumPolicies; i++) {
+    envoy::config::rbac::v2alpha::Policy policy;
+    auto* header = policy.add_permissions()->mutable_header();
+    header->set_name(":path");
+    header->set_prefix_match(fmt::format("/service{}/", i));
+    auto* source_ip = policy.add_principals()->mutable_source_ip();
+    source_ip->set_address_prefix(fmt::format("10.{}.{}.0", i / 256, i % 256));
+    source_ip->mutable_prefix_len()->set_value(24);
+    (*rbac.mutable_policies())[fmt::format("service{}", i)] = policy;
+  }
+  return rbac;
+}
+
+static void runEngine(benchmark::State& state,
+                      const std::function<bool(const Network::Connection&,
+                                               const Http::HeaderMap&, std::string*)>& allowed) {
+  testing::NiceMock<Network::MockConnection> connection;
+  Network::Address::InstanceConstSharedPtr local_address =
+      Network::Utility::parseInternetAddress("1.2.3.4", 443, false);
+  Network::Address::InstanceConstSharedPtr remote_address =
+      Network::Utility::parseInternetAddress("10.5.220.7", 5000, false);
+  ON_CALL(connection, localAddress()).WillByDefault(testing::ReturnRef(local_address));
+  ON_CALL(connection, remoteAddress()).WillByDefault(testing::ReturnRef(remote_address));
+  // The policy of service1500 allows the first request, none allows the second.
+  const std::vector<Http::TestHeaderMapImpl> requests{{{":path", "/service1500/get"}},
+                                                      {{":path", "/unknown/get"}}};
+
+  std::string policy_id;
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(allowed(connection, requests[i++ % requests.size()], &policy_id));
+  }
+}
+
+static void BM_IndexedPolicies(benchmark::State& state) {
+  const RoleBasedAccessControlEngineImpl engine(rbac());
+  runEngine(state, [&engine](const Network::Connection& connection,
+                             const Http::HeaderMap& headers, std::string* policy_id) {
+    return engine.allowed(connection, headers, envoy::api::v2::core::Metadata(), policy_id);
+  });
+}
+BENCHMARK(BM_IndexedPolicies);
+
+// The policies evaluated in turn, as RoleBasedAccessControlEngineImpl previously did.
+static void BM_SequentialPolicies(benchmark::State& state) {
+  const envoy::config::rbac::v2alpha::RBAC rules = rbac();
+  const std::map<std::string, envoy::config::rbac::v2alpha::Policy> sorted_policies(
+      rules.policies().begin(), rules.policies().end());
+  std::vector<std::pair<std::string, PolicyMatcher>> policies;
+  for (const auto& policy : sorted_policies) {
+    policies.emplace_back(policy.first, PolicyMatcher(policy.second));
+  }
+
+  runEngine(state, [&policies](const Network::Connection& connection,
+                               const Http::HeaderMap& headers, std::string* policy_id) {
+    for (const auto& policy : policies) {
+      if (policy.second.matches(connection, headers, envoy::api::v2::core::Metadata())) {
+        *policy_id = policy.first;
+        return true;
+      }
+    }
+    return false;
+  });
+}
+BENCHMARK(BM_SequentialPolicies);
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn,
+                                      Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
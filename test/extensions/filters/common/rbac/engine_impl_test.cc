@@ -1,3 +1,4 @@
+#include "common/common/fmt.h"
 #include "common/network/utility.h"
 
 #include "extensions/filters/common/rbac/engine_impl.h"
@@ -79,6 +80,54 @@ TEST(RoleBasedAccessControlEngineImpl, DeniedBlacklist) {
   checkEngine(engine, true, conn);
 }
 
+
+TEST(RoleBasedAccessControlEngineImpl, IndexedPolicies) {
+  envoy::config::rbac::v2alpha::RBAC rbac;
+  rbac.set_action(envoy::config::rbac::v2alpha::RBAC_Action::RBAC_Action_ALLOW);
+  for (uint32_t i = 0; i < RBAC::RoleBasedAccessControlEngineImpl::MinIndexedPolicies; i++) {
+    envoy::config::rbac::v2alpha::Policy policy;
+    policy.add_permissions()->set_destination_port(100 + i);
+    policy.add_principals()->set_any(true);
+    (*rbac.mutable_policies())[fmt::format("port_{:02}", i)] = policy;
+  }
+  // Evaluated first, but neither indexed nor matching.
+  envoy::config::rbac::v2alpha::Policy policy;
+  policy.add_permissions()->set_any(true);
+  policy.add_principals()->mutable_authenticated()->mutable_principal_name()->set_exact("foo");
+  (*rbac.mutable_policies())["authenticated"] = policy;
+  // Found by the same port, but after "port_05".
+  policy.Clear();
+  policy.add_permissions()->set_destination_port(105);
+  policy.add_principals()->set_any(true);
+  (*rbac.mutable_policies())["port_zz"] = policy;
+
+  RBAC::RoleBasedAccessControlEngineImpl engine(rbac);
+  EXPECT_TRUE(engine.indexed());
+
+  testing::NiceMock<Envoy::Network::MockConnection> conn;
+  Envoy::Network::Address::InstanceConstSharedPtr addr =
+      Envoy::Network::Utility::parseInternetAddress("1.2.3.4", 105, false);
+  ON_CALL(conn, localAddress()).WillByDefault(ReturnRef(addr));
+  ON_CALL(Const(conn), ssl()).WillByDefault(Return(nullptr));
+
+  std::string policy_id;
+  checkEngine(engine, true, conn, Envoy::Http::HeaderMapImpl(), envoy::api::v2::core::Metadata(),
+              &policy_id);
+  EXPECT_EQ("port_05", policy_id);
+
+  addr = Envoy::Network::Utility::parseInternetAddress("1.2.3.4", 456, false);
+  checkEngine(engine, false, conn);
+}
+
+TEST(RoleBasedAccessControlEngineImpl, FewPoliciesNotIndexed) {
+  envoy::config::rbac::v2alpha::Policy policy;
+  policy.add_permissions()->set_destination_port(123);
+  policy.add_principals()->set_any(true);
+
+  envoy::config::rbac::v2alpha::RBAC rbac;
+  (*rbac.mutable_policies())["foo"] = policy;
+  EXPECT_FALSE(RBAC::RoleBasedAccessControlEngineImpl(rbac).indexed());
+}
 } // namespace
 } // namespace RBAC
 } // namespace Common
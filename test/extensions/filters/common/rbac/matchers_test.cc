@@ -86,10 +86,11 @@ TEST(OrMatcher, Permission_Set) {
   Envoy::Network::MockConnection conn;
   Envoy::Network::Address::InstanceConstSharedPtr addr =
       Envoy::Network::Utility::parseInternetAddress("1.2.3.4", 456, false);
-  EXPECT_CALL(conn, localAddress()).Times(2).WillRepeatedly(ReturnRef(addr));
+  EXPECT_CALL(conn, localAddress()).WillOnce(ReturnRef(addr));
 
   checkMatcher(RBAC::OrMatcher(set), false, conn);
 
+  // The cheaper any rule is evaluated first and short-circuits the port.
   perm = set.add_rules();
   perm->set_any(true);
 
@@ -106,16 +107,34 @@ TEST(OrMatcher, Principal_Set) {
   Envoy::Network::MockConnection conn;
   Envoy::Network::Address::InstanceConstSharedPtr addr =
       Envoy::Network::Utility::parseInternetAddress("1.2.4.6", 456, false);
-  EXPECT_CALL(conn, remoteAddress()).Times(2).WillRepeatedly(ReturnRef(addr));
+  EXPECT_CALL(conn, remoteAddress()).WillOnce(ReturnRef(addr));
 
   checkMatcher(RBAC::OrMatcher(set), false, conn);
 
+  // The cheaper any rule is evaluated first and short-circuits the source IP.
   id = set.add_ids();
   id->set_any(true);
 
   checkMatcher(RBAC::OrMatcher(set), true, conn);
 }
 
+TEST(AndMatcher, CheapRulesFirst) {
+  envoy::config::rbac::v2alpha::Principal_Set set;
+  set.add_ids()->mutable_authenticated()->mutable_principal_name()->set_exact("foo");
+  auto* cidr = set.add_ids()->mutable_source_ip();
+  cidr->set_address_prefix("1.2.3.0");
+  cidr->mutable_prefix_len()->set_value(24);
+
+  Envoy::Network::MockConnection conn;
+  Envoy::Network::Address::InstanceConstSharedPtr addr =
+      Envoy::Network::Utility::parseInternetAddress("1.2.4.6", 123, false);
+  EXPECT_CALL(conn, remoteAddress()).WillOnce(ReturnRef(addr));
+
+  // The source IP does not match, so the peer certificate is never looked at.
+  EXPECT_CALL(Const(conn), ssl()).Times(0);
+  checkMatcher(RBAC::AndMatcher(set), false, conn);
+}
+
 TEST(NotMatcher, Permission) {
   envoy::config::rbac::v2alpha::Permission perm;
   perm.set_any(true);
@@ -0,0 +1,197 @@
+#include <string>
+#include <vector>
+
+#include "common/http/header_map_impl.h"
+#include "common/network/address_impl.h"
+#include "common/network/utility.h"
+
+#include "extensions/filters/common/rbac/policy_index.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+namespace {
+
+class PolicyIndexTest : public testing::Test {
+public:
+  PolicyIndexTest() {
+    ON_CALL(connection_, localAddress()).WillByDefault(ReturnRef(local_address_));
+    ON_CALL(connection_, remoteAddress()).WillByDefault(ReturnRef(remote_address_));
+  }
+
+  envoy::config::rbac::v2alpha::Policy& addPolicy(const std::string& yaml) {
+    policies_.emplace_back();
+    MessageUtil::loadFromYaml(yaml, policies_.back());
+    return policies_.back();
+  }
+
+  std::vector<uint32_t> candidates(const Http::HeaderMap& headers) {
+    std::vector<const envoy::config::rbac::v2alpha::Policy*> policies;
+    for (const auto& policy : policies_) {
+      policies.push_back(&policy);
+    }
+    PolicyIndex index(policies);
+    unindexed_ = index.unindexed();
+
+    std::vector<uint32_t> candidates;
+    index.candidates(connection_, headers, candidates);
+    return candidates;
+  }
+
+  std::vector<envoy::config::rbac::v2alpha::Policy> policies_;
+  NiceMock<Network::MockConnection> connection_;
+  Network::Address::InstanceConstSharedPtr local_address_{
+      Network::Utility::parseInternetAddress("1.2.3.4", 443, false)};
+  Network::Address::InstanceConstSharedPtr remote_address_{
+      Network::Utility::parseInternetAddress("10.0.1.5", 5000, false)};
+  uint32_t unindexed_{};
+};
+
+TEST_F(PolicyIndexTest, Conditions) {
+  // 0: a destination port.
+  addPolicy("{permissions: [{destination_port: 443}], principals: [{any: true}]}");
+  addPolicy("{permissions: [{destination_port: 80}], principals: [{any: true}]}");
+  // 2: a source range, as the permissions have no condition.
+  addPolicy(R"EOF(
+  permissions: [{any: true}]
+  principals: [{source_ip: {address_prefix: 10.0.1.0, prefix_len: 24}}]
+  )EOF");
+  addPolicy(R"EOF(
+  permissions: [{any: true}]
+  principals: [{source_ip: {address_prefix: 10.0.2.0, prefix_len: 24}}]
+  )EOF");
+  // 4: a destination range.
+  addPolicy(R"EOF(
+  permissions: [{destination_ip: {address_prefix: 1.2.0.0, prefix_len: 16}}]
+  principals: [{any: true}]
+  )EOF");
+  // 5: an exact header value.
+  addPolicy(R"EOF(
+  permissions: [{header: {name: ":method", exact_match: GET}}]
+  principals: [{any: true}]
+  )EOF");
+  addPolicy(R"EOF(
+  permissions: [{header: {name: ":method", exact_match: POST}}]
+  principals: [{any: true}]
+  )EOF");
+  // 7: a path prefix.
+  addPolicy(R"EOF(
+  permissions: [{header: {name: ":path", prefix_match: /api/}}]
+  principals: [{any: true}]
+  )EOF");
+  addPolicy(R"EOF(
+  permissions: [{header: {name: ":path", prefix_match: /admin/}}]
+  principals: [{any: true}]
+  )EOF");
+
+  Http::TestHeaderMapImpl headers{{":method", "GET"}, {":path", "/api/v1"}};
+  EXPECT_EQ((std::vector<uint32_t>{0, 2, 4, 5, 7}), candidates(headers));
+  EXPECT_EQ(0U, unindexed_);
+
+  Http::TestHeaderMapImpl other_headers{{":method", "PUT"}, {":path", "/"}};
+  EXPECT_EQ((std::vector<uint32_t>{0, 2, 4}), candidates(other_headers));
+}
+
+TEST_F(PolicyIndexTest, Unindexed) {
+  // Any permission and any principal.
+  addPolicy("{permissions: [{any: true}], principals: [{any: true}]}");
+  // One permission without a condition makes the permissions unusable.
+  addPolicy(R"EOF(
+  permissions: [{destination_port: 80}, {metadata: {filter: f, path: [{key: k}], value: {}}}]
+  principals: [{authenticated: {}}]
+  )EOF");
+  // Inverted, regex and empty exact header matches have no condition.
+  addPolicy(R"EOF(
+  permissions: [{header: {name: a, exact_match: b, invert_match: true}}]
+  principals: [{header: {name: a, regex_match: b.*}}]
+  )EOF");
+  addPolicy(R"EOF(
+  permissions: [{header: {name: a, exact_match: ""}}]
+  principals: [{not_id: {any: true}}]
+  )EOF");
+  addPolicy("{permissions: [{destination_port: 80}], principals: [{any: true}]}");
+
+  EXPECT_EQ((std::vector<uint32_t>{0, 1, 2, 3}), candidates(Http::TestHeaderMapImpl()));
+  EXPECT_EQ(4U, unindexed_);
+}
+
+TEST_F(PolicyIndexTest, CompositeRules) {
+  // An and rule requires its first rule with a condition.
+  addPolicy(R"EOF(
+  permissions:
+  - and_rules:
+      rules: [{any: true}, {destination_port: 443}, {destination_port: 80}]
+  principals: [{any: true}]
+  )EOF");
+  addPolicy(R"EOF(
+  permissions:
+  - and_rules:
+      rules: [{destination_port: 80}, {destination_port: 443}]
+  principals: [{any: true}]
+  )EOF");
+  // An or rule requires one of the conditions of all its rules.
+  addPolicy(R"EOF(
+  permissions: [{any: true}]
+  principals:
+  - or_ids:
+      ids:
+      - source_ip: {address_prefix: 192.168.0.0, prefix_len: 16}
+      - and_ids: {ids: [{source_ip: {address_prefix: 10.0.0.0, prefix_len: 8}}, {any: true}]}
+  )EOF");
+  addPolicy(R"EOF(
+  permissions:
+  - or_rules: {rules: [{destination_port: 80}, {any: true}]}
+  principals: [{any: true}]
+  )EOF");
+
+  EXPECT_EQ((std::vector<uint32_t>{0, 2, 3}), candidates(Http::TestHeaderMapImpl()));
+  EXPECT_EQ(1U, unindexed_);
+}
+
+TEST_F(PolicyIndexTest, DuplicateConditions) {
+  addPolicy(R"EOF(
+  permissions: [{destination_port: 443}, {header: {name: ":path", prefix_match: /}}]
+  principals: [{any: true}]
+  )EOF");
+  addPolicy(R"EOF(
+  permissions:
+  - header: {name: ":path", prefix_match: /a}
+  - header: {name: ":path", prefix_match: /ab}
+  - header: {name: ":path", exact_match: /abc}
+  principals: [{any: true}]
+  )EOF");
+
+  EXPECT_EQ((std::vector<uint32_t>{0, 1}),
+            candidates(Http::TestHeaderMapImpl{{":path", "/abc"}}));
+  EXPECT_EQ((std::vector<uint32_t>{0}), candidates(Http::TestHeaderMapImpl{{":path", "/b"}}));
+}
+
+TEST_F(PolicyIndexTest, NonIpAddresses) {
+  addPolicy("{permissions: [{destination_port: 443}], principals: [{any: true}]}");
+  addPolicy(R"EOF(
+  permissions: [{any: true}]
+  principals: [{source_ip: {address_prefix: 10.0.0.0, prefix_len: 8}}]
+  )EOF");
+
+  local_address_ = std::make_shared<Network::Address::PipeInstance>("/tmp/local");
+  remote_address_ = std::make_shared<Network::Address::PipeInstance>("/tmp/remote");
+  EXPECT_TRUE(candidates(Http::TestHeaderMapImpl()).empty());
+}
+
+} // namespace
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,100 @@
+#include <chrono>
+
+#include "common/http/header_map_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/adaptive_concurrency/adaptive_concurrency_filter.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/http/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+class MockConcurrencyController : public ConcurrencyController {
+public:
+  MOCK_METHOD0(forwardingDecision, RequestForwardingAction());
+  MOCK_METHOD1(recordLatencySample, void(std::chrono::nanoseconds rq_latency));
+  MOCK_METHOD0(cancelLatencySample, void());
+  MOCK_CONST_METHOD0(concurrencyLimit, uint32_t());
+};
+
+class AdaptiveConcurrencyFilterTest : public testing::Test {
+public:
+  AdaptiveConcurrencyFilterTest() {
+    config_ = std::make_shared<AdaptiveConcurrencyFilterConfig>(controller_, "test.", stats_,
+                                                                time_source_);
+    filter_ = std::make_unique<AdaptiveConcurrencyFilter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+  }
+
+  std::shared_ptr<MockConcurrencyController> controller_{
+      std::make_shared<MockConcurrencyController>()};
+  Stats::IsolatedStoreImpl stats_;
+  MockTimeSource time_source_;
+  AdaptiveConcurrencyFilterConfigSharedPtr config_;
+  std::unique_ptr<AdaptiveConcurrencyFilter> filter_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  Http::TestHeaderMapImpl request_headers_{{":method", "GET"}, {":path", "/"}};
+  Http::TestHeaderMapImpl response_headers_{{":status", "200"}};
+};
+
+TEST_F(AdaptiveConcurrencyFilterTest, ForwardedRequestRecordsLatency) {
+  const MonotonicTime start;
+  EXPECT_CALL(*controller_, forwardingDecision())
+      .WillOnce(Return(RequestForwardingAction::Forward));
+  EXPECT_CALL(time_source_, monotonicTime()).WillOnce(Return(start));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, true));
+
+  EXPECT_CALL(time_source_, monotonicTime())
+      .WillOnce(Return(start + std::chrono::milliseconds(5)));
+  EXPECT_CALL(*controller_, recordLatencySample(std::chrono::nanoseconds(5000000)));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers_, true));
+
+  EXPECT_CALL(*controller_, cancelLatencySample()).Times(0);
+  filter_->onDestroy();
+  EXPECT_EQ(0U, stats_.counter("test.rq_blocked").value());
+}
+
+TEST_F(AdaptiveConcurrencyFilterTest, BlockedRequest) {
+  EXPECT_CALL(*controller_, forwardingDecision()).WillOnce(Return(RequestForwardingAction::Block));
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, false))
+      .WillOnce(Invoke([](Http::HeaderMap& headers, bool) -> void {
+        EXPECT_STREQ("503", headers.Status()->value().c_str());
+      }));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_->decodeHeaders(request_headers_, true));
+  EXPECT_EQ(1U, stats_.counter("test.rq_blocked").value());
+
+  // The local reply is not a latency sample.
+  EXPECT_CALL(*controller_, recordLatencySample(_)).Times(0);
+  EXPECT_CALL(*controller_, cancelLatencySample()).Times(0);
+  filter_->encodeHeaders(response_headers_, true);
+  filter_->onDestroy();
+}
+
+TEST_F(AdaptiveConcurrencyFilterTest, ResetRequestCancelsSample) {
+  EXPECT_CALL(*controller_, forwardingDecision())
+      .WillOnce(Return(RequestForwardingAction::Forward));
+  EXPECT_CALL(time_source_, monotonicTime()).WillOnce(Return(MonotonicTime()));
+  filter_->decodeHeaders(request_headers_, false);
+
+  EXPECT_CALL(*controller_, cancelLatencySample());
+  filter_->onDestroy();
+}
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,153 @@
+#include <chrono>
+
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/adaptive_concurrency/gradient_controller.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+
+class GradientControllerTest : public testing::Test {
+public:
+  void initialize(const std::string& yaml) {
+    envoy::config::filter::http::adaptive_concurrency::v2alpha::GradientControllerConfig
+        proto_config;
+    MessageUtil::loadFromYaml(yaml, proto_config);
+
+    // gmock matches in LIFO order, so these are created in the reverse order of the controller.
+    min_rtt_calc_timer_ = new Event::MockTimer(&dispatcher_);
+    sample_timer_ = new Event::MockTimer(&dispatcher_);
+    EXPECT_CALL(*min_rtt_calc_timer_, enableTimer(std::chrono::milliseconds(60000)));
+    EXPECT_CALL(*sample_timer_, enableTimer(std::chrono::milliseconds(100)));
+    controller_ = std::make_unique<GradientController>(GradientControllerConfig(proto_config),
+                                                       dispatcher_, "test.", stats_);
+  }
+
+  void sampleLatency(std::chrono::milliseconds latency, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+      EXPECT_EQ(RequestForwardingAction::Forward, controller_->forwardingDecision());
+      controller_->recordLatencySample(latency);
+    }
+  }
+
+  uint64_t gauge(const std::string& name) { return stats_.gauge("test." + name).value(); }
+
+  const std::string yaml_ = R"EOF(
+min_rtt_request_count: 5
+min_concurrency: 2
+)EOF";
+
+  Stats::IsolatedStoreImpl stats_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Event::MockTimer* sample_timer_;
+  Event::MockTimer* min_rtt_calc_timer_;
+  std::unique_ptr<GradientController> controller_;
+};
+
+TEST_F(GradientControllerTest, Defaults) {
+  GradientControllerConfig config(
+      envoy::config::filter::http::adaptive_concurrency::v2alpha::GradientControllerConfig{});
+  EXPECT_EQ(std::chrono::milliseconds(100), config.sampleInterval());
+  EXPECT_DOUBLE_EQ(0.5, config.sampleAggregatePercentile());
+  EXPECT_DOUBLE_EQ(0.25, config.buffer());
+  EXPECT_EQ(std::chrono::milliseconds(60000), config.minRttCalcInterval());
+  EXPECT_EQ(50U, config.minRttRequestCount());
+  EXPECT_EQ(3U, config.minConcurrency());
+  EXPECT_EQ(1000U, config.maxConcurrencyLimit());
+}
+
+TEST_F(GradientControllerTest, BlocksAtLimit) {
+  initialize(yaml_);
+  EXPECT_EQ(2U, controller_->concurrencyLimit());
+  EXPECT_EQ(RequestForwardingAction::Forward, controller_->forwardingDecision());
+  EXPECT_EQ(RequestForwardingAction::Forward, controller_->forwardingDecision());
+  EXPECT_EQ(RequestForwardingAction::Block, controller_->forwardingDecision());
+
+  controller_->cancelLatencySample();
+  EXPECT_EQ(RequestForwardingAction::Forward, controller_->forwardingDecision());
+  controller_->cancelLatencySample();
+  controller_->cancelLatencySample();
+}
+
+TEST_F(GradientControllerTest, LimitFollowsLatency) {
+  initialize(yaml_);
+  EXPECT_EQ(1U, gauge("min_rtt_calculation_active"));
+
+  // The sample timer leaves the samples to the minimum RTT calculation.
+  sampleLatency(std::chrono::milliseconds(10), 4);
+  EXPECT_CALL(*sample_timer_, enableTimer(_));
+  sample_timer_->callback_();
+  EXPECT_EQ(2U, controller_->concurrencyLimit());
+
+  sampleLatency(std::chrono::milliseconds(10), 1);
+  EXPECT_EQ(0U, gauge("min_rtt_calculation_active"));
+  EXPECT_EQ(10U, gauge("min_rtt_msecs"));
+  EXPECT_EQ(2U, controller_->concurrencyLimit());
+
+  // Latency within the buffer over the minimum RTT grows the limit: 2 * 1.25 + sqrt(2.5).
+  sampleLatency(std::chrono::milliseconds(10), 2);
+  EXPECT_CALL(*sample_timer_, enableTimer(_));
+  sample_timer_->callback_();
+  EXPECT_EQ(4U, controller_->concurrencyLimit());
+  EXPECT_EQ(4U, gauge("concurrency_limit"));
+  EXPECT_EQ(10U, gauge("sample_rtt_msecs"));
+
+  // Queueing in the upstream shrinks the limit, by at most half: 4 * 0.5 + sqrt(2).
+  sampleLatency(std::chrono::milliseconds(100), 3);
+  EXPECT_CALL(*sample_timer_, enableTimer(_));
+  sample_timer_->callback_();
+  EXPECT_EQ(3U, controller_->concurrencyLimit());
+
+  // Intervals without samples leave the limit alone.
+  EXPECT_CALL(*sample_timer_, enableTimer(_));
+  sample_timer_->callback_();
+  EXPECT_EQ(3U, controller_->concurrencyLimit());
+}
+
+TEST_F(GradientControllerTest, MinRttRecalculation) {
+  initialize(yaml_);
+  sampleLatency(std::chrono::milliseconds(10), 5);
+  sampleLatency(std::chrono::milliseconds(10), 2);
+  EXPECT_CALL(*sample_timer_, enableTimer(_));
+  sample_timer_->callback_();
+  EXPECT_EQ(4U, controller_->concurrencyLimit());
+
+  // The limit drops to its minimum while the minimum RTT is measured, and is restored after.
+  EXPECT_CALL(*min_rtt_calc_timer_, enableTimer(std::chrono::milliseconds(60000)));
+  min_rtt_calc_timer_->callback_();
+  EXPECT_EQ(2U, controller_->concurrencyLimit());
+  EXPECT_EQ(1U, gauge("min_rtt_calculation_active"));
+
+  sampleLatency(std::chrono::milliseconds(20), 5);
+  EXPECT_EQ(20U, gauge("min_rtt_msecs"));
+  EXPECT_EQ(4U, controller_->concurrencyLimit());
+}
+
+TEST_F(GradientControllerTest, MaxConcurrencyLimit) {
+  initialize(R"EOF(
+min_rtt_request_count: 1
+min_concurrency: 2
+max_concurrency_limit: 3
+)EOF");
+  sampleLatency(std::chrono::milliseconds(10), 1);
+  sampleLatency(std::chrono::milliseconds(1), 2);
+  EXPECT_CALL(*sample_timer_, enableTimer(_));
+  sample_timer_->callback_();
+  EXPECT_EQ(3U, controller_->concurrencyLimit());
+}
+
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
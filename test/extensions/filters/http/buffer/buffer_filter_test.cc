@@ -12,6 +12,7 @@
 #include "test/mocks/buffer/mocks.h"
 #include "test/mocks/http/mocks.h"
 #include "test/test_common/printers.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -152,6 +153,69 @@ TEST_F(BufferFilterTest, VHostConfigOverride) {
   filter_.onDestroy();
 }
 
+// With stream_after_bytes, the request is buffered until that many bytes of the body have been
+// received, and the rest is streamed.
+TEST_F(BufferFilterTest, StreamAfterBytes) {
+  envoy::config::filter::http::buffer::v2::BufferPerRoute route_cfg;
+  auto* buf = route_cfg.mutable_buffer();
+  buf->mutable_max_request_bytes()->set_value(1024);
+  buf->mutable_max_request_time()->set_seconds(1);
+  buf->mutable_stream_after_bytes()->set_value(10);
+  BufferFilterSettings route_settings(route_cfg);
+  routeLocalConfig(&route_settings, nullptr);
+
+  InSequence s;
+  expectTimerCreate();
+
+  Http::TestHeaderMapImpl headers;
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter_.decodeHeaders(headers, false));
+
+  Buffer::OwnedImpl buffered("hello");
+  Buffer::OwnedImpl data1("hello");
+  EXPECT_CALL(callbacks_, decodingBuffer()).WillOnce(Return(nullptr));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, filter_.decodeData(data1, false));
+
+  Buffer::OwnedImpl data2("world");
+  EXPECT_CALL(callbacks_, decodingBuffer()).WillOnce(Return(&buffered));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(data2, false));
+
+  Buffer::OwnedImpl data3("more");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(data3, false));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(data3, true));
+  filter_.onDestroy();
+}
+
+// Requests smaller than stream_after_bytes are buffered completely.
+TEST_F(BufferFilterTest, StreamAfterBytesSmallRequest) {
+  envoy::config::filter::http::buffer::v2::BufferPerRoute route_cfg;
+  auto* buf = route_cfg.mutable_buffer();
+  buf->mutable_max_request_bytes()->set_value(1024);
+  buf->mutable_max_request_time()->set_seconds(1);
+  buf->mutable_stream_after_bytes()->set_value(100);
+  BufferFilterSettings route_settings(route_cfg);
+  routeLocalConfig(&route_settings, nullptr);
+
+  expectTimerCreate();
+
+  Http::TestHeaderMapImpl headers;
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter_.decodeHeaders(headers, false));
+
+  Buffer::OwnedImpl data1("hello");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer, filter_.decodeData(data1, false));
+  Buffer::OwnedImpl data2(" world");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(data2, true));
+}
+
+// stream_after_bytes may not exceed max_request_bytes.
+TEST_F(BufferFilterTest, StreamAfterBytesTooLarge) {
+  envoy::config::filter::http::buffer::v2::Buffer proto_config;
+  proto_config.mutable_max_request_bytes()->set_value(10);
+  proto_config.mutable_max_request_time()->set_seconds(1);
+  proto_config.mutable_stream_after_bytes()->set_value(11);
+  EXPECT_THROW_WITH_MESSAGE(BufferFilterSettings settings(proto_config), EnvoyException,
+                            "buffer filter: stream_after_bytes 11 exceeds max_request_bytes 10");
+}
+
 TEST_F(BufferFilterTest, RouteDisabledConfigOverride) {
   envoy::config::filter::http::buffer::v2::BufferPerRoute vhost_cfg;
   vhost_cfg.set_disabled(true);
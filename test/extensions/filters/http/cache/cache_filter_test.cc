@@ -0,0 +1,376 @@
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "envoy/config/filter/http/cache/v2alpha/cache.pb.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/cache/cache_filter.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+// A filter with its callbacks, standing for a request.
+struct TestStream {
+  TestStream(CacheFilterConfigSharedPtr config) : filter_(config) {
+    filter_.setDecoderFilterCallbacks(decoder_callbacks_);
+    filter_.setEncoderFilterCallbacks(encoder_callbacks_);
+  }
+
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  CacheFilter filter_;
+};
+
+class CacheFilterTest : public testing::Test {
+public:
+  void initialize(const std::string& yaml) {
+    envoy::config::filter::http::cache::v2alpha::Cache proto_config;
+    MessageUtil::loadFromYaml(yaml, proto_config);
+    ON_CALL(time_source_, monotonicTime()).WillByDefault(Invoke([this]() { return now_; }));
+    config_ = std::make_shared<CacheFilterConfig>(proto_config, "test.", stats_store_, tls_,
+                                                  time_source_);
+  }
+
+  Http::TestHeaderMapImpl request(const std::string& path = "/") {
+    return Http::TestHeaderMapImpl{{":method", "GET"},
+                                   {":authority", "host"},
+                                   {":path", path},
+                                   {"x-forwarded-proto", "https"}};
+  }
+
+  // Sends the response of a request that missed the cache.
+  void respond(TestStream& stream, Http::TestHeaderMapImpl&& headers, const std::string& body) {
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              stream.filter_.encodeHeaders(headers, body.empty()));
+    if (!body.empty()) {
+      Buffer::OwnedImpl data(body);
+      EXPECT_EQ(Http::FilterDataStatus::Continue, stream.filter_.encodeData(data, true));
+    }
+  }
+
+  // Fills the cache with a response to GET /.
+  void fill(const std::string& cache_control = "max-age=10") {
+    TestStream stream(config_);
+    Http::TestHeaderMapImpl headers = request();
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, stream.filter_.decodeHeaders(headers, true));
+    respond(stream,
+            {{":status", "200"}, {"cache-control", cache_control}, {"etag", "\"v1\""}}, "body");
+    stream.filter_.onDestroy();
+  }
+
+  // Expects the request to be served the cached response to GET /.
+  void expectHit(Http::TestHeaderMapImpl&& headers, const std::string& age) {
+    TestStream stream(config_);
+    EXPECT_CALL(stream.decoder_callbacks_, encodeHeaders_(_, false))
+        .WillOnce(Invoke([&age](Http::HeaderMap& headers, bool) {
+          EXPECT_STREQ("200", headers.Status()->value().c_str());
+          EXPECT_STREQ("\"v1\"", headers.Etag()->value().c_str());
+          EXPECT_STREQ(age.c_str(), headers.get(Http::LowerCaseString("age"))->value().c_str());
+        }));
+    EXPECT_CALL(stream.decoder_callbacks_, encodeData(_, true))
+        .WillOnce(Invoke([](Buffer::Instance& data, bool) { EXPECT_EQ("body", data.toString()); }));
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              stream.filter_.decodeHeaders(headers, true));
+    stream.filter_.onDestroy();
+  }
+
+  // Expects the request to miss the cache and fill it.
+  void expectMiss(Http::TestHeaderMapImpl&& headers) {
+    TestStream stream(config_);
+    EXPECT_CALL(stream.decoder_callbacks_, encodeHeaders_(_, _)).Times(0);
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, stream.filter_.decodeHeaders(headers, true));
+    stream.filter_.onDestroy();
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("test.cache." + name).value();
+  }
+
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<MockTimeSource> time_source_;
+  Stats::IsolatedStoreImpl stats_store_;
+  MonotonicTime now_;
+  CacheFilterConfigSharedPtr config_;
+};
+
+TEST_F(CacheFilterTest, Defaults) {
+  initialize("{}");
+  EXPECT_EQ(1024 * 1024, config_->maxBodyBytes());
+}
+
+TEST_F(CacheFilterTest, Key) {
+  EXPECT_EQ("https host /a?b", CacheFilter::key(Http::TestHeaderMapImpl{
+                                   {":authority", "host"}, {":path", "/a?b"},
+                                   {"x-forwarded-proto", "https"}}));
+  EXPECT_EQ("  ", CacheFilter::key(Http::TestHeaderMapImpl{}));
+}
+
+TEST_F(CacheFilterTest, Bypass) {
+  initialize("{}");
+  TestStream stream(config_);
+  Http::TestHeaderMapImpl headers{{":method", "POST"}, {":authority", "host"}, {":path", "/"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, stream.filter_.decodeHeaders(headers, false));
+  Buffer::OwnedImpl data("request");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, stream.filter_.decodeData(data, true));
+  respond(stream, {{":status", "200"}, {"cache-control", "max-age=10"}}, "body");
+  stream.filter_.onDestroy();
+
+  EXPECT_EQ(1U, counter("bypass"));
+  EXPECT_EQ(0U, counter("insert"));
+}
+
+TEST_F(CacheFilterTest, MissThenHit) {
+  initialize("{}");
+  fill();
+  EXPECT_EQ(1U, counter("miss"));
+  EXPECT_EQ(1U, counter("insert"));
+
+  expectHit(request(), "0");
+  now_ += std::chrono::seconds(9);
+  expectHit(request(), "9");
+  EXPECT_EQ(2U, counter("hit"));
+
+  // Other paths and schemes have their own responses.
+  expectMiss(request("/other"));
+  Http::TestHeaderMapImpl http = request();
+  http.remove(Http::LowerCaseString("x-forwarded-proto"));
+  expectMiss(std::move(http));
+}
+
+TEST_F(CacheFilterTest, Expiry) {
+  initialize("{}");
+  fill();
+  now_ += std::chrono::seconds(10);
+  expectMiss(request());
+  EXPECT_EQ(2U, counter("miss"));
+}
+
+TEST_F(CacheFilterTest, NotCacheable) {
+  initialize("{}");
+  fill("no-store, max-age=10");
+  EXPECT_EQ(1U, counter("not_cacheable"));
+  expectMiss(request());
+
+  // A request asking to bypass the cache is not served from it.
+  fill();
+  Http::TestHeaderMapImpl no_cache = request();
+  no_cache.addCopy("cache-control", "no-cache");
+  expectMiss(std::move(no_cache));
+  EXPECT_EQ(1U, counter("bypass"));
+}
+
+TEST_F(CacheFilterTest, NotModified) {
+  initialize("{}");
+  fill();
+
+  TestStream stream(config_);
+  EXPECT_CALL(stream.decoder_callbacks_, encodeHeaders_(_, true))
+      .WillOnce(Invoke([](Http::HeaderMap& headers, bool) {
+        EXPECT_STREQ("304", headers.Status()->value().c_str());
+      }));
+  EXPECT_CALL(stream.decoder_callbacks_, encodeData(_, _)).Times(0);
+  Http::TestHeaderMapImpl headers = request();
+  headers.addCopy("if-none-match", "W/\"v1\"");
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, stream.filter_.decodeHeaders(headers, true));
+  EXPECT_EQ(1U, counter("validated"));
+
+  // Another entity tag is served the response.
+  Http::TestHeaderMapImpl other = request();
+  other.addCopy("if-none-match", "\"v0\"");
+  expectHit(std::move(other), "0");
+}
+
+TEST_F(CacheFilterTest, Vary) {
+  initialize("{}");
+  TestStream stream(config_);
+  Http::TestHeaderMapImpl headers = request();
+  headers.addCopy("accept-encoding", "gzip");
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, stream.filter_.decodeHeaders(headers, true));
+  respond(stream,
+          {{":status", "200"},
+           {"cache-control", "max-age=10"},
+           {"etag", "\"v1\""},
+           {"vary", "accept-encoding"}},
+          "body");
+
+  Http::TestHeaderMapImpl gzip = request();
+  gzip.addCopy("accept-encoding", "gzip");
+  expectHit(std::move(gzip), "0");
+  expectMiss(request());
+}
+
+TEST_F(CacheFilterTest, TooLarge) {
+  initialize("max_body_bytes: 3");
+  fill();
+  EXPECT_EQ(1U, counter("not_cacheable"));
+  EXPECT_EQ(0U, counter("insert"));
+  expectMiss(request());
+}
+
+TEST_F(CacheFilterTest, Trailers) {
+  initialize("{}");
+  TestStream stream(config_);
+  Http::TestHeaderMapImpl headers = request();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, stream.filter_.decodeHeaders(headers, true));
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"cache-control", "max-age=10"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            stream.filter_.encodeHeaders(response_headers, false));
+  Buffer::OwnedImpl data("body");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, stream.filter_.encodeData(data, false));
+  Http::TestHeaderMapImpl trailers{{"grpc-status", "0"}};
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, stream.filter_.encodeTrailers(trailers));
+  stream.filter_.onDestroy();
+
+  EXPECT_EQ(1U, counter("not_cacheable"));
+  expectMiss(request());
+}
+
+TEST_F(CacheFilterTest, CoalescedMisses) {
+  initialize("{}");
+  TestStream filler(config_);
+  TestStream waiter(config_);
+  Http::TestHeaderMapImpl filler_headers = request();
+  Http::TestHeaderMapImpl waiter_headers = request();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            filler.filter_.decodeHeaders(filler_headers, true));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            waiter.filter_.decodeHeaders(waiter_headers, true));
+  EXPECT_EQ(1U, counter("coalesced"));
+
+  // The waiter is served the response of the filler once it completes.
+  EXPECT_CALL(waiter.decoder_callbacks_, continueDecoding()).Times(0);
+  EXPECT_CALL(waiter.decoder_callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(waiter.decoder_callbacks_, encodeData(_, true))
+      .WillOnce(Invoke([](Buffer::Instance& data, bool) { EXPECT_EQ("body", data.toString()); }));
+  respond(filler, {{":status", "200"}, {"cache-control", "max-age=10"}}, "body");
+  filler.filter_.onDestroy();
+  waiter.filter_.onDestroy();
+  EXPECT_EQ(2U, counter("miss"));
+  EXPECT_EQ(1U, counter("insert"));
+}
+
+TEST_F(CacheFilterTest, CoalescedMissNotCacheable) {
+  initialize("{}");
+  TestStream filler(config_);
+  TestStream waiter(config_);
+  Http::TestHeaderMapImpl filler_headers = request();
+  Http::TestHeaderMapImpl waiter_headers = request();
+  filler.filter_.decodeHeaders(filler_headers, true);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            waiter.filter_.decodeHeaders(waiter_headers, false));
+  Buffer::OwnedImpl data("request");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationAndBuffer,
+            waiter.filter_.decodeData(data, true));
+
+  // The waiter is forwarded upstream by itself, and does not fill the cache.
+  EXPECT_CALL(waiter.decoder_callbacks_, continueDecoding());
+  EXPECT_CALL(waiter.decoder_callbacks_, encodeHeaders_(_, _)).Times(0);
+  respond(filler, {{":status", "503"}}, "");
+  respond(waiter, {{":status", "200"}, {"cache-control", "max-age=10"}}, "body");
+  filler.filter_.onDestroy();
+  waiter.filter_.onDestroy();
+  EXPECT_EQ(0U, counter("insert"));
+}
+
+TEST_F(CacheFilterTest, CancelledFill) {
+  initialize("{}");
+  TestStream filler(config_);
+  TestStream first(config_);
+  TestStream second(config_);
+  Http::TestHeaderMapImpl filler_headers = request();
+  Http::TestHeaderMapImpl first_headers = request();
+  Http::TestHeaderMapImpl second_headers = request();
+  filler.filter_.decodeHeaders(filler_headers, true);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            first.filter_.decodeHeaders(first_headers, true));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            second.filter_.decodeHeaders(second_headers, true));
+
+  // The first waiter takes over the fill, and the second one waits for it.
+  EXPECT_CALL(first.decoder_callbacks_, continueDecoding());
+  EXPECT_CALL(second.decoder_callbacks_, continueDecoding()).Times(0);
+  filler.filter_.onDestroy();
+
+  EXPECT_CALL(second.decoder_callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(second.decoder_callbacks_, encodeData(_, true));
+  respond(first, {{":status", "200"}, {"cache-control", "max-age=10"}}, "body");
+  first.filter_.onDestroy();
+  second.filter_.onDestroy();
+  EXPECT_EQ(1U, counter("insert"));
+}
+
+TEST_F(CacheFilterTest, ResetWaiter) {
+  initialize("{}");
+  TestStream filler(config_);
+  Http::TestHeaderMapImpl filler_headers = request();
+  filler.filter_.decodeHeaders(filler_headers, true);
+  {
+    TestStream waiter(config_);
+    Http::TestHeaderMapImpl waiter_headers = request();
+    waiter.filter_.decodeHeaders(waiter_headers, true);
+    waiter.filter_.onDestroy();
+  }
+
+  respond(filler, {{":status", "200"}, {"cache-control", "max-age=10"}}, "body");
+  filler.filter_.onDestroy();
+  EXPECT_EQ(1U, counter("insert"));
+}
+
+TEST_F(CacheFilterTest, HitWithRequestBody) {
+  initialize("{}");
+  fill();
+
+  TestStream stream(config_);
+  EXPECT_CALL(stream.decoder_callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(stream.decoder_callbacks_, encodeData(_, true));
+  Http::TestHeaderMapImpl headers = request();
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, stream.filter_.decodeHeaders(headers, false));
+  Buffer::OwnedImpl data("request");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, stream.filter_.decodeData(data, false));
+  Http::TestHeaderMapImpl trailers{{"x-trailer", "a"}};
+  EXPECT_EQ(Http::FilterTrailersStatus::StopIteration, stream.filter_.decodeTrailers(trailers));
+}
+
+TEST_F(CacheFilterTest, SharedLru) {
+  initialize(R"EOF(
+  shared_lru:
+    max_entries: 1
+    shards: 1
+  )EOF");
+  fill();
+  expectHit(request(), "0");
+
+  expectMiss(request("/other"));
+  TestStream stream(config_);
+  Http::TestHeaderMapImpl headers = request("/other");
+  stream.filter_.decodeHeaders(headers, true);
+  respond(stream, {{":status", "200"}, {"cache-control", "max-age=10"}}, "other");
+  stream.filter_.onDestroy();
+  EXPECT_EQ(1U, counter("eviction"));
+  expectMiss(request());
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,117 @@
+#include <chrono>
+
+#include "extensions/filters/http/cache/cache_policy.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+TEST(CachePolicyTest, RequestCacheable) {
+  EXPECT_TRUE(CachePolicy::requestCacheable(Http::TestHeaderMapImpl{{":method", "GET"}}));
+  EXPECT_TRUE(CachePolicy::requestCacheable(
+      Http::TestHeaderMapImpl{{":method", "GET"}, {"cache-control", "max-age=10"}}));
+
+  EXPECT_FALSE(CachePolicy::requestCacheable(Http::TestHeaderMapImpl{}));
+  EXPECT_FALSE(CachePolicy::requestCacheable(Http::TestHeaderMapImpl{{":method", "POST"}}));
+  EXPECT_FALSE(CachePolicy::requestCacheable(Http::TestHeaderMapImpl{{":method", "HEAD"}}));
+  EXPECT_FALSE(CachePolicy::requestCacheable(
+      Http::TestHeaderMapImpl{{":method", "GET"}, {"authorization", "secret"}}));
+  EXPECT_FALSE(CachePolicy::requestCacheable(
+      Http::TestHeaderMapImpl{{":method", "GET"}, {"cache-control", "No-Cache"}}));
+  EXPECT_FALSE(CachePolicy::requestCacheable(
+      Http::TestHeaderMapImpl{{":method", "GET"}, {"cache-control", "max-age=0, no-store"}}));
+}
+
+TEST(CachePolicyTest, FreshnessLifetime) {
+  EXPECT_EQ(std::chrono::seconds(10),
+            CachePolicy::freshnessLifetime(
+                Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=10"}}));
+  EXPECT_EQ(std::chrono::seconds(20),
+            CachePolicy::freshnessLifetime(Http::TestHeaderMapImpl{
+                {":status", "200"}, {"cache-control", "public, max-age=10, s-maxage=20"}}));
+  EXPECT_EQ(std::chrono::seconds(20),
+            CachePolicy::freshnessLifetime(Http::TestHeaderMapImpl{
+                {":status", "200"}, {"cache-control", "s-maxage=20, max-age=10"}}));
+
+  // Responses without an explicit lifetime, or one of zero, are not cached.
+  EXPECT_FALSE(CachePolicy::freshnessLifetime(Http::TestHeaderMapImpl{{":status", "200"}}));
+  EXPECT_FALSE(CachePolicy::freshnessLifetime(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "public"}}));
+  EXPECT_FALSE(CachePolicy::freshnessLifetime(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=0"}}));
+  EXPECT_FALSE(CachePolicy::freshnessLifetime(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=invalid"}}));
+
+  // Neither are the responses which forbid it, nor those which are not final and complete.
+  EXPECT_FALSE(CachePolicy::freshnessLifetime(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=10, no-store"}}));
+  EXPECT_FALSE(CachePolicy::freshnessLifetime(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "no-cache, max-age=10"}}));
+  EXPECT_FALSE(CachePolicy::freshnessLifetime(Http::TestHeaderMapImpl{
+      {":status", "200"}, {"cache-control", "private=\"x-user\", max-age=10"}}));
+  EXPECT_FALSE(CachePolicy::freshnessLifetime(Http::TestHeaderMapImpl{
+      {":status", "200"}, {"cache-control", "max-age=10"}, {"set-cookie", "a=b"}}));
+  EXPECT_FALSE(CachePolicy::freshnessLifetime(
+      Http::TestHeaderMapImpl{{":status", "206"}, {"cache-control", "max-age=10"}}));
+  EXPECT_FALSE(CachePolicy::freshnessLifetime(
+      Http::TestHeaderMapImpl{{":status", "304"}, {"cache-control", "max-age=10"}}));
+}
+
+TEST(CachePolicyTest, Vary) {
+  Http::TestHeaderMapImpl request{{"accept-encoding", "gzip"}, {"accept-language", "en"}};
+  CachedResponse response;
+  EXPECT_TRUE(CachePolicy::varyHeaders(
+      Http::TestHeaderMapImpl{{"vary", "Accept-Encoding, x-missing"}}, request, response));
+  ASSERT_EQ(2U, response.vary_.size());
+  EXPECT_EQ("accept-encoding", response.vary_[0].first.get());
+  EXPECT_EQ("gzip", response.vary_[0].second.value());
+  EXPECT_EQ("x-missing", response.vary_[1].first.get());
+  EXPECT_FALSE(response.vary_[1].second.has_value());
+
+  EXPECT_TRUE(CachePolicy::varyMatches(response, request));
+  EXPECT_TRUE(CachePolicy::varyMatches(
+      response, Http::TestHeaderMapImpl{{"accept-encoding", "gzip"}, {"accept-language", "fr"}}));
+  EXPECT_FALSE(CachePolicy::varyMatches(response, Http::TestHeaderMapImpl{}));
+  EXPECT_FALSE(CachePolicy::varyMatches(response,
+                                        Http::TestHeaderMapImpl{{"accept-encoding", "br"}}));
+  EXPECT_FALSE(CachePolicy::varyMatches(
+      response, Http::TestHeaderMapImpl{{"accept-encoding", "gzip"}, {"x-missing", ""}}));
+
+  CachedResponse wildcard;
+  EXPECT_FALSE(CachePolicy::varyHeaders(Http::TestHeaderMapImpl{{"vary", "accept, *"}}, request,
+                                        wildcard));
+
+  CachedResponse none;
+  EXPECT_TRUE(CachePolicy::varyHeaders(Http::TestHeaderMapImpl{}, request, none));
+  EXPECT_TRUE(none.vary_.empty());
+  EXPECT_TRUE(CachePolicy::varyMatches(none, Http::TestHeaderMapImpl{}));
+}
+
+TEST(CachePolicyTest, EtagMatches) {
+  Http::TestHeaderMapImpl response{{"etag", "\"abc\""}};
+  EXPECT_TRUE(
+      CachePolicy::etagMatches(Http::TestHeaderMapImpl{{"if-none-match", "\"abc\""}}, response));
+  EXPECT_TRUE(CachePolicy::etagMatches(
+      Http::TestHeaderMapImpl{{"if-none-match", "\"x\", W/\"abc\""}}, response));
+  EXPECT_TRUE(CachePolicy::etagMatches(Http::TestHeaderMapImpl{{"if-none-match", "*"}}, response));
+  EXPECT_TRUE(CachePolicy::etagMatches(Http::TestHeaderMapImpl{{"if-none-match", "\"abc\""}},
+                                       Http::TestHeaderMapImpl{{"etag", "W/\"abc\""}}));
+
+  EXPECT_FALSE(
+      CachePolicy::etagMatches(Http::TestHeaderMapImpl{{"if-none-match", "\"x\""}}, response));
+  EXPECT_FALSE(CachePolicy::etagMatches(Http::TestHeaderMapImpl{}, response));
+  EXPECT_FALSE(CachePolicy::etagMatches(Http::TestHeaderMapImpl{{"if-none-match", "*"}},
+                                        Http::TestHeaderMapImpl{}));
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
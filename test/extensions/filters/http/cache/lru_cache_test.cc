@@ -0,0 +1,104 @@
+#include <memory>
+#include <string>
+
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/cache/lru_cache.h"
+
+#include "test/mocks/thread_local/mocks.h"
+
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+CachedResponseSharedPtr response(const std::string& body) {
+  auto response = std::make_shared<CachedResponse>();
+  response->body_ = body;
+  return response;
+}
+
+class LruCacheTest : public testing::Test {
+public:
+  Stats::IsolatedStoreImpl stats_;
+  Stats::Counter& evictions_{stats_.counter("eviction")};
+};
+
+TEST_F(LruCacheTest, LookupAndInsert) {
+  LruCache cache(2, evictions_);
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  cache.insert("a", response("body a"));
+  EXPECT_EQ("body a", cache.lookup("a")->body_);
+
+  // A newer response replaces the stored one.
+  cache.insert("a", response("other"));
+  EXPECT_EQ("other", cache.lookup("a")->body_);
+  EXPECT_EQ(1U, cache.size());
+}
+
+TEST_F(LruCacheTest, EvictsLeastRecentlyUsed) {
+  LruCache cache(2, evictions_);
+  cache.insert("a", response("body a"));
+  cache.insert("b", response("body b"));
+  CachedResponseSharedPtr a = cache.lookup("a");
+  cache.insert("c", response("body c"));
+  EXPECT_EQ(1U, evictions_.value());
+
+  EXPECT_EQ(nullptr, cache.lookup("b"));
+  EXPECT_NE(nullptr, cache.lookup("c"));
+  cache.insert("d", response("body d"));
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  EXPECT_EQ(2U, cache.size());
+
+  // A response handed out outlives its entry.
+  EXPECT_EQ("body a", a->body_);
+}
+
+TEST_F(LruCacheTest, WorkerLruCache) {
+  NiceMock<ThreadLocal::MockInstance> tls;
+  WorkerLruCache cache(1, tls, evictions_);
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  cache.insert("a", response("body a"));
+  EXPECT_EQ("body a", cache.lookup("a")->body_);
+  cache.insert("b", response("body b"));
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  EXPECT_EQ(1U, evictions_.value());
+}
+
+TEST_F(LruCacheTest, SharedLruCache) {
+  // A single shard behaves as a single LRU.
+  SharedLruCache single(2, 1, evictions_);
+  single.insert("a", response("body a"));
+  single.insert("b", response("body b"));
+  single.insert("c", response("body c"));
+  EXPECT_EQ(nullptr, single.lookup("a"));
+  EXPECT_EQ("body b", single.lookup("b")->body_);
+  EXPECT_EQ(1U, evictions_.value());
+
+  // Each of the shards holds its share of the responses, rounded up.
+  SharedLruCache sharded(10, 4, evictions_);
+  for (int i = 0; i < 100; i++) {
+    sharded.insert(std::to_string(i), response(std::to_string(i)));
+  }
+  uint32_t held = 0;
+  for (int i = 0; i < 100; i++) {
+    CachedResponseSharedPtr cached = sharded.lookup(std::to_string(i));
+    if (cached != nullptr) {
+      EXPECT_EQ(std::to_string(i), cached->body_);
+      held++;
+    }
+  }
+  EXPECT_LE(held, 12U);
+  EXPECT_GT(held, 0U);
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
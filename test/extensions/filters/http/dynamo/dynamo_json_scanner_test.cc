@@ -0,0 +1,189 @@
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+
+#include "extensions/filters/http/dynamo/dynamo_json_scanner.h"
+
+#include "absl/strings/str_join.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Dynamo {
+namespace {
+
+// Records the names of the members and the reported values as "path=value". The members whose
+// names start with "nested" or "value" are reported.
+class RecordingCallbacks : public JsonScannerCallbacks {
+public:
+  bool onMember(const std::vector<std::string>& path) override {
+    members_.push_back(absl::StrJoin(path, "."));
+    return path.back().find("nested") == 0 || path.back().find("value") == 0;
+  }
+  void onString(const std::vector<std::string>& path, const std::string& value) override {
+    values_.push_back(absl::StrJoin(path, ".") + "=" + value);
+  }
+  void onNumber(const std::vector<std::string>& path, double value) override {
+    values_.push_back(absl::StrJoin(path, ".") + "=" + std::to_string(value));
+  }
+
+  std::vector<std::string> members_;
+  std::vector<std::string> values_;
+};
+
+class DynamoJsonScannerTest : public testing::Test {
+public:
+  DynamoJsonScannerTest() : scanner_(callbacks_) {}
+
+  // Scans the document in one piece, then again a byte at a time, and checks both agree.
+  bool scan(const std::string& json) {
+    scanner_.reset();
+    callbacks_.values_.clear();
+    Buffer::OwnedImpl data(json);
+    scanner_.scan(data);
+    const bool valid = scanner_.finish();
+    const std::vector<std::string> values = callbacks_.values_;
+
+    scanner_.reset();
+    callbacks_.values_.clear();
+    for (char c : json) {
+      Buffer::OwnedImpl piece(std::string(1, c));
+      scanner_.scan(piece);
+    }
+    EXPECT_EQ(valid, scanner_.finish()) << json;
+    EXPECT_EQ(values, callbacks_.values_) << json;
+    return valid;
+  }
+
+  RecordingCallbacks callbacks_;
+  JsonScanner scanner_;
+};
+
+TEST_F(DynamoJsonScannerTest, ValidDocuments) {
+  EXPECT_TRUE(scan("{}"));
+  EXPECT_TRUE(scan(" { } "));
+  EXPECT_TRUE(scan("[]"));
+  EXPECT_TRUE(scan("[1, -2.5e+3, true, false, null, \"a\", {}, [[]]]"));
+  EXPECT_TRUE(scan("\"string\""));
+  EXPECT_TRUE(scan("0"));
+  EXPECT_TRUE(scan("-0.5E-10"));
+  EXPECT_TRUE(scan("null"));
+  EXPECT_TRUE(scan("{\"a\": {\"b\": [1, {\"c\": \"\\\"\\\\\\/\\b\\f\\n\\r\\t\"}]}, \"d\": 2}"));
+}
+
+TEST_F(DynamoJsonScannerTest, InvalidDocuments) {
+  EXPECT_FALSE(scan(""));
+  EXPECT_FALSE(scan("   "));
+  EXPECT_FALSE(scan("{"));
+  EXPECT_FALSE(scan("{\"a\"}"));
+  EXPECT_FALSE(scan("{\"a\": 1,}"));
+  EXPECT_FALSE(scan("[1,]"));
+  EXPECT_FALSE(scan("[1 2]"));
+  EXPECT_FALSE(scan("{a: 1}"));
+  EXPECT_FALSE(scan("{\"a\": 1]"));
+  EXPECT_FALSE(scan("[1}"));
+  EXPECT_FALSE(scan("01"));
+  EXPECT_FALSE(scan("1."));
+  EXPECT_FALSE(scan("-"));
+  EXPECT_FALSE(scan("1e"));
+  EXPECT_FALSE(scan("+1"));
+  EXPECT_FALSE(scan("[1-2]"));
+  EXPECT_FALSE(scan("tru"));
+  EXPECT_FALSE(scan("nul1"));
+  EXPECT_FALSE(scan("\"\\x\""));
+  EXPECT_FALSE(scan("\"\\u12G4\""));
+  EXPECT_FALSE(scan("\"\\ud800\""));
+  EXPECT_FALSE(scan("\"\\ud800\\u0041\""));
+  EXPECT_FALSE(scan("\"\\udc00\""));
+  EXPECT_FALSE(scan("\"a\nb\""));
+  EXPECT_FALSE(scan("{} {}"));
+  EXPECT_FALSE(scan("{}x"));
+}
+
+TEST_F(DynamoJsonScannerTest, ReportedMembers) {
+  EXPECT_TRUE(scan(R"EOF(
+  {
+    "string": "a",
+    "number": 1.5,
+    "object": {"hidden": "b"},
+    "array": [{"hidden": "c"}],
+    "nested": {
+      "value": "d",
+      "other": "e",
+      "nested_array": [{"hidden": "f"}, "g"],
+      "nested_object": {"value_number": 2, "value_literal": true}
+    },
+    "last": "h"
+  }
+  )EOF"));
+
+  EXPECT_EQ((std::vector<std::string>{"nested.value=d",
+                                      "nested.nested_object.value_number=2.000000"}),
+            callbacks_.values_);
+
+  // Members are named whether or not their values are reported, but never inside arrays or the
+  // objects whose member was not reported.
+  callbacks_.members_.clear();
+  EXPECT_TRUE(scan("{\"object\": {\"hidden\": 1}, \"array\": [{\"hidden\": 2}], \"nested\": {}}"));
+  EXPECT_EQ((std::vector<std::string>{"object", "array", "nested", "object", "array", "nested"}),
+            callbacks_.members_);
+}
+
+TEST_F(DynamoJsonScannerTest, UnicodeEscapes) {
+  EXPECT_TRUE(scan(R"EOF({"value": "\u0041\u00e9\u20AC\ud83d\ude00"})EOF"));
+  EXPECT_EQ((std::vector<std::string>{"value=A\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80"}),
+            callbacks_.values_);
+}
+
+TEST_F(DynamoJsonScannerTest, EscapedMemberNames) {
+  EXPECT_TRUE(scan(R"EOF({"v\u0061lue": "\"quoted\"", "\u0076alue2": 3})EOF"));
+  EXPECT_EQ((std::vector<std::string>{"value=\"quoted\"", "value2=3.000000"}), callbacks_.values_);
+}
+
+TEST_F(DynamoJsonScannerTest, Empty) {
+  EXPECT_TRUE(scanner_.empty());
+
+  Buffer::OwnedImpl empty;
+  scanner_.scan(empty);
+  EXPECT_TRUE(scanner_.empty());
+  EXPECT_FALSE(scanner_.finish());
+
+  Buffer::OwnedImpl data("{}");
+  scanner_.scan(data);
+  EXPECT_FALSE(scanner_.empty());
+  EXPECT_EQ(2U, data.length());
+
+  scanner_.reset();
+  EXPECT_TRUE(scanner_.empty());
+}
+
+TEST_F(DynamoJsonScannerTest, ResetDiscardsErrors) {
+  Buffer::OwnedImpl invalid("{]");
+  scanner_.scan(invalid);
+  EXPECT_FALSE(scanner_.finish());
+
+  scanner_.reset();
+  Buffer::OwnedImpl valid("{\"value\": \"a\"}");
+  scanner_.scan(valid);
+  EXPECT_TRUE(scanner_.finish());
+  EXPECT_EQ((std::vector<std::string>{"value=a"}), callbacks_.values_);
+}
+
+TEST_F(DynamoJsonScannerTest, MultipleSlices) {
+  Buffer::OwnedImpl data;
+  data.add("{\"val");
+  Buffer::OwnedImpl more("ue\": \"a");
+  data.move(more);
+  data.add("b\"}");
+  scanner_.scan(data);
+  EXPECT_TRUE(scanner_.finish());
+  EXPECT_EQ((std::vector<std::string>{"value=ab"}), callbacks_.values_);
+}
+
+} // namespace
+} // namespace Dynamo
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,6 +1,7 @@
 #include <string>
 #include <vector>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/http/header_map_impl.h"
 #include "common/json/json_loader.h"
 
@@ -264,6 +265,99 @@ TEST(DynamoRequestParser, parsePartitionIds) {
   }
 }
 
+TEST(DynamoRequestBodyParser, SingleTableOperation) {
+  RequestBodyParser parser("GetItem");
+  EXPECT_TRUE(parser.empty());
+
+  Buffer::OwnedImpl data(R"EOF({"Key": {"TableName": {"S": "key"}}, "TableName": "Pets"})EOF");
+  parser.parse(data);
+  EXPECT_FALSE(parser.empty());
+  EXPECT_TRUE(parser.finish());
+  EXPECT_EQ("Pets", parser.table().table_name);
+  EXPECT_TRUE(parser.table().is_single_table);
+}
+
+TEST(DynamoRequestBodyParser, BatchOperation) {
+  {
+    RequestBodyParser parser("BatchGetItem");
+    Buffer::OwnedImpl data(R"EOF(
+    {
+      "RequestItems": {
+        "table_1": {"Keys": [{"RequestItems": {"S": "a"}}]},
+        "table_1": {"Keys": []}
+      }
+    }
+    )EOF");
+    parser.parse(data);
+    EXPECT_TRUE(parser.finish());
+    EXPECT_EQ("table_1", parser.table().table_name);
+    EXPECT_TRUE(parser.table().is_single_table);
+  }
+  {
+    RequestBodyParser parser("BatchWriteItem");
+    Buffer::OwnedImpl data(R"EOF({"RequestItems": {"table_1": {}, "table_2": {}}})EOF");
+    parser.parse(data);
+    EXPECT_TRUE(parser.finish());
+    EXPECT_EQ("", parser.table().table_name);
+    EXPECT_FALSE(parser.table().is_single_table);
+  }
+  {
+    // The table name of a batch operation only comes from the request items.
+    RequestBodyParser parser("BatchGetItem");
+    Buffer::OwnedImpl data(R"EOF({"TableName": "Pets"})EOF");
+    parser.parse(data);
+    EXPECT_TRUE(parser.finish());
+    EXPECT_EQ("", parser.table().table_name);
+    EXPECT_TRUE(parser.table().is_single_table);
+  }
+}
+
+TEST(DynamoRequestBodyParser, InvalidBody) {
+  RequestBodyParser parser("GetItem");
+  Buffer::OwnedImpl data(R"EOF({"TableName": "Pets",})EOF");
+  parser.parse(data);
+  EXPECT_FALSE(parser.finish());
+}
+
+TEST(DynamoResponseBodyParser, ParseResponse) {
+  ResponseBodyParser parser;
+  EXPECT_TRUE(parser.empty());
+
+  Buffer::OwnedImpl data(R"EOF(
+  {
+    "__type": "com.amazonaws.dynamodb.v20120810#ResourceNotFoundException",
+    "UnprocessedKeys": {
+      "table_1": {"Keys": [{"__type": {"S": "a"}}]},
+      "table_2": {}
+    },
+    "ConsumedCapacity": {
+      "Partitions": {
+        "partition_1": 0.5,
+        "partition_2": 3
+      },
+      "CapacityUnits": 4
+    }
+  }
+  )EOF");
+  parser.parse(data);
+  EXPECT_FALSE(parser.empty());
+  EXPECT_TRUE(parser.finish());
+
+  EXPECT_EQ("ResourceNotFoundException", parser.errorType());
+  EXPECT_EQ((std::vector<std::string>{"table_1", "table_2"}), parser.unprocessedTables());
+  ASSERT_EQ(2U, parser.partitions().size());
+  EXPECT_EQ("partition_1", parser.partitions()[0].partition_id_);
+  EXPECT_EQ(1U, parser.partitions()[0].capacity_);
+  EXPECT_EQ("partition_2", parser.partitions()[1].partition_id_);
+  EXPECT_EQ(3U, parser.partitions()[1].capacity_);
+
+  parser.reset();
+  EXPECT_TRUE(parser.empty());
+  EXPECT_EQ("", parser.errorType());
+  EXPECT_TRUE(parser.unprocessedTables().empty());
+  EXPECT_TRUE(parser.partitions().empty());
+}
+
 } // namespace Dynamo
 } // namespace HttpFilters
 } // namespace Extensions
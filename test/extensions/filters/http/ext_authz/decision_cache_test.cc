@@ -0,0 +1,222 @@
+#include <chrono>
+#include <string>
+
+#include "envoy/config/filter/http/ext_authz/v2alpha/ext_authz.pb.h"
+
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/ext_authz/decision_cache.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+namespace {
+
+using Filters::Common::ExtAuthz::CheckStatus;
+using Filters::Common::ExtAuthz::Response;
+
+class MockDecisionCacheWaiter : public DecisionCacheWaiter {
+public:
+  MOCK_METHOD1(onDecision, void(const Response& response));
+  MOCK_METHOD0(onCheckCancelled, void());
+};
+
+class DecisionCacheTest : public testing::Test {
+public:
+  void initialize(const std::string& yaml) {
+    envoy::config::filter::http::ext_authz::v2alpha::DecisionCache config;
+    MessageUtil::loadFromYaml(yaml, config);
+    ON_CALL(time_source_, monotonicTime()).WillByDefault(Invoke([this]() { return now_; }));
+    cache_ = std::make_unique<DecisionCache>(config, tls_, time_source_, stats_store_, "test.");
+  }
+
+  // Checks the key and completes the check with the response.
+  void check(const std::string& key, CheckStatus status) {
+    Response response{};
+    response.status = status;
+    check(key, response);
+  }
+
+  void check(const std::string& key, const Response& response) {
+    MockDecisionCacheWaiter checker;
+    ASSERT_TRUE(cache_->startCheck(key, checker));
+    cache_->completeCheck(key, response);
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("test." + name).value();
+  }
+
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<MockTimeSource> time_source_;
+  Stats::IsolatedStoreImpl stats_store_;
+  MonotonicTime now_;
+  DecisionCachePtr cache_;
+};
+
+TEST_F(DecisionCacheTest, Key) {
+  initialize(R"EOF(
+  key_headers: ["authorization", "x-tenant"]
+  path_segments: 2
+  )EOF");
+
+  Http::TestHeaderMapImpl headers{{":method", "GET"},
+                                  {":authority", "host"},
+                                  {":path", "/a/b/c?query"},
+                                  {"authorization", "alice"}};
+  EXPECT_EQ("GET\nhost\n/a/b\n=alice\n", cache_->key(headers));
+
+  headers.addCopy("x-tenant", "");
+  EXPECT_EQ("GET\nhost\n/a/b\n=alice\n=", cache_->key(headers));
+
+  Http::TestHeaderMapImpl short_path{{":method", "GET"}, {":authority", "host"}, {":path", "/a"}};
+  EXPECT_EQ("GET\nhost\n/a\n\n", cache_->key(short_path));
+}
+
+TEST_F(DecisionCacheTest, KeyWholePath) {
+  initialize("{}");
+
+  Http::TestHeaderMapImpl headers{{":method", "POST"}, {":authority", "host"}, {":path", "/a/b?q"}};
+  EXPECT_EQ("POST\nhost\n/a/b", cache_->key(headers));
+}
+
+TEST_F(DecisionCacheTest, Expiry) {
+  initialize("ttl: 2s");
+
+  EXPECT_EQ(nullptr, cache_->lookup("key"));
+  check("key", CheckStatus::OK);
+  ASSERT_NE(nullptr, cache_->lookup("key"));
+  EXPECT_EQ(CheckStatus::OK, cache_->lookup("key")->status);
+
+  now_ += std::chrono::milliseconds(1999);
+  EXPECT_NE(nullptr, cache_->lookup("key"));
+  now_ += std::chrono::milliseconds(1);
+  EXPECT_EQ(nullptr, cache_->lookup("key"));
+
+  EXPECT_EQ(3U, counter("hit"));
+  EXPECT_EQ(2U, counter("miss"));
+}
+
+TEST_F(DecisionCacheTest, DeniedTtl) {
+  initialize("{}");
+  check("denied", CheckStatus::Denied);
+  check("error", CheckStatus::Error);
+  EXPECT_EQ(nullptr, cache_->lookup("denied"));
+  EXPECT_EQ(nullptr, cache_->lookup("error"));
+
+  initialize("denied_ttl: 1s");
+  check("denied", CheckStatus::Denied);
+  check("error", CheckStatus::Error);
+  EXPECT_NE(nullptr, cache_->lookup("denied"));
+  EXPECT_EQ(nullptr, cache_->lookup("error"));
+  now_ += std::chrono::seconds(1);
+  EXPECT_EQ(nullptr, cache_->lookup("denied"));
+}
+
+// The lifetime the authorization service gives a decision overrides the configured ones.
+TEST_F(DecisionCacheTest, MaxAge) {
+  initialize("ttl: 10s");
+
+  Response no_store{};
+  no_store.status = CheckStatus::OK;
+  no_store.max_age = std::chrono::seconds(0);
+  check("no_store", no_store);
+  EXPECT_EQ(nullptr, cache_->lookup("no_store"));
+
+  Response denied{};
+  denied.status = CheckStatus::Denied;
+  denied.max_age = std::chrono::seconds(1);
+  check("denied", denied);
+  EXPECT_NE(nullptr, cache_->lookup("denied"));
+  now_ += std::chrono::seconds(1);
+  EXPECT_EQ(nullptr, cache_->lookup("denied"));
+}
+
+TEST_F(DecisionCacheTest, Eviction) {
+  initialize("max_entries: 2");
+
+  check("a", CheckStatus::OK);
+  check("b", CheckStatus::OK);
+  // Touch a, so that b is the least recently used.
+  EXPECT_NE(nullptr, cache_->lookup("a"));
+  check("c", CheckStatus::OK);
+
+  EXPECT_NE(nullptr, cache_->lookup("a"));
+  EXPECT_EQ(nullptr, cache_->lookup("b"));
+  EXPECT_NE(nullptr, cache_->lookup("c"));
+  EXPECT_EQ(1U, counter("eviction"));
+
+  // Replacing an expired entry does not evict another one.
+  now_ += std::chrono::seconds(10);
+  check("a", CheckStatus::OK);
+  EXPECT_NE(nullptr, cache_->lookup("a"));
+  EXPECT_EQ(1U, counter("eviction"));
+}
+
+TEST_F(DecisionCacheTest, CoalescedChecks) {
+  initialize("{}");
+
+  MockDecisionCacheWaiter checker;
+  MockDecisionCacheWaiter waiter1;
+  MockDecisionCacheWaiter waiter2;
+  EXPECT_TRUE(cache_->startCheck("key", checker));
+  EXPECT_FALSE(cache_->startCheck("key", waiter1));
+  EXPECT_FALSE(cache_->startCheck("key", waiter2));
+  EXPECT_TRUE(cache_->startCheck("other", waiter2));
+  EXPECT_EQ(2U, counter("coalesced"));
+
+  Response response{};
+  response.status = CheckStatus::OK;
+  EXPECT_CALL(waiter1, onDecision(_)).WillOnce(Invoke([this](const Response& decision) {
+    EXPECT_EQ(CheckStatus::OK, decision.status);
+    // The decision is cached before the waiters are called back.
+    EXPECT_NE(nullptr, cache_->lookup("key"));
+  }));
+  EXPECT_CALL(waiter2, onDecision(_));
+  cache_->completeCheck("key", response);
+
+  // The check is no longer pending.
+  EXPECT_TRUE(cache_->startCheck("key", checker));
+}
+
+TEST_F(DecisionCacheTest, CancelledChecks) {
+  initialize("{}");
+
+  MockDecisionCacheWaiter checker;
+  MockDecisionCacheWaiter waiter1;
+  MockDecisionCacheWaiter waiter2;
+  EXPECT_TRUE(cache_->startCheck("key", checker));
+  EXPECT_FALSE(cache_->startCheck("key", waiter1));
+  EXPECT_FALSE(cache_->startCheck("key", waiter2));
+
+  // A waiter which stops waiting is not called back.
+  EXPECT_CALL(waiter1, onCheckCancelled()).Times(0);
+  cache_->cancelCheck("key", waiter1);
+
+  // The remaining waiter takes over the check when the checker is cancelled.
+  EXPECT_CALL(waiter2, onCheckCancelled()).WillOnce(Invoke([this, &waiter2]() {
+    EXPECT_TRUE(cache_->startCheck("key", waiter2));
+  }));
+  cache_->cancelCheck("key", checker);
+
+  EXPECT_FALSE(cache_->startCheck("key", checker));
+}
+
+} // namespace
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -16,10 +16,12 @@
 #include "extensions/filters/http/ext_authz/ext_authz.h"
 
 #include "test/extensions/filters/common/ext_authz/mocks.h"
+#include "test/mocks/common.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/runtime/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/tracing/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
@@ -58,6 +60,8 @@ public:
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Upstream::MockClusterManager> cm_;
   NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<MockTimeSource> time_source_;
   Network::Address::InstanceConstSharedPtr addr_;
   NiceMock<Envoy::Network::MockConnection> connection_;
 };
@@ -69,7 +73,8 @@ public:
   void initialize(const std::string yaml) {
     envoy::config::filter::http::ext_authz::v2alpha::ExtAuthz proto_config{};
     MessageUtil::loadFromYaml(yaml, proto_config);
-    config_.reset(new FilterConfig(proto_config, local_info_, stats_store_, runtime_, cm_));
+    config_.reset(new FilterConfig(proto_config, local_info_, stats_store_, runtime_, cm_, tls_,
+                                   time_source_, "test."));
 
     client_ = new Filters::Common::ExtAuthz::MockClient();
     filter_.reset(new Filter(config_, Filters::Common::ExtAuthz::ClientPtr{client_}));
@@ -92,7 +97,8 @@ class HttpExtAuthzFilterParamTest : public TestWithParam<CreateFilterConfigFunc*
 public:
   virtual void SetUp() override {
     envoy::config::filter::http::ext_authz::v2alpha::ExtAuthz proto_config = (*GetParam())();
-    config_.reset(new FilterConfig(proto_config, local_info_, stats_store_, runtime_, cm_));
+    config_.reset(new FilterConfig(proto_config, local_info_, stats_store_, runtime_, cm_, tls_,
+                                   time_source_, "test."));
 
     client_ = new Filters::Common::ExtAuthz::MockClient();
     filter_.reset(new Filter(config_, Filters::Common::ExtAuthz::ClientPtr{client_}));
@@ -644,6 +650,160 @@ TEST_F(HttpExtAuthzFilterTest, ImmediateErrorOpen) {
                     .value());
 }
 
+class HttpExtAuthzDecisionCacheTest : public HttpExtAuthzFilterTest {
+public:
+  // A request through its own filter, which shares the config and so the decision cache.
+  struct Stream {
+    Filters::Common::ExtAuthz::MockClient* client_{new Filters::Common::ExtAuthz::MockClient()};
+    std::unique_ptr<Filter> filter_;
+    NiceMock<Http::MockStreamDecoderFilterCallbacks> callbacks_;
+    Filters::Common::ExtAuthz::RequestCallbacks* request_callbacks_{};
+  };
+  typedef std::unique_ptr<Stream> StreamPtr;
+
+  void SetUp() override {
+    initialize(R"EOF(
+    grpc_service:
+      envoy_grpc:
+        cluster_name: "ext_authz_server"
+    decision_cache:
+      key_headers: ["authorization"]
+      ttl: 1s
+    )EOF");
+    ON_CALL(time_source_, monotonicTime()).WillByDefault(Invoke([this]() { return now_; }));
+    ON_CALL(connection_, remoteAddress()).WillByDefault(ReturnRef(addr_));
+    ON_CALL(connection_, localAddress()).WillByDefault(ReturnRef(addr_));
+  }
+
+  StreamPtr createStream() {
+    StreamPtr stream = std::make_unique<Stream>();
+    stream->filter_ =
+        std::make_unique<Filter>(config_, Filters::Common::ExtAuthz::ClientPtr{stream->client_});
+    stream->filter_->setDecoderFilterCallbacks(stream->callbacks_);
+    ON_CALL(stream->callbacks_, connection()).WillByDefault(Return(&connection_));
+    return stream;
+  }
+
+  // Expects the stream to call the authorization service, and stops at its headers.
+  void expectCheck(Stream& stream, Http::HeaderMap& headers) {
+    EXPECT_CALL(*stream.client_, check(_, _, _))
+        .WillOnce(
+            WithArgs<0>(Invoke([&](Filters::Common::ExtAuthz::RequestCallbacks& callbacks) -> void {
+              stream.request_callbacks_ = &callbacks;
+            })));
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              stream.filter_->decodeHeaders(headers, false));
+  }
+
+  static Filters::Common::ExtAuthz::ResponsePtr
+  response(Filters::Common::ExtAuthz::CheckStatus status) {
+    auto response = std::make_unique<Filters::Common::ExtAuthz::Response>();
+    response->status = status;
+    return response;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("test.ext_authz.decision_cache." + name).value();
+  }
+
+  MonotonicTime now_;
+  Http::TestHeaderMapImpl alice_headers_{
+      {":method", "GET"}, {":path", "/a"}, {":authority", "host"}, {"authorization", "alice"}};
+  Http::TestHeaderMapImpl bob_headers_{
+      {":method", "GET"}, {":path", "/a"}, {":authority", "host"}, {"authorization", "bob"}};
+};
+
+// Test that an allowed decision is reused for the same key until it expires.
+TEST_F(HttpExtAuthzDecisionCacheTest, CachedDecision) {
+  StreamPtr first = createStream();
+  expectCheck(*first, alice_headers_);
+  EXPECT_CALL(first->callbacks_, continueDecoding());
+  first->request_callbacks_->onComplete(response(Filters::Common::ExtAuthz::CheckStatus::OK));
+
+  StreamPtr second = createStream();
+  EXPECT_CALL(*second->client_, check(_, _, _)).Times(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            second->filter_->decodeHeaders(alice_headers_, false));
+  EXPECT_EQ(1U, counter("hit"));
+
+  StreamPtr other = createStream();
+  expectCheck(*other, bob_headers_);
+  other->filter_->onDestroy();
+
+  now_ += std::chrono::seconds(1);
+  StreamPtr expired = createStream();
+  expectCheck(*expired, alice_headers_);
+  expired->filter_->onDestroy();
+  EXPECT_EQ(1U, counter("hit"));
+  EXPECT_EQ(3U, counter("miss"));
+}
+
+// Test that denied and failed checks are not cached by default.
+TEST_F(HttpExtAuthzDecisionCacheTest, DeniedNotCached) {
+  StreamPtr denied = createStream();
+  expectCheck(*denied, alice_headers_);
+  EXPECT_CALL(denied->callbacks_, encodeHeaders_(_, true));
+  denied->request_callbacks_->onComplete(
+      response(Filters::Common::ExtAuthz::CheckStatus::Denied));
+
+  StreamPtr failed = createStream();
+  expectCheck(*failed, alice_headers_);
+  EXPECT_CALL(failed->callbacks_, encodeHeaders_(_, true));
+  failed->request_callbacks_->onComplete(response(Filters::Common::ExtAuthz::CheckStatus::Error));
+
+  StreamPtr retry = createStream();
+  expectCheck(*retry, alice_headers_);
+  retry->filter_->onDestroy();
+  EXPECT_EQ(0U, counter("hit"));
+}
+
+// Test that concurrent requests with the same key wait for the check of the first one.
+TEST_F(HttpExtAuthzDecisionCacheTest, CoalescedChecks) {
+  StreamPtr first = createStream();
+  expectCheck(*first, alice_headers_);
+
+  StreamPtr second = createStream();
+  EXPECT_CALL(*second->client_, check(_, _, _)).Times(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            second->filter_->decodeHeaders(alice_headers_, false));
+  EXPECT_EQ(1U, counter("coalesced"));
+
+  EXPECT_CALL(first->callbacks_, continueDecoding());
+  EXPECT_CALL(second->callbacks_, continueDecoding());
+  first->request_callbacks_->onComplete(response(Filters::Common::ExtAuthz::CheckStatus::OK));
+  EXPECT_EQ(2U, cm_.thread_local_cluster_.cluster_.info_->stats_store_.counter("ext_authz.ok")
+                    .value());
+}
+
+// Test that a waiting request checks by itself when the request it waits for is reset, and that
+// a reset waiting request is not called back.
+TEST_F(HttpExtAuthzDecisionCacheTest, CancelledCheck) {
+  StreamPtr first = createStream();
+  expectCheck(*first, alice_headers_);
+
+  StreamPtr second = createStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            second->filter_->decodeHeaders(alice_headers_, false));
+  StreamPtr third = createStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            third->filter_->decodeHeaders(alice_headers_, false));
+
+  EXPECT_CALL(*third->client_, cancel()).Times(0);
+  third->filter_->onDestroy();
+
+  EXPECT_CALL(*first->client_, cancel());
+  EXPECT_CALL(*second->client_, check(_, _, _))
+      .WillOnce(
+          WithArgs<0>(Invoke([&](Filters::Common::ExtAuthz::RequestCallbacks& callbacks) -> void {
+            second->request_callbacks_ = &callbacks;
+          })));
+  first->filter_->onDestroy();
+
+  EXPECT_CALL(second->callbacks_, continueDecoding());
+  EXPECT_CALL(third->callbacks_, continueDecoding()).Times(0);
+  second->request_callbacks_->onComplete(response(Filters::Common::ExtAuthz::CheckStatus::OK));
+}
+
 } // namespace ExtAuthz
 } // namespace HttpFilters
 } // namespace Extensions
@@ -208,20 +208,26 @@ TEST_F(GrpcJsonTranscoderConfigTest, InvalidVariableBinding) {
 
 class GrpcJsonTranscoderFilterTest : public testing::Test {
 public:
-  GrpcJsonTranscoderFilterTest(const bool match_incoming_request_route = false)
-      : config_(bookstoreProtoConfig(match_incoming_request_route)), filter_(config_) {
+  GrpcJsonTranscoderFilterTest(const bool match_incoming_request_route = false,
+                               const uint32_t max_request_message_bytes = 0)
+      : config_(bookstoreProtoConfig(match_incoming_request_route, max_request_message_bytes)),
+        filter_(config_) {
     filter_.setDecoderFilterCallbacks(decoder_callbacks_);
     filter_.setEncoderFilterCallbacks(encoder_callbacks_);
   }
 
   const envoy::config::filter::http::transcoder::v2::GrpcJsonTranscoder
-  bookstoreProtoConfig(const bool match_incoming_request_route) {
+  bookstoreProtoConfig(const bool match_incoming_request_route,
+                       const uint32_t max_request_message_bytes) {
     std::string json_string = "{\"proto_descriptor\": \"" + bookstoreDescriptorPath() +
                               "\",\"services\": [\"bookstore.Bookstore\"]}";
     auto json_config = Json::Factory::loadFromString(json_string);
     envoy::config::filter::http::transcoder::v2::GrpcJsonTranscoder proto_config{};
     Envoy::Config::FilterJson::translateGrpcJsonTranscoder(*json_config, proto_config);
     proto_config.set_match_incoming_request_route(match_incoming_request_route);
+    if (max_request_message_bytes > 0) {
+      proto_config.mutable_max_request_message_bytes()->set_value(max_request_message_bytes);
+    }
     return proto_config;
   }
 
@@ -490,6 +496,65 @@ TEST_F(GrpcJsonTranscoderFilterSkipRecalculatingTest, TranscodingUnaryPostSkipRe
   EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(request_data, true));
 }
 
+class GrpcJsonTranscoderFilterMaxRequestMessageTest : public GrpcJsonTranscoderFilterTest {
+public:
+  GrpcJsonTranscoderFilterMaxRequestMessageTest() : GrpcJsonTranscoderFilterTest(false, 32) {}
+
+  void expectPayloadTooLarge() {
+    EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, false))
+        .WillOnce(Invoke([](Http::HeaderMap& headers, bool) {
+          EXPECT_STREQ("413", headers.Status()->value().c_str());
+        }));
+    EXPECT_CALL(decoder_callbacks_, encodeData(_, true));
+  }
+};
+
+TEST_F(GrpcJsonTranscoderFilterMaxRequestMessageTest, UnaryMessageTooLarge) {
+  Http::TestHeaderMapImpl request_headers{
+      {"content-type", "application/json"}, {":method", "POST"}, {":path", "/shelf"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+
+  Buffer::OwnedImpl request_data{"{\"theme\": \"Chi"};
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(request_data, false));
+  EXPECT_EQ(0, request_data.length());
+
+  expectPayloadTooLarge();
+  Buffer::OwnedImpl more_request_data{"ldren and young adults"};
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer,
+            filter_.decodeData(more_request_data, false));
+  EXPECT_EQ(0, more_request_data.length());
+}
+
+// Each message of a streaming request is forwarded when it is complete, so only the message being
+// transcoded counts towards the limit.
+TEST_F(GrpcJsonTranscoderFilterMaxRequestMessageTest, StreamingMessages) {
+  Http::TestHeaderMapImpl request_headers{
+      {"content-type", "application/json"}, {":method", "POST"}, {":path", "/bulk/shelves"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
+  EXPECT_EQ("/bookstore.Bookstore/BulkCreateShelf", request_headers.get_(":path"));
+
+  for (const std::string theme : {"Children", "Fiction", "Poetry"}) {
+    Buffer::OwnedImpl request_data{"{\"theme\": \"" + theme + "\"}, "};
+    if (theme == "Children") {
+      request_data.prepend("[");
+    }
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_.decodeData(request_data, false));
+
+    Grpc::Decoder decoder;
+    std::vector<Grpc::Frame> frames;
+    decoder.decode(request_data, frames);
+    ASSERT_EQ(1, frames.size());
+
+    bookstore::CreateShelfRequest request;
+    request.ParseFromString(frames[0].data_->toString());
+    EXPECT_EQ(theme, request.shelf().theme());
+  }
+
+  expectPayloadTooLarge();
+  Buffer::OwnedImpl request_data{"{\"theme\": \"A very long theme of a shelf"};
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_.decodeData(request_data, false));
+}
+
 TEST_F(GrpcJsonTranscoderFilterTest, TranscodingUnaryError) {
   Http::TestHeaderMapImpl request_headers{
       {"content-type", "application/json"}, {":method", "POST"}, {":path", "/shelf"}};
@@ -0,0 +1,85 @@
+#include "extensions/filters/http/gzip/compressed_response_cache.h"
+
+#include "test/mocks/stats/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Gzip {
+namespace {
+
+class CompressedResponseCacheTest : public testing::Test {
+public:
+  void setUp(uint32_t max_entries) {
+    envoy::config::filter::http::gzip::v2::Gzip::CompressedResponseCache config;
+    config.mutable_max_entries()->set_value(max_entries);
+    cache_ = std::make_unique<CompressedResponseCache>(config, tls_, stats_, "cache.");
+  }
+
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Stats::IsolatedStoreImpl stats_;
+  CompressedResponseCachePtr cache_;
+};
+
+TEST_F(CompressedResponseCacheTest, Cacheable) {
+  EXPECT_TRUE(CompressedResponseCache::cacheable("\"abc\""));
+  EXPECT_TRUE(CompressedResponseCache::cacheable("\"\""));
+  EXPECT_FALSE(CompressedResponseCache::cacheable("W/\"abc\""));
+  EXPECT_FALSE(CompressedResponseCache::cacheable("abc"));
+  EXPECT_FALSE(CompressedResponseCache::cacheable("\""));
+  EXPECT_FALSE(CompressedResponseCache::cacheable(""));
+}
+
+TEST_F(CompressedResponseCacheTest, Defaults) {
+  envoy::config::filter::http::gzip::v2::Gzip::CompressedResponseCache config;
+  CompressedResponseCache cache(config, tls_, stats_, "cache.");
+  EXPECT_EQ(1024 * 1024, cache.maxBodyBytes());
+}
+
+TEST_F(CompressedResponseCacheTest, LookupAndInsert) {
+  setUp(2);
+  EXPECT_EQ(nullptr, cache_->lookup("a"));
+  cache_->insert("a", "body a");
+  EXPECT_EQ("body a", *cache_->lookup("a"));
+
+  // The first completed body is kept.
+  cache_->insert("a", "other");
+  EXPECT_EQ("body a", *cache_->lookup("a"));
+
+  EXPECT_EQ(1U, stats_.counter("cache.miss").value());
+  EXPECT_EQ(2U, stats_.counter("cache.hit").value());
+}
+
+TEST_F(CompressedResponseCacheTest, EvictsLeastRecentlyUsed) {
+  setUp(2);
+  cache_->insert("a", "body a");
+  cache_->insert("b", "body b");
+  CompressedBodySharedPtr body = cache_->lookup("a");
+  cache_->insert("c", "body c");
+  EXPECT_EQ(1U, stats_.counter("cache.eviction").value());
+
+  EXPECT_EQ(nullptr, cache_->lookup("b"));
+  EXPECT_NE(nullptr, cache_->lookup("c"));
+  cache_->insert("d", "body d");
+  EXPECT_EQ(nullptr, cache_->lookup("a"));
+
+  // A body handed out outlives its entry.
+  EXPECT_EQ("body a", *body);
+}
+
+TEST_F(CompressedResponseCacheTest, TooLarge) {
+  setUp(1);
+  cache_->onTooLarge();
+  EXPECT_EQ(1U, stats_.counter("cache.too_large").value());
+}
+
+} // namespace
+} // namespace Gzip
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -7,6 +7,7 @@
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
@@ -62,7 +63,7 @@ protected:
     Json::ObjectSharedPtr config = Json::Factory::loadFromString(json);
     envoy::config::filter::http::gzip::v2::Gzip gzip;
     MessageUtil::loadFromJson(json, gzip);
-    config_.reset(new GzipFilterConfig(gzip, "test.", stats_, runtime_));
+    config_.reset(new GzipFilterConfig(gzip, "test.", stats_, runtime_, tls_));
     filter_.reset(new GzipFilter(config_));
   }
 
@@ -125,6 +126,7 @@ protected:
   std::string expected_str_;
   Stats::IsolatedStoreImpl stats_;
   NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
 };
 
 // Test if Runtime Feature is Disabled
@@ -704,6 +706,77 @@ TEST_F(GzipFilterTest, RemoveAcceptEncodingHeader) {
   }
 }
 
+// Verifies that the compressed body of a response with a strong etag is cached and replayed.
+TEST_F(GzipFilterTest, CompressedResponseCache) {
+  setUpFilter(R"EOF({"compressed_response_cache": {"max_entries": 1}})EOF");
+  feedBuffer(256);
+  const std::string body = data_.toString();
+  drainBuffer();
+
+  auto respond = [this, &body](const std::string& path, const std::string& etag) {
+    filter_.reset(new GzipFilter(config_));
+    doRequest({{":method", "get"}, {":authority", "host"}, {":path", path},
+               {"accept-encoding", "gzip"}},
+              true);
+    Http::TestHeaderMapImpl headers{
+        {":status", "200"}, {"content-length", "256"}, {"etag", etag}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+    EXPECT_EQ("gzip", headers.get_("content-encoding"));
+    EXPECT_FALSE(headers.has("etag"));
+    Buffer::OwnedImpl data(body.substr(0, 128));
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, false));
+    Buffer::OwnedImpl compressed;
+    compressed.move(data);
+    data.add(body.substr(128));
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, true));
+    compressed.move(data);
+    return compressed.toString();
+  };
+
+  const std::string compressed = respond("/a", "\"abc\"");
+  EXPECT_EQ(1U, stats_.counter("test.gzip.cache.miss").value());
+  EXPECT_EQ(compressed, respond("/a", "\"abc\""));
+  EXPECT_EQ(1U, stats_.counter("test.gzip.cache.hit").value());
+
+  Buffer::OwnedImpl compressed_data(compressed);
+  decompressor_.decompress(compressed_data, decompressed_data_);
+  EXPECT_EQ(body, decompressed_data_.toString());
+
+  // A new entity tag misses and evicts the only entry.
+  EXPECT_EQ(compressed, respond("/a", "\"abd\""));
+  EXPECT_EQ(2U, stats_.counter("test.gzip.cache.miss").value());
+  EXPECT_EQ(1U, stats_.counter("test.gzip.cache.eviction").value());
+  EXPECT_EQ(compressed, respond("/a", "\"abc\""));
+  EXPECT_EQ(3U, stats_.counter("test.gzip.cache.miss").value());
+}
+
+// Verifies that bodies larger than the limit and weak etags are not cached.
+TEST_F(GzipFilterTest, CompressedResponseCacheNotCached) {
+  setUpFilter(R"EOF({"compressed_response_cache": {"max_body_bytes": 8}})EOF");
+  for (int i = 0; i < 2; i++) {
+    filter_.reset(new GzipFilter(config_));
+    doRequest({{":method", "get"}, {":authority", "host"}, {":path", "/"},
+               {"accept-encoding", "gzip"}},
+              true);
+    Http::TestHeaderMapImpl headers{
+        {":status", "200"}, {"content-length", "256"}, {"etag", "\"abc\""}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+    Buffer::OwnedImpl data(std::string(256, 'a'));
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, true));
+  }
+  EXPECT_EQ(2U, stats_.counter("test.gzip.cache.miss").value());
+  EXPECT_EQ(2U, stats_.counter("test.gzip.cache.too_large").value());
+
+  filter_.reset(new GzipFilter(config_));
+  doRequest(
+      {{":method", "get"}, {":authority", "host"}, {":path", "/"}, {"accept-encoding", "gzip"}},
+      true);
+  Http::TestHeaderMapImpl headers{
+      {":status", "200"}, {"content-length", "256"}, {"etag", "W/\"abc\""}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  EXPECT_EQ(2U, stats_.counter("test.gzip.cache.miss").value());
+}
+
 } // namespace Gzip
 } // namespace HttpFilters
 } // namespace Extensions
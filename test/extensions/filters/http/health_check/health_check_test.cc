@@ -9,6 +9,7 @@
 
 #include "test/mocks/server/mocks.h"
 #include "test/mocks/upstream/cluster_info.h"
+#include "test/mocks/upstream/host.h"
 #include "test/test_common/printers.h"
 #include "test/test_common/utility.h"
 
@@ -50,8 +51,13 @@ public:
     matcher.set_name(":path");
     matcher.set_exact_match("/healthcheck");
     header_data_->emplace_back(matcher);
+    ClusterHealthTrackerConstSharedPtr cluster_health_tracker;
+    if (cluster_min_healthy_percentages != nullptr) {
+      cluster_health_tracker = std::make_shared<ClusterHealthTracker>(
+          context_.cluster_manager_, context_.thread_local_, cluster_min_healthy_percentages);
+    }
     filter_.reset(new HealthCheckFilter(context_, pass_through, cache_manager_, header_data_,
-                                        cluster_min_healthy_percentages));
+                                        cluster_health_tracker));
     filter_->setDecoderFilterCallbacks(callbacks_);
   }
 
@@ -64,12 +70,21 @@ public:
   Http::TestHeaderMapImpl request_headers_;
   Http::TestHeaderMapImpl request_headers_no_hc_;
   HeaderDataVectorSharedPtr header_data_;
+  const std::string cluster_name_www2_{"www2"};
 
   class MockHealthCheckCluster : public NiceMock<Upstream::MockThreadLocalCluster> {
   public:
     MockHealthCheckCluster(uint64_t membership_total, uint64_t membership_healthy) {
-      info()->stats().membership_total_.set(membership_total);
-      info()->stats().membership_healthy_.set(membership_healthy);
+      setHosts(membership_total, membership_healthy);
+    }
+
+    // Updates the hosts of the cluster, which notifies the member update callbacks.
+    void setHosts(uint64_t membership_total, uint64_t membership_healthy) {
+      Upstream::MockHostSet* host_set = cluster_.priority_set_.getMockHostSet(0);
+      Upstream::HostSharedPtr host = std::make_shared<NiceMock<Upstream::MockHost>>();
+      host_set->hosts_ = Upstream::HostVector(membership_total, host);
+      host_set->healthy_hosts_ = Upstream::HostVector(membership_healthy, host);
+      host_set->runCallbacks({}, {});
     }
   };
 };
@@ -130,66 +145,109 @@ TEST_F(HealthCheckFilterNoPassThroughTest, ComputedHealth) {
   }
 
   // Test non-pass-through health checks with upstream cluster minimum health specified.
-  prepareFilter(false, ClusterMinHealthyPercentagesConstSharedPtr(
-                           new ClusterMinHealthyPercentages{{"www1", 50.0}, {"www2", 75.0}}));
+  const auto percentages = std::make_shared<ClusterMinHealthyPercentages>(
+      ClusterMinHealthyPercentages{{"www1", 50.0}, {"www2", 75.0}});
   {
     // This should pass, because each upstream cluster has at least the
     // minimum percentage of healthy servers.
     Http::TestHeaderMapImpl health_check_response{{":status", "200"}};
     MockHealthCheckCluster cluster_www1(100, 50);
     MockHealthCheckCluster cluster_www2(1000, 800);
-    EXPECT_CALL(context_, healthCheckFailed()).WillOnce(Return(false));
-    EXPECT_CALL(context_, clusterManager());
     EXPECT_CALL(context_.cluster_manager_, get("www1")).WillRepeatedly(Return(&cluster_www1));
     EXPECT_CALL(context_.cluster_manager_, get("www2")).WillRepeatedly(Return(&cluster_www2));
+    prepareFilter(false, percentages);
+    EXPECT_CALL(context_, healthCheckFailed()).WillOnce(Return(false));
     EXPECT_CALL(callbacks_, encodeHeaders_(HeaderMapEqualRef(&health_check_response), true));
     EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
               filter_->decodeHeaders(request_headers_, true));
+    filter_.reset();
   }
   {
     // This should fail, because one upstream cluster has too few healthy servers.
     Http::TestHeaderMapImpl health_check_response{{":status", "503"}};
     MockHealthCheckCluster cluster_www1(100, 49);
     MockHealthCheckCluster cluster_www2(1000, 800);
-    EXPECT_CALL(context_, healthCheckFailed()).WillOnce(Return(false));
-    EXPECT_CALL(context_, clusterManager());
     EXPECT_CALL(context_.cluster_manager_, get("www1")).WillRepeatedly(Return(&cluster_www1));
     EXPECT_CALL(context_.cluster_manager_, get("www2")).WillRepeatedly(Return(&cluster_www2));
+    prepareFilter(false, percentages);
+    EXPECT_CALL(context_, healthCheckFailed()).WillOnce(Return(false));
     EXPECT_CALL(callbacks_, encodeHeaders_(HeaderMapEqualRef(&health_check_response), true));
     EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
               filter_->decodeHeaders(request_headers_, true));
+    filter_.reset();
   }
   {
     // This should fail, because one upstream cluster has no servers at all.
     Http::TestHeaderMapImpl health_check_response{{":status", "503"}};
     MockHealthCheckCluster cluster_www1(0, 0);
     MockHealthCheckCluster cluster_www2(1000, 800);
-    EXPECT_CALL(context_, healthCheckFailed()).WillOnce(Return(false));
-    EXPECT_CALL(context_, clusterManager());
     EXPECT_CALL(context_.cluster_manager_, get("www1")).WillRepeatedly(Return(&cluster_www1));
     EXPECT_CALL(context_.cluster_manager_, get("www2")).WillRepeatedly(Return(&cluster_www2));
+    prepareFilter(false, percentages);
+    EXPECT_CALL(context_, healthCheckFailed()).WillOnce(Return(false));
     EXPECT_CALL(callbacks_, encodeHeaders_(HeaderMapEqualRef(&health_check_response), true));
     EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
               filter_->decodeHeaders(request_headers_, true));
+    filter_.reset();
   }
   // Test the cases where an upstream cluster is empty, or has no healthy servers, but
   // the minimum required percent healthy is zero. The health check should return a 200.
-  prepareFilter(false, ClusterMinHealthyPercentagesConstSharedPtr(
-                           new ClusterMinHealthyPercentages{{"www1", 0.0}, {"www2", 0.0}}));
   {
     Http::TestHeaderMapImpl health_check_response{{":status", "200"}};
     MockHealthCheckCluster cluster_www1(0, 0);
     MockHealthCheckCluster cluster_www2(1000, 0);
-    EXPECT_CALL(context_, healthCheckFailed()).WillOnce(Return(false));
-    EXPECT_CALL(context_, clusterManager());
     EXPECT_CALL(context_.cluster_manager_, get("www1")).WillRepeatedly(Return(&cluster_www1));
     EXPECT_CALL(context_.cluster_manager_, get("www2")).WillRepeatedly(Return(&cluster_www2));
+    prepareFilter(false, std::make_shared<ClusterMinHealthyPercentages>(
+                             ClusterMinHealthyPercentages{{"www1", 0.0}, {"www2", 0.0}}));
+    EXPECT_CALL(context_, healthCheckFailed()).WillOnce(Return(false));
     EXPECT_CALL(callbacks_, encodeHeaders_(HeaderMapEqualRef(&health_check_response), true));
     EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
               filter_->decodeHeaders(request_headers_, true));
+    filter_.reset();
   }
 }
 
+TEST_F(HealthCheckFilterNoPassThroughTest, ClusterHealthTracker) {
+  MockHealthCheckCluster cluster_www1(100, 50);
+  Upstream::ClusterUpdateCallbacks* cluster_update_callbacks{};
+  EXPECT_CALL(context_.cluster_manager_, get("www1")).WillOnce(Return(&cluster_www1));
+  EXPECT_CALL(context_.cluster_manager_, get("www2")).WillOnce(Return(nullptr));
+  EXPECT_CALL(context_.cluster_manager_, addThreadLocalClusterUpdateCallbacks(_))
+      .WillOnce(Invoke([&cluster_update_callbacks](Upstream::ClusterUpdateCallbacks& callbacks)
+                           -> Upstream::ClusterUpdateCallbacksHandlePtr {
+        cluster_update_callbacks = &callbacks;
+        return nullptr;
+      }));
+  ClusterHealthTracker tracker(context_.cluster_manager_, context_.thread_local_,
+                               std::make_shared<ClusterMinHealthyPercentages>(
+                                   ClusterMinHealthyPercentages{{"www1", 50.0}, {"www2", 0.0}}));
+
+  // The decision is computed again when the clusters change, and not when it is read.
+  EXPECT_FALSE(tracker.healthy());
+  MockHealthCheckCluster cluster_www2(0, 0);
+  ON_CALL(*cluster_www2.cluster_.info_, name()).WillByDefault(ReturnRef(cluster_name_www2_));
+  cluster_update_callbacks->onClusterAddOrUpdate(cluster_www2);
+  EXPECT_CALL(context_.cluster_manager_, get(_)).Times(0);
+  EXPECT_TRUE(tracker.healthy());
+
+  cluster_www1.setHosts(100, 49);
+  EXPECT_FALSE(tracker.healthy());
+  cluster_www1.setHosts(10, 5);
+  EXPECT_TRUE(tracker.healthy());
+
+  // Other clusters are ignored.
+  NiceMock<Upstream::MockThreadLocalCluster> other;
+  cluster_update_callbacks->onClusterAddOrUpdate(other);
+  cluster_update_callbacks->onClusterRemoval("other");
+  EXPECT_TRUE(tracker.healthy());
+
+  cluster_update_callbacks->onClusterRemoval("www2");
+  EXPECT_FALSE(tracker.healthy());
+  cluster_www2.setHosts(1, 0);
+  EXPECT_FALSE(tracker.healthy());
+}
+
 TEST_F(HealthCheckFilterNoPassThroughTest, HealthCheckFailedCallbackCalled) {
   EXPECT_CALL(context_, healthCheckFailed()).WillOnce(Return(true));
   EXPECT_CALL(callbacks_.request_info_, healthCheck(true));
@@ -297,6 +297,62 @@ TEST_F(AuthenticatorTest, TestNoForwardPayloadHeader) {
   EXPECT_FALSE(headers.has("sec-istio-auth-userinfo"));
 }
 
+// This test verifies that a cached token is accepted without verifying it again, with the same
+// result as for the first request.
+TEST_F(AuthenticatorTest, TestVerifiedTokenCache) {
+  proto_config_.set_verified_token_cache_size(10);
+  CreateAuthenticator();
+  EXPECT_CALL(*fetcher_, fetch(_, _))
+      .WillOnce(Invoke(
+          [this](const ::envoy::api::v2::core::HttpUri&, JwksFetcher::JwksReceiver& receiver) {
+            receiver.onJwksSuccess(std::move(jwks_));
+          }));
+
+  for (int i = 0; i < 10; i++) {
+    auto headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+    MockAuthenticatorCallbacks mock_cb;
+    EXPECT_CALL(mock_cb, onComplete(_)).WillOnce(Invoke([](const Status& status) {
+      ASSERT_EQ(status, Status::Ok);
+    }));
+    auth_->verify(headers, &mock_cb);
+
+    EXPECT_EQ(headers.get_("sec-istio-auth-userinfo"), ExpectedPayloadValue);
+    EXPECT_FALSE(headers.Authorization());
+  }
+  EXPECT_EQ(9U, mock_factory_ctx_.scope_.counter("jwt_authn.verified_token_cache_hit").value());
+
+  // Other tokens are still verified.
+  auto headers =
+      Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(NonExistKidToken)}};
+  MockAuthenticatorCallbacks mock_cb;
+  EXPECT_CALL(mock_cb, onComplete(Status::JwtVerificationFail));
+  auth_->verify(headers, &mock_cb);
+}
+
+// This test verifies that the remote jwks fetched for a filter is used by the other filters.
+TEST_F(AuthenticatorTest, TestSharedRemoteJwks) {
+  EXPECT_CALL(*fetcher_, fetch(_, _))
+      .WillOnce(Invoke(
+          [this](const ::envoy::api::v2::core::HttpUri&, JwksFetcher::JwksReceiver& receiver) {
+            receiver.onJwksSuccess(std::move(jwks_));
+          }));
+  auto headers = Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  EXPECT_CALL(mock_cb_, onComplete(Status::Ok));
+  auth_->verify(headers, &mock_cb_);
+
+  auto other_filter_config = std::make_shared<FilterConfig>(proto_config_, "", mock_factory_ctx_);
+  auto other_auth = Authenticator::create(
+      other_filter_config, [](Upstream::ClusterManager&) -> JwksFetcherPtr {
+        ADD_FAILURE() << "jwks should not be fetched again";
+        return nullptr;
+      });
+  auto other_headers =
+      Http::TestHeaderMapImpl{{"Authorization", "Bearer " + std::string(GoodToken)}};
+  MockAuthenticatorCallbacks other_cb;
+  EXPECT_CALL(other_cb, onComplete(Status::Ok));
+  other_auth->verify(other_headers, &other_cb);
+}
+
 } // namespace JwtAuthn
 } // namespace HttpFilters
 } // namespace Extensions
@@ -97,6 +97,36 @@ TEST_F(JwksCacheTest, TestBadInlineJwks) {
   EXPECT_TRUE(jwks->getJwksObj() == nullptr);
 }
 
+// Test remote jwks shared through a SharedJwksStore
+TEST_F(JwksCacheTest, TestSharedRemoteJwks) {
+  auto store = std::make_shared<SharedJwksStore>();
+  cache_ = JwksCache::create(config_, store);
+  JwksCachePtr other_cache = JwksCache::create(config_, store);
+
+  auto jwks = cache_->findByIssuer("https://example.com");
+  auto other_jwks = other_cache->findByIssuer("https://example.com");
+  EXPECT_FALSE(other_jwks->loadSharedRemoteJwks());
+
+  EXPECT_EQ(jwks->setRemoteJwks(std::move(jwks_))->getStatus(), Status::Ok);
+  EXPECT_TRUE(other_jwks->loadSharedRemoteJwks());
+  EXPECT_EQ(jwks->getJwksObj(), other_jwks->getJwksObj());
+  EXPECT_FALSE(other_jwks->isExpired());
+}
+
+// Test invalid remote jwks are not shared
+TEST_F(JwksCacheTest, TestSharedRemoteJwksInvalid) {
+  auto store = std::make_shared<SharedJwksStore>();
+  cache_ = JwksCache::create(config_, store);
+  JwksCachePtr other_cache = JwksCache::create(config_, store);
+
+  auto jwks = cache_->findByIssuer("https://example.com");
+  EXPECT_NE(jwks->setRemoteJwks(google::jwt_verify::Jwks::createFrom(
+                                    "BAD-JWKS", google::jwt_verify::Jwks::JWKS))
+                ->getStatus(),
+            Status::Ok);
+  EXPECT_FALSE(other_cache->findByIssuer("https://example.com")->loadSharedRemoteJwks());
+}
+
 // Test audiences with different formats
 TEST_F(JwksCacheTest, TestAudiences) {
   auto jwks = cache_->findByIssuer("https://example.com");
@@ -0,0 +1,63 @@
+#include "extensions/filters/http/jwt_authn/token_cache.h"
+
+#include "test/extensions/filters/http/jwt_authn/test_common.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace JwtAuthn {
+namespace {
+
+TokenCache::Entry makeEntry(const std::string& issuer) { return {issuer, 0, "payload", {}}; }
+
+// Test insert, lookup and remove
+TEST(TokenCacheTest, TestInsertLookupRemove) {
+  TokenCache cache(2);
+  EXPECT_EQ(nullptr, cache.lookup("token1"));
+
+  cache.insert("token1", makeEntry("issuer1"));
+  ASSERT_NE(nullptr, cache.lookup("token1"));
+  EXPECT_EQ("issuer1", cache.lookup("token1")->issuer_);
+
+  // Inserting again replaces the entry.
+  cache.insert("token1", makeEntry("issuer2"));
+  EXPECT_EQ("issuer2", cache.lookup("token1")->issuer_);
+
+  cache.remove("token1");
+  EXPECT_EQ(nullptr, cache.lookup("token1"));
+  cache.remove("token1");
+}
+
+// Test the least recently used token is evicted once full
+TEST(TokenCacheTest, TestEviction) {
+  TokenCache cache(2);
+  cache.insert("token1", makeEntry("issuer"));
+  cache.insert("token2", makeEntry("issuer"));
+  // Use token1, so that token2 is the least recently used.
+  EXPECT_NE(nullptr, cache.lookup("token1"));
+
+  cache.insert("token3", makeEntry("issuer"));
+  EXPECT_NE(nullptr, cache.lookup("token1"));
+  EXPECT_EQ(nullptr, cache.lookup("token2"));
+  EXPECT_NE(nullptr, cache.lookup("token3"));
+}
+
+// Test entries keep track of the jwks they were verified with
+TEST(TokenCacheTest, TestJwksReplaced) {
+  TokenCache cache(2);
+  std::shared_ptr<const ::google::jwt_verify::Jwks> jwks =
+      ::google::jwt_verify::Jwks::createFrom(PublicKey, ::google::jwt_verify::Jwks::JWKS);
+  cache.insert("token1", {"issuer", 0, "payload", jwks});
+  EXPECT_EQ(jwks.get(), cache.lookup("token1")->jwks_.lock().get());
+
+  jwks.reset();
+  EXPECT_EQ(nullptr, cache.lookup("token1")->jwks_.lock());
+}
+
+} // namespace
+} // namespace JwtAuthn
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
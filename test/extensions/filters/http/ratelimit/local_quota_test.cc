@@ -0,0 +1,153 @@
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "envoy/config/filter/http/rate_limit/v2/rate_limit.pb.h"
+
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/ratelimit/local_quota.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/thread_local/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RateLimitFilter {
+namespace {
+
+using RateLimit::LimitStatus;
+
+class LocalQuotaTest : public testing::Test {
+public:
+  void initialize(const std::string& yaml) {
+    envoy::config::filter::http::rate_limit::v2::LocalQuota config;
+    MessageUtil::loadFromYaml(yaml, config);
+    now_ += std::chrono::hours(1);
+    ON_CALL(time_source_, monotonicTime()).WillByDefault(Invoke([this]() { return now_; }));
+    quota_ = std::make_unique<LocalQuota>(config, tls_, time_source_, stats_store_, "test.");
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("test." + name).value();
+  }
+
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<MockTimeSource> time_source_;
+  Stats::IsolatedStoreImpl stats_store_;
+  MonotonicTime now_;
+  LocalQuotaPtr quota_;
+};
+
+TEST_F(LocalQuotaTest, Key) {
+  const std::vector<RateLimit::Descriptor> descriptors{{{{"a", "b"}, {"c", "d"}}},
+                                                       {{{"e", "f"}}}};
+  EXPECT_EQ("a\tb\tc\td\t\ne\tf\t\n", LocalQuota::key(descriptors));
+
+  // Moving an entry to another descriptor changes the key.
+  EXPECT_NE(LocalQuota::key({{{{"a", "b"}}}, {{{"c", "d"}}}}),
+            LocalQuota::key({{{{"a", "b"}, {"c", "d"}}}}));
+}
+
+TEST_F(LocalQuotaTest, Lease) {
+  initialize("lease_hits: 3");
+  EXPECT_FALSE(quota_->hasFallback());
+
+  EXPECT_FALSE(quota_->consume("key"));
+  EXPECT_EQ(3U, quota_->leaseHits("key"));
+  quota_->onLimit("key", 3, LimitStatus::OK);
+
+  EXPECT_TRUE(quota_->consume("key"));
+  EXPECT_TRUE(quota_->consume("key"));
+  EXPECT_FALSE(quota_->consume("key"));
+  EXPECT_FALSE(quota_->consume("other"));
+
+  // Concurrent leases add up, and the hits expire together.
+  quota_->onLimit("key", 3, LimitStatus::OK);
+  now_ += std::chrono::milliseconds(500);
+  quota_->onLimit("key", 3, LimitStatus::OK);
+  now_ += std::chrono::milliseconds(999);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(quota_->consume("key"));
+  }
+  EXPECT_FALSE(quota_->consume("key"));
+
+  quota_->onLimit("key", 3, LimitStatus::OK);
+  now_ += std::chrono::seconds(1);
+  EXPECT_FALSE(quota_->consume("key"));
+
+  EXPECT_EQ(6U, counter("lease_hit"));
+  EXPECT_EQ(5U, counter("lease_miss"));
+}
+
+TEST_F(LocalQuotaTest, SingleHitsAreNotLeased) {
+  initialize("lease_hits: 1");
+
+  quota_->onLimit("key", 1, LimitStatus::OK);
+  EXPECT_FALSE(quota_->consume("key"));
+}
+
+TEST_F(LocalQuotaTest, OverLimit) {
+  initialize("{lease_hits: 5, lease_duration: 2s}");
+
+  quota_->onLimit("key", 5, LimitStatus::OverLimit);
+  EXPECT_EQ(1U, quota_->leaseHits("key"));
+  EXPECT_EQ(5U, quota_->leaseHits("other"));
+
+  // Single hits being over limit do not extend the back off.
+  now_ += std::chrono::seconds(1);
+  quota_->onLimit("key", 1, LimitStatus::OverLimit);
+  now_ += std::chrono::seconds(1);
+  EXPECT_EQ(5U, quota_->leaseHits("key"));
+
+  // Errors neither lease nor back off.
+  quota_->onLimit("key", 5, LimitStatus::Error);
+  EXPECT_FALSE(quota_->consume("key"));
+  EXPECT_EQ(5U, quota_->leaseHits("key"));
+}
+
+TEST_F(LocalQuotaTest, FallbackBucket) {
+  initialize("{lease_hits: 5, fallback_bucket: {max_tokens: 2, fill_rate: 1}}");
+  EXPECT_TRUE(quota_->hasFallback());
+
+  EXPECT_TRUE(quota_->consumeFallback("key"));
+  EXPECT_TRUE(quota_->consumeFallback("key"));
+  EXPECT_FALSE(quota_->consumeFallback("key"));
+  EXPECT_TRUE(quota_->consumeFallback("other"));
+
+  now_ += std::chrono::seconds(1);
+  EXPECT_TRUE(quota_->consumeFallback("key"));
+  EXPECT_FALSE(quota_->consumeFallback("key"));
+
+  EXPECT_EQ(4U, counter("fallback_ok"));
+  EXPECT_EQ(2U, counter("fallback_over_limit"));
+}
+
+TEST_F(LocalQuotaTest, Eviction) {
+  initialize("{lease_hits: 2, max_entries: 2}");
+
+  quota_->onLimit("a", 2, LimitStatus::OK);
+  quota_->onLimit("b", 2, LimitStatus::OK);
+  // Touch a, so that b is the least recently used.
+  EXPECT_EQ(2U, quota_->leaseHits("a"));
+  quota_->onLimit("c", 2, LimitStatus::OK);
+  EXPECT_EQ(1U, counter("eviction"));
+
+  EXPECT_TRUE(quota_->consume("a"));
+  EXPECT_FALSE(quota_->consume("b"));
+  EXPECT_TRUE(quota_->consume("c"));
+}
+
+} // namespace
+} // namespace RateLimitFilter
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
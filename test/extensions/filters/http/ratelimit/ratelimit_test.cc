@@ -9,10 +9,12 @@
 
 #include "extensions/filters/http/ratelimit/ratelimit.h"
 
+#include "test/mocks/common.h"
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/ratelimit/mocks.h"
 #include "test/mocks/runtime/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/tracing/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
@@ -50,7 +52,8 @@ public:
     envoy::config::filter::http::rate_limit::v2::RateLimit proto_config{};
     MessageUtil::loadFromYaml(yaml, proto_config);
 
-    config_.reset(new FilterConfig(proto_config, local_info_, stats_store_, runtime_, cm_));
+    config_.reset(new FilterConfig(proto_config, local_info_, stats_store_, runtime_, cm_, tls_,
+                                   time_source_, "test."));
 
     client_ = new RateLimit::MockClient();
     filter_.reset(new Filter(config_, RateLimit::ClientPtr{client_}));
@@ -89,6 +92,8 @@ public:
   NiceMock<Router::MockRateLimitPolicyEntry> vh_rate_limit_;
   std::vector<RateLimit::Descriptor> descriptor_{{{{"descriptor_key", "descriptor_value"}}}};
   NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<MockTimeSource> time_source_;
 };
 
 TEST_F(HttpRateLimitFilterTest, BadConfig) {
@@ -770,6 +775,122 @@ TEST_F(HttpRateLimitFilterTest, DefaultConfigValueTest) {
   EXPECT_EQ(FilterRequestType::Both, config_->requestType());
 }
 
+class HttpRateLimitLocalQuotaTest : public HttpRateLimitFilterTest {
+public:
+  void SetUp() override {
+    SetUpTest(R"EOF(
+    domain: foo
+    local_quota:
+      lease_hits: 3
+      lease_duration: 1s
+      fallback_bucket:
+        max_tokens: 1
+        fill_rate: 1
+    )EOF");
+    now_ += std::chrono::hours(1);
+    ON_CALL(time_source_, monotonicTime()).WillByDefault(Invoke([this]() { return now_; }));
+    ON_CALL(route_rate_limit_, populateDescriptors(_, _, _, _, _))
+        .WillByDefault(SetArgReferee<1>(descriptor_));
+  }
+
+  // Creates the filter of another request, which shares the config.
+  Filter& addFilter(RateLimit::MockClient*& client) {
+    client = new RateLimit::MockClient();
+    filters_.emplace_back(new Filter(config_, RateLimit::ClientPtr{client}));
+    filters_.back()->setDecoderFilterCallbacks(filter_callbacks_);
+    return *filters_.back();
+  }
+
+  void expectLimit(RateLimit::MockClient& client, RateLimit::LimitStatus status) {
+    EXPECT_CALL(client, limit(_, "foo", _, _))
+        .WillOnce(WithArgs<0>(Invoke([status](RateLimit::RequestCallbacks& callbacks) -> void {
+          callbacks.complete(status, nullptr);
+        })));
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("test.ratelimit.local_quota." + name).value();
+  }
+
+  MonotonicTime now_;
+  std::vector<std::unique_ptr<Filter>> filters_;
+};
+
+// Test that a call leases hits which the following requests use without calling.
+TEST_F(HttpRateLimitLocalQuotaTest, LeasedHits) {
+  expectLimit(*client_, RateLimit::LimitStatus::OK);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_EQ(3U, client_->hits_addend_);
+
+  RateLimit::MockClient* client;
+  for (int i = 0; i < 2; i++) {
+    Filter& filter = addFilter(client);
+    EXPECT_CALL(*client, limit(_, _, _, _)).Times(0);
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter.decodeHeaders(request_headers_, false));
+  }
+  EXPECT_EQ(2U, counter("lease_hit"));
+
+  // The lease is used up.
+  Filter& used_up = addFilter(client);
+  expectLimit(*client, RateLimit::LimitStatus::OK);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, used_up.decodeHeaders(request_headers_, false));
+
+  // The unused hits of the new lease expire.
+  now_ += std::chrono::seconds(1);
+  Filter& expired = addFilter(client);
+  expectLimit(*client, RateLimit::LimitStatus::OK);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, expired.decodeHeaders(request_headers_, false));
+
+  EXPECT_EQ(3U, counter("lease_miss"));
+  EXPECT_EQ(3U,
+            cm_.thread_local_cluster_.cluster_.info_->stats_store_.counter("ratelimit.ok").value());
+}
+
+// Test that after a lease is over limit the calls ask for single hits for a while.
+TEST_F(HttpRateLimitLocalQuotaTest, OverLimitLease) {
+  expectLimit(*client_, RateLimit::LimitStatus::OverLimit);
+  EXPECT_CALL(filter_callbacks_, encodeHeaders_(_, true));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            filter_->decodeHeaders(request_headers_, false));
+  EXPECT_EQ(3U, client_->hits_addend_);
+
+  RateLimit::MockClient* client;
+  Filter& single = addFilter(client);
+  expectLimit(*client, RateLimit::LimitStatus::OK);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, single.decodeHeaders(request_headers_, false));
+  EXPECT_EQ(1U, client->hits_addend_);
+
+  now_ += std::chrono::seconds(1);
+  Filter& lease = addFilter(client);
+  expectLimit(*client, RateLimit::LimitStatus::OK);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, lease.decodeHeaders(request_headers_, false));
+  EXPECT_EQ(3U, client->hits_addend_);
+}
+
+// Test that the fallback bucket limits the requests while the service cannot be queried.
+TEST_F(HttpRateLimitLocalQuotaTest, FallbackBucket) {
+  expectLimit(*client_, RateLimit::LimitStatus::Error);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+
+  RateLimit::MockClient* client;
+  Filter& limited = addFilter(client);
+  expectLimit(*client, RateLimit::LimitStatus::Error);
+  EXPECT_CALL(filter_callbacks_, encodeHeaders_(_, true));
+  EXPECT_CALL(filter_callbacks_.request_info_,
+              setResponseFlag(RequestInfo::ResponseFlag::RateLimited));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            limited.decodeHeaders(request_headers_, false));
+
+  EXPECT_EQ(1U, counter("fallback_ok"));
+  EXPECT_EQ(1U, counter("fallback_over_limit"));
+  EXPECT_EQ(
+      2U,
+      cm_.thread_local_cluster_.cluster_.info_->stats_store_.counter("ratelimit.error").value());
+  EXPECT_EQ(0U, cm_.thread_local_cluster_.cluster_.info_->stats_store_
+                    .counter("ratelimit.failure_mode_allowed")
+                    .value());
+}
+
 } // namespace RateLimitFilter
 } // namespace HttpFilters
 } // namespace Extensions
@@ -6,6 +6,7 @@
 
 #include "common/buffer/buffer_impl.h"
 #include "common/event/dispatcher_impl.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/listener_impl.h"
 #include "common/network/raw_buffer_socket.h"
@@ -69,9 +70,16 @@ public:
   bool bindToPort() override { return true; }
   bool handOffRestoredDestinationConnections() const override { return false; }
   uint32_t perConnectionBufferLimitBytes() override { return 0; }
+  uint32_t perConnectionBufferLimitMaxBytes() override { return 0; }
   Stats::Scope& listenerScope() override { return stats_store_; }
   uint64_t listenerTag() const override { return 1; }
   const std::string& name() const override { return name_; }
+  Network::ConnectionBalancer& connectionBalancer() override { return connection_balancer_; }
+  const Network::AcceptLimits& acceptLimits() const override { return accept_limits_; }
+  bool tcpQuickAck() const override { return false; }
+  Network::Address::SocketType socketType() const override {
+    return Network::Address::SocketType::Stream;
+  }
 
   // Network::FilterChainManager
   const Network::FilterChain* findFilterChain(const Network::ConnectionSocket&) const override {
@@ -156,6 +164,8 @@ public:
   Network::MockConnectionCallbacks server_callbacks_;
   std::shared_ptr<Network::MockReadFilter> read_filter_;
   std::string name_;
+  Network::NopConnectionBalancerImpl connection_balancer_;
+  const Network::AcceptLimits accept_limits_{};
   const Network::FilterChainSharedPtr filter_chain_;
 };
 
@@ -891,9 +901,16 @@ public:
   bool bindToPort() override { return true; }
   bool handOffRestoredDestinationConnections() const override { return false; }
   uint32_t perConnectionBufferLimitBytes() override { return 0; }
+  uint32_t perConnectionBufferLimitMaxBytes() override { return 0; }
   Stats::Scope& listenerScope() override { return stats_store_; }
   uint64_t listenerTag() const override { return 1; }
   const std::string& name() const override { return name_; }
+  Network::ConnectionBalancer& connectionBalancer() override { return connection_balancer_; }
+  const Network::AcceptLimits& acceptLimits() const override { return accept_limits_; }
+  bool tcpQuickAck() const override { return false; }
+  Network::Address::SocketType socketType() const override {
+    return Network::Address::SocketType::Stream;
+  }
 
   // Network::FilterChainManager
   const Network::FilterChain* findFilterChain(const Network::ConnectionSocket&) const override {
@@ -956,6 +973,8 @@ public:
   Network::MockConnectionCallbacks server_callbacks_;
   std::shared_ptr<Network::MockReadFilter> read_filter_;
   std::string name_;
+  Network::NopConnectionBalancerImpl connection_balancer_;
+  const Network::AcceptLimits accept_limits_{};
   const Network::FilterChainSharedPtr filter_chain_;
 };
 
@@ -37,12 +37,24 @@ public:
     EXPECT_CALL(cb_, dispatcher()).WillRepeatedly(ReturnRef(dispatcher_));
     EXPECT_CALL(socket_, fd()).WillRepeatedly(Return(42));
 
+    // Nothing is readable yet when the connection is accepted.
+    EXPECT_CALL(os_sys_calls_, recv(42, _, _, MSG_PEEK))
+        .WillOnce(Return(Api::SysCallSizeResult{ssize_t(-1), EAGAIN}));
     EXPECT_CALL(dispatcher_,
                 createFileEvent_(_, _, Event::FileTriggerType::Edge,
                                  Event::FileReadyType::Read | Event::FileReadyType::Closed))
         .WillOnce(
             DoAll(SaveArg<1>(&file_event_callback_), ReturnNew<NiceMock<Event::MockFileEvent>>()));
-    filter_->onAccept(cb_);
+    EXPECT_EQ(Network::FilterStatus::StopIteration, filter_->onAccept(cb_));
+  }
+
+  void initReadable() {
+    filter_ = std::make_unique<Filter>(cfg_);
+    EXPECT_CALL(cb_, socket()).WillRepeatedly(ReturnRef(socket_));
+    EXPECT_CALL(cb_, dispatcher()).WillRepeatedly(ReturnRef(dispatcher_));
+    EXPECT_CALL(socket_, fd()).WillRepeatedly(Return(42));
+    EXPECT_CALL(dispatcher_, createFileEvent_(_, _, _, _)).Times(0);
+    EXPECT_CALL(dispatcher_, createTimer_(_)).Times(0);
   }
 
   NiceMock<Api::MockOsSysCalls> os_sys_calls_;
@@ -90,6 +102,36 @@ TEST_F(TlsInspectorTest, ReadError) {
   EXPECT_EQ(1, cfg_->stats().read_error_.value());
 }
 
+// Test that a ClientHello readable on accept is inspected without waiting for a read event.
+TEST_F(TlsInspectorTest, ClientHelloReadableOnAccept) {
+  initReadable();
+  const std::string servername("example.com");
+  std::vector<uint8_t> client_hello = Tls::Test::generateClientHello(servername, "");
+  EXPECT_CALL(os_sys_calls_, recv(42, _, _, MSG_PEEK))
+      .WillOnce(
+          Invoke([&client_hello](int, void* buffer, size_t length, int) -> Api::SysCallSizeResult {
+            ASSERT(length >= client_hello.size());
+            memcpy(buffer, client_hello.data(), client_hello.size());
+            return Api::SysCallSizeResult{ssize_t(client_hello.size()), 0};
+          }));
+  EXPECT_CALL(socket_, setRequestedServerName(Eq(servername)));
+  EXPECT_CALL(socket_, setDetectedTransportProtocol(absl::string_view("tls")));
+  EXPECT_CALL(cb_, continueFilterChain(_)).Times(0);
+  EXPECT_EQ(Network::FilterStatus::Continue, filter_->onAccept(cb_));
+  EXPECT_EQ(1, cfg_->stats().tls_found_.value());
+  EXPECT_EQ(1, cfg_->stats().sni_found_.value());
+}
+
+// Test that a read error on accept fails the filter chain straight away.
+TEST_F(TlsInspectorTest, ReadErrorOnAccept) {
+  initReadable();
+  EXPECT_CALL(os_sys_calls_, recv(42, _, _, MSG_PEEK))
+      .WillOnce(Return(Api::SysCallSizeResult{ssize_t(-1), ENOTSUP}));
+  EXPECT_CALL(cb_, continueFilterChain(false));
+  EXPECT_EQ(Network::FilterStatus::StopIteration, filter_->onAccept(cb_));
+  EXPECT_EQ(1, cfg_->stats().read_error_.value());
+}
+
 // Test that a ClientHello with an SNI value causes the correct name notification.
 TEST_F(TlsInspectorTest, SniRegistered) {
   init();
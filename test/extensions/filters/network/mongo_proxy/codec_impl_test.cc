@@ -7,11 +7,14 @@
 #include "extensions/filters/network/mongo_proxy/codec_impl.h"
 
 #include "test/test_common/printers.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::_;
 using testing::Eq;
+using testing::Invoke;
 using testing::NiceMock;
 using testing::Pointee;
 
@@ -31,6 +34,7 @@ public:
   void decodeCommandReply(CommandReplyMessagePtr&& message) override {
     decodeCommandReply_(message);
   }
+  void decodeOpMsg(OpMsgMessagePtr&& message) override { decodeOpMsg_(message); }
 
   MOCK_METHOD1(decodeGetMore_, void(GetMoreMessagePtr& message));
   MOCK_METHOD1(decodeInsert_, void(InsertMessagePtr& message));
@@ -39,6 +43,7 @@ public:
   MOCK_METHOD1(decodeReply_, void(ReplyMessagePtr& message));
   MOCK_METHOD1(decodeCommand_, void(CommandMessagePtr& message));
   MOCK_METHOD1(decodeCommandReply_, void(CommandReplyMessagePtr& message));
+  MOCK_METHOD1(decodeOpMsg_, void(OpMsgMessagePtr& message));
 };
 
 class MongoCodecImplTest : public testing::Test {
@@ -165,6 +170,45 @@ TEST_F(MongoCodecImplTest, Reply) {
   decoder_.onData(output_);
 }
 
+TEST_F(MongoCodecImplTest, ReplySkipDocuments) {
+  ReplyMessageImpl reply(2, 2);
+  reply.numberReturned(2);
+  reply.documents().push_back(Bson::DocumentImpl::create()->addString("hello", "world"));
+  reply.documents().push_back(Bson::DocumentImpl::create());
+  EXPECT_EQ(2U, reply.numberOfDocuments());
+  EXPECT_EQ(27U, reply.documentsByteSize());
+  encoder_.encodeReply(reply);
+  encoder_.encodeReply(reply);
+
+  DecoderImpl decoder(callbacks_, true);
+  ReplyMessagePtr decoded;
+  EXPECT_CALL(callbacks_, decodeReply_(_))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](ReplyMessagePtr& message) -> void { decoded.swap(message); }));
+  decoder.onData(output_);
+  EXPECT_EQ(0U, output_.length());
+
+  EXPECT_TRUE(decoded->documents().empty());
+  EXPECT_EQ(2, decoded->numberReturned());
+  EXPECT_EQ(2U, decoded->numberOfDocuments());
+  EXPECT_EQ(27U, decoded->documentsByteSize());
+  EXPECT_NO_THROW(Json::Factory::loadFromString(decoded->toString(true)));
+  EXPECT_NO_THROW(Json::Factory::loadFromString(decoded->toString(false)));
+
+  // The length prefix of a skipped document is still validated.
+  Bson::BufferHelper::writeInt32(output_, 16 + 20 + 5);
+  Bson::BufferHelper::writeInt32(output_, 2);
+  Bson::BufferHelper::writeInt32(output_, 2);
+  Bson::BufferHelper::writeInt32(output_, 1);
+  Bson::BufferHelper::writeInt32(output_, 0);
+  Bson::BufferHelper::writeInt64(output_, 0);
+  Bson::BufferHelper::writeInt32(output_, 0);
+  Bson::BufferHelper::writeInt32(output_, 1);
+  Bson::BufferHelper::writeInt32(output_, 100);
+  output_.add("\0", 1);
+  EXPECT_THROW_WITH_MESSAGE(decoder.onData(output_), EnvoyException, "invalid BSON message length");
+}
+
 TEST_F(MongoCodecImplTest, GetMoreEqual) {
   {
     GetMoreMessageImpl g1(0, 0);
@@ -442,6 +486,165 @@ TEST_F(MongoCodecImplTest, CommandReply) {
   decoder_.onData(output_);
 }
 
+TEST_F(MongoCodecImplTest, OpMsgEqual) {
+  {
+    OpMsgMessageImpl m1(0, 0);
+    OpMsgMessageImpl m2(1, 1);
+    EXPECT_FALSE(m1 == m2);
+  }
+
+  {
+    OpMsgMessageImpl m1(0, 0);
+    m1.body(Bson::DocumentImpl::create()->addString("hello", "world"));
+    OpMsgMessageImpl m2(0, 0);
+    m2.body(Bson::DocumentImpl::create()->addString("world", "hello"));
+    EXPECT_FALSE(m1 == m2);
+  }
+
+  {
+    OpMsgMessageImpl m1(0, 0);
+    m1.documentSequences().push_back({"documents", {}});
+    OpMsgMessageImpl m2(0, 0);
+    m2.documentSequences().push_back({"updates", {}});
+    EXPECT_FALSE(m1 == m2);
+  }
+
+  {
+    OpMsgMessageImpl m1(0, 0);
+    m1.documentSequences().push_back({"documents", {Bson::DocumentImpl::create()}});
+    OpMsgMessageImpl m2(0, 0);
+    m2.documentSequences().push_back(
+        {"documents", {Bson::DocumentImpl::create()->addString("hello", "world")}});
+    EXPECT_FALSE(m1 == m2);
+  }
+}
+
+TEST_F(MongoCodecImplTest, OpMsg) {
+  OpMsgMessageImpl op_msg(16, 0);
+  op_msg.flags(OpMsgMessage::Flags::ExhaustAllowed);
+  op_msg.body(Bson::DocumentImpl::create()->addString("insert", "test")->addString("$db", "db"));
+  op_msg.documentSequences().push_back(
+      {"documents",
+       {Bson::DocumentImpl::create()->addString("hello", "world"), Bson::DocumentImpl::create()}});
+  op_msg.documentSequences().push_back({"\"escaped\"", {}});
+
+  EXPECT_NO_THROW(Json::Factory::loadFromString(op_msg.toString(true)));
+  EXPECT_NO_THROW(Json::Factory::loadFromString(op_msg.toString(false)));
+
+  encoder_.encodeOpMsg(op_msg);
+  EXPECT_CALL(callbacks_, decodeOpMsg_(Pointee(Eq(op_msg))));
+  decoder_.onData(output_);
+  EXPECT_EQ(0U, output_.length());
+
+  // Requests are decoded even when the documents of replies are skipped.
+  encoder_.encodeOpMsg(op_msg);
+  DecoderImpl decoder(callbacks_, true);
+  EXPECT_CALL(callbacks_, decodeOpMsg_(Pointee(Eq(op_msg))));
+  decoder.onData(output_);
+
+  OpMsgMessageImpl invalid(16, 0);
+  EXPECT_THROW(encoder_.encodeOpMsg(invalid), EnvoyException);
+}
+
+TEST_F(MongoCodecImplTest, OpMsgChecksum) {
+  OpMsgMessageImpl op_msg(16, 0);
+  op_msg.flags(OpMsgMessage::Flags::ChecksumPresent);
+  op_msg.body(Bson::DocumentImpl::create()->addString("ping", "1"));
+
+  // The encoder never sets the flag, as it does not compute checksums.
+  encoder_.encodeOpMsg(op_msg);
+  const uint64_t length = output_.length();
+  op_msg.flags(0);
+  EXPECT_CALL(callbacks_, decodeOpMsg_(Pointee(Eq(op_msg))));
+  decoder_.onData(output_);
+
+  // Append a checksum to an encoded message.
+  encoder_.encodeOpMsg(op_msg);
+  Buffer::OwnedImpl data;
+  Bson::BufferHelper::writeInt32(data, length + 4);
+  output_.drain(4);
+  data.move(output_, 12);
+  output_.drain(4);
+  Bson::BufferHelper::writeInt32(data, OpMsgMessage::Flags::ChecksumPresent);
+  data.move(output_);
+  Bson::BufferHelper::writeInt32(data, 0x12345678);
+  op_msg.flags(OpMsgMessage::Flags::ChecksumPresent);
+  EXPECT_CALL(callbacks_, decodeOpMsg_(Pointee(Eq(op_msg))));
+  decoder_.onData(data);
+  EXPECT_EQ(0U, data.length());
+}
+
+TEST_F(MongoCodecImplTest, OpMsgSkipSections) {
+  OpMsgMessageImpl op_msg(16, 26);
+  op_msg.body(Bson::DocumentImpl::create()->addString("hello", "world"));
+  op_msg.documentSequences().push_back({"documents", {Bson::DocumentImpl::create()}});
+  EXPECT_EQ(27U, op_msg.documentsByteSize());
+  encoder_.encodeOpMsg(op_msg);
+
+  DecoderImpl decoder(callbacks_, true);
+  OpMsgMessagePtr decoded;
+  EXPECT_CALL(callbacks_, decodeOpMsg_(_)).WillOnce(Invoke([&](OpMsgMessagePtr& message) -> void {
+    decoded.swap(message);
+  }));
+  decoder.onData(output_);
+  EXPECT_EQ(0U, output_.length());
+
+  EXPECT_EQ(26, decoded->responseTo());
+  EXPECT_EQ(nullptr, decoded->body());
+  EXPECT_TRUE(decoded->documentSequences().empty());
+  EXPECT_EQ(27U, decoded->documentsByteSize());
+  EXPECT_NO_THROW(Json::Factory::loadFromString(decoded->toString(true)));
+}
+
+TEST_F(MongoCodecImplTest, OpMsgInvalid) {
+  auto write_op_msg = [this](int32_t flags, const std::string& sections) -> void {
+    Bson::BufferHelper::writeInt32(output_, 16 + 4 + sections.size());
+    Bson::BufferHelper::writeInt32(output_, 1);
+    Bson::BufferHelper::writeInt32(output_, 0);
+    Bson::BufferHelper::writeInt32(output_, 2013);
+    Bson::BufferHelper::writeInt32(output_, flags);
+    output_.add(sections);
+  };
+  const std::string body("\0\x05\0\0\0\0", 6);
+
+  // No body section.
+  write_op_msg(0, "");
+  EXPECT_THROW_WITH_MESSAGE(decoder_.onData(output_), EnvoyException, "invalid OP_MSG message");
+  output_.drain(output_.length());
+
+  // Two body sections.
+  write_op_msg(0, body + body);
+  EXPECT_THROW_WITH_MESSAGE(decoder_.onData(output_), EnvoyException, "invalid OP_MSG message");
+  output_.drain(output_.length());
+
+  // Unknown section kind.
+  write_op_msg(0, body + "\x02");
+  EXPECT_THROW_WITH_MESSAGE(decoder_.onData(output_), EnvoyException,
+                            "invalid OP_MSG section kind 2");
+  output_.drain(output_.length());
+
+  // A document sequence that overruns the message.
+  write_op_msg(0, body + std::string("\x01\x10\0\0\0a\0", 7));
+  EXPECT_THROW_WITH_MESSAGE(decoder_.onData(output_), EnvoyException,
+                            "invalid OP_MSG document sequence length");
+  output_.drain(output_.length());
+
+  // A checksum flag without a checksum.
+  write_op_msg(OpMsgMessage::Flags::ChecksumPresent, "");
+  EXPECT_THROW_WITH_MESSAGE(decoder_.onData(output_), EnvoyException,
+                            "invalid OP_MSG message length");
+  output_.drain(output_.length());
+
+  // No flags.
+  Bson::BufferHelper::writeInt32(output_, 16 + 2);
+  Bson::BufferHelper::writeInt32(output_, 1);
+  Bson::BufferHelper::writeInt32(output_, 0);
+  Bson::BufferHelper::writeInt32(output_, 2013);
+  output_.add("\0\0", 2);
+  EXPECT_THROW_WITH_MESSAGE(decoder_.onData(output_), EnvoyException,
+                            "invalid OP_MSG message length");
+}
+
 } // namespace MongoProxy
 } // namespace NetworkFilters
 } // namespace Extensions
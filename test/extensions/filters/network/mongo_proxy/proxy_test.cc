@@ -15,6 +15,7 @@
 #include "test/mocks/filesystem/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/runtime/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/printers.h"
 
 #include "gmock/gmock.h"
@@ -74,8 +75,8 @@ public:
   }
 
   void initializeFilter() {
-    filter_.reset(new TestProxyFilter("test.", store_, runtime_, access_log_, fault_config_,
-                                      drain_decision_, generator_));
+    filter_.reset(new TestProxyFilter("test.", store_, dynamic_stats_, runtime_, access_log_,
+                                      fault_config_, drain_decision_, generator_));
     filter_->initializeReadFilterCallbacks(read_filter_callbacks_);
     filter_->onNewConnection();
 
@@ -105,6 +106,9 @@ public:
 
   Buffer::OwnedImpl fake_data_;
   NiceMock<TestStatStore> store_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Stats::DynamicStatsCacheSharedPtr dynamic_stats_{
+      std::make_shared<Stats::DynamicStatsCache>(store_, tls_)};
   NiceMock<Runtime::MockLoader> runtime_;
   NiceMock<Event::MockDispatcher> dispatcher_;
   std::shared_ptr<Filesystem::MockFile> file_{new NiceMock<Filesystem::MockFile>()};
@@ -321,6 +325,29 @@ TEST_F(MongoProxyFilterTest, CommandStats) {
   EXPECT_EQ(1U, store_.counter("test.cmd.foo.total").value());
 }
 
+TEST_F(MongoProxyFilterTest, OpMsgStats) {
+  initializeFilter();
+
+  EXPECT_CALL(*file_, write(_)).Times(AtLeast(1));
+
+  EXPECT_CALL(*filter_->decoder_, onData(_)).WillOnce(Invoke([&](Buffer::Instance&) -> void {
+    OpMsgMessagePtr message(new OpMsgMessageImpl(1, 0));
+    message->body(Bson::DocumentImpl::create()->addString("find", "test")->addString("$db", "db"));
+    filter_->callbacks_->decodeOpMsg(std::move(message));
+  }));
+  filter_->onData(fake_data_, false);
+
+  EXPECT_CALL(*filter_->decoder_, onData(_)).WillOnce(Invoke([&](Buffer::Instance&) -> void {
+    OpMsgMessagePtr message(new OpMsgMessageImpl(2, 1));
+    filter_->callbacks_->decodeOpMsg(std::move(message));
+  }));
+  filter_->onWrite(fake_data_, false);
+
+  EXPECT_EQ(1U, store_.counter("test.op_msg").value());
+  EXPECT_EQ(1U, store_.counter("test.op_msg_reply").value());
+  EXPECT_EQ(1U, store_.counter("test.cmd.find.total").value());
+}
+
 TEST_F(MongoProxyFilterTest, CallingFunctionStats) {
   initializeFilter();
 
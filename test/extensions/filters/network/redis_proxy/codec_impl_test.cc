@@ -1,3 +1,5 @@
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "common/buffer/buffer_impl.h"
@@ -128,6 +130,50 @@ TEST_F(RedisEncoderDecoderImplTest, Array) {
   EXPECT_EQ(0UL, buffer_.length());
 }
 
+TEST_F(RedisEncoderDecoderImplTest, LargeBulkString) {
+  const std::string payload(100000, 'a');
+  RespValue value;
+  value.type(RespType::BulkString);
+  value.asString() = payload;
+  encoder_.encode(value, buffer_);
+
+  // Decode in pieces, with the payload split over several reads.
+  Buffer::OwnedImpl input;
+  while (buffer_.length() > 0) {
+    input.move(buffer_, std::min<uint64_t>(30000, buffer_.length()));
+    decoder_.decode(input);
+    EXPECT_EQ(0UL, input.length());
+  }
+  ASSERT_EQ(1UL, decoded_values_.size());
+  EXPECT_TRUE(decoded_values_[0]->hasBuffer());
+  EXPECT_EQ(payload, decoded_values_[0]->sharedBuffer()->toString());
+
+  // Re-encoding references the decoded payload.
+  encoder_.encode(*decoded_values_[0], buffer_);
+  EXPECT_EQ("$100000\r\n" + payload + "\r\n", buffer_.toString());
+  const std::weak_ptr<Buffer::Instance> decoded_buffer = decoded_values_[0]->sharedBuffer();
+  decoded_values_.clear();
+  EXPECT_FALSE(decoded_buffer.expired());
+  buffer_.drain(buffer_.length());
+  EXPECT_TRUE(decoded_buffer.expired());
+}
+
+TEST_F(RedisEncoderDecoderImplTest, LargeBulkStringInArray) {
+  const std::string payload(20000, 'a');
+  buffer_.add("*3\r\n$3\r\nset\r\n$3\r\nkey\r\n$20000\r\n" + payload + "\r\n");
+  decoder_.decode(buffer_);
+  EXPECT_EQ(0UL, buffer_.length());
+  ASSERT_EQ(1UL, decoded_values_.size());
+  const std::vector<RespValue>& values = decoded_values_[0]->asArray();
+  EXPECT_FALSE(values[1].hasBuffer());
+  EXPECT_EQ("key", values[1].asString());
+  EXPECT_TRUE(values[2].hasBuffer());
+
+  // asString() copies the payload out of the buffer.
+  EXPECT_EQ(payload, values[2].asString());
+  EXPECT_FALSE(values[2].hasBuffer());
+}
+
 TEST_F(RedisEncoderDecoderImplTest, NestedArray) {
   std::vector<RespValue> nested_values(3);
   nested_values[0].type(RespType::BulkString);
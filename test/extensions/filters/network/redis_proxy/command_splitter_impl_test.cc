@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "common/common/fmt.h"
+#include "common/protobuf/utility.h"
 #include "common/stats/isolated_store_impl.h"
 
 #include "extensions/filters/network/redis_proxy/command_splitter_impl.h"
@@ -11,6 +12,7 @@
 
 #include "test/extensions/filters/network/redis_proxy/mocks.h"
 #include "test/mocks/common.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/test_common/printers.h"
 
 #include "gmock/gmock.h"
@@ -21,6 +23,8 @@ using testing::ByRef;
 using testing::DoAll;
 using testing::Eq;
 using testing::InSequence;
+using testing::Invoke;
+using testing::NiceMock;
 using testing::Ref;
 using testing::Return;
 using testing::WithArg;
@@ -46,7 +50,7 @@ public:
 
   ConnPool::MockInstance* conn_pool_{new ConnPool::MockInstance()};
   Stats::IsolatedStoreImpl store_;
-  InstanceImpl splitter_{ConnPool::InstancePtr{conn_pool_}, store_, "redis.foo."};
+  InstanceImpl splitter_{ConnPool::InstancePtr{conn_pool_}, nullptr, store_, "redis.foo."};
   MockSplitCallbacks callbacks_;
   SplitRequestPtr handle_;
 };
@@ -680,6 +684,252 @@ TEST_P(RedisSplitKeysSumResultHandlerTest, NoUpstreamHostForAll) {
 INSTANTIATE_TEST_CASE_P(RedisSplitKeysSumResultHandlerTest, RedisSplitKeysSumResultHandlerTest,
                         testing::ValuesIn(SupportedCommands::hashMultipleSumResultCommands()));
 
+class RedisShardGroupingTest : public RedisCommandSplitterImplTest {
+public:
+  RedisShardGroupingTest() {
+    // Keys are in the shard named by their first character.
+    ON_CALL(*conn_pool_, shardForKey(_))
+        .WillByDefault(
+            Invoke([](const std::string& key) -> std::string { return key.substr(0, 1); }));
+  }
+
+  void expectRequest(const std::string& hash_key, const std::vector<std::string>& strings,
+                     uint32_t index) {
+    expected_requests_[index].reset(new RespValue());
+    makeBulkStringArray(*expected_requests_[index], strings);
+    EXPECT_CALL(*conn_pool_, makeRequest(hash_key, Eq(ByRef(*expected_requests_[index])), _))
+        .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks_[index])),
+                        Return(&pool_requests_[index])));
+  }
+
+  void makeRequest(const std::vector<std::string>& strings) {
+    RespValue request;
+    makeBulkStringArray(request, strings);
+    handle_ = splitter_.makeRequest(request, callbacks_);
+    EXPECT_NE(nullptr, handle_);
+  }
+
+  RespValuePtr expected_requests_[2];
+  ConnPool::PoolCallbacks* pool_callbacks_[2];
+  ConnPool::MockPoolRequest pool_requests_[2];
+};
+
+TEST_F(RedisShardGroupingTest, MGET) {
+  InSequence s;
+
+  expectRequest("a1", {"mget", "a1", "a2", "a3"}, 0);
+  expectRequest("b1", {"get", "b1"}, 1);
+  makeRequest({"mget", "a1", "b1", "a2", "a3"});
+
+  RespValuePtr response1(new RespValue());
+  makeBulkStringArray(*response1, {"1", "2", "3"});
+  response1->asArray()[1].type(RespType::Null);
+  response1->asArray()[2].type(RespType::Integer);
+  pool_callbacks_[0]->onResponse(std::move(response1));
+
+  RespValue expected_response;
+  makeBulkStringArray(expected_response, {"1", "4", "", "upstream protocol error"});
+  expected_response.asArray()[2].type(RespType::Null);
+  expected_response.asArray()[3].type(RespType::Error);
+  expected_response.asArray()[3].asString() = "upstream protocol error";
+  RespValuePtr response2(new RespValue());
+  response2->type(RespType::BulkString);
+  response2->asString() = "4";
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks_[1]->onResponse(std::move(response2));
+
+  EXPECT_EQ(1UL, store_.counter("redis.foo.command.mget.total").value());
+}
+
+TEST_F(RedisShardGroupingTest, MGETFailure) {
+  InSequence s;
+
+  expectRequest("a1", {"mget", "a1", "a2"}, 0);
+  expectRequest("b1", {"mget", "b1", "b2"}, 1);
+  makeRequest({"mget", "a1", "b1", "a2", "b2"});
+
+  // An unexpected response fails every key of the request.
+  RespValuePtr response1(new RespValue());
+  makeBulkStringArray(*response1, {"1"});
+  pool_callbacks_[0]->onResponse(std::move(response1));
+
+  RespValue expected_response;
+  makeBulkStringArray(expected_response, {"", "", "", ""});
+  for (uint64_t i = 0; i < 4; i++) {
+    expected_response.asArray()[i].type(RespType::Error);
+    expected_response.asArray()[i].asString() =
+        i % 2 == 0 ? "upstream protocol error" : "upstream failure";
+  }
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks_[1]->onFailure();
+}
+
+TEST_F(RedisShardGroupingTest, MSET) {
+  InSequence s;
+
+  expectRequest("a1", {"mset", "a1", "1", "a2", "2"}, 0);
+  expectRequest("b1", {"set", "b1", "3"}, 1);
+  makeRequest({"mset", "a1", "1", "b1", "3", "a2", "2"});
+
+  RespValuePtr response1(new RespValue());
+  response1->type(RespType::SimpleString);
+  response1->asString() = "OK";
+  pool_callbacks_[0]->onResponse(std::move(response1));
+
+  RespValue expected_response;
+  expected_response.type(RespType::SimpleString);
+  expected_response.asString() = "OK";
+  RespValuePtr response2(new RespValue());
+  response2->type(RespType::SimpleString);
+  response2->asString() = "OK";
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks_[1]->onResponse(std::move(response2));
+}
+
+TEST_F(RedisShardGroupingTest, SplitKeysSumResult) {
+  InSequence s;
+
+  expectRequest("a1", {"del", "a1", "a2"}, 0);
+  expectRequest("b1", {"del", "b1"}, 1);
+  makeRequest({"del", "a1", "b1", "a2"});
+
+  RespValuePtr response1(new RespValue());
+  response1->type(RespType::Integer);
+  response1->asInteger() = 2;
+  pool_callbacks_[0]->onResponse(std::move(response1));
+
+  RespValue expected_response;
+  expected_response.type(RespType::Integer);
+  expected_response.asInteger() = 3;
+  RespValuePtr response2(new RespValue());
+  response2->type(RespType::Integer);
+  response2->asInteger() = 1;
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks_[1]->onResponse(std::move(response2));
+}
+
+class RedisResponseCacheCommandSplitterTest : public RedisCommandSplitterImplTest {
+public:
+  RedisResponseCacheCommandSplitterTest() {
+    envoy::config::filter::network::redis_proxy::v2::RedisProxy::ResponseCache config;
+    MessageUtil::loadFromYaml("ttl: 1s", config);
+    caching_splitter_.reset(new InstanceImpl(
+        ConnPool::InstancePtr{caching_conn_pool_},
+        ResponseCachePtr{new ResponseCache(config, tls_, time_source_, store_, "redis.foo.")},
+        store_, "redis.foo."));
+  }
+
+  void makeRequest(const std::vector<std::string>& strings) {
+    RespValue request;
+    makeBulkStringArray(request, strings);
+    EXPECT_CALL(*caching_conn_pool_, makeRequest(strings[1], _, _))
+        .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks_)), Return(&pool_request_)));
+    handle_ = caching_splitter_->makeRequest(request, callbacks_);
+    EXPECT_NE(nullptr, handle_);
+  }
+
+  void respond(const std::string& string) {
+    RespValuePtr response(new RespValue());
+    response->type(RespType::BulkString);
+    response->asString() = string;
+    RespValue expected_response(*response);
+    EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+    pool_callbacks_->onResponse(std::move(response));
+    handle_.reset();
+  }
+
+  void expectCachedResponse(const std::vector<std::string>& strings, const RespValue& response) {
+    RespValue request;
+    makeBulkStringArray(request, strings);
+    EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&response)));
+    EXPECT_EQ(nullptr, caching_splitter_->makeRequest(request, callbacks_));
+  }
+
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<MockTimeSource> time_source_;
+  ConnPool::MockInstance* caching_conn_pool_{new ConnPool::MockInstance()};
+  std::unique_ptr<InstanceImpl> caching_splitter_;
+  ConnPool::PoolCallbacks* pool_callbacks_;
+  ConnPool::MockPoolRequest pool_request_;
+};
+
+TEST_F(RedisResponseCacheCommandSplitterTest, SimpleRequest) {
+  InSequence s;
+
+  makeRequest({"get", "foo"});
+  respond("bar");
+
+  RespValue expected_response;
+  expected_response.type(RespType::BulkString);
+  expected_response.asString() = "bar";
+  expectCachedResponse({"GET", "foo"}, expected_response);
+  EXPECT_EQ(1UL, store_.counter("redis.foo.cache.hit").value());
+  EXPECT_EQ(1UL, store_.counter("redis.foo.cache.miss").value());
+
+  // Responses to other commands are not cached.
+  makeRequest({"strlen", "foo"});
+  respond("3");
+  makeRequest({"strlen", "foo"});
+  respond("3");
+  EXPECT_EQ(1UL, store_.counter("redis.foo.cache.miss").value());
+}
+
+TEST_F(RedisResponseCacheCommandSplitterTest, WriteInvalidates) {
+  InSequence s;
+
+  makeRequest({"get", "foo"});
+  respond("bar");
+
+  // A response that arrives after a write is not cached, as it may predate the write.
+  makeRequest({"get", "baz"});
+  ConnPool::PoolCallbacks* get_callbacks = pool_callbacks_;
+  SplitRequestPtr get_handle = std::move(handle_);
+  makeRequest({"set", "foo", "baz"});
+  EXPECT_EQ(1UL, store_.counter("redis.foo.cache.invalidation").value());
+  respond("OK");
+
+  pool_callbacks_ = get_callbacks;
+  respond("qux");
+  get_handle.reset();
+
+  makeRequest({"get", "foo"});
+  respond("baz");
+  makeRequest({"get", "baz"});
+  respond("qux");
+  EXPECT_EQ(0UL, store_.counter("redis.foo.cache.hit").value());
+  EXPECT_EQ(4UL, store_.counter("redis.foo.cache.miss").value());
+}
+
+TEST_F(RedisResponseCacheCommandSplitterTest, MGET) {
+  InSequence s;
+
+  makeRequest({"get", "a"});
+  respond("1");
+
+  // Only the GETs that miss are sent.
+  RespValue request;
+  makeBulkStringArray(request, {"mget", "a", "b"});
+  RespValue expected_request;
+  makeBulkStringArray(expected_request, {"get", "b"});
+  EXPECT_CALL(*caching_conn_pool_, makeRequest("b", Eq(ByRef(expected_request)), _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks_)), Return(&pool_request_)));
+  handle_ = caching_splitter_->makeRequest(request, callbacks_);
+  EXPECT_NE(nullptr, handle_);
+
+  RespValue expected_response;
+  makeBulkStringArray(expected_response, {"1", "2"});
+  RespValuePtr response(new RespValue());
+  response->type(RespType::BulkString);
+  response->asString() = "2";
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks_->onResponse(std::move(response));
+  handle_.reset();
+
+  expectCachedResponse({"mget", "a", "b"}, expected_response);
+  EXPECT_EQ(3UL, store_.counter("redis.foo.cache.hit").value());
+  EXPECT_EQ(2UL, store_.counter("redis.foo.cache.miss").value());
+}
+
 } // namespace CommandSplitter
 } // namespace RedisProxy
 } // namespace NetworkFilters
@@ -1,3 +1,4 @@
+#include <cmath>
 #include <memory>
 #include <string>
 
@@ -6,7 +7,9 @@
 
 #include "extensions/filters/network/redis_proxy/conn_pool_impl.h"
 
+#include "test/common/upstream/utility.h"
 #include "test/extensions/filters/network/redis_proxy/mocks.h"
+#include "test/mocks/common.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/mocks.h"
@@ -16,6 +19,7 @@
 #include "gtest/gtest.h"
 
 using testing::_;
+using testing::AnyNumber;
 using testing::Eq;
 using testing::InSequence;
 using testing::Invoke;
@@ -95,6 +99,8 @@ public:
   const std::string cluster_name_{"foo"};
   std::shared_ptr<Upstream::MockHost> host_{new NiceMock<Upstream::MockHost>()};
   Event::MockDispatcher dispatcher_;
+  // Declared first, as the timer created last by the client is matched first.
+  NiceMock<Event::MockTimer>* flush_timer_{new NiceMock<Event::MockTimer>(&dispatcher_)};
   Event::MockTimer* connect_or_op_timer_{new Event::MockTimer(&dispatcher_)};
   MockEncoder* encoder_{new MockEncoder()};
   MockDecoder* decoder_{new MockDecoder()};
@@ -151,6 +157,97 @@ TEST_F(RedisClientImplTest, Basic) {
   client_->close();
 }
 
+TEST_F(RedisClientImplTest, LatencyCost) {
+  NiceMock<MockTimeSystem> time_system;
+  MonotonicTime now;
+  ON_CALL(time_system, monotonicTime()).WillByDefault(Invoke([&]() { return now; }));
+  dispatcher_.setTimeSystem(time_system);
+
+  setup();
+  EXPECT_EQ(0, client_->latencyCost());
+
+  RespValue request;
+  MockPoolCallbacks callbacks1;
+  EXPECT_CALL(*encoder_, encode(Ref(request), _)).Times(3);
+  client_->makeRequest(request, callbacks1);
+  onConnected();
+  EXPECT_CALL(*connect_or_op_timer_, enableTimer(_)).Times(AnyNumber());
+  EXPECT_CALL(*connect_or_op_timer_, disableTimer()).Times(AnyNumber());
+
+  // A response raises the latency to its response time at once.
+  now += std::chrono::milliseconds(2);
+  EXPECT_CALL(callbacks1, onResponse_(_));
+  callbacks_->onRespValue(RespValuePtr{new RespValue()});
+  EXPECT_DOUBLE_EQ(2000, client_->latencyCost());
+
+  // The cost grows with the outstanding requests.
+  MockPoolCallbacks callbacks2;
+  MockPoolCallbacks callbacks3;
+  client_->makeRequest(request, callbacks2);
+  client_->makeRequest(request, callbacks3);
+  EXPECT_DOUBLE_EQ(3 * 2000, client_->latencyCost());
+
+  // The latency decays while no responses are received.
+  now += std::chrono::seconds(10);
+  EXPECT_DOUBLE_EQ(3 * 2000 * std::exp(-1), client_->latencyCost());
+
+  EXPECT_CALL(callbacks2, onResponse_(_));
+  callbacks_->onRespValue(RespValuePtr{new RespValue()});
+  EXPECT_DOUBLE_EQ(2 * 10000000, client_->latencyCost());
+
+  // Responses are counted as host successes, or errors for error replies.
+  RespValuePtr error(new RespValue());
+  error->type(RespType::Error);
+  error->asString() = "ERR";
+  EXPECT_CALL(callbacks3, onResponse_(_));
+  callbacks_->onRespValue(std::move(error));
+  EXPECT_EQ(2UL, host_->stats_.rq_success_.value());
+  EXPECT_EQ(1UL, host_->stats_.rq_error_.value());
+
+  EXPECT_CALL(*upstream_connection_, close(Network::ConnectionCloseType::NoFlush));
+  client_->close();
+}
+
+TEST_F(RedisClientImplTest, BatchedWrites) {
+  InSequence s;
+
+  setup();
+
+  RespValue request1;
+  MockPoolCallbacks callbacks1;
+  EXPECT_CALL(*encoder_, encode(Ref(request1), _));
+  EXPECT_CALL(*flush_timer_, enableTimer(std::chrono::milliseconds(0)));
+  client_->makeRequest(request1, callbacks1);
+
+  onConnected();
+
+  RespValue request2;
+  MockPoolCallbacks callbacks2;
+  EXPECT_CALL(*encoder_, encode(Ref(request2), _));
+  EXPECT_CALL(*flush_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(*upstream_connection_, write(_, _)).Times(0);
+  client_->makeRequest(request2, callbacks2);
+
+  // Both requests are written at the end of the event loop iteration.
+  EXPECT_CALL(*upstream_connection_, write(_, false));
+  flush_timer_->callback_();
+
+  RespValue request3;
+  MockPoolCallbacks callbacks3;
+  EXPECT_CALL(*encoder_, encode(Ref(request3), _));
+  EXPECT_CALL(*flush_timer_, enableTimer(std::chrono::milliseconds(0)));
+  client_->makeRequest(request3, callbacks3);
+
+  // Requests not written yet are dropped on close.
+  EXPECT_CALL(*upstream_connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(callbacks1, onFailure());
+  EXPECT_CALL(callbacks2, onFailure());
+  EXPECT_CALL(callbacks3, onFailure());
+  EXPECT_CALL(*connect_or_op_timer_, disableTimer());
+  EXPECT_CALL(*flush_timer_, disableTimer());
+  client_->close();
+}
+
 TEST_F(RedisClientImplTest, Cancel) {
   InSequence s;
 
@@ -473,6 +570,24 @@ TEST_F(RedisConnPoolImplTest, NoHost) {
   tls_.shutdownThread();
 }
 
+TEST_F(RedisConnPoolImplTest, ShardForKey) {
+  InSequence s;
+
+  Upstream::HostSharedPtr host =
+      Upstream::makeTestHost(cm_.thread_local_cluster_.cluster_.info_, "tcp://10.0.0.1:6379");
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_))
+      .WillOnce(Invoke([&](Upstream::LoadBalancerContext* context) -> Upstream::HostConstSharedPtr {
+        EXPECT_EQ(context->computeHashKey().value(), std::hash<std::string>()("foo"));
+        return host;
+      }));
+  EXPECT_EQ("10.0.0.1:6379", conn_pool_->shardForKey("foo"));
+
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_)).WillOnce(Return(nullptr));
+  EXPECT_EQ("", conn_pool_->shardForKey("foo"));
+
+  tls_.shutdownThread();
+}
+
 TEST_F(RedisConnPoolImplTest, RemoteClose) {
   InSequence s;
 
@@ -494,6 +609,287 @@ TEST_F(RedisConnPoolImplTest, RemoteClose) {
   tls_.shutdownThread();
 }
 
+RespValue makeCommand(const std::vector<std::string>& arguments) {
+  RespValue command;
+  command.type(RespType::Array);
+  for (const std::string& argument : arguments) {
+    command.asArray().emplace_back();
+    command.asArray().back().type(RespType::BulkString);
+    command.asArray().back().asString() = argument;
+  }
+  return command;
+}
+
+// CLUSTER SLOTS response with slots 0-8191 on 10.0.0.1 and 8192-16383 on 10.0.0.2, replicated by
+// the given replicas.
+RespValuePtr makeClusterSlotsResponse(const std::vector<std::string>& replicas) {
+  auto node = [](const std::string& ip) -> RespValue {
+    RespValue node;
+    node.type(RespType::Array);
+    node.asArray().resize(2);
+    node.asArray()[0].type(RespType::BulkString);
+    node.asArray()[0].asString() = ip;
+    node.asArray()[1].type(RespType::Integer);
+    node.asArray()[1].asInteger() = 6379;
+    return node;
+  };
+  auto range = [](int64_t first, int64_t last, const std::vector<RespValue>& nodes) -> RespValue {
+    RespValue range;
+    range.type(RespType::Array);
+    range.asArray().resize(2);
+    range.asArray()[0].type(RespType::Integer);
+    range.asArray()[0].asInteger() = first;
+    range.asArray()[1].type(RespType::Integer);
+    range.asArray()[1].asInteger() = last;
+    range.asArray().insert(range.asArray().end(), nodes.begin(), nodes.end());
+    return range;
+  };
+
+  RespValuePtr response(new RespValue());
+  response->type(RespType::Array);
+  response->asArray().push_back(range(0, 8191, {node("10.0.0.1")}));
+  std::vector<RespValue> nodes{node("10.0.0.2")};
+  for (const std::string& replica : replicas) {
+    nodes.push_back(node(replica));
+  }
+  response->asArray().push_back(range(8192, 16383, nodes));
+  return response;
+}
+
+RespValuePtr makeError(const std::string& error) {
+  RespValuePtr value(new RespValue());
+  value->type(RespType::Error);
+  value->asString() = error;
+  return value;
+}
+
+class RedisClusterConnPoolImplTest : public RedisConnPoolImplTest {
+public:
+  void setup(bool read_from_replicas,
+             envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings::
+                 RedisCluster::ReplicaSelection replica_selection =
+                     envoy::config::filter::network::redis_proxy::v2::RedisProxy::
+                         ConnPoolSettings::RedisCluster::ROUND_ROBIN,
+             const std::vector<std::string>& replicas = {"10.0.0.3"}) {
+    Upstream::ClusterInfoConstSharedPtr info = cm_.thread_local_cluster_.cluster_.info_;
+    hosts_ = {Upstream::makeTestHost(info, "tcp://10.0.0.1:6379"),
+              Upstream::makeTestHost(info, "tcp://10.0.0.2:6379"),
+              Upstream::makeTestHost(info, "tcp://10.0.0.3:6379"),
+              Upstream::makeTestHost(info, "tcp://10.0.0.4:6379")};
+    cm_.thread_local_cluster_.cluster_.prioritySet().getMockHostSet(0)->hosts_ = hosts_;
+
+    auto settings = createConnPoolSettings();
+    settings.mutable_redis_cluster()->set_read_from_replicas(read_from_replicas);
+    settings.mutable_redis_cluster()->set_replica_selection(replica_selection);
+    slots_refresh_timer_ = new NiceMock<Event::MockTimer>(&tls_.dispatcher_);
+    EXPECT_CALL(*slots_refresh_timer_, enableTimer(std::chrono::milliseconds(0)));
+    conn_pool_.reset(new InstanceImpl(cluster_name_, cm_, *this, tls_, settings));
+
+    // The first refresh of the slot map is sent to any node.
+    clients_.resize(hosts_.size());
+    EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(nullptr)).WillOnce(Return(hosts_[0]));
+    expectClient(0, read_from_replicas);
+    PoolCallbacks* slots_callbacks;
+    EXPECT_CALL(*clients_[0], makeRequest(Eq(makeCommand({"CLUSTER", "SLOTS"})), _))
+        .WillOnce(Invoke([&](const RespValue&, PoolCallbacks& pool_callbacks) -> PoolRequest* {
+          slots_callbacks = &pool_callbacks;
+          return &slots_request_;
+        }));
+    slots_refresh_timer_->callback_();
+
+    EXPECT_CALL(*slots_refresh_timer_, enableTimer(std::chrono::milliseconds(10000)));
+    slots_callbacks->onResponse(makeClusterSlotsResponse(replicas));
+  }
+
+  void expectClient(uint32_t index, bool read_from_replicas) {
+    clients_[index] = new NiceMock<MockClient>();
+    EXPECT_CALL(*this, create_(Eq(hosts_[index]))).WillOnce(Return(clients_[index]));
+    if (read_from_replicas) {
+      EXPECT_CALL(*clients_[index], makeRequest(Eq(makeCommand({"READONLY"})), _))
+          .WillOnce(Return(&readonly_request_));
+    }
+  }
+
+  std::vector<Upstream::HostSharedPtr> hosts_;
+  std::vector<MockClient*> clients_;
+  NiceMock<Event::MockTimer>* slots_refresh_timer_;
+  MockPoolRequest slots_request_;
+  MockPoolRequest readonly_request_;
+};
+
+TEST_F(RedisClusterConnPoolImplTest, Moved) {
+  InSequence s;
+
+  setup(false);
+
+  // "foo" is in slot 12182.
+  RespValue value = makeCommand({"get", "foo"});
+  MockPoolCallbacks callbacks;
+  MockPoolRequest active_request1;
+  PoolCallbacks* request_callbacks;
+  expectClient(1, false);
+  EXPECT_CALL(*clients_[1], makeRequest(Eq(value), _))
+      .WillOnce(Invoke([&](const RespValue&, PoolCallbacks& pool_callbacks) -> PoolRequest* {
+        request_callbacks = &pool_callbacks;
+        return &active_request1;
+      }));
+  PoolRequest* request = conn_pool_->makeRequest("foo", value, callbacks);
+  EXPECT_NE(nullptr, request);
+
+  // The request is sent again to the new node of the slot, and the slot map is refreshed.
+  MockPoolRequest active_request2;
+  EXPECT_CALL(*slots_refresh_timer_, enableTimer(std::chrono::milliseconds(0)));
+  EXPECT_CALL(*clients_[0], makeRequest(Eq(value), _))
+      .WillOnce(Invoke([&](const RespValue&, PoolCallbacks& pool_callbacks) -> PoolRequest* {
+        request_callbacks = &pool_callbacks;
+        return &active_request2;
+      }));
+  request_callbacks->onResponse(makeError("MOVED 12182 10.0.0.1:6379"));
+
+  RespValuePtr response(new RespValue());
+  EXPECT_CALL(callbacks, onResponse_(Ref(response)));
+  request_callbacks->onResponse(std::move(response));
+
+  // The slot now maps to the new node.
+  MockPoolRequest active_request3;
+  EXPECT_CALL(*clients_[0], makeRequest(Eq(value), _)).WillOnce(Return(&active_request3));
+  request = conn_pool_->makeRequest("foo", value, callbacks);
+  EXPECT_NE(nullptr, request);
+
+  EXPECT_CALL(active_request3, cancel());
+  request->cancel();
+
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, Ask) {
+  InSequence s;
+
+  setup(false);
+
+  RespValue value = makeCommand({"get", "foo"});
+  MockPoolCallbacks callbacks;
+  MockPoolRequest active_request1;
+  PoolCallbacks* request_callbacks;
+  expectClient(1, false);
+  EXPECT_CALL(*clients_[1], makeRequest(Eq(value), _))
+      .WillOnce(Invoke([&](const RespValue&, PoolCallbacks& pool_callbacks) -> PoolRequest* {
+        request_callbacks = &pool_callbacks;
+        return &active_request1;
+      }));
+  conn_pool_->makeRequest("foo", value, callbacks);
+
+  // The request is sent once to the node importing the slot, preceded by ASKING.
+  MockPoolRequest asking_request;
+  MockPoolRequest active_request2;
+  EXPECT_CALL(*slots_refresh_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(*clients_[0], makeRequest(Eq(makeCommand({"ASKING"})), _))
+      .WillOnce(Return(&asking_request));
+  EXPECT_CALL(*clients_[0], makeRequest(Eq(value), _))
+      .WillOnce(Invoke([&](const RespValue&, PoolCallbacks& pool_callbacks) -> PoolRequest* {
+        request_callbacks = &pool_callbacks;
+        return &active_request2;
+      }));
+  request_callbacks->onResponse(makeError("ASK 12182 10.0.0.1:6379"));
+
+  // Redirections to nodes which are not hosts of the cluster are not followed.
+  RespValuePtr response = makeError("ASK 12182 10.0.0.4:6379");
+  EXPECT_CALL(callbacks, onResponse_(Ref(response)));
+  request_callbacks->onResponse(std::move(response));
+
+  // The slot map is unchanged.
+  MockPoolRequest active_request3;
+  EXPECT_CALL(*clients_[1], makeRequest(Eq(value), _))
+      .WillOnce(Invoke([&](const RespValue&, PoolCallbacks& pool_callbacks) -> PoolRequest* {
+        request_callbacks = &pool_callbacks;
+        return &active_request3;
+      }));
+  conn_pool_->makeRequest("foo", value, callbacks);
+
+  EXPECT_CALL(callbacks, onFailure());
+  request_callbacks->onFailure();
+
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, ShardForKey) {
+  setup(false);
+
+  // Keys are grouped by slot rather than by node.
+  EXPECT_EQ(std::to_string(SlotMap::slotForKey("foo")), conn_pool_->shardForKey("foo"));
+  EXPECT_EQ(conn_pool_->shardForKey("foo"), conn_pool_->shardForKey("{foo}.bar"));
+  EXPECT_NE(conn_pool_->shardForKey("foo"), conn_pool_->shardForKey("bar"));
+
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, ReadFromReplicas) {
+  InSequence s;
+
+  setup(true);
+
+  // Reads go to the replica, whose connection is read only.
+  RespValue get = makeCommand({"GET", "foo"});
+  MockPoolCallbacks callbacks;
+  MockPoolRequest active_request1;
+  expectClient(2, true);
+  EXPECT_CALL(*clients_[2], makeRequest(Eq(get), _)).WillOnce(Return(&active_request1));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", get, callbacks));
+
+  // Writes go to the master.
+  RespValue set = makeCommand({"SET", "foo", "bar"});
+  MockPoolRequest active_request2;
+  expectClient(1, true);
+  EXPECT_CALL(*clients_[1], makeRequest(Eq(set), _)).WillOnce(Return(&active_request2));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", set, callbacks));
+
+  // Without replicas, reads go to the master.
+  MockPoolRequest active_request3;
+  EXPECT_CALL(*clients_[0], makeRequest(Eq(get), _)).WillOnce(Return(&active_request3));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("bar", get, callbacks));
+
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, LeastLatencyReplicas) {
+  setup(true,
+        envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings::
+            RedisCluster::LEAST_LATENCY,
+        {"10.0.0.3", "10.0.0.4"});
+
+  RespValue get = makeCommand({"GET", "foo"});
+  MockPoolCallbacks callbacks;
+  MockPoolRequest active_request;
+
+  // Replicas without a connection are tried first.
+  expectClient(2, true);
+  EXPECT_CALL(*clients_[2], makeRequest(Eq(get), _)).WillOnce(Return(&active_request));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", get, callbacks));
+
+  expectClient(3, true);
+  ON_CALL(*clients_[2], latencyCost()).WillByDefault(Return(5000));
+  EXPECT_CALL(*clients_[3], makeRequest(Eq(get), _)).WillOnce(Return(&active_request));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", get, callbacks));
+
+  // The faster replica is chosen, even when the slower one has its turn.
+  ON_CALL(*clients_[3], latencyCost()).WillByDefault(Return(1000));
+  EXPECT_CALL(*clients_[3], makeRequest(Eq(get), _))
+      .Times(2)
+      .WillRepeatedly(Return(&active_request));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", get, callbacks));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", get, callbacks));
+
+  // A replica failing health checks is avoided.
+  hosts_[3]->healthFlagSet(Upstream::Host::HealthFlag::FAILED_ACTIVE_HC);
+  EXPECT_CALL(*clients_[2], makeRequest(Eq(get), _))
+      .Times(2)
+      .WillRepeatedly(Return(&active_request));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", get, callbacks));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", get, callbacks));
+
+  tls_.shutdownThread();
+}
+
 } // namespace ConnPool
 } // namespace RedisProxy
 } // namespace NetworkFilters
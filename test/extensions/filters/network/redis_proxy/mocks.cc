@@ -9,6 +9,7 @@
 
 using testing::_;
 using testing::Invoke;
+using testing::ReturnArg;
 
 namespace Envoy {
 namespace Extensions {
@@ -85,7 +86,10 @@ MockPoolRequest::~MockPoolRequest() {}
 MockPoolCallbacks::MockPoolCallbacks() {}
 MockPoolCallbacks::~MockPoolCallbacks() {}
 
-MockInstance::MockInstance() {}
+MockInstance::MockInstance() {
+  // By default, every key is in its own shard.
+  ON_CALL(*this, shardForKey(_)).WillByDefault(ReturnArg<0>());
+}
 MockInstance::~MockInstance() {}
 
 } // namespace ConnPool
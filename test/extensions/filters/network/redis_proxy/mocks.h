@@ -72,6 +72,7 @@ public:
   MOCK_METHOD1(addConnectionCallbacks, void(Network::ConnectionCallbacks& callbacks));
   MOCK_METHOD0(close, void());
   MOCK_METHOD2(makeRequest, PoolRequest*(const RespValue& request, PoolCallbacks& callbacks));
+  MOCK_METHOD0(latencyCost, double());
 
   std::list<Network::ConnectionCallbacks*> callbacks_;
 };
@@ -102,6 +103,7 @@ public:
 
   MOCK_METHOD3(makeRequest, PoolRequest*(const std::string& hash_key, const RespValue& request,
                                          PoolCallbacks& callbacks));
+  MOCK_METHOD1(shardForKey, std::string(const std::string& hash_key));
 };
 
 } // namespace ConnPool
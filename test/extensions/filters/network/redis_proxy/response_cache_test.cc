@@ -0,0 +1,198 @@
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/network/redis_proxy/response_cache.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::ReturnPointee;
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace CommandSplitter {
+
+class RedisResponseCacheTest : public testing::Test {
+public:
+  void setup(const std::string& yaml) {
+    envoy::config::filter::network::redis_proxy::v2::RedisProxy::ResponseCache config;
+    MessageUtil::loadFromYaml(yaml, config);
+    cache_.reset(new ResponseCache(config, tls_, time_source_, store_, "redis.foo."));
+  }
+
+  RespValue makeRequest(const std::vector<std::string>& strings) {
+    std::vector<RespValue> values(strings.size());
+    for (uint64_t i = 0; i < strings.size(); i++) {
+      values[i].type(RespType::BulkString);
+      values[i].asString() = strings[i];
+    }
+    RespValue request;
+    request.type(RespType::Array);
+    request.asArray().swap(values);
+    return request;
+  }
+
+  RespValue makeBulkString(const std::string& string) {
+    RespValue value;
+    value.type(RespType::BulkString);
+    value.asString() = string;
+    return value;
+  }
+
+  // Cache a response to a request, and return whether it was cached.
+  bool cache(const RespValue& request, const RespValue& response) {
+    ResponseCache::Key key;
+    EXPECT_EQ(nullptr, cache_->lookup(request, key));
+    cache_->insert(key, response);
+    return cache_->lookup(request, key) != nullptr;
+  }
+
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  NiceMock<MockTimeSource> time_source_;
+  MonotonicTime now_;
+  Stats::IsolatedStoreImpl store_;
+  ResponseCachePtr cache_;
+};
+
+TEST_F(RedisResponseCacheTest, Commands) {
+  setup("ttl: 1s");
+  EXPECT_TRUE(cache_->cached("get"));
+  EXPECT_TRUE(cache_->cached("HGET"));
+  EXPECT_FALSE(cache_->cached("hgetall"));
+
+  setup(R"EOF(
+ttl: 1s
+commands: [ GET, hgetall ]
+)EOF");
+  EXPECT_TRUE(cache_->cached("get"));
+  EXPECT_TRUE(cache_->cached("hgetall"));
+  EXPECT_FALSE(cache_->cached("hget"));
+
+  EXPECT_THROW_WITH_MESSAGE(setup(R"EOF(
+ttl: 1s
+commands: [ set ]
+)EOF"),
+                            EnvoyException, "redis: cannot cache the responses to 'set'");
+  EXPECT_THROW_WITH_MESSAGE(setup(R"EOF(
+ttl: 1s
+commands: [ exists ]
+)EOF"),
+                            EnvoyException, "redis: cannot cache the responses to 'exists'");
+}
+
+TEST_F(RedisResponseCacheTest, HitAndExpiry) {
+  ON_CALL(time_source_, monotonicTime()).WillByDefault(ReturnPointee(&now_));
+  setup("ttl: 1s");
+
+  const RespValue request = makeRequest({"HGET", "foo", "bar"});
+  ResponseCache::Key key;
+  EXPECT_EQ(nullptr, cache_->lookup(request, key));
+  EXPECT_EQ("foo", key.key_);
+  cache_->insert(key, makeBulkString("baz"));
+
+  RespValuePtr response = cache_->lookup(makeRequest({"hget", "foo", "bar"}), key);
+  ASSERT_NE(nullptr, response);
+  EXPECT_EQ("baz", response->asString());
+  EXPECT_EQ(nullptr, cache_->lookup(makeRequest({"hget", "foo", "ba"}), key));
+  EXPECT_EQ(nullptr, cache_->lookup(makeRequest({"hget", "foo", "bar", ""}), key));
+  EXPECT_EQ(nullptr, cache_->lookup(makeRequest({"hget", "fo", "obar"}), key));
+
+  now_ += std::chrono::milliseconds(999);
+  EXPECT_NE(nullptr, cache_->lookup(request, key));
+  now_ += std::chrono::milliseconds(1);
+  EXPECT_EQ(nullptr, cache_->lookup(request, key));
+
+  EXPECT_EQ(2UL, store_.counter("redis.foo.cache.hit").value());
+  EXPECT_EQ(5UL, store_.counter("redis.foo.cache.miss").value());
+}
+
+TEST_F(RedisResponseCacheTest, Cacheable) {
+  setup(R"EOF(
+ttl: 1s
+commands: [ get, hgetall ]
+)EOF");
+
+  RespValue null;
+  EXPECT_TRUE(cache(makeRequest({"get", "null"}), null));
+
+  RespValue error;
+  error.type(RespType::Error);
+  error.asString() = "ERR";
+  EXPECT_FALSE(cache(makeRequest({"get", "error"}), error));
+
+  RespValue buffered;
+  buffered.type(RespType::BulkString);
+  buffered.asBuffer().add("large");
+  EXPECT_FALSE(cache(makeRequest({"get", "buffered"}), buffered));
+
+  RespValue array;
+  array.type(RespType::Array);
+  array.asArray().push_back(makeBulkString("field"));
+  EXPECT_TRUE(cache(makeRequest({"hgetall", "array"}), array));
+  array.asArray().push_back(buffered);
+  EXPECT_FALSE(cache(makeRequest({"hgetall", "buffered_array"}), array));
+}
+
+TEST_F(RedisResponseCacheTest, Invalidate) {
+  setup("ttl: 1s");
+
+  const RespValue request = makeRequest({"get", "foo"});
+  EXPECT_TRUE(cache(request, makeBulkString("bar")));
+  EXPECT_TRUE(cache(makeRequest({"hget", "foo", "bar"}), makeBulkString("baz")));
+
+  cache_->invalidate("bar");
+  EXPECT_EQ(0UL, store_.counter("redis.foo.cache.invalidation").value());
+  cache_->invalidate("foo");
+  EXPECT_EQ(1UL, store_.counter("redis.foo.cache.invalidation").value());
+  ResponseCache::Key key;
+  EXPECT_EQ(nullptr, cache_->lookup(request, key));
+  EXPECT_EQ(nullptr, cache_->lookup(makeRequest({"hget", "foo", "bar"}), key));
+
+  // A response to a request looked up before an invalidation may predate the write.
+  EXPECT_EQ(nullptr, cache_->lookup(request, key));
+  cache_->invalidate("other");
+  cache_->insert(key, makeBulkString("bar"));
+  EXPECT_EQ(nullptr, cache_->lookup(request, key));
+}
+
+TEST_F(RedisResponseCacheTest, Eviction) {
+  setup(R"EOF(
+ttl: 1s
+max_entries: 2
+)EOF");
+
+  EXPECT_TRUE(cache(makeRequest({"get", "a"}), makeBulkString("a")));
+  EXPECT_TRUE(cache(makeRequest({"get", "b"}), makeBulkString("b")));
+  ResponseCache::Key key;
+  EXPECT_NE(nullptr, cache_->lookup(makeRequest({"get", "a"}), key));
+
+  // b is the least recently used key.
+  EXPECT_TRUE(cache(makeRequest({"get", "c"}), makeBulkString("c")));
+  EXPECT_EQ(1UL, store_.counter("redis.foo.cache.eviction").value());
+  EXPECT_NE(nullptr, cache_->lookup(makeRequest({"get", "a"}), key));
+  EXPECT_EQ(nullptr, cache_->lookup(makeRequest({"get", "b"}), key));
+  EXPECT_NE(nullptr, cache_->lookup(makeRequest({"get", "c"}), key));
+
+  // Keys are evicted with all their entries, but the most recently used key is kept.
+  EXPECT_TRUE(cache(makeRequest({"hget", "c", "1"}), makeBulkString("1")));
+  EXPECT_EQ(2UL, store_.counter("redis.foo.cache.eviction").value());
+  EXPECT_EQ(nullptr, cache_->lookup(makeRequest({"get", "a"}), key));
+  EXPECT_TRUE(cache(makeRequest({"hget", "c", "2"}), makeBulkString("2")));
+  EXPECT_NE(nullptr, cache_->lookup(makeRequest({"get", "c"}), key));
+}
+
+} // namespace CommandSplitter
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,145 @@
+#include <string>
+#include <vector>
+
+#include "extensions/filters/network/redis_proxy/slot_map.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+
+RespValue makeNode(const std::string& ip, int64_t port) {
+  std::vector<RespValue> fields(3);
+  fields[0].type(RespType::BulkString);
+  fields[0].asString() = ip;
+  fields[1].type(RespType::Integer);
+  fields[1].asInteger() = port;
+  fields[2].type(RespType::BulkString);
+  fields[2].asString() = "09dbe9720cda62f7865eabc5fd8857c5d2678366";
+  RespValue node;
+  node.type(RespType::Array);
+  node.asArray().swap(fields);
+  return node;
+}
+
+RespValue makeRange(int64_t first, int64_t last, const std::vector<RespValue>& nodes) {
+  std::vector<RespValue> fields(2);
+  fields[0].type(RespType::Integer);
+  fields[0].asInteger() = first;
+  fields[1].type(RespType::Integer);
+  fields[1].asInteger() = last;
+  fields.insert(fields.end(), nodes.begin(), nodes.end());
+  RespValue range;
+  range.type(RespType::Array);
+  range.asArray().swap(fields);
+  return range;
+}
+
+RespValue makeError(const std::string& error) {
+  RespValue value;
+  value.type(RespType::Error);
+  value.asString() = error;
+  return value;
+}
+
+TEST(RedisSlotMapTest, SlotForKey) {
+  EXPECT_EQ(12182, SlotMap::slotForKey("foo"));
+  EXPECT_EQ(5061, SlotMap::slotForKey("bar"));
+  EXPECT_EQ(0x31C3, SlotMap::slotForKey("123456789"));
+  EXPECT_EQ(0, SlotMap::slotForKey(""));
+
+  // Only hash tags are hashed.
+  EXPECT_EQ(SlotMap::slotForKey("user1000"), SlotMap::slotForKey("{user1000}.following"));
+  EXPECT_EQ(SlotMap::slotForKey("user1000"), SlotMap::slotForKey("{user1000}.followers"));
+  EXPECT_EQ(SlotMap::slotForKey("bar"), SlotMap::slotForKey("foo{bar}{zap}"));
+  EXPECT_EQ(SlotMap::slotForKey("{bar"), SlotMap::slotForKey("foo{{bar}}zap"));
+
+  // Empty or unterminated hash tags are not hash tags.
+  EXPECT_NE(SlotMap::slotForKey(""), SlotMap::slotForKey("foo{}{bar}"));
+  EXPECT_NE(SlotMap::slotForKey("bar"), SlotMap::slotForKey("foo{bar"));
+}
+
+TEST(RedisSlotMapTest, Create) {
+  RespValue response;
+  response.type(RespType::Array);
+  response.asArray().push_back(
+      makeRange(0, 5460, {makeNode("10.0.0.1", 6379), makeNode("10.0.0.2", 6379)}));
+  response.asArray().push_back(makeRange(5461, 10922, {makeNode("::1", 6380)}));
+
+  SlotMapPtr slot_map = SlotMap::create(response);
+  ASSERT_NE(nullptr, slot_map);
+  const SlotMap::Shard* shard = slot_map->shard(0);
+  ASSERT_NE(nullptr, shard);
+  EXPECT_EQ("10.0.0.1:6379", shard->master_);
+  EXPECT_EQ(std::vector<std::string>{"10.0.0.2:6379"}, shard->replicas_);
+  EXPECT_EQ(shard, slot_map->shard(5460));
+
+  shard = slot_map->shard(10922);
+  ASSERT_NE(nullptr, shard);
+  EXPECT_EQ("[::1]:6380", shard->master_);
+  EXPECT_TRUE(shard->replicas_.empty());
+
+  EXPECT_EQ(nullptr, slot_map->shard(10923));
+  EXPECT_EQ(nullptr, slot_map->shard(SlotMap::NumSlots - 1));
+
+  // Moving to a known master keeps the slot's replicas unknown until the next refresh.
+  slot_map->moveSlot(10923, "10.0.0.1:6379");
+  EXPECT_EQ(slot_map->shard(0), slot_map->shard(10923));
+  slot_map->moveSlot(0, "10.0.0.3:6379");
+  EXPECT_EQ("10.0.0.3:6379", slot_map->shard(0)->master_);
+  EXPECT_EQ("10.0.0.1:6379", slot_map->shard(1)->master_);
+}
+
+TEST(RedisSlotMapTest, CreateInvalid) {
+  RespValue response;
+  EXPECT_EQ(nullptr, SlotMap::create(response));
+
+  response.type(RespType::Array);
+  response.asArray().push_back(makeRange(0, 5460, {}));
+  EXPECT_EQ(nullptr, SlotMap::create(response));
+
+  response.asArray()[0] = makeRange(5460, 0, {makeNode("10.0.0.1", 6379)});
+  EXPECT_EQ(nullptr, SlotMap::create(response));
+
+  response.asArray()[0] = makeRange(0, SlotMap::NumSlots, {makeNode("10.0.0.1", 6379)});
+  EXPECT_EQ(nullptr, SlotMap::create(response));
+
+  response.asArray()[0] = makeRange(0, 5460, {makeNode("10.0.0.1", 0)});
+  EXPECT_EQ(nullptr, SlotMap::create(response));
+
+  response.asArray()[0] = makeRange(0, 5460, {makeNode("redis.example.com", 6379)});
+  EXPECT_EQ(nullptr, SlotMap::create(response));
+}
+
+TEST(RedisSlotMapTest, ParseRedirection) {
+  absl::optional<SlotMap::Redirection> redirection =
+      SlotMap::parseRedirection(makeError("MOVED 3999 127.0.0.1:6381"));
+  ASSERT_TRUE(redirection.has_value());
+  EXPECT_FALSE(redirection.value().ask_);
+  EXPECT_EQ(3999, redirection.value().slot_);
+  EXPECT_EQ("127.0.0.1:6381", redirection.value().address_);
+
+  redirection = SlotMap::parseRedirection(makeError("ASK 3999 ::1:6381"));
+  ASSERT_TRUE(redirection.has_value());
+  EXPECT_TRUE(redirection.value().ask_);
+  EXPECT_EQ("[::1]:6381", redirection.value().address_);
+
+  EXPECT_FALSE(SlotMap::parseRedirection(makeError("ERR unknown command")).has_value());
+  EXPECT_FALSE(SlotMap::parseRedirection(makeError("MOVED 16384 127.0.0.1:6381")).has_value());
+  EXPECT_FALSE(SlotMap::parseRedirection(makeError("MOVED 3999 127.0.0.1")).has_value());
+  EXPECT_FALSE(SlotMap::parseRedirection(makeError("MOVED 3999 127.0.0.1:x")).has_value());
+
+  RespValue value;
+  value.type(RespType::SimpleString);
+  value.asString() = "MOVED 3999 127.0.0.1:6381";
+  EXPECT_FALSE(SlotMap::parseRedirection(value).has_value());
+}
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,4 +1,6 @@
 #include <limits>
+#include <string>
+#include <vector>
 
 #include "envoy/common/exception.h"
 
@@ -413,6 +415,37 @@ TEST(BufferHelperTest, PeekZigZagI64) {
   EXPECT_EQ(size, 10);
 }
 
+// Var ints of every length are decoded whether they are followed by more data, or end the buffer
+// and are split across its slices.
+TEST(BufferHelperTest, PeekZigZagI64EveryLength) {
+  std::vector<int64_t> values{0, -1};
+  for (int i = 1; i < 64; i++) {
+    values.push_back(static_cast<int64_t>((static_cast<uint64_t>(1) << i) - 1));
+    values.push_back(-static_cast<int64_t>(static_cast<uint64_t>(1) << (i - 1)) * 2);
+  }
+
+  for (int64_t value : values) {
+    Buffer::OwnedImpl encoded;
+    BufferHelper::writeZigZagI64(encoded, value);
+    const std::string bytes = encoded.toString();
+    const int length = bytes.size();
+
+    Buffer::OwnedImpl buffer;
+    addInt8(buffer, 0);
+    buffer.add(bytes);
+    BufferHelper::writeZigZagI64(buffer, -1);
+    int size = 0;
+    EXPECT_EQ(value, BufferHelper::peekZigZagI64(buffer, 1, size));
+    EXPECT_EQ(length, size);
+
+    Buffer::OwnedImpl split(bytes.substr(0, length / 2));
+    Buffer::OwnedImpl rest(bytes.substr(length / 2));
+    split.move(rest);
+    EXPECT_EQ(value, BufferHelper::peekZigZagI64(split, 0, size));
+    EXPECT_EQ(length, size);
+  }
+}
+
 TEST(BufferHelperTest, PeekZigZagI64BufferUnderflow) {
   Buffer::OwnedImpl buffer;
   int size = 0;
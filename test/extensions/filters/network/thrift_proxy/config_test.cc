@@ -111,6 +111,14 @@ TEST_F(ThriftFilterConfigTest, ThriftProxyWithEmptyProto) {
   testConfig(config);
 }
 
+TEST_F(ThriftFilterConfigTest, ProtocolOptionsMaxRequestsPerConnection) {
+  envoy::config::filter::network::thrift_proxy::v2alpha1::ThriftProtocolOptions options;
+  EXPECT_EQ(1U, ProtocolOptionsConfigImpl(options).maxRequestsPerConnection());
+
+  options.mutable_max_requests_per_connection()->set_value(100);
+  EXPECT_EQ(100U, ProtocolOptionsConfigImpl(options).maxRequestsPerConnection());
+}
+
 } // namespace ThriftProxy
 } // namespace NetworkFilters
 } // namespace Extensions
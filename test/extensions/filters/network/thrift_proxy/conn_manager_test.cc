@@ -618,6 +618,51 @@ route_config:
   filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
 }
 
+TEST_F(ThriftConnectionManagerTest, PayloadPassthrough) {
+  const std::string yaml = R"EOF(
+transport: FRAMED
+protocol: BINARY
+stat_prefix: test
+payload_passthrough: true
+)EOF";
+
+  initializeFilter(yaml);
+  writeFramedBinaryMessage(buffer_, MessageType::Oneway, 0x0F);
+
+  EXPECT_CALL(*decoder_filter_, passthroughEnabled()).WillOnce(Return(true));
+  EXPECT_CALL(*decoder_filter_, structBegin(_)).Times(0);
+  EXPECT_CALL(*decoder_filter_, passthroughData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& data) -> FilterStatus {
+        // The struct with its string field and stop byte.
+        EXPECT_EQ(13U, data.length());
+        return FilterStatus::Continue;
+      }));
+  EXPECT_CALL(*decoder_filter_, messageEnd());
+  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_, deferredDelete_(_)).Times(1);
+
+  EXPECT_EQ(filter_->onData(buffer_, false), Network::FilterStatus::StopIteration);
+  EXPECT_EQ(0U, buffer_.length());
+  EXPECT_EQ(1U, store_.counter("test.request_oneway").value());
+  EXPECT_EQ(0U, store_.counter("test.request_decoding_error").value());
+
+  filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
+}
+
+TEST_F(ThriftConnectionManagerTest, PayloadPassthroughDisabled) {
+  initializeFilter();
+  writeFramedBinaryMessage(buffer_, MessageType::Oneway, 0x0F);
+
+  EXPECT_CALL(*decoder_filter_, passthroughEnabled()).Times(0);
+  EXPECT_CALL(*decoder_filter_, passthroughData(_)).Times(0);
+  EXPECT_CALL(*decoder_filter_, structBegin(_));
+  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_, deferredDelete_(_)).Times(1);
+
+  EXPECT_EQ(filter_->onData(buffer_, false), Network::FilterStatus::StopIteration);
+  EXPECT_EQ(1U, store_.counter("test.request_oneway").value());
+
+  filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
+}
+
 TEST_F(ThriftConnectionManagerTest, RequestAndResponse) {
   initializeFilter();
   writeComplexFramedBinaryMessage(buffer_, MessageType::Call, 0x0F);
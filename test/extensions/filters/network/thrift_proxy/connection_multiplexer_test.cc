@@ -0,0 +1,218 @@
+#include "common/buffer/buffer_impl.h"
+
+#include "extensions/filters/network/thrift_proxy/binary_protocol_impl.h"
+#include "extensions/filters/network/thrift_proxy/framed_transport_impl.h"
+#include "extensions/filters/network/thrift_proxy/router/connection_multiplexer.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/tcp/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace ThriftProxy {
+namespace Router {
+
+class ThriftConnectionMultiplexerTest : public testing::Test {
+public:
+  MultiplexedConnection& addConnection(uint32_t max_requests) {
+    auto* conn_data = new NiceMock<Tcp::ConnectionPool::MockConnectionData>();
+    ON_CALL(*conn_data, connection()).WillByDefault(ReturnRef(connection_));
+    ON_CALL(*conn_data, connectionState())
+        .WillByDefault(
+            Invoke([&]() -> Tcp::ConnectionPool::ConnectionState* { return conn_state_.get(); }));
+    ON_CALL(*conn_data, setConnectionState_(_))
+        .WillByDefault(Invoke(
+            [&](Tcp::ConnectionPool::ConnectionStatePtr& cs) -> void { conn_state_.swap(cs); }));
+    conn_data->release_callback_ = [&]() -> void { released_ = true; };
+
+    return multiplexer_.addConnection(pool_, Tcp::ConnectionPool::ConnectionDataPtr{conn_data},
+                                      host_, TransportType::Framed, ProtocolType::Binary,
+                                      max_requests);
+  }
+
+  void writeResponse(Buffer::Instance& buffer, int32_t sequence_id) {
+    MessageMetadata metadata;
+    metadata.setMethodName("method");
+    metadata.setMessageType(MessageType::Reply);
+    metadata.setSequenceId(sequence_id);
+
+    BinaryProtocolImpl protocol;
+    Buffer::OwnedImpl message;
+    protocol.writeMessageBegin(message, metadata);
+    protocol.writeStructBegin(message, "");
+    protocol.writeFieldBegin(message, "", FieldType::Stop, 0);
+    protocol.writeStructEnd(message);
+    protocol.writeMessageEnd(message);
+
+    FramedTransportImpl transport;
+    transport.encodeFrame(buffer, metadata, message);
+  }
+
+  // Runs the deferred deletion of the connections that are no longer shared.
+  void deleteReleasedConnections() { connection_.dispatcher_.to_delete_.clear(); }
+
+  bool released_{};
+  Tcp::ConnectionPool::ConnectionStatePtr conn_state_;
+  NiceMock<Network::MockClientConnection> connection_;
+  NiceMock<Tcp::ConnectionPool::MockInstance> pool_;
+  std::shared_ptr<NiceMock<Upstream::MockHostDescription>> host_{
+      new NiceMock<Upstream::MockHostDescription>()};
+  ConnectionMultiplexer multiplexer_;
+  NiceMock<Tcp::ConnectionPool::MockUpstreamCallbacks> callbacks1_;
+  NiceMock<Tcp::ConnectionPool::MockUpstreamCallbacks> callbacks2_;
+};
+
+TEST_F(ThriftConnectionMultiplexerTest, ResponsesMatchedBySequenceId) {
+  EXPECT_EQ(nullptr, multiplexer_.connection(pool_, TransportType::Framed, ProtocolType::Binary));
+
+  MultiplexedConnection& connection = addConnection(2);
+  EXPECT_EQ(host_, connection.host());
+  EXPECT_NE(nullptr, conn_state_);
+  EXPECT_EQ(&connection,
+            multiplexer_.connection(pool_, TransportType::Framed, ProtocolType::Binary));
+  EXPECT_EQ(nullptr, multiplexer_.connection(pool_, TransportType::Header, ProtocolType::Binary));
+  EXPECT_EQ(nullptr, multiplexer_.connection(pool_, TransportType::Framed, ProtocolType::Compact));
+
+  connection.addRequest(1, callbacks1_);
+  connection.addRequest(2, callbacks2_);
+  EXPECT_EQ(nullptr, multiplexer_.connection(pool_, TransportType::Framed, ProtocolType::Binary));
+
+  Buffer::OwnedImpl response1;
+  writeResponse(response1, 1);
+  const uint64_t response1_length = response1.length();
+
+  // The second response arrives first, followed by part of the first.
+  Buffer::OwnedImpl data;
+  writeResponse(data, 2);
+  const uint64_t response2_length = data.length();
+  data.move(response1, 5);
+
+  EXPECT_CALL(callbacks1_, onUpstreamData(_, _)).Times(0);
+  EXPECT_CALL(callbacks2_, onUpstreamData(_, true))
+      .WillOnce(Invoke([&](Buffer::Instance& frame, bool) -> void {
+        EXPECT_EQ(response2_length, frame.length());
+      }));
+  connection.onUpstreamData(data, false);
+  EXPECT_EQ(5UL, data.length());
+  EXPECT_FALSE(released_);
+
+  // The connection is released once no request waits on it.
+  data.move(response1);
+  EXPECT_CALL(callbacks1_, onUpstreamData(_, true))
+      .WillOnce(Invoke([&](Buffer::Instance& frame, bool) -> void {
+        EXPECT_EQ(response1_length, frame.length());
+      }));
+  EXPECT_CALL(connection_, close(_)).Times(0);
+  connection.onUpstreamData(data, false);
+  EXPECT_EQ(0UL, data.length());
+  EXPECT_EQ(nullptr, multiplexer_.connection(pool_, TransportType::Framed, ProtocolType::Binary));
+
+  EXPECT_FALSE(released_);
+  deleteReleasedConnections();
+  EXPECT_TRUE(released_);
+}
+
+TEST_F(ThriftConnectionMultiplexerTest, AbandonedRequest) {
+  MultiplexedConnection& connection = addConnection(2);
+  connection.addRequest(1, callbacks1_);
+  connection.addRequest(2, callbacks2_);
+  connection.removeRequest(1, true);
+
+  // The abandoned request still counts against the limit until its response arrives.
+  EXPECT_EQ(nullptr, multiplexer_.connection(pool_, TransportType::Framed, ProtocolType::Binary));
+
+  Buffer::OwnedImpl data;
+  writeResponse(data, 1);
+  EXPECT_CALL(callbacks1_, onUpstreamData(_, _)).Times(0);
+  connection.onUpstreamData(data, false);
+  EXPECT_EQ(&connection,
+            multiplexer_.connection(pool_, TransportType::Framed, ProtocolType::Binary));
+
+  // The connection is reusable as no response is pending.
+  EXPECT_CALL(connection_, close(_)).Times(0);
+  connection.removeRequest(2, false);
+  deleteReleasedConnections();
+  EXPECT_TRUE(released_);
+}
+
+TEST_F(ThriftConnectionMultiplexerTest, ClosedWithPendingResponse) {
+  MultiplexedConnection& connection = addConnection(2);
+  connection.addRequest(1, callbacks1_);
+
+  // A late response must not reach the next user of the connection.
+  EXPECT_CALL(connection_, close(Network::ConnectionCloseType::NoFlush));
+  connection.removeRequest(1, true);
+
+  EXPECT_CALL(callbacks1_, onEvent(_)).Times(0);
+  connection.onEvent(Network::ConnectionEvent::LocalClose);
+  deleteReleasedConnections();
+  EXPECT_TRUE(released_);
+}
+
+TEST_F(ThriftConnectionMultiplexerTest, UnexpectedSequenceId) {
+  MultiplexedConnection& connection = addConnection(2);
+  connection.addRequest(1, callbacks1_);
+
+  Buffer::OwnedImpl data;
+  writeResponse(data, 3);
+  EXPECT_CALL(callbacks1_, onUpstreamData(_, _)).Times(0);
+  EXPECT_CALL(connection_, close(Network::ConnectionCloseType::NoFlush))
+      .WillOnce(Invoke([&](Network::ConnectionCloseType) -> void {
+        connection.onEvent(Network::ConnectionEvent::LocalClose);
+      }));
+  EXPECT_CALL(callbacks1_, onEvent(Network::ConnectionEvent::LocalClose));
+  connection.onUpstreamData(data, false);
+  EXPECT_EQ(nullptr, multiplexer_.connection(pool_, TransportType::Framed, ProtocolType::Binary));
+}
+
+TEST_F(ThriftConnectionMultiplexerTest, InvalidFrame) {
+  MultiplexedConnection& connection = addConnection(2);
+  connection.addRequest(1, callbacks1_);
+
+  Buffer::OwnedImpl data;
+  data.add("\x00\x00\x00\x00", 4);
+  EXPECT_CALL(connection_, close(Network::ConnectionCloseType::NoFlush));
+  connection.onUpstreamData(data, false);
+}
+
+TEST_F(ThriftConnectionMultiplexerTest, RemoteClose) {
+  MultiplexedConnection& connection = addConnection(3);
+  connection.addRequest(1, callbacks1_);
+  connection.addRequest(2, callbacks2_);
+
+  // Requests may stop waiting while the close is delivered.
+  EXPECT_CALL(callbacks1_, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke(
+          [&](Network::ConnectionEvent) -> void { connection.removeRequest(2, true); }));
+  EXPECT_CALL(callbacks2_, onEvent(Network::ConnectionEvent::RemoteClose));
+  connection.onEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_EQ(nullptr, multiplexer_.connection(pool_, TransportType::Framed, ProtocolType::Binary));
+
+  deleteReleasedConnections();
+  EXPECT_TRUE(released_);
+}
+
+TEST_F(ThriftConnectionMultiplexerTest, EndStream) {
+  MultiplexedConnection& connection = addConnection(2);
+  connection.addRequest(1, callbacks1_);
+
+  Buffer::OwnedImpl data;
+  EXPECT_CALL(connection_, close(Network::ConnectionCloseType::NoFlush));
+  connection.onUpstreamData(data, true);
+}
+
+} // namespace Router
+} // namespace ThriftProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -545,6 +545,77 @@ TEST_F(DecoderStateMachineTest, EmptyStruct) {
   EXPECT_EQ(dsm.currentState(), ProtocolState::Done);
 }
 
+TEST_F(DecoderStateMachineTest, PassthroughData) {
+  Buffer::OwnedImpl buffer;
+  buffer.add("begin");
+  InSequence dummy;
+
+  metadata_->setFrameSize(15);
+  EXPECT_CALL(proto_, readMessageBegin(Ref(buffer), _))
+      .WillOnce(Invoke([&](Buffer::Instance& data, MessageMetadata& metadata) -> bool {
+        data.drain(5);
+        metadata.setMethodName("name");
+        metadata.setMessageType(MessageType::Call);
+        metadata.setSequenceId(100);
+        return true;
+      }));
+  EXPECT_CALL(handler_, messageBegin(_)).WillOnce(Return(FilterStatus::Continue));
+  EXPECT_CALL(handler_, passthroughEnabled()).WillOnce(Return(true));
+
+  DecoderStateMachine dsm(proto_, metadata_, handler_);
+
+  // The body is only handed over once all of it is available.
+  buffer.add("01234");
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::WaitForData);
+  EXPECT_EQ(dsm.currentState(), ProtocolState::PassthroughData);
+
+  EXPECT_CALL(proto_, readStructBegin(_, _)).Times(0);
+  EXPECT_CALL(handler_, passthroughData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& data) -> FilterStatus {
+        EXPECT_EQ("0123456789", data.toString());
+        return FilterStatus::Continue;
+      }));
+  EXPECT_CALL(proto_, readMessageEnd(Ref(buffer))).WillOnce(Return(true));
+  EXPECT_CALL(handler_, messageEnd()).WillOnce(Return(FilterStatus::Continue));
+
+  buffer.add("56789extra");
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::Done);
+  EXPECT_EQ(dsm.currentState(), ProtocolState::Done);
+  EXPECT_EQ("extra", buffer.toString());
+}
+
+TEST_F(DecoderStateMachineTest, PassthroughDataInvalidFrameSize) {
+  Buffer::OwnedImpl buffer;
+  buffer.add("begin");
+
+  metadata_->setFrameSize(4);
+  EXPECT_CALL(proto_, readMessageBegin(Ref(buffer), _))
+      .WillOnce(Invoke([&](Buffer::Instance& data, MessageMetadata&) -> bool {
+        data.drain(5);
+        return true;
+      }));
+  EXPECT_CALL(handler_, passthroughEnabled()).WillOnce(Return(true));
+
+  DecoderStateMachine dsm(proto_, metadata_, handler_);
+
+  EXPECT_THROW_WITH_MESSAGE(dsm.run(buffer), EnvoyException,
+                            "invalid thrift frame size 4 for message of 5 bytes");
+}
+
+TEST_F(DecoderStateMachineTest, PassthroughDisabledWithoutFrameSize) {
+  Buffer::OwnedImpl buffer;
+  InSequence dummy;
+
+  EXPECT_CALL(proto_, readMessageBegin(Ref(buffer), _)).WillOnce(Return(true));
+  EXPECT_CALL(handler_, passthroughEnabled()).Times(0);
+  EXPECT_CALL(proto_, readStructBegin(Ref(buffer), _)).WillOnce(Return(false));
+
+  DecoderStateMachine dsm(proto_, metadata_, handler_);
+
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::WaitForData);
+  EXPECT_EQ(dsm.currentState(), ProtocolState::StructBegin);
+}
+
 TEST_P(DecoderStateMachineValueTest, SingleFieldStruct) {
   FieldType field_type = GetParam();
   Buffer::OwnedImpl buffer;
@@ -749,6 +820,7 @@ TEST(DecoderTest, OnData) {
         EXPECT_EQ(100U, metadata->sequenceId());
         return FilterStatus::Continue;
       }));
+  EXPECT_CALL(handler, passthroughEnabled()).WillOnce(Return(false));
 
   EXPECT_CALL(proto, readStructBegin(Ref(buffer), _)).WillOnce(Return(true));
   EXPECT_CALL(handler, structBegin(absl::string_view())).WillOnce(Return(FilterStatus::Continue));
@@ -816,6 +888,7 @@ TEST(DecoderTest, OnDataWithProtocolHint) {
         EXPECT_EQ(100U, metadata->sequenceId());
         return FilterStatus::Continue;
       }));
+  EXPECT_CALL(handler, passthroughEnabled()).WillOnce(Return(false));
 
   EXPECT_CALL(proto, readStructBegin(Ref(buffer), _)).WillOnce(Return(true));
   EXPECT_CALL(handler, structBegin(absl::string_view())).WillOnce(Return(FilterStatus::Continue));
@@ -1058,6 +1131,7 @@ TEST(DecoderTest, OnDataHandlesStopIterationAndResumes) {
         EXPECT_EQ(100U, metadata->sequenceId());
         return FilterStatus::StopIteration;
       }));
+  EXPECT_CALL(handler, passthroughEnabled()).WillOnce(Return(false));
   EXPECT_EQ(FilterStatus::StopIteration, decoder.onData(buffer, underflow));
   EXPECT_FALSE(underflow);
 
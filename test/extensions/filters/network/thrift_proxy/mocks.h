@@ -32,6 +32,7 @@ public:
   MOCK_METHOD0(stats, ThriftFilterStats&());
   MOCK_METHOD1(createDecoder, DecoderPtr(DecoderCallbacks&));
   MOCK_METHOD0(routerConfig, Router::Config&());
+  MOCK_CONST_METHOD0(payloadPassthrough, bool());
 };
 
 class MockTransport : public Transport {
@@ -152,6 +153,8 @@ public:
   MOCK_METHOD0(listEnd, FilterStatus());
   MOCK_METHOD2(setBegin, FilterStatus(FieldType elem_type, uint32_t size));
   MOCK_METHOD0(setEnd, FilterStatus());
+  MOCK_CONST_METHOD0(passthroughEnabled, bool());
+  MOCK_METHOD1(passthroughData, FilterStatus(Buffer::Instance& data));
 };
 
 class MockDirectResponse : public DirectResponse {
@@ -207,6 +210,8 @@ public:
   MOCK_METHOD0(listEnd, FilterStatus());
   MOCK_METHOD2(setBegin, FilterStatus(FieldType elem_type, uint32_t size));
   MOCK_METHOD0(setEnd, FilterStatus());
+  MOCK_CONST_METHOD0(passthroughEnabled, bool());
+  MOCK_METHOD1(passthroughData, FilterStatus(Buffer::Instance& data));
 };
 
 class MockDecoderFilterCallbacks : public DecoderFilterCallbacks {
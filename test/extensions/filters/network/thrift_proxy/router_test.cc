@@ -86,7 +86,7 @@ public:
     route_ = new NiceMock<MockRoute>();
     route_ptr_.reset(route_);
 
-    router_.reset(new Router(context_.clusterManager()));
+    router_.reset(new Router(context_.clusterManager(), multiplexer_));
 
     EXPECT_EQ(nullptr, router_->downstreamConnection());
 
@@ -306,6 +306,7 @@ public:
   NiceMock<MockRouteEntry> route_entry_;
   NiceMock<Upstream::MockHostDescription>* host_{};
   Tcp::ConnectionPool::ConnectionStatePtr conn_state_;
+  ConnectionMultiplexer multiplexer_;
 
   RouteConstSharedPtr route_ptr_;
   std::unique_ptr<Router> router_;
@@ -616,7 +617,9 @@ TEST_F(ThriftRouterTest, ProtocolUpgrade) {
       .WillOnce(Invoke(
           [&](Tcp::ConnectionPool::ConnectionStatePtr& cs) -> void { conn_state_.swap(cs); }));
 
-  EXPECT_CALL(*protocol_, supportsUpgrade()).WillOnce(Return(true));
+  EXPECT_CALL(*protocol_, supportsUpgrade())
+      .WillOnce(Return(true))
+      .WillRepeatedly(Return(false));
 
   MockThriftObject* upgrade_response = new NiceMock<MockThriftObject>();
 
@@ -669,7 +672,9 @@ TEST_F(ThriftRouterTest, ProtocolUpgradeSkippedOnExistingConnection) {
       .WillRepeatedly(
           Invoke([&]() -> Tcp::ConnectionPool::ConnectionState* { return conn_state_.get(); }));
 
-  EXPECT_CALL(*protocol_, supportsUpgrade()).WillOnce(Return(true));
+  EXPECT_CALL(*protocol_, supportsUpgrade())
+      .WillOnce(Return(true))
+      .WillRepeatedly(Return(false));
 
   // Protocol determines that connection state shows upgrade already occurred
   EXPECT_CALL(*protocol_, attemptUpgrade(_, _, _))
@@ -733,6 +738,40 @@ TEST_F(ThriftRouterTest, CallWithExistingConnection) {
   destroyRouter();
 }
 
+TEST_F(ThriftRouterTest, PassthroughData) {
+  initializeRouter();
+  EXPECT_FALSE(router_->passthroughEnabled());
+
+  startRequestWithExistingConnection(MessageType::Call);
+
+  EXPECT_CALL(callbacks_, downstreamProtocolType()).WillOnce(Return(ProtocolType::Compact));
+  EXPECT_FALSE(router_->passthroughEnabled());
+  EXPECT_CALL(callbacks_, downstreamProtocolType()).WillOnce(Return(ProtocolType::Binary));
+  EXPECT_CALL(*protocol_, supportsUpgrade())
+      .WillOnce(Return(true))
+      .WillRepeatedly(Return(false));
+  EXPECT_FALSE(router_->passthroughEnabled());
+  EXPECT_CALL(callbacks_, downstreamProtocolType()).WillOnce(Return(ProtocolType::Binary));
+  EXPECT_TRUE(router_->passthroughEnabled());
+
+  Buffer::OwnedImpl body("body");
+  EXPECT_EQ(FilterStatus::Continue, router_->passthroughData(body));
+  EXPECT_EQ(0UL, body.length());
+
+  EXPECT_CALL(*protocol_, writeMessageEnd(_));
+  EXPECT_CALL(*transport_, encodeFrame(_, _, _))
+      .WillOnce(Invoke([&](Buffer::Instance&, const MessageMetadata&,
+                           Buffer::Instance& message) -> void {
+        EXPECT_EQ("body", message.toString());
+      }));
+  EXPECT_CALL(upstream_connection_, write(_, false));
+  EXPECT_EQ(FilterStatus::Continue, router_->messageEnd());
+  EXPECT_EQ(FilterStatus::Continue, router_->transportEnd());
+
+  returnResponse();
+  destroyRouter();
+}
+
 TEST_P(ThriftRouterContainerTest, DecoderFilterCallbacks) {
   FieldType field_type = GetParam();
 
@@ -0,0 +1,202 @@
+#include <sys/socket.h>
+
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/network/address_impl.h"
+#include "common/network/listen_socket_impl.h"
+#include "common/network/utility.h"
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/udp/udp_proxy/udp_proxy_filter.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/network_utility.h"
+#include "test/test_common/test_time.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace UdpFilters {
+namespace UdpProxy {
+namespace {
+
+class UdpProxyFilterTest : public testing::TestWithParam<Network::Address::IpVersion> {
+public:
+  UdpProxyFilterTest()
+      : dispatcher_(test_time_.timeSystem()),
+        upstream_socket_(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr, true) {
+    ON_CALL(callbacks_.udp_listener_, dispatcher()).WillByDefault(ReturnRef(dispatcher_));
+    ON_CALL(*cluster_manager_.thread_local_cluster_.lb_.host_, address())
+        .WillByDefault(Return(upstream_socket_.localAddress()));
+  }
+
+  void setup(const std::string& yaml) {
+    envoy::config::filter::udp::udp_proxy::v2alpha::UdpProxyConfig proto_config;
+    MessageUtil::loadFromYaml(yaml, proto_config);
+    config_ = std::make_shared<const UdpProxyFilterConfig>(cluster_manager_, store_, proto_config);
+    filter_ = std::make_unique<UdpProxyFilter>(callbacks_, config_);
+  }
+
+  void recvDataFromDownstream(const std::string& peer_address, const std::string& data) {
+    Network::UdpRecvData recv_data;
+    recv_data.local_address_ = Network::Test::getCanonicalLoopbackAddress(GetParam());
+    recv_data.peer_address_ = Network::Utility::parseInternetAddressAndPort(peer_address);
+    recv_data.buffer_ = std::make_unique<Buffer::OwnedImpl>(data);
+    filter_->onData(recv_data);
+  }
+
+  // Receive a datagram on the upstream socket, returning the address of the session it was sent
+  // from.
+  Network::Address::InstanceConstSharedPtr recvDataOnUpstream(const std::string& expected) {
+    char received[64];
+    sockaddr_storage address;
+    socklen_t address_length = sizeof(address);
+    const ssize_t rc = ::recvfrom(upstream_socket_.fd(), received, sizeof(received), 0,
+                                  reinterpret_cast<sockaddr*>(&address), &address_length);
+    EXPECT_EQ(expected, std::string(received, rc > 0 ? rc : 0));
+    return Network::Address::addressFromSockAddr(address, address_length);
+  }
+
+  void sendDataFromUpstream(const Network::Address::Instance& session_address,
+                            const std::string& data) {
+    iovec iov{const_cast<char*>(data.data()), data.size()};
+    EXPECT_EQ(static_cast<ssize_t>(data.size()),
+              session_address.sendTo(upstream_socket_.fd(), &iov, 1).rc_);
+  }
+
+  uint64_t counter(const std::string& name) { return store_.counter("udp.test." + name).value(); }
+
+  DangerousDeprecatedTestTime test_time_;
+  Event::DispatcherImpl dispatcher_;
+  Network::UdpListenSocket upstream_socket_;
+  Stats::IsolatedStoreImpl store_;
+  NiceMock<Upstream::MockClusterManager> cluster_manager_;
+  NiceMock<Network::MockUdpReadFilterCallbacks> callbacks_;
+  UdpProxyFilterConfigSharedPtr config_;
+  std::unique_ptr<UdpProxyFilter> filter_;
+};
+
+INSTANTIATE_TEST_CASE_P(IpVersions, UdpProxyFilterTest,
+                        testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                        TestUtility::ipTestParamsToString);
+
+// The datagrams of a peer share a session, and the replies read in one batch are sent back to the
+// peer with a single sendBatch().
+TEST_P(UdpProxyFilterTest, ForwardAndReplyInBatches) {
+  setup(R"EOF(
+stat_prefix: test
+cluster: fake_cluster
+)EOF");
+
+  recvDataFromDownstream("10.0.0.1:1000", "hello");
+  recvDataFromDownstream("10.0.0.1:1000", "world");
+  EXPECT_EQ(1, filter_->numSessions());
+  EXPECT_EQ(1, counter("downstream_sess_total"));
+  EXPECT_EQ(2, counter("downstream_sess_rx_datagrams"));
+  EXPECT_EQ(1, store_.gauge("udp.test.downstream_sess_active").value());
+
+  const Network::Address::InstanceConstSharedPtr session_address = recvDataOnUpstream("hello");
+  EXPECT_EQ(session_address->asString(), recvDataOnUpstream("world")->asString());
+
+  sendDataFromUpstream(*session_address, "reply1");
+  sendDataFromUpstream(*session_address, "reply2");
+  EXPECT_CALL(callbacks_.udp_listener_, sendBatch(_, _, 2))
+      .WillOnce(Invoke([](const Network::Address::Instance& peer_address,
+                          const Buffer::RawSlice* datagrams, uint64_t) -> Api::SysCallIntResult {
+        EXPECT_EQ("10.0.0.1:1000", peer_address.asString());
+        EXPECT_EQ("reply1", std::string(static_cast<char*>(datagrams[0].mem_), datagrams[0].len_));
+        EXPECT_EQ("reply2", std::string(static_cast<char*>(datagrams[1].mem_), datagrams[1].len_));
+        return {1, 0};
+      }));
+  dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(1, counter("downstream_sess_tx_datagrams"));
+  EXPECT_EQ(1, counter("downstream_sess_tx_errors"));
+
+  filter_.reset();
+  EXPECT_EQ(0, store_.gauge("udp.test.downstream_sess_active").value());
+}
+
+// Each peer gets its own session, and the hash key for host selection depends only on the IP
+// address of the peer.
+TEST_P(UdpProxyFilterTest, SessionPerPeer) {
+  setup(R"EOF(
+stat_prefix: test
+cluster: fake_cluster
+)EOF");
+
+  std::vector<absl::optional<uint64_t>> hashes;
+  EXPECT_CALL(cluster_manager_.thread_local_cluster_.lb_, chooseHost(_))
+      .Times(3)
+      .WillRepeatedly(Invoke([&](Upstream::LoadBalancerContext* context) {
+        hashes.push_back(context->computeHashKey());
+        return cluster_manager_.thread_local_cluster_.lb_.host_;
+      }));
+  recvDataFromDownstream("10.0.0.1:1000", "a");
+  recvDataFromDownstream("10.0.0.1:1001", "b");
+  recvDataFromDownstream("10.0.0.2:1000", "c");
+  recvDataFromDownstream("10.0.0.1:1000", "d");
+  EXPECT_EQ(3, filter_->numSessions());
+  EXPECT_EQ(3, counter("downstream_sess_total"));
+
+  ASSERT_EQ(3, hashes.size());
+  EXPECT_TRUE(hashes[0].has_value());
+  EXPECT_EQ(hashes[0], hashes[1]);
+  EXPECT_NE(hashes[0], hashes[2]);
+}
+
+// Datagrams are dropped without a session if there is no cluster or no healthy host.
+TEST_P(UdpProxyFilterTest, NoHealthyHost) {
+  setup(R"EOF(
+stat_prefix: test
+cluster: fake_cluster
+)EOF");
+
+  EXPECT_CALL(cluster_manager_.thread_local_cluster_.lb_, chooseHost(_)).WillOnce(Return(nullptr));
+  recvDataFromDownstream("10.0.0.1:1000", "hello");
+  EXPECT_CALL(cluster_manager_, get("fake_cluster")).WillOnce(Return(nullptr));
+  recvDataFromDownstream("10.0.0.1:1000", "hello");
+  EXPECT_EQ(0, filter_->numSessions());
+  EXPECT_EQ(2, counter("downstream_sess_no_healthy_host"));
+  EXPECT_EQ(0, counter("downstream_sess_total"));
+}
+
+// A session without traffic is closed after the idle timeout.
+TEST_P(UdpProxyFilterTest, IdleTimeout) {
+  setup(R"EOF(
+stat_prefix: test
+cluster: fake_cluster
+idle_timeout: 0.001s
+)EOF");
+
+  recvDataFromDownstream("10.0.0.1:1000", "hello");
+  EXPECT_EQ(1, filter_->numSessions());
+  while (filter_->numSessions() != 0) {
+    dispatcher_.run(Event::Dispatcher::RunType::NonBlock);
+  }
+  EXPECT_EQ(1, counter("idle_timeout"));
+  EXPECT_EQ(0, store_.gauge("udp.test.downstream_sess_active").value());
+
+  // The next datagram of the peer opens a new session.
+  recvDataFromDownstream("10.0.0.1:1000", "hello");
+  EXPECT_EQ(2, counter("downstream_sess_total"));
+}
+
+} // namespace
+} // namespace UdpProxy
+} // namespace UdpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -95,6 +95,28 @@ public:
                                Upstream::HealthCheckEventLoggerPtr(event_logger_), *this));
   }
 
+  void setupSkipProbeOnTraffic() {
+    const std::string yaml = R"EOF(
+    timeout: 1s
+    interval: 1s
+    no_traffic_interval: 5s
+    interval_jitter: 1s
+    unhealthy_threshold: 1
+    healthy_threshold: 1
+    custom_health_check:
+      name: envoy.health_checkers.redis
+      config:
+        skip_probe_on_traffic: true
+    )EOF";
+
+    const auto& hc_config = Upstream::parseHealthCheckFromV2Yaml(yaml);
+    const auto& redis_config = getRedisHealthCheckConfig(hc_config);
+
+    health_checker_.reset(
+        new RedisHealthChecker(*cluster_, hc_config, redis_config, dispatcher_, runtime_, random_,
+                               Upstream::HealthCheckEventLoggerPtr(event_logger_), *this));
+  }
+
   Extensions::NetworkFilters::RedisProxy::ConnPool::ClientPtr
   create(Upstream::HostConstSharedPtr, Event::Dispatcher&,
          const Extensions::NetworkFilters::RedisProxy::ConnPool::Config&) override {
@@ -259,6 +281,63 @@ TEST_F(RedisHealthCheckerTest, Exists) {
   EXPECT_EQ(2UL, cluster_->info_->stats_store_.counter("health_check.failure").value());
 }
 
+// Tests that hosts answering proxied commands are not sent PINGs.
+TEST_F(RedisHealthCheckerTest, SkipProbeOnTraffic) {
+  InSequence s;
+  setupSkipProbeOnTraffic();
+
+  Upstream::HostSharedPtr host = Upstream::makeTestHost(cluster_->info_, "tcp://127.0.0.1:80");
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {host};
+
+  expectSessionCreate();
+  Event::MockTimer* skipped_check_timer = new Event::MockTimer(&dispatcher_);
+  expectClientCreate();
+  expectPingRequestCreate();
+  health_checker_->start();
+
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_));
+  Extensions::NetworkFilters::RedisProxy::RespValuePtr response(
+      new Extensions::NetworkFilters::RedisProxy::RespValue());
+  response->type(Extensions::NetworkFilters::RedisProxy::RespType::SimpleString);
+  response->asString() = "PONG";
+  pool_callbacks_->onResponse(std::move(response));
+
+  // Proxied commands succeeded, so the check passes without a PING.
+  host->stats().rq_success_.inc();
+  EXPECT_CALL(*skipped_check_timer, enableTimer(std::chrono::milliseconds(0)));
+  EXPECT_CALL(*timeout_timer_, enableTimer(_));
+  interval_timer_->callback_();
+
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_));
+  skipped_check_timer->callback_();
+
+  // Without proxied commands since, the host is sent a PING.
+  expectPingRequestCreate();
+  interval_timer_->callback_();
+
+  EXPECT_CALL(*timeout_timer_, disableTimer());
+  EXPECT_CALL(*interval_timer_, enableTimer(_));
+  response.reset(new Extensions::NetworkFilters::RedisProxy::RespValue());
+  response->type(Extensions::NetworkFilters::RedisProxy::RespType::SimpleString);
+  response->asString() = "PONG";
+  pool_callbacks_->onResponse(std::move(response));
+
+  // A proxied command timed out, so the host is sent a PING.
+  host->stats().rq_success_.inc();
+  host->stats().rq_timeout_.inc();
+  expectPingRequestCreate();
+  interval_timer_->callback_();
+
+  // Shutdown with active request.
+  EXPECT_CALL(pool_request_, cancel());
+  EXPECT_CALL(*client_, close());
+
+  EXPECT_EQ(4UL, cluster_->info_->stats_store_.counter("health_check.attempt").value());
+  EXPECT_EQ(3UL, cluster_->info_->stats_store_.counter("health_check.success").value());
+}
+
 // Tests that redis client will behave appropriately when reuse_connection is false.
 TEST_F(RedisHealthCheckerTest, NoConnectionReuse) {
   InSequence s;
@@ -0,0 +1,114 @@
+#include "extensions/resource_monitors/cgroup_memory/cgroup_memory_monitor.h"
+
+#include "test/test_common/environment.h"
+
+#include "absl/types/optional.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace CgroupMemoryMonitor {
+
+class MockCgroupMemoryStatsReader : public CgroupMemoryStatsReader {
+public:
+  MockCgroupMemoryStatsReader() : CgroupMemoryStatsReader("/nonexistent") {}
+
+  MOCK_METHOD0(workingSetBytes, uint64_t());
+  MOCK_METHOD0(limitBytes, absl::optional<uint64_t>());
+};
+
+class ResourcePressure : public Server::ResourceMonitor::Callbacks {
+public:
+  void onSuccess(const Server::ResourceUsage& usage) override {
+    pressure_ = usage.resource_pressure_;
+  }
+
+  void onFailure(const EnvoyException& error) override { error_ = error; }
+
+  bool hasPressure() const { return pressure_.has_value(); }
+  bool hasError() const { return error_.has_value(); }
+
+  double pressure() const { return *pressure_; }
+
+private:
+  absl::optional<double> pressure_;
+  absl::optional<EnvoyException> error_;
+};
+
+TEST(CgroupMemoryMonitorTest, ComputesCorrectUsage) {
+  envoy::config::resource_monitor::cgroup_memory::v2alpha::CgroupMemoryConfig config;
+  auto stats_reader = std::make_unique<MockCgroupMemoryStatsReader>();
+  EXPECT_CALL(*stats_reader, limitBytes()).WillOnce(testing::Return(1000));
+  EXPECT_CALL(*stats_reader, workingSetBytes()).WillOnce(testing::Return(700));
+  CgroupMemoryMonitor monitor(config, std::move(stats_reader));
+
+  ResourcePressure resource;
+  monitor.updateResourceUsage(resource);
+  EXPECT_TRUE(resource.hasPressure());
+  EXPECT_FALSE(resource.hasError());
+  EXPECT_EQ(resource.pressure(), 0.7);
+}
+
+TEST(CgroupMemoryMonitorTest, MaxMemoryBoundsLimit) {
+  envoy::config::resource_monitor::cgroup_memory::v2alpha::CgroupMemoryConfig config;
+  config.set_max_memory_bytes(800);
+  auto stats_reader = std::make_unique<MockCgroupMemoryStatsReader>();
+  EXPECT_CALL(*stats_reader, limitBytes()).WillOnce(testing::Return(1000));
+  EXPECT_CALL(*stats_reader, workingSetBytes()).WillOnce(testing::Return(400));
+  CgroupMemoryMonitor monitor(config, std::move(stats_reader));
+
+  ResourcePressure resource;
+  monitor.updateResourceUsage(resource);
+  EXPECT_EQ(resource.pressure(), 0.5);
+}
+
+TEST(CgroupMemoryMonitorTest, Unlimited) {
+  envoy::config::resource_monitor::cgroup_memory::v2alpha::CgroupMemoryConfig config;
+  auto stats_reader = std::make_unique<MockCgroupMemoryStatsReader>();
+  EXPECT_CALL(*stats_reader, limitBytes()).WillOnce(testing::Return(absl::nullopt));
+  CgroupMemoryMonitor monitor(config, std::move(stats_reader));
+
+  ResourcePressure resource;
+  monitor.updateResourceUsage(resource);
+  EXPECT_FALSE(resource.hasPressure());
+  EXPECT_TRUE(resource.hasError());
+}
+
+TEST(CgroupMemoryStatsReaderTest, CgroupV2) {
+  TestEnvironment::writeStringToFileForTest("cgroup_v2/memory.current", "1000\n");
+  TestEnvironment::writeStringToFileForTest("cgroup_v2/memory.max", "2000\n");
+  TestEnvironment::writeStringToFileForTest("cgroup_v2/memory.stat",
+                                            "anon 600\nfile 400\ninactive_file 300\n");
+  CgroupMemoryStatsReader reader(TestEnvironment::temporaryPath("cgroup_v2"));
+  EXPECT_EQ(700, reader.workingSetBytes());
+  EXPECT_EQ(2000, reader.limitBytes().value());
+
+  TestEnvironment::writeStringToFileForTest("cgroup_v2/memory.max", "max\n");
+  EXPECT_FALSE(reader.limitBytes().has_value());
+}
+
+TEST(CgroupMemoryStatsReaderTest, CgroupV1) {
+  TestEnvironment::writeStringToFileForTest("cgroup_v1/memory/memory.usage_in_bytes", "1000\n");
+  TestEnvironment::writeStringToFileForTest("cgroup_v1/memory/memory.limit_in_bytes", "2000\n");
+  TestEnvironment::writeStringToFileForTest(
+      "cgroup_v1/memory/memory.stat", "inactive_file 100\ntotal_inactive_file 200\n");
+  CgroupMemoryStatsReader reader(TestEnvironment::temporaryPath("cgroup_v1"));
+  EXPECT_EQ(800, reader.workingSetBytes());
+  EXPECT_EQ(2000, reader.limitBytes().value());
+
+  TestEnvironment::writeStringToFileForTest("cgroup_v1/memory/memory.limit_in_bytes",
+                                            "9223372036854771712\n");
+  EXPECT_FALSE(reader.limitBytes().has_value());
+}
+
+TEST(CgroupMemoryStatsReaderTest, MissingFiles) {
+  CgroupMemoryStatsReader reader(TestEnvironment::temporaryPath("cgroup_missing"));
+  EXPECT_THROW(reader.workingSetBytes(), EnvoyException);
+}
+
+} // namespace CgroupMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,34 @@
+#include "envoy/config/resource_monitor/cgroup_memory/v2alpha/cgroup_memory.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "server/resource_monitor_config_impl.h"
+
+#include "extensions/resource_monitors/cgroup_memory/config.h"
+
+#include "test/mocks/event/mocks.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace CgroupMemoryMonitor {
+
+TEST(CgroupMemoryMonitorFactoryTest, CreateMonitor) {
+  auto factory =
+      Registry::FactoryRegistry<Server::Configuration::ResourceMonitorFactory>::getFactory(
+          "envoy.resource_monitors.cgroup_memory");
+  EXPECT_NE(factory, nullptr);
+
+  envoy::config::resource_monitor::cgroup_memory::v2alpha::CgroupMemoryConfig config;
+  config.set_max_memory_bytes(std::numeric_limits<uint64_t>::max());
+  Event::MockDispatcher dispatcher;
+  Server::Configuration::ResourceMonitorFactoryContextImpl context(dispatcher);
+  auto monitor = factory->createResourceMonitor(config, context);
+  EXPECT_NE(monitor, nullptr);
+}
+
+} // namespace CgroupMemoryMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
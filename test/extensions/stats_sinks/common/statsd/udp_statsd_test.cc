@@ -15,6 +15,8 @@
 #include "gtest/gtest.h"
 #include "spdlog/spdlog.h"
 
+using testing::_;
+using testing::ElementsAre;
 using testing::NiceMock;
 
 namespace Envoy {
@@ -26,6 +28,7 @@ namespace Statsd {
 class MockWriter : public Writer {
 public:
   MOCK_METHOD1(write, void(const std::string& message));
+  MOCK_METHOD1(writeBatch, void(const std::vector<std::string>& messages));
 };
 
 class UdpStatsdSinkTest : public testing::TestWithParam<Network::Address::IpVersion> {};
@@ -134,7 +137,7 @@ TEST(UdpStatsdSinkTest, CheckActualStats) {
   source.counters_.push_back(counter);
 
   EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
-              write("envoy.test_counter:1|c"));
+              writeBatch(ElementsAre("envoy.test_counter:1|c")));
   sink.flush(source);
   counter->used_ = false;
 
@@ -145,7 +148,7 @@ TEST(UdpStatsdSinkTest, CheckActualStats) {
   source.gauges_.push_back(gauge);
 
   EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
-              write("envoy.test_gauge:1|g"));
+              writeBatch(ElementsAre("envoy.test_gauge:1|g")));
   sink.flush(source);
 
   NiceMock<Stats::MockHistogram> timer;
@@ -172,7 +175,7 @@ TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   source.counters_.push_back(counter);
 
   EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
-              write("envoy.test_counter:1|c|#key1:value1,key2:value2"));
+              writeBatch(ElementsAre("envoy.test_counter:1|c|#key1:value1,key2:value2")));
   sink.flush(source);
   counter->used_ = false;
 
@@ -184,7 +187,7 @@ TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   source.gauges_.push_back(gauge);
 
   EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
-              write("envoy.test_gauge:1|g|#key1:value1,key2:value2"));
+              writeBatch(ElementsAre("envoy.test_gauge:1|g|#key1:value1,key2:value2")));
   sink.flush(source);
 
   NiceMock<Stats::MockHistogram> timer;
@@ -197,6 +200,48 @@ TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   tls_.shutdownThread();
 }
 
+TEST(UdpStatsdSinkTest, PackDatagrams) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  // Fits two of the 22 byte counter messages and the newline between them.
+  UdpStatsdSink sink(tls_, writer_ptr, false, getDefaultPrefix(), 45);
+
+  for (const std::string& name : {"test_counter", "test_count_2", "test_count_3"}) {
+    auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+    counter->name_ = name;
+    counter->used_ = true;
+    counter->latch_ = 1;
+    source.counters_.push_back(counter);
+  }
+
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "test_gauge_with_a_name_longer_than_a_datagram";
+  gauge->value_ = 1;
+  gauge->used_ = true;
+  source.gauges_.push_back(gauge);
+
+  EXPECT_CALL(*writer_ptr,
+              writeBatch(ElementsAre("envoy.test_counter:1|c\nenvoy.test_count_2:1|c",
+                                     "envoy.test_count_3:1|c",
+                                     "envoy.test_gauge_with_a_name_longer_than_a_datagram:1|g")));
+  sink.flush(source);
+
+  tls_.shutdownThread();
+}
+
+TEST(UdpStatsdSinkTest, NothingToFlush) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  UdpStatsdSink sink(tls_, writer_ptr, false);
+
+  EXPECT_CALL(*writer_ptr, writeBatch(_)).Times(0);
+  sink.flush(source);
+
+  tls_.shutdownThread();
+}
+
 } // namespace Statsd
 } // namespace Common
 } // namespace StatSinks
@@ -9,6 +9,7 @@
 #include "test/mocks/stats/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 
+#include "absl/strings/match.h"
 #include "absl/strings/str_split.h"
 #include "circllhist.h"
 #include "fmt/printf.h"
@@ -372,6 +373,36 @@ TEST_F(HystrixSinkTest, Disconnect) {
   EXPECT_EQ(json_buffer->getInteger("rollingCountSuccess"), 0);
 }
 
+TEST_F(HystrixSinkTest, MultipleConnections) {
+  Buffer::OwnedImpl buffer = createClusterAndCallbacks();
+  sink_->registerConnection(&callbacks_);
+
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> callbacks2;
+  Buffer::OwnedImpl buffer2;
+  ON_CALL(callbacks2, encodeData(_, _))
+      .WillByDefault(Invoke([&buffer2](Buffer::Instance& data, bool) { buffer2.move(data); }));
+  // Connections are unregistered by stream id.
+  ON_CALL(callbacks2, streamId()).WillByDefault(Return(1));
+  sink_->registerConnection(&callbacks2);
+
+  ON_CALL(cluster1_.success_counter_, value()).WillByDefault(Return(7));
+  sink_->flush(source_);
+
+  // Both connections are sent the same event, followed by the keep alive ping.
+  EXPECT_NE(0, buffer.length());
+  EXPECT_EQ(buffer.toString(), buffer2.toString());
+  EXPECT_TRUE(absl::EndsWith(buffer2.toString(), "}\n\n:\n\n"));
+
+  // The buffer of a connection keeps its event alive across later flushes.
+  buffer.drain(buffer.length());
+  sink_->unregisterConnection(&callbacks2);
+  sink_->flush(source_);
+  std::unordered_map<std::string, std::string> cluster_message_map =
+      buildClusterMap(buffer2.toString());
+  ASSERT_NE(cluster_message_map.find(cluster1_name_), cluster_message_map.end());
+  EXPECT_NE(0, buffer.length());
+}
+
 TEST_F(HystrixSinkTest, AddCluster) {
   InSequence s;
   // Register callback to sink.
@@ -543,6 +574,38 @@ TEST_F(HystrixSinkTest, HystrixEventStreamHandler) {
   EXPECT_THAT(access_control_allow_headers, HasSubstr("Accept"));
 }
 
+TEST(ClusterStatsCacheTest, RollingWindow) {
+  const uint64_t window_size = 4;
+  ClusterStatsCache cache("cluster", window_size);
+
+  // The first values fill the window.
+  uint64_t index = 0;
+  cache.pushNewValues(index, {10, 1, 2, 3, 16});
+  EXPECT_EQ(0, cache.getRollingValue(RollingStat::Success, index));
+
+  for (uint64_t i = 1; i <= 2 * window_size; i++) {
+    index = (index + 1) % window_size;
+    cache.pushNewValues(index, {10 + 5 * i, 1 + i, 2, 3, 16 + 6 * i});
+  }
+
+  // The window holds window_size values, the difference spans window_size - 1 flushes.
+  EXPECT_EQ(5 * (window_size - 1), cache.getRollingValue(RollingStat::Success, index));
+  EXPECT_EQ(window_size - 1, cache.getRollingValue(RollingStat::Errors, index));
+  EXPECT_EQ(0, cache.getRollingValue(RollingStat::Timeouts, index));
+  EXPECT_EQ(0, cache.getRollingValue(RollingStat::Rejected, index));
+  EXPECT_EQ(6 * (window_size - 1), cache.getRollingValue(RollingStat::Total, index));
+
+  // A counter reset is reported as no change.
+  index = (index + 1) % window_size;
+  cache.pushNewValues(index, {0, 0, 0, 0, 0});
+  EXPECT_EQ(0, cache.getRollingValue(RollingStat::Success, index));
+
+  std::string out;
+  cache.printToString(out);
+  EXPECT_THAT(out, HasSubstr("cluster.success | "));
+  EXPECT_THAT(out, HasSubstr("cluster.total | "));
+}
+
 } // namespace Hystrix
 } // namespace StatSinks
 } // namespace Extensions
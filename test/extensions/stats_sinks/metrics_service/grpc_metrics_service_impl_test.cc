@@ -78,21 +78,54 @@ TEST_F(GrpcMetricsStreamerImplTest, StreamFailure) {
   EXPECT_CALL(local_info_, node());
   envoy::service::metrics::v2::StreamMetricsMessage message_metrics1;
   streamer_->send(message_metrics1);
+  EXPECT_EQ(1, streamer_->streamGeneration());
+}
+
+// Test that the generation changes when the stream is closed.
+TEST_F(GrpcMetricsStreamerImplTest, StreamGeneration) {
+  InSequence s;
+
+  MockMetricsStream stream1;
+  MetricsServiceCallbacks* callbacks1;
+  expectStreamStart(stream1, &callbacks1);
+  EXPECT_CALL(local_info_, node());
+  EXPECT_CALL(stream1, sendMessage(_, false)).Times(2);
+  envoy::service::metrics::v2::StreamMetricsMessage message_metrics1;
+  streamer_->send(message_metrics1);
+  streamer_->send(message_metrics1);
+  EXPECT_EQ(0, streamer_->streamGeneration());
+
+  callbacks1->onRemoteClose(Grpc::Status::Internal, "bad");
+  EXPECT_EQ(1, streamer_->streamGeneration());
+
+  MockMetricsStream stream2;
+  MetricsServiceCallbacks* callbacks2;
+  expectStreamStart(stream2, &callbacks2);
+  EXPECT_CALL(local_info_, node());
+  EXPECT_CALL(stream2, sendMessage(_, false));
+  envoy::service::metrics::v2::StreamMetricsMessage message_metrics2;
+  streamer_->send(message_metrics2);
+  EXPECT_EQ(1, streamer_->streamGeneration());
 }
 
 class MockGrpcMetricsStreamer : public GrpcMetricsStreamer {
 public:
   // GrpcMetricsStreamer
   MOCK_METHOD1(send, void(envoy::service::metrics::v2::StreamMetricsMessage& message));
+  MOCK_METHOD0(streamGeneration, uint64_t());
 };
 
 class TestGrpcMetricsStreamer : public GrpcMetricsStreamer {
 public:
   int metric_count;
+  std::vector<envoy::service::metrics::v2::StreamMetricsMessage> messages_;
+  uint64_t stream_generation_{};
   // GrpcMetricsStreamer
-  void send(envoy::service::metrics::v2::StreamMetricsMessage& message) {
+  void send(envoy::service::metrics::v2::StreamMetricsMessage& message) override {
     metric_count = message.envoy_metrics_size();
+    messages_.push_back(message);
   }
+  uint64_t streamGeneration() override { return stream_generation_; }
 };
 
 class MetricsServiceSinkTest : public testing::Test {};
@@ -102,7 +135,7 @@ TEST(MetricsServiceSinkTest, CheckSendCall) {
   NiceMock<MockTimeSystem> mock_time;
   std::shared_ptr<MockGrpcMetricsStreamer> streamer_{new MockGrpcMetricsStreamer()};
 
-  MetricsServiceSink sink(streamer_, mock_time);
+  MetricsServiceSink sink(streamer_, mock_time, false, false, 0);
 
   auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
   counter->name_ = "test_counter";
@@ -130,7 +163,7 @@ TEST(MetricsServiceSinkTest, CheckStatsCount) {
   NiceMock<MockTimeSystem> mock_time;
   std::shared_ptr<TestGrpcMetricsStreamer> streamer_{new TestGrpcMetricsStreamer()};
 
-  MetricsServiceSink sink(streamer_, mock_time);
+  MetricsServiceSink sink(streamer_, mock_time, false, false, 0);
 
   auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
   counter->name_ = "test_counter";
@@ -153,6 +186,100 @@ TEST(MetricsServiceSinkTest, CheckStatsCount) {
   EXPECT_EQ(1, (*streamer_).metric_count);
 }
 
+class MetricsServiceSinkOptionsTest : public testing::Test {
+public:
+  void addCounter(const std::string& name, uint64_t latch) {
+    auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+    counter->name_ = name;
+    counter->value_ = 100;
+    counter->latch_ = latch;
+    counter->used_ = true;
+    source_.counters_.push_back(counter);
+  }
+
+  void addGauge(const std::string& name) {
+    auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+    gauge->name_ = name;
+    gauge->value_ = 1;
+    gauge->used_ = true;
+    source_.gauges_.push_back(gauge);
+  }
+
+  NiceMock<Stats::MockSource> source_;
+  NiceMock<MockTimeSystem> mock_time_;
+  std::shared_ptr<TestGrpcMetricsStreamer> streamer_{new TestGrpcMetricsStreamer()};
+};
+
+// Counters are reported by their delta, and unchanged counters are left out.
+TEST_F(MetricsServiceSinkOptionsTest, CounterDeltas) {
+  MetricsServiceSink sink(streamer_, mock_time_, true, false, 0);
+  addCounter("changed", 3);
+  addCounter("unchanged", 0);
+
+  sink.flush(source_);
+  ASSERT_EQ(1, streamer_->messages_.size());
+  const auto& message = streamer_->messages_[0];
+  ASSERT_EQ(1, message.envoy_metrics_size());
+  EXPECT_EQ("changed", message.envoy_metrics(0).name());
+  EXPECT_EQ(3, message.envoy_metrics(0).metric(0).counter().value());
+}
+
+// Names are sent once per stream, and metrics refer to them by id.
+TEST_F(MetricsServiceSinkOptionsTest, MetricNameIds) {
+  MetricsServiceSink sink(streamer_, mock_time_, false, true, 0);
+  addCounter("counter", 1);
+  addGauge("gauge");
+
+  sink.flush(source_);
+  ASSERT_EQ(1, streamer_->messages_.size());
+  const auto& first = streamer_->messages_[0];
+  ASSERT_EQ(2, first.metric_names_size());
+  EXPECT_EQ("counter", first.metric_names(0).name());
+  EXPECT_EQ("gauge", first.metric_names(1).name());
+  ASSERT_EQ(2, first.envoy_metric_name_ids_size());
+  EXPECT_EQ(first.metric_names(0).id(), first.envoy_metric_name_ids(0));
+  EXPECT_EQ(first.metric_names(1).id(), first.envoy_metric_name_ids(1));
+  EXPECT_EQ("", first.envoy_metrics(0).name());
+
+  // Only new names are sent.
+  addGauge("gauge2");
+  sink.flush(source_);
+  ASSERT_EQ(2, streamer_->messages_.size());
+  const auto& second = streamer_->messages_[1];
+  ASSERT_EQ(1, second.metric_names_size());
+  EXPECT_EQ("gauge2", second.metric_names(0).name());
+  ASSERT_EQ(3, second.envoy_metric_name_ids_size());
+  EXPECT_EQ(first.envoy_metric_name_ids(0), second.envoy_metric_name_ids(0));
+  EXPECT_EQ(second.metric_names(0).id(), second.envoy_metric_name_ids(2));
+
+  // All the names are sent again on a new stream.
+  streamer_->stream_generation_++;
+  sink.flush(source_);
+  ASSERT_EQ(3, streamer_->messages_.size());
+  EXPECT_EQ(3, streamer_->messages_[2].metric_names_size());
+}
+
+// The metrics of a flush are split into messages of the batch size.
+TEST_F(MetricsServiceSinkOptionsTest, BatchSize) {
+  MetricsServiceSink sink(streamer_, mock_time_, false, false, 1);
+  addCounter("counter", 1);
+  addGauge("gauge");
+
+  sink.flush(source_);
+  ASSERT_EQ(2, streamer_->messages_.size());
+  ASSERT_EQ(1, streamer_->messages_[0].envoy_metrics_size());
+  EXPECT_EQ("counter", streamer_->messages_[0].envoy_metrics(0).name());
+  ASSERT_EQ(1, streamer_->messages_[1].envoy_metrics_size());
+  EXPECT_EQ("gauge", streamer_->messages_[1].envoy_metrics(0).name());
+
+  // An empty flush still sends a message.
+  source_.counters_.clear();
+  source_.gauges_.clear();
+  sink.flush(source_);
+  ASSERT_EQ(3, streamer_->messages_.size());
+  EXPECT_EQ(0, streamer_->messages_[2].envoy_metrics_size());
+}
+
 } // namespace MetricsService
 } // namespace StatSinks
 } // namespace Extensions
@@ -1,3 +1,5 @@
+#include "common/common/base64.h"
+
 #include "extensions/tracers/common/ot/opentracing_driver_impl.h"
 
 #include "test/mocks/http/mocks.h"
@@ -86,6 +88,7 @@ TEST_F(OpenTracingDriverTest, TagSamplingFalseByDecision) {
 
   Tracing::SpanPtr first_span = driver_->startSpan(config_, request_headers_, operation_name_,
                                                    start_time_, {Tracing::Reason::Sampling, false});
+  EXPECT_FALSE(first_span->sampled());
   first_span->finishSpan();
 
   const std::map<std::string, opentracing::Value> expected_tags = {
@@ -101,7 +104,9 @@ TEST_F(OpenTracingDriverTest, TagSamplingFalseByFlag) {
 
   Tracing::SpanPtr first_span = driver_->startSpan(config_, request_headers_, operation_name_,
                                                    start_time_, {Tracing::Reason::Sampling, true});
+  EXPECT_TRUE(first_span->sampled());
   first_span->setSampled(false);
+  EXPECT_FALSE(first_span->sampled());
   first_span->finishSpan();
 
   const std::map<std::string, opentracing::Value> expected_tags = {
@@ -183,6 +188,54 @@ TEST_F(OpenTracingDriverTest, ExtractWithUnindexedHeader) {
   EXPECT_EQ(spans.at(1).span_context.span_id, spans.at(0).references.at(0).span_id);
 }
 
+TEST_F(OpenTracingDriverTest, ExtractWithSingleHeader) {
+  setupValidDriver(OpenTracingDriver::PropagationMode::SingleHeader);
+
+  Tracing::SpanPtr first_span = driver_->startSpan(config_, request_headers_, operation_name_,
+                                                   start_time_, {Tracing::Reason::Sampling, true});
+  first_span->injectContext(request_headers_);
+  ASSERT_NE(nullptr, request_headers_.OtSpanContext());
+
+  Tracing::SpanPtr second_span = driver_->startSpan(config_, request_headers_, operation_name_,
+                                                    start_time_, {Tracing::Reason::Sampling, true});
+  second_span->finishSpan();
+  first_span->finishSpan();
+
+  auto spans = driver_->recorder().spans();
+  EXPECT_EQ(spans.at(1).span_context.span_id, spans.at(0).references.at(0).span_id);
+  EXPECT_EQ(0U, stats_.counter("tracing.opentracing.span_context_extraction_error").value());
+}
+
+// A single header too large to be decoded on the stack is decoded into allocated storage.
+TEST_F(OpenTracingDriverTest, ExtractWithLargeSingleHeader) {
+  setupValidDriver(OpenTracingDriver::PropagationMode::SingleHeader);
+
+  const std::string invalid_context(200, 'a');
+  request_headers_.insertOtSpanContext().value(
+      Base64::encode(invalid_context.data(), invalid_context.size()));
+  Tracing::SpanPtr span = driver_->startSpan(config_, request_headers_, operation_name_,
+                                             start_time_, {Tracing::Reason::Sampling, true});
+  span->finishSpan();
+
+  EXPECT_EQ(1U, stats_.counter("tracing.opentracing.span_context_extraction_error").value());
+}
+
+// Injecting into an inline header that is already present overwrites it.
+TEST_F(OpenTracingDriverTest, InjectOverwritesInlineHeader) {
+  opentracing::mocktracer::PropagationOptions propagation_options;
+  propagation_options.propagation_key = "x-ot-span-context";
+  setupValidDriver(OpenTracingDriver::PropagationMode::TracerNative, propagation_options);
+
+  request_headers_.insertOtSpanContext().value(std::string("stale"));
+  const size_t num_headers = request_headers_.size();
+  Tracing::SpanPtr span = driver_->startSpan(config_, request_headers_, operation_name_,
+                                             start_time_, {Tracing::Reason::Sampling, true});
+  span->injectContext(request_headers_);
+
+  EXPECT_EQ(num_headers, request_headers_.size());
+  EXPECT_NE("stale", request_headers_.get_("x-ot-span-context"));
+}
+
 } // namespace Ot
 } // namespace Common
 } // namespace Tracers
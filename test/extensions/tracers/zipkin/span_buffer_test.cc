@@ -109,6 +109,28 @@ TEST(ZipkinSpanBufferTest, sizeConstructorEndtoEnd) {
   EXPECT_EQ("[]", buffer.toStringifiedJsonArray());
 }
 
+TEST(ZipkinSpanBufferTest, fullBufferRejectsSpans) {
+  DangerousDeprecatedTestTime test_time;
+  SpanBuffer buffer(1);
+
+  EXPECT_TRUE(buffer.addSpan(Span(test_time.timeSystem())));
+  EXPECT_FALSE(buffer.addSpan(Span(test_time.timeSystem())));
+  EXPECT_EQ(1ULL, buffer.pendingSpans());
+  const std::string expected_json_array_string = "[{"
+                                                 R"("traceId":"0000000000000000",)"
+                                                 R"("name":"",)"
+                                                 R"("id":"0000000000000000",)"
+                                                 R"("annotations":[],)"
+                                                 R"("binaryAnnotations":[])"
+                                                 "}]";
+  EXPECT_EQ(expected_json_array_string, buffer.toStringifiedJsonArray());
+
+  // Space is available again once the buffer was flushed.
+  buffer.clear();
+  EXPECT_TRUE(buffer.addSpan(Span(test_time.timeSystem())));
+  EXPECT_EQ(expected_json_array_string, buffer.toStringifiedJsonArray());
+}
+
 } // namespace Zipkin
 } // namespace Tracers
 } // namespace Extensions
@@ -68,6 +68,21 @@ TEST_F(TsiFrameProtectorTest, Protect) {
   }
 }
 
+TEST_F(TsiFrameProtectorTest, ProtectMultipleSlices) {
+  // Frames span the slices of the input, as they would if it were linearized.
+  Buffer::OwnedImpl input, encrypted;
+  for (const std::string& piece : {std::string(10000, 'a'), std::string(10000, 'a')}) {
+    Buffer::OwnedImpl slice(piece);
+    input.move(slice);
+  }
+
+  EXPECT_EQ(TSI_OK, frame_protector_.protect(input, encrypted));
+  EXPECT_EQ(0, input.length());
+  std::string expected =
+      "\0\x40\0\0"s + std::string(16380, 'a') + "\x28\x0e\0\0"s + std::string(3620, 'a');
+  EXPECT_EQ(expected, encrypted.toString());
+}
+
 TEST_F(TsiFrameProtectorTest, ProtectError) {
   const tsi_frame_protector_vtable* vtable = raw_frame_protector_->vtable;
   tsi_frame_protector_vtable mock_vtable = *raw_frame_protector_->vtable;
@@ -129,6 +144,19 @@ TEST_F(TsiFrameProtectorTest, Unprotect) {
     EXPECT_EQ(std::string(20000, 'a'), decrypted.toString());
   }
 }
+TEST_F(TsiFrameProtectorTest, UnprotectMultipleSlices) {
+  // A frame split between slices is unprotected once its last slice is.
+  Buffer::OwnedImpl input, decrypted;
+  for (const std::string& piece : {"\x0a\0\0"s, "\0foo"s, "bar\x07\0\0\0baz"s}) {
+    Buffer::OwnedImpl slice(piece);
+    input.move(slice);
+  }
+
+  EXPECT_EQ(TSI_OK, frame_protector_.unprotect(input, decrypted));
+  EXPECT_EQ(0, input.length());
+  EXPECT_EQ("foobarbaz", decrypted.toString());
+}
+
 TEST_F(TsiFrameProtectorTest, UnprotectError) {
   const tsi_frame_protector_vtable* vtable = raw_frame_protector_->vtable;
   tsi_frame_protector_vtable mock_vtable = *raw_frame_protector_->vtable;
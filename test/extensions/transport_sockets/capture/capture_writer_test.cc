@@ -0,0 +1,145 @@
+#include <cstring>
+
+#include "common/filesystem/filesystem_impl.h"
+#include "common/protobuf/protobuf.h"
+
+#include "extensions/transport_sockets/capture/capture_writer.h"
+
+#include "test/test_common/environment.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Capture {
+namespace {
+
+typedef envoy::config::transport_socket::capture::v2alpha::FileSink FileSink;
+
+// A segment with the events, whose data are read if prefixed by "r" and written otherwise.
+TracePtr makeTrace(bool with_connection, const std::vector<std::string>& events) {
+  TracePtr trace = std::make_unique<envoy::data::tap::v2alpha::Trace>();
+  if (with_connection) {
+    auto* connection = trace->mutable_connection();
+    connection->set_id(7);
+    connection->mutable_local_address()->mutable_socket_address()->set_address("127.0.0.1");
+    connection->mutable_local_address()->mutable_socket_address()->set_port_value(10000);
+    connection->mutable_remote_address()->mutable_socket_address()->set_address("127.0.0.2");
+    connection->mutable_remote_address()->mutable_socket_address()->set_port_value(20000);
+  }
+  for (const std::string& data : events) {
+    auto* event = trace->add_events();
+    event->mutable_timestamp()->set_seconds(1);
+    if (data[0] == 'r') {
+      event->mutable_read()->set_data(data.substr(1));
+    } else {
+      event->mutable_write()->set_data(data);
+    }
+  }
+  return trace;
+}
+
+TEST(CaptureWriterTest, Extensions) {
+  EXPECT_STREQ("pb", TraceFile::extension(FileSink::PROTO_BINARY));
+  EXPECT_STREQ("pb_text", TraceFile::extension(FileSink::PROTO_TEXT));
+  EXPECT_STREQ("pcap", TraceFile::extension(FileSink::PCAP));
+}
+
+// The segments of a binary trace parse as a single trace.
+TEST(CaptureWriterTest, BinarySegments) {
+  const std::string path = TestEnvironment::temporaryPath("capture_writer_binary.pb");
+  CaptureWriter writer(1024);
+  EXPECT_EQ(0, writer.write(path, FileSink::PROTO_BINARY, makeTrace(true, {"rhello"}), 5, false));
+  EXPECT_EQ(0, writer.write(path, FileSink::PROTO_BINARY, makeTrace(false, {"world"}), 5, true));
+  writer.drain();
+
+  envoy::data::tap::v2alpha::Trace trace;
+  EXPECT_TRUE(trace.ParseFromString(Filesystem::fileReadToEnd(path)));
+  EXPECT_EQ(7, trace.connection().id());
+  ASSERT_EQ(2, trace.events_size());
+  EXPECT_EQ("hello", trace.events(0).read().data());
+  EXPECT_EQ("world", trace.events(1).write().data());
+}
+
+// The segments of a text trace parse as a single trace.
+TEST(CaptureWriterTest, TextSegments) {
+  const std::string path = TestEnvironment::temporaryPath("capture_writer_text.pb_text");
+  CaptureWriter writer(1024);
+  writer.write(path, FileSink::PROTO_TEXT, makeTrace(true, {"rhello"}), 5, false);
+  writer.write(path, FileSink::PROTO_TEXT, makeTrace(false, {"world"}), 5, true);
+  writer.drain();
+
+  envoy::data::tap::v2alpha::Trace trace;
+  EXPECT_TRUE(Protobuf::TextFormat::ParseFromString(Filesystem::fileReadToEnd(path), &trace));
+  EXPECT_EQ(7, trace.connection().id());
+  EXPECT_EQ(2, trace.events_size());
+}
+
+// Events beyond the pending bytes are dropped, but the connection and the end of the trace are
+// still written.
+TEST(CaptureWriterTest, DropBeyondPendingBytes) {
+  const std::string path = TestEnvironment::temporaryPath("capture_writer_drop.pb");
+  CaptureWriter writer(4);
+  EXPECT_EQ(1, writer.write(path, FileSink::PROTO_BINARY, makeTrace(true, {"hello"}), 5, false));
+  EXPECT_EQ(2, writer.write(path, FileSink::PROTO_BINARY, makeTrace(false, {"hello", "world"}),
+                            10, false));
+  EXPECT_EQ(0, writer.write(path, FileSink::PROTO_BINARY, makeTrace(false, {"abc"}), 3, true));
+  writer.drain();
+
+  envoy::data::tap::v2alpha::Trace trace;
+  EXPECT_TRUE(trace.ParseFromString(Filesystem::fileReadToEnd(path)));
+  EXPECT_EQ(7, trace.connection().id());
+  ASSERT_EQ(1, trace.events_size());
+  EXPECT_EQ("abc", trace.events(0).write().data());
+}
+
+// PCAP files have a packet per event, with IPv4 and TCP headers.
+TEST(CaptureWriterTest, Pcap) {
+  const std::string path = TestEnvironment::temporaryPath("capture_writer.pcap");
+  {
+    TraceFile file(path, FileSink::PCAP);
+    TracePtr trace = makeTrace(true, {"rhello", "hi"});
+    trace->mutable_events(1)->mutable_write()->set_end_stream(true);
+    file.append(*trace);
+  }
+
+  const std::string pcap = Filesystem::fileReadToEnd(path);
+  // The file header, then a record header, IPv4 header, TCP header and data per packet.
+  ASSERT_EQ(24 + (16 + 20 + 20 + 5) + (16 + 20 + 20 + 2), pcap.size());
+  uint32_t magic;
+  memcpy(&magic, pcap.data(), sizeof(magic));
+  EXPECT_EQ(0xa1b2c3d4, magic);
+
+  // The read is sent from the remote address to the local one.
+  const std::string read = pcap.substr(24 + 16, 20 + 20 + 5);
+  EXPECT_EQ(0x45, read[0]);
+  EXPECT_EQ(std::string("\x7f\x00\x00\x02", 4), read.substr(12, 4));
+  EXPECT_EQ(std::string("\x7f\x00\x00\x01", 4), read.substr(16, 4));
+  EXPECT_EQ(std::string("\x4e\x20\x27\x10", 4), read.substr(20, 4));
+  EXPECT_EQ("hello", read.substr(40));
+
+  // The write ends the stream, and acknowledges the read.
+  const std::string write = pcap.substr(24 + 16 + 45 + 16);
+  EXPECT_EQ(std::string("\x27\x10\x4e\x20", 4), write.substr(20, 4));
+  EXPECT_EQ(std::string("\x00\x00\x00\x06", 4), write.substr(28, 4));
+  EXPECT_EQ(0x19, write[33]);
+  EXPECT_EQ("hi", write.substr(40));
+}
+
+// Events larger than the snap length are split into several packets.
+TEST(CaptureWriterTest, PcapLargeEvent) {
+  const std::string path = TestEnvironment::temporaryPath("capture_writer_large.pcap");
+  {
+    TraceFile file(path, FileSink::PCAP);
+    file.append(*makeTrace(true, {std::string(100000, 'a')}));
+  }
+
+  EXPECT_EQ(24 + 2 * (16 + 20 + 20) + 100000, Filesystem::fileReadToEnd(path).size());
+}
+
+} // namespace
+} // namespace Capture
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
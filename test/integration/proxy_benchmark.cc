@@ -0,0 +1,312 @@
+// End to end benchmarks of a real server proxying HTTP/1, HTTP/2, TLS and TCP traffic through
+// a worker thread to an in process upstream. Each benchmark reports the request rate, the
+// latency percentiles of the requests, and the CPU time and heap growth of the process per
+// request. The load generating client and the upstream run in the same process, so the CPU time
+// is an upper bound of the server's.
+//
+// Run with:
+//   bazel run -c opt //test/integration:proxy_benchmark
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/thread.h"
+#include "common/event/libevent.h"
+#include "common/memory/stats.h"
+#include "common/network/filter_impl.h"
+#include "common/ssl/context_manager_impl.h"
+
+#include "extensions/filters/network/echo/echo.h"
+
+#include "test/integration/autonomous_upstream.h"
+#include "test/integration/http_integration.h"
+#include "test/integration/ssl_utility.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/test_common/environment.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace {
+
+/**
+ * Measures the requests of a benchmark run, from its construction to report().
+ */
+class RequestMeter {
+public:
+  explicit RequestMeter(benchmark::State& state)
+      : state_(state), cpu_start_(cpuTime()),
+        allocated_start_(Memory::Stats::totalCurrentlyAllocated()) {}
+
+  void begin() { request_start_ = std::chrono::steady_clock::now(); }
+
+  void end() {
+    latencies_.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - request_start_)
+                             .count());
+  }
+
+  void report() {
+    state_.SetItemsProcessed(state_.iterations());
+    if (latencies_.empty()) {
+      return;
+    }
+
+    std::sort(latencies_.begin(), latencies_.end());
+    state_.counters["p50_us"] = percentile(0.5);
+    state_.counters["p99_us"] = percentile(0.99);
+    state_.counters["p999_us"] = percentile(0.999);
+
+    const double requests = latencies_.size();
+    state_.counters["cpu_us_per_req"] = (cpuTime() - cpu_start_).count() / requests;
+    // Only tracked when built with tcmalloc. A steady growth points at a leak or at a cache
+    // growing per request.
+    state_.counters["heap_growth_bytes_per_req"] =
+        (static_cast<double>(Memory::Stats::totalCurrentlyAllocated()) - allocated_start_) /
+        requests;
+  }
+
+private:
+  // @return the CPU time used by all the threads of the process so far.
+  static std::chrono::microseconds cpuTime() {
+    struct rusage usage;
+    RELEASE_ASSERT(getrusage(RUSAGE_SELF, &usage) == 0, "");
+    return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+  }
+
+  double percentile(double quantile) const {
+    const size_t index =
+        std::min(latencies_.size() - 1, static_cast<size_t>(quantile * latencies_.size()));
+    return latencies_[index] / 1000.0;
+  }
+
+  benchmark::State& state_;
+  const std::chrono::microseconds cpu_start_;
+  const double allocated_start_;
+  std::chrono::steady_clock::time_point request_start_;
+  std::vector<uint64_t> latencies_;
+};
+
+/**
+ * Proxies requests to an AutonomousUpstream, which responds to each with a body of the size
+ * requested by the request headers.
+ */
+class HttpProxyBenchmark : public HttpIntegrationTest {
+public:
+  HttpProxyBenchmark(Http::CodecClient::Type downstream_protocol,
+                     FakeHttpConnection::Type upstream_protocol, bool tls)
+      : HttpIntegrationTest(downstream_protocol, Network::Address::IpVersion::v4), tls_(tls) {
+    autonomous_upstream_ = true;
+    setUpstreamProtocol(upstream_protocol);
+  }
+
+  ~HttpProxyBenchmark() {
+    // The client connection uses the client TLS context.
+    if (codec_client_ != nullptr) {
+      codec_client_->close();
+      codec_client_.reset();
+    }
+    client_ssl_ctx_.reset();
+    context_manager_.reset();
+  }
+
+  void run(benchmark::State& state, uint64_t response_size) {
+    if (tls_) {
+      config_helper_.addSslConfig();
+    }
+    initialize();
+    if (tls_) {
+      context_manager_ = std::make_unique<Ssl::ContextManagerImpl>(runtime_);
+      client_ssl_ctx_ = Ssl::createClientSslTransportSocketFactory(false, false, *context_manager_);
+      codec_client_ = makeHttpConnection(dispatcher_->createClientConnection(
+          Ssl::getSslAddress(version_, lookupPort("http")),
+          Network::Address::InstanceConstSharedPtr(), client_ssl_ctx_->createTransportSocket(),
+          nullptr));
+    } else {
+      codec_client_ = makeHttpConnection(lookupPort("http"));
+    }
+
+    const Http::TestHeaderMapImpl request_headers{
+        {":method", "GET"},
+        {":path", "/"},
+        {":scheme", "http"},
+        {":authority", "host"},
+        {AutonomousStream::RESPONSE_SIZE_BYTES, std::to_string(response_size)}};
+    RequestMeter meter(state);
+    for (auto _ : state) {
+      meter.begin();
+      IntegrationStreamDecoderPtr response = codec_client_->makeHeaderOnlyRequest(request_headers);
+      response->waitForEndStream();
+      meter.end();
+      if (!response->complete() || response->headers().Status()->value() != "200") {
+        state.SkipWithError("request failed");
+        break;
+      }
+    }
+    meter.report();
+  }
+
+private:
+  const bool tls_;
+  testing::NiceMock<Runtime::MockLoader> runtime_;
+  std::unique_ptr<Ssl::ContextManagerImpl> context_manager_;
+  Network::TransportSocketFactoryPtr client_ssl_ctx_;
+};
+
+/**
+ * Upstream echoing the data of its connections.
+ */
+class EchoUpstream : public FakeUpstream {
+public:
+  explicit EchoUpstream(Network::Address::IpVersion version)
+      : FakeUpstream(0, FakeHttpConnection::Type::HTTP1, version) {}
+
+  bool createNetworkFilterChain(Network::Connection& connection,
+                                const std::vector<Network::FilterFactoryCb>&) override {
+    connection.addReadFilter(std::make_shared<Extensions::NetworkFilters::Echo::EchoFilter>());
+    return true;
+  }
+};
+
+/**
+ * Client reading the echoed data until it has read as much as it wrote.
+ */
+class EchoClient : public Network::ReadFilterBaseImpl, public Network::ConnectionCallbacks {
+public:
+  explicit EchoClient(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+  // Network::ReadFilter
+  Network::FilterStatus onData(Buffer::Instance& data, bool) override {
+    received_ += data.length();
+    data.drain(data.length());
+    if (received_ >= expected_) {
+      dispatcher_.exit();
+    }
+    return Network::FilterStatus::StopIteration;
+  }
+
+  // Network::ConnectionCallbacks
+  void onEvent(Network::ConnectionEvent event) override {
+    if (event == Network::ConnectionEvent::RemoteClose ||
+        event == Network::ConnectionEvent::LocalClose) {
+      closed_ = true;
+      dispatcher_.exit();
+    }
+  }
+  void onAboveWriteBufferHighWatermark() override {}
+  void onBelowWriteBufferLowWatermark() override {}
+
+  Event::Dispatcher& dispatcher_;
+  uint64_t expected_{};
+  uint64_t received_{};
+  bool closed_{};
+};
+
+/**
+ * Proxies the data of a TCP connection to an EchoUpstream.
+ */
+class TcpProxyBenchmark : public BaseIntegrationTest {
+public:
+  TcpProxyBenchmark()
+      : BaseIntegrationTest(Network::Address::IpVersion::v4, ConfigHelper::TCP_PROXY_CONFIG) {}
+
+  ~TcpProxyBenchmark() {
+    if (connection_ != nullptr) {
+      connection_->close(Network::ConnectionCloseType::NoFlush);
+    }
+    test_server_.reset();
+    fake_upstreams_.clear();
+  }
+
+  // BaseIntegrationTest
+  void createUpstreams() override { fake_upstreams_.emplace_back(new EchoUpstream(version_)); }
+
+  void run(benchmark::State& state, uint64_t payload_size) {
+    initialize();
+    auto client = std::make_shared<EchoClient>(*dispatcher_);
+    connection_ = makeClientConnection(lookupPort("tcp_proxy"));
+    connection_->addConnectionCallbacks(*client);
+    connection_->addReadFilter(client);
+    connection_->connect();
+
+    const std::string payload(payload_size, 'a');
+    RequestMeter meter(state);
+    for (auto _ : state) {
+      meter.begin();
+      client->expected_ += payload_size;
+      Buffer::OwnedImpl data(payload);
+      connection_->write(data, false);
+      while (client->received_ < client->expected_ && !client->closed_) {
+        dispatcher_->run(Event::Dispatcher::RunType::Block);
+      }
+      meter.end();
+      if (client->closed_) {
+        state.SkipWithError("connection closed");
+        break;
+      }
+    }
+    meter.report();
+  }
+
+private:
+  Network::ClientConnectionPtr connection_;
+};
+
+void BM_Http1(benchmark::State& state) {
+  HttpProxyBenchmark fixture(Http::CodecClient::Type::HTTP1, FakeHttpConnection::Type::HTTP1,
+                             false);
+  fixture.run(state, state.range(0));
+}
+BENCHMARK(BM_Http1)->Arg(10)->Arg(16384)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+void BM_Http2(benchmark::State& state) {
+  HttpProxyBenchmark fixture(Http::CodecClient::Type::HTTP2, FakeHttpConnection::Type::HTTP2,
+                             false);
+  fixture.run(state, state.range(0));
+}
+BENCHMARK(BM_Http2)->Arg(10)->Arg(16384)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+void BM_Http1Tls(benchmark::State& state) {
+  HttpProxyBenchmark fixture(Http::CodecClient::Type::HTTP1, FakeHttpConnection::Type::HTTP1,
+                             true);
+  fixture.run(state, state.range(0));
+}
+BENCHMARK(BM_Http1Tls)->Arg(10)->Arg(16384)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+void BM_TcpProxy(benchmark::State& state) {
+  TcpProxyBenchmark fixture;
+  fixture.run(state, state.range(0));
+}
+BENCHMARK(BM_TcpProxy)->Arg(128)->Arg(16384)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+} // namespace
+} // namespace Envoy
+
+int main(int argc, char** argv) {
+  // bazel run starts the benchmark in its runfiles tree, which holds the configs and certs.
+  char cwd[PATH_MAX];
+  RELEASE_ASSERT(::getcwd(cwd, sizeof(cwd)) != nullptr, "");
+  ::setenv("TEST_RUNDIR", cwd, 0);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  Envoy::Event::Libevent::Global::initialize();
+  Envoy::TestEnvironment::initializeOptions(argc, argv);
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn,
+                                      Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+  benchmark::RunSpecifiedBenchmarks();
+}
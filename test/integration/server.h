@@ -12,6 +12,7 @@
 #include "common/common/assert.h"
 #include "common/common/lock_guard.h"
 #include "common/common/logger.h"
+#include "common/common/regex.h"
 #include "common/common/thread.h"
 #include "common/stats/source_impl.h"
 
@@ -43,6 +44,13 @@ public:
   // Server::Options
   uint64_t baseId() const override { return 0; }
   uint32_t concurrency() const override { return 1; }
+  const std::vector<uint32_t>& workerCpuAffinity() const override { return worker_cpu_affinity_; }
+  uint32_t blockingPoolThreads() const override { return 0; }
+  uint32_t tlsPrivateKeyThreads() const override { return 0; }
+  uint32_t tlsSessionCacheSize() const override { return 0; }
+  uint32_t tlsLazyServerContexts() const override { return 0; }
+  uint32_t dnsCacheSize() const override { return 0; }
+  std::chrono::seconds dnsCacheMaxStale() const override { return std::chrono::seconds(0); }
   const std::string& configPath() const override { return config_path_; }
   const std::string& configYaml() const override { return config_yaml_; }
   bool v2ConfigOnly() const override { return false; }
@@ -51,10 +59,13 @@ public:
     return local_address_ip_version_;
   }
   std::chrono::seconds drainTime() const override { return std::chrono::seconds(1); }
+  DrainCurve drainCurve() const override { return DrainCurve::Linear; }
+  uint32_t drainCloseRate() const override { return 0; }
   spdlog::level::level_enum logLevel() const override { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
   const std::string& logFormat() const override { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
   std::chrono::seconds parentShutdownTime() const override { return std::chrono::seconds(2); }
   const std::string& logPath() const override { return log_path_; }
+  uint32_t logRingSize() const override { return 0; }
   uint64_t restartEpoch() const override { return 0; }
   std::chrono::milliseconds fileFlushIntervalMsec() const override {
     return std::chrono::milliseconds(50);
@@ -66,6 +77,12 @@ public:
   uint64_t maxStats() const override { return 16384; }
   const Stats::StatsOptions& statsOptions() const override { return stats_options_; }
   bool hotRestartDisabled() const override { return false; }
+  uint32_t bufferSlabPoolMb() const override { return 0; }
+  bool useLibeventBuffers() const override { return false; }
+  EventLoopBackend eventLoopBackend() const override { return EventLoopBackend::Default; }
+  uint64_t readBudgetBytes() const override { return 0; }
+  bool useStdRegex() const override { return false; }
+  uint32_t maxRegexProgramSize() const override { return Regex::Utility::DefaultMaxProgramSize; }
 
   // asConfigYaml returns a new config that empties the configPath() and populates configYaml()
   Server::TestOptionsImpl asConfigYaml();
@@ -80,6 +97,7 @@ private:
   const std::string service_zone_;
   Stats::StatsOptionsImpl stats_options_;
   const std::string log_path_;
+  const std::vector<uint32_t> worker_cpu_affinity_;
 };
 
 class TestDrainManager : public DrainManager {
@@ -194,6 +212,8 @@ public:
   // Stats::StoreRoot
   void addSink(Sink&) override {}
   void setTagProducer(TagProducerPtr&&) override {}
+  void setCardinalityLimit(const std::string&, uint64_t) override {}
+  void setStatsMatcher(StatsMatcherPtr&&) override {}
   void initializeThreading(Event::Dispatcher&, ThreadLocal::Instance&) override {}
   void shutdownThreading() override {}
   void mergeHistograms(PostMergeCb) override {}
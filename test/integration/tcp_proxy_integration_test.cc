@@ -355,6 +355,45 @@ TEST_P(TcpProxyIntegrationTest, TestIdletimeoutWithLargeOutstandingData) {
   ASSERT_TRUE(fake_upstream_connection->waitForDisconnect(true));
 }
 
+#ifdef __linux__
+// Test that spliced connections proxy data and half-closes in both directions.
+TEST_P(TcpProxyIntegrationTest, Splice) {
+  config_helper_.addConfigModifier([&](envoy::config::bootstrap::v2::Bootstrap& bootstrap) -> void {
+    auto* listener = bootstrap.mutable_static_resources()->mutable_listeners(0);
+    auto* filter_chain = listener->mutable_filter_chains(0);
+    auto* config_blob = filter_chain->mutable_filters(0)->mutable_config();
+
+    envoy::config::filter::network::tcp_proxy::v2::TcpProxy tcp_proxy_config;
+    MessageUtil::jsonConvert(*config_blob, tcp_proxy_config);
+    tcp_proxy_config.set_splice(true);
+    MessageUtil::jsonConvert(tcp_proxy_config, *config_blob);
+  });
+
+  initialize();
+  std::string data(1024 * 512, 'a');
+  IntegrationTcpClientPtr tcp_client = makeTcpConnection(lookupPort("tcp_proxy"));
+  tcp_client->write(data);
+  FakeRawConnectionPtr fake_upstream_connection;
+  ASSERT_TRUE(fake_upstreams_[0]->waitForRawConnection(fake_upstream_connection));
+  ASSERT_TRUE(fake_upstream_connection->waitForData(data.size()));
+  ASSERT_TRUE(fake_upstream_connection->write(data));
+  tcp_client->waitForData(data);
+
+  tcp_client->write("", true);
+  ASSERT_TRUE(fake_upstream_connection->waitForHalfClose());
+  ASSERT_TRUE(fake_upstream_connection->write("bye", true));
+  tcp_client->waitForData("bye", false);
+  tcp_client->waitForDisconnect();
+  ASSERT_TRUE(fake_upstream_connection->waitForDisconnect());
+
+  EXPECT_EQ(1, test_server_->counter("tcp.tcp_stats.downstream_cx_splice_total")->value());
+  EXPECT_EQ(data.size(),
+            test_server_->counter("tcp.tcp_stats.downstream_cx_rx_bytes_total")->value());
+  EXPECT_EQ(data.size() + 3,
+            test_server_->counter("tcp.tcp_stats.downstream_cx_tx_bytes_total")->value());
+}
+#endif
+
 INSTANTIATE_TEST_CASE_P(IpVersions, TcpProxySslIntegrationTest,
                         testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
                         TestUtility::ipTestParamsToString);
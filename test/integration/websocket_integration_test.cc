@@ -336,6 +336,26 @@ TEST_P(WebsocketIntegrationTest, WebSocketConnectionIdleTimeout) {
   ASSERT_TRUE(waitForUpstreamDisconnectOrReset());
 }
 
+#ifdef __linux__
+// Test that plaintext old style WebSocket connections are spliced once upgraded.
+TEST_P(WebsocketIntegrationTest, Splice) {
+  if (!old_style_websockets_) {
+    return;
+  }
+  envoy::api::v2::route::RouteAction::WebSocketProxyConfig ws_config;
+  ws_config.set_splice(true);
+  config_helper_.addConfigModifier(setRouteUsingWebsocket(&ws_config, old_style_websockets_));
+  initialize();
+
+  performUpgrade(upgradeRequestHeaders(), upgradeResponseHeaders());
+  sendBidirectionalData();
+  EXPECT_EQ(1, test_server_->counter("tcp.websocket.downstream_cx_splice_total")->value());
+
+  codec_client_->close();
+  ASSERT_TRUE(waitForUpstreamDisconnectOrReset());
+}
+#endif
+
 TEST_P(WebsocketIntegrationTest, WebSocketLogging) {
   if (!old_style_websockets_)
     return;
@@ -8,11 +8,15 @@
 
 using testing::_;
 using testing::Return;
+using testing::ReturnRef;
 
 namespace Envoy {
 namespace Api {
 
-MockApi::MockApi() { ON_CALL(*this, createFile(_, _, _, _)).WillByDefault(Return(file_)); }
+MockApi::MockApi() {
+  ON_CALL(*this, createFile(_, _, _, _)).WillByDefault(Return(file_));
+  ON_CALL(*this, blockingPool()).WillByDefault(ReturnRef(blocking_pool_));
+}
 
 MockApi::~MockApi() {}
 
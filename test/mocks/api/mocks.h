@@ -10,6 +10,7 @@
 #include "envoy/stats/store.h"
 
 #include "common/api/os_sys_calls_impl.h"
+#include "common/common/blocking_pool_impl.h"
 
 #include "test/mocks/filesystem/mocks.h"
 
@@ -34,8 +35,11 @@ public:
                                          Thread::BasicLockable& lock, Stats::Store& stats_store));
   MOCK_METHOD1(fileExists, bool(const std::string& path));
   MOCK_METHOD1(fileReadToEnd, std::string(const std::string& path));
+  MOCK_METHOD0(blockingPool, Thread::BlockingPool&());
 
   std::shared_ptr<Filesystem::MockFile> file_{new Filesystem::MockFile()};
+  // Runs the blocking work inline.
+  Thread::BlockingPoolImpl blocking_pool_{0};
 };
 
 class MockOsSysCalls : public OsSysCallsImpl {
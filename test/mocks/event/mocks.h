@@ -34,6 +34,7 @@ public:
 
   // Dispatcher
   TimeSystem& timeSystem() override { return *time_system_; }
+  TimeSource& approximateTimeSource() override { return *time_system_; }
   Network::ConnectionPtr
   createServerConnection(Network::ConnectionSocketPtr&& socket,
                          Network::TransportSocketPtr&& transport_socket) override {
@@ -49,6 +50,15 @@ public:
         createClientConnection_(address, source_address, transport_socket, options)};
   }
 
+  Network::ClientConnectionPtr createHappyEyeballsConnection(
+      const std::vector<Network::Address::InstanceConstSharedPtr>& addresses,
+      Network::Address::InstanceConstSharedPtr source_address,
+      Network::TransportSocketPtr&& transport_socket,
+      const Network::ConnectionSocket::OptionsSharedPtr& options) override {
+    return Network::ClientConnectionPtr{
+        createHappyEyeballsConnection_(addresses, source_address, transport_socket, options)};
+  }
+
   FileEventPtr createFileEvent(int fd, FileReadyCb cb, FileTriggerType trigger,
                                uint32_t events) override {
     return FileEventPtr{createFileEvent_(fd, cb, trigger, events)};
@@ -65,10 +75,19 @@ public:
         createListener_(socket, cb, bind_to_port, hand_off_restored_destination_connections)};
   }
 
+  Network::UdpListenerPtr createUdpListener(Network::Socket& socket,
+                                            Network::UdpListenerCallbacks& cb) override {
+    return Network::UdpListenerPtr{createUdpListener_(socket, cb)};
+  }
+
   Event::TimerPtr createTimer(Event::TimerCb cb) override {
     return Event::TimerPtr{createTimer_(cb)};
   }
 
+  Event::TimerPtr createCoarseTimer(Event::TimerCb cb) override {
+    return Event::TimerPtr{createTimer_(cb)};
+  }
+
   void deferredDelete(DeferredDeletablePtr&& to_delete) override {
     deferredDelete_(to_delete.get());
     if (to_delete) {
@@ -81,6 +100,7 @@ public:
   }
 
   // Event::Dispatcher
+  MOCK_METHOD2(initializeStats, void(Stats::Scope& scope, const std::string& prefix));
   MOCK_METHOD0(clearDeferredDeleteList, void());
   MOCK_METHOD2(createServerConnection_,
                Network::Connection*(Network::ConnectionSocket* socket,
@@ -91,6 +111,12 @@ public:
                                  Network::Address::InstanceConstSharedPtr source_address,
                                  Network::TransportSocketPtr& transport_socket,
                                  const Network::ConnectionSocket::OptionsSharedPtr& options));
+  MOCK_METHOD4(createHappyEyeballsConnection_,
+               Network::ClientConnection*(
+                   const std::vector<Network::Address::InstanceConstSharedPtr>& addresses,
+                   Network::Address::InstanceConstSharedPtr source_address,
+                   Network::TransportSocketPtr& transport_socket,
+                   const Network::ConnectionSocket::OptionsSharedPtr& options));
   MOCK_METHOD1(createDnsResolver,
                Network::DnsResolverSharedPtr(
                    const std::vector<Network::Address::InstanceConstSharedPtr>& resolvers));
@@ -101,6 +127,8 @@ public:
                Network::Listener*(Network::Socket& socket, Network::ListenerCallbacks& cb,
                                   bool bind_to_port,
                                   bool hand_off_restored_destination_connections));
+  MOCK_METHOD2(createUdpListener_,
+               Network::UdpListener*(Network::Socket& socket, Network::UdpListenerCallbacks& cb));
   MOCK_METHOD1(createTimer_, Timer*(Event::TimerCb cb));
   MOCK_METHOD1(deferredDelete_, void(DeferredDeletable* to_delete));
   MOCK_METHOD0(exit, void());
@@ -135,6 +135,11 @@ MockStreamFilter::~MockStreamFilter() {}
 
 MockAsyncClient::MockAsyncClient() {
   ON_CALL(*this, dispatcher()).WillByDefault(ReturnRef(dispatcher_));
+  ON_CALL(*this, sendWithOptions_(_, _, _))
+      .WillByDefault(Invoke([this](MessagePtr& request, Callbacks& callbacks,
+                                   const RequestOptions& options) -> Request* {
+        return send_(request, callbacks, options.timeout);
+      }));
 }
 MockAsyncClient::~MockAsyncClient() {}
 
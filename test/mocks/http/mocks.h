@@ -94,6 +94,7 @@ public:
   MOCK_METHOD1(readDisable, void(bool disable));
   MOCK_METHOD2(setWriteBufferWatermarks, void(uint32_t, uint32_t));
   MOCK_METHOD0(bufferLimit, uint32_t());
+  MOCK_METHOD1(setPriorityWeight, void(uint32_t weight));
 
   std::list<StreamCallbacks*> callbacks_{};
 
@@ -349,6 +350,16 @@ public:
   MOCK_METHOD3(send_, Request*(MessagePtr& request, Callbacks& callbacks,
                                const absl::optional<std::chrono::milliseconds>& timeout));
 
+  Request* send(MessagePtr&& request, Callbacks& callbacks,
+                const RequestOptions& options) override {
+    return sendWithOptions_(request, callbacks, options);
+  }
+
+  // By default forwards to send_(), so that expectations on send_() also match requests sent
+  // with options.
+  MOCK_METHOD3(sendWithOptions_,
+               Request*(MessagePtr& request, Callbacks& callbacks, const RequestOptions& options));
+
   MOCK_METHOD3(start, Stream*(StreamCallbacks& callbacks,
                               const absl::optional<std::chrono::milliseconds>& timeout,
                               bool buffer_body_for_retry));
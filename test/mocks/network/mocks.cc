@@ -28,6 +28,8 @@ MockListenerConfig::MockListenerConfig() {
   ON_CALL(*this, socket()).WillByDefault(ReturnRef(socket_));
   ON_CALL(*this, listenerScope()).WillByDefault(ReturnRef(scope_));
   ON_CALL(*this, name()).WillByDefault(ReturnRef(name_));
+  ON_CALL(*this, connectionBalancer()).WillByDefault(ReturnRef(connection_balancer_));
+  ON_CALL(*this, acceptLimits()).WillByDefault(ReturnRef(accept_limits_));
 }
 MockListenerConfig::~MockListenerConfig() {}
 
@@ -154,6 +156,23 @@ MockFilter::~MockFilter() {}
 MockListenerCallbacks::MockListenerCallbacks() {}
 MockListenerCallbacks::~MockListenerCallbacks() {}
 
+MockUdpListenerCallbacks::MockUdpListenerCallbacks() {}
+MockUdpListenerCallbacks::~MockUdpListenerCallbacks() {}
+
+MockUdpListener::MockUdpListener() {
+  ON_CALL(*this, dispatcher()).WillByDefault(ReturnRef(dispatcher_));
+}
+MockUdpListener::~MockUdpListener() { onDestroy(); }
+
+MockUdpListenerReadFilter::MockUdpListenerReadFilter(UdpReadFilterCallbacks& callbacks)
+    : UdpListenerReadFilter(callbacks) {}
+MockUdpListenerReadFilter::~MockUdpListenerReadFilter() {}
+
+MockUdpReadFilterCallbacks::MockUdpReadFilterCallbacks() {
+  ON_CALL(*this, udpListener()).WillByDefault(ReturnRef(udp_listener_));
+}
+MockUdpReadFilterCallbacks::~MockUdpReadFilterCallbacks() {}
+
 MockDrainDecision::MockDrainDecision() {}
 MockDrainDecision::~MockDrainDecision() {}
 
@@ -174,6 +193,7 @@ MockFilterChainManager::~MockFilterChainManager() {}
 
 MockFilterChainFactory::MockFilterChainFactory() {
   ON_CALL(*this, createListenerFilterChain(_)).WillByDefault(Return(true));
+  ON_CALL(*this, createUdpListenerFilterChain(_, _)).WillByDefault(Return(true));
 }
 MockFilterChainFactory::~MockFilterChainFactory() {}
 
@@ -13,6 +13,7 @@
 #include "envoy/network/transport_socket.h"
 #include "envoy/stats/scope.h"
 
+#include "common/network/connection_balancer_impl.h"
 #include "common/stats/isolated_store_impl.h"
 
 #include "test/mocks/event/mocks.h"
@@ -68,9 +69,11 @@ public:
   MOCK_METHOD1(close, void(ConnectionCloseType type));
   MOCK_METHOD0(dispatcher, Event::Dispatcher&());
   MOCK_CONST_METHOD0(id, uint64_t());
+  MOCK_CONST_METHOD0(fd, int());
   MOCK_METHOD0(initializeReadFilters, bool());
   MOCK_CONST_METHOD0(nextProtocol, std::string());
   MOCK_METHOD1(noDelay, void(bool enable));
+  MOCK_METHOD1(quickAck, void(bool enable));
   MOCK_METHOD1(readDisable, void(bool disable));
   MOCK_METHOD1(detectEarlyCloseWhenReadDisabled, void(bool));
   MOCK_CONST_METHOD0(readEnabled, bool());
@@ -83,8 +86,10 @@ public:
   MOCK_METHOD2(write, void(Buffer::Instance& data, bool end_stream));
   MOCK_METHOD1(setBufferLimits, void(uint32_t limit));
   MOCK_CONST_METHOD0(bufferLimit, uint32_t());
+  MOCK_METHOD1(setBufferLimitAutoTuning, void(uint32_t max_limit));
   MOCK_CONST_METHOD0(localAddressRestored, bool());
   MOCK_CONST_METHOD0(aboveHighWatermark, bool());
+  MOCK_CONST_METHOD0(bufferedWriteBytes, uint64_t());
   MOCK_CONST_METHOD0(socketOptions, const Network::ConnectionSocket::OptionsSharedPtr&());
 };
 
@@ -107,9 +112,11 @@ public:
   MOCK_METHOD1(close, void(ConnectionCloseType type));
   MOCK_METHOD0(dispatcher, Event::Dispatcher&());
   MOCK_CONST_METHOD0(id, uint64_t());
+  MOCK_CONST_METHOD0(fd, int());
   MOCK_METHOD0(initializeReadFilters, bool());
   MOCK_CONST_METHOD0(nextProtocol, std::string());
   MOCK_METHOD1(noDelay, void(bool enable));
+  MOCK_METHOD1(quickAck, void(bool enable));
   MOCK_METHOD1(readDisable, void(bool disable));
   MOCK_METHOD1(detectEarlyCloseWhenReadDisabled, void(bool));
   MOCK_CONST_METHOD0(readEnabled, bool());
@@ -122,8 +129,10 @@ public:
   MOCK_METHOD2(write, void(Buffer::Instance& data, bool end_stream));
   MOCK_METHOD1(setBufferLimits, void(uint32_t limit));
   MOCK_CONST_METHOD0(bufferLimit, uint32_t());
+  MOCK_METHOD1(setBufferLimitAutoTuning, void(uint32_t max_limit));
   MOCK_CONST_METHOD0(localAddressRestored, bool());
   MOCK_CONST_METHOD0(aboveHighWatermark, bool());
+  MOCK_CONST_METHOD0(bufferedWriteBytes, uint64_t());
   MOCK_CONST_METHOD0(socketOptions, const Network::ConnectionSocket::OptionsSharedPtr&());
 
   // Network::ClientConnection
@@ -222,6 +231,54 @@ public:
   MOCK_METHOD1(onNewConnection_, void(ConnectionPtr& conn));
 };
 
+class MockUdpListenerCallbacks : public UdpListenerCallbacks {
+public:
+  MockUdpListenerCallbacks();
+  ~MockUdpListenerCallbacks();
+
+  void onData(UdpRecvData&& data) override { onData_(data); }
+
+  MOCK_METHOD1(onData_, void(UdpRecvData& data));
+};
+
+class MockUdpListener : public UdpListener {
+public:
+  MockUdpListener();
+  ~MockUdpListener();
+
+  MOCK_METHOD0(onDestroy, void());
+  MOCK_METHOD0(disable, void());
+  MOCK_METHOD0(enable, void());
+  MOCK_METHOD0(dispatcher, Event::Dispatcher&());
+  MOCK_METHOD2(send, Api::SysCallSizeResult(const Address::Instance& peer_address,
+                                            Buffer::Instance& data));
+  MOCK_METHOD3(sendBatch, Api::SysCallIntResult(const Address::Instance& peer_address,
+                                                const Buffer::RawSlice* datagrams,
+                                                uint64_t num_datagrams));
+
+  testing::NiceMock<Event::MockDispatcher> dispatcher_;
+};
+
+class MockUdpListenerReadFilter : public UdpListenerReadFilter {
+public:
+  MockUdpListenerReadFilter(UdpReadFilterCallbacks& callbacks);
+  ~MockUdpListenerReadFilter();
+
+  MOCK_METHOD1(onData, void(UdpRecvData& data));
+
+  UdpReadFilterCallbacks& callbacks() { return *read_callbacks_; }
+};
+
+class MockUdpReadFilterCallbacks : public UdpReadFilterCallbacks {
+public:
+  MockUdpReadFilterCallbacks();
+  ~MockUdpReadFilterCallbacks();
+
+  MOCK_METHOD0(udpListener, UdpListener&());
+
+  testing::NiceMock<MockUdpListener> udp_listener_;
+};
+
 class MockDrainDecision : public DrainDecision {
 public:
   MockDrainDecision();
@@ -286,6 +343,8 @@ public:
                bool(Connection& connection,
                     const std::vector<Network::FilterFactoryCb>& filter_factories));
   MOCK_METHOD1(createListenerFilterChain, bool(ListenerFilterManager& listener));
+  MOCK_METHOD2(createUdpListenerFilterChain,
+               bool(UdpListenerFilterManager& udp_listener, UdpReadFilterCallbacks& callbacks));
 };
 
 class MockListenSocket : public Socket {
@@ -356,14 +415,21 @@ public:
   MOCK_METHOD0(bindToPort, bool());
   MOCK_CONST_METHOD0(handOffRestoredDestinationConnections, bool());
   MOCK_METHOD0(perConnectionBufferLimitBytes, uint32_t());
+  MOCK_METHOD0(perConnectionBufferLimitMaxBytes, uint32_t());
   MOCK_METHOD0(listenerScope, Stats::Scope&());
   MOCK_CONST_METHOD0(listenerTag, uint64_t());
   MOCK_CONST_METHOD0(name, const std::string&());
+  MOCK_METHOD0(connectionBalancer, ConnectionBalancer&());
+  MOCK_CONST_METHOD0(acceptLimits, const AcceptLimits&());
+  MOCK_CONST_METHOD0(tcpQuickAck, bool());
+  MOCK_CONST_METHOD0(socketType, Address::SocketType());
 
   testing::NiceMock<MockFilterChainFactory> filter_chain_factory_;
   testing::NiceMock<MockListenSocket> socket_;
   Stats::IsolatedStoreImpl scope_;
   std::string name_;
+  NopConnectionBalancerImpl connection_balancer_;
+  AcceptLimits accept_limits_;
 };
 
 class MockListener : public Listener {
@@ -372,6 +438,8 @@ public:
   ~MockListener();
 
   MOCK_METHOD0(onDestroy, void());
+  MOCK_METHOD0(disable, void());
+  MOCK_METHOD0(enable, void());
 };
 
 class MockConnectionHandler : public ConnectionHandler {
@@ -384,8 +452,14 @@ public:
   MOCK_METHOD1(findListenerByAddress,
                Network::Listener*(const Network::Address::Instance& address));
   MOCK_METHOD1(removeListeners, void(uint64_t listener_tag));
+  MOCK_METHOD3(removeFilterChains,
+               void(uint64_t listener_tag,
+                    const std::unordered_set<const FilterChain*>& filter_chains,
+                    std::function<void()> completion));
   MOCK_METHOD1(stopListeners, void(uint64_t listener_tag));
   MOCK_METHOD0(stopListeners, void());
+  MOCK_METHOD0(disableListeners, void());
+  MOCK_METHOD0(enableListeners, void());
 };
 
 class MockIp : public Address::Ip {
@@ -410,6 +484,8 @@ public:
 
   MOCK_CONST_METHOD1(bind, Api::SysCallIntResult(int));
   MOCK_CONST_METHOD1(connect, Api::SysCallIntResult(int));
+  MOCK_CONST_METHOD3(sendTo, Api::SysCallSizeResult(int, const iovec*, int));
+  MOCK_CONST_METHOD3(sendBatchTo, Api::SysCallIntResult(int, const iovec*, int));
   MOCK_CONST_METHOD0(ip, Address::Ip*());
   MOCK_CONST_METHOD1(socket, int(Address::SocketType));
   MOCK_CONST_METHOD0(type, Address::Type());
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -17,8 +18,18 @@ public:
 
   // RateLimit::Client
   MOCK_METHOD0(cancel, void());
+  void limit(RequestCallbacks& callbacks, const std::string& domain,
+             const std::vector<Descriptor>& descriptors, uint32_t hits_addend,
+             Tracing::Span& parent_span) override {
+    hits_addend_ = hits_addend;
+    limit(callbacks, domain, descriptors, parent_span);
+  }
+
   MOCK_METHOD4(limit, void(RequestCallbacks& callbacks, const std::string& domain,
                            const std::vector<Descriptor>& descriptors, Tracing::Span& parent_span));
+
+  // The number of hits of the last limit() call.
+  uint32_t hits_addend_{};
 };
 
 inline bool operator==(const DescriptorEntry& lhs, const DescriptorEntry& rhs) {
@@ -34,7 +34,23 @@ public:
                                           uint64_t random_value, uint64_t num_buckets));
   MOCK_CONST_METHOD1(get, const std::string&(const std::string& key));
   MOCK_CONST_METHOD2(getInteger, uint64_t(const std::string& key, uint64_t default_value));
-  MOCK_CONST_METHOD0(getLayers, const std::vector<OverrideLayerConstPtr>&());
+  MOCK_CONST_METHOD0(getLayers, const std::vector<OverrideLayerConstSharedPtr>&());
+
+  // The interned key variants are forwarded to the mocks taking the name of the key.
+  bool featureEnabled(const Key& key, uint64_t default_value) const override {
+    return featureEnabled(key.name(), default_value);
+  }
+  bool featureEnabled(const Key& key, uint64_t default_value,
+                      uint64_t random_value) const override {
+    return featureEnabled(key.name(), default_value, random_value);
+  }
+  bool featureEnabled(const Key& key, uint64_t default_value, uint64_t random_value,
+                      uint64_t num_buckets) const override {
+    return featureEnabled(key.name(), default_value, random_value, num_buckets);
+  }
+  uint64_t getInteger(const Key& key, uint64_t default_value) const override {
+    return getInteger(key.name(), default_value);
+  }
 };
 
 class MockLoader : public Loader {
@@ -21,6 +21,8 @@ public:
                      TlsCertificateConfigProviderSharedPtr(const std::string& name));
   MOCK_CONST_METHOD1(findStaticCertificateValidationContextProvider,
                      CertificateValidationContextConfigProviderSharedPtr(const std::string& name));
+  MOCK_CONST_METHOD1(findStaticTlsSessionTicketKeysProvider,
+                     TlsSessionTicketKeysConfigProviderSharedPtr(const std::string& name));
   MOCK_METHOD1(createInlineTlsCertificateProvider,
                TlsCertificateConfigProviderSharedPtr(
                    const envoy::api::v2::auth::TlsCertificate& tls_certificate));
@@ -28,10 +30,17 @@ public:
                CertificateValidationContextConfigProviderSharedPtr(
                    const envoy::api::v2::auth::CertificateValidationContext&
                        certificate_validation_context));
+  MOCK_METHOD1(createInlineTlsSessionTicketKeysProvider,
+               TlsSessionTicketKeysConfigProviderSharedPtr(
+                   const envoy::api::v2::auth::TlsSessionTicketKeys& session_ticket_keys));
   MOCK_METHOD3(findOrCreateTlsCertificateProvider,
                TlsCertificateConfigProviderSharedPtr(
                    const envoy::api::v2::core::ConfigSource&, const std::string&,
                    Server::Configuration::TransportSocketFactoryContext&));
+  MOCK_METHOD3(findOrCreateTlsSessionTicketKeysProvider,
+               TlsSessionTicketKeysConfigProviderSharedPtr(
+                   const envoy::api::v2::core::ConfigSource&, const std::string&,
+                   Server::Configuration::TransportSocketFactoryContext&));
 };
 
 class MockSecretCallbacks : public SecretCallbacks {
@@ -20,6 +20,7 @@ namespace Server {
 
 MockOptions::MockOptions(const std::string& config_path) : config_path_(config_path) {
   ON_CALL(*this, concurrency()).WillByDefault(ReturnPointee(&concurrency_));
+  ON_CALL(*this, workerCpuAffinity()).WillByDefault(ReturnRef(worker_cpu_affinity_));
   ON_CALL(*this, configPath()).WillByDefault(ReturnRef(config_path_));
   ON_CALL(*this, configYaml()).WillByDefault(ReturnRef(config_yaml_));
   ON_CALL(*this, v2ConfigOnly()).WillByDefault(Invoke([this] { return v2_config_only_; }));
@@ -88,6 +89,28 @@ MockListenerComponentFactory::MockListenerComponentFactory()
         }
         return socket_;
       }));
+  ON_CALL(*this, createWorkerListenSocket(_, _, _))
+      .WillByDefault(Invoke([](Network::Address::InstanceConstSharedPtr,
+                               const Network::Socket::OptionsSharedPtr& options,
+                               uint32_t) -> Network::SocketSharedPtr {
+        auto socket = std::make_shared<NiceMock<Network::MockListenSocket>>();
+        if (!Network::Socket::applyOptions(options, *socket,
+                                           envoy::api::v2::core::SocketOption::STATE_PREBIND)) {
+          throw EnvoyException("MockListenerComponentFactory: Setting socket options failed");
+        }
+        return socket;
+      }));
+  ON_CALL(*this, createUdpListenSocket(_, _, _))
+      .WillByDefault(Invoke([](Network::Address::InstanceConstSharedPtr,
+                               const Network::Socket::OptionsSharedPtr& options,
+                               uint32_t) -> Network::SocketSharedPtr {
+        auto socket = std::make_shared<NiceMock<Network::MockListenSocket>>();
+        if (!Network::Socket::applyOptions(options, *socket,
+                                           envoy::api::v2::core::SocketOption::STATE_PREBIND)) {
+          throw EnvoyException("MockListenerComponentFactory: Setting socket options failed");
+        }
+        return socket;
+      }));
 }
 MockListenerComponentFactory::~MockListenerComponentFactory() {}
 
@@ -111,6 +134,16 @@ MockWorker::MockWorker() {
             EXPECT_EQ(nullptr, remove_listener_completion_);
             remove_listener_completion_ = completion;
           }));
+
+  ON_CALL(*this, removeFilterChains(_, _, _))
+      .WillByDefault(Invoke(
+          [this](Network::ListenerConfig&,
+                 const std::unordered_set<const Network::FilterChain*>& filter_chains,
+                 std::function<void()> completion) -> void {
+            EXPECT_EQ(nullptr, remove_listener_completion_);
+            removed_filter_chains_ = filter_chains;
+            remove_listener_completion_ = completion;
+          }));
 }
 MockWorker::~MockWorker() {}
 
@@ -53,15 +53,25 @@ public:
 
   MOCK_CONST_METHOD0(baseId, uint64_t());
   MOCK_CONST_METHOD0(concurrency, uint32_t());
+  MOCK_CONST_METHOD0(workerCpuAffinity, const std::vector<uint32_t>&());
+  MOCK_CONST_METHOD0(blockingPoolThreads, uint32_t());
+  MOCK_CONST_METHOD0(tlsPrivateKeyThreads, uint32_t());
+  MOCK_CONST_METHOD0(tlsSessionCacheSize, uint32_t());
+  MOCK_CONST_METHOD0(tlsLazyServerContexts, uint32_t());
+  MOCK_CONST_METHOD0(dnsCacheSize, uint32_t());
+  MOCK_CONST_METHOD0(dnsCacheMaxStale, std::chrono::seconds());
   MOCK_CONST_METHOD0(configPath, const std::string&());
   MOCK_CONST_METHOD0(configYaml, const std::string&());
   MOCK_CONST_METHOD0(v2ConfigOnly, bool());
   MOCK_CONST_METHOD0(adminAddressPath, const std::string&());
   MOCK_CONST_METHOD0(localAddressIpVersion, Network::Address::IpVersion());
   MOCK_CONST_METHOD0(drainTime, std::chrono::seconds());
+  MOCK_CONST_METHOD0(drainCurve, DrainCurve());
+  MOCK_CONST_METHOD0(drainCloseRate, uint32_t());
   MOCK_CONST_METHOD0(logLevel, spdlog::level::level_enum());
   MOCK_CONST_METHOD0(logFormat, const std::string&());
   MOCK_CONST_METHOD0(logPath, const std::string&());
+  MOCK_CONST_METHOD0(logRingSize, uint32_t());
   MOCK_CONST_METHOD0(parentShutdownTime, std::chrono::seconds());
   MOCK_CONST_METHOD0(restartEpoch, uint64_t());
   MOCK_CONST_METHOD0(fileFlushIntervalMsec, std::chrono::milliseconds());
@@ -72,6 +82,12 @@ public:
   MOCK_CONST_METHOD0(maxStats, uint64_t());
   MOCK_CONST_METHOD0(statsOptions, const Stats::StatsOptions&());
   MOCK_CONST_METHOD0(hotRestartDisabled, bool());
+  MOCK_CONST_METHOD0(bufferSlabPoolMb, uint32_t());
+  MOCK_CONST_METHOD0(useLibeventBuffers, bool());
+  MOCK_CONST_METHOD0(eventLoopBackend, EventLoopBackend());
+  MOCK_CONST_METHOD0(readBudgetBytes, uint64_t());
+  MOCK_CONST_METHOD0(useStdRegex, bool());
+  MOCK_CONST_METHOD0(maxRegexProgramSize, uint32_t());
 
   std::string config_path_;
   std::string config_yaml_;
@@ -84,6 +100,7 @@ public:
   std::string log_path_;
   Stats::StatsOptionsImpl stats_options_;
   uint32_t concurrency_{1};
+  std::vector<uint32_t> worker_cpu_affinity_;
   uint64_t hot_restart_epoch_{};
   bool hot_restart_disabled_{};
 };
@@ -167,8 +184,9 @@ public:
 
   // Server::HotRestart
   MOCK_METHOD0(drainParentListeners, void());
-  MOCK_METHOD1(duplicateParentListenSocket, int(const std::string& address));
+  MOCK_METHOD2(duplicateParentListenSocket, int(const std::string& address, uint32_t worker_index));
   MOCK_METHOD1(getParentStats, void(GetParentStatsInfo& info));
+  MOCK_METHOD0(getParentTlsSessions, std::string());
   MOCK_METHOD2(initialize, void(Event::Dispatcher& dispatcher, Server::Instance& server));
   MOCK_METHOD1(shutdownParentAdmin, void(ShutdownParentAdminInfo& info));
   MOCK_METHOD0(terminateParent, void());
@@ -205,10 +223,22 @@ public:
                std::vector<Network::ListenerFilterFactoryCb>(
                    const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>&,
                    Configuration::ListenerFactoryContext& context));
+  MOCK_METHOD2(createUdpListenerFilterFactoryList,
+               std::vector<Network::UdpListenerFilterFactoryCb>(
+                   const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>&,
+                   Configuration::ListenerFactoryContext& context));
   MOCK_METHOD3(createListenSocket,
                Network::SocketSharedPtr(Network::Address::InstanceConstSharedPtr address,
                                         const Network::Socket::OptionsSharedPtr& options,
                                         bool bind_to_port));
+  MOCK_METHOD3(createWorkerListenSocket,
+               Network::SocketSharedPtr(Network::Address::InstanceConstSharedPtr address,
+                                        const Network::Socket::OptionsSharedPtr& options,
+                                        uint32_t worker_index));
+  MOCK_METHOD3(createUdpListenSocket,
+               Network::SocketSharedPtr(Network::Address::InstanceConstSharedPtr address,
+                                        const Network::Socket::OptionsSharedPtr& options,
+                                        uint32_t worker_index));
   MOCK_METHOD1(createDrainManager_, DrainManager*(envoy::api::v2::Listener::DrainType drain_type));
   MOCK_METHOD0(nextListenerTag, uint64_t());
 
@@ -224,6 +254,8 @@ public:
                                          const std::string& version_info, bool modifiable));
   MOCK_METHOD1(createLdsApi, void(const envoy::api::v2::core::ConfigSource& lds_config));
   MOCK_METHOD0(listeners, std::vector<std::reference_wrapper<Network::ListenerConfig>>());
+  MOCK_METHOD1(workerListeners,
+               std::vector<std::reference_wrapper<Network::ListenerConfig>>(uint32_t worker_index));
   MOCK_METHOD0(numConnections, uint64_t());
   MOCK_METHOD1(removeListener, bool(const std::string& listener_name));
   MOCK_METHOD1(startWorkers, void(GuardDog& guard_dog));
@@ -237,7 +269,7 @@ public:
   ~MockWorkerFactory();
 
   // Server::WorkerFactory
-  WorkerPtr createWorker() override { return WorkerPtr{createWorker_()}; }
+  WorkerPtr createWorker(OverloadManager&) override { return WorkerPtr{createWorker_()}; }
 
   MOCK_METHOD0(createWorker_, Worker*());
 };
@@ -265,6 +297,10 @@ public:
   MOCK_METHOD0(numConnections, uint64_t());
   MOCK_METHOD2(removeListener,
                void(Network::ListenerConfig& listener, std::function<void()> completion));
+  MOCK_METHOD3(removeFilterChains,
+               void(Network::ListenerConfig& listener,
+                    const std::unordered_set<const Network::FilterChain*>& filter_chains,
+                    std::function<void()> completion));
   MOCK_METHOD1(start, void(GuardDog& guard_dog));
   MOCK_METHOD0(stop, void());
   MOCK_METHOD1(stopListener, void(Network::ListenerConfig& listener));
@@ -272,6 +308,7 @@ public:
 
   AddListenerCompletion add_listener_completion_;
   std::function<void()> remove_listener_completion_;
+  std::unordered_set<const Network::FilterChain*> removed_filter_chains_;
 };
 
 class MockOverloadManager : public OverloadManager {
@@ -495,6 +532,7 @@ public:
   MOCK_CONST_METHOD0(getRequestHeaders, Http::HeaderMap&());
   MOCK_CONST_METHOD0(getDecoderFilterCallbacks,
                      NiceMock<Http::MockStreamDecoderFilterCallbacks>&());
+  MOCK_METHOD1(setResponseContinuation, void(std::function<bool(Buffer::Instance&)>));
 };
 
 } // namespace Configuration
@@ -26,8 +26,18 @@ public:
   MOCK_METHOD3(createSslServerContext,
                ServerContextSharedPtr(Stats::Scope& stats, const ServerContextConfig& config,
                                       const std::vector<std::string>& server_names));
+  LazyServerContextPtr
+  createLazySslServerContext(Stats::Scope& scope, const ServerContextConfig& config,
+                             const std::vector<std::string>& server_names) override {
+    return LazyServerContextPtr{createLazySslServerContext_(scope, config, server_names)};
+  }
+  MOCK_METHOD3(createLazySslServerContext_,
+               LazyServerContext*(Stats::Scope& scope, const ServerContextConfig& config,
+                                  const std::vector<std::string>& server_names));
   MOCK_CONST_METHOD0(daysUntilFirstCertExpires, size_t());
   MOCK_METHOD1(iterateContexts, void(std::function<void(const Context&)> callback));
+  MOCK_METHOD0(exportServerSessions, std::string());
+  MOCK_METHOD1(importServerSessions, void(const std::string& sessions));
 };
 
 class MockConnection : public Connection {
@@ -61,6 +61,26 @@ MockSource::MockSource() {
   ON_CALL(*this, cachedCounters()).WillByDefault(ReturnRef(counters_));
   ON_CALL(*this, cachedGauges()).WillByDefault(ReturnRef(gauges_));
   ON_CALL(*this, cachedHistograms()).WillByDefault(ReturnRef(histograms_));
+  ON_CALL(*this, cachedCounterSnapshots())
+      .WillByDefault(Invoke([this]() -> const std::vector<CounterSnapshot>& {
+        counter_snapshots_.clear();
+        for (const CounterSharedPtr& counter : counters_) {
+          if (counter->used()) {
+            counter_snapshots_.push_back({*counter, counter->latch()});
+          }
+        }
+        return counter_snapshots_;
+      }));
+  ON_CALL(*this, cachedGaugeSnapshots())
+      .WillByDefault(Invoke([this]() -> const std::vector<GaugeSnapshot>& {
+        gauge_snapshots_.clear();
+        for (const GaugeSharedPtr& gauge : gauges_) {
+          if (gauge->used()) {
+            gauge_snapshots_.push_back({*gauge, gauge->value()});
+          }
+        }
+        return gauge_snapshots_;
+      }));
 }
 
 MockSource::~MockSource() {}
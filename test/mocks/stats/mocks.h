@@ -125,11 +125,17 @@ public:
   MOCK_METHOD0(cachedCounters, const std::vector<CounterSharedPtr>&());
   MOCK_METHOD0(cachedGauges, const std::vector<GaugeSharedPtr>&());
   MOCK_METHOD0(cachedHistograms, const std::vector<ParentHistogramSharedPtr>&());
+  MOCK_METHOD0(cachedCounterSnapshots, const std::vector<CounterSnapshot>&());
+  MOCK_METHOD0(cachedGaugeSnapshots, const std::vector<GaugeSnapshot>&());
+  MOCK_METHOD1(setChangedMetricsOnly, void(bool changed_only));
   MOCK_METHOD0(clearCache, void());
 
   std::vector<CounterSharedPtr> counters_;
   std::vector<GaugeSharedPtr> gauges_;
   std::vector<ParentHistogramSharedPtr> histograms_;
+  // By default, built from the used counters_ and gauges_ when requested.
+  std::vector<CounterSnapshot> counter_snapshots_;
+  std::vector<GaugeSnapshot> gauge_snapshots_;
 };
 
 class MockSink : public Sink {
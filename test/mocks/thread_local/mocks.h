@@ -62,6 +62,7 @@ public:
       parent_.runOnAllThreads(cb, main_callback);
     }
     void set(InitializeCb cb) override { parent_.data_[index_] = cb(parent_.dispatcher_); }
+    void publish(ThreadLocalObjectSharedPtr object) override { parent_.data_[index_] = object; }
 
     MockInstance& parent_;
     const uint32_t index_;
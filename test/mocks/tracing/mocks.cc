@@ -9,7 +9,7 @@ using testing::ReturnRef;
 namespace Envoy {
 namespace Tracing {
 
-MockSpan::MockSpan() {}
+MockSpan::MockSpan() { ON_CALL(*this, sampled()).WillByDefault(Return(true)); }
 MockSpan::~MockSpan() {}
 
 MockConfig::MockConfig() {
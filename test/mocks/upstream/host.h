@@ -28,6 +28,7 @@ public:
   MOCK_METHOD0(lastUnejectionTime, const absl::optional<MonotonicTime>&());
   MOCK_CONST_METHOD0(successRate, double());
   MOCK_METHOD1(successRate, void(double new_success_rate));
+  MOCK_CONST_METHOD0(latency, double());
 };
 
 class MockEventLogger : public EventLogger {
@@ -54,6 +55,8 @@ public:
   MOCK_METHOD1(addChangedStateCb, void(ChangeStateCb cb));
   MOCK_CONST_METHOD0(successRateAverage, double());
   MOCK_CONST_METHOD0(successRateEjectionThreshold, double());
+  MOCK_CONST_METHOD0(latencyAverage, double());
+  MOCK_CONST_METHOD0(latencyEjectionThreshold, double());
 
   std::list<ChangeStateCb> callbacks_;
 };
@@ -80,6 +83,7 @@ public:
   MOCK_METHOD1(canary, void(bool new_canary));
   MOCK_CONST_METHOD0(metadata, const std::shared_ptr<envoy::api::v2::core::Metadata>());
   MOCK_METHOD1(metadata, void(const envoy::api::v2::core::Metadata&));
+  MOCK_CONST_METHOD0(lbMetadata, LbMetadataConstSharedPtr());
   MOCK_CONST_METHOD0(cluster, const ClusterInfo&());
   MOCK_CONST_METHOD0(outlierDetector, Outlier::DetectorHostMonitor&());
   MOCK_CONST_METHOD0(healthChecker, HealthCheckHostMonitor&());
@@ -133,6 +137,7 @@ public:
   MOCK_METHOD1(canary, void(bool new_canary));
   MOCK_CONST_METHOD0(metadata, const std::shared_ptr<envoy::api::v2::core::Metadata>());
   MOCK_METHOD1(metadata, void(const envoy::api::v2::core::Metadata&));
+  MOCK_CONST_METHOD0(lbMetadata, LbMetadataConstSharedPtr());
   MOCK_CONST_METHOD0(cluster, const ClusterInfo&());
   MOCK_CONST_METHOD0(counters, std::vector<Stats::CounterSharedPtr>());
   MOCK_CONST_METHOD2(
@@ -32,6 +32,18 @@ MockHostSet::MockHostSet(uint32_t priority, uint32_t overprovisioning_factor)
   ON_CALL(*this, localityWeights()).WillByDefault(Invoke([this]() -> LocalityWeightsConstSharedPtr {
     return locality_weights_;
   }));
+  ON_CALL(*this, hostsPtr()).WillByDefault(Invoke([this]() -> HostVectorConstSharedPtr {
+    return std::make_shared<const HostVector>(hosts_);
+  }));
+  ON_CALL(*this, healthyHostsPtr()).WillByDefault(Invoke([this]() -> HostVectorConstSharedPtr {
+    return std::make_shared<const HostVector>(healthy_hosts_);
+  }));
+  ON_CALL(*this, hostsPerLocalityPtr())
+      .WillByDefault(
+          Invoke([this]() -> HostsPerLocalityConstSharedPtr { return hosts_per_locality_; }));
+  ON_CALL(*this, healthyHostsPerLocalityPtr())
+      .WillByDefault(Invoke(
+          [this]() -> HostsPerLocalityConstSharedPtr { return healthy_hosts_per_locality_; }));
 }
 
 MockPrioritySet::MockPrioritySet() {
@@ -94,6 +106,7 @@ MockClusterManager::MockClusterManager() {
   ON_CALL(*this, httpAsyncClientForCluster(_)).WillByDefault((ReturnRef(async_client_)));
   ON_CALL(*this, bindConfig()).WillByDefault(ReturnRef(bind_config_));
   ON_CALL(*this, adsMux()).WillByDefault(ReturnRef(ads_mux_));
+  ON_CALL(*this, xdsDecodePool()).WillByDefault(ReturnRef(xds_decode_pool_));
   ON_CALL(*this, grpcAsyncClientManager()).WillByDefault(ReturnRef(async_client_manager_));
   ON_CALL(*this, localClusterName()).WillByDefault((ReturnRef(local_cluster_name_)));
 
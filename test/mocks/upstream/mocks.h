@@ -12,6 +12,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "common/common/callback_impl.h"
+#include "common/config/decode_pool_impl.h"
 #include "common/upstream/health_discovery_service.h"
 #include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/upstream_impl.h"
@@ -51,6 +52,10 @@ public:
   MOCK_CONST_METHOD0(healthyHosts, const HostVector&());
   MOCK_CONST_METHOD0(hostsPerLocality, const HostsPerLocality&());
   MOCK_CONST_METHOD0(healthyHostsPerLocality, const HostsPerLocality&());
+  MOCK_CONST_METHOD0(hostsPtr, HostVectorConstSharedPtr());
+  MOCK_CONST_METHOD0(healthyHostsPtr, HostVectorConstSharedPtr());
+  MOCK_CONST_METHOD0(hostsPerLocalityPtr, HostsPerLocalityConstSharedPtr());
+  MOCK_CONST_METHOD0(healthyHostsPerLocalityPtr, HostsPerLocalityConstSharedPtr());
   MOCK_CONST_METHOD0(localityWeights, LocalityWeightsConstSharedPtr());
   MOCK_METHOD0(chooseLocality, absl::optional<uint32_t>());
   MOCK_METHOD8(updateHosts, void(std::shared_ptr<const HostVector> hosts,
@@ -105,6 +110,7 @@ public:
 
   // Upstream::Cluster
   MOCK_METHOD0(healthChecker, HealthChecker*());
+  MOCK_CONST_METHOD0(healthChecker, const HealthChecker*());
   MOCK_CONST_METHOD0(info, ClusterInfoConstSharedPtr());
   MOCK_METHOD0(outlierDetector, Outlier::Detector*());
   MOCK_CONST_METHOD0(outlierDetector, const Outlier::Detector*());
@@ -230,6 +236,7 @@ public:
   MOCK_METHOD0(shutdown, void());
   MOCK_CONST_METHOD0(bindConfig, const envoy::api::v2::core::BindConfig&());
   MOCK_METHOD0(adsMux, Config::GrpcMux&());
+  MOCK_METHOD0(xdsDecodePool, Config::DecodePool&());
   MOCK_METHOD0(grpcAsyncClientManager, Grpc::AsyncClientManager&());
   MOCK_CONST_METHOD0(versionInfo, const std::string());
   MOCK_CONST_METHOD0(localClusterName, const std::string&());
@@ -245,6 +252,7 @@ public:
   NiceMock<MockThreadLocalCluster> thread_local_cluster_;
   envoy::api::v2::core::BindConfig bind_config_;
   NiceMock<Config::MockGrpcMux> ads_mux_;
+  Config::DecodePoolImpl xds_decode_pool_{0};
   NiceMock<Grpc::MockAsyncClientManager> async_client_manager_;
   std::string local_cluster_name_;
   NiceMock<MockClusterManagerFactory> cluster_manager_factory_;
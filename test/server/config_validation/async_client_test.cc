@@ -20,6 +20,8 @@ TEST(ValidationAsyncClientTest, MockedMethods) {
   ValidationAsyncClient client(test_time.timeSystem());
   EXPECT_EQ(nullptr, client.send(std::move(message), callbacks,
                                  absl::optional<std::chrono::milliseconds>()));
+  message.reset(new RequestMessageImpl());
+  EXPECT_EQ(nullptr, client.send(std::move(message), callbacks, AsyncClient::RequestOptions()));
   EXPECT_EQ(nullptr,
             client.start(stream_callbacks, absl::optional<std::chrono::milliseconds>(), false));
 }
@@ -1,12 +1,15 @@
 #include "envoy/stats/scope.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/utility.h"
 #include "common/network/address_impl.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/raw_buffer_socket.h"
 #include "common/network/utility.h"
 
 #include "server/connection_handler_impl.h"
 
+#include "test/mocks/common.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/server/mocks.h"
 #include "test/test_common/network_utility.h"
@@ -20,7 +23,9 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
+using testing::ReturnPointee;
 using testing::ReturnRef;
+using testing::SaveArg;
 
 namespace Envoy {
 namespace Server {
@@ -48,9 +53,14 @@ public:
       return hand_off_restored_destination_connections_;
     }
     uint32_t perConnectionBufferLimitBytes() override { return 0; }
+    uint32_t perConnectionBufferLimitMaxBytes() override { return 0; }
     Stats::Scope& listenerScope() override { return parent_.stats_store_; }
     uint64_t listenerTag() const override { return tag_; }
     const std::string& name() const override { return name_; }
+    Network::ConnectionBalancer& connectionBalancer() override { return *connection_balancer_; }
+    const Network::AcceptLimits& acceptLimits() const override { return accept_limits_; }
+    bool tcpQuickAck() const override { return tcp_quick_ack_; }
+    Network::Address::SocketType socketType() const override { return socket_type_; }
 
     ConnectionHandlerTest& parent_;
     Network::MockListenSocket socket_;
@@ -58,6 +68,11 @@ public:
     bool bind_to_port_;
     const bool hand_off_restored_destination_connections_;
     const std::string name_;
+    std::shared_ptr<Network::ConnectionBalancer> connection_balancer_{
+        std::make_shared<Network::NopConnectionBalancerImpl>()};
+    Network::AcceptLimits accept_limits_;
+    bool tcp_quick_ack_{false};
+    Network::Address::SocketType socket_type_{Network::Address::SocketType::Stream};
   };
 
   typedef std::unique_ptr<TestListener> TestListenerPtr;
@@ -116,6 +131,50 @@ TEST_F(ConnectionHandlerTest, RemoveListener) {
   handler_->removeListeners(0);
 }
 
+// A UDP listener's filters receive its datagrams, and are destroyed with it.
+TEST_F(ConnectionHandlerTest, UdpListener) {
+  InSequence s;
+
+  Network::MockUdpListener* listener = new NiceMock<Network::MockUdpListener>();
+  Network::UdpListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createUdpListener_(_, _))
+      .WillOnce(Invoke([&](Network::Socket&,
+                           Network::UdpListenerCallbacks& cb) -> Network::UdpListener* {
+        listener_callbacks = &cb;
+        return listener;
+      }));
+  Network::MockUdpListenerReadFilter* filter = nullptr;
+  EXPECT_CALL(factory_, createUdpListenerFilterChain(_, _))
+      .WillOnce(Invoke([&](Network::UdpListenerFilterManager& manager,
+                           Network::UdpReadFilterCallbacks& callbacks) -> bool {
+        EXPECT_EQ(listener, &callbacks.udpListener());
+        filter = new Network::MockUdpListenerReadFilter(callbacks);
+        manager.addReadFilter(Network::UdpListenerReadFilterPtr{filter});
+        return true;
+      }));
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  test_listener->socket_type_ = Network::Address::SocketType::Datagram;
+  handler_->addListener(*test_listener);
+  EXPECT_EQ(0UL, handler_->numConnections());
+
+  EXPECT_CALL(*filter, onData(_)).WillOnce(Invoke([](Network::UdpRecvData& data) -> void {
+    EXPECT_EQ("hello", data.buffer_->toString());
+  }));
+  Network::UdpRecvData data;
+  data.buffer_ = std::make_unique<Buffer::OwnedImpl>("hello");
+  listener_callbacks->onData(std::move(data));
+
+  EXPECT_CALL(*listener, disable());
+  handler_->disableListeners();
+  EXPECT_CALL(*listener, enable());
+  handler_->enableListeners();
+
+  // Stopping a UDP listener destroys it, as there are no connections to drain.
+  EXPECT_CALL(*listener, onDestroy());
+  handler_->stopListeners(1);
+  handler_->removeListeners(1);
+}
+
 TEST_F(ConnectionHandlerTest, DestroyCloseConnections) {
   InSequence s;
 
@@ -141,6 +200,31 @@ TEST_F(ConnectionHandlerTest, DestroyCloseConnections) {
   handler_.reset();
 }
 
+// Quick ACKs are enabled on the connections of listeners configured with them.
+TEST_F(ConnectionHandlerTest, QuickAck) {
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks = &cb;
+            return listener;
+          }));
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  test_listener->tcp_quick_ack_ = true;
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->addListener(*test_listener);
+
+  Network::MockConnection* connection = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(*connection, noDelay(true));
+  EXPECT_CALL(*connection, quickAck(true));
+  listener_callbacks->onNewConnection(Network::ConnectionPtr{connection});
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  EXPECT_CALL(*listener, onDestroy());
+  handler_.reset();
+}
+
 TEST_F(ConnectionHandlerTest, CloseDuringFilterChainCreate) {
   InSequence s;
 
@@ -197,6 +281,65 @@ TEST_F(ConnectionHandlerTest, CloseConnectionOnEmptyFilterChain) {
   EXPECT_CALL(*listener, onDestroy());
 }
 
+TEST_F(ConnectionHandlerTest, RemoveFilterChains) {
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks = &cb;
+            return listener;
+          }));
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->addListener(*test_listener);
+
+  const Network::FilterChainSharedPtr kept_filter_chain =
+      Network::Test::createEmptyFilterChainWithRawBufferSockets();
+  EXPECT_CALL(manager_, findFilterChain(_))
+      .WillOnce(Return(filter_chain_.get()))
+      .WillOnce(Return(kept_filter_chain.get()));
+  Network::MockConnection* removed_connection = new NiceMock<Network::MockConnection>();
+  Network::MockConnection* kept_connection = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _))
+      .WillOnce(Return(removed_connection))
+      .WillOnce(Return(kept_connection));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillRepeatedly(Return(true));
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, true);
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, true);
+  EXPECT_EQ(2UL, handler_->numConnections());
+
+  EXPECT_CALL(*listener, onDestroy());
+  handler_->stopListeners(1);
+
+  // Only the connection of the removed filter chain is closed, and the listener stays until the
+  // other connection closes as well.
+  bool completed = false;
+  Event::PostCb remove_listener;
+  EXPECT_CALL(*removed_connection, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(*kept_connection, close(_)).Times(0);
+  EXPECT_CALL(dispatcher_, post(_)).Times(0);
+  handler_->removeFilterChains(1, {filter_chain_.get()}, [&completed]() { completed = true; });
+  EXPECT_EQ(1UL, handler_->numConnections());
+  EXPECT_FALSE(completed);
+
+  testing::Mock::VerifyAndClearExpectations(&dispatcher_);
+  EXPECT_CALL(dispatcher_, post(_)).WillOnce(SaveArg<0>(&remove_listener));
+  kept_connection->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_EQ(0UL, handler_->numConnections());
+  EXPECT_FALSE(completed);
+
+  remove_listener();
+  EXPECT_TRUE(completed);
+
+  // Removing filter chains of an unknown listener completes immediately.
+  completed = false;
+  handler_->removeFilterChains(1, {filter_chain_.get()}, [&completed]() { completed = true; });
+  EXPECT_TRUE(completed);
+}
+
 TEST_F(ConnectionHandlerTest, FindListenerByAddress) {
   TestListener* test_listener1 = addListener(1, true, true, "test_listener1");
   Network::Address::InstanceConstSharedPtr alt_address(
@@ -476,6 +619,41 @@ TEST_F(ConnectionHandlerTest, TransportProtocolDefault) {
   EXPECT_CALL(*listener, onDestroy());
 }
 
+// A listener filter that fails from onAccept() closes the socket rather than keeping it.
+TEST_F(ConnectionHandlerTest, ListenerFilterFailsOnAccept) {
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  Network::MockListener* listener = new Network::MockListener();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, false))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks = &cb;
+            return listener;
+          }));
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->addListener(*test_listener);
+
+  Network::MockListenerFilter* test_filter = new Network::MockListenerFilter();
+  EXPECT_CALL(factory_, createListenerFilterChain(_))
+      .WillRepeatedly(Invoke([&](Network::ListenerFilterManager& manager) -> bool {
+        manager.addAcceptFilter(Network::ListenerFilterPtr{test_filter});
+        return true;
+      }));
+  EXPECT_CALL(*test_filter, onAccept(_))
+      .WillOnce(Invoke([&](Network::ListenerFilterCallbacks& cb) -> Network::FilterStatus {
+        cb.continueFilterChain(false);
+        return Network::FilterStatus::StopIteration;
+      }));
+  EXPECT_CALL(manager_, findFilterChain(_)).Times(0);
+  // The filter and the socket are destroyed with the failed ActiveSocket, which the mock
+  // expectations above would otherwise report as leaked.
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, true);
+  EXPECT_EQ(0UL, handler_->numConnections());
+
+  EXPECT_CALL(*listener, onDestroy());
+}
+
 TEST_F(ConnectionHandlerTest, TransportProtocolCustom) {
   TestListener* test_listener = addListener(1, true, false, "test_listener");
   Network::MockListener* listener = new Network::MockListener();
@@ -510,5 +688,191 @@ TEST_F(ConnectionHandlerTest, TransportProtocolCustom) {
   EXPECT_CALL(*listener, onDestroy());
 }
 
+TEST_F(ConnectionHandlerTest, ExactBalancerPostsToLeastLoadedWorker) {
+  // The same listener on a second worker, sharing an exact balancer with the first.
+  NiceMock<Event::MockDispatcher> dispatcher2;
+  ConnectionHandlerImpl handler2(ENVOY_LOGGER(), dispatcher2, 1);
+  auto balancer = std::make_shared<Network::ExactConnectionBalancerImpl>();
+
+  TestListener* test_listener1 = addListener(1, true, false, "test_listener");
+  test_listener1->connection_balancer_ = balancer;
+  Network::MockListener* listener1 = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks1;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks1 = &cb;
+            return listener1;
+          }));
+  handler_->addListener(*test_listener1);
+
+  TestListener* test_listener2 = addListener(1, true, false, "test_listener");
+  test_listener2->connection_balancer_ = balancer;
+  Network::MockListener* listener2 = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks2;
+  EXPECT_CALL(dispatcher2, createListener_(_, _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks2 = &cb;
+            return listener2;
+          }));
+  handler2.addListener(*test_listener2);
+
+  // The second worker already has a connection.
+  Network::MockConnection* connection2 = new NiceMock<Network::MockConnection>();
+  listener_callbacks2->onNewConnection(Network::ConnectionPtr{connection2});
+  EXPECT_EQ(1UL, handler2.numConnections());
+  EXPECT_EQ(1UL, stats_store_.counter("worker_1.downstream_cx_total").value());
+  EXPECT_EQ(1UL, stats_store_.gauge("worker_1.downstream_cx_active").value());
+
+  // A connection accepted by the second worker is posted to the first.
+  std::function<void()> posted_cb;
+  EXPECT_CALL(dispatcher_, post(_)).WillOnce(Invoke([&](std::function<void()> cb) -> void {
+    posted_cb = cb;
+  }));
+  EXPECT_CALL(dispatcher2, createServerConnection_(_, _)).Times(0);
+  Network::MockConnectionSocket* accepted_socket = new NiceMock<Network::MockConnectionSocket>();
+  listener_callbacks2->onAccept(Network::ConnectionSocketPtr{accepted_socket}, false);
+  EXPECT_EQ(0UL, handler_->numConnections());
+
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(filter_chain_.get()));
+  Network::MockConnection* connection1 = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _)).WillOnce(Return(connection1));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  posted_cb();
+  EXPECT_EQ(1UL, handler_->numConnections());
+  EXPECT_EQ(1UL, handler2.numConnections());
+
+  // With both workers even, the accepting worker keeps the connection.
+  EXPECT_CALL(dispatcher2, post(_)).Times(0);
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(filter_chain_.get()));
+  Network::MockConnection* connection3 = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(dispatcher2, createServerConnection_(_, _)).WillOnce(Return(connection3));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  accepted_socket = new NiceMock<Network::MockConnectionSocket>();
+  listener_callbacks2->onAccept(Network::ConnectionSocketPtr{accepted_socket}, false);
+  EXPECT_EQ(2UL, handler2.numConnections());
+  EXPECT_EQ(2UL, stats_store_.counter("worker_1.downstream_cx_total").value());
+
+  // A socket posted to a listener that has since been removed is dropped.
+  EXPECT_CALL(dispatcher_, post(_)).WillOnce(Invoke([&](std::function<void()> cb) -> void {
+    posted_cb = cb;
+  }));
+  accepted_socket = new NiceMock<Network::MockConnectionSocket>();
+  listener_callbacks2->onAccept(Network::ConnectionSocketPtr{accepted_socket}, false);
+  EXPECT_CALL(*listener1, onDestroy());
+  handler_->removeListeners(1);
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _)).Times(0);
+  posted_cb();
+  posted_cb = nullptr;
+
+  EXPECT_CALL(*listener2, onDestroy());
+}
+
+TEST_F(ConnectionHandlerTest, MaxAcceptsPerEventLoop) {
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  test_listener->accept_limits_.max_accepts_per_event_loop_ = 2;
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks = &cb;
+            return listener;
+          }));
+  Event::MockTimer* event_loop_timer = new Event::MockTimer(&dispatcher_);
+  handler_->addListener(*test_listener);
+
+  // The first accept of an event loop iteration arms the timer, and the last one allowed stops
+  // the listener for the rest of the iteration.
+  EXPECT_CALL(*event_loop_timer, enableTimer(std::chrono::milliseconds(0)));
+  EXPECT_CALL(*listener, disable()).Times(0);
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+  EXPECT_CALL(*listener, disable());
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+
+  // The next iteration accepts again.
+  EXPECT_CALL(*listener, enable());
+  event_loop_timer->callback_();
+  EXPECT_CALL(*event_loop_timer, enableTimer(std::chrono::milliseconds(0)));
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+
+  EXPECT_CALL(*listener, onDestroy());
+}
+
+TEST_F(ConnectionHandlerTest, AcceptRateLimit) {
+  NiceMock<MockTimeSystem> time_system;
+  MonotonicTime now;
+  ON_CALL(time_system, monotonicTime()).WillByDefault(ReturnPointee(&now));
+  dispatcher_.setTimeSystem(time_system);
+
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  test_listener->accept_limits_.accepts_per_second_ = 3;
+  test_listener->accept_limits_.accept_burst_ = 2;
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks = &cb;
+            return listener;
+          }));
+  Event::MockTimer* rate_limit_timer = new Event::MockTimer(&dispatcher_);
+  handler_->addListener(*test_listener);
+
+  // The burst is accepted without pausing.
+  EXPECT_CALL(*listener, disable()).Times(0);
+  for (int i = 0; i < 2; i++) {
+    listener_callbacks->onAccept(
+        Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+  }
+
+  // The connection over the rate is still handled, but the listener pauses until the rate allows
+  // another connection.
+  EXPECT_CALL(*listener, disable());
+  EXPECT_CALL(*rate_limit_timer, enableTimer(std::chrono::milliseconds(334)));
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+  EXPECT_EQ(1UL, stats_store_.counter("accept_rate_limited").value());
+
+  now += std::chrono::milliseconds(334);
+  EXPECT_CALL(*listener, enable());
+  rate_limit_timer->callback_();
+  EXPECT_CALL(*listener, disable()).Times(0);
+  listener_callbacks->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, false);
+
+  EXPECT_CALL(*listener, onDestroy());
+}
+
+TEST_F(ConnectionHandlerTest, DisableAndEnableListeners) {
+  TestListener* test_listener1 = addListener(1, true, false, "test_listener1");
+  Network::MockListener* listener1 = new NiceMock<Network::MockListener>();
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _)).WillOnce(Return(listener1));
+  handler_->addListener(*test_listener1);
+
+  EXPECT_CALL(*listener1, disable());
+  handler_->disableListeners();
+
+  // Listeners added while disabled start disabled.
+  TestListener* test_listener2 = addListener(2, true, false, "test_listener2");
+  Network::MockListener* listener2 = new NiceMock<Network::MockListener>();
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _)).WillOnce(Return(listener2));
+  EXPECT_CALL(*listener2, disable());
+  handler_->addListener(*test_listener2);
+
+  // Stopped listeners stay stopped.
+  EXPECT_CALL(*listener2, onDestroy());
+  handler_->stopListeners(2);
+
+  EXPECT_CALL(*listener1, enable());
+  handler_->enableListeners();
+
+  EXPECT_CALL(*listener1, onDestroy());
+}
+
 } // namespace Server
 } // namespace Envoy
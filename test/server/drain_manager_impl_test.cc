@@ -2,6 +2,7 @@
 
 #include "server/drain_manager_impl.h"
 
+#include "test/mocks/common.h"
 #include "test/mocks/server/mocks.h"
 
 #include "gmock/gmock.h"
@@ -10,6 +11,7 @@
 using testing::_;
 using testing::InSequence;
 using testing::Return;
+using testing::ReturnRef;
 using testing::SaveArg;
 
 namespace Envoy {
@@ -64,6 +66,81 @@ TEST_F(DrainManagerImplTest, Default) {
   EXPECT_TRUE(drain_manager.drainClose());
 }
 
+// With the quadratic curve, connections are drain closed with the square of the probability of the
+// linear curve.
+TEST_F(DrainManagerImplTest, QuadraticCurve) {
+  ON_CALL(server_.options_, drainCurve()).WillByDefault(Return(DrainCurve::Quadratic));
+  DrainManagerImpl drain_manager(server_, envoy::api::v2::Listener_DrainType_MODIFY_ONLY);
+
+  Event::MockTimer* drain_timer = new Event::MockTimer(&server_.dispatcher_);
+  drain_manager.startDrainSequence(nullptr);
+  for (size_t i = 0; i < 299; i++) {
+    drain_timer->callback_();
+  }
+
+  // Half of the drain time has elapsed.
+  EXPECT_CALL(server_.random_, random()).WillOnce(Return(149999));
+  EXPECT_TRUE(drain_manager.drainClose());
+  EXPECT_CALL(server_.random_, random()).WillOnce(Return(150000));
+  EXPECT_FALSE(drain_manager.drainClose());
+}
+
+TEST_F(DrainManagerImplTest, ImmediateCurve) {
+  ON_CALL(server_.options_, drainCurve()).WillByDefault(Return(DrainCurve::Immediate));
+  DrainManagerImpl drain_manager(server_, envoy::api::v2::Listener_DrainType_MODIFY_ONLY);
+  EXPECT_FALSE(drain_manager.drainClose());
+
+  new Event::MockTimer(&server_.dispatcher_);
+  drain_manager.startDrainSequence(nullptr);
+  EXPECT_CALL(server_.random_, random()).Times(0);
+  EXPECT_TRUE(drain_manager.drainClose());
+}
+
+// Each thread drain closes at most drainCloseRate() connections per second.
+TEST_F(DrainManagerImplTest, PaceDrainCloses) {
+  MockTimeSystem time_system;
+  ON_CALL(server_, timeSystem()).WillByDefault(ReturnRef(time_system));
+  ON_CALL(server_.options_, drainCloseRate()).WillByDefault(Return(2));
+  ON_CALL(server_, healthCheckFailed()).WillByDefault(Return(true));
+  DrainManagerImpl drain_manager(server_, envoy::api::v2::Listener_DrainType_DEFAULT);
+
+  EXPECT_CALL(time_system, monotonicTime())
+      .WillRepeatedly(Return(MonotonicTime(std::chrono::seconds(1000))));
+  EXPECT_TRUE(drain_manager.drainClose());
+  EXPECT_TRUE(drain_manager.drainClose());
+  EXPECT_FALSE(drain_manager.drainClose());
+
+  EXPECT_CALL(time_system, monotonicTime())
+      .WillRepeatedly(Return(MonotonicTime(std::chrono::milliseconds(1000999))));
+  EXPECT_FALSE(drain_manager.drainClose());
+
+  EXPECT_CALL(time_system, monotonicTime())
+      .WillRepeatedly(Return(MonotonicTime(std::chrono::seconds(1001))));
+  EXPECT_TRUE(drain_manager.drainClose());
+}
+
+// The drain sequence advances at half speed while the slow drain overload action is active.
+TEST_F(DrainManagerImplTest, SlowDrain) {
+  ON_CALL(server_.options_, drainTime()).WillByDefault(Return(std::chrono::seconds(2)));
+  DrainManagerImpl drain_manager(server_, envoy::api::v2::Listener_DrainType_MODIFY_ONLY);
+  server_.overload_manager_.overload_state_.setState(OverloadActionNames::get().SlowDrain,
+                                                     OverloadActionState::Active);
+
+  Event::MockTimer* drain_timer = new Event::MockTimer(&server_.dispatcher_);
+  ReadyWatcher drain_complete;
+  drain_manager.startDrainSequence([&drain_complete]() -> void { drain_complete.ready(); });
+  drain_timer->callback_();
+  drain_timer->callback_();
+
+  EXPECT_CALL(server_.random_, random()).WillOnce(Return(1499));
+  EXPECT_TRUE(drain_manager.drainClose());
+  EXPECT_CALL(server_.random_, random()).WillOnce(Return(1500));
+  EXPECT_FALSE(drain_manager.drainClose());
+
+  EXPECT_CALL(drain_complete, ready());
+  drain_timer->callback_();
+}
+
 TEST_F(DrainManagerImplTest, ModifyOnly) {
   InSequence s;
   DrainManagerImpl drain_manager(server_, envoy::api::v2::Listener_DrainType_MODIFY_ONLY);
@@ -0,0 +1,97 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+
+#include "server/filter_chain_matcher.h"
+
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Server {
+
+// A listener with one filter chain per SNI, as used for TLS termination of many domains.
+constexpr int NumServerNames = 5000;
+
+static std::vector<std::string> serverNames() {
+  std::vector<std::string> names;
+  for (int i = 0; i < NumServerNames; i++) {
+    names.push_back(fmt::format("service{}.example.com", i));
+  }
+  return names;
+}
+
+// The lookup sequence previously used by ListenerImpl::findFilterChain, for comparison.
+static void BM_ServerNameHashMap(benchmark::State& state) {
+  std::unordered_map<std::string, int> map;
+  for (const auto& name : serverNames()) {
+    map[name] = 1;
+  }
+  map[".example.com"] = 2;
+  const std::vector<std::string> requested{"service4321.example.com", "unknown.example.com"};
+
+  size_t i = 0;
+  for (auto _ : state) {
+    const std::string server_name(requested[i++ % requested.size()]);
+    auto match = map.find(server_name);
+    size_t pos = server_name.find('.', 1);
+    while (match == map.end() && pos < server_name.size() - 1 && pos != std::string::npos) {
+      match = map.find(server_name.substr(pos));
+      pos = server_name.find('.', pos + 1);
+    }
+    benchmark::DoNotOptimize(match);
+  }
+}
+BENCHMARK(BM_ServerNameHashMap);
+
+static void BM_ServerNameTrie(benchmark::State& state) {
+  ServerNameTrie<int> trie;
+  for (const auto& name : serverNames()) {
+    trie.add(name, 1);
+  }
+  trie.add(".example.com", 2);
+  const std::vector<std::string> requested{"service4321.example.com", "unknown.example.com"};
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(trie.find(requested[i++ % requested.size()]));
+  }
+}
+BENCHMARK(BM_ServerNameTrie);
+
+static void BM_ApplicationProtocolMap(benchmark::State& state) {
+  ProtocolMap<int> map;
+  map["h2"] = 1;
+  map["http/1.1"] = 2;
+  map[""] = 3;
+  const std::vector<std::string> requested{"spdy/3", "http/1.1"};
+
+  for (auto _ : state) {
+    for (const auto& protocol : requested) {
+      benchmark::DoNotOptimize(map.find(protocol));
+    }
+  }
+}
+BENCHMARK(BM_ApplicationProtocolMap);
+
+} // namespace Server
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Registry::initialize(spdlog::level::warn,
+                                      Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
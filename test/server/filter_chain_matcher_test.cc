@@ -0,0 +1,76 @@
+#include <string>
+
+#include "server/filter_chain_matcher.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Server {
+namespace {
+
+TEST(ProtocolMapTest, FindAndInsert) {
+  ProtocolMap<int> map;
+  EXPECT_EQ(nullptr, map.find("h2"));
+
+  map["h2"] = 1;
+  map["http/1.1"] = 2;
+  map["h2"] = 3;
+  EXPECT_EQ(3, *map.find("h2"));
+  EXPECT_EQ(2, *map.find("http/1.1"));
+  EXPECT_EQ(nullptr, map.find(""));
+  EXPECT_EQ(nullptr, map.find("h"));
+}
+
+TEST(ServerNameTrieTest, ExactWildcardAndCatchAll) {
+  ServerNameTrie<std::string> trie;
+  EXPECT_EQ(nullptr, trie.find("www.example.com"));
+
+  trie.add("www.example.com", "exact");
+  trie.add(".example.com", "wildcard");
+  trie.add(".com", "tld");
+  EXPECT_EQ("exact", *trie.find("www.example.com"));
+  EXPECT_EQ("wildcard", *trie.find("api.example.com"));
+  EXPECT_EQ("wildcard", *trie.find("a.b.example.com"));
+  EXPECT_EQ("tld", *trie.find("example.com"));
+  EXPECT_EQ("tld", *trie.find("www.example2.com"));
+  EXPECT_EQ(nullptr, trie.find("com"));
+  EXPECT_EQ(nullptr, trie.find("www.example.org"));
+  EXPECT_EQ(nullptr, trie.find(""));
+
+  // Labels are matched whole.
+  EXPECT_EQ(nullptr, trie.find("www.example.co"));
+  EXPECT_EQ("tld", *trie.find("wwwexample.com"));
+
+  trie.add("", "any");
+  EXPECT_EQ("any", *trie.find(""));
+  EXPECT_EQ("any", *trie.find("com"));
+  EXPECT_EQ("any", *trie.find("www.example.org"));
+  EXPECT_EQ("exact", *trie.find("www.example.com"));
+}
+
+TEST(ServerNameTrieTest, ExactAndWildcardOnSameName) {
+  ServerNameTrie<std::string> trie;
+  trie.add("example.com", "exact");
+  trie.add(".example.com", "wildcard");
+  EXPECT_EQ("exact", *trie.find("example.com"));
+  EXPECT_EQ("wildcard", *trie.find("www.example.com"));
+
+  // An exact name only matches itself, not its subdomains.
+  trie.add("api.example.com", "api");
+  EXPECT_EQ("wildcard", *trie.find("v1.api.example.com"));
+}
+
+TEST(ServerNameTrieTest, ManyNames) {
+  ServerNameTrie<int> trie;
+  for (int i = 0; i < 1000; i++) {
+    trie.add("host" + std::to_string(i) + ".example.com", i);
+  }
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(i, *trie.find("host" + std::to_string(i) + ".example.com"));
+  }
+  EXPECT_EQ(nullptr, trie.find("host1000.example.com"));
+}
+
+} // namespace
+} // namespace Server
+} // namespace Envoy
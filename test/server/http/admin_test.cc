@@ -2,11 +2,14 @@
 #include <regex>
 #include <unordered_map>
 
+#include "envoy/admin/v2alpha/config_dump.pb.h"
 #include "envoy/admin/v2alpha/memory.pb.h"
 #include "envoy/json/json_object.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/stats.h"
 
+#include "common/buffer/memory_account.h"
+#include "common/common/thread.h"
 #include "common/http/message_impl.h"
 #include "common/json/json_loader.h"
 #include "common/profiler/profiler.h"
@@ -16,6 +19,8 @@
 
 #include "server/http/admin.h"
 
+#include "test/mocks/buffer/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
 #include "test/test_common/environment.h"
@@ -34,6 +39,7 @@ using testing::Ge;
 using testing::HasSubstr;
 using testing::InSequence;
 using testing::Invoke;
+using testing::InvokeWithoutArgs;
 using testing::NiceMock;
 using testing::Property;
 using testing::Ref;
@@ -573,6 +579,46 @@ TEST_P(AdminFilterTest, Trailers) {
   filter_.decodeTrailers(request_headers_);
 }
 
+TEST_P(AdminFilterTest, ContinuedResponse) {
+  uint32_t chunks = 2;
+  admin_.addHandler("/chunked", "chunked response",
+                    [&chunks](absl::string_view, Http::HeaderMap&, Buffer::Instance& response,
+                              AdminStream& admin_stream) -> Http::Code {
+                      response.add("a");
+                      admin_stream.setResponseContinuation(
+                          [&chunks](Buffer::Instance& response) -> bool {
+                            response.add("b");
+                            return --chunks > 0;
+                          });
+                      return Http::Code::OK;
+                    },
+                    true, false);
+  request_headers_.insertPath().value(std::string("/chunked"));
+
+  Event::MockTimer* timer = new Event::MockTimer(&callbacks_.dispatcher_);
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(callbacks_, encodeData(BufferStringEqual("a"), false));
+  EXPECT_CALL(callbacks_, addDownstreamWatermarkCallbacks(Ref(filter_)));
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(0)));
+  filter_.decodeHeaders(request_headers_, true);
+
+  // The next chunk waits while the client is behind.
+  EXPECT_CALL(callbacks_, encodeData(BufferStringEqual("b"), false))
+      .WillOnce(InvokeWithoutArgs([this]() -> void { filter_.onAboveWriteBufferHighWatermark(); }));
+  EXPECT_CALL(*timer, enableTimer(_)).Times(0);
+  timer->callback_();
+
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(0)));
+  filter_.onBelowWriteBufferLowWatermark();
+
+  EXPECT_CALL(callbacks_, encodeData(BufferStringEqual("b"), true));
+  EXPECT_CALL(*timer, enableTimer(_)).Times(0);
+  timer->callback_();
+
+  EXPECT_CALL(callbacks_, removeDownstreamWatermarkCallbacks(Ref(filter_)));
+  filter_.onDestroy();
+}
+
 class AdminInstanceTest : public testing::TestWithParam<Network::Address::IpVersion> {
 public:
   AdminInstanceTest()
@@ -592,7 +638,11 @@ public:
                          Buffer::Instance& response, absl::string_view method) {
     request_headers_.insertMethod().value(method.data(), method.size());
     admin_filter_.decodeHeaders(request_headers_, false);
-    return admin_.runCallback(path_and_query, response_headers, response, admin_filter_);
+    const Http::Code code =
+        admin_.runCallback(path_and_query, response_headers, response, admin_filter_);
+    while (admin_filter_.continueResponse(response)) {
+    }
+    return code;
   }
 
   Http::Code getCallback(absl::string_view path_and_query, Http::HeaderMap& response_headers,
@@ -662,6 +712,71 @@ TEST_P(AdminInstanceTest, AdminBadProfiler) {
   EXPECT_FALSE(Profiler::Cpu::profilerEnabled());
 }
 
+TEST_P(AdminInstanceTest, PprofProfileBadSeconds) {
+  Http::HeaderMapImpl header_map;
+  Buffer::OwnedImpl data;
+  EXPECT_EQ(Http::Code::BadRequest, getCallback("/pprof/profile?seconds=0", header_map, data));
+  EXPECT_EQ(Http::Code::BadRequest, getCallback("/pprof/profile?seconds=601", header_map, data));
+  EXPECT_EQ(Http::Code::BadRequest, getCallback("/pprof/profile?seconds=x", header_map, data));
+  EXPECT_FALSE(Profiler::Cpu::profilerEnabled());
+}
+
+#ifdef TCMALLOC
+
+TEST_P(AdminInstanceTest, PprofHeap) {
+  Http::HeaderMapImpl header_map;
+  Buffer::OwnedImpl data;
+  EXPECT_EQ(Http::Code::OK, getCallback("/pprof/heap", header_map, data));
+}
+
+TEST_P(AdminInstanceTest, PprofProfileWhileProfiling) {
+  Http::HeaderMapImpl header_map;
+  Buffer::OwnedImpl data;
+  EXPECT_EQ(Http::Code::OK, postCallback("/cpuprofiler?enable=y", header_map, data));
+  EXPECT_EQ(Http::Code::Conflict, getCallback("/pprof/profile?seconds=1", header_map, data));
+  EXPECT_EQ(Http::Code::OK, postCallback("/cpuprofiler?enable=n", header_map, data));
+}
+
+#else
+
+TEST_P(AdminInstanceTest, PprofHeap) {
+  Http::HeaderMapImpl header_map;
+  Buffer::OwnedImpl data;
+  EXPECT_EQ(Http::Code::NotImplemented, getCallback("/pprof/heap", header_map, data));
+}
+
+TEST_P(AdminInstanceTest, PprofProfile) {
+  Http::HeaderMapImpl header_map;
+  Buffer::OwnedImpl data;
+  EXPECT_EQ(Http::Code::InternalServerError,
+            getCallback("/pprof/profile?seconds=1", header_map, data));
+}
+
+#endif
+
+TEST_P(AdminInstanceTest, Contention) {
+  Http::HeaderMapImpl header_map;
+  Buffer::OwnedImpl data;
+  EXPECT_EQ(Http::Code::BadRequest, postCallback("/contentionprofiler", header_map, data));
+  EXPECT_EQ(Http::Code::OK, postCallback("/contentionprofiler?enable=y", header_map, data));
+  EXPECT_TRUE(Thread::MutexContention::enabled());
+  Thread::MutexContention::record(std::chrono::microseconds(3));
+  Thread::MutexContention::record(std::chrono::microseconds(5));
+
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(Http::Code::OK, getCallback("/contention", header_map, response));
+  EXPECT_EQ("enabled: true\n"
+            "contentions: 2\n"
+            "wait_time_us: 8\n"
+            "wait_us_histogram:\n"
+            "  [2, 4): 1\n"
+            "  [4, 8): 1\n",
+            response.toString());
+
+  EXPECT_EQ(Http::Code::OK, postCallback("/contentionprofiler?enable=n", header_map, data));
+  EXPECT_FALSE(Thread::MutexContention::enabled());
+}
+
 TEST_P(AdminInstanceTest, WriteAddressToFile) {
   std::ifstream address_file(address_out_path_);
   std::string address_from_file;
@@ -830,6 +945,78 @@ TEST_P(AdminInstanceTest, ConfigDumpMaintainsOrder) {
   }
 }
 
+// Only the configs of the requested keys are collected, and only their resources matching the name
+// regex are dumped.
+TEST_P(AdminInstanceTest, ConfigDumpFilters) {
+  auto cluster_entry = admin_.getConfigTracker().add("clusters", [] {
+    auto msg = std::make_unique<envoy::admin::v2alpha::ClustersConfigDump>();
+    msg->set_version_info("1");
+    msg->add_static_clusters()->mutable_cluster()->set_name("foo");
+    msg->add_dynamic_active_clusters()->mutable_cluster()->set_name("bar");
+    msg->add_dynamic_active_clusters()->mutable_cluster()->set_name("food");
+    return msg;
+  });
+  uint32_t listener_dumps = 0;
+  auto listener_entry = admin_.getConfigTracker().add("listeners", [&listener_dumps] {
+    listener_dumps++;
+    return std::make_unique<ProtobufWkt::StringValue>();
+  });
+
+  Buffer::OwnedImpl response;
+  Http::HeaderMapImpl header_map;
+  EXPECT_EQ(Http::Code::OK,
+            getCallback("/config_dump?resource=clusters&name_regex=^foo", header_map, response));
+  EXPECT_EQ(0, listener_dumps);
+  envoy::admin::v2alpha::ConfigDump config_dump;
+  MessageUtil::loadFromJson(response.toString(), config_dump);
+  ASSERT_EQ(1, config_dump.configs_size());
+  envoy::admin::v2alpha::ClustersConfigDump clusters_dump;
+  ASSERT_TRUE(config_dump.configs(0).UnpackTo(&clusters_dump));
+  EXPECT_EQ("1", clusters_dump.version_info());
+  ASSERT_EQ(1, clusters_dump.static_clusters_size());
+  EXPECT_EQ("foo", clusters_dump.static_clusters(0).cluster().name());
+  ASSERT_EQ(1, clusters_dump.dynamic_active_clusters_size());
+  EXPECT_EQ("food", clusters_dump.dynamic_active_clusters(0).cluster().name());
+
+  response.drain(response.length());
+  EXPECT_EQ(Http::Code::OK, getCallback("/config_dump?resource=routes", header_map, response));
+  EXPECT_EQ("{}\n", response.toString());
+}
+
+// The binary output parses as a single ConfigDump.
+TEST_P(AdminInstanceTest, ConfigDumpProto) {
+  auto bootstrap_entry = admin_.getConfigTracker().add("bootstrap", [] {
+    auto msg = std::make_unique<ProtobufWkt::StringValue>();
+    msg->set_value("bootstrap_config");
+    return msg;
+  });
+  auto cluster_entry = admin_.getConfigTracker().add("clusters", [] {
+    auto msg = std::make_unique<ProtobufWkt::StringValue>();
+    msg->set_value("clusters_config");
+    return msg;
+  });
+
+  Buffer::OwnedImpl response;
+  Http::HeaderMapImpl header_map;
+  EXPECT_EQ(Http::Code::OK, getCallback("/config_dump?format=proto", header_map, response));
+  EXPECT_EQ("application/octet-stream", header_map.ContentType()->value().getStringView());
+  envoy::admin::v2alpha::ConfigDump config_dump;
+  ASSERT_TRUE(config_dump.ParseFromString(response.toString()));
+  ASSERT_EQ(2, config_dump.configs_size());
+  ProtobufWkt::StringValue value;
+  ASSERT_TRUE(config_dump.configs(0).UnpackTo(&value));
+  EXPECT_EQ("bootstrap_config", value.value());
+  ASSERT_TRUE(config_dump.configs(1).UnpackTo(&value));
+  EXPECT_EQ("clusters_config", value.value());
+}
+
+TEST_P(AdminInstanceTest, ConfigDumpBadRequest) {
+  Buffer::OwnedImpl response;
+  Http::HeaderMapImpl header_map;
+  EXPECT_EQ(Http::Code::BadRequest, getCallback("/config_dump?format=yaml", header_map, response));
+  EXPECT_EQ(Http::Code::BadRequest, getCallback("/config_dump?name_regex=[", header_map, response));
+}
+
 TEST_P(AdminInstanceTest, Memory) {
   Http::HeaderMapImpl header_map;
   Buffer::OwnedImpl response;
@@ -841,6 +1028,37 @@ TEST_P(AdminInstanceTest, Memory) {
                                   Property(&envoy::admin::v2alpha::Memory::heap_size, Ge(0))));
 }
 
+TEST_P(AdminInstanceTest, MemoryTop) {
+  class TestMemoryAccount : public Buffer::MemoryAccount {
+  public:
+    TestMemoryAccount(Event::Dispatcher& dispatcher, const std::string& name)
+        : MemoryAccount(dispatcher), name_(name) {}
+
+    std::string describe() const override { return name_; }
+    void resetOwner() override {}
+
+    const std::string name_;
+  };
+
+  NiceMock<Event::MockDispatcher> dispatcher;
+  TestMemoryAccount small(dispatcher, "small");
+  TestMemoryAccount large(dispatcher, "large");
+  small.charge(10);
+  large.charge(200);
+
+  Http::HeaderMapImpl header_map;
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(Http::Code::OK, getCallback("/memory/top", header_map, response));
+  EXPECT_EQ("200 large\n10 small\n", response.toString());
+
+  response.drain(response.length());
+  EXPECT_EQ(Http::Code::OK, getCallback("/memory/top?limit=1", header_map, response));
+  EXPECT_EQ("200 large\n", response.toString());
+
+  response.drain(response.length());
+  EXPECT_EQ(Http::Code::BadRequest, getCallback("/memory/top?limit=x", header_map, response));
+}
+
 TEST_P(AdminInstanceTest, Runtime) {
   Http::HeaderMapImpl header_map;
   Buffer::OwnedImpl response;
@@ -859,7 +1077,7 @@ TEST_P(AdminInstanceTest, Runtime) {
   ON_CALL(*layer2, name()).WillByDefault(testing::ReturnRefOfCopy(std::string{"layer2"}));
   ON_CALL(*layer2, values()).WillByDefault(testing::ReturnRef(entries2));
 
-  std::vector<Runtime::Snapshot::OverrideLayerConstPtr> layers;
+  std::vector<Runtime::Snapshot::OverrideLayerConstSharedPtr> layers;
   layers.push_back(std::move(layer1));
   layers.push_back(std::move(layer2));
   EXPECT_CALL(snapshot, getLayers()).WillRepeatedly(testing::ReturnRef(layers));
@@ -1064,6 +1282,47 @@ TEST_P(AdminInstanceTest, ClustersJson) {
   EXPECT_THROW(MessageUtil::loadFromJson(text_output, failed_conversion_proto), EnvoyException);
 }
 
+TEST_P(AdminInstanceTest, StatsInChunks) {
+  for (uint32_t i = 0; i < 1500; i++) {
+    server_.stats_store_.counter(fmt::format("chunked.c{}", i));
+  }
+  const auto lines = [](Buffer::Instance& response) -> size_t {
+    const std::string output = response.toString();
+    return std::count(output.begin(), output.end(), '\n');
+  };
+
+  request_headers_.insertMethod().value(Http::Headers::get().MethodValues.Get);
+  admin_filter_.decodeHeaders(request_headers_, false);
+  Http::HeaderMapImpl header_map;
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(Http::Code::OK,
+            admin_.runCallback("/stats?filter=^chunked", header_map, response, admin_filter_));
+  EXPECT_EQ(1000, lines(response));
+  EXPECT_TRUE(absl::StartsWith(response.toString(), "chunked.c0: 0\nchunked.c1: 0\n"));
+  EXPECT_FALSE(admin_filter_.continueResponse(response));
+  EXPECT_EQ(1500, lines(response));
+
+  // A counter and its # TYPE line per metric.
+  response.drain(response.length());
+  EXPECT_EQ(Http::Code::OK, admin_.runCallback("/stats?format=prometheus&filter=^chunked",
+                                               header_map, response, admin_filter_));
+  EXPECT_EQ(2000, lines(response));
+  EXPECT_FALSE(admin_filter_.continueResponse(response));
+  EXPECT_EQ(3000, lines(response));
+}
+
+TEST_P(AdminInstanceTest, PrometheusStatsFilter) {
+  server_.stats_store_.counter("foo.used").inc();
+  server_.stats_store_.counter("foo.unused");
+  server_.stats_store_.gauge("bar.gauge").set(3);
+
+  Http::HeaderMapImpl header_map;
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(Http::Code::OK,
+            getCallback("/stats?format=prometheus&filter=^foo&usedonly", header_map, response));
+  EXPECT_EQ("# TYPE envoy_foo_used counter\nenvoy_foo_used{} 1\n", response.toString());
+}
+
 TEST_P(AdminInstanceTest, GetRequest) {
   Http::HeaderMapImpl response_headers;
   std::string body;
@@ -5,6 +5,7 @@
 #include "common/api/os_sys_calls_impl.h"
 #include "common/config/metadata.h"
 #include "common/network/address_impl.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/socket_option_impl.h"
 #include "common/network/utility.h"
@@ -229,6 +230,33 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, SetListenerPerConnectionBufferLim
   EXPECT_EQ(8192U, manager_->listeners().back().get().perConnectionBufferLimitBytes());
 }
 
+TEST_F(ListenerManagerImplWithRealFiltersTest, ConnectionBalanceConfig) {
+  const std::string yaml = TestEnvironment::substitute(R"EOF(
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    filter_chains:
+    - filters:
+  )EOF",
+                                                       Network::Address::IpVersion::v4);
+  const std::string exact_yaml = TestEnvironment::substitute(R"EOF(
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1235 }
+    filter_chains:
+    - filters:
+    connection_balance_config:
+      exact_balance: {}
+  )EOF",
+                                                             Network::Address::IpVersion::v4);
+
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true)).Times(2);
+  manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
+  EXPECT_NE(nullptr, dynamic_cast<Network::NopConnectionBalancerImpl*>(
+                         &manager_->listeners().back().get().connectionBalancer()));
+  manager_->addOrUpdateListener(parseListenerFromV2Yaml(exact_yaml), "", true);
+  EXPECT_NE(nullptr, dynamic_cast<Network::ExactConnectionBalancerImpl*>(
+                         &manager_->listeners().back().get().connectionBalancer()));
+}
+
 TEST_F(ListenerManagerImplWithRealFiltersTest, SslContext) {
   const std::string json = TestEnvironment::substitute(R"EOF(
   {
@@ -927,6 +955,92 @@ TEST_F(ListenerManagerImplTest, ListenerDraining) {
   checkStats(1, 0, 1, 0, 0, 0);
 }
 
+TEST_F(ListenerManagerImplTest, UpdateOnlyFilterChains) {
+  EXPECT_CALL(*worker_, start(_));
+  manager_->startWorkers(guard_dog_);
+
+  const std::string listener_foo_yaml = R"EOF(
+name: "foo"
+address:
+  socket_address:
+    address: "127.0.0.1"
+    port_value: 1234
+filter_chains:
+- filter_chain_match:
+    destination_port: 8080
+- filter_chain_match:
+    destination_port: 8081
+  )EOF";
+
+  std::vector<Configuration::FactoryContext*> contexts;
+  auto save_context = [&contexts](
+                          const Protobuf::RepeatedPtrField<envoy::api::v2::listener::Filter>&,
+                          Configuration::FactoryContext& context)
+      -> std::vector<Network::FilterFactoryCb> {
+    contexts.push_back(&context);
+    return {};
+  };
+
+  MockDrainManager* drain_manager = new MockDrainManager();
+  EXPECT_CALL(listener_factory_, createDrainManager_(_)).WillOnce(Return(drain_manager));
+  EXPECT_CALL(listener_factory_, createNetworkFilterFactoryList(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke(save_context));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true));
+  EXPECT_CALL(*worker_, addListener(_, _));
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_yaml), "", true));
+  worker_->callAddCompletion(true);
+  checkStats(1, 0, 0, 0, 1, 0);
+
+  // Replace the second filter chain. Only its connections are drained.
+  const std::string listener_foo_update1_yaml = R"EOF(
+name: "foo"
+address:
+  socket_address:
+    address: "127.0.0.1"
+    port_value: 1234
+filter_chains:
+- filter_chain_match:
+    destination_port: 8080
+- filter_chain_match:
+    destination_port: 8082
+  )EOF";
+
+  MockDrainManager* drain_manager_update1 = new MockDrainManager();
+  MockDrainManager* filter_chain_drain_manager = new MockDrainManager();
+  EXPECT_CALL(listener_factory_, createDrainManager_(_))
+      .WillOnce(Return(drain_manager_update1))
+      .WillOnce(Return(filter_chain_drain_manager));
+  EXPECT_CALL(listener_factory_, createNetworkFilterFactoryList(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke(save_context));
+  EXPECT_CALL(*worker_, addListener(_, _));
+  EXPECT_CALL(*worker_, stopListener(_));
+  EXPECT_CALL(*drain_manager, startDrainSequence(_)).Times(0);
+  EXPECT_CALL(*filter_chain_drain_manager, startDrainSequence(_));
+  EXPECT_TRUE(
+      manager_->addOrUpdateListener(parseListenerFromV2Yaml(listener_foo_update1_yaml), "", true));
+  worker_->callAddCompletion(true);
+  checkStats(1, 1, 0, 0, 1, 1);
+
+  // Connections of the removed filter chain drain, those of the kept filter chain do not.
+  ASSERT_EQ(4U, contexts.size());
+  EXPECT_CALL(*filter_chain_drain_manager, drainClose()).WillOnce(Return(true));
+  EXPECT_TRUE(contexts[1]->drainDecision().drainClose());
+  EXPECT_CALL(*drain_manager, drainClose()).WillOnce(Return(false));
+  EXPECT_CALL(server_.drain_manager_, drainClose()).WillOnce(Return(false));
+  EXPECT_FALSE(contexts[0]->drainDecision().drainClose());
+
+  EXPECT_CALL(*worker_, removeFilterChains(_, _, _));
+  filter_chain_drain_manager->drain_sequence_completion_();
+  EXPECT_EQ(1U, worker_->removed_filter_chains_.size());
+  checkStats(1, 1, 0, 0, 1, 1);
+
+  worker_->callRemovalCompletion();
+  checkStats(1, 1, 0, 0, 1, 0);
+  EXPECT_EQ(1UL, manager_->listeners().size());
+}
+
 TEST_F(ListenerManagerImplTest, RemoveListener) {
   InSequence s;
 
@@ -1735,6 +1849,71 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, MultipleFilterChainsWithDifferent
   EXPECT_EQ(1U, manager_->listeners().size());
 }
 
+TEST_F(ListenerManagerImplWithRealFiltersTest, UpdateReusesUnchangedTransportSocketFactories) {
+  const std::string yaml = TestEnvironment::substitute(R"EOF(
+    name: foo
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    filter_chains:
+    - filter_chain_match:
+        destination_port: 8080
+      tls_context:
+        common_tls_context:
+          tls_certificates:
+            - certificate_chain: { filename: "{{ test_rundir }}/test/common/ssl/test_data/san_dns_cert.pem" }
+              private_key: { filename: "{{ test_rundir }}/test/common/ssl/test_data/san_dns_key.pem" }
+    - filter_chain_match:
+        destination_port: 8081
+      tls_context:
+        common_tls_context:
+          tls_certificates:
+            - certificate_chain: { filename: "{{ test_rundir }}/test/common/ssl/test_data/san_dns_cert.pem" }
+              private_key: { filename: "{{ test_rundir }}/test/common/ssl/test_data/san_dns_key.pem" }
+  )EOF",
+                                                       Network::Address::IpVersion::v4);
+
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true));
+  manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
+  auto filter_chain = findFilterChain(8080, true, "127.0.0.1", true, "", true, "tls", true, {});
+  ASSERT_NE(filter_chain, nullptr);
+  const Network::TransportSocketFactory* kept_factory = &filter_chain->transportSocketFactory();
+  filter_chain = findFilterChain(8081, true, "127.0.0.1", true, "", true, "tls", true, {});
+  ASSERT_NE(filter_chain, nullptr);
+  const Network::TransportSocketFactory* changed_factory = &filter_chain->transportSocketFactory();
+
+  // Change the second filter chain's certificate.
+  const std::string update_yaml = TestEnvironment::substitute(R"EOF(
+    name: foo
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1234 }
+    filter_chains:
+    - filter_chain_match:
+        destination_port: 8080
+      tls_context:
+        common_tls_context:
+          tls_certificates:
+            - certificate_chain: { filename: "{{ test_rundir }}/test/common/ssl/test_data/san_dns_cert.pem" }
+              private_key: { filename: "{{ test_rundir }}/test/common/ssl/test_data/san_dns_key.pem" }
+    - filter_chain_match:
+        destination_port: 8081
+      tls_context:
+        common_tls_context:
+          tls_certificates:
+            - certificate_chain: { filename: "{{ test_rundir }}/test/common/ssl/test_data/san_uri_cert.pem" }
+              private_key: { filename: "{{ test_rundir }}/test/common/ssl/test_data/san_uri_key.pem" }
+  )EOF",
+                                                              Network::Address::IpVersion::v4);
+
+  EXPECT_TRUE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(update_yaml), "", true));
+  EXPECT_EQ(1U, manager_->listeners().size());
+  filter_chain = findFilterChain(8080, true, "127.0.0.1", true, "", true, "tls", true, {});
+  ASSERT_NE(filter_chain, nullptr);
+  EXPECT_EQ(kept_factory, &filter_chain->transportSocketFactory());
+  filter_chain = findFilterChain(8081, true, "127.0.0.1", true, "", true, "tls", true, {});
+  ASSERT_NE(filter_chain, nullptr);
+  EXPECT_NE(changed_factory, &filter_chain->transportSocketFactory());
+}
+
 TEST_F(ListenerManagerImplWithRealFiltersTest,
        MultipleFilterChainsWithMixedUseOfSessionTicketKeys) {
   const std::string yaml = TestEnvironment::substitute(R"EOF(
@@ -2524,6 +2703,62 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, FreebindListenerEnabled) {
   }
 }
 
+// Validate that the latency options set in the Listener are applied to the listen socket, and that
+// quick ACKs are enabled on its connections.
+TEST_F(ListenerManagerImplWithRealFiltersTest, TcpLatencyOptionsListenerEnabled) {
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  const std::string yaml = TestEnvironment::substitute(R"EOF(
+    name: TcpLatencyListener
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1111 }
+    filter_chains:
+    - filters:
+    tcp_latency_options:
+      busy_poll_us: 50
+      notsent_lowat: 16384
+      quick_ack: true
+  )EOF",
+                                                       Network::Address::IpVersion::v4);
+  if (ENVOY_SOCKET_SO_BUSY_POLL.has_value() && ENVOY_SOCKET_TCP_NOTSENT_LOWAT.has_value()) {
+    EXPECT_CALL(listener_factory_, createListenSocket(_, _, true))
+        .WillOnce(Invoke([this](Network::Address::InstanceConstSharedPtr,
+                                const Network::Socket::OptionsSharedPtr& options,
+                                bool) -> Network::SocketSharedPtr {
+          EXPECT_NE(options.get(), nullptr);
+          EXPECT_EQ(options->size(), 2);
+          EXPECT_TRUE(
+              Network::Socket::applyOptions(options, *listener_factory_.socket_,
+                                            envoy::api::v2::core::SocketOption::STATE_PREBIND));
+          return listener_factory_.socket_;
+        }));
+    EXPECT_CALL(os_sys_calls,
+                setsockopt_(_, ENVOY_SOCKET_SO_BUSY_POLL.value().first,
+                            ENVOY_SOCKET_SO_BUSY_POLL.value().second, _, sizeof(int)))
+        .WillOnce(Invoke([](int, int, int, const void* optval, socklen_t) -> int {
+          EXPECT_EQ(50, *static_cast<const int*>(optval));
+          return 0;
+        }));
+    EXPECT_CALL(os_sys_calls,
+                setsockopt_(_, ENVOY_SOCKET_TCP_NOTSENT_LOWAT.value().first,
+                            ENVOY_SOCKET_TCP_NOTSENT_LOWAT.value().second, _, sizeof(int)))
+        .WillOnce(Invoke([](int, int, int, const void* optval, socklen_t) -> int {
+          EXPECT_EQ(16384, *static_cast<const int*>(optval));
+          return 0;
+        }));
+    manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true);
+    ASSERT_EQ(1U, manager_->listeners().size());
+    EXPECT_TRUE(manager_->listeners().back().get().tcpQuickAck());
+  } else {
+    // MockListenerSocket is not a real socket, so this always fails in testing.
+    EXPECT_THROW_WITH_MESSAGE(
+        manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true), EnvoyException,
+        "MockListenerComponentFactory: Setting socket options failed");
+    EXPECT_EQ(0U, manager_->listeners().size());
+  }
+}
+
 TEST_F(ListenerManagerImplWithRealFiltersTest, LiteralSockoptListenerEnabled) {
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
@@ -2737,5 +2972,210 @@ TEST_F(ListenerManagerImplWithRealFiltersTest, VerifyIgnoreExpirationWithCA) {
   EXPECT_NO_THROW(manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true));
 }
 
+// Validate that a reuse_port listener gets a separate socket per worker, and that each worker and
+// the hot restart lookup see the listener with that worker's socket.
+TEST_F(ListenerManagerImplWithRealFiltersTest, ReusePortSocketsFollowWorkerCpuAffinity) {
+  if (!ENVOY_SOCKET_SO_INCOMING_CPU.has_value()) {
+    return;
+  }
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  server_.options_.concurrency_ = 2;
+  server_.options_.worker_cpu_affinity_ = {4, 6};
+  EXPECT_CALL(worker_factory_, createWorker_())
+      .WillOnce(Return(new MockWorker()))
+      .WillOnce(Return(new MockWorker()));
+  ListenerManagerImpl manager(server_, listener_factory_, worker_factory_, time_source_);
+
+  const std::string yaml = TestEnvironment::substitute(R"EOF(
+    name: ReusePortListener
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1111 }
+    filter_chains:
+    - filters:
+    reuse_port: true
+  )EOF",
+                                                       Network::Address::IpVersion::v4);
+
+  // Each worker's socket prefers connections received on the worker's CPU.
+  std::vector<int> incoming_cpus;
+  EXPECT_CALL(os_sys_calls,
+              setsockopt_(_, ENVOY_SOCKET_SO_INCOMING_CPU.value().first,
+                          ENVOY_SOCKET_SO_INCOMING_CPU.value().second, _, sizeof(int)))
+      .Times(2)
+      .WillRepeatedly(Invoke([&](int, int, int, const void* optval, socklen_t) -> int {
+        incoming_cpus.push_back(*static_cast<const int*>(optval));
+        return 0;
+      }));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true));
+  auto worker_socket = std::make_shared<NiceMock<Network::MockListenSocket>>();
+  EXPECT_CALL(listener_factory_, createWorkerListenSocket(_, _, 1))
+      .WillOnce(Invoke([&](Network::Address::InstanceConstSharedPtr,
+                           const Network::Socket::OptionsSharedPtr& options,
+                           uint32_t) -> Network::SocketSharedPtr {
+        EXPECT_EQ(2U, options->size());
+        EXPECT_TRUE(Network::Socket::applyOptions(
+            options, *worker_socket, envoy::api::v2::core::SocketOption::STATE_PREBIND));
+        return worker_socket;
+      }));
+  EXPECT_TRUE(manager.addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true));
+  EXPECT_EQ(std::vector<int>({4, 6}), incoming_cpus);
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, ReusePortSocketPerWorker) {
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  server_.options_.concurrency_ = 2;
+  MockWorker* worker1 = new MockWorker();
+  MockWorker* worker2 = new MockWorker();
+  EXPECT_CALL(worker_factory_, createWorker_())
+      .WillOnce(Return(worker1))
+      .WillOnce(Return(worker2));
+  ListenerManagerImpl manager(server_, listener_factory_, worker_factory_, time_source_);
+
+  const std::string yaml = TestEnvironment::substitute(R"EOF(
+    name: ReusePortListener
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1111 }
+    filter_chains:
+    - filters:
+    reuse_port: true
+  )EOF",
+                                                       Network::Address::IpVersion::v4);
+
+  auto worker_socket = std::make_shared<NiceMock<Network::MockListenSocket>>();
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, true));
+  EXPECT_CALL(listener_factory_, createWorkerListenSocket(_, _, 1))
+      .WillOnce(Invoke([&](Network::Address::InstanceConstSharedPtr address,
+                           const Network::Socket::OptionsSharedPtr& options,
+                           uint32_t) -> Network::SocketSharedPtr {
+        // The worker socket binds to the address of the first socket.
+        EXPECT_EQ(*listener_factory_.socket_->localAddress(), *address);
+        EXPECT_EQ(1U, options->size());
+        return worker_socket;
+      }));
+  EXPECT_TRUE(manager.addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true));
+
+  Network::ListenerConfig* worker1_listener{};
+  Network::ListenerConfig* worker2_listener{};
+  EXPECT_CALL(*worker1, addListener(_, _))
+      .WillOnce(Invoke([&](Network::ListenerConfig& listener, Worker::AddListenerCompletion) {
+        worker1_listener = &listener;
+      }));
+  EXPECT_CALL(*worker2, addListener(_, _))
+      .WillOnce(Invoke([&](Network::ListenerConfig& listener, Worker::AddListenerCompletion) {
+        worker2_listener = &listener;
+      }));
+  EXPECT_CALL(*worker1, start(_));
+  EXPECT_CALL(*worker2, start(_));
+  manager.startWorkers(guard_dog_);
+
+  EXPECT_EQ(listener_factory_.socket_.get(), &worker1_listener->socket());
+  EXPECT_EQ(worker_socket.get(), &worker2_listener->socket());
+  EXPECT_EQ(worker1_listener->listenerTag(), worker2_listener->listenerTag());
+  EXPECT_EQ("ReusePortListener", worker2_listener->name());
+
+  ASSERT_EQ(1U, manager.workerListeners(1).size());
+  EXPECT_EQ(worker_socket.get(), &manager.workerListeners(1)[0].get().socket());
+  EXPECT_TRUE(manager.workerListeners(2).empty());
+
+  // The sockets are carried over on update, so the socket layout can't change.
+  const std::string update_yaml = TestEnvironment::substitute(R"EOF(
+    name: ReusePortListener
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1111 }
+    filter_chains:
+    - filters:
+  )EOF",
+                                                              Network::Address::IpVersion::v4);
+  EXPECT_THROW_WITH_MESSAGE(
+      manager.addOrUpdateListener(parseListenerFromV2Yaml(update_yaml), "", true), EnvoyException,
+      "error updating listener: 'ReusePortListener' cannot change reuse_port of existing listener");
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, UdpListenerSocketPerWorker) {
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+
+  server_.options_.concurrency_ = 2;
+  MockWorker* worker1 = new MockWorker();
+  MockWorker* worker2 = new MockWorker();
+  EXPECT_CALL(worker_factory_, createWorker_())
+      .WillOnce(Return(worker1))
+      .WillOnce(Return(worker2));
+  ListenerManagerImpl manager(server_, listener_factory_, worker_factory_, time_source_);
+
+  // UDP listeners have a SO_REUSEPORT socket per worker without reuse_port being set.
+  const std::string yaml = TestEnvironment::substitute(R"EOF(
+    name: UdpListener
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1111, protocol: UDP }
+  )EOF",
+                                                       Network::Address::IpVersion::v4);
+
+  auto first_socket = std::make_shared<NiceMock<Network::MockListenSocket>>();
+  auto worker_socket = std::make_shared<NiceMock<Network::MockListenSocket>>();
+  EXPECT_CALL(listener_factory_, createUdpListenerFilterFactoryList(_, _));
+  EXPECT_CALL(listener_factory_, createUdpListenSocket(_, _, 0)).WillOnce(Return(first_socket));
+  EXPECT_CALL(listener_factory_, createUdpListenSocket(_, _, 1))
+      .WillOnce(Invoke([&](Network::Address::InstanceConstSharedPtr address,
+                           const Network::Socket::OptionsSharedPtr& options,
+                           uint32_t) -> Network::SocketSharedPtr {
+        EXPECT_EQ(*first_socket->localAddress(), *address);
+        EXPECT_EQ(1U, options->size());
+        return worker_socket;
+      }));
+  EXPECT_CALL(listener_factory_, createListenSocket(_, _, _)).Times(0);
+  EXPECT_TRUE(manager.addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true));
+
+  Network::ListenerConfig* worker1_listener{};
+  Network::ListenerConfig* worker2_listener{};
+  EXPECT_CALL(*worker1, addListener(_, _))
+      .WillOnce(Invoke([&](Network::ListenerConfig& listener, Worker::AddListenerCompletion) {
+        worker1_listener = &listener;
+      }));
+  EXPECT_CALL(*worker2, addListener(_, _))
+      .WillOnce(Invoke([&](Network::ListenerConfig& listener, Worker::AddListenerCompletion) {
+        worker2_listener = &listener;
+      }));
+  EXPECT_CALL(*worker1, start(_));
+  EXPECT_CALL(*worker2, start(_));
+  manager.startWorkers(guard_dog_);
+
+  EXPECT_EQ(first_socket.get(), &worker1_listener->socket());
+  EXPECT_EQ(worker_socket.get(), &worker2_listener->socket());
+  EXPECT_EQ(Network::Address::SocketType::Datagram, worker1_listener->socketType());
+  EXPECT_EQ(Network::Address::SocketType::Datagram, worker2_listener->socketType());
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, UdpListenerWithFilterChains) {
+  const std::string yaml = TestEnvironment::substitute(R"EOF(
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1111, protocol: UDP }
+    filter_chains:
+    - filters:
+  )EOF",
+                                                       Network::Address::IpVersion::v4);
+
+  EXPECT_THROW_WITH_MESSAGE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true),
+                            EnvoyException,
+                            "error adding listener '127.0.0.1:1111': udp listeners must bind to "
+                            "their port and can not have filter chains or use original dst");
+}
+
+TEST_F(ListenerManagerImplWithRealFiltersTest, TcpListenerWithoutFilterChains) {
+  const std::string yaml = TestEnvironment::substitute(R"EOF(
+    address:
+      socket_address: { address: 127.0.0.1, port_value: 1111 }
+  )EOF",
+                                                       Network::Address::IpVersion::v4);
+
+  EXPECT_THROW_WITH_MESSAGE(manager_->addOrUpdateListener(parseListenerFromV2Yaml(yaml), "", true),
+                            EnvoyException,
+                            "error adding listener '127.0.0.1:1111': no filter chains");
+}
+
 } // namespace Server
 } // namespace Envoy
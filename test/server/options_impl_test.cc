@@ -5,7 +5,11 @@
 
 #include "envoy/common/exception.h"
 
+#include "common/buffer/buffer_impl.h"
+#include "common/common/regex.h"
 #include "common/common/utility.h"
+#include "common/event/libevent.h"
+#include "common/network/connection_impl.h"
 
 #include "server/options_impl.h"
 
@@ -98,6 +102,95 @@ TEST(OptionsImplTest, All) {
   EXPECT_EQ(Server::Mode::InitOnly, options->mode());
 }
 
+TEST(OptionsImplTest, UseLibeventBuffers) {
+  EXPECT_FALSE(createOptionsImpl("envoy -c hello")->useLibeventBuffers());
+  EXPECT_TRUE(createOptionsImpl("envoy -c hello --use-libevent-buffers")->useLibeventBuffers());
+  // The buffer implementation is only selected when the server starts.
+  EXPECT_FALSE(Buffer::OwnedImpl::usingOldImpl());
+}
+
+TEST(OptionsImplTest, EventLoopBackend) {
+  EXPECT_EQ(Server::EventLoopBackend::Default,
+            createOptionsImpl("envoy -c hello")->eventLoopBackend());
+  EXPECT_EQ(Server::EventLoopBackend::EpollChangelist,
+            createOptionsImpl("envoy -c hello --event-loop-backend epoll_changelist")
+                ->eventLoopBackend());
+  EXPECT_EQ(Server::EventLoopBackend::Default,
+            createOptionsImpl("envoy -c hello --event-loop-backend default")->eventLoopBackend());
+  EXPECT_EQ(Event::Libevent::Backend::Default, Event::Libevent::Global::backend());
+  EXPECT_THROW_WITH_REGEX(createOptionsImpl("envoy -c hello --event-loop-backend io_uring"),
+                          MalformedArgvException, "unknown event loop backend 'io_uring'");
+}
+
+TEST(OptionsImplTest, DrainCurve) {
+  EXPECT_EQ(Server::DrainCurve::Quadratic,
+            createOptionsImpl("envoy -c hello --drain-curve quadratic")->drainCurve());
+  EXPECT_EQ(Server::DrainCurve::Immediate,
+            createOptionsImpl("envoy -c hello --drain-curve immediate")->drainCurve());
+  EXPECT_THROW_WITH_REGEX(createOptionsImpl("envoy -c hello --drain-curve cubic"),
+                          MalformedArgvException, "unknown drain curve 'cubic'");
+}
+
+TEST(OptionsImplTest, WorkerCpuAffinity) {
+  EXPECT_TRUE(createOptionsImpl("envoy -c hello")->workerCpuAffinity().empty());
+  EXPECT_EQ(std::vector<uint32_t>({0, 1, 2, 3, 8, 10, 11}),
+            createOptionsImpl("envoy -c hello --worker-cpu-affinity 0-3,8,10-11")
+                ->workerCpuAffinity());
+  EXPECT_THROW_WITH_REGEX(createOptionsImpl("envoy -c hello --worker-cpu-affinity 3-1"),
+                          MalformedArgvException, "invalid worker CPU affinity '3-1'");
+  EXPECT_THROW_WITH_REGEX(createOptionsImpl("envoy -c hello --worker-cpu-affinity 1-2-3"),
+                          MalformedArgvException, "invalid worker CPU affinity '1-2-3'");
+  EXPECT_THROW_WITH_REGEX(createOptionsImpl("envoy -c hello --worker-cpu-affinity 0,x"),
+                          MalformedArgvException, "invalid worker CPU affinity '0,x'");
+  EXPECT_THROW_WITH_REGEX(createOptionsImpl("envoy -c hello --worker-cpu-affinity 0-100000"),
+                          MalformedArgvException, "invalid worker CPU affinity '0-100000'");
+}
+
+TEST(OptionsImplTest, TlsPrivateKeyThreads) {
+  EXPECT_EQ(0U, createOptionsImpl("envoy -c hello")->tlsPrivateKeyThreads());
+  EXPECT_EQ(4U, createOptionsImpl("envoy -c hello --tls-private-key-threads 4")
+                    ->tlsPrivateKeyThreads());
+}
+
+TEST(OptionsImplTest, TlsSessionCacheSize) {
+  EXPECT_EQ(0U, createOptionsImpl("envoy -c hello")->tlsSessionCacheSize());
+  EXPECT_EQ(1024U, createOptionsImpl("envoy -c hello --tls-session-cache-size 1024")
+                       ->tlsSessionCacheSize());
+}
+
+TEST(OptionsImplTest, TlsLazyServerContexts) {
+  EXPECT_EQ(0U, createOptionsImpl("envoy -c hello")->tlsLazyServerContexts());
+  EXPECT_EQ(1000U, createOptionsImpl("envoy -c hello --tls-lazy-server-contexts 1000")
+                       ->tlsLazyServerContexts());
+}
+
+TEST(OptionsImplTest, DnsCache) {
+  std::unique_ptr<OptionsImpl> options = createOptionsImpl("envoy -c hello");
+  EXPECT_EQ(0U, options->dnsCacheSize());
+  EXPECT_EQ(std::chrono::seconds(30), options->dnsCacheMaxStale());
+  options = createOptionsImpl("envoy -c hello --dns-cache-size 4096 --dns-cache-max-stale 60");
+  EXPECT_EQ(4096U, options->dnsCacheSize());
+  EXPECT_EQ(std::chrono::seconds(60), options->dnsCacheMaxStale());
+}
+
+TEST(OptionsImplTest, ReadBudget) {
+  EXPECT_EQ(0U, createOptionsImpl("envoy -c hello")->readBudgetBytes());
+  EXPECT_EQ(65536U,
+            createOptionsImpl("envoy -c hello --read-budget-bytes 65536")->readBudgetBytes());
+  EXPECT_EQ(0, Network::ConnectionImpl::readBudget());
+}
+
+TEST(OptionsImplTest, Regex) {
+  std::unique_ptr<OptionsImpl> options = createOptionsImpl("envoy -c hello");
+  EXPECT_FALSE(options->useStdRegex());
+  EXPECT_EQ(Regex::Utility::DefaultMaxProgramSize, options->maxRegexProgramSize());
+  options = createOptionsImpl("envoy -c hello --use-std-regex --max-regex-program-size 5000");
+  EXPECT_TRUE(options->useStdRegex());
+  EXPECT_EQ(5000U, options->maxRegexProgramSize());
+  EXPECT_EQ(Regex::Engine::GoogleRe2, Regex::Utility::defaultEngine());
+  EXPECT_EQ(Regex::Utility::DefaultMaxProgramSize, Regex::Utility::maxProgramSize());
+}
+
 TEST(OptionsImplTest, SetAll) {
   std::unique_ptr<OptionsImpl> options = createOptionsImpl("envoy -c hello");
   bool v2_config_only = options->v2ConfigOnly();
@@ -108,15 +201,25 @@ TEST(OptionsImplTest, SetAll) {
 
   options->setBaseId(109876);
   options->setConcurrency(42);
+  options->setWorkerCpuAffinity({1, 3});
+  options->setBlockingPoolThreads(3);
+  options->setTlsPrivateKeyThreads(4);
+  options->setTlsSessionCacheSize(1024);
+  options->setTlsLazyServerContexts(1000);
+  options->setDnsCacheSize(4096);
+  options->setDnsCacheMaxStale(std::chrono::seconds(60));
   options->setConfigPath("foo");
   options->setConfigYaml("bogus:");
   options->setV2ConfigOnly(!options->v2ConfigOnly());
   options->setAdminAddressPath("path");
   options->setLocalAddressIpVersion(Network::Address::IpVersion::v6);
   options->setDrainTime(std::chrono::seconds(42));
+  options->setDrainCurve(Server::DrainCurve::Quadratic);
+  options->setDrainCloseRate(100);
   options->setLogLevel(spdlog::level::trace);
   options->setLogFormat("%L %n %v");
   options->setLogPath("/foo/bar");
+  options->setLogRingSize(1024);
   options->setParentShutdownTime(std::chrono::seconds(43));
   options->setRestartEpoch(44);
   options->setFileFlushIntervalMsec(std::chrono::milliseconds(45));
@@ -127,18 +230,34 @@ TEST(OptionsImplTest, SetAll) {
   options->setMaxStats(12345);
   options->setStatsOptions(stats_options);
   options->setHotRestartDisabled(!options->hotRestartDisabled());
+  options->setBufferSlabPoolMb(64);
+  options->setUseLibeventBuffers(true);
+  options->setEventLoopBackend(Server::EventLoopBackend::EpollChangelist);
+  options->setReadBudgetBytes(65536);
+  options->setUseStdRegex(true);
+  options->setMaxRegexProgramSize(5000);
 
   EXPECT_EQ(109876, options->baseId());
   EXPECT_EQ(42U, options->concurrency());
+  EXPECT_EQ(std::vector<uint32_t>({1, 3}), options->workerCpuAffinity());
+  EXPECT_EQ(3U, options->blockingPoolThreads());
+  EXPECT_EQ(4U, options->tlsPrivateKeyThreads());
+  EXPECT_EQ(1024U, options->tlsSessionCacheSize());
+  EXPECT_EQ(1000U, options->tlsLazyServerContexts());
+  EXPECT_EQ(4096U, options->dnsCacheSize());
+  EXPECT_EQ(std::chrono::seconds(60), options->dnsCacheMaxStale());
   EXPECT_EQ("foo", options->configPath());
   EXPECT_EQ("bogus:", options->configYaml());
   EXPECT_EQ(!v2_config_only, options->v2ConfigOnly());
   EXPECT_EQ("path", options->adminAddressPath());
   EXPECT_EQ(Network::Address::IpVersion::v6, options->localAddressIpVersion());
   EXPECT_EQ(std::chrono::seconds(42), options->drainTime());
+  EXPECT_EQ(Server::DrainCurve::Quadratic, options->drainCurve());
+  EXPECT_EQ(100U, options->drainCloseRate());
   EXPECT_EQ(spdlog::level::trace, options->logLevel());
   EXPECT_EQ("%L %n %v", options->logFormat());
   EXPECT_EQ("/foo/bar", options->logPath());
+  EXPECT_EQ(1024U, options->logRingSize());
   EXPECT_EQ(std::chrono::seconds(43), options->parentShutdownTime());
   EXPECT_EQ(44, options->restartEpoch());
   EXPECT_EQ(std::chrono::milliseconds(45), options->fileFlushIntervalMsec());
@@ -150,16 +269,26 @@ TEST(OptionsImplTest, SetAll) {
   EXPECT_EQ(stats_options.max_obj_name_length_, options->statsOptions().maxObjNameLength());
   EXPECT_EQ(stats_options.max_stat_suffix_length_, options->statsOptions().maxStatSuffixLength());
   EXPECT_EQ(!hot_restart_disabled, options->hotRestartDisabled());
+  EXPECT_EQ(64U, options->bufferSlabPoolMb());
+  EXPECT_TRUE(options->useLibeventBuffers());
+  EXPECT_EQ(Server::EventLoopBackend::EpollChangelist, options->eventLoopBackend());
+  EXPECT_EQ(65536U, options->readBudgetBytes());
+  EXPECT_TRUE(options->useStdRegex());
+  EXPECT_EQ(5000U, options->maxRegexProgramSize());
 }
 
 TEST(OptionsImplTest, DefaultParams) {
   std::unique_ptr<OptionsImpl> options = createOptionsImpl("envoy -c hello");
   EXPECT_EQ(std::chrono::seconds(600), options->drainTime());
+  EXPECT_EQ(Server::DrainCurve::Linear, options->drainCurve());
+  EXPECT_EQ(0U, options->drainCloseRate());
   EXPECT_EQ(std::chrono::seconds(900), options->parentShutdownTime());
   EXPECT_EQ("", options->adminAddressPath());
   EXPECT_EQ(Network::Address::IpVersion::v4, options->localAddressIpVersion());
   EXPECT_EQ(Server::Mode::Serve, options->mode());
   EXPECT_EQ(false, options->hotRestartDisabled());
+  EXPECT_EQ(0U, options->bufferSlabPoolMb());
+  EXPECT_EQ(2U, options->blockingPoolThreads());
 }
 
 TEST(OptionsImplTest, BadCliOption) {
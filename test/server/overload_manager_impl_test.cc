@@ -200,6 +200,68 @@ TEST_F(OverloadManagerImplTest, CallbackOnlyFiresWhenStateChanges) {
   EXPECT_EQ(40, pressure_gauge2.value());
 }
 
+TEST_F(OverloadManagerImplTest, ScaledTrigger) {
+  setDispatcherExpectation();
+
+  const std::string config = R"EOF(
+    resource_monitors {
+      name: "envoy.resource_monitors.fake_resource1"
+    }
+    actions {
+      name: "envoy.overload_actions.dummy_action"
+      triggers {
+        name: "envoy.resource_monitors.fake_resource1"
+        scaled {
+          scaling_threshold: 0.5
+          saturation_threshold: 1.0
+        }
+      }
+    }
+  )EOF";
+
+  auto manager(createOverloadManager(config));
+  int cb_count = 0;
+  manager->registerForAction("envoy.overload_actions.dummy_action", dispatcher_,
+                             [&](OverloadActionState) { cb_count++; });
+  manager->start();
+
+  Stats::Gauge& active_gauge = stats_.gauge("overload.envoy.overload_actions.dummy_action.active");
+  Stats::Gauge& scale_percent_gauge =
+      stats_.gauge("overload.envoy.overload_actions.dummy_action.scale_percent");
+  const OverloadActionState& action_state =
+      manager->getThreadLocalOverloadState().getState("envoy.overload_actions.dummy_action");
+  const double& scaled_value =
+      manager->getThreadLocalOverloadState().getScaledValue("envoy.overload_actions.dummy_action");
+
+  factory1_.monitor_->setPressure(0.4);
+  timer_cb_();
+  EXPECT_EQ(0, scaled_value);
+  EXPECT_EQ(0, scale_percent_gauge.value());
+
+  // Scaling changes the value of the action without activating it.
+  factory1_.monitor_->setPressure(0.75);
+  timer_cb_();
+  EXPECT_DOUBLE_EQ(0.5, scaled_value);
+  EXPECT_EQ(50, scale_percent_gauge.value());
+  EXPECT_EQ(action_state, OverloadActionState::Inactive);
+  EXPECT_EQ(0, active_gauge.value());
+  EXPECT_EQ(0, cb_count);
+
+  factory1_.monitor_->setPressure(1.0);
+  timer_cb_();
+  EXPECT_EQ(1, scaled_value);
+  EXPECT_EQ(100, scale_percent_gauge.value());
+  EXPECT_EQ(action_state, OverloadActionState::Active);
+  EXPECT_EQ(1, active_gauge.value());
+  EXPECT_EQ(1, cb_count);
+
+  factory1_.monitor_->setPressure(0.625);
+  timer_cb_();
+  EXPECT_DOUBLE_EQ(0.25, scaled_value);
+  EXPECT_EQ(action_state, OverloadActionState::Inactive);
+  EXPECT_EQ(2, cb_count);
+}
+
 TEST_F(OverloadManagerImplTest, FailedUpdates) {
   setDispatcherExpectation();
   auto manager(createOverloadManager(getConfig()));
@@ -306,6 +368,27 @@ TEST_F(OverloadManagerImplTest, DuplicateTrigger) {
 
   EXPECT_THROW_WITH_REGEX(createOverloadManager(config), EnvoyException, "Duplicate trigger .*");
 }
+
+TEST_F(OverloadManagerImplTest, InvalidScaledTrigger) {
+  const std::string config = R"EOF(
+    resource_monitors {
+      name: "envoy.resource_monitors.fake_resource1"
+    }
+    actions {
+      name: "envoy.overload_actions.dummy_action"
+      triggers {
+        name: "envoy.resource_monitors.fake_resource1"
+        scaled {
+          scaling_threshold: 0.9
+          saturation_threshold: 0.8
+        }
+      }
+    }
+  )EOF";
+
+  EXPECT_THROW_WITH_MESSAGE(createOverloadManager(config), EnvoyException,
+                            "scaling_threshold must be less than saturation_threshold");
+}
 } // namespace
 } // namespace Server
 } // namespace Envoy
@@ -1,3 +1,7 @@
+#ifdef __linux__
+#include <sched.h>
+#endif
+
 #include "common/event/dispatcher_impl.h"
 
 #include "server/worker_impl.h"
@@ -16,6 +20,7 @@ using testing::Invoke;
 using testing::InvokeWithoutArgs;
 using testing::NiceMock;
 using testing::Return;
+using testing::SaveArg;
 using testing::Throw;
 
 namespace Envoy {
@@ -35,8 +40,9 @@ public:
   Network::MockConnectionHandler* handler_ = new Network::MockConnectionHandler();
   NiceMock<MockGuardDog> guard_dog_;
   DefaultTestHooks hooks_;
+  NiceMock<MockOverloadManager> overload_manager_;
   WorkerImpl worker_{tls_, hooks_, Event::DispatcherPtr{dispatcher_},
-                     Network::ConnectionHandlerPtr{handler_}};
+                     Network::ConnectionHandlerPtr{handler_}, overload_manager_, absl::nullopt};
   Event::TimerPtr no_exit_timer_ = dispatcher_->createTimer([]() -> void {});
 };
 
@@ -132,5 +138,57 @@ TEST_F(WorkerImplTest, ListenerException) {
   worker_.stop();
 }
 
+#ifdef __linux__
+TEST_F(WorkerImplTest, CpuAffinity) {
+  cpu_set_t allowed;
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+  uint32_t cpu = 0;
+  while (!CPU_ISSET(cpu, &allowed)) {
+    cpu++;
+  }
+
+  Event::DispatcherImpl* dispatcher = new Event::DispatcherImpl(test_time.timeSystem());
+  Network::MockConnectionHandler* handler = new Network::MockConnectionHandler();
+  WorkerImpl worker{tls_, hooks_, Event::DispatcherPtr{dispatcher},
+                    Network::ConnectionHandlerPtr{handler}, overload_manager_, cpu};
+  Event::TimerPtr no_exit_timer = dispatcher->createTimer([]() -> void {});
+  no_exit_timer->enableTimer(std::chrono::hours(1));
+
+  // The worker thread runs the event loop pinned to the CPU.
+  ConditionalInitializer ci;
+  cpu_set_t pinned;
+  CPU_ZERO(&pinned);
+  NiceMock<Network::MockListenerConfig> listener;
+  EXPECT_CALL(*handler, addListener(_)).WillOnce(Invoke([&pinned](Network::ListenerConfig&) {
+    EXPECT_EQ(0, sched_getaffinity(0, sizeof(pinned), &pinned));
+  }));
+  worker.addListener(listener, [&ci](bool) -> void { ci.setReady(); });
+  worker.start(guard_dog_);
+  ci.waitReady();
+  worker.stop();
+
+  EXPECT_EQ(1, CPU_COUNT(&pinned));
+  EXPECT_TRUE(CPU_ISSET(cpu, &pinned));
+}
+#endif
+
+TEST_F(WorkerImplTest, StopAcceptingConnectionsOnOverload) {
+  NiceMock<MockOverloadManager> overload_manager;
+  OverloadActionCb stop_accepting_connections_cb;
+  EXPECT_CALL(overload_manager,
+              registerForAction(OverloadActionNames::get().StopAcceptingConnections, _, _))
+      .WillOnce(SaveArg<2>(&stop_accepting_connections_cb));
+  Network::MockConnectionHandler* handler = new Network::MockConnectionHandler();
+  WorkerImpl worker{tls_, hooks_, Event::DispatcherPtr{new Event::DispatcherImpl(
+                                      test_time.timeSystem())},
+                    Network::ConnectionHandlerPtr{handler}, overload_manager, absl::nullopt};
+
+  // The overload manager posts the callback to the worker's dispatcher.
+  EXPECT_CALL(*handler, disableListeners());
+  stop_accepting_connections_cb(OverloadActionState::Active);
+  EXPECT_CALL(*handler, enableListeners());
+  stop_accepting_connections_cb(OverloadActionState::Inactive);
+}
+
 } // namespace Server
 } // namespace Envoy
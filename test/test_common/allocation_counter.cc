@@ -0,0 +1,42 @@
+#include "test/test_common/allocation_counter.h"
+
+#include <atomic>
+
+#ifdef TCMALLOC
+#include "gperftools/malloc_hook.h"
+#endif
+
+namespace Envoy {
+namespace {
+
+std::atomic<uint64_t> allocation_count{0};
+
+#ifdef TCMALLOC
+void onNew(const void*, size_t) { allocation_count.fetch_add(1, std::memory_order_relaxed); }
+
+bool installHook() { return MallocHook::AddNewHook(&onNew); }
+#else
+bool installHook() { return false; }
+#endif
+
+bool hookInstalled() {
+  static const bool installed = installHook();
+  return installed;
+}
+
+} // namespace
+
+AllocationCounter::AllocationCounter() {
+  hookInstalled();
+  reset();
+}
+
+bool AllocationCounter::enabled() { return hookInstalled(); }
+
+uint64_t AllocationCounter::allocations() const {
+  return allocation_count.load(std::memory_order_relaxed) - start_;
+}
+
+void AllocationCounter::reset() { start_ = allocation_count.load(std::memory_order_relaxed); }
+
+} // namespace Envoy
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Envoy {
+
+/**
+ * Counts the heap allocations made by all the threads of the process, for benchmarks to report
+ * the allocations per operation. Allocations are only counted when built with tcmalloc, via its
+ * new hook, which is installed the first time a counter is constructed.
+ */
+class AllocationCounter {
+public:
+  AllocationCounter();
+
+  /**
+   * @return whether allocations are counted in this build.
+   */
+  static bool enabled();
+
+  /**
+   * @return the number of allocations since construction or the last reset().
+   */
+  uint64_t allocations() const;
+
+  /**
+   * Restarts the count from zero.
+   */
+  void reset();
+
+private:
+  uint64_t start_;
+};
+
+} // namespace Envoy
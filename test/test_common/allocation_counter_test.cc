@@ -0,0 +1,22 @@
+#include "test/test_common/allocation_counter.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+
+TEST(AllocationCounterTest, CountsAllocations) {
+  AllocationCounter counter;
+  auto value = std::make_unique<uint64_t>(1);
+  if (AllocationCounter::enabled()) {
+    EXPECT_LE(1, counter.allocations());
+  } else {
+    EXPECT_EQ(0, counter.allocations());
+  }
+
+  counter.reset();
+  EXPECT_EQ(0, counter.allocations());
+}
+
+} // namespace Envoy